@@ -22,6 +22,7 @@ limitations under the License.
 #include "tensorflow/c/experimental/stream_executor/stream_executor.h"
 
 #include <string>
+#include <vector>
 
 #include "tensorflow/c/c_api_macros.h"
 #include "tensorflow/c/c_api_macros_internal.h"
@@ -138,6 +139,13 @@ port::Status ValidateSPStreamExecutor(const SP_StreamExecutor& se,
   TF_VALIDATE_NOT_NULL(SP_StreamExecutor, se, stop_timer);
   TF_VALIDATE_NOT_NULL(SP_StreamExecutor, se, memcpy_dtoh);
   TF_VALIDATE_NOT_NULL(SP_StreamExecutor, se, memcpy_htod);
+  if (se.memcpy_htod_batch != nullptr || se.memcpy_dtoh_batch != nullptr) {
+    TF_VALIDATE_NOT_NULL(SP_StreamExecutor, se, memcpy_htod_batch);
+    TF_VALIDATE_NOT_NULL(SP_StreamExecutor, se, memcpy_dtoh_batch);
+  }
+  if (se.allocate_async != nullptr) {
+    TF_VALIDATE_NOT_NULL(SP_StreamExecutor, se, deallocate_async);
+  }
   TF_VALIDATE_NOT_NULL(SP_StreamExecutor, se, sync_memcpy_dtoh);
   TF_VALIDATE_NOT_NULL(SP_StreamExecutor, se, sync_memcpy_htod);
   TF_VALIDATE_NOT_NULL(SP_StreamExecutor, se, block_host_for_event);
@@ -643,6 +651,90 @@ class CStreamExecutor : public internal::StreamExecutorInterface {
         new CTimer(&device_, stream_executor_, timer_fns_));
   }
 
+  bool SupportsMemcpyBatch() const {
+    return stream_executor_->memcpy_htod_batch != nullptr;
+  }
+  port::Status MemcpyHostToDeviceBatch(
+      Stream* stream, absl::Span<DeviceMemoryBase* const> device_dsts,
+      absl::Span<const void* const> host_srcs,
+      absl::Span<const uint64> sizes) {
+    if (!SupportsMemcpyBatch()) {
+      return port::UnimplementedError(
+          "Batched memcpy is not supported by this plugin.");
+    }
+    std::vector<SP_DeviceMemoryBase> device_mem_dsts;
+    device_mem_dsts.reserve(device_dsts.size());
+    for (DeviceMemoryBase* device_dst : device_dsts) {
+      device_mem_dsts.push_back(DeviceMemoryBaseToC(device_dst));
+    }
+    std::vector<uint64_t> c_sizes(sizes.begin(), sizes.end());
+    OwnedTFStatus c_status(TF_NewStatus());
+    SP_Stream stream_handle =
+        static_cast<CStream*>(stream->implementation())->Handle();
+    stream_executor_->memcpy_htod_batch(
+        &device_, stream_handle, device_mem_dsts.data(), host_srcs.data(),
+        c_sizes.data(), c_sizes.size(), c_status.get());
+    return StatusFromTF_Status(c_status.get());
+  }
+  port::Status MemcpyDeviceToHostBatch(
+      Stream* stream, absl::Span<void* const> host_dsts,
+      absl::Span<const DeviceMemoryBase* const> device_srcs,
+      absl::Span<const uint64> sizes) {
+    if (!SupportsMemcpyBatch()) {
+      return port::UnimplementedError(
+          "Batched memcpy is not supported by this plugin.");
+    }
+    std::vector<SP_DeviceMemoryBase> device_mem_srcs;
+    device_mem_srcs.reserve(device_srcs.size());
+    for (const DeviceMemoryBase* device_src : device_srcs) {
+      device_mem_srcs.push_back(DeviceMemoryBaseToC(device_src));
+    }
+    std::vector<uint64_t> c_sizes(sizes.begin(), sizes.end());
+    OwnedTFStatus c_status(TF_NewStatus());
+    SP_Stream stream_handle =
+        static_cast<CStream*>(stream->implementation())->Handle();
+    stream_executor_->memcpy_dtoh_batch(
+        &device_, stream_handle, host_dsts.data(), device_mem_srcs.data(),
+        c_sizes.data(), c_sizes.size(), c_status.get());
+    return StatusFromTF_Status(c_status.get());
+  }
+
+  bool SupportsStreamOrderedAllocation() const {
+    return stream_executor_->allocate_async != nullptr;
+  }
+  port::StatusOr<DeviceMemoryBase> AllocateAsync(Stream* stream,
+                                                 uint64 size) {
+    if (!SupportsStreamOrderedAllocation()) {
+      return port::UnimplementedError(
+          "Stream-ordered allocation is not supported by this plugin.");
+    }
+    SP_DeviceMemoryBase mem = {SP_DEVICE_MEMORY_BASE_STRUCT_SIZE};
+    OwnedTFStatus c_status(TF_NewStatus());
+    SP_Stream stream_handle =
+        static_cast<CStream*>(stream->implementation())->Handle();
+    stream_executor_->allocate_async(&device_, stream_handle, size,
+                                     /*memory_space=*/0, &mem,
+                                     c_status.get());
+    TF_RETURN_IF_ERROR(StatusFromTF_Status(c_status.get()));
+    TF_RETURN_IF_ERROR(ValidateSPDeviceMemoryBase(mem));
+    return DeviceMemoryBaseFromC(mem);
+  }
+  port::Status DeallocateAsync(Stream* stream, DeviceMemoryBase* mem) {
+    if (!SupportsStreamOrderedAllocation()) {
+      return port::UnimplementedError(
+          "Stream-ordered allocation is not supported by this plugin.");
+    }
+    SP_DeviceMemoryBase device_memory_base = DeviceMemoryBaseToC(mem);
+    OwnedTFStatus c_status(TF_NewStatus());
+    SP_Stream stream_handle =
+        static_cast<CStream*>(stream->implementation())->Handle();
+    stream_executor_->deallocate_async(&device_, stream_handle,
+                                       &device_memory_base, c_status.get());
+    TF_RETURN_IF_ERROR(StatusFromTF_Status(c_status.get()));
+    *mem = DeviceMemoryBase();
+    return ::tensorflow::OkStatus();
+  }
+
  private:
   SP_Device device_;
   SP_DeviceFns* device_fns_;
@@ -653,8 +745,72 @@ class CStreamExecutor : public internal::StreamExecutorInterface {
   std::string platform_name_;
   int visible_device_count_;
 };
+
+// Returns the CStreamExecutor backing `executor`, or nullptr if `executor`
+// does not belong to a pluggable device.
+CStreamExecutor* AsCStreamExecutor(StreamExecutor* executor) {
+  return dynamic_cast<CStreamExecutor*>(executor->implementation());
+}
+
+port::Status NotAPluggableDeviceError() {
+  return port::InvalidArgumentError(
+      "Stream does not belong to a pluggable device.");
+}
 }  // namespace
 
+bool SupportsMemcpyBatch(StreamExecutor* executor) {
+  CStreamExecutor* c_executor = AsCStreamExecutor(executor);
+  return c_executor != nullptr && c_executor->SupportsMemcpyBatch();
+}
+
+port::Status MemcpyHostToDeviceBatch(
+    Stream* stream, absl::Span<DeviceMemoryBase* const> device_dsts,
+    absl::Span<const void* const> host_srcs, absl::Span<const uint64> sizes) {
+  if (device_dsts.size() != host_srcs.size() ||
+      device_dsts.size() != sizes.size()) {
+    return port::InvalidArgumentError(
+        "Mismatched number of batched memcpy destinations, sources and "
+        "sizes.");
+  }
+  CStreamExecutor* c_executor = AsCStreamExecutor(stream->parent());
+  if (c_executor == nullptr) return NotAPluggableDeviceError();
+  return c_executor->MemcpyHostToDeviceBatch(stream, device_dsts, host_srcs,
+                                             sizes);
+}
+
+port::Status MemcpyDeviceToHostBatch(
+    Stream* stream, absl::Span<void* const> host_dsts,
+    absl::Span<const DeviceMemoryBase* const> device_srcs,
+    absl::Span<const uint64> sizes) {
+  if (host_dsts.size() != device_srcs.size() ||
+      host_dsts.size() != sizes.size()) {
+    return port::InvalidArgumentError(
+        "Mismatched number of batched memcpy destinations, sources and "
+        "sizes.");
+  }
+  CStreamExecutor* c_executor = AsCStreamExecutor(stream->parent());
+  if (c_executor == nullptr) return NotAPluggableDeviceError();
+  return c_executor->MemcpyDeviceToHostBatch(stream, host_dsts, device_srcs,
+                                             sizes);
+}
+
+bool SupportsStreamOrderedAllocation(StreamExecutor* executor) {
+  CStreamExecutor* c_executor = AsCStreamExecutor(executor);
+  return c_executor != nullptr && c_executor->SupportsStreamOrderedAllocation();
+}
+
+port::StatusOr<DeviceMemoryBase> AllocateAsync(Stream* stream, uint64 size) {
+  CStreamExecutor* c_executor = AsCStreamExecutor(stream->parent());
+  if (c_executor == nullptr) return NotAPluggableDeviceError();
+  return c_executor->AllocateAsync(stream, size);
+}
+
+port::Status DeallocateAsync(Stream* stream, DeviceMemoryBase* mem) {
+  CStreamExecutor* c_executor = AsCStreamExecutor(stream->parent());
+  if (c_executor == nullptr) return NotAPluggableDeviceError();
+  return c_executor->DeallocateAsync(stream, mem);
+}
+
 CPlatform::CPlatform(SP_Platform platform,
                      void (*destroy_platform)(SP_Platform*),
                      SP_PlatformFns platform_fns,
@@ -412,10 +412,52 @@ typedef struct SP_StreamExecutor {
   // `callback_arg` should be passed as the first argument to `callback_fn`.
   TF_Bool (*host_callback)(const SP_Device* device, SP_Stream stream,
                            SE_StatusCallbackFn callback_fn, void* callback_arg);
+
+  /*** BATCHED MEMCPY CALLBACKS ***/
+  // [Optional]
+  // Enqueues `num_copies` memcpy operations onto stream, where copy `i` copies
+  // `sizes[i]` bytes from the host location `host_srcs[i]` to
+  // `device_dsts[i]`. Lets the plugin submit many small copies at once.
+  // If set, `memcpy_dtoh_batch` must be set as well. If not set, copies are
+  // enqueued one at a time with `memcpy_htod`.
+  void (*memcpy_htod_batch)(const SP_Device* device, SP_Stream stream,
+                            SP_DeviceMemoryBase* device_dsts,
+                            const void* const* host_srcs,
+                            const uint64_t* sizes, size_t num_copies,
+                            TF_Status* status);
+
+  // [Optional]
+  // Enqueues `num_copies` memcpy operations onto stream, where copy `i` copies
+  // `sizes[i]` bytes from `device_srcs[i]` to the host location
+  // `host_dsts[i]`. If set, `memcpy_htod_batch` must be set as well.
+  void (*memcpy_dtoh_batch)(const SP_Device* device, SP_Stream stream,
+                            void* const* host_dsts,
+                            const SP_DeviceMemoryBase* device_srcs,
+                            const uint64_t* sizes, size_t num_copies,
+                            TF_Status* status);
+
+  /*** STREAM-ORDERED ALLOCATION CALLBACKS ***/
+  // [Optional]
+  // Allocates `size` bytes in stream order: the memory may be used by work
+  // enqueued onto `stream` after this call, and may reuse memory freed by
+  // `deallocate_async` on the same stream without synchronizing the host. In
+  // the case of failure, sets `status` and leaves `mem` empty.
+  // `memory_space` is reserved for a potential future usage and should be set
+  // to 0. If set, `deallocate_async` must be set as well.
+  void (*allocate_async)(const SP_Device* device, SP_Stream stream,
+                         uint64_t size, int64_t memory_space,
+                         SP_DeviceMemoryBase* mem, TF_Status* status);
+
+  // [Optional]
+  // Deallocates memory allocated by `allocate_async` once the work enqueued
+  // onto `stream` before this call has completed. Must be set if
+  // `allocate_async` is set.
+  void (*deallocate_async)(const SP_Device* device, SP_Stream stream,
+                           SP_DeviceMemoryBase* memory, TF_Status* status);
 } SP_StreamExecutor;
 
 #define SP_STREAMEXECUTOR_STRUCT_SIZE \
-  TF_OFFSET_OF_END(SP_StreamExecutor, host_callback)
+  TF_OFFSET_OF_END(SP_StreamExecutor, deallocate_async)
 
 typedef struct SE_CreateStreamExecutorParams {
   size_t struct_size;
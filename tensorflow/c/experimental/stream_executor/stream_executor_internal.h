@@ -19,9 +19,12 @@ limitations under the License.
 #define TENSORFLOW_C_EXPERIMENTAL_STREAM_EXECUTOR_STREAM_EXECUTOR_INTERNAL_H_
 
 #include "tensorflow/c/experimental/stream_executor/stream_executor.h"
+#include "absl/types/span.h"
 #include "tensorflow/c/tf_status_helper.h"
+#include "tensorflow/stream_executor/device_memory.h"
 #include "tensorflow/stream_executor/executor_cache.h"
 #include "tensorflow/stream_executor/lib/status.h"
+#include "tensorflow/stream_executor/lib/statusor.h"
 #include "tensorflow/stream_executor/platform.h"
 
 namespace stream_executor {
@@ -43,6 +46,38 @@ port::Status InitStreamExecutorPlugin(SEInitPluginFn init_fn,
                                       std::string* device_type,
                                       std::string* platform_name);
 
+// Returns true if `executor` belongs to a pluggable device whose plugin
+// implements the batched memcpy callbacks.
+bool SupportsMemcpyBatch(StreamExecutor* executor);
+
+// Enqueues the copies `host_srcs[i]` -> `device_dsts[i]` of `sizes[i]` bytes
+// onto `stream` with a single call into the plugin. Returns Unimplemented if
+// the plugin does not support batched memcpy.
+port::Status MemcpyHostToDeviceBatch(
+    Stream* stream, absl::Span<DeviceMemoryBase* const> device_dsts,
+    absl::Span<const void* const> host_srcs, absl::Span<const uint64> sizes);
+
+// Enqueues the copies `device_srcs[i]` -> `host_dsts[i]` of `sizes[i]` bytes
+// onto `stream` with a single call into the plugin. Returns Unimplemented if
+// the plugin does not support batched memcpy.
+port::Status MemcpyDeviceToHostBatch(
+    Stream* stream, absl::Span<void* const> host_dsts,
+    absl::Span<const DeviceMemoryBase* const> device_srcs,
+    absl::Span<const uint64> sizes);
+
+// Returns true if `executor` belongs to a pluggable device whose plugin
+// implements stream-ordered allocation.
+bool SupportsStreamOrderedAllocation(StreamExecutor* executor);
+
+// Allocates `size` bytes ordered with respect to the work on `stream`.
+// Returns Unimplemented if the plugin does not support stream-ordered
+// allocation.
+port::StatusOr<DeviceMemoryBase> AllocateAsync(Stream* stream, uint64 size);
+
+// Frees `mem` once the work enqueued onto `stream` so far has completed, and
+// resets `mem`.
+port::Status DeallocateAsync(Stream* stream, DeviceMemoryBase* mem);
+
 // This file implements core stream executor base classes in terms of
 // the C API defined in stream_executor.h. A class "CSomething" represents a
 // "Something" that can be manipulated via calls in the C interface.
@@ -71,6 +106,9 @@ class CPlatform : public Platform {
   }
   bool UseBfcAllocator() const { return platform_.use_bfc_allocator; }
   bool ForceMemoryGrowth() const { return platform_.force_memory_growth; }
+  bool SupportsStreamOrderedAllocation() const {
+    return stream_executor_.allocate_async != nullptr;
+  }
   port::StatusOr<std::unique_ptr<DeviceDescription>> DescriptionForDevice(
       int ordinal) const override;
   port::StatusOr<StreamExecutor*> ExecutorForDevice(int ordinal) override;
@@ -132,6 +132,32 @@ TEST(StreamExecutor, UnifiedMemoryAllocateNotSet) {
       "'unified_memory_allocate' field in SP_StreamExecutor must be set.");
 }
 
+TEST(StreamExecutor, MemcpyDeviceToHostBatchNotSet) {
+  auto plugin_init = [](SE_PlatformRegistrationParams* const params,
+                        TF_Status* const status) -> void {
+    TF_SetStatus(status, TF_OK, "");
+    test_util::PopulateDefaultPlatformRegistrationParams(params);
+    params->platform_fns->create_stream_executor =
+        [](const SP_Platform* platform,
+           SE_CreateStreamExecutorParams* se_params, TF_Status* status) {
+          TF_SetStatus(status, TF_OK, "");
+          test_util::PopulateDefaultStreamExecutor(se_params->stream_executor);
+          se_params->stream_executor->memcpy_htod_batch =
+              [](const SP_Device* device, SP_Stream stream,
+                 SP_DeviceMemoryBase* device_dsts,
+                 const void* const* host_srcs, const uint64_t* sizes,
+                 size_t num_copies, TF_Status* status) {};
+        };
+  };
+
+  std::string device_type, platform_name;
+  port::Status status =
+      InitStreamExecutorPlugin(plugin_init, &device_type, &platform_name);
+  ASSERT_EQ(status.code(), tensorflow::error::FAILED_PRECONDITION);
+  ASSERT_EQ(status.error_message(),
+            "'memcpy_dtoh_batch' field in SP_StreamExecutor must be set.");
+}
+
 /*** StreamExecutor behavior tests ***/
 class StreamExecutorTest : public ::testing::Test {
  protected:
@@ -593,6 +619,115 @@ TEST_F(StreamExecutorTest, MemcpyDeviceToDevice) {
   ASSERT_EQ(dst_data, 18);
 }
 
+TEST_F(StreamExecutorTest, MemcpyBatch) {
+  se_.memcpy_htod_batch = [](const SP_Device* const device, SP_Stream stream,
+                             SP_DeviceMemoryBase* device_dsts,
+                             const void* const* host_srcs,
+                             const uint64_t* sizes, size_t num_copies,
+                             TF_Status* const status) {
+    TF_SetStatus(status, TF_OK, "");
+    for (size_t i = 0; i < num_copies; ++i) {
+      std::memcpy(device_dsts[i].opaque, host_srcs[i], sizes[i]);
+    }
+  };
+  se_.memcpy_dtoh_batch = [](const SP_Device* const device, SP_Stream stream,
+                             void* const* host_dsts,
+                             const SP_DeviceMemoryBase* device_srcs,
+                             const uint64_t* sizes, size_t num_copies,
+                             TF_Status* const status) {
+    TF_SetStatus(status, TF_OK, "");
+    for (size_t i = 0; i < num_copies; ++i) {
+      std::memcpy(host_dsts[i], device_srcs[i].opaque, sizes[i]);
+    }
+  };
+
+  StreamExecutor* executor = GetExecutor(0);
+  ASSERT_TRUE(SupportsMemcpyBatch(executor));
+  Stream stream(executor);
+  stream.Init();
+  int src_data[2] = {18, 19};
+  int device_data[2] = {0, 0};
+  int dst_data[2] = {0, 0};
+  DeviceMemoryBase device_mem0(&device_data[0], sizeof(int));
+  DeviceMemoryBase device_mem1(&device_data[1], sizeof(int));
+  const uint64 sizes[] = {sizeof(int), sizeof(int)};
+  DeviceMemoryBase* device_dsts[] = {&device_mem0, &device_mem1};
+  const void* host_srcs[] = {&src_data[0], &src_data[1]};
+  TF_ASSERT_OK(
+      MemcpyHostToDeviceBatch(&stream, device_dsts, host_srcs, sizes));
+  EXPECT_EQ(device_data[0], 18);
+  EXPECT_EQ(device_data[1], 19);
+
+  const DeviceMemoryBase* device_srcs[] = {&device_mem1, &device_mem0};
+  void* host_dsts[] = {&dst_data[0], &dst_data[1]};
+  TF_ASSERT_OK(
+      MemcpyDeviceToHostBatch(&stream, host_dsts, device_srcs, sizes));
+  EXPECT_EQ(dst_data[0], 19);
+  EXPECT_EQ(dst_data[1], 18);
+
+  // The number of sources, destinations and sizes must match.
+  EXPECT_EQ(MemcpyHostToDeviceBatch(&stream, device_dsts, host_srcs,
+                                    absl::MakeSpan(sizes, 1))
+                .code(),
+            tensorflow::error::INVALID_ARGUMENT);
+}
+
+TEST_F(StreamExecutorTest, MemcpyBatchNotSupported) {
+  StreamExecutor* executor = GetExecutor(0);
+  EXPECT_FALSE(SupportsMemcpyBatch(executor));
+  Stream stream(executor);
+  stream.Init();
+  int src_data = 18;
+  int dst_data = 0;
+  DeviceMemoryBase device_mem(&dst_data, sizeof(int));
+  const uint64 sizes[] = {sizeof(int)};
+  DeviceMemoryBase* device_dsts[] = {&device_mem};
+  const void* host_srcs[] = {&src_data};
+  EXPECT_EQ(
+      MemcpyHostToDeviceBatch(&stream, device_dsts, host_srcs, sizes).code(),
+      tensorflow::error::UNIMPLEMENTED);
+}
+
+TEST_F(StreamExecutorTest, AllocateAsync) {
+  se_.create_stream = [](const SP_Device* const device, SP_Stream* stream,
+                         TF_Status* const status) -> void {
+    *stream = new SP_Stream_st(14);
+  };
+  se_.destroy_stream = [](const SP_Device* const device,
+                          SP_Stream stream) -> void { delete stream; };
+  se_.allocate_async = [](const SP_Device* const device, SP_Stream stream,
+                          uint64_t size, int64_t memory_space,
+                          SP_DeviceMemoryBase* const mem,
+                          TF_Status* const status) {
+    TF_SetStatus(status, TF_OK, "");
+    EXPECT_EQ(stream->stream_id, 14);
+    mem->struct_size = SP_DEVICE_MEMORY_BASE_STRUCT_SIZE;
+    mem->opaque = malloc(size);
+    mem->size = size;
+  };
+  se_.deallocate_async = [](const SP_Device* const device, SP_Stream stream,
+                            SP_DeviceMemoryBase* const mem,
+                            TF_Status* const status) {
+    TF_SetStatus(status, TF_OK, "");
+    EXPECT_EQ(stream->stream_id, 14);
+    EXPECT_EQ(mem->size, 2 * sizeof(int));
+    free(mem->opaque);
+  };
+
+  StreamExecutor* executor = GetExecutor(0);
+  ASSERT_TRUE(SupportsStreamOrderedAllocation(executor));
+  ASSERT_TRUE(cplatform_->SupportsStreamOrderedAllocation());
+  Stream stream(executor);
+  stream.Init();
+  port::StatusOr<DeviceMemoryBase> mem =
+      AllocateAsync(&stream, 2 * sizeof(int));
+  TF_ASSERT_OK(mem.status());
+  ASSERT_NE(mem->opaque(), nullptr);
+  ASSERT_EQ(mem->size(), 2 * sizeof(int));
+  TF_ASSERT_OK(DeallocateAsync(&stream, &mem.ValueOrDie()));
+  EXPECT_TRUE(mem->is_null());
+}
+
 TEST_F(StreamExecutorTest, SyncMemcpyToHost) {
   se_.sync_memcpy_dtoh = [](const SP_Device* const device, void* host_dst,
                             const SP_DeviceMemoryBase* const device_src,
@@ -15,7 +15,13 @@ limitations under the License.
 
 #include "tensorflow/cc/saved_model/loader.h"
 
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <memory>
 #include <unordered_set>
+#include <utility>
+#include <vector>
 
 #include "tensorflow/cc/saved_model/constants.h"
 #include "tensorflow/cc/saved_model/loader_util.h"
@@ -26,7 +32,10 @@ limitations under the License.
 #include "tensorflow/core/framework/function.pb.h"
 #include "tensorflow/core/framework/node_def.pb.h"
 #include "tensorflow/core/framework/op_def.pb.h"
+#include "tensorflow/core/framework/tensor.h"
 #include "tensorflow/core/framework/tensor.pb.h"
+#include "tensorflow/core/framework/tensor_shape.h"
+#include "tensorflow/core/framework/types.h"
 #include "tensorflow/core/lib/io/path.h"
 #include "tensorflow/core/lib/monitoring/counter.h"
 #include "tensorflow/core/lib/monitoring/sampler.h"
@@ -36,11 +45,13 @@ limitations under the License.
 #include "tensorflow/core/platform/errors.h"
 #include "tensorflow/core/platform/file_system_helper.h"
 #include "tensorflow/core/platform/statusor.h"
+#include "tensorflow/core/platform/threadpool.h"
 #include "tensorflow/core/protobuf/graph_debug_info.pb.h"
 #include "tensorflow/core/protobuf/meta_graph.pb.h"
 #include "tensorflow/core/protobuf/saver.pb.h"
 #include "tensorflow/core/public/session.h"
 #include "tensorflow/core/public/session_options.h"
+#include "tensorflow/core/util/env_var.h"
 #include "tensorflow/core/util/tensor_bundle/naming.h"
 
 namespace tensorflow {
@@ -221,6 +232,57 @@ Status RunInitOp(const RunOptions& run_options, const string& export_dir,
   return OkStatus();
 }
 
+// Reads the variables data files of a SavedModel on a thread pool, so that
+// the restore op finds them in the file system cache.  Started before the
+// MetaGraph is read and the session is created, which overlaps the restore
+// I/O with those stages and with the graph optimization of the restore run.
+// Read errors are ignored; the restore op reports them.
+class VariablesPrefetcher {
+ public:
+  explicit VariablesPrefetcher(const string& export_dir)
+      : pool_(Env::Default(), "saved_model_prefetch", kNumThreads) {
+    const string pattern =
+        strings::StrCat(io::JoinPath(export_dir, kSavedModelVariablesDirectory,
+                                     kSavedModelVariablesFilename),
+                        ".data-*");
+    std::vector<string> filenames;
+    if (!Env::Default()->GetMatchingPaths(pattern, &filenames).ok()) return;
+    for (const string& filename : filenames) {
+      std::shared_ptr<RandomAccessFile> file;
+      uint64 size;
+      {
+        std::unique_ptr<RandomAccessFile> f;
+        if (!Env::Default()->NewRandomAccessFile(filename, &f).ok() ||
+            !Env::Default()->GetFileSize(filename, &size).ok()) {
+          continue;
+        }
+        file = std::move(f);
+      }
+      for (uint64 offset = 0; offset < size; offset += kChunkBytes) {
+        const size_t n = std::min<uint64>(kChunkBytes, size - offset);
+        pool_.Schedule([this, file, offset, n]() {
+          if (cancelled_) return;
+          std::unique_ptr<char[]> scratch(new char[n]);
+          StringPiece data;
+          file->Read(offset, n, &data, scratch.get()).IgnoreError();
+        });
+      }
+    }
+  }
+
+  // Skips the remaining reads and waits for the ones in flight.
+  ~VariablesPrefetcher() { cancelled_ = true; }
+
+ private:
+  static constexpr int kNumThreads = 4;
+  static constexpr uint64 kChunkBytes = 16 << 20;
+
+  std::atomic<bool> cancelled_{false};
+  // Declared last, so that it waits for the reads before the other members
+  // are destroyed.
+  thread::ThreadPool pool_;
+};
+
 Status RunRestore(const RunOptions& run_options, const string& export_dir,
                   const StringPiece restore_op_name,
                   const StringPiece variable_filename_const_op_name,
@@ -261,10 +323,82 @@ Status RunRestore(const RunOptions& run_options, const string& export_dir,
                  nullptr /* outputs */, &run_metadata, session);
 }
 
+// Fills `inputs` with zero-valued tensors for the inputs of `signature`, with
+// unknown dimensions (typically the batch dimension) set to 1. Returns false
+// if an input is not a dense tensor, has a dtype that cannot be zero-filled or
+// has unknown rank.
+bool MakeWarmUpInputs(const SignatureDef& signature,
+                      std::vector<std::pair<string, Tensor>>* inputs) {
+  for (const auto& input : signature.inputs()) {
+    const TensorInfo& info = input.second;
+    if (info.encoding_case() != TensorInfo::kName ||
+        !DataTypeCanUseMemcpy(info.dtype())) {
+      return false;
+    }
+    PartialTensorShape shape(info.tensor_shape());
+    if (shape.unknown_rank()) return false;
+    TensorShape fully_defined_shape;
+    for (int64_t dim : shape.dim_sizes()) {
+      fully_defined_shape.AddDim(dim < 0 ? 1 : dim);
+    }
+    Tensor tensor(info.dtype(), fully_defined_shape);
+    if (tensor.TotalBytes() > 0) {
+      std::memset(tensor.data(), 0, tensor.TotalBytes());
+    }
+    inputs->emplace_back(info.name(), std::move(tensor));
+  }
+  return true;
+}
+
 }  // namespace
 
 SavedModelBundleInterface::~SavedModelBundleInterface() {}
 
+Status WarmUpSignatures(const RunOptions& run_options,
+                        const SavedModelBundleInterface& bundle,
+                        std::vector<string>* warmed_up_signatures) {
+  // Visit the signatures in a deterministic order.
+  std::vector<string> signature_names;
+  for (const auto& signature : bundle.GetSignatures()) {
+    signature_names.push_back(signature.first);
+  }
+  std::sort(signature_names.begin(), signature_names.end());
+
+  for (const string& signature_name : signature_names) {
+    const SignatureDef& signature = bundle.GetSignatures().at(signature_name);
+    std::vector<std::pair<string, Tensor>> inputs;
+    if (!MakeWarmUpInputs(signature, &inputs)) {
+      VLOG(1) << "Not warming up signature " << signature_name
+              << ", whose inputs are not all dense tensors of known rank.";
+      continue;
+    }
+    std::vector<string> output_names;
+    for (const auto& output : signature.outputs()) {
+      if (output.second.encoding_case() == TensorInfo::kName) {
+        output_names.push_back(output.second.name());
+      }
+    }
+    if (output_names.empty()) continue;
+
+    std::vector<Tensor> outputs;
+    RunMetadata run_metadata;
+    const Status status =
+        bundle.GetSession()->Run(run_options, inputs, output_names, {},
+                                 &outputs, &run_metadata);
+    if (!status.ok()) {
+      // Zero inputs are not valid for every model, so a failed warm-up does
+      // not fail the caller.
+      LOG(WARNING) << "Warm-up of signature " << signature_name
+                   << " failed: " << status;
+      continue;
+    }
+    if (warmed_up_signatures != nullptr) {
+      warmed_up_signatures->push_back(signature_name);
+    }
+  }
+  return OkStatus();
+}
+
 Status LoadMetagraphIntoSession(const SessionOptions& session_options,
                                 const MetaGraphDef& meta_graph,
                                 std::unique_ptr<Session>* session) {
@@ -280,14 +414,44 @@ Status LoadSavedModelInternal(const SessionOptions& session_options,
                               const string& export_dir,
                               const std::unordered_set<string>& tags,
                               SavedModelBundle* const bundle) {
+  // If TF_SAVED_MODEL_PREFETCH_VARIABLES is true, the variables are read
+  // into the file system cache while the stages before the restore run.
+  bool prefetch_variables;
+  TF_RETURN_IF_ERROR(ReadBoolFromEnvVar("TF_SAVED_MODEL_PREFETCH_VARIABLES",
+                                        false, &prefetch_variables));
+  std::unique_ptr<VariablesPrefetcher> prefetcher;
+  if (prefetch_variables) {
+    prefetcher = std::make_unique<VariablesPrefetcher>(export_dir);
+  }
+
+  const uint64 read_start_microseconds = Env::Default()->NowMicros();
   TF_RETURN_IF_ERROR(ReadMetaGraphDefFromSavedModel(export_dir, tags,
                                                     &bundle->meta_graph_def));
   TF_RETURN_IF_ERROR(
       ReadSavedModelDebugInfoIfPresent(export_dir, &bundle->debug_info));
+  load_latency_by_stage->GetCell(export_dir, "read_meta_graph")
+      ->Add(GetLatencyMicroseconds(read_start_microseconds));
+
+  const uint64 session_start_microseconds = Env::Default()->NowMicros();
   TF_RETURN_IF_ERROR(LoadMetagraphIntoSession(
       session_options, bundle->meta_graph_def, &bundle->session));
+  load_latency_by_stage->GetCell(export_dir, "create_session")
+      ->Add(GetLatencyMicroseconds(session_start_microseconds));
+
   TF_RETURN_IF_ERROR(RestoreSession(run_options, bundle->meta_graph_def,
                                     export_dir, &bundle->session));
+
+  // If TF_SAVED_MODEL_WARMUP_SIGNATURES is true, the signatures are run once
+  // before the first request; see WarmUpSignatures().
+  bool warm_up_signatures;
+  TF_RETURN_IF_ERROR(ReadBoolFromEnvVar("TF_SAVED_MODEL_WARMUP_SIGNATURES",
+                                        false, &warm_up_signatures));
+  if (warm_up_signatures) {
+    const uint64 warm_up_start_microseconds = Env::Default()->NowMicros();
+    TF_RETURN_IF_ERROR(WarmUpSignatures(run_options, *bundle));
+    load_latency_by_stage->GetCell(export_dir, "warm_up")
+        ->Add(GetLatencyMicroseconds(warm_up_start_microseconds));
+  }
   return OkStatus();
 }
 
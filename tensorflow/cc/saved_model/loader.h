@@ -20,6 +20,7 @@ limitations under the License.
 
 #include <string>
 #include <unordered_set>
+#include <vector>
 
 #include "tensorflow/core/lib/core/status.h"
 #include "tensorflow/core/protobuf/graph_debug_info.pb.h"
@@ -142,6 +143,21 @@ Status LoadSavedModel(const SessionOptions& session_options,
 /// no guarantee that it can be loaded.
 bool MaybeSavedModelDirectory(const std::string& export_dir);
 
+/// Runs each signature of `bundle` once on zero-valued inputs, so that kernels
+/// that build per-shape state on their first run, such as the oneDNN
+/// primitives of the MKL kernels, do so at load time rather than on the first
+/// request. Only signatures whose inputs are all dense numeric tensors of
+/// known rank are run, with unknown dimensions set to 1. Warm-up is
+/// best-effort: a signature that fails to run is logged and skipped. The
+/// names of the signatures that ran are appended to `warmed_up_signatures`,
+/// if not null.
+///
+/// LoadSavedModel calls this when the TF_SAVED_MODEL_WARMUP_SIGNATURES
+/// environment variable is true.
+Status WarmUpSignatures(const RunOptions& run_options,
+                        const SavedModelBundleInterface& bundle,
+                        std::vector<string>* warmed_up_signatures = nullptr);
+
 }  // namespace tensorflow
 
 #endif  // TENSORFLOW_CC_SAVED_MODEL_LOADER_H_
@@ -137,6 +137,54 @@ TEST_F(LoaderTest, TagMatch) {
   CheckSavedModelBundle(export_dir, bundle);
 }
 
+TEST_F(LoaderTest, PrefetchVariables) {
+  setenv("TF_SAVED_MODEL_PREFETCH_VARIABLES", "true", 1);
+  SavedModelBundle bundle;
+  SessionOptions session_options;
+  RunOptions run_options;
+
+  const string export_dir =
+      io::JoinPath(testing::TensorFlowSrcRoot(), kTestDataSharded);
+  TF_ASSERT_OK(LoadSavedModel(session_options, run_options, export_dir,
+                              {kSavedModelTagServe}, &bundle));
+  CheckSavedModelBundle(export_dir, bundle);
+  unsetenv("TF_SAVED_MODEL_PREFETCH_VARIABLES");
+}
+
+TEST_F(LoaderTest, WarmUpSignatures) {
+  SavedModelBundle bundle;
+  SessionOptions session_options;
+  RunOptions run_options;
+
+  const string export_dir =
+      io::JoinPath(testing::TensorFlowSrcRoot(), kTestDataSharded);
+  TF_ASSERT_OK(LoadSavedModel(session_options, run_options, export_dir,
+                              {kSavedModelTagServe}, &bundle));
+  std::vector<string> warmed_up_signatures;
+  TF_ASSERT_OK(WarmUpSignatures(run_options, bundle, &warmed_up_signatures));
+  // The signatures taking float tensors run; those taking serialized
+  // tf.Examples of unknown rank do not.
+  EXPECT_THAT(warmed_up_signatures,
+              ::testing::Contains("regress_x2_to_y3"));
+  EXPECT_THAT(warmed_up_signatures,
+              ::testing::Not(::testing::Contains("regress_x_to_y")));
+  CheckSavedModelBundle(export_dir, bundle);
+}
+
+TEST_F(LoaderTest, WarmUpSignaturesOnLoad) {
+  setenv("TF_SAVED_MODEL_WARMUP_SIGNATURES", "true", 1);
+  SavedModelBundle bundle;
+  SessionOptions session_options;
+  RunOptions run_options;
+
+  const string export_dir =
+      io::JoinPath(testing::TensorFlowSrcRoot(), kTestDataSharded);
+  TF_ASSERT_OK(LoadSavedModel(session_options, run_options, export_dir,
+                              {kSavedModelTagServe}, &bundle));
+  CheckSavedModelBundle(export_dir, bundle);
+  unsetenv("TF_SAVED_MODEL_WARMUP_SIGNATURES");
+}
+
 TEST_F(LoaderTest, ReadMetaGraphFromSavedModel) {
   SavedModelBundle bundle;
   SessionOptions session_options;
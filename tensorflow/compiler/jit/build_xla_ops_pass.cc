@@ -15,9 +15,14 @@ limitations under the License.
 
 #include "tensorflow/compiler/jit/build_xla_ops_pass.h"
 
+#include <optional>
+
 #include "absl/algorithm/container.h"
+#include "absl/container/flat_hash_set.h"
+#include "absl/strings/numbers.h"
 #include "absl/strings/str_cat.h"
 #include "absl/strings/str_join.h"
+#include "absl/strings/str_split.h"
 #include "tensorflow/cc/framework/ops.h"
 #include "tensorflow/cc/framework/scope_internal.h"
 #include "tensorflow/cc/ops/array_ops.h"
@@ -25,15 +30,18 @@ limitations under the License.
 #include "tensorflow/cc/ops/control_flow_ops.h"
 #include "tensorflow/cc/ops/functional_ops.h"
 #include "tensorflow/cc/ops/logging_ops.h"
+#include "tensorflow/cc/ops/math_ops.h"
 #include "tensorflow/compiler/jit/defs.h"
 #include "tensorflow/compiler/jit/device_util.h"
 #include "tensorflow/compiler/jit/encapsulate_subgraphs_pass.h"
 #include "tensorflow/compiler/jit/flags.h"
+#include "tensorflow/compiler/jit/shape_inference.h"
 #include "tensorflow/compiler/jit/xla_cluster_util.h"
 #include "tensorflow/compiler/tf2xla/cc/ops/xla_jit_ops.h"
 #include "tensorflow/compiler/tf2xla/xla_op_registry.h"
 #include "tensorflow/compiler/xla/status_macros.h"
 #include "tensorflow/core/common_runtime/function.h"
+#include "tensorflow/core/common_runtime/function_def_utils.h"
 #include "tensorflow/core/common_runtime/graph_constructor.h"
 #include "tensorflow/core/common_runtime/optimization_registry.h"
 #include "tensorflow/core/framework/graph_def_util.h"
@@ -45,6 +53,7 @@ limitations under the License.
 #include "tensorflow/core/lib/core/status.h"
 #include "tensorflow/core/lib/hash/hash.h"
 #include "tensorflow/core/public/version.h"
+#include "tensorflow/core/util/device_name_utils.h"
 #include "tensorflow/core/util/dump_graph.h"
 
 namespace tensorflow {
@@ -463,11 +472,256 @@ Status PredicateInt32Inputs(const Scope& root, Node* n,
   return OkStatus();
 }
 
+// Parses the --tf_xla_batch_buckets flag.
+StatusOr<std::vector<int32>> ParseBatchBuckets(absl::string_view spec) {
+  std::vector<int32> buckets;
+  if (spec.empty()) return buckets;
+  if (spec == "pow2") {
+    for (int shift = 0; shift <= 30; ++shift) buckets.push_back(1 << shift);
+    return buckets;
+  }
+  for (absl::string_view bucket_str : absl::StrSplit(spec, ',')) {
+    int32 bucket;
+    if (!absl::SimpleAtoi(bucket_str, &bucket) || bucket <= 0 ||
+        (!buckets.empty() && bucket <= buckets.back())) {
+      return errors::InvalidArgument(
+          "Invalid --tf_xla_batch_buckets: \"", spec,
+          "\". Expected \"pow2\" or increasing positive integers.");
+    }
+    buckets.push_back(bucket);
+  }
+  return buckets;
+}
+
+// Returns true if every row of the outputs of `fdef` only depends on the same
+// row of its batched inputs, so that padding the batch dimension of the inputs
+// only adds rows to the outputs.
+bool IsBatchParallelFunction(const FunctionDef& fdef) {
+  static const auto* const kRowwiseOps = new absl::flat_hash_set<std::string>(
+      {"Abs",        "Add",       "AddV2",   "BiasAdd",
+       "Cast",       "Ceil",      "Const",   "Cos",
+       "Div",        "Elu",       "Erf",     "Exp",
+       "Floor",      "Identity",  "LeakyRelu", "Log",
+       "Log1p",      "Maximum",   "Minimum", "Mul",
+       "Neg",        "Pow",       "RealDiv", "Reciprocal",
+       "Relu",       "Relu6",     "Round",   "Rsqrt",
+       "Selu",       "Sigmoid",   "Sign",    "Sin",
+       "Softplus",   "Sqrt",      "Square",  "SquaredDifference",
+       "Sub",        "Tanh"});
+  for (const NodeDef& node : fdef.node_def()) {
+    if (node.op() == "MatMul") {
+      // Only the rows of the first operand are independent.
+      auto it = node.attr().find("transpose_a");
+      if (it != node.attr().end() && it->second.b()) return false;
+      continue;
+    }
+    if (node.op() == "Conv2D") {
+      auto it = node.attr().find("data_format");
+      if (it != node.attr().end() && it->second.s() != "NHWC" &&
+          it->second.s() != "NCHW") {
+        return false;
+      }
+      continue;
+    }
+    if (!kRowwiseOps->contains(node.op())) return false;
+  }
+  return true;
+}
+
+// The inputs and outputs of a cluster whose leading dimension is the batch
+// dimension, with their ranks.
+struct BatchedClusterSignature {
+  std::vector<std::pair<int, int>> non_constant_inputs;
+  std::vector<std::pair<int, int>> outputs;
+};
+
+// Returns the batched inputs and outputs of the cluster `n` if it can be
+// padded, i.e. if its function is batch-parallel and some of its inputs have
+// an unknown leading dimension.
+StatusOr<std::optional<BatchedClusterSignature>> GetBatchedClusterSignature(
+    const FunctionLibraryDefinition& flib_def, const GraphShapeInfo& shape_info,
+    const XlaClusterInfo& cluster_info) {
+  const std::optional<BatchedClusterSignature> kNotBatched;
+  const FunctionDef* fdef = flib_def.Find(cluster_info.function.name());
+  if (fdef == nullptr || !IsBatchParallelFunction(*fdef)) {
+    return kNotBatched;
+  }
+
+  auto get_shape = [&](const Output& output) -> const PartialTensorShape* {
+    auto it = shape_info.find(output.node()->name());
+    if (it == shape_info.end() || output.index() >= it->second.size()) {
+      return nullptr;
+    }
+    return &it->second[output.index()].shape;
+  };
+  auto is_batched = [](const PartialTensorShape& shape) {
+    return !shape.unknown_rank() && shape.dims() >= 1 && shape.dim_size(0) < 0;
+  };
+
+  BatchedClusterSignature signature;
+  std::map<int, InferredShape> arg_shapes;
+  const int num_constant_inputs = cluster_info.constant_inputs.size();
+  for (int i = 0; i < cluster_info.constant_inputs.size(); ++i) {
+    const PartialTensorShape* shape =
+        get_shape(cluster_info.constant_inputs[i]);
+    if (shape != nullptr) arg_shapes[i].shape = *shape;
+  }
+  for (int i = 0; i < cluster_info.non_constant_inputs.size(); ++i) {
+    const Output& input = cluster_info.non_constant_inputs[i];
+    const PartialTensorShape* shape = get_shape(input);
+    if (shape == nullptr) continue;
+    arg_shapes[num_constant_inputs + i].shape = *shape;
+    if (is_batched(*shape)) {
+      signature.non_constant_inputs.emplace_back(i, shape->dims());
+    }
+  }
+  if (signature.non_constant_inputs.empty()) return kNotBatched;
+
+  std::unique_ptr<FunctionBody> fbody;
+  TF_RETURN_IF_ERROR(FunctionDefToBodyHelper(
+      *fdef, AttrSlice(&cluster_info.function.attr()), &flib_def, &fbody));
+  GraphShapeInfo body_shape_info;
+  TF_RETURN_IF_ERROR(InferShapes(fbody->graph, arg_shapes, &flib_def,
+                                 &body_shape_info));
+  for (int i = 0; i < fbody->ret_nodes.size(); ++i) {
+    const Edge* edge;
+    TF_RETURN_IF_ERROR(fbody->ret_nodes[i]->input_edge(0, &edge));
+    auto it = body_shape_info.find(edge->src()->name());
+    if (it == body_shape_info.end() ||
+        edge->src_output() >= it->second.size()) {
+      return kNotBatched;
+    }
+    const PartialTensorShape& output_shape =
+        it->second[edge->src_output()].shape;
+    // A batch-parallel function has outputs of unknown rank only if it has
+    // inputs of unknown rank; bail out as we cannot slice them.
+    if (output_shape.unknown_rank()) return kNotBatched;
+    if (is_batched(output_shape)) {
+      signature.outputs.emplace_back(i, output_shape.dims());
+    }
+  }
+  return std::optional<BatchedClusterSignature>(std::move(signature));
+}
+
+// Returns the name of the host CPU device of the task of `device_name`.
+std::string HostDeviceName(absl::string_view device_name) {
+  DeviceNameUtils::ParsedName parsed_name;
+  if (!DeviceNameUtils::ParseFullName(device_name, &parsed_name)) {
+    return std::string(device_name);
+  }
+  parsed_name.type = DEVICE_CPU;
+  parsed_name.id = 0;
+  return DeviceNameUtils::ParsedNameToString(parsed_name);
+}
+
+Output Int32Constant(const Scope& scope, std::vector<int32> values,
+                     TensorShape shape) {
+  Tensor tensor(DT_INT32, shape);
+  std::copy(values.begin(), values.end(), tensor.flat<int32>().data());
+  return ops::Const(scope, Input::Initializer(tensor));
+}
+
+// Pads the batched inputs of the cluster `cluster_info` up to a bucket of
+// `buckets`, and slices the batched outputs of `xla_run` back to the batch
+// size:
+//
+//   batch_size = Shape(first batched input)[0]
+//   bucket = max(buckets[min(LowerBound(buckets, batch_size), #buckets - 1)],
+//                batch_size)
+//   padded_input_i = Pad(input_i, [[0, bucket - batch_size], [0, 0], ...])
+//
+// The small integer computations are placed on the host.
+class BatchBucketingRewrite {
+ public:
+  BatchBucketingRewrite(const Scope& root, const std::string& host_device_name,
+                        absl::Span<const int32> buckets,
+                        BatchedClusterSignature signature)
+      : root_(root),
+        host_(root.WithDevice(host_device_name)
+                  .WithAssignedDevice(host_device_name)),
+        buckets_(buckets.begin(), buckets.end()),
+        signature_(std::move(signature)) {}
+
+  // Replaces the batched inputs in `cluster_info` with padded inputs.
+  void PadInputs(XlaClusterInfo* cluster_info) {
+    const Output first_input =
+        cluster_info->non_constant_inputs[signature_.non_constant_inputs[0]
+                                              .first];
+    Output shape = ops::Shape(root_.WithOpName("batched_input_shape"),
+                              first_input, ops::Shape::OutType(DT_INT32));
+    batch_size_ = ops::Squeeze(host_.WithOpName("batch_size"),
+                               ops::Slice(host_, shape, {0}, {1}));
+    const int num_buckets = buckets_.size();
+    Output idx = ops::LowerBound(
+        host_, Int32Constant(host_, buckets_, TensorShape({1, num_buckets})),
+        ops::Reshape(host_, batch_size_, {1, 1}));
+    idx = ops::Minimum(host_, ops::Squeeze(host_, idx), num_buckets - 1);
+    Output bucket = ops::Maximum(
+        host_.WithOpName("batch_bucket"),
+        ops::GatherV2(
+            host_, Int32Constant(host_, buckets_, TensorShape({num_buckets})),
+            idx, 0),
+        batch_size_);
+    Output padding =
+        ops::Stack(host_, {Output(ops::Const(host_, 0)),
+                           Output(ops::Sub(host_, bucket, batch_size_))});
+
+    for (const auto& [index, rank] : signature_.non_constant_inputs) {
+      Output paddings = ops::Reshape(host_, padding, {1, 2});
+      if (rank > 1) {
+        paddings = ops::Concat(
+            host_,
+            {paddings, Int32Constant(host_, std::vector<int32>(2 * (rank - 1)),
+                                     TensorShape({rank - 1, 2}))},
+            0);
+      }
+      Output& input = cluster_info->non_constant_inputs[index];
+      input = ops::Pad(root_.WithOpName(absl::StrCat("padded_input_", index)),
+                       input, paddings);
+    }
+  }
+
+  // Slices the batched outputs of `xla_run` back to the batch size, for all of
+  // their consumers.
+  void SliceOutputs(Graph* g, Node* xla_run) {
+    for (const auto& [index, rank] : signature_.outputs) {
+      std::vector<const Edge*> out_edges;
+      for (const Edge* e : xla_run->out_edges()) {
+        if (e->src_output() == index) out_edges.push_back(e);
+      }
+      Output size = ops::Reshape(host_, batch_size_, {1});
+      if (rank > 1) {
+        size = ops::Concat(
+            host_,
+            {size, Int32Constant(host_, std::vector<int32>(rank - 1, -1),
+                                 TensorShape({rank - 1}))},
+            0);
+      }
+      Output sliced = ops::Slice(
+          root_.WithOpName(absl::StrCat("sliced_output_", index)),
+          Output(xla_run, index),
+          Int32Constant(host_, std::vector<int32>(rank), TensorShape({rank})),
+          size);
+      for (const Edge* e : out_edges) {
+        g->UpdateEdge(sliced.node(), 0, e->dst(), e->dst_input()).IgnoreError();
+      }
+    }
+  }
+
+ private:
+  const Scope root_;
+  const Scope host_;
+  const std::vector<int32> buckets_;
+  const BatchedClusterSignature signature_;
+  Output batch_size_;
+};
+
 Status ReplaceNodeWithXlaCompileAndXlaRun(
     jit::DeviceInfoCache* device_info_cache,
     const GraphOptimizationPassOptions& options,
     const FunctionLibraryDefinition& flib_def, bool lazy_compilation_enabled,
-    const DebuggingOpts& debugging_opts, Graph* g, Node* n) {
+    const DebuggingOpts& debugging_opts, absl::Span<const int32> batch_buckets,
+    const GraphShapeInfo* shape_info, Graph* g, Node* n) {
   XlaClusterInfo cluster_info;
   TF_RETURN_IF_ERROR(GetXlaClusterInfo(n, &cluster_info));
 
@@ -491,6 +745,20 @@ Status ReplaceNodeWithXlaCompileAndXlaRun(
                    .WithDevice(n->requested_device())
                    .WithAssignedDevice(device_name_str);
 
+  std::optional<BatchedClusterSignature> batched_signature;
+  if (!batch_buckets.empty()) {
+    TF_ASSIGN_OR_RETURN(
+        batched_signature,
+        GetBatchedClusterSignature(flib_def, *shape_info, cluster_info));
+  }
+  std::optional<BatchBucketingRewrite> batch_bucketing;
+  if (batched_signature.has_value()) {
+    VLOG(2) << "Padding the batch dimension of cluster " << n->name();
+    batch_bucketing.emplace(root, HostDeviceName(device_name_str),
+                            batch_buckets, *std::move(batched_signature));
+    batch_bucketing->PadInputs(&cluster_info);
+  }
+
   ops::_XlaCompile xla_compile(root.WithOpName("xla_compile"),
                                /*constants=*/cluster_info.constant_inputs,
                                /*args=*/cluster_info.non_constant_inputs,
@@ -517,6 +785,9 @@ Status ReplaceNodeWithXlaCompileAndXlaRun(
     MoveOutgoingEdges(g, /*old_node=*/n,
                       /*new_node=*/xla_run.operation.node());
     g->RemoveNode(n);
+    if (batch_bucketing.has_value()) {
+      batch_bucketing->SliceOutputs(g, xla_run.operation.node());
+    }
   } else {
     // "Lazy" compilation: an _XlaCompile invocation may decide not to compile
     // the cluster based on profitability heuristics.
@@ -544,6 +815,9 @@ Status ReplaceNodeWithXlaCompileAndXlaRun(
     MergeOutgoingDataEdges(root, /*old_node=*/n,
                            /*new_node=*/xla_run.operation.node(),
                            cluster_info.function.name(), debugging_opts);
+    if (batch_bucketing.has_value()) {
+      batch_bucketing->SliceOutputs(g, xla_run.operation.node());
+    }
 
     TF_RETURN_IF_ERROR(root.status());
 
@@ -604,10 +878,19 @@ Status BuildXlaOpsPass::Run(const GraphOptimizationPassOptions& options) {
   VLOG(1) << "check_input_numerics = " << debugging_opts.check_input_numerics;
   VLOG(1) << "check_output_numerics = " << debugging_opts.check_output_numerics;
 
+  TF_ASSIGN_OR_RETURN(std::vector<int32> batch_buckets,
+                      ParseBatchBuckets(flags.tf_xla_batch_buckets));
+  GraphShapeInfo shape_info;
+  if (!batch_buckets.empty() && !xla_compiled_kernels.empty()) {
+    TF_RETURN_IF_ERROR(InferShapes(graph, /*arg_shapes=*/{}, options.flib_def,
+                                   &shape_info));
+  }
+
   for (Node* n : xla_compiled_kernels) {
     TF_RETURN_IF_ERROR(ReplaceNodeWithXlaCompileAndXlaRun(
         &device_info_cache, options, *options.flib_def,
-        lazy_compilation_enabled, debugging_opts, graph, n));
+        lazy_compilation_enabled, debugging_opts, batch_buckets, &shape_info,
+        graph, n));
   }
 
   if (VLOG_IS_ON(1)) {
@@ -21,6 +21,7 @@ limitations under the License.
 #include "tensorflow/cc/ops/standard_ops.h"
 #include "tensorflow/compiler/jit/defs.h"
 #include "tensorflow/compiler/jit/encapsulate_subgraphs_pass.h"
+#include "tensorflow/compiler/jit/flags.h"
 #include "tensorflow/compiler/jit/node_matchers.h"
 #include "tensorflow/compiler/jit/test_util.h"
 #include "tensorflow/core/common_runtime/device_factory.h"
@@ -207,6 +208,57 @@ TEST_F(BuildXlaOpsTest, OnNonXlaDevice) {
   EXPECT_THAT(write_op_new, assign_var);
 }
 
+FunctionDefLibrary CreateFunctionDefLibWithReluFunction(const string& name) {
+  FunctionDefLibrary fdef_lib;
+  FunctionDef func = FunctionDefHelper::Create(
+      /*function_name=*/name, /*in_def=*/{"x: float"},
+      /*out_def=*/{"out: float"}, /*attr_def*/ {},
+      /*node_def=*/{{{"relu"}, "Relu", {"x"}, {{"T", DT_FLOAT}}}},
+      /*ret_def=*/{{"out", "relu:activations:0"}});
+  *fdef_lib.add_function() = std::move(func);
+  return fdef_lib;
+}
+
+TEST_F(BuildXlaOpsTest, BatchBucketing) {
+  GetBuildXlaOpsPassFlags()->tf_xla_batch_buckets = "pow2";
+  Scope root = Scope::NewRootScope().ExitOnError();
+
+  FunctionDefLibrary fdef_lib =
+      CreateFunctionDefLibWithReluFunction("cluster_0");
+  TF_ASSERT_OK(root.graph()->AddFunctionLibrary(fdef_lib));
+
+  Output input =
+      ops::Placeholder(root.WithOpName("input"), DT_FLOAT,
+                       ops::Placeholder::Shape(PartialTensorShape({-1, 4})));
+  Node* call;
+  TF_ASSERT_OK(MakeXlaCompiledKernel(root.graph(), "cluster_0", "C", &call));
+  root.graph()->AddEdge(input.node(), 0, call, 0);
+  TF_ASSERT_OK(root.DoShapeInference(call));
+  call->AddAttr(kXlaHasReferenceVarsAttr, false);
+
+  Output consumer = ops::Identity(root.WithOpName("consumer"), Output(call));
+
+  std::unique_ptr<Graph> graph;
+  TF_ASSERT_OK(BuildXlaOps(root, fdef_lib, &graph));
+  GetBuildXlaOpsPassFlags()->tf_xla_batch_buckets = "";
+
+  // The cluster is compiled and run on the padded input, and its output is
+  // sliced back to the batch size.
+  auto padded_input =
+      NodeWith(Op("Pad"), Inputs(Out(NodeWith(Name("input"))), _));
+  auto xla_compile = NodeWith(Op("_XlaCompile"), Inputs(Out(padded_input)));
+  auto xla_run = NodeWith(Op("_XlaRun"), Inputs(Out(padded_input), _));
+  auto sliced_output = NodeWith(Op("Slice"), Inputs(Out(xla_run), _, _));
+  auto merge = NodeWith(Op("_XlaMerge"), Inputs(_, Out(sliced_output)));
+
+  Node* consumer_new = FindNodeByName(graph.get(), "consumer");
+  ASSERT_NE(consumer_new, nullptr);
+  EXPECT_THAT(consumer_new, NodeWith(Inputs(Out(merge))));
+  Node* xla_compile_new = FindNodeByName(graph.get(), "C/xla_compile");
+  ASSERT_NE(xla_compile_new, nullptr);
+  EXPECT_THAT(xla_compile_new, xla_compile);
+}
+
 TEST_F(BuildXlaOpsTest, OnXlaDevice) {
   const char* kXlaDeviceName = "/job:worker/replica:0/task:0/device:XLA_CPU:0";
   Scope root = Scope::NewRootScope().WithDevice(kXlaDeviceName).ExitOnError();
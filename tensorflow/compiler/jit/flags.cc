@@ -179,6 +179,7 @@ void AllocateAndParseFlags() {
   build_ops_flags->tf_xla_check_cluster_input_numerics = false;
   build_ops_flags->tf_xla_check_cluster_output_numerics = false;
   build_ops_flags->tf_xla_disable_constant_folding = false;
+  build_ops_flags->tf_xla_batch_buckets = "";
 
   mark_for_compilation_flags = new MarkForCompilationPassFlags;
   mark_for_compilation_flags->xla_auto_jit_flag.optimization_level_single_gpu =
@@ -208,6 +209,7 @@ void AllocateAndParseFlags() {
   ops_flags = new XlaOpsCommonFlags;
   ops_flags->tf_xla_always_defer_compilation = false;
   ops_flags->tf_xla_async_compilation = false;
+  ops_flags->tf_xla_async_compilation_for_jit_compile = false;
 
   jitter_flags = new IntroduceFloatingPointJitterPassFlags;
   jitter_flags->jitter_amount = 1e-5;
@@ -251,6 +253,13 @@ void AllocateAndParseFlags() {
             &build_ops_flags->tf_xla_disable_constant_folding,
             "If true then disables constant folding on TF graph before XLA "
             "compilation."),
+       Flag("tf_xla_batch_buckets", &build_ops_flags->tf_xla_batch_buckets,
+            "Pads the batch dimension of the inputs of batch-parallel "
+            "clusters up to a bucket to bound the number of recompilations. "
+            "Either \"pow2\" or a comma-separated list of increasing bucket "
+            "sizes, e.g. \"8,32,128\". The padded rows are zeros; only "
+            "clusters made of ops that process each row of the batch "
+            "independently are padded."),
 
        Flag("tf_xla_compile_on_demand", &device_flags->tf_xla_compile_on_demand,
             "Switch a device into 'on-demand' mode, where instead of "
@@ -268,6 +277,12 @@ void AllocateAndParseFlags() {
             "When lazy compilation is enabled, asynchronous compilation starts "
             "the cluster compilation in the background, and the fallback path "
             "is executed until the compilation has finished."),
+       Flag("tf_xla_async_compilation_for_jit_compile",
+            &ops_flags->tf_xla_async_compilation_for_jit_compile,
+            "Compile functions with jit_compile=True in the background, and "
+            "run them with the TF kernels until the compilation has finished. "
+            "Compilation errors are only reported once the compilation has "
+            "finished."),
 
        Flag("tf_introduce_floating_point_jitter_to_tensors",
             setter_for_jitter_tensor_names, "",
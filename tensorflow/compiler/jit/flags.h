@@ -119,6 +119,9 @@ struct XlaOpsCommonFlags {
   // If true, _XlaCompile compiles the cluster asynchronously with respect to
   // the main execution. The fallback path is taken while compilation happens.
   bool tf_xla_async_compilation;
+  // If true, functions with jit_compile=True are also compiled asynchronously,
+  // and run as regular TF functions until the compilation has finished.
+  bool tf_xla_async_compilation_for_jit_compile;
 };
 
 // Flags for the build_xla_ops pass.
@@ -142,6 +145,13 @@ struct BuildXlaOpsPassFlags {
   // Disables all constant folding. The primary use for this is for testing to
   // guarantee that tests are run on XLA and not on TF's CPU implementation.
   bool tf_xla_disable_constant_folding;
+
+  // If non-empty, the batch dimension of the inputs of batch-parallel clusters
+  // is padded up to a bucket, and their outputs are sliced back, which bounds
+  // the number of recompilations for dynamic batch sizes. Either "pow2" for
+  // power-of-two buckets, or a comma-separated list of increasing bucket
+  // sizes. Batch sizes above the largest bucket are not padded.
+  std::string tf_xla_batch_buckets;
 };
 
 // Flags for the IntroduceFloatingPointJitter pass.
@@ -271,6 +271,44 @@ static Status CompileToLocalExecutable(
                         compilation_result, executable);
 }
 
+// Runs `function` with the TF kernels, e.g. while it is compiled
+// asynchronously.
+static Status RunTensorFlowFunction(OpKernelContext* ctx,
+                                    const NameAttrList& function) {
+  FunctionLibraryRuntime* lib = ctx->function_library();
+  if (lib == nullptr) {
+    return errors::Internal("No function library.");
+  }
+  FunctionLibraryRuntime::Handle handle;
+  TF_RETURN_IF_ERROR(lib->Instantiate(
+      function.name(), AttrSlice(&function.attr()), &handle));
+
+  FunctionLibraryRuntime::Options opts;
+  opts.rendezvous = ctx->rendezvous();
+  opts.cancellation_manager = ctx->cancellation_manager();
+  opts.collective_executor = ctx->collective_executor();
+  opts.runner = ctx->runner();
+  opts.run_all_kernels_inline = ctx->run_all_kernels_inline();
+  opts.step_container = ctx->step_container();
+
+  std::vector<Tensor> args;
+  args.reserve(ctx->num_inputs());
+  for (int i = 0; i < ctx->num_inputs(); ++i) {
+    args.push_back(ctx->input(i));
+  }
+  std::vector<Tensor> rets;
+  TF_RETURN_IF_ERROR(lib->RunSync(std::move(opts), handle, args, &rets));
+  if (rets.size() != static_cast<size_t>(ctx->num_outputs())) {
+    return errors::Internal("Function ", function.name(), " returned ",
+                            rets.size(), " outputs, expected ",
+                            ctx->num_outputs(), ".");
+  }
+  for (int i = 0; i < ctx->num_outputs(); ++i) {
+    ctx->set_output(i, std::move(rets[i]));
+  }
+  return OkStatus();
+}
+
 void XlaLocalLaunchBase::Compute(OpKernelContext* ctx) {
   VLOG(1) << "XlaLocalLaunchOpBase::Compute "
           << Canonicalize(function_.name(), AttrSlice(&function_.attr()));
@@ -282,6 +320,11 @@ void XlaLocalLaunchBase::Compute(OpKernelContext* ctx) {
   const XlaCompiler::CompilationResult* compilation_result;
   xla::LocalExecutable* executable;
 
+  const XlaCompilationCache::CompileMode compile_mode =
+      GetXlaOpsCommonFlags().tf_xla_async_compilation_for_jit_compile
+          ? XlaCompilationCache::CompileMode::kAsync
+          : XlaCompilationCache::CompileMode::kStrict;
+
   std::vector<VariableInfo> variable_infos;
   {
     OP_REQUIRES_OK(
@@ -290,12 +333,23 @@ void XlaLocalLaunchBase::Compute(OpKernelContext* ctx) {
     OP_REQUIRES_OK(ctx, LockVariables(absl::MakeSpan(variable_infos)));
     Status s = CompileToLocalExecutable(
         ctx, function_, /*has_ref_vars=*/has_ref_vars_, platform_info_, inputs,
-        variable_infos, constants_, XlaCompilationCache::CompileMode::kStrict,
+        variable_infos, constants_, compile_mode,
         /*may_alias_resource_update=*/true, &client, &compilation_result,
         &executable);
     OP_REQUIRES_OK(ctx, s);
   }
 
+  // Async compilation returns a nullptr executable until it has finished.
+  if (executable == nullptr) {
+    DCHECK(compile_mode == XlaCompilationCache::CompileMode::kAsync);
+    VLOG(2) << "Running " << function_.name()
+            << " with the TF kernels while it is compiled.";
+    // The function locks the variables it accesses itself.
+    variable_infos.clear();
+    OP_REQUIRES_OK(ctx, RunTensorFlowFunction(ctx, function_));
+    return;
+  }
+
   std::map<int, const Tensor*> resource_var_ptrs;
   for (int i = 0; i < resources_.size(); i++) {
     resource_var_ptrs[resources_[i]] = variable_infos[i].var()->tensor();
@@ -13,10 +13,15 @@ See the License for the specific language governing permissions and
 limitations under the License.
 ==============================================================================*/
 
+#include <string>
+#include <vector>
+
+#include "absl/strings/match.h"
 #include "tensorflow/compiler/jit/flags.h"
 #include "tensorflow/compiler/jit/mark_for_compilation_pass.h"
 #include "tensorflow/compiler/jit/tests/xla_compilation_cache_test_helper.h"
 #include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/env.h"
 
 namespace tensorflow {
 namespace {
@@ -33,6 +38,14 @@ TEST_F(XlaCompilationCacheSerializeTest, PersistentCacheTest) {
   TF_ASSERT_OK(
       listener()->VerifyListenerHistory(/*expect_persistent_cache_use=*/false));
 
+  // Entries are written through temporary files that are renamed into place.
+  std::vector<std::string> file_names;
+  TF_ASSERT_OK(
+      Env::Default()->GetChildren(tensorflow::testing::TmpDir(), &file_names));
+  for (const std::string& file_name : file_names) {
+    EXPECT_FALSE(absl::EndsWith(file_name, ".tmp")) << file_name;
+  }
+
   // Reset the cluster numbering between sessions so we can get the same
   // cluster numbering.
   testing::ResetClusterSequenceNumber();
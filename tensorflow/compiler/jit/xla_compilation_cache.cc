@@ -42,6 +42,7 @@ limitations under the License.
 #include "tensorflow/compiler/xla/protobuf_util.h"
 #include "tensorflow/compiler/xla/service/compiler.h"
 #include "tensorflow/compiler/xla/service/hlo.pb.h"
+#include "tensorflow/compiler/xla/shape_util.h"
 #include "tensorflow/compiler/xla/status_macros.h"
 #include "tensorflow/compiler/xla/util.h"
 #include "tensorflow/core/common_runtime/device.h"
@@ -140,7 +141,27 @@ std::string XlaSerializedCacheKeyToString(const XlaSerializedCacheKey& key) {
       key.prefix(), key.prefix().empty() ? "" : kXlaSerializedCacheKeySeparator,
       key.signature_fingerprint(), kXlaSerializedCacheKeySeparator,
       key.cluster_fingerprint(), kXlaSerializedCacheKeySeparator,
-      key.device_type());
+      key.device_type(), kXlaSerializedCacheKeySeparator,
+      Hash64Combine(
+          key.build_options_fingerprint(),
+          Hash64Combine(Hash64(key.device_description()),
+                        Hash64(key.compiler_version()))));
+}
+
+uint64 BuildOptionsFingerprint(const xla::ExecutableBuildOptions& options) {
+  uint64 fingerprint = options.has_debug_options()
+                           ? DeterministicProtoHash64(options.debug_options())
+                           : 0;
+  fingerprint = Hash64Combine(fingerprint, options.num_replicas());
+  fingerprint = Hash64Combine(fingerprint, options.num_partitions());
+  fingerprint = Hash64Combine(fingerprint, options.use_spmd_partitioning());
+  fingerprint = Hash64Combine(fingerprint, options.alias_passthrough_params());
+  if (options.result_layout() != nullptr) {
+    fingerprint = Hash64Combine(
+        fingerprint, Hash64(xla::ShapeUtil::HumanStringWithLayout(
+                         *options.result_layout())));
+  }
+  return fingerprint;
 }
 
 }  // namespace
@@ -521,7 +542,9 @@ Status XlaCompilationCache::CompileStrict(
     const xla::HloModuleProto& hlo_module =
         entry->compilation_result.computation->proto();
 
-    XlaSerializedCacheKey cache_key = BuildSerializedCacheKey(sig, hlo_module);
+    TF_ASSIGN_OR_RETURN(
+        XlaSerializedCacheKey cache_key,
+        BuildSerializedCacheKey(options, sig, entry->compilation_result));
 
     {
       XLA_SCOPED_LOGGING_TIMER(absl::StrCat(
@@ -826,14 +849,29 @@ Status XlaCompilationCache::CompileImpl(
   return OkStatus();
 }
 
-XlaSerializedCacheKey XlaCompilationCache::BuildSerializedCacheKey(
-    const Signature& sig, const xla::HloModuleProto& hlo_module) const {
+StatusOr<XlaSerializedCacheKey> XlaCompilationCache::BuildSerializedCacheKey(
+    const XlaCompiler::Options& options, const Signature& sig,
+    const XlaCompiler::CompilationResult& result) const {
+  xla::ExecutableBuildOptions build_options =
+      GetBuildOptions(options, result, client_->default_device_ordinal());
+  TF_ASSIGN_OR_RETURN(
+      se::StreamExecutor * executor,
+      client_->backend().stream_executor(build_options.device_ordinal()));
+  const se::DeviceDescription& device_description =
+      executor->GetDeviceDescription();
+
   XlaSerializedCacheKey serialized_cache_key;
   serialized_cache_key.set_signature_fingerprint(Signature::Hash()(sig));
   serialized_cache_key.set_cluster_fingerprint(
-      DeterministicProtoHash64(hlo_module));
+      DeterministicProtoHash64(result.computation->proto()));
   serialized_cache_key.set_device_type(device_type_.type_string());
   serialized_cache_key.set_prefix(persistance_prefix_);
+  serialized_cache_key.set_build_options_fingerprint(
+      BuildOptionsFingerprint(build_options));
+  serialized_cache_key.set_device_description(absl::StrCat(
+      client_->platform()->Name(), ":", device_description.name(), ":",
+      device_description.platform_version()));
+  serialized_cache_key.set_compiler_version(TF_VERSION_STRING);
   return serialized_cache_key;
 }
 
@@ -888,7 +926,9 @@ StatusOr<XlaSerializedCacheEntry> XlaCompilationCache::SerializeEntry(
   XlaSerializedCacheEntry serialized_entry;
   const xla::HloModuleProto& hlo_module =
       entry.compilation_result.computation->proto();
-  *serialized_entry.mutable_key() = BuildSerializedCacheKey(sig, hlo_module);
+  TF_ASSIGN_OR_RETURN(
+      *serialized_entry.mutable_key(),
+      BuildSerializedCacheKey(options, sig, entry.compilation_result));
   *serialized_entry.mutable_hlo_module() = hlo_module;
 
   TF_ASSIGN_OR_RETURN(
@@ -916,7 +956,21 @@ Status XlaCompilationCache::SaveSerializedEntry(
   TF_RETURN_IF_ERROR(env->RecursivelyCreateDir(persistent_cache_directory_));
   const std::string file_path =
       GetFilePath(entry.key(), persistent_cache_directory_);
-  return WriteBinaryProto(env, file_path, entry);
+  if (env->FileExists(file_path).ok()) {
+    // Another process sharing the directory saved the entry first.
+    return OkStatus();
+  }
+  // Write to a unique temporary file first so that readers, and other writers
+  // racing on the same entry, only ever see complete entries.
+  std::string temp_file_path = absl::StrCat(file_path, ".");
+  if (!env->CreateUniqueFileName(&temp_file_path, ".tmp")) {
+    return errors::Internal("Failed to create a temporary file name for ",
+                            file_path);
+  }
+  Status status = WriteBinaryProto(env, temp_file_path, entry);
+  if (status.ok()) status = env->RenameFile(temp_file_path, file_path);
+  if (!status.ok()) env->DeleteFile(temp_file_path).IgnoreError();
+  return status;
 }
 
 StatusOr<std::optional<XlaSerializedCacheEntry>>
@@ -928,7 +982,14 @@ XlaCompilationCache::TryLoadSerializedEntry(const XlaSerializedCacheKey& key) {
   }
 
   XlaSerializedCacheEntry entry;
-  TF_RETURN_IF_ERROR(ReadTextOrBinaryProto(env, file_path, &entry));
+  Status status = ReadTextOrBinaryProto(env, file_path, &entry);
+  if (!status.ok()) {
+    // Treat unreadable entries, e.g. from an incompatible writer, as misses
+    // so that they get recompiled and overwritten.
+    LOG(WARNING) << "Failed to load the XLA cache entry " << file_path << ": "
+                 << status;
+    return StatusOr<std::optional<XlaSerializedCacheEntry>>(std::nullopt);
+  }
   return StatusOr<std::optional<XlaSerializedCacheEntry>>(entry);
 }
 
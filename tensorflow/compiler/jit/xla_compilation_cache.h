@@ -223,9 +223,11 @@ class XlaCompilationCache : public ResourceBase {
   };
 
   // Returns a cache key proto that identifies an entry in the compilation
-  // cache.
-  XlaSerializedCacheKey BuildSerializedCacheKey(
-      const Signature& sig, const xla::HloModuleProto& hlo_module) const;
+  // cache. Entries are only shared between compilations with the same build
+  // options, on equivalent devices, by the same compiler version.
+  StatusOr<XlaSerializedCacheKey> BuildSerializedCacheKey(
+      const XlaCompiler::Options& options, const Signature& sig,
+      const XlaCompiler::CompilationResult& result) const;
 
   // Serializes the signature and its corresponding entry to a proto message.
   StatusOr<XlaSerializedCacheEntry> SerializeEntry(
@@ -252,12 +254,15 @@ class XlaCompilationCache : public ResourceBase {
                              CompileScope scope);
 
   // Saves the cache entry in the file directory supplied during the
-  // construction of this class. Overwrites existing entries.
+  // construction of this class. The entry is written to a temporary file and
+  // then renamed, so that concurrent writers (e.g. replicas sharing the
+  // directory) never expose partially written entries. Does nothing if the
+  // entry already exists.
   Status SaveSerializedEntry(const XlaSerializedCacheEntry& entry);
 
   // Tries to load a cache entry given a `key` by searching the file directory
   // supplied during the construction of this class. Returns std::nullopt if no
-  // cache entry is found.
+  // cache entry is found or if the entry cannot be parsed.
   StatusOr<std::optional<XlaSerializedCacheEntry>> TryLoadSerializedEntry(
       const XlaSerializedCacheKey& key);
 
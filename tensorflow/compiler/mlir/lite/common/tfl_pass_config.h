@@ -45,7 +45,8 @@ struct PassConfig {
         guarantee_all_funcs_one_use(false),
         enable_hlo_to_tf_conversion(false),
         enable_dynamic_update_slice(false),
-        preserve_assert_op(false) {}
+        preserve_assert_op(false),
+        fuse_attention(false) {}
 
   // If `emit_builtin_tflite_ops` is true, TF Lite legalization passes will be
   // added, which produces TF Lite ops.
@@ -88,6 +89,10 @@ struct PassConfig {
   bool enable_dynamic_update_slice;
   // Whether to preserve AssertOp during legalization.
   bool preserve_assert_op;
+  // Whether to fuse the batch_matmul, softmax, batch_matmul chains of
+  // attention into the ScaledDotProductAttention custom op. The chains are only
+  // matched when `unfold_batch_matmul` is false.
+  bool fuse_attention;
 };
 
 inline llvm::raw_ostream& operator<<(llvm::raw_ostream& os,
@@ -111,7 +116,8 @@ inline llvm::raw_ostream& operator<<(llvm::raw_ostream& os,
             << "\nguarantee_all_funcs_one_use: "
             << pass_config.guarantee_all_funcs_one_use
             << "\nenable_hlo_to_tf_conversion: "
-            << pass_config.enable_hlo_to_tf_conversion << "\n";
+            << pass_config.enable_hlo_to_tf_conversion
+            << "\nfuse_attention: " << pass_config.fuse_attention << "\n";
 }
 
 }  // namespace TFL
@@ -20,6 +20,7 @@ limitations under the License.
 
 #include <algorithm>
 #include <cstdint>
+#include <limits>
 #include <memory>
 #include <string>
 #include <utility>
@@ -79,6 +80,7 @@ limitations under the License.
 #include "tensorflow/core/platform/status.h"
 #include "tensorflow/lite/delegates/flex/allowlisted_flex_ops.h"
 #include "tensorflow/lite/kernels/internal/kernel_utils.h"
+#include "tensorflow/lite/offline_memory_planner.h"
 #include "tensorflow/lite/schema/schema_conversion_utils.h"
 #include "tensorflow/lite/schema/schema_generated.h"
 #include "tensorflow/lite/string_util.h"
@@ -464,6 +466,66 @@ static Optional<TfLitePoolParams> GetTflitePoolParams(Operation* inst,
   return llvm::None;
 }
 
+// Plans the kTfLiteArenaRw offsets of the tensors of a subgraph, with the
+// tensor lifetimes of ArenaPlanner: graph inputs and outputs live through the
+// whole subgraph, and the other tensors from the operator that produces them
+// through the last operator that uses them. Returns kOnlinePlannedOffset for
+// the tensors with negative bytes, which are left to the runtime.
+static std::vector<int32_t> PlanArenaOffsets(
+    const std::vector<int64_t>& tensor_bytes,
+    const std::vector<int32_t>& inputs, const std::vector<int32_t>& outputs,
+    const std::vector<std::pair<std::vector<int32_t>, std::vector<int32_t>>>&
+        operators) {
+  constexpr int32_t kNotAssigned = std::numeric_limits<int32_t>::max();
+  const int num_tensors = tensor_bytes.size();
+  std::vector<int32_t> first_node(num_tensors, kNotAssigned);
+  std::vector<int32_t> last_node(num_tensors, kNotAssigned);
+  // The inputs and outputs are never freed, like in ArenaPlanner.
+  std::vector<int> refcounts(num_tensors, 0);
+  for (int32_t tensor : outputs) ++refcounts[tensor];
+  for (int32_t tensor : inputs) {
+    ++refcounts[tensor];
+    first_node[tensor] = 0;
+  }
+  for (const auto& op : operators) {
+    for (int32_t tensor : op.first) {
+      if (tensor != kTfLiteOptionalTensor) ++refcounts[tensor];
+    }
+  }
+  for (int32_t node = 0; node < operators.size(); ++node) {
+    for (int32_t tensor : operators[node].second) {
+      if (first_node[tensor] == kNotAssigned) first_node[tensor] = node;
+    }
+    for (int32_t tensor : operators[node].first) {
+      if (tensor != kTfLiteOptionalTensor && --refcounts[tensor] == 0 &&
+          first_node[tensor] != kNotAssigned) {
+        last_node[tensor] = node;
+      }
+    }
+  }
+
+  std::vector<tflite::OfflinePlannedBuffer> buffers;
+  std::vector<int> buffer_tensors;
+  for (int tensor = 0; tensor < num_tensors; ++tensor) {
+    if (tensor_bytes[tensor] < 0 || first_node[tensor] == kNotAssigned) {
+      continue;
+    }
+    buffers.push_back({static_cast<size_t>(tensor_bytes[tensor]),
+                       first_node[tensor], last_node[tensor]});
+    buffer_tensors.push_back(tensor);
+  }
+  size_t arena_size;
+  const std::vector<size_t> buffer_offsets =
+      tflite::PlanOfflineMemoryAllocation(
+          buffers, tflite::OfflineMemoryPlannerOptions(), &arena_size);
+  std::vector<int32_t> offsets(num_tensors, tflite::kOnlinePlannedOffset);
+  if (arena_size > std::numeric_limits<int32_t>::max()) return offsets;
+  for (int i = 0; i < buffers.size(); ++i) {
+    offsets[buffer_tensors[i]] = buffer_offsets[i];
+  }
+  return offsets;
+}
+
 namespace {
 
 // Helper struct that wraps inputs/outputs of a single SignatureDef.
@@ -508,7 +570,8 @@ class Translator {
                             toco_flags.select_user_tf_ops().end()),
         metadata_(metadata),
         supported_backends_(toco_flags.supported_backends().begin(),
-                            toco_flags.supported_backends().end()) {
+                            toco_flags.supported_backends().end()),
+        plan_memory_offline_(toco_flags.enable_offline_memory_planning()) {
     // The first buffer must be empty according to the schema definition.
     empty_buffer_ = tflite::CreateBuffer(builder_);
     buffers_.push_back(empty_buffer_);
@@ -634,6 +697,10 @@ class Translator {
   // is marked as a stateful operand.
   bool IsStatefulOperand(mlir::Operation* op, int operand_index);
 
+  // Returns the size of the tensor of `value` if it is a kTfLiteArenaRw tensor
+  // of static size at runtime, or -1.
+  int64_t GetArenaTensorBytes(Value value);
+
   // Returns a unique name for `val`.
   std::string UniqueName(mlir::Value val);
 
@@ -692,6 +759,11 @@ class Translator {
   const std::map<std::string, std::string> metadata_;
   // User's defined supported backends.
   const std::unordered_set<std::string> supported_backends_;
+  // Whether to embed the arena offsets of the tensors in the metadata.
+  const bool plan_memory_offline_;
+  // The arena offsets of the tensors of each subgraph, if
+  // plan_memory_offline_.
+  std::vector<std::pair<int, std::vector<int32_t>>> offline_offsets_;
   // A mapping table to mlir::Operation objects for TFL subgraph and operator
   // index in a flatbuffer.
   std::vector<std::vector<Operation*>> subgraph_op_inst_map_;
@@ -920,6 +992,30 @@ Optional<BufferOffset<tflite::Tensor>> Translator::BuildTensor(
   }
 }
 
+int64_t Translator::GetArenaTensorBytes(Value value) {
+  if (auto* inst = value.getDefiningOp()) {
+    if (IsConst(inst)) return -1;
+  }
+  auto type = value.getType().dyn_cast<TensorType>();
+  if (!type || !type.hasStaticShape()) return -1;
+  // Variables are allocated in the persistent arena.
+  for (auto& use : value.getUses()) {
+    if (IsStatefulOperand(use.getOwner(), use.getOperandNumber())) return -1;
+  }
+  Type element_type = type.getElementType();
+  if (auto qtype = element_type.dyn_cast<mlir::quant::QuantizedType>()) {
+    element_type = qtype.getStorageType();
+  }
+  int64_t num_values = type.getNumElements();
+  if (auto complex_type = element_type.dyn_cast<mlir::ComplexType>()) {
+    element_type = complex_type.getElementType();
+    num_values *= 2;
+  }
+  // Strings, resources and variants are dynamic tensors.
+  if (!element_type.isIntOrFloat()) return -1;
+  return num_values * ((element_type.getIntOrFloatBitWidth() + 7) / 8);
+}
+
 BufferOffset<tflite::Operator> Translator::BuildIfOperator(
     mlir::TF::IfOp op, const std::vector<int32_t>& operands,
     const std::vector<int32_t>& results) {
@@ -1381,6 +1477,8 @@ Optional<BufferOffset<tflite::SubGraph>> Translator::BuildSubGraph(
     InitializeNamesFromAttribute(fn, &has_input_attr);
   }
   std::vector<BufferOffset<tflite::Tensor>> tensors;
+  // The kTfLiteArenaRw bytes of each tensor, or -1.
+  std::vector<int64_t> tensor_bytes;
   llvm::DenseMap<Value, int> tensor_index_map;
 
   // Builds tensor and buffer for argument or operation result. Returns false
@@ -1406,6 +1504,7 @@ Optional<BufferOffset<tflite::SubGraph>> Translator::BuildSubGraph(
         BuildTensor(value, tensor_name, buffers_.size(), quant_parameters);
     if (!tensor_or) return false;
     tensors.push_back(*tensor_or);
+    tensor_bytes.push_back(GetArenaTensorBytes(value));
 
     // TODO(ashwinm): Check if for stateful tensors, if it is also needed to
     // make the Buffer empty apart from setting the buffer_idx=0 in the
@@ -1422,6 +1521,9 @@ Optional<BufferOffset<tflite::SubGraph>> Translator::BuildSubGraph(
   };
 
   std::vector<BufferOffset<tflite::Operator>> operators;
+  // The input and output tensors of each operator.
+  std::vector<std::pair<std::vector<int32_t>, std::vector<int32_t>>>
+      operator_tensors;
   std::vector<Operation*> operators_in_mlir;
   auto& bb = region->front();
 
@@ -1465,6 +1567,7 @@ Optional<BufferOffset<tflite::SubGraph>> Translator::BuildSubGraph(
           } else {
             intermediates.push_back(tensors.size());
             tensors.push_back(tensor_or.getValue());
+            tensor_bytes.push_back(-1);
           }
         }
       }
@@ -1525,6 +1628,7 @@ Optional<BufferOffset<tflite::SubGraph>> Translator::BuildSubGraph(
     if (auto tfl_operator =
             BuildOperator(real_inst, operands, results, intermediates)) {
       operators.push_back(*tfl_operator);
+      operator_tensors.emplace_back(operands, results);
       operators_in_mlir.push_back(real_inst);
     } else {
       failed_once = true;
@@ -1545,6 +1649,12 @@ Optional<BufferOffset<tflite::SubGraph>> Translator::BuildSubGraph(
     outputs.push_back(tensor_index_map[result]);
   }
 
+  if (plan_memory_offline_) {
+    offline_offsets_.emplace_back(
+        index,
+        PlanArenaOffsets(tensor_bytes, inputs, outputs, operator_tensors));
+  }
+
   return tflite::CreateSubGraph(
       builder_, builder_.CreateVector(tensors), builder_.CreateVector(inputs),
       builder_.CreateVector(outputs), builder_.CreateVector(operators),
@@ -1585,6 +1695,12 @@ Translator::CreateMetadataVector() {
   constexpr std::size_t kByteStringSize = 16;
   metadata.push_back(
       BuildMetadata("min_runtime_version", std::string(kByteStringSize, '\0')));
+  if (!offline_offsets_.empty()) {
+    metadata.push_back(
+        BuildMetadata(tflite::kOfflineMemoryAllocationMetadata,
+                      tflite::SerializeOfflineMemoryAllocation(
+                          offline_offsets_)));
+  }
   for (const auto& kv : metadata_) {
     const std::string& val = kv.second;
     // Only take the first kByteStringSize values.
@@ -87,6 +87,7 @@ bool emit_custom_ops;
 bool emit_select_tf_ops;
 bool lower_tensor_list_ops;
 bool strip_debug_info;
+bool plan_memory_offline;
 
 // NOLINTNEXTLINE
 static opt<bool, true> emit_builtin_tflite_ops_flag(
@@ -119,6 +120,13 @@ static opt<bool, true> strip_debug_info_flag(
     "strip-debug-info", llvm::cl::desc("Strip debug info during export"),
     llvm::cl::location(strip_debug_info), llvm::cl::init(false));
 
+// NOLINTNEXTLINE
+static opt<bool, true> plan_memory_offline_flag(
+    "plan-memory-offline",
+    llvm::cl::desc("Plan the arena offsets of the tensors during export and "
+                   "embed them in the model metadata"),
+    llvm::cl::location(plan_memory_offline), llvm::cl::init(false));
+
 namespace mlir {
 namespace {
 static OwningOpRef<mlir::ModuleOp> FlatBufferFileToMlirTrans(
@@ -166,6 +174,7 @@ static LogicalResult MlirToFlatBufferFileTranslateFunction(
   options.toco_flags.set_force_select_tf_ops(!emit_builtin_tflite_ops);
   options.toco_flags.set_enable_select_tf_ops(emit_select_tf_ops);
   options.toco_flags.set_allow_custom_ops(emit_custom_ops);
+  options.toco_flags.set_enable_offline_memory_planning(plan_memory_offline);
   options.op_or_arg_name_mapper = op_or_arg_name_mapper.get();
   if (!tflite::MlirToFlatBufferTranslateFunction(module, options,
                                                  &serialized_flatbuffer))
@@ -0,0 +1,61 @@
+// RUN: tf-opt -tfl-fuse-attention %s | FileCheck %s
+
+// CHECK-LABEL: @fuseAttention
+func.func @fuseAttention(%arg0: tensor<2x8x16xf32>, %arg1: tensor<2x12x16xf32>, %arg2: tensor<2x12x4xf32>) -> tensor<2x8x4xf32> {
+  %cst = arith.constant dense<0.25> : tensor<f32>
+  %0 = "tfl.batch_matmul"(%arg0, %arg1) {adj_x = false, adj_y = true} : (tensor<2x8x16xf32>, tensor<2x12x16xf32>) -> tensor<2x8x12xf32>
+  %1 = "tfl.mul"(%0, %cst) {fused_activation_function = "NONE"} : (tensor<2x8x12xf32>, tensor<f32>) -> tensor<2x8x12xf32>
+  %2 = "tfl.softmax"(%1) {beta = 1.000000e+00 : f32} : (tensor<2x8x12xf32>) -> tensor<2x8x12xf32>
+  %3 = "tfl.batch_matmul"(%2, %arg2) {adj_x = false, adj_y = false} : (tensor<2x8x12xf32>, tensor<2x12x4xf32>) -> tensor<2x8x4xf32>
+  func.return %3 : tensor<2x8x4xf32>
+
+  // CHECK: %[[RES:.*]] = "tfl.custom"(%arg0, %arg1, %arg2) {custom_code = "ScaledDotProductAttention", custom_option = opaque<"tfl", "0x{{.*}}"> : tensor<{{.*}}xi8>} : (tensor<2x8x16xf32>, tensor<2x12x16xf32>, tensor<2x12x4xf32>) -> tensor<2x8x4xf32>
+  // CHECK-NOT: tfl.softmax
+  // CHECK: return %[[RES]]
+}
+
+// CHECK-LABEL: @fuseAttentionWithMask
+func.func @fuseAttentionWithMask(%arg0: tensor<1x2x8x16xf32>, %arg1: tensor<1x2x12x16xf32>, %arg2: tensor<1x2x12x4xf32>, %arg3: tensor<8x12xf32>) -> tensor<1x2x8x4xf32> {
+  %0 = "tfl.batch_matmul"(%arg0, %arg1) {adj_x = false, adj_y = true} : (tensor<1x2x8x16xf32>, tensor<1x2x12x16xf32>) -> tensor<1x2x8x12xf32>
+  %1 = "tfl.add"(%arg3, %0) {fused_activation_function = "NONE"} : (tensor<8x12xf32>, tensor<1x2x8x12xf32>) -> tensor<1x2x8x12xf32>
+  %2 = "tfl.softmax"(%1) {beta = 1.000000e+00 : f32} : (tensor<1x2x8x12xf32>) -> tensor<1x2x8x12xf32>
+  %3 = "tfl.batch_matmul"(%2, %arg2) {adj_x = false, adj_y = false} : (tensor<1x2x8x12xf32>, tensor<1x2x12x4xf32>) -> tensor<1x2x8x4xf32>
+  func.return %3 : tensor<1x2x8x4xf32>
+
+  // CHECK: "tfl.custom"(%arg0, %arg1, %arg2, %arg3) {custom_code = "ScaledDotProductAttention"
+}
+
+// CHECK-LABEL: @fuseQuantizedAttention
+func.func @fuseQuantizedAttention(%arg0: tensor<1x8x16x!quant.uniform<i8:f32, 0.05:-3>>, %arg1: tensor<1x12x16x!quant.uniform<i8:f32, 0.04:2>>, %arg2: tensor<1x12x4x!quant.uniform<i8:f32, 0.02:1>>) -> tensor<1x8x4x!quant.uniform<i8:f32, 0.01:0>> {
+  %cst = "tfl.pseudo_qconst"() {qtype = tensor<!quant.uniform<i8:f32, 0.0025:0>>, value = dense<100> : tensor<i8>} : () -> tensor<!quant.uniform<i8:f32, 0.0025:0>>
+  %0 = "tfl.batch_matmul"(%arg0, %arg1) {adj_x = false, adj_y = true} : (tensor<1x8x16x!quant.uniform<i8:f32, 0.05:-3>>, tensor<1x12x16x!quant.uniform<i8:f32, 0.04:2>>) -> tensor<1x8x12x!quant.uniform<i8:f32, 0.1:-5>>
+  %1 = "tfl.mul"(%0, %cst) {fused_activation_function = "NONE"} : (tensor<1x8x12x!quant.uniform<i8:f32, 0.1:-5>>, tensor<!quant.uniform<i8:f32, 0.0025:0>>) -> tensor<1x8x12x!quant.uniform<i8:f32, 0.025:-5>>
+  %2 = "tfl.softmax"(%1) {beta = 1.000000e+00 : f32} : (tensor<1x8x12x!quant.uniform<i8:f32, 0.025:-5>>) -> tensor<1x8x12x!quant.uniform<i8:f32, 3.906250e-03:-128>>
+  %3 = "tfl.batch_matmul"(%2, %arg2) {adj_x = false, adj_y = false} : (tensor<1x8x12x!quant.uniform<i8:f32, 3.906250e-03:-128>>, tensor<1x12x4x!quant.uniform<i8:f32, 0.02:1>>) -> tensor<1x8x4x!quant.uniform<i8:f32, 0.01:0>>
+  func.return %3 : tensor<1x8x4x!quant.uniform<i8:f32, 0.01:0>>
+
+  // CHECK: "tfl.custom"(%arg0, %arg1, %arg2) {custom_code = "ScaledDotProductAttention"
+  // CHECK-NOT: tfl.softmax
+}
+
+// CHECK-LABEL: @notFusedWhenScoresHaveOtherUses
+func.func @notFusedWhenScoresHaveOtherUses(%arg0: tensor<2x8x16xf32>, %arg1: tensor<2x12x16xf32>, %arg2: tensor<2x12x4xf32>) -> (tensor<2x8x4xf32>, tensor<2x8x12xf32>) {
+  %0 = "tfl.batch_matmul"(%arg0, %arg1) {adj_x = false, adj_y = true} : (tensor<2x8x16xf32>, tensor<2x12x16xf32>) -> tensor<2x8x12xf32>
+  %1 = "tfl.softmax"(%0) {beta = 1.000000e+00 : f32} : (tensor<2x8x12xf32>) -> tensor<2x8x12xf32>
+  %2 = "tfl.batch_matmul"(%1, %arg2) {adj_x = false, adj_y = false} : (tensor<2x8x12xf32>, tensor<2x12x4xf32>) -> tensor<2x8x4xf32>
+  func.return %2, %0 : tensor<2x8x4xf32>, tensor<2x8x12xf32>
+
+  // CHECK-NOT: tfl.custom
+  // CHECK: tfl.softmax
+}
+
+// CHECK-LABEL: @notFusedWithoutTransposedKey
+func.func @notFusedWithoutTransposedKey(%arg0: tensor<2x8x16xf32>, %arg1: tensor<2x16x12xf32>, %arg2: tensor<2x12x4xf32>) -> tensor<2x8x4xf32> {
+  %0 = "tfl.batch_matmul"(%arg0, %arg1) {adj_x = false, adj_y = false} : (tensor<2x8x16xf32>, tensor<2x16x12xf32>) -> tensor<2x8x12xf32>
+  %1 = "tfl.softmax"(%0) {beta = 1.000000e+00 : f32} : (tensor<2x8x12xf32>) -> tensor<2x8x12xf32>
+  %2 = "tfl.batch_matmul"(%1, %arg2) {adj_x = false, adj_y = false} : (tensor<2x8x12xf32>, tensor<2x12x4xf32>) -> tensor<2x8x4xf32>
+  func.return %2 : tensor<2x8x4xf32>
+
+  // CHECK-NOT: tfl.custom
+  // CHECK: tfl.softmax
+}
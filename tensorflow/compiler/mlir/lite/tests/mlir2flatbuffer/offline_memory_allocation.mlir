@@ -0,0 +1,27 @@
+// RUN: flatbuffer_translate -mlir-to-tflite-flatbuffer -plan-memory-offline %s -o - | flatbuffer_to_string - | FileCheck %s
+
+// The input and the output live through the whole graph, so they don't share
+// memory, and the constant isn't planned.
+func.func @main(tensor<3x2xi32>) -> tensor<3x2xi32> {
+^bb0(%arg0: tensor<3x2xi32>):
+  %0 = "tfl.pseudo_const" () {value = dense<[[1, 2], [3, 4], [5, 6]]> : tensor<3x2xi32>} : () -> tensor<3x2xi32>
+  %1 = "tfl.sub" (%arg0, %0) {fused_activation_function = "NONE"} : (tensor<3x2xi32>, tensor<3x2xi32>) -> tensor<3x2xi32>
+  func.return %1 : tensor<3x2xi32>
+}
+
+// CHECK:      buffers: [ {
+// CHECK:      }, {
+// CHECK:      }, {
+// CHECK:      }, {
+// CHECK:      }, {
+// CHECK-NEXT:   data: [ 49, 46, 54, 46, 48, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0 ]
+// CHECK-NEXT: }, {
+// CHECK-NEXT:   data: [ 1, 0, 0, 0, 0, 0, 0, 0, 3, 0, 0, 0, 64, 0, 0, 0, 255, 255, 255, 255, 0, 0, 0, 0 ]
+// CHECK-NEXT: } ],
+// CHECK-NEXT: metadata: [ {
+// CHECK-NEXT:   name: "min_runtime_version",
+// CHECK-NEXT:   buffer: 4
+// CHECK-NEXT: }, {
+// CHECK-NEXT:   name: "OfflineMemoryAllocation",
+// CHECK-NEXT:   buffer: 5
+// CHECK-NEXT: } ]
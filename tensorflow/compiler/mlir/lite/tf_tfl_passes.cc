@@ -340,6 +340,12 @@ void AddPostVariableFreezingTFToTFLConversionPasses(
                    .RunAndRewriteDynamicRangeQuantizationPasses()) {
       AddDynamicRangeQuantizationPasses(pass_config.quant_specs, *pass_manager);
     }
+    // The attention fusion runs after quantization so that it matches the
+    // quantized chains as well as the float ones.
+    if (pass_config.fuse_attention) {
+      pass_manager->addNestedPass<mlir::func::FuncOp>(
+          mlir::TFL::CreateFuseAttentionPass());
+    }
     pass_manager->addPass(mlir::createCanonicalizerPass());
 
     // This pass should be always at the end of the model
@@ -112,9 +112,10 @@ float CalculateRandomSparsity(const ElementsAttr& attr,
 float CalculateBlockSparsity(const ElementsAttr& attr, const ShapedType& type,
                              const std::vector<int>& block_size) {
   float sparsity = 0;
-  std::vector<int> shape(2);
-  shape[0] = type.getDimSize(0);
-  shape[1] = type.getDimSize(1);
+  std::vector<int> shape(type.getRank());
+  for (int i = 0; i < type.getRank(); i++) {
+    shape[i] = type.getDimSize(i);
+  }
 
   std::vector<int> traversal_order = {};
   std::vector<TfLiteDimensionType> format = {};
@@ -208,6 +209,7 @@ InspectResult InspectWeight(
   std::vector<int> selected_block_size;
   result.needs_densify = true;
   for (const auto& block_size : supported_block_size) {
+    if (static_cast<int64_t>(block_size.size()) != type.getRank()) continue;
     curr_sparsity = CalculateBlockSparsity(attr, type, block_size);
     if (curr_sparsity / random_sparsity > ratio_threshold) {
       selected_block_size = block_size;
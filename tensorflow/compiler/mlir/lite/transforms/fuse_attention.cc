@@ -0,0 +1,236 @@
+/* Copyright 2022 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+// Fuses the chain of ops of a scaled dot-product attention,
+//
+//   %scores = tfl.batch_matmul(%query, %key) {adj_y = true}
+//   %scaled = tfl.mul(%scores, %scale)       // optional, splat constant
+//   %masked = tfl.add(%scaled, %mask)        // optional
+//   %probs = tfl.softmax(%masked) {beta = 1.0}
+//   %output = tfl.batch_matmul(%probs, %value)
+//
+// into tfl.custom("ScaledDotProductAttention"), whose kernel never writes the
+// scores to memory. The pass runs after quantization, and fuses chains whose
+// query, key, value and output are all float32 or all quantized int8.
+
+#include <vector>
+
+#include "flatbuffers/flexbuffers.h"  // from @flatbuffers
+#include "llvm/ADT/APFloat.h"
+#include "llvm/ADT/StringRef.h"
+#include "mlir/Dialect/Func/IR/FuncOps.h"  // from @llvm-project
+#include "mlir/Dialect/Quant/QuantTypes.h"  // from @llvm-project
+#include "mlir/IR/Attributes.h"  // from @llvm-project
+#include "mlir/IR/BuiltinAttributes.h"  // from @llvm-project
+#include "mlir/IR/BuiltinTypes.h"  // from @llvm-project
+#include "mlir/IR/Matchers.h"  // from @llvm-project
+#include "mlir/IR/PatternMatch.h"  // from @llvm-project
+#include "mlir/IR/TypeUtilities.h"  // from @llvm-project
+#include "mlir/Pass/Pass.h"  // from @llvm-project
+#include "mlir/Support/LLVM.h"  // from @llvm-project
+#include "mlir/Support/LogicalResult.h"  // from @llvm-project
+#include "mlir/Transforms/GreedyPatternRewriteDriver.h"  // from @llvm-project
+#include "tensorflow/compiler/mlir/lite/ir/tfl_ops.h"
+#include "tensorflow/compiler/mlir/lite/transforms/passes.h"
+
+namespace mlir {
+namespace TFL {
+namespace {
+#define GEN_PASS_CLASSES
+#include "tensorflow/compiler/mlir/lite/transforms/passes.h.inc"
+
+constexpr char kCustomCode[] = "ScaledDotProductAttention";
+
+struct FuseAttentionPass : public FuseAttentionPassBase<FuseAttentionPass> {
+  MLIR_DEFINE_EXPLICIT_INTERNAL_INLINE_TYPE_ID(FuseAttentionPass)
+
+  void runOnOperation() override;
+};
+
+// Whether the elements of `type` are float32 or per-tensor quantized int8,
+// the types supported by the kernel.
+bool IsSupportedElementType(Type type) {
+  Type element_type = getElementTypeOrSelf(type);
+  if (element_type.isF32()) return true;
+  auto quantized_type = element_type.dyn_cast<quant::UniformQuantizedType>();
+  return quantized_type && quantized_type.isSigned() &&
+         quantized_type.getStorageTypeIntegralWidth() == 8;
+}
+
+bool HaveSameElementKind(Type a, Type b) {
+  return getElementTypeOrSelf(a).isF32() == getElementTypeOrSelf(b).isF32();
+}
+
+// Returns the value of a splat constant, dequantized if it is quantized.
+Optional<float> GetSplatConstant(Value value) {
+  Operation *op = value.getDefiningOp();
+  if (auto qconst = dyn_cast_or_null<QConstOp>(op)) {
+    auto quantized_type = getElementTypeOrSelf(qconst.getType())
+                              .dyn_cast<quant::UniformQuantizedType>();
+    auto elements = qconst.value().dyn_cast<DenseIntElementsAttr>();
+    if (!quantized_type || !elements || !elements.isSplat()) return llvm::None;
+    const int64_t quantized = elements.getSplatValue<APInt>().getSExtValue();
+    return static_cast<float>(quantized_type.getScale() *
+                              (quantized - quantized_type.getZeroPoint()));
+  }
+  DenseFPElementsAttr elements;
+  if (!matchPattern(value, m_Constant(&elements)) || !elements.isSplat()) {
+    return llvm::None;
+  }
+  return elements.getSplatValue<APFloat>().convertToFloat();
+}
+
+// Whether `mask` broadcasts to the shape of `scores` along the rules of the
+// kernel: no more dimensions than the scores, right aligned, each of size 1 or
+// of the size of the scores.
+bool IsBroadcastableMask(Value mask, Value scores) {
+  auto mask_type = mask.getType().dyn_cast<RankedTensorType>();
+  auto scores_type = scores.getType().dyn_cast<RankedTensorType>();
+  if (!mask_type || !scores_type || !mask_type.hasStaticShape() ||
+      mask_type.getRank() > scores_type.getRank()) {
+    return false;
+  }
+  const int64_t offset = scores_type.getRank() - mask_type.getRank();
+  for (int64_t i = 0; i < mask_type.getRank(); ++i) {
+    const int64_t mask_dim = mask_type.getDimSize(i);
+    if (mask_dim != 1 && mask_dim != scores_type.getDimSize(offset + i)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+// Whether query, key and value have the same static batch dimensions, which
+// the kernel does not broadcast.
+bool HaveSameBatchDims(Value query, Value key, Value value) {
+  auto query_type = query.getType().dyn_cast<RankedTensorType>();
+  auto key_type = key.getType().dyn_cast<RankedTensorType>();
+  auto value_type = value.getType().dyn_cast<RankedTensorType>();
+  if (!query_type || !key_type || !value_type) return false;
+  const int64_t rank = query_type.getRank();
+  if (rank < 2 || key_type.getRank() != rank || value_type.getRank() != rank) {
+    return false;
+  }
+  for (int64_t i = 0; i < rank - 2; ++i) {
+    if (query_type.isDynamicDim(i) ||
+        key_type.getDimSize(i) != query_type.getDimSize(i) ||
+        value_type.getDimSize(i) != query_type.getDimSize(i)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+struct FuseScaledDotProductAttention
+    : public OpRewritePattern<TFL::BatchMatMulOp> {
+  using OpRewritePattern<TFL::BatchMatMulOp>::OpRewritePattern;
+
+  LogicalResult matchAndRewrite(TFL::BatchMatMulOp output_op,
+                                PatternRewriter &rewriter) const override {
+    if (output_op.adj_x() || output_op.adj_y()) return failure();
+    auto softmax = output_op.x().getDefiningOp<TFL::SoftmaxOp>();
+    if (!softmax || !softmax->hasOneUse() ||
+        !softmax.beta().isExactlyValue(1.0)) {
+      return failure();
+    }
+
+    Value scores = softmax.input();
+    Value mask;
+    if (auto add = scores.getDefiningOp<TFL::AddOp>()) {
+      if (!add->hasOneUse() || add.fused_activation_function() != "NONE") {
+        return failure();
+      }
+      // The scores are the operand computed by a mul or a batch_matmul.
+      const bool lhs_is_scores =
+          isa_and_nonnull<TFL::MulOp, TFL::BatchMatMulOp>(
+              add.lhs().getDefiningOp());
+      scores = lhs_is_scores ? add.lhs() : add.rhs();
+      mask = lhs_is_scores ? add.rhs() : add.lhs();
+    }
+
+    float scale = 1.0f;
+    if (auto mul = scores.getDefiningOp<TFL::MulOp>()) {
+      if (!mul->hasOneUse() || mul.fused_activation_function() != "NONE") {
+        return failure();
+      }
+      Optional<float> constant = GetSplatConstant(mul.rhs());
+      scores = mul.lhs();
+      if (!constant) {
+        constant = GetSplatConstant(mul.lhs());
+        scores = mul.rhs();
+      }
+      if (!constant) return failure();
+      scale = *constant;
+    }
+
+    auto scores_op = scores.getDefiningOp<TFL::BatchMatMulOp>();
+    if (!scores_op || !scores_op->hasOneUse() || scores_op.adj_x() ||
+        !scores_op.adj_y()) {
+      return failure();
+    }
+
+    Value query = scores_op.x();
+    Value key = scores_op.y();
+    Value value = output_op.y();
+    Type output_type = output_op.getType();
+    for (Type type : {query.getType(), key.getType(), value.getType(),
+                      output_type}) {
+      if (!IsSupportedElementType(type) ||
+          !HaveSameElementKind(type, output_type)) {
+        return failure();
+      }
+    }
+    if (!HaveSameBatchDims(query, key, value)) return failure();
+    // The mask is either float32 or of the type of the query.
+    if (mask && (!IsSupportedElementType(mask.getType()) ||
+                 !(getElementTypeOrSelf(mask).isF32() ||
+                   HaveSameElementKind(mask.getType(), query.getType())) ||
+                 !IsBroadcastableMask(mask, scores))) {
+      return failure();
+    }
+
+    flexbuffers::Builder fbb;
+    fbb.Map([&]() { fbb.Float("scale", scale); });
+    fbb.Finish();
+    const std::vector<uint8_t> &buffer = fbb.GetBuffer();
+    auto option_type = RankedTensorType::get(
+        {static_cast<int64_t>(buffer.size())}, rewriter.getIntegerType(8));
+    auto custom_option = OpaqueElementsAttr::get(
+        rewriter.getContext()->getLoadedDialect("tfl"), option_type,
+        StringRef(reinterpret_cast<const char *>(buffer.data()),
+                  buffer.size()));
+
+    SmallVector<Value, 4> operands = {query, key, value};
+    if (mask) operands.push_back(mask);
+    rewriter.replaceOpWithNewOp<TFL::CustomOp>(
+        output_op, TypeRange{output_type}, operands, kCustomCode,
+        custom_option);
+    return success();
+  }
+};
+
+void FuseAttentionPass::runOnOperation() {
+  RewritePatternSet patterns(&getContext());
+  patterns.add<FuseScaledDotProductAttention>(&getContext());
+  (void)applyPatternsAndFoldGreedily(getOperation(), std::move(patterns));
+}
+
+}  // namespace
+
+std::unique_ptr<OperationPass<func::FuncOp>> CreateFuseAttentionPass() {
+  return std::make_unique<FuseAttentionPass>();
+}
+
+}  // namespace TFL
+}  // namespace mlir
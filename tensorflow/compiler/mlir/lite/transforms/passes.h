@@ -192,6 +192,10 @@ CreateInsertCallOnceOpFromSessionInitializerPass();
 // Replace the tfl wrapped random function body with tfl.customOp.
 std::unique_ptr<OperationPass<func::FuncOp>> CreateLegalizeJaxRandomPass();
 
+// Creates a pass which fuses the ops of scaled dot-product attention into the
+// ScaledDotProductAttention custom op.
+std::unique_ptr<OperationPass<func::FuncOp>> CreateFuseAttentionPass();
+
 // Creates a pass which is responsible for legalizing TensorFlow variables to
 // TensorFlow Lite variables.
 std::unique_ptr<OperationPass<ModuleOp>> CreateLegalizeVariablesPass();
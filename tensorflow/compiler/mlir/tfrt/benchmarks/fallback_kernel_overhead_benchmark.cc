@@ -0,0 +1,249 @@
+/* Copyright 2022 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+// Benchmarks for the per-kernel overhead of the TFRT fallback: the ops below
+// do almost no work, so the measured time is dominated by dispatching them.
+
+#include "tensorflow/compiler/mlir/tfrt/benchmarks/benchmark_mlir_function.h"
+
+namespace tensorflow {
+namespace {
+
+static const char* const mlir_scalar_chain = R"(
+  func.func @compute(%arg0: tensor<i64>, %arg1: tensor<i64>) -> tensor<i64> {
+    %0 = "tf.AddV2"(%arg0, %arg1)
+         {device = "/job:localhost/replica:0/task:0/device:CPU:0"}
+         : (tensor<i64>, tensor<i64>) -> tensor<i64>
+    %1 = "tf.Mul"(%0, %arg1)
+         {device = "/job:localhost/replica:0/task:0/device:CPU:0"}
+         : (tensor<i64>, tensor<i64>) -> tensor<i64>
+    %2 = "tf.AddV2"(%1, %arg1)
+         {device = "/job:localhost/replica:0/task:0/device:CPU:0"}
+         : (tensor<i64>, tensor<i64>) -> tensor<i64>
+    %3 = "tf.Mul"(%2, %arg1)
+         {device = "/job:localhost/replica:0/task:0/device:CPU:0"}
+         : (tensor<i64>, tensor<i64>) -> tensor<i64>
+    %4 = "tf.AddV2"(%3, %arg1)
+         {device = "/job:localhost/replica:0/task:0/device:CPU:0"}
+         : (tensor<i64>, tensor<i64>) -> tensor<i64>
+    %5 = "tf.Mul"(%4, %arg1)
+         {device = "/job:localhost/replica:0/task:0/device:CPU:0"}
+         : (tensor<i64>, tensor<i64>) -> tensor<i64>
+    %6 = "tf.AddV2"(%5, %arg1)
+         {device = "/job:localhost/replica:0/task:0/device:CPU:0"}
+         : (tensor<i64>, tensor<i64>) -> tensor<i64>
+    %7 = "tf.Mul"(%6, %arg1)
+         {device = "/job:localhost/replica:0/task:0/device:CPU:0"}
+         : (tensor<i64>, tensor<i64>) -> tensor<i64>
+    %8 = "tf.AddV2"(%7, %arg1)
+         {device = "/job:localhost/replica:0/task:0/device:CPU:0"}
+         : (tensor<i64>, tensor<i64>) -> tensor<i64>
+    %9 = "tf.Mul"(%8, %arg1)
+         {device = "/job:localhost/replica:0/task:0/device:CPU:0"}
+         : (tensor<i64>, tensor<i64>) -> tensor<i64>
+    %10 = "tf.AddV2"(%9, %arg1)
+         {device = "/job:localhost/replica:0/task:0/device:CPU:0"}
+         : (tensor<i64>, tensor<i64>) -> tensor<i64>
+    %11 = "tf.Mul"(%10, %arg1)
+         {device = "/job:localhost/replica:0/task:0/device:CPU:0"}
+         : (tensor<i64>, tensor<i64>) -> tensor<i64>
+    %12 = "tf.AddV2"(%11, %arg1)
+         {device = "/job:localhost/replica:0/task:0/device:CPU:0"}
+         : (tensor<i64>, tensor<i64>) -> tensor<i64>
+    %13 = "tf.Mul"(%12, %arg1)
+         {device = "/job:localhost/replica:0/task:0/device:CPU:0"}
+         : (tensor<i64>, tensor<i64>) -> tensor<i64>
+    %14 = "tf.AddV2"(%13, %arg1)
+         {device = "/job:localhost/replica:0/task:0/device:CPU:0"}
+         : (tensor<i64>, tensor<i64>) -> tensor<i64>
+    %15 = "tf.Mul"(%14, %arg1)
+         {device = "/job:localhost/replica:0/task:0/device:CPU:0"}
+         : (tensor<i64>, tensor<i64>) -> tensor<i64>
+    %16 = "tf.AddV2"(%15, %arg1)
+         {device = "/job:localhost/replica:0/task:0/device:CPU:0"}
+         : (tensor<i64>, tensor<i64>) -> tensor<i64>
+    %17 = "tf.Mul"(%16, %arg1)
+         {device = "/job:localhost/replica:0/task:0/device:CPU:0"}
+         : (tensor<i64>, tensor<i64>) -> tensor<i64>
+    %18 = "tf.AddV2"(%17, %arg1)
+         {device = "/job:localhost/replica:0/task:0/device:CPU:0"}
+         : (tensor<i64>, tensor<i64>) -> tensor<i64>
+    %19 = "tf.Mul"(%18, %arg1)
+         {device = "/job:localhost/replica:0/task:0/device:CPU:0"}
+         : (tensor<i64>, tensor<i64>) -> tensor<i64>
+    %20 = "tf.AddV2"(%19, %arg1)
+         {device = "/job:localhost/replica:0/task:0/device:CPU:0"}
+         : (tensor<i64>, tensor<i64>) -> tensor<i64>
+    %21 = "tf.Mul"(%20, %arg1)
+         {device = "/job:localhost/replica:0/task:0/device:CPU:0"}
+         : (tensor<i64>, tensor<i64>) -> tensor<i64>
+    %22 = "tf.AddV2"(%21, %arg1)
+         {device = "/job:localhost/replica:0/task:0/device:CPU:0"}
+         : (tensor<i64>, tensor<i64>) -> tensor<i64>
+    %23 = "tf.Mul"(%22, %arg1)
+         {device = "/job:localhost/replica:0/task:0/device:CPU:0"}
+         : (tensor<i64>, tensor<i64>) -> tensor<i64>
+    %24 = "tf.AddV2"(%23, %arg1)
+         {device = "/job:localhost/replica:0/task:0/device:CPU:0"}
+         : (tensor<i64>, tensor<i64>) -> tensor<i64>
+    %25 = "tf.Mul"(%24, %arg1)
+         {device = "/job:localhost/replica:0/task:0/device:CPU:0"}
+         : (tensor<i64>, tensor<i64>) -> tensor<i64>
+    %26 = "tf.AddV2"(%25, %arg1)
+         {device = "/job:localhost/replica:0/task:0/device:CPU:0"}
+         : (tensor<i64>, tensor<i64>) -> tensor<i64>
+    %27 = "tf.Mul"(%26, %arg1)
+         {device = "/job:localhost/replica:0/task:0/device:CPU:0"}
+         : (tensor<i64>, tensor<i64>) -> tensor<i64>
+    %28 = "tf.AddV2"(%27, %arg1)
+         {device = "/job:localhost/replica:0/task:0/device:CPU:0"}
+         : (tensor<i64>, tensor<i64>) -> tensor<i64>
+    %29 = "tf.Mul"(%28, %arg1)
+         {device = "/job:localhost/replica:0/task:0/device:CPU:0"}
+         : (tensor<i64>, tensor<i64>) -> tensor<i64>
+    %30 = "tf.AddV2"(%29, %arg1)
+         {device = "/job:localhost/replica:0/task:0/device:CPU:0"}
+         : (tensor<i64>, tensor<i64>) -> tensor<i64>
+    %31 = "tf.Mul"(%30, %arg1)
+         {device = "/job:localhost/replica:0/task:0/device:CPU:0"}
+         : (tensor<i64>, tensor<i64>) -> tensor<i64>
+    func.return %31 : tensor<i64>
+  }
+)";
+
+static llvm::SmallVector<InputTensorSpec> InputsScalarChain() {
+  return {
+      InputTensorSpec(DT_INT64, {}),  // %arg0
+      InputTensorSpec(DT_INT64, {}),  // %arg1
+  };
+}
+
+static const char* const mlir_vector_chain = R"(
+  func.func @compute(%arg0: tensor<16xf32>,
+                     %arg1: tensor<16xf32>) -> tensor<16xf32> {
+    %0 = "tf.AddV2"(%arg0, %arg1)
+         {device = "/job:localhost/replica:0/task:0/device:CPU:0"}
+         : (tensor<16xf32>, tensor<16xf32>) -> tensor<16xf32>
+    %1 = "tf.Mul"(%0, %arg1)
+         {device = "/job:localhost/replica:0/task:0/device:CPU:0"}
+         : (tensor<16xf32>, tensor<16xf32>) -> tensor<16xf32>
+    %2 = "tf.AddV2"(%1, %arg1)
+         {device = "/job:localhost/replica:0/task:0/device:CPU:0"}
+         : (tensor<16xf32>, tensor<16xf32>) -> tensor<16xf32>
+    %3 = "tf.Mul"(%2, %arg1)
+         {device = "/job:localhost/replica:0/task:0/device:CPU:0"}
+         : (tensor<16xf32>, tensor<16xf32>) -> tensor<16xf32>
+    %4 = "tf.AddV2"(%3, %arg1)
+         {device = "/job:localhost/replica:0/task:0/device:CPU:0"}
+         : (tensor<16xf32>, tensor<16xf32>) -> tensor<16xf32>
+    %5 = "tf.Mul"(%4, %arg1)
+         {device = "/job:localhost/replica:0/task:0/device:CPU:0"}
+         : (tensor<16xf32>, tensor<16xf32>) -> tensor<16xf32>
+    %6 = "tf.AddV2"(%5, %arg1)
+         {device = "/job:localhost/replica:0/task:0/device:CPU:0"}
+         : (tensor<16xf32>, tensor<16xf32>) -> tensor<16xf32>
+    %7 = "tf.Mul"(%6, %arg1)
+         {device = "/job:localhost/replica:0/task:0/device:CPU:0"}
+         : (tensor<16xf32>, tensor<16xf32>) -> tensor<16xf32>
+    %8 = "tf.AddV2"(%7, %arg1)
+         {device = "/job:localhost/replica:0/task:0/device:CPU:0"}
+         : (tensor<16xf32>, tensor<16xf32>) -> tensor<16xf32>
+    %9 = "tf.Mul"(%8, %arg1)
+         {device = "/job:localhost/replica:0/task:0/device:CPU:0"}
+         : (tensor<16xf32>, tensor<16xf32>) -> tensor<16xf32>
+    %10 = "tf.AddV2"(%9, %arg1)
+         {device = "/job:localhost/replica:0/task:0/device:CPU:0"}
+         : (tensor<16xf32>, tensor<16xf32>) -> tensor<16xf32>
+    %11 = "tf.Mul"(%10, %arg1)
+         {device = "/job:localhost/replica:0/task:0/device:CPU:0"}
+         : (tensor<16xf32>, tensor<16xf32>) -> tensor<16xf32>
+    %12 = "tf.AddV2"(%11, %arg1)
+         {device = "/job:localhost/replica:0/task:0/device:CPU:0"}
+         : (tensor<16xf32>, tensor<16xf32>) -> tensor<16xf32>
+    %13 = "tf.Mul"(%12, %arg1)
+         {device = "/job:localhost/replica:0/task:0/device:CPU:0"}
+         : (tensor<16xf32>, tensor<16xf32>) -> tensor<16xf32>
+    %14 = "tf.AddV2"(%13, %arg1)
+         {device = "/job:localhost/replica:0/task:0/device:CPU:0"}
+         : (tensor<16xf32>, tensor<16xf32>) -> tensor<16xf32>
+    %15 = "tf.Mul"(%14, %arg1)
+         {device = "/job:localhost/replica:0/task:0/device:CPU:0"}
+         : (tensor<16xf32>, tensor<16xf32>) -> tensor<16xf32>
+    %16 = "tf.AddV2"(%15, %arg1)
+         {device = "/job:localhost/replica:0/task:0/device:CPU:0"}
+         : (tensor<16xf32>, tensor<16xf32>) -> tensor<16xf32>
+    %17 = "tf.Mul"(%16, %arg1)
+         {device = "/job:localhost/replica:0/task:0/device:CPU:0"}
+         : (tensor<16xf32>, tensor<16xf32>) -> tensor<16xf32>
+    %18 = "tf.AddV2"(%17, %arg1)
+         {device = "/job:localhost/replica:0/task:0/device:CPU:0"}
+         : (tensor<16xf32>, tensor<16xf32>) -> tensor<16xf32>
+    %19 = "tf.Mul"(%18, %arg1)
+         {device = "/job:localhost/replica:0/task:0/device:CPU:0"}
+         : (tensor<16xf32>, tensor<16xf32>) -> tensor<16xf32>
+    %20 = "tf.AddV2"(%19, %arg1)
+         {device = "/job:localhost/replica:0/task:0/device:CPU:0"}
+         : (tensor<16xf32>, tensor<16xf32>) -> tensor<16xf32>
+    %21 = "tf.Mul"(%20, %arg1)
+         {device = "/job:localhost/replica:0/task:0/device:CPU:0"}
+         : (tensor<16xf32>, tensor<16xf32>) -> tensor<16xf32>
+    %22 = "tf.AddV2"(%21, %arg1)
+         {device = "/job:localhost/replica:0/task:0/device:CPU:0"}
+         : (tensor<16xf32>, tensor<16xf32>) -> tensor<16xf32>
+    %23 = "tf.Mul"(%22, %arg1)
+         {device = "/job:localhost/replica:0/task:0/device:CPU:0"}
+         : (tensor<16xf32>, tensor<16xf32>) -> tensor<16xf32>
+    %24 = "tf.AddV2"(%23, %arg1)
+         {device = "/job:localhost/replica:0/task:0/device:CPU:0"}
+         : (tensor<16xf32>, tensor<16xf32>) -> tensor<16xf32>
+    %25 = "tf.Mul"(%24, %arg1)
+         {device = "/job:localhost/replica:0/task:0/device:CPU:0"}
+         : (tensor<16xf32>, tensor<16xf32>) -> tensor<16xf32>
+    %26 = "tf.AddV2"(%25, %arg1)
+         {device = "/job:localhost/replica:0/task:0/device:CPU:0"}
+         : (tensor<16xf32>, tensor<16xf32>) -> tensor<16xf32>
+    %27 = "tf.Mul"(%26, %arg1)
+         {device = "/job:localhost/replica:0/task:0/device:CPU:0"}
+         : (tensor<16xf32>, tensor<16xf32>) -> tensor<16xf32>
+    %28 = "tf.AddV2"(%27, %arg1)
+         {device = "/job:localhost/replica:0/task:0/device:CPU:0"}
+         : (tensor<16xf32>, tensor<16xf32>) -> tensor<16xf32>
+    %29 = "tf.Mul"(%28, %arg1)
+         {device = "/job:localhost/replica:0/task:0/device:CPU:0"}
+         : (tensor<16xf32>, tensor<16xf32>) -> tensor<16xf32>
+    %30 = "tf.AddV2"(%29, %arg1)
+         {device = "/job:localhost/replica:0/task:0/device:CPU:0"}
+         : (tensor<16xf32>, tensor<16xf32>) -> tensor<16xf32>
+    %31 = "tf.Mul"(%30, %arg1)
+         {device = "/job:localhost/replica:0/task:0/device:CPU:0"}
+         : (tensor<16xf32>, tensor<16xf32>) -> tensor<16xf32>
+    func.return %31 : tensor<16xf32>
+  }
+)";
+
+static llvm::SmallVector<InputTensorSpec> InputsVectorChain() {
+  return {
+      InputTensorSpec(DT_FLOAT, {16}),  // %arg0
+      InputTensorSpec(DT_FLOAT, {16}),  // %arg1
+  };
+}
+
+#define BM(FN) BM_##FN->Arg(0)->Arg(4);
+
+BM(Tfrt(ScalarChain32, mlir_scalar_chain, "compute", InputsScalarChain()));
+BM(Tfrt(VectorChain32, mlir_vector_chain, "compute", InputsVectorChain()));
+
+}  // namespace
+}  // namespace tensorflow
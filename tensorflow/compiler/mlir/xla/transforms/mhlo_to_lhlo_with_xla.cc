@@ -364,6 +364,10 @@ StatusOr<mlir::Operation*> LhloDialectEmitter::EmitOp(
       return EmitCollectivePermuteOp(instr);
     case HloOpcode::kConditional:
       return EmitCaseOp(instr);
+    case HloOpcode::kCopyStart:
+      return EmitCopyStartOp(instr);
+    case HloOpcode::kCopyDone:
+      return EmitCopyDoneOp(instr);
     case HloOpcode::kFft:
       return EmitFftOp(instr);
     case HloOpcode::kGetTupleElement:
@@ -1165,6 +1169,38 @@ StatusOr<lmhlo_gpu::AllReduceDoneOp> LhloDialectEmitter::EmitAllReduceDoneOp(
       getLocation(instr), /*resultTypes=*/llvm::None, operands);
 }
 
+StatusOr<lmhlo_gpu::CopyStartOp> LhloDialectEmitter::EmitCopyStartOp(
+    const HloInstruction* instr) {
+  llvm::SmallVector<Value, 2> operands;
+  TF_RETURN_IF_ERROR(GetOrCreateView(instr->operand(0), &operands));
+  // The other outputs are the operand and the copy context, which need no
+  // buffers of their own.
+  TF_RETURN_IF_ERROR(GetOrCreateView(instr, &operands, /*result_subset=*/{0}));
+
+  mlir::Type token_type = mlir::mhlo::TokenType::get(builder_.getContext());
+  std::array<mlir::Type, 1> result_types = {token_type};
+  auto copy_start_op = builder_.create<lmhlo_gpu::CopyStartOp>(
+      getLocation(instr), result_types, operands);
+  TF_RET_CHECK(copy_start_ops_.emplace(instr, copy_start_op).second)
+      << "copy-start already lowered";
+  return copy_start_op;
+}
+
+StatusOr<lmhlo_gpu::CopyDoneOp> LhloDialectEmitter::EmitCopyDoneOp(
+    const HloInstruction* instr) {
+  auto it = copy_start_ops_.find(instr->operand(0));
+  TF_RET_CHECK(it != copy_start_ops_.end()) << "didn't find copy-start op";
+
+  llvm::SmallVector<Value, 2> operands;
+  operands.push_back(it->second.getToken());
+  copy_start_ops_.erase(it);
+
+  // The output aliases the destination of the copy-start.
+  TF_RETURN_IF_ERROR(GetOrCreateView(instr, &operands));
+  return builder_.create<lmhlo_gpu::CopyDoneOp>(
+      getLocation(instr), /*resultTypes=*/llvm::None, operands);
+}
+
 StatusOr<lmhlo::ReduceScatterOp> LhloDialectEmitter::EmitReduceScatterOp(
     const HloInstruction* instr) {
   TF_ASSIGN_OR_RETURN(auto reduce_scatter_op,
@@ -1641,7 +1677,8 @@ std::unique_ptr<OperationPass<ModuleOp>> createXlaHloToLhloWithXlaPass() {
 }
 
 Status HloToLhloModule(const BufferAssignment& assignment,
-                       const HloModule& hlo_module, ModuleOp module) {
+                       const HloModule& hlo_module, ModuleOp module,
+                       const xla::HloInstructionSequence* entry_sequence) {
   module.getContext()
       ->loadDialect<arith::ArithmeticDialect,
                     bufferization::BufferizationDialect, func::FuncDialect,
@@ -1662,7 +1699,8 @@ Status HloToLhloModule(const BufferAssignment& assignment,
   TF_RETURN_IF_ERROR(emitter.Initialize());
 
   const xla::HloInstructionSequence* schedule =
-      assignment.hlo_ordering().SequentialOrder(*computation);
+      entry_sequence ? entry_sequence
+                     : assignment.hlo_ordering().SequentialOrder(*computation);
   if (!schedule)
     return xla::Unimplemented("Missing sequential order for the computation");
 
@@ -93,6 +93,10 @@ class LhloDialectEmitter : public xla::ConstDfsHloVisitorWithDefault {
       const xla::HloInstruction* instr);
   xla::StatusOr<lmhlo::ReduceScatterOp> EmitReduceScatterOp(
       const xla::HloInstruction* instr);
+  xla::StatusOr<lmhlo_gpu::CopyStartOp> EmitCopyStartOp(
+      const xla::HloInstruction* instr);
+  xla::StatusOr<lmhlo_gpu::CopyDoneOp> EmitCopyDoneOp(
+      const xla::HloInstruction* instr);
   xla::StatusOr<lmhlo::CollectivePermuteOp> EmitCollectivePermuteOp(
       const xla::HloInstruction* instr);
 
@@ -265,14 +269,25 @@ class LhloDialectEmitter : public xla::ConstDfsHloVisitorWithDefault {
   // all-reduce-done op with the correct token.
   absl::flat_hash_map<const xla::HloInstruction*, lmhlo_gpu::AllReduceStartOp>
       all_reduce_start_ops_;
+
+  // Map copy-start ops to their LHLO op, so we can connect the copy-done op
+  // with the correct token.
+  absl::flat_hash_map<const xla::HloInstruction*, lmhlo_gpu::CopyStartOp>
+      copy_start_ops_;
 };
 
 // Populate the MLIR `module` with the computation from the `hlo_module` using
 // the provided buffer `assignment`. The returned `Status` indicates success
 // or failure in the conversion.
-tensorflow::Status HloToLhloModule(const xla::BufferAssignment& assignment,
-                                   const xla::HloModule& hlo_module,
-                                   ModuleOp module);
+//
+// The entry computation is imported in `entry_sequence`, if given, and in the
+// sequential order of the buffer assignment otherwise. The former is needed
+// when the entry computation is only partially ordered, e.g. because it runs
+// on several streams.
+tensorflow::Status HloToLhloModule(
+    const xla::BufferAssignment& assignment, const xla::HloModule& hlo_module,
+    ModuleOp module,
+    const xla::HloInstructionSequence* entry_sequence = nullptr);
 
 tensorflow::Status OptimizeAndConvertHloToLmhlo(
     std::unique_ptr<xla::HloModule> hlo_module, ModuleOp module,
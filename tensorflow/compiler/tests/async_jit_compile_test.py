@@ -0,0 +1,61 @@
+# Copyright 2017 The TensorFlow Authors. All Rights Reserved.
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+# ==============================================================================
+"""Tests for asynchronous compilation of functions with jit_compile=True."""
+
+import os
+
+import numpy as np
+
+from tensorflow.python.eager import def_function
+from tensorflow.python.eager import test
+from tensorflow.python.framework import constant_op
+from tensorflow.python.framework import dtypes
+from tensorflow.python.ops import math_ops
+from tensorflow.python.ops import variables
+
+
+class AsyncJitCompileTest(test.TestCase):
+
+  # The first calls run with the TF kernels while the function compiles, and
+  # the later calls with the compiled executable. Both must give the same
+  # results.
+  def testResultsAcrossCompilation(self):
+
+    @def_function.function(jit_compile=True)
+    def f(x):
+      return math_ops.log(x) * 2.
+
+    x = constant_op.constant([1., 2., 3.])
+    for _ in range(50):
+      self.assertAllClose(np.log([1., 2., 3.]) * 2., f(x))
+
+  def testVariableUpdatesAcrossCompilation(self):
+    v = variables.Variable(0., dtype=dtypes.float32)
+
+    @def_function.function(jit_compile=True)
+    def f(x):
+      v.assign_add(x)
+      return v.read_value()
+
+    for i in range(1, 51):
+      self.assertAllClose(float(i), f(constant_op.constant(1.)))
+    self.assertAllClose(50., v.numpy())
+
+
+if __name__ == "__main__":
+  os.environ["TF_XLA_FLAGS"] = (
+      "--tf_xla_async_compilation_for_jit_compile=true " +
+      os.environ.get("TF_XLA_FLAGS", ""))
+  test.main()
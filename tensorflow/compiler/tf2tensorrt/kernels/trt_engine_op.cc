@@ -27,6 +27,7 @@ limitations under the License.
 #include "tensorflow/compiler/tf2tensorrt/utils/trt_engine_utils.h"
 #include "tensorflow/compiler/tf2tensorrt/utils/trt_logger.h"
 #include "tensorflow/compiler/tf2tensorrt/utils/trt_lru_cache.h"
+#include "tensorflow/compiler/tf2tensorrt/utils/trt_persistent_engine_cache.h"
 #include "tensorflow/compiler/tf2tensorrt/utils/trt_shape_optimization_profiles.h"
 #include "tensorflow/core/common_runtime/function.h"
 #include "tensorflow/core/common_runtime/graph_constructor.h"
@@ -40,8 +41,10 @@ limitations under the License.
 #include "tensorflow/core/grappler/clusters/utils.h"
 #include "tensorflow/core/grappler/clusters/virtual_cluster.h"
 #include "tensorflow/core/lib/core/refcount.h"
+#include "tensorflow/core/lib/strings/proto_serialization.h"
 #include "tensorflow/core/lib/strings/str_util.h"
 #include "tensorflow/core/lib/strings/strcat.h"
+#include "tensorflow/core/platform/fingerprint.h"
 #include "tensorflow/core/platform/logging.h"
 #include "tensorflow/core/platform/mutex.h"
 #include "tensorflow/core/platform/stream_executor.h"
@@ -193,6 +196,19 @@ class TRTEngineOp : public AsyncOpKernel {
       bool use_calibration, TRTInt8Calibrator* calibrator,
       TRTEngineCacheResource* cache_resource, OpKernelContext* ctx);
 
+  // Returns the key identifying the engine built for the given conversion
+  // input shapes in the persistent engine cache.
+  string PersistentEngineCacheKey(
+      const std::vector<PartialTensorShape>& conversion_input_shapes,
+      int batch_size, TRTEngineCacheResource* cache_resource,
+      OpKernelContext* ctx);
+
+  // Looks up the engine for `key` in the persistent engine cache. Returns
+  // nullptr if there is no usable engine.
+  TrtUniquePtrType<nvinfer1::ICudaEngine> LookupPersistentEngine(
+      const string& key, TRTEngineCacheResource* cache_resource,
+      OpKernelContext* ctx);
+
   // Verify that the input shapes are consistent and can be handled by this op.
   Status VerifyInputShapes(const std::vector<TensorShape>& shapes);
 
@@ -263,6 +279,10 @@ class TRTEngineOp : public AsyncOpKernel {
 
   // Whether to use explicit precision (QDQ) mode.
   bool use_explicit_precision_;
+
+  // The cache of engines persisted across process restarts, or nullptr if the
+  // persistent engine cache is disabled.
+  std::unique_ptr<PersistentEngineCache> persistent_cache_;
 };
 
 #define TYPECASE(dt, X, Y)                                    \
@@ -433,6 +453,11 @@ TRTEngineOp::TRTEngineOp(OpKernelConstruction* context)
   if (!static_engine_) {
     OP_REQUIRES_OK(context, ImportSegmentGraphDef(context->function_library(),
                                                   context->device()->name()));
+    const string cache_dir = GetPersistentEngineCacheDir();
+    if (!cache_dir.empty()) {
+      persistent_cache_ =
+          std::make_unique<PersistentEngineCache>(context->env(), cache_dir);
+    }
   }
   // TODO(laigd): calibration_data is used in TF v1.x and we keep it only for
   // backward compatibility reasons. Remove it once all known users switch to
@@ -1016,6 +1041,17 @@ StatusOr<TrtUniquePtrType<nvinfer1::ICudaEngine>> TRTEngineOp::BuildEngine(
                                             input_concrete_shapes.end())
           : input_partial_shapes_;
 
+  // Engines built for calibration are only used to collect the calibration
+  // data, so they are not persisted.
+  string persistent_cache_key;
+  if (persistent_cache_ && !use_calibration) {
+    persistent_cache_key = PersistentEngineCacheKey(
+        conversion_input_shapes, batch_size, cache_resource, ctx);
+    TrtUniquePtrType<nvinfer1::ICudaEngine> engine =
+        LookupPersistentEngine(persistent_cache_key, cache_resource, ctx);
+    if (engine) return engine;
+  }
+
   VLOG(1) << "Building a new TensorRT engine for " << name()
           << " with input shapes: " << DebugString(conversion_input_shapes);
 
@@ -1043,6 +1079,98 @@ StatusOr<TrtUniquePtrType<nvinfer1::ICudaEngine>> TRTEngineOp::BuildEngine(
                                    std::make_unique<EngineContext>());
     return status;
   }
+  if (!persistent_cache_key.empty()) {
+    TrtUniquePtrType<nvinfer1::IHostMemory> engine_data(engine->serialize());
+    TRTEngineInstance engine_instance;
+    for (const TensorShape& shape : input_concrete_shapes) {
+      shape.AsProto(engine_instance.add_input_shapes());
+    }
+    engine_instance.set_serialized_engine(engine_data->data(),
+                                          engine_data->size());
+    Status insert_status = persistent_cache_->Insert(
+        persistent_cache_key, std::move(engine_instance));
+    if (!insert_status.ok()) {
+      LOG_FIRST_FEW_WARNING_WITH_PREFIX
+          << "Failed to store the TensorRT engine for " << name()
+          << " in the persistent engine cache: " << insert_status;
+    }
+  }
+  return engine;
+}
+
+string TRTEngineOp::PersistentEngineCacheKey(
+    const std::vector<PartialTensorShape>& conversion_input_shapes,
+    int batch_size, TRTEngineCacheResource* cache_resource,
+    OpKernelContext* ctx) {
+  string serialized_segment;
+  SerializeToStringDeterministic(segment_graph_def_, &serialized_segment);
+  auto linked_version = GetLinkedTensorRTVersion();
+  auto loaded_version = GetLoadedTensorRTVersion();
+  const se::DeviceDescription& device_description =
+      ctx->op_device_context()->stream()->parent()->GetDeviceDescription();
+  string key = StrCat(
+      "segment: ", Fingerprint64(serialized_segment),
+      ", trt_linked: ", std::get<0>(linked_version), ".",
+      std::get<1>(linked_version), ".", std::get<2>(linked_version),
+      ", trt_loaded: ", std::get<0>(loaded_version), ".",
+      std::get<1>(loaded_version), ".", std::get<2>(loaded_version),
+      ", gpu: ", device_description.name(), " ",
+      device_description.cuda_compute_capability().ToString(),
+      ", precision: ", static_cast<int>(precision_mode_),
+      ", implicit_batch: ", use_implicit_batch_,
+      ", explicit_precision: ", use_explicit_precision_,
+      ", workspace: ", workspace_size_,
+      ", input_shapes: ", DebugString(conversion_input_shapes));
+  if (use_implicit_batch_) {
+    StrAppend(&key, ", batch_size: ", batch_size);
+  } else {
+    StrAppend(&key, ", profiles: ",
+              cache_resource->profiles_.ProfilesDebugString());
+  }
+  return key;
+}
+
+TrtUniquePtrType<nvinfer1::ICudaEngine> TRTEngineOp::LookupPersistentEngine(
+    const string& key, TRTEngineCacheResource* cache_resource,
+    OpKernelContext* ctx) {
+  TRTEngineInstance engine_instance;
+  Status status = persistent_cache_->Lookup(key, &engine_instance);
+  if (!status.ok()) {
+    if (!errors::IsNotFound(status)) {
+      LOG_FIRST_FEW_WARNING_WITH_PREFIX
+          << "Failed to read the persistent engine cache for " << name()
+          << ": " << status;
+    }
+    return nullptr;
+  }
+  TrtUniquePtrType<IRuntime> infer(nvinfer1::createInferRuntime(logger));
+  infer->setGpuAllocator(cache_resource->allocator_.get());
+  // Need to initialize plugins in order to deserialize engines that contain
+  // plugins.
+  MaybeInitializeTrtPlugins(&logger);
+  TrtUniquePtrType<nvinfer1::ICudaEngine> engine(infer->deserializeCudaEngine(
+      engine_instance.serialized_engine().c_str(),
+      engine_instance.serialized_engine().size(), nullptr));
+  if (!engine) {
+    LOG_FIRST_FEW_WARNING_WITH_PREFIX
+        << "Failed to deserialize the cached TensorRT engine for " << name()
+        << ", building a new one.";
+    return nullptr;
+  }
+  if (!use_implicit_batch_) {
+    // The profiles of the deserialized engine replace the ones collected by
+    // this op, which describe the same shapes.
+    status = cache_resource->profiles_.RestoreProfiles(engine.get(),
+                                                       ctx->num_inputs());
+    if (!status.ok()) {
+      LOG_FIRST_FEW_WARNING_WITH_PREFIX
+          << "Failed to restore the profiles of the cached TensorRT engine for "
+          << name() << ": " << status;
+      return nullptr;
+    }
+  }
+  VLOG(1) << "Loaded the TensorRT engine for " << name()
+          << " from the persistent engine cache.";
   return engine;
 }
 
@@ -0,0 +1,108 @@
+/* Copyright 2022 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/compiler/tf2tensorrt/utils/trt_persistent_engine_cache.h"
+
+#include <memory>
+#include <utility>
+
+#include "absl/strings/str_cat.h"
+#include "tensorflow/core/lib/io/path.h"
+#include "tensorflow/core/lib/io/record_reader.h"
+#include "tensorflow/core/lib/io/record_writer.h"
+#include "tensorflow/core/platform/errors.h"
+#include "tensorflow/core/platform/fingerprint.h"
+#include "tensorflow/core/platform/logging.h"
+#include "tensorflow/core/util/env_var.h"
+
+namespace tensorflow {
+namespace tensorrt {
+
+std::string GetPersistentEngineCacheDir() {
+  std::string cache_dir;
+  Status status = ReadStringFromEnvVar("TF_TRT_PERSISTENT_ENGINE_CACHE_DIR",
+                                       /*default_val=*/"", &cache_dir);
+  if (!status.ok()) {
+    LOG(ERROR) << status;
+  }
+  return cache_dir;
+}
+
+PersistentEngineCache::PersistentEngineCache(Env* env, std::string cache_dir)
+    : env_(env), cache_dir_(std::move(cache_dir)) {}
+
+std::string PersistentEngineCache::FileName(absl::string_view key) const {
+  return io::JoinPath(
+      cache_dir_,
+      absl::StrCat(absl::Hex(Fingerprint64(key), absl::kZeroPad16),
+                   ".trtengine"));
+}
+
+Status PersistentEngineCache::Lookup(
+    absl::string_view key, TRTEngineInstance* engine_instance) const {
+  const std::string filename = FileName(key);
+  Status status = env_->FileExists(filename);
+  if (!status.ok()) {
+    return errors::NotFound("No cached TensorRT engine in ", filename);
+  }
+
+  std::unique_ptr<RandomAccessFile> file;
+  TF_RETURN_IF_ERROR(env_->NewRandomAccessFile(filename, &file));
+  io::RecordReader reader(file.get());
+  uint64 offset = 0;
+  tstring record;
+  TF_RETURN_IF_ERROR(reader.ReadRecord(&offset, &record));
+  if (!engine_instance->ParseFromString(record)) {
+    return errors::DataLoss("Failed to parse the TensorRT engine in ",
+                            filename);
+  }
+  if (engine_instance->cache_key() != key) {
+    // A fingerprint collision, treat it as a miss.
+    return errors::NotFound("The TensorRT engine in ", filename,
+                            " was cached for a different key");
+  }
+  return Status::OK();
+}
+
+Status PersistentEngineCache::Insert(
+    absl::string_view key, TRTEngineInstance engine_instance) const {
+  TF_RETURN_IF_ERROR(env_->RecursivelyCreateDir(cache_dir_));
+  engine_instance.set_cache_key(std::string(key));
+
+  const std::string filename = FileName(key);
+  std::string tmp_filename = filename;
+  if (!env_->CreateUniqueFileName(&tmp_filename, ".tmp")) {
+    return errors::Internal("Failed to create a temporary file name for ",
+                            filename);
+  }
+  {
+    std::unique_ptr<WritableFile> file;
+    TF_RETURN_IF_ERROR(env_->NewWritableFile(tmp_filename, &file));
+    io::RecordWriter writer(file.get());
+    TF_RETURN_IF_ERROR(writer.WriteRecord(engine_instance.SerializeAsString()));
+    TF_RETURN_IF_ERROR(writer.Close());
+    TF_RETURN_IF_ERROR(file->Close());
+  }
+  Status status = env_->RenameFile(tmp_filename, filename);
+  if (!status.ok()) {
+    env_->DeleteFile(tmp_filename).IgnoreError();
+    return status;
+  }
+  VLOG(1) << "Cached TensorRT engine in " << filename;
+  return Status::OK();
+}
+
+}  // namespace tensorrt
+}  // namespace tensorflow
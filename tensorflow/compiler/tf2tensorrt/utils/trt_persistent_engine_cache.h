@@ -0,0 +1,73 @@
+/* Copyright 2022 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_COMPILER_TF2TENSORRT_UTILS_TRT_PERSISTENT_ENGINE_CACHE_H_
+#define TENSORFLOW_COMPILER_TF2TENSORRT_UTILS_TRT_PERSISTENT_ENGINE_CACHE_H_
+
+#include <string>
+
+#include "absl/strings/string_view.h"
+#include "tensorflow/compiler/tf2tensorrt/utils/trt_engine_instance.pb.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/status.h"
+
+namespace tensorflow {
+namespace tensorrt {
+
+// Returns the directory of the persistent engine cache, which is set with the
+// TF_TRT_PERSISTENT_ENGINE_CACHE_DIR environment variable. Returns an empty
+// string if the persistent engine cache is disabled.
+std::string GetPersistentEngineCacheDir();
+
+// A cache of serialized TensorRT engines stored as files in a directory, so
+// that the engines built by TRTEngineOp are reused across process restarts.
+//
+// Each engine is stored in its own file, named after the fingerprint of the
+// cache key. The key must identify everything the engine depends on, e.g. the
+// segment graph, the engine input shapes or optimization profiles, the TensorRT
+// version and the GPU. The full key is stored with the engine and verified on
+// lookup.
+//
+// Engines are written to a temporary file which is then renamed, so that
+// several processes can share a cache directory: a reader sees either no file
+// or a complete one, and concurrent writers of the same key write identical
+// engines.
+//
+// This class is thread safe.
+class PersistentEngineCache {
+ public:
+  PersistentEngineCache(Env* env, std::string cache_dir);
+
+  // Reads the engine cached for `key` into `engine_instance`. Returns NotFound
+  // if there is no engine for `key`.
+  Status Lookup(absl::string_view key,
+                TRTEngineInstance* engine_instance) const;
+
+  // Stores `engine_instance` as the engine for `key`, replacing any existing
+  // one.
+  Status Insert(absl::string_view key, TRTEngineInstance engine_instance) const;
+
+  // Returns the name of the file that caches the engine for `key`.
+  std::string FileName(absl::string_view key) const;
+
+ private:
+  Env* const env_;
+  const std::string cache_dir_;
+};
+
+}  // namespace tensorrt
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_COMPILER_TF2TENSORRT_UTILS_TRT_PERSISTENT_ENGINE_CACHE_H_
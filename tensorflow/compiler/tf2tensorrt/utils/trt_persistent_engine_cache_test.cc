@@ -0,0 +1,82 @@
+/* Copyright 2022 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/compiler/tf2tensorrt/utils/trt_persistent_engine_cache.h"
+
+#include <vector>
+
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/lib/io/path.h"
+#include "tensorflow/core/platform/errors.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace tensorrt {
+namespace {
+
+TEST(PersistentEngineCacheTest, InsertAndLookup) {
+  Env* env = Env::Default();
+  const std::string cache_dir =
+      io::JoinPath(testing::TmpDir(), "trt_persistent_engine_cache");
+  PersistentEngineCache cache(env, cache_dir);
+
+  TRTEngineInstance engine_instance;
+  EXPECT_TRUE(errors::IsNotFound(cache.Lookup("key", &engine_instance)));
+
+  TRTEngineInstance inserted;
+  TensorShape({2, 3}).AsProto(inserted.add_input_shapes());
+  inserted.set_serialized_engine("engine");
+  TF_ASSERT_OK(cache.Insert("key", inserted));
+  TF_ASSERT_OK(cache.Lookup("key", &engine_instance));
+  EXPECT_EQ(engine_instance.serialized_engine(), "engine");
+  ASSERT_EQ(engine_instance.input_shapes_size(), 1);
+  EXPECT_EQ(TensorShape(engine_instance.input_shapes(0)), TensorShape({2, 3}));
+  EXPECT_TRUE(
+      errors::IsNotFound(cache.Lookup("other_key", &engine_instance)));
+
+  // Another cache on the same directory, e.g. after a restart, finds the
+  // engine, and replaces it.
+  PersistentEngineCache other_cache(env, cache_dir);
+  TF_ASSERT_OK(other_cache.Lookup("key", &engine_instance));
+  EXPECT_EQ(engine_instance.serialized_engine(), "engine");
+  inserted.set_serialized_engine("new_engine");
+  TF_ASSERT_OK(other_cache.Insert("key", inserted));
+  TF_ASSERT_OK(cache.Lookup("key", &engine_instance));
+  EXPECT_EQ(engine_instance.serialized_engine(), "new_engine");
+
+  // No temporary file is left behind.
+  std::vector<std::string> children;
+  TF_ASSERT_OK(env->GetChildren(cache_dir, &children));
+  EXPECT_EQ(children.size(), 1);
+}
+
+TEST(PersistentEngineCacheTest, KeyMismatch) {
+  Env* env = Env::Default();
+  PersistentEngineCache cache(
+      env, io::JoinPath(testing::TmpDir(), "trt_persistent_engine_cache_key"));
+  TRTEngineInstance engine_instance;
+  TF_ASSERT_OK(cache.Insert("key", engine_instance));
+
+  // Overwrite the file with an engine cached for another key, as if the two
+  // keys had the same fingerprint.
+  TF_ASSERT_OK(cache.Insert("other_key", engine_instance));
+  TF_ASSERT_OK(
+      env->RenameFile(cache.FileName("other_key"), cache.FileName("key")));
+  EXPECT_TRUE(errors::IsNotFound(cache.Lookup("key", &engine_instance)));
+}
+
+}  // namespace
+}  // namespace tensorrt
+}  // namespace tensorflow
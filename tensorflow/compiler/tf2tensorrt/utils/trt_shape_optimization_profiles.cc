@@ -593,6 +593,7 @@ Status TrtShapeOptimizationProfile::RestoreProfiles(
 
   TF_RETURN_IF_ERROR(SetPrunedMask(engine, n_network_inputs));
 
+  profiles_.clear();
   for (int prof_idx = 0; prof_idx < n_profiles; prof_idx++) {
     OptimizationProfileConfig cfg;
 
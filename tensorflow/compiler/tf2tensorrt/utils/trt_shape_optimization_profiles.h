@@ -232,7 +232,8 @@ class TrtShapeOptimizationProfile {
   bool HasShape() const { return !input_shapes_.empty(); }
   bool NeedProfiles() const { return need_profiles_; }
 
-  // Restores profiles from the engine (used after deserialization).
+  // Restores profiles from the engine (used after deserialization), replacing
+  // any existing profiles.
   Status RestoreProfiles(const nvinfer1::ICudaEngine* engine,
                          int n_network_inputs);
 
@@ -250,6 +251,16 @@ class TrtShapeOptimizationProfile {
     // FixShapeValueProfile workaround is turned off.
   }
 
+  // Returns a string describing all the optimization profiles, which is used
+  // to identify the engine built for them.
+  string ProfilesDebugString() const {
+    string result;
+    for (const auto& profile : profiles_) {
+      absl::StrAppend(&result, profile.DebugString());
+    }
+    return result;
+  }
+
  private:
   // Set of input shape vetors that we collect during profile_generation_mode.
   std::vector<std::vector<TensorShape>> input_shapes_;
@@ -57,6 +57,8 @@ limitations under the License.
 #include "tensorflow/core/lib/core/errors.h"
 #include "tensorflow/core/lib/gtl/cleanup.h"
 #include "tensorflow/core/lib/hash/hash.h"
+#include "tensorflow/core/lib/strings/proto_serialization.h"
+#include "tensorflow/core/platform/fingerprint.h"
 #include "tensorflow/core/platform/logging.h"
 #include "tensorflow/core/protobuf/error_codes.pb.h"
 #include "tensorflow/core/protobuf/graph_debug_info.pb.h"
@@ -543,6 +545,22 @@ uint64 XlaCompiler::SignatureHash::operator()(
   return std::hash<string>()(signature.first);
 }
 
+uint64 XlaCompiler::BodySignatureHash::operator()(
+    const std::pair<uint64, std::vector<Argument>>& signature) const {
+  return signature.first;
+}
+
+/* static */ uint64 XlaCompiler::FunctionBodyFingerprint(
+    const NameAttrList& fn_name_attrs, const FunctionBody& fbody) {
+  FunctionDef fdef = fbody.fdef;
+  fdef.mutable_signature()->clear_name();
+  string serialized;
+  SerializeToStringDeterministic(fdef, &serialized);
+  return Hash64Combine(
+      Fingerprint64(serialized),
+      Fingerprint64(Canonicalize("", AttrSlice(&fn_name_attrs.attr()))));
+}
+
 static Status GetFunctionBody(const NameAttrList& function,
                               FunctionLibraryRuntime* flib_runtime,
                               const FunctionBody** fbody) {
@@ -756,6 +774,17 @@ Status XlaCompiler::CompileFunction(
       CheckSignature(fbody->arg_types, args),
       "Signature check failure while compiling: ", fn_name_attrs.name());
 
+  const uint64 body_fingerprint =
+      FunctionBodyFingerprint(fn_name_attrs, *fbody);
+  auto body_it = body_cache_.find({body_fingerprint, arg_vector});
+  if (body_it != body_cache_.end()) {
+    VLOG(1) << "Reusing the compilation of an identical function body for "
+            << function_id;
+    *result = body_it->second;
+    cache_[{function_id, arg_vector}] = *result;
+    return OkStatus();
+  }
+
   // Set shapes for _Arg nodes. They are useful for constant folding (e.g. an
   // Xla op requires a compile-time constant input, and that input is shape of
   // an _Arg node.
@@ -839,6 +868,7 @@ Status XlaCompiler::CompileFunction(
   VLOG(1) << "====================================================";
 
   cache_[{function_id, arg_vector}] = *result;
+  body_cache_[{body_fingerprint, arg_vector}] = *result;
   return OkStatus();
 }
 
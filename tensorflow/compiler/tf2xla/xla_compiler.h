@@ -360,6 +360,24 @@ class XlaCompiler {
                      CompilationResult, SignatureHash>
       cache_;
 
+  // Returns the fingerprint of the body of `fbody`, instantiated with the
+  // attributes of `fn_name_attrs`. Functions with different names but the same
+  // body have the same fingerprint.
+  static uint64 FunctionBodyFingerprint(const NameAttrList& fn_name_attrs,
+                                        const FunctionBody& fbody);
+
+  struct BodySignatureHash {
+    uint64 operator()(
+        const std::pair<uint64, std::vector<Argument>>& signature) const;
+  };
+
+  // Compiled functions keyed by the fingerprint of their body, so that
+  // identical function bodies, e.g. the bodies of functions cloned for each
+  // call site, are only compiled once.
+  std::unordered_map<std::pair<uint64, std::vector<Argument>>,
+                     CompilationResult, BodySignatureHash>
+      body_cache_;
+
   std::unordered_map<string, xla::ChannelHandle> channels_;
 
   std::unordered_map<string, tf2xla::HostTransferMetadata> host_compute_sends_;
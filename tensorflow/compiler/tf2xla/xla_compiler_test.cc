@@ -1025,6 +1025,43 @@ TEST_F(XlaCompilerTest, LocalFunctionWithWrongArgumentsFail) {
       << status.error_message();
 }
 
+// Tests that functions with identical bodies are only compiled once.
+TEST_F(XlaCompilerTest, IdenticalFunctionBodiesAreCompiledOnce) {
+  XlaCompiler compiler(DefaultOptions());
+
+  auto local_flib_def = LocalFlibDef(&compiler);
+  FunctionDef copy = test::function::XTimesTwo();
+  copy.mutable_signature()->set_name("XTimesTwoCopy");
+  TF_ASSERT_OK(local_flib_def->AddFunctionDef(test::function::XTimesTwo()));
+  TF_ASSERT_OK(local_flib_def->AddFunctionDef(copy));
+
+  std::vector<XlaCompiler::Argument> args(1);
+  args[0].kind = XlaCompiler::Argument::kParameter;
+  args[0].type = DT_FLOAT;
+  args[0].shape = TensorShape({2});
+
+  NameAttrList name_attr;
+  name_attr.set_name("XTimesTwo");
+  (*name_attr.mutable_attr())["T"].set_type(DT_FLOAT);
+  XlaCompiler::CompilationResult result;
+  TF_ASSERT_OK(compiler.CompileFunction(XlaCompiler::CompileOptions(),
+                                        name_attr, args, &result));
+
+  NameAttrList copy_name_attr = name_attr;
+  copy_name_attr.set_name("XTimesTwoCopy");
+  XlaCompiler::CompilationResult copy_result;
+  TF_ASSERT_OK(compiler.CompileFunction(XlaCompiler::CompileOptions(),
+                                        copy_name_attr, args, &copy_result));
+  EXPECT_EQ(result.computation, copy_result.computation);
+
+  // Instantiating the body with other attributes compiles it again.
+  (*copy_name_attr.mutable_attr())["T"].set_type(DT_INT32);
+  args[0].type = DT_INT32;
+  TF_ASSERT_OK(compiler.CompileFunction(XlaCompiler::CompileOptions(),
+                                        copy_name_attr, args, &copy_result));
+  EXPECT_NE(result.computation, copy_result.computation);
+}
+
 FunctionDef SliceFn() {
   return FunctionDefHelper::Define(
       // Name
@@ -97,6 +97,7 @@ DebugOptions DefaultDebugOptionsIgnoringFlags() {
   opts.set_xla_gpu_redzone_scratch_max_megabytes(1LL << 12);
   opts.set_xla_gpu_shape_checks(DebugOptions::RUNTIME);
   opts.set_xla_cpu_enable_mlir_lowering(false);
+  opts.set_xla_cpu_parallel_codegen_split_count(0);
   opts.set_xla_gpu_enable_mlir_lowering(false);
   opts.set_xla_gpu_normalize_layouts(false);
   return opts;
@@ -623,6 +624,20 @@ static void AllocateFlags() {
       flag_values->xla_gpu_algorithm_denylist_path(),
       "An AlgorithmDenylist text proto file as a denylist of convolutions to "
       "avoid to use."));
+  flag_objects->push_back(tensorflow::Flag(
+      "xla_gpu_load_autotune_results_from",
+      string_setter_for(
+          &DebugOptions::set_xla_gpu_load_autotune_results_from),
+      flag_values->xla_gpu_load_autotune_results_from(),
+      "Comma-separated AutotuneResults files to load before the first GPU "
+      "compilation. The autotuning of the convolutions and GEMMs in them is "
+      "skipped."));
+  flag_objects->push_back(tensorflow::Flag(
+      "xla_gpu_dump_autotune_results_to",
+      string_setter_for(&DebugOptions::set_xla_gpu_dump_autotune_results_to),
+      flag_values->xla_gpu_dump_autotune_results_to(),
+      "File to write the autotuning results of the process to after each GPU "
+      "compilation, as a text proto if it ends with .pbtxt."));
   flag_objects->push_back(tensorflow::Flag(
       "xla_tpu_detect_nan",
       bool_setter_for(&DebugOptions::set_xla_tpu_detect_nan),
@@ -703,6 +718,43 @@ static void AllocateFlags() {
       bool_setter_for(&DebugOptions::set_xla_gpu_enable_cudnn_frontend),
       flag_values->xla_gpu_enable_cudnn_frontend(),
       "Use the cuDNN frontend API for convolutions when possible."));
+  flag_objects->push_back(tensorflow::Flag(
+      "xla_gpu_enable_cuda_graphs",
+      bool_setter_for(&DebugOptions::set_xla_gpu_enable_cuda_graphs),
+      flag_values->xla_gpu_enable_cuda_graphs(),
+      "Replay the thunks of GPU executables with CUDA graphs when all of them "
+      "can be captured."));
+  flag_objects->push_back(tensorflow::Flag(
+      "xla_gpu_enable_latency_hiding_scheduler",
+      bool_setter_for(
+          &DebugOptions::set_xla_gpu_enable_latency_hiding_scheduler),
+      flag_values->xla_gpu_enable_latency_hiding_scheduler(),
+      "Overlap asynchronous collectives with independent compute in the GPU "
+      "schedule."));
+  flag_objects->push_back(tensorflow::Flag(
+      "xla_gpu_enable_rematerialization",
+      bool_setter_for(&DebugOptions::set_xla_gpu_enable_rematerialization),
+      flag_values->xla_gpu_enable_rematerialization(),
+      "Rematerialize instructions so that the peak memory of the GPU schedule "
+      "fits in the free device memory."));
+  flag_objects->push_back(tensorflow::Flag(
+      "xla_gpu_enable_host_offloading",
+      bool_setter_for(&DebugOptions::set_xla_gpu_enable_host_offloading),
+      flag_values->xla_gpu_enable_host_offloading(),
+      "Offload values that the GPU schedule doesn't use for a while to pinned "
+      "host memory until its peak memory fits in the free device memory."));
+  flag_objects->push_back(tensorflow::Flag(
+      "xla_heap_simulator_try_area_order",
+      bool_setter_for(&DebugOptions::set_xla_heap_simulator_try_area_order),
+      flag_values->xla_heap_simulator_try_area_order(),
+      "Also try placing buffers in decreasing size * live range in the heap "
+      "simulation of buffer assignment, and keep the smallest heap."));
+  flag_objects->push_back(tensorflow::Flag(
+      "xla_gpu_enable_blocked_attention",
+      bool_setter_for(&DebugOptions::set_xla_gpu_enable_blocked_attention),
+      flag_values->xla_gpu_enable_blocked_attention(),
+      "Rewrite softmax attention patterns with long key sequences into loops "
+      "over key and value blocks that compute the softmax online."));
   flag_objects->push_back(tensorflow::Flag(
       "xla_gpu_enable_cublaslt",
       bool_setter_for(&DebugOptions::set_xla_gpu_enable_cublaslt),
@@ -761,6 +813,14 @@ static void AllocateFlags() {
       bool_setter_for(&DebugOptions::set_xla_cpu_enable_mlir_lowering),
       flag_values->xla_cpu_enable_mlir_lowering(),
       "Enable MLIR-based lowering in XLA:CPU instead of LLVM emitters."));
+  flag_objects->push_back(tensorflow::Flag(
+      "xla_cpu_parallel_codegen_split_count",
+      int32_setter_for(
+          &DebugOptions::set_xla_cpu_parallel_codegen_split_count),
+      flag_values->xla_cpu_parallel_codegen_split_count(),
+      "Splits the LLVM module of an XLA:CPU executable into this many modules "
+      "that are compiled in parallel. Setting to 0 (the default value) or 1 "
+      "compiles the module serially."));
   flag_objects->push_back(tensorflow::Flag(
       "xla_gpu_enable_mlir_lowering",
       bool_setter_for(&DebugOptions::set_xla_gpu_enable_mlir_lowering),
@@ -24,7 +24,7 @@ namespace xla {
 
 EventPool::Handle::~Handle() {
   if (pool_ && event_) {
-    absl::MutexLock lock(&pool_->mu_);
+    absl::MutexLock lock(&pool_->free_events_mu_);
     pool_->free_events_.push(std::move(event_));
   }
 }
@@ -38,7 +38,7 @@ StatusOr<EventPool::Handle> EventPool::AllocateEvent(
 
   if (allow_reuse_) {
     event.pool_ = this;
-    absl::MutexLock lock(&mu_);
+    absl::MutexLock lock(&free_events_mu_);
     if (!free_events_.empty()) {
       event.event_ = std::move(free_events_.top());
       free_events_.pop();
@@ -86,8 +86,15 @@ class EventPool {
  private:
   const bool allow_reuse_;
 
+  // Separate from mu_ so that returning events doesn't contend with the
+  // recording of events by concurrent launches.
+  absl::Mutex free_events_mu_;
+  std::stack<std::unique_ptr<se::Event>> free_events_
+      ABSL_GUARDED_BY(free_events_mu_);
+
+  // Held while recording an event, so that the sequence numbers follow the
+  // order of the events on the stream.
   absl::Mutex mu_;
-  std::stack<std::unique_ptr<se::Event>> free_events_ ABSL_GUARDED_BY(mu_);
   uint64_t next_sequence_number_ ABSL_GUARDED_BY(mu_);
 };
 
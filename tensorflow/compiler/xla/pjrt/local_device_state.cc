@@ -173,7 +173,7 @@ void LocalDeviceState::ReturnStreamToPool(std::unique_ptr<se::Stream> stream) {
 }
 
 int LocalDeviceState::GetNewPrngSeed() {
-  absl::MutexLock lock(&mu_);
+  absl::MutexLock lock(&prng_seed_mu_);
   int x = 0;
   do {
     x = prng_seed_distribution_(prng_seed_generator_);
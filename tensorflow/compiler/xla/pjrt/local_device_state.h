@@ -188,9 +188,12 @@ class LocalDeviceState {
   std::stack<std::unique_ptr<se::Stream>> usage_stream_pool_
       ABSL_GUARDED_BY(mu_);
 
-  std::random_device prng_seed_device_ ABSL_GUARDED_BY(mu_);
-  std::mt19937 prng_seed_generator_ ABSL_GUARDED_BY(mu_);
-  std::uniform_int_distribution<> prng_seed_distribution_ ABSL_GUARDED_BY(mu_);
+  // Taken by every launch, so it doesn't share mu_ with the stream pools.
+  absl::Mutex prng_seed_mu_;
+  std::random_device prng_seed_device_ ABSL_GUARDED_BY(prng_seed_mu_);
+  std::mt19937 prng_seed_generator_ ABSL_GUARDED_BY(prng_seed_mu_);
+  std::uniform_int_distribution<> prng_seed_distribution_
+      ABSL_GUARDED_BY(prng_seed_mu_);
 
   // Callback map pairs callback stream with a device stream and is used for
   // running short host-side callbacks after device side events, without
@@ -31,6 +31,22 @@ auto* pjrt_executable_execution_time_usecs =
         "The total time spent on PjRtExecutable::ExecuteHelper in "
         "microseconds.");
 
+auto* pjrt_executable_queued_launches = tensorflow::monitoring::Counter<0>::New(
+    "/jax/pjrt/pjrt_executable_queued_launches",
+    "The number of launches that went through the execute queue of a device.");
+
+auto* pjrt_executable_queueing_time_usecs =
+    tensorflow::monitoring::Counter<0>::New(
+        "/jax/pjrt/pjrt_executable_queueing_time_usecs",
+        "The total time launches waited in the execute queue of a device in "
+        "microseconds.");
+
+auto* pjrt_executable_device_time_usecs =
+    tensorflow::monitoring::Counter<0>::New(
+        "/jax/pjrt/pjrt_executable_device_time_usecs",
+        "The total time from the end of the enqueue of a launch to the end of "
+        "its execution on the device in microseconds.");
+
 }  // namespace
 
 void ReportExecutableEnqueueTime(const uint64_t running_time_usecs) {
@@ -44,4 +60,19 @@ void ReportExecutableEnqueueTime(const uint64_t running_time_usecs) {
   }
 }
 
+void ReportExecutableQueueingTime(const uint64_t queueing_time_usecs) {
+  static auto* pjrt_executable_queued_launches_cell =
+      pjrt_executable_queued_launches->GetCell();
+  static auto* pjrt_executable_queueing_time_usecs_cell =
+      pjrt_executable_queueing_time_usecs->GetCell();
+  pjrt_executable_queued_launches_cell->IncrementBy(1);
+  pjrt_executable_queueing_time_usecs_cell->IncrementBy(queueing_time_usecs);
+}
+
+void ReportExecutableDeviceTime(const uint64_t device_time_usecs) {
+  static auto* pjrt_executable_device_time_usecs_cell =
+      pjrt_executable_device_time_usecs->GetCell();
+  pjrt_executable_device_time_usecs_cell->IncrementBy(device_time_usecs);
+}
+
 }  // namespace xla
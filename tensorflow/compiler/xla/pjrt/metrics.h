@@ -24,6 +24,14 @@ namespace xla {
 
 void ReportExecutableEnqueueTime(const uint64_t running_time_usecs);
 
+// Reports the time a launch waited in the execute queue of its device before
+// it started to be enqueued.
+void ReportExecutableQueueingTime(const uint64_t queueing_time_usecs);
+
+// Reports the time from the end of the enqueue of a launch to the end of its
+// execution on the device, which includes the work enqueued before it.
+void ReportExecutableDeviceTime(const uint64_t device_time_usecs);
+
 }
 
 #endif  // TENSORFLOW_COMPILER_XLA_PJRT_METRICS_H_
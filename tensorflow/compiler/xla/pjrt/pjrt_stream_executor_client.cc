@@ -2177,6 +2177,11 @@ StatusOr<PjRtExecutable::Result> PjRtStreamExecutorExecutable::ExecuteHelper(
     compute_callbacks.push_back(
         [promise = std::move(promise)]() mutable { promise.Set(OkStatus()); });
   }
+  const uint64_t enqueue_end_usecs = tensorflow::Env::Default()->NowMicros();
+  compute_callbacks.push_back([enqueue_end_usecs]() {
+    ReportExecutableDeviceTime(tensorflow::Env::Default()->NowMicros() -
+                               enqueue_end_usecs);
+  });
   device_state->ThenExecuteCallback(
       stream, [callbacks{std::move(compute_callbacks)},
                buffers_to_release{std::move(buffers_to_release)}]() {
@@ -2184,8 +2189,7 @@ StatusOr<PjRtExecutable::Result> PjRtStreamExecutorExecutable::ExecuteHelper(
           fn();
         }
       });
-  ReportExecutableEnqueueTime(tensorflow::Env::Default()->NowMicros() -
-                              start_time_usecs);
+  ReportExecutableEnqueueTime(enqueue_end_usecs - start_time_usecs);
   return Result({/*future=*/std::move(future), /*buffers=*/std::move(outputs)});
 }
 
@@ -2231,6 +2235,8 @@ PjRtStreamExecutorExecutable::Execute(
     int failed = 0;
     Status first_failure_status;
 
+    const uint64_t schedule_time_usecs =
+        tensorflow::Env::Default()->NowMicros();
     for (int i = 0; i < num_addressable_devices; ++i) {
       const int replica = addressable_device_logical_ids_[i].replica;
       const int partition = addressable_device_logical_ids_[i].partition;
@@ -2239,6 +2245,8 @@ PjRtStreamExecutorExecutable::Execute(
           *tensorflow::down_cast<PjRtStreamExecutorDevice*>(device)
                ->local_device_state();
       device_state.execute_thread()->Schedule([&, replica, partition, i] {
+        ReportExecutableQueueingTime(tensorflow::Env::Default()->NowMicros() -
+                                     schedule_time_usecs);
         results[i] =
             ExecuteHelper(argument_handles[i], replica, partition, run_id,
                           options, returned_futures.has_value());
@@ -493,58 +493,56 @@ StatusOr<std::unique_ptr<PjRtBuffer>> TfrtCpuClient::BufferFromHostBuffer(
                         MaybeOwningCpuMemory::AllocateShared(byte_size));
     auto dst_data_ptr = device_buffer->data();
     buffers.push_back(device_buffer);
+    // If the input array does not have a major-to-minor layout, transpose it
+    // into major-to-minor layout instead of copying it.
+    // TODO(phawkins): parallelize the transpose.
+    std::shared_ptr<TransposePlan> transpose;
     if (!has_default_layout) {
-      // If the input array does not have a major-to-minor layout, transpose it
-      // into major-to-minor layout. Currently we choose to always do this
-      // synchronously.
-      // TODO(phawkins): consider performing the transpose asynchronously.
-      // TODO(phawkins): parallelize the transpose.
-      std::shared_ptr<TransposePlan> transpose;
-      {
-        absl::InlinedVector<int64_t, 4> permutation(dims.size());
-        absl::c_iota(permutation, 0);
-        absl::MutexLock lock(&transpose_mu_);
-        TF_ASSIGN_OR_RETURN(
-            transpose, transpose_cache_.GetOrCreate(
-                           primitive_util::ByteWidth(type), dims, permutation,
-                           TransposePlan::Striding{*byte_strides}));
+      absl::InlinedVector<int64_t, 4> permutation(dims.size());
+      absl::c_iota(permutation, 0);
+      absl::MutexLock lock(&transpose_mu_);
+      TF_ASSIGN_OR_RETURN(
+          transpose, transpose_cache_.GetOrCreate(
+                         primitive_util::ByteWidth(type), dims, permutation,
+                         TransposePlan::Striding{*byte_strides}));
+    }
+    auto copy_to_device = [transpose, dst_data_ptr, data, byte_size]() {
+      if (transpose) {
+        transpose->Execute(data, dst_data_ptr);
+      } else {
+        std::memcpy(dst_data_ptr, data, byte_size);
       }
-      transpose->Execute(data, dst_data_ptr);
+    };
+    bool should_sync_copy =
+        host_buffer_semantics ==
+            HostBufferSemantics::kImmutableOnlyDuringCall ||
+        (byte_size < kSmallDataTransferByteSize);
+    if (should_sync_copy) {
+      copy_to_device();
       if (on_done_with_host_buffer) {
         on_done_with_host_buffer();
         on_done_with_host_buffer = nullptr;
       }
     } else {
-      bool should_sync_copy =
-          host_buffer_semantics ==
-              HostBufferSemantics::kImmutableOnlyDuringCall ||
-          (byte_size < kSmallDataTransferByteSize);
-      if (should_sync_copy) {
-        std::memcpy(dst_data_ptr, data, byte_size);
-        if (on_done_with_host_buffer) {
-          on_done_with_host_buffer();
-          on_done_with_host_buffer = nullptr;
-        }
-      } else {
-        tfrt::AsyncValueRef<CpuEvent> copy_event =
-            tfrt::MakeConstructedAsyncValueRef<CpuEvent>(host_ctx_.get());
-        definition_events.push_back(copy_event.CopyRef());
-        tfrt::EnqueueWork(
-            host_ctx_.get(),
-            [device_buffer = std::move(device_buffer), dst_data_ptr, data,
-             byte_size, copy_event = std::move(copy_event),
-             on_done_with_host_buffer =
-                 std::move(on_done_with_host_buffer)]() mutable {
-              tensorflow::profiler::TraceMe traceme("H2D Dispatch");
-              std::memcpy(dst_data_ptr, data, byte_size);
-              if (on_done_with_host_buffer) {
-                on_done_with_host_buffer();
-                on_done_with_host_buffer = nullptr;
-              }
-              // Signal copy is complete.
-              copy_event.SetStateConcrete();
-            });
-      }
+      tfrt::AsyncValueRef<CpuEvent> copy_event =
+          tfrt::MakeConstructedAsyncValueRef<CpuEvent>(host_ctx_.get());
+      definition_events.push_back(copy_event.CopyRef());
+      tfrt::EnqueueWork(
+          host_ctx_.get(),
+          [device_buffer = std::move(device_buffer),
+           copy_to_device = std::move(copy_to_device),
+           copy_event = std::move(copy_event),
+           on_done_with_host_buffer =
+               std::move(on_done_with_host_buffer)]() mutable {
+            tensorflow::profiler::TraceMe traceme("H2D Dispatch");
+            copy_to_device();
+            if (on_done_with_host_buffer) {
+              on_done_with_host_buffer();
+              on_done_with_host_buffer = nullptr;
+            }
+            // Signal copy is complete.
+            copy_event.SetStateConcrete();
+          });
     }
   }
   auto tracked_device_buffer = std::make_shared<TrackedTfrtCpuDeviceBuffer>(
@@ -1315,7 +1313,8 @@ TfrtCpuExecutable::TfrtCpuExecutable(
       result_buffer_indices_(std::move(result_buffer_indices)),
       addressable_device_logical_ids_(
           std::move(addressable_device_logical_ids)),
-      addressable_devices_(std::move(addressable_devices)) {
+      addressable_devices_(std::move(addressable_devices)),
+      temp_buffer_pool_(std::make_shared<TempBufferPool>()) {
   auto hlo_cost_analysis =
       std::make_unique<HloCostAnalysis>(cpu::CpuExecutable::ShapeSizeBytes);
   // Cache to avoid std::map lookup in flop_count() on critical path.
@@ -1368,7 +1367,8 @@ Status TfrtCpuExecutable::SetUpDonation(bool tuple_inputs) {
 // and assemble the buffer pointers in order to call into CpuExecutable.
 static StatusOr<std::shared_ptr<MaybeOwningCpuMemory>> MemoryForAllocation(
     const BufferAllocation& allocation,
-    absl::Span<const std::shared_ptr<TrackedTfrtCpuDeviceBuffer>> arguments) {
+    absl::Span<const std::shared_ptr<TrackedTfrtCpuDeviceBuffer>> arguments,
+    std::shared_ptr<MaybeOwningCpuMemory>* temp_buffer) {
   if (allocation.is_entry_computation_parameter()) {
     const std::shared_ptr<TrackedTfrtCpuDeviceBuffer>& arg =
         arguments[allocation.parameter_number()];
@@ -1384,10 +1384,17 @@ static StatusOr<std::shared_ptr<MaybeOwningCpuMemory>> MemoryForAllocation(
     return std::make_shared<MaybeOwningCpuMemory>();
   }
 
-  // Output and temporary buffer.
+  // Output and temporary buffer. Temporary buffers are reused from previous
+  // executions when possible, the outputs are handed out to the caller.
   int64_t buffer_size = allocation.size();
+  if (!allocation.maybe_live_out() && *temp_buffer != nullptr) {
+    return *temp_buffer;
+  }
   TF_ASSIGN_OR_RETURN(auto out,
                       MaybeOwningCpuMemory::AllocateShared(buffer_size));
+  if (!allocation.maybe_live_out()) {
+    *temp_buffer = out;
+  }
 
   // Since the output buffer and all the temporary buffers were written into
   // by the JITed code, msan has no way of knowing their memory was
@@ -1397,20 +1404,44 @@ static StatusOr<std::shared_ptr<MaybeOwningCpuMemory>> MemoryForAllocation(
   return out;
 }
 
+// `temp_buffers` holds the temporary buffers by allocation index. The missing
+// ones are allocated and stored into it.
 static StatusOr<std::vector<std::shared_ptr<MaybeOwningCpuMemory>>>
 CreateBufferTable(
     const BufferAssignment& assignment,
-    absl::Span<const std::shared_ptr<TrackedTfrtCpuDeviceBuffer>> arguments) {
+    absl::Span<const std::shared_ptr<TrackedTfrtCpuDeviceBuffer>> arguments,
+    std::vector<std::shared_ptr<MaybeOwningCpuMemory>>* temp_buffers) {
   std::vector<std::shared_ptr<MaybeOwningCpuMemory>> buffers(
       assignment.Allocations().size());
+  temp_buffers->resize(assignment.Allocations().size());
   for (BufferAllocation::Index i = 0; i < assignment.Allocations().size();
        ++i) {
     const BufferAllocation& allocation = assignment.GetAllocation(i);
-    TF_ASSIGN_OR_RETURN(buffers[i], MemoryForAllocation(allocation, arguments));
+    TF_ASSIGN_OR_RETURN(
+        buffers[i],
+        MemoryForAllocation(allocation, arguments, &(*temp_buffers)[i]));
   }
   return std::move(buffers);
 }
 
+std::vector<std::shared_ptr<MaybeOwningCpuMemory>>
+TfrtCpuExecutable::TempBufferPool::Acquire() {
+  absl::MutexLock lock(&mu);
+  if (free_tables.empty()) {
+    return {};
+  }
+  std::vector<std::shared_ptr<MaybeOwningCpuMemory>> table =
+      std::move(free_tables.back());
+  free_tables.pop_back();
+  return table;
+}
+
+void TfrtCpuExecutable::TempBufferPool::Release(
+    std::vector<std::shared_ptr<MaybeOwningCpuMemory>> table) {
+  absl::MutexLock lock(&mu);
+  free_tables.push_back(std::move(table));
+}
+
 static StatusOr<absl::InlinedVector<std::shared_ptr<MaybeOwningCpuMemory>, 4>>
 CreateResultShapedBuffer(
     absl::Span<const BufferAllocation::Index> buffer_indices,
@@ -1573,9 +1604,12 @@ StatusOr<PjRtExecutable::Result> TfrtCpuExecutable::ExecuteHelper(
 
   auto* cpu_executable =
       tensorflow::down_cast<cpu::CpuExecutable*>(cpu_executable_.get());
+  std::vector<std::shared_ptr<MaybeOwningCpuMemory>> temp_buffers =
+      temp_buffer_pool_->Acquire();
   TF_ASSIGN_OR_RETURN(
       std::vector<std::shared_ptr<MaybeOwningCpuMemory>> buffer_table,
-      CreateBufferTable(cpu_executable->buffer_assignment(), tracked_buffers));
+      CreateBufferTable(cpu_executable->buffer_assignment(), tracked_buffers,
+                        &temp_buffers));
   TF_ASSIGN_OR_RETURN(auto result_buffers,
                       CreateResultShapedBuffer(result_buffer_indices_,
                                                buffer_table, tracked_buffers));
@@ -1628,6 +1662,7 @@ StatusOr<PjRtExecutable::Result> TfrtCpuExecutable::ExecuteHelper(
     cpu_executable->compute_function()(result_buffer, &run_options, nullptr,
                                        buffer_pointers.data(), &status,
                                        nullptr);
+    temp_buffer_pool_->Release(std::move(temp_buffers));
 
     std::optional<absl::string_view> error_message =
         xla::CustomCallStatusGetMessage(&status);
@@ -1653,6 +1688,8 @@ StatusOr<PjRtExecutable::Result> TfrtCpuExecutable::ExecuteHelper(
         [cpu_executable, result_buffer,
          buffer_pointers = std::move(buffer_pointers),
          buffer_table = std::move(buffer_table),
+         temp_buffers = std::move(temp_buffers),
+         temp_buffer_pool = temp_buffer_pool_,
          run_options = std::move(run_options),
          cpu_executable_copy = cpu_executable_,
          device_assignment = std::move(device_assignment),
@@ -1679,6 +1716,7 @@ StatusOr<PjRtExecutable::Result> TfrtCpuExecutable::ExecuteHelper(
           cpu_executable->compute_function()(result_buffer, &run_options,
                                              nullptr, buffer_pointers.data(),
                                              &status, nullptr);
+          temp_buffer_pool->Release(std::move(temp_buffers));
 
           std::optional<absl::string_view> error_message =
               xla::CustomCallStatusGetMessage(&status);
@@ -689,6 +689,21 @@ class TfrtCpuExecutable final : public PjRtExecutable {
   // Cached result of comparing HloCostAnalysis FLOP estimate for execute
   // critical path.
   bool cheap_computation_;
+
+  // The temporary buffers of the executions that completed, to be reused by
+  // the next ones instead of allocating them again. There are at most as many
+  // tables as concurrent executions.
+  struct TempBufferPool {
+    std::vector<std::shared_ptr<MaybeOwningCpuMemory>> Acquire();
+    void Release(std::vector<std::shared_ptr<MaybeOwningCpuMemory>> table);
+
+    absl::Mutex mu;
+    // Each table holds the temporary buffers by allocation index.
+    std::vector<std::vector<std::shared_ptr<MaybeOwningCpuMemory>>>
+        free_tables ABSL_GUARDED_BY(mu);
+  };
+  // Shared with the executions in flight, which may outlive the executable.
+  std::shared_ptr<TempBufferPool> temp_buffer_pool_;
 };
 
 // Creates a CPU client with one Device. For testing purposes, you can set the
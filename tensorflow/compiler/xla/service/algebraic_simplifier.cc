@@ -6707,15 +6707,10 @@ Status AlgebraicSimplifierVisitor::HandleMap(HloInstruction* map) {
   return ReplaceWithNewInstruction(map, std::move(clone));
 }
 
-StatusOr<bool> AlgebraicSimplifier::Run(HloModule* module) {
-  bool changed = false;
+StatusOr<bool> AlgebraicSimplifier::RunOnComputation(
+    HloComputation* computation) {
   AlgebraicSimplifierVisitor visitor(options_, this);
-  for (auto* comp : module->MakeNonfusionComputations()) {
-    if (visitor.Run(comp, options_, this)) {
-      changed = true;
-    }
-  }
-  return changed;
+  return visitor.Run(computation, options_, this);
 }
 
 }  // namespace xla
@@ -1471,6 +1471,10 @@ Status BufferAssigner::AssignBuffersWithSequentialOrdering(
 
   // Returns a heap algorithm that chooses the best result from several
   // algorithms.
+  const bool try_area_order = assignment->module()
+                                  .config()
+                                  .debug_options()
+                                  .xla_heap_simulator_try_area_order();
   auto get_heap_algorithm = [&](int64_t alignment) {
     auto algorithms = std::make_unique<
         std::vector<std::unique_ptr<HeapAlgorithm<HloValue>>>>();
@@ -1482,6 +1486,12 @@ Status BufferAssigner::AssignBuffersWithSequentialOrdering(
         std::make_unique<ConstrainedGlobalDecreasingSizeBestFitHeap>(
             assignment->multiheap_size_constraint_per_heap(), alignment,
             GlobalDecreasingSizeBestFitHeap<HloValue>::kTemporal));
+    if (try_area_order) {
+      algorithms->push_back(
+          std::make_unique<ConstrainedGlobalDecreasingSizeBestFitHeap>(
+              assignment->multiheap_size_constraint_per_heap(), alignment,
+              GlobalDecreasingSizeBestFitHeap<HloValue>::kArea));
+    }
     return std::make_unique<ChooseBestHeapAlgorithm<HloValue>>(
         std::move(algorithms));
   };
@@ -20,6 +20,7 @@ limitations under the License.
 
 #include <functional>
 #include <map>
+#include <optional>
 #include <memory>
 #include <stack>
 #include <string>
@@ -33,10 +34,13 @@ limitations under the License.
 #include "absl/base/call_once.h"
 #include "absl/container/flat_hash_map.h"
 #include "absl/strings/str_cat.h"
+#include "absl/synchronization/mutex.h"
 #include "llvm/ADT/ArrayRef.h"
 #include "llvm/ADT/STLExtras.h"
 #include "llvm/ADT/StringRef.h"
 #include "llvm/ADT/Triple.h"
+#include "llvm/Bitcode/BitcodeReader.h"
+#include "llvm/Bitcode/BitcodeWriter.h"
 #include "llvm/IR/Function.h"
 #include "llvm/IR/LLVMContext.h"
 #include "llvm/IR/Mangler.h"
@@ -50,6 +54,7 @@ limitations under the License.
 #include "llvm/Support/TargetSelect.h"
 #include "llvm/Target/TargetMachine.h"
 #include "llvm/Target/TargetOptions.h"
+#include "llvm/Transforms/Utils/SplitModule.h"
 #include "mlir/Conversion/AffineToStandard/AffineToStandard.h"  // from @llvm-project
 #include "mlir/Conversion/ArithmeticToLLVM/ArithmeticToLLVM.h"  // from @llvm-project
 #include "mlir/Conversion/BufferizationToMemRef/BufferizationToMemRef.h"  // from @llvm-project
@@ -105,6 +110,7 @@ limitations under the License.
 #include "tensorflow/compiler/xla/service/bitcast_dtypes_expander.h"
 #include "tensorflow/compiler/xla/service/broadcast_canonicalizer.h"
 #include "tensorflow/compiler/xla/service/buffer_assignment.h"
+#include "tensorflow/compiler/xla/service/call_graph.h"
 #include "tensorflow/compiler/xla/service/call_inliner.h"
 #include "tensorflow/compiler/xla/service/cholesky_expander.h"
 #include "tensorflow/compiler/xla/service/comparison_expander.h"
@@ -188,8 +194,11 @@ limitations under the License.
 #include "tensorflow/compiler/xla/types.h"
 #include "tensorflow/compiler/xla/util.h"
 #include "tensorflow/compiler/xla/xla_data.pb.h"
+#include "tensorflow/core/platform/blocking_counter.h"
+#include "tensorflow/core/platform/env.h"
 #include "tensorflow/core/platform/errors.h"
 #include "tensorflow/core/platform/status.h"
+#include "tensorflow/core/platform/threadpool.h"
 #include "tensorflow/core/protobuf/error_codes.pb.h"
 
 namespace {
@@ -708,7 +717,8 @@ llvm::CodeGenOpt::Level CodeGenOptLevel(const HloModuleConfig& module_config) {
 std::pair<LLVMCompiler::ModuleHook, LLVMCompiler::ModuleHook> GetIRModuleHooks(
     const HloModule& hlo_module,
     const LLVMCompiler::ModuleHook& user_pre_optimization_hook,
-    const LLVMCompiler::ModuleHook& user_post_optimization_hook) {
+    const LLVMCompiler::ModuleHook& user_post_optimization_hook,
+    absl::string_view filename_suffix = "") {
   // Create the IR hooks. If applicable, each IR hook does the following:
   //
   //  * Calls the user supplied module hook.
@@ -716,14 +726,14 @@ std::pair<LLVMCompiler::ModuleHook, LLVMCompiler::ModuleHook> GetIRModuleHooks(
   //    --xla_dump_to
   const HloModule* hlo_module_ptr = &hlo_module;
   auto hook = [user_pre_optimization_hook, user_post_optimization_hook,
-               hlo_module_ptr](bool optimized,
-                               const llvm::Module& llvm_module) {
+               hlo_module_ptr, suffix = std::string(filename_suffix)](
+                  bool optimized, const llvm::Module& llvm_module) {
     const auto& user_hook =
         !optimized ? user_pre_optimization_hook : user_post_optimization_hook;
     if (user_hook) {
       user_hook(llvm_module);
     }
-    llvm_ir::DumpIrIfEnabled(*hlo_module_ptr, llvm_module, optimized);
+    llvm_ir::DumpIrIfEnabled(*hlo_module_ptr, llvm_module, optimized, suffix);
   };
   return {[hook](const llvm::Module& llvm_module) {
             return hook(/*optimized=*/false, llvm_module);
@@ -829,10 +839,11 @@ namespace {
 struct OrcJITPostCompilationHook {
   // Gets an std::function that implements this hook.
   static std::function<void(const llvm::object::ObjectFile& obj_file)> Create(
-      const HloModule* module) {
+      const HloModule* module, absl::string_view file_suffix = "o") {
     // This struct is not copyable, but std::functions must be.  So to create an
     // std::function out of this struct, we have to wrap it in a shared_ptr.
-    auto wrapped = std::make_shared<OrcJITPostCompilationHook>(module);
+    auto wrapped =
+        std::make_shared<OrcJITPostCompilationHook>(module, file_suffix);
     return [wrapped](const llvm::object::ObjectFile& obj_file) {
       (*wrapped)(obj_file);
     };
@@ -840,20 +851,22 @@ struct OrcJITPostCompilationHook {
 
   // Constructor can't be private because we want to call it from
   // std::make_shared, but users should call Create() instead.
-  explicit OrcJITPostCompilationHook(const HloModule* module)
-      : module(module) {}
+  OrcJITPostCompilationHook(const HloModule* module,
+                            absl::string_view file_suffix)
+      : module(module), file_suffix(file_suffix) {}
 
  private:
   void operator()(const llvm::object::ObjectFile& obj_file) {
     if (!DumpingEnabledForHloModule(*module)) {
       return;
     }
-    DumpToFileInDir(*module, /*file_prefix=*/"", /*file_suffix=*/"o",
+    DumpToFileInDir(*module, /*file_prefix=*/"", file_suffix,
                     absl::string_view(obj_file.getData().data(),
                                       obj_file.getData().size()));
   }
 
   const HloModule* module;
+  const std::string file_suffix;
 };
 
 void InitializeLLVMCommandLineOptions(const HloModuleConfig& config) {
@@ -1080,6 +1093,93 @@ std::vector<ComputationToEmit> SubcomputationEmissionOrder(
   return postorder;
 }
 
+// Splits `llvm_module` into `split_count` modules, optimizes and compiles them
+// to object files on `thread_pool` and adds the object files to `jit`.
+//
+// Only the externally visible functions are distributed over the modules;
+// internal functions and globals stay with their users so that the embedded
+// computations can still be inlined.  The split is a function of the module
+// and `split_count` only, and the object files are added in the order of the
+// modules, so the result does not depend on the thread pool.
+Status CompileSplitModule(std::unique_ptr<llvm::Module> llvm_module,
+                          int split_count, const HloModule& hlo_module,
+                          const LLVMCompiler::ModuleHook& user_pre_hook,
+                          const LLVMCompiler::ModuleHook& user_post_hook,
+                          tensorflow::thread::ThreadPool* thread_pool,
+                          SimpleOrcJIT* jit) {
+  XLA_SCOPED_LOGGING_TIMER("CpuCompiler - Compiling split LLVM module");
+  // The modules from SplitModule share the context of `llvm_module`, so move
+  // each of them to a context of its own through bitcode.
+  std::vector<std::string> bitcode;
+  llvm::SplitModule(
+      *llvm_module, split_count,
+      [&](std::unique_ptr<llvm::Module> part) {
+        llvm::raw_string_ostream os(bitcode.emplace_back());
+        llvm::WriteBitcodeToFile(*part, os);
+      },
+      /*PreserveLocals=*/true);
+  llvm_module.reset();
+  VLOG(1) << "Split module " << hlo_module.name() << " into "
+          << bitcode.size() << " LLVM modules";
+
+  // The hooks are not required to be thread-safe.
+  absl::Mutex hook_mu;
+  auto serialize = [&hook_mu](LLVMCompiler::ModuleHook hook) {
+    return [&hook_mu, hook](const llvm::Module& module) {
+      absl::MutexLock lock(&hook_mu);
+      hook(module);
+    };
+  };
+
+  std::vector<StatusOr<std::unique_ptr<llvm::MemoryBuffer>>> object_files(
+      bitcode.size());
+  tensorflow::BlockingCounter counter(bitcode.size());
+  for (int i = 0; i < bitcode.size(); ++i) {
+    thread_pool->Schedule([&, i]() {
+      object_files[i] = [&]() -> StatusOr<std::unique_ptr<llvm::MemoryBuffer>> {
+        const std::string part_name = absl::StrCat("part-", i);
+        llvm::LLVMContext context;
+        llvm::Expected<std::unique_ptr<llvm::Module>> module =
+            llvm::parseBitcodeFile(
+                llvm::MemoryBufferRef(bitcode[i], part_name), context);
+        if (!module) {
+          return InternalError("Failed to parse LLVM module %s: %s",
+                               part_name, llvm::toString(module.takeError()));
+        }
+        LLVMCompiler::ModuleHook pre_optimization_ir_hook;
+        LLVMCompiler::ModuleHook post_optimization_ir_hook;
+        std::tie(pre_optimization_ir_hook, post_optimization_ir_hook) =
+            GetIRModuleHooks(hlo_module, user_pre_hook, user_post_hook,
+                             part_name);
+        llvm::Expected<std::unique_ptr<llvm::MemoryBuffer>> object_file =
+            jit->CompileModule(
+                **module, serialize(std::move(pre_optimization_ir_hook)),
+                serialize(std::move(post_optimization_ir_hook)),
+                OrcJITPostCompilationHook::Create(
+                    &hlo_module, absl::StrCat(part_name, ".o")));
+        if (!object_file) {
+          return InternalError("Failed to compile LLVM module %s: %s",
+                               part_name,
+                               llvm::toString(object_file.takeError()));
+        }
+        return std::move(*object_file);
+      }();
+      counter.DecrementCount();
+    });
+  }
+  counter.Wait();
+
+  for (auto& object_file : object_files) {
+    TF_RETURN_IF_ERROR(object_file.status());
+    if (llvm::Error error =
+            jit->AddObjectFile(std::move(object_file).value())) {
+      return InternalError("Failed to add object file to the JIT: %s",
+                           llvm::toString(std::move(error)));
+    }
+  }
+  return OkStatus();
+}
+
 }  // namespace
 
 StatusOr<std::unique_ptr<Executable>> CpuCompiler::RunBackend(
@@ -1140,6 +1240,8 @@ StatusOr<std::unique_ptr<Executable>> CpuCompiler::RunBackend(
   // ownership is std::moved.
   const bool embed_ir_in_executable =
       module->config().debug_options().xla_embed_ir_in_executable();
+  const int parallel_codegen_split_count =
+      module->config().debug_options().xla_cpu_parallel_codegen_split_count();
 
   // Select an order for emitting the HLO instructions for each
   // computation. Using this sequence enables tighter buffer liveness analysis
@@ -1201,20 +1303,31 @@ StatusOr<std::unique_ptr<Executable>> CpuCompiler::RunBackend(
 
     TF_RETURN_IF_ERROR(ir_emitter.EmitConstantGlobals());
 
+    std::unique_ptr<CallGraph> call_graph =
+        parallel_codegen_split_count > 1 ? CallGraph::Build(module.get())
+                                         : nullptr;
     for (ComputationToEmit subcomputation :
          SubcomputationEmissionOrder(entry_computation)) {
       if (subcomputation.computation->IsFusionComputation()) {
         continue;
       }
-      TF_RETURN_IF_ERROR(
-          ir_emitter
-              .EmitComputation(
-                  subcomputation.computation,
-                  subcomputation.computation->name(),
-                  /*is_top_level_computation=*/false,
-                  schedule.sequence(subcomputation.computation).instructions(),
-                  subcomputation.allow_reassociation)
-              .status());
+      TF_ASSIGN_OR_RETURN(
+          llvm::Function * function,
+          ir_emitter.EmitComputation(
+              subcomputation.computation, subcomputation.computation->name(),
+              /*is_top_level_computation=*/false,
+              schedule.sequence(subcomputation.computation).instructions(),
+              subcomputation.allow_reassociation));
+      // The bodies of control flow are called once per iteration or branch,
+      // so they can live in another module of a split without losing much to
+      // the missed inlining.  Making them externally visible lets the split
+      // distribute them.
+      if (call_graph != nullptr &&
+          call_graph->GetNode(subcomputation.computation).context() ==
+              CallContext::kControlFlow) {
+        function->setLinkage(llvm::GlobalValue::ExternalLinkage);
+        function->setVisibility(llvm::GlobalValue::HiddenVisibility);
+      }
     }
     std::string function_name_prefix = entry_computation->name().empty()
                                            ? "__compute"
@@ -1244,9 +1357,24 @@ StatusOr<std::unique_ptr<Executable>> CpuCompiler::RunBackend(
   TF_RETURN_IF_ERROR(VerifyLlvmModule(*llvm_module));
 
   // JIT compile the LLVM IR module to in-memory machine code.
-  llvm::orc::ThreadSafeModule thread_safe_module(std::move(llvm_module),
-                                                 std::move(llvm_context));
-  cantFail((*jit)->AddModule(std::move(thread_safe_module)));
+  if (parallel_codegen_split_count > 1) {
+    std::optional<tensorflow::thread::ThreadPool> overriding_thread_pool;
+    tensorflow::thread::ThreadPool* thread_pool = options.thread_pool;
+    if (thread_pool == nullptr) {
+      overriding_thread_pool.emplace(tensorflow::Env::Default(),
+                                     "xla_cpu_codegen",
+                                     parallel_codegen_split_count);
+      thread_pool = &*overriding_thread_pool;
+    }
+    TF_RETURN_IF_ERROR(CompileSplitModule(
+        std::move(llvm_module), parallel_codegen_split_count, *module,
+        user_pre_optimization_hook_, user_post_optimization_hook_, thread_pool,
+        jit->get()));
+  } else {
+    llvm::orc::ThreadSafeModule thread_safe_module(std::move(llvm_module),
+                                                   std::move(llvm_context));
+    cantFail((*jit)->AddModule(std::move(thread_safe_module)));
+  }
 
   auto cpu_executable = std::make_unique<CpuExecutable>(
       std::move(*jit), std::move(assignment), std::move(module), function_name,
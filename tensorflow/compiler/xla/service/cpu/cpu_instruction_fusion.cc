@@ -15,6 +15,7 @@ limitations under the License.
 
 #include "tensorflow/compiler/xla/service/cpu/cpu_instruction_fusion.h"
 
+#include "tensorflow/compiler/xla/service/cpu/ir_emission_utils.h"
 #include "tensorflow/compiler/xla/service/fusion_node_indexing_evaluation.h"
 #include "tensorflow/compiler/xla/service/hlo_opcode.h"
 #include "tensorflow/compiler/xla/service/llvm_ir/fused_ir_emitter.h"
@@ -54,11 +55,62 @@ bool HasExactlyOneUse(const HloInstruction& hlo_instr) {
          absl::c_count(hlo_instr.users().front()->operands(), &hlo_instr) == 1;
 }
 
+// Returns true if the bias add and ReLU that follow `hlo` can be computed by
+// the dot emitter, see EmitDotOperation.
+bool IsEpilogueFusibleDot(const HloInstruction* hlo) {
+  return hlo->opcode() == HloOpcode::kDot &&
+         hlo->shape().element_type() == F32 &&
+         hlo->shape().dimensions_size() <= 2 &&
+         hlo->dot_dimension_numbers().lhs_batch_dimensions_size() == 0;
+}
+
 bool CanBeOutputFused(const HloInstruction* producer,
                       const HloInstruction* consumer) {
-  return consumer->opcode() == HloOpcode::kAdd &&
-         IsNonComplexNonBatchedMatrixVectorDot(producer) &&
-         HasExactlyOneUse(*producer) == 1;
+  if (!HasExactlyOneUse(*producer)) {
+    return false;
+  }
+  if (consumer->opcode() == HloOpcode::kAdd &&
+      IsNonComplexNonBatchedMatrixVectorDot(producer)) {
+    return true;
+  }
+  if (!IsEpilogueFusibleDot(producer)) {
+    return false;
+  }
+
+  // The dot can absorb its epilogue, or a loop fusion that computes it.
+  const HloInstruction* root = consumer;
+  const HloInstruction* dot = producer;
+  if (consumer->IsLoopFusion()) {
+    root = consumer->fused_expression_root();
+    dot = consumer->fused_parameter(consumer->operand_index(producer));
+  } else if (consumer->opcode() != HloOpcode::kAdd &&
+             consumer->opcode() != HloOpcode::kMaximum) {
+    return false;
+  }
+  std::optional<DotEpilogue> epilogue = MatchDotEpilogue(
+      root, [&](const HloInstruction* hlo) { return hlo == dot; });
+  return epilogue.has_value() && (epilogue->addend || epilogue->relu);
+}
+
+// Returns true if `producer` broadcasts the bias of the epilogue of the output
+// fusion `consumer`, which then reads the bias vector instead of a matrix.
+bool IsBiasOfOutputFusion(const HloInstruction* producer,
+                          const HloInstruction* consumer,
+                          int64_t operand_index) {
+  if (!consumer->IsOutputFusion() ||
+      producer->opcode() != HloOpcode::kBroadcast ||
+      producer->shape().rank() != 2 ||
+      producer->operand(0)->shape().rank() != 1 ||
+      producer->dimensions() != std::vector<int64_t>{1}) {
+    return false;
+  }
+  std::optional<DotEpilogue> epilogue =
+      MatchDotEpilogue(consumer->fused_expression_root(),
+                       [](const HloInstruction* hlo) {
+                         return hlo->opcode() == HloOpcode::kDot;
+                       });
+  return epilogue.has_value() && !epilogue->bias &&
+         epilogue->addend == consumer->fused_parameter(operand_index);
 }
 
 bool CanBeOutputFusedIntoSomeOperand(const HloInstruction* consumer) {
@@ -81,7 +133,16 @@ FusionDecision CpuInstructionFusion::ShouldFuse(HloInstruction* consumer,
     return {};
   }
 
-  if (CanBeOutputFusedIntoSomeOperand(producer)) {
+  if (IsBiasOfOutputFusion(producer, consumer, operand_index)) {
+    VLOG(2) << "Fusion OK: Producer is the bias of an output fusion.";
+    return {};
+  }
+
+  // A ReLU of a bias add is fused with the add first, so that the dot can
+  // then absorb both.
+  if (CanBeOutputFusedIntoSomeOperand(producer) &&
+      !(consumer->opcode() == HloOpcode::kMaximum &&
+        MatchDotEpilogue(consumer, IsEpilogueFusibleDot).has_value())) {
     return "Bailing because producer can be output-fused into some operand.";
   }
 
@@ -192,7 +253,7 @@ FusionDecision CpuInstructionFusion::ShouldFuse(HloInstruction* consumer,
 
 HloInstruction::FusionKind CpuInstructionFusion::ChooseKind(
     const HloInstruction* producer, const HloInstruction* consumer) {
-  return CanBeOutputFused(producer, consumer)
+  return CanBeOutputFused(producer, consumer) || consumer->IsOutputFusion()
              ? HloInstruction::FusionKind::kOutput
              : HloInstruction::FusionKind::kLoop;
 }
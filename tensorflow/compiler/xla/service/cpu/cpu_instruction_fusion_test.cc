@@ -21,6 +21,7 @@ limitations under the License.
 
 #include "absl/strings/str_cat.h"
 #include "absl/types/span.h"
+#include "tensorflow/compiler/xla/service/cpu/ir_emission_utils.h"
 #include "tensorflow/compiler/xla/service/hlo_matchers.h"
 #include "tensorflow/compiler/xla/service/transpose_folding.h"
 #include "tensorflow/compiler/xla/shape.h"
@@ -681,11 +682,48 @@ TEST_F(OpcodeFusionTest, DotAddOutputFusion_19x50x19) {
                                              /*k=*/50, /*n=*/19,
                                              /*add_extra_use_for_dot=*/false);
 
+  RunFusionAndCheckOpcodesWereFused(
+      module.get(),
+      {HloOpcode::kDot, HloOpcode::kAdd, HloOpcode::kParameter,
+       HloOpcode::kParameter, HloOpcode::kParameter},
+      HloInstruction::FusionKind::kOutput);
+}
+
+TEST_F(InstructionFusionTest, DotBiasReluOutputFusion) {
+  absl::string_view module_string = R"(
+HloModule module
+
+ENTRY main {
+  a = f32[50,60]{1,0} parameter(0)
+  b = f32[60,40]{1,0} parameter(1)
+  bias = f32[40]{0} parameter(2)
+  dot = f32[50,40]{1,0} dot(a, b), lhs_contracting_dims={1}, rhs_contracting_dims={0}
+  bias_broadcast = f32[50,40]{1,0} broadcast(bias), dimensions={1}
+  add = f32[50,40]{1,0} add(dot, bias_broadcast)
+  zero = f32[] constant(0)
+  zeros = f32[50,40]{1,0} broadcast(zero), dimensions={}
+  ROOT relu = f32[50,40]{1,0} maximum(add, zeros)
+}
+)";
+
+  TF_ASSERT_OK_AND_ASSIGN(auto module,
+                          ParseAndReturnVerifiedModule(module_string));
   TF_ASSERT_OK_AND_ASSIGN(bool fused_something,
                           CpuInstructionFusion().Run(module.get()));
-  EXPECT_FALSE(fused_something);
-  EXPECT_THAT(module->entry_computation()->root_instruction(),
-              Not(op::Fusion()));
+  EXPECT_TRUE(fused_something);
+  HloInstruction* root = module->entry_computation()->root_instruction();
+  ASSERT_THAT(root, op::Fusion());
+  EXPECT_EQ(root->fusion_kind(), HloInstruction::FusionKind::kOutput);
+  std::optional<DotEpilogue> epilogue =
+      MatchDotEpilogue(root->fused_expression_root(),
+                       [](const HloInstruction* hlo) {
+                         return hlo->opcode() == HloOpcode::kDot;
+                       });
+  ASSERT_TRUE(epilogue.has_value());
+  EXPECT_TRUE(epilogue->bias);
+  EXPECT_TRUE(epilogue->relu);
+  EXPECT_THAT(epilogue->dot, op::Dot(op::Parameter(), op::Parameter()));
+  EXPECT_THAT(epilogue->addend, op::Parameter());
 }
 
 TEST_F(OpcodeFusionTest, DotAddOutputFusion_19x50x1_multi_use) {
@@ -75,6 +75,8 @@ extern const char* const kEigenMatMulF16SymbolName =
     "__xla_cpu_runtime_EigenMatMulF16";
 extern const char* const kEigenMatMulF32SymbolName =
     "__xla_cpu_runtime_EigenMatMulF32";
+extern const char* const kEigenMatMulF32WithEpilogueSymbolName =
+    "__xla_cpu_runtime_EigenMatMulF32WithEpilogue";
 extern const char* const kEigenMatMulF64SymbolName =
     "__xla_cpu_runtime_EigenMatMulF64";
 extern const char* const kEigenMatMulC64SymbolName =
@@ -116,6 +118,8 @@ extern const char* const kEigenSingleThreadedMatMulF16SymbolName =
     "__xla_cpu_runtime_EigenSingleThreadedMatMulF16";
 extern const char* const kEigenSingleThreadedMatMulF32SymbolName =
     "__xla_cpu_runtime_EigenSingleThreadedMatMulF32";
+extern const char* const kEigenSingleThreadedMatMulF32WithEpilogueSymbolName =
+    "__xla_cpu_runtime_EigenSingleThreadedMatMulF32WithEpilogue";
 extern const char* const kEigenSingleThreadedMatMulF64SymbolName =
     "__xla_cpu_runtime_EigenSingleThreadedMatMulF64";
 extern const char* const kEigenSingleThreadedMatMulC64SymbolName =
@@ -37,6 +37,7 @@ limitations under the License.
 #include "tensorflow/compiler/xla/service/cpu/cpu_runtime.h"
 #include "tensorflow/compiler/xla/service/cpu/ir_emission_utils.h"
 #include "tensorflow/compiler/xla/service/cpu/mlir_emitter.h"
+#include "tensorflow/compiler/xla/service/cpu/runtime_matmul_epilogue.h"
 #include "tensorflow/compiler/xla/service/cpu/target_machine_features.h"
 #include "tensorflow/compiler/xla/service/cpu/tiled_dot_emitter.h"
 #include "tensorflow/compiler/xla/service/cpu/vector_support_library.h"
@@ -45,6 +46,7 @@ limitations under the License.
 #include "tensorflow/compiler/xla/service/hlo_module.h"
 #include "tensorflow/compiler/xla/service/llvm_ir/kernel_support_library.h"
 #include "tensorflow/compiler/xla/service/llvm_ir/llvm_util.h"
+#include "tensorflow/compiler/xla/service/llvm_ir/loop_emitter.h"
 #include "tensorflow/compiler/xla/shape_util.h"
 #include "tensorflow/compiler/xla/status_macros.h"
 #include "tensorflow/compiler/xla/util.h"
@@ -125,7 +127,7 @@ class DotOpEmitter {
                         const llvm_ir::IrArray& target_array,
                         const llvm_ir::IrArray& lhs_array,
                         const llvm_ir::IrArray& rhs_array,
-                        const llvm_ir::IrArray* addend_array,
+                        const FusedDotEpilogue& epilogue,
                         llvm::Value* executable_run_options_value,
                         llvm::IRBuilder<>* b, mlir::MLIRContext* mlir_context,
                         const HloModuleConfig& hlo_module_config,
@@ -145,6 +147,18 @@ class DotOpEmitter {
   // Emits a call to the CPU runtime to perform the matrix multiply.
   Status EmitCallToRuntime();
 
+  // Returns true if the CPU runtime matrix multiply can compute the epilogue.
+  bool RuntimeCallEmitsEpilogue() const;
+
+  // Returns true if the tiled matrix-vector multiply adds the addend.
+  bool GemvEmitsAddend() const {
+    return epilogue_.addend != nullptr && !epilogue_.bias;
+  }
+
+  // Emits a loop over the target that applies the epilogue, leaving out the
+  // addend unless `emit_addend` is true.
+  Status EmitEpilogue(bool emit_addend);
+
   // Emits a call to the CPU runtime to perform the batch matrix multiply.
   Status EmitCallToBatchRuntime();
 
@@ -234,7 +248,7 @@ class DotOpEmitter {
   const llvm_ir::IrArray& target_array_;
   const llvm_ir::IrArray& lhs_array_;
   const llvm_ir::IrArray& rhs_array_;
-  const llvm_ir::IrArray* addend_array_;
+  const FusedDotEpilogue epilogue_;
   llvm::Value* executable_run_options_value_;
   llvm::IRBuilder<>* b_;
   mlir::MLIRContext* mlir_context_;
@@ -246,7 +260,7 @@ class DotOpEmitter {
 DotOpEmitter::DotOpEmitter(
     DotInfo dot_info, std::string dot_hlo_name,
     const llvm_ir::IrArray& target_array, const llvm_ir::IrArray& lhs_array,
-    const llvm_ir::IrArray& rhs_array, const llvm_ir::IrArray* addend_array,
+    const llvm_ir::IrArray& rhs_array, const FusedDotEpilogue& epilogue,
     llvm::Value* executable_run_options_value, llvm::IRBuilder<>* b,
     mlir::MLIRContext* mlir_context, const HloModuleConfig& hlo_module_config,
     const TargetMachineFeatures& target_machine_features)
@@ -255,7 +269,7 @@ DotOpEmitter::DotOpEmitter(
       target_array_(target_array),
       lhs_array_(lhs_array),
       rhs_array_(rhs_array),
-      addend_array_(addend_array),
+      epilogue_(epilogue),
       executable_run_options_value_(executable_run_options_value),
       b_(b),
       mlir_context_(mlir_context),
@@ -510,7 +524,8 @@ void DotOpEmitter::EmitTiledLlvmIrGemv() {
         /*scalar_type=*/primitive_type,
         /*tile_rows=*/vector_register_element_size, /*tile_cols=*/tiling_factor,
         /*m=*/m, /*k=*/k, /*lhs=*/lhs_op, /*rhs=*/rhs_op,
-        /*addend=*/addend_array_ ? addend_array_->GetBasePointer() : nullptr,
+        /*addend=*/GemvEmitsAddend() ? epilogue_.addend->GetBasePointer()
+                                     : nullptr,
         /*result=*/result_op, b_, hlo_module_config_);
   } else {
     VLOG(2) << "Emitting row major matrix-vector multiply with m = " << m
@@ -520,7 +535,8 @@ void DotOpEmitter::EmitTiledLlvmIrGemv() {
         /*tile_rows=*/tiling_factor,
         /*tile_cols=*/vector_register_element_size,
         /*m=*/m, /*k=*/k, /*lhs=*/lhs_op, /*rhs=*/rhs_op,
-        /*addend=*/addend_array_ ? addend_array_->GetBasePointer() : nullptr,
+        /*addend=*/GemvEmitsAddend() ? epilogue_.addend->GetBasePointer()
+                                     : nullptr,
         /*result=*/result_op, b_, hlo_module_config_);
   }
 }
@@ -555,31 +571,72 @@ Status DotOpEmitter::Emit() {
     // If the operands are scalar, don't emit any loops.
     TF_RET_CHECK(ShapeUtil::IsScalar(lhs_shape) &&
                  ShapeUtil::IsScalar(rhs_shape));
-    return EmitScalarDot();
+    TF_RETURN_IF_ERROR(EmitScalarDot());
+    return EmitEpilogue(/*emit_addend=*/true);
   }
 
   switch (GetDotImplementationStrategy(hlo_module_config_, dot_info_,
                                        target_machine_features_)) {
     case DotImplementationStrategy::kNaiveLlvmIr:
       EmitNaiveLlvmIrGemm();
-      return OkStatus();
+      return EmitEpilogue(/*emit_addend=*/true);
 
     case DotImplementationStrategy::kTiledLlvmIrGemv:
       EmitTiledLlvmIrGemv();
-      return OkStatus();
+      return EmitEpilogue(/*emit_addend=*/!GemvEmitsAddend());
 
     case DotImplementationStrategy::kTiledLlvmIrGemm:
+      // The tiled GEMM is only used for small matrices, so the result is still
+      // in cache for the epilogue.
       EmitTiledLlvmIrGemm();
-      return OkStatus();
+      return EmitEpilogue(/*emit_addend=*/true);
 
     case DotImplementationStrategy::kLinalgMatmul:
-      return EmitLinalgMatmul();
+      TF_RETURN_IF_ERROR(EmitLinalgMatmul());
+      return EmitEpilogue(/*emit_addend=*/true);
 
     case DotImplementationStrategy::kEigen:
-      return EmitCallToRuntime();
+      TF_RETURN_IF_ERROR(EmitCallToRuntime());
+      if (RuntimeCallEmitsEpilogue()) {
+        return OkStatus();
+      }
+      return EmitEpilogue(/*emit_addend=*/true);
   }
 }
 
+Status DotOpEmitter::EmitEpilogue(bool emit_addend) {
+  const llvm_ir::IrArray* addend = emit_addend ? epilogue_.addend : nullptr;
+  if (addend == nullptr && !epilogue_.relu) {
+    return OkStatus();
+  }
+  bool is_float = primitive_util::IsFloatingPointType(
+      target_array_.GetShape().element_type());
+  TF_RET_CHECK(is_float || !epilogue_.relu);
+  auto body_emitter = [&](const llvm_ir::IrArray::Index& index) -> Status {
+    llvm::Value* value = target_array_.EmitReadArrayElement(index, b_);
+    if (addend != nullptr) {
+      llvm_ir::IrArray::Index addend_index =
+          epilogue_.bias
+              ? llvm_ir::IrArray::Index({index.multidim()[1]},
+                                        addend->GetShape(), index.GetType())
+              : index;
+      llvm::Value* addend_value =
+          addend->EmitReadArrayElement(addend_index, b_);
+      value = is_float ? b_->CreateFAdd(value, addend_value)
+                       : b_->CreateAdd(value, addend_value);
+    }
+    if (epilogue_.relu) {
+      // Like max(x, 0) in XLA, this propagates NaNs.
+      llvm::Value* zero = llvm::ConstantFP::get(value->getType(), 0.0);
+      value = b_->CreateSelect(b_->CreateFCmpOLT(value, zero), zero, value);
+    }
+    target_array_.EmitWriteArrayElement(index, value, b_);
+    return OkStatus();
+  };
+  return llvm_ir::LoopEmitter(body_emitter, target_array_.GetShape(), b_)
+      .EmitLoop(llvm_ir::IrName(dot_hlo_name_, "epilogue"), b_->getInt64Ty());
+}
+
 Status DotOpEmitter::EmitBatch() {
   // The dot operation performs a sum of products over dimension 0 of the left
   // hand side operand and dimension 1 of the right hand side operand.
@@ -607,8 +664,6 @@ Status DotOpEmitter::EmitBatch() {
 }
 
 void DotOpEmitter::EmitNaiveLlvmIrGemm() {
-  CHECK_EQ(addend_array_, nullptr);
-
   const Shape& lhs_shape = lhs_array_.GetShape();
   const Shape& rhs_shape = rhs_array_.GetShape();
   const DotDimensionNumbers& dim_nums = dot_info_.dim_nums;
@@ -787,6 +842,19 @@ Status DotOpEmitter::EmitScalarDot() {
   return OkStatus();
 }
 
+bool DotOpEmitter::RuntimeCallEmitsEpilogue() const {
+  const DebugOptions& debug_options = hlo_module_config_.debug_options();
+  if ((epilogue_.addend == nullptr && !epilogue_.relu) ||
+      target_array_.GetShape().element_type() != F32 ||
+      debug_options.xla_cpu_use_mkl_dnn() || debug_options.xla_cpu_use_acl()) {
+    return false;
+  }
+  // The runtime reads a full addend in the layout of the result.
+  return epilogue_.addend == nullptr || epilogue_.bias ||
+         LayoutUtil::Equal(epilogue_.addend->GetShape().layout(),
+                           target_array_.GetShape().layout());
+}
+
 Status DotOpEmitter::EmitCallToRuntime() {
   // The signature of the Eigen runtime matmul function is:
   //
@@ -795,6 +863,12 @@ Status DotOpEmitter::EmitCallToRuntime() {
   //          int32_t transpose_rhs);
   // The two transpose_... parameters are actually booleans, but we use int32_t
   // to avoid target-dependent calling convention details.
+  //
+  // The F32 variant that computes the epilogue takes three more parameters,
+  //
+  //   (float* addend, int32_t addend_kind, int32_t relu)
+  //
+  // where addend_kind is a MatMulAddendKind.
 
   bool multi_threaded = ShouldUseMultiThreadedEigen(hlo_module_config_);
   bool use_mkl_dnn = hlo_module_config_.debug_options().xla_cpu_use_mkl_dnn();
@@ -853,16 +927,26 @@ Status DotOpEmitter::EmitCallToRuntime() {
       return Unimplemented("Invalid type %s for dot operation",
                            PrimitiveType_Name(type));
   }
+  const bool emit_epilogue = RuntimeCallEmitsEpilogue();
+  if (emit_epilogue) {
+    fn_name =
+        multi_threaded
+            ? runtime::kEigenMatMulF32WithEpilogueSymbolName
+            : runtime::kEigenSingleThreadedMatMulF32WithEpilogueSymbolName;
+  }
 
   llvm::Type* float_ptr_type = float_type->getPointerTo();
   llvm::Type* int64_type = b_->getInt64Ty();
   llvm::Type* int32_type = b_->getInt32Ty();
   llvm::Type* int8_ptr_type = b_->getInt8Ty()->getPointerTo();
-  llvm::FunctionType* matmul_type = llvm::FunctionType::get(
-      b_->getVoidTy(),
-      {int8_ptr_type, float_ptr_type, float_ptr_type, float_ptr_type,
-       int64_type, int64_type, int64_type, int32_type, int32_type},
-      /*isVarArg=*/false);
+  std::vector<llvm::Type*> arg_types = {
+      int8_ptr_type, float_ptr_type, float_ptr_type, float_ptr_type, int64_type,
+      int64_type,    int64_type,     int32_type,     int32_type};
+  if (emit_epilogue) {
+    arg_types.insert(arg_types.end(), {float_ptr_type, int32_type, int32_type});
+  }
+  llvm::FunctionType* matmul_type =
+      llvm::FunctionType::get(b_->getVoidTy(), arg_types, /*isVarArg=*/false);
 
   llvm::FunctionCallee matmul_func =
       module->getOrInsertFunction(fn_name, matmul_type);
@@ -898,15 +982,37 @@ Status DotOpEmitter::EmitCallToRuntime() {
     std::swap(transpose_lhs, transpose_rhs);
   }
 
-  b_->CreateCall(
-      matmul_func,
-      {b_->CreateBitCast(executable_run_options_value_, int8_ptr_type),
-       b_->CreateBitCast(target_array_.GetBasePointer(), float_ptr_type),
-       b_->CreateBitCast(lhs->GetBasePointer(), float_ptr_type),
-       b_->CreateBitCast(rhs->GetBasePointer(), float_ptr_type),
-       b_->getInt64(mat_mult_dims.m), b_->getInt64(mat_mult_dims.n),
-       b_->getInt64(mat_mult_dims.k), b_->getInt32(transpose_lhs),
-       b_->getInt32(transpose_rhs)});
+  std::vector<llvm::Value*> args = {
+      b_->CreateBitCast(executable_run_options_value_, int8_ptr_type),
+      b_->CreateBitCast(target_array_.GetBasePointer(), float_ptr_type),
+      b_->CreateBitCast(lhs->GetBasePointer(), float_ptr_type),
+      b_->CreateBitCast(rhs->GetBasePointer(), float_ptr_type),
+      b_->getInt64(mat_mult_dims.m),
+      b_->getInt64(mat_mult_dims.n),
+      b_->getInt64(mat_mult_dims.k),
+      b_->getInt32(transpose_lhs),
+      b_->getInt32(transpose_rhs)};
+  if (emit_epilogue) {
+    // The bias is added along dimension 1 of the result, which is a row of the
+    // column-major result of the runtime if the operands were swapped.
+    MatMulAddendKind addend_kind = MatMulAddendKind::kNone;
+    if (epilogue_.addend != nullptr && !epilogue_.bias) {
+      addend_kind = MatMulAddendKind::kMatrix;
+    } else if (epilogue_.addend != nullptr) {
+      addend_kind = mat_mult_dims.lhs_column_major
+                        ? MatMulAddendKind::kPerColumn
+                        : MatMulAddendKind::kPerRow;
+    }
+    args.push_back(
+        epilogue_.addend != nullptr
+            ? b_->CreateBitCast(epilogue_.addend->GetBasePointer(),
+                                float_ptr_type)
+            : llvm::ConstantPointerNull::get(
+                  llvm::cast<llvm::PointerType>(float_ptr_type)));
+    args.push_back(b_->getInt32(static_cast<int32_t>(addend_kind)));
+    args.push_back(b_->getInt32(epilogue_.relu));
+  }
+  b_->CreateCall(matmul_func, args);
   return OkStatus();
 }
 
@@ -1232,7 +1338,7 @@ DotImplementationStrategy GetDotImplementationStrategy(
 Status EmitNonBatchDotOperation(
     DotInfo dot_info, std::string hlo_name,
     const llvm_ir::IrArray& target_array, const llvm_ir::IrArray& lhs_array,
-    const llvm_ir::IrArray& rhs_array, const llvm_ir::IrArray* addend_array,
+    const llvm_ir::IrArray& rhs_array, const FusedDotEpilogue& epilogue,
     llvm::Value* executable_run_options_value, llvm::IRBuilder<>* b,
     mlir::MLIRContext* mlir_context, const HloModuleConfig& hlo_module_config,
     const TargetMachineFeatures& target_machine_features) {
@@ -1242,7 +1348,7 @@ Status EmitNonBatchDotOperation(
                U64 == type || F16 == type || F32 == type || F64 == type ||
                C64 == type || C128 == type);
   DotOpEmitter dot_emitter(std::move(dot_info), std::move(hlo_name),
-                           target_array, lhs_array, rhs_array, addend_array,
+                           target_array, lhs_array, rhs_array, epilogue,
                            executable_run_options_value, b, mlir_context,
                            hlo_module_config, target_machine_features);
   return dot_emitter.Emit();
@@ -1388,7 +1494,7 @@ Status EmitBatchDotOperation(
           b, mlir_context, hlo_module_config, target_machine_features,
           dot_info)) {
     DotOpEmitter dot_emitter(dot_info, dot.name(), target_array, lhs_array,
-                             rhs_array, nullptr /*addend_array*/,
+                             rhs_array, /*epilogue=*/{},
                              executable_run_options_value, b, mlir_context,
                              hlo_module_config, target_machine_features);
 
@@ -1449,9 +1555,9 @@ Status EmitBatchDotOperation(
 
           // Emit the inner non-batch dot operation.
           return EmitNonBatchDotOperation(
-              dot_info, dot.name(), target_slice, lhs_slice, rhs_slice, nullptr,
-              executable_run_options_value, b, mlir_context, hlo_module_config,
-              target_machine_features);
+              dot_info, dot.name(), target_slice, lhs_slice, rhs_slice,
+              /*epilogue=*/{}, executable_run_options_value, b, mlir_context,
+              hlo_module_config, target_machine_features);
         });
   }
 }
@@ -1499,7 +1605,7 @@ Status EmitDotOperation(const HloInstruction& dot,
                         const llvm_ir::IrArray& target_array,
                         const llvm_ir::IrArray& lhs_array,
                         const llvm_ir::IrArray& rhs_array,
-                        const llvm_ir::IrArray* addend_array,
+                        const FusedDotEpilogue& epilogue,
                         llvm::Value* executable_run_options_value,
                         llvm::IRBuilder<>* b, mlir::MLIRContext* mlir_context,
                         const HloModuleConfig& hlo_module_config,
@@ -1509,14 +1615,14 @@ Status EmitDotOperation(const HloInstruction& dot,
   CHECK(dot.parent()->root_instruction()->outer_dimension_partitions().empty());
 
   if (IsBatchDot(dot)) {
-    TF_RET_CHECK(addend_array == nullptr);
+    TF_RET_CHECK(epilogue.addend == nullptr && !epilogue.relu);
     return EmitBatchDotOperation(dot, target_array, lhs_array, rhs_array,
                                  executable_run_options_value, b, mlir_context,
                                  hlo_module_config, target_machine_features);
   }
 
   return EmitNonBatchDotOperation(DotInfo(dot), dot.name(), target_array,
-                                  lhs_array, rhs_array, addend_array,
+                                  lhs_array, rhs_array, epilogue,
                                   executable_run_options_value, b, mlir_context,
                                   hlo_module_config, target_machine_features);
 }
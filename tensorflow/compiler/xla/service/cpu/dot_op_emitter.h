@@ -48,20 +48,30 @@ bool DotImplementationCanHandleTranspose(
 std::optional<int64_t> ProfitableToMakeDotOperandColumnMajor(
     const HloInstruction& hlo);
 
+// The elementwise operations that are fused into a dot, see DotEpilogue.
+struct FusedDotEpilogue {
+  // If `bias` is set, a vector that is added to each row of the matrix result.
+  // Otherwise either nullptr or an array of the same dimensions as the result.
+  const llvm_ir::IrArray* addend = nullptr;
+  bool bias = false;
+  bool relu = false;
+};
+
 // Emit LLVM IR to perform the dot operation on lhs_array and rhs_array and
 // place the result in target_array. IR is emitted at current insert point of
 // the builder. Upon completion of the method, the insert point is set to the
 // end of all instructions emitted for this operation.
 //
-// If `addend_array` is not nullptr then it must be an array of the same
-// dimensions as the result, and the result is computed as `addend_array` +
-// dot(`lhs_array`, `rhs_array`).  A non-null `addend_array` is only supported
-// for Matrix-vector products.
+// The result is computed as relu(dot(`lhs_array`, `rhs_array`) + addend) for
+// the addend and ReLU of `epilogue`.  F32 Eigen matrix-matrix products apply
+// the epilogue to each block of the result, and matrix-vector products add a
+// full addend while they compute the result.  Otherwise the epilogue is a
+// separate pass over the result.  Batch dots do not support an epilogue.
 Status EmitDotOperation(const HloInstruction& dot,
                         const llvm_ir::IrArray& target_array,
                         const llvm_ir::IrArray& lhs_array,
                         const llvm_ir::IrArray& rhs_array,
-                        const llvm_ir::IrArray* addend_array,
+                        const FusedDotEpilogue& epilogue,
                         llvm::Value* executable_run_options_value,
                         llvm::IRBuilder<>* b, mlir::MLIRContext* mlir_context,
                         const HloModuleConfig& hlo_module_config,
@@ -24,6 +24,65 @@ limitations under the License.
 namespace xla {
 namespace cpu {
 
+namespace {
+
+// Returns true if `hlo` is zero, looking through broadcasts and the parameters
+// of fused computations.
+bool IsZero(const HloInstruction* hlo) {
+  while (true) {
+    if (hlo->opcode() == HloOpcode::kBroadcast) {
+      hlo = hlo->operand(0);
+    } else if (hlo->opcode() == HloOpcode::kParameter && hlo->IsFused()) {
+      hlo =
+          hlo->parent()->FusionInstruction()->operand(hlo->parameter_number());
+    } else {
+      return hlo->opcode() == HloOpcode::kConstant && hlo->literal().IsAll(0);
+    }
+  }
+}
+
+}  // namespace
+
+std::optional<DotEpilogue> MatchDotEpilogue(
+    const HloInstruction* root,
+    absl::FunctionRef<bool(const HloInstruction*)> is_dot) {
+  DotEpilogue epilogue;
+  const HloInstruction* hlo = root;
+  if (hlo->opcode() == HloOpcode::kMaximum) {
+    if (IsZero(hlo->operand(1))) {
+      hlo = hlo->operand(0);
+    } else if (IsZero(hlo->operand(0))) {
+      hlo = hlo->operand(1);
+    } else {
+      return std::nullopt;
+    }
+    epilogue.relu = true;
+  }
+  if (hlo->opcode() == HloOpcode::kAdd) {
+    const HloInstruction* dot = hlo->operand(0);
+    const HloInstruction* addend = hlo->operand(1);
+    if (!is_dot(dot)) {
+      std::swap(dot, addend);
+    }
+    if (addend->opcode() == HloOpcode::kBroadcast &&
+        dot->shape().rank() == 2 && addend->operand(0)->shape().rank() == 1 &&
+        addend->dimensions().size() == 1 && addend->dimensions(0) == 1) {
+      epilogue.bias = true;
+      addend = addend->operand(0);
+    }
+    if (root->IsFused() && addend->opcode() != HloOpcode::kParameter) {
+      return std::nullopt;
+    }
+    epilogue.addend = addend;
+    hlo = dot;
+  }
+  if (!is_dot(hlo)) {
+    return std::nullopt;
+  }
+  epilogue.dot = hlo;
+  return epilogue;
+}
+
 int64_t GetMinimumAlignmentForArray(
     const Shape& shape, const TargetMachineFeatures& target_machine_features) {
   CHECK(shape.IsArray());
@@ -16,6 +16,9 @@ limitations under the License.
 #ifndef TENSORFLOW_COMPILER_XLA_SERVICE_CPU_IR_EMISSION_UTILS_H_
 #define TENSORFLOW_COMPILER_XLA_SERVICE_CPU_IR_EMISSION_UTILS_H_
 
+#include <optional>
+
+#include "absl/functional/function_ref.h"
 #include "llvm/IR/Value.h"
 #include "tensorflow/compiler/xla/service/cpu/target_machine_features.h"
 #include "tensorflow/compiler/xla/service/hlo_instruction.h"
@@ -44,6 +47,27 @@ int64_t GetMinimumAlignmentForArray(
 // See IrFunction and ParallelLoopEmitter for details.
 using DynamicLoopBounds = std::vector<std::pair<llvm::Value*, llvm::Value*>>;
 
+// The elementwise operations on the result of a dot that are computed as
+//
+//   relu(dot + addend)
+//
+// where both the addend and the ReLU, max(x, 0), are optional.
+struct DotEpilogue {
+  const HloInstruction* dot = nullptr;
+  // If `bias` is set, a vector that is added to each row of a rank 2 dot.
+  // Otherwise either nullptr or an instruction of the shape of the dot.
+  const HloInstruction* addend = nullptr;
+  bool bias = false;
+  bool relu = false;
+};
+
+// Matches the expression rooted at `root` to a DotEpilogue, where `is_dot`
+// tells which instructions to treat as the dot.  In a fused computation, the
+// addend must be a parameter.
+std::optional<DotEpilogue> MatchDotEpilogue(
+    const HloInstruction* root,
+    absl::FunctionRef<bool(const HloInstruction*)> is_dot);
+
 }  // namespace cpu
 }  // namespace xla
 
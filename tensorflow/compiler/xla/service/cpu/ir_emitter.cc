@@ -894,9 +894,9 @@ Status IrEmitter::HandleDot(HloInstruction* dot) {
 
   // Dot operation is complicated so we delegate to a helper class.
   return EmitDotOperation(*dot, target_array, lhs_array, rhs_array,
-                          /*addend_array=*/nullptr,
-                          GetExecutableRunOptionsArgument(), &b_, mlir_context_,
-                          hlo_module_config_, target_machine_features_);
+                          /*epilogue=*/{}, GetExecutableRunOptionsArgument(),
+                          &b_, mlir_context_, hlo_module_config_,
+                          target_machine_features_);
 }
 
 Status IrEmitter::HandleConvolution(HloInstruction* convolution) {
@@ -2190,17 +2190,16 @@ Status IrEmitter::HandleFusion(HloInstruction* fusion) {
     return EmitTargetElementLoop(fusion, generator);
   } else if (fusion->IsOutputFusion()) {
     VLOG(3) << "HandleFusion kOutput";
-    int64_t dot_op_index =
-        root->operand(0)->opcode() == HloOpcode::kDot ? 0 : 1;
-    const HloInstruction* dot = root->operand(dot_op_index);
-    CHECK_EQ(dot->opcode(), HloOpcode::kDot)
-        << dot->ToString() << "  "
+    std::optional<DotEpilogue> epilogue =
+        MatchDotEpilogue(root, [](const HloInstruction* hlo) {
+          return hlo->opcode() == HloOpcode::kDot;
+        });
+    CHECK(epilogue.has_value() && (epilogue->addend || epilogue->relu))
         << fusion->fused_instructions_computation()->ToString();
+    const HloInstruction* dot = epilogue->dot;
 
     int64_t dot_lhs_param_number = dot->operand(0)->parameter_number();
     int64_t dot_rhs_param_number = dot->operand(1)->parameter_number();
-    int64_t addend_param_number =
-        root->operand(1 - dot_op_index)->parameter_number();
 
     Shape target_shape = fusion->shape();
     TF_RETURN_IF_ERROR(EmitTargetAddressForOp(fusion));
@@ -2210,11 +2209,18 @@ Status IrEmitter::HandleFusion(HloInstruction* fusion) {
         GetIrArrayFor(fusion->operand(dot_lhs_param_number)));
     llvm_ir::IrArray rhs_array(
         GetIrArrayFor(fusion->operand(dot_rhs_param_number)));
-    llvm_ir::IrArray addend_array(
-        GetIrArrayFor(fusion->operand(addend_param_number)));
+    std::optional<llvm_ir::IrArray> addend_array;
+    if (epilogue->addend != nullptr) {
+      addend_array.emplace(GetIrArrayFor(
+          fusion->operand(epilogue->addend->parameter_number())));
+    }
 
+    FusedDotEpilogue fused_epilogue;
+    fused_epilogue.addend = addend_array ? &*addend_array : nullptr;
+    fused_epilogue.bias = epilogue->bias;
+    fused_epilogue.relu = epilogue->relu;
     TF_RETURN_IF_ERROR(EmitDotOperation(
-        *dot, target_array, lhs_array, rhs_array, &addend_array,
+        *dot, target_array, lhs_array, rhs_array, fused_epilogue,
         GetExecutableRunOptionsArgument(), &b_, mlir_context_,
         hlo_module_config_, target_machine_features_));
     return OkStatus();
@@ -15,6 +15,7 @@ limitations under the License.
 
 #include "tensorflow/compiler/xla/service/cpu/parallel_task_assignment.h"
 
+#include <algorithm>
 #include <memory>
 
 #include "absl/strings/str_cat.h"
@@ -29,6 +30,30 @@ limitations under the License.
 namespace xla {
 namespace cpu {
 
+namespace {
+
+// Returns the size of the output of 'instruction' or, for reductions, which
+// read far more than they write, the size of their largest operand.  This is
+// the amount of memory an I/O bound instruction streams through.
+int64_t MemoryFootprint(const HloInstruction& instruction,
+                        const HloCostAnalysis::ShapeSizeFunction& shape_size) {
+  const HloInstruction* root = instruction.opcode() == HloOpcode::kFusion
+                                   ? instruction.fused_expression_root()
+                                   : &instruction;
+  int64_t footprint = shape_size(instruction.shape());
+  if (root->opcode() == HloOpcode::kReduce ||
+      root->opcode() == HloOpcode::kReduceWindow) {
+    for (const HloInstruction* operand : instruction.operands()) {
+      if (operand->shape().IsArray()) {
+        footprint = std::max(footprint, shape_size(operand->shape()));
+      }
+    }
+  }
+  return footprint;
+}
+
+}  // namespace
+
 class SimpleCostModel : public ParallelCostModel {
  public:
   SimpleCostModel(const int64_t max_parallelism,
@@ -38,7 +63,7 @@ class SimpleCostModel : public ParallelCostModel {
 
   int64_t GetParallelTaskCount(HloInstruction* instruction) override {
     // Simple cost model based on hlo size and typical L2 cache size.
-    const int64_t instruction_cost = shape_size_(instruction->shape());
+    const int64_t instruction_cost = MemoryFootprint(*instruction, shape_size_);
     const int64_t min_cost_per_thread = 256LL << 10;  // 256KB L2 Cache size.
     // Return target parallel task count in [1, max_parallelism_].
     return std::min(
@@ -81,7 +106,7 @@ class DefaultCostModel : public ParallelCostModel {
           max_parallelism_,
           std::ceil(std::sqrt(tensorflow::port::MaxParallelism())));
       // Use shape size instruction cost and L2 cache size min per-thread cost.
-      instruction_cost = shape_size_(instruction->shape());
+      instruction_cost = MemoryFootprint(*instruction, shape_size_);
       min_cost_per_thread = 256LL << 10;  // 256KB L2 Cache size.
     } else {
       // Use max parallelism for compute bound instructions.
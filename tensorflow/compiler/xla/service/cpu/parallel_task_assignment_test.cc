@@ -20,6 +20,7 @@ limitations under the License.
 #include "tensorflow/compiler/xla/test.h"
 #include "tensorflow/compiler/xla/tests/hlo_test_base.h"
 #include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/cpu_info.h"
 
 namespace xla {
 namespace {
@@ -206,5 +207,31 @@ TEST_F(ParallelTaskAssignmentTest, ConstantNotParallelized) {
   EXPECT_FALSE(changed);
 }
 
+TEST_F(ParallelTaskAssignmentTest, ReduceWithSmallOutputParallelized) {
+  if (tensorflow::port::MaxParallelism() < 2) {
+    GTEST_SKIP() << "Needs at least two threads.";
+  }
+  // The output has only 8 elements, but the reduction reads 2MB.
+  constexpr char hlo_string[] = R"(
+  HloModule TestTaskParallel_reduce
+    add {
+      p0 = f32[] parameter(0)
+      p1 = f32[] parameter(1)
+      ROOT sum = f32[] add(p0, p1)
+    }
+
+    ENTRY reduce {
+      input = f32[8,65536] parameter(0)
+      zero = f32[] constant(0)
+      ROOT reduce = f32[8] reduce(input, zero), dimensions={1}, to_apply=add
+    }
+  )";
+
+  TF_ASSERT_OK_AND_ASSIGN(std::unique_ptr<HloModule> m,
+                          ParseAndReturnVerifiedModule(hlo_string));
+  TF_ASSERT_OK_AND_ASSIGN(bool changed, RunParallelTaskAssigner(m.get()));
+  EXPECT_TRUE(changed);
+}
+
 }  // namespace
 }  // namespace xla
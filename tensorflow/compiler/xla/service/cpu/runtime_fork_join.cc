@@ -17,6 +17,11 @@ limitations under the License.
 
 #define EIGEN_USE_THREADS
 
+#include <algorithm>
+#include <atomic>
+#include <memory>
+#include <vector>
+
 #include "absl/base/dynamic_annotations.h"
 #include "absl/strings/str_format.h"
 #include "absl/strings/str_join.h"
@@ -29,9 +34,29 @@ limitations under the License.
 using ComputeFunctionType = void (*)(void*, const void*, const void**, void**,
                                      void*, int64_t*, uint64_t*);
 
-// Dispatches 'num_partitions - 1' calls to 'function_ptr' in parallel.
-// Calls 'function_ptr' for first partition inline.
-// Uses blocking counter to synchronize threads after parallel calls complete.
+namespace {
+
+// The state of a fork/join that is shared with its workers.  A worker that
+// starts after all partitions were claimed only touches this state, so the
+// caller does not have to wait for it.
+struct ForkJoinState {
+  explicit ForkJoinState(int32_t num_partitions)
+      : statuses(num_partitions), done(num_partitions) {}
+
+  std::atomic<int32_t> next_partition{0};
+  std::vector<XlaCustomCallStatus> statuses;
+  tensorflow::BlockingCounter done;
+};
+
+}  // namespace
+
+// Calls 'function_ptr' for each of the 'num_partitions' partitions.
+//
+// The calling thread and up to one worker per thread of the intra-op thread
+// pool claim partitions one at a time from a shared counter until all of them
+// are claimed, so that threads that are free take over the partitions of
+// threads that are busy or slow to start, rather than each thread running a
+// fixed partition.  Returns once all partitions are done.
 //
 // The 'partitions' array has a total number of elements equal to
 // 'num_partitions * num_partitioned_dims * 2' (the '2' is necessary to specify
@@ -80,33 +105,33 @@ ABSL_ATTRIBUTE_NO_SANITIZE_MEMORY void __xla_cpu_runtime_ParallelForkJoin(
   // Compute partition stride in 'partitions' array.
   const int64_t stride = 2 * num_partitioned_dims;
 
-  std::vector<XlaCustomCallStatus> statuses(num_partitions);
-
-  // Dispatch 'num_partitions - 1' compute functions to run in parallel.
-  tensorflow::BlockingCounter bc(num_partitions - 1);
-  for (int32_t i = 1; i < num_partitions; ++i) {
-    const int64_t offset = i * stride;
-    run_options->intra_op_thread_pool()->enqueueNoNotification(
-        [i, function, result_ptr, run_options_ptr, buffer_table, prof_counters,
-         partitions, offset, &bc, &statuses]() {
-          function(result_ptr, run_options_ptr, nullptr, buffer_table,
-                   &statuses[i], &partitions[offset], prof_counters);
-          bc.DecrementCount();
-          VLOG(3) << "ParallelForkJoin partition " << i << " done.";
-        });
-  }
+  auto state = std::make_shared<ForkJoinState>(num_partitions);
+  auto run_partitions = [state, function, result_ptr, run_options_ptr,
+                         buffer_table, prof_counters, partitions, stride,
+                         num_partitions]() {
+    for (int32_t i = state->next_partition.fetch_add(1); i < num_partitions;
+         i = state->next_partition.fetch_add(1)) {
+      function(result_ptr, run_options_ptr, nullptr, buffer_table,
+               &state->statuses[i], &partitions[i * stride], prof_counters);
+      VLOG(3) << "ParallelForkJoin partition " << i << " done.";
+      state->done.DecrementCount();
+    }
+  };
 
-  // Call first compute function inline.
-  function(result_ptr, run_options_ptr, params, buffer_table, &statuses[0],
-           &partitions[0], prof_counters);
-  VLOG(3) << "ParallelForkJoin partition 0 done.";
-  bc.Wait();
+  // Dispatch the workers, and work on the partitions inline as well.
+  const int32_t num_workers = std::min(
+      num_partitions - 1, run_options->intra_op_thread_pool()->numThreads());
+  for (int32_t i = 0; i < num_workers; ++i) {
+    run_options->intra_op_thread_pool()->enqueueNoNotification(run_partitions);
+  }
+  run_partitions();
+  state->done.Wait();
 
   // Collect all error messages (if any).
   std::vector<std::pair<int32_t, absl::string_view>> error_messages;
   for (int32_t i = 0; i < num_partitions; ++i) {
     std::optional<absl::string_view> msg =
-        xla::CustomCallStatusGetMessage(&statuses[i]);
+        xla::CustomCallStatusGetMessage(&state->statuses[i]);
     if (msg) {
       error_messages.emplace_back(i, *msg);
     }
@@ -21,6 +21,7 @@ limitations under the License.
 #include "third_party/eigen3/unsupported/Eigen/CXX11/Tensor"
 #include "tensorflow/compiler/xla/executable_run_options.h"
 #include "tensorflow/compiler/xla/service/cpu/runtime_lightweight_check.h"
+#include "tensorflow/compiler/xla/service/cpu/runtime_matmul_epilogue.h"
 
 #if defined(TENSORFLOW_USE_CUSTOM_CONTRACTION_KERNEL)
 #include "tensorflow/core/kernels/eigen_contraction_kernel.h"
@@ -32,10 +33,11 @@ bool Is16BytesAligned(void* ptr) {
   return reinterpret_cast<uintptr_t>(ptr) % 16 == 0;
 }
 
-template <typename T, Eigen::AlignmentType Alignment>
+template <typename T, Eigen::AlignmentType Alignment,
+          typename OutputKernel = Eigen::NoOpOutputKernel>
 void MatMul(const void* run_options_ptr, T* out, T* lhs, T* rhs, int64_t m,
-            int64_t n, int64_t k, int32_t transpose_lhs,
-            int32_t transpose_rhs) {
+            int64_t n, int64_t k, int32_t transpose_lhs, int32_t transpose_rhs,
+            const OutputKernel& output_kernel = OutputKernel()) {
   const xla::ExecutableRunOptions* run_options =
       static_cast<const xla::ExecutableRunOptions*>(run_options_ptr);
 
@@ -67,7 +69,8 @@ void MatMul(const void* run_options_ptr, T* out, T* lhs, T* rhs, int64_t m,
   // the contraction is performed along dimension 1 of the lhs and dimension
   // 0 of the rhs.
   XLA_LIGHTWEIGHT_CHECK(run_options->intra_op_thread_pool() != nullptr);
-  C.device(*run_options->intra_op_thread_pool()) = A.contract(B, dims);
+  C.device(*run_options->intra_op_thread_pool()) =
+      A.contract(B, dims, output_kernel);
 }
 
 template <typename T, Eigen::AlignmentType Alignment>
@@ -113,21 +116,22 @@ void MatMul_Batch(const void* run_options_ptr, T* out, T* lhs, T* rhs,
   }
 }
 
-template <typename T>
+template <typename T, typename OutputKernel = Eigen::NoOpOutputKernel>
 void MatMulDispatch(const void* run_options_ptr, T* out, T* lhs, T* rhs,
                     int64_t m, int64_t n, int64_t k, int32_t transpose_lhs,
-                    int32_t transpose_rhs) {
+                    int32_t transpose_rhs,
+                    const OutputKernel& output_kernel = OutputKernel()) {
   bool all_buffers_16b_aligned =
       Is16BytesAligned(out) && Is16BytesAligned(lhs) && Is16BytesAligned(rhs);
 
   if (!all_buffers_16b_aligned) {
     MatMul<T, Eigen::Unaligned>(run_options_ptr, out, lhs, rhs, m, n, k,
-                                transpose_lhs, transpose_rhs);
+                                transpose_lhs, transpose_rhs, output_kernel);
     return;
   }
 
   MatMul<T, Eigen::Aligned16>(run_options_ptr, out, lhs, rhs, m, n, k,
-                              transpose_lhs, transpose_rhs);
+                              transpose_lhs, transpose_rhs, output_kernel);
 }
 
 template <typename T>
@@ -163,6 +167,18 @@ ABSL_ATTRIBUTE_NO_SANITIZE_MEMORY void __xla_cpu_runtime_EigenMatMulF32(
                         transpose_rhs);
 }
 
+ABSL_ATTRIBUTE_NO_SANITIZE_MEMORY void
+__xla_cpu_runtime_EigenMatMulF32WithEpilogue(
+    const void* run_options_ptr, float* out, float* lhs, float* rhs, int64_t m,
+    int64_t n, int64_t k, int32_t transpose_lhs, int32_t transpose_rhs,
+    float* addend, int32_t addend_kind, int32_t relu) {
+  const xla::cpu::MatMulEpilogueOutputKernel<float> output_kernel{
+      addend, static_cast<xla::cpu::MatMulAddendKind>(addend_kind), m,
+      relu != 0};
+  MatMulDispatch<float>(run_options_ptr, out, lhs, rhs, m, n, k, transpose_lhs,
+                        transpose_rhs, output_kernel);
+}
+
 ABSL_ATTRIBUTE_NO_SANITIZE_MEMORY void __xla_cpu_runtime_EigenMatMulF64(
     const void* run_options_ptr, double* out, double* lhs, double* rhs,
     int64_t m, int64_t n, int64_t k, int32_t transpose_lhs,
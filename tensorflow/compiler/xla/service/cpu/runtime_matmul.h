@@ -39,6 +39,16 @@ extern void __xla_cpu_runtime_EigenMatMulF32(
     float* lhs, float* rhs, int64_t m, int64_t n, int64_t k,
     int32_t transpose_lhs, int32_t transpose_rhs);
 
+// Like __xla_cpu_runtime_EigenMatMulF32, but computes
+// out = relu(lhs * rhs + addend).  'addend_kind' is a MatMulAddendKind that
+// describes how 'addend' is broadcast over 'out', and the ReLU is only applied
+// if 'relu' is nonzero.
+extern void __xla_cpu_runtime_EigenMatMulF32WithEpilogue(
+    const void* /* xla::ExecutableRunOptions* */ run_options_ptr, float* out,
+    float* lhs, float* rhs, int64_t m, int64_t n, int64_t k,
+    int32_t transpose_lhs, int32_t transpose_rhs, float* addend,
+    int32_t addend_kind, int32_t relu);
+
 extern void __xla_cpu_runtime_EigenMatMulF64(
     const void* /* xla::ExecutableRunOptions* */ run_options_ptr, double* out,
     double* lhs, double* rhs, int64_t m, int64_t n, int64_t k,
@@ -0,0 +1,95 @@
+/* Copyright 2022 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_COMPILER_XLA_SERVICE_CPU_RUNTIME_MATMUL_EPILOGUE_H_
+#define TENSORFLOW_COMPILER_XLA_SERVICE_CPU_RUNTIME_MATMUL_EPILOGUE_H_
+
+#include <stdint.h>
+
+namespace xla {
+namespace cpu {
+
+// How the addend of a matrix multiplication with an epilogue is broadcast over
+// the m x n column-major output.
+enum class MatMulAddendKind : int32_t {
+  kNone = 0,
+  // The addend is an m x n column-major matrix.
+  kMatrix = 1,
+  // The addend is a vector of m elements, one per row of the output.
+  kPerRow = 2,
+  // The addend is a vector of n elements, one per column of the output.
+  kPerColumn = 3,
+};
+
+// An Eigen tensor contraction output kernel that computes
+//
+//   out = relu(out + addend)
+//
+// for each block of the output while the block is still in cache.  Both the
+// addend and the ReLU are optional, and the ReLU propagates NaNs.
+template <typename T>
+struct MatMulEpilogueOutputKernel {
+  const T* addend;
+  MatMulAddendKind addend_kind;
+  // The number of rows in the output.
+  int64_t m;
+  bool relu;
+
+  template <typename OutputMapper, typename Params, typename Index>
+  void operator()(const OutputMapper& output_mapper, const Params& params,
+                  Index i, Index j, Index num_rows, Index num_cols) const {
+    for (Index c = 0; c < num_cols; ++c) {
+      T* out = &output_mapper(0, c);
+      // With swapped arguments Eigen computes the transposed output, so the
+      // elements of a block column belong to one row of the output.
+      int64_t row = i, col = j + c, row_stride = 1, col_stride = 0;
+      if (params.swapped_arguments) {
+        row = j + c;
+        col = i;
+        row_stride = 0;
+        col_stride = 1;
+      }
+      const T* addend_base = nullptr;
+      int64_t addend_stride = 0;
+      switch (addend_kind) {
+        case MatMulAddendKind::kNone:
+          break;
+        case MatMulAddendKind::kMatrix:
+          addend_base = addend + row + col * m;
+          addend_stride = row_stride + col_stride * m;
+          break;
+        case MatMulAddendKind::kPerRow:
+          addend_base = addend + row;
+          addend_stride = row_stride;
+          break;
+        case MatMulAddendKind::kPerColumn:
+          addend_base = addend + col;
+          addend_stride = col_stride;
+          break;
+      }
+      for (Index r = 0; r < num_rows; ++r) {
+        T value = out[r];
+        if (addend_base != nullptr) value += addend_base[r * addend_stride];
+        if (relu && value < T(0)) value = T(0);
+        out[r] = value;
+      }
+    }
+  }
+};
+
+}  // namespace cpu
+}  // namespace xla
+
+#endif  // TENSORFLOW_COMPILER_XLA_SERVICE_CPU_RUNTIME_MATMUL_EPILOGUE_H_
@@ -16,6 +16,7 @@ limitations under the License.
 #include "tensorflow/compiler/xla/service/cpu/runtime_single_threaded_matmul.h"
 
 #include "absl/base/attributes.h"
+#include "tensorflow/compiler/xla/service/cpu/runtime_matmul_epilogue.h"
 #include "third_party/eigen3/unsupported/Eigen/CXX11/Tensor"
 
 #if defined(TENSORFLOW_USE_CUSTOM_CONTRACTION_KERNEL)
@@ -28,10 +29,11 @@ bool Is16BytesAligned(void* ptr) {
   return reinterpret_cast<uintptr_t>(ptr) % 16 == 0;
 }
 
-template <typename T, Eigen::AlignmentType Alignment>
+template <typename T, Eigen::AlignmentType Alignment,
+          typename OutputKernel = Eigen::NoOpOutputKernel>
 void MatMul(const void* run_options_ptr, T* out, T* lhs, T* rhs, int64_t m,
-            int64_t n, int64_t k, int32_t transpose_lhs,
-            int32_t transpose_rhs) {
+            int64_t n, int64_t k, int32_t transpose_lhs, int32_t transpose_rhs,
+            const OutputKernel& output_kernel = OutputKernel()) {
   int64_t lhs_rows = m;
   int64_t lhs_cols = k;
   if (transpose_lhs) {
@@ -59,24 +61,25 @@ void MatMul(const void* run_options_ptr, T* out, T* lhs, T* rhs, int64_t m,
   // Matrix multiply is a special case of the "contract" operation where
   // the contraction is performed along dimension 1 of the lhs and dimension
   // 0 of the rhs.
-  C = A.contract(B, dims);
+  C = A.contract(B, dims, output_kernel);
 }
 
-template <typename T>
-void SingleThreadedMatMulDispatch(const void* run_options_ptr, T* out, T* lhs,
-                                  T* rhs, int64_t m, int64_t n, int64_t k,
-                                  int32_t transpose_lhs,
-                                  int32_t transpose_rhs) {
+template <typename T, typename OutputKernel = Eigen::NoOpOutputKernel>
+void SingleThreadedMatMulDispatch(
+    const void* run_options_ptr, T* out, T* lhs, T* rhs, int64_t m, int64_t n,
+    int64_t k, int32_t transpose_lhs, int32_t transpose_rhs,
+    const OutputKernel& output_kernel = OutputKernel()) {
   bool all_buffers_16b_aligned =
       Is16BytesAligned(out) && Is16BytesAligned(lhs) && Is16BytesAligned(rhs);
 
   if (!all_buffers_16b_aligned) {
     MatMul<T, Eigen::Unaligned>(run_options_ptr, out, lhs, rhs, m, n, k,
-                                transpose_lhs, transpose_rhs);
+                                transpose_lhs, transpose_rhs, output_kernel);
+    return;
   }
 
   MatMul<T, Eigen::Aligned16>(run_options_ptr, out, lhs, rhs, m, n, k,
-                              transpose_lhs, transpose_rhs);
+                              transpose_lhs, transpose_rhs, output_kernel);
 }
 
 }  // namespace
@@ -100,6 +103,19 @@ __xla_cpu_runtime_EigenSingleThreadedMatMulF32(const void* run_options_ptr,
                                       transpose_lhs, transpose_rhs);
 }
 
+ABSL_ATTRIBUTE_NO_SANITIZE_MEMORY void
+__xla_cpu_runtime_EigenSingleThreadedMatMulF32WithEpilogue(
+    const void* run_options_ptr, float* out, float* lhs, float* rhs, int64_t m,
+    int64_t n, int64_t k, int32_t transpose_lhs, int32_t transpose_rhs,
+    float* addend, int32_t addend_kind, int32_t relu) {
+  const xla::cpu::MatMulEpilogueOutputKernel<float> output_kernel{
+      addend, static_cast<xla::cpu::MatMulAddendKind>(addend_kind), m,
+      relu != 0};
+  SingleThreadedMatMulDispatch<float>(run_options_ptr, out, lhs, rhs, m, n, k,
+                                      transpose_lhs, transpose_rhs,
+                                      output_kernel);
+}
+
 ABSL_ATTRIBUTE_NO_SANITIZE_MEMORY void
 __xla_cpu_runtime_EigenSingleThreadedMatMulF64(const void* run_options_ptr,
                                                double* out, double* lhs,
@@ -28,6 +28,7 @@ limitations under the License.
 #include "llvm/ExecutionEngine/Orc/RTDyldObjectLinkingLayer.h"
 #include "llvm/ExecutionEngine/Orc/SymbolStringPool.h"
 #include "llvm/IR/Module.h"
+#include "llvm/Support/MemoryBuffer.h"
 #include "llvm/Target/TargetMachine.h"
 #include "tensorflow/compiler/xla/service/cpu/compiler_functor.h"
 #include "tensorflow/compiler/xla/types.h"
@@ -79,6 +80,18 @@ class SimpleOrcJIT : public llvm::JITEventListener {
 
   llvm::Error AddModule(llvm::orc::ThreadSafeModule module);
 
+  // Optimizes `module` and compiles it to an object file with a target machine
+  // of its own, so that several modules can be compiled concurrently.  The
+  // given hooks are run instead of the ones the JIT was created with.
+  llvm::Expected<std::unique_ptr<llvm::MemoryBuffer>> CompileModule(
+      llvm::Module& module, LLVMCompiler::ModuleHook pre_optimization_hook,
+      LLVMCompiler::ModuleHook post_optimization_hook,
+      std::function<void(const llvm::object::ObjectFile&)> post_codegen_hook)
+      const;
+
+  // Adds an object file produced by CompileModule to the JIT.
+  llvm::Error AddObjectFile(std::unique_ptr<llvm::MemoryBuffer> object_file);
+
   // Discards objects we no longer need once we are done compiling.
   void DoneCompiling();
 
@@ -108,6 +121,12 @@ class SimpleOrcJIT : public llvm::JITEventListener {
       const llvm::RuntimeDyld::LoadedObjectInfo& object_info) override;
   void notifyFreeingObject(llvm::JITEventListener::ObjectKey key) override;
 
+  const llvm::TargetOptions target_options_;
+  const llvm::CodeGenOpt::Level opt_level_;
+  const bool optimize_for_size_;
+  const bool disable_expensive_passes_;
+  const llvm::FastMathFlags fast_math_flags_;
+
   std::unique_ptr<llvm::TargetMachine> target_machine_;
   llvm::Triple target_triple_;
   const llvm::DataLayout data_layout_;
@@ -332,6 +332,59 @@ TEST_F(CpuFusionTest, DoNotDuplicateExpensiveOps) {
   EXPECT_EQ(0, fusion_inst->operand_count());
 }
 
+TEST_F(CpuFusionTest, DotBiasReluOutputFusion) {
+  const char* const hlo_string = R"(
+HloModule DotBiasRelu
+
+ENTRY main {
+  lhs = f32[64,128]{1,0} parameter(0)
+  rhs = f32[128,96]{1,0} parameter(1)
+  bias = f32[96]{0} parameter(2)
+  dot = f32[64,96]{1,0} dot(lhs, rhs), lhs_contracting_dims={1}, rhs_contracting_dims={0}
+  bias_broadcast = f32[64,96]{1,0} broadcast(bias), dimensions={1}
+  add = f32[64,96]{1,0} add(dot, bias_broadcast)
+  zero = f32[] constant(0)
+  zeros = f32[64,96]{1,0} broadcast(zero), dimensions={}
+  ROOT relu = f32[64,96]{1,0} maximum(add, zeros)
+}
+)";
+  EXPECT_TRUE(RunAndCompare(hlo_string, ErrorSpec{1e-4, 1e-4}));
+}
+
+TEST_F(CpuFusionTest, ColumnMajorDotBiasOutputFusion) {
+  const char* const hlo_string = R"(
+HloModule ColumnMajorDotBias
+
+ENTRY main {
+  lhs = f32[64,128]{0,1} parameter(0)
+  rhs = f32[128,96]{0,1} parameter(1)
+  bias = f32[96]{0} parameter(2)
+  dot = f32[64,96]{0,1} dot(lhs, rhs), lhs_contracting_dims={1}, rhs_contracting_dims={0}
+  bias_broadcast = f32[64,96]{0,1} broadcast(bias), dimensions={1}
+  ROOT add = f32[64,96]{0,1} add(dot, bias_broadcast)
+}
+)";
+  EXPECT_TRUE(RunAndCompare(hlo_string, ErrorSpec{1e-4, 1e-4}));
+}
+
+TEST_F(CpuFusionTest, DotAddendReluOutputFusion) {
+  const char* const hlo_string = R"(
+HloModule DotAddendRelu
+
+ENTRY main {
+  lhs = f32[64,128]{1,0} parameter(0)
+  rhs = f32[128,96]{1,0} parameter(1)
+  addend = f32[64,96]{1,0} parameter(2)
+  dot = f32[64,96]{1,0} dot(lhs, rhs), lhs_contracting_dims={1}, rhs_contracting_dims={0}
+  add = f32[64,96]{1,0} add(addend, dot)
+  zero = f32[] constant(0)
+  zeros = f32[64,96]{1,0} broadcast(zero), dimensions={}
+  ROOT relu = f32[64,96]{1,0} maximum(zeros, add)
+}
+)";
+  EXPECT_TRUE(RunAndCompare(hlo_string, ErrorSpec{1e-4, 1e-4}));
+}
+
 }  // namespace
 }  // namespace cpu
 }  // namespace xla
@@ -15,6 +15,7 @@ limitations under the License.
 
 #include <memory>
 #include <string>
+#include <vector>
 
 #include "tensorflow/compiler/xla/service/cpu/cpu_compiler.h"
 #include "tensorflow/compiler/xla/service/cpu/tests/cpu_codegen_test.h"
@@ -66,6 +67,61 @@ ENTRY entry {
   LiteralTestUtil::ExpectR0Equal(3, result);
 }
 
+class CpuParallelCodegenTest : public CpuCodegenTest {
+  DebugOptions GetDebugOptionsForTest() override {
+    DebugOptions debug_options = CpuCodegenTest::GetDebugOptionsForTest();
+    debug_options.set_xla_cpu_parallel_codegen_split_count(4);
+    return debug_options;
+  }
+};
+
+TEST_F(CpuParallelCodegenTest, WhileWithReduce) {
+  const std::string hlo_text = R"(
+HloModule module
+
+add {
+  add.p0 = f32[] parameter(0)
+  add.p1 = f32[] parameter(1)
+  ROOT add.sum = f32[] add(add.p0, add.p1)
+}
+
+body {
+  body.p0 = (s32[], f32[16]) parameter(0)
+  body.i = s32[] get-tuple-element(body.p0), index=0
+  body.c1 = s32[] constant(1)
+  body.next = s32[] add(body.i, body.c1)
+  body.v = f32[16] get-tuple-element(body.p0), index=1
+  body.zero = f32[] constant(0)
+  body.sum = f32[] reduce(body.v, body.zero), dimensions={0}, to_apply=add
+  body.bcast = f32[16] broadcast(body.sum), dimensions={}
+  ROOT body.root = (s32[], f32[16]) tuple(body.next, body.bcast)
+}
+
+cond {
+  cond.p0 = (s32[], f32[16]) parameter(0)
+  cond.i = s32[] get-tuple-element(cond.p0), index=0
+  cond.c2 = s32[] constant(2)
+  ROOT cond.root = pred[] compare(cond.i, cond.c2), direction=LT
+}
+
+ENTRY entry {
+  entry.c0 = s32[] constant(0)
+  entry.one = f32[] constant(1)
+  entry.v = f32[16] broadcast(entry.one), dimensions={}
+  entry.init = (s32[], f32[16]) tuple(entry.c0, entry.v)
+  entry.while = (s32[], f32[16]) while(entry.init), condition=cond, body=body
+  ROOT entry.root = f32[16] get-tuple-element(entry.while), index=1
+}
+)";
+
+  TF_ASSERT_OK_AND_ASSIGN(auto module, ParseAndReturnVerifiedModule(hlo_text));
+
+  // The loop body and condition are compiled apart from the entry
+  // computation, and the reducer stays with its caller.
+  auto result = ExecuteAndTransfer(std::move(module), {});
+  LiteralTestUtil::ExpectR1Equal<float>(std::vector<float>(16, 256), result);
+}
+
 }  // namespace
 }  // namespace cpu
 }  // namespace xla
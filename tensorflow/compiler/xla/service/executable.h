@@ -354,6 +354,14 @@ class Executable {
 
   const HloModuleConfig& module_config() const { return hlo_module_->config(); }
 
+  // Returns the compile profile of the module: the metadata of each HLO pass
+  // run, with its wall time, instruction counts and the peak memory of the
+  // compiler. Empty if the executable has no module.
+  HloModuleMetadataProto compilation_profile() const {
+    return has_module() ? hlo_module_->metadata().proto()
+                        : HloModuleMetadataProto();
+  }
+
   // The shape (including layout) that results from this execution. This is the
   // shape of the DeviceMemoryBase result value in ExecuteOnStream above.
   const Shape& result_shape() const {
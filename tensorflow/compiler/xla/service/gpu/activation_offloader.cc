@@ -0,0 +1,259 @@
+/* Copyright 2022 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/compiler/xla/service/gpu/activation_offloader.h"
+
+#include <algorithm>
+#include <memory>
+#include <optional>
+#include <utility>
+#include <vector>
+
+#include "absl/algorithm/container.h"
+#include "absl/container/flat_hash_map.h"
+#include "tensorflow/compiler/xla/service/gpu/gpu_constants.h"
+#include "tensorflow/compiler/xla/service/hlo_alias_analysis.h"
+#include "tensorflow/compiler/xla/service/hlo_computation.h"
+#include "tensorflow/compiler/xla/service/hlo_instruction.h"
+#include "tensorflow/compiler/xla/service/hlo_live_range.h"
+#include "tensorflow/compiler/xla/service/hlo_opcode.h"
+#include "tensorflow/compiler/xla/service/hlo_schedule.h"
+#include "tensorflow/compiler/xla/shape_util.h"
+#include "tensorflow/compiler/xla/status_macros.h"
+
+namespace xla {
+namespace gpu {
+namespace {
+
+// An offload of `value`, in positions of the entry sequence: the copy to the
+// host starts after the use at `before_gap` and is done after `offload_done`,
+// the copy back starts before `reload_start` and is done before the use at
+// `after_gap`. The device buffer is free in between.
+struct Offload {
+  HloInstruction* value;
+  int64_t size_bytes;
+  int64_t before_gap;
+  int64_t offload_done;
+  int64_t reload_start;
+  int64_t after_gap;
+
+  int64_t saved_instructions() const {
+    return reload_start - offload_done - 1;
+  }
+};
+
+// Returns whether the buffer of `instr` is freed once its users are done, so
+// that offloading it saves device memory.
+bool CanOffload(const HloInstruction& instr) {
+  if (!instr.shape().IsArray() ||
+      instr.shape().layout().memory_space() != 0 ||
+      instr.parent()->root_instruction() == &instr) {
+    return false;
+  }
+  switch (instr.opcode()) {
+    case HloOpcode::kParameter:
+    case HloOpcode::kConstant:
+    case HloOpcode::kBitcast:
+    case HloOpcode::kGetTupleElement:
+    case HloOpcode::kCopyDone:
+      return false;
+    default:
+      break;
+  }
+  // Users that alias the buffer keep it alive beyond their own position.
+  return absl::c_none_of(instr.users(), [](const HloInstruction* user) {
+    return user->opcode() == HloOpcode::kBitcast ||
+           user->opcode() == HloOpcode::kTuple ||
+           user->opcode() == HloOpcode::kAddDependency;
+  });
+}
+
+// Returns the estimated bytes live in device memory at each position of the
+// entry sequence.
+StatusOr<std::vector<int64_t>> LiveBytes(const HloModule& module,
+                                         int64_t pointer_size) {
+  const HloComputation* entry = module.entry_computation();
+  TF_ASSIGN_OR_RETURN(std::unique_ptr<HloAliasAnalysis> alias_analysis,
+                      HloAliasAnalysis::Run(&module));
+  TF_ASSIGN_OR_RETURN(
+      std::unique_ptr<HloLiveRange> live_range,
+      HloLiveRange::Run(module.schedule(), *alias_analysis, entry,
+                        /*module_scoped_analysis=*/false));
+  const int64_t size = module.schedule().sequence(entry).size();
+  std::vector<int64_t> live_bytes(size + 1, 0);
+  for (const auto& [value, time_bound] : live_range->buffer_live_ranges()) {
+    if (value->defining_instruction()->parent() != entry ||
+        (value->shape().IsArray() &&
+         value->shape().layout().memory_space() != 0)) {
+      continue;
+    }
+    const int64_t bytes = ShapeUtil::ByteSizeOf(value->shape(), pointer_size);
+    live_bytes[std::max<int64_t>(time_bound.start, 0)] += bytes;
+    live_bytes[std::min<int64_t>(time_bound.end, size - 1) + 1] -= bytes;
+  }
+  for (int64_t i = 1; i < size; ++i) {
+    live_bytes[i] += live_bytes[i - 1];
+  }
+  live_bytes.pop_back();
+  return live_bytes;
+}
+
+}  // namespace
+
+StatusOr<bool> ActivationOffloader::Run(HloModule* module) {
+  TF_RET_CHECK(module->has_schedule()) << "The module must be scheduled.";
+  HloComputation* entry = module->entry_computation();
+  const std::vector<HloInstruction*> sequence =
+      module->schedule().sequence(entry).instructions();
+  const int64_t size = sequence.size();
+  absl::flat_hash_map<const HloInstruction*, int64_t> position;
+  // The estimated seconds the instructions before each position take.
+  std::vector<double> start_seconds(size + 1, 0.0);
+  for (int64_t i = 0; i < size; ++i) {
+    position[sequence[i]] = i;
+    start_seconds[i + 1] =
+        start_seconds[i] + cost_analysis_->optimal_seconds(*sequence[i]);
+  }
+
+  // Finds the offload with the most instructions in between for each value.
+  std::vector<Offload> offloads;
+  for (int64_t i = 0; i < size; ++i) {
+    HloInstruction* instr = sequence[i];
+    const int64_t size_bytes =
+        ShapeUtil::ByteSizeOf(instr->shape(), options_.pointer_size);
+    if (size_bytes < options_.min_size_bytes || !CanOffload(*instr)) {
+      continue;
+    }
+    std::vector<int64_t> uses = {i};
+    for (const HloInstruction* user : instr->users()) {
+      uses.push_back(position.at(user));
+    }
+    absl::c_sort(uses);
+    uses.erase(std::unique(uses.begin(), uses.end()), uses.end());
+    const double copy_seconds = size_bytes / options_.host_bytes_per_second;
+    std::optional<Offload> best;
+    for (int64_t j = 0; j + 1 < static_cast<int64_t>(uses.size()); ++j) {
+      // The copy to the host is done after the first instruction that ends
+      // `copy_seconds` after the gap starts, and the copy back starts before
+      // the last instruction that starts `copy_seconds` before it ends.
+      const int64_t offload_done =
+          std::lower_bound(start_seconds.begin() + uses[j] + 2,
+                           start_seconds.begin() + uses[j + 1] + 1,
+                           start_seconds[uses[j] + 1] + copy_seconds) -
+          start_seconds.begin() - 1;
+      const int64_t reload_start =
+          std::upper_bound(start_seconds.begin() + uses[j] + 1,
+                           start_seconds.begin() + uses[j + 1],
+                           start_seconds[uses[j + 1]] - copy_seconds) -
+          start_seconds.begin() - 1;
+      Offload offload{instr,        size_bytes,   uses[j],
+                      offload_done, reload_start, uses[j + 1]};
+      if (offload_done < uses[j + 1] && reload_start > uses[j] &&
+          offload.saved_instructions() > 0 &&
+          (!best || offload.saved_instructions() >
+                        best->saved_instructions())) {
+        best = offload;
+      }
+    }
+    if (best) {
+      offloads.push_back(*best);
+    }
+  }
+  if (offloads.empty()) {
+    return false;
+  }
+  absl::c_stable_sort(offloads, [](const Offload& a, const Offload& b) {
+    return a.size_bytes * a.saved_instructions() >
+           b.size_bytes * b.saved_instructions();
+  });
+
+  // Picks the offloads that are live where the memory exceeds the limit.
+  TF_ASSIGN_OR_RETURN(std::vector<int64_t> live_bytes,
+                      LiveBytes(*module, options_.pointer_size));
+  std::vector<Offload> picked;
+  for (const Offload& offload : offloads) {
+    if (*absl::c_max_element(live_bytes) <= options_.memory_limit_bytes) {
+      break;
+    }
+    auto begin = live_bytes.begin() + offload.offload_done + 1;
+    auto end = live_bytes.begin() + offload.reload_start;
+    if (*std::max_element(begin, end) <= options_.memory_limit_bytes) {
+      continue;
+    }
+    for (auto it = begin; it != end; ++it) {
+      *it -= offload.size_bytes;
+    }
+    picked.push_back(offload);
+  }
+  if (picked.empty()) {
+    return false;
+  }
+
+  absl::flat_hash_map<int64_t, std::vector<HloInstruction*>> schedule_before;
+  absl::flat_hash_map<int64_t, std::vector<HloInstruction*>> schedule_after;
+  for (const Offload& offload : picked) {
+    HloInstruction* value = offload.value;
+    const Shape& device_shape = value->shape();
+    Shape host_shape = device_shape;
+    host_shape.mutable_layout()->set_memory_space(kHostMemorySpace);
+    const Shape context_shape = ShapeUtil::MakeShape(U32, {});
+    HloInstruction* offload_start =
+        entry->AddInstruction(HloInstruction::CreateCopyStart(
+            ShapeUtil::MakeTupleShape(
+                {host_shape, device_shape, context_shape}),
+            value));
+    HloInstruction* offload_done = entry->AddInstruction(
+        HloInstruction::CreateUnary(host_shape, HloOpcode::kCopyDone,
+                                    offload_start));
+    HloInstruction* reload_start =
+        entry->AddInstruction(HloInstruction::CreateCopyStart(
+            ShapeUtil::MakeTupleShape(
+                {device_shape, host_shape, context_shape}),
+            offload_done));
+    HloInstruction* reload_done = entry->AddInstruction(
+        HloInstruction::CreateUnary(device_shape, HloOpcode::kCopyDone,
+                                    reload_start));
+    const std::vector<HloInstruction*> users = value->users();
+    for (HloInstruction* user : users) {
+      if (position.at(user) >= offload.after_gap) {
+        TF_RETURN_IF_ERROR(value->ReplaceUseWith(user, reload_done));
+      }
+    }
+    schedule_after[offload.before_gap].push_back(offload_start);
+    schedule_after[offload.offload_done].push_back(offload_done);
+    schedule_before[offload.reload_start].push_back(reload_start);
+    schedule_before[offload.after_gap].push_back(reload_done);
+    VLOG(2) << "Offloading " << value->name() << " to host memory from "
+            << sequence[offload.offload_done]->name() << " to "
+            << sequence[offload.reload_start]->name();
+  }
+
+  HloInstructionSequence new_sequence;
+  for (int64_t i = 0; i < size; ++i) {
+    for (HloInstruction* instr : schedule_before[i]) {
+      new_sequence.push_back(instr);
+    }
+    new_sequence.push_back(sequence[i]);
+    for (HloInstruction* instr : schedule_after[i]) {
+      new_sequence.push_back(instr);
+    }
+  }
+  module->schedule().set_sequence(entry, std::move(new_sequence));
+  TF_RETURN_IF_ERROR(module->schedule().Verify());
+  return true;
+}
+
+}  // namespace gpu
+}  // namespace xla
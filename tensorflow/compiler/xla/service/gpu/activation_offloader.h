@@ -0,0 +1,73 @@
+/* Copyright 2022 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_COMPILER_XLA_SERVICE_GPU_ACTIVATION_OFFLOADER_H_
+#define TENSORFLOW_COMPILER_XLA_SERVICE_GPU_ACTIVATION_OFFLOADER_H_
+
+#include <cstdint>
+
+#include "tensorflow/compiler/xla/service/hlo_cost_analysis.h"
+#include "tensorflow/compiler/xla/service/hlo_module.h"
+#include "tensorflow/compiler/xla/service/hlo_pass_interface.h"
+
+namespace xla {
+namespace gpu {
+
+// Offloads values of the scheduled entry computation to pinned host memory
+// while they are not used, e.g. the activations of the forward pass until the
+// backward pass reads them.
+//
+// For the longest gap between two uses of a value, the pass copies the value
+// to kHostMemorySpace with a copy-start/copy-done pair after the use before
+// the gap, and back before the use after the gap, which then reads the copy.
+// The copies run on the async stream, so the copy-dones are scheduled once the
+// cost analysis estimates the compute since the copy-start to have hidden the
+// copy. The device buffer is free between the two copies.
+//
+// Values are offloaded by decreasing bytes times instructions saved, as long
+// as they are live where the estimated peak memory exceeds the limit.
+class ActivationOffloader : public HloModulePass {
+ public:
+  struct Options {
+    // Values smaller than this stay in device memory.
+    int64_t min_size_bytes = 1 << 20;
+    // The bandwidth of the copies between device and host memory.
+    double host_bytes_per_second = 12e9;
+    // Values are offloaded until the estimated peak memory of the schedule
+    // fits into this. 0 offloads all values that have a long enough gap.
+    int64_t memory_limit_bytes = 0;
+    int64_t pointer_size = 8;
+  };
+
+  // `cost_analysis` estimates the run time of the entry computation's
+  // instructions, and must outlive the pass.
+  ActivationOffloader(const HloCostAnalysis* cost_analysis,
+                      const Options& options)
+      : cost_analysis_(cost_analysis), options_(options) {}
+
+  absl::string_view name() const override { return "activation-offloader"; }
+
+  // The module must be scheduled, and the schedule is updated.
+  StatusOr<bool> Run(HloModule* module) override;
+
+ private:
+  const HloCostAnalysis* cost_analysis_;
+  const Options options_;
+};
+
+}  // namespace gpu
+}  // namespace xla
+
+#endif  // TENSORFLOW_COMPILER_XLA_SERVICE_GPU_ACTIVATION_OFFLOADER_H_
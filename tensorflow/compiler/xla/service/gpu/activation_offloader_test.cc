@@ -0,0 +1,117 @@
+/* Copyright 2022 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/compiler/xla/service/gpu/activation_offloader.h"
+
+#include <memory>
+#include <vector>
+
+#include "tensorflow/compiler/xla/service/gpu/gpu_constants.h"
+#include "tensorflow/compiler/xla/service/gpu/gpu_hlo_cost_analysis.h"
+#include "tensorflow/compiler/xla/service/hlo_instruction.h"
+#include "tensorflow/compiler/xla/service/hlo_opcode.h"
+#include "tensorflow/compiler/xla/shape_util.h"
+#include "tensorflow/compiler/xla/tests/hlo_test_base.h"
+
+namespace xla {
+namespace gpu {
+namespace {
+
+class ActivationOffloaderTest : public HloTestBase {
+ protected:
+  // Runs the offloader with the nominal rates of the GPU schedule, with which
+  // each instruction below takes about 17us.
+  StatusOr<bool> RunOffloader(HloModule* module,
+                              const ActivationOffloader::Options& options) {
+    HloCostAnalysis::Options cost_options{[](const Shape& shape) {
+      return ShapeUtil::ByteSizeOf(shape, /*pointer_size=*/8);
+    }};
+    cost_options.set_flops_per_second(1e13);
+    cost_options.set_bytes_per_second(5e11);
+    GpuHloCostAnalysis cost_analysis(cost_options);
+    TF_RETURN_IF_ERROR(module->entry_computation()->Accept(&cost_analysis));
+    return ActivationOffloader(&cost_analysis, options).Run(module);
+  }
+
+  // `a` is used right away and again at the end, the other values only once.
+  static constexpr char kHloText[] = R"(
+HloModule m, is_scheduled=true
+
+ENTRY e {
+  p0 = f32[1024,1024] parameter(0)
+  a = f32[1024,1024] exponential(p0)
+  b = f32[1024,1024] negate(a)
+  c = f32[1024,1024] sine(b)
+  d = f32[1024,1024] cosine(c)
+  e = f32[1024,1024] tanh(d)
+  f = f32[1024,1024] log(e)
+  ROOT g = f32[1024,1024] add(f, a)
+})";
+};
+
+TEST_F(ActivationOffloaderTest, OffloadsValueDuringGap) {
+  TF_ASSERT_OK_AND_ASSIGN(auto module, ParseAndReturnVerifiedModule(kHloText));
+  ActivationOffloader::Options options;
+  // Copying `a` takes 4us, so each copy is hidden by one instruction.
+  options.host_bytes_per_second = 1e12;
+  TF_ASSERT_OK_AND_ASSIGN(bool changed, RunOffloader(module.get(), options));
+  EXPECT_TRUE(changed);
+
+  const HloComputation* entry = module->entry_computation();
+  std::vector<HloOpcode> opcodes;
+  for (const HloInstruction* instr :
+       module->schedule().sequence(entry).instructions()) {
+    opcodes.push_back(instr->opcode());
+  }
+  EXPECT_EQ(opcodes,
+            std::vector<HloOpcode>(
+                {HloOpcode::kParameter, HloOpcode::kExp, HloOpcode::kNegate,
+                 HloOpcode::kCopyStart, HloOpcode::kSin, HloOpcode::kCopyDone,
+                 HloOpcode::kCos, HloOpcode::kTanh, HloOpcode::kCopyStart,
+                 HloOpcode::kLog, HloOpcode::kCopyDone, HloOpcode::kAdd}));
+
+  const HloInstruction* reload_done = entry->root_instruction()->operand(1);
+  ASSERT_EQ(reload_done->opcode(), HloOpcode::kCopyDone);
+  EXPECT_EQ(reload_done->shape().layout().memory_space(), 0);
+  const HloInstruction* offload_done = reload_done->operand(0)->operand(0);
+  ASSERT_EQ(offload_done->opcode(), HloOpcode::kCopyDone);
+  EXPECT_EQ(offload_done->shape().layout().memory_space(), kHostMemorySpace);
+  EXPECT_EQ(offload_done->operand(0)->operand(0)->name(), "a");
+  EXPECT_EQ(entry->GetInstructionWithName("b")->operand(0)->name(), "a");
+  TF_EXPECT_OK(verifier().Run(module.get()).status());
+}
+
+TEST_F(ActivationOffloaderTest, KeepsValuesIfMemoryFits) {
+  TF_ASSERT_OK_AND_ASSIGN(auto module, ParseAndReturnVerifiedModule(kHloText));
+  ActivationOffloader::Options options;
+  options.host_bytes_per_second = 1e12;
+  options.memory_limit_bytes = 1 << 30;
+  TF_ASSERT_OK_AND_ASSIGN(bool changed, RunOffloader(module.get(), options));
+  EXPECT_FALSE(changed);
+}
+
+TEST_F(ActivationOffloaderTest, KeepsValuesIfCopiesAreNotHidden) {
+  TF_ASSERT_OK_AND_ASSIGN(auto module, ParseAndReturnVerifiedModule(kHloText));
+  ActivationOffloader::Options options;
+  // Copying `a` takes 40us, so the four instructions of the gap can't hide
+  // both copies.
+  options.host_bytes_per_second = 1e11;
+  TF_ASSERT_OK_AND_ASSIGN(bool changed, RunOffloader(module.get(), options));
+  EXPECT_FALSE(changed);
+}
+
+}  // namespace
+}  // namespace gpu
+}  // namespace xla
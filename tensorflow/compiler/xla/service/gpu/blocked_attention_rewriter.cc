@@ -0,0 +1,395 @@
+/* Copyright 2022 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/compiler/xla/service/gpu/blocked_attention_rewriter.h"
+
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <optional>
+#include <utility>
+#include <vector>
+
+#include "absl/algorithm/container.h"
+#include "absl/strings/str_cat.h"
+#include "tensorflow/compiler/xla/comparison_util.h"
+#include "tensorflow/compiler/xla/literal_util.h"
+#include "tensorflow/compiler/xla/primitive_util.h"
+#include "tensorflow/compiler/xla/service/hlo_computation.h"
+#include "tensorflow/compiler/xla/service/hlo_instruction.h"
+#include "tensorflow/compiler/xla/service/hlo_opcode.h"
+#include "tensorflow/compiler/xla/shape_util.h"
+#include "tensorflow/core/platform/logging.h"
+
+namespace xla {
+namespace gpu {
+namespace {
+
+// The instructions of a matched attention pattern.
+struct AttentionPattern {
+  HloInstruction* scores;  // dot(q, k)
+  // The scalar the scores are multiplied by, or null.
+  HloInstruction* scale = nullptr;
+  HloInstruction* max_reduce;
+  HloInstruction* sum_reduce;
+  HloInstruction* output;  // dot(softmax, v)
+  // The key and value sequence dimensions of k and v.
+  int64_t k_seq_dim;
+  int64_t v_seq_dim;
+};
+
+// Returns the dimensions [0, n).
+std::vector<int64_t> Iota(int64_t n) {
+  std::vector<int64_t> dims(n);
+  absl::c_iota(dims, 0);
+  return dims;
+}
+
+bool IsIota(absl::Span<const int64_t> dims, int64_t n) {
+  return dims.size() == n && absl::c_equal(dims, Iota(n));
+}
+
+// Returns true if `broadcast` broadcasts along the last dimension.
+bool IsRowBroadcast(const HloInstruction* broadcast) {
+  return broadcast->opcode() == HloOpcode::kBroadcast &&
+         IsIota(broadcast->dimensions(), broadcast->shape().rank() - 1);
+}
+
+// Returns true if `reduce` reduces the last dimension of `operand` with the
+// binary `opcode` and the initial value `init`.
+bool IsRowReduce(const HloInstruction* reduce, const HloInstruction* operand,
+                 HloOpcode opcode, float init) {
+  if (reduce->opcode() != HloOpcode::kReduce || reduce->operand_count() != 2 ||
+      reduce->operand(0) != operand || reduce->user_count() != 1 ||
+      reduce->dimensions() !=
+          std::vector<int64_t>{operand->shape().rank() - 1}) {
+    return false;
+  }
+  const HloInstruction* init_value = reduce->operand(1);
+  if (init_value->opcode() != HloOpcode::kConstant ||
+      !init_value->literal().IsAllFloat(init)) {
+    return false;
+  }
+  const HloInstruction* root = reduce->to_apply()->root_instruction();
+  return root->opcode() == opcode &&
+         root->operand(0)->opcode() == HloOpcode::kParameter &&
+         root->operand(1)->opcode() == HloOpcode::kParameter &&
+         root->operand(0) != root->operand(1);
+}
+
+// Returns true if `dot` has `num_batch_dims` batch dimensions and one
+// contracting dimension per operand, and operands of the rank of the result.
+bool IsBatchMatMul(const HloInstruction* dot, int64_t num_batch_dims) {
+  if (dot->opcode() != HloOpcode::kDot) {
+    return false;
+  }
+  const DotDimensionNumbers& dnums = dot->dot_dimension_numbers();
+  const int64_t rank = dot->shape().rank();
+  return dnums.lhs_batch_dimensions_size() == num_batch_dims &&
+         dnums.rhs_batch_dimensions_size() == num_batch_dims &&
+         dnums.lhs_contracting_dimensions_size() == 1 &&
+         dnums.rhs_contracting_dimensions_size() == 1 &&
+         dot->operand(0)->shape().rank() == rank &&
+         dot->operand(1)->shape().rank() == rank;
+}
+
+std::optional<AttentionPattern> MatchAttention(HloInstruction* output) {
+  const Shape& shape = output->shape();
+  const int64_t rank = shape.rank();
+  const int64_t num_batch_dims = rank - 2;
+  if (rank < 2 || !primitive_util::IsFloatingPointType(shape.element_type()) ||
+      !IsBatchMatMul(output, num_batch_dims)) {
+    return std::nullopt;
+  }
+  // The softmax is contracted along the key sequence, which is its last
+  // dimension, so that the loop can emit an output block per key block.
+  const DotDimensionNumbers& output_dnums = output->dot_dimension_numbers();
+  if (!IsIota(absl::MakeSpan(output_dnums.lhs_batch_dimensions()),
+              num_batch_dims) ||
+      output_dnums.lhs_contracting_dimensions(0) != rank - 1) {
+    return std::nullopt;
+  }
+
+  AttentionPattern pattern;
+  pattern.output = output;
+  pattern.v_seq_dim = output_dnums.rhs_contracting_dimensions(0);
+  HloInstruction* softmax = output->mutable_operand(0);
+  if (softmax->opcode() != HloOpcode::kDivide || softmax->user_count() != 1) {
+    return std::nullopt;
+  }
+  HloInstruction* exp = softmax->mutable_operand(0);
+  if (exp->opcode() != HloOpcode::kExp || exp->user_count() != 2 ||
+      !IsRowBroadcast(softmax->operand(1))) {
+    return std::nullopt;
+  }
+  pattern.sum_reduce = softmax->mutable_operand(1)->mutable_operand(0);
+  if (!IsRowReduce(pattern.sum_reduce, exp, HloOpcode::kAdd, 0.0f)) {
+    return std::nullopt;
+  }
+  HloInstruction* shifted = exp->mutable_operand(0);
+  if (shifted->opcode() != HloOpcode::kSubtract ||
+      shifted->user_count() != 1) {
+    return std::nullopt;
+  }
+  HloInstruction* logits = shifted->mutable_operand(0);
+  HloInstruction* max_broadcast = shifted->mutable_operand(1);
+  if (logits->user_count() != 2 || !IsRowBroadcast(max_broadcast)) {
+    return std::nullopt;
+  }
+  pattern.max_reduce = max_broadcast->mutable_operand(0);
+  if (!IsRowReduce(pattern.max_reduce, logits, HloOpcode::kMaximum,
+                   -std::numeric_limits<float>::infinity())) {
+    return std::nullopt;
+  }
+
+  pattern.scores = logits;
+  if (logits->opcode() == HloOpcode::kMultiply) {
+    for (int64_t i = 0; i < 2; ++i) {
+      HloInstruction* scores = logits->mutable_operand(i);
+      HloInstruction* scale = logits->mutable_operand(1 - i);
+      if (scores->opcode() == HloOpcode::kDot &&
+          scale->opcode() == HloOpcode::kBroadcast &&
+          ShapeUtil::IsScalar(scale->operand(0)->shape())) {
+        pattern.scores = scores;
+        pattern.scale = scale->mutable_operand(0);
+        break;
+      }
+    }
+    if (pattern.scale == nullptr || pattern.scores->user_count() != 1) {
+      return std::nullopt;
+    }
+  }
+  // The loop computes the statistics and the output in the element type of
+  // the pattern, so mixed precision patterns are left alone.
+  if (!IsBatchMatMul(pattern.scores, num_batch_dims) ||
+      pattern.scores->shape().element_type() != shape.element_type() ||
+      output->operand(1)->shape().element_type() != shape.element_type()) {
+    return std::nullopt;
+  }
+
+  const DotDimensionNumbers& dnums = pattern.scores->dot_dimension_numbers();
+  for (int64_t dim = 0; dim < rank; ++dim) {
+    if (!absl::c_linear_search(dnums.rhs_batch_dimensions(), dim) &&
+        dnums.rhs_contracting_dimensions(0) != dim) {
+      pattern.k_seq_dim = dim;
+    }
+  }
+  return pattern;
+}
+
+// Replaces `pattern` with a while loop over blocks of `block_size` keys and
+// values that computes the softmax online.
+Status RewriteAttention(const AttentionPattern& pattern, int64_t block_size) {
+  HloInstruction* output = pattern.output;
+  HloComputation* computation = output->parent();
+  HloModule* module = computation->parent();
+  HloInstruction* q = pattern.scores->mutable_operand(0);
+  HloInstruction* k = pattern.scores->mutable_operand(1);
+  HloInstruction* v = output->mutable_operand(1);
+
+  const Shape& scores_shape = pattern.scores->shape();
+  const Shape& stats_shape = pattern.max_reduce->shape();
+  const Shape& output_shape = output->shape();
+  const int64_t rank = scores_shape.rank();
+  const int64_t num_blocks = scores_shape.dimensions(rank - 1) / block_size;
+  const std::vector<int64_t> row_dims = Iota(rank - 1);
+  Shape block_scores_shape = scores_shape;
+  block_scores_shape.set_dimensions(rank - 1, block_size);
+  Shape k_block_shape = k->shape();
+  k_block_shape.set_dimensions(pattern.k_seq_dim, block_size);
+  Shape v_block_shape = v->shape();
+  v_block_shape.set_dimensions(pattern.v_seq_dim, block_size);
+  const Shape index_shape = ShapeUtil::MakeShape(S32, {});
+
+  // The loop state.
+  enum { kIndex, kQ, kK, kV, kMax, kSum, kOutput, kScale };
+  auto add = [&](std::unique_ptr<HloInstruction> instruction) {
+    return computation->AddInstruction(std::move(instruction));
+  };
+  std::vector<HloInstruction*> init = {
+      add(HloInstruction::CreateConstant(LiteralUtil::CreateR0<int32_t>(0))),
+      q,
+      k,
+      v,
+      add(HloInstruction::CreateBroadcast(
+          stats_shape, add(pattern.max_reduce->operand(1)->Clone()), {})),
+      add(HloInstruction::CreateBroadcast(
+          stats_shape, add(pattern.sum_reduce->operand(1)->Clone()), {})),
+      add(HloInstruction::CreateBroadcast(
+          output_shape,
+          add(HloInstruction::CreateConstant(
+              LiteralUtil::Zero(output_shape.element_type()))),
+          {}))};
+  if (pattern.scale != nullptr) {
+    init.push_back(pattern.scale);
+  }
+  std::vector<Shape> state_shapes;
+  for (const HloInstruction* value : init) {
+    state_shapes.push_back(value->shape());
+  }
+  const Shape state_shape = ShapeUtil::MakeTupleShape(state_shapes);
+
+  HloComputation::Builder body_builder(
+      absl::StrCat(output->name(), ".blocked_attention_body"));
+  auto add_to_body = [&](std::unique_ptr<HloInstruction> instruction) {
+    return body_builder.AddInstruction(std::move(instruction));
+  };
+  auto add_binary = [&](const Shape& shape, HloOpcode opcode,
+                        HloInstruction* lhs, HloInstruction* rhs) {
+    return add_to_body(HloInstruction::CreateBinary(shape, opcode, lhs, rhs));
+  };
+  HloInstruction* state = add_to_body(
+      HloInstruction::CreateParameter(0, state_shape, "blocked_attention"));
+  auto get = [&](int64_t index) {
+    return add_to_body(HloInstruction::CreateGetTupleElement(state, index));
+  };
+  HloInstruction* index = get(kIndex);
+  HloInstruction* block_start = add_binary(
+      index_shape, HloOpcode::kMultiply, index,
+      add_to_body(HloInstruction::CreateConstant(
+          LiteralUtil::CreateR0<int32_t>(block_size))));
+  HloInstruction* zero_index = add_to_body(
+      HloInstruction::CreateConstant(LiteralUtil::CreateR0<int32_t>(0)));
+  auto slice_block = [&](HloInstruction* operand, int64_t dim,
+                         const Shape& block_shape) {
+    std::vector<HloInstruction*> start_indices(block_shape.rank(), zero_index);
+    start_indices[dim] = block_start;
+    return add_to_body(HloInstruction::CreateDynamicSlice(
+        block_shape, operand, start_indices, block_shape.dimensions()));
+  };
+  HloInstruction* k_block = slice_block(get(kK), pattern.k_seq_dim,
+                                        k_block_shape);
+  HloInstruction* v_block = slice_block(get(kV), pattern.v_seq_dim,
+                                        v_block_shape);
+
+  HloInstruction* logits = add_to_body(HloInstruction::CreateDot(
+      block_scores_shape, get(kQ), k_block,
+      pattern.scores->dot_dimension_numbers(),
+      pattern.scores->precision_config()));
+  if (pattern.scale != nullptr) {
+    logits = add_binary(block_scores_shape, HloOpcode::kMultiply, logits,
+                        add_to_body(HloInstruction::CreateBroadcast(
+                            block_scores_shape, get(kScale), {})));
+  }
+  HloInstruction* max = get(kMax);
+  HloInstruction* new_max = add_binary(
+      stats_shape, HloOpcode::kMaximum, max,
+      add_to_body(HloInstruction::CreateReduce(
+          stats_shape, logits,
+          add_to_body(pattern.max_reduce->operand(1)->Clone()), {rank - 1},
+          pattern.max_reduce->to_apply())));
+  HloInstruction* probs = add_to_body(HloInstruction::CreateUnary(
+      block_scores_shape, HloOpcode::kExp,
+      add_binary(block_scores_shape, HloOpcode::kSubtract, logits,
+                 add_to_body(HloInstruction::CreateBroadcast(
+                     block_scores_shape, new_max, row_dims)))));
+  // Rescales the sums and outputs of the previous blocks to the new maximum.
+  // The correction of the first block is exp(-inf) = 0.
+  HloInstruction* correction = add_to_body(HloInstruction::CreateUnary(
+      stats_shape, HloOpcode::kExp,
+      add_binary(stats_shape, HloOpcode::kSubtract, max, new_max)));
+  HloInstruction* new_sum = add_binary(
+      stats_shape, HloOpcode::kAdd,
+      add_binary(stats_shape, HloOpcode::kMultiply, get(kSum), correction),
+      add_to_body(HloInstruction::CreateReduce(
+          stats_shape, probs,
+          add_to_body(pattern.sum_reduce->operand(1)->Clone()), {rank - 1},
+          pattern.sum_reduce->to_apply())));
+  HloInstruction* new_output = add_binary(
+      output_shape, HloOpcode::kAdd,
+      add_binary(output_shape, HloOpcode::kMultiply, get(kOutput),
+                 add_to_body(HloInstruction::CreateBroadcast(
+                     output_shape, correction, row_dims))),
+      add_to_body(HloInstruction::CreateDot(output_shape, probs, v_block,
+                                            output->dot_dimension_numbers(),
+                                            output->precision_config())));
+  std::vector<HloInstruction*> next = {
+      add_binary(index_shape, HloOpcode::kAdd, index,
+                 add_to_body(HloInstruction::CreateConstant(
+                     LiteralUtil::CreateR0<int32_t>(1)))),
+      get(kQ),
+      get(kK),
+      get(kV),
+      new_max,
+      new_sum,
+      new_output};
+  if (pattern.scale != nullptr) {
+    next.push_back(get(kScale));
+  }
+  add_to_body(HloInstruction::CreateTuple(next));
+  HloComputation* body = module->AddEmbeddedComputation(body_builder.Build());
+
+  HloComputation::Builder condition_builder(
+      absl::StrCat(output->name(), ".blocked_attention_condition"));
+  HloInstruction* condition_state =
+      condition_builder.AddInstruction(HloInstruction::CreateParameter(
+          0, state_shape, "blocked_attention"));
+  condition_builder.AddInstruction(HloInstruction::CreateCompare(
+      ShapeUtil::MakeShape(PRED, {}),
+      condition_builder.AddInstruction(
+          HloInstruction::CreateGetTupleElement(condition_state, kIndex)),
+      condition_builder.AddInstruction(HloInstruction::CreateConstant(
+          LiteralUtil::CreateR0<int32_t>(num_blocks))),
+      ComparisonDirection::kLt));
+  HloComputation* condition =
+      module->AddEmbeddedComputation(condition_builder.Build());
+
+  HloInstruction* loop = add(HloInstruction::CreateWhile(
+      state_shape, condition, body, add(HloInstruction::CreateTuple(init))));
+  HloInstruction* sum =
+      add(HloInstruction::CreateGetTupleElement(loop, kSum));
+  return computation->ReplaceWithNewInstruction(
+      output,
+      HloInstruction::CreateBinary(
+          output_shape, HloOpcode::kDivide,
+          add(HloInstruction::CreateGetTupleElement(loop, kOutput)),
+          add(HloInstruction::CreateBroadcast(output_shape, sum, row_dims))));
+}
+
+}  // namespace
+
+StatusOr<bool> BlockedAttentionRewriter::Run(HloModule* module) {
+  bool changed = false;
+  for (HloComputation* computation : module->MakeNonfusionComputations()) {
+    std::vector<AttentionPattern> patterns;
+    for (HloInstruction* instruction : computation->instructions()) {
+      std::optional<AttentionPattern> pattern = MatchAttention(instruction);
+      if (!pattern.has_value()) {
+        continue;
+      }
+      const Shape& scores_shape = pattern->scores->shape();
+      const int64_t seq_len =
+          scores_shape.dimensions(scores_shape.rank() - 1);
+      if (seq_len <= options_.block_size ||
+          seq_len % options_.block_size != 0 ||
+          ShapeUtil::ByteSizeOf(scores_shape) < options_.min_scores_bytes) {
+        continue;
+      }
+      patterns.push_back(*pattern);
+    }
+    // The patterns don't share instructions, so they are rewritten after the
+    // walk over the instructions.
+    for (const AttentionPattern& pattern : patterns) {
+      VLOG(2) << "Rewriting attention " << pattern.output->name()
+              << " into blocks of " << options_.block_size;
+      TF_RETURN_IF_ERROR(RewriteAttention(pattern, options_.block_size));
+      changed = true;
+    }
+  }
+  return changed;
+}
+
+}  // namespace gpu
+}  // namespace xla
@@ -0,0 +1,66 @@
+/* Copyright 2022 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_COMPILER_XLA_SERVICE_GPU_BLOCKED_ATTENTION_REWRITER_H_
+#define TENSORFLOW_COMPILER_XLA_SERVICE_GPU_BLOCKED_ATTENTION_REWRITER_H_
+
+#include "tensorflow/compiler/xla/service/hlo_module.h"
+#include "tensorflow/compiler/xla/service/hlo_pass_interface.h"
+
+namespace xla {
+namespace gpu {
+
+// Rewrites attention patterns
+//
+//   softmax(dot(q, k) [* broadcast(scale)]) . v
+//
+// where the softmax is over the last (key sequence) dimension of the scores,
+// into a loop over blocks of the key and value sequence that computes the
+// softmax online, like flash attention: each iteration computes the scores of
+// one block, rescales the running row maximum, row sum and output with it, and
+// the output is normalized by the row sum after the loop. Only a block of the
+// [batch..., query sequence, key sequence] score tensor is then live at a time,
+// instead of the whole tensor, which bounds the memory of long sequences.
+//
+// The dots are expected in a single batch group with one contracting and one
+// non-contracting dimension per operand, as after DotDecomposer, and the
+// intermediates of the pattern must have no other users.
+class BlockedAttentionRewriter : public HloModulePass {
+ public:
+  struct Options {
+    // The number of key and value positions per iteration. Key sequences that
+    // it doesn't divide are not rewritten.
+    int64_t block_size = 512;
+    // Patterns with smaller score tensors are not rewritten.
+    int64_t min_scores_bytes = int64_t{64} << 20;
+  };
+
+  explicit BlockedAttentionRewriter(const Options& options)
+      : options_(options) {}
+
+  absl::string_view name() const override {
+    return "blocked-attention-rewriter";
+  }
+
+  StatusOr<bool> Run(HloModule* module) override;
+
+ private:
+  const Options options_;
+};
+
+}  // namespace gpu
+}  // namespace xla
+
+#endif  // TENSORFLOW_COMPILER_XLA_SERVICE_GPU_BLOCKED_ATTENTION_REWRITER_H_
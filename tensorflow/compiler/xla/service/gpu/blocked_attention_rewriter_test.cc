@@ -0,0 +1,210 @@
+/* Copyright 2022 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/compiler/xla/service/gpu/blocked_attention_rewriter.h"
+
+#include <memory>
+#include <vector>
+
+#include "tensorflow/compiler/xla/error_spec.h"
+#include "tensorflow/compiler/xla/literal.h"
+#include "tensorflow/compiler/xla/service/hlo_evaluator.h"
+#include "tensorflow/compiler/xla/service/hlo_matchers.h"
+#include "tensorflow/compiler/xla/test.h"
+#include "tensorflow/compiler/xla/tests/hlo_test_base.h"
+#include "tensorflow/compiler/xla/tests/literal_test_util.h"
+#include "tensorflow/compiler/xla/tests/test_utils.h"
+
+namespace xla {
+namespace gpu {
+namespace {
+
+namespace op = xla::testing::opcode_matchers;
+
+class BlockedAttentionRewriterTest : public HloTestBase {
+ protected:
+  // Returns options that rewrite the attention patterns of the tests.
+  static BlockedAttentionRewriter::Options TestOptions() {
+    BlockedAttentionRewriter::Options options;
+    options.block_size = 4;
+    options.min_scores_bytes = 0;
+    return options;
+  }
+};
+
+constexpr char kScaledAttention[] = R"(
+HloModule attention
+
+max_computation {
+  x = f32[] parameter(0)
+  y = f32[] parameter(1)
+  ROOT maximum = f32[] maximum(x, y)
+}
+
+add_computation {
+  x = f32[] parameter(0)
+  y = f32[] parameter(1)
+  ROOT add = f32[] add(x, y)
+}
+
+ENTRY main {
+  q = f32[2,3,8,4] parameter(0)
+  k = f32[2,3,16,4] parameter(1)
+  v = f32[2,3,16,4] parameter(2)
+  scores = f32[2,3,8,16] dot(q, k), lhs_batch_dims={0,1}, lhs_contracting_dims={3}, rhs_batch_dims={0,1}, rhs_contracting_dims={3}
+  scale = f32[] constant(0.5)
+  scale.broadcast = f32[2,3,8,16] broadcast(scale), dimensions={}
+  logits = f32[2,3,8,16] multiply(scores, scale.broadcast)
+  neg_inf = f32[] constant(-inf)
+  max = f32[2,3,8] reduce(logits, neg_inf), dimensions={3}, to_apply=max_computation
+  max.broadcast = f32[2,3,8,16] broadcast(max), dimensions={0,1,2}
+  shifted = f32[2,3,8,16] subtract(logits, max.broadcast)
+  exp = f32[2,3,8,16] exponential(shifted)
+  zero = f32[] constant(0)
+  sum = f32[2,3,8] reduce(exp, zero), dimensions={3}, to_apply=add_computation
+  sum.broadcast = f32[2,3,8,16] broadcast(sum), dimensions={0,1,2}
+  softmax = f32[2,3,8,16] divide(exp, sum.broadcast)
+  ROOT output = f32[2,3,8,4] dot(softmax, v), lhs_batch_dims={0,1}, lhs_contracting_dims={3}, rhs_batch_dims={0,1}, rhs_contracting_dims={2}
+}
+)";
+
+TEST_F(BlockedAttentionRewriterTest, RewritesScaledAttention) {
+  auto module = ParseAndReturnVerifiedModule(kScaledAttention).ValueOrDie();
+  std::unique_ptr<HloModule> original = module->Clone();
+  ASSERT_TRUE(
+      BlockedAttentionRewriter(TestOptions()).Run(module.get()).ValueOrDie());
+  SCOPED_TRACE(module->ToString());
+  EXPECT_THAT(module->entry_computation()->root_instruction(),
+              op::Divide(op::GetTupleElement(op::While(), 6),
+                         op::Broadcast(op::GetTupleElement(op::While(), 5))));
+
+  // The loop computes the same softmax as the original pattern.
+  std::vector<Literal> arguments =
+      MakeFakeArguments(original.get()).ValueOrDie();
+  HloEvaluator evaluator;
+  Literal expected = evaluator.Evaluate(*original, arguments).ValueOrDie();
+  Literal actual = evaluator.Evaluate(*module, arguments).ValueOrDie();
+  EXPECT_TRUE(LiteralTestUtil::Near(expected, actual, ErrorSpec(1e-5, 1e-5)));
+}
+
+TEST_F(BlockedAttentionRewriterTest, RewritesUnscaledAttention) {
+  auto module = ParseAndReturnVerifiedModule(R"(
+HloModule attention
+
+max_computation {
+  x = f32[] parameter(0)
+  y = f32[] parameter(1)
+  ROOT maximum = f32[] maximum(x, y)
+}
+
+add_computation {
+  x = f32[] parameter(0)
+  y = f32[] parameter(1)
+  ROOT add = f32[] add(x, y)
+}
+
+ENTRY main {
+  q = f32[8,2] parameter(0)
+  k = f32[12,2] parameter(1)
+  v = f32[3,12] parameter(2)
+  scores = f32[8,12] dot(q, k), lhs_contracting_dims={1}, rhs_contracting_dims={1}
+  neg_inf = f32[] constant(-inf)
+  max = f32[8] reduce(scores, neg_inf), dimensions={1}, to_apply=max_computation
+  max.broadcast = f32[8,12] broadcast(max), dimensions={0}
+  shifted = f32[8,12] subtract(scores, max.broadcast)
+  exp = f32[8,12] exponential(shifted)
+  zero = f32[] constant(0)
+  sum = f32[8] reduce(exp, zero), dimensions={1}, to_apply=add_computation
+  sum.broadcast = f32[8,12] broadcast(sum), dimensions={0}
+  softmax = f32[8,12] divide(exp, sum.broadcast)
+  ROOT output = f32[8,3] dot(softmax, v), lhs_contracting_dims={1}, rhs_contracting_dims={1}
+}
+)")
+                    .ValueOrDie();
+  std::unique_ptr<HloModule> original = module->Clone();
+  ASSERT_TRUE(
+      BlockedAttentionRewriter(TestOptions()).Run(module.get()).ValueOrDie());
+  SCOPED_TRACE(module->ToString());
+  EXPECT_THAT(module->entry_computation()->root_instruction(),
+              op::Divide(op::GetTupleElement(op::While(), 6),
+                         op::Broadcast(op::GetTupleElement(op::While(), 5))));
+
+  std::vector<Literal> arguments =
+      MakeFakeArguments(original.get()).ValueOrDie();
+  HloEvaluator evaluator;
+  Literal expected = evaluator.Evaluate(*original, arguments).ValueOrDie();
+  Literal actual = evaluator.Evaluate(*module, arguments).ValueOrDie();
+  EXPECT_TRUE(LiteralTestUtil::Near(expected, actual, ErrorSpec(1e-5, 1e-5)));
+}
+
+TEST_F(BlockedAttentionRewriterTest, SkipsIndivisibleSequence) {
+  auto module = ParseAndReturnVerifiedModule(kScaledAttention).ValueOrDie();
+  BlockedAttentionRewriter::Options options = TestOptions();
+  options.block_size = 5;
+  EXPECT_FALSE(
+      BlockedAttentionRewriter(options).Run(module.get()).ValueOrDie());
+}
+
+TEST_F(BlockedAttentionRewriterTest, SkipsSmallScores) {
+  auto module = ParseAndReturnVerifiedModule(kScaledAttention).ValueOrDie();
+  BlockedAttentionRewriter::Options options = TestOptions();
+  // The scores take 2 * 3 * 8 * 16 * 4 bytes.
+  options.min_scores_bytes = 4096;
+  EXPECT_FALSE(
+      BlockedAttentionRewriter(options).Run(module.get()).ValueOrDie());
+}
+
+TEST_F(BlockedAttentionRewriterTest, SkipsSoftmaxWithOtherUsers) {
+  auto module = ParseAndReturnVerifiedModule(R"(
+HloModule attention
+
+max_computation {
+  x = f32[] parameter(0)
+  y = f32[] parameter(1)
+  ROOT maximum = f32[] maximum(x, y)
+}
+
+add_computation {
+  x = f32[] parameter(0)
+  y = f32[] parameter(1)
+  ROOT add = f32[] add(x, y)
+}
+
+ENTRY main {
+  q = f32[8,2] parameter(0)
+  k = f32[12,2] parameter(1)
+  v = f32[12,3] parameter(2)
+  scores = f32[8,12] dot(q, k), lhs_contracting_dims={1}, rhs_contracting_dims={1}
+  neg_inf = f32[] constant(-inf)
+  max = f32[8] reduce(scores, neg_inf), dimensions={1}, to_apply=max_computation
+  max.broadcast = f32[8,12] broadcast(max), dimensions={0}
+  shifted = f32[8,12] subtract(scores, max.broadcast)
+  exp = f32[8,12] exponential(shifted)
+  zero = f32[] constant(0)
+  sum = f32[8] reduce(exp, zero), dimensions={1}, to_apply=add_computation
+  sum.broadcast = f32[8,12] broadcast(sum), dimensions={0}
+  softmax = f32[8,12] divide(exp, sum.broadcast)
+  output = f32[8,3] dot(softmax, v), lhs_contracting_dims={1}, rhs_contracting_dims={0}
+  ROOT tuple = (f32[8,3], f32[8,12]) tuple(output, softmax)
+}
+)")
+                    .ValueOrDie();
+  EXPECT_FALSE(
+      BlockedAttentionRewriter(TestOptions()).Run(module.get()).ValueOrDie());
+}
+
+}  // namespace
+}  // namespace gpu
+}  // namespace xla
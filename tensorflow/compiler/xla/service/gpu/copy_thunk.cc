@@ -15,6 +15,9 @@ limitations under the License.
 
 #include "tensorflow/compiler/xla/service/gpu/copy_thunk.h"
 
+#include <utility>
+
+#include "tensorflow/compiler/xla/status_macros.h"
 #include "tensorflow/core/platform/stream_executor_no_cuda.h"
 
 namespace xla {
@@ -36,5 +39,63 @@ Status DeviceToDeviceCopyThunk::ExecuteOnStream(const ExecuteParams& params) {
   params.stream->ThenMemcpy(&destination_data, source_data, mem_size_);
   return OkStatus();
 }
+
+CopyStartThunk::CopyStartThunk(
+    ThunkInfo thunk_info, const BufferAllocation::Slice& source_buffer,
+    const BufferAllocation::Slice& destination_buffer, uint64_t mem_size,
+    bool to_host)
+    : Thunk(Kind::kCopyStart, thunk_info),
+      source_buffer_(source_buffer),
+      destination_buffer_(destination_buffer),
+      mem_size_(mem_size),
+      to_host_(to_host) {}
+
+Status CopyStartThunk::ExecuteOnStream(const ExecuteParams& params) {
+  se::Stream& async_stream = *params.async_comms_stream;
+  // Wait until the source is ready, and the destination is no longer read.
+  async_stream.ThenWaitFor(params.stream);
+
+  se::DeviceMemoryBase destination_data =
+      params.buffer_allocations->GetDeviceAddress(destination_buffer_);
+  se::DeviceMemoryBase source_data =
+      params.buffer_allocations->GetDeviceAddress(source_buffer_);
+  if (to_host_) {
+    async_stream.ThenMemcpy(destination_data.opaque(), source_data, mem_size_);
+  } else {
+    async_stream.ThenMemcpy(&destination_data, source_data.opaque(),
+                            mem_size_);
+  }
+
+  se::Event done_event(async_stream.parent());
+  TF_RET_CHECK(done_event.Init());
+  async_stream.ThenRecordEvent(&done_event);
+
+  int device_ordinal = async_stream.parent()->device_ordinal();
+  absl::MutexLock lock(&mu_);
+  auto result = done_events_.emplace(device_ordinal, std::move(done_event));
+  TF_RET_CHECK(result.second) << "done event has not been consumed";
+  return OkStatus();
+}
+
+StatusOr<se::Event> CopyStartThunk::TakeDoneEvent(int device_ordinal) {
+  absl::MutexLock lock(&mu_);
+  auto it = done_events_.find(device_ordinal);
+  TF_RET_CHECK(it != done_events_.end()) << "done event not found";
+  se::Event done_event = std::move(it->second);
+  done_events_.erase(it);
+  return done_event;
+}
+
+CopyDoneThunk::CopyDoneThunk(ThunkInfo thunk_info, CopyStartThunk& start_thunk)
+    : Thunk(Kind::kCopyDone, thunk_info), start_thunk_(start_thunk) {}
+
+Status CopyDoneThunk::ExecuteOnStream(const ExecuteParams& params) {
+  int device_ordinal = params.stream->parent()->device_ordinal();
+  TF_ASSIGN_OR_RETURN(se::Event done_event,
+                      start_thunk_.TakeDoneEvent(device_ordinal));
+  params.stream->ThenWaitFor(&done_event);
+  return OkStatus();
+}
+
 }  // namespace gpu
 }  // namespace xla
@@ -16,6 +16,9 @@ limitations under the License.
 #ifndef TENSORFLOW_COMPILER_XLA_SERVICE_GPU_COPY_THUNK_H_
 #define TENSORFLOW_COMPILER_XLA_SERVICE_GPU_COPY_THUNK_H_
 
+#include "absl/base/thread_annotations.h"
+#include "absl/container/flat_hash_map.h"
+#include "absl/synchronization/mutex.h"
 #include "tensorflow/compiler/xla/service/buffer_assignment.h"
 #include "tensorflow/compiler/xla/service/gpu/buffer_allocations.h"
 #include "tensorflow/compiler/xla/service/gpu/thunk.h"
@@ -53,6 +56,56 @@ class DeviceToDeviceCopyThunk : public Thunk {
   const uint64_t mem_size_;
 };
 
+// A thunk that starts copying a buffer between device memory and pinned host
+// memory on the async stream, so that the copy overlaps with the thunks on the
+// main stream until the matching CopyDoneThunk.
+class CopyStartThunk : public Thunk {
+ public:
+  // `to_host` tells whether `destination_buffer` is in host memory, or
+  // `source_buffer` is.
+  CopyStartThunk(ThunkInfo thunk_info,
+                 const BufferAllocation::Slice& source_buffer,
+                 const BufferAllocation::Slice& destination_buffer,
+                 uint64_t mem_size, bool to_host);
+
+  CopyStartThunk(const CopyStartThunk&) = delete;
+  CopyStartThunk& operator=(const CopyStartThunk&) = delete;
+
+  Status ExecuteOnStream(const ExecuteParams& params) override;
+
+  // Returns the event that the copy started on the device with
+  // `device_ordinal` records when it is done.
+  StatusOr<se::Event> TakeDoneEvent(int device_ordinal);
+
+  const BufferAllocation::Slice& source() const { return source_buffer_; }
+  const BufferAllocation::Slice& destination() const {
+    return destination_buffer_;
+  }
+  uint64_t size_bytes() const { return mem_size_; }
+  bool to_host() const { return to_host_; }
+
+ private:
+  const BufferAllocation::Slice source_buffer_;
+  const BufferAllocation::Slice destination_buffer_;
+  const uint64_t mem_size_;
+  const bool to_host_;
+
+  absl::Mutex mu_;
+  // Events the main stream waits on in CopyDoneThunk, by device ordinal.
+  absl::flat_hash_map<int, se::Event> done_events_ ABSL_GUARDED_BY(mu_);
+};
+
+// A thunk that makes the main stream wait for the copy of a CopyStartThunk.
+class CopyDoneThunk : public Thunk {
+ public:
+  CopyDoneThunk(ThunkInfo thunk_info, CopyStartThunk& start_thunk);
+
+  Status ExecuteOnStream(const ExecuteParams& params) override;
+
+ private:
+  CopyStartThunk& start_thunk_;
+};
+
 }  // namespace gpu
 }  // namespace xla
 
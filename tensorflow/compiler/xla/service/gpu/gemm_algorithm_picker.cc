@@ -17,8 +17,14 @@ limitations under the License.
 
 #include <functional>
 #include <limits>
+#include <optional>
 #include <string>
+#include <tuple>
 #include <utility>
+#include <vector>
+
+#include "absl/algorithm/container.h"
+#include "absl/container/flat_hash_map.h"
 
 #include "tensorflow/compiler/xla/service/gpu/backend_configs.pb.h"
 #include "tensorflow/compiler/xla/service/gpu/buffer_comparator.h"
@@ -279,12 +285,29 @@ Status DoBlasPlansAutotune(se::Stream* stream, const HloInstruction* gemm,
   return OkStatus();
 }
 
+using GemmCacheKey =
+    std::tuple</* GetDeviceIdentifier(stream_exec) */ std::string,
+               /* gemm->ToString(HloPrintOptions::Canonical()) */ std::string>;
+
+GemmCacheKey GemmCacheKeyFromInstruction(const HloInstruction* gemm,
+                                         se::StreamExecutor* stream_exec) {
+  auto options = HloPrintOptions::Canonical();
+  options.set_print_backend_config(true);
+  return std::make_tuple(GetDeviceIdentifier(stream_exec),
+                         gemm->ToString(options));
+}
+
+absl::Mutex autotune_cache_mu(absl::kConstInit);
+auto& autotune_cache ABSL_GUARDED_BY(autotune_cache_mu) =
+    *new absl::flat_hash_map<GemmCacheKey,
+                             std::optional<se::blas::AlgorithmType>>();
+int64_t cache_hits ABSL_GUARDED_BY(autotune_cache_mu) = 0;
+int64_t cache_misses ABSL_GUARDED_BY(autotune_cache_mu) = 0;
+
 static StatusOr<std::optional<se::blas::AlgorithmType>> DoGemmAutotune(
     const HloInstruction* gemm, const GemmBackendConfig& gemm_config,
     se::DeviceMemoryAllocator* allocator, se::Stream* stream) {
   VLOG(3) << "Starting autotune of GemmThunk " << gemm->ToString();
-  const HloInstruction* lhs = gemm->operand(0);
-  const HloInstruction* rhs = gemm->operand(1);
 
   TF_ASSIGN_OR_RETURN(GemmConfig config, GemmConfig::For(gemm));
   // Don't run autotuning concurrently on the same GPU.
@@ -296,25 +319,17 @@ static StatusOr<std::optional<se::blas::AlgorithmType>> DoGemmAutotune(
     return {se::blas::kNoAlgorithm};
   }
 
-  auto key = std::make_tuple(stream->parent(), lhs->shape(), rhs->shape(),
-                             gemm->shape(), gemm_config.SerializeAsString());
-
-  static absl::Mutex mutex(absl::kConstInit);
-  static auto& cache ABSL_GUARDED_BY(mutex) =
-      *new absl::flat_hash_map<decltype(key),
-                               std::optional<se::blas::AlgorithmType>>();
-  static int64_t cache_hits ABSL_GUARDED_BY(mutex) = 0;
-  static int64_t cache_misses ABSL_GUARDED_BY(mutex) = 0;
+  GemmCacheKey key = GemmCacheKeyFromInstruction(gemm, stream->parent());
 
-  absl::MutexLock lock(&mutex);
-  auto it = cache.find(key);
+  absl::MutexLock lock(&autotune_cache_mu);
+  auto it = autotune_cache.find(key);
   int64_t requests = cache_hits + cache_misses;
   if (requests && requests % 10 == 0) {
     VLOG(2) << "Autotuning cache hits/(hits + misses): " << cache_hits << "/"
             << requests;
   }
 
-  if (it != cache.end()) {
+  if (it != autotune_cache.end()) {
     cache_hits++;
     VLOG(4) << "Autotuning cache hit, using algorithm: "
             << (it->second.has_value() ? absl::StrCat(*(it->second))
@@ -367,7 +382,7 @@ static StatusOr<std::optional<se::blas::AlgorithmType>> DoGemmAutotune(
   std::optional<se::blas::AlgorithmType> best_algorithm;
   if (best_algorithm_idx) best_algorithm = algorithms[*best_algorithm_idx];
 
-  CHECK(cache.emplace(key, best_algorithm).second);
+  CHECK(autotune_cache.emplace(key, best_algorithm).second);
   return best_algorithm;
 }
 
@@ -413,6 +428,47 @@ StatusOr<bool> RunOnComputation(HloComputation* computation,
 
 }  // namespace
 
+/*static*/ void GemmAlgorithmPicker::WriteAutotuneResults(
+    AutotuneResults* results) {
+  absl::MutexLock lock(&autotune_cache_mu);
+  std::vector<const std::pair<const GemmCacheKey,
+                              std::optional<se::blas::AlgorithmType>>*>
+      entries;
+  entries.reserve(autotune_cache.size());
+  for (const auto& entry : autotune_cache) entries.push_back(&entry);
+  // Sorts the entries to make the output deterministic.
+  absl::c_sort(entries, [](const auto* a, const auto* b) {
+    return a->first < b->first;
+  });
+  for (const auto* entry : entries) {
+    AutotuneResults::Entry* result = results->add_dots();
+    result->set_device(std::get<0>(entry->first));
+    result->set_hlo(std::get<1>(entry->first));
+    // GEMMs without a supported algorithm have a result without a gemm key.
+    if (entry->second.has_value()) {
+      result->mutable_result()->mutable_gemm()->set_algorithm(*entry->second);
+    }
+  }
+}
+
+/*static*/ void GemmAlgorithmPicker::LoadAutotuneResults(
+    const AutotuneResults& results) {
+  absl::MutexLock lock(&autotune_cache_mu);
+  for (const AutotuneResults::Entry& result : results.dots()) {
+    std::optional<se::blas::AlgorithmType> algorithm;
+    if (result.result().has_gemm()) {
+      algorithm = result.result().gemm().algorithm();
+    }
+    autotune_cache.insert(
+        {std::make_tuple(result.device(), result.hlo()), algorithm});
+  }
+}
+
+/*static*/ void GemmAlgorithmPicker::ClearAutotuneResults() {
+  absl::MutexLock lock(&autotune_cache_mu);
+  autotune_cache.clear();
+}
+
 StatusOr<bool> GemmAlgorithmPicker::Run(HloModule* module) {
   XLA_SCOPED_LOGGING_TIMER("GemmAlgorithmPicker");
 
@@ -17,6 +17,7 @@ limitations under the License.
 
 #include <optional>
 
+#include "tensorflow/compiler/xla/service/gpu/gpu_autotuning.pb.h"
 #include "tensorflow/compiler/xla/service/gpu/gpu_conv_runner.h"
 #include "tensorflow/compiler/xla/service/hlo_instructions.h"
 #include "tensorflow/compiler/xla/service/hlo_module.h"
@@ -38,6 +39,14 @@ class GemmAlgorithmPicker : public HloModulePass {
 
   StatusOr<bool> Run(HloModule* module) override;
 
+  // Appends the autotuning results of all GEMMs of the process to `results`.
+  // GEMMs that go through cublasLt are not included.
+  static void WriteAutotuneResults(AutotuneResults* results);
+  // Adds the GEMM results of `results` to the results of the process.
+  // Results of instructions that were already autotuned are kept.
+  static void LoadAutotuneResults(const AutotuneResults& results);
+  static void ClearAutotuneResults();
+
  private:
   se::StreamExecutor* stream_exec_;
   se::DeviceMemoryAllocator* allocator_;
@@ -21,10 +21,13 @@ limitations under the License.
 #include <functional>
 #include <iterator>
 #include <memory>
+#include <optional>
 #include <string>
 #include <utility>
 #include <vector>
 
+#include "absl/container/flat_hash_map.h"
+#include "absl/container/flat_hash_set.h"
 #include "absl/strings/numbers.h"
 #include "absl/strings/str_cat.h"
 #include "absl/types/variant.h"
@@ -83,9 +86,11 @@ limitations under the License.
 #include "tensorflow/compiler/xla/service/eigh_expander.h"
 #include "tensorflow/compiler/xla/service/flatten_call_graph.h"
 #include "tensorflow/compiler/xla/service/gather_expander.h"
+#include "tensorflow/compiler/xla/service/gpu/activation_offloader.h"
 #include "tensorflow/compiler/xla/service/gpu/alias_passthrough_params.h"
 #include "tensorflow/compiler/xla/service/gpu/all_reduce_blueconnect.h"
 #include "tensorflow/compiler/xla/service/gpu/bef_thunk.h"
+#include "tensorflow/compiler/xla/service/gpu/blocked_attention_rewriter.h"
 #include "tensorflow/compiler/xla/service/gpu/fusion_bitcast_lift.h"
 #include "tensorflow/compiler/xla/service/gpu/fusion_merger.h"
 #include "tensorflow/compiler/xla/service/gpu/gemm_broadcast_folding_rewriter.h"
@@ -118,6 +123,7 @@ limitations under the License.
 #include "tensorflow/compiler/xla/service/gpu/reduction_layout_normalizer.h"
 #include "tensorflow/compiler/xla/service/gpu/reduction_splitter.h"
 #include "tensorflow/compiler/xla/service/gpu/runtime_intrinsics.h"
+#include "tensorflow/compiler/xla/service/gpu/sequential_thunk.h"
 #include "tensorflow/compiler/xla/service/gpu/stream_assignment.h"
 #include "tensorflow/compiler/xla/service/gpu/stream_executor_util.h"
 #include "tensorflow/compiler/xla/service/gpu/target_constants.h"
@@ -135,6 +141,7 @@ limitations under the License.
 #include "tensorflow/compiler/xla/service/hlo_pass_fix.h"
 #include "tensorflow/compiler/xla/service/hlo_pass_pipeline.h"
 #include "tensorflow/compiler/xla/service/hlo_proto_util.h"
+#include "tensorflow/compiler/xla/service/hlo_rematerialization.h"
 #include "tensorflow/compiler/xla/service/hlo_sharding_metadata.h"
 #include "tensorflow/compiler/xla/service/hlo_subcomputation_unification.h"
 #include "tensorflow/compiler/xla/service/hlo_verifier.h"
@@ -520,6 +527,12 @@ Status GpuCompiler::OptimizeHloModule(
       pipeline.AddPass<HloDCE>();
     }();
 
+    if (debug_options.xla_gpu_enable_blocked_attention()) {
+      // Runs after DotDecomposer, which canonicalizes the attention dots.
+      pipeline.AddPass<BlockedAttentionRewriter>(
+          BlockedAttentionRewriter::Options());
+    }
+
     // Run WhileLoopTripCountAnnotator at the end of the simplification
     // pipeline, before layout assignment and fusion.  This pass does some
     // pattern-matching on while bodies/conditions, and this is where the HLO is
@@ -795,6 +808,96 @@ Status GpuCompiler::OptimizeHloPostLayoutAssignment(
   return OkStatus();
 }
 
+// Rematerializes instructions of the single-stream schedule until its peak
+// memory fits in the free memory of `stream_exec`, and sets the schedule on
+// the module for GpuHloSchedule::Build to keep.
+static Status RematerializeToFitDeviceMemory(HloModule* hlo_module,
+                                             se::StreamExecutor* stream_exec,
+                                             int64_t pointer_size) {
+  if (!hlo_module->config()
+           .debug_options()
+           .xla_gpu_enable_rematerialization() ||
+      stream_exec == nullptr) {
+    return OkStatus();
+  }
+  // With several streams the thunks are not ordered by a sequential schedule,
+  // so there is nothing to rematerialize against.
+  if (AssignStreams(*hlo_module)->StreamCount() > 1) {
+    VLOG(1) << "Not rematerializing " << hlo_module->name()
+            << ", which runs on several streams.";
+    return OkStatus();
+  }
+  int64_t free_bytes = 0;
+  int64_t total_bytes = 0;
+  if (!stream_exec->DeviceMemoryUsage(&free_bytes, &total_bytes)) {
+    VLOG(1) << "Not rematerializing " << hlo_module->name()
+            << ", the free device memory is unknown.";
+    return OkStatus();
+  }
+
+  TF_ASSIGN_OR_RETURN(
+      HloSchedule schedule,
+      GpuHloSchedule::BuildSequentialSchedule(hlo_module, pointer_size));
+  TF_RETURN_IF_ERROR(hlo_module->set_schedule(std::move(schedule)));
+  HloRematerialization::RematerializationSizes sizes;
+  HloRematerialization rematerialization(
+      [pointer_size](const Shape& shape) {
+        return GetSizeOfShape(shape, pointer_size);
+      },
+      /*memory_limit_bytes=*/free_bytes, &sizes,
+      HloRematerialization::RematerializationPass::kPostFusion,
+      /*block_size_limit=*/1, /*block_rematerialization_factor=*/1,
+      /*compact_shape_function=*/nullptr,
+      HloRematerialization::RematerializationMode::kRecomputeOnly);
+  TF_ASSIGN_OR_RETURN(bool changed, rematerialization.Run(hlo_module));
+  VLOG(1) << "Rematerialization of " << hlo_module->name() << " to "
+          << free_bytes << " bytes " << (changed ? "changed" : "kept")
+          << " the peak memory of " << sizes.before_bytes << " bytes, now "
+          << sizes.after_bytes << " bytes.";
+  return OkStatus();
+}
+
+// Offloads values of the single-stream schedule to pinned host memory while
+// they are not used, until the estimated peak memory fits in the free memory
+// of `stream_exec`, or as far as possible if that is unknown.
+static Status OffloadActivationsToHost(HloModule* hlo_module,
+                                       se::StreamExecutor* stream_exec,
+                                       int64_t pointer_size) {
+  if (!hlo_module->config().debug_options().xla_gpu_enable_host_offloading()) {
+    return OkStatus();
+  }
+  // The copies overlap with the compute only where the schedule places them.
+  if (AssignStreams(*hlo_module)->StreamCount() > 1) {
+    VLOG(1) << "Not offloading activations of " << hlo_module->name()
+            << ", which runs on several streams.";
+    return OkStatus();
+  }
+  if (!hlo_module->has_schedule()) {
+    TF_ASSIGN_OR_RETURN(
+        HloSchedule schedule,
+        GpuHloSchedule::BuildSequentialSchedule(hlo_module, pointer_size));
+    TF_RETURN_IF_ERROR(hlo_module->set_schedule(std::move(schedule)));
+  }
+
+  ActivationOffloader::Options options;
+  options.pointer_size = pointer_size;
+  int64_t free_bytes = 0;
+  int64_t total_bytes = 0;
+  if (stream_exec != nullptr &&
+      stream_exec->DeviceMemoryUsage(&free_bytes, &total_bytes)) {
+    options.memory_limit_bytes = free_bytes;
+  }
+  // The nominal device rates of the GPU schedule.
+  HloCostAnalysis::Options cost_options{[pointer_size](const Shape& shape) {
+    return ShapeUtil::ByteSizeOf(shape, pointer_size);
+  }};
+  cost_options.set_flops_per_second(1e13);
+  cost_options.set_bytes_per_second(5e11);
+  GpuHloCostAnalysis cost_analysis(cost_options);
+  TF_RETURN_IF_ERROR(hlo_module->entry_computation()->Accept(&cost_analysis));
+  return ActivationOffloader(&cost_analysis, options).Run(hlo_module).status();
+}
+
 StatusOr<std::unique_ptr<HloModule>> GpuCompiler::RunHloPasses(
     std::unique_ptr<HloModule> module, se::StreamExecutor* stream_exec,
     const CompileOptions& options) {
@@ -809,6 +912,11 @@ StatusOr<std::unique_ptr<HloModule>> GpuCompiler::RunHloPasses(
 
   TF_RETURN_IF_ERROR(PrepareHloModuleForIrEmitting(module.get()));
 
+  TF_RETURN_IF_ERROR(
+      RematerializeToFitDeviceMemory(module.get(), stream_exec, pointer_size_));
+  TF_RETURN_IF_ERROR(
+      OffloadActivationsToHost(module.get(), stream_exec, pointer_size_));
+
   uint64_t end_usecs = tensorflow::Env::Default()->NowMicros();
 
   // This won't record values for calls that error out (because if they error
@@ -967,6 +1075,66 @@ struct CompileModuleResults {
   std::string module_name;
 };
 
+// Schedules `thunks` onto the streams of `stream_assignment`. `thunk_op_names`
+// are the names of the instructions of `entry_computation` the thunks were
+// emitted for. The schedule maps each instruction to a single thunk, so several
+// thunks emitted for one instruction are wrapped into a SequentialThunk. Falls
+// back to a single stream if the thunks don't map to the instructions.
+static std::unique_ptr<ThunkSchedule> BuildMultiStreamThunkSchedule(
+    HloComputation* entry_computation, std::unique_ptr<ThunkSequence> thunks,
+    const std::vector<std::string>& thunk_op_names,
+    std::unique_ptr<StreamAssignment> stream_assignment) {
+  // The instructions in thunk order, with the index of their first thunk.
+  std::vector<std::pair<const HloInstruction*, int64_t>> thunk_ranges;
+  absl::flat_hash_set<const HloInstruction*> seen;
+  for (int64_t i = 0; i < thunks->size(); ++i) {
+    const HloInstruction* hlo =
+        i < thunk_op_names.size()
+            ? entry_computation->GetInstructionWithName(thunk_op_names[i])
+            : nullptr;
+    if (hlo == nullptr || !stream_assignment->HasStreamAssigned(*hlo)) {
+      VLOG(1) << "Running on a single stream, thunk " << i
+              << " has no instruction with a stream.";
+      return std::make_unique<ThunkSchedule>(std::move(thunks));
+    }
+    if (!thunk_ranges.empty() && thunk_ranges.back().first == hlo) {
+      continue;
+    }
+    if (!seen.insert(hlo).second) {
+      VLOG(1) << "Running on a single stream, the thunks of " << hlo->name()
+              << " are not contiguous.";
+      return std::make_unique<ThunkSchedule>(std::move(thunks));
+    }
+    thunk_ranges.emplace_back(hlo, i);
+  }
+
+  auto hlo_thunks = std::make_unique<ThunkSequence>();
+  absl::flat_hash_map<const Thunk*, const HloInstruction*> thunk_to_hlo;
+  for (int64_t r = 0; r < thunk_ranges.size(); ++r) {
+    int64_t begin = thunk_ranges[r].second;
+    int64_t end = r + 1 < thunk_ranges.size() ? thunk_ranges[r + 1].second
+                                              : thunks->size();
+    std::unique_ptr<Thunk> thunk;
+    if (end - begin == 1) {
+      thunk = std::move(thunks->at(begin));
+    } else {
+      Thunk::ThunkInfo thunk_info;
+      thunk_info.profile_annotation = thunks->at(begin)->profile_annotation();
+      ThunkSequence sequence;
+      for (int64_t i = begin; i < end; ++i) {
+        sequence.push_back(std::move(thunks->at(i)));
+      }
+      thunk =
+          std::make_unique<SequentialThunk>(thunk_info, std::move(sequence));
+    }
+    thunk_to_hlo[thunk.get()] = thunk_ranges[r].first;
+    hlo_thunks->push_back(std::move(thunk));
+  }
+  return std::make_unique<ThunkSchedule>(std::move(hlo_thunks),
+                                         std::move(stream_assignment),
+                                         std::move(thunk_to_hlo));
+}
+
 // The order of `thunk_sequence` corresponds to
 // `hlo_schedule->ThunkLaunchOrder()`.
 static Status CompileModuleToLlvmIrImpl(
@@ -1020,8 +1188,15 @@ static Status CompileModuleToLlvmIrImpl(
   mlir::OwningOpRef<mlir::ModuleOp> mlir_module =
       mlir::ModuleOp::create(mlir::Builder(&mlir_context).getUnknownLoc());
 
-  TF_RETURN_IF_ERROR(
-      HloToLhloModule(*results->buffer_assignment, *hlo_module, *mlir_module));
+  // With several streams the entry computation is only partially ordered, so
+  // its instructions are imported in the thunk launch order.
+  std::optional<HloInstructionSequence> entry_sequence;
+  if (stream_assignment->StreamCount() > 1) {
+    entry_sequence.emplace(hlo_schedule->ThunkLaunchOrder());
+  }
+  TF_RETURN_IF_ERROR(HloToLhloModule(
+      *results->buffer_assignment, *hlo_module, *mlir_module,
+      entry_sequence.has_value() ? &*entry_sequence : nullptr));
 
   results->module_name = mlir::GetNameFromLoc(mlir_module->getLoc());
 
@@ -1112,8 +1287,14 @@ static Status CompileModuleToLlvmIrImpl(
   }
 #endif  // XLA_ENABLE_XLIR
 
-  results->executable =
-      std::make_unique<ThunkSchedule>(ir_emitter->ConsumeThunkSequence());
+  if (stream_assignment->StreamCount() > 1) {
+    results->executable = BuildMultiStreamThunkSchedule(
+        hlo_module->entry_computation(), ir_emitter->ConsumeThunkSequence(),
+        ir_emitter->thunk_op_names(), std::move(stream_assignment));
+  } else {
+    results->executable =
+        std::make_unique<ThunkSchedule>(ir_emitter->ConsumeThunkSequence());
+  }
   return OkStatus();
 }
 
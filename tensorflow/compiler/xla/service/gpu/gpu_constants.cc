@@ -34,5 +34,7 @@ const int64_t kXlaAllocatedBufferAlignBytes = 128;
 
 const int64_t kConstantBufferAlignBytes = kXlaAllocatedBufferAlignBytes;
 
+const int64_t kHostMemorySpace = 1;
+
 }  // namespace gpu
 }  // namespace xla
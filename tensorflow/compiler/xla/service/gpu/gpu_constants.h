@@ -31,6 +31,11 @@ extern const int64_t kXlaAllocatedBufferAlignBytes;
 // Minimum alignment for constant buffers.
 extern const int64_t kConstantBufferAlignBytes;
 
+// The layout memory space of buffers in pinned host memory, e.g. activations
+// offloaded from the device. The buffers in the default memory space 0 are in
+// device memory.
+extern const int64_t kHostMemorySpace;
+
 }  // namespace gpu
 }  // namespace xla
 
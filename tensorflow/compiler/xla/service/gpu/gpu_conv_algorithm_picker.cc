@@ -18,7 +18,9 @@ limitations under the License.
 #include <limits>
 #include <optional>
 #include <string>
+#include <tuple>
 #include <utility>
+#include <vector>
 
 #include "absl/algorithm/container.h"
 #include "absl/strings/str_cat.h"
@@ -305,7 +307,7 @@ StatusOr<bool> CheckRedzones(const se::RedzoneAllocator& allocator,
 #endif
 
 using ConvCacheKey =
-    std::tuple<se::StreamExecutor*,
+    std::tuple</* GetDeviceIdentifier(stream_exec) */ std::string,
                /* conv->ToString(HloPrintOptions::Canonical()) */ std::string>;
 
 struct ConvCacheStats {
@@ -322,7 +324,7 @@ ConvCacheKey AutotuneCacheKeyfromInstruction(
     const HloCustomCallInstruction* conv, se::StreamExecutor* se) {
   auto options = HloPrintOptions::Canonical();
   options.set_print_backend_config(true);
-  return std::make_tuple(se, conv->ToString(options));
+  return std::make_tuple(GetDeviceIdentifier(se), conv->ToString(options));
 }
 
 absl::Mutex autotune_cache_lock(absl::kConstInit);
@@ -332,6 +334,38 @@ auto& autotune_cache_stats ABSL_GUARDED_BY(autotune_cache_lock) =
     *new ConvCacheStats();
 }  // anonymous namespace
 
+/*static*/ void GpuConvAlgorithmPicker::WriteAutotuneResults(
+    AutotuneResults* results) {
+  absl::MutexLock lock(&autotune_cache_lock);
+  std::vector<const std::pair<const ConvCacheKey, AutotuneResult>*> entries;
+  entries.reserve(autotune_cache.size());
+  for (const auto& entry : autotune_cache) entries.push_back(&entry);
+  // Sorts the entries to make the output deterministic.
+  absl::c_sort(entries, [](const auto* a, const auto* b) {
+    return a->first < b->first;
+  });
+  for (const auto* entry : entries) {
+    AutotuneResults::Entry* result = results->add_convs();
+    result->set_device(std::get<0>(entry->first));
+    result->set_hlo(std::get<1>(entry->first));
+    *result->mutable_result() = entry->second;
+  }
+}
+
+/*static*/ void GpuConvAlgorithmPicker::LoadAutotuneResults(
+    const AutotuneResults& results) {
+  absl::MutexLock lock(&autotune_cache_lock);
+  for (const AutotuneResults::Entry& result : results.convs()) {
+    autotune_cache.insert(
+        {std::make_tuple(result.device(), result.hlo()), result.result()});
+  }
+}
+
+/*static*/ void GpuConvAlgorithmPicker::ClearAutotuneResults() {
+  absl::MutexLock lock(&autotune_cache_lock);
+  autotune_cache.clear();
+}
+
 StatusOr<AutotuneResult> GpuConvAlgorithmPicker::PickBestAlgorithm(
     const HloCustomCallInstruction* instr) {
   // Don't run this function concurrently on the same GPU.
@@ -395,7 +429,8 @@ StatusOr<AutotuneResult> GpuConvAlgorithmPicker::PickBestAlgorithm(
 
   if (result_or.ok()) {
     absl::MutexLock lock(&autotune_cache_lock);
-    CHECK(autotune_cache.insert({key, result_or.ValueOrDie()}).second);
+    // The result may have been loaded by LoadAutotuneResults meanwhile.
+    autotune_cache.insert({key, result_or.ValueOrDie()});
   }
   return result_or;
 }
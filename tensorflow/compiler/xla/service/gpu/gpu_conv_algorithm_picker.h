@@ -20,6 +20,7 @@ limitations under the License.
 
 #include "absl/time/time.h"
 #include "tensorflow/compiler/xla/service/compiler.h"
+#include "tensorflow/compiler/xla/service/gpu/gpu_autotuning.pb.h"
 #include "tensorflow/compiler/xla/service/gpu/gpu_conv_runner.h"
 #include "tensorflow/compiler/xla/service/hlo_instructions.h"
 #include "tensorflow/compiler/xla/service/hlo_module.h"
@@ -52,6 +53,14 @@ class GpuConvAlgorithmPicker : public HloModulePass {
 
   StatusOr<bool> Run(HloModule* module) override;
 
+  // Appends the autotuning results of all convolutions of the process to
+  // `results`.
+  static void WriteAutotuneResults(AutotuneResults* results);
+  // Adds the convolution results of `results` to the results of the process.
+  // Results of instructions that were already autotuned are kept.
+  static void LoadAutotuneResults(const AutotuneResults& results);
+  static void ClearAutotuneResults();
+
  private:
   StatusOr<bool> RunOnComputation(HloComputation* computation);
   StatusOr<bool> RunOnInstruction(HloInstruction* instr);
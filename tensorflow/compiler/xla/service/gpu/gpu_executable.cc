@@ -23,6 +23,7 @@ limitations under the License.
 #include <utility>
 #include <vector>
 
+#include "absl/algorithm/container.h"
 #include "absl/cleanup/cleanup.h"
 #include "absl/container/flat_hash_map.h"
 #include "absl/synchronization/mutex.h"
@@ -31,6 +32,7 @@ limitations under the License.
 #include "tensorflow/compiler/xla/service/gpu/gpu_constants.h"
 #include "tensorflow/compiler/xla/service/gpu/gpu_executable_run_options.h"
 #include "tensorflow/compiler/xla/service/gpu/gpu_types.h"
+#include "tensorflow/compiler/xla/service/gpu/sequential_thunk.h"
 #include "tensorflow/compiler/xla/service/gpu/stream_executor_util.h"
 #include "tensorflow/compiler/xla/service/hlo_instruction.h"
 #include "tensorflow/compiler/xla/service/hlo_parser.h"
@@ -49,6 +51,9 @@ limitations under the License.
 #include "tensorflow/core/platform/logging.h"
 #include "tensorflow/core/profiler/lib/scoped_annotation.h"
 #include "tensorflow/core/profiler/lib/traceme.h"
+#include "tensorflow/stream_executor/gpu/gpu_driver.h"
+#include "tensorflow/stream_executor/gpu/gpu_executor.h"
+#include "tensorflow/stream_executor/gpu/gpu_stream.h"
 #include "tensorflow/stream_executor/platform.h"
 
 #if XLA_ENABLE_XLIR
@@ -59,8 +64,6 @@ limitations under the License.
 #include "tensorflow/compiler/mlir/utils/name_utils.h"
 #include "tensorflow/compiler/xla/service/gpu/jitrt_custom_calls.h"
 #include "tensorflow/compiler/xla/service/gpu/xlir_ops.h"
-#include "tensorflow/stream_executor/gpu/gpu_executor.h"
-#include "tensorflow/stream_executor/gpu/gpu_stream.h"
 #include "tfrt/gpu/gpu_executor.h"  // from @tf_runtime
 #include "tfrt/gpu/gpu_types.h"  // from @tf_runtime
 #include "tfrt/jitrt/diagnostics.h"  // from @tf_runtime
@@ -113,6 +116,8 @@ using ::tensorflow::profiler::ScopedAnnotation;
 
 bool NeedsAsyncCommsStream(Thunk& thunk) {
   switch (thunk.kind()) {
+    case Thunk::Kind::kCopyStart:
+    case Thunk::Kind::kCopyDone:
     case Thunk::Kind::kNcclAllReduceStart:
     case Thunk::Kind::kNcclAllReduceDone:
       return true;
@@ -121,6 +126,39 @@ bool NeedsAsyncCommsStream(Thunk& thunk) {
   }
 }
 
+// Returns whether the thunk only enqueues work onto its stream that can be
+// captured into a CUDA graph.  Thunks with control flow, host callbacks,
+// host-device transfers or collectives aren't captured.
+bool CanCaptureThunk(const Thunk& thunk) {
+  switch (thunk.kind()) {
+    case Thunk::kCopy:
+    case Thunk::kGemm:
+    case Thunk::kKernel:
+    case Thunk::kMemset32BitValue:
+    case Thunk::kMemzero:
+      return true;
+    case Thunk::kSequential:
+      return absl::c_all_of(
+          static_cast<const SequentialThunk&>(thunk).thunks(),
+          [](const std::unique_ptr<Thunk>& thunk) {
+            return CanCaptureThunk(*thunk);
+          });
+    default:
+      return false;
+  }
+}
+
+// Returns whether the thunks of `thunk_schedule` can be replayed with a CUDA
+// graph.  Only schedules on a single stream are captured, as the events
+// between the streams of the other schedules can't be captured.
+bool CanCaptureCudaGraph(const ThunkSchedule& thunk_schedule) {
+  return thunk_schedule.StreamCount() == 1 &&
+         absl::c_all_of(thunk_schedule.TotalOrder(),
+                        [](const std::unique_ptr<Thunk>& thunk) {
+                          return CanCaptureThunk(*thunk);
+                        });
+}
+
 }  // namespace
 
 void GpuExecutable::BefBufferDeleter::operator()(uint8_t* ptr) const {
@@ -292,6 +330,11 @@ StatusOr<std::unique_ptr<GpuExecutable>> GpuExecutable::Create(Params params) {
 
   if (std::holds_alternative<OwnedThunkSchedule>(executable)) {
     result->thunks_ = std::move(std::get<OwnedThunkSchedule>(executable));
+    result->cuda_graphs_enabled_ =
+        result->has_module() &&
+        result->module().config().debug_options()
+            .xla_gpu_enable_cuda_graphs() &&
+        CanCaptureCudaGraph(*result->thunks_);
     return result;
   }
 
@@ -516,6 +559,116 @@ Status MaybeSyncAndProfile(const ServiceExecutableRunOptions* run_options,
 
 }  // namespace
 
+struct GpuExecutable::CudaGraph {
+  explicit CudaGraph(se::gpu::GpuContext* context) : context(context) {}
+  ~CudaGraph() {
+    if (graph_exec != nullptr) {
+      se::gpu::GpuDriver::DestroyGraphExec(context, graph_exec);
+    }
+  }
+
+  se::gpu::GpuContext* const context;
+  // Serializes the updates and launches of `graph_exec`.
+  absl::Mutex mu;
+  se::gpu::GpuGraphExecHandle graph_exec ABSL_GUARDED_BY(mu) = nullptr;
+  // The buffer addresses `graph_exec` was captured with.
+  std::vector<void*> buffers ABSL_GUARDED_BY(mu);
+};
+
+Status GpuExecutable::CaptureCudaGraph(
+    const ServiceExecutableRunOptions* run_options,
+    const BufferAllocations& buffer_allocations, CudaGraph* graph) {
+  se::StreamExecutor* executor = run_options->stream()->parent();
+  // Captures on a stream of its own, so that a failed capture doesn't leave the
+  // main stream in an error state.
+  TF_ASSIGN_OR_RETURN(StreamPool::Ptr capture_stream,
+                      run_options->BorrowStream(executor->device_ordinal()));
+  se::gpu::GpuStreamHandle stream =
+      se::gpu::AsGpuStreamValue(capture_stream.get());
+
+  TF_RETURN_IF_ERROR(
+      se::gpu::GpuDriver::StreamBeginCapture(graph->context, stream));
+  Status status;
+  for (const std::unique_ptr<Thunk>& thunk : thunks_->TotalOrder()) {
+    Thunk::ExecuteParams thunk_params{*run_options, buffer_allocations,
+                                      capture_stream.get(), nullptr};
+    status = thunk->ExecuteOnStream(thunk_params);
+    if (!status.ok()) break;
+  }
+  se::gpu::GpuGraphHandle captured_graph = nullptr;
+  Status end_status = se::gpu::GpuDriver::StreamEndCapture(
+      graph->context, stream, &captured_graph);
+  TF_RETURN_IF_ERROR(status);
+  TF_RETURN_IF_ERROR(end_status);
+  absl::Cleanup destroy_graph = [&] {
+    se::gpu::GpuDriver::DestroyGraph(graph->context, captured_graph);
+  };
+
+  if (graph->graph_exec != nullptr) {
+    // Updating the kernel arguments is much cheaper than instantiating the
+    // graph again.
+    TF_ASSIGN_OR_RETURN(
+        bool updated, se::gpu::GpuDriver::GraphExecUpdate(
+                          graph->context, graph->graph_exec, captured_graph));
+    if (updated) return OkStatus();
+    se::gpu::GpuDriver::DestroyGraphExec(graph->context, graph->graph_exec);
+    graph->graph_exec = nullptr;
+  }
+  return se::gpu::GpuDriver::GraphInstantiate(graph->context, captured_graph,
+                                              &graph->graph_exec);
+}
+
+StatusOr<bool> GpuExecutable::ExecuteThunksWithCudaGraph(
+    const ServiceExecutableRunOptions* run_options,
+    const BufferAllocations& buffer_allocations, bool block_host_until_done) {
+  se::Stream* main_stream = run_options->stream();
+  se::StreamExecutor* executor = main_stream->parent();
+
+  CudaGraph* graph;
+  {
+    absl::MutexLock lock(&cuda_graphs_mutex_);
+    if (!cuda_graphs_enabled_) return false;
+    std::unique_ptr<CudaGraph>& entry = cuda_graphs_[executor];
+    if (entry == nullptr) {
+      entry = std::make_unique<CudaGraph>(
+          se::gpu::ExtractGpuExecutor(executor)->gpu_context());
+    }
+    graph = entry.get();
+  }
+
+  uint64_t start_micros = tensorflow::Env::Default()->NowMicros();
+  tensorflow::profiler::TraceMe hlo_module_activity(
+      [&] { return absl::StrCat(module_name_, ":XLA GPU module"); },
+      tensorflow::profiler::TraceMeLevel::kInfo);
+
+  absl::MutexLock lock(&graph->mu);
+  std::vector<void*> buffers(allocations_.size());
+  for (BufferAllocation::Index i = 0; i < allocations_.size(); ++i) {
+    buffers[i] = buffer_allocations.GetDeviceAddress(i).opaque();
+  }
+  if (graph->graph_exec == nullptr || buffers != graph->buffers) {
+    VLOG(2) << "Capturing a CUDA graph of " << module_name_;
+    Status status = CaptureCudaGraph(run_options, buffer_allocations, graph);
+    if (!status.ok()) {
+      LOG(WARNING) << "Failed to capture a CUDA graph of " << module_name_
+                   << ", launching its thunks separately from now on: "
+                   << status;
+      absl::MutexLock graphs_lock(&cuda_graphs_mutex_);
+      cuda_graphs_enabled_ = false;
+      return false;
+    }
+    graph->buffers = std::move(buffers);
+  }
+
+  TF_RETURN_IF_ERROR(se::gpu::GpuDriver::GraphLaunch(
+      graph->context, graph->graph_exec,
+      se::gpu::AsGpuStreamValue(main_stream)));
+  TF_RETURN_IF_ERROR(
+      MaybeSyncAndProfile(run_options, start_micros,
+                          block_host_until_done ? main_stream : nullptr));
+  return true;
+}
+
 StatusOr<const GpuExecutable::BufferAllocToDeviceMemoryMap*>
 GpuExecutable::ResolveConstantGlobals(se::Stream* stream) {
   se::StreamExecutor* executor = stream->parent();
@@ -666,16 +819,30 @@ static Status CheckAlignment(const BufferAllocation& allocation,
 StatusOr<BufferAllocations> GpuExecutable::GenerateBufferAllocations(
     VariantArguments arguments,
     const GpuExecutable::BufferAllocToDeviceMemoryMap* globals,
-    se::DeviceMemoryAllocator* const memory_allocator, int device_ordinal) {
+    se::DeviceMemoryAllocator* const memory_allocator,
+    se::StreamExecutor* executor, std::vector<void*>* host_buffers) {
   tensorflow::profiler::TraceMe hlo_module_activity(
       [&] { return std::string("Build buffer allocations"); },
       tensorflow::profiler::TraceMeLevel::kInfo);
 
+  const int device_ordinal = executor->device_ordinal();
   const int64_t num_buffers = allocations_.size();
   std::vector<se::DeviceMemoryBase> buffers;
   buffers.reserve(num_buffers);
   for (int64_t i = 0; i < num_buffers; ++i) {
     const BufferAllocation& allocation = allocations_[i];
+    if (allocation.color() == kHostMemorySpace) {
+      void* host_buffer = executor->HostMemoryAllocate(allocation.size());
+      if (host_buffer == nullptr) {
+        return ResourceExhausted(
+            "Failed to allocate %d bytes of pinned host memory for allocation "
+            "%d.",
+            allocation.size(), i);
+      }
+      host_buffers->push_back(host_buffer);
+      buffers.emplace_back(host_buffer, allocation.size());
+      continue;
+    }
     TF_ASSIGN_OR_RETURN(
         se::DeviceMemoryBase buffer,
         BufferForAllocation(arguments, globals, allocation, memory_allocator,
@@ -929,9 +1096,13 @@ StatusOr<ExecutionOutput> GpuExecutable::ExecuteAsyncOnStreamImpl(
   XLA_SCOPED_LOGGING_TIMER(absl::StrCat(
       "GpuExecutable::ExecuteAsyncOnStreamImpl(", module_name_, ")"));
   se::DeviceMemoryAllocator* const memory_allocator = run_options->allocator();
-  // Force synchronous execution if the allocator requires it.
+  // Force synchronous execution if the allocator requires it, or to free the
+  // pinned host buffers once the device is done with them.
   const bool block_host_until_done =
-      !memory_allocator->AllowsAsynchronousDeallocation();
+      !memory_allocator->AllowsAsynchronousDeallocation() ||
+      absl::c_any_of(allocations_, [](const BufferAllocation& allocation) {
+        return allocation.color() == kHostMemorySpace;
+      });
 
   se::StreamExecutor* executor = run_options->stream()->parent();
 
@@ -953,10 +1124,16 @@ StatusOr<ExecutionOutput> GpuExecutable::ExecuteAsyncOnStreamImpl(
   ExecutionOutput result(/*on_device_shape=*/output_shape_, memory_allocator,
                          device_ordinal);
 
+  std::vector<void*> host_buffers;
+  absl::Cleanup free_host_buffers = [&] {
+    for (void* host_buffer : host_buffers) {
+      executor->HostMemoryDeallocate(host_buffer);
+    }
+  };
   TF_ASSIGN_OR_RETURN(
       BufferAllocations buffer_allocations,
-      GenerateBufferAllocations(arguments, globals, memory_allocator,
-                                device_ordinal));
+      GenerateBufferAllocations(arguments, globals, memory_allocator, executor,
+                                &host_buffers));
   VLOG(2) << buffer_allocations.ToString();
   std::set<se::DeviceMemoryBase> buffers_in_result;
 
@@ -1095,6 +1272,11 @@ Status GpuExecutable::ExecuteThunksOrBef(
     for (const std::unique_ptr<Thunk>& thunk : thunks_->TotalOrder()) {
       TF_RETURN_IF_ERROR(thunk->Initialize(*this, executor));
     }
+    TF_ASSIGN_OR_RETURN(bool executed,
+                        ExecuteThunksWithCudaGraph(run_options,
+                                                   buffer_allocations,
+                                                   block_host_until_done));
+    if (executed) return OkStatus();
     return ExecuteThunks(module_name_, *thunks_, run_options,
                          buffer_allocations, block_host_until_done);
   }
@@ -271,15 +271,36 @@ class GpuExecutable : public Executable {
   StatusOr<const BufferAllocToDeviceMemoryMap*> ResolveConstantGlobals(
       stream_executor::Stream* stream);
 
+  // A CUDA graph that replays thunks_ on one StreamExecutor.
+  struct CudaGraph;
+
+  // Executes thunks_ by launching a CUDA graph of them, which is captured
+  // again when the buffer addresses differ from the ones it was captured
+  // with.  Returns false without executing anything if CUDA graphs are
+  // disabled for this executable, or a capture failed.
+  StatusOr<bool> ExecuteThunksWithCudaGraph(
+      const ServiceExecutableRunOptions* run_options,
+      const BufferAllocations& buffer_allocations, bool block_host_until_done);
+
+  // Captures thunks_ with `buffer_allocations` into `graph`, updating the
+  // executable graph of `graph` if it has one of the same topology.
+  Status CaptureCudaGraph(const ServiceExecutableRunOptions* run_options,
+                          const BufferAllocations& buffer_allocations,
+                          CudaGraph* graph)
+      ABSL_EXCLUSIVE_LOCKS_REQUIRED(graph->mu);
+
   // GpuExecutable check with either AMD's ISA version, or Nvidia's major minor
   // version for compute capability, depending on the hardware.
   Status CheckCompatibilityWithServiceExecutableRunOptions(
       const ServiceExecutableRunOptions* run_options);
 
+  // The allocations in kHostMemorySpace are allocated in pinned host memory of
+  // `executor`, and appended to `host_buffers` for the caller to free.
   StatusOr<BufferAllocations> GenerateBufferAllocations(
       VariantArguments arguments,
       const GpuExecutable::BufferAllocToDeviceMemoryMap* globals,
-      se::DeviceMemoryAllocator* const memory_allocator, int device_ordinal);
+      se::DeviceMemoryAllocator* const memory_allocator,
+      se::StreamExecutor* executor, std::vector<void*>* host_buffers);
 
   StatusOr<se::DeviceMemoryBase> BufferForAllocation(
       VariantArguments arguments,
@@ -334,6 +355,15 @@ class GpuExecutable : public Executable {
   std::map<stream_executor::StreamExecutor*, BufferAllocToDeviceMemoryMap>
       module_globals_ ABSL_GUARDED_BY(module_handle_mutex_);
 
+  absl::Mutex cuda_graphs_mutex_;
+  // Whether thunks_ are executed with CUDA graphs, see
+  // DebugOptions::xla_gpu_enable_cuda_graphs.
+  bool cuda_graphs_enabled_ ABSL_GUARDED_BY(cuda_graphs_mutex_) = false;
+  // Declared after module_handles_ to be destroyed before the modules that the
+  // graphs launch kernels of are unloaded.
+  std::map<stream_executor::StreamExecutor*, std::unique_ptr<CudaGraph>>
+      cuda_graphs_ ABSL_GUARDED_BY(cuda_graphs_mutex_);
+
   std::vector<ConstantInfo> constants_;
   const absl::flat_hash_map<ShapeIndex, OutputInfo> output_info_;
   // Retains shared ownership of on-device constants that are managed by XLA and
@@ -15,11 +15,17 @@ limitations under the License.
 
 #include "tensorflow/compiler/xla/service/gpu/gpu_hlo_schedule.h"
 
+#include <algorithm>
 #include <deque>
 #include <memory>
+#include <optional>
+#include <set>
+#include <vector>
 
+#include "absl/algorithm/container.h"
 #include "absl/container/flat_hash_map.h"
 #include "tensorflow/compiler/xla/service/buffer_value.h"
+#include "tensorflow/compiler/xla/service/gpu/gpu_hlo_cost_analysis.h"
 #include "tensorflow/compiler/xla/service/hlo_instructions.h"
 #include "tensorflow/compiler/xla/service/hlo_memory_scheduler.h"
 #include "tensorflow/compiler/xla/service/hlo_reachability.h"
@@ -40,12 +46,13 @@ class GpuHloOrdering : public PredecessorHloOrdering {
                  const std::vector<HloInstruction*>& thunk_launch_order);
   ~GpuHloOrdering() override = default;
 
-  // Only the entry computation can possibly be sequentially ordered, and only
-  // if we've assigned all instructions to a single stream.
+  // The entry computation is only sequentially ordered if we've assigned all
+  // instructions to a single stream. The other computations run on the stream
+  // of their caller, in the order they are emitted in.
   const HloInstructionSequence* SequentialOrder(
       const HloComputation& computation) const override {
-    return &computation == module_->entry_computation() ? entry_sequence_.get()
-                                                        : nullptr;
+    auto it = sequences_.find(&computation);
+    return it == sequences_.end() ? nullptr : &it->second;
   }
 
   std::string ToString() const override {
@@ -53,7 +60,8 @@ class GpuHloOrdering : public PredecessorHloOrdering {
   }
 
  private:
-  std::unique_ptr<HloInstructionSequence> entry_sequence_;
+  absl::flat_hash_map<const HloComputation*, HloInstructionSequence>
+      sequences_;
 };
 
 GpuHloOrdering::GpuHloOrdering(
@@ -62,8 +70,8 @@ GpuHloOrdering::GpuHloOrdering(
     : PredecessorHloOrdering(module) {
   // The entry computation has a total order when there's only one stream.
   if (stream_assignment.StreamCount() == 1) {
-    entry_sequence_ =
-        std::make_unique<HloInstructionSequence>(thunk_launch_order);
+    sequences_.emplace(module->entry_computation(),
+                       HloInstructionSequence(thunk_launch_order));
   }
 
   // The ordering of instructions for the entry computation is determined by the
@@ -116,18 +124,16 @@ GpuHloOrdering::GpuHloOrdering(
   predecessors_.emplace(module->entry_computation(),
                         std::move(predecessor_map));
 
-  // The ordering of instructions in subcomputations is based solely on control
-  // and data dependencies.
-  //
-  // TODO(toddw): Each subcomputation is actually emitted as a function in DFS
-  // postorder, so we can do better and establish the total order here. We don't
-  // do that yet since it's hard to ensure that the order here is the order used
-  // by IrEmitterNested. And mismatched ordering bugs would be hard to find.
+  // Subcomputations run on the stream of their caller, sequentially in the
+  // order given here, which is also the order they are imported to LMHLO in.
   for (auto* computation : module->computations()) {
     if (computation != module->entry_computation() &&
         !computation->IsFusionComputation()) {
       predecessors_.emplace(computation,
                             HloReachabilityMap::Build(computation));
+      sequences_.emplace(
+          computation,
+          HloInstructionSequence(computation->MakeInstructionPostOrder()));
     }
   }
 }
@@ -305,11 +311,255 @@ HloInstructionSequence PostprocessorToScheduleAsEarlyOrLateAsPossible(
   return result;
 }
 
+// Nominal device rates of the latency model. The model only has to tell which
+// compute fits into the time a collective is in flight.
+constexpr float kFlopsPerSecond = 1e13;
+constexpr float kBytesPerSecond = 5e11;
+constexpr double kInterconnectBytesPerSecond = 2e10;
+constexpr double kCollectiveLatencySeconds = 10e-6;
+// How much the peak memory may grow over the memory-minimizing schedule.
+constexpr double kMemoryLimitFactor = 1.1;
+
+bool IsAsyncCollectiveStart(const HloInstruction& instr) {
+  switch (instr.opcode()) {
+    case HloOpcode::kAllGatherStart:
+    case HloOpcode::kAllReduceStart:
+    case HloOpcode::kCollectivePermuteStart:
+      return true;
+    default:
+      return false;
+  }
+}
+
+bool IsAsyncCollectiveDone(const HloInstruction& instr) {
+  switch (instr.opcode()) {
+    case HloOpcode::kAllGatherDone:
+    case HloOpcode::kAllReduceDone:
+    case HloOpcode::kCollectivePermuteDone:
+      return true;
+    default:
+      return false;
+  }
+}
+
+// Returns the estimated time the collective started by `start` takes.
+double CollectiveSeconds(const HloInstruction& start, int64_t pointer_size) {
+  int64_t bytes = 0;
+  for (const HloInstruction* operand : start.operands()) {
+    bytes += ShapeUtil::ByteSizeOf(operand->shape(), pointer_size);
+  }
+  return kCollectiveLatencySeconds + bytes / kInterconnectBytesPerSecond;
+}
+
+// Returns the bytes of the buffers defined by `instr`. Instructions that only
+// forward buffers define none.
+int64_t DefinedBytes(const HloInstruction& instr, int64_t pointer_size) {
+  switch (instr.opcode()) {
+    case HloOpcode::kBitcast:
+    case HloOpcode::kGetTupleElement:
+    case HloOpcode::kParameter:
+    case HloOpcode::kTuple:
+      return 0;
+    default:
+      break;
+  }
+  int64_t bytes = 0;
+  ShapeUtil::ForEachSubshape(
+      instr.shape(), [&](const Shape& subshape, const ShapeIndex&) {
+        if (subshape.IsArray()) {
+          bytes += ShapeUtil::ByteSizeOf(subshape, pointer_size);
+        }
+      });
+  return bytes;
+}
+
+// Tracks the bytes live at each point of a schedule: the buffers defined by an
+// instruction are live until all of its users are scheduled.
+class LiveBytesTracker {
+ public:
+  explicit LiveBytesTracker(int64_t pointer_size)
+      : pointer_size_(pointer_size) {}
+
+  // Returns the live bytes after scheduling `instr`, without scheduling it.
+  int64_t LiveBytesAfter(const HloInstruction& instr) const {
+    return live_bytes_ + DefinedBytes(instr, pointer_size_);
+  }
+
+  void Schedule(const HloInstruction& instr) {
+    live_bytes_ += DefinedBytes(instr, pointer_size_);
+    peak_bytes_ = std::max(peak_bytes_, live_bytes_);
+    if (instr.user_count() == 0 && !instr.IsRoot()) {
+      live_bytes_ -= DefinedBytes(instr, pointer_size_);
+    }
+    for (const HloInstruction* operand : instr.unique_operands()) {
+      auto it = remaining_users_.try_emplace(operand, operand->user_count())
+                    .first;
+      if (--it->second == 0 && !operand->IsRoot()) {
+        live_bytes_ -= DefinedBytes(*operand, pointer_size_);
+      }
+    }
+  }
+
+  int64_t peak_bytes() const { return peak_bytes_; }
+
+ private:
+  const int64_t pointer_size_;
+  int64_t live_bytes_ = 0;
+  int64_t peak_bytes_ = 0;
+  absl::flat_hash_map<const HloInstruction*, int64_t> remaining_users_;
+};
+
+// Reorders `input` to hide the latency of asynchronous collectives. This is a
+// list scheduler that simulates the run time of the schedule with the cost
+// model: collectives start as soon as they are ready, and while one is in
+// flight, instructions that don't wait for it are scheduled ahead of its done.
+// Otherwise instructions keep the order of `input`, and the scheduler stops
+// hoisting compute over a done once the live bytes would exceed the limit.
+HloInstructionSequence ScheduleToHideLatency(
+    const HloInstructionSequence& input, const HloCostAnalysis& cost_analysis,
+    int64_t pointer_size) {
+  const std::vector<HloInstruction*>& instructions = input.instructions();
+  if (!absl::c_any_of(instructions, [](const HloInstruction* instr) {
+        return IsAsyncCollectiveStart(*instr);
+      })) {
+    return input;
+  }
+
+  LiveBytesTracker input_tracker(pointer_size);
+  absl::flat_hash_map<const HloInstruction*, int64_t> position;
+  for (int64_t i = 0; i < instructions.size(); ++i) {
+    input_tracker.Schedule(*instructions[i]);
+    position[instructions[i]] = i;
+  }
+  const int64_t memory_limit = input_tracker.peak_bytes() * kMemoryLimitFactor;
+
+  // The number of operands and control predecessors each instruction waits
+  // for. Each operand counts once, as users() lists each user once.
+  absl::flat_hash_map<const HloInstruction*, int64_t> unscheduled_deps;
+  // The ready instructions by their position in `input`.
+  std::set<int64_t> ready;
+  for (HloInstruction* instr : instructions) {
+    int64_t deps = instr->unique_operands().size() +
+                   instr->control_predecessors().size();
+    unscheduled_deps[instr] = deps;
+    if (deps == 0) {
+      ready.insert(position[instr]);
+    }
+  }
+
+  HloInstructionSequence result;
+  LiveBytesTracker tracker(pointer_size);
+  double now_seconds = 0.0;
+  // The time each in-flight collective is estimated to finish at, by done.
+  absl::flat_hash_map<const HloInstruction*, double> done_seconds;
+  while (!ready.empty()) {
+    // Picks the first ready instruction of the input order, preferring
+    // collective starts, then the dones of finished collectives, then the
+    // other instructions that fit into the memory limit.
+    std::optional<int64_t> start, finished_done, first_done, compute;
+    for (int64_t i : ready) {
+      const HloInstruction& instr = *instructions[i];
+      if (IsAsyncCollectiveStart(instr)) {
+        start = i;
+        break;
+      }
+      if (IsAsyncCollectiveDone(instr) && done_seconds.contains(&instr)) {
+        if (done_seconds[&instr] <= now_seconds && !finished_done) {
+          finished_done = i;
+        }
+        if (!first_done || done_seconds[&instr] <
+                               done_seconds[instructions[*first_done]]) {
+          first_done = i;
+        }
+      } else if (!compute &&
+                 tracker.LiveBytesAfter(instr) <= memory_limit) {
+        compute = i;
+      }
+    }
+    int64_t next = *ready.begin();
+    if (start) {
+      next = *start;
+    } else if (finished_done) {
+      next = *finished_done;
+    } else if (compute) {
+      next = *compute;
+    } else if (first_done) {
+      next = *first_done;
+    }
+    ready.erase(next);
+    HloInstruction* instr = instructions[next];
+    result.push_back(instr);
+    tracker.Schedule(*instr);
+
+    if (IsAsyncCollectiveStart(*instr)) {
+      for (const HloInstruction* user : instr->users()) {
+        if (IsAsyncCollectiveDone(*user)) {
+          done_seconds[user] =
+              now_seconds + CollectiveSeconds(*instr, pointer_size);
+        }
+      }
+    } else if (done_seconds.contains(instr)) {
+      now_seconds = std::max(now_seconds, done_seconds[instr]);
+    } else {
+      now_seconds += cost_analysis.optimal_seconds(*instr);
+    }
+
+    auto release = [&](const HloInstruction* successor) {
+      if (--unscheduled_deps[successor] == 0) {
+        ready.insert(position[successor]);
+      }
+    };
+    for (const HloInstruction* user : instr->users()) {
+      release(user);
+    }
+    for (const HloInstruction* successor : instr->control_successors()) {
+      release(successor);
+    }
+  }
+  CHECK_EQ(result.size(), instructions.size());
+  return result;
+}
+
 }  // end namespace
 
 GpuHloSchedule::GpuHloSchedule() {}
 
 /* static */
+StatusOr<HloSchedule> GpuHloSchedule::BuildSequentialSchedule(
+    const HloModule* module, int64_t pointer_size) {
+  // All kernels are launched on a single stream, so there's no loss of
+  // concurrency by optimizing for minimal memory usage, except for the
+  // asynchronous collectives.
+  MemorySchedulerPostprocessor postprocessor =
+      PostprocessorToScheduleAsEarlyOrLateAsPossible;
+  HloCostAnalysis::Options options{[pointer_size](const Shape& shape) {
+    return ShapeUtil::ByteSizeOf(shape, pointer_size);
+  }};
+  options.set_flops_per_second(kFlopsPerSecond);
+  options.set_bytes_per_second(kBytesPerSecond);
+  GpuHloCostAnalysis cost_analysis(options);
+  if (module->config()
+          .debug_options()
+          .xla_gpu_enable_latency_hiding_scheduler()) {
+    for (const HloComputation* computation : module->computations()) {
+      if (!computation->IsFusionComputation()) {
+        TF_RETURN_IF_ERROR(computation->Accept(&cost_analysis));
+      }
+    }
+    postprocessor = [&](const HloInstructionSequence& input) {
+      return PostprocessorToScheduleAsEarlyOrLateAsPossible(
+          ScheduleToHideLatency(input, cost_analysis, pointer_size));
+    };
+  }
+  return ScheduleModule(
+      module,
+      [pointer_size](const BufferValue& buffer) {
+        return ShapeUtil::ByteSizeOf(buffer.shape(), pointer_size);
+      },
+      ComputationSchedulerToModuleScheduler(DefaultMemoryScheduler,
+                                            postprocessor));
+}
+
 StatusOr<std::unique_ptr<GpuHloSchedule>> GpuHloSchedule::Build(
     const HloModule* module, const StreamAssignment& stream_assignment,
     int64_t pointer_size) {
@@ -318,22 +568,19 @@ StatusOr<std::unique_ptr<GpuHloSchedule>> GpuHloSchedule::Build(
   // Initialize thunk_launch_order_, the total order of thunk launches.
   HloComputation* entry_computation = module->entry_computation();
   if (stream_assignment.StreamCount() == 1) {
-    // All kernels are launched on a single stream, so there's no loss of
-    // concurrency by optimizing for minimal memory usage.
-    TF_ASSIGN_OR_RETURN(
-        HloSchedule sequences,
-        ScheduleModule(
-            module,
-            [pointer_size](const BufferValue& buffer) {
-              return ShapeUtil::ByteSizeOf(buffer.shape(), pointer_size);
-            },
-            ComputationSchedulerToModuleScheduler(
-                DefaultMemoryScheduler,
-                PostprocessorToScheduleAsEarlyOrLateAsPossible)));
+    // A schedule of the module, e.g. the one rematerialization fit into device
+    // memory, is kept as long as it is still valid.
+    std::optional<HloSchedule> sequences;
+    if (module->has_schedule() && module->schedule().Verify().ok()) {
+      sequences = module->schedule();
+    } else {
+      TF_ASSIGN_OR_RETURN(sequences,
+                          BuildSequentialSchedule(module, pointer_size));
+    }
     schedule->thunk_launch_order_ =
-        sequences.sequence(entry_computation).instructions();
+        sequences->sequence(entry_computation).instructions();
     schedule->hlo_ordering_ =
-        std::make_unique<SequentialHloOrdering>(sequences);
+        std::make_unique<SequentialHloOrdering>(*sequences);
   } else {
     // BFS tends to increase concurrency, but also increases memory usage.
     BFSLaunchOrder(entry_computation, &schedule->thunk_launch_order_);
@@ -22,6 +22,7 @@ limitations under the License.
 #include "tensorflow/compiler/xla/service/gpu/stream_assignment.h"
 #include "tensorflow/compiler/xla/service/hlo_module.h"
 #include "tensorflow/compiler/xla/service/hlo_ordering.h"
+#include "tensorflow/compiler/xla/service/hlo_schedule.h"
 #include "tensorflow/compiler/xla/statusor.h"
 
 namespace xla {
@@ -44,6 +45,11 @@ class GpuHloSchedule {
       const HloModule* module, const StreamAssignment& stream_assignment,
       int64_t pointer_size);
 
+  // Returns the sequential schedule that Build uses when all thunks run on a
+  // single stream and the module has no valid schedule of its own.
+  static StatusOr<HloSchedule> BuildSequentialSchedule(const HloModule* module,
+                                                       int64_t pointer_size);
+
   // Returns the total order of thunk launches, represented in terms of HLO
   // instructions.
   const std::vector<HloInstruction*>& ThunkLaunchOrder() const {
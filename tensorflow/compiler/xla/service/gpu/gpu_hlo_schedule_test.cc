@@ -481,5 +481,73 @@ TEST_F(GpuHloScheduleTest, AsyncAllReduce) {
   EXPECT_TRUE(order->ExecutesBefore(all_reduce_done, add4));
 }
 
+TEST_F(GpuHloScheduleTest, LatencyHidingScheduler) {
+  const char* hlo_text = R"(
+HloModule LatencyHidingScheduler
+
+add {
+  x = f32[] parameter(0)
+  y = f32[] parameter(1)
+  ROOT add = f32[] add(x, y)
+}
+
+ENTRY main {
+  p0 = f32[1024,1024] parameter(0)
+  p1 = f32[1024,1024] parameter(1)
+  start = f32[1024,1024] all-reduce-start(p0), to_apply=add
+  done = f32[1024,1024] all-reduce-done(start)
+  add = f32[1024,1024] add(done, done)
+  dot = f32[1024,1024] dot(p1, p1), lhs_contracting_dims={1}, rhs_contracting_dims={0}
+  ROOT tuple = (f32[1024,1024], f32[1024,1024]) tuple(add, dot)
+})";
+  HloModuleConfig config;
+  DebugOptions debug_options = GetDebugOptionsForTest();
+  debug_options.set_xla_gpu_enable_latency_hiding_scheduler(true);
+  config.set_debug_options(debug_options);
+  TF_ASSERT_OK_AND_ASSIGN(auto module,
+                          ParseAndReturnVerifiedModule(hlo_text, config));
+
+  std::unique_ptr<StreamAssignment> streams = AssignStreams(*module);
+  ASSERT_EQ(streams->StreamCount(), 1);
+  std::unique_ptr<GpuHloSchedule> schedule =
+      BuildGpuHloSchedule(module.get(), *streams);
+  std::unique_ptr<HloOrdering> order = schedule->ConsumeHloOrdering();
+  VLOG(2) << order->ToString();
+
+  // The dot doesn't depend on the all-reduce, so it runs while the all-reduce
+  // is in flight.
+  HloInstruction* start = FindInstruction(module.get(), "start");
+  HloInstruction* done = FindInstruction(module.get(), "done");
+  HloInstruction* dot = FindInstruction(module.get(), "dot");
+  EXPECT_TRUE(order->ExecutesBefore(start, dot));
+  EXPECT_TRUE(order->ExecutesBefore(dot, done));
+}
+
+// A valid schedule of the module, e.g. the one set by rematerialization, is
+// kept instead of being recomputed.
+TEST_F(GpuHloScheduleTest, KeepsModuleSchedule) {
+  const char* hlo_text = R"(
+HloModule KeepsModuleSchedule, is_scheduled=true
+
+ENTRY main {
+  p0 = f32[2,2] parameter(0)
+  p1 = f32[2,2] parameter(1)
+  exp = f32[2,2] exponential(p1)
+  negate = f32[2,2] negate(p0)
+  ROOT tuple = (f32[2,2], f32[2,2]) tuple(negate, exp)
+})";
+  TF_ASSERT_OK_AND_ASSIGN(auto module, ParseAndReturnVerifiedModule(hlo_text));
+  ASSERT_TRUE(module->has_schedule());
+
+  std::unique_ptr<StreamAssignment> streams = AssignStreams(*module);
+  ASSERT_EQ(streams->StreamCount(), 1);
+  std::unique_ptr<GpuHloSchedule> schedule =
+      BuildGpuHloSchedule(module.get(), *streams);
+  EXPECT_EQ(schedule->ThunkLaunchOrder(),
+            module->schedule()
+                .sequence(module->entry_computation())
+                .instructions());
+}
+
 }  // namespace gpu
 }  // namespace xla
@@ -3179,6 +3179,43 @@ Status IrEmitterUnnested::EmitAllReduceDone(mlir::Operation* op) {
   return OkStatus();
 }
 
+Status IrEmitterUnnested::EmitCopyStart(mlir::Operation* op) {
+  auto start_op = mlir::cast<mlir::lmhlo_gpu::CopyStartOp>(op);
+  TF_ASSIGN_OR_RETURN(BufferAllocation::Slice source,
+                      GetAllocationSlice(start_op.getOperand()));
+  TF_ASSIGN_OR_RETURN(BufferAllocation::Slice destination,
+                      GetAllocationSlice(start_op.getOutput()));
+  const bool source_on_host = source.allocation()->color() == kHostMemorySpace;
+  const bool destination_on_host =
+      destination.allocation()->color() == kHostMemorySpace;
+  if (source_on_host == destination_on_host) {
+    return Unimplemented(
+        "copy-start is only implemented between device and host memory: %s",
+        MlirToString(op));
+  }
+  auto thunk = std::make_unique<CopyStartThunk>(
+      GetThunkInfo(op), source, destination,
+      ByteSizeOf(GetShape(start_op.getOperand())),
+      /*to_host=*/destination_on_host);
+  TF_RET_CHECK(copy_start_thunks_.emplace(op, thunk.get()).second)
+      << "copy-start with this unique ID already seen";
+  AddThunkToThunkSequence(std::move(thunk));
+  return OkStatus();
+}
+
+Status IrEmitterUnnested::EmitCopyDone(mlir::Operation* op) {
+  auto done_op = mlir::cast<mlir::lmhlo_gpu::CopyDoneOp>(op);
+  auto start_op =
+      done_op.getToken().getDefiningOp<mlir::lmhlo_gpu::CopyStartOp>();
+  auto it = copy_start_thunks_.find(start_op);
+  TF_RET_CHECK(it != copy_start_thunks_.end())
+      << "couldn't find thunk for copy-start op";
+  AddThunkToThunkSequence(
+      std::make_unique<CopyDoneThunk>(GetThunkInfo(op), *it->second));
+  copy_start_thunks_.erase(it);
+  return OkStatus();
+}
+
 StatusOr<std::vector<ShapedSlice>> IrEmitterUnnested::GetShapedSlices(
     mlir::Operation::operand_range operands) {
   std::vector<ShapedSlice> shaped_slices;
@@ -5752,6 +5789,14 @@ Status IrEmitterUnnested::EmitOp(mlir::Operation* op) {
     return EmitAllReduceDone(op);
   }
 
+  if (mlir::isa<mlir::lmhlo_gpu::CopyStartOp>(op)) {
+    return EmitCopyStart(op);
+  }
+
+  if (mlir::isa<mlir::lmhlo_gpu::CopyDoneOp>(op)) {
+    return EmitCopyDone(op);
+  }
+
   if (mlir::isa<mlir::lmhlo::ReduceScatterOp>(op)) {
     return EmitNcclThunk<NcclReduceScatterThunk, mlir::lmhlo::ReduceScatterOp>(
         op);
@@ -5794,6 +5839,8 @@ Status IrEmitterUnnested::EmitOp(mlir::Operation* op) {
 Status IrEmitterUnnested::EmitLmhloRegion(mlir::Region* region) {
   for (mlir::Operation& op : llvm::make_early_inc_range(region->front())) {
     TF_RETURN_IF_ERROR(EmitOp(&op));
+    thunk_op_names_.resize(thunk_sequence_.size(),
+                           mlir::GetNameFromLoc(op.getLoc()));
   }
   return OkStatus();
 }
@@ -23,6 +23,7 @@ limitations under the License.
 #include "tensorflow/compiler/xla/service/gpu/ir_emission_utils.h"
 #include "tensorflow/compiler/xla/service/gpu/ir_emitter.h"
 #include "tensorflow/compiler/xla/service/gpu/kernel_mapping_scheme.h"
+#include "tensorflow/compiler/xla/service/gpu/copy_thunk.h"
 #include "tensorflow/compiler/xla/service/gpu/nccl_all_reduce_thunk.h"
 #include "tensorflow/compiler/xla/service/gpu/sequential_thunk.h"
 #include "tensorflow/compiler/xla/service/gpu/thunk.h"
@@ -157,6 +158,12 @@ class IrEmitterUnnested : public IrEmitter {
     return std::make_unique<ThunkSequence>(std::move(thunk_sequence_));
   }
 
+  // Returns the name of the op each thunk was emitted for by EmitLmhloRegion,
+  // in the order of the thunk sequence.
+  const std::vector<std::string>& thunk_op_names() const {
+    return thunk_op_names_;
+  }
+
   // Emits code for the given LMHLO region.
   //
   // Also populates related information to 'ir_emitter_context_' for
@@ -203,6 +210,8 @@ class IrEmitterUnnested : public IrEmitter {
   template <typename NcclThunkType, typename OpTy>
   Status EmitNcclThunk(mlir::Operation* op);
   Status EmitAllReduceDone(mlir::Operation* op);
+  Status EmitCopyStart(mlir::Operation* op);
+  Status EmitCopyDone(mlir::Operation* op);
 
   template <typename ThunkType, typename OpT>
   Status EmitReplicaOrPartitionId(mlir::Operation* op);
@@ -723,11 +732,15 @@ class IrEmitterUnnested : public IrEmitter {
 
   // The thunk sequence this IrEmitter generates for the input computation.
   ThunkSequence thunk_sequence_;
+  std::vector<std::string> thunk_op_names_;
 
   // Maps all-reduce-start ops to their thunk so done can access the thunk.
   absl::flat_hash_map<mlir::Operation*, NcclAllReduceStartThunk*>
       all_reduce_start_thunks_;
 
+  // Maps copy-start ops to their thunk so done can access the thunk.
+  absl::flat_hash_map<mlir::Operation*, CopyStartThunk*> copy_start_thunks_;
+
   // Begin optional members for XLA HLO -> LMHLO:
   absl::flat_hash_map<const mlir::Region*, std::unique_ptr<HloModule>>
       scratch_nested_computations_;
@@ -22,6 +22,10 @@ limitations under the License.
 #include <utility>
 
 #include "absl/base/call_once.h"
+#include "absl/container/flat_hash_set.h"
+#include "absl/strings/match.h"
+#include "absl/strings/str_split.h"
+#include "absl/synchronization/mutex.h"
 #include "llvm/IRReader/IRReader.h"
 #include "llvm/Support/SourceMgr.h"
 #include "tensorflow/compiler/xla/service/algebraic_simplifier.h"
@@ -34,6 +38,8 @@ limitations under the License.
 #include "tensorflow/compiler/xla/service/gpu/cusolver_rewriter.h"
 #include "tensorflow/compiler/xla/service/gpu/gemm_algorithm_picker.h"
 #include "tensorflow/compiler/xla/service/gpu/gpu_asm_opts_util.h"
+#include "tensorflow/compiler/xla/service/gpu/gpu_autotuning.pb.h"
+#include "tensorflow/compiler/xla/service/gpu/gpu_conv_algorithm_picker.h"
 #include "tensorflow/compiler/xla/service/gpu/gpu_conv_padding_legalization.h"
 #include "tensorflow/compiler/xla/service/gpu/gpu_conv_rewriter.h"
 #include "tensorflow/compiler/xla/service/gpu/gpu_executable.h"
@@ -57,6 +63,7 @@ limitations under the License.
 #include "tensorflow/compiler/xla/util.h"
 #include "tensorflow/core/lib/core/status.h"
 #include "tensorflow/core/lib/io/path.h"
+#include "tensorflow/core/platform/env.h"
 #include "tensorflow/core/profiler/lib/traceme.h"
 #include "tensorflow/stream_executor/cuda/cuda_diagnostics.h"
 #include "tensorflow/stream_executor/gpu/asm_compiler.h"
@@ -104,9 +111,73 @@ Status NVPTXCompiler::OptimizeHloConvolutionCanonicalization(
   return OkStatus();
 }
 
+namespace {
+// Bumped when the keys of the autotuning caches change.
+constexpr int kAutotuneResultsVersion = 1;
+
+bool IsTextProtoPath(absl::string_view path) {
+  return absl::EndsWith(path, ".pbtxt");
+}
+
+// Loads the files in xla_gpu_load_autotune_results_from into the caches of the
+// algorithm pickers.  Each file is loaded once per process.
+Status LoadAutotuneResults(const DebugOptions& debug_options) {
+  static absl::Mutex mu(absl::kConstInit);
+  static auto* loaded_paths ABSL_GUARDED_BY(mu) =
+      new absl::flat_hash_set<std::string>();
+
+  absl::MutexLock lock(&mu);
+  for (absl::string_view path :
+       absl::StrSplit(debug_options.xla_gpu_load_autotune_results_from(), ',',
+                      absl::SkipEmpty())) {
+    if (loaded_paths->contains(path)) continue;
+    AutotuneResults results;
+    tensorflow::Env* env = tensorflow::Env::Default();
+    std::string path_str(path);
+    TF_RETURN_IF_ERROR(IsTextProtoPath(path)
+                           ? tensorflow::ReadTextProto(env, path_str, &results)
+                           : tensorflow::ReadBinaryProto(env, path_str,
+                                                         &results));
+    if (results.version() != kAutotuneResultsVersion) {
+      return InvalidArgument(
+          "Autotuning results in %s have version %d, expected version %d.",
+          path, results.version(), kAutotuneResultsVersion);
+    }
+    VLOG(1) << "Loaded " << results.convs_size() << " convolution and "
+            << results.dots_size() << " GEMM autotuning results from " << path;
+    GpuConvAlgorithmPicker::LoadAutotuneResults(results);
+    GemmAlgorithmPicker::LoadAutotuneResults(results);
+    loaded_paths->insert(std::move(path_str));
+  }
+  return OkStatus();
+}
+
+// Writes the autotuning results of the process to
+// xla_gpu_dump_autotune_results_to.
+Status DumpAutotuneResults(const DebugOptions& debug_options) {
+  const std::string& path = debug_options.xla_gpu_dump_autotune_results_to();
+  if (path.empty()) return OkStatus();
+  AutotuneResults results;
+  results.set_version(kAutotuneResultsVersion);
+  GpuConvAlgorithmPicker::WriteAutotuneResults(&results);
+  GemmAlgorithmPicker::WriteAutotuneResults(&results);
+
+  // Serializes concurrent compilations that write the same file.
+  static absl::Mutex mu(absl::kConstInit);
+  absl::MutexLock lock(&mu);
+  tensorflow::Env* env = tensorflow::Env::Default();
+  return IsTextProtoPath(path) ? tensorflow::WriteTextProto(env, path, results)
+                               : tensorflow::WriteBinaryProto(env, path,
+                                                              results);
+}
+}  // namespace
+
 Status NVPTXCompiler::OptimizeHloPostLayoutAssignment(
     HloModule* hlo_module, se::StreamExecutor* stream_exec,
     se::DeviceMemoryAllocator* device_allocator) {
+  const DebugOptions& debug_options = hlo_module->config().debug_options();
+  TF_RETURN_IF_ERROR(LoadAutotuneResults(debug_options));
+
   HloPassPipeline pre_pipeline("nvptx post-layout_assignment part 1");
 
   // This needs to run before GemmRewriter, which is part of
@@ -152,7 +223,7 @@ Status NVPTXCompiler::OptimizeHloPostLayoutAssignment(
 
   TF_RETURN_IF_ERROR(post_pipeline.Run(hlo_module).status());
 
-  return OkStatus();
+  return DumpAutotuneResults(debug_options);
 }
 
 namespace {
@@ -15,14 +15,18 @@ limitations under the License.
 
 #include "tensorflow/compiler/xla/service/gpu/stream_assignment.h"
 
+#include <algorithm>
+#include <limits>
 #include <memory>
+#include <vector>
 
-#include "absl/container/flat_hash_set.h"
+#include "absl/algorithm/container.h"
+#include "absl/container/flat_hash_map.h"
 #include "tensorflow/compiler/xla/map_util.h"
 #include "tensorflow/compiler/xla/service/gpu/cublas_cudnn.h"
-#include "tensorflow/compiler/xla/service/gpu/ir_emission_utils.h"
+#include "tensorflow/compiler/xla/service/gpu/gpu_hlo_cost_analysis.h"
 #include "tensorflow/compiler/xla/service/hlo_computation.h"
-#include "tensorflow/compiler/xla/service/hlo_reachability.h"
+#include "tensorflow/compiler/xla/shape_util.h"
 
 namespace xla {
 namespace gpu {
@@ -47,38 +51,194 @@ void StreamAssignment::AssignStreamToHlo(const HloInstruction* hlo,
 
 namespace {
 
-// Returns whether the two HLOs can run concurrently, i.e., neither is a
-// transitive consumer of the other.
-bool CanRunConcurrently(const HloInstruction& a, const HloInstruction& b,
-                        const HloReachabilityMap& reachability) {
-  return !reachability.IsConnected(&a, &b);
-}
-
 constexpr int kInvalidStreamNum = -1;
 //  Returns true iff `stream_num` is an invalid stream number.
 inline bool IsStreamNumValid(int stream_num) {
   return stream_num != kInvalidStreamNum;
 }
 
-// Returns which existing stream to assign to `hlo`, or -1 if a stream is not
-// needed. `stream_assignment` is the existing stream assignment for all
-// instructions topologically before `hlo`. `seen_gemms` contains all GEMMs that
-// are topologically before `hlo`.
-int ComputeStreamToAssign(
-    const HloInstruction& hlo, const StreamAssignment& stream_assignment,
-    const HloReachabilityMap& reachability,
-    const std::vector<const HloInstruction*>& seen_gemms) {
-  if (hlo.opcode() == HloOpcode::kParameter ||
-      hlo.opcode() == HloOpcode::kConstant) {
-    // kParameter and kConstant do not need a thunk.
-    return kInvalidStreamNum;
+// Nominal device rates of the cost model. Only the relative run times of the
+// instructions matter for the assignment, so they need not match the device.
+constexpr float kFlopsPerSecond = 1e13;
+constexpr float kBytesPerSecond = 5e11;
+// The cost of making a stream wait for an instruction on another stream.
+constexpr double kCrossStreamWaitSeconds = 5e-6;
+// Instructions that take less than this stay on the stream of their operands,
+// where they don't need to wait for an event.
+constexpr double kMinSecondsOnNewStream = 10e-6;
+// The maximum number of streams compute instructions are spread over.
+constexpr int kMaxComputeStreams = 4;
+
+// Returns whether `hlo` is a synchronous collective. The asynchronous ones
+// already run on the async comms stream, and the main stream only launches and
+// waits for them in the order of the schedule.
+bool IsSyncCollective(const HloInstruction& hlo) {
+  switch (hlo.opcode()) {
+    case HloOpcode::kAllGather:
+    case HloOpcode::kAllReduce:
+    case HloOpcode::kAllToAll:
+    case HloOpcode::kCollectivePermute:
+    case HloOpcode::kReduceScatter:
+      return true;
+    default:
+      return false;
   }
+}
 
-  const auto& debug_options = hlo.GetModule()->config().debug_options();
-  if (!debug_options.xla_gpu_disable_multi_streaming()) {
-    LOG(ERROR) << "Multi streaming is not supported";
+// Returns whether `hlo` has to run on the main stream, in program order with
+// the other such instructions: infeeds, outfeeds, host transfers and custom
+// calls may have side effects that the HLO dependencies don't capture, and
+// the asynchronous collectives and copies are scheduled to overlap on the main
+// stream.
+bool MustRunOnMainStream(const HloInstruction& hlo) {
+  switch (hlo.opcode()) {
+    case HloOpcode::kCopyStart:
+    case HloOpcode::kCopyDone:
+    case HloOpcode::kAllGatherStart:
+    case HloOpcode::kAllGatherDone:
+    case HloOpcode::kAllReduceStart:
+    case HloOpcode::kAllReduceDone:
+    case HloOpcode::kCollectivePermuteStart:
+    case HloOpcode::kCollectivePermuteDone:
+      return true;
+    case HloOpcode::kCustomCall:
+      return !IsCublasGemm(hlo) && !IsCustomCallToDnnConvolution(hlo);
+    default:
+      return hlo.HasSideEffect();
+  }
+}
+
+// Assigns the instructions of a computation to streams with a greedy list
+// scheduler: each instruction goes to the stream on which the cost model
+// estimates it to finish first, given the streams its operands run on.
+// Independent instructions thus spread over several streams, while chains of
+// dependent instructions stay on one stream. Collectives run on a stream of
+// their own, in program order, so they overlap with the compute streams.
+class StreamAssigner {
+ public:
+  StreamAssigner(const HloCostAnalysis& cost_analysis,
+                 StreamAssignment* stream_assignment)
+      : cost_analysis_(cost_analysis),
+        stream_assignment_(stream_assignment),
+        compute_streams_({0}),
+        stream_free_seconds_({0.0}) {}
+
+  // Returns which stream to assign to `hlo`, or -1 if a stream is not needed.
+  // All operands of `hlo` must have been assigned.
+  int ComputeStreamToAssign(const HloInstruction& hlo) {
+    if (hlo.opcode() == HloOpcode::kParameter ||
+        hlo.opcode() == HloOpcode::kConstant) {
+      // kParameter and kConstant do not need a thunk.
+      return kInvalidStreamNum;
+    }
+    if (IsSyncCollective(hlo)) {
+      if (!IsStreamNumValid(collective_stream_)) {
+        collective_stream_ = AddStream();
+      }
+      return collective_stream_;
+    }
+    if (MustRunOnMainStream(hlo)) {
+      return 0;
+    }
+
+    if (cost_analysis_.optimal_seconds(hlo) < kMinSecondsOnNewStream) {
+      // Follows the compute operand that is ready last.
+      int stream_num = 0;
+      double finish_seconds = -1.0;
+      for (const HloInstruction* operand : hlo.operands()) {
+        auto it = finish_seconds_.find(operand);
+        if (it != finish_seconds_.end() && it->second > finish_seconds &&
+            stream_assignment_->StreamNumberForHlo(*operand) !=
+                collective_stream_) {
+          stream_num = stream_assignment_->StreamNumberForHlo(*operand);
+          finish_seconds = it->second;
+        }
+      }
+      return stream_num;
+    }
+
+    std::vector<int> candidates = compute_streams_;
+    if (compute_streams_.size() < static_cast<size_t>(kMaxComputeStreams)) {
+      candidates.push_back(kInvalidStreamNum);
+    }
+    int best_stream = 0;
+    double best_start_seconds = std::numeric_limits<double>::infinity();
+    for (int stream_num : candidates) {
+      double start_seconds =
+          StartSeconds(hlo, stream_num, IsStreamNumValid(stream_num)
+                                            ? stream_free_seconds_[stream_num]
+                                            : 0.0);
+      if (start_seconds < best_start_seconds) {
+        best_stream = stream_num;
+        best_start_seconds = start_seconds;
+      }
+    }
+    if (!IsStreamNumValid(best_stream)) {
+      best_stream = AddStream();
+      compute_streams_.push_back(best_stream);
+    }
+    return best_stream;
+  }
+
+  // Assigns `hlo` to `stream_num` and updates the estimated stream timelines.
+  void AssignStreamToHlo(const HloInstruction& hlo, int stream_num) {
+    stream_assignment_->AssignStreamToHlo(&hlo, stream_num);
+    double finish_seconds =
+        StartSeconds(hlo, stream_num, stream_free_seconds_[stream_num]) +
+        cost_analysis_.optimal_seconds(hlo);
+    finish_seconds_[&hlo] = finish_seconds;
+    stream_free_seconds_[stream_num] = finish_seconds;
+  }
+
+ private:
+  int AddStream() {
+    stream_free_seconds_.push_back(0.0);
+    return stream_free_seconds_.size() - 1;
+  }
+
+  // Returns when `hlo` can start on `stream_num`, which is free at
+  // `free_seconds`.
+  double StartSeconds(const HloInstruction& hlo, int stream_num,
+                      double free_seconds) const {
+    double start_seconds = free_seconds;
+    auto add_dependency = [&](const HloInstruction* dependency) {
+      auto it = finish_seconds_.find(dependency);
+      if (it == finish_seconds_.end()) {
+        return;
+      }
+      double ready_seconds = it->second;
+      if (stream_assignment_->StreamNumberForHlo(*dependency) != stream_num) {
+        ready_seconds += kCrossStreamWaitSeconds;
+      }
+      start_seconds = std::max(start_seconds, ready_seconds);
+    };
+    absl::c_for_each(hlo.operands(), add_dependency);
+    absl::c_for_each(hlo.control_predecessors(), add_dependency);
+    return start_seconds;
+  }
+
+  const HloCostAnalysis& cost_analysis_;
+  StreamAssignment* stream_assignment_;
+  // The streams compute instructions are assigned to.
+  std::vector<int> compute_streams_;
+  int collective_stream_ = kInvalidStreamNum;
+  // The estimated time each stream finishes its instructions at, by stream
+  // number.
+  std::vector<double> stream_free_seconds_;
+  // The estimated time each assigned instruction finishes at.
+  absl::flat_hash_map<const HloInstruction*, double> finish_seconds_;
+};
+
+// Assigns all instructions of `computation` that need a thunk to the main
+// stream.
+void AssignMainStream(const HloComputation& computation,
+                      StreamAssignment* stream_assignment) {
+  for (const HloInstruction* hlo : computation.instructions()) {
+    if (hlo->opcode() != HloOpcode::kParameter &&
+        hlo->opcode() != HloOpcode::kConstant) {
+      stream_assignment->AssignStreamToHlo(hlo, 0);
+    }
   }
-  return 0;
 }
 
 }  // namespace
@@ -86,9 +246,27 @@ int ComputeStreamToAssign(
 std::unique_ptr<StreamAssignment> AssignStreams(const HloModule& module) {
   auto stream_assignment = std::make_unique<StreamAssignment>();
   const HloComputation& computation = *module.entry_computation();
-  std::unique_ptr<HloReachabilityMap> reachability =
-      HloReachabilityMap::Build(&computation);
-  std::vector<const HloInstruction*> seen_gemms;
+  if (module.config().debug_options().xla_gpu_disable_multi_streaming()) {
+    AssignMainStream(computation, stream_assignment.get());
+    return stream_assignment;
+  }
+
+  HloCostAnalysis::Options options{[](const Shape& shape) {
+    constexpr int64_t kPointerSize = 8;
+    return ShapeUtil::ByteSizeOf(shape, kPointerSize);
+  }};
+  options.set_flops_per_second(kFlopsPerSecond);
+  options.set_bytes_per_second(kBytesPerSecond);
+  GpuHloCostAnalysis cost_analysis(options);
+  Status status = computation.Accept(&cost_analysis);
+  if (!status.ok()) {
+    LOG(WARNING) << "Assigning a single stream, the cost analysis failed: "
+                 << status;
+    AssignMainStream(computation, stream_assignment.get());
+    return stream_assignment;
+  }
+
+  StreamAssigner assigner(cost_analysis, stream_assignment.get());
   // The execution of different RNG Hlo instructions in the same module updates
   // a common global variable. To avoid a race condition, we simply assign all
   // RNG kernels to the same stream to make them run sequentially.
@@ -102,18 +280,14 @@ std::unique_ptr<StreamAssignment> AssignStreams(const HloModule& module) {
     int stream_num = (hlo->opcode() == HloOpcode::kRng &&
                       IsStreamNumValid(stream_num_for_rng))
                          ? stream_num_for_rng
-                         : ComputeStreamToAssign(*hlo, *stream_assignment,
-                                                 *reachability, seen_gemms);
+                         : assigner.ComputeStreamToAssign(*hlo);
     if (IsStreamNumValid(stream_num)) {
-      stream_assignment->AssignStreamToHlo(hlo, stream_num);
+      assigner.AssignStreamToHlo(*hlo, stream_num);
       if (hlo->opcode() == HloOpcode::kRng &&
           !IsStreamNumValid(stream_num_for_rng)) {
         stream_num_for_rng = stream_num;
       }
     }
-    if (IsCublasGemm(*hlo) || IsMatrixMultiplication(*hlo)) {
-      seen_gemms.push_back(hlo);
-    }
   }
   return stream_assignment;
 }
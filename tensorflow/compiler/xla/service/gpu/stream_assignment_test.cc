@@ -31,19 +31,25 @@ namespace gpu {
 
 class StreamAssignmentTest : public HloTestBase {
  protected:
-  std::unique_ptr<HloModule> CreateNewVerifiedModule() {
+  HloModuleConfig MultiStreamConfig() {
     HloModuleConfig config;
     auto debug_options = GetDebugOptionsForTest();
     debug_options.set_xla_gpu_disable_multi_streaming(false);
     config.set_debug_options(debug_options);
-    return std::make_unique<HloModule>("test_module", config);
+    return config;
   }
 
-  // Pre-canned shapes.
+  std::unique_ptr<HloModule> CreateNewVerifiedModule() {
+    return std::make_unique<HloModule>("test_module", MultiStreamConfig());
+  }
+
+  // Pre-canned shapes. The dots of f32_2x2_ are too cheap to be worth another
+  // stream, those of f32_1024x1024_ are not.
   Shape f32_2x2_ = ShapeUtil::MakeShape(F32, {2, 2});
+  Shape f32_1024x1024_ = ShapeUtil::MakeShape(F32, {1024, 1024});
 };
 
-TEST_F(StreamAssignmentTest, DISABLED_SequentialMatMul) {
+TEST_F(StreamAssignmentTest, SequentialMatMul) {
   HloComputation::Builder builder("entry_computation");
   HloInstruction* x = builder.AddInstruction(HloInstruction::CreateParameter(
       /*parameter_number=*/0, f32_2x2_, /*name=*/"x"));
@@ -64,7 +70,28 @@ TEST_F(StreamAssignmentTest, DISABLED_SequentialMatMul) {
             assignment->StreamNumberForHlo(*dot2));
 }
 
-TEST_F(StreamAssignmentTest, DISABLED_ConcurrentMatMul) {
+TEST_F(StreamAssignmentTest, ConcurrentMatMul) {
+  HloComputation::Builder builder("entry_computation");
+  HloInstruction* x = builder.AddInstruction(HloInstruction::CreateParameter(
+      /*parameter_number=*/0, f32_1024x1024_, /*name=*/"x"));
+  HloInstruction* y = builder.AddInstruction(HloInstruction::CreateParameter(
+      /*parameter_number=*/1, f32_1024x1024_, /*name=*/"y"));
+  HloInstruction* dot1 =
+      builder.AddInstruction(CreateCanonicalDot(f32_1024x1024_, x, y));
+  HloInstruction* dot2 =
+      builder.AddInstruction(CreateCanonicalDot(f32_1024x1024_, y, x));
+  HloInstruction* add = builder.AddInstruction(HloInstruction::CreateBinary(
+      f32_1024x1024_, HloOpcode::kAdd, dot1, dot2));
+
+  auto module = CreateNewVerifiedModule();
+  module->AddEntryComputation(builder.Build(add));
+
+  std::unique_ptr<StreamAssignment> assignment = AssignStreams(*module);
+  EXPECT_NE(assignment->StreamNumberForHlo(*dot1),
+            assignment->StreamNumberForHlo(*dot2));
+}
+
+TEST_F(StreamAssignmentTest, ConcurrentCheapMatMul) {
   HloComputation::Builder builder("entry_computation");
   HloInstruction* x = builder.AddInstruction(HloInstruction::CreateParameter(
       /*parameter_number=*/0, f32_2x2_, /*name=*/"x"));
@@ -81,11 +108,10 @@ TEST_F(StreamAssignmentTest, DISABLED_ConcurrentMatMul) {
   module->AddEntryComputation(builder.Build(add));
 
   std::unique_ptr<StreamAssignment> assignment = AssignStreams(*module);
-  EXPECT_NE(assignment->StreamNumberForHlo(*dot1),
-            assignment->StreamNumberForHlo(*dot2));
+  EXPECT_EQ(assignment->StreamCount(), 1);
 }
 
-TEST_F(StreamAssignmentTest, DISABLED_LatticeMatMul) {
+TEST_F(StreamAssignmentTest, LatticeMatMul) {
   //      d00      -- layer 0
   //     /   \
   //   d10   d11   -- layer 1
@@ -100,26 +126,26 @@ TEST_F(StreamAssignmentTest, DISABLED_LatticeMatMul) {
   params.reserve(6);
   for (int i = 0; i < 6; ++i) {
     params.push_back(builder.AddInstruction(HloInstruction::CreateParameter(
-        i, f32_2x2_, /*name=*/absl::StrFormat("param%d", i))));
+        i, f32_1024x1024_, /*name=*/absl::StrFormat("param%d", i))));
   }
   HloInstruction* d00 = builder.AddInstruction(
-      CreateCanonicalDot(f32_2x2_, params[2], params[3]));
-  HloInstruction* d10 =
-      builder.AddInstruction(CreateCanonicalDot(f32_2x2_, params[1], d00));
-  HloInstruction* d11 =
-      builder.AddInstruction(CreateCanonicalDot(f32_2x2_, d00, params[4]));
-  HloInstruction* d20 =
-      builder.AddInstruction(CreateCanonicalDot(f32_2x2_, params[0], d10));
-  HloInstruction* d21 =
-      builder.AddInstruction(CreateCanonicalDot(f32_2x2_, d10, d11));
-  HloInstruction* d22 =
-      builder.AddInstruction(CreateCanonicalDot(f32_2x2_, d11, params[5]));
-  HloInstruction* d30 =
-      builder.AddInstruction(CreateCanonicalDot(f32_2x2_, d20, d21));
-  HloInstruction* d31 =
-      builder.AddInstruction(CreateCanonicalDot(f32_2x2_, d21, d22));
-  HloInstruction* d40 =
-      builder.AddInstruction(CreateCanonicalDot(f32_2x2_, d30, d31));
+      CreateCanonicalDot(f32_1024x1024_, params[2], params[3]));
+  HloInstruction* d10 = builder.AddInstruction(
+      CreateCanonicalDot(f32_1024x1024_, params[1], d00));
+  HloInstruction* d11 = builder.AddInstruction(
+      CreateCanonicalDot(f32_1024x1024_, d00, params[4]));
+  HloInstruction* d20 = builder.AddInstruction(
+      CreateCanonicalDot(f32_1024x1024_, params[0], d10));
+  HloInstruction* d21 = builder.AddInstruction(
+      CreateCanonicalDot(f32_1024x1024_, d10, d11));
+  HloInstruction* d22 = builder.AddInstruction(
+      CreateCanonicalDot(f32_1024x1024_, d11, params[5]));
+  HloInstruction* d30 = builder.AddInstruction(
+      CreateCanonicalDot(f32_1024x1024_, d20, d21));
+  HloInstruction* d31 = builder.AddInstruction(
+      CreateCanonicalDot(f32_1024x1024_, d21, d22));
+  HloInstruction* d40 = builder.AddInstruction(
+      CreateCanonicalDot(f32_1024x1024_, d30, d31));
 
   auto module = CreateNewVerifiedModule();
   module->AddEntryComputation(builder.Build(d40));
@@ -140,5 +166,84 @@ TEST_F(StreamAssignmentTest, DISABLED_LatticeMatMul) {
             assignment->StreamNumberForHlo(*d31));
 }
 
+TEST_F(StreamAssignmentTest, CheapOpFollowsOperand) {
+  const char* hlo_text = R"(
+HloModule CheapOpFollowsOperand
+
+ENTRY main {
+  p0 = f32[1024,1024] parameter(0)
+  p1 = f32[1024,1024] parameter(1)
+  dot0 = f32[1024,1024] dot(p0, p1), lhs_contracting_dims={1}, rhs_contracting_dims={0}
+  dot1 = f32[1024,1024] dot(p1, p0), lhs_contracting_dims={1}, rhs_contracting_dims={0}
+  slice0 = f32[2,2] slice(dot0), slice={[0:2], [0:2]}
+  slice1 = f32[2,2] slice(dot1), slice={[0:2], [0:2]}
+  ROOT tuple = (f32[2,2], f32[2,2]) tuple(slice0, slice1)
+})";
+  TF_ASSERT_OK_AND_ASSIGN(auto module,
+                          ParseAndReturnVerifiedModule(hlo_text,
+                                                       MultiStreamConfig()));
+  std::unique_ptr<StreamAssignment> assignment = AssignStreams(*module);
+  auto stream = [&](absl::string_view name) {
+    return assignment->StreamNumberForHlo(*FindInstruction(module.get(), name));
+  };
+  EXPECT_NE(stream("dot0"), stream("dot1"));
+  EXPECT_EQ(stream("dot0"), stream("slice0"));
+  EXPECT_EQ(stream("dot1"), stream("slice1"));
+}
+
+TEST_F(StreamAssignmentTest, CollectivesOverlapCompute) {
+  const char* hlo_text = R"(
+HloModule CollectivesOverlapCompute
+
+add {
+  x = f32[] parameter(0)
+  y = f32[] parameter(1)
+  ROOT add = f32[] add(x, y)
+}
+
+ENTRY main {
+  p0 = f32[1024,1024] parameter(0)
+  p1 = f32[1024,1024] parameter(1)
+  dot0 = f32[1024,1024] dot(p0, p1), lhs_contracting_dims={1}, rhs_contracting_dims={0}
+  all-reduce0 = f32[1024,1024] all-reduce(dot0), to_apply=add
+  dot1 = f32[1024,1024] dot(dot0, p1), lhs_contracting_dims={1}, rhs_contracting_dims={0}
+  all-reduce1 = f32[1024,1024] all-reduce(dot1), to_apply=add
+  ROOT tuple = (f32[1024,1024], f32[1024,1024]) tuple(all-reduce0, all-reduce1)
+})";
+  TF_ASSERT_OK_AND_ASSIGN(auto module,
+                          ParseAndReturnVerifiedModule(hlo_text,
+                                                       MultiStreamConfig()));
+  std::unique_ptr<StreamAssignment> assignment = AssignStreams(*module);
+  auto stream = [&](absl::string_view name) {
+    return assignment->StreamNumberForHlo(*FindInstruction(module.get(), name));
+  };
+  // The all-reduces run in program order on a stream of their own.
+  EXPECT_EQ(stream("all-reduce0"), stream("all-reduce1"));
+  EXPECT_NE(stream("dot1"), stream("all-reduce0"));
+  EXPECT_EQ(stream("dot0"), stream("dot1"));
+}
+
+TEST_F(StreamAssignmentTest, DisabledMultiStreaming) {
+  HloComputation::Builder builder("entry_computation");
+  HloInstruction* x = builder.AddInstruction(HloInstruction::CreateParameter(
+      /*parameter_number=*/0, f32_1024x1024_, /*name=*/"x"));
+  HloInstruction* y = builder.AddInstruction(HloInstruction::CreateParameter(
+      /*parameter_number=*/1, f32_1024x1024_, /*name=*/"y"));
+  HloInstruction* dot1 =
+      builder.AddInstruction(CreateCanonicalDot(f32_1024x1024_, x, y));
+  HloInstruction* dot2 =
+      builder.AddInstruction(CreateCanonicalDot(f32_1024x1024_, y, x));
+  builder.AddInstruction(HloInstruction::CreateTuple({dot1, dot2}));
+
+  auto module =
+      std::make_unique<HloModule>("test_module", GetModuleConfigForTest());
+  module->AddEntryComputation(builder.Build());
+
+  std::unique_ptr<StreamAssignment> assignment = AssignStreams(*module);
+  EXPECT_EQ(assignment->StreamCount(), 1);
+  EXPECT_FALSE(assignment->HasStreamAssigned(*x));
+  EXPECT_EQ(assignment->StreamNumberForHlo(*dot2), 0);
+}
+
 }  // namespace gpu
 }  // namespace xla
@@ -17,8 +17,10 @@ limitations under the License.
 
 #include <memory>
 #include <random>
+#include <string>
 #include <utility>
 
+#include "absl/strings/str_cat.h"
 #include "tensorflow/compiler/xla/layout_util.h"
 #include "tensorflow/compiler/xla/service/hlo_computation.h"
 #include "tensorflow/compiler/xla/service/hlo_instruction.h"
@@ -328,6 +330,34 @@ absl::Mutex& GetGpuMutex(const se::StreamExecutor* stream_exec) {
   return it->second;
 }
 
+std::string GetDeviceIdentifier(se::StreamExecutor* stream_exec) {
+  const se::DeviceDescription& desc = stream_exec->GetDeviceDescription();
+  std::string arch;
+  if (stream_exec->platform_kind() == se::PlatformKind::kROCm) {
+    arch = desc.rocm_compute_capability().gcn_arch_name();
+  } else {
+    se::CudaComputeCapability cc = desc.cuda_compute_capability();
+    arch = absl::StrCat("sm_", cc.major, cc.minor);
+  }
+  std::string dnn_version = "none";
+  if (auto* dnn = stream_exec->AsDnn()) {
+    StatusOr<se::dnn::VersionInfo> version = dnn->GetVersion();
+    if (version.ok()) {
+      dnn_version = absl::StrCat(version->major_version(), ".",
+                                 version->minor_version(), ".",
+                                 version->patch());
+    }
+  }
+  std::string blas_version = "none";
+  if (auto* blas = stream_exec->AsBlas()) {
+    (void)blas->GetVersion(&blas_version);
+  }
+  return absl::StrCat(desc.name(), " ", arch,
+                      " driver: ", desc.driver_version(),
+                      " runtime: ", desc.runtime_version(),
+                      " dnn: ", dnn_version, " blas: ", blas_version);
+}
+
 StatusOr<std::unique_ptr<se::KernelBase>> CreateKernel(
     absl::string_view kernel_name, uint64_t num_args, absl::string_view ptx,
     absl::Span<const uint8_t> cubin_data, se::StreamExecutor* stream_exec) {
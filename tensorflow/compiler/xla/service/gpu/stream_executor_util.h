@@ -16,6 +16,8 @@ limitations under the License.
 #ifndef TENSORFLOW_COMPILER_XLA_SERVICE_GPU_STREAM_EXECUTOR_UTIL_H_
 #define TENSORFLOW_COMPILER_XLA_SERVICE_GPU_STREAM_EXECUTOR_UTIL_H_
 
+#include <string>
+
 #include "absl/strings/string_view.h"
 #include "absl/types/span.h"
 #include "tensorflow/compiler/xla/layout.h"
@@ -72,6 +74,11 @@ FindVectorizedFeatureDims(const ConvolutionDimensionNumbers& dnums,
 // device while another thread is using it.
 absl::Mutex& GetGpuMutex(const se::StreamExecutor* stream_exec);
 
+// Returns a string that identifies the model of the device of `stream_exec`
+// and the versions of the driver, runtime, DNN and BLAS libraries it uses.
+// Autotuning results are only reused on devices with the same identifier.
+std::string GetDeviceIdentifier(se::StreamExecutor* stream_exec);
+
 // Creates a kernel with a provided name, based from provided PTX in ptx.
 // The kernel should be executed using the provided executor.
 // The argument cubin_data represents compiled PTX and may be left empty.
@@ -0,0 +1,116 @@
+/* Copyright 2022 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include <memory>
+#include <utility>
+
+#include "tensorflow/compiler/xla/literal_util.h"
+#include "tensorflow/compiler/xla/service/gpu/tests/gpu_codegen_test.h"
+#include "tensorflow/compiler/xla/service/hlo_module_config.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace xla {
+namespace gpu {
+namespace {
+
+class CudaGraphTest : public GpuCodegenTest {
+  DebugOptions GetDebugOptionsForTest() override {
+    DebugOptions debug_options = GpuCodegenTest::GetDebugOptionsForTest();
+    debug_options.set_xla_gpu_enable_cuda_graphs(true);
+    return debug_options;
+  }
+};
+
+TEST_F(CudaGraphTest, ReplaysWithNewBuffers) {
+  const char* hlo_text = R"(
+HloModule m
+
+add {
+  x = f32[] parameter(0)
+  y = f32[] parameter(1)
+  ROOT add = f32[] add(x, y)
+}
+
+ENTRY main {
+  p0 = f32[4] parameter(0)
+  p1 = f32[4] parameter(1)
+  sum = f32[4] add(p0, p1)
+  zero = f32[] constant(0)
+  total = f32[] reduce(sum, zero), dimensions={0}, to_apply=add
+  broadcast = f32[4] broadcast(total), dimensions={}
+  ROOT mul = f32[4] multiply(sum, broadcast)
+}
+)";
+  TF_ASSERT_OK_AND_ASSIGN(std::unique_ptr<VerifiedHloModule> module,
+                          ParseAndReturnVerifiedModule(hlo_text));
+  TF_ASSERT_OK_AND_ASSIGN(
+      std::unique_ptr<Executable> executable,
+      test_runner_.CreateExecutable(std::move(module),
+                                    /*run_hlo_passes=*/true));
+
+  // Each execution allocates new buffers, so that the graph is captured again
+  // or replayed depending on where the allocator places them.
+  for (int i = 0; i < 3; ++i) {
+    Literal p0 = LiteralUtil::CreateR1<float>({1, 2, 3, 4});
+    Literal p1 = LiteralUtil::CreateR1<float>({1, 1, 1, 1});
+    TF_ASSERT_OK_AND_ASSIGN(
+        Literal result,
+        test_runner_.ExecuteWithExecutable(executable.get(), {&p0, &p1}));
+    EXPECT_EQ(LiteralUtil::CreateR1<float>({28, 42, 56, 70}), result);
+
+    Literal q0 = LiteralUtil::CreateR1<float>({0, 1, 0, 1});
+    Literal q1 = LiteralUtil::CreateR1<float>({1, 0, 1, 0});
+    TF_ASSERT_OK_AND_ASSIGN(
+        result,
+        test_runner_.ExecuteWithExecutable(executable.get(), {&q0, &q1}));
+    EXPECT_EQ(LiteralUtil::CreateR1<float>({4, 4, 4, 4}), result);
+  }
+}
+
+TEST_F(CudaGraphTest, WhileLoopFallsBack) {
+  const char* hlo_text = R"(
+HloModule m
+
+cond {
+  p = (s32[], f32[4]) parameter(0)
+  i = s32[] get-tuple-element(p), index=0
+  n = s32[] constant(5)
+  ROOT lt = pred[] compare(i, n), direction=LT
+}
+
+body {
+  p = (s32[], f32[4]) parameter(0)
+  i = s32[] get-tuple-element(p), index=0
+  x = f32[4] get-tuple-element(p), index=1
+  one = s32[] constant(1)
+  next_i = s32[] add(i, one)
+  next_x = f32[4] add(x, x)
+  ROOT t = (s32[], f32[4]) tuple(next_i, next_x)
+}
+
+ENTRY main {
+  x = f32[4] parameter(0)
+  zero = s32[] constant(0)
+  init = (s32[], f32[4]) tuple(zero, x)
+  loop = (s32[], f32[4]) while(init), condition=cond, body=body
+  ROOT result = f32[4] get-tuple-element(loop), index=1
+}
+)";
+  EXPECT_TRUE(RunAndCompare(hlo_text, ErrorSpec{1e-5, 1e-5}));
+}
+
+}  // namespace
+}  // namespace gpu
+}  // namespace xla
@@ -0,0 +1,95 @@
+/* Copyright 2022 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/compiler/xla/service/gpu/tests/gpu_codegen_test.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace xla {
+namespace gpu {
+namespace {
+
+class MultiStreamTest : public GpuCodegenTest {
+  DebugOptions GetDebugOptionsForTest() override {
+    DebugOptions debug_options = GpuCodegenTest::GetDebugOptionsForTest();
+    debug_options.set_xla_gpu_disable_multi_streaming(false);
+    return debug_options;
+  }
+};
+
+// The towers are independent until the final add, so their dots run on
+// different streams.
+TEST_F(MultiStreamTest, Towers) {
+  const char* hlo_text = R"(
+HloModule Towers
+
+ENTRY main {
+  p0 = f32[512,512] parameter(0)
+  p1 = f32[512,512] parameter(1)
+  a0 = f32[512,512] dot(p0, p1), lhs_contracting_dims={1}, rhs_contracting_dims={0}
+  a1 = f32[512,512] tanh(a0)
+  a2 = f32[512,512] dot(a1, p1), lhs_contracting_dims={1}, rhs_contracting_dims={0}
+  b0 = f32[512,512] dot(p1, p0), lhs_contracting_dims={1}, rhs_contracting_dims={0}
+  b1 = f32[512,512] tanh(b0)
+  b2 = f32[512,512] dot(b1, p0), lhs_contracting_dims={1}, rhs_contracting_dims={0}
+  c0 = f32[512,512] dot(p0, p0), lhs_contracting_dims={1}, rhs_contracting_dims={1}
+  c1 = f32[512,512] tanh(c0)
+  sum = f32[512,512] add(a2, b2)
+  ROOT result = f32[512,512] add(sum, c1)
+}
+)";
+  EXPECT_TRUE(RunAndCompare(hlo_text, ErrorSpec{1e-3, 1e-3}));
+}
+
+// The while loop runs on one of the streams, with its body in sequence.
+TEST_F(MultiStreamTest, WhileLoopNextToDot) {
+  const char* hlo_text = R"(
+HloModule WhileLoopNextToDot
+
+cond {
+  p = (s32[], f32[512,512]) parameter(0)
+  i = s32[] get-tuple-element(p), index=0
+  n = s32[] constant(3)
+  ROOT lt = pred[] compare(i, n), direction=LT
+}
+
+body {
+  p = (s32[], f32[512,512]) parameter(0)
+  i = s32[] get-tuple-element(p), index=0
+  x = f32[512,512] get-tuple-element(p), index=1
+  one = s32[] constant(1)
+  next_i = s32[] add(i, one)
+  half = f32[] constant(0.5)
+  halves = f32[512,512] broadcast(half), dimensions={}
+  next_x = f32[512,512] multiply(x, halves)
+  ROOT t = (s32[], f32[512,512]) tuple(next_i, next_x)
+}
+
+ENTRY main {
+  p0 = f32[512,512] parameter(0)
+  p1 = f32[512,512] parameter(1)
+  dot = f32[512,512] dot(p0, p1), lhs_contracting_dims={1}, rhs_contracting_dims={0}
+  zero = s32[] constant(0)
+  init = (s32[], f32[512,512]) tuple(zero, p1)
+  loop = (s32[], f32[512,512]) while(init), condition=cond, body=body
+  x = f32[512,512] get-tuple-element(loop), index=1
+  ROOT result = f32[512,512] add(dot, x)
+}
+)";
+  EXPECT_TRUE(RunAndCompare(hlo_text, ErrorSpec{1e-3, 1e-3}));
+}
+
+}  // namespace
+}  // namespace gpu
+}  // namespace xla
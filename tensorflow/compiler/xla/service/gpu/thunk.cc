@@ -39,6 +39,10 @@ Thunk::ExecuteParams::ExecuteParams(
       return "kConvolution";
     case Thunk::kCopy:
       return "kCopy";
+    case Thunk::kCopyStart:
+      return "kCopyStart";
+    case Thunk::kCopyDone:
+      return "kCopyDone";
     case Thunk::kCustomCall:
       return "kCustomCall";
     case Thunk::kNcclAllGather:
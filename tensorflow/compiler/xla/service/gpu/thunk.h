@@ -49,6 +49,8 @@ class Thunk {
     kConditional,
     kConvolution,
     kCopy,
+    kCopyStart,
+    kCopyDone,
     kCustomCall,
     kFft,
     kGemm,
@@ -511,6 +511,8 @@ GlobalDecreasingSizeBestFitHeap<BufferType>::GlobalDecreasingSizeBestFitHeap(
     : alignment_(alignment) {
   if (type == kTemporal) {
     buffer_interval_compare_ = GetTemporalBufferIntervalCompare();
+  } else if (type == kArea) {
+    buffer_interval_compare_ = GetAreaBufferIntervalCompare();
   } else {
     CHECK(type == kSpatial);
     buffer_interval_compare_ = GetSpatialBufferIntervalCompare();
@@ -522,20 +524,30 @@ typename GlobalDecreasingSizeBestFitHeap<BufferType>::BufferIntervalCompare
 GlobalDecreasingSizeBestFitHeap<BufferType>::GetTemporalBufferIntervalCompare()
     const {
   return [&](const BufferInterval& x, const BufferInterval& y) {
-    int64_t x_end = x.end;
-    for (auto colocation : GetTransitiveColocations(x)) {
-      x_end = std::max(x_end, buffer_intervals_.at(colocation).end);
+    const int64_t x_end = GetColocatedEnd(x);
+    const int64_t y_end = GetColocatedEnd(y);
+    if (x_end - x.start != y_end - y.start) {
+      return x_end - x.start > y_end - y.start;
     }
 
-    int64_t y_end = y.end;
-    for (auto colocation : GetTransitiveColocations(y)) {
-      y_end = std::max(y_end, buffer_intervals_.at(colocation).end);
+    if (x.size != y.size) {
+      return x.size > y.size;
     }
+    return *x.buffer < *y.buffer;
+  };
+}
 
-    if (x_end - x.start != y_end - y.start) {
-      return x_end - x.start > y_end - y.start;
+template <typename BufferType>
+typename GlobalDecreasingSizeBestFitHeap<BufferType>::BufferIntervalCompare
+GlobalDecreasingSizeBestFitHeap<BufferType>::GetAreaBufferIntervalCompare()
+    const {
+  return [&](const BufferInterval& x, const BufferInterval& y) {
+    // The live ranges include the end time, so they are never empty.
+    const int64_t x_area = x.size * (GetColocatedEnd(x) - x.start + 1);
+    const int64_t y_area = y.size * (GetColocatedEnd(y) - y.start + 1);
+    if (x_area != y_area) {
+      return x_area > y_area;
     }
-
     if (x.size != y.size) {
       return x.size > y.size;
     }
@@ -543,6 +555,21 @@ GlobalDecreasingSizeBestFitHeap<BufferType>::GetTemporalBufferIntervalCompare()
   };
 }
 
+template <typename BufferType>
+int64_t GlobalDecreasingSizeBestFitHeap<BufferType>::GetColocatedEnd(
+    const BufferInterval& interval) const {
+  int64_t end = interval.end;
+  // Most buffers have no colocations, which is worth a shortcut since it is
+  // called from the sort of all buffers.
+  if (interval.colocations.empty()) {
+    return end;
+  }
+  for (auto colocation : GetTransitiveColocations(interval)) {
+    end = std::max(end, buffer_intervals_.at(colocation).end);
+  }
+  return end;
+}
+
 template <typename BufferType>
 /*static*/ typename GlobalDecreasingSizeBestFitHeap<
     BufferType>::BufferIntervalCompare
@@ -370,6 +370,8 @@ class GlobalDecreasingSizeBestFitHeap : public HeapAlgorithm<BufferType> {
   enum Type {
     kSpatial = 0,
     kTemporal,
+    // Sorts by the product of the spatial and temporal sizes.
+    kArea,
   };
 
   // BufferInterval stores a buffer's size and time interval.
@@ -434,6 +436,11 @@ class GlobalDecreasingSizeBestFitHeap : public HeapAlgorithm<BufferType> {
   // contiguous.
   BufferIntervalCompare GetTemporalBufferIntervalCompare() const;
 
+  // Return a BufferIntervalCompare function that sorts by the product of the
+  // size and the live range, as defined above, so that the buffers that take
+  // the most space over time are placed first.
+  BufferIntervalCompare GetAreaBufferIntervalCompare() const;
+
   absl::flat_hash_map<const BufferType*, BufferInterval> buffer_intervals_;
   HeapResult result_;
   BufferIntervalCompare buffer_interval_compare_;
@@ -451,6 +458,9 @@ class GlobalDecreasingSizeBestFitHeap : public HeapAlgorithm<BufferType> {
   // returns all three of them.
   absl::flat_hash_set<const BufferType*> GetTransitiveColocations(
       const BufferInterval& interval) const;
+
+  // Returns the end of the last buffer colocated with this buffer interval.
+  int64_t GetColocatedEnd(const BufferInterval& interval) const;
 };
 
 // This class implements an algorithm that will produce multiple heaps, where
@@ -1284,6 +1284,48 @@ TEST_F(GlobalDecreasingSizeBestFitHeapTest, ColocatedIII) {
   EXPECT_EQ(30, result.chunk_map.at(buffer_c_).offset);
 }
 
+TEST_F(GlobalDecreasingSizeBestFitHeapTest, AreaOrder) {
+  // Placing the buffers in decreasing size * live range puts a before b. The
+  // spatial and temporal orders lead to a 110 bytes heap instead.
+  //
+  // space
+  //   ^
+  //   |    +-b-+
+  //   |    |   |   +-----c-----+
+  //   |    +---+   +-----------+
+  //   |+-------a-------+   +-----d-----+
+  //   ||               |   |           |
+  //   |+---------------+   +-----------+
+  //   ---------------------------------> time
+  auto run_heap = [&](GlobalDecreasingSizeBestFitHeap<HloValue>::Type type,
+                      HeapSimulator::HeapResult<HloValue>* result) {
+    GlobalDecreasingSizeBestFitHeap<HloValue> heap(/*alignment=*/1, type);
+    heap.Alloc(buffer_a_, 40);
+    heap.Alloc(buffer_b_, 50);
+    heap.Free(buffer_b_, 50);
+    heap.Alloc(buffer_c_, 20);
+    heap.Free(buffer_a_, 40);
+    heap.Alloc(buffer_d_, 50);
+    heap.Free(buffer_c_, 20);
+    heap.Free(buffer_d_, 50);
+    const HeapSimulator::Result<HloValue> results = heap.Finish();
+    ASSERT_EQ(1, results.heap_results.size());
+    *result = results.heap_results.at(0);
+  };
+
+  HeapSimulator::HeapResult<HloValue> result;
+  run_heap(GlobalDecreasingSizeBestFitHeap<HloValue>::kSpatial, &result);
+  EXPECT_EQ(110, result.heap_size);
+  run_heap(GlobalDecreasingSizeBestFitHeap<HloValue>::kTemporal, &result);
+  EXPECT_EQ(110, result.heap_size);
+  run_heap(GlobalDecreasingSizeBestFitHeap<HloValue>::kArea, &result);
+  EXPECT_EQ(90, result.heap_size);
+  EXPECT_EQ(0, result.chunk_map.at(buffer_a_).offset);
+  EXPECT_EQ(40, result.chunk_map.at(buffer_b_).offset);
+  EXPECT_EQ(50, result.chunk_map.at(buffer_c_).offset);
+  EXPECT_EQ(0, result.chunk_map.at(buffer_d_).offset);
+}
+
 TEST_F(GlobalDecreasingSizeBestFitHeapTest, ChunkCandidate) {
   // space
   //   ^
@@ -0,0 +1,108 @@
+/* Copyright 2022 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/compiler/xla/service/hlo_computation_pass.h"
+
+#include <vector>
+
+#include "absl/container/flat_hash_set.h"
+#include "tensorflow/compiler/xla/service/hlo_instruction.h"
+#include "tensorflow/compiler/xla/status_macros.h"
+#include "tensorflow/core/platform/blocking_counter.h"
+
+namespace xla {
+
+StatusOr<bool> HloComputationPass::Run(HloModule* module) {
+  TF_ASSIGN_OR_RETURN(
+      std::vector<HloComputation*> changed,
+      RunOnComputations(module, module->MakeNonfusionComputations()));
+  return !changed.empty();
+}
+
+Status HloComputationPass::RunOnChangedComputations(HloModule* module,
+                                                    RunState* run_state) {
+  // The post order visits callees before their callers, so that changes
+  // propagate up the call graph in a single walk.
+  absl::flat_hash_set<const HloComputation*> dirty;
+  std::vector<HloComputation*> computations;
+  for (HloComputation* computation : module->MakeComputationPostOrder()) {
+    bool is_dirty = run_state->changed_last_iteration.contains(computation);
+    for (const HloInstruction* instruction : computation->instructions()) {
+      if (is_dirty) {
+        break;
+      }
+      for (const HloComputation* callee : instruction->called_computations()) {
+        if (dirty.contains(callee)) {
+          is_dirty = true;
+          break;
+        }
+      }
+    }
+    if (!is_dirty) {
+      continue;
+    }
+    dirty.insert(computation);
+    if (!computation->IsFusionComputation()) {
+      computations.push_back(computation);
+    }
+  }
+  VLOG(3) << name() << " runs on " << computations.size() << " of "
+          << module->computation_count() << " computations";
+  TF_ASSIGN_OR_RETURN(std::vector<HloComputation*> changed,
+                      RunOnComputations(module, computations));
+  run_state->changed_this_iteration.insert(changed.begin(), changed.end());
+  return OkStatus();
+}
+
+StatusOr<std::vector<HloComputation*>> HloComputationPass::RunOnComputations(
+    HloModule* module, absl::Span<HloComputation* const> computations) {
+  const absl::flat_hash_set<const HloComputation*> computations_before(
+      module->computations().begin(), module->computations().end());
+  std::vector<StatusOr<bool>> changed(computations.size(), false);
+  if (thread_pool_ != nullptr && RunOnComputationIsThreadSafe() &&
+      computations.size() > 1) {
+    tensorflow::BlockingCounter counter(computations.size());
+    for (int64_t i = 0; i < computations.size(); ++i) {
+      thread_pool_->Schedule([&, i]() {
+        changed[i] = RunOnComputation(computations[i]);
+        counter.DecrementCount();
+      });
+    }
+    counter.Wait();
+  } else {
+    for (int64_t i = 0; i < computations.size(); ++i) {
+      changed[i] = RunOnComputation(computations[i]);
+      if (!changed[i].ok()) {
+        break;
+      }
+    }
+  }
+
+  std::vector<HloComputation*> result;
+  for (int64_t i = 0; i < computations.size(); ++i) {
+    TF_RETURN_IF_ERROR(changed[i].status());
+    if (*changed[i]) {
+      result.push_back(computations[i]);
+    }
+  }
+  for (HloComputation* computation : module->computations()) {
+    if (!computations_before.contains(computation)) {
+      result.push_back(computation);
+    }
+  }
+  return result;
+}
+
+}  // namespace xla
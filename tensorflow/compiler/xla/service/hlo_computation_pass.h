@@ -0,0 +1,73 @@
+/* Copyright 2022 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_COMPILER_XLA_SERVICE_HLO_COMPUTATION_PASS_H_
+#define TENSORFLOW_COMPILER_XLA_SERVICE_HLO_COMPUTATION_PASS_H_
+
+#include <vector>
+
+#include "absl/types/span.h"
+#include "tensorflow/compiler/xla/service/hlo_computation.h"
+#include "tensorflow/compiler/xla/service/hlo_module.h"
+#include "tensorflow/compiler/xla/service/hlo_pass_interface.h"
+#include "tensorflow/compiler/xla/statusor.h"
+#include "tensorflow/core/platform/threadpool.h"
+
+namespace xla {
+
+// Base class for module passes which transform each non-fusion computation on
+// its own. RunOnComputation may only change the given computation, and what
+// it does may only depend on that computation and the computations it calls.
+//
+// This lets RunOnChangedComputations skip the computations that did not change
+// since the last iteration of a fixed-point pipeline: a computation is only
+// revisited if it, or a computation it calls, changed.
+//
+// If RunOnComputation in addition neither adds instructions or computations
+// nor reads or writes any other module-level state, the pass can override
+// RunOnComputationIsThreadSafe to run over different computations in parallel
+// on the thread pool given to set_thread_pool.
+class HloComputationPass : public HloModulePass {
+ public:
+  // Runs the pass on the given computation. Returns whether the computation was
+  // changed.
+  virtual StatusOr<bool> RunOnComputation(HloComputation* computation) = 0;
+
+  StatusOr<bool> Run(HloModule* module) override;
+  Status RunOnChangedComputations(HloModule* module,
+                                  RunState* run_state) override;
+
+  // The pool must outlive the runs of the pass. Null runs the pass on the
+  // calling thread.
+  void set_thread_pool(tensorflow::thread::ThreadPool* thread_pool) {
+    thread_pool_ = thread_pool;
+  }
+
+ protected:
+  virtual bool RunOnComputationIsThreadSafe() const { return false; }
+
+ private:
+  // Runs the pass on `computations`, in order unless it runs in parallel.
+  // Returns the computations that changed, including the ones that were added
+  // to the module.
+  StatusOr<std::vector<HloComputation*>> RunOnComputations(
+      HloModule* module, absl::Span<HloComputation* const> computations);
+
+  tensorflow::thread::ThreadPool* thread_pool_ = nullptr;
+};
+
+}  // namespace xla
+
+#endif  // TENSORFLOW_COMPILER_XLA_SERVICE_HLO_COMPUTATION_PASS_H_
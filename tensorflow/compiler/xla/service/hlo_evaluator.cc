@@ -21,6 +21,7 @@ limitations under the License.
 #include <cstdlib>
 #include <functional>
 #include <iterator>
+#include <limits>
 #include <memory>
 #include <optional>
 #include <string>
@@ -3596,6 +3597,174 @@ static bool IsScalarAdd(HloComputation* computation) {
   return false;
 }
 
+// Returns the opcode of `computation` if it only applies a binary op to its
+// accumulator and input parameters, in that order, so that a reduction with it
+// can be computed without the embedded evaluator.
+static std::optional<HloOpcode> GetSimpleReducerOpcode(
+    const HloComputation* computation) {
+  const HloInstruction* root = computation->root_instruction();
+  if (computation->num_parameters() != 2 ||
+      computation->instruction_count() != 3 || root->operand_count() != 2 ||
+      root->operand(0) != computation->parameter_instruction(0) ||
+      root->operand(1) != computation->parameter_instruction(1) ||
+      !ShapeUtil::IsScalar(root->shape()) ||
+      !ShapeUtil::SameElementType(root->shape(), root->operand(0)->shape()) ||
+      !ShapeUtil::SameElementType(root->shape(), root->operand(1)->shape())) {
+    return std::nullopt;
+  }
+  switch (root->opcode()) {
+    case HloOpcode::kAdd:
+    case HloOpcode::kMultiply:
+    case HloOpcode::kMaximum:
+    case HloOpcode::kMinimum:
+    case HloOpcode::kAnd:
+    case HloOpcode::kOr:
+      return root->opcode();
+    default:
+      return std::nullopt;
+  }
+}
+
+// Applies `opcode` the way the typed visitor of NativeT does.
+template <typename NativeT>
+static NativeT ApplySimpleReducer(HloOpcode opcode, NativeT lhs, NativeT rhs) {
+  if constexpr (std::is_same_v<NativeT, Eigen::half> ||
+                std::is_same_v<NativeT, bfloat16>) {
+    return static_cast<NativeT>(ApplySimpleReducer<float>(
+        opcode, static_cast<float>(lhs), static_cast<float>(rhs)));
+  } else {
+    switch (opcode) {
+      case HloOpcode::kAdd:
+        return static_cast<NativeT>(ToArithmeticSafeType(lhs) +
+                                    ToArithmeticSafeType(rhs));
+      case HloOpcode::kMultiply:
+        return static_cast<NativeT>(ToArithmeticSafeType(lhs) *
+                                    ToArithmeticSafeType(rhs));
+      case HloOpcode::kMaximum:
+      case HloOpcode::kMinimum:
+        if constexpr (std::numeric_limits<NativeT>::has_quiet_NaN) {
+          if (std::isnan(lhs)) {
+            return lhs;
+          }
+          if (std::isnan(rhs)) {
+            return rhs;
+          }
+        }
+        return opcode == HloOpcode::kMaximum ? std::max(lhs, rhs)
+                                             : std::min(lhs, rhs);
+      case HloOpcode::kAnd:
+        if constexpr (std::is_integral_v<NativeT>) {
+          return static_cast<NativeT>(lhs & rhs);
+        }
+        break;
+      case HloOpcode::kOr:
+        if constexpr (std::is_integral_v<NativeT>) {
+          return static_cast<NativeT>(lhs | rhs);
+        }
+        break;
+      default:
+        break;
+    }
+    LOG(FATAL) << "Unsupported simple reducer: " << HloOpcodeString(opcode);
+  }
+}
+
+// Reduces the elements of `input` in the iteration space given by `base`,
+// `counts` and `steps` into the element of `result` at `output_index`, which
+// holds the initial value.
+template <typename NativeT>
+static void ReduceWithSimpleReducer(HloOpcode opcode, const Literal& input,
+                                    absl::Span<const int64_t> base,
+                                    absl::Span<const int64_t> counts,
+                                    absl::Span<const int64_t> steps,
+                                    absl::Span<const int64_t> output_index,
+                                    Literal* result) {
+  NativeT accumulator = result->Get<NativeT>(output_index);
+  ShapeUtil::ForEachIndex(input.shape(), base, counts, steps,
+                          [&](absl::Span<const int64_t> input_index) {
+                            accumulator = ApplySimpleReducer<NativeT>(
+                                opcode, accumulator,
+                                input.Get<NativeT>(input_index));
+                            return true;
+                          });
+  result->Set<NativeT>(output_index, accumulator);
+}
+
+// Calls ReduceWithSimpleReducer for the element type of `input`. Returns false
+// if `opcode` is not supported for that type.
+static bool TryReduceWithSimpleReducer(HloOpcode opcode, const Literal& input,
+                                       absl::Span<const int64_t> base,
+                                       absl::Span<const int64_t> counts,
+                                       absl::Span<const int64_t> steps,
+                                       absl::Span<const int64_t> output_index,
+                                       Literal* result) {
+  const PrimitiveType type = input.shape().element_type();
+  const bool is_bitwise =
+      opcode == HloOpcode::kAnd || opcode == HloOpcode::kOr;
+  if (type == PRED && !is_bitwise) {
+    return false;
+  }
+  if (is_bitwise && type != PRED && !primitive_util::IsIntegralType(type)) {
+    return false;
+  }
+  switch (type) {
+    case PRED:
+      ReduceWithSimpleReducer<bool>(opcode, input, base, counts, steps,
+                                    output_index, result);
+      return true;
+    case S8:
+      ReduceWithSimpleReducer<int8_t>(opcode, input, base, counts, steps,
+                                      output_index, result);
+      return true;
+    case S16:
+      ReduceWithSimpleReducer<int16_t>(opcode, input, base, counts, steps,
+                                       output_index, result);
+      return true;
+    case S32:
+      ReduceWithSimpleReducer<int32_t>(opcode, input, base, counts, steps,
+                                       output_index, result);
+      return true;
+    case S64:
+      ReduceWithSimpleReducer<int64_t>(opcode, input, base, counts, steps,
+                                       output_index, result);
+      return true;
+    case U8:
+      ReduceWithSimpleReducer<uint8_t>(opcode, input, base, counts, steps,
+                                       output_index, result);
+      return true;
+    case U16:
+      ReduceWithSimpleReducer<uint16_t>(opcode, input, base, counts, steps,
+                                        output_index, result);
+      return true;
+    case U32:
+      ReduceWithSimpleReducer<uint32_t>(opcode, input, base, counts, steps,
+                                        output_index, result);
+      return true;
+    case U64:
+      ReduceWithSimpleReducer<uint64_t>(opcode, input, base, counts, steps,
+                                        output_index, result);
+      return true;
+    case F16:
+      ReduceWithSimpleReducer<Eigen::half>(opcode, input, base, counts, steps,
+                                           output_index, result);
+      return true;
+    case BF16:
+      ReduceWithSimpleReducer<bfloat16>(opcode, input, base, counts, steps,
+                                        output_index, result);
+      return true;
+    case F32:
+      ReduceWithSimpleReducer<float>(opcode, input, base, counts, steps,
+                                     output_index, result);
+      return true;
+    case F64:
+      ReduceWithSimpleReducer<double>(opcode, input, base, counts, steps,
+                                      output_index, result);
+      return true;
+    default:
+      return false;
+  }
+}
+
 // Run a single step of an inner loop while running reduction, which applies
 // the user-provided computation on the accumulator and the output element
 // (until the reduction is completed, the output element is also used as
@@ -3694,6 +3863,16 @@ static StatusOr<bool> GenerateReduceOutputElement(
     return true;
   }
 
+  if (!is_tuple) {
+    std::optional<HloOpcode> opcode = GetSimpleReducerOpcode(function);
+    if (opcode.has_value() &&
+        TryReduceWithSimpleReducer(*opcode, *input_args[0], base,
+                                   arg_dim_counts, arg_dim_steps, output_index,
+                                   &results[0])) {
+      return true;
+    }
+  }
+
   // Iterates only over reduced shape, as counts and steps are set to zero
   // for all non-reduced dimensions.
   TF_RETURN_IF_ERROR(ShapeUtil::ForEachIndexWithStatus(
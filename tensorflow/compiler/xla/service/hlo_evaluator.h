@@ -439,6 +439,17 @@ class HloEvaluator : public DfsHloVisitorWithDefault {
     TF_RET_CHECK(ShapeUtil::SameDimensions(shape, operand->shape()));
 
     Literal result(shape);
+    // An operand in the layout of the result is read in linear index order,
+    // without the multi-index arithmetic of Populate and Get.
+    if (ShapeUtil::EqualIgnoringElementType(result.shape(),
+                                            operand_literal.shape())) {
+      absl::Span<const NativeT> operand_data = operand_literal.data<NativeT>();
+      absl::Span<ReturnT> result_data = result.data<ReturnT>();
+      for (int64_t i = 0; i < result_data.size(); ++i) {
+        result_data[i] = unary_op(operand_data[i]);
+      }
+      return std::move(result);
+    }
     TF_RETURN_IF_ERROR(
         result.Populate<ReturnT>([&](absl::Span<const int64_t> multi_index) {
           return unary_op(operand_literal.Get<NativeT>(multi_index));
@@ -14,6 +14,7 @@ limitations under the License.
 ==============================================================================*/
 #include "tensorflow/compiler/xla/service/hlo_evaluator.h"
 
+#include <cmath>
 #include <initializer_list>
 #include <memory>
 #include <string>
@@ -4792,6 +4793,86 @@ TEST_F(HloEvaluatorTest, DotUpcast) {
   EXPECT_TRUE(LiteralTestUtil::Equal(expected, result));
 }
 
+TEST_F(HloEvaluatorTest, ElementwiseWithDifferentLayouts) {
+  const absl::string_view hlo_text = R"(
+  HloModule test
+  ENTRY main {
+    a = s32[2,3]{0,1} constant({{1, 2, 3}, {4, 5, 6}})
+    b = s32[2,3]{1,0} constant({{10, 20, 30}, {40, 50, 60}})
+    add = s32[2,3]{1,0} add(a, b)
+    negate = s32[2,3]{1,0} negate(a)
+    ROOT multiply = s32[2,3]{1,0} multiply(add, negate)
+  }
+  )";
+  TF_ASSERT_OK_AND_ASSIGN(m_, ParseAndReturnVerifiedModule(hlo_text));
+  TF_ASSERT_OK_AND_ASSIGN(Literal result, Evaluate());
+  auto expected = LiteralUtil::CreateR2<int32_t>(
+      {{-11, -44, -99}, {-176, -275, -396}});
+  EXPECT_TRUE(LiteralTestUtil::Equal(expected, result));
+}
+
+TEST_F(HloEvaluatorTest, DotWithColumnMajorOperands) {
+  const absl::string_view hlo_text = R"(
+  HloModule test
+  ENTRY main {
+    l = s32[2,3]{0,1} constant({{1, 2, 3}, {4, 5, 6}})
+    r = s32[3,2]{0,1} constant({{1, 2}, {3, 4}, {5, 6}})
+    ROOT result = s32[2,2]{1,0} dot(l, r), lhs_contracting_dims={1},
+                                           rhs_contracting_dims={0}
+  }
+  )";
+  TF_ASSERT_OK_AND_ASSIGN(m_, ParseAndReturnVerifiedModule(hlo_text));
+  TF_ASSERT_OK_AND_ASSIGN(Literal result, Evaluate());
+  auto expected = LiteralUtil::CreateR2<int32_t>({{22, 28}, {49, 64}});
+  EXPECT_TRUE(LiteralTestUtil::Equal(expected, result));
+}
+
+TEST_F(HloEvaluatorTest, ReduceWithSimpleReducers) {
+  const absl::string_view hlo_text = R"(
+  HloModule test
+
+  max_s32 {
+    p0 = s32[] parameter(0)
+    p1 = s32[] parameter(1)
+    ROOT max = s32[] maximum(p0, p1)
+  }
+
+  max_f32 {
+    p0 = f32[] parameter(0)
+    p1 = f32[] parameter(1)
+    ROOT max = f32[] maximum(p0, p1)
+  }
+
+  multiply_u8 {
+    p0 = u8[] parameter(0)
+    p1 = u8[] parameter(1)
+    ROOT multiply = u8[] multiply(p0, p1)
+  }
+
+  ENTRY main {
+    a = s32[2,3]{0,1} constant({{1, 7, 3}, {-4, 5, 6}})
+    a_init = s32[] constant(-2147483648)
+    max_a = s32[2] reduce(a, a_init), dimensions={1}, to_apply=max_s32
+    b = f32[2,2] constant({{1, nan}, {2, 3}})
+    b_init = f32[] constant(-inf)
+    max_b = f32[2] reduce(b, b_init), dimensions={1}, to_apply=max_f32
+    c = u8[4] constant({16, 16, 2, 1})
+    c_init = u8[] constant(1)
+    product_c = u8[] reduce(c, c_init), dimensions={0}, to_apply=multiply_u8
+    ROOT result = (s32[2], f32[2], u8[]) tuple(max_a, max_b, product_c)
+  }
+  )";
+  TF_ASSERT_OK_AND_ASSIGN(m_, ParseAndReturnVerifiedModule(hlo_text));
+  TF_ASSERT_OK_AND_ASSIGN(Literal result, Evaluate());
+  std::vector<Literal> results = result.DecomposeTuple();
+  EXPECT_TRUE(LiteralTestUtil::Equal(LiteralUtil::CreateR1<int32_t>({7, 6}),
+                                     results[0]));
+  EXPECT_TRUE(std::isnan(results[1].Get<float>({0})));
+  EXPECT_EQ(results[1].Get<float>({1}), 3.0f);
+  EXPECT_TRUE(
+      LiteralTestUtil::Equal(LiteralUtil::CreateR0<uint8_t>(0), results[2]));
+}
+
 TEST_F(HloEvaluatorTest, SortC64) {
   const absl::string_view hlo_text = R"(
   HloModule m
@@ -34,6 +34,7 @@ limitations under the License.
 #include "absl/container/inlined_vector.h"
 #include "absl/types/span.h"
 #include "tensorflow/compiler/xla/array2d.h"
+#include "tensorflow/compiler/xla/index_util.h"
 #include "tensorflow/compiler/xla/literal.h"
 #include "tensorflow/compiler/xla/literal_util.h"
 #include "tensorflow/compiler/xla/primitive_util.h"
@@ -1253,15 +1254,25 @@ class HloEvaluatorTypedVisitor : public DfsHloVisitorWithDefault {
     contracting_dim_sizes.reserve(dnums.lhs_contracting_dimensions_size());
     DimensionVector lhs_contracting_dims;
     DimensionVector rhs_contracting_dims;
+    // The strides of the contracting dimensions in the operand literals, so
+    // that the contraction walks the data spans by linear index.
+    DimensionVector lhs_contracting_strides;
+    DimensionVector rhs_contracting_strides;
     for (int64_t i = 0; i < dnums.lhs_contracting_dimensions_size(); ++i) {
       const int64_t lhs_dnum = dnums.lhs_contracting_dimensions(i);
       const int64_t rhs_dnum = dnums.rhs_contracting_dimensions(i);
       lhs_contracting_dims.push_back(lhs_dnum);
       rhs_contracting_dims.push_back(rhs_dnum);
+      lhs_contracting_strides.push_back(
+          IndexUtil::GetDimensionStride(lhs_literal.shape(), lhs_dnum));
+      rhs_contracting_strides.push_back(
+          IndexUtil::GetDimensionStride(rhs_literal.shape(), rhs_dnum));
       const int64_t dim_size = lhs_literal.shape().dimensions(lhs_dnum);
       contracting_dim_sizes.push_back(dim_size);
     }
     const int64_t total_contraction_size = Product(contracting_dim_sizes);
+    absl::Span<const ReturnT> lhs_data = lhs_literal.data<ReturnT>();
+    absl::Span<const ReturnT> rhs_data = rhs_literal.data<ReturnT>();
     Literal result(dot->shape());
     TF_RETURN_IF_ERROR(result.PopulateParallel<ReturnT>(
         [&](absl::Span<const int64_t> result_index, int /*thread_id*/) {
@@ -1286,10 +1297,14 @@ class HloEvaluatorTypedVisitor : public DfsHloVisitorWithDefault {
           }
 
           // Accumulate resulting product along the contracting dimensions.
+          int64_t lhs_offset = IndexUtil::MultidimensionalIndexToLinearIndex(
+              lhs_literal.shape(), lhs_index);
+          int64_t rhs_offset = IndexUtil::MultidimensionalIndexToLinearIndex(
+              rhs_literal.shape(), rhs_index);
           ElementwiseT result_val = static_cast<ElementwiseT>(0);
           for (int64_t k = 0; k < total_contraction_size; k++) {
-            ElementwiseT lhs_val(lhs_literal.Get<ReturnT>(lhs_index));
-            ElementwiseT rhs_val(rhs_literal.Get<ReturnT>(rhs_index));
+            ElementwiseT lhs_val(lhs_data[lhs_offset]);
+            ElementwiseT rhs_val(rhs_data[rhs_offset]);
             result_val +=
                 ToArithmeticSafeType(lhs_val) * ToArithmeticSafeType(rhs_val);
 
@@ -1298,13 +1313,17 @@ class HloEvaluatorTypedVisitor : public DfsHloVisitorWithDefault {
             if (!contracting_dim_sizes.empty()) {
               for (int64_t i = contracting_dim_sizes.size() - 1; i >= 0; --i) {
                 lhs_index[lhs_contracting_dims[i]]++;
-                rhs_index[rhs_contracting_dims[i]]++;
+                lhs_offset += lhs_contracting_strides[i];
+                rhs_offset += rhs_contracting_strides[i];
                 if (lhs_index[lhs_contracting_dims[i]] !=
                     contracting_dim_sizes[i]) {
                   break;
                 }
                 lhs_index[lhs_contracting_dims[i]] = 0;
-                rhs_index[rhs_contracting_dims[i]] = 0;
+                lhs_offset -= contracting_dim_sizes[i] *
+                              lhs_contracting_strides[i];
+                rhs_offset -= contracting_dim_sizes[i] *
+                              rhs_contracting_strides[i];
               }
             }
           }
@@ -2439,12 +2458,31 @@ class HloEvaluatorTypedVisitor : public DfsHloVisitorWithDefault {
     const Literal& rhs_literal = parent_->GetEvaluatedLiteralFor(rhs);
 
     Literal result(shape);
+    const auto apply = [&binary_op](ReturnT lhs_elem, ReturnT rhs_elem) {
+      return static_cast<ReturnT>(
+          binary_op(static_cast<ElementwiseT>(lhs_elem),
+                    static_cast<ElementwiseT>(rhs_elem)));
+    };
+
+    // Operands in the layout of the result are read in linear index order,
+    // without the multi-index arithmetic of Populate and Get.
+    if (ShapeUtil::EqualIgnoringElementType(result.shape(),
+                                            lhs_literal.shape()) &&
+        ShapeUtil::EqualIgnoringElementType(result.shape(),
+                                            rhs_literal.shape())) {
+      absl::Span<const ReturnT> lhs_data = lhs_literal.data<ReturnT>();
+      absl::Span<const ReturnT> rhs_data = rhs_literal.data<ReturnT>();
+      absl::Span<ReturnT> result_data = result.data<ReturnT>();
+      for (int64_t i = 0; i < result_data.size(); ++i) {
+        result_data[i] = apply(lhs_data[i], rhs_data[i]);
+      }
+      return std::move(result);
+    }
 
     TF_RETURN_IF_ERROR(
         result.Populate<ReturnT>([&](absl::Span<const int64_t> multi_index) {
-          return ConvertBinaryFunction(binary_op)(
-              lhs_literal.Get<ReturnT>(multi_index),
-              rhs_literal.Get<ReturnT>(multi_index));
+          return apply(lhs_literal.Get<ReturnT>(multi_index),
+                       rhs_literal.Get<ReturnT>(multi_index));
         }));
     return std::move(result);
   }
@@ -2467,6 +2505,22 @@ class HloEvaluatorTypedVisitor : public DfsHloVisitorWithDefault {
 
     Literal result(shape);
 
+    if (ShapeUtil::EqualIgnoringElementType(result.shape(),
+                                            lhs_literal.shape()) &&
+        ShapeUtil::EqualIgnoringElementType(result.shape(),
+                                            rhs_literal.shape()) &&
+        ShapeUtil::EqualIgnoringElementType(result.shape(),
+                                            ehs_literal.shape())) {
+      absl::Span<const LhsType> lhs_data = lhs_literal.data<LhsType>();
+      absl::Span<const RhsType> rhs_data = rhs_literal.data<RhsType>();
+      absl::Span<const EhsType> ehs_data = ehs_literal.data<EhsType>();
+      absl::Span<ReturnT> result_data = result.data<ReturnT>();
+      for (int64_t i = 0; i < result_data.size(); ++i) {
+        result_data[i] = ternary_op(lhs_data[i], rhs_data[i], ehs_data[i]);
+      }
+      return std::move(result);
+    }
+
     TF_RETURN_IF_ERROR(
         result.Populate<ReturnT>([&](absl::Span<const int64_t> multi_index) {
           return ternary_op(lhs_literal.Get<LhsType>(multi_index),
@@ -15,6 +15,11 @@ limitations under the License.
 
 #include "tensorflow/compiler/xla/service/hlo_pass_pipeline.h"
 
+#if defined(__linux__)
+#include <sys/resource.h>
+#endif  // defined(__linux__)
+
+#include <cstdint>
 #include <functional>
 #include <string>
 
@@ -30,17 +35,46 @@ limitations under the License.
 #include "tensorflow/compiler/xla/util.h"
 #include "tensorflow/core/platform/errors.h"
 #include "tensorflow/core/platform/logging.h"
+#include "tensorflow/core/profiler/lib/traceme.h"
+#include "tensorflow/core/profiler/lib/traceme_encode.h"
 
 namespace xla {
 
 namespace {
 
+// Returns the peak resident memory of the process in bytes, or 0 if it is not
+// known on the platform.
+int64_t PeakMemoryBytes() {
+#if defined(__linux__)
+  struct rusage usage;
+  if (getrusage(RUSAGE_SELF, &usage) == 0) {
+    // ru_maxrss is in kilobytes on Linux.
+    return int64_t{usage.ru_maxrss} * 1024;
+  }
+#endif  // defined(__linux__)
+  return 0;
+}
+
+int64_t InstructionCount(const HloModule& module) {
+  return module.instruction_count();
+}
+
+int64_t InstructionCount(const HloModuleGroup& module_group) {
+  int64_t count = 0;
+  for (const HloModule* module : module_group.modules()) {
+    count += module->instruction_count();
+  }
+  return count;
+}
+
 void RecordPassStartMetadata(HloModule& module, const std::string& pass_name,
                              const std::string& pipeline_name) {
   module.metadata()->RecordPassStart();
   // An HloPassMetadata was just created so Status should always be OK.
   TF_CHECK_OK(module.metadata()->set_current_pass_name(pass_name));
   TF_CHECK_OK(module.metadata()->set_current_pass_pipeline_name(pipeline_name));
+  TF_CHECK_OK(module.metadata()->set_current_pass_instruction_count_before(
+      module.instruction_count()));
 }
 
 void RecordPassStartMetadata(HloModuleGroup& module_group,
@@ -60,6 +94,11 @@ Status AttemptRecordPassEndMetadata(HloModule& module,
       module.metadata()->set_current_pass_module_id(module.unique_id()));
   TF_RETURN_IF_ERROR(
       module.metadata()->set_current_pass_module_changed(module_changed));
+  TF_RETURN_IF_ERROR(
+      module.metadata()->set_current_pass_instruction_count_after(
+          module.instruction_count()));
+  TF_RETURN_IF_ERROR(
+      module.metadata()->set_current_pass_peak_memory_bytes(PeakMemoryBytes()));
   TF_RETURN_IF_ERROR(module.metadata()->RecordPassEnd());
   return OkStatus();
 }
@@ -145,7 +184,7 @@ Status HloPassPipeline::RunInvariantCheckers(
 
 template <typename HloT>
 StatusOr<bool> HloPassPipeline::RunPassesInternal(
-    HloT* hlo, const DebugOptions& debug_options) {
+    HloT* hlo, const DebugOptions& debug_options, RunState* run_state) {
   auto passes = GetEnabledPasses(debug_options);
   // Copy string by value since debug options could get clobbered in an hlo
   // module group pass.
@@ -176,8 +215,20 @@ StatusOr<bool> HloPassPipeline::RunPassesInternal(
     if (!pass->IsPassPipeline()) {
       compilation_stats_->StartPass(pass_name);
     }
+    // Shows up as an event of the host XPlane when the TF profiler is active.
+    tensorflow::profiler::TraceMe trace_me([&] {
+      return tensorflow::profiler::TraceMeEncode(
+          "HloPass", {{"name", pass_name},
+                      {"pipeline", pipeline_name},
+                      {"instruction_count_before", InstructionCount(*hlo)}});
+    });
     RecordPassStartMetadata(*hlo, pass_name, pipeline_name);
-    TF_ASSIGN_OR_RETURN(bool pass_changed, RunHelper(pass, hlo));
+    TF_ASSIGN_OR_RETURN(bool pass_changed, RunHelper(pass, hlo, run_state));
+    trace_me.AppendMetadata([&] {
+      return tensorflow::profiler::TraceMeEncode(
+          {{"changed", pass_changed ? "true" : "false"},
+           {"instruction_count_after", InstructionCount(*hlo)}});
+    });
     SetInstructionMetadata(*hlo);
     if (!dump_regex.empty() && (pass_changed || dump_regex != ".*")) {
       MaybeDumpHloAndSaveFilenames(*hlo,
@@ -272,6 +323,18 @@ StatusOr<bool> HloPassPipeline::Run(HloModule* module) {
   return RunPassesInternal(module, module->config().debug_options());
 }
 
+Status HloPassPipeline::RunOnChangedComputations(HloModule* module,
+                                                 RunState* run_state) {
+  run_called_ = true;
+
+  VLOG(1) << "Running HLO pass pipeline on changed computations of module "
+          << module->name() << ": " << name();
+
+  return RunPassesInternal(module, module->config().debug_options(),
+                           run_state)
+      .status();
+}
+
 StatusOr<bool> HloPassPipeline::RunOnModuleGroup(HloModuleGroup* module_group) {
   run_called_ = true;
 
@@ -81,6 +81,12 @@ class HloPassPipeline : public HloPassInterface {
   StatusOr<bool> Run(HloModule* module) override;
   StatusOr<bool> RunOnModuleGroup(HloModuleGroup* module_group) override;
 
+  // Runs each pass on the computations changed in the last iteration of
+  // `run_state` or by the passes before it, so that a fixed-point pipeline
+  // only revisits changed computations with passes that support it.
+  Status RunOnChangedComputations(HloModule* module,
+                                  RunState* run_state) override;
+
   bool IsPassPipeline() override { return true; }
 
   // Return size of passes_.
@@ -110,21 +116,40 @@ class HloPassPipeline : public HloPassInterface {
   Status RunInvariantCheckers(HloT* hlo, absl::string_view after_pass_name);
 
   // Helper which runs the given pass on the given HLO. HloT can be either
-  // HloModule or HloModuleGroup.
+  // HloModule or HloModuleGroup. If `run_state` is not null, the passes only
+  // run on the computations changed according to it.
   template <typename HloT>
-  StatusOr<bool> RunPassesInternal(HloT* hlo,
-                                   const DebugOptions& debug_options);
+  StatusOr<bool> RunPassesInternal(HloT* hlo, const DebugOptions& debug_options,
+                                   RunState* run_state = nullptr);
 
   // Helpers which run the given passes on the given HLO construct. These
   // helpers enable templating of the core of the pipeline logic by providing
   // HloModule and HloModuleGroup specific methods with the same name.
-  static StatusOr<bool> RunHelper(HloPassInterface* pass, HloModule* module) {
-    TF_ASSIGN_OR_RETURN(bool changed, pass->Run(module));
+  static StatusOr<bool> RunHelper(HloPassInterface* pass, HloModule* module,
+                                  RunState* run_state = nullptr) {
+    bool changed;
+    if (run_state == nullptr) {
+      TF_ASSIGN_OR_RETURN(changed, pass->Run(module));
+    } else {
+      RunState pass_run_state;
+      pass_run_state.changed_last_iteration = run_state->changed_last_iteration;
+      pass_run_state.changed_last_iteration.insert(
+          run_state->changed_this_iteration.begin(),
+          run_state->changed_this_iteration.end());
+      TF_RETURN_IF_ERROR(
+          pass->RunOnChangedComputations(module, &pass_run_state));
+      changed = !pass_run_state.changed_this_iteration.empty();
+      run_state->changed_this_iteration.insert(
+          pass_run_state.changed_this_iteration.begin(),
+          pass_run_state.changed_this_iteration.end());
+    }
     module->Cleanup();
     return changed;
   }
   static StatusOr<bool> RunHelper(HloPassInterface* pass,
-                                  HloModuleGroup* module_group) {
+                                  HloModuleGroup* module_group,
+                                  RunState* run_state = nullptr) {
+    TF_RET_CHECK(run_state == nullptr);
     TF_ASSIGN_OR_RETURN(bool changed, pass->RunOnModuleGroup(module_group));
     module_group->Cleanup();
     return changed;
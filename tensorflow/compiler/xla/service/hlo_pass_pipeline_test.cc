@@ -15,13 +15,21 @@ limitations under the License.
 
 #include "tensorflow/compiler/xla/service/hlo_pass_pipeline.h"
 
+#include <map>
+#include <string>
+
 #include "tensorflow/compiler/xla/service/hlo_computation.h"
+#include "tensorflow/compiler/xla/service/hlo_computation_pass.h"
 #include "tensorflow/compiler/xla/service/hlo_instruction.h"
 #include "tensorflow/compiler/xla/service/hlo_module.h"
 #include "tensorflow/compiler/xla/service/hlo_parser.h"
+#include "tensorflow/compiler/xla/service/hlo_pass_fix.h"
 #include "tensorflow/compiler/xla/tests/hlo_test_base.h"
 #include "tensorflow/compiler/xla/util.h"
 #include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/threadpool.h"
 
 namespace xla {
 namespace {
@@ -62,6 +70,43 @@ class FooToBarModulePass : public HloModulePass {
   }
 };
 
+// A computation pass which renames instructions named 'foo' to 'bar', and
+// counts its runs on each computation.
+class FooToBarComputationPass : public HloComputationPass {
+ public:
+  explicit FooToBarComputationPass(bool thread_safe = false)
+      : thread_safe_(thread_safe) {}
+  absl::string_view name() const override { return "foo2bar-computation"; }
+
+  StatusOr<bool> RunOnComputation(HloComputation* computation) override {
+    {
+      tensorflow::mutex_lock lock(mu_);
+      ++runs_[computation->name()];
+    }
+    bool changed = false;
+    for (HloInstruction* instruction : computation->instructions()) {
+      if (instruction->name() == "foo") {
+        instruction->SetAndSanitizeName("bar");
+        changed = true;
+      }
+    }
+    return changed;
+  }
+
+  std::map<std::string, int> runs() {
+    tensorflow::mutex_lock lock(mu_);
+    return runs_;
+  }
+
+ protected:
+  bool RunOnComputationIsThreadSafe() const override { return thread_safe_; }
+
+ private:
+  const bool thread_safe_;
+  tensorflow::mutex mu_;
+  std::map<std::string, int> runs_ TF_GUARDED_BY(mu_);
+};
+
 // A module group pass which renames instructions named 'baz' to 'qux'.
 class BazToQuxModuleGroupPass : public HloModuleGroupPass {
   absl::string_view name() const override { return "baz2qux"; }
@@ -297,5 +342,84 @@ TEST_F(HloPassPipelineTest, SetHloModuleMetadata) {
   }
 }
 
+TEST_F(HloPassPipelineTest, RecordsPassProfile) {
+  const std::string module_str = R"(
+HloModule RecordsPassProfile
+
+ENTRY main {
+  a = f32[] parameter(0)
+  b = f32[] parameter(1)
+  ROOT foo = f32[] multiply(a, b)
+}
+)";
+  TF_ASSERT_OK_AND_ASSIGN(std::unique_ptr<VerifiedHloModule> module,
+                          ParseAndReturnVerifiedModule(module_str));
+  HloPassPipeline pipeline(TestName());
+  pipeline.AddPass<FooToBarModulePass>();
+  TF_ASSERT_OK(pipeline.Run(module.get()).status());
+
+  const HloModuleMetadataProto& metadata = module->metadata().proto();
+  ASSERT_THAT(metadata.pass_metadata(), SizeIs(2));
+  const HloPassMetadata& pass_metadata = metadata.pass_metadata(1);
+  EXPECT_THAT(pass_metadata.pass_name(), StrEq("foo2bar"));
+  EXPECT_TRUE(pass_metadata.module_changed());
+  EXPECT_EQ(pass_metadata.instruction_count_before(), 3);
+  EXPECT_EQ(pass_metadata.instruction_count_after(), 3);
+  EXPECT_GE(pass_metadata.peak_memory_bytes(), 0);
+}
+
+constexpr char kTwoCallsModule[] = R"(
+HloModule TwoCalls
+
+a {
+  p = f32[] parameter(0)
+  ROOT foo = f32[] negate(p)
+}
+
+b {
+  p = f32[] parameter(0)
+  ROOT baz = f32[] exponential(p)
+}
+
+ENTRY main {
+  x = f32[] parameter(0)
+  call_a = f32[] call(x), to_apply=a
+  ROOT call_b = f32[] call(call_a), to_apply=b
+}
+)";
+
+TEST_F(HloPassPipelineTest, FixedPointRevisitsOnlyChangedComputations) {
+  TF_ASSERT_OK_AND_ASSIGN(std::unique_ptr<VerifiedHloModule> module,
+                          ParseAndReturnVerifiedModule(kTwoCallsModule));
+  HloPassFix<HloPassPipeline> pipeline(TestName());
+  FooToBarComputationPass& pass =
+      pipeline.AddPass<FooToBarComputationPass>();
+  TF_ASSERT_OK_AND_ASSIGN(bool changed, pipeline.Run(module.get()));
+  EXPECT_TRUE(changed);
+  EXPECT_EQ(module->GetComputationWithName("a")->root_instruction()->name(),
+            "bar");
+
+  // The second iteration only revisits the changed computation and its caller.
+  const std::map<std::string, int> expected_runs = {
+      {"a", 2}, {"b", 1}, {"main", 2}};
+  EXPECT_EQ(pass.runs(), expected_runs);
+}
+
+TEST_F(HloPassPipelineTest, ComputationPassRunsInParallel) {
+  TF_ASSERT_OK_AND_ASSIGN(std::unique_ptr<VerifiedHloModule> module,
+                          ParseAndReturnVerifiedModule(kTwoCallsModule));
+  tensorflow::thread::ThreadPool thread_pool(tensorflow::Env::Default(),
+                                             TestName(), 4);
+  FooToBarComputationPass pass(/*thread_safe=*/true);
+  pass.set_thread_pool(&thread_pool);
+  TF_ASSERT_OK_AND_ASSIGN(bool changed, pass.Run(module.get()));
+  EXPECT_TRUE(changed);
+  EXPECT_EQ(module->GetComputationWithName("a")->root_instruction()->name(),
+            "bar");
+  const std::map<std::string, int> expected_runs = {
+      {"a", 1}, {"b", 1}, {"main", 1}};
+  EXPECT_EQ(pass.runs(), expected_runs);
+}
+
 }  // namespace
 }  // namespace xla
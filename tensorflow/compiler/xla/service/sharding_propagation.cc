@@ -2413,6 +2413,15 @@ StatusOr<bool> ShardingPropagation::Run(HloModule* module) {
     provided_shardings.insert(module->entry_computation()->root_instruction());
   }
 
+  // The propagation below doesn't change the graph, so the post orders are
+  // computed once for all the iterations.
+  std::vector<std::pair<const HloComputation*, std::vector<HloInstruction*>>>
+      post_orders;
+  for (const HloComputation* computation : module->computations()) {
+    post_orders.emplace_back(computation,
+                             computation->MakeInstructionPostOrder());
+  }
+
   // Iterate to a fixpoint that is guaranteed to be reached because we only
   // strictly improve the sharding of the graph and it can't be improved
   // indefinitely.
@@ -2420,19 +2429,31 @@ StatusOr<bool> ShardingPropagation::Run(HloModule* module) {
   auto run_to_fix_point = [&](int64_t aggressiveness) {
     absl::flat_hash_set<const HloInstruction*> already_inferred_from_operands;
     absl::flat_hash_set<const HloInstruction*> already_inferred_from_users;
+    // Computations with an instruction whose neighbors changed sharding since
+    // it was last visited. The others can't change, so an iteration only
+    // visits these.
+    absl::flat_hash_set<const HloComputation*> dirty_computations;
+    for (const auto& post_order : post_orders) {
+      dirty_computations.insert(post_order.first);
+    }
     bool changed_last_iter = true;
     const bool may_merge_partial = is_spmd_ && aggressiveness > 0;
     while (changed_last_iter) {
       changed_last_iter = false;
       int64_t inferred_from_operand_counter = 0;
       int64_t inferred_from_user_counter = 0;
+      int64_t computation_counter = 0;
       int64_t instruction_counter = 0;
       int64_t already_sharded_counter = 0;
-      for (const HloComputation* computation : module->computations()) {
+      for (const auto& post_order : post_orders) {
+        const HloComputation* computation = post_order.first;
+        if (!dirty_computations.erase(computation)) {
+          continue;
+        }
         VLOG(2) << "Consider computation: " << computation->name();
-        std::vector<HloInstruction*> instructions =
-            computation->MakeInstructionPostOrder();
+        const std::vector<HloInstruction*>& instructions = post_order.second;
 
+        ++computation_counter;
         instruction_counter += instructions.size();
         for (const HloInstruction* instruction : instructions) {
           already_sharded_counter += (instruction->has_sharding() ? 1 : 0);
@@ -2441,12 +2462,14 @@ StatusOr<bool> ShardingPropagation::Run(HloModule* module) {
                                HloInstruction* hlo_for_users = nullptr) {
           for (auto operand : hlo->operands()) {
             already_inferred_from_users.erase(operand);
+            dirty_computations.insert(operand->parent());
           }
           if (hlo_for_users == nullptr) {
             hlo_for_users = hlo;
           }
           for (auto user : hlo_for_users->users()) {
             already_inferred_from_operands.erase(user);
+            dirty_computations.insert(user->parent());
           }
         };
         // First iterate the HLO graph in post order taking shardings from
@@ -2544,7 +2567,8 @@ StatusOr<bool> ShardingPropagation::Run(HloModule* module) {
         }
       }
       VLOG(1) << "Sharding propagation iteration " << iterations << ";";
-      VLOG(1) << "  total instructions: " << instruction_counter;
+      VLOG(1) << "  computations visited: " << computation_counter;
+      VLOG(1) << "  instructions visited: " << instruction_counter;
       VLOG(1) << "  instructions already sharded: " << already_sharded_counter;
       VLOG(1) << "  shardings inferred from operands: "
               << inferred_from_operand_counter;
@@ -5935,5 +5935,53 @@ ENTRY %entry {
       op::Sharding("{devices=[1,4,2]0,1,2,3,4,5,6,7 last_tile_dim_replicate}"));
 }
 
+TEST_F(ShardingPropagationTest, RevisitWhileBodyAfterChangeInCaller) {
+  // The body is visited before the entry computation, so it has to be
+  // revisited once the sharding reaches the while from the caller.
+  const char* const hlo_string = R"(
+HloModule module
+
+%cond {
+  %vars.cond = (u32[], f32[8,16]) parameter(0)
+  %count.cond = u32[] get-tuple-element(%vars.cond), index=0
+  %limit = u32[] constant(10)
+  ROOT %lt = pred[] compare(%count.cond, %limit), direction=LT
+}
+
+%body {
+  %param = (u32[], f32[8,16]) parameter(0)
+  %count = u32[] get-tuple-element(%param), index=0
+  %one = u32[] constant(1)
+  %next = u32[] add(%count, %one)
+  %data = f32[8,16] get-tuple-element(%param), index=1
+  %negate = f32[8,16] negate(%data)
+  %exp = f32[8,16] exponential(%negate)
+  ROOT %tuple = (u32[], f32[8,16]) tuple(%next, %exp)
+}
+
+ENTRY %entry {
+  %zero = u32[] constant(0)
+  %p0 = f32[8,16] parameter(0), sharding={devices=[2,2]0,1,2,3}
+  %copy = f32[8,16] copy(%p0)
+  %init = (u32[], f32[8,16]) tuple(%zero, %copy)
+  %while = (u32[], f32[8,16]) while(%init), body=%body, condition=%cond
+  %result = f32[8,16] get-tuple-element(%while), index=1
+  ROOT %abs = f32[8,16] abs(%result)
+})";
+  TF_ASSERT_OK_AND_ASSIGN(auto module,
+                          ParseAndReturnVerifiedModule(hlo_string));
+  TF_ASSERT_OK_AND_ASSIGN(
+      bool changed,
+      ShardingPropagation(/*is_spmd=*/true, /*propagate_metadata=*/false,
+                          /*allow_spmd_sharding_propagation_to_output=*/true)
+          .Run(module.get()));
+  EXPECT_TRUE(changed);
+  for (absl::string_view name : {"negate", "exp", "result", "abs"}) {
+    auto* instruction = FindInstruction(module.get(), name);
+    ASSERT_NE(instruction, nullptr);
+    EXPECT_THAT(instruction, op::Sharding("{devices=[2,2]0,1,2,3}")) << name;
+  }
+}
+
 }  // namespace
 }  // namespace xla
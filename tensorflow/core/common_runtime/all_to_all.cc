@@ -14,6 +14,7 @@ limitations under the License.
 ==============================================================================*/
 #include "tensorflow/core/common_runtime/all_to_all.h"
 
+#include <memory>
 #include <utility>
 
 #include "tensorflow/core/common_runtime/collective_rma_local.h"
@@ -27,6 +28,7 @@ limitations under the License.
 #include "tensorflow/core/framework/device_base.h"
 #include "tensorflow/core/framework/op_kernel.h"
 #include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_shape.h"
 #include "tensorflow/core/framework/types.h"
 #include "tensorflow/core/lib/core/errors.h"
 #include "tensorflow/core/lib/core/notification.h"
@@ -145,8 +147,233 @@ void AllToAll::DispatchRecv(int src_rank, int target_rank, Tensor* tensor,
       0, col_ctx_->op_ctx->cancellation_manager(), done);
 }
 
+namespace {
+// Returns the key of the transfer from `src_rank` to `target_rank` in `phase`
+// of an all-to-all-v.
+string AllToAllVKey(const string& exec_key, StringPiece phase, int src_rank,
+                    int target_rank) {
+  return strings::StrCat(exec_key, ":", phase, ":", src_rank, ":",
+                         target_rank);
+}
+}  // namespace
+
+AllToAllV::AllToAllV()
+    : col_ctx_(nullptr), col_params_(nullptr), done_(nullptr) {}
+
+StatusCallback AllToAllV::CountDown(int count, StatusCallback done) {
+  struct State {
+    mutex mu;
+    int pending TF_GUARDED_BY(mu);
+    Status status TF_GUARDED_BY(mu);
+  };
+  auto state = std::make_shared<State>();
+  {
+    mutex_lock l(state->mu);
+    state->pending = count;
+  }
+  return [state, done = std::move(done)](const Status& s) {
+    Status final_status;
+    {
+      mutex_lock l(state->mu);
+      state->status.Update(s);
+      if (--state->pending > 0) {
+        return;
+      }
+      final_status = state->status;
+    }
+    done(final_status);
+  };
+}
+
+Status AllToAllV::InitializeCollectiveContext(
+    std::shared_ptr<CollectiveContext> col_ctx) {
+  const int group_size = col_ctx->col_params->group.group_size;
+  if (col_ctx->input->dims() < 1) {
+    return errors::InvalidArgument(
+        "input to all-to-all-v must be at least 1-D, got shape ",
+        col_ctx->input->shape().DebugString());
+  }
+  if (col_ctx->op_ctx->num_inputs() < 2) {
+    return errors::Internal(
+        "all-to-all-v expects the split sizes as the second input");
+  }
+  const Tensor& send_counts = col_ctx->op_ctx->input(1);
+  if (send_counts.dtype() != DT_INT64 ||
+      !TensorShapeUtils::IsVector(send_counts.shape()) ||
+      send_counts.NumElements() != group_size) {
+    return errors::InvalidArgument(
+        "split sizes of all-to-all-v must be an int64 vector of the group "
+        "size (",
+        group_size, "), got ", DataTypeString(send_counts.dtype()), " ",
+        send_counts.shape().DebugString());
+  }
+  auto counts = send_counts.vec<int64_t>();
+  col_ctx->send_counts.resize(group_size);
+  col_ctx->send_offsets.resize(group_size);
+  int64_t offset = 0;
+  for (int i = 0; i < group_size; ++i) {
+    if (counts(i) < 0) {
+      return errors::InvalidArgument(
+          "split sizes of all-to-all-v must be non-negative, got ", counts(i),
+          " for group member ", i);
+    }
+    col_ctx->send_counts[i] = counts(i);
+    col_ctx->send_offsets[i] = offset;
+    offset += counts(i);
+  }
+  if (offset != col_ctx->input->dim_size(0)) {
+    return errors::InvalidArgument(
+        "split sizes of all-to-all-v add up to ", offset,
+        " but the first dimension of the input is ",
+        col_ctx->input->dim_size(0));
+  }
+  DCHECK(col_ctx->dev_mgr);
+  col_ctx_ = col_ctx;
+  col_params_ = col_ctx->col_params.get();
+  return collective_util::InitializeDeviceAndLocality(
+      col_ctx->dev_mgr, col_ctx->device_name, &col_ctx->device,
+      &col_ctx->device_locality);
+}
+
+void AllToAllV::Run(StatusCallback done) {
+  done_ = std::move(done);
+  const int group_size = col_params_->group.group_size;
+  const int default_rank = col_params_->default_rank;
+  // The counts live in host memory regardless of the device.
+  AllocatorAttributes host_attr;
+  host_attr.set_on_host(true);
+  const Tensor& send_counts = col_ctx_->op_ctx->input(1);
+  recv_counts_ = Tensor(col_ctx_->device->GetAllocator(host_attr), DT_INT64,
+                        TensorShape({group_size}));
+  send_count_chunks_.reserve(group_size);
+  recv_count_chunks_.reserve(group_size);
+  for (int i = 0; i < group_size; ++i) {
+    send_count_chunks_.push_back(send_counts.Slice(i, i + 1));
+    recv_count_chunks_.push_back(recv_counts_.Slice(i, i + 1));
+  }
+
+  StatusCallback counts_done =
+      CountDown(2 * group_size, [this](const Status& s) {
+        if (!s.ok()) {
+          done_(s);
+          return;
+        }
+        OnCountsExchanged();
+      });
+  for (int i = 0; i < group_size; ++i) {
+    DispatchSend("counts", default_rank, i, host_attr, &send_count_chunks_[i],
+                 counts_done);
+    DispatchRecv("counts", i, default_rank, host_attr, &recv_count_chunks_[i],
+                 counts_done);
+  }
+}
+
+void AllToAllV::OnCountsExchanged() {
+  const int group_size = col_params_->group.group_size;
+  auto counts = recv_counts_.vec<int64_t>();
+  // Select the output position of each member based on user specified rank,
+  // if available.
+  std::vector<int> member_at_rank(group_size);
+  for (int i = 0; i < group_size; ++i) {
+    member_at_rank[col_params_->group.members[i].rank] = i;
+  }
+  col_ctx_->recv_counts.resize(group_size);
+  col_ctx_->recv_offsets.resize(group_size);
+  int64_t num_rows = 0;
+  for (int r = 0; r < group_size; ++r) {
+    const int i = member_at_rank[r];
+    if (counts(i) < 0) {
+      done_(errors::Internal("all-to-all-v received a negative split size ",
+                             counts(i), " from group member ", i));
+      return;
+    }
+    col_ctx_->recv_counts[i] = counts(i);
+    col_ctx_->recv_offsets[i] = num_rows;
+    num_rows += counts(i);
+  }
+
+  TensorShape output_shape = col_ctx_->input->shape();
+  output_shape.set_dim(0, num_rows);
+  Tensor* output = nullptr;
+  Status s = col_ctx_->op_ctx->allocate_output(0, output_shape, &output);
+  Tensor* recv_counts = nullptr;
+  if (s.ok()) {
+    s = col_ctx_->op_ctx->allocate_output(1, TensorShape({group_size}),
+                                          &recv_counts);
+  }
+  if (!s.ok()) {
+    done_(s);
+    return;
+  }
+  auto recv_counts_flat = recv_counts->vec<int64_t>();
+  for (int r = 0; r < group_size; ++r) {
+    recv_counts_flat(r) = counts(member_at_rank[r]);
+  }
+  col_ctx_->output = output;
+  ExchangeData(done_);
+}
+
+void AllToAllV::ExchangeData(StatusCallback done) {
+  const int group_size = col_params_->group.group_size;
+  const int default_rank = col_params_->default_rank;
+  const AllocatorAttributes attr = col_ctx_->op_ctx->output_alloc_attr(0);
+  input_chunks_.reserve(group_size);
+  output_chunks_.reserve(group_size);
+  for (int i = 0; i < group_size; ++i) {
+    input_chunks_.push_back(col_ctx_->input->Slice(
+        col_ctx_->send_offsets[i],
+        col_ctx_->send_offsets[i] + col_ctx_->send_counts[i]));
+    output_chunks_.push_back(col_ctx_->output->Slice(
+        col_ctx_->recv_offsets[i],
+        col_ctx_->recv_offsets[i] + col_ctx_->recv_counts[i]));
+  }
+
+  StatusCallback chunk_done = CountDown(2 * group_size, std::move(done));
+  for (int i = 0; i < group_size; ++i) {
+    // Both sides know the size of every chunk, so empty chunks are skipped.
+    if (col_ctx_->send_counts[i] > 0) {
+      DispatchSend("data", default_rank, i, attr, &input_chunks_[i],
+                   chunk_done);
+    } else {
+      chunk_done(OkStatus());
+    }
+    if (col_ctx_->recv_counts[i] > 0) {
+      DispatchRecv("data", i, default_rank, attr, &output_chunks_[i],
+                   chunk_done);
+    } else {
+      chunk_done(OkStatus());
+    }
+  }
+}
+
+void AllToAllV::DispatchSend(const string& key_prefix, int src_rank,
+                             int target_rank, const AllocatorAttributes& attr,
+                             const Tensor* tensor, const StatusCallback& done) {
+  col_ctx_->col_exec->remote_access()->PostToPeer(
+      col_params_->group.members[target_rank].device.name(),
+      col_params_->group.members[target_rank].task,
+      AllToAllVKey(col_ctx_->exec_key, key_prefix, src_rank, target_rank),
+      col_ctx_->device, col_ctx_->op_ctx->op_device_context(), attr, tensor,
+      col_ctx_->device_locality, col_ctx_->op_ctx->cancellation_manager(),
+      done);
+}
+
+void AllToAllV::DispatchRecv(const string& key_prefix, int src_rank,
+                             int target_rank, const AllocatorAttributes& attr,
+                             Tensor* tensor, const StatusCallback& done) {
+  col_ctx_->col_exec->remote_access()->RecvFromPeer(
+      col_params_->group.members[src_rank].device.name(),
+      col_params_->group.members[src_rank].task,
+      col_params_->group.members[src_rank].is_local,
+      AllToAllVKey(col_ctx_->exec_key, key_prefix, src_rank, target_rank),
+      col_ctx_->device, col_ctx_->op_ctx->op_device_context(), attr, tensor,
+      col_ctx_->device_locality, 0, col_ctx_->op_ctx->cancellation_manager(),
+      done);
+}
+
 namespace {
 REGISTER_COLLECTIVE(AllToAll, AllToAll);
+REGISTER_COLLECTIVE(AllToAllV, AllToAllV);
 }  // namespace
 
 }  // namespace tensorflow
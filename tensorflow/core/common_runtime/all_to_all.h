@@ -21,6 +21,7 @@ limitations under the License.
 #include <vector>
 
 #include "tensorflow/core/common_runtime/base_collective_executor.h"
+#include "tensorflow/core/framework/allocator.h"
 #include "tensorflow/core/framework/collective.h"
 #include "tensorflow/core/framework/device.h"
 
@@ -65,5 +66,61 @@ class AllToAll : public CollectiveImplementationInterface {
   StatusCallback CheckCounterAndCallDone();
 };
 
+// Implementation of collective all-to-all with variable split sizes.  The
+// first input is split along its first dimension into group_size chunks whose
+// number of rows is given by the second input of the op, a host int64 vector,
+// and chunk i is sent to group member i.  The number of rows each member sends
+// is exchanged as part of the collective, so the output, which concatenates
+// the received chunks in rank order, is allocated by the collective itself.
+// The op's second output is set to the number of rows received from each
+// member.
+class AllToAllV : public CollectiveImplementationInterface {
+ public:
+  AllToAllV();
+
+  void Run(StatusCallback done) override;
+
+  Status InitializeCollectiveParams(CollectiveParams* col_params) override {
+    return OkStatus();
+  }
+
+  // Validates the split sizes, fills the send counts and offsets of the
+  // CollectiveContext and initializes device and device_locality.  Also saves
+  // the CollectiveContext in this object.
+  Status InitializeCollectiveContext(
+      std::shared_ptr<CollectiveContext> col_ctx) override;
+
+ protected:
+  // Moves the chunks once the counts have been exchanged and the output has
+  // been allocated.  Calls done once all chunks have been sent and received.
+  virtual void ExchangeData(StatusCallback done);
+
+  std::shared_ptr<CollectiveContext> col_ctx_;
+  const CollectiveParams* col_params_;  // Not owned
+
+ private:
+  // Allocates the outputs from the exchanged counts and starts ExchangeData.
+  void OnCountsExchanged();
+
+  // Returns a callback that records its status and invokes `done` with the
+  // first error once it has been invoked `count` times.
+  StatusCallback CountDown(int count, StatusCallback done);
+
+  void DispatchSend(const string& key_prefix, int src_rank, int target_rank,
+                    const AllocatorAttributes& attr, const Tensor* tensor,
+                    const StatusCallback& done);
+
+  void DispatchRecv(const string& key_prefix, int src_rank, int target_rank,
+                    const AllocatorAttributes& attr, Tensor* tensor,
+                    const StatusCallback& done);
+
+  std::vector<Tensor> send_count_chunks_;
+  Tensor recv_counts_;
+  std::vector<Tensor> recv_count_chunks_;
+  std::vector<Tensor> input_chunks_;
+  std::vector<Tensor> output_chunks_;
+  StatusCallback done_;
+};
+
 }  // namespace tensorflow
 #endif  // TENSORFLOW_CORE_COMMON_RUNTIME_ALL_TO_ALL_H_
@@ -17,12 +17,17 @@ limitations under the License.
 #include "tensorflow/core/common_runtime/collective_test_util.h"
 #include "tensorflow/core/common_runtime/process_util.h"
 #include "tensorflow/core/framework/device.h"
+#include "tensorflow/core/framework/node_def.pb.h"
+#include "tensorflow/core/framework/op.h"
+#include "tensorflow/core/framework/op_kernel.h"
 #include "tensorflow/core/framework/tensor_shape.h"
 #include "tensorflow/core/framework/tensor_testutil.h"
 #include "tensorflow/core/framework/types.pb.h"
+#include "tensorflow/core/lib/core/notification.h"
 #include "tensorflow/core/platform/blocking_counter.h"
 #include "tensorflow/core/platform/mutex.h"
 #include "tensorflow/core/platform/test.h"
+#include "tensorflow/core/public/version.h"
 
 namespace tensorflow {
 namespace {
@@ -156,5 +161,194 @@ TEST_F(AllToAllTest, WrongFirstDimensionSize) {
   counter.Wait();
 }
 
+// AllToAllV reads the split sizes from and allocates the outputs of the op it
+// runs for, so the tests run it for a kernel with the same signature as
+// CollectiveAllToAllVV3.
+REGISTER_OP("AllToAllVTestOp")
+    .Input("input: double")
+    .Input("send_counts: int64")
+    .Output("data: double")
+    .Output("recv_counts: int64");
+
+class AllToAllVTestOp : public OpKernel {
+ public:
+  explicit AllToAllVTestOp(OpKernelConstruction* c) : OpKernel(c) {}
+  void Compute(OpKernelContext* c) override {}
+};
+
+REGISTER_KERNEL_BUILDER(Name("AllToAllVTestOp").Device(DEVICE_CPU),
+                        AllToAllVTestOp);
+
+// Runs AllToAllV on `device` and sets `output` and `recv_counts`.
+Status RunAllToAllV(CollectiveTestEnv* test_env, CollectiveParams* col_params,
+                    Device* device, const Tensor& input,
+                    const Tensor& send_counts, Tensor* output,
+                    Tensor* recv_counts) {
+  NodeDef node_def;
+  node_def.set_name("all_to_all_v");
+  node_def.set_op("AllToAllVTestOp");
+  node_def.add_input("input");
+  node_def.add_input("send_counts");
+  Status status;
+  std::unique_ptr<OpKernel> kernel =
+      CreateOpKernel(DEVICE_CPU, device, device->GetAllocator({}), node_def,
+                     TF_GRAPH_DEF_VERSION, &status);
+  TF_RETURN_IF_ERROR(status);
+
+  Tensor input_buffer = input;
+  Tensor send_counts_buffer = send_counts;
+  OpKernelContext::Params op_params;
+  CancellationManager cancellation_manager;
+  op_params.step_id = 0;
+  op_params.device = device;
+  op_params.op_kernel = kernel.get();
+  op_params.cancellation_manager = &cancellation_manager;
+  gtl::InlinedVector<TensorValue, 4> inputs;
+  inputs.push_back(TensorValue(&input_buffer));
+  inputs.push_back(TensorValue(&send_counts_buffer));
+  op_params.inputs = &inputs;
+  gtl::InlinedVector<AllocatorAttributes, 4> input_aa(2);
+  op_params.input_alloc_attrs = &input_aa;
+  DeviceContext* dev_ctx = new DeviceContext;
+  core::ScopedUnref unref_dev_ctx(dev_ctx);
+  op_params.op_device_context = dev_ctx;
+  AllocatorAttributes output_aa[2];
+  op_params.output_attr_array = output_aa;
+  op_params.resource_manager = device->resource_manager();
+  OpKernelContext ctx(&op_params, 2);
+
+  CollectiveImplementationInterface* collective_impl = nullptr;
+  TF_CHECK_OK(CollectiveRegistry::Lookup(
+      col_params->instance.impl_details.collective_name, &collective_impl));
+  core::ScopedUnref unref_collective_impl(collective_impl);
+  TF_RETURN_IF_ERROR(collective_impl->InitializeCollectiveParams(col_params));
+  auto col_ctx = std::make_shared<CollectiveContext>(
+      test_env->col_exec.get(), /*nccl_communicator*/ nullptr,
+      test_env->device_mgr.get(), &ctx, &op_params, col_params,
+      strings::StrCat(col_params->instance.instance_key, ":0:0"),
+      op_params.step_id, &input_buffer, /*output*/ nullptr);
+  TF_RETURN_IF_ERROR(collective_impl->InitializeCollectiveContext(col_ctx));
+
+  Notification n;
+  collective_impl->Run([&status, &n](Status s) {
+    status = s;
+    n.Notify();
+  });
+  n.WaitForNotification();
+  if (status.ok()) {
+    *output = *ctx.mutable_output(0);
+    *recv_counts = *ctx.mutable_output(1);
+  }
+  return status;
+}
+
+class AllToAllVTest : public ::testing::Test {
+ protected:
+  std::unique_ptr<CollectiveTestEnv> test_env_;
+};
+
+TEST_F(AllToAllVTest, Success) {
+  test_env_ = CreateCollectiveTestEnv(/*num_workers*/ 1,
+                                      /*num_devices_per_worker*/ 3, DEVICE_CPU);
+  std::vector<Tensor> inputs = {
+      test::AsTensor<double>({1., 2., 3.}),
+      test::AsTensor<double>({4., 5.}),
+      test::AsTensor<double>({6., 7., 8., 9.}),
+  };
+  std::vector<Tensor> send_counts = {
+      test::AsTensor<int64_t>({1, 0, 2}),
+      test::AsTensor<int64_t>({2, 0, 0}),
+      test::AsTensor<int64_t>({0, 3, 1}),
+  };
+  std::vector<Tensor> outputs(3);
+  std::vector<Tensor> recv_counts(3);
+  BlockingCounter counter(3);
+  for (int i = 0; i < 3; ++i) {
+    SchedClosure([&, i]() {
+      auto col_params = CreateCollectiveParams(
+          *test_env_, i, "AllToAllV", ALL_TO_ALL_V_COLLECTIVE, DT_DOUBLE,
+          TensorShape({}));
+      Device* device = nullptr;
+      TF_CHECK_OK(test_env_->device_mgr->LookupDevice(
+          col_params->group.members[i].device.name(), &device));
+      TF_CHECK_OK(RunAllToAllV(test_env_.get(), col_params.get(), device,
+                               inputs[i], send_counts[i], &outputs[i],
+                               &recv_counts[i]));
+      counter.DecrementCount();
+    });
+  }
+  counter.Wait();
+  test::ExpectTensorEqual<double>(outputs[0],
+                                  test::AsTensor<double>({1., 4., 5.}));
+  test::ExpectTensorEqual<double>(outputs[1],
+                                  test::AsTensor<double>({6., 7., 8.}));
+  test::ExpectTensorEqual<double>(outputs[2],
+                                  test::AsTensor<double>({2., 3., 9.}));
+  test::ExpectTensorEqual<int64_t>(recv_counts[0],
+                                   test::AsTensor<int64_t>({1, 2, 0}));
+  test::ExpectTensorEqual<int64_t>(recv_counts[1],
+                                   test::AsTensor<int64_t>({0, 0, 3}));
+  test::ExpectTensorEqual<int64_t>(recv_counts[2],
+                                   test::AsTensor<int64_t>({2, 0, 1}));
+}
+
+TEST_F(AllToAllVTest, Rows) {
+  test_env_ = CreateCollectiveTestEnv(/*num_workers*/ 1,
+                                      /*num_devices_per_worker*/ 2, DEVICE_CPU);
+  std::vector<Tensor> inputs = {
+      test::AsTensor<double>({1., 2., 3., 4., 5., 6.}, TensorShape({3, 2})),
+      test::AsTensor<double>({7., 8.}, TensorShape({1, 2})),
+  };
+  std::vector<Tensor> send_counts = {
+      test::AsTensor<int64_t>({1, 2}),
+      test::AsTensor<int64_t>({0, 1}),
+  };
+  std::vector<Tensor> outputs(2);
+  std::vector<Tensor> recv_counts(2);
+  BlockingCounter counter(2);
+  for (int i = 0; i < 2; ++i) {
+    SchedClosure([&, i]() {
+      auto col_params = CreateCollectiveParams(
+          *test_env_, i, "AllToAllV", ALL_TO_ALL_V_COLLECTIVE, DT_DOUBLE,
+          TensorShape({2}));
+      Device* device = nullptr;
+      TF_CHECK_OK(test_env_->device_mgr->LookupDevice(
+          col_params->group.members[i].device.name(), &device));
+      TF_CHECK_OK(RunAllToAllV(test_env_.get(), col_params.get(), device,
+                               inputs[i], send_counts[i], &outputs[i],
+                               &recv_counts[i]));
+      counter.DecrementCount();
+    });
+  }
+  counter.Wait();
+  test::ExpectTensorEqual<double>(
+      outputs[0], test::AsTensor<double>({1., 2.}, TensorShape({1, 2})));
+  test::ExpectTensorEqual<double>(
+      outputs[1],
+      test::AsTensor<double>({3., 4., 5., 6., 7., 8.}, TensorShape({3, 2})));
+}
+
+TEST_F(AllToAllVTest, WrongSplitSizes) {
+  test_env_ = CreateCollectiveTestEnv(/*num_workers*/ 1,
+                                      /*num_devices_per_worker*/ 2, DEVICE_CPU);
+  auto col_params =
+      CreateCollectiveParams(*test_env_, 0, "AllToAllV",
+                             ALL_TO_ALL_V_COLLECTIVE, DT_DOUBLE, TensorShape());
+  Device* device = nullptr;
+  TF_CHECK_OK(test_env_->device_mgr->LookupDevice(
+      col_params->group.members[0].device.name(), &device));
+  Tensor output, recv_counts;
+  Status status = RunAllToAllV(
+      test_env_.get(), col_params.get(), device,
+      test::AsTensor<double>({1., 2., 3.}), test::AsTensor<int64_t>({1, 1}),
+      &output, &recv_counts);
+  EXPECT_TRUE(errors::IsInvalidArgument(status)) << status;
+  status = RunAllToAllV(test_env_.get(), col_params.get(), device,
+                        test::AsTensor<double>({1., 2.}),
+                        test::AsTensor<int64_t>({3, -1}), &output,
+                        &recv_counts);
+  EXPECT_TRUE(errors::IsInvalidArgument(status)) << status;
+}
+
 }  // namespace
 }  // namespace tensorflow
@@ -307,6 +307,7 @@ void BaseCollectiveExecutor::ExecuteAsync(OpKernelContext* ctx,
                          col_params->instance.type == GATHER_COLLECTIVE ||
                          col_params->instance.type == PERMUTE_COLLECTIVE ||
                          col_params->instance.type == ALL_TO_ALL_COLLECTIVE ||
+                         col_params->instance.type == ALL_TO_ALL_V_COLLECTIVE ||
                          (col_params->instance.type == BROADCAST_COLLECTIVE &&
                           col_params->is_source))
                             ? &ctx->input(0)
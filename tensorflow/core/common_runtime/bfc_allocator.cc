@@ -17,15 +17,24 @@ limitations under the License.
 
 #include <algorithm>
 #include <atomic>
+#include <functional>
+#include <thread>  // NOLINT
 #include <utility>
 
+#include "absl/algorithm/container.h"
+#include "absl/container/inlined_vector.h"
+#include "absl/memory/memory.h"
+#include "absl/strings/str_cat.h"
 #include "absl/strings/string_view.h"
 #include "tensorflow/core/common_runtime/allocator_retry.h"
+#include "tensorflow/core/framework/metrics.h"
 #include "tensorflow/core/lib/core/bits.h"
 #include "tensorflow/core/lib/strings/numbers.h"
 #include "tensorflow/core/lib/strings/str_util.h"
 #include "tensorflow/core/lib/strings/strcat.h"
+#include "tensorflow/core/platform/env.h"
 #include "tensorflow/core/platform/file_system.h"
+#include "tensorflow/core/platform/hash.h"
 #include "tensorflow/core/platform/logging.h"
 #include "tensorflow/core/platform/mutex.h"
 #ifdef TENSORFLOW_MEM_DEBUG
@@ -40,6 +49,20 @@ namespace tensorflow {
 
 constexpr BFCAllocator::ChunkHandle BFCAllocator::kInvalidChunkHandle;
 
+namespace {
+// The stream installed by the innermost BFCAllocator::ScopedStream.
+thread_local void* current_allocation_stream = nullptr;
+}  // namespace
+
+BFCAllocator::ScopedStream::ScopedStream(void* stream)
+    : previous_stream_(current_allocation_stream) {
+  current_allocation_stream = stream;
+}
+
+BFCAllocator::ScopedStream::~ScopedStream() {
+  current_allocation_stream = previous_stream_;
+}
+
 BFCAllocator::BFCAllocator(std::unique_ptr<SubAllocator> sub_allocator,
                            size_t total_memory, const string& name,
                            const Options& opts)
@@ -47,6 +70,7 @@ BFCAllocator::BFCAllocator(std::unique_ptr<SubAllocator> sub_allocator,
       coalesce_regions_(sub_allocator->SupportsCoalescing()),
       sub_allocator_(std::move(sub_allocator)),
       name_(name),
+      stream_ordered_(opts.then_execute_on_stream != nullptr),
       free_chunks_list_(kInvalidChunkHandle),
       next_allocation_id_(1) {
   if (opts.allow_growth) {
@@ -80,9 +104,27 @@ BFCAllocator::BFCAllocator(std::unique_ptr<SubAllocator> sub_allocator,
       CHECK_NE(BinForSize(bin_size * 2), BinFromIndex(b));
     }
   }
+
+  if (opts.record_telemetry) {
+    fragmentation_cell_ = metrics::GetBfcFragmentationSampler(name_);
+    phase_peak_cell_ = metrics::GetBfcPeakBytesInUseGauge(name_, "default");
+  }
+
+  if (opts.use_thread_local_caches && !stream_ordered_ &&
+      !opts.record_telemetry) {
+    chunk_caches_.reset(new ChunkCache[kNumChunkCaches]);
+    owned_chunk_shards_.reset(new OwnedChunkShard[kNumChunkCaches]);
+  }
 }
 
 BFCAllocator::~BFCAllocator() {
+  {
+    mutex_lock l(lock_);
+    while (num_pending_stream_callbacks_ > 0) {
+      stream_callbacks_done_.wait(l);
+    }
+  }
+
   // Return memory back.
   VLOG(2) << "Number of regions allocated: "
           << region_manager_.regions().size();
@@ -165,12 +207,17 @@ bool BFCAllocator::Extend(size_t alignment, size_t rounded_bytes) {
   VLOG(1) << "Allocated memory at " << mem_addr << " to "
           << static_cast<void*>(static_cast<char*>(mem_addr) + bytes_received);
 
+  AddFreeMemory(mem_addr, bytes_received);
+  return true;
+}
+
+void BFCAllocator::AddFreeMemory(void* mem_addr, size_t bytes) {
   AllocationRegion* maybe_extended_region = nullptr;
   if (coalesce_regions_) {
     maybe_extended_region =
-        region_manager_.AddOrExtendAllocationRegion(mem_addr, bytes_received);
+        region_manager_.AddOrExtendAllocationRegion(mem_addr, bytes);
   } else {
-    region_manager_.AddAllocationRegion(mem_addr, bytes_received);
+    region_manager_.AddAllocationRegion(mem_addr, bytes);
   }
 
   // Create one large chunk for the whole memory space that will
@@ -178,7 +225,7 @@ bool BFCAllocator::Extend(size_t alignment, size_t rounded_bytes) {
   ChunkHandle h = AllocateChunk();
   BFCAllocator::Chunk* c = ChunkFromHandle(h);
   c->ptr = mem_addr;
-  c->size = bytes_received;
+  c->size = bytes;
   c->allocation_id = -1;
   c->prev = kInvalidChunkHandle;
   c->next = kInvalidChunkHandle;
@@ -203,7 +250,100 @@ bool BFCAllocator::Extend(size_t alignment, size_t rounded_bytes) {
 
   // Maybe merge adjacent chunks and insert the chunk into the right bin.
   InsertFreeChunkIntoBin(TryToCoalesce(h, /*ignore_freed_at=*/false));
+}
+
+bool BFCAllocator::RemapFreeChunks(size_t rounded_bytes) {
+  const size_t page_bytes = sub_allocator_->RemapGranularity();
+  if (page_bytes == 0) return false;
+
+  // Find the whole pages within free chunks that nothing may still be using.
+  struct PageRun {
+    void* chunk_ptr;
+    char* ptr;
+    size_t size;
+  };
+  std::vector<PageRun> runs;
+  for (const AllocationRegion& region : region_manager_.regions()) {
+    ChunkHandle h = region_manager_.get_handle(region.ptr());
+    while (h != kInvalidChunkHandle) {
+      const Chunk* c = ChunkFromHandle(h);
+      if (!c->in_use() && c->freed_at_count == 0 && IsStreamReleased(*c)) {
+        const uintptr_t begin = reinterpret_cast<uintptr_t>(c->ptr);
+        const uintptr_t first_page = (begin + page_bytes - 1) / page_bytes;
+        const uintptr_t end_page = (begin + c->size) / page_bytes;
+        if (end_page > first_page) {
+          runs.push_back({c->ptr,
+                          reinterpret_cast<char*>(first_page * page_bytes),
+                          (end_page - first_page) * page_bytes});
+        }
+      }
+      h = c->next;
+    }
+  }
+
+  // Move as few, and as large, runs of pages as needed.
+  std::sort(runs.begin(), runs.end(), [](const PageRun& a, const PageRun& b) {
+    return a.size > b.size;
+  });
+  size_t total_bytes = 0;
+  size_t num_runs = 0;
+  while (num_runs < runs.size() && total_bytes < rounded_bytes) {
+    total_bytes += runs[num_runs++].size;
+  }
+  if (total_bytes < rounded_bytes) return false;
+  runs.resize(num_runs);
+
+  // Split each run out of its chunk, so that it is covered by a chunk of its
+  // own that is in no bin.
+  std::vector<std::pair<void*, size_t>> ranges;
+  std::vector<ChunkHandle> run_chunks;
+  for (const PageRun& run : runs) {
+    ChunkHandle h = region_manager_.get_handle(run.chunk_ptr);
+    RemoveFreeChunkFromBin(h);
+    const size_t head_bytes = run.ptr - static_cast<char*>(run.chunk_ptr);
+    if (head_bytes > 0) {
+      SplitChunk(h, head_bytes);
+      InsertFreeChunkIntoBin(h);
+      h = region_manager_.get_handle(run.ptr);
+      RemoveFreeChunkFromBin(h);
+    }
+    if (ChunkFromHandle(h)->size > run.size) {
+      SplitChunk(h, run.size);
+    }
+    ranges.emplace_back(run.ptr, run.size);
+    run_chunks.push_back(h);
+  }
 
+  size_t bytes_received = 0;
+  void* mem_addr = sub_allocator_->Remap(ranges, &bytes_received);
+  if (mem_addr == nullptr) {
+    for (ChunkHandle h : run_chunks) {
+      InsertFreeChunkIntoBin(TryToCoalesce(h, /*ignore_freed_at=*/false));
+    }
+    return false;
+  }
+
+  // The old addresses are gone; drop them from the regions.
+  for (ChunkHandle h : run_chunks) {
+    Chunk* c = ChunkFromHandle(h);
+    if (c->prev != kInvalidChunkHandle) {
+      ChunkFromHandle(c->prev)->next = kInvalidChunkHandle;
+    }
+    if (c->next != kInvalidChunkHandle) {
+      ChunkFromHandle(c->next)->prev = kInvalidChunkHandle;
+    }
+    void* ptr = c->ptr;
+    const size_t size = c->size;
+    DeleteChunk(h);
+    region_manager_.RemoveRange(ptr, size);
+    total_region_allocated_bytes_ -= size;
+  }
+  LOG(WARNING) << "Defragmented " << Name() << " by remapping "
+               << strings::HumanReadableNumBytes(bytes_received)
+               << " of free memory in " << run_chunks.size()
+               << " pieces to a contiguous range.";
+  total_region_allocated_bytes_ += bytes_received;
+  AddFreeMemory(mem_addr, bytes_received);
   return true;
 }
 
@@ -224,6 +364,9 @@ void BFCAllocator::DeallocateChunk(ChunkHandle h) {
   Chunk* c = ChunkFromHandle(h);
   c->allocation_id = -1;
   c->bin_num = kInvalidBinNum;
+  c->stream = nullptr;
+  c->stream_free_seq = 0;
+  c->telemetry = nullptr;
   c->next = free_chunks_list_;
   free_chunks_list_ = h;
 }
@@ -258,6 +401,14 @@ void* BFCAllocator::AllocateRawInternalWithRetry(
 void* BFCAllocator::AllocateRaw(size_t unused_alignment, size_t num_bytes,
                                 const AllocationAttributes& allocation_attr) {
   VLOG(3) << "AllocateRaw " << Name() << "  " << num_bytes;
+  if (chunk_caches_ != nullptr && allocation_attr.freed_by_func == nullptr) {
+    void* result = AllocateFromChunkCache(num_bytes);
+    if (result != nullptr) {
+      VLOG(3) << "AllocateRaw " << Name() << "  " << num_bytes << " " << result
+              << " (cached)";
+      return result;
+    }
+  }
   void* result = [&] {
     if (!opts_.allow_retry_on_failure || !allocation_attr.retry_on_failure) {
       // If we have globally disabled retry-on-failure and fail to allocate an
@@ -332,7 +483,8 @@ bool BFCAllocator::DeallocateFreeRegions(size_t rounded_bytes)
     bool any_use = false;
     while (h != kInvalidChunkHandle) {
       const Chunk* c = ChunkFromHandle(h);
-      if (c->in_use()) {
+      // Work still pending on a chunk's stream may be using it.
+      if (c->in_use() || !IsStreamReleased(*c)) {
         any_use = true;
         break;
       }
@@ -423,13 +575,15 @@ void* BFCAllocator::AllocateRawInternal(size_t unused_alignment,
 
   // The BFC allocator tries to find the best fit first.
   BinNum bin_num = BinNumForSize(rounded_bytes);
+  void* stream = stream_ordered_ ? current_allocation_stream : nullptr;
 
   mutex_lock l(lock_);
   if (!timestamped_chunks_.empty()) {
     // Merge timestamped chunks whose counts have become safe for general use.
     MergeTimestampedChunks(0);
   }
-  void* ptr = FindChunkPtr(bin_num, rounded_bytes, num_bytes, freed_before);
+  void* ptr =
+      FindChunkPtr(bin_num, rounded_bytes, num_bytes, freed_before, stream);
   if (ptr != nullptr) {
     AddTraceMe("MemoryAllocation", ptr);
     return ptr;
@@ -437,7 +591,8 @@ void* BFCAllocator::AllocateRawInternal(size_t unused_alignment,
 
   // Try to extend
   if (Extend(unused_alignment, rounded_bytes)) {
-    ptr = FindChunkPtr(bin_num, rounded_bytes, num_bytes, freed_before);
+    ptr = FindChunkPtr(bin_num, rounded_bytes, num_bytes, freed_before,
+                       stream);
     if (ptr != nullptr) {
       AddTraceMe("MemoryAllocation", ptr);
       return ptr;
@@ -450,7 +605,8 @@ void* BFCAllocator::AllocateRawInternal(size_t unused_alignment,
     // timestamped chunks more aggressively until a free chunk of the necessary
     // size is formed.
     if (MergeTimestampedChunks(rounded_bytes)) {
-      ptr = FindChunkPtr(bin_num, rounded_bytes, num_bytes, freed_before);
+      ptr = FindChunkPtr(bin_num, rounded_bytes, num_bytes, freed_before,
+                         stream);
       if (ptr != nullptr) {
         AddTraceMe("MemoryAllocation", ptr);
         return ptr;
@@ -458,13 +614,47 @@ void* BFCAllocator::AllocateRawInternal(size_t unused_alignment,
     }
   }
 
+  // Chunks held by the caches may coalesce with their free neighbors into a
+  // chunk that fits.
+  if (FlushChunkCaches()) {
+    ptr = FindChunkPtr(bin_num, rounded_bytes, num_bytes, freed_before,
+                       stream);
+    if (ptr != nullptr) {
+      AddTraceMe("MemoryAllocation", ptr);
+      return ptr;
+    }
+  }
+
+  // Chunks released by their streams may not have been coalesced with their
+  // neighbors yet.
+  if (stream_ordered_ && CoalesceStreamReleasedChunks()) {
+    ptr = FindChunkPtr(bin_num, rounded_bytes, num_bytes, freed_before,
+                       stream);
+    if (ptr != nullptr) {
+      AddTraceMe("MemoryAllocation", ptr);
+      return ptr;
+    }
+  }
+
   // Reaching this point means that no chunks can satisfy the request. Also,
   // the unallocated bytes cannot satisfy the request. Before giving up, let's
   // try deallocating free regions so that suballocator can combine them with
   // the unallocated bytes and form a larger region.
   if (DeallocateFreeRegions(rounded_bytes) &&
       Extend(unused_alignment, rounded_bytes)) {
-    ptr = FindChunkPtr(bin_num, rounded_bytes, num_bytes, freed_before);
+    ptr = FindChunkPtr(bin_num, rounded_bytes, num_bytes, freed_before,
+                       stream);
+    if (ptr != nullptr) {
+      AddTraceMe("MemoryAllocation", ptr);
+      return ptr;
+    }
+  }
+
+  // Free memory may be plentiful but too fragmented; if the sub-allocator
+  // can move it around, gather it into one range.
+  if (RemapFreeChunks(rounded_bytes)) {
+    ptr = FindChunkPtr(bin_num, rounded_bytes, num_bytes, freed_before,
+                       stream);
     if (ptr != nullptr) {
       AddTraceMe("MemoryAllocation", ptr);
       return ptr;
@@ -503,7 +693,9 @@ int64_t BFCAllocator::LargestFreeChunk() {
 }
 
 double BFCAllocator::GetFragmentation() {
-  int64_t bytes_available = total_region_allocated_bytes_ - stats_.bytes_in_use;
+  int64_t bytes_available = total_region_allocated_bytes_ -
+                            stats_.bytes_in_use +
+                            cached_bytes_.load(std::memory_order_relaxed);
   DCHECK_GT(bytes_available, 0);
   return static_cast<double>(bytes_available - LargestFreeChunk()) /
          bytes_available;
@@ -516,10 +708,10 @@ void BFCAllocator::AddTraceMe(absl::string_view traceme_name, const void* ptr) {
 
 void BFCAllocator::AddTraceMe(absl::string_view traceme_name,
                               const void* chunk_ptr, int64_t req_bytes,
-                              int64_t alloc_bytes) {
+                              int64_t alloc_bytes, int64_t lifetime_usecs) {
   tensorflow::profiler::TraceMe::InstantActivity(
-      [this, traceme_name, chunk_ptr, req_bytes, alloc_bytes]()
-          TF_NO_THREAD_SAFETY_ANALYSIS {
+      [this, traceme_name, chunk_ptr, req_bytes, alloc_bytes,
+       lifetime_usecs]() TF_NO_THREAD_SAFETY_ANALYSIS {
             int64_t bytes_available =
                 memory_limit_ - stats_.bytes_reserved - stats_.bytes_in_use;
             const auto& annotation =
@@ -530,7 +722,7 @@ void BFCAllocator::AddTraceMe(absl::string_view traceme_name,
             const auto region_type = annotation.pending_region_type
                                          ? annotation.pending_region_type
                                          : "(null)";
-            return tensorflow::profiler::TraceMeEncode(
+            std::string encoded = tensorflow::profiler::TraceMeEncode(
                 traceme_name, {{"allocator_name", name_},
                                {"bytes_reserved", stats_.bytes_reserved},
                                {"bytes_allocated", stats_.bytes_in_use},
@@ -545,12 +737,65 @@ void BFCAllocator::AddTraceMe(absl::string_view traceme_name,
                                {"region_type", region_type},
                                {"data_type", annotation.pending_data_type},
                                {"shape", annotation.pending_shape_func()}});
+            if (lifetime_usecs >= 0) {
+              // Extend the metadata, which ends with '#'.
+              encoded.back() = ',';
+              absl::StrAppend(&encoded, "lifetime_usecs=", lifetime_usecs,
+                              "#");
+            }
+            return encoded;
           },
       /*level=*/profiler::TraceMeLevel::kInfo);
 }
 
+void BFCAllocator::RecordAllocationTelemetry(Chunk* chunk) {
+  const char* op_name =
+      profiler::ScopedMemoryDebugAnnotation::CurrentAnnotation()
+          .pending_op_name;
+  if (op_name == nullptr) op_name = "(null)";
+  auto it = op_telemetry_.find(absl::string_view(op_name));
+  if (it == op_telemetry_.end()) {
+    auto telemetry = absl::make_unique<OpTelemetry>();
+    telemetry->bytes = metrics::GetBfcAllocationBytesSampler(name_, op_name);
+    telemetry->lifetime_usecs =
+        metrics::GetBfcAllocationLifetimeSampler(name_, op_name);
+    it = op_telemetry_.emplace(op_name, std::move(telemetry)).first;
+  }
+  chunk->telemetry = it->second.get();
+  chunk->alloc_micros = Env::Default()->NowMicros();
+  chunk->telemetry->bytes->Add(chunk->requested_size);
+
+  if (stats_.bytes_in_use > phase_peak_bytes_in_use_) {
+    phase_peak_bytes_in_use_ = stats_.bytes_in_use;
+    phase_peak_cell_->Set(phase_peak_bytes_in_use_);
+  }
+  if (++num_recorded_allocs_ % kFragmentationSamplePeriod == 0 &&
+      static_cast<int64_t>(total_region_allocated_bytes_) >
+          stats_.bytes_in_use) {
+    fragmentation_cell_->Add(GetFragmentation());
+  }
+}
+
+int64_t BFCAllocator::RecordDeallocationTelemetry(Chunk* chunk) {
+  if (chunk->telemetry == nullptr) return -1;
+  const int64_t lifetime_usecs =
+      static_cast<int64_t>(Env::Default()->NowMicros() - chunk->alloc_micros);
+  chunk->telemetry->lifetime_usecs->Add(lifetime_usecs);
+  chunk->telemetry = nullptr;
+  return lifetime_usecs;
+}
+
+void BFCAllocator::SetTelemetryPhase(const string& phase) {
+  if (!opts_.record_telemetry) return;
+  mutex_lock l(lock_);
+  phase_peak_cell_ = metrics::GetBfcPeakBytesInUseGauge(name_, phase);
+  phase_peak_bytes_in_use_ = stats_.bytes_in_use;
+  phase_peak_cell_->Set(phase_peak_bytes_in_use_);
+}
+
 void* BFCAllocator::FindChunkPtr(BinNum bin_num, size_t rounded_bytes,
-                                 size_t num_bytes, uint64 freed_before) {
+                                 size_t num_bytes, uint64 freed_before,
+                                 void* stream) {
   // First identify the first bin that could satisfy rounded_bytes.
   for (; bin_num < kNumBins; bin_num++) {
     // Start searching from the first bin for the smallest chunk that fits
@@ -564,6 +809,9 @@ void* BFCAllocator::FindChunkPtr(BinNum bin_num, size_t rounded_bytes,
       if (freed_before > 0 && freed_before < chunk->freed_at_count) {
         continue;
       }
+      if (chunk->stream != stream && !IsStreamReleased(*chunk)) {
+        continue;
+      }
       if (chunk->size >= rounded_bytes) {
         // We found an existing chunk that fits us that wasn't in use, so remove
         // it from the free bin structure prior to using.
@@ -591,10 +839,16 @@ void* BFCAllocator::FindChunkPtr(BinNum bin_num, size_t rounded_bytes,
         // Assign a unique id and increment the id counter, marking the
         // chunk as being in use.
         chunk->allocation_id = next_allocation_id_++;
+        chunk->stream = stream;
+        chunk->stream_free_seq = 0;
 
         // Update stats.
         ++stats_.num_allocs;
         stats_.bytes_in_use += chunk->size;
+        if (chunk_caches_ != nullptr) {
+          bin_bytes_in_use_.store(stats_.bytes_in_use,
+                                  std::memory_order_relaxed);
+        }
         if (stats_.bytes_in_use > stats_.peak_bytes_in_use) {
           VLOG(2) << "New Peak memory usage of " << stats_.bytes_in_use
                   << " bytes for " << Name();
@@ -603,6 +857,9 @@ void* BFCAllocator::FindChunkPtr(BinNum bin_num, size_t rounded_bytes,
             std::max(stats_.peak_bytes_in_use, stats_.bytes_in_use);
         stats_.largest_alloc_size =
             std::max<std::size_t>(stats_.largest_alloc_size, chunk->size);
+        if (opts_.record_telemetry) {
+          RecordAllocationTelemetry(chunk);
+        }
 
 #ifdef TENSORFLOW_MEM_DEBUG
         if (ShouldRecordOpName()) {
@@ -658,6 +915,8 @@ void BFCAllocator::SplitChunk(BFCAllocator::ChunkHandle h, size_t num_bytes) {
 
   // It inherits the freed time.
   new_chunk->freed_at_count = c->freed_at_count;
+  new_chunk->stream = c->stream;
+  new_chunk->stream_free_seq = c->stream_free_seq;
 
   // Maintain the pointers.
   // c <-> c_neighbor becomes
@@ -678,6 +937,10 @@ void BFCAllocator::SplitChunk(BFCAllocator::ChunkHandle h, size_t num_bytes) {
 void BFCAllocator::DeallocateRaw(void* ptr) {
   VLOG(3) << "DeallocateRaw " << Name() << " "
           << (ptr ? RequestedSize(ptr) : 0);
+  if (chunk_caches_ != nullptr && ptr != nullptr &&
+      DeallocateToChunkCache(ptr)) {
+    return;
+  }
   DeallocateRawInternal(ptr);
   retry_helper_.NotifyDealloc();
 }
@@ -687,8 +950,30 @@ void BFCAllocator::DeallocateRawInternal(void* ptr) {
     VLOG(2) << "tried to deallocate nullptr";
     return;
   }
-  mutex_lock l(lock_);
+  gtl::InlinedVector<void*, 2> other_streams;
+  StreamRelease release;
+  {
+    mutex_lock l(lock_);
+    if (stream_ordered_) {
+      auto it = cross_stream_uses_.find(ptr);
+      if (it != cross_stream_uses_.end()) {
+        other_streams = std::move(it->second);
+        cross_stream_uses_.erase(it);
+        ++num_pending_stream_callbacks_;
+      }
+    }
+    if (other_streams.empty()) {
+      release = FreeChunk(ptr);
+    }
+  }
+  if (!other_streams.empty()) {
+    DeferStreamFree(ptr, other_streams);
+  } else if (release.stream != nullptr) {
+    ScheduleStreamRelease(release);
+  }
+}
 
+BFCAllocator::StreamRelease BFCAllocator::FreeChunk(void* ptr) {
   // Find the chunk from the ptr.
   BFCAllocator::ChunkHandle h = region_manager_.get_handle(ptr);
   CHECK(h != kInvalidChunkHandle);
@@ -697,9 +982,23 @@ void BFCAllocator::DeallocateRawInternal(void* ptr) {
   void* chunk_ptr = chunk->ptr;
   int64_t req_bytes = chunk->requested_size;
   int64_t alloc_bytes = chunk->size;
+  int64_t lifetime_usecs = RecordDeallocationTelemetry(chunk);
 
   MarkFree(h);
 
+  // Work enqueued on the chunk's stream may still be using it, so it only
+  // becomes reusable on that stream until the stream has caught up.
+  StreamRelease release;
+  if (chunk->stream != nullptr) {
+    StreamState& state = stream_states_[chunk->stream];
+    chunk->stream_free_seq = ++state.last_free_seq;
+    if (!state.release_pending) {
+      state.release_pending = true;
+      ++num_pending_stream_callbacks_;
+      release = {chunk->stream, chunk->stream_free_seq};
+    }
+  }
+
   // Consider coalescing it.
   if (timing_counter_) {
     InsertFreeChunkIntoBin(h);
@@ -710,11 +1009,295 @@ void BFCAllocator::DeallocateRawInternal(void* ptr) {
 
   // TraceMe needs to be added after MarkFree and InsertFreeChunkIntoBin for
   // correct aggregation stats (bytes_in_use, fragmentation).
-  AddTraceMe("MemoryDeallocation", chunk_ptr, req_bytes, alloc_bytes);
+  AddTraceMe("MemoryDeallocation", chunk_ptr, req_bytes, alloc_bytes,
+             lifetime_usecs);
 
   if (VLOG_IS_ON(4)) {
     LOG(INFO) << "F: " << RenderOccupancy();
   }
+  return release;
+}
+
+void BFCAllocator::ScheduleStreamRelease(const StreamRelease& release) {
+  opts_.then_execute_on_stream(
+      release.stream, [this, release]() { OnStreamReleased(release); });
+}
+
+void BFCAllocator::OnStreamReleased(const StreamRelease& release) {
+  StreamRelease next;
+  {
+    mutex_lock l(lock_);
+    StreamState& state = stream_states_[release.stream];
+    state.last_released_seq = std::max(state.last_released_seq, release.seq);
+    if (state.last_free_seq > release.seq) {
+      // More chunks were freed on the stream since this release was
+      // scheduled; wait for the stream to catch up with those too.
+      next = {release.stream, state.last_free_seq};
+    } else {
+      state.release_pending = false;
+    }
+  }
+  // Allocations waiting for memory may fit now.
+  retry_helper_.NotifyDealloc();
+  if (next.stream != nullptr) {
+    // The new callback takes over this one's pending count.
+    ScheduleStreamRelease(next);
+    return;
+  }
+  StreamCallbackDone();
+}
+
+void BFCAllocator::DeferStreamFree(void* ptr,
+                                   absl::Span<void* const> streams) {
+  auto num_pending = std::make_shared<std::atomic<int>>(streams.size());
+  for (void* stream : streams) {
+    opts_.then_execute_on_stream(stream, [this, ptr, num_pending]() {
+      if (num_pending->fetch_sub(1) != 1) return;
+      StreamRelease release;
+      {
+        mutex_lock l(lock_);
+        release = FreeChunk(ptr);
+      }
+      if (release.stream != nullptr) {
+        ScheduleStreamRelease(release);
+      }
+      retry_helper_.NotifyDealloc();
+      StreamCallbackDone();
+    });
+  }
+}
+
+void BFCAllocator::StreamCallbackDone() {
+  mutex_lock l(lock_);
+  if (--num_pending_stream_callbacks_ == 0) {
+    stream_callbacks_done_.notify_all();
+  }
+}
+
+void BFCAllocator::RecordStreamUse(void* ptr, void* stream) {
+  if (!stream_ordered_ || ptr == nullptr || stream == nullptr) return;
+  mutex_lock l(lock_);
+  BFCAllocator::ChunkHandle h = region_manager_.get_handle(ptr);
+  CHECK(h != kInvalidChunkHandle)
+      << "Asked to record stream use of pointer we never allocated: " << ptr;
+  const Chunk* c = ChunkFromHandle(h);
+  CHECK(c->in_use());
+  if (c->stream == stream) return;
+  gtl::InlinedVector<void*, 2>& streams = cross_stream_uses_[ptr];
+  if (!absl::c_linear_search(streams, stream)) {
+    streams.push_back(stream);
+  }
+}
+
+bool BFCAllocator::IsStreamReleased(const Chunk& c) const {
+  if (c.stream == nullptr) return true;
+  auto it = stream_states_.find(c.stream);
+  return it != stream_states_.end() &&
+         c.stream_free_seq <= it->second.last_released_seq;
+}
+
+bool BFCAllocator::CanMergeStreams(const Chunk& a, const Chunk& b) const {
+  return a.stream == b.stream || (IsStreamReleased(a) && IsStreamReleased(b));
+}
+
+bool BFCAllocator::CoalesceStreamReleasedChunks() {
+  std::vector<void*> released;
+  for (const AllocationRegion& region : region_manager_.regions()) {
+    ChunkHandle h = region_manager_.get_handle(region.ptr());
+    while (h != kInvalidChunkHandle) {
+      const Chunk* c = ChunkFromHandle(h);
+      if (!c->in_use() && c->stream != nullptr && IsStreamReleased(*c)) {
+        released.push_back(c->ptr);
+      }
+      h = c->next;
+    }
+  }
+  for (void* ptr : released) {
+    // The chunk may have been merged into a previous one already.
+    ChunkHandle h = region_manager_.get_handle(ptr);
+    if (h == kInvalidChunkHandle) continue;
+    Chunk* c = ChunkFromHandle(h);
+    if (c->in_use() || c->bin_num == kInvalidBinNum) continue;
+    RemoveFreeChunkFromBin(h);
+    c->stream = nullptr;
+    c->stream_free_seq = 0;
+    InsertFreeChunkIntoBin(TryToCoalesce(h, /*ignore_freed_at=*/false));
+  }
+  return !released.empty();
+}
+
+BFCAllocator::ChunkCache* BFCAllocator::ChunkCacheForCurrentThread() {
+  static thread_local const size_t thread_hash =
+      std::hash<std::thread::id>()(std::this_thread::get_id());
+  return &chunk_caches_[thread_hash % kNumChunkCaches];
+}
+
+BFCAllocator::OwnedChunkShard* BFCAllocator::OwnedChunkShardFor(
+    const void* ptr) {
+  const uint64 key = reinterpret_cast<uintptr_t>(ptr) >> kMinAllocationBits;
+  return &owned_chunk_shards_[Hash64Combine(key, 0) % kNumChunkCaches];
+}
+
+void* BFCAllocator::AllocateFromChunkCache(size_t num_bytes) {
+  if (num_bytes == 0 || timing_counter_ != nullptr) return nullptr;
+  const size_t rounded_bytes = RoundedBytes(num_bytes);
+  if (rounded_bytes > kMaxCachedAllocationBytes) return nullptr;
+  const int size_class = rounded_bytes / kMinAllocationSize - 1;
+
+  ChunkCache* cache = ChunkCacheForCurrentThread();
+  {
+    mutex_lock l(cache->mu);
+    std::vector<void*>& chunks = cache->chunks[size_class];
+    if (!chunks.empty()) {
+      void* ptr = chunks.back();
+      chunks.pop_back();
+      const int64_t bytes_in_use =
+          bin_bytes_in_use_.load(std::memory_order_relaxed) -
+          (cached_bytes_.fetch_sub(rounded_bytes, std::memory_order_relaxed) -
+           rounded_bytes);
+      num_cached_allocs_.fetch_add(1, std::memory_order_relaxed);
+      int64_t peak = cached_peak_bytes_in_use_.load(std::memory_order_relaxed);
+      while (bytes_in_use > peak &&
+             !cached_peak_bytes_in_use_.compare_exchange_weak(
+                 peak, bytes_in_use, std::memory_order_relaxed)) {
+      }
+      return ptr;
+    }
+  }
+
+  // Refill half of the cache's capacity for this size class under a single
+  // acquisition of lock_. Only the first chunk is handed out; the others count
+  // as allocations when they are taken from the cache.
+  const size_t refill_count =
+      std::max<size_t>(1, kChunkCacheBytesPerSizeClass / rounded_bytes / 2);
+  absl::InlinedVector<void*, 64> ptrs;
+  {
+    mutex_lock l(lock_);
+    const int64_t peak_bytes_in_use = stats_.peak_bytes_in_use;
+    const BinNum bin_num = BinNumForSize(rounded_bytes);
+    while (ptrs.size() < refill_count) {
+      void* ptr = FindChunkPtr(bin_num, rounded_bytes, num_bytes, 0,
+                               /*stream=*/nullptr);
+      if (ptr == nullptr) break;
+      ptrs.push_back(ptr);
+    }
+    if (ptrs.empty()) return nullptr;
+    const int64_t refilled_bytes = (ptrs.size() - 1) * rounded_bytes;
+    stats_.num_allocs -= ptrs.size() - 1;
+    stats_.peak_bytes_in_use = std::max(
+        peak_bytes_in_use, stats_.bytes_in_use - refilled_bytes -
+                               cached_bytes_.load(std::memory_order_relaxed));
+    for (void* ptr : ptrs) {
+      OwnedChunkShard* shard = OwnedChunkShardFor(ptr);
+      mutex_lock shard_lock(shard->mu);
+      shard->size_classes[ptr] = size_class;
+    }
+    AddTraceMe("MemoryAllocation", ptrs[0]);
+  }
+  if (ptrs.size() > 1) {
+    mutex_lock l(cache->mu);
+    std::vector<void*>& chunks = cache->chunks[size_class];
+    chunks.insert(chunks.end(), ptrs.begin() + 1, ptrs.end());
+    cached_bytes_.fetch_add((ptrs.size() - 1) * rounded_bytes,
+                            std::memory_order_relaxed);
+  }
+  return ptrs[0];
+}
+
+bool BFCAllocator::DeallocateToChunkCache(void* ptr) {
+  int size_class;
+  {
+    OwnedChunkShard* shard = OwnedChunkShardFor(ptr);
+    mutex_lock l(shard->mu);
+    auto it = shard->size_classes.find(ptr);
+    if (it == shard->size_classes.end()) return false;
+    size_class = it->second;
+    if (timing_counter_ != nullptr) {
+      // The chunk needs a freed_at_count, so let the regular path free it.
+      shard->size_classes.erase(it);
+      return false;
+    }
+  }
+
+  const size_t chunk_bytes = SizeClassBytes(size_class);
+  absl::InlinedVector<void*, 64> drained;
+  ChunkCache* cache = ChunkCacheForCurrentThread();
+  {
+    mutex_lock l(cache->mu);
+    std::vector<void*>& chunks = cache->chunks[size_class];
+    chunks.push_back(ptr);
+    cached_bytes_.fetch_add(chunk_bytes, std::memory_order_relaxed);
+    if (chunks.size() * chunk_bytes > kChunkCacheBytesPerSizeClass) {
+      // Drain the least recently cached half.
+      const size_t num_drained = chunks.size() / 2;
+      drained.assign(chunks.begin(), chunks.begin() + num_drained);
+      chunks.erase(chunks.begin(), chunks.begin() + num_drained);
+      cached_bytes_.fetch_sub(num_drained * chunk_bytes,
+                              std::memory_order_relaxed);
+    }
+  }
+  if (!drained.empty()) {
+    {
+      mutex_lock l(lock_);
+      ReleaseCachedChunks(drained);
+    }
+    retry_helper_.NotifyDealloc();
+  }
+  return true;
+}
+
+void BFCAllocator::ReleaseCachedChunks(absl::Span<void* const> ptrs) {
+  for (void* ptr : ptrs) {
+    {
+      OwnedChunkShard* shard = OwnedChunkShardFor(ptr);
+      mutex_lock l(shard->mu);
+      shard->size_classes.erase(ptr);
+    }
+    FreeChunk(ptr);
+  }
+}
+
+bool BFCAllocator::FlushChunkCaches() {
+  if (chunk_caches_ == nullptr) return false;
+  std::vector<void*> ptrs;
+  for (int i = 0; i < kNumChunkCaches; ++i) {
+    ChunkCache& cache = chunk_caches_[i];
+    mutex_lock l(cache.mu);
+    for (int size_class = 0; size_class < kNumCacheSizeClasses; ++size_class) {
+      std::vector<void*>& chunks = cache.chunks[size_class];
+      cached_bytes_.fetch_sub(chunks.size() * SizeClassBytes(size_class),
+                              std::memory_order_relaxed);
+      ptrs.insert(ptrs.end(), chunks.begin(), chunks.end());
+      chunks.clear();
+    }
+  }
+  if (ptrs.empty()) return false;
+  VLOG(2) << "Flushing " << ptrs.size() << " cached chunks of " << Name();
+  ReleaseCachedChunks(ptrs);
+  return true;
+}
+
+absl::flat_hash_set<const void*> BFCAllocator::CachedChunkPtrs() const {
+  absl::flat_hash_set<const void*> ptrs;
+  if (chunk_caches_ == nullptr) return ptrs;
+  for (int i = 0; i < kNumChunkCaches; ++i) {
+    ChunkCache& cache = chunk_caches_[i];
+    mutex_lock l(cache.mu);
+    for (const std::vector<void*>& chunks : cache.chunks) {
+      ptrs.insert(chunks.begin(), chunks.end());
+    }
+  }
+  return ptrs;
+}
+
+AllocatorStats BFCAllocator::StatsExcludingCachedChunks() const {
+  AllocatorStats stats = stats_;
+  stats.num_allocs += num_cached_allocs_.load(std::memory_order_relaxed);
+  stats.bytes_in_use -= cached_bytes_.load(std::memory_order_relaxed);
+  stats.peak_bytes_in_use = std::max(
+      {stats.peak_bytes_in_use, stats.bytes_in_use,
+       cached_peak_bytes_in_use_.load(std::memory_order_relaxed)});
+  return stats;
 }
 
 // Merges h1 and h2 when Chunk(h1)->next is h2 and Chunk(h2)->prev is c1.
@@ -748,6 +1331,14 @@ void BFCAllocator::Merge(BFCAllocator::ChunkHandle h1,
   // Pick latest free time.
   c1->freed_at_count = std::max(c1->freed_at_count, c2->freed_at_count);
 
+  // Chunks of different streams are only merged once both are released.
+  if (c1->stream == c2->stream) {
+    c1->stream_free_seq = std::max(c1->stream_free_seq, c2->stream_free_seq);
+  } else {
+    c1->stream = nullptr;
+    c1->stream_free_seq = 0;
+  }
+
   DeleteChunk(h2);
 }
 
@@ -800,6 +1391,9 @@ void BFCAllocator::MarkFree(BFCAllocator::ChunkHandle h) {
 
   // Updates the stats.
   stats_.bytes_in_use -= c->size;
+  if (chunk_caches_ != nullptr) {
+    bin_bytes_in_use_.store(stats_.bytes_in_use, std::memory_order_relaxed);
+  }
 
 #ifdef TENSORFLOW_MEM_DEBUG
   if (ShouldRecordOpName()) {
@@ -819,7 +1413,8 @@ BFCAllocator::ChunkHandle BFCAllocator::TryToCoalesce(ChunkHandle h,
   // If the next chunk is free, merge it into c and delete it.
   if (c->next != kInvalidChunkHandle && !ChunkFromHandle(c->next)->in_use()) {
     Chunk* n = ChunkFromHandle(c->next);
-    if ((n->freed_at_count == 0) || ignore_freed_at) {
+    if (((n->freed_at_count == 0) || ignore_freed_at) &&
+        CanMergeStreams(*c, *n)) {
       VLOG(4) << "Merging c->next " << n->ptr << " with c " << c->ptr;
       RemoveFreeChunkFromBin(c->next);
       Merge(h, c->next);
@@ -829,7 +1424,8 @@ BFCAllocator::ChunkHandle BFCAllocator::TryToCoalesce(ChunkHandle h,
   // If the previous chunk is free, merge c into it and delete c.
   if (c->prev != kInvalidChunkHandle && !ChunkFromHandle(c->prev)->in_use()) {
     Chunk* n = ChunkFromHandle(c->prev);
-    if ((n->freed_at_count == 0) || ignore_freed_at) {
+    if (((n->freed_at_count == 0) || ignore_freed_at) &&
+        CanMergeStreams(*c, *n)) {
       VLOG(4) << "Merging c " << c->ptr << " into c->prev " << n->ptr;
       coalesced_chunk = c->prev;
       RemoveFreeChunkFromBin(c->prev);
@@ -1034,8 +1630,9 @@ void BFCAllocator::DumpMemoryLog(size_t num_bytes) {
   for (BinNum bin_num = 0; bin_num < kNumBins; bin_num++) {
     Bin* b = BinFromIndex(bin_num);
     const BinDebugInfo& bin_info = bin_infos[bin_num];
-    CHECK_EQ(b->free_chunks.size(),
-             bin_info.total_chunks_in_bin - bin_info.total_chunks_in_use);
+    CHECK_EQ(b->free_chunks.size(), bin_info.total_chunks_in_bin -
+                                        bin_info.total_chunks_in_use -
+                                        bin_info.total_chunks_cached);
 
     LOG(INFO) << "Bin (" << b->bin_size
               << "): \tTotal Chunks: " << bin_info.total_chunks_in_bin
@@ -1046,7 +1643,15 @@ void BFCAllocator::DumpMemoryLog(size_t num_bytes) {
               << " in use in bin. "
               << strings::HumanReadableNumBytes(
                      bin_info.total_requested_bytes_in_use)
-              << " client-requested in use in bin.";
+              << " client-requested in use in bin."
+              << (bin_info.total_chunks_cached > 0
+                      ? strings::StrCat(
+                            " ", bin_info.total_chunks_cached,
+                            " chunks of ",
+                            strings::HumanReadableNumBytes(
+                                bin_info.total_bytes_cached),
+                            " held by the chunk caches.")
+                      : "");
   }
 
   // Find the bin that we would have liked to allocate in, so we
@@ -1106,7 +1711,7 @@ void BFCAllocator::DumpMemoryLog(size_t num_bytes) {
             << (memory_limit_ - total_region_allocated_bytes_)
             << " curr_region_allocation_bytes_: "
             << curr_region_allocation_bytes_;
-  LOG(INFO) << "Stats: \n" << stats_.DebugString();
+  LOG(INFO) << "Stats: \n" << StatsExcludingCachedChunks().DebugString();
 }
 
 void BFCAllocator::MaybeWriteMemoryMap() {
@@ -1139,19 +1744,21 @@ MemoryDump BFCAllocator::RecordMemoryMapInternal() {
   md.set_allocator_name(Name());
 
   // Record the general stats
+  const AllocatorStats stats = StatsExcludingCachedChunks();
   MemAllocatorStats* mas = md.mutable_stats();
-  mas->set_num_allocs(stats_.num_allocs);
-  mas->set_bytes_in_use(stats_.bytes_in_use);
-  mas->set_peak_bytes_in_use(stats_.peak_bytes_in_use);
-  mas->set_largest_alloc_size(stats_.largest_alloc_size);
+  mas->set_num_allocs(stats.num_allocs);
+  mas->set_bytes_in_use(stats.bytes_in_use);
+  mas->set_peak_bytes_in_use(stats.peak_bytes_in_use);
+  mas->set_largest_alloc_size(stats.largest_alloc_size);
 
   // Record summary data for every bin.
   const std::array<BinDebugInfo, kNumBins> bin_infos = get_bin_debug_info();
   for (BinNum bin_num = 0; bin_num < kNumBins; bin_num++) {
     Bin* b = BinFromIndex(bin_num);
     const BinDebugInfo& bin_info = bin_infos[bin_num];
-    DCHECK_EQ(b->free_chunks.size(),
-              bin_info.total_chunks_in_bin - bin_info.total_chunks_in_use);
+    DCHECK_EQ(b->free_chunks.size(), bin_info.total_chunks_in_bin -
+                                         bin_info.total_chunks_in_use -
+                                         bin_info.total_chunks_cached);
     BinSummary* bs = md.add_bin_summary();
     bs->set_bin(bin_num);
     bs->set_total_bytes_in_use(bin_info.total_bytes_in_use);
@@ -1161,12 +1768,13 @@ MemoryDump BFCAllocator::RecordMemoryMapInternal() {
   }
 
   // Record state of every defined Chunk.
+  const absl::flat_hash_set<const void*> cached_ptrs = CachedChunkPtrs();
   for (const auto& region : region_manager_.regions()) {
     ChunkHandle h = region_manager_.get_handle(region.ptr());
     while (h != kInvalidChunkHandle) {
       const Chunk* c = ChunkFromHandle(h);
       MemChunk* mc = md.add_chunk();
-      mc->set_in_use(c->in_use());
+      mc->set_in_use(c->in_use() && !cached_ptrs.contains(c->ptr));
       mc->set_address(reinterpret_cast<uint64>(c->ptr));
       mc->set_size(c->size);
       mc->set_requested_size(c->requested_size);
@@ -1202,13 +1810,17 @@ MemoryDump BFCAllocator::RecordMemoryMapInternal() {
 
 absl::optional<AllocatorStats> BFCAllocator::GetStats() {
   mutex_lock l(lock_);
-  return stats_;
+  return StatsExcludingCachedChunks();
 }
 
 bool BFCAllocator::ClearStats() {
   mutex_lock l(lock_);
   stats_.num_allocs = 0;
-  stats_.peak_bytes_in_use = stats_.bytes_in_use;
+  num_cached_allocs_.store(0, std::memory_order_relaxed);
+  stats_.peak_bytes_in_use =
+      stats_.bytes_in_use - cached_bytes_.load(std::memory_order_relaxed);
+  cached_peak_bytes_in_use_.store(stats_.peak_bytes_in_use,
+                                  std::memory_order_relaxed);
   stats_.largest_alloc_size = 0;
   return true;
 }
@@ -1216,6 +1828,7 @@ bool BFCAllocator::ClearStats() {
 std::array<BFCAllocator::BinDebugInfo, BFCAllocator::kNumBins>
 BFCAllocator::get_bin_debug_info() {
   std::array<BinDebugInfo, kNumBins> bin_infos;
+  const absl::flat_hash_set<const void*> cached_ptrs = CachedChunkPtrs();
   for (const auto& region : region_manager_.regions()) {
     ChunkHandle h = region_manager_.get_handle(region.ptr());
     while (h != kInvalidChunkHandle) {
@@ -1224,7 +1837,10 @@ BFCAllocator::get_bin_debug_info() {
       BinDebugInfo& bin_info = bin_infos[bin_num];
       bin_info.total_bytes_in_bin += c->size;
       bin_info.total_chunks_in_bin++;
-      if (c->in_use()) {
+      if (cached_ptrs.contains(c->ptr)) {
+        bin_info.total_bytes_cached += c->size;
+        bin_info.total_chunks_cached++;
+      } else if (c->in_use()) {
         bin_info.total_bytes_in_use += c->size;
         bin_info.total_requested_bytes_in_use += c->requested_size;
         bin_info.total_chunks_in_use++;
@@ -16,17 +16,26 @@ limitations under the License.
 #ifndef TENSORFLOW_CORE_COMMON_RUNTIME_BFC_ALLOCATOR_H_
 #define TENSORFLOW_CORE_COMMON_RUNTIME_BFC_ALLOCATOR_H_
 
+#include <algorithm>
 #include <array>
+#include <atomic>
 #include <deque>
+#include <functional>
+#include <iterator>
 #include <memory>
 #include <string>
 #include <unordered_map>
 #include <vector>
 
+#include "absl/container/flat_hash_map.h"
 #include "absl/container/flat_hash_set.h"
+#include "absl/types/span.h"
 #include "tensorflow/core/common_runtime/allocator_retry.h"
 #include "tensorflow/core/common_runtime/shared_counter.h"
 #include "tensorflow/core/framework/allocator.h"
+#include "tensorflow/core/lib/gtl/inlined_vector.h"
+#include "tensorflow/core/lib/monitoring/gauge.h"
+#include "tensorflow/core/lib/monitoring/sampler.h"
 #include "tensorflow/core/lib/strings/numbers.h"
 #include "tensorflow/core/lib/strings/strcat.h"
 #include "tensorflow/core/platform/macros.h"
@@ -66,7 +75,45 @@ class BFCAllocator : public Allocator {
     // Controls when a chunk should be split, if its size exceeds the requested
     // allocation size.
     double fragmentation_fraction = 0;
+
+    // If true, allocations of up to 4KiB (after rounding) are served from and
+    // freed to small per-thread caches of chunks, which refill from and drain
+    // to the bins in batches, so that most small allocations and deallocations
+    // don't contend on the allocator lock. Caching is bypassed while a timing
+    // counter is set, and is not supported by stream-ordered allocators or
+    // when telemetry is recorded.
+    bool use_thread_local_caches = false;
+
+    // If set, the allocator is stream-ordered: allocations are tagged with the
+    // stream installed by ScopedStream on the allocating thread, and a chunk
+    // freed while tagged with a stream is reused right away only by
+    // allocations on that same stream. Other streams may reuse it once
+    // `then_execute_on_stream(stream, done)` has run `done`, which must happen
+    // after all work enqueued on `stream` so far has completed.
+    std::function<void(void* stream, std::function<void()> done)>
+        then_execute_on_stream;
+
+    // If true, the allocator exports the sizes and lifetimes of allocations
+    // per op, its fragmentation over time, and its peak memory usage per
+    // phase (see SetTelemetryPhase) through the metrics in
+    // framework/metrics.h, and annotates the deallocation events on its
+    // profiler memory track with the lifetime of the allocation.
+    bool record_telemetry = false;
+  };
+
+  // Sets the stream that stream-ordered allocators tag the allocations of the
+  // current thread with, for the lifetime of this object.
+  class ScopedStream {
+   public:
+    explicit ScopedStream(void* stream);
+    ~ScopedStream();
+
+   private:
+    void* const previous_stream_;
+
+    TF_DISALLOW_COPY_AND_ASSIGN(ScopedStream);
   };
+
   BFCAllocator(std::unique_ptr<SubAllocator> sub_allocator, size_t total_memory,
                const string& name, const Options& opts);
 
@@ -105,8 +152,20 @@ class BFCAllocator : public Allocator {
 
   MemoryDump RecordMemoryMap();
 
+  // Records that the allocation at `ptr` is also used by work on `stream`,
+  // other than the stream it was allocated on. When `ptr` is deallocated, its
+  // chunk is only returned to the bins once all work enqueued on `stream` by
+  // then has completed. No-op unless the allocator is stream-ordered.
+  void RecordStreamUse(void* ptr, void* stream);
+
+  // Starts a new phase of the program (e.g. "warmup" or "training"), so that
+  // the peak memory usage recorded from now on is attributed to `phase`.
+  // No-op unless Options::record_telemetry is set.
+  void SetTelemetryPhase(const string& phase);
+
  private:
   struct Bin;
+  struct OpTelemetry;
 
   void* AllocateRawInternal(size_t alignment, size_t num_bytes,
                             bool dump_log_on_failure,
@@ -118,6 +177,29 @@ class BFCAllocator : public Allocator {
 
   void DeallocateRawInternal(void* ptr);
 
+  // A request to run OnStreamReleased once all work enqueued on `stream` has
+  // completed, to make the chunks freed on it up to `seq` reusable elsewhere.
+  struct StreamRelease {
+    void* stream = nullptr;
+    uint64 seq = 0;
+  };
+
+  // Returns the in-use chunk at `ptr` to the bins. For stream-ordered
+  // allocators, returns the release that the caller must pass to
+  // ScheduleStreamRelease once lock_ is released, if any.
+  StreamRelease FreeChunk(void* ptr) TF_EXCLUSIVE_LOCKS_REQUIRED(lock_);
+
+  void ScheduleStreamRelease(const StreamRelease& release)
+      TF_LOCKS_EXCLUDED(lock_);
+  void OnStreamReleased(const StreamRelease& release) TF_LOCKS_EXCLUDED(lock_);
+
+  // Frees `ptr` once all work enqueued on `streams` has completed.
+  void DeferStreamFree(void* ptr, absl::Span<void* const> streams)
+      TF_LOCKS_EXCLUDED(lock_);
+
+  // Must be the last thing each callback run by then_execute_on_stream does.
+  void StreamCallbackDone() TF_LOCKS_EXCLUDED(lock_);
+
   // Chunks whose freed_at_count is later than the safe frontier value are kept
   // on a special list and not subject to merging immediately upon being freed.
   //
@@ -147,7 +229,24 @@ class BFCAllocator : public Allocator {
 
   // Overloaded AddTraceMe function with chunk information.
   void AddTraceMe(absl::string_view traceme_name, const void* chunk_ptr,
-                  int64_t req_bytes, int64_t alloc_bytes)
+                  int64_t req_bytes, int64_t alloc_bytes,
+                  int64_t lifetime_usecs = -1)
+      TF_EXCLUSIVE_LOCKS_REQUIRED(lock_);
+
+  // The allocation metrics of one op on this allocator.
+  struct OpTelemetry {
+    monitoring::SamplerCell* bytes;
+    monitoring::SamplerCell* lifetime_usecs;
+  };
+
+  // Records the allocation of `chunk` by the current op. Requires
+  // Options::record_telemetry.
+  void RecordAllocationTelemetry(Chunk* chunk)
+      TF_EXCLUSIVE_LOCKS_REQUIRED(lock_);
+
+  // Records the deallocation of `chunk` and returns the lifetime of the
+  // allocation in microseconds, or -1 if its allocation wasn't recorded.
+  int64_t RecordDeallocationTelemetry(Chunk* chunk)
       TF_EXCLUSIVE_LOCKS_REQUIRED(lock_);
 
   // A ChunkHandle is an index into the chunks_ vector in BFCAllocator
@@ -206,6 +305,17 @@ class BFCAllocator : public Allocator {
     // Optional count when this chunk was most recently made free.
     uint64 freed_at_count = 0;
 
+    // For stream-ordered allocators, the stream this chunk was last used on
+    // (nullptr if it may be used on any stream) and, while free, the sequence
+    // number of its release on that stream.
+    void* stream = nullptr;
+    uint64 stream_free_seq = 0;
+
+    // If telemetry is recorded, the metrics of the op that allocated this
+    // chunk and the time of the allocation.
+    OpTelemetry* telemetry = nullptr;
+    uint64 alloc_micros = 0;
+
     bool in_use() const { return allocation_id != -1; }
 
 #ifdef TENSORFLOW_MEM_DEBUG
@@ -324,6 +434,18 @@ class BFCAllocator : public Allocator {
     void set_handle(const void* p, ChunkHandle h) { handles_[IndexFor(p)] = h; }
     void erase(const void* p) { set_handle(p, kInvalidChunkHandle); }
 
+    // Returns a region for [begin, end), which must lie within this region,
+    // with the same handles.
+    AllocationRegion Slice(const void* begin, const void* end) const {
+      const size_t size =
+          static_cast<const char*>(end) - static_cast<const char*>(begin);
+      AllocationRegion slice(const_cast<void*>(begin), size);
+      std::copy(handles_.begin() + IndexFor(begin),
+                handles_.begin() + IndexFor(begin) + slice.handles_.size(),
+                slice.handles_.begin());
+      return slice;
+    }
+
    private:
     void Swap(AllocationRegion* other) {
       std::swap(ptr_, other->ptr_);
@@ -406,6 +528,25 @@ class BFCAllocator : public Allocator {
       return regions_.erase(it);
     }
 
+    // Removes [ptr, ptr + size), which must lie within a single region and
+    // hold no chunks, from that region, splitting it in two if needed.
+    void RemoveRange(void* ptr, size_t size) {
+      auto it =
+          std::upper_bound(regions_.begin(), regions_.end(), ptr, &Comparator);
+      CHECK(it != regions_.end() && it->ptr() <= ptr);
+      const void* end = static_cast<char*>(ptr) + size;
+      std::vector<AllocationRegion> remaining;
+      if (it->ptr() < ptr) {
+        remaining.push_back(it->Slice(it->ptr(), ptr));
+      }
+      if (end < it->end_ptr()) {
+        remaining.push_back(it->Slice(end, it->end_ptr()));
+      }
+      it = regions_.erase(it);
+      regions_.insert(it, std::make_move_iterator(remaining.begin()),
+                      std::make_move_iterator(remaining.end()));
+    }
+
     ChunkHandle get_handle(const void* p) const {
       return RegionFor(p)->get_handle(p);
     }
@@ -451,6 +592,17 @@ class BFCAllocator : public Allocator {
   bool Extend(size_t alignment, size_t rounded_bytes)
       TF_EXCLUSIVE_LOCKS_REQUIRED(lock_);
 
+  // Adds the 'bytes' of memory at 'mem_addr', obtained from the sub-allocator,
+  // to the regions as a free chunk.
+  void AddFreeMemory(void* mem_addr, size_t bytes)
+      TF_EXCLUSIVE_LOCKS_REQUIRED(lock_);
+
+  // Defragments without copying, if the sub-allocator supports Remap(): the
+  // memory behind free chunks is moved into a new contiguous region of at
+  // least 'rounded_bytes', and the addresses it was at are dropped from the
+  // regions. Returns true on success.
+  bool RemapFreeChunks(size_t rounded_bytes) TF_EXCLUSIVE_LOCKS_REQUIRED(lock_);
+
   // Deallocate free regions to give back the memory to suballocator, so that
   // we can re-allocate a larger region.  The main use scenario of this function
   // is when OOM happens but we have free regions and the sum of sizes of free
@@ -464,9 +616,24 @@ class BFCAllocator : public Allocator {
       TF_EXCLUSIVE_LOCKS_REQUIRED(lock_);
 
   // Returns a pointer to an underlying allocated chunk of size
-  // 'rounded_bytes'.
+  // 'rounded_bytes'. For stream-ordered allocators, only chunks reusable on
+  // 'stream' are considered and the chunk is tagged with it.
   void* FindChunkPtr(BinNum bin_num, size_t rounded_bytes, size_t num_bytes,
-                     uint64 freed_before) TF_EXCLUSIVE_LOCKS_REQUIRED(lock_);
+                     uint64 freed_before, void* stream)
+      TF_EXCLUSIVE_LOCKS_REQUIRED(lock_);
+
+  // Returns true if the free chunk 'c' has no pending work on its stream.
+  bool IsStreamReleased(const Chunk& c) const
+      TF_EXCLUSIVE_LOCKS_REQUIRED(lock_);
+
+  // Returns true if the free chunks 'a' and 'b' may be merged.
+  bool CanMergeStreams(const Chunk& a, const Chunk& b) const
+      TF_EXCLUSIVE_LOCKS_REQUIRED(lock_);
+
+  // Untags and coalesces free chunks whose streams have released them, which
+  // may be left uncoalesced next to chunks of other streams.  Returns true if
+  // any were found.
+  bool CoalesceStreamReleasedChunks() TF_EXCLUSIVE_LOCKS_REQUIRED(lock_);
 
   // Splits the chunk specified by 'h' into two chunks, one at least
   // of size 'num_bytes'.
@@ -521,12 +688,89 @@ class BFCAllocator : public Allocator {
     size_t total_requested_bytes_in_use = 0;
     size_t total_chunks_in_use = 0;
     size_t total_chunks_in_bin = 0;
+    // Chunks held by the chunk caches. They are neither in use nor free.
+    size_t total_bytes_cached = 0;
+    size_t total_chunks_cached = 0;
   };
 
   // Computes and returns a BinDebugInfo for each Bin.
   std::array<BinDebugInfo, kNumBins> get_bin_debug_info()
       TF_EXCLUSIVE_LOCKS_REQUIRED(lock_);
 
+  // Chunk caches (see Options::use_thread_local_caches). Chunks of up to
+  // kMaxCachedAllocationBytes are taken out of the bins in batches and then
+  // handed out and returned through the cache of the calling thread. From the
+  // bins' point of view such a chunk stays in use until it is drained from a
+  // cache, so stats and debug info subtract the cached bytes. Threads are
+  // mapped onto kNumChunkCaches caches by their id.
+  //
+  // Lock order: lock_ may be held while acquiring a ChunkCache or
+  // OwnedChunkShard mutex, never the other way around, and those two are never
+  // held together.
+  static constexpr size_t kMaxCachedAllocationBytes = 4096;
+  static constexpr int kNumCacheSizeClasses =
+      kMaxCachedAllocationBytes / kMinAllocationSize;
+  // Upper bound on the bytes a cache holds per size class.
+  static constexpr size_t kChunkCacheBytesPerSizeClass = 32 << 10;
+  static constexpr int kNumChunkCaches = 16;
+
+  struct alignas(64) ChunkCache {
+    mutex mu;
+    // Cached chunk pointers, indexed by size class.
+    std::array<std::vector<void*>, kNumCacheSizeClasses> chunks
+        TF_GUARDED_BY(mu);
+  };
+
+  // Maps every chunk owned by the caches, whether cached or handed out, to its
+  // size class. Sharded by address.
+  struct alignas(64) OwnedChunkShard {
+    mutex mu;
+    absl::flat_hash_map<const void*, int> size_classes TF_GUARDED_BY(mu);
+  };
+
+  static size_t SizeClassBytes(int size_class) {
+    return (size_class + 1) * kMinAllocationSize;
+  }
+  ChunkCache* ChunkCacheForCurrentThread();
+  OwnedChunkShard* OwnedChunkShardFor(const void* ptr);
+
+  // Returns a chunk for `num_bytes` from the calling thread's cache, refilling
+  // the cache from the bins if it is empty. Returns nullptr if the request
+  // can't be served by the caches.
+  void* AllocateFromChunkCache(size_t num_bytes);
+
+  // Returns true and takes `ptr` into the calling thread's cache if it is owned
+  // by the caches. Drains half of the cache to the bins when it is full.
+  bool DeallocateToChunkCache(void* ptr);
+
+  // Returns the cache-owned chunks `ptrs`, none of which may be handed out, to
+  // the bins.
+  void ReleaseCachedChunks(absl::Span<void* const> ptrs)
+      TF_EXCLUSIVE_LOCKS_REQUIRED(lock_);
+
+  // Returns every cached chunk to the bins. Returns true if there were any.
+  bool FlushChunkCaches() TF_EXCLUSIVE_LOCKS_REQUIRED(lock_);
+
+  // Returns the pointers of all currently cached chunks.
+  absl::flat_hash_set<const void*> CachedChunkPtrs() const
+      TF_EXCLUSIVE_LOCKS_REQUIRED(lock_);
+
+  // Returns stats_ with the cached chunks accounted as free.
+  AllocatorStats StatsExcludingCachedChunks() const
+      TF_EXCLUSIVE_LOCKS_REQUIRED(lock_);
+
+  std::unique_ptr<ChunkCache[]> chunk_caches_;
+  std::unique_ptr<OwnedChunkShard[]> owned_chunk_shards_;
+  // Total size of the cached chunks.
+  std::atomic<int64_t> cached_bytes_{0};
+  // Number of allocations served from a cache without touching the bins.
+  std::atomic<int64_t> num_cached_allocs_{0};
+  // Mirror of stats_.bytes_in_use, maintained only while the caches are on, so
+  // that allocations served from a cache can update the peak without lock_.
+  std::atomic<int64_t> bin_bytes_in_use_{0};
+  // Peak of bytes in use, excluding cached chunks, seen by cache hits.
+  std::atomic<int64_t> cached_peak_bytes_in_use_{0};
+
   AllocatorRetry retry_helper_;
 
   // Structures immutable after construction
@@ -594,6 +838,9 @@ class BFCAllocator : public Allocator {
   SharedCounter* timing_counter_ = nullptr;
   std::deque<ChunkHandle> timestamped_chunks_;
 
+  // Whether Options::then_execute_on_stream is set.
+  const bool stream_ordered_;
+
   std::atomic<uint64> safe_frontier_ = {0};
 
   // Structures mutable after construction
@@ -609,8 +856,38 @@ class BFCAllocator : public Allocator {
   // newly-created chunk.
   int64_t next_allocation_id_ TF_GUARDED_BY(lock_);
 
+  // Release state of each stream a chunk was allocated on.
+  struct StreamState {
+    // Sequence number of the last chunk freed on the stream.
+    uint64 last_free_seq = 0;
+    // Chunks freed up to this sequence number are reusable on any stream.
+    uint64 last_released_seq = 0;
+    // Whether a release callback is scheduled on the stream. At most one is
+    // in flight per stream.
+    bool release_pending = false;
+  };
+  absl::flat_hash_map<void*, StreamState> stream_states_ TF_GUARDED_BY(lock_);
+  // Streams other than their own that in-use chunks were recorded on.
+  absl::flat_hash_map<const void*, gtl::InlinedVector<void*, 2>>
+      cross_stream_uses_ TF_GUARDED_BY(lock_);
+  // Callbacks passed to then_execute_on_stream that haven't finished.
+  int num_pending_stream_callbacks_ TF_GUARDED_BY(lock_) = 0;
+  condition_variable stream_callbacks_done_;
+
   // Stats.
   AllocatorStats stats_ TF_GUARDED_BY(lock_);
+
+  // Telemetry, only used if Options::record_telemetry is set. The
+  // fragmentation is sampled once every kFragmentationSamplePeriod
+  // allocations.
+  static constexpr int64_t kFragmentationSamplePeriod = 256;
+  absl::flat_hash_map<string, std::unique_ptr<OpTelemetry>> op_telemetry_
+      TF_GUARDED_BY(lock_);
+  monitoring::SamplerCell* fragmentation_cell_ = nullptr;
+  monitoring::GaugeCell<int64_t>* phase_peak_cell_ TF_GUARDED_BY(lock_) =
+      nullptr;
+  int64_t phase_peak_bytes_in_use_ TF_GUARDED_BY(lock_) = 0;
+  int64_t num_recorded_allocs_ TF_GUARDED_BY(lock_) = 0;
 #ifdef TENSORFLOW_MEM_DEBUG
   int64 action_counter_ = 0 TF_GUARDED_BY(lock_);
 #define MEM_DEBUG_SIZE_HISTORY_SIZE 4096
@@ -52,7 +52,8 @@ CollectiveParamResolverLocal::CollectiveParamResolverLocal(
       nccl_communicator_(nccl_communicator),
       task_name_(task_name),
       gpu_ring_order_(
-          config.gpu_options().experimental().collective_ring_order()) {}
+          config.gpu_options().experimental().collective_ring_order()),
+      ring_wire_dtype_(config.experimental().collective_ring_wire_dtype()) {}
 
 void CollectiveParamResolverLocal::CompleteGroupAsync(
     const DeviceAttributes& device, CollGroupParams* group_params,
@@ -67,7 +68,10 @@ const char* GetCollectiveName(const CollectiveParams* cp, bool nccl) {
       return nccl ? "NcclBroadcast" : "HierarchicalTreeBroadcast";
 
     case REDUCTION_COLLECTIVE:
-      return nccl ? "NcclReduce" : "RingReduce";
+      if (nccl) return "NcclReduce";
+      return cp->instance.impl_details.communication_hint == "hierarchical"
+                 ? "HierarchicalReduce"
+                 : "RingReduce";
 
     case GATHER_COLLECTIVE:
       return nccl ? "NcclGather" : "RingGather";
@@ -78,6 +82,9 @@ const char* GetCollectiveName(const CollectiveParams* cp, bool nccl) {
     case ALL_TO_ALL_COLLECTIVE:
       return "AllToAll";
 
+    case ALL_TO_ALL_V_COLLECTIVE:
+      return nccl ? "NcclAllToAllV" : "AllToAllV";
+
     default:
       return "undef";
   }
@@ -693,6 +700,14 @@ void CollectiveParamResolverLocal::AssignCollectiveType(CollectiveParams* cp) {
       CollectiveRegistry::LookupParamResolverInstance("NcclReduce", &col_impl)
           .ok();
   cp->instance.impl_details.collective_name = GetCollectiveName(cp, use_nccl);
+  // Chunks are only compressed for CPU ring reductions spanning tasks, where
+  // the transfers between the tasks are expected to dominate.
+  if ((ring_wire_dtype_ == DT_BFLOAT16 || ring_wire_dtype_ == DT_HALF) &&
+      cp->instance.impl_details.collective_name == "RingReduce" &&
+      cp->instance.data_type == DT_FLOAT &&
+      cp->group.device_type == DEVICE_CPU && cp->group.num_tasks > 1) {
+    cp->instance.impl_details.wire_dtype = ring_wire_dtype_;
+  }
   VLOG(1) << "AssignCollectiveType "
           << cp->instance.impl_details.collective_name;
 }
@@ -191,6 +191,7 @@ class CollectiveParamResolverLocal : public ParamResolverInterface {
   NcclCommunicatorInterface* nccl_communicator_;  // Not owned.
   string task_name_;
   string gpu_ring_order_;
+  const DataType ring_wire_dtype_;
   mutex group_mu_;
   gtl::FlatMap<int32, std::unique_ptr<GroupRec>> group_table_
       TF_GUARDED_BY(group_mu_);
@@ -22,6 +22,13 @@ namespace tensorflow {
 inline constexpr char kTpuCostName[] = "tpu";
 inline constexpr char kGcuCostName[] = "gcu";
 inline constexpr char kNoOpCostName[] = "no_op";
+// The time spent in the kernels run by the executors of a request.
+inline constexpr char kOpComputeCostName[] = "op_compute";
+
+// Types of per-request metrics.
+//
+// The bytes of the tensors produced by the kernels run for a request.
+inline constexpr char kOpOutputBytesMetricName[] = "op_output_bytes";
 
 // Each type of per-request cost could have the following versions.
 //
@@ -15,6 +15,11 @@ limitations under the License.
 
 #include "tensorflow/core/common_runtime/device/device_event_mgr.h"
 
+#include <algorithm>
+#include <utility>
+
+#include "tensorflow/core/framework/metrics.h"
+#include "tensorflow/core/platform/env_time.h"
 #include "tensorflow/core/platform/stacktrace.h"
 #include "tensorflow/core/platform/stream_executor.h"
 #include "tensorflow/core/protobuf/config.pb.h"
@@ -28,6 +33,14 @@ namespace {
 //  - Should EventMgrs be shared between devices on a machine with multiple
 //  devices of the same type?
 static const int kNumThreads = 2;
+
+// After a poll retires an event, the polling loop re-polls this many times
+// without sleeping, since completions tend to come in bursts.
+static const int kNumSpinPolls = 10;
+
+// The polling loop then sleeps for polling_active_delay_usecs, doubling the
+// delay after every unproductive poll until it is this many times longer.
+static const int kMaxBackoffShift = 4;
 }  // namespace
 
 namespace device_event_mgr {
@@ -97,6 +110,10 @@ EventMgr::EventMgr(se::StreamExecutor* se, const GPUOptions& gpu_options)
                                       : 10),
       threadpool_(Env::Default(), "Device_Event_Manager", kNumThreads) {
   device_event_mgr::InitThreadpoolLabels(&threadpool_);
+  if (gpu_options.experimental().event_polling_blocking_sync()) {
+    sync_stream_ = std::make_unique<se::Stream>(exec_);
+    sync_stream_->Init();
+  }
   StartPollingLoop();
 }
 
@@ -141,10 +158,21 @@ void EventMgr::StopPollingLoop() {
 //
 // While one or more events is outstanding, poll for completed events.  When no
 // events are outstanding, we sleep until one is enqueued.
+//
+// Polls that retire nothing move the loop through three phases: it first spins
+// for kNumSpinPolls polls, then sleeps with an exponentially growing delay and
+// finally, if a sync stream was requested, blocks in the driver until the
+// oldest pending event completes.  Any poll that retires an event starts over
+// with spinning.
 void EventMgr::PollLoop() {
+  const int64_t max_delay_usecs = polling_active_delay_usecs_
+                                  << kMaxBackoffShift;
   ToFreeVector to_free;
+  int idle_polls = 0;
+  int64_t delay_usecs = polling_active_delay_usecs_;
   while (true) {
     bool events_still_pending;
+    bool wait_for_event = false;
     {
       mutex_lock l(mu_);
       if (stop_polling_) {
@@ -155,17 +183,54 @@ void EventMgr::PollLoop() {
       }
       PollEvents(true, &to_free);
       events_still_pending = !used_events_.empty();
+      if (!to_free.empty() || !events_still_pending) {
+        idle_polls = 0;
+        delay_usecs = polling_active_delay_usecs_;
+      } else if (++idle_polls > kNumSpinPolls + kMaxBackoffShift + 1 &&
+                 sync_stream_ != nullptr) {
+        // PollEvents() pops the retired records off the front of the queue,
+        // so the front is the oldest pending event.  The wait is enqueued
+        // under the lock, before the event can be recycled and re-recorded.
+        sync_stream_->ThenWaitFor(used_events_.front().event);
+        wait_for_event = true;
+      }
+    }
+    if (!to_free.empty()) {
+      FreeMemory(std::move(to_free));
+      to_free.clear();
     }
-    FreeMemory(to_free);
-    to_free.clear();
 
-    if (events_still_pending) {
-      Env::Default()->SleepForMicroseconds(polling_active_delay_usecs_);
+    if (wait_for_event) {
+      Status s = sync_stream_->BlockHostUntilDone();
+      if (!s.ok()) {
+        LOG(ERROR) << "Waiting for a device event failed, falling back to "
+                      "polling: "
+                   << s;
+        sync_stream_.reset();
+      }
+    } else if (events_still_pending && idle_polls > kNumSpinPolls) {
+      Env::Default()->SleepForMicroseconds(delay_usecs);
+      delay_usecs = std::min(2 * delay_usecs, max_delay_usecs);
     }
   }
   polling_stopped_->Notify();
 }
 
+void EventMgr::FreeMemory(ToFreeVector to_free) {
+  if (to_free.empty()) return;
+  metrics::RecordEventMgrCallbackBatchSize(to_free.size());
+  // The functions must be called in another thread.
+  threadpool_.Schedule([to_free = std::move(to_free)]() {
+    for (const InUse& iu : to_free) {
+      if (iu.func == nullptr) continue;
+      const uint64 now = EnvTime::NowMicros();
+      metrics::RecordEventMgrCallbackLatency(now > iu.usecs ? now - iu.usecs
+                                                            : 0);
+      iu.func();
+    }
+  });
+}
+
 void EventMgr::QueueInUse(se::Stream* stream, InUse in_use) {
   VLOG(2) << "QueueInUse  free_events_ " << free_events_.size()
           << " used_events_ " << used_events_.size();
@@ -179,6 +244,7 @@ void EventMgr::QueueInUse(se::Stream* stream, InUse in_use) {
   free_events_.pop_back();
   stream->ThenRecordEvent(e);
   in_use.event = e;
+  in_use.usecs = EnvTime::NowMicros();
   bool was_empty = used_events_.empty();
   used_events_.push_back(in_use);
   // Maybe wake up the polling thread
@@ -207,6 +273,11 @@ void EventMgr::PollEvents(bool is_dedicated_poller,
                           gtl::InlinedVector<InUse, 4>* to_free) {
   VLOG(2) << "PollEvents  free_events_ " << free_events_.size()
           << " used_events_ " << used_events_.size();
+  // Every event that is still queued was pending at the time of the last
+  // full sweep, unless it was queued later, which bounds its completion time
+  // from below.
+  const uint64 pending_usecs = last_sweep_usecs_;
+  if (is_dedicated_poller) last_sweep_usecs_ = EnvTime::NowMicros();
   // Sweep the remaining events in order.  If this is the dedicated
   // polling thread, check the entire set.  Otherwise, just sweep up to
   // the first non-complete record that is still pending.
@@ -227,6 +298,7 @@ void EventMgr::PollEvents(bool is_dedicated_poller,
         // Make a copy of the InUse record so we can free it after releasing
         // the lock
         to_free->push_back(iu);
+        to_free->back().usecs = std::max(iu.usecs, pending_usecs);
         free_events_.push_back(iu.event);
         // Mark this InUse record as completed.
         iu.event = nullptr;
@@ -17,6 +17,7 @@ limitations under the License.
 #define TENSORFLOW_CORE_COMMON_RUNTIME_DEVICE_DEVICE_EVENT_MGR_H_
 
 #include <deque>
+#include <memory>
 #include <vector>
 
 #include "tensorflow/core/framework/log_memory.h"
@@ -77,7 +78,7 @@ class EventMgr {
       QueueFunc(stream, std::move(func));
       PollEvents(false, &to_free);
     }
-    FreeMemory(to_free);
+    if (!to_free.empty()) FreeMemory(std::move(to_free));
   }
 
  private:
@@ -92,18 +93,19 @@ class EventMgr {
   struct InUse {
     se::Event* event;
     std::function<void()> func;
+    // The time the event was queued.  Once the event has completed, a lower
+    // bound on the time of its completion.
+    uint64 usecs = 0;
   };
 
   typedef gtl::InlinedVector<InUse, 4> ToFreeVector;
 
   EventMgr(se::StreamExecutor* se, const GPUOptions& gpu_options);
 
-  void FreeMemory(const ToFreeVector& to_free) {
-    for (const auto& iu : to_free) {
-      // The function must be called in another thread.
-      if (iu.func != nullptr) threadpool_.Schedule(iu.func);
-    }
-  }
+  // Runs the callbacks of the retired events in "to_free" on the threadpool.
+  // All of them are handed over as a single closure, so that a burst of
+  // completed events costs one Schedule() rather than one per event.
+  void FreeMemory(ToFreeVector to_free);
 
   // Stream-enqueue an unused Event and save with it a collection of
   // Tensors and/or a BufRec to be deleted only after the Event
@@ -138,6 +140,14 @@ class EventMgr {
   // A FIFO queue of InUse events and associated tensors.
   std::deque<InUse> used_events_ TF_GUARDED_BY(mu_);
 
+  // The time of the last PollEvents() call that swept the whole queue.
+  uint64 last_sweep_usecs_ TF_GUARDED_BY(mu_) = 0;
+
+  // If not null, the polling loop waits on this stream for the oldest pending
+  // event once it has backed off to its longest sleep.  Only used by the
+  // polling loop.
+  std::unique_ptr<se::Stream> sync_stream_;
+
   bool stop_polling_ TF_GUARDED_BY(mu_);
   std::unique_ptr<Notification> polling_stopped_;
 
@@ -28,6 +28,7 @@ limitations under the License.
 #include "tensorflow/core/graph/node_builder.h"
 #include "tensorflow/core/lib/core/notification.h"
 #include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/lib/monitoring/cell_reader.h"
 #include "tensorflow/core/platform/stream_executor.h"
 #include "tensorflow/core/platform/test.h"
 #include "tensorflow/core/platform/test_benchmark.h"
@@ -138,6 +139,39 @@ TEST(EventMgr, WarnIfInCallback) {
   note.WaitForNotification();
   EXPECT_TRUE(hit);
 }
+
+// Tests that the polling loop still runs every callback when it is allowed to
+// block in the driver, and that the callback latencies are recorded.
+TEST(EventMgr, BlockingSyncPollLoop) {
+  monitoring::testing::CellReader<monitoring::testing::Histogram> latency(
+      "/tensorflow/core/event_mgr/callback_latency_usecs");
+  auto stream_exec = GPUMachineManager()->ExecutorForDevice(0).ValueOrDie();
+  GPUOptions gpu_options;
+  gpu_options.mutable_experimental()->set_event_polling_blocking_sync(true);
+  TEST_EventMgr em(stream_exec, gpu_options);
+  std::unique_ptr<se::Stream> stream(new se::Stream(stream_exec));
+  CHECK(stream);
+  stream->Init();
+  // Keep the stream busy for long enough that the polling loop backs off
+  // and ends up waiting in the driver.
+  constexpr uint64 kNumElements = 1 << 24;
+  se::ScopedDeviceMemory<float> mem =
+      stream_exec->AllocateOwnedArray<float>(kNumElements);
+  constexpr int kNumCallbacks = 20;
+  std::atomic<int> num_called(0);
+  Notification note;
+  for (int i = 0; i < kNumCallbacks; ++i) {
+    for (int j = 0; j < 10; ++j) {
+      stream->ThenMemset32(mem.ptr(), i, kNumElements * sizeof(float));
+    }
+    em.ThenExecute(stream.get(), [&num_called, &note]() {
+      if (++num_called == kNumCallbacks) note.Notify();
+    });
+  }
+  note.WaitForNotification();
+  EXPECT_EQ(kNumCallbacks, num_called);
+  EXPECT_EQ(kNumCallbacks, latency.Delta().num());
+}
 }  // namespace
 
 // Provides access to private resources of BaseGPUDevice.
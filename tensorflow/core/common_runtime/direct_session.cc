@@ -637,6 +637,16 @@ Status DirectSession::RunInternal(
     default_runner = [handler_ptr](Executor::Args::Closure c) {
       handler_ptr->ScheduleInterOpClosure(std::move(c));
     };
+  } else if (options_.config.experimental().use_inter_op_step_affinity() &&
+             threadpool_wrapper == nullptr && pool->NumThreads() > 1) {
+    // Closures scheduled from a pool thread go to that thread's own queue, so
+    // hinting the home thread only affects closures scheduled from outside the
+    // pool (e.g. the root nodes of the step and completed async kernels).
+    // Idle threads steal from the home thread when it falls behind.
+    const int home_thread = step_id % pool->NumThreads();
+    default_runner = [pool, home_thread](Executor::Args::Closure c) {
+      pool->ScheduleWithHint(std::move(c), home_thread, home_thread + 1);
+    };
   } else {
     default_runner = [pool](Executor::Args::Closure c) {
       pool->Schedule(std::move(c));
@@ -1389,6 +1399,10 @@ Status DirectSession::CreateExecutors(
     params.device = device;
     params.session_metadata = session_metadata;
     params.function_library = lib;
+    params.use_critical_path_scheduling =
+        options_.config.experimental().use_critical_path_scheduling();
+    params.use_adaptive_inline_execution =
+        options_.config.experimental().use_adaptive_inline_execution();
     auto opseg = device->op_segment();
     params.create_kernel =
         [this, lib, opseg](const std::shared_ptr<const NodeProperties>& props,
@@ -1869,21 +1883,38 @@ Status DirectSession::MakeCallable(const CallableOptions& callable_options,
   {
     mutex_lock l(callables_lock_);
     *out_handle = next_callable_handle_++;
-    callables_[*out_handle] = {std::move(ek), std::move(func_info)};
+    auto call_frames = std::make_shared<CallFramePool>(ek.get());
+    callables_[*out_handle] = {std::move(ek), std::move(func_info),
+                               std::move(call_frames)};
   }
   return OkStatus();
 }
 
 class DirectSession::RunCallableCallFrame : public CallFrameInterface {
  public:
-  RunCallableCallFrame(DirectSession* session,
-                       ExecutorsAndKeys* executors_and_keys,
-                       const std::vector<Tensor>* feed_tensors,
-                       std::vector<Tensor>* fetch_tensors)
-      : session_(session),
-        executors_and_keys_(executors_and_keys),
-        feed_tensors_(feed_tensors),
-        fetch_tensors_(fetch_tensors) {}
+  explicit RunCallableCallFrame(ExecutorsAndKeys* executors_and_keys)
+      : executors_and_keys_(executors_and_keys) {}
+
+  // Points the frame at the feeds and fetches of the next step.
+  void Bind(const std::vector<Tensor>* feed_tensors,
+            std::vector<Tensor>* fetch_tensors) {
+    feed_tensors_ = feed_tensors;
+    fetch_tensors_ = fetch_tensors;
+  }
+
+  // Drops all references held by the frame, keeping the capacity of
+  // `converted_feed_tensors_` for the next step.
+  void Reset() {
+    feed_tensors_ = nullptr;
+    fetch_tensors_ = nullptr;
+    converted_feed_tensors_.clear();
+  }
+
+  // Scratch storage for feeds that must be converted before the step runs
+  // (e.g. resource handles). Empty whenever the frame is not in use.
+  std::vector<Tensor>* converted_feed_tensors() {
+    return &converted_feed_tensors_;
+  }
 
   size_t num_args() const override {
     return executors_and_keys_->input_types.size();
@@ -1910,10 +1941,61 @@ class DirectSession::RunCallableCallFrame : public CallFrameInterface {
   }
 
  private:
-  DirectSession* const session_;                   // Not owned.
-  ExecutorsAndKeys* const executors_and_keys_;     // Not owned.
-  const std::vector<Tensor>* const feed_tensors_;  // Not owned.
-  std::vector<Tensor>* const fetch_tensors_;       // Not owned.
+  ExecutorsAndKeys* const executors_and_keys_;        // Not owned.
+  const std::vector<Tensor>* feed_tensors_ = nullptr;  // Not owned.
+  std::vector<Tensor>* fetch_tensors_ = nullptr;       // Not owned.
+  std::vector<Tensor> converted_feed_tensors_;
+};
+
+// The call frames of one callable. Each in-flight `RunCallable()` takes a
+// frame from the pool and returns it when the step finishes, so the pool grows
+// to the peak number of concurrent calls and steady-state calls reuse frames
+// instead of allocating them.
+class DirectSession::CallFramePool {
+ public:
+  explicit CallFramePool(ExecutorsAndKeys* executors_and_keys)
+      : executors_and_keys_(executors_and_keys) {}
+
+  // Owns a frame taken from `pool` for the lifetime of one step.
+  class ScopedFrame {
+   public:
+    explicit ScopedFrame(CallFramePool* pool)
+        : pool_(pool), frame_(pool->Acquire()) {}
+    ~ScopedFrame() { pool_->Release(std::move(frame_)); }
+
+    RunCallableCallFrame* get() const { return frame_.get(); }
+
+   private:
+    CallFramePool* const pool_;
+    std::unique_ptr<RunCallableCallFrame> frame_;
+
+    TF_DISALLOW_COPY_AND_ASSIGN(ScopedFrame);
+  };
+
+ private:
+  std::unique_ptr<RunCallableCallFrame> Acquire() {
+    {
+      mutex_lock l(mu_);
+      if (!free_frames_.empty()) {
+        std::unique_ptr<RunCallableCallFrame> frame =
+            std::move(free_frames_.back());
+        free_frames_.pop_back();
+        return frame;
+      }
+    }
+    return std::make_unique<RunCallableCallFrame>(executors_and_keys_);
+  }
+
+  void Release(std::unique_ptr<RunCallableCallFrame> frame) {
+    frame->Reset();
+    mutex_lock l(mu_);
+    free_frames_.push_back(std::move(frame));
+  }
+
+  ExecutorsAndKeys* const executors_and_keys_;  // Not owned.
+  mutex mu_;
+  std::vector<std::unique_ptr<RunCallableCallFrame>> free_frames_
+      TF_GUARDED_BY(mu_);
 };
 
 ::tensorflow::Status DirectSession::RunCallable(
@@ -1933,6 +2015,7 @@ class DirectSession::RunCallableCallFrame : public CallFrameInterface {
 
   // Check if we already have an executor for these arguments.
   std::shared_ptr<ExecutorsAndKeys> executors_and_keys;
+  std::shared_ptr<CallFramePool> call_frames;
   const int64_t step_id = step_id_counter_.fetch_add(1);
 
   {
@@ -1940,7 +2023,9 @@ class DirectSession::RunCallableCallFrame : public CallFrameInterface {
     if (handle >= next_callable_handle_) {
       return errors::InvalidArgument("No such callable handle: ", handle);
     }
-    executors_and_keys = callables_[handle].executors_and_keys;
+    const Callable& callable = callables_[handle];
+    executors_and_keys = callable.executors_and_keys;
+    call_frames = callable.call_frames;
   }
 
   if (!executors_and_keys) {
@@ -1961,6 +2046,8 @@ class DirectSession::RunCallableCallFrame : public CallFrameInterface {
         " feed tensors, but got ", feed_tensors.size());
   }
   if (fetch_tensors != nullptr) {
+    // A caller that passes the same `fetch_tensors` to every call keeps its
+    // storage: the resize is a no-op and the outputs are assigned in place.
     fetch_tensors->resize(executors_and_keys->output_types.size());
   } else if (!executors_and_keys->output_types.empty()) {
     return errors::InvalidArgument(
@@ -1976,11 +2063,14 @@ class DirectSession::RunCallableCallFrame : public CallFrameInterface {
   }
   metrics::RecordGraphInputTensors(input_size);
 
-  std::unique_ptr<std::vector<Tensor>> converted_feed_tensors;
+  // A specialized CallFrame implementation that takes advantage of the
+  // optimized RunCallable interface. The frame is reused across calls.
+  CallFramePool::ScopedFrame call_frame(call_frames.get());
   const std::vector<Tensor>* actual_feed_tensors;
 
   if (TF_PREDICT_FALSE(any_resource_feeds)) {
-    converted_feed_tensors = std::make_unique<std::vector<Tensor>>();
+    std::vector<Tensor>* converted_feed_tensors =
+        call_frame.get()->converted_feed_tensors();
     converted_feed_tensors->reserve(feed_tensors.size());
     for (const Tensor& t : feed_tensors) {
       if (t.dtype() == DT_RESOURCE) {
@@ -1991,22 +2081,19 @@ class DirectSession::RunCallableCallFrame : public CallFrameInterface {
         converted_feed_tensors->emplace_back(t);
       }
     }
-    actual_feed_tensors = converted_feed_tensors.get();
+    actual_feed_tensors = converted_feed_tensors;
   } else {
     actual_feed_tensors = &feed_tensors;
   }
-
-  // A specialized CallFrame implementation that takes advantage of the
-  // optimized RunCallable interface.
-  RunCallableCallFrame call_frame(this, executors_and_keys.get(),
-                                  actual_feed_tensors, fetch_tensors);
+  call_frame.get()->Bind(actual_feed_tensors, fetch_tensors);
 
   if (LogMemory::IsEnabled()) {
     LogMemory::RecordStep(step_id, run_state_args.handle);
   }
 
   TF_RETURN_IF_ERROR(RunInternal(
-      step_id, executors_and_keys->callable_options.run_options(), &call_frame,
+      step_id, executors_and_keys->callable_options.run_options(),
+      call_frame.get(),
       executors_and_keys.get(), run_metadata, threadpool_options));
 
   if (fetch_tensors != nullptr) {
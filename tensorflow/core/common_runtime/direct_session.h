@@ -368,9 +368,12 @@ class DirectSession : public Session {
       TF_GUARDED_BY(executor_lock_);
 
   class RunCallableCallFrame;
+  class CallFramePool;
   struct Callable {
     std::shared_ptr<ExecutorsAndKeys> executors_and_keys;
     std::shared_ptr<FunctionInfo> function_info;
+    // Reusable call frames for concurrent `RunCallable()` calls.
+    std::shared_ptr<CallFramePool> call_frames;
     ~Callable();
   };
   mutex callables_lock_;
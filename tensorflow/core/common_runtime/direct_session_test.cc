@@ -44,6 +44,7 @@ limitations under the License.
 #include "tensorflow/core/lib/core/status_test_util.h"
 #include "tensorflow/core/lib/core/threadpool.h"
 #include "tensorflow/core/lib/strings/str_util.h"
+#include "tensorflow/core/platform/blocking_counter.h"
 #include "tensorflow/core/platform/protobuf.h"
 #include "tensorflow/core/platform/stacktrace.h"
 #include "tensorflow/core/platform/test.h"
@@ -199,6 +200,38 @@ TEST_F(DirectSessionMinusAXTest, RunSimpleNetwork_Callable) {
   }
 }
 
+TEST_F(DirectSessionMinusAXTest, CallableReusesFetchTensors) {
+  Initialize({3, 2, -1, 0});
+  auto session = CreateSession();
+  ASSERT_TRUE(session != nullptr);
+  TF_ASSERT_OK(session->Create(def_));
+
+  Session::CallableHandle handle;
+  TF_ASSERT_OK(session->MakeCallable(
+      MakeCallableOptions({}, {y_ + ":0", y_neg_ + ":0"}, {}), &handle));
+
+  // Passing the same `outputs` to every call keeps its storage, and each call
+  // overwrites the previous outputs.
+  std::vector<Tensor> outputs(2);
+  const Tensor* storage = outputs.data();
+  for (int i = 0; i < 3; ++i) {
+    TF_ASSERT_OK(session->RunCallable(handle, {}, &outputs, nullptr));
+    ASSERT_EQ(2, outputs.size());
+    EXPECT_EQ(storage, outputs.data());
+    EXPECT_FLOAT_EQ(5.0, outputs[0].matrix<float>()(0, 0));
+    EXPECT_FLOAT_EQ(-5.0, outputs[1].matrix<float>()(0, 0));
+  }
+
+  // Outputs left over from an unrelated call are replaced.
+  outputs = {Tensor(DT_INT32, TensorShape({})), Tensor()};
+  TF_ASSERT_OK(session->RunCallable(handle, {}, &outputs, nullptr));
+  ASSERT_EQ(2, outputs.size());
+  EXPECT_EQ(DT_FLOAT, outputs[0].dtype());
+  EXPECT_FLOAT_EQ(5.0, outputs[0].matrix<float>()(0, 0));
+
+  TF_ASSERT_OK(session->ReleaseCallable(handle));
+}
+
 TEST_F(DirectSessionMinusAXTest, RunSimpleNetwork_OptimizeForStaticGraph) {
   Initialize({3, 2, -1, 0});
   SessionOptions options(DefaultSessionOptions());
@@ -801,6 +834,27 @@ TEST_F(DirectSessionMinusAXTest, UseRunHandlerPool) {
   EXPECT_FLOAT_EQ(5.0, mat(0, 0));
 }
 
+TEST_F(DirectSessionMinusAXTest, UseInterOpStepAffinity) {
+  Initialize({3, 2, -1, 0});
+  SessionOptions options = DefaultSessionOptions();
+  options.config.mutable_experimental()->set_use_inter_op_step_affinity(true);
+  std::unique_ptr<Session> session(NewSession(options));
+  ASSERT_TRUE(session != nullptr);
+  TF_ASSERT_OK(session->Create(def_));
+  std::vector<std::pair<string, Tensor>> inputs;
+
+  std::vector<string> output_names = {y_ + ":0"};
+  std::vector<string> target_nodes = {y_neg_};
+  for (int i = 0; i < 10; ++i) {
+    std::vector<Tensor> outputs;
+    TF_ASSERT_OK(session->Run(inputs, output_names, target_nodes, &outputs));
+    ASSERT_EQ(1, outputs.size());
+    auto mat = outputs[0].matrix<float>();
+    ASSERT_TRUE(outputs[0].IsInitialized());
+    EXPECT_FLOAT_EQ(5.0, mat(0, 0));
+  }
+}
+
 TEST(DirectSessionTest, KeepsStateAcrossRunsOfSession) {
   GraphDef def;
   Graph g(OpRegistry::Global());
@@ -2728,6 +2782,88 @@ void BM_FeedFetchCallableSingleThreadExecutor(
                            /* use_single_threaded_executor */ true);
 }
 
+// Inter-op schedulers compared by `BM_ConcurrentRuns`.
+enum class InterOpScheduler { kDefault, kRunHandlerPool, kStepAffinity };
+
+// A benchmark for many concurrent small `DirectSession::Run()` calls, each of
+// which runs `kNumBranches` independent chains of `kChainLength` Identity ops.
+void ConcurrentRunsBenchmarkHelper(::testing::benchmark::State& state,
+                                   int num_concurrent_runs,
+                                   InterOpScheduler scheduler) {
+  constexpr int kNumBranches = 16;
+  constexpr int kChainLength = 4;
+  Tensor value(DT_FLOAT, TensorShape());
+  value.flat<float>()(0) = 37.0;
+
+  Graph g(OpRegistry::Global());
+  Node* placeholder;
+  TF_CHECK_OK(NodeBuilder(g.NewName("Placeholder"), "Placeholder")
+                  .Attr("shape", TensorShape())
+                  .Attr("dtype", DT_FLOAT)
+                  .Device("/cpu:0")
+                  .Finalize(&g, &placeholder));
+  std::vector<std::pair<string, Tensor>> inputs = {
+      {placeholder->name() + ":0", value}};
+  std::vector<string> outputs;
+  for (int i = 0; i < kNumBranches; ++i) {
+    Node* node = placeholder;
+    for (int j = 0; j < kChainLength; ++j) {
+      TF_CHECK_OK(NodeBuilder(g.NewName("Identity"), "Identity")
+                      .Input(node)
+                      .Attr("T", DT_FLOAT)
+                      .Device("/cpu:0")
+                      .Finalize(&g, &node));
+    }
+    outputs.push_back(node->name() + ":0");
+  }
+  GraphDef gd;
+  g.ToGraphDef(&gd);
+  SessionOptions opts;
+  if (scheduler == InterOpScheduler::kStepAffinity) {
+    opts.config.mutable_experimental()->set_use_inter_op_step_affinity(true);
+  }
+  RunOptions run_options;
+  if (scheduler == InterOpScheduler::kRunHandlerPool) {
+    run_options.mutable_experimental()->set_use_run_handler_pool(true);
+  }
+  std::unique_ptr<Session> session(NewSession(opts));
+  TF_CHECK_OK(session->Create(gd));
+  {
+    // Ignore the first run, which incurs the graph partitioning overhead.
+    std::vector<Tensor> output_values;
+    TF_CHECK_OK(session->Run(run_options, inputs, outputs, {}, &output_values,
+                             nullptr));
+  }
+
+  thread::ThreadPool clients(Env::Default(), "clients", num_concurrent_runs);
+  for (auto s : state) {
+    BlockingCounter counter(num_concurrent_runs);
+    for (int i = 0; i < num_concurrent_runs; ++i) {
+      clients.Schedule([&]() {
+        std::vector<Tensor> output_values;
+        TF_CHECK_OK(session->Run(run_options, inputs, outputs, {},
+                                 &output_values, nullptr));
+        counter.DecrementCount();
+      });
+    }
+    counter.Wait();
+  }
+  state.SetItemsProcessed(state.iterations() * num_concurrent_runs);
+}
+
+void BM_ConcurrentRuns(::testing::benchmark::State& state) {
+  ConcurrentRunsBenchmarkHelper(state, /*num_concurrent_runs=*/state.range(0),
+                                InterOpScheduler::kDefault);
+}
+void BM_ConcurrentRunsRunHandlerPool(::testing::benchmark::State& state) {
+  ConcurrentRunsBenchmarkHelper(state, /*num_concurrent_runs=*/state.range(0),
+                                InterOpScheduler::kRunHandlerPool);
+}
+void BM_ConcurrentRunsStepAffinity(::testing::benchmark::State& state) {
+  ConcurrentRunsBenchmarkHelper(state, /*num_concurrent_runs=*/state.range(0),
+                                InterOpScheduler::kStepAffinity);
+}
+
 BENCHMARK(BM_FeedFetch)->Arg(1)->Arg(2)->Arg(5)->Arg(10);
 BENCHMARK(BM_FeedFetchCallable)->Arg(1)->Arg(2)->Arg(5)->Arg(10);
 BENCHMARK(BM_FeedFetchCallableSingleThread)->Arg(1)->Arg(2)->Arg(5)->Arg(10);
@@ -2736,6 +2872,9 @@ BENCHMARK(BM_FeedFetchCallableSingleThreadExecutor)
     ->Arg(2)
     ->Arg(5)
     ->Arg(10);
+BENCHMARK(BM_ConcurrentRuns)->Arg(1)->Arg(16)->Arg(64);
+BENCHMARK(BM_ConcurrentRunsRunHandlerPool)->Arg(1)->Arg(16)->Arg(64);
+BENCHMARK(BM_ConcurrentRunsStepAffinity)->Arg(1)->Arg(16)->Arg(64);
 
 }  // namespace
 
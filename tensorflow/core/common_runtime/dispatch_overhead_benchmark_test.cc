@@ -0,0 +1,289 @@
+/* Copyright 2022 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+// Benchmarks of the framework overhead of running ops, as opposed to the cost
+// of the kernels themselves (see kernel_benchmark_testlib.h). Every benchmark
+// runs no-op or Identity kernels on scalars, so almost all of the measured
+// time is spent in one dispatch path:
+//
+//   * BM_Executor*: the local executor running a graph.
+//   * BM_DirectSession*: `DirectSession::Run()` of the same graph.
+//   * BM_FunctionCall: a function call through the function library runtime,
+//     as used by `tf.function`.
+//   * BM_EagerDispatch*: eager execution of single ops.
+//
+// The first argument is the number of ops per step, and items_per_second is
+// the number of ops run per second. The second argument of the graph and
+// function benchmarks is the number of threads, and the ops are split into
+// that many independent chains. Eager benchmarks run one op at a time and
+// scale across benchmark threads instead.
+
+#include <functional>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "absl/strings/str_cat.h"
+#include "tensorflow/core/common_runtime/device_factory.h"
+#include "tensorflow/core/common_runtime/device_mgr.h"
+#include "tensorflow/core/common_runtime/eager/context.h"
+#include "tensorflow/core/common_runtime/eager/eager_operation.h"
+#include "tensorflow/core/common_runtime/eager/execute.h"
+#include "tensorflow/core/common_runtime/eager/tensor_handle.h"
+#include "tensorflow/core/common_runtime/executor.h"
+#include "tensorflow/core/common_runtime/process_function_library_runtime.h"
+#include "tensorflow/core/framework/function.h"
+#include "tensorflow/core/framework/function.pb.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/graph/algorithm.h"
+#include "tensorflow/core/graph/graph.h"
+#include "tensorflow/core/graph/testlib.h"
+#include "tensorflow/core/lib/core/threadpool.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/test.h"
+#include "tensorflow/core/platform/test_benchmark.h"
+#include "tensorflow/core/public/session.h"
+#include "tensorflow/core/public/session_options.h"
+#include "tensorflow/core/public/version.h"
+
+namespace tensorflow {
+namespace {
+
+constexpr char kDeviceName[] = "/job:localhost/replica:0/task:0/device:CPU:0";
+
+enum class OpKind { kNoOp, kIdentity };
+
+// Returns a graph of `num_chains` independent chains of `num_ops` ops in
+// total, followed by a NoOp that depends on all of them and whose name is
+// returned in `target`.
+std::unique_ptr<Graph> ChainsGraph(OpKind kind, int num_ops, int num_chains,
+                                   std::string* target) {
+  auto g = std::make_unique<Graph>(OpRegistry::Global());
+  Node* input = test::graph::Constant(g.get(), Tensor(1.0f));
+  std::vector<Node*> chain_ends;
+  for (int chain = 0; chain < num_chains; ++chain) {
+    Node* node = input;
+    for (int i = chain; i < num_ops; i += num_chains) {
+      node = kind == OpKind::kNoOp ? test::graph::NoOp(g.get(), {node})
+                                   : test::graph::Identity(g.get(), node);
+    }
+    chain_ends.push_back(node);
+  }
+  *target = test::graph::NoOp(g.get(), chain_ends)->name();
+  return g;
+}
+
+void ReportOps(::testing::benchmark::State& state, int num_ops) {
+  state.SetItemsProcessed(static_cast<int64_t>(state.iterations()) * num_ops);
+}
+
+void ExecutorBenchmark(::testing::benchmark::State& state, OpKind kind) {
+  const int num_ops = state.range(0);
+  const int num_threads = state.range(1);
+  std::string target;
+  std::unique_ptr<Graph> graph =
+      ChainsGraph(kind, num_ops, num_threads, &target);
+  FixupSourceAndSinkEdges(graph.get());
+  std::unique_ptr<Device> device =
+      DeviceFactory::NewDevice("CPU", {}, "/job:localhost/replica:0/task:0");
+  thread::ThreadPool pool(Env::Default(), "executor", num_threads);
+
+  LocalExecutorParams params;
+  params.device = device.get();
+  const int version = graph->versions().producer();
+  params.create_kernel =
+      [&device, version](const std::shared_ptr<const NodeProperties>& props,
+                         OpKernel** kernel) {
+        return CreateNonCachedKernel(device.get(), nullptr, props, version,
+                                     kernel);
+      };
+  params.delete_kernel = [](OpKernel* kernel) {
+    DeleteNonCachedKernel(kernel);
+  };
+  Executor* executor;
+  TF_CHECK_OK(NewLocalExecutor(params, *graph, &executor));
+  std::unique_ptr<Executor> executor_owner(executor);
+
+  Executor::Args args;
+  args.runner = [&pool](std::function<void()> fn) {
+    pool.Schedule(std::move(fn));
+  };
+  for (auto _ : state) {
+    TF_CHECK_OK(executor->Run(args));
+  }
+  ReportOps(state, num_ops);
+}
+
+void BM_ExecutorNoOp(::testing::benchmark::State& state) {
+  ExecutorBenchmark(state, OpKind::kNoOp);
+}
+
+void BM_ExecutorIdentity(::testing::benchmark::State& state) {
+  ExecutorBenchmark(state, OpKind::kIdentity);
+}
+
+void DirectSessionBenchmark(::testing::benchmark::State& state, OpKind kind) {
+  const int num_ops = state.range(0);
+  const int num_threads = state.range(1);
+  std::string target;
+  std::unique_ptr<Graph> graph =
+      ChainsGraph(kind, num_ops, num_threads, &target);
+  GraphDef graph_def;
+  graph->ToGraphDef(&graph_def);
+
+  SessionOptions options;
+  options.config.set_inter_op_parallelism_threads(num_threads);
+  // Keep the graph as it is, so that every op is run.
+  GraphOptions* graph_options = options.config.mutable_graph_options();
+  graph_options->mutable_optimizer_options()->set_opt_level(
+      OptimizerOptions::L0);
+  graph_options->mutable_rewrite_options()->set_disable_meta_optimizer(true);
+  std::unique_ptr<Session> session(NewSession(options));
+  TF_CHECK_OK(session->Create(graph_def));
+  // The first run prunes and partitions the graph, which is not measured.
+  TF_CHECK_OK(session->Run({}, {}, {target}, nullptr));
+  for (auto _ : state) {
+    TF_CHECK_OK(session->Run({}, {}, {target}, nullptr));
+  }
+  ReportOps(state, num_ops);
+}
+
+void BM_DirectSessionNoOp(::testing::benchmark::State& state) {
+  DirectSessionBenchmark(state, OpKind::kNoOp);
+}
+
+void BM_DirectSessionIdentity(::testing::benchmark::State& state) {
+  DirectSessionBenchmark(state, OpKind::kIdentity);
+}
+
+// Returns a function of `num_chains` independent chains of `num_ops` Identity
+// ops in total, each of which returns one output. Requires
+// `num_chains <= num_ops`.
+FunctionDef IdentityChainsFunction(int num_ops, int num_chains) {
+  std::vector<string> outputs;
+  std::vector<FunctionDefHelper::Node> nodes;
+  for (int chain = 0; chain < num_chains; ++chain) {
+    std::string input = "x";
+    for (int i = chain; i < num_ops; i += num_chains) {
+      const std::string name =
+          i + num_chains < num_ops ? absl::StrCat("n", i)
+                                   : absl::StrCat("y", chain);
+      nodes.push_back({{name}, "Identity", {input}, {{"T", DT_FLOAT}}});
+      input = name;
+    }
+    outputs.push_back(absl::StrCat("y", chain, ": float"));
+  }
+  return FunctionDefHelper::Define("IdentityChains", {"x: float"}, outputs,
+                                   {}, nodes);
+}
+
+void BM_FunctionCall(::testing::benchmark::State& state) {
+  const int num_ops = state.range(0);
+  const int num_threads = state.range(1);
+  FunctionDefLibrary library;
+  *library.add_function() = IdentityChainsFunction(num_ops, num_threads);
+  FunctionLibraryDefinition lib_def(OpRegistry::Global(), library);
+  StaticDeviceMgr device_mgr(DeviceFactory::NewDevice("CPU", {}, kDeviceName));
+  thread::ThreadPool pool(Env::Default(), "function", num_threads);
+  OptimizerOptions optimizer_options;
+  optimizer_options.set_opt_level(OptimizerOptions::L0);
+  ProcessFunctionLibraryRuntime pflr(&device_mgr, Env::Default(),
+                                     /*config=*/nullptr, TF_GRAPH_DEF_VERSION,
+                                     &lib_def, optimizer_options, &pool);
+  FunctionLibraryRuntime* flr = pflr.GetFLR(kDeviceName);
+  FunctionLibraryRuntime::Handle handle;
+  TF_CHECK_OK(flr->Instantiate("IdentityChains", AttrSlice(), &handle));
+
+  std::function<void(std::function<void()>)> runner =
+      [&pool](std::function<void()> fn) { pool.Schedule(std::move(fn)); };
+  FunctionLibraryRuntime::Options options;
+  options.runner = &runner;
+  const std::vector<Tensor> args = {Tensor(1.0f)};
+  std::vector<Tensor> rets;
+  for (auto _ : state) {
+    TF_CHECK_OK(flr->RunSync(options, handle, args, &rets));
+  }
+  ReportOps(state, num_ops);
+}
+
+// Returns an eager context that is shared by all benchmark threads.
+EagerContext* SharedEagerContext() {
+  static StaticDeviceMgr* device_mgr = new StaticDeviceMgr(
+      DeviceFactory::NewDevice("CPU", {}, kDeviceName));
+  static EagerContext* ctx = new EagerContext(
+      SessionOptions(), ContextDevicePlacementPolicy::DEVICE_PLACEMENT_SILENT,
+      /*async=*/false, device_mgr, /*device_mgr_owned=*/false,
+      /*rendezvous=*/nullptr, /*cluster_flr=*/nullptr);
+  return ctx;
+}
+
+void EagerDispatchBenchmark(::testing::benchmark::State& state, OpKind kind) {
+  const int num_ops = state.range(0);
+  EagerContext* ctx = SharedEagerContext();
+  Device* device = ctx->HostCPU();
+  core::RefCountPtr<TensorHandle> input(TensorHandle::CreateLocalHandle(
+      Tensor(1.0f), device, device, ctx));
+  const char* op_name = kind == OpKind::kNoOp ? "NoOp" : "Identity";
+  for (auto _ : state) {
+    for (int i = 0; i < num_ops; ++i) {
+      EagerOperation op(ctx);
+      TF_CHECK_OK(op.Reset(op_name, kDeviceName));
+      if (kind == OpKind::kIdentity) {
+        TF_CHECK_OK(op.AddInput(input.get()));
+      }
+      TensorHandle* retval = nullptr;
+      int num_retvals = kind == OpKind::kNoOp ? 0 : 1;
+      TF_CHECK_OK(EagerExecute(&op, &retval, &num_retvals));
+      if (retval != nullptr) retval->Unref();
+    }
+  }
+  ReportOps(state, num_ops);
+}
+
+void BM_EagerDispatchNoOp(::testing::benchmark::State& state) {
+  EagerDispatchBenchmark(state, OpKind::kNoOp);
+}
+
+void BM_EagerDispatchIdentity(::testing::benchmark::State& state) {
+  EagerDispatchBenchmark(state, OpKind::kIdentity);
+}
+
+void OpsAndThreads(::benchmark::internal::Benchmark* b) {
+  for (int num_ops : {1, 16, 256}) {
+    for (int num_threads : {1, 4, 16}) {
+      if (num_threads <= num_ops) b->ArgPair(num_ops, num_threads);
+    }
+  }
+}
+
+BENCHMARK(BM_ExecutorNoOp)->Apply(OpsAndThreads)->UseRealTime();
+BENCHMARK(BM_ExecutorIdentity)->Apply(OpsAndThreads)->UseRealTime();
+BENCHMARK(BM_DirectSessionNoOp)->Apply(OpsAndThreads)->UseRealTime();
+BENCHMARK(BM_DirectSessionIdentity)->Apply(OpsAndThreads)->UseRealTime();
+BENCHMARK(BM_FunctionCall)->Apply(OpsAndThreads)->UseRealTime();
+BENCHMARK(BM_EagerDispatchNoOp)
+    ->Arg(1)
+    ->Arg(16)
+    ->ThreadRange(1, 16)
+    ->UseRealTime();
+BENCHMARK(BM_EagerDispatchIdentity)
+    ->Arg(1)
+    ->Arg(16)
+    ->ThreadRange(1, 16)
+    ->UseRealTime();
+
+}  // namespace
+}  // namespace tensorflow
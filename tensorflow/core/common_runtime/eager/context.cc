@@ -493,6 +493,7 @@ void EagerContext::ClearCachesAndDefaultExecutor() {
     mutex_lock dl(device_cache_mu_);
     device_cache_.clear();
   }
+  cache_generation_.fetch_add(1, std::memory_order_release);
   {
     mutex_lock ml(metadata_mu_);
     step_container_.reset(new ScopedStepContainer(
@@ -993,6 +994,7 @@ Status EagerContext::RemoveFunction(const string& func) {
     for (auto& key : *registered_function->cached_kernel_keys) {
       kernel_cache_.erase(key);
     }
+    cache_generation_.fetch_add(1, std::memory_order_release);
     registered_functions_.erase(func);
   }
   registered_function->Unref();
@@ -16,6 +16,7 @@ limitations under the License.
 #define TENSORFLOW_CORE_COMMON_RUNTIME_EAGER_CONTEXT_H_
 
 #include <algorithm>
+#include <atomic>
 #include <cstddef>
 #include <map>
 #include <memory>
@@ -260,6 +261,12 @@ class EagerContext : public ImmediateExecutionContext, public core::RefCounted {
   Status AsyncWait() override { return SyncExecutors(); }
 
   core::RefCountPtr<KernelAndDevice> GetCachedKernel(Fprint128 cache_key);
+  // Incremented whenever cached kernels or devices are dropped, so that copies
+  // of cache entries held elsewhere (see EagerOperation::InlineCache) can tell
+  // that they are stale.
+  int64_t CacheGeneration() const {
+    return cache_generation_.load(std::memory_order_acquire);
+  }
   Device* GetCachedDevice(Fprint128 device_cache_key);
 
   void AddKernelToCache(Fprint128 cache_key, KernelAndDevice* kernel);
@@ -721,6 +728,7 @@ class EagerContext : public ImmediateExecutionContext, public core::RefCounted {
       TF_GUARDED_BY(cache_mu_);
   absl::flat_hash_map<Fprint128, Device*, Fprint128Hasher> device_cache_
       TF_GUARDED_BY(device_cache_mu_);
+  std::atomic<int64_t> cache_generation_{0};
 
   // Whether we should compute RunMetadata.
   std::atomic<bool> should_store_graphs_{false};
@@ -29,6 +29,13 @@ bool IsAsyncWaitForRemoteFunctionEnabled() {
                                  true, &enabled));
   return enabled;
 }
+
+int64_t MaxBatchSize() {
+  int64_t max_batch_size = 1;
+  TF_CHECK_OK(ReadInt64FromEnvVar("TF_EAGER_EXECUTOR_MAX_BATCH_SIZE", 1,
+                                  &max_batch_size));
+  return std::max<int64_t>(max_batch_size, 1);
+}
 }  // namespace
 
 EagerExecutor::EagerExecutor(bool async, bool enable_streaming_enqueue)
@@ -41,7 +48,8 @@ EagerExecutor::EagerExecutor(bool async, bool enable_streaming_enqueue)
       last_eager_client_(nullptr),
       enable_async_wait_for_remote_function_(
           IsAsyncWaitForRemoteFunctionEnabled()),
-      enable_streaming_enqueue_(enable_streaming_enqueue) {}
+      enable_streaming_enqueue_(enable_streaming_enqueue),
+      max_batch_size_(MaxBatchSize()) {}
 
 EagerExecutor::~EagerExecutor() {
   tensorflow::mutex_lock l(node_queue_mutex_);
@@ -150,7 +158,7 @@ Status EagerExecutor::AddOrExecute(std::unique_ptr<EagerNode> node) {
     } else {
       status = status_;
       if (status.ok()) {
-        node_queue_.push(std::move(item));
+        node_queue_.push_back(std::move(item));
         // If there were no previous nodes pending, wake the run thread to
         // start processing requests again.
         if (node_queue_.size() == 1) {
@@ -231,7 +239,7 @@ void EagerExecutor::NodeDone(const core::RefCountPtr<NodeItem>& item,
     if (from_queue) {
       // Since this was from the async queue, pop it from the front of the queue
       DCHECK(!node_queue_.empty() && item.get() == node_queue_.front().get());
-      node_queue_.pop();
+      node_queue_.pop_front();
     } else if (async) {
       // If it is an Async node then we will find the node in the unfinished
       // nodes list. However we only notify if we are at the front of the list
@@ -265,7 +273,7 @@ void EagerExecutor::NodeDone(const core::RefCountPtr<NodeItem>& item,
       }
       while (!node_queue_.empty()) {
         items_to_destroy.push_front(std::move(node_queue_.front()));
-        node_queue_.pop();
+        node_queue_.pop_front();
       }
       for (auto& it : unfinished_nodes_) {
         items_to_destroy.push_front(std::move(it.second));
@@ -322,6 +330,8 @@ void EagerExecutor::Run() {
       gtl::MakeCleanup([this] { thread_exited_notification_.Notify(); });
   while (true) {
     core::RefCountPtr<NodeItem> curr_item;
+    // Synchronous nodes queued behind it, run in the same batch.
+    std::vector<core::RefCountPtr<NodeItem>> batch;
     {
       tensorflow::mutex_lock l(node_queue_mutex_);
       while (node_queue_.empty() || !status_.ok()) {
@@ -337,6 +347,35 @@ void EagerExecutor::Run() {
       // and register a notification for its completion.
       curr_item.reset(node_queue_.front().get());
       curr_item->Ref();
+      AsyncRemoteExecuteNode* remote_node =
+          curr_item->node->AsAsyncRemoteExecuteNode();
+      if (max_batch_size_ > 1 && curr_item->node->AsAsync() == nullptr) {
+        for (const auto& item : node_queue_) {
+          if (item->node->AsAsync() != nullptr) break;
+          item->Ref();
+          batch.emplace_back(item.get());
+          if (batch.size() == max_batch_size_) break;
+        }
+      } else if (max_batch_size_ > 1 && remote_node != nullptr) {
+        for (const auto& item : node_queue_) {
+          if (!batch.empty()) {
+            const AsyncRemoteExecuteNode* next =
+                item->node->AsAsyncRemoteExecuteNode();
+            if (next == nullptr || !remote_node->CanCoalesceWith(next)) break;
+          }
+          item->Ref();
+          batch.emplace_back(item.get());
+          if (batch.size() == max_batch_size_) break;
+        }
+      }
+    }
+    if (batch.size() > 1) {
+      if (batch.front()->node->AsAsync() == nullptr) {
+        RunBatch(std::move(batch));
+      } else {
+        RunCoalescedBatch(std::move(batch));
+      }
+      continue;
     }
     Status status = RunItem(std::move(curr_item), /*from_queue=*/true);
     if (!status.ok()) {
@@ -345,35 +384,116 @@ void EagerExecutor::Run() {
   }
 }
 
+void EagerExecutor::RunBatch(std::vector<core::RefCountPtr<NodeItem>> batch) {
+  DVLOG(3) << "Running batch of " << batch.size() << " nodes: [id "
+           << batch.front()->id << " to " << batch.back()->id << "]";
+  Status status;
+  size_t num_done = 0;
+  for (; num_done < batch.size(); ++num_done) {
+    // Like Run(), stop once another node has put the executor in an error
+    // state.
+    if (num_done > 0 && !ok()) break;
+    status = batch[num_done]->node->Run();
+    if (!status.ok()) break;
+    batch[num_done]->state = NodeState::kDONE;
+  }
+  if (num_done > 0) {
+    // Retire the nodes that succeeded under a single acquisition of the lock,
+    // as NodeDone would have done for each of them.
+    mutex_lock l(node_queue_mutex_);
+    if (status_.ok()) {
+      for (size_t i = 0; i < num_done; ++i) {
+        DCHECK(!node_queue_.empty() &&
+               batch[i].get() == node_queue_.front().get());
+        node_queue_.pop_front();
+      }
+      NotifyWaiters(batch.front()->id);
+    }
+  }
+  if (!status.ok()) {
+    VLOG(1) << "Failed to run item: " << status;
+    NodeDone(batch[num_done], status, /*from_queue=*/true);
+  }
+  // The nodes are destroyed here, while not holding node_queue_mutex_.
+}
+
+void EagerExecutor::RunCoalescedBatch(
+    std::vector<core::RefCountPtr<NodeItem>> batch) {
+  DVLOG(3) << "Running coalesced batch of " << batch.size()
+           << " remote nodes: [id " << batch.front()->id << " to "
+           << batch.back()->id << "]";
+  AsyncRemoteExecuteNode* remote_node =
+      batch.front()->node->AsAsyncRemoteExecuteNode();
+  Status status = MaybeSyncBeforeRemoteNode(remote_node);
+  if (!status.ok()) {
+    VLOG(1) << "Failed to run item: " << status;
+    NodeDone(batch.front(), status, /*from_queue=*/true);
+    return;
+  }
+
+  std::vector<NodeItem*> scheduled;
+  scheduled.reserve(batch.size());
+  for (auto& item : batch) {
+    item->state = NodeState::kSCHEDULED;
+    item->Ref();
+    scheduled.push_back(item.get());
+  }
+  for (auto& item : batch) {
+    status = MoveToUnfinished(std::move(item), /*from_queue=*/true);
+    if (!status.ok()) {
+      // The executor is in an error state, which aborts the nodes already
+      // moved to unfinished_nodes_ as well as those still queued.
+      VLOG(1) << "Failed to run item: " << status;
+      for (NodeItem* scheduled_item : scheduled) scheduled_item->Unref();
+      return;
+    }
+  }
+
+  std::vector<AsyncRemoteExecuteNode*> others;
+  others.reserve(scheduled.size() - 1);
+  std::vector<StatusCallback> done;
+  done.reserve(scheduled.size());
+  for (NodeItem* async_ref : scheduled) {
+    if (async_ref != scheduled.front()) {
+      others.push_back(async_ref->node->AsAsyncRemoteExecuteNode());
+    }
+    done.push_back([this, async_ref](const Status& status) {
+      core::RefCountPtr<NodeItem> async_item(async_ref);
+      NodeDone(async_item, status, false);
+    });
+  }
+  remote_node->RunCoalescedAsync(others, std::move(done));
+}
+
+Status EagerExecutor::MaybeSyncBeforeRemoteNode(AsyncRemoteExecuteNode* node) {
+  if (!enable_async_wait_for_remote_function_ || node == nullptr) {
+    return OkStatus();
+  }
+  if (last_eager_client_ != nullptr && node->eager_client() != nullptr &&
+      last_eager_client_ != node->eager_client()) {
+    // Running a remote function, need to sync if the function is going to
+    // different device than last time we run remote distributed function.
+    TF_RETURN_IF_ERROR(node->SyncExecutors());
+    last_eager_client_ = nullptr;
+  }
+  if (node->eager_client() != nullptr && node->needs_remote_inputs() &&
+      node->allow_multiple_pending_requests()) {
+    // We are running remote distributed function, update
+    // last_remote_device_name_.
+    last_eager_client_ = node->eager_client();
+  }
+  return OkStatus();
+}
+
 Status EagerExecutor::RunItem(core::RefCountPtr<NodeItem> item,
                               bool from_queue) {
   DVLOG(3) << "Running Node: [id " << item->id << "] "
            << item->node->DebugString();
-  AsyncRemoteExecuteNode* async_remote_node =
-      item->node->AsAsyncRemoteExecuteNode();
-  if (enable_async_wait_for_remote_function_) {
-    if (async_remote_node != nullptr) {
-      if (last_eager_client_ != nullptr &&
-          async_remote_node->eager_client() != nullptr &&
-          last_eager_client_ != async_remote_node->eager_client()) {
-        // Running a remote function, need to sync if the function is going to
-        // different device than last time we run remote distributed function.
-        DVLOG(3) << "Executing Sync Executor for node" << item->id;
-        tensorflow::Status status = async_remote_node->SyncExecutors();
-        if (!status.ok()) {
-          NodeDone(item, status, from_queue);
-          return status;
-        }
-        last_eager_client_ = nullptr;
-      }
-      if (async_remote_node->eager_client() != nullptr &&
-          async_remote_node->needs_remote_inputs() &&
-          async_remote_node->allow_multiple_pending_requests()) {
-        // We are running remote distributed function, update
-        // last_remote_device_name_.
-        last_eager_client_ = async_remote_node->eager_client();
-      }
-    }
+  tensorflow::Status sync_status =
+      MaybeSyncBeforeRemoteNode(item->node->AsAsyncRemoteExecuteNode());
+  if (!sync_status.ok()) {
+    NodeDone(item, sync_status, from_queue);
+    return sync_status;
   }
 
   AsyncEagerNode* async_node = item->node->AsAsync();
@@ -407,7 +527,7 @@ Status EagerExecutor::MoveToUnfinished(core::RefCountPtr<NodeItem> item,
 
   if (from_queue) {
     DCHECK(!node_queue_.empty() && item.get() == node_queue_.front().get());
-    node_queue_.pop();
+    node_queue_.pop_front();
   }
 
   DVLOG(3) << "Add Node: [id " << item->id << "] to unfinished map.";
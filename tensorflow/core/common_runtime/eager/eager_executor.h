@@ -17,12 +17,14 @@ limitations under the License.
 
 #include <algorithm>
 #include <cstddef>
+#include <deque>
 #include <map>
 #include <memory>
 #include <queue>
 #include <string>
 #include <vector>
 
+#include "absl/types/span.h"
 #include "tensorflow/core/common_runtime/device_factory.h"
 #include "tensorflow/core/common_runtime/function.h"
 #include "tensorflow/core/common_runtime/rendezvous_mgr.h"
@@ -99,6 +101,25 @@ class AsyncRemoteExecuteNode : public AsyncEagerNode {
   virtual bool needs_remote_inputs() const = 0;
   virtual bool allow_multiple_pending_requests() const = 0;
   virtual Status SyncExecutors() = 0;
+
+  // Returns true if `next`, queued right behind this node (or behind nodes
+  // this node can be coalesced with), can be sent to the remote worker in the
+  // same request as this node.
+  virtual bool CanCoalesceWith(const AsyncRemoteExecuteNode* next) const {
+    return false;
+  }
+
+  // Runs this node together with `others`, for which CanCoalesceWith returned
+  // true, as a single request. `done[0]` is called when this node is done and
+  // `done[i + 1]` when `others[i]` is done.
+  virtual void RunCoalescedAsync(
+      absl::Span<AsyncRemoteExecuteNode* const> others,
+      std::vector<StatusCallback> done) {
+    RunAsync(std::move(done[0]));
+    for (size_t i = 0; i < others.size(); ++i) {
+      others[i]->RunAsync(std::move(done[i + 1]));
+    }
+  }
 };
 
 // A class for handling async execution (see TFE_ContextSetAsync).
@@ -206,6 +227,20 @@ class EagerExecutor {
   void Run();
 
   Status RunItem(core::RefCountPtr<NodeItem> item, bool from_queue);
+
+  // Runs `batch`, consecutive synchronous nodes from the front of the queue,
+  // one after the other, and retires those that succeed together. Stops at the
+  // first node that fails.
+  void RunBatch(std::vector<core::RefCountPtr<NodeItem>> batch);
+
+  // Sends `batch`, consecutive remote nodes from the front of the queue that
+  // the first of them can be coalesced with, to the remote worker as a single
+  // request.
+  void RunCoalescedBatch(std::vector<core::RefCountPtr<NodeItem>> batch);
+
+  // Syncs the executors before running `node` if it goes to a different
+  // remote worker than the last remote function with remote inputs.
+  Status MaybeSyncBeforeRemoteNode(AsyncRemoteExecuteNode* node);
   Status MoveToUnfinished(core::RefCountPtr<NodeItem> item, bool from_queue);
 
   // The impl of WaitForAllPendingNodes
@@ -223,7 +258,7 @@ class EagerExecutor {
   condition_variable nodes_pending_ TF_GUARDED_BY(node_queue_mutex_);
 
   // Queue of pending NodeItems. Ordered by NodeItem::id.
-  std::queue<core::RefCountPtr<NodeItem>> node_queue_
+  std::deque<core::RefCountPtr<NodeItem>> node_queue_
       TF_GUARDED_BY(node_queue_mutex_);
 
   // Ordered by NodeItem::id.
@@ -263,6 +298,13 @@ class EagerExecutor {
   // Enable sending remote executions through streaming enqueue.
   const bool enable_streaming_enqueue_;
 
+  // The maximum number of queued synchronous nodes that the executor thread
+  // runs back to back before retiring them, set with
+  // TF_EAGER_EXECUTOR_MAX_BATCH_SIZE. Batching saves a round trip through the
+  // queue lock and waiter notification per node. Queued remote nodes for the
+  // same worker are likewise coalesced into requests of up to this many nodes.
+  const size_t max_batch_size_;
+
   // Callbacks to run on destruction.
   std::unordered_map<intptr_t, std::vector<std::function<void()>>> cleanups_;
 };
@@ -215,6 +215,21 @@ class EagerOperation : public ImmediateExecutionOperation {
   // Op name recorded for memory debugging purpose.
   const char* op_name() const { return op_name_; }
 
+  // The device and kernel this operation last ran with, together with the
+  // context cache keys they were found under. Unlike the rest of the state it
+  // survives Reset(), so that an EagerOperation reused for repeated calls of
+  // the same op (e.g. the thread-local operation of the Python fast path) finds
+  // them without going through the context's locked caches. Entries are only
+  // valid while `generation` matches EagerContext::CacheGeneration().
+  struct InlineCache {
+    int64_t generation = -1;
+    Fprint128 device_cache_key = {0, 0};
+    tensorflow::Device* device = nullptr;
+    Fprint128 kernel_cache_key = {0, 0};
+    core::RefCountPtr<KernelAndDevice> kernel;
+  };
+  InlineCache* MutableInlineCache() { return &inline_cache_; }
+
   // For LLVM style RTTI.
   static bool classof(const AbstractOperation* ptr) {
     return ptr->getKind() == kEager;
@@ -283,6 +298,8 @@ class EagerOperation : public ImmediateExecutionOperation {
   int inference_arg_idx_;  // arg definition index for the next input to be
                            // added
   gtl::FlatSet<std::string> inference_attrs_;  // attributes inferred so far
+
+  InlineCache inline_cache_;
 };
 
 inline void EagerOperation::UpdateInput(int i, TensorHandle* h) {
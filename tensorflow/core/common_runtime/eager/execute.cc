@@ -983,17 +983,34 @@ Status GetOrCreateKernelAndDevice(
   Device* device = absl::get<Device*>(op->Device());
   const KernelDef* kernel_def = nullptr;
 
+  // The inline cache belongs to the original op, even if `op` is later
+  // replaced by a wrapping function call.
+  EagerOperation::InlineCache* inline_cache = op->MutableInlineCache();
+  const int64_t cache_generation = ctx.CacheGeneration();
+  if (inline_cache->generation != cache_generation) {
+    inline_cache->device = nullptr;
+    inline_cache->kernel.reset();
+    inline_cache->generation = cache_generation;
+  }
+
   // Set the EagerOperation's device prior to extracting the input_dev_ptrs to
   // avoid any redundant H2D/D2H copies.
   if (device == nullptr && !op->is_function()) {
     Fprint128 device_cache_key = GetDeviceCacheKey(op, ctx);
-    device = ctx.GetCachedDevice(device_cache_key);
+    if (inline_cache->device != nullptr &&
+        inline_cache->device_cache_key == device_cache_key) {
+      device = inline_cache->device;
+    } else {
+      device = ctx.GetCachedDevice(device_cache_key);
+    }
     if (device == nullptr) {
       TF_RETURN_IF_ERROR(SetOpDevice(ctx, op, &device));
       ctx.AddDeviceToCache(device_cache_key, device);
     } else {
       op->SetDevice(device);
     }
+    inline_cache->device_cache_key = device_cache_key;
+    inline_cache->device = device;
   }
 
   // Save the original value of reuse_rendezvous_for_functions from the context.
@@ -1062,7 +1079,23 @@ Status GetOrCreateKernelAndDevice(
       GetKernelCacheKey(*op, op->MutableAttrs()->CacheKey(op->DeviceName()),
                         input_dev_ptrs,
                         input_resource_variable_dtypes_and_shapes));
-  core::RefCountPtr<KernelAndDevice> kernel = ctx.GetCachedKernel(cache_key);
+  core::RefCountPtr<KernelAndDevice> kernel;
+  if (inline_cache->kernel != nullptr &&
+      inline_cache->kernel_cache_key == cache_key) {
+    inline_cache->kernel->Ref();
+    kernel.reset(inline_cache->kernel.get());
+  } else {
+    kernel = ctx.GetCachedKernel(cache_key);
+  }
+  // Remembers a kernel that is also in the context's cache.
+  auto add_to_inline_cache = [inline_cache, &cache_key](KernelAndDevice* k) {
+    k->Ref();
+    inline_cache->kernel.reset(k);
+    inline_cache->kernel_cache_key = cache_key;
+  };
+  if (kernel != nullptr && kernel.get() != inline_cache->kernel.get()) {
+    add_to_inline_cache(kernel.get());
+  }
   AbstractOperationPtr wrapped_op_releaser;
   // We can eliminate some overhead by running simple functions using regular
   // CallOp kernel. However, it is tricky to figure out which functions should
@@ -1211,6 +1244,7 @@ Status GetOrCreateKernelAndDevice(
 
     if (op->is_function()) {
       ctx.AddKernelToCache(cache_key, kernel.get());
+      add_to_inline_cache(kernel.get());
     } else {
       // Exclude tf.data op kernels from being cached. The reason for this is
       // that tf.data op kernels that accept a user-defined function will have a
@@ -1222,6 +1256,7 @@ Status GetOrCreateKernelAndDevice(
       TF_RETURN_IF_ERROR(OpDefForOp(op->Name().data(), &op_def));
       if (KernelCacheEnabled(*op_def)) {
         ctx.AddKernelToCache(cache_key, kernel.get());
+        add_to_inline_cache(kernel.get());
       }
     }
   }
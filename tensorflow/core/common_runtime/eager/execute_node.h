@@ -181,10 +181,7 @@ class AsyncExecuteNode : public EagerNode {
     for (auto handle : retvals_) {
       handle->Unref();
     }
-
-    for (auto handle : inputs_) {
-      handle->Unref();
-    }
+    ReleaseInputs();
   }
 
   Status Run() override {
@@ -202,6 +199,11 @@ class AsyncExecuteNode : public EagerNode {
     Status status = EagerKernelExecute(
         ctx_, inputs_, eager_func_params_, kernel_, graph_collector_,
         cancellation_manager_, absl::MakeSpan(retvals_), stack_trace_);
+    // This node was the last consumer of any input that only it referenced.
+    // Drop the inputs now rather than when the node is destroyed, which the
+    // executor may defer, so that their buffers go back to the allocator
+    // right away.
+    ReleaseInputs();
     if (!status.ok()) {
       if (stack_trace_.has_value()) {
         errors::SetStackTrace(status, stack_trace_->ToStackFrames({}, {}));
@@ -229,6 +231,13 @@ class AsyncExecuteNode : public EagerNode {
   }
 
  private:
+  void ReleaseInputs() {
+    for (auto handle : inputs_) {
+      handle->Unref();
+    }
+    inputs_.clear();
+  }
+
   EagerContext* ctx_;
   absl::InlinedVector<TensorHandle*, 4> inputs_;
   const absl::optional<EagerFunctionParams> eager_func_params_;
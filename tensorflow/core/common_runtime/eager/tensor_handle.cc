@@ -62,8 +62,51 @@ string SafeDeviceDebugString(Device* device) {
     return device->DebugString();
   }
 }
+
+// Storage of deleted TensorHandles, reused by the next ones created on the
+// same thread.
+struct RecycledTensorHandles {
+  static constexpr int kCapacity = 64;
+
+  ~RecycledTensorHandles() {
+    for (int i = 0; i < size; ++i) {
+      ::operator delete(blocks[i]);
+    }
+    destroyed = true;
+  }
+
+  void* blocks[kCapacity];
+  int size = 0;
+  // Handles may still be deleted by other thread-local destructors after this
+  // one has run; those bypass the free list.
+  static thread_local bool destroyed;
+};
+
+thread_local bool RecycledTensorHandles::destroyed = false;
+thread_local RecycledTensorHandles recycled_tensor_handles;
 }  // namespace
 
+void* TensorHandle::operator new(size_t size) {
+  if (size == sizeof(TensorHandle) && !RecycledTensorHandles::destroyed) {
+    RecycledTensorHandles& recycled = recycled_tensor_handles;
+    if (recycled.size > 0) {
+      return recycled.blocks[--recycled.size];
+    }
+  }
+  return ::operator new(size);
+}
+
+void TensorHandle::operator delete(void* ptr, size_t size) {
+  if (size == sizeof(TensorHandle) && !RecycledTensorHandles::destroyed) {
+    RecycledTensorHandles& recycled = recycled_tensor_handles;
+    if (recycled.size < RecycledTensorHandles::kCapacity) {
+      recycled.blocks[recycled.size++] = ptr;
+      return;
+    }
+  }
+  ::operator delete(ptr);
+}
+
 TensorHandle::PackedTensorHandleData::PackedTensorHandleData(
     std::vector<TensorHandle*>&& handles, const TensorShape& shape)
     : handles_(std::move(handles)), shape_(shape) {
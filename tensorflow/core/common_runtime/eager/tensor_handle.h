@@ -72,6 +72,12 @@ class TensorHandle : public ImmediateExecutionTensorHandle {
 #endif  // IS_MOBILE_PLATFORM
 
  public:
+  // A TensorHandle is created for every output of every eager op, so their
+  // storage is recycled through small per-thread free lists instead of going
+  // back to the heap each time.
+  static void* operator new(size_t size);
+  static void operator delete(void* ptr, size_t size);
+
   // TensorHandle with no assigned device
   static TensorHandle* CreateLocalHandle(const tensorflow::Tensor& t);
   static TensorHandle* CreateLocalHandle(tensorflow::Tensor&& t, Device* d,
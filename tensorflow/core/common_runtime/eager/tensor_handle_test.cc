@@ -66,6 +66,18 @@ TEST(TensorHandle_ShapeTest, AsyncShape) {
   ctx->Unref();
 }
 
+TEST(TensorHandle_ShapeTest, RecyclesStorage) {
+  TensorHandle* th = TensorHandle::CreateLocalHandle(Tensor(1.0f));
+  const void* storage = th;
+  th->Unref();
+  th = TensorHandle::CreateLocalHandle(Tensor(2.0f));
+  EXPECT_EQ(storage, th);
+  const Tensor* t = nullptr;
+  TF_ASSERT_OK(th->Tensor(&t));
+  EXPECT_EQ(2.0f, t->scalar<float>()());
+  th->Unref();
+}
+
 static Device* CreateDevice(const char* type, const char* name,
                             bool is_local = true) {
   class FakeDevice : public Device {
@@ -15,6 +15,7 @@ limitations under the License.
 
 #include "tensorflow/core/common_runtime/executor.h"
 
+#include <algorithm>
 #include <atomic>
 #include <memory>
 #include <vector>
@@ -22,6 +23,7 @@ limitations under the License.
 #include "absl/memory/memory.h"
 #include "absl/time/time.h"
 #include "absl/types/optional.h"
+#include "tensorflow/core/common_runtime/cost_constants.h"
 #include "tensorflow/core/common_runtime/costmodel_manager.h"
 #include "tensorflow/core/common_runtime/entry.h"
 #include "tensorflow/core/common_runtime/executor_factory.h"
@@ -30,6 +32,7 @@ limitations under the License.
 #include "tensorflow/core/common_runtime/pending_counts.h"
 #include "tensorflow/core/common_runtime/propagator_state.h"
 #include "tensorflow/core/common_runtime/renamed_device.h"
+#include "tensorflow/core/common_runtime/request_cost.h"
 #include "tensorflow/core/common_runtime/simple_propagator_state.h"
 #include "tensorflow/core/common_runtime/step_stats_collector.h"
 #include "tensorflow/core/framework/allocator.h"
@@ -68,6 +71,7 @@ limitations under the License.
 #include "tensorflow/core/platform/thread_annotations.h"
 #include "tensorflow/core/platform/tracing.h"
 #include "tensorflow/core/platform/types.h"
+#include "tensorflow/core/profiler/backends/cpu/perf_counters.h"
 #include "tensorflow/core/profiler/lib/annotated_traceme.h"
 #include "tensorflow/core/profiler/lib/connected_traceme.h"
 #include "tensorflow/core/profiler/lib/scoped_annotation.h"
@@ -145,7 +149,9 @@ class ExecutorImpl : public Executor {
 
   Status Initialize(const Graph& graph) {
     TF_RETURN_IF_ERROR(immutable_state_.Initialize(graph));
-    kernel_stats_.Initialize(immutable_state_.graph_view());
+    kernel_stats_.Initialize(
+        immutable_state_.graph_view(),
+        immutable_state_.params().use_adaptive_inline_execution);
     return OkStatus();
   }
 
@@ -160,15 +166,28 @@ class ExecutorImpl : public Executor {
    public:
     KernelStats() = default;
 
-    void Initialize(const GraphView& gview) {
-      is_expensive_.resize(gview.num_nodes());
+    // If `use_adaptive_inline_execution` is true, the costs of all synchronous
+    // kernels are measured, so that kernels without the `IsExpensive()` marker
+    // are dispatched once they are measured to be expensive. Otherwise, only
+    // the kernels whose `IsExpensive()` returns true are measured, and all
+    // other kernels are always considered inexpensive.
+    void Initialize(const GraphView& gview,
+                    bool use_adaptive_inline_execution) {
+      is_cost_tracked_.resize(gview.num_nodes());
       cost_estimates_ =
           std::make_unique<std::atomic_uint_fast64_t[]>(gview.num_nodes());
       for (int32_t i = 0; i < gview.num_nodes(); ++i) {
-        if (gview.node(i)) {
-          is_expensive_[i] =
-              gview.node(i)->kernel && gview.node(i)->kernel->IsExpensive();
-          cost_estimates_[i] = kInitialCostEstimateCycles;
+        const NodeItem* item = gview.node(i);
+        if (item) {
+          const bool has_expensive_marker =
+              item->kernel && item->kernel->IsExpensive();
+          is_cost_tracked_[i] =
+              has_expensive_marker || (use_adaptive_inline_execution &&
+                                       item->kernel && !item->kernel_is_async);
+          // Kernels with the marker start out "expensive"; the others start
+          // out inexpensive until a measurement says otherwise.
+          cost_estimates_[i] =
+              has_expensive_marker ? kInitialCostEstimateCycles : 0;
         }
       }
     }
@@ -177,20 +196,29 @@ class ExecutorImpl : public Executor {
     // executor uses this flag to optimize graph execution, for example
     // by "inlining" inexpensive kernels.
     bool IsExpensive(const NodeItem& node) const {
-      return is_expensive_[node.node_id] &&
-             (cost_estimates_[node.node_id].load(std::memory_order_relaxed) >
-              kOpIsExpensiveThresholdCycles);
+      return is_cost_tracked_[node.node_id] &&
+             (EstimatedCost(node) > kOpIsExpensiveThresholdCycles);
     }
 
-    // Returns the value of kernel->IsExpensive().
-    bool HasExpensiveMarker(const NodeItem& node) const {
-      return is_expensive_[node.node_id];
+    // Returns true iff the cost of the given node is measured, i.e. its
+    // kernel->IsExpensive() returns true or adaptive inline execution is
+    // enabled.
+    bool IsCostTracked(const NodeItem& node) const {
+      return is_cost_tracked_[node.node_id];
+    }
+
+    // Returns the current cost estimate (in CPU cycles) of the given node, or
+    // 0 if its cost is not tracked.
+    uint64 EstimatedCost(const NodeItem& node) const {
+      return is_cost_tracked_[node.node_id]
+                 ? cost_estimates_[node.node_id].load(std::memory_order_relaxed)
+                 : 0;
     }
 
     // Updates the dynamic cost estimate, which is used to determine whether the
     // given node is expensive. The new cost estimate is a weighted average of
     // the old cost estimate and the latest cost. We only update cost estimates
-    // for kernels for which IsExpensive() return true.
+    // for kernels for which IsCostTracked() returns true.
     void UpdateCostEstimate(const NodeItem& node, uint64 elapsed_cycles) {
       // N.B. Updates to `cost_estimate` are atomic but unlocked.  Simultaneous
       // updates may result in one or more updates being ignored.  This does not
@@ -204,16 +232,18 @@ class ExecutorImpl : public Executor {
       cost_estimate.store(new_estimate, std::memory_order_relaxed);
     }
 
+    // Operations whose estimated cost (in CPU cycles) exceeds this threshold
+    // are "expensive".
+    static constexpr uint64 kOpIsExpensiveThresholdCycles = 8000;
+
    private:
     // Initial time (in CPU cycles) we expect an operation to take.  Used to
     // determine whether an operation should be place in a threadpool.
-    // Operations start out "expensive".
+    // Operations with an `IsExpensive()` marker start out "expensive".
     static constexpr uint64 kInitialCostEstimateCycles = 100 * 1000 * 1000;
-    static constexpr uint64 kOpIsExpensiveThresholdCycles = 8000;
     static constexpr uint64 kCostDecay = 10;
 
-    std::vector<bool> is_expensive_;
-    // std::unique_ptr<std::atomic<bool>[]> is_expensive_;
+    std::vector<bool> is_cost_tracked_;
     std::unique_ptr<std::atomic_uint_fast64_t[]> cost_estimates_;
   };
 
@@ -335,6 +365,25 @@ class ExecutorState {
   template <typename Closure>
   void RunTask(Closure&& c);
 
+  // Dispatches the nodes in `ready` to the inter-op thread pool, grouping
+  // consecutive inexpensive nodes into one closure until their estimated cost
+  // reaches the expensive threshold. Used when adaptive inline execution is
+  // enabled.
+  void DispatchBatched(const TaggedNodeSeq& ready, int64_t scheduled_nsec);
+
+  // Dispatches `tagged_node` to the inter-op thread pool. If critical path
+  // scheduling is enabled, the node is added to `priority_queue_` and the
+  // scheduled closure processes the queued node with the highest critical path
+  // cost when it starts running.
+  void Dispatch(const TaggedNode& tagged_node, int64_t scheduled_nsec);
+
+  // Returns the estimated cost of the longest path from `tagged_node` to the
+  // end of the graph, or 0 if critical path scheduling is disabled.
+  int64_t CriticalPathCost(const TaggedNode& tagged_node) const {
+    if (!use_critical_path_scheduling_) return 0;
+    return immutable_state_.critical_path_cost(tagged_node.get_node_item());
+  }
+
   // Clean up when this executor is done.
   void Finish();
   void ScheduleFinish();
@@ -374,12 +423,36 @@ class ExecutorState {
   ExecutorImpl::KernelStats* const kernel_stats_;
   CancellationManager* cancellation_manager_;
   CoordinationServiceAgent* coordination_service_agent_;
+  // If not null, the costs of the kernels are accumulated below and added to it
+  // when the step finishes.
+  RequestCost* const request_cost_;
+  std::atomic<int64_t> op_compute_nanos_{0};
+  std::atomic<int64_t> op_output_bytes_{0};
   absl::optional<ManagedStackTrace> stack_trace_ = absl::nullopt;
   // If not null, use this device to schedule intra-op operation
   std::unique_ptr<DeviceBase> user_device_;
   Executor::Args::Runner runner_;
   bool sync_on_finish_;
   const bool run_all_kernels_inline_;
+  const bool use_critical_path_scheduling_;
+  const bool use_adaptive_inline_execution_;
+
+  // A ready node waiting in `priority_queue_` for an inter-op thread.
+  struct PrioritizedNode {
+    int64_t critical_path_cost;
+    TaggedNode tagged_node;
+    int64_t scheduled_nsec;
+  };
+  static bool LowerPriority(const PrioritizedNode& a,
+                            const PrioritizedNode& b) {
+    return a.critical_path_cost < b.critical_path_cost;
+  }
+
+  // Max-heap of dispatched nodes ordered by `LowerPriority`. Every entry has a
+  // matching closure scheduled on `runner_`.
+  mutex priority_queue_mu_;
+  std::vector<PrioritizedNode> priority_queue_
+      TF_GUARDED_BY(priority_queue_mu_);
 
   PropagatorStateType propagator_;
 
@@ -424,10 +497,15 @@ ExecutorState<PropagatorStateType>::ExecutorState(
       kernel_stats_(kernel_stats),
       cancellation_manager_(args.cancellation_manager),
       coordination_service_agent_(args.coordination_service_agent),
+      request_cost_(args.request_cost),
       stack_trace_(args.stack_trace),
       runner_(args.runner),
       sync_on_finish_(args.sync_on_finish),
       run_all_kernels_inline_(args.run_all_kernels_inline),
+      use_critical_path_scheduling_(
+          immutable_state.params().use_critical_path_scheduling),
+      use_adaptive_inline_execution_(
+          immutable_state.params().use_adaptive_inline_execution),
       propagator_(immutable_state, step_id_, vlog_),
       num_outstanding_ops_(0) {
   if (args.user_intra_op_threadpool != nullptr) {
@@ -529,6 +607,8 @@ struct ExecutorState<PropagatorStateType>::AsyncState {
   Entry* first_input;
   OpKernelContext ctx;
   NodeExecStatsInterface* stats;
+  // When the kernel was started, if its cost is recorded.
+  int64_t compute_start_nanos = 0;
 
  private:
   OpKernelContext::Params* ParamsButClearingEigenGPUDevice(
@@ -571,6 +651,7 @@ Status ExecutorState<PropagatorStateType>::ProcessSync(
   OpKernel* op_kernel = item.kernel;
   Device* device = immutable_state_.params().device;
   const bool is_expensive = kernel_stats_->IsExpensive(item);
+  const int64_t compute_start_nanos = request_cost_ ? NowInNsec() : 0;
 
   if (TF_PREDICT_FALSE(MightTrace(event_collector_, is_expensive))) {
     tracing::ScopedRegion region(tracing::EventCategory::kCompute,
@@ -581,8 +662,12 @@ Status ExecutorState<PropagatorStateType>::ProcessSync(
               ctx, /*verbose=*/profiler::TfOpDetailsEnabled());
         },
         profiler::GetTFTraceMeLevel(is_expensive));
+    profiler::PerfCounterScope perf_counters;
     device->Compute(op_kernel, &ctx);
-  } else if (kernel_stats_->HasExpensiveMarker(item)) {
+    if (TF_PREDICT_FALSE(perf_counters.active())) {
+      activity.AppendMetadata([&] { return perf_counters.EncodeDeltas(); });
+    }
+  } else if (kernel_stats_->IsCostTracked(item)) {
     KernelTimer timer;
     device->Compute(op_kernel, &ctx);
     // For expensive kernels, always update the cost estimate. For inexpensive
@@ -596,6 +681,7 @@ Status ExecutorState<PropagatorStateType>::ProcessSync(
   } else {
     device->Compute(op_kernel, &ctx);
   }
+  if (request_cost_) op_compute_nanos_ += NowInNsec() - compute_start_nanos;
   nodestats::SetOpEnd(stats);
   if (outputs->size() < item.num_outputs) outputs->resize(item.num_outputs);
   s = ProcessOutputs(item, &ctx, outputs->data(), stats);
@@ -619,6 +705,11 @@ void ExecutorState<PropagatorStateType>::ProcessAsync(
     Entry* first_input = state->first_input;       // Shorthand
 
     nodestats::SetOpEnd(stats);
+    if (request_cost_) {
+      // This includes the time on the device for kernels, e.g. the ones of
+      // multi-device functions, which are done when the device work is.
+      op_compute_nanos_ += NowInNsec() - state->compute_start_nanos;
+    }
     EntryVector outputs(state->item->num_outputs);
     Status s = ProcessOutputs(*state->item, &state->ctx, outputs.data(), stats);
     nodestats::SetMemory(stats, &state->ctx);
@@ -652,6 +743,7 @@ void ExecutorState<PropagatorStateType>::ProcessAsync(
               state->ctx, /*verbose=*/profiler::TfOpDetailsEnabled());
         },
         profiler::GetTFTraceMeLevel(kernel_stats_->IsExpensive(item)));
+    if (request_cost_) state->compute_start_nanos = NowInNsec();
     immutable_state_.params().device->ComputeAsync(async_kernel, &state->ctx,
                                                    std::move(done));
   }
@@ -1059,6 +1151,9 @@ Status ExecutorState<PropagatorStateType>::ProcessOutputs(
         } else {
           // NOTE that std::move is used here, so val.tensor goes to
           // uninitialized state (val.tensor->IsInitialized return false).
+          if (request_cost_ && val.tensor->IsInitialized()) {
+            op_output_bytes_ += val.tensor->TotalBytes();
+          }
           out->state = Entry::State::HAS_VALUE;
           out->val.Init(std::move(*val.tensor));
           if (log_memory_) {
@@ -1193,8 +1288,12 @@ void ExecutorState<PropagatorStateType>::ScheduleReady(
     const TaggedNode* curr_expensive_node = nullptr;
     if (inline_ready == nullptr) {
       // Schedule to run all the ready ops in thread pool.
-      for (auto& tagged_node : *ready) {
-        RunTask([=]() { Process(tagged_node, scheduled_nsec); });
+      if (use_adaptive_inline_execution_) {
+        DispatchBatched(*ready, scheduled_nsec);
+      } else {
+        for (auto& tagged_node : *ready) {
+          Dispatch(tagged_node, scheduled_nsec);
+        }
       }
     } else {
       for (auto& tagged_node : *ready) {
@@ -1202,12 +1301,17 @@ void ExecutorState<PropagatorStateType>::ScheduleReady(
         if (tagged_node.get_is_dead() || !kernel_stats_->IsExpensive(item)) {
           // Inline this inexpensive node.
           inline_ready->push_back(tagged_node);
+        } else if (use_critical_path_scheduling_ && curr_expensive_node &&
+                   CriticalPathCost(tagged_node) <=
+                       CriticalPathCost(*curr_expensive_node)) {
+          // Keep the node with the most expensive path to the end of the graph
+          // for this thread, and dispatch the other one.
+          Dispatch(tagged_node, scheduled_nsec);
         } else {
           if (curr_expensive_node) {
             // Dispatch to another thread since there is plenty of work to
             // do for this thread.
-            RunTask(std::bind(&ExecutorState::Process, this,
-                              *curr_expensive_node, scheduled_nsec));
+            Dispatch(*curr_expensive_node, scheduled_nsec);
           }
           curr_expensive_node = &tagged_node;
         }
@@ -1219,14 +1323,82 @@ void ExecutorState<PropagatorStateType>::ScheduleReady(
       } else {
         // There are inline nodes to run already. We dispatch this expensive
         // node to other thread.
-        RunTask(std::bind(&ExecutorState::Process, this, *curr_expensive_node,
-                          scheduled_nsec));
+        Dispatch(*curr_expensive_node, scheduled_nsec);
       }
     }
   }
   ready->clear();
 }
 
+template <class PropagatorStateType>
+void ExecutorState<PropagatorStateType>::DispatchBatched(
+    const TaggedNodeSeq& ready, int64_t scheduled_nsec) {
+  // Bounds the size of a batch whose nodes have not been measured yet.
+  constexpr size_t kMaxNodesPerClosure = 16;
+  constexpr uint64 kBatchCostBudgetCycles =
+      ExecutorImpl::KernelStats::kOpIsExpensiveThresholdCycles;
+  TaggedNodeSeq batch;
+  uint64 batch_cost = 0;
+  auto flush_batch = [this, &batch, &batch_cost, scheduled_nsec]() {
+    if (batch.size() == 1) {
+      Dispatch(batch[0], scheduled_nsec);
+    } else if (!batch.empty()) {
+      RunTask([this, batch = std::move(batch), scheduled_nsec]() {
+        for (auto& tagged_node : batch) {
+          Process(tagged_node, scheduled_nsec);
+        }
+      });
+    }
+    batch.clear();
+    batch_cost = 0;
+  };
+  for (auto& tagged_node : ready) {
+    const NodeItem& item = *tagged_node.node_item;
+    if (!tagged_node.get_is_dead() && kernel_stats_->IsExpensive(item)) {
+      Dispatch(tagged_node, scheduled_nsec);
+      continue;
+    }
+    batch.push_back(tagged_node);
+    if (!tagged_node.get_is_dead()) {
+      batch_cost += kernel_stats_->EstimatedCost(item);
+    }
+    if (batch_cost >= kBatchCostBudgetCycles ||
+        batch.size() >= kMaxNodesPerClosure) {
+      flush_batch();
+    }
+  }
+  flush_batch();
+}
+
+template <class PropagatorStateType>
+void ExecutorState<PropagatorStateType>::Dispatch(const TaggedNode& tagged_node,
+                                                  int64_t scheduled_nsec) {
+  if (!use_critical_path_scheduling_) {
+    RunTask(
+        std::bind(&ExecutorState::Process, this, tagged_node, scheduled_nsec));
+    return;
+  }
+  {
+    mutex_lock l(priority_queue_mu_);
+    priority_queue_.push_back(
+        {CriticalPathCost(tagged_node), tagged_node, scheduled_nsec});
+    std::push_heap(priority_queue_.begin(), priority_queue_.end(),
+                   LowerPriority);
+  }
+  RunTask([this]() {
+    PrioritizedNode next = [this]() {
+      mutex_lock l(priority_queue_mu_);
+      DCHECK(!priority_queue_.empty());
+      std::pop_heap(priority_queue_.begin(), priority_queue_.end(),
+                    LowerPriority);
+      PrioritizedNode node = std::move(priority_queue_.back());
+      priority_queue_.pop_back();
+      return node;
+    }();
+    Process(next.tagged_node, next.scheduled_nsec);
+  });
+}
+
 template <class PropagatorStateType>
 void ExecutorState<PropagatorStateType>::ScheduleFinish() {
   // Checks condition to decide if needs to invoke Finish(). If there are
@@ -1258,6 +1430,14 @@ void ExecutorState<PropagatorStateType>::Finish() {
   CHECK(done_cb != nullptr);
   Device* device = immutable_state_.params().device;
 
+  if (request_cost_) {
+    request_cost_->RecordCost(
+        {{kOpComputeCostName, absl::Nanoseconds(op_compute_nanos_.load())}});
+    request_cost_->RecordMetrics(
+        {{kOpOutputBytesMetricName,
+          static_cast<double>(op_output_bytes_.load())}});
+  }
+
   if (vlog_ && !status.ok() && VLOG_IS_ON(1)) {
     // Logs verbose information about the current state of active and pending
     // nodes in the propagator.
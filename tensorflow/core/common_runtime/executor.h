@@ -34,6 +34,7 @@ limitations under the License.
 
 namespace tensorflow {
 
+class RequestCost;
 class StepStatsCollector;
 
 // Executor runs a graph computation.
@@ -103,6 +104,9 @@ class Executor {
     CollectiveExecutor* collective_executor = nullptr;
     thread::ThreadPoolInterface* user_intra_op_threadpool = nullptr;
     CoordinationServiceAgent* coordination_service_agent = nullptr;
+    // If not null, the compute time and the output bytes of the kernels of the
+    // step are added to it when the step finishes. Must outlive the step.
+    RequestCost* request_cost = nullptr;
     int64_t start_time_usecs = 0;
     // The deadline for the kernel to complete by. Empty if unspecified.
     absl::optional<absl::Time> deadline;
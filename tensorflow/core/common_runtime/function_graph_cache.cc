@@ -0,0 +1,87 @@
+/* Copyright 2022 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/common_runtime/function_graph_cache.h"
+
+namespace tensorflow {
+
+namespace {
+
+// Partitioned graphs of large functions can take several megabytes, so only
+// a moderate number of functions is kept.
+constexpr int kGlobalCacheCapacity = 1024;
+
+}  // namespace
+
+FunctionGraphCache* FunctionGraphCache::Global() {
+  static FunctionGraphCache* cache =
+      new FunctionGraphCache(kGlobalCacheCapacity);
+  return cache;
+}
+
+std::shared_ptr<const FunctionGraphCache::Entry> FunctionGraphCache::Lookup(
+    const std::string& key) {
+  mutex_lock l(mu_);
+  auto it = entries_.find(key);
+  if (it == entries_.end()) {
+    ++num_misses_;
+    return nullptr;
+  }
+  ++num_hits_;
+  lru_.splice(lru_.begin(), lru_, it->second);
+  return it->second->second;
+}
+
+void FunctionGraphCache::Insert(const std::string& key,
+                                std::shared_ptr<const Entry> entry) {
+  mutex_lock l(mu_);
+  auto it = entries_.find(key);
+  if (it != entries_.end()) {
+    it->second->second = std::move(entry);
+    lru_.splice(lru_.begin(), lru_, it->second);
+    return;
+  }
+  lru_.emplace_front(key, std::move(entry));
+  entries_.emplace(key, lru_.begin());
+  while (lru_.size() > static_cast<size_t>(capacity_)) {
+    entries_.erase(lru_.back().first);
+    lru_.pop_back();
+  }
+}
+
+void FunctionGraphCache::Clear() {
+  mutex_lock l(mu_);
+  entries_.clear();
+  lru_.clear();
+  num_hits_ = 0;
+  num_misses_ = 0;
+}
+
+int FunctionGraphCache::size() const {
+  mutex_lock l(mu_);
+  return entries_.size();
+}
+
+int64_t FunctionGraphCache::num_hits() const {
+  mutex_lock l(mu_);
+  return num_hits_;
+}
+
+int64_t FunctionGraphCache::num_misses() const {
+  mutex_lock l(mu_);
+  return num_misses_;
+}
+
+}  // namespace tensorflow
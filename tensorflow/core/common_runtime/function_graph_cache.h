@@ -0,0 +1,98 @@
+/* Copyright 2022 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_CORE_COMMON_RUNTIME_FUNCTION_GRAPH_CACHE_H_
+#define TENSORFLOW_CORE_COMMON_RUNTIME_FUNCTION_GRAPH_CACHE_H_
+
+#include <list>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "absl/container/flat_hash_map.h"
+#include "tensorflow/core/framework/function.pb.h"
+#include "tensorflow/core/framework/graph.pb.h"
+#include "tensorflow/core/framework/types.h"
+#include "tensorflow/core/platform/macros.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/thread_annotations.h"
+
+namespace tensorflow {
+
+// A bounded, least-recently-used cache of the optimized and partitioned graphs
+// of multi-device functions, which allows `ProcessFunctionLibraryRuntime`
+// instances in the same process to share the results of graph optimization,
+// placement and partitioning.
+//
+// Keys must identify everything that the cached graphs depend on; see
+// `ProcessFunctionLibraryRuntime::InstantiateMultiDevice()`.
+class FunctionGraphCache {
+ public:
+  struct Entry {
+    // The function library after running the graph optimization passes.
+    FunctionDefLibrary library;
+
+    // The partitioned graphs, keyed by the name of the device to which they
+    // were assigned.
+    std::vector<std::pair<std::string, GraphDef>> partitions;
+
+    // Maps a node name in the partitioned graphs to the control output name.
+    std::unordered_map<std::string, std::string> node_name_to_control_ret;
+
+    int num_outputs = 0;
+    DataTypeVector ret_types;
+  };
+
+  // The cache shared by all `ProcessFunctionLibraryRuntime` instances.
+  static FunctionGraphCache* Global();
+
+  explicit FunctionGraphCache(int capacity) : capacity_(capacity) {}
+
+  // Returns the entry for `key`, or null if it is not cached.
+  std::shared_ptr<const Entry> Lookup(const std::string& key)
+      TF_LOCKS_EXCLUDED(mu_);
+
+  // Caches `entry` under `key`, replacing any existing entry, and evicts the
+  // least recently used entry if the cache is full.
+  void Insert(const std::string& key, std::shared_ptr<const Entry> entry)
+      TF_LOCKS_EXCLUDED(mu_);
+
+  void Clear() TF_LOCKS_EXCLUDED(mu_);
+
+  int size() const TF_LOCKS_EXCLUDED(mu_);
+  int64_t num_hits() const TF_LOCKS_EXCLUDED(mu_);
+  int64_t num_misses() const TF_LOCKS_EXCLUDED(mu_);
+
+ private:
+  using LruList =
+      std::list<std::pair<std::string, std::shared_ptr<const Entry>>>;
+
+  const int capacity_;
+  mutable mutex mu_;
+  // Entries in order of use, the most recently used first.
+  LruList lru_ TF_GUARDED_BY(mu_);
+  absl::flat_hash_map<std::string, LruList::iterator> entries_
+      TF_GUARDED_BY(mu_);
+  int64_t num_hits_ TF_GUARDED_BY(mu_) = 0;
+  int64_t num_misses_ TF_GUARDED_BY(mu_) = 0;
+
+  TF_DISALLOW_COPY_AND_ASSIGN(FunctionGraphCache);
+};
+
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_COMMON_RUNTIME_FUNCTION_GRAPH_CACHE_H_
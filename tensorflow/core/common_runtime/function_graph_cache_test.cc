@@ -0,0 +1,67 @@
+/* Copyright 2022 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/common_runtime/function_graph_cache.h"
+
+#include <memory>
+
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace {
+
+std::shared_ptr<const FunctionGraphCache::Entry> MakeEntry(int num_outputs) {
+  auto entry = std::make_shared<FunctionGraphCache::Entry>();
+  entry->num_outputs = num_outputs;
+  return entry;
+}
+
+TEST(FunctionGraphCacheTest, LookupAndInsert) {
+  FunctionGraphCache cache(/*capacity=*/2);
+  EXPECT_EQ(cache.Lookup("a"), nullptr);
+  cache.Insert("a", MakeEntry(1));
+  ASSERT_NE(cache.Lookup("a"), nullptr);
+  EXPECT_EQ(cache.Lookup("a")->num_outputs, 1);
+  cache.Insert("a", MakeEntry(2));
+  EXPECT_EQ(cache.Lookup("a")->num_outputs, 2);
+  EXPECT_EQ(cache.size(), 1);
+  EXPECT_EQ(cache.num_hits(), 3);
+  EXPECT_EQ(cache.num_misses(), 1);
+}
+
+TEST(FunctionGraphCacheTest, EvictsLeastRecentlyUsed) {
+  FunctionGraphCache cache(/*capacity=*/2);
+  cache.Insert("a", MakeEntry(1));
+  cache.Insert("b", MakeEntry(2));
+  // Using "a" makes "b" the least recently used entry.
+  EXPECT_NE(cache.Lookup("a"), nullptr);
+  cache.Insert("c", MakeEntry(3));
+  EXPECT_EQ(cache.size(), 2);
+  EXPECT_NE(cache.Lookup("a"), nullptr);
+  EXPECT_EQ(cache.Lookup("b"), nullptr);
+  EXPECT_NE(cache.Lookup("c"), nullptr);
+}
+
+TEST(FunctionGraphCacheTest, EntriesOutliveEviction) {
+  FunctionGraphCache cache(/*capacity=*/1);
+  cache.Insert("a", MakeEntry(1));
+  std::shared_ptr<const FunctionGraphCache::Entry> entry = cache.Lookup("a");
+  cache.Clear();
+  EXPECT_EQ(cache.size(), 0);
+  EXPECT_EQ(entry->num_outputs, 1);
+}
+
+}  // namespace
+}  // namespace tensorflow
@@ -17,7 +17,9 @@ limitations under the License.
 
 #include <utility>
 
+#include "tensorflow/core/common_runtime/device/device_event_mgr.h"
 #include "tensorflow/core/lib/strings/strcat.h"
+#include "tensorflow/core/platform/stream_executor.h"
 
 namespace tensorflow {
 
@@ -90,6 +92,15 @@ GPUBFCAllocator::GPUBFCAllocator(std::unique_ptr<SubAllocator> sub_allocator,
           o.garbage_collection = GetGarbageCollectionValue();
         }
         o.fragmentation_fraction = opts.fragmentation_fraction;
+        o.use_thread_local_caches = opts.use_thread_local_caches;
+        o.record_telemetry = opts.record_telemetry;
+        if (EventMgr* event_mgr = opts.event_mgr) {
+          o.then_execute_on_stream = [event_mgr](void* stream,
+                                                 std::function<void()> done) {
+            event_mgr->ThenExecute(static_cast<se::Stream*>(stream),
+                                   std::move(done));
+          };
+        }
         return o;
       }()) {}
 
@@ -30,6 +30,8 @@ limitations under the License.
 
 namespace tensorflow {
 
+class EventMgr;
+
 // A GPU memory allocator that implements a 'best-fit with coalescing'
 // algorithm.
 class GPUBFCAllocator : public BFCAllocator {
@@ -50,6 +52,16 @@ class GPUBFCAllocator : public BFCAllocator {
 
     double fragmentation_fraction = 0;
     bool allow_retry_on_failure = true;
+    bool use_thread_local_caches = false;
+    bool record_telemetry = false;
+
+    // If set, the allocator is stream-ordered (see
+    // BFCAllocator::Options::then_execute_on_stream), with allocations tagged
+    // by the se::Stream installed through BFCAllocator::ScopedStream. Chunks
+    // freed on one stream become reusable on others once `event_mgr` reports
+    // that the stream has completed the work enqueued before the free. Not
+    // owned; must outlive the allocator.
+    EventMgr* event_mgr = nullptr;
   };
 
   GPUBFCAllocator(std::unique_ptr<SubAllocator> sub_allocator,
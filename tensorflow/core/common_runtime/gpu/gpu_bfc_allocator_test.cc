@@ -19,6 +19,8 @@ limitations under the License.
 #include "tensorflow/core/common_runtime/gpu/gpu_bfc_allocator.h"
 
 #include <algorithm>
+#include <deque>
+#include <functional>
 #include <vector>
 
 #include "tensorflow/core/common_runtime/device/device_id.h"
@@ -29,6 +31,7 @@ limitations under the License.
 #include "tensorflow/core/framework/typed_allocator.h"
 #include "tensorflow/core/lib/core/threadpool.h"
 #include "tensorflow/core/lib/gtl/inlined_vector.h"
+#include "tensorflow/core/lib/monitoring/cell_reader.h"
 #include "tensorflow/core/lib/random/simple_philox.h"
 #include "tensorflow/core/platform/logging.h"
 #include "tensorflow/core/platform/strcat.h"
@@ -36,6 +39,7 @@ limitations under the License.
 #include "tensorflow/core/platform/test.h"
 #include "tensorflow/core/platform/test_benchmark.h"
 #include "tensorflow/core/platform/types.h"
+#include "tensorflow/core/profiler/lib/scoped_memory_debug_annotation.h"
 #include "tensorflow/core/protobuf/bfc_memory_map.pb.h"
 #include "tensorflow/stream_executor/gpu/gpu_driver.h"
 
@@ -320,6 +324,154 @@ TEST_P(GPUBFCAllocatorTest, AllocationsAndDeallocationsWithGrowth) {
   }
 }
 
+TEST_P(GPUBFCAllocatorTest, ThreadLocalCaches) {
+  GPUBFCAllocator::Options options;
+  options.use_thread_local_caches = true;
+  GPUBFCAllocator a(GetParam()(1ull << 32), 1 << 30, "GPU_0_bfc", options);
+
+  // Small allocations are served by the caches; large ones bypass them.
+  std::vector<void*> ptrs;
+  for (int i = 0; i < 1000; ++i) {
+    ptrs.push_back(a.AllocateRaw(1, 256 * (1 + i % 16)));
+  }
+  void* large = a.AllocateRaw(1, 1 << 20);
+  absl::flat_hash_set<void*> unique_ptrs(ptrs.begin(), ptrs.end());
+  EXPECT_EQ(ptrs.size(), unique_ptrs.size());
+
+  int64_t expected_bytes_in_use = 1 << 20;
+  for (int i = 0; i < 1000; ++i) {
+    EXPECT_EQ(256 * (1 + i % 16), a.AllocatedSize(ptrs[i]));
+    expected_bytes_in_use += 256 * (1 + i % 16);
+  }
+  absl::optional<AllocatorStats> stats = a.GetStats();
+  ASSERT_TRUE(stats);
+  EXPECT_EQ(1001, stats->num_allocs);
+  EXPECT_EQ(expected_bytes_in_use, stats->bytes_in_use);
+  EXPECT_EQ(expected_bytes_in_use, stats->peak_bytes_in_use);
+
+  // Freed chunks stay cached and are handed out again.
+  for (void* ptr : ptrs) {
+    a.DeallocateRaw(ptr);
+  }
+  a.DeallocateRaw(large);
+  stats = a.GetStats();
+  EXPECT_EQ(0, stats->bytes_in_use);
+  EXPECT_EQ(expected_bytes_in_use, stats->peak_bytes_in_use);
+  void* reused = a.AllocateRaw(1, 256);
+  EXPECT_TRUE(unique_ptrs.contains(reused));
+  a.DeallocateRaw(reused);
+
+  // Cached chunks are reported as free in the memory map.
+  MemoryDump md = a.RecordMemoryMap();
+  EXPECT_EQ(0, md.stats().bytes_in_use());
+  for (const MemChunk& chunk : md.chunk()) {
+    EXPECT_FALSE(chunk.in_use());
+  }
+
+  // A request that only fits in the coalesced cached chunks flushes them.
+  void* all = a.AllocateRaw(1, (1 << 30) - 256);
+  EXPECT_NE(nullptr, all);
+  a.DeallocateRaw(all);
+}
+
+TEST_P(GPUBFCAllocatorTest, StreamOrderedReuse) {
+  // Stand-ins for two streams whose pending work completes when `callbacks`
+  // are run.
+  int stream_a, stream_b;
+  std::deque<std::function<void()>> callbacks;
+  auto run_callbacks = [&callbacks]() {
+    while (!callbacks.empty()) {
+      std::function<void()> callback = std::move(callbacks.front());
+      callbacks.pop_front();
+      callback();
+    }
+  };
+  BFCAllocator::Options options;
+  options.then_execute_on_stream = [&callbacks](void* stream,
+                                                std::function<void()> done) {
+    callbacks.push_back(std::move(done));
+  };
+  BFCAllocator a(GetParam()(1ull << 32), 2 << 20, "GPU_0_bfc", options);
+
+  void* p1;
+  {
+    BFCAllocator::ScopedStream scoped_stream(&stream_a);
+    p1 = a.AllocateRaw(1, 1024);
+    a.DeallocateRaw(p1);
+    // The chunk is reused right away on the same stream.
+    EXPECT_EQ(p1, a.AllocateRaw(1, 1024));
+    a.DeallocateRaw(p1);
+  }
+  EXPECT_EQ(1, callbacks.size());
+  {
+    // But not on another stream until stream_a has caught up.
+    BFCAllocator::ScopedStream scoped_stream(&stream_b);
+    void* p2 = a.AllocateRaw(1, 1024);
+    EXPECT_NE(p1, p2);
+    a.DeallocateRaw(p2);
+    run_callbacks();
+    EXPECT_EQ(p1, a.AllocateRaw(1, 1024));
+    a.DeallocateRaw(p1);
+  }
+  run_callbacks();
+
+  // Chunks recorded on another stream are only freed once it has caught up.
+  {
+    BFCAllocator::ScopedStream scoped_stream(&stream_a);
+    void* p3 = a.AllocateRaw(1, 1024);
+    a.RecordStreamUse(p3, &stream_b);
+    a.DeallocateRaw(p3);
+    EXPECT_EQ(1024, a.GetStats()->bytes_in_use);
+    run_callbacks();
+    EXPECT_EQ(0, a.GetStats()->bytes_in_use);
+  }
+
+  // Released chunks coalesce again before the allocator gives up.
+  void* all = a.AllocateRaw(1, 2 << 20);
+  EXPECT_NE(nullptr, all);
+  a.DeallocateRaw(all);
+}
+
+TEST_P(GPUBFCAllocatorTest, Telemetry) {
+  using monitoring::testing::CellReader;
+  using monitoring::testing::Histogram;
+  CellReader<Histogram> bytes_reader(
+      "/tensorflow/core/bfc_allocator/allocation_bytes");
+  CellReader<Histogram> lifetime_reader(
+      "/tensorflow/core/bfc_allocator/allocation_lifetime_usecs");
+  CellReader<int64_t> peak_reader(
+      "/tensorflow/core/bfc_allocator/peak_bytes_in_use");
+
+  GPUBFCAllocator::Options options;
+  options.record_telemetry = true;
+  GPUBFCAllocator a(GetParam()(1ull << 32), 1 << 30, "GPU_0_telemetry",
+                    options);
+
+  std::vector<void*> ptrs;
+  {
+    profiler::ScopedMemoryDebugAnnotation annotation("MatMul", /*step_id=*/1);
+    ptrs.push_back(a.AllocateRaw(1, 1000));
+    ptrs.push_back(a.AllocateRaw(1, 3000));
+  }
+  Histogram bytes = bytes_reader.Delta("GPU_0_telemetry", "MatMul");
+  EXPECT_EQ(2, bytes.num());
+  EXPECT_EQ(4000, bytes.sum());
+  EXPECT_EQ(2 * 2048, peak_reader.Read("GPU_0_telemetry", "default"));
+
+  a.SetTelemetryPhase("training");
+  EXPECT_EQ(2 * 2048, peak_reader.Read("GPU_0_telemetry", "training"));
+  a.DeallocateRaw(ptrs[0]);
+  a.DeallocateRaw(ptrs[1]);
+  {
+    profiler::ScopedMemoryDebugAnnotation annotation("Conv2D", /*step_id=*/2);
+    a.DeallocateRaw(a.AllocateRaw(1, 256));
+  }
+  EXPECT_EQ(2, lifetime_reader.Delta("GPU_0_telemetry", "MatMul").num());
+  EXPECT_EQ(1, lifetime_reader.Delta("GPU_0_telemetry", "Conv2D").num());
+  EXPECT_EQ(2 * 2048, peak_reader.Read("GPU_0_telemetry", "default"));
+  EXPECT_EQ(2 * 2048, peak_reader.Read("GPU_0_telemetry", "training"));
+}
+
 TEST_P(GPUBFCAllocatorTest, DISABLED_AllocatorReceivesZeroMemory) {
   GPUBFCAllocator a(GetParam()(1ul << 62), 1UL << 60, "GPU_0_bfc", {});
   GPUBFCAllocator b(GetParam()(1ul << 62), 1UL << 60, "GPU_0_bfc", {});
@@ -624,6 +776,44 @@ TEST_F(GPUBFCAllocatorTest_SubAllocatorSpecific,
   void* big_alloc = a.AllocateRaw(1, k512MiB - size);
   EXPECT_NE(big_alloc, nullptr);
 }
+
+TEST_F(GPUBFCAllocatorTest_SubAllocatorSpecific,
+       VirtualAllocatorRemapsFragmentedMemory) {
+  PlatformDeviceId gpu_id(0);
+  auto executor =
+      DeviceIdUtil::ExecutorForPlatformDeviceId(GPUMachineManager(), gpu_id)
+          .ValueOrDie();
+  auto* gpu_context = reinterpret_cast<stream_executor::gpu::GpuContext*>(
+      executor->implementation()->GpuContextHack());
+  std::unique_ptr<SubAllocator> sub_allocator =
+      GpuVirtualMemAllocator::Create({}, {}, *gpu_context, gpu_id, 1ull << 32,
+                                     {}, /*enable_remap=*/true)
+          .ValueOrDie();
+  const size_t page = sub_allocator->RemapGranularity();
+  ASSERT_GT(page, 0);
+
+  GPUBFCAllocator::Options options;
+  options.allow_growth = false;
+  GPUBFCAllocator a(std::move(sub_allocator), 4 * page, "GPU_0_bfc", options);
+  std::vector<void*> ptrs;
+  for (int i = 0; i < 4; ++i) {
+    ptrs.push_back(a.AllocateRaw(1, page));
+    ASSERT_NE(nullptr, ptrs.back());
+  }
+  // Half of the memory is free, but not in one piece.
+  a.DeallocateRaw(ptrs[0]);
+  a.DeallocateRaw(ptrs[2]);
+  void* p = a.AllocateRaw(1, 2 * page);
+  ASSERT_NE(nullptr, p);
+  EXPECT_EQ(2 * page, a.AllocatedSize(p));
+  EXPECT_EQ(page, a.AllocatedSize(ptrs[1]));
+  EXPECT_EQ(page, a.AllocatedSize(ptrs[3]));
+  EXPECT_EQ(4 * page, a.GetStats()->bytes_in_use);
+
+  a.DeallocateRaw(p);
+  a.DeallocateRaw(ptrs[1]);
+  a.DeallocateRaw(ptrs[3]);
+}
 #endif
 
 TEST_F(GPUBFCAllocatorTest_SubAllocatorSpecific,
@@ -74,6 +74,7 @@ limitations under the License.
 #include "tensorflow/core/profiler/lib/scoped_annotation.h"
 #include "tensorflow/core/profiler/lib/scoped_memory_debug_annotation.h"
 #include "tensorflow/core/public/session_options.h"
+#include "tensorflow/core/util/autotune_maps/autotune_serialize.h"
 #include "tensorflow/core/util/device_name_utils.h"
 #include "tensorflow/core/util/env_var.h"
 #include "tensorflow/core/util/stream_executor_util.h"
@@ -233,26 +234,135 @@ class EigenGpuStreamDevice : public ::Eigen::StreamInterface {
   TF_DISALLOW_COPY_AND_ASSIGN(EigenGpuStreamDevice);
 };
 
+namespace {
+
+// Forwards to the allocator of a GPU, which is used by the stream groups of
+// all priorities on that GPU. Once more than one such stream group exists,
+// freed memory is only handed back to the allocator after the work queued on
+// this device's compute stream so far has completed. Otherwise a kernel on
+// another stream could reuse the memory while a kernel on this stream still
+// accesses it.
+class StreamOrderedAllocator : public Allocator {
+ public:
+  StreamOrderedAllocator(Allocator* allocator, se::Stream* stream,
+                         EventMgr* em, const std::atomic<bool>* shared)
+      : allocator_(allocator), stream_(stream), em_(em), shared_(shared) {}
+
+  std::string Name() override { return allocator_->Name(); }
+
+  void* AllocateRaw(size_t alignment, size_t num_bytes) override {
+    return allocator_->AllocateRaw(alignment, num_bytes);
+  }
+
+  void* AllocateRaw(size_t alignment, size_t num_bytes,
+                    const AllocationAttributes& allocation_attr) override {
+    return allocator_->AllocateRaw(alignment, num_bytes, allocation_attr);
+  }
+
+  void DeallocateRaw(void* ptr) override {
+    if (shared_->load()) {
+      Allocator* allocator = allocator_;
+      em_->ThenExecute(stream_,
+                       [allocator, ptr]() { allocator->DeallocateRaw(ptr); });
+      return;
+    }
+    allocator_->DeallocateRaw(ptr);
+  }
+
+  bool TracksAllocationSizes() const override {
+    return allocator_->TracksAllocationSizes();
+  }
+
+  bool AllocatesOpaqueHandle() const override {
+    return allocator_->AllocatesOpaqueHandle();
+  }
+
+  size_t RequestedSize(const void* ptr) const override {
+    return allocator_->RequestedSize(ptr);
+  }
+
+  size_t AllocatedSize(const void* ptr) const override {
+    return allocator_->AllocatedSize(ptr);
+  }
+
+  int64_t AllocationId(const void* ptr) const override {
+    return allocator_->AllocationId(ptr);
+  }
+
+  size_t AllocatedSizeSlow(const void* ptr) const override {
+    return allocator_->AllocatedSizeSlow(ptr);
+  }
+
+  absl::optional<AllocatorStats> GetStats() override {
+    return allocator_->GetStats();
+  }
+
+  bool ClearStats() override { return allocator_->ClearStats(); }
+
+  void SetSafeFrontier(uint64 count) override {
+    allocator_->SetSafeFrontier(count);
+  }
+
+  void SetStreamAndPreallocateMemory(void* stream) override {
+    allocator_->SetStreamAndPreallocateMemory(stream);
+  }
+
+  AllocatorMemoryType GetMemoryType() const override {
+    return allocator_->GetMemoryType();
+  }
+
+ private:
+  Allocator* const allocator_;        // not owned
+  se::Stream* const stream_;          // not owned
+  EventMgr* const em_;                // not owned
+  const std::atomic<bool>* shared_;  // not owned
+};
+
+}  // namespace
+
 // This factory helps to ensure that different GPU device objects that refer to
-// the same physical device and stream group id use the same stream group
-// object (and therefore the same CUDA streams). This is necessary since there
-// is a single memory allocator per device (see ProcessState::GetGPUAllocator)
-// and allocators must not be shared across streams.
+// the same physical device, stream group id and priority use the same stream
+// group object (and therefore the same CUDA streams). There is a single memory
+// allocator per device (see ProcessState::GetGPUAllocator); when stream groups
+// of different priorities exist on a device, its BaseGPUDevices therefore
+// return memory to the allocator in stream order (see StreamOrderedAllocator).
 class BaseGPUDevice::StreamGroupFactory {
  public:
   // Returns the unique stream group for use with the stream defined by
-  // {tf_device_id, stream_group_within_gpu}, creating it if it does not yet
-  // exist.
+  // {tf_device_id, stream_group_within_gpu} and the stream priority from
+  // `options`, creating it if it does not yet exist.
   // This function is thread safe.
   BaseGPUDevice::StreamGroup* GetOrCreate(TfDeviceId tf_device_id,
                                           int stream_group_within_gpu,
                                           se::StreamExecutor* executor,
                                           const GPUOptions& options) {
     mutex_lock guard(lock_);
-    StreamGroup* group =
-        &streams_[key_type(tf_device_id.value(), stream_group_within_gpu)];
+    const int priority = GetPriority(tf_device_id.value(), options);
+    StreamGroup* group = &streams_[key_type(
+        tf_device_id.value(), stream_group_within_gpu, priority)];
     if (!group->compute) {
-      int priority = GetPriority(tf_device_id.value(), options);
+      std::atomic<bool>& allocator_shared =
+          allocator_shared_[tf_device_id.value()];
+      if (!allocator_shared.load()) {
+        for (const auto& item : streams_) {
+          const StreamGroup& other = item.second;
+          if (std::get<0>(item.first) != tf_device_id.value() ||
+              other.compute == nullptr) {
+            continue;
+          }
+          // From now on memory is freed in stream order. Memory that was
+          // freed before may still be in use by work on the existing streams.
+          allocator_shared.store(true);
+          VLOG(1) << "Stream groups with priorities " << other.priority
+                  << " and " << priority << " share the allocator of GPU "
+                  << tf_device_id.value();
+          Status status = other.compute->BlockHostUntilDone();
+          if (!status.ok()) {
+            LOG(ERROR) << "Failed to synchronize GPU stream: " << status;
+          }
+        }
+      }
+      group->allocator_shared = &allocator_shared;
       group->priority = priority;
       group->compute = GetStream(executor, priority);
       group->compute->Init();
@@ -342,12 +452,17 @@ class BaseGPUDevice::StreamGroupFactory {
       }
     }
     streams_.clear();
+    allocator_shared_.clear();
   }
 
  private:
-  // Returns priority for the given virtual GPU id from the session options.
-  // Returns 0 if no virtual devices are specified.
+  // Returns the stream priority of this session if it sets one, and otherwise
+  // the priority for the given virtual GPU id from the session options.
+  // Returns 0 if neither is specified.
   int GetPriority(int tf_device_id, const GPUOptions& options) {
+    if (options.experimental().stream_priority() != 0) {
+      return options.experimental().stream_priority();
+    }
     int id = tf_device_id;
     int i = 0;
     int priority = 0;
@@ -375,8 +490,11 @@ class BaseGPUDevice::StreamGroupFactory {
   }
 
   mutex lock_;
-  using key_type = std::tuple<int, int>;
+  using key_type = std::tuple<int, int, int>;
   std::map<key_type, StreamGroup> streams_;
+  // Keyed by tf_device_id. The elements are never moved, so StreamGroups can
+  // point to them.
+  std::map<int, std::atomic<bool>> allocator_shared_;
 
   // StreamGroupFactory cannot be created directly; Call
   // StreamGroupFactory::Global() to get the global instance.
@@ -463,6 +581,11 @@ Status BaseGPUDevice::Init(const SessionOptions& options) {
   em_ = EventMgrFactory::Singleton()->GetEventMgr(executor_,
                                                   options.config.gpu_options());
 
+  Allocator* base_gpu_allocator = gpu_allocator_;
+  stream_ordered_allocator_ = std::make_unique<StreamOrderedAllocator>(
+      gpu_allocator_, stream_->compute, em_, stream_->allocator_shared);
+  gpu_allocator_ = stream_ordered_allocator_.get();
+
   GPUKernelTracker::Params tracker_params(
       options.config.gpu_options().experimental().kernel_tracker_max_interval(),
       options.config.gpu_options().experimental().kernel_tracker_max_bytes(),
@@ -485,7 +608,7 @@ Status BaseGPUDevice::Init(const SessionOptions& options) {
     }
     kernel_tracker_.reset(new GPUKernelTracker(
         tracker_params, Env::Default(), stream_->compute, timing_counter,
-        timestamped_allocator_ ? gpu_allocator_ : nullptr, em_));
+        timestamped_allocator_ ? base_gpu_allocator : nullptr, em_));
   }
 
   accelerator_device_info_ = new DeviceBase::AcceleratorDeviceInfo;
@@ -1409,6 +1532,22 @@ Status BaseGPUDeviceFactory::CreateDevices(
             << cuda_minor_version << " and cuDNN " << CUDNN_MAJOR << "."
             << CUDNN_MINOR << "." << CUDNN_PATCHLEVEL;
 #endif
+
+    // Persisted autotune results are only valid for the DNN library that is
+    // actually loaded, which may differ from the one we were compiled with.
+    std::string dnn_version = "unknown";
+    auto executor = DeviceIdUtil::ExecutorForPlatformDeviceId(
+        gpu_manager, valid_platform_device_ids[0]);
+    if (executor.ok() && executor.ValueOrDie()->AsDnn() != nullptr) {
+      auto version = executor.ValueOrDie()->AsDnn()->GetVersion();
+      if (version.ok()) {
+        const se::dnn::VersionInfo& info = version.ValueOrDie();
+        dnn_version = strings::StrCat(info.major_version(), ".",
+                                      info.minor_version(), ".",
+                                      info.patch());
+      }
+    }
+    MaybeEnablePersistentAutotuneCache(dnn_version);
   }
 
   std::vector<InterconnectMap> interconnect_maps;
@@ -1440,6 +1579,22 @@ Status BaseGPUDeviceFactory::CreateDevices(
     }
   }
 
+  const int stream_priority = gpu_options.experimental().stream_priority();
+  if (stream_priority != 0) {
+    for (const auto& item : supported_priority_ranges) {
+      const std::pair<int, int>& priority_range = item.second;
+      if (stream_priority > priority_range.first ||
+          stream_priority < priority_range.second) {
+        return errors::InvalidArgument(
+            "Stream priority ", stream_priority,
+            " is outside the range of supported priorities "
+            "[",
+            priority_range.second, ",", priority_range.first, "] on GPU# ",
+            item.first);
+      }
+    }
+  }
+
   const auto& virtual_devices = gpu_options.experimental().virtual_devices();
   if (!virtual_devices.empty()) {
     TF_RETURN_IF_ERROR(VerifyVirtualDeviceSettings(
@@ -20,6 +20,7 @@ limitations under the License.
 #ifndef TENSORFLOW_CORE_COMMON_RUNTIME_GPU_GPU_DEVICE_H_
 #define TENSORFLOW_CORE_COMMON_RUNTIME_GPU_GPU_DEVICE_H_
 
+#include <atomic>
 #include <memory>
 #include <string>
 #include <unordered_map>
@@ -166,6 +167,9 @@ class BaseGPUDevice : public LocalDevice {
     se::Stream* device_to_host = nullptr;
     gtl::InlinedVector<se::Stream*, 4> device_to_device;
     int priority = 0;
+    // Set once stream groups of different priorities exist on this GPU, and
+    // therefore share its allocator.
+    const std::atomic<bool>* allocator_shared = nullptr;
   };
   class StreamGroupFactory;
 
@@ -183,6 +187,9 @@ class BaseGPUDevice : public LocalDevice {
   int32 pending_cap_ = 0;
   bool timestamped_allocator_ = false;
   NodeFileWriter* node_file_writer_ = nullptr;  // not owned
+  // Wraps the allocator passed at construction; gpu_allocator_ points to it
+  // once the device is initialized.
+  std::unique_ptr<Allocator> stream_ordered_allocator_;
 
   // Initialize scratch buffers used by Eigen.
   Status InitScratchBuffers();
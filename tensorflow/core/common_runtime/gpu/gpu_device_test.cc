@@ -516,6 +516,59 @@ TEST_F(GPUDeviceTest, UnifiedMemoryAllocation) {
   allocator->DeallocateRaw(ptr);
 }
 
+TEST_F(GPUDeviceTest, SessionStreamPriority) {
+  SessionOptions default_opts = MakeSessionOptions("0");
+  std::vector<std::unique_ptr<Device>> default_devices;
+  TF_ASSERT_OK(DeviceFactory::GetFactory("GPU")->CreateDevices(
+      default_opts, kDeviceNamePrefix, &default_devices));
+  // Valid range for priority values on AMD GPUs in (-1,1)
+  // Valid range for priority values on NVidia GPUs in (-2, 0)
+  SessionOptions priority_opts = MakeSessionOptions("0");
+  priority_opts.config.mutable_gpu_options()
+      ->mutable_experimental()
+      ->set_stream_priority(-1);
+  std::vector<std::unique_ptr<Device>> priority_devices;
+  TF_ASSERT_OK(DeviceFactory::GetFactory("GPU")->CreateDevices(
+      priority_opts, kDeviceNamePrefix, &priority_devices));
+  ASSERT_THAT(default_devices, SizeIs(1));
+  ASSERT_THAT(priority_devices, SizeIs(1));
+  auto* default_device = static_cast<BaseGPUDevice*>(default_devices[0].get());
+  auto* priority_device =
+      static_cast<BaseGPUDevice*>(priority_devices[0].get());
+  EXPECT_EQ(default_device->priority(), 0);
+  EXPECT_EQ(priority_device->priority(), -1);
+  EXPECT_NE(default_device->GetStream(), priority_device->GetStream());
+
+  // Both devices keep working on their own streams with the shared allocator.
+  for (BaseGPUDevice* device : {default_device, priority_device}) {
+    DeviceContext* device_context =
+        device->tensorflow_accelerator_device_info()->default_context;
+    Allocator* allocator = device->GetAllocator(AllocatorAttributes());
+    constexpr int kNumElements = 4;
+    Tensor gpu_tensor(allocator, DT_FLOAT, TensorShape({kNumElements}));
+    Tensor cpu_tensor(cpu_allocator(), DT_FLOAT, TensorShape({kNumElements}));
+    InitCPUTensor(&cpu_tensor, kNumElements, device->priority());
+    CopyCPUToGPU(&cpu_tensor, &gpu_tensor, device, device_context);
+    Tensor result(cpu_allocator(), DT_FLOAT, TensorShape({kNumElements}));
+    CopyGPUToCPU(&gpu_tensor, &result, device, device_context);
+    for (int i = 0; i < kNumElements; ++i) {
+      EXPECT_EQ(result.flat<float>()(i), device->priority());
+    }
+  }
+}
+
+TEST_F(GPUDeviceTest, SessionStreamPriorityOutOfRange) {
+  SessionOptions opts = MakeSessionOptions("0");
+  opts.config.mutable_gpu_options()
+      ->mutable_experimental()
+      ->set_stream_priority(100);
+  std::vector<std::unique_ptr<Device>> devices;
+  Status status = DeviceFactory::GetFactory("GPU")->CreateDevices(
+      opts, kDeviceNamePrefix, &devices);
+  EXPECT_EQ(status.code(), error::INVALID_ARGUMENT);
+  ExpectErrorMessageSubstr(status, "Stream priority 100 is outside the range");
+}
+
 TEST_F(GPUDeviceTest, CopyTensorInSameDevice) {
   SessionOptions opts = MakeSessionOptions("0");
   std::vector<std::unique_ptr<Device>> devices;
@@ -193,6 +193,11 @@ Allocator* GPUProcessState::GetGPUAllocator(
               !options.experimental().disallow_retry_on_allocation_failure();
           o.fragmentation_fraction =
               options.experimental().internal_fragmentation_fraction();
+          // Per-thread chunk caches serve the small, short-lived outputs of
+          // eager ops without taking the allocator lock.
+          TF_CHECK_OK(ReadBoolFromEnvVar("TF_GPU_ALLOCATOR_THREAD_LOCAL_CACHES",
+                                         /*default_val=*/false,
+                                         &o.use_thread_local_caches));
           return o;
         }());
     Allocator* gpu_allocator = gpu_bfc_allocator.get();
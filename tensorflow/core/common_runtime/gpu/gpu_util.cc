@@ -15,6 +15,9 @@ limitations under the License.
 
 #include "tensorflow/core/common_runtime/gpu/gpu_util.h"
 
+#include <algorithm>
+#include <cstring>
+
 #include "tensorflow/core/common_runtime/copy_tensor.h"
 #include "tensorflow/core/common_runtime/device.h"
 #include "tensorflow/core/common_runtime/device/device_event_mgr.h"
@@ -260,6 +263,11 @@ bool NeedStaging(const Tensor* tensor) {
   return tensor->GetMemoryType() == AllocatorMemoryType::kHostPageable;
 }
 
+// Staged CPU->GPU copies are split into pieces of this size, so that the host
+// memcpy into the staging buffer of one piece overlaps the DMA of the previous
+// ones.
+constexpr int64_t kStagingPieceBytes = 8 << 20;
+
 }  // namespace
 
 // static
@@ -362,11 +370,29 @@ void GPUUtil::CopyCPUTensorToGPU(const Tensor* cpu_tensor,
     if (do_staging) {
       staging_buffer = host_memory_allocator->AllocateRaw(
           tensorflow::Allocator::kAllocatorAlignment, total_bytes);
-      std::memcpy(staging_buffer, src_ptr, total_bytes);
-      input_ref.Unref();
+      if (staging_buffer == nullptr) {
+        LOG_FIRST_N(WARNING, 1)
+            << "Failed to allocate " << total_bytes
+            << " bytes to stage data for CPU->GPU transfer. Staging will be "
+               "skipped.";
+        do_staging = false;
+      }
+    }
 
-      recv_host_to_device_stream->ThenMemcpy(&gpu_dst_ptr, staging_buffer,
-                                             total_bytes);
+    if (do_staging) {
+      for (int64_t offset = 0; offset < total_bytes;
+           offset += kStagingPieceBytes) {
+        const int64_t piece_bytes =
+            std::min(kStagingPieceBytes, total_bytes - offset);
+        char* staging_piece = static_cast<char*>(staging_buffer) + offset;
+        std::memcpy(staging_piece, static_cast<char*>(src_ptr) + offset,
+                    piece_bytes);
+        DeviceMemoryBase gpu_dst_piece(static_cast<char*>(dst_ptr) + offset,
+                                       piece_bytes);
+        recv_host_to_device_stream->ThenMemcpy(&gpu_dst_piece, staging_piece,
+                                               piece_bytes);
+      }
+      input_ref.Unref();
     } else {
       recv_host_to_device_stream->ThenMemcpy(&gpu_dst_ptr, src_ptr,
                                              total_bytes);
@@ -15,6 +15,9 @@ limitations under the License.
 
 #include "tensorflow/core/common_runtime/gpu/gpu_virtual_mem_allocator.h"
 
+#include <algorithm>
+#include <utility>
+
 #include "absl/strings/str_format.h"
 #include "tensorflow/core/lib/strings/numbers.h"
 #include "tensorflow/stream_executor/lib/status.h"
@@ -63,7 +66,7 @@ GpuVirtualMemAllocator::Create(
     const std::vector<Visitor>& alloc_visitors,
     const std::vector<Visitor>& free_visitors, GpuContext& gpu_context,
     PlatformDeviceId gpu_id, size_t virtual_address_space_size,
-    const std::vector<PlatformDeviceId>& peer_gpu_ids) {
+    const std::vector<PlatformDeviceId>& peer_gpu_ids, bool enable_remap) {
   std::vector<GpuDeviceHandle> access_gpu_handles;
   access_gpu_handles.reserve(peer_gpu_ids.size() + 1);
 
@@ -105,7 +108,7 @@ GpuVirtualMemAllocator::Create(
 
   return std::unique_ptr<GpuVirtualMemAllocator>(new GpuVirtualMemAllocator(
       alloc_visitors, free_visitors, gpu_context, gpu_id,
-      std::move(access_gpu_handles), vmem, max_granularity));
+      std::move(access_gpu_handles), vmem, max_granularity, enable_remap));
 }
 
 GpuVirtualMemAllocator::GpuVirtualMemAllocator(
@@ -113,13 +116,14 @@ GpuVirtualMemAllocator::GpuVirtualMemAllocator(
     const std::vector<Visitor>& free_visitors, GpuContext& gpu_context,
     PlatformDeviceId gpu_id,
     const std::vector<GpuDeviceHandle> access_gpu_handles,
-    GpuDriver::VmemSpan vmem, size_t granularity)
+    GpuDriver::VmemSpan vmem, size_t granularity, bool enable_remap)
     : SubAllocator(alloc_visitors, free_visitors),
       gpu_context_(gpu_context),
       gpu_id_(gpu_id),
       access_gpu_handles_(access_gpu_handles),
       vmem_(vmem),
-      granularity_(granularity) {}
+      granularity_(granularity),
+      enable_remap_(enable_remap) {}
 
 GpuVirtualMemAllocator::~GpuVirtualMemAllocator() {
   for (const auto mapping : mappings_) {
@@ -147,28 +151,111 @@ void* GpuVirtualMemAllocator::Alloc(size_t alignment, size_t num_bytes,
     return nullptr;
   }
 
-  // Create physical memory backing allocation.
-  auto maybe_handle =
-      GpuDriver::CreateMemoryHandle(&gpu_context_, padded_bytes);
-  if (!maybe_handle.ok()) {
-    LOG(ERROR) << maybe_handle.status();
+  if (!MapNewMemory(next_va, padded_bytes)) {
     return nullptr;
   }
-  GpuDriver::GenericMemoryHandle handle = std::move(maybe_handle).ValueOrDie();
+  next_alloc_offset_ += padded_bytes;
+  VisitAlloc(reinterpret_cast<void*>(next_va), gpu_id_.value(), padded_bytes);
+  *bytes_received = padded_bytes;
+  return reinterpret_cast<void*>(next_va);
+}
 
-  // Map VAs for this physical memory.
-  auto status =
-      GpuDriver::MapMemory(&gpu_context_, next_va, handle, access_gpu_handles_);
-  if (!status.ok()) {
+bool GpuVirtualMemAllocator::MapNewMemory(GpuDevicePtr va, size_t bytes) {
+  const size_t mapping_bytes = enable_remap_ ? granularity_ : bytes;
+  const size_t first_mapping = mappings_.size();
+  for (size_t offset = 0; offset < bytes; offset += mapping_bytes) {
+    // Create physical memory backing allocation.
+    auto maybe_handle =
+        GpuDriver::CreateMemoryHandle(&gpu_context_, mapping_bytes);
+    Status status = maybe_handle.status();
+    if (status.ok()) {
+      // Map VAs for this physical memory.
+      status = GpuDriver::MapMemory(&gpu_context_, va + offset,
+                                    maybe_handle.ValueOrDie(),
+                                    access_gpu_handles_);
+      if (status.ok()) {
+        mappings_.push_back(
+            {va + offset, std::move(maybe_handle).ValueOrDie()});
+        continue;
+      }
+      GpuDriver::ReleaseMemoryHandle(&gpu_context_,
+                                     std::move(maybe_handle).ValueOrDie());
+    }
     LOG(ERROR) << status;
-    GpuDriver::ReleaseMemoryHandle(&gpu_context_, std::move(handle));
+    for (auto it = mappings_.begin() + first_mapping; it != mappings_.end();
+         ++it) {
+      GpuDriver::UnmapMemory(&gpu_context_, it->va, it->physical.bytes);
+      GpuDriver::ReleaseMemoryHandle(&gpu_context_, std::move(it->physical));
+    }
+    mappings_.resize(first_mapping);
+    return false;
+  }
+  return true;
+}
+
+void* GpuVirtualMemAllocator::Remap(
+    const std::vector<std::pair<void*, size_t>>& ranges,
+    size_t* bytes_received) {
+  if (!enable_remap_) return nullptr;
+
+  // Find the page mappings that make up the ranges.
+  std::vector<size_t> pages;
+  for (const auto& range : ranges) {
+    const GpuDevicePtr begin = reinterpret_cast<GpuDevicePtr>(range.first);
+    auto it = std::lower_bound(mappings_.begin(), mappings_.end(), begin,
+                               [](const Mapping& mapping, GpuDevicePtr va) {
+                                 return mapping.va < va;
+                               });
+    for (GpuDevicePtr va = begin; va < begin + range.second;
+         va += granularity_, ++it) {
+      if (it == mappings_.end() || it->va != va) {
+        LOG(ERROR) << "Could not find GPU vmem mapping for address at " << va;
+        return nullptr;
+      }
+      pages.push_back(it - mappings_.begin());
+    }
+  }
+
+  const size_t total_bytes = pages.size() * granularity_;
+  const GpuDevicePtr new_va = vmem_.base + next_alloc_offset_;
+  if (new_va + total_bytes > vmem_.base + vmem_.size_bytes) {
+    LOG(WARNING) << "Not enough GPU virtual address space left to remap "
+                 << strings::HumanReadableNumBytes(total_bytes);
     return nullptr;
   }
-  next_alloc_offset_ += handle.bytes;
-  mappings_.push_back({next_va, std::move(handle)});
-  VisitAlloc(reinterpret_cast<void*>(next_va), gpu_id_.value(), padded_bytes);
-  *bytes_received = padded_bytes;
-  return reinterpret_cast<void*>(next_va);
+
+  // Map the pages at their new addresses first, so that a failure leaves
+  // the old mappings intact.
+  for (size_t i = 0; i < pages.size(); ++i) {
+    Status status =
+        GpuDriver::MapMemory(&gpu_context_, new_va + i * granularity_,
+                             mappings_[pages[i]].physical, access_gpu_handles_);
+    if (!status.ok()) {
+      LOG(ERROR) << status;
+      for (size_t j = 0; j < i; ++j) {
+        GpuDriver::UnmapMemory(&gpu_context_, new_va + j * granularity_,
+                               granularity_);
+      }
+      return nullptr;
+    }
+  }
+  for (const auto& range : ranges) {
+    VisitFree(range.first, gpu_id_.value(), range.second);
+  }
+  for (size_t i = 0; i < pages.size(); ++i) {
+    Mapping& mapping = mappings_[pages[i]];
+    GpuDriver::UnmapMemory(&gpu_context_, mapping.va, granularity_);
+    mapping.va = new_va + i * granularity_;
+  }
+  std::sort(mappings_.begin(), mappings_.end(),
+            [](const Mapping& a, const Mapping& b) { return a.va < b.va; });
+  next_alloc_offset_ += total_bytes;
+
+  VLOG(1) << "Remapped " << pages.size() << " pages to "
+          << reinterpret_cast<void*>(new_va);
+  VisitAlloc(reinterpret_cast<void*>(new_va), gpu_id_.value(), total_bytes);
+  *bytes_received = total_bytes;
+  return reinterpret_cast<void*>(new_va);
 }
 
 void GpuVirtualMemAllocator::Free(void* ptr, size_t num_bytes) {
@@ -37,6 +37,11 @@ namespace tensorflow {
 // reserving a large chunk of virtual addresses at construction and then mapping
 // physical memory pages to this virtual address range as requested.
 //
+// If created with `enable_remap`, physical memory is mapped in pages of the
+// allocation granularity, which Remap can move to the end of the reservation
+// so that the BFC allocator can turn scattered free chunks into a contiguous
+// region.
+//
 // This class is not thread-safe.
 class GpuVirtualMemAllocator : public SubAllocator {
  public:
@@ -46,7 +51,8 @@ class GpuVirtualMemAllocator : public SubAllocator {
          const std::vector<Visitor>& free_visitors,
          stream_executor::gpu::GpuContext& gpu_context, PlatformDeviceId gpu_id,
          size_t virtual_address_space_size,
-         const std::vector<PlatformDeviceId>& peer_gpu_ids);
+         const std::vector<PlatformDeviceId>& peer_gpu_ids,
+         bool enable_remap = false);
   ~GpuVirtualMemAllocator() override;
 
   // Allocates memory at least as large as requested by num_bytes. Will be
@@ -70,13 +76,29 @@ class GpuVirtualMemAllocator : public SubAllocator {
 
   bool SupportsCoalescing() const override { return true; }
 
+  size_t RemapGranularity() const override {
+    return enable_remap_ ? granularity_ : 0;
+  }
+
+  // Maps the pages behind `ranges` at the end of the reservation, then unmaps
+  // them from their old addresses. Those addresses become holes, which are
+  // not reused.
+  void* Remap(const std::vector<std::pair<void*, size_t>>& ranges,
+              size_t* bytes_received) override;
+
  private:
   GpuVirtualMemAllocator(
       const std::vector<Visitor>& alloc_visitors,
       const std::vector<Visitor>& free_visitors,
       stream_executor::gpu::GpuContext& gpu_context, PlatformDeviceId gpu_id,
       std::vector<stream_executor::gpu::GpuDeviceHandle> access_device_handles,
-      stream_executor::gpu::GpuDriver::VmemSpan vmem, size_t granularity);
+      stream_executor::gpu::GpuDriver::VmemSpan vmem, size_t granularity,
+      bool enable_remap);
+
+  // Creates physical memory of `bytes` and maps it at `va`, as a single
+  // mapping or, with enable_remap_, one mapping per page. Returns false and
+  // leaves nothing mapped on failure.
+  bool MapNewMemory(stream_executor::gpu::GpuDevicePtr va, size_t bytes);
 
   stream_executor::gpu::GpuContext& gpu_context_;
   PlatformDeviceId gpu_id_;
@@ -97,6 +119,9 @@ class GpuVirtualMemAllocator : public SubAllocator {
   // Smallest allocation as determined by CUDA.
   const size_t granularity_;
 
+  // Whether RemapGranularity() and Remap() are supported.
+  const bool enable_remap_;
+
   struct Mapping {
     stream_executor::gpu::GpuDevicePtr va;
     stream_executor::gpu::GpuDriver::GenericMemoryHandle physical;
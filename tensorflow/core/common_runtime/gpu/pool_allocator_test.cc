@@ -17,6 +17,8 @@ limitations under the License.
 
 #include "tensorflow/core/common_runtime/pool_allocator.h"
 
+#include <cstring>
+
 #include "gpu_init.h"
 #include "tensorflow/core/common_runtime/device/device_host_allocator.h"
 #include "tensorflow/core/platform/stream_executor.h"
@@ -128,6 +130,27 @@ TEST(PoolAllocatorTest, AutoResize) {
   EXPECT_EQ(100, pool.size_limit());
 }
 
+TEST(PoolAllocatorTest, BasicCPUAllocatorHugePages) {
+  const size_t kHugePageSize = 2 << 20;
+  BasicCPUAllocator sub_allocator(port::kNUMANoAffinity, {}, {},
+                                  kHugePageSize);
+  size_t bytes_received;
+  // Small allocations use regular pages.
+  void* small = sub_allocator.Alloc(64, 1 << 10, &bytes_received);
+  EXPECT_NE(nullptr, small);
+  EXPECT_EQ(1 << 10, bytes_received);
+  sub_allocator.Free(small, bytes_received);
+
+  // Large ones are rounded up to whole huge pages, unless those are
+  // unavailable.
+  void* large = sub_allocator.Alloc(64, kHugePageSize + 1, &bytes_received);
+  EXPECT_NE(nullptr, large);
+  EXPECT_TRUE(bytes_received == kHugePageSize + 1 ||
+              bytes_received == 2 * kHugePageSize);
+  memset(large, 0, kHugePageSize + 1);
+  sub_allocator.Free(large, bytes_received);
+}
+
 TEST(PoolAllocatorTest, CudaHostAllocator) {
   int alloc_count = 0;
   int64_t alloc_size = 0;
@@ -0,0 +1,294 @@
+/* Copyright 2022 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/common_runtime/hierarchical_reducer.h"
+
+#include <string>
+#include <utility>
+
+#include "tensorflow/core/common_runtime/collective_rma_local.h"
+#include "tensorflow/core/common_runtime/collective_util.h"
+#include "tensorflow/core/common_runtime/device.h"
+#include "tensorflow/core/common_runtime/dma_helper.h"
+#include "tensorflow/core/framework/allocator.h"
+#include "tensorflow/core/framework/device_base.h"
+#include "tensorflow/core/framework/op_kernel.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/lib/core/errors.h"
+#include "tensorflow/core/lib/core/notification.h"
+#include "tensorflow/core/lib/core/status.h"
+#include "tensorflow/core/lib/strings/strcat.h"
+#include "tensorflow/core/platform/blocking_counter.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/profiler/lib/traceme.h"
+
+namespace tensorflow {
+
+namespace {
+
+// Phases of the reduction, used in the BufRendezvous keys.
+enum Phase {
+  kTaskReduceScatter = 0,
+  kCrossTaskReduceScatter,
+  kCrossTaskAllGather,
+  kTaskAllGather,
+};
+
+string StepKey(const string& exec_key, int phase, int step) {
+  return strings::StrCat(exec_key, ":", phase, ":", step);
+}
+
+}  // namespace
+
+Status HierarchicalReducer::InitializeCollectiveParams(
+    CollectiveParams* col_params) {
+  if (col_params->instance.type != REDUCTION_COLLECTIVE) {
+    return errors::Internal("HierarchicalReduce only implements reductions");
+  }
+  int num_devices = -1;
+  for (const auto& task : col_params->group.num_devices_per_task) {
+    if (num_devices != -1 && task.second != num_devices) {
+      return errors::InvalidArgument(
+          "HierarchicalReduce requires the same number of devices in every "
+          "task, but task ",
+          task.first, " has ", task.second, " devices instead of ",
+          num_devices);
+    }
+    num_devices = task.second;
+  }
+  return OkStatus();
+}
+
+Status HierarchicalReducer::InitializeCollectiveContext(
+    std::shared_ptr<CollectiveContext> col_ctx) {
+  DCHECK(col_ctx->dev_mgr);
+  col_ctx_ = col_ctx;
+  col_params_ = col_ctx->col_params.get();
+  return collective_util::InitializeDeviceAndLocality(
+      col_ctx->dev_mgr, col_ctx->device_name, &col_ctx->device,
+      &col_ctx->device_locality);
+}
+
+void HierarchicalReducer::Run(StatusCallback done) {
+  DCHECK(col_ctx_);
+  DCHECK(col_params_);
+  // Like `RingReducer`, this doesn't require non-overlapping collectives.
+  col_ctx_->col_exec->UnblockDependencies(*col_params_);
+  Status s = RunHierarchy();
+  if (!s.ok()) {
+    col_ctx_->col_exec->StartAbort(s);
+  }
+  done(s);
+}
+
+Status HierarchicalReducer::RunHierarchy() {
+  // Start by copying input to output if they're not already the same, i.e. if
+  // we're not computing in-place on the input tensor.
+  if ((col_ctx_->input != col_ctx_->output) &&
+      (DMAHelper::base(col_ctx_->input) != DMAHelper::base(col_ctx_->output))) {
+    Notification note;
+    Status status;
+    profiler::TraceMe activity("MemCpyAsync", profiler::TraceMeLevel::kInfo);
+    CollectiveRemoteAccessLocal::MemCpyAsync(
+        col_ctx_->op_ctx->op_device_context(),
+        col_ctx_->op_ctx->op_device_context(), col_ctx_->device,
+        col_ctx_->device, col_ctx_->op_ctx->input_alloc_attr(0),
+        col_ctx_->op_ctx->output_alloc_attr(0), col_ctx_->input,
+        col_ctx_->output, 0 /*dev_to_dev_stream_index*/,
+        [&note, &status](const Status& s) {
+          status.Update(s);
+          note.Notify();
+        });
+    note.WaitForNotification();
+    TF_RETURN_IF_ERROR(status);
+  }
+
+  // The group members are ordered by task.  Find the ring of the devices of
+  // this task, and the ring of the devices at the same position in every
+  // task.
+  const std::vector<CollGroupMember>& members = col_params_->group.members;
+  const int rank = col_params_->default_rank;
+  std::vector<std::vector<int>> task_members;
+  int task_idx = -1;
+  for (int i = 0; i < members.size(); ++i) {
+    if (i == 0 || members[i].task != members[i - 1].task) {
+      task_members.emplace_back();
+    }
+    task_members.back().push_back(i);
+    if (i == rank) task_idx = task_members.size() - 1;
+  }
+  const std::vector<int>& task_ring = task_members[task_idx];
+  const int num_devices = task_ring.size();
+  const int task_pos = rank - task_ring[0];
+  std::vector<int> cross_task_ring;
+  for (const std::vector<int>& task : task_members) {
+    if (task.size() != num_devices) {
+      return errors::Internal("Tasks of the HierarchicalReduce group have ",
+                              "different numbers of devices");
+    }
+    cross_task_ring.push_back(task[task_pos]);
+  }
+
+  Allocator* allocator = col_ctx_->device->GetAllocator(
+      col_ctx_->op_ctx->output_alloc_attr(0));
+  std::unique_ptr<CollectiveAdapter> ca(
+      MakeCollectiveAdapter(col_ctx_->output, num_devices, allocator));
+  TF_RETURN_IF_ERROR(
+      ReduceScatter(kTaskReduceScatter, task_ring, task_pos, ca.get()));
+
+  // The devices holding the same chunk in all the tasks all-reduce it.
+  const int chunk_idx = (task_pos + 1) % num_devices;
+  if (ca->ChunkBytes(chunk_idx) > 0) {
+    Tensor chunk = ca->ChunkAlias(chunk_idx);
+    std::unique_ptr<CollectiveAdapter> chunk_ca(MakeCollectiveAdapter(
+        &chunk, cross_task_ring.size(), allocator));
+    TF_RETURN_IF_ERROR(ReduceScatter(kCrossTaskReduceScatter, cross_task_ring,
+                                     task_idx, chunk_ca.get()));
+    const int sub_chunk_idx = (task_idx + 1) % cross_task_ring.size();
+    if (col_params_->final_op && chunk_ca->ChunkBytes(sub_chunk_idx) > 0) {
+      Tensor group_size = chunk_ca->Scalar(col_params_->group.group_size);
+      if (col_params_->group.device_type != DEVICE_CPU) {
+        Tensor host_group_size = group_size;
+        group_size = chunk_ca->Scalar(
+            col_ctx_->device->GetAllocator(
+                col_ctx_->op_ctx->input_alloc_attr(0)),
+            AllocationAttributes());
+        TF_RETURN_IF_ERROR(
+            col_ctx_->op_ctx->op_device_context()->CopyCPUTensorToDeviceSync(
+                &host_group_size, col_ctx_->device, &group_size));
+      }
+      Tensor sub_chunk = chunk_ca->ChunkAlias(sub_chunk_idx);
+      TF_RETURN_IF_ERROR(collective_util::ComputeBinOp(
+          col_ctx_->op_ctx, col_ctx_->op_params, col_ctx_->device,
+          col_params_->final_op, &sub_chunk, &group_size));
+    }
+    TF_RETURN_IF_ERROR(AllGather(kCrossTaskAllGather, cross_task_ring,
+                                 task_idx, chunk_ca.get()));
+  }
+
+  TF_RETURN_IF_ERROR(AllGather(kTaskAllGather, task_ring, task_pos, ca.get()));
+  ca->ConsumeFinalValue(col_ctx_->output);
+  return OkStatus();
+}
+
+Status HierarchicalReducer::ReduceScatter(int phase,
+                                          const std::vector<int>& ring,
+                                          int pos, CollectiveAdapter* ca) {
+  const int n = ring.size();
+  if (n == 1) return OkStatus();
+  // Allocate all the temporary chunks up front, so that only one wait is
+  // needed before they can be written to.
+  std::vector<Tensor> tmp_chunks(n - 1);
+  for (int step = 0; step < n - 1; ++step) {
+    tmp_chunks[step] = ca->TempChunk((pos - step - 1 + 2 * n) % n);
+  }
+  TF_RETURN_IF_ERROR(WaitForQueuedEvents());
+  for (int step = 0; step < n - 1; ++step) {
+    const int send_idx = (pos - step + n) % n;
+    const int recv_idx = (pos - step - 1 + 2 * n) % n;
+    // All the devices have the same chunk sizes and skip the same transfers.
+    if (ca->ChunkBytes(recv_idx) == 0 && ca->ChunkBytes(send_idx) == 0) {
+      continue;
+    }
+    Tensor send_chunk = ca->ChunkAlias(send_idx);
+    Tensor recv_chunk = ca->ChunkAlias(recv_idx);
+    TF_RETURN_IF_ERROR(SendRecv(
+        StepKey(col_ctx_->exec_key, phase, step), ring[(pos + 1) % n],
+        ca->ChunkBytes(send_idx) > 0 ? &send_chunk : nullptr,
+        ring[(pos - 1 + n) % n],
+        ca->ChunkBytes(recv_idx) > 0 ? &tmp_chunks[step] : nullptr));
+    if (ca->ChunkBytes(recv_idx) > 0) {
+      TF_RETURN_IF_ERROR(collective_util::ComputeBinOp(
+          col_ctx_->op_ctx, col_ctx_->op_params, col_ctx_->device,
+          col_params_->merge_op, &recv_chunk, &tmp_chunks[step]));
+    }
+  }
+  return OkStatus();
+}
+
+Status HierarchicalReducer::AllGather(int phase, const std::vector<int>& ring,
+                                      int pos, CollectiveAdapter* ca) {
+  const int n = ring.size();
+  for (int step = 0; step < n - 1; ++step) {
+    const int send_idx = (pos + 1 - step + n) % n;
+    const int recv_idx = (pos - step + n) % n;
+    if (ca->ChunkBytes(recv_idx) == 0 && ca->ChunkBytes(send_idx) == 0) {
+      continue;
+    }
+    Tensor send_chunk = ca->ChunkAlias(send_idx);
+    Tensor recv_chunk = ca->ChunkAlias(recv_idx);
+    TF_RETURN_IF_ERROR(SendRecv(
+        StepKey(col_ctx_->exec_key, phase, step), ring[(pos + 1) % n],
+        ca->ChunkBytes(send_idx) > 0 ? &send_chunk : nullptr,
+        ring[(pos - 1 + n) % n],
+        ca->ChunkBytes(recv_idx) > 0 ? &recv_chunk : nullptr));
+  }
+  return OkStatus();
+}
+
+Status HierarchicalReducer::SendRecv(const string& key, int dst_idx,
+                                     const Tensor* send, int src_idx,
+                                     Tensor* recv) {
+  const std::vector<CollGroupMember>& members = col_params_->group.members;
+  BlockingCounter pending((send != nullptr) + (recv != nullptr));
+  mutex mu;
+  Status status;
+  auto done = [&pending, &mu, &status](const Status& s) {
+    {
+      mutex_lock l(mu);
+      status.Update(s);
+    }
+    pending.DecrementCount();
+  };
+  if (send != nullptr) {
+    col_ctx_->col_exec->remote_access()->PostToPeer(
+        members[dst_idx].device.name(), members[dst_idx].task,
+        strings::StrCat(key, ":", col_params_->default_rank), col_ctx_->device,
+        col_ctx_->op_ctx->op_device_context(),
+        col_ctx_->op_ctx->output_alloc_attr(0), send,
+        col_ctx_->device_locality, col_ctx_->op_ctx->cancellation_manager(),
+        done);
+  }
+  if (recv != nullptr) {
+    col_ctx_->col_exec->remote_access()->RecvFromPeer(
+        members[src_idx].device.name(), members[src_idx].task,
+        members[src_idx].is_local, strings::StrCat(key, ":", src_idx),
+        col_ctx_->device, col_ctx_->op_ctx->op_device_context(),
+        col_ctx_->op_ctx->output_alloc_attr(0), recv,
+        col_ctx_->device_locality, 0 /*dev_to_dev_stream_index*/,
+        col_ctx_->op_ctx->cancellation_manager(), done);
+  }
+  pending.Wait();
+  mutex_lock l(mu);
+  return status;
+}
+
+Status HierarchicalReducer::WaitForQueuedEvents() {
+  const DeviceBase::AcceleratorDeviceInfo* gpu_info =
+      col_ctx_->device->tensorflow_accelerator_device_info();
+  if (gpu_info == nullptr) return OkStatus();
+  profiler::TraceMe activity("WaitForQueuedEvents",
+                             profiler::TraceMeLevel::kInfo);
+  Notification note;
+  TF_RETURN_IF_ERROR(gpu_info->default_context->ThenExecute(
+      col_ctx_->device, gpu_info->stream, [&note]() { note.Notify(); }));
+  note.WaitForNotification();
+  return OkStatus();
+}
+
+namespace {
+REGISTER_COLLECTIVE(HierarchicalReduce, HierarchicalReducer);
+}  // namespace
+
+}  // namespace tensorflow
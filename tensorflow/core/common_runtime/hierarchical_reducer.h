@@ -0,0 +1,75 @@
+/* Copyright 2022 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_CORE_COMMON_RUNTIME_HIERARCHICAL_REDUCER_H_
+#define TENSORFLOW_CORE_COMMON_RUNTIME_HIERARCHICAL_REDUCER_H_
+
+#include <memory>
+#include <vector>
+
+#include "tensorflow/core/common_runtime/base_collective_executor.h"
+#include "tensorflow/core/framework/collective.h"
+
+namespace tensorflow {
+
+// Hierarchical implementation of collective reduce, for groups spanning tasks
+// with the same number of devices each.  With d devices per task, the tensor
+// is reduce-scattered in d chunks over a ring of the devices of each task,
+// each chunk is all-reduced over a ring of the devices holding it in all the
+// tasks, and the chunks are all-gathered over the task rings again.  Only 1/d
+// of the tensor crosses tasks per device, in d concurrent rings.
+class HierarchicalReducer : public CollectiveImplementationInterface {
+ public:
+  HierarchicalReducer() = default;
+  ~HierarchicalReducer() override = default;
+
+  // Checks that all the tasks have the same number of devices.
+  Status InitializeCollectiveParams(CollectiveParams* col_params) override;
+
+  // Initializes members of CollectiveContext not yet initialized, i.e. device
+  // and device_locality.  Also saves the CollectiveContext in this object.
+  Status InitializeCollectiveContext(
+      std::shared_ptr<CollectiveContext> col_ctx) override;
+
+  // Runs the hierarchical reduction.  Must be called in a blockable thread.
+  void Run(StatusCallback done) override;
+
+ private:
+  Status RunHierarchy();
+
+  // Reduce-scatters the chunks of "ca", one per device of "ring", over
+  // "ring", where this device is at "pos".  Afterwards this device holds the
+  // reduced chunk (pos + 1) % ring.size().
+  Status ReduceScatter(int phase, const std::vector<int>& ring, int pos,
+                       CollectiveAdapter* ca);
+
+  // All-gathers the chunks of "ca" over "ring" after ReduceScatter().
+  Status AllGather(int phase, const std::vector<int>& ring, int pos,
+                   CollectiveAdapter* ca);
+
+  // Sends "send" to the group member "dst_idx" while receiving "recv" from
+  // the group member "src_idx", and waits for both.
+  Status SendRecv(const string& key, int dst_idx, const Tensor* send,
+                  int src_idx, Tensor* recv);
+
+  // Waits for the operations queued on the stream of a GPU device, e.g. so
+  // that newly allocated temporary buffers are valid.
+  Status WaitForQueuedEvents();
+
+  std::shared_ptr<CollectiveContext> col_ctx_;
+  const CollectiveParams* col_params_ = nullptr;  // Not owned
+};
+
+}  // namespace tensorflow
+#endif  // TENSORFLOW_CORE_COMMON_RUNTIME_HIERARCHICAL_REDUCER_H_
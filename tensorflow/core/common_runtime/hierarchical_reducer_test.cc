@@ -0,0 +1,150 @@
+/* Copyright 2022 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/common_runtime/hierarchical_reducer.h"
+
+#include <atomic>
+#include <memory>
+#include <vector>
+
+#include "tensorflow/core/common_runtime/collective_test_util.h"
+#include "tensorflow/core/common_runtime/device.h"
+#include "tensorflow/core/common_runtime/device_mgr.h"
+#include "tensorflow/core/common_runtime/process_util.h"
+#include "tensorflow/core/framework/collective.h"
+#include "tensorflow/core/framework/fake_input.h"
+#include "tensorflow/core/framework/node_def.pb.h"
+#include "tensorflow/core/framework/node_def_builder.h"
+#include "tensorflow/core/framework/op_kernel.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_testutil.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/lib/strings/strcat.h"
+#include "tensorflow/core/platform/errors.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/refcount.h"
+#include "tensorflow/core/platform/test.h"
+#include "tensorflow/core/public/version.h"
+
+namespace tensorflow {
+namespace {
+
+std::unique_ptr<OpKernel> GetBinOp(const string& op, DataType dtype,
+                                   const DeviceType& device_type,
+                                   DeviceBase* device) {
+  NodeDef node_def;
+  TF_CHECK_OK(NodeDefBuilder(strings::StrCat(op, "_node"), op)
+                  .Attr("T", dtype)
+                  .Input(FakeInput(dtype))
+                  .Input(FakeInput(dtype))
+                  .Finalize(&node_def));
+  Status status;
+  std::unique_ptr<OpKernel> k = CreateOpKernel(
+      device_type, device, device->GetAllocator(AllocatorAttributes()),
+      node_def, TF_GRAPH_DEF_VERSION, &status);
+  TF_CHECK_OK(status);
+  return k;
+}
+
+class HierarchicalReducerTest : public ::testing::Test {
+ protected:
+  class DeviceInstance {
+   public:
+    DeviceInstance(int rank, const TensorShape& shape,
+                   CollectiveTestEnv* test_env)
+        : test_env_(test_env), tensor_(DT_FLOAT, shape) {
+      col_params_ =
+          CreateCollectiveParams(*test_env_, rank, "HierarchicalReduce",
+                                 REDUCTION_COLLECTIVE, DT_FLOAT, shape);
+      const string& dev_name = col_params_->group.members[rank].device.name();
+      TF_CHECK_OK(test_env_->device_mgr->LookupDevice(dev_name, &device_));
+      merge_op_ = GetBinOp("Add", DT_FLOAT, test_env_->device_type, device_);
+      final_op_ = GetBinOp("Div", DT_FLOAT, test_env_->device_type, device_);
+      col_params_->merge_op = merge_op_.get();
+      col_params_->final_op = final_op_.get();
+    }
+
+    void DoReduce() {
+      status_ = RunCollective(test_env_, col_params_.get(), device_, &tensor_,
+                              &tensor_);
+    }
+
+    CollectiveTestEnv* test_env_;
+    Tensor tensor_;
+    Device* device_;
+    core::RefCountPtr<CollectiveParams> col_params_;
+    std::unique_ptr<OpKernel> merge_op_;
+    std::unique_ptr<OpKernel> final_op_;
+    Status status_;
+  };
+
+  void RunTest(int num_workers, int num_devices, int tensor_len) {
+    test_env_ = CreateCollectiveTestEnv(num_workers, num_devices, DEVICE_CPU);
+    const int group_size = num_workers * num_devices;
+    std::vector<float> expected(tensor_len);
+    for (int rank = 0; rank < group_size; ++rank) {
+      instances_.push_back(std::make_unique<DeviceInstance>(
+          rank, TensorShape({tensor_len}), test_env_.get()));
+      auto values = instances_.back()->tensor_.flat<float>();
+      for (int i = 0; i < tensor_len; ++i) {
+        values(i) = rank * 10 + i;
+        expected[i] += (rank * 10 + i) / static_cast<float>(group_size);
+      }
+    }
+    std::atomic<int> done(0);
+    for (auto& instance : instances_) {
+      SchedClosure([&instance, &done] {
+        instance->DoReduce();
+        ++done;
+      });
+    }
+    while (done < group_size) {
+      Env::Default()->SleepForMicroseconds(1000);
+    }
+    for (auto& instance : instances_) {
+      TF_EXPECT_OK(instance->status_);
+      test::ExpectClose(test::AsTensor<float>(expected), instance->tensor_,
+                        /*atol=*/1e-4, /*rtol=*/1e-5);
+    }
+  }
+
+  std::unique_ptr<CollectiveTestEnv> test_env_;
+  std::vector<std::unique_ptr<DeviceInstance>> instances_;
+};
+
+TEST_F(HierarchicalReducerTest, SingleTask) { RunTest(1, 4, 1001); }
+
+TEST_F(HierarchicalReducerTest, SingleDevicePerTask) { RunTest(4, 1, 1001); }
+
+TEST_F(HierarchicalReducerTest, MultipleTasks) { RunTest(2, 4, 1001); }
+
+TEST_F(HierarchicalReducerTest, MultipleTasksLargeTensor) {
+  RunTest(3, 8, 65536 + 3);
+}
+
+TEST_F(HierarchicalReducerTest, SmallTensor) { RunTest(2, 4, 3); }
+
+TEST_F(HierarchicalReducerTest, UnevenTasks) {
+  test_env_ = CreateCollectiveTestEnv(2, 2, DEVICE_CPU);
+  auto col_params =
+      CreateCollectiveParams(*test_env_, 0, "HierarchicalReduce",
+                             REDUCTION_COLLECTIVE, DT_FLOAT, TensorShape({8}));
+  col_params->group.num_devices_per_task["/job:worker/replica:0/task:1"] = 1;
+  core::RefCountPtr<HierarchicalReducer> reducer(new HierarchicalReducer);
+  EXPECT_TRUE(errors::IsInvalidArgument(
+      reducer->InitializeCollectiveParams(col_params.get())));
+}
+
+}  // namespace
+}  // namespace tensorflow
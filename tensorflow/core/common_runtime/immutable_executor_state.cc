@@ -19,6 +19,8 @@ limitations under the License.
 #include "tensorflow/core/framework/function.h"
 #include "tensorflow/core/framework/metrics.h"
 #include "tensorflow/core/framework/node_def_util.h"
+#include "tensorflow/core/graph/algorithm.h"
+#include "tensorflow/core/graph/costmodel.h"
 #include "tensorflow/core/graph/edgeset.h"
 #include "tensorflow/core/graph/graph.h"
 #include "tensorflow/core/graph/graph_node_util.h"
@@ -259,9 +261,41 @@ Status ImmutableExecutorState::Initialize(const Graph& graph) {
   // Initialize PendingCounts only after pending_ids_[node.id] is initialized
   // for all nodes.
   InitializePending(&graph, cf_info);
+  if (params_.use_critical_path_scheduling) {
+    InitializeCriticalPathCosts(graph);
+  }
   return gview_.SetAllocAttrs(&graph, params_.device);
 }
 
+void ImmutableExecutorState::InitializeCriticalPathCosts(const Graph& graph) {
+  // Visit the nodes in reverse topological order so that the cost of every
+  // successor is known before the cost of its predecessors. Back edges of
+  // while loops point to earlier nodes in the order and are ignored.
+  std::vector<Node*> order;
+  GetReversePostOrder(graph, &order);
+  std::vector<int> position(graph.num_node_ids(), -1);
+  for (int i = 0; i < order.size(); ++i) {
+    position[order[i]->id()] = i;
+  }
+  critical_path_costs_.assign(graph.num_node_ids(), 0);
+  for (int i = order.size() - 1; i >= 0; --i) {
+    const Node* n = order[i];
+    int64_t max_successor_cost = 0;
+    for (const Edge* e : n->out_edges()) {
+      const int dst_position = position[e->dst()->id()];
+      if (dst_position > i) {
+        max_successor_cost = std::max(max_successor_cost,
+                                      critical_path_costs_[e->dst()->id()]);
+      }
+    }
+    int64_t cost = 1;
+    if (params_.cost_model != nullptr) {
+      cost = std::max(cost, params_.cost_model->TimeEstimate(n).value());
+    }
+    critical_path_costs_[n->id()] = cost + max_successor_cost;
+  }
+}
+
 namespace {
 // If a Node has been marked to use a ScopedAllocator x for output i, then
 // sc_attr will contain the subsequence (i, x) at an even offset.  This function
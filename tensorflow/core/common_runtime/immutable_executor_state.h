@@ -101,6 +101,15 @@ class ImmutableExecutorState {
 
   bool requires_control_flow_support() const { return requires_control_flow_; }
 
+  // Returns the estimated cost of the longest path from `node_item` to the
+  // sink node, including the cost of `node_item` itself.
+  //
+  // REQUIRES: `params().use_critical_path_scheduling`.
+  int64_t critical_path_cost(const NodeItem& node_item) const {
+    DCHECK(params_.use_critical_path_scheduling);
+    return critical_path_costs_[node_item.node_id];
+  }
+
   // Copies the pending counts for nodes in this graph to the given array.
   //
   // This method provides a more efficient way of initializing
@@ -125,6 +134,7 @@ class ImmutableExecutorState {
   static Status BuildControlFlowInfo(const Graph* graph,
                                      ControlFlowInfo* cf_info);
   void InitializePending(const Graph* graph, const ControlFlowInfo& cf_info);
+  void InitializeCriticalPathCosts(const Graph& graph);
 
   FrameInfo* EnsureFrameInfo(const string& fname);
 
@@ -152,6 +162,10 @@ class ImmutableExecutorState {
   // pending counts for the nodes in the graph, indexed by node ID.
   std::unique_ptr<std::atomic<int32>[]> atomic_pending_counts_;
 
+  // If `params_.use_critical_path_scheduling` is true, maps dense node IDs to
+  // the estimated cost of the longest path from the node to the sink node.
+  std::vector<int64_t> critical_path_costs_;
+
   // Shallow copies of the constant tensors used in the graph.
   std::vector<Tensor> const_tensors_;
 
@@ -21,6 +21,7 @@ limitations under the License.
 
 namespace tensorflow {
 
+class CostModel;
 class Device;
 class StepStatsCollector;
 class SessionMetadata;
@@ -50,6 +51,23 @@ struct LocalExecutorParams {
 
   // Whether control flow nodes are allowed to be executed synchronously.
   bool allow_control_flow_sync_execution = false;
+
+  // If true, nodes dispatched to the inter-op thread pool are run in order of
+  // the estimated cost of their longest path to the end of the graph, so that
+  // nodes on the critical path do not wait behind off-path work.
+  bool use_critical_path_scheduling = false;
+
+  // If true, the executor measures the run time of every synchronous kernel,
+  // not only of those whose `OpKernel::IsExpensive()` returns true, and uses a
+  // moving average of the measurements to decide whether to run a ready node
+  // inline or to dispatch it. Inexpensive nodes that become ready at the same
+  // time are dispatched together in one closure.
+  bool use_adaptive_inline_execution = false;
+
+  // Optional per-node execution time estimates used to compute the critical
+  // path priorities. If null, every node is assumed to have unit cost. Only
+  // used during executor initialization. Not owned.
+  const CostModel* cost_model = nullptr;
 };
 
 }  // end namespace tensorflow
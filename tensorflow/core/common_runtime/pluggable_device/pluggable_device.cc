@@ -177,6 +177,9 @@ Status PluggableDevice::Init(const SessionOptions& options) {
 
   stream_ = StreamGroupFactory::Global().GetOrCreate(
       device_type(), tf_device_id_, 0, executor_, options.config.gpu_options());
+  // Lets a stream-ordered allocator allocate in the order of the compute
+  // stream. Other allocators ignore this.
+  device_allocator_->SetStreamAndPreallocateMemory(stream_->compute);
   device_context_ = new PluggableDeviceContext(
       0, stream_->compute, stream_->host_to_device, stream_->device_to_host,
       stream_->device_to_device);
@@ -0,0 +1,110 @@
+/* Copyright 2022 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/common_runtime/pluggable_device/pluggable_device_async_allocator.h"
+
+#include <algorithm>
+
+#include "tensorflow/c/experimental/stream_executor/stream_executor_internal.h"
+#include "tensorflow/core/platform/logging.h"
+
+namespace tensorflow {
+
+PluggableDeviceAsyncAllocator::PluggableDeviceAsyncAllocator(
+    DeviceMemAllocator* sub_allocator, const string& name)
+    : sub_allocator_(sub_allocator), name_(name) {}
+
+void* PluggableDeviceAsyncAllocator::AllocateRaw(size_t alignment,
+                                                 size_t num_bytes) {
+  if (num_bytes == 0) return nullptr;
+  mutex_lock l(mu_);
+  void* ptr = nullptr;
+  if (stream_ != nullptr) {
+    port::StatusOr<se::DeviceMemoryBase> mem =
+        se::AllocateAsync(stream_, num_bytes);
+    if (!mem.ok()) {
+      LOG(ERROR) << name_ << " failed to allocate " << num_bytes
+                 << " bytes: " << mem.status();
+      return nullptr;
+    }
+    ptr = mem->opaque();
+  } else {
+    size_t bytes_received;
+    ptr = sub_allocator_->Alloc(alignment, num_bytes, &bytes_received);
+  }
+  if (ptr == nullptr) return nullptr;
+  allocations_[ptr] = {num_bytes, stream_ != nullptr};
+  ++stats_.num_allocs;
+  stats_.bytes_in_use += num_bytes;
+  stats_.peak_bytes_in_use =
+      std::max(stats_.peak_bytes_in_use, stats_.bytes_in_use);
+  stats_.largest_alloc_size =
+      std::max<int64_t>(stats_.largest_alloc_size, num_bytes);
+  return ptr;
+}
+
+void PluggableDeviceAsyncAllocator::DeallocateRaw(void* ptr) {
+  if (ptr == nullptr) return;
+  mutex_lock l(mu_);
+  auto it = allocations_.find(ptr);
+  CHECK(it != allocations_.end())  // Crash OK
+      << name_ << " asked to deallocate an unknown pointer " << ptr;
+  const Allocation allocation = it->second;
+  allocations_.erase(it);
+  stats_.bytes_in_use -= allocation.size;
+  if (allocation.stream_ordered) {
+    se::DeviceMemoryBase mem(ptr, allocation.size);
+    Status s = se::DeallocateAsync(stream_, &mem);
+    if (!s.ok()) {
+      LOG(ERROR) << name_ << " failed to deallocate " << ptr << ": " << s;
+    }
+  } else {
+    sub_allocator_->Free(ptr, allocation.size);
+  }
+}
+
+size_t PluggableDeviceAsyncAllocator::RequestedSize(const void* ptr) const {
+  mutex_lock l(mu_);
+  auto it = allocations_.find(ptr);
+  CHECK(it != allocations_.end())  // Crash OK
+      << name_ << " asked for the size of an unknown pointer " << ptr;
+  return it->second.size;
+}
+
+absl::optional<AllocatorStats> PluggableDeviceAsyncAllocator::GetStats() {
+  mutex_lock l(mu_);
+  return stats_;
+}
+
+bool PluggableDeviceAsyncAllocator::ClearStats() {
+  mutex_lock l(mu_);
+  stats_.num_allocs = 0;
+  stats_.peak_bytes_in_use = stats_.bytes_in_use;
+  stats_.largest_alloc_size = 0;
+  return true;
+}
+
+void PluggableDeviceAsyncAllocator::SetStreamAndPreallocateMemory(
+    void* stream) {
+  mutex_lock l(mu_);
+  se::Stream* new_stream = static_cast<se::Stream*>(stream);
+  if (stream_ != nullptr) {
+    CHECK_EQ(stream_, new_stream)  // Crash OK
+        << name_ << " can only be used with one stream.";
+    return;
+  }
+  stream_ = new_stream;
+}
+
+}  // namespace tensorflow
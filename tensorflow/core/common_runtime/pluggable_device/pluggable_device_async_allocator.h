@@ -0,0 +1,83 @@
+/* Copyright 2022 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_CORE_COMMON_RUNTIME_PLUGGABLE_DEVICE_PLUGGABLE_DEVICE_ASYNC_ALLOCATOR_H_
+#define TENSORFLOW_CORE_COMMON_RUNTIME_PLUGGABLE_DEVICE_PLUGGABLE_DEVICE_ASYNC_ALLOCATOR_H_
+
+#include <memory>
+#include <string>
+
+#include "absl/container/flat_hash_map.h"
+#include "tensorflow/core/common_runtime/device/device_mem_allocator.h"
+#include "tensorflow/core/framework/allocator.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/stream_executor.h"
+#include "tensorflow/core/platform/thread_annotations.h"
+#include "tensorflow/core/platform/types.h"
+
+namespace tensorflow {
+
+// An allocator for PluggableDevices whose plugin implements stream-ordered
+// allocation (`allocate_async` and `deallocate_async` in SP_StreamExecutor).
+// Memory is allocated and freed in the order of the compute stream, so the
+// plugin's pool can reuse memory freed by earlier ops without the host waiting
+// for the device. Allocations made before the compute stream is set with
+// SetStreamAndPreallocateMemory() go through `sub_allocator` synchronously.
+class PluggableDeviceAsyncAllocator : public Allocator {
+ public:
+  PluggableDeviceAsyncAllocator(DeviceMemAllocator* sub_allocator,
+                                const string& name);
+  ~PluggableDeviceAsyncAllocator() override {}
+
+  void* AllocateRaw(size_t alignment, size_t num_bytes) override;
+  void DeallocateRaw(void* ptr) override;
+
+  bool TracksAllocationSizes() const override { return true; }
+  size_t RequestedSize(const void* ptr) const override;
+  size_t AllocatedSize(const void* ptr) const override {
+    return RequestedSize(ptr);
+  }
+  string Name() override { return name_; }
+  absl::optional<AllocatorStats> GetStats() override;
+  bool ClearStats() override;
+
+  // `stream` is the se::Stream* of the device's compute stream.
+  void SetStreamAndPreallocateMemory(void* stream) override;
+
+  AllocatorMemoryType GetMemoryType() const override {
+    return sub_allocator_->GetMemoryType();
+  }
+
+ private:
+  struct Allocation {
+    size_t size;
+    // Whether the memory was allocated in stream order, and must be freed in
+    // stream order too.
+    bool stream_ordered;
+  };
+
+  std::unique_ptr<SubAllocator> sub_allocator_;
+  const string name_;
+
+  mutable mutex mu_;
+  se::Stream* stream_ TF_GUARDED_BY(mu_) = nullptr;
+  absl::flat_hash_map<const void*, Allocation> allocations_ TF_GUARDED_BY(mu_);
+  AllocatorStats stats_ TF_GUARDED_BY(mu_);
+
+  TF_DISALLOW_COPY_AND_ASSIGN(PluggableDeviceAsyncAllocator);
+};
+
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_COMMON_RUNTIME_PLUGGABLE_DEVICE_PLUGGABLE_DEVICE_ASYNC_ALLOCATOR_H_
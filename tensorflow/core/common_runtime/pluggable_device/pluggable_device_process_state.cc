@@ -25,6 +25,7 @@ limitations under the License.
 #include "tensorflow/core/common_runtime/device/device_id_manager.h"
 #include "tensorflow/core/common_runtime/device/device_id_utils.h"
 #include "tensorflow/core/common_runtime/device_factory.h"
+#include "tensorflow/core/common_runtime/pluggable_device/pluggable_device_async_allocator.h"
 #include "tensorflow/core/common_runtime/pluggable_device/pluggable_device_bfc_allocator.h"
 #include "tensorflow/core/common_runtime/pluggable_device/pluggable_device_init.h"
 #include "tensorflow/core/common_runtime/pluggable_device/pluggable_device_simple_allocator.h"
@@ -127,6 +128,10 @@ Allocator* PluggableDeviceProcessState::GetPluggableDeviceAllocator(
           sub_allocator, total_bytes, options,
           strings::StrCat("PluggableDevice_", tf_device_id.value(), "_bfc"),
           cplatform->ForceMemoryGrowth());
+    } else if (cplatform->SupportsStreamOrderedAllocation()) {
+      device_allocator = new PluggableDeviceAsyncAllocator(
+          sub_allocator,
+          strings::StrCat("PluggableDevice_", tf_device_id.value(), "_async"));
     } else {
       device_allocator = new PluggableDeviceSimpleAllocator(sub_allocator);
     }
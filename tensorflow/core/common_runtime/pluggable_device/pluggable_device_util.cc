@@ -15,6 +15,12 @@ limitations under the License.
 
 #include "tensorflow/core/common_runtime/pluggable_device/pluggable_device_util.h"
 
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "absl/container/flat_hash_map.h"
+#include "tensorflow/c/experimental/stream_executor/stream_executor_internal.h"
 #include "tensorflow/core/common_runtime/copy_tensor.h"
 #include "tensorflow/core/common_runtime/device.h"
 #include "tensorflow/core/common_runtime/device/device_event_mgr.h"
@@ -31,7 +37,9 @@ limitations under the License.
 #include "tensorflow/core/lib/hash/hash.h"
 #include "tensorflow/core/lib/strings/strcat.h"
 #include "tensorflow/core/lib/strings/stringprintf.h"
+#include "tensorflow/core/platform/env.h"
 #include "tensorflow/core/platform/logging.h"
+#include "tensorflow/core/platform/mutex.h"
 #include "tensorflow/core/platform/stream_executor.h"
 #include "tensorflow/core/platform/tensor_coding.h"
 #include "tensorflow/core/util/util.h"
@@ -218,6 +226,102 @@ void PluggableDeviceUtil::CopyPluggableDeviceTensorToCPU(
 }
 
 // static
+namespace {
+
+// Host-to-device copies of at most this many bytes are batched when the plugin
+// supports batched memcpy. Larger copies are bandwidth bound and gain nothing
+// from sharing a call into the plugin.
+constexpr int64_t kMaxBatchedCopyBytes = 64 << 10;
+
+// Coalesces small host-to-device copies enqueued onto the same stream into a
+// single batched memcpy, so that a step feeding many small tensors pays the
+// plugin's per-copy submission overhead once. The first copy added to an empty
+// batch schedules a flush; the copies added before the flush runs join it.
+class HostToDeviceCopyBatcher {
+ public:
+  struct Copy {
+    DeviceMemoryBase dst;
+    const void* src = nullptr;
+    uint64 size = 0;
+    // Keeps the source tensor alive until the copy has completed.
+    TensorReference input_ref{Tensor()};
+    StatusCallback done;
+  };
+
+  explicit HostToDeviceCopyBatcher(se::Stream* stream) : stream_(stream) {}
+
+  void Add(Copy copy, EventMgr* event_mgr) {
+    bool schedule_flush;
+    {
+      mutex_lock l(mu_);
+      schedule_flush = pending_.empty();
+      pending_.push_back(std::move(copy));
+    }
+    if (schedule_flush) {
+      Env::Default()->SchedClosure([this, event_mgr]() { Flush(event_mgr); });
+    }
+  }
+
+ private:
+  void Flush(EventMgr* event_mgr) {
+    // Serializes flushes so that batches reach the stream in order.
+    mutex_lock flush_lock(flush_mu_);
+    auto copies = std::make_shared<std::vector<Copy>>();
+    {
+      mutex_lock l(mu_);
+      std::swap(*copies, pending_);
+    }
+    std::vector<DeviceMemoryBase*> dsts;
+    std::vector<const void*> srcs;
+    std::vector<uint64> sizes;
+    dsts.reserve(copies->size());
+    srcs.reserve(copies->size());
+    sizes.reserve(copies->size());
+    for (Copy& copy : *copies) {
+      dsts.push_back(&copy.dst);
+      srcs.push_back(copy.src);
+      sizes.push_back(copy.size);
+    }
+    Status s = se::MemcpyHostToDeviceBatch(stream_, dsts, srcs, sizes);
+    if (!s.ok()) {
+      LOG(FATAL) << "CPU->PluggableDevice batched Memcpy failed: "  // Crash OK
+                 << s;
+    }
+    se::Stream* stream = stream_;
+    event_mgr->ThenExecute(stream, [stream, copies]() {
+      if (!stream->ok()) {
+        LOG(FATAL) << "CPU->PluggableDevice Memcpy failed.";  // Crash OK
+      }
+      for (Copy& copy : *copies) {
+        copy.input_ref.Unref();
+        copy.done(OkStatus());
+      }
+    });
+  }
+
+  se::Stream* const stream_;
+  mutex flush_mu_;
+  mutex mu_;
+  std::vector<Copy> pending_ TF_GUARDED_BY(mu_);
+};
+
+// Returns the batcher for copies onto `stream`. Batchers live as long as the
+// process, like the streams of the devices they serve.
+HostToDeviceCopyBatcher* GetHostToDeviceCopyBatcher(se::Stream* stream) {
+  static mutex* mu = new mutex;
+  static auto* batchers =
+      new absl::flat_hash_map<se::Stream*,
+                              std::unique_ptr<HostToDeviceCopyBatcher>>;
+  mutex_lock l(*mu);
+  std::unique_ptr<HostToDeviceCopyBatcher>& batcher = (*batchers)[stream];
+  if (batcher == nullptr) {
+    batcher = std::make_unique<HostToDeviceCopyBatcher>(stream);
+  }
+  return batcher.get();
+}
+
+}  // namespace
+
 void PluggableDeviceUtil::CopyCPUTensorToPluggableDevice(
     const Tensor* cpu_tensor, const DeviceContext* device_context,
     Device* device, Tensor* device_tensor, StatusCallback done,
@@ -245,6 +349,18 @@ void PluggableDeviceUtil::CopyCPUTensorToPluggableDevice(
     recv_host_to_device_stream->ThenWaitFor(recv_stream);
   }
   const int64_t total_bytes = cpu_tensor->TotalBytes();
+  if (total_bytes > 0 && total_bytes <= kMaxBatchedCopyBytes &&
+      se::SupportsMemcpyBatch(recv_host_to_device_stream->parent())) {
+    HostToDeviceCopyBatcher::Copy copy;
+    copy.dst = DeviceMemoryBase(GetBase(device_tensor), total_bytes);
+    copy.src = GetBase(cpu_tensor);
+    copy.size = total_bytes;
+    copy.input_ref = TensorReference(*cpu_tensor);
+    copy.done = std::move(done);
+    GetHostToDeviceCopyBatcher(recv_host_to_device_stream)
+        ->Add(std::move(copy), dev_info->event_mgr);
+    return;
+  }
   // Note that 0-size tensors have no backing buffer.
   if (total_bytes > 0) {
     void* src_ptr = GetBase(cpu_tensor);
@@ -261,6 +261,23 @@ void* BasicCPUAllocator::Alloc(size_t alignment, size_t num_bytes,
                                size_t* bytes_received) {
   void* ptr = nullptr;
   *bytes_received = num_bytes;
+  if (huge_page_size_ > 0 && num_bytes >= huge_page_size_ &&
+      alignment <= huge_page_size_) {
+    const size_t rounded_bytes =
+        (num_bytes + huge_page_size_ - 1) / huge_page_size_ * huge_page_size_;
+    ptr = port::NUMAMallocHugePages(numa_node_, rounded_bytes, huge_page_size_);
+    if (ptr != nullptr) {
+      {
+        mutex_lock l(mu_);
+        huge_page_allocations_.insert(ptr);
+      }
+      *bytes_received = rounded_bytes;
+      VisitAlloc(ptr, numa_node_, rounded_bytes);
+      return ptr;
+    }
+    VLOG(1) << "Huge pages of " << huge_page_size_
+            << " bytes unavailable; falling back to regular pages";
+  }
   if (num_bytes > 0) {
     if (numa_node_ == port::kNUMANoAffinity) {
       ptr = port::AlignedMalloc(num_bytes, static_cast<int>(alignment));
@@ -274,6 +291,18 @@ void* BasicCPUAllocator::Alloc(size_t alignment, size_t num_bytes,
 }
 
 void BasicCPUAllocator::Free(void* ptr, size_t num_bytes) {
+  if (huge_page_size_ > 0 && num_bytes >= huge_page_size_) {
+    bool huge_pages;
+    {
+      mutex_lock l(mu_);
+      huge_pages = huge_page_allocations_.erase(ptr) > 0;
+    }
+    if (huge_pages) {
+      VisitFree(ptr, numa_node_, num_bytes);
+      port::NUMAFreeHugePages(ptr, num_bytes);
+      return;
+    }
+  }
   if (num_bytes > 0) {
     VisitFree(ptr, numa_node_, num_bytes);
     if (numa_node_ == port::kNUMANoAffinity) {
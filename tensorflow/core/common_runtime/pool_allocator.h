@@ -21,6 +21,7 @@ limitations under the License.
 #include <atomic>
 #include <map>
 #include <memory>
+#include <unordered_set>
 #include <vector>
 
 #include "tensorflow/core/framework/allocator.h"
@@ -153,9 +154,15 @@ class Pow2Rounder : public RoundUpInterface {
 
 class BasicCPUAllocator : public SubAllocator {
  public:
+  // If huge_page_size is nonzero, allocations of at least huge_page_size bytes
+  // are rounded up to a multiple of it and backed by huge pages of that size
+  // (see port::NUMAMallocHugePages) when the platform provides them.
   BasicCPUAllocator(int numa_node, const std::vector<Visitor>& alloc_visitors,
-                    const std::vector<Visitor>& free_visitors)
-      : SubAllocator(alloc_visitors, free_visitors), numa_node_(numa_node) {}
+                    const std::vector<Visitor>& free_visitors,
+                    size_t huge_page_size = 0)
+      : SubAllocator(alloc_visitors, free_visitors),
+        numa_node_(numa_node),
+        huge_page_size_(huge_page_size) {}
 
   ~BasicCPUAllocator() override {}
 
@@ -172,6 +179,11 @@ class BasicCPUAllocator : public SubAllocator {
 
  private:
   int numa_node_;
+  const size_t huge_page_size_;
+
+  mutex mu_;
+  // Allocations backed by huge pages.
+  std::unordered_set<void*> huge_page_allocations_ TF_GUARDED_BY(mu_);
 
   TF_DISALLOW_COPY_AND_ASSIGN(BasicCPUAllocator);
 };
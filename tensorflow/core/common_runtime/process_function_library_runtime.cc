@@ -20,9 +20,11 @@ limitations under the License.
 
 #include "absl/container/flat_hash_map.h"
 #include "absl/memory/memory.h"
+#include "absl/strings/str_cat.h"
 #include "absl/strings/str_join.h"
 #include "tensorflow/core/common_runtime/device_set.h"
 #include "tensorflow/core/common_runtime/function.h"
+#include "tensorflow/core/common_runtime/function_graph_cache.h"
 #include "tensorflow/core/common_runtime/function_optimization_registry.h"
 #include "tensorflow/core/common_runtime/graph_constructor.h"
 #include "tensorflow/core/common_runtime/optimization_registry.h"
@@ -50,6 +52,8 @@ limitations under the License.
 #include "tensorflow/core/lib/gtl/inlined_vector.h"
 #include "tensorflow/core/lib/gtl/map_util.h"
 #include "tensorflow/core/lib/random/random.h"
+#include "tensorflow/core/lib/strings/proto_serialization.h"
+#include "tensorflow/core/platform/fingerprint.h"
 #include "tensorflow/core/platform/notification.h"
 #include "tensorflow/core/util/device_name_utils.h"
 #include "tensorflow/core/util/dump_graph.h"
@@ -671,6 +675,67 @@ Status ValidateMultiDeviceOptions(
   return OkStatus();
 }
 
+// Returns the key under which the partitioned graphs of the multi-device
+// function `fdef` are shared through `FunctionGraphCache::Global()`. The key
+// covers the definitions of all functions reachable from `fdef`, the
+// instantiation attributes and options, and the devices available for
+// placement.
+string FunctionGraphCacheKey(
+    const string& function_name, AttrSlice attrs, const FunctionDef& fdef,
+    const FunctionLibraryDefinition& lib_def,
+    const FunctionLibraryRuntime::InstantiateOptions& options,
+    const DeviceSet& device_set,
+    const std::vector<CompositeDevice*>& composite_devices) {
+  // `Canonicalize()` identifies `options.lib_def` by its address, which is
+  // specific to the caller, so the key uses the library contents instead.
+  FunctionLibraryRuntime::InstantiateOptions key_options = options;
+  key_options.lib_def = nullptr;
+  string key = Canonicalize(function_name, attrs, key_options);
+
+  string contents;
+  SerializeToStringDeterministic(fdef, &contents);
+  const FunctionLibraryDefinition reachable_lib_def =
+      lib_def.ReachableDefinitions(fdef);
+  std::vector<string> reachable_functions =
+      reachable_lib_def.ListFunctionNames();
+  std::sort(reachable_functions.begin(), reachable_functions.end());
+  for (const string& name : reachable_functions) {
+    string serialized;
+    SerializeToStringDeterministic(*reachable_lib_def.Find(name), &serialized);
+    absl::StrAppend(&contents, ";", serialized, ";",
+                    reachable_lib_def.FindGradient(name));
+  }
+  const Fprint128 fingerprint = Fingerprint128(contents);
+  absl::StrAppend(&key, "#", fingerprint.low64, "_", fingerprint.high64);
+
+  std::vector<string> device_names;
+  for (const Device* device : device_set.devices()) {
+    device_names.push_back(device->name());
+  }
+  std::sort(device_names.begin(), device_names.end());
+  absl::StrAppend(&key, "#", absl::StrJoin(device_names, ","));
+  for (const CompositeDevice* device : composite_devices) {
+    absl::StrAppend(&key, "#", device->name(), "=",
+                    absl::StrJoin(*device->underlying_devices(), ","));
+  }
+  std::vector<string> replicated_devices;
+  for (const auto& it : options.composite_devices) {
+    replicated_devices.push_back(
+        absl::StrCat(it.first, "=", absl::StrJoin(*it.second, ",")));
+  }
+  std::sort(replicated_devices.begin(), replicated_devices.end());
+  absl::StrAppend(&key, "#", absl::StrJoin(replicated_devices, ";"));
+
+  // Options that affect the optimized graphs but not `Canonicalize()`.
+  absl::StrAppend(&key, "#", options.is_component_function, ",",
+                  options.default_device_to_target, ",",
+                  options.int_args_and_retvals_on_device, ",",
+                  options.shape_inference_on_tfe_dialect_import, ",",
+                  options.optimize_graph_fn != nullptr, ",",
+                  options.xla_compile_device_type);
+  return key;
+}
+
 }  // anonymous namespace
 
 ProcessFunctionLibraryRuntime::AsyncAttributes::Summary
@@ -752,49 +817,14 @@ Status GetGraphAndArgRets(
   return OkStatus();
 }
 
-Status ProcessFunctionLibraryRuntime::InstantiateMultiDevice(
-    const string& function_name, AttrSlice attrs,
+Status ProcessFunctionLibraryRuntime::OptimizeAndPartitionMultiDeviceFunction(
+    const string& function_name, AttrSlice attrs, const FunctionDef* fdef,
+    const FunctionLibraryDefinition* lib_def,
     const FunctionLibraryRuntime::InstantiateOptions& options,
-    FunctionLibraryRuntime::Handle* handle) {
-  // Check if this function has already been instantiated.
-  const string& function_key = Canonicalize(function_name, attrs, options);
-
-  {
-    mutex_lock l(mu_);
-    const auto& it = table_.find(function_key);
-    if (it != table_.end()) {
-      *handle = it->second;
-      ++mdevice_data_[*handle]->instantiation_counter_;
-      return OkStatus();
-    }
-  }
-
-  VLOG(1) << "Instantiating MultiDevice function \"" << function_name
-          << "\" on default device \"" << options.target << "\"";
-  if (VLOG_IS_ON(3)) {
-    int index = 0;
-    VLOG(3) << "Requested input devices:";
-    for (const string& device : options.input_devices) {
-      VLOG(3) << "    [input " << index++ << "] " << device;
-    }
-    index = 0;
-    VLOG(3) << "Requested output devices:";
-    for (const string& device : options.output_devices) {
-      VLOG(3) << "    [output " << index++ << "] " << device;
-    }
-  }
-
-  const FunctionLibraryDefinition* lib_def =
-      options.lib_def == nullptr ? lib_def_ : options.lib_def;
-
-  const FunctionDef* fdef = lib_def->Find(function_name);
-  if (fdef == nullptr) {
-    return errors::InvalidArgument("Failed to find function \"", function_name,
-                                   "\" in function library: ", lib_def);
-  }
-
-  TF_RETURN_IF_ERROR(ValidateMultiDeviceOptions(*fdef, options));
-
+    const string& function_key, const std::shared_ptr<DeviceSet>& dev_set,
+    std::unique_ptr<MultiDeviceFunctionData>* out_data,
+    std::unordered_map<string, std::unique_ptr<Graph>>* out_subgraphs,
+    std::unordered_map<string, string>* out_node_name_to_control_ret) {
   std::unique_ptr<Graph> graph;
   std::vector<Node*> arg_nodes, ret_nodes;
   std::vector<string> ret_node_names;
@@ -836,8 +866,6 @@ Status ProcessFunctionLibraryRuntime::InstantiateMultiDevice(
     }
   }
 
-  const std::shared_ptr<DeviceSet> dev_set = device_set();
-
   TF_RETURN_IF_ERROR(
       SetArgShape(options.input_resource_dtypes_and_shapes, arg_nodes));
   TF_RETURN_IF_ERROR(PinArgsAndRets(
@@ -865,8 +893,8 @@ Status ProcessFunctionLibraryRuntime::InstantiateMultiDevice(
             << function_name;
   }
 
-  // Mapping from a function body node name to the control output name.
-  std::unordered_map<string, string> node_name_to_control_ret;
+  std::unordered_map<string, string>& node_name_to_control_ret =
+      *out_node_name_to_control_ret;
 
   bool control_rets_updated = false;
   if (should_run_optimization_passes) {
@@ -968,7 +996,8 @@ Status ProcessFunctionLibraryRuntime::InstantiateMultiDevice(
   VLOG(4) << "Main function graph to be partitioned:";
   VLOG(4) << DebugString(graph->ToGraphDefDebug());
 
-  std::unordered_map<string, std::unique_ptr<Graph>> subgraphs;
+  std::unordered_map<string, std::unique_ptr<Graph>>& subgraphs =
+      *out_subgraphs;
   TF_RETURN_IF_ERROR(
       PartitionFunctionGraph(*dev_set, std::move(graph), &subgraphs));
 
@@ -1010,6 +1039,115 @@ Status ProcessFunctionLibraryRuntime::InstantiateMultiDevice(
     }
   }
 
+  *out_data = std::move(data);
+  return OkStatus();
+}
+
+Status ProcessFunctionLibraryRuntime::InstantiateMultiDevice(
+    const string& function_name, AttrSlice attrs,
+    const FunctionLibraryRuntime::InstantiateOptions& options,
+    FunctionLibraryRuntime::Handle* handle) {
+  // Check if this function has already been instantiated.
+  const string& function_key = Canonicalize(function_name, attrs, options);
+
+  {
+    mutex_lock l(mu_);
+    const auto& it = table_.find(function_key);
+    if (it != table_.end()) {
+      *handle = it->second;
+      ++mdevice_data_[*handle]->instantiation_counter_;
+      return OkStatus();
+    }
+  }
+
+  VLOG(1) << "Instantiating MultiDevice function \"" << function_name
+          << "\" on default device \"" << options.target << "\"";
+  if (VLOG_IS_ON(3)) {
+    int index = 0;
+    VLOG(3) << "Requested input devices:";
+    for (const string& device : options.input_devices) {
+      VLOG(3) << "    [input " << index++ << "] " << device;
+    }
+    index = 0;
+    VLOG(3) << "Requested output devices:";
+    for (const string& device : options.output_devices) {
+      VLOG(3) << "    [output " << index++ << "] " << device;
+    }
+  }
+
+  const FunctionLibraryDefinition* lib_def =
+      options.lib_def == nullptr ? lib_def_ : options.lib_def;
+
+  const FunctionDef* fdef = lib_def->Find(function_name);
+  if (fdef == nullptr) {
+    return errors::InvalidArgument("Failed to find function \"", function_name,
+                                   "\" in function library: ", lib_def);
+  }
+
+  TF_RETURN_IF_ERROR(ValidateMultiDeviceOptions(*fdef, options));
+
+  const std::shared_ptr<DeviceSet> dev_set = device_set();
+
+  std::unique_ptr<MultiDeviceFunctionData> data;
+  std::unordered_map<string, std::unique_ptr<Graph>> subgraphs;
+  // Mapping from a function body node name to the control output name.
+  std::unordered_map<string, string> node_name_to_control_ret;
+
+  // The graph collector expects to observe the graphs of every stage, so the
+  // cache is bypassed when one is set.
+  const bool use_graph_cache =
+      options.config_proto.experimental().enable_function_graph_cache() &&
+      options.graph_collector == nullptr;
+  string graph_cache_key;
+  std::shared_ptr<const FunctionGraphCache::Entry> cached_graphs;
+  if (use_graph_cache) {
+    std::vector<CompositeDevice*> composite_devices;
+    {
+      tf_shared_lock l(mu_);
+      for (auto* d : composite_devices_) composite_devices.push_back(d);
+    }
+    graph_cache_key =
+        FunctionGraphCacheKey(function_name, attrs, *fdef, *lib_def, options,
+                              *dev_set, composite_devices);
+    cached_graphs = FunctionGraphCache::Global()->Lookup(graph_cache_key);
+  }
+
+  if (cached_graphs != nullptr) {
+    VLOG(1) << "Reusing cached partitioned graphs of MultiDevice function \""
+            << function_name << "\"";
+    data = std::make_unique<MultiDeviceFunctionData>(
+        function_name, function_key, cached_graphs->num_outputs,
+        FunctionLibraryDefinition(lib_def->default_registry(),
+                                  cached_graphs->library),
+        cached_graphs->ret_types);
+    GraphConstructorOptions opts;
+    opts.allow_internal_ops = true;
+    opts.expect_device_spec = true;
+    for (const auto& partition : cached_graphs->partitions) {
+      auto subgraph = std::make_unique<Graph>(&data->lib_def_);
+      TF_RETURN_IF_ERROR(
+          ConvertGraphDefToGraph(opts, partition.second, subgraph.get()));
+      subgraphs.emplace(partition.first, std::move(subgraph));
+    }
+    node_name_to_control_ret = cached_graphs->node_name_to_control_ret;
+  } else {
+    TF_RETURN_IF_ERROR(OptimizeAndPartitionMultiDeviceFunction(
+        function_name, attrs, fdef, lib_def, options, function_key, dev_set,
+        &data, &subgraphs, &node_name_to_control_ret));
+    if (use_graph_cache) {
+      auto entry = std::make_shared<FunctionGraphCache::Entry>();
+      entry->library = data->lib_def_.ToProto();
+      for (const auto& pair : subgraphs) {
+        entry->partitions.emplace_back(pair.first, GraphDef());
+        pair.second->ToGraphDef(&entry->partitions.back().second);
+      }
+      entry->node_name_to_control_ret = node_name_to_control_ret;
+      entry->num_outputs = data->num_outputs_;
+      entry->ret_types = data->ret_types_;
+      FunctionGraphCache::Global()->Insert(graph_cache_key, std::move(entry));
+    }
+  }
+
   // We must preserve control returns in each of the function components,
   // otherwise after function inlining we might prune side-effectful nodes.
   const auto control_ret =
@@ -388,6 +388,19 @@ class ProcessFunctionLibraryRuntime {
       const FunctionLibraryRuntime::InstantiateOptions& options,
       FunctionLibraryRuntime::Handle* handle);
 
+  // Builds the graph of the multi-device function `function_name`, runs the
+  // graph optimization passes and the placer on it, and partitions it by
+  // device. `out_data` receives the function library that the partitions
+  // refer to.
+  Status OptimizeAndPartitionMultiDeviceFunction(
+      const string& function_name, AttrSlice attrs, const FunctionDef* fdef,
+      const FunctionLibraryDefinition* lib_def,
+      const FunctionLibraryRuntime::InstantiateOptions& options,
+      const string& function_key, const std::shared_ptr<DeviceSet>& dev_set,
+      std::unique_ptr<MultiDeviceFunctionData>* out_data,
+      std::unordered_map<string, std::unique_ptr<Graph>>* out_subgraphs,
+      std::unordered_map<string, string>* out_node_name_to_control_ret);
+
   void InstantiateRemote(
       const string& function_name, AttrSlice attrs,
       const FunctionLibraryRuntime::InstantiateOptions& options,
@@ -21,6 +21,7 @@ limitations under the License.
 #include "tensorflow/core/common_runtime/composite_device.h"
 #include "tensorflow/core/common_runtime/device_factory.h"
 #include "tensorflow/core/common_runtime/device_mgr.h"
+#include "tensorflow/core/common_runtime/function_graph_cache.h"
 #include "tensorflow/core/common_runtime/function_testlib.h"
 #include "tensorflow/core/common_runtime/rendezvous_mgr.h"
 #include "tensorflow/core/framework/function.h"
@@ -1061,6 +1062,38 @@ TEST_F(ProcessFunctionLibraryRuntimeTest, MultiDevice_CreateKernelsEagerly) {
   EXPECT_TRUE(errors::IsInternal(status));
 }
 
+TEST_F(ProcessFunctionLibraryRuntimeTest, MultiDevice_FunctionGraphCache) {
+  FunctionGraphCache::Global()->Clear();
+  FunctionLibraryRuntime::InstantiateOptions inst_opts =
+      MakeOptions("CPU:0", {"CPU:0"}, {"CPU:0"});
+  inst_opts.config_proto.mutable_experimental()
+      ->set_enable_function_graph_cache(true);
+  auto x = test::AsTensor<float>({1, 2, 3, 4});
+  for (int i = 0; i < 2; ++i) {
+    // Each iteration uses a new runtime, as when the same model is reloaded.
+    proc_flr_.reset();
+    Init({test::function::XTimesTwo()});
+    Tensor y;
+    TF_CHECK_OK(Run("XTimesTwo", FunctionLibraryRuntime::Options(),
+                    {{"T", DT_FLOAT}}, inst_opts, {x}, {&y}));
+    test::ExpectTensorEqual<float>(y, test::AsTensor<float>({2, 4, 6, 8}));
+  }
+  EXPECT_EQ(1, FunctionGraphCache::Global()->size());
+  EXPECT_EQ(1, FunctionGraphCache::Global()->num_hits());
+
+  // Placing the function on another device needs another entry.
+  inst_opts = MakeOptions("CPU:1", {"CPU:1"}, {"CPU:1"});
+  inst_opts.config_proto.mutable_experimental()
+      ->set_enable_function_graph_cache(true);
+  Tensor y;
+  TF_CHECK_OK(Run("XTimesTwo", FunctionLibraryRuntime::Options(),
+                  {{"T", DT_FLOAT}}, inst_opts, {x}, {&y}));
+  test::ExpectTensorEqual<float>(y, test::AsTensor<float>({2, 4, 6, 8}));
+  EXPECT_EQ(2, FunctionGraphCache::Global()->size());
+  EXPECT_EQ(1, FunctionGraphCache::Global()->num_hits());
+  FunctionGraphCache::Global()->Clear();
+}
+
 TEST_F(ProcessFunctionLibraryRuntimeTest, MultiDevice_StateHandle) {
   auto T = DT_INT32;
   // The expected sequence of outputs from this function is [6, 4, 0, 1, ...].
@@ -82,12 +82,28 @@ Allocator* ProcessState::GetCPUAllocator(int numa_node) {
     if (!status.ok()) {
       LOG(ERROR) << "GetCPUAllocator: " << status.error_message();
     }
+    // Large allocations may be backed by huge pages (typically 2MB or 1GB),
+    // which cuts TLB misses for large, randomly accessed tensors.
+    int64_t huge_page_size_in_mb = 0;
+    status = ReadInt64FromEnvVar("TF_CPU_ALLOCATOR_HUGE_PAGE_SIZE_IN_MB", 0,
+                                 &huge_page_size_in_mb);
+    if (!status.ok()) {
+      LOG(ERROR) << "GetCPUAllocator: " << status.error_message();
+    }
+    if (huge_page_size_in_mb < 0 ||
+        (huge_page_size_in_mb & (huge_page_size_in_mb - 1)) != 0) {
+      LOG(ERROR) << "GetCPUAllocator: TF_CPU_ALLOCATOR_HUGE_PAGE_SIZE_IN_MB "
+                 << "must be a power of two, got " << huge_page_size_in_mb;
+      huge_page_size_in_mb = 0;
+    }
+    const size_t huge_page_size = huge_page_size_in_mb * (1LL << 20);
     Allocator* allocator = nullptr;
     SubAllocator* sub_allocator =
-        (numa_enabled_ || alloc_visitors_defined || use_bfc_allocator)
+        (numa_enabled_ || alloc_visitors_defined || use_bfc_allocator ||
+         huge_page_size > 0)
             ? new BasicCPUAllocator(
                   numa_enabled_ ? numa_node : port::kNUMANoAffinity,
-                  cpu_alloc_visitors_, cpu_free_visitors_)
+                  cpu_alloc_visitors_, cpu_free_visitors_, huge_page_size)
             : nullptr;
     if (use_bfc_allocator) {
       // TODO(reedwm): evaluate whether 64GB by default is the best choice.
@@ -39,11 +39,22 @@ class RequestCost {
   // rpc request, when all the costs have been collected.
   absl::flat_hash_map<std::string, absl::Duration> GetCosts() const;
 
+  // Records metrics that are not durations, e.g. the number of allocated
+  // bytes. The inputs should be pairs of metric name and value, and the values
+  // are added to the recorded ones. It's thread-safe.
+  void RecordMetrics(
+      const std::vector<std::pair<absl::string_view, double>>& metrics);
+
+  // Gets all metrics for processing an rpc request. It's thread-safe.
+  absl::flat_hash_map<std::string, double> GetMetrics() const;
+
  private:
   mutable absl::Mutex mutex_;
   // Map from cost type to cost.
   absl::flat_hash_map<std::string, absl::Duration> cost_map_
       ABSL_GUARDED_BY(mutex_);
+  // Map from metric name to value.
+  absl::flat_hash_map<std::string, double> metric_map_ ABSL_GUARDED_BY(mutex_);
 };
 
 }  // namespace tensorflow
@@ -48,5 +48,15 @@ TEST(RequestCostTest, Basic) {
                                    Pair("cpu_v2", absl::Milliseconds(44))));
 }
 
+TEST(RequestCostTest, Metrics) {
+  RequestCost request_cost;
+
+  request_cost.RecordMetrics({{"bytes", 100}, {"flops", 1.5}});
+  request_cost.RecordMetrics({{"bytes", 20}});
+  EXPECT_THAT(request_cost.GetMetrics(),
+              UnorderedElementsAre(Pair("bytes", 120), Pair("flops", 1.5)));
+  EXPECT_TRUE(request_cost.GetCosts().empty());
+}
+
 }  // namespace
 }  // namespace tensorflow
@@ -43,6 +43,24 @@ limitations under the License.
 
 namespace tensorflow {
 
+namespace {
+
+// Casts the values of "src" to the type of "dst", where one of them is a float
+// tensor and the other a bfloat16 or half tensor of the same shape.
+void CastChunk(const Tensor& src, Tensor* dst) {
+  if (src.dtype() == DT_BFLOAT16) {
+    dst->flat<float>() = src.flat<bfloat16>().cast<float>();
+  } else if (src.dtype() == DT_HALF) {
+    dst->flat<float>() = src.flat<Eigen::half>().cast<float>();
+  } else if (dst->dtype() == DT_BFLOAT16) {
+    dst->flat<bfloat16>() = src.flat<float>().cast<bfloat16>();
+  } else {
+    dst->flat<Eigen::half>() = src.flat<float>().cast<Eigen::half>();
+  }
+}
+
+}  // namespace
+
 RingReducer::~RingReducer() { group_size_tensor_ready_.WaitForNotification(); }
 
 Status RingReducer::InitializeCollectiveParams(CollectiveParams* col_params) {
@@ -167,6 +185,17 @@ void RingReducer::InitRingField(RingField* rf, int chunk_idx, int subdiv_idx,
   if (rf->do_recv) {
     rf->tmp_chunk = ca_->TempChunk(rf->sc_idx);
   }
+  // Field values are compressed between devices, which is implemented for
+  // float values on CPU devices.
+  const DataType wire_dtype = col_params_->instance.impl_details.wire_dtype;
+  if (wire_dtype != DT_INVALID && rf->chunk.IsInitialized() &&
+      rf->chunk.dtype() == DT_FLOAT &&
+      col_params_->group.device_type == DEVICE_CPU) {
+    rf->wire_chunk =
+        Tensor(col_ctx_->device->GetAllocator(
+                   col_ctx_->op_ctx->output_alloc_attr(0)),
+               wire_dtype, rf->chunk.shape());
+  }
 }
 
 // At the beginning of the algorithm initialize a RingField struct for
@@ -252,6 +281,10 @@ bool RingReducer::RunAsyncParts() {
           case RF_RECV:
             CHECK_GT(recv_pending_count, 0);
             --recv_pending_count;
+            if (rf->wire_chunk.IsInitialized()) {
+              CastChunk(rf->wire_chunk, rf->second_pass ? &rf->chunk
+                                                        : &rf->tmp_chunk);
+            }
             if (!rf->second_pass) {
               rf->action = RF_REDUCE;
               Status s = collective_util::ComputeBinOp(
@@ -286,6 +319,9 @@ bool RingReducer::RunAsyncParts() {
           case RF_SEND_READY:
             if (rf->do_send) {
               rf->action = RF_SEND;
+              if (rf->wire_chunk.IsInitialized()) {
+                CastChunk(rf->chunk, &rf->wire_chunk);
+              }
               auto send_complete = [this, rf, &ready_queue,
                                     &aborted](Status s) {
                 if (!s.ok()) {
@@ -314,6 +350,12 @@ bool RingReducer::RunAsyncParts() {
             ++field_done_count;
             break;  // from do while(!dispatched)
           } else {
+            if (rf->is_final && rf->wire_chunk.IsInitialized()) {
+              // Round the reduced values to the wire type, so that all the
+              // devices end up with the values sent in the second pass.
+              CastChunk(rf->chunk, &rf->wire_chunk);
+              CastChunk(rf->wire_chunk, &rf->chunk);
+            }
             AdvanceToSecondPass(rf);
           }
         }
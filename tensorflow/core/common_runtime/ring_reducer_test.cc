@@ -424,6 +424,39 @@ DEF_TEST(INT32, CPU, 2, 8, 3, 4095, 0)
 DEF_TEST(INT64, CPU, 1, 2, 1, 1001, 0)
 DEF_TEST(INT64, CPU, 2, 8, 3, 4095, 0)
 
+TEST_F(RingReducerTest, CompressedChunks) {
+  for (DataType wire_dtype : {DT_BFLOAT16, DT_HALF}) {
+    instances_.clear();
+    const int tensor_len = 1001;
+    Init(/*num_workers=*/2, /*num_devices=*/2, DT_FLOAT,
+         TensorShape({tensor_len}), DEVICE_CPU, /*num_subdivs=*/1,
+         /*fail_after=*/0);
+    for (int di = 0; di < static_cast<int>(instances_.size()); ++di) {
+      instances_[di]->col_params_->instance.impl_details.wire_dtype =
+          wire_dtype;
+      instances_[di]->InitTensor([di](Tensor* t) {
+        for (int i = 0; i < t->NumElements(); ++i) {
+          t->flat<float>()(i) = 0.01f * i + di;
+        }
+      });
+    }
+    Reduce(/*fail_after=*/0);
+    std::vector<float> expected(tensor_len);
+    for (int i = 0; i < tensor_len; ++i) {
+      expected[i] = 0.01f * i + 1.5f;
+    }
+    for (int di = 0; di < static_cast<int>(instances_.size()); ++di) {
+      TF_EXPECT_OK(instances_[di]->status_);
+      test::ExpectClose(test::AsTensor<float>(expected),
+                        instances_[di]->tensor(), /*atol=*/0.1,
+                        /*rtol=*/0.01);
+      // All the devices must end up with the same rounded values.
+      test::ExpectTensorEqual<float>(instances_[0]->tensor(),
+                                     instances_[di]->tensor());
+    }
+  }
+}
+
 // Failure tests
 DEF_TEST(FLOAT, CPU, 2, 8, 1, 9408, 1)
 DEF_TEST(FLOAT, CPU, 2, 8, 1, 9408, 7)
@@ -15,18 +15,28 @@ limitations under the License.
 
 #include "tensorflow/core/common_runtime/single_threaded_executor.h"
 
+#include <algorithm>
+#include <atomic>
+#include <memory>
 #include <utility>
 
 #include "tensorflow/core/common_runtime/entry.h"
 #include "tensorflow/core/common_runtime/executor.h"
 #include "tensorflow/core/common_runtime/executor_factory.h"
 #include "tensorflow/core/common_runtime/renamed_device.h"
+#include "tensorflow/core/common_runtime/shape_refiner.h"
+#include "tensorflow/core/common_runtime/step_memory_planner.h"
+#include "tensorflow/core/framework/shape_inference.h"
+#include "tensorflow/core/framework/types.h"
 #include "tensorflow/core/graph/algorithm.h"
 #include "tensorflow/core/lib/core/errors.h"
 #include "tensorflow/core/lib/core/status.h"
 #include "tensorflow/core/lib/gtl/cleanup.h"
+#include "tensorflow/core/platform/cpu_info.h"
 #include "tensorflow/core/platform/errors.h"
 #include "tensorflow/core/platform/macros.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/refcount.h"
 
 namespace tensorflow {
 
@@ -67,11 +77,15 @@ typedef gtl::InlinedVector<AllocatorAttributes, 4> AllocatorAttributeVec;
 
 static const string& kSingleThreadedExecutor =
     *new string("SINGLE_THREADED_EXECUTOR");
+static const string& kStaticPlanExecutor =
+    *new string("STATIC_PLAN_EXECUTOR");
 
 class SingleThreadedExecutorImpl : public Executor {
  public:
-  explicit SingleThreadedExecutorImpl(const LocalExecutorParams& params)
-      : params_(params) {}
+  SingleThreadedExecutorImpl(const LocalExecutorParams& params,
+                             bool execute_waves_in_parallel)
+      : params_(params),
+        execute_waves_in_parallel_(execute_waves_in_parallel) {}
 
   ~SingleThreadedExecutorImpl() override {
     for (const KernelState& kernel_state : kernels_) {
@@ -94,6 +108,25 @@ class SingleThreadedExecutorImpl : public Executor {
                                      ordered_nodes.size());
     }
 
+    // In the static plan mode, group the nodes into waves: the wave of a node
+    // is one more than the latest wave of its (data or control) inputs. A
+    // stable sort by wave keeps the order topological, and makes the kernels
+    // of each wave contiguous in `kernels_`.
+    absl::flat_hash_map<const Node*, int> node_waves;
+    if (execute_waves_in_parallel_) {
+      for (const Node* n : ordered_nodes) {
+        int wave = 0;
+        for (const Edge* e : n->in_edges()) {
+          wave = std::max(wave, node_waves[e->src()] + 1);
+        }
+        node_waves[n] = wave;
+      }
+      std::stable_sort(ordered_nodes.begin(), ordered_nodes.end(),
+                       [&node_waves](const Node* a, const Node* b) {
+                         return node_waves[a] < node_waves[b];
+                       });
+    }
+
     // We reserve two less nodes because we do not need to create kernels for
     // the _SOURCE and _SINK nodes.
     kernels_.reserve(ordered_nodes.size() - 2);
@@ -235,6 +268,19 @@ class SingleThreadedExecutorImpl : public Executor {
       }
     }
 
+    if (execute_waves_in_parallel_) {
+      for (size_t i = 1; i < nodes_with_kernels.size(); ++i) {
+        if (node_waves[nodes_with_kernels[i]] !=
+            node_waves[nodes_with_kernels[i - 1]]) {
+          wave_limits_.push_back(i);
+        }
+      }
+      if (!kernels_.empty()) {
+        wave_limits_.push_back(kernels_.size());
+      }
+      PlanOutputMemory(graph, ordered_nodes, nodes_with_kernels, node_waves);
+    }
+
     if (!kernels_.empty()) {
       const KernelState& last_kernel_state = kernels_.back();
       total_num_inputs_ =
@@ -329,7 +375,9 @@ class SingleThreadedExecutorImpl : public Executor {
     params.runner = &runner_copy;
     params.run_all_kernels_inline = args.run_all_kernels_inline;
     params.stats_collector = args.stats_collector;
-    params.executor_type = &kSingleThreadedExecutor;
+    params.executor_type = execute_waves_in_parallel_
+                               ? &kStaticPlanExecutor
+                               : &kSingleThreadedExecutor;
 
     // NOTE(mrry): We are assuming that the graph is loopless and condless.
     params.frame_iter = FrameAndIter(0, 0);
@@ -345,6 +393,23 @@ class SingleThreadedExecutorImpl : public Executor {
     // TODO(mrry): Consider implementing forwarding.
     params.forward_from_array = nullptr;
 
+    // Serve the outputs with statically known sizes from a single arena laid
+    // out by `PlanOutputMemory()`.
+    core::RefCountPtr<StepArena> arena;
+    std::vector<Allocator*> output_allocators;
+    if (memory_plan_ != nullptr) {
+      arena.reset(new StepArena(device->GetAllocator(AllocatorAttributes()),
+                                memory_plan_));
+      output_allocators.resize(total_num_outputs_, nullptr);
+      for (size_t i = 0; i < output_plan_slots_.size(); ++i) {
+        if (output_plan_slots_[i] >= 0) {
+          output_allocators[i] = arena->slot_allocator(output_plan_slots_[i]);
+        }
+      }
+    }
+    Allocator* const* output_allocators_data =
+        output_allocators.empty() ? nullptr : output_allocators.data();
+
     const size_t received_args =
         args.call_frame ? args.call_frame->num_args() : 0;
     if (TF_PREDICT_FALSE(arg_output_locations_.size() > received_args)) {
@@ -406,98 +471,289 @@ class SingleThreadedExecutorImpl : public Executor {
       }
     }
 
-    // Execute the kernels one-at-a-time in topological order.
-    for (size_t i = 0; i < kernels_.size(); ++i) {
-      const KernelState& kernel_state = kernels_[i];
-
-      // Prepare the per-kernel parameters.
-      const size_t input_start_index = kernel_state.input_start_index;
-      const size_t num_inputs = kernel_state.num_inputs;
-      const size_t num_outputs = kernel_state.num_outputs;
-
-      node_inputs.clear();
-      node_inputs.resize(num_inputs);
-      input_alloc_attrs.clear();
-      input_alloc_attrs.resize(num_inputs);
-      for (size_t j = 0; j < num_inputs; ++j) {
-        Entry& input = inputs[input_start_index + j];
-        switch (input.state) {
-          case Entry::State::HAS_CONST_TENSOR:
-            // NOTE(mrry): This `const_cast` is necessary because `TensorValue`
-            // stores a non-const `Tensor*`, and relies on the `OpKernelContext`
-            // accessors making dynamic checks that prevent using an immutable
-            // tensor as a mutable tensor.
-            node_inputs[j].tensor = const_cast<Tensor*>(input.const_tensor);
-            break;
-          case Entry::State::HAS_VALUE:
-            node_inputs[j].tensor = input.val.get();
-            break;
-          default:
-            DCHECK(false) << "Input did not have a valid value.";
+    // Execute the kernels in topological order. In the static plan mode,
+    // the kernels of each wave (which do not depend on each other) may run
+    // concurrently.
+    if (!execute_waves_in_parallel_) {
+      for (size_t i = 0; i < kernels_.size(); ++i) {
+        TF_RETURN_IF_ERROR(ExecuteKernel(i, device, &params, &node_inputs,
+                                         &input_alloc_attrs,
+                                         output_allocators_data, &inputs));
+      }
+    } else {
+      size_t wave_start = 0;
+      for (size_t wave_limit : wave_limits_) {
+        if (wave_limit - wave_start == 1 || args.run_all_kernels_inline) {
+          for (size_t i = wave_start; i < wave_limit; ++i) {
+            TF_RETURN_IF_ERROR(ExecuteKernel(i, device, &params, &node_inputs,
+                                             &input_alloc_attrs,
+                                             output_allocators_data, &inputs));
+          }
+        } else {
+          TF_RETURN_IF_ERROR(ExecuteWave(wave_start, wave_limit, device,
+                                         params, args.runner,
+                                         output_allocators_data, &inputs));
         }
-        input_alloc_attrs[j] = input_alloc_attrs_[input_start_index + j];
+        wave_start = wave_limit;
       }
-      params.op_kernel = kernel_state.kernel;
-      params.output_attr_array = kernel_state.output_alloc_attrs.data();
-      OpKernelContext ctx(&params, num_outputs);
+    }
+    return OkStatus();
+  }
 
-      // Actually execute the kernel.
-      device->Compute(kernel_state.kernel, &ctx);
-      TF_RETURN_IF_ERROR(ctx.status());
+  // Execute all operations in the calling thread when asynchronous execution
+  // is requested. Callers may expect to perform expensive work in the calling
+  // thread even when the execution itself is single-threaded.
+  //
+  // This also avoid stack-overflow issues with functional control flow.
+  void RunAsync(const Args& args, DoneCallback done) override {
+    args.runner([this, args, done]() { done(Run(args)); });
+  }
 
-      // Free the inputs to the current kernel.
-      for (size_t j = 0; j < num_inputs; ++j) {
-        inputs[input_start_index + j].ClearVal();
+ private:
+  // Executes `kernels_[i]`. Consumes the inputs of the kernel from `inputs`,
+  // and forwards its outputs to the inputs of the kernels that depend on it.
+  // `node_inputs` and `input_alloc_attrs` are scratch space, and `params` is
+  // updated to point to them. If not null, `output_allocators` is indexed by
+  // `KernelState::output_start_index` plus the output number.
+  Status ExecuteKernel(size_t i, Device* device,
+                       OpKernelContext::Params* params,
+                       TensorValueVec* node_inputs,
+                       AllocatorAttributeVec* input_alloc_attrs,
+                       Allocator* const* output_allocators,
+                       std::vector<Entry>* inputs) const {
+    const KernelState& kernel_state = kernels_[i];
+
+    // Prepare the per-kernel parameters.
+    const size_t input_start_index = kernel_state.input_start_index;
+    const size_t num_inputs = kernel_state.num_inputs;
+    const size_t num_outputs = kernel_state.num_outputs;
+
+    node_inputs->clear();
+    node_inputs->resize(num_inputs);
+    input_alloc_attrs->clear();
+    input_alloc_attrs->resize(num_inputs);
+    for (size_t j = 0; j < num_inputs; ++j) {
+      Entry& input = (*inputs)[input_start_index + j];
+      switch (input.state) {
+        case Entry::State::HAS_CONST_TENSOR:
+          // NOTE(mrry): This `const_cast` is necessary because `TensorValue`
+          // stores a non-const `Tensor*`, and relies on the `OpKernelContext`
+          // accessors making dynamic checks that prevent using an immutable
+          // tensor as a mutable tensor.
+          (*node_inputs)[j].tensor = const_cast<Tensor*>(input.const_tensor);
+          break;
+        case Entry::State::HAS_VALUE:
+          (*node_inputs)[j].tensor = input.val.get();
+          break;
+        default:
+          DCHECK(false) << "Input did not have a valid value.";
       }
+      (*input_alloc_attrs)[j] = input_alloc_attrs_[input_start_index + j];
+    }
+    params->inputs = node_inputs;
+    params->input_alloc_attrs = input_alloc_attrs;
+    params->op_kernel = kernel_state.kernel;
+    params->output_attr_array = kernel_state.output_alloc_attrs.data();
+    params->output_allocator_array =
+        output_allocators != nullptr
+            ? output_allocators + kernel_state.output_start_index
+            : nullptr;
+    OpKernelContext ctx(params, num_outputs);
+
+    // Actually execute the kernel.
+    device->Compute(kernel_state.kernel, &ctx);
+    TF_RETURN_IF_ERROR(ctx.status());
+
+    // Free the inputs to the current kernel.
+    for (size_t j = 0; j < num_inputs; ++j) {
+      (*inputs)[input_start_index + j].ClearVal();
+    }
 
-      // Forward the outputs of the kernel to the inputs of subsequent kernels.
-      for (size_t j = 0; j < num_outputs; ++j) {
-        TensorValue val = ctx.release_output(j);
-        const size_t num_destinations = kernel_state.output_locations[j].size();
-        if (num_destinations > 0) {
-          // TODO(mrry): Consider flattening the `output_locations` vector
-          // to improve the cache-friendliness of this loop.
-          for (size_t k = 0; k < num_destinations - 1; ++k) {
-            // TODO(mrry): Validate that the types match the expected values or
-            // ensure that the necessary validation has already happened.
-            Entry& input = inputs[kernel_state.output_locations[j][k]];
-            input.state = Entry::State::HAS_VALUE;
-            if (val.tensor != nullptr) {
-              input.val.Init(*val.tensor);
-            } else {
-              input.val.Init(Tensor(kernel_state.kernel->output_type(j)));
-            }
-          }
-          // Move `arg` to the last consumer to avoid the cost of copying it.
-          Entry& input =
-              inputs[kernel_state.output_locations[j][num_destinations - 1]];
+    // Forward the outputs of the kernel to the inputs of subsequent kernels.
+    for (size_t j = 0; j < num_outputs; ++j) {
+      TensorValue val = ctx.release_output(j);
+      const size_t num_destinations = kernel_state.output_locations[j].size();
+      if (num_destinations > 0) {
+        // TODO(mrry): Consider flattening the `output_locations` vector
+        // to improve the cache-friendliness of this loop.
+        for (size_t k = 0; k < num_destinations - 1; ++k) {
+          // TODO(mrry): Validate that the types match the expected values or
+          // ensure that the necessary validation has already happened.
+          Entry& input = (*inputs)[kernel_state.output_locations[j][k]];
           input.state = Entry::State::HAS_VALUE;
           if (val.tensor != nullptr) {
-            input.val.Init(std::move(*val.tensor));
+            input.val.Init(*val.tensor);
           } else {
             input.val.Init(Tensor(kernel_state.kernel->output_type(j)));
           }
         }
-        delete val.tensor;
+        // Move `arg` to the last consumer to avoid the cost of copying it.
+        Entry& input =
+            (*inputs)[kernel_state.output_locations[j][num_destinations - 1]];
+        input.state = Entry::State::HAS_VALUE;
+        if (val.tensor != nullptr) {
+          input.val.Init(std::move(*val.tensor));
+        } else {
+          input.val.Init(Tensor(kernel_state.kernel->output_type(j)));
+        }
       }
+      delete val.tensor;
     }
     return OkStatus();
   }
 
-  // Execute all operations in the calling thread when asynchronous execution
-  // is requested. Callers may expect to perform expensive work in the calling
-  // thread even when the execution itself is single-threaded.
-  //
-  // This also avoid stack-overflow issues with functional control flow.
-  void RunAsync(const Args& args, DoneCallback done) override {
-    args.runner([this, args, done]() { done(Run(args)); });
+  // Executes `kernels_[wave_start, wave_limit)`, which do not depend on each
+  // other, using the calling thread and up to `port::MaxParallelism() - 1`
+  // closures scheduled on `runner`. Every participant claims kernels from a
+  // shared counter, so the wave completes even if none of the closures gets
+  // to run before the calling thread has executed all kernels.
+  Status ExecuteWave(size_t wave_start, size_t wave_limit, Device* device,
+                     const OpKernelContext::Params& params,
+                     const Args::Runner& runner,
+                     Allocator* const* output_allocators,
+                     std::vector<Entry>* inputs) const {
+    // NOTE: `OpKernelContext::Params` owns `eigen_gpu_device`, so it may only
+    // be copied while that is unset.
+    DCHECK(params.eigen_gpu_device == nullptr);
+    struct WaveState {
+      std::atomic<size_t> next_kernel;
+      mutex mu;
+      condition_variable all_done;
+      size_t num_done TF_GUARDED_BY(mu) = 0;
+      Status status TF_GUARDED_BY(mu);
+    };
+    auto state = std::make_shared<WaveState>();
+    state->next_kernel = wave_start;
+    const size_t num_kernels = wave_limit - wave_start;
+    // A closure that has not claimed a kernel never dereferences `device`,
+    // `params` or `inputs`, which may be gone by the time it runs.
+    auto work = [this, state, wave_limit, num_kernels, device, &params,
+                 output_allocators, inputs]() {
+      std::unique_ptr<OpKernelContext::Params> kernel_params;
+      TensorValueVec node_inputs;
+      AllocatorAttributeVec input_alloc_attrs;
+      size_t i;
+      while ((i = state->next_kernel.fetch_add(1)) < wave_limit) {
+        if (!kernel_params) {
+          kernel_params = std::make_unique<OpKernelContext::Params>(params);
+        }
+        Status s = ExecuteKernel(i, device, kernel_params.get(), &node_inputs,
+                                 &input_alloc_attrs, output_allocators, inputs);
+        mutex_lock l(state->mu);
+        state->status.Update(s);
+        if (++state->num_done == num_kernels) {
+          state->all_done.notify_all();
+        }
+      }
+    };
+    const size_t num_closures =
+        std::min(num_kernels, static_cast<size_t>(port::MaxParallelism())) - 1;
+    for (size_t i = 0; i < num_closures; ++i) {
+      runner(work);
+    }
+    work();
+    mutex_lock l(state->mu);
+    while (state->num_done < num_kernels) {
+      state->all_done.wait(l);
+    }
+    return state->status;
+  }
+
+  // Plans a single arena for the outputs of `nodes_with_kernels` whose sizes
+  // are known after shape inference, such that outputs that may be live at
+  // the same time do not overlap. An output is live from the wave of its
+  // producer to the latest wave of its consumers. Allocations that do not
+  // follow the plan (e.g. because an output is forwarded and outlives its
+  // planned lifetime) fall back to the device allocator at run time.
+  void PlanOutputMemory(const Graph& graph,
+                        const std::vector<Node*>& ordered_nodes,
+                        const std::vector<Node*>& nodes_with_kernels,
+                        absl::flat_hash_map<const Node*, int>& node_waves) {
+    total_num_outputs_ = 0;
+    for (KernelState& kernel_state : kernels_) {
+      kernel_state.output_start_index = total_num_outputs_;
+      total_num_outputs_ += kernel_state.num_outputs;
+    }
+    // Only host memory is planned, since other devices may impose additional
+    // requirements on their allocators.
+    if (params_.device->device_type() != DEVICE_CPU) {
+      return;
+    }
+
+    ShapeRefiner refiner(graph.versions(), graph.op_registry());
+    refiner.set_require_shape_inference_fns(false);
+    for (const Node* n : ordered_nodes) {
+      if (!n->IsSource() && !n->IsSink()) {
+        // Nodes whose shapes cannot be inferred are not planned.
+        refiner.AddNode(n).IgnoreError();
+      }
+    }
+
+    std::vector<TensorLifetime> lifetimes;
+    output_plan_slots_.assign(total_num_outputs_, -1);
+    for (size_t i = 0; i < kernels_.size(); ++i) {
+      const Node* n = nodes_with_kernels[i];
+      const KernelState& kernel_state = kernels_[i];
+      shape_inference::InferenceContext* c = refiner.GetContext(n);
+      if (c == nullptr) {
+        continue;
+      }
+      for (int j = 0; j < n->num_outputs(); ++j) {
+        const DataType dtype = n->output_type(j);
+        const shape_inference::ShapeHandle shape = c->output(j);
+        if (kernel_state.output_alloc_attrs[j].value != 0 ||
+            !DataTypeCanUseMemcpy(dtype) || !c->FullyDefined(shape)) {
+          continue;
+        }
+        const int64_t size =
+            c->Value(c->NumElements(shape)) * DataTypeSize(dtype);
+        if (size <= 0) {
+          continue;
+        }
+        TensorLifetime lifetime;
+        lifetime.size = size;
+        lifetime.first_use = node_waves[n];
+        lifetime.last_use = lifetime.first_use;
+        for (const Edge* e : n->out_edges()) {
+          if (e->src_output() == j) {
+            lifetime.last_use =
+                std::max<int64_t>(lifetime.last_use, node_waves[e->dst()]);
+          }
+        }
+        output_plan_slots_[kernel_state.output_start_index + j] =
+            lifetimes.size();
+        lifetimes.push_back(lifetime);
+      }
+    }
+    if (!lifetimes.empty()) {
+      memory_plan_ =
+          std::make_shared<const StepMemoryPlan>(PlanStepMemory(lifetimes));
+    }
   }
 
- private:
   const LocalExecutorParams params_;
 
+  // If true, independent kernels are grouped into waves that may execute
+  // concurrently on `Args::runner`.
+  const bool execute_waves_in_parallel_;
+
   // All following members are read-only after Initialize().
 
+  // If `execute_waves_in_parallel_` is true, the `i`th wave consists of the
+  // kernels with indices in `[wave_limits_[i - 1], wave_limits_[i])`, where
+  // `wave_limits_[-1]` is taken as 0.
+  std::vector<size_t> wave_limits_;
+
+  // The sum of the number of outputs for each kernel.
+  size_t total_num_outputs_ = 0;
+
+  // If not null, the arena layout for the outputs with statically known
+  // sizes. The `k`th kernel output, in the order given by
+  // `KernelState::output_start_index`, is allocated from the region
+  // `output_plan_slots_[k]` of the plan, unless that is -1.
+  std::shared_ptr<const StepMemoryPlan> memory_plan_;
+  std::vector<int> output_plan_slots_;
+
   // The sum of the number of inputs for each node in the graph. This determines
   // the length of the flat `inputs` vector. See comment at the beginning of
   // `RunAsync()` for details.
@@ -518,6 +774,10 @@ class SingleThreadedExecutorImpl : public Executor {
 
     size_t num_outputs;
 
+    // The index of the first output of `kernel` in the flat vector of all
+    // kernel outputs, which is used to look up their planned allocators.
+    size_t output_start_index = 0;
+
     // For the `j`th output of `kernel`, `output_locations[j]` contains the
     // locations in the flat `inputs` vector to which that output must be
     // copied. See comment at the beginning of `Run()` for details.
@@ -573,6 +833,7 @@ class SingleThreadedExecutorRegistrar {
  public:
   SingleThreadedExecutorRegistrar() {
     ExecutorFactory::Register(kSingleThreadedExecutor, new Factory());
+    ExecutorFactory::Register(kStaticPlanExecutor, new StaticPlanFactory());
   }
 
  private:
@@ -585,6 +846,16 @@ class SingleThreadedExecutorRegistrar {
       return OkStatus();
     }
   };
+
+  class StaticPlanFactory : public ExecutorFactory {
+    Status NewExecutor(const LocalExecutorParams& params, const Graph& graph,
+                       std::unique_ptr<Executor>* out_executor) override {
+      Executor* ret;
+      TF_RETURN_IF_ERROR(NewStaticPlanExecutor(params, graph, &ret));
+      out_executor->reset(ret);
+      return OkStatus();
+    }
+  };
 };
 static SingleThreadedExecutorRegistrar registrar;
 
@@ -592,7 +863,17 @@ static SingleThreadedExecutorRegistrar registrar;
 
 Status NewSingleThreadedExecutor(const LocalExecutorParams& params,
                                  const Graph& graph, Executor** executor) {
-  auto impl = std::make_unique<SingleThreadedExecutorImpl>(params);
+  auto impl = std::make_unique<SingleThreadedExecutorImpl>(
+      params, /*execute_waves_in_parallel=*/false);
+  TF_RETURN_IF_ERROR(impl->Initialize(graph));
+  *executor = impl.release();
+  return OkStatus();
+}
+
+Status NewStaticPlanExecutor(const LocalExecutorParams& params,
+                             const Graph& graph, Executor** executor) {
+  auto impl = std::make_unique<SingleThreadedExecutorImpl>(
+      params, /*execute_waves_in_parallel=*/true);
   TF_RETURN_IF_ERROR(impl->Initialize(graph));
   *executor = impl.release();
   return OkStatus();
@@ -54,6 +54,20 @@ namespace tensorflow {
 Status NewSingleThreadedExecutor(const LocalExecutorParams& params,
                                  const Graph& graph, Executor** executor);
 
+// Creates a new `Executor` that, like the single-threaded executor, schedules
+// `graph` once into a static plan with a preassigned input buffer layout, and
+// replays that plan on every run without maintaining pending counts or ready
+// queues. Unlike the single-threaded executor, the plan groups kernels into
+// waves of kernels that do not depend on each other, and the kernels of a wave
+// may run concurrently on `Executor::Args::runner`. On CPU devices, outputs
+// whose sizes are known from shape inference are allocated from a single
+// per-step arena, at offsets planned from their lifetimes in waves.
+//
+// The executor is registered as "STATIC_PLAN_EXECUTOR", and has the same
+// limitations as the single-threaded executor.
+Status NewStaticPlanExecutor(const LocalExecutorParams& params,
+                             const Graph& graph, Executor** executor);
+
 // Returns Status::OK() for ops which are compatible with synchronous execution,
 // and otherwise returns an error message appropriate for propagation if needed.
 // If `allow_control_flow_sync_execution` is set to `true` control
@@ -28,12 +28,14 @@ limitations under the License.
 #include "tensorflow/core/framework/op.h"
 #include "tensorflow/core/framework/op_kernel.h"
 #include "tensorflow/core/framework/rendezvous.h"
+#include "tensorflow/core/framework/tensor_testutil.h"
 #include "tensorflow/core/framework/versions.pb.h"
 #include "tensorflow/core/graph/algorithm.h"
 #include "tensorflow/core/graph/graph.h"
 #include "tensorflow/core/graph/node_builder.h"
 #include "tensorflow/core/graph/testlib.h"
 #include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/lib/core/threadpool.h"
 #include "tensorflow/core/lib/random/simple_philox.h"
 #include "tensorflow/core/lib/strings/strcat.h"
 #include "tensorflow/core/platform/errors.h"
@@ -85,7 +87,8 @@ class ExecutorTest : public ::testing::Test {
 
   // Resets executor_ with a new executor based on a graph 'gdef'.
   void Create(std::unique_ptr<const Graph> graph,
-              std::function<void(OpKernelContext*)> mock_fn = nullptr) {
+              std::function<void(OpKernelContext*)> mock_fn = nullptr,
+              const string& executor_type = "SINGLE_THREADED_EXECUTOR") {
     const int version = graph->versions().producer();
     LocalExecutorParams params;
     params.device = device_.get();
@@ -103,8 +106,7 @@ class ExecutorTest : public ::testing::Test {
     params.delete_kernel = [](OpKernel* kernel) {
       DeleteNonCachedKernel(kernel);
     };
-    TF_CHECK_OK(
-        NewExecutor("SINGLE_THREADED_EXECUTOR", params, *graph, &exec_));
+    TF_CHECK_OK(NewExecutor(executor_type, params, *graph, &exec_));
     runner_ = [](const std::function<void()>& fn) { fn(); };
     rendez_ = NewLocalRendezvous();
   }
@@ -324,6 +326,68 @@ TEST_F(ExecutorTest, RandomTree) {
   EXPECT_EQ(4096.0, V(retvals[0]));
 }
 
+TEST_F(ExecutorTest, StaticPlanRandomTree) {
+  auto g = std::make_unique<Graph>(OpRegistry::Global());
+  BuildTree(4096, g.get());
+  Create(std::move(g), /*mock_fn=*/nullptr, "STATIC_PLAN_EXECUTOR");
+  thread::ThreadPool pool(Env::Default(), "static_plan", 4);
+  runner_ = [&pool](std::function<void()> fn) { pool.Schedule(std::move(fn)); };
+  FunctionCallFrame call_frame({DT_FLOAT}, {DT_FLOAT});
+  TF_ASSERT_OK(call_frame.SetArgs({V(1.0)}));
+  TF_ASSERT_OK(Run(&call_frame));
+  std::vector<Tensor> retvals;
+  TF_ASSERT_OK(call_frame.ConsumeRetvals(&retvals, false));
+  EXPECT_EQ(4096.0, V(retvals[0]));
+}
+
+TEST_F(ExecutorTest, StaticPlanKnownShapes) {
+  // All intermediate results have statically known shapes, so they are
+  // allocated from the planned step arena, and the returned tensor escapes it.
+  auto g = std::make_unique<Graph>(OpRegistry::Global());
+  Tensor ones(DT_FLOAT, TensorShape({1024}));
+  ones.flat<float>().setConstant(1.0);
+  auto c = test::graph::Constant(g.get(), ones);
+  auto x = test::graph::Unary(g.get(), "Neg", c);
+  auto y = test::graph::Add(g.get(), c, c);
+  for (int i = 0; i < 8; ++i) {
+    x = test::graph::Add(g.get(), x, c);
+    if (i < 3) {
+      y = test::graph::Add(g.get(), y, c);
+    }
+  }
+  test::graph::Retval(g.get(), 0, test::graph::Add(g.get(), x, y));
+  FixupSourceAndSinkEdges(g.get());
+  Create(std::move(g), /*mock_fn=*/nullptr, "STATIC_PLAN_EXECUTOR");
+  thread::ThreadPool pool(Env::Default(), "static_plan", 4);
+  runner_ = [&pool](std::function<void()> fn) { pool.Schedule(std::move(fn)); };
+  std::vector<Tensor> retvals;
+  for (int step = 0; step < 2; ++step) {
+    FunctionCallFrame call_frame({}, {DT_FLOAT});
+    TF_ASSERT_OK(Run(&call_frame));
+    TF_ASSERT_OK(call_frame.ConsumeRetvals(&retvals, false));
+  }
+  ASSERT_EQ(1, retvals.size());
+  Tensor expected(DT_FLOAT, TensorShape({1024}));
+  expected.flat<float>().setConstant(12.0);
+  test::ExpectTensorEqual<float>(expected, retvals[0]);
+}
+
+TEST_F(ExecutorTest, StaticPlanOpError) {
+  auto g = std::make_unique<Graph>(OpRegistry::Global());
+  auto zero = test::graph::Constant(g.get(), V(0.0));
+  auto inf = test::graph::Unary(g.get(), "Reciprocal", zero);
+  auto check = test::graph::CheckNumerics(g.get(), inf, "message");
+  auto two = test::graph::Constant(g.get(), V(2.0));
+  test::graph::Binary(g.get(), "Mul", check, two);
+  test::graph::Unary(g.get(), "Reciprocal", two);
+  FixupSourceAndSinkEdges(g.get());
+  Create(std::move(g), /*mock_fn=*/nullptr, "STATIC_PLAN_EXECUTOR");
+  thread::ThreadPool pool(Env::Default(), "static_plan", 4);
+  runner_ = [&pool](std::function<void()> fn) { pool.Schedule(std::move(fn)); };
+  FunctionCallFrame call_frame({}, {});
+  EXPECT_TRUE(errors::IsInvalidArgument(Run(&call_frame)));
+}
+
 TEST_F(ExecutorTest, OpError) {
   auto g = std::make_unique<Graph>(OpRegistry::Global());
   auto zero = test::graph::Constant(g.get(), V(0.0));
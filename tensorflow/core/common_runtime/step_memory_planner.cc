@@ -0,0 +1,160 @@
+/* Copyright 2022 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/common_runtime/step_memory_planner.h"
+
+#include <algorithm>
+#include <iterator>
+#include <numeric>
+#include <utility>
+
+#include "tensorflow/core/platform/logging.h"
+
+namespace tensorflow {
+
+namespace {
+
+int64_t AlignedSize(int64_t size) {
+  constexpr int64_t kAlignment = Allocator::kAllocatorAlignment;
+  return (size + kAlignment - 1) / kAlignment * kAlignment;
+}
+
+}  // namespace
+
+StepMemoryPlan PlanStepMemory(const std::vector<TensorLifetime>& lifetimes) {
+  const int num_tensors = lifetimes.size();
+  StepMemoryPlan plan;
+  plan.offsets.resize(num_tensors, 0);
+  plan.sizes.resize(num_tensors);
+  for (int i = 0; i < num_tensors; ++i) {
+    plan.sizes[i] = AlignedSize(lifetimes[i].size);
+  }
+
+  std::vector<int> order(num_tensors);
+  std::iota(order.begin(), order.end(), 0);
+  std::stable_sort(order.begin(), order.end(), [&plan](int a, int b) {
+    return plan.sizes[a] > plan.sizes[b];
+  });
+
+  // The tensors placed so far, ordered by offset.
+  std::vector<int> placed;
+  placed.reserve(num_tensors);
+  for (int i : order) {
+    const TensorLifetime& lifetime = lifetimes[i];
+    int64_t offset = 0;
+    for (int p : placed) {
+      if (lifetimes[p].last_use < lifetime.first_use ||
+          lifetime.last_use < lifetimes[p].first_use) {
+        continue;
+      }
+      if (offset + plan.sizes[i] <= plan.offsets[p]) {
+        break;
+      }
+      offset = std::max(offset, plan.offsets[p] + plan.sizes[p]);
+    }
+    plan.offsets[i] = offset;
+    plan.arena_size = std::max(plan.arena_size, offset + plan.sizes[i]);
+    placed.insert(std::upper_bound(placed.begin(), placed.end(), offset,
+                                   [&plan](int64_t o, int p) {
+                                     return o < plan.offsets[p];
+                                   }),
+                  i);
+  }
+  return plan;
+}
+
+class StepArena::SlotAllocator : public Allocator {
+ public:
+  SlotAllocator(StepArena* arena, int slot) : arena_(arena), slot_(slot) {}
+
+  std::string Name() override { return "step_arena"; }
+
+  void* AllocateRaw(size_t alignment, size_t num_bytes) override {
+    return arena_->AllocateSlot(slot_, alignment, num_bytes);
+  }
+
+  void DeallocateRaw(void* ptr) override { arena_->DeallocateSlot(ptr); }
+
+ private:
+  StepArena* const arena_;  // Not owned.
+  const int slot_;
+};
+
+StepArena::StepArena(Allocator* allocator,
+                     std::shared_ptr<const StepMemoryPlan> plan)
+    : allocator_(allocator), plan_(std::move(plan)) {
+  if (plan_->arena_size > 0) {
+    base_ = static_cast<char*>(allocator_->AllocateRaw(
+        Allocator::kAllocatorAlignment, plan_->arena_size));
+  }
+  const int num_slots = plan_->offsets.size();
+  slot_allocators_.reserve(num_slots);
+  for (int i = 0; i < num_slots; ++i) {
+    slot_allocators_.push_back(std::make_unique<SlotAllocator>(this, i));
+  }
+}
+
+StepArena::~StepArena() {
+  DCHECK(busy_.empty());
+  if (base_ != nullptr) {
+    allocator_->DeallocateRaw(base_);
+  }
+}
+
+bool StepArena::Contains(const void* ptr) const {
+  const char* p = static_cast<const char*>(ptr);
+  return base_ != nullptr && p >= base_ && p < base_ + plan_->arena_size;
+}
+
+void* StepArena::AllocateSlot(int i, size_t alignment, size_t num_bytes) {
+  const int64_t offset = plan_->offsets[i];
+  const int64_t limit = offset + plan_->sizes[i];
+  // The plan reserves space for the size observed when it was made, so any
+  // other request (or an alignment stricter than the arena's) uses the
+  // underlying allocator.
+  if (base_ != nullptr && num_bytes > 0 &&
+      AlignedSize(num_bytes) == plan_->sizes[i] &&
+      alignment <= Allocator::kAllocatorAlignment) {
+    mutex_lock l(mu_);
+    auto it = busy_.lower_bound(limit);
+    // The region is free if the last live allocation starting before `limit`
+    // ends at or before `offset`.
+    if (it == busy_.begin() || std::prev(it)->second <= offset) {
+      busy_.emplace(offset, limit);
+      Ref();
+      return base_ + offset;
+    }
+  }
+  void* ptr = allocator_->AllocateRaw(alignment, num_bytes);
+  if (ptr != nullptr) {
+    // The tensor buffer will call back into the slot allocator, which is
+    // owned by the arena.
+    Ref();
+  }
+  return ptr;
+}
+
+void StepArena::DeallocateSlot(void* ptr) {
+  if (Contains(ptr)) {
+    mutex_lock l(mu_);
+    busy_.erase(static_cast<char*>(ptr) - base_);
+  } else {
+    allocator_->DeallocateRaw(ptr);
+  }
+  // NOTE: This may delete the arena, so no members may be accessed after it.
+  Unref();
+}
+
+}  // namespace tensorflow
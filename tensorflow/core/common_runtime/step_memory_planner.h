@@ -0,0 +1,98 @@
+/* Copyright 2022 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_CORE_COMMON_RUNTIME_STEP_MEMORY_PLANNER_H_
+#define TENSORFLOW_CORE_COMMON_RUNTIME_STEP_MEMORY_PLANNER_H_
+
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "tensorflow/core/framework/allocator.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/refcount.h"
+#include "tensorflow/core/platform/thread_annotations.h"
+#include "tensorflow/core/platform/types.h"
+
+namespace tensorflow {
+
+// The size and lifetime of a tensor whose shape is known before a step runs.
+// The lifetime is the closed interval `[first_use, last_use]` of the
+// execution stages (e.g. kernel indices, or waves of independent kernels) in
+// which the tensor buffer must remain valid.
+struct TensorLifetime {
+  int64_t size = 0;
+  int64_t first_use = 0;
+  int64_t last_use = 0;
+};
+
+// A static assignment of non-overlapping regions of a single arena to tensors
+// with overlapping lifetimes. `offsets[i]` and `sizes[i]` describe the region
+// of the `i`th tensor, and `arena_size` is the total number of bytes needed.
+struct StepMemoryPlan {
+  std::vector<int64_t> offsets;
+  std::vector<int64_t> sizes;
+  int64_t arena_size = 0;
+};
+
+// Computes an arena layout for `lifetimes` using the greedy-by-size heuristic:
+// tensors are placed in decreasing order of size, each at the lowest offset
+// that does not overlap a previously placed tensor with an overlapping
+// lifetime. Region sizes are rounded up to `Allocator::kAllocatorAlignment`.
+StepMemoryPlan PlanStepMemory(const std::vector<TensorLifetime>& lifetimes);
+
+// A single buffer that serves the allocations of one step according to a
+// `StepMemoryPlan`.
+//
+// `slot_allocator(i)` returns an allocator that returns the planned region for
+// the `i`th tensor when the requested size matches the plan and the region is
+// not in use by an allocation that outlived its planned lifetime; it falls back
+// to the underlying allocator otherwise. Each live allocation holds a
+// reference on the arena, so tensors that escape the step (e.g. as function
+// return values) remain valid after the caller drops its reference.
+class StepArena : public core::RefCounted {
+ public:
+  // Does not take ownership of `allocator`, which must outlive the arena.
+  StepArena(Allocator* allocator, std::shared_ptr<const StepMemoryPlan> plan);
+  ~StepArena() override;
+
+  Allocator* slot_allocator(int i) { return slot_allocators_[i].get(); }
+
+  // Returns true if `ptr` was allocated from the arena buffer.
+  bool Contains(const void* ptr) const;
+
+ private:
+  class SlotAllocator;
+
+  void* AllocateSlot(int i, size_t alignment, size_t num_bytes);
+  void DeallocateSlot(void* ptr);
+
+  Allocator* const allocator_;  // Not owned.
+  // Shared with the owner of the plan, since the arena may outlive it.
+  const std::shared_ptr<const StepMemoryPlan> plan_;
+  char* base_ = nullptr;
+  std::vector<std::unique_ptr<SlotAllocator>> slot_allocators_;
+
+  mutex mu_;
+  // Maps the offset of each live arena allocation to its limit.
+  std::map<int64_t, int64_t> busy_ TF_GUARDED_BY(mu_);
+
+  TF_DISALLOW_COPY_AND_ASSIGN(StepArena);
+};
+
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_COMMON_RUNTIME_STEP_MEMORY_PLANNER_H_
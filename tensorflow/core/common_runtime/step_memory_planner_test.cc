@@ -0,0 +1,103 @@
+/* Copyright 2022 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/common_runtime/step_memory_planner.h"
+
+#include <memory>
+#include <vector>
+
+#include "tensorflow/core/framework/allocator.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace {
+
+bool Overlaps(const StepMemoryPlan& plan, int a, int b) {
+  return plan.offsets[a] < plan.offsets[b] + plan.sizes[b] &&
+         plan.offsets[b] < plan.offsets[a] + plan.sizes[a];
+}
+
+TEST(StepMemoryPlannerTest, DisjointLifetimesShareMemory) {
+  StepMemoryPlan plan = PlanStepMemory({{256, 0, 1}, {256, 2, 3}, {128, 4, 4}});
+  EXPECT_EQ(plan.offsets, std::vector<int64_t>({0, 0, 0}));
+  EXPECT_EQ(plan.arena_size, 256);
+}
+
+TEST(StepMemoryPlannerTest, OverlappingLifetimesDoNotShareMemory) {
+  std::vector<TensorLifetime> lifetimes = {
+      {100, 0, 2}, {300, 1, 3}, {64, 2, 2}, {200, 3, 4}, {500, 5, 6}};
+  StepMemoryPlan plan = PlanStepMemory(lifetimes);
+  for (int i = 0; i < lifetimes.size(); ++i) {
+    EXPECT_EQ(plan.offsets[i] % Allocator::kAllocatorAlignment, 0);
+    EXPECT_GE(plan.sizes[i], lifetimes[i].size);
+    EXPECT_LE(plan.offsets[i] + plan.sizes[i], plan.arena_size);
+    for (int j = 0; j < i; ++j) {
+      if (lifetimes[i].first_use <= lifetimes[j].last_use &&
+          lifetimes[j].first_use <= lifetimes[i].last_use) {
+        EXPECT_FALSE(Overlaps(plan, i, j)) << i << " " << j;
+      }
+    }
+  }
+  // The arena is no larger than the peak size of the live tensors, at stage 3.
+  EXPECT_EQ(plan.arena_size, 320 + 256);
+}
+
+TEST(StepArenaTest, ServesPlannedRegions) {
+  auto plan = std::make_shared<StepMemoryPlan>(
+      PlanStepMemory({{1024, 0, 0}, {1024, 1, 1}}));
+  auto* arena = new StepArena(cpu_allocator(), plan);
+  core::ScopedUnref unref(arena);
+  Tensor t0(arena->slot_allocator(0), DT_FLOAT, TensorShape({256}));
+  EXPECT_TRUE(arena->Contains(t0.data()));
+  t0 = Tensor();
+  Tensor t1(arena->slot_allocator(1), DT_FLOAT, TensorShape({256}));
+  EXPECT_TRUE(arena->Contains(t1.data()));
+}
+
+TEST(StepArenaTest, FallsBackOnSizeMismatch) {
+  auto plan = std::make_shared<StepMemoryPlan>(PlanStepMemory({{1024, 0, 0}}));
+  auto* arena = new StepArena(cpu_allocator(), plan);
+  core::ScopedUnref unref(arena);
+  Tensor t(arena->slot_allocator(0), DT_FLOAT, TensorShape({512}));
+  EXPECT_TRUE(t.IsInitialized());
+  EXPECT_FALSE(arena->Contains(t.data()));
+}
+
+TEST(StepArenaTest, FallsBackWhenRegionIsStillInUse) {
+  auto plan = std::make_shared<StepMemoryPlan>(
+      PlanStepMemory({{1024, 0, 0}, {1024, 1, 1}}));
+  ASSERT_EQ(plan->offsets[0], plan->offsets[1]);
+  auto* arena = new StepArena(cpu_allocator(), plan);
+  core::ScopedUnref unref(arena);
+  // `t0` outlives its planned lifetime, so `t1` must not alias it.
+  Tensor t0(arena->slot_allocator(0), DT_FLOAT, TensorShape({256}));
+  Tensor t1(arena->slot_allocator(1), DT_FLOAT, TensorShape({256}));
+  EXPECT_TRUE(arena->Contains(t0.data()));
+  EXPECT_FALSE(arena->Contains(t1.data()));
+}
+
+TEST(StepArenaTest, TensorsOutliveTheCallersReference) {
+  auto plan = std::make_shared<StepMemoryPlan>(PlanStepMemory({{1024, 0, 0}}));
+  auto* arena = new StepArena(cpu_allocator(), plan);
+  Tensor t(arena->slot_allocator(0), DT_FLOAT, TensorShape({256}));
+  arena->Unref();
+  plan.reset();
+  t.flat<float>().setConstant(1.0f);
+  EXPECT_EQ(t.flat<float>()(255), 1.0f);
+}
+
+}  // namespace
+}  // namespace tensorflow
@@ -45,6 +45,7 @@ info. It does not have any negative impact on performance. */
 #include "tensorflow/core/platform/types.h"
 #include "tensorflow/core/public/session_options.h"
 #include "tensorflow/core/util/util.h"
+#include "tensorflow/core/util/work_sharder.h"
 
 #ifdef INTEL_MKL
 #include "tensorflow/core/common_runtime/mkl_cpu_allocator.h"
@@ -172,6 +173,14 @@ bool ShouldLogInputsAndOutputs(OpKernel* op_kernel) {
   }
   return ops_to_log.count(op_kernel->type_string());
 }
+
+// Returns the maximum number of intra-op threads Grappler's ParallelismTuner
+// found `op_kernel` can make good use of, or 0 if there is no limit.
+int MaxIntraOpParallelism(const OpKernel* op_kernel) {
+  const auto& attr = op_kernel->def().attr();
+  auto it = attr.find("_max_intra_op_parallelism");
+  return it == attr.end() ? 0 : static_cast<int>(it->second.i());
+}
 }  // namespace
 
 void ThreadPoolDevice::Compute(OpKernel* op_kernel, OpKernelContext* context) {
@@ -181,7 +190,14 @@ void ThreadPoolDevice::Compute(OpKernel* op_kernel, OpKernelContext* context) {
     LogInputs(op_kernel, context);
   }
 
-  op_kernel->Compute(context);
+  const int max_intra_op_parallelism = MaxIntraOpParallelism(op_kernel);
+  if (max_intra_op_parallelism > 0) {
+    ScopedPerThreadMaxParallelism scoped_max_parallelism(
+        max_intra_op_parallelism);
+    op_kernel->Compute(context);
+  } else {
+    op_kernel->Compute(context);
+  }
 
   if (context->status().ok() && node_file_writer_) {
     Status s = node_file_writer_->RecordNodeExecution(op_kernel, context);
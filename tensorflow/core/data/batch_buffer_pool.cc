@@ -0,0 +1,112 @@
+/* Copyright 2022 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/data/batch_buffer_pool.h"
+
+#include "tensorflow/core/framework/allocation_description.pb.h"
+#include "tensorflow/core/platform/errors.h"
+
+namespace tensorflow {
+namespace data {
+
+class BatchBufferPool::PooledBuffer : public TensorBuffer {
+ public:
+  // Takes a reference to `pool`, which is released once the buffer has been
+  // returned to the pool.
+  PooledBuffer(BatchBufferPool* pool, void* data, size_t size)
+      : TensorBuffer(data), pool_(pool), size_(size) {
+    pool_->Ref();
+  }
+
+  ~PooledBuffer() override {
+    pool_->Release(data(), size_);
+    pool_->Unref();
+  }
+
+  size_t size() const override { return size_; }
+
+  TensorBuffer* root_buffer() override { return this; }
+
+  void FillAllocationDescription(AllocationDescription* proto) const override {
+    proto->set_requested_bytes(size_);
+    proto->set_allocator_name(pool_->allocator_->Name());
+    proto->set_ptr(reinterpret_cast<uintptr_t>(data()));
+  }
+
+ private:
+  BatchBufferPool* const pool_;
+  const size_t size_;
+};
+
+BatchBufferPool::BatchBufferPool(Allocator* allocator, int64_t max_cached_bytes)
+    : allocator_(allocator), max_cached_bytes_(max_cached_bytes) {}
+
+BatchBufferPool::~BatchBufferPool() {
+  mutex_lock l(mu_);
+  for (auto& it : free_buffers_) {
+    for (void* data : it.second) {
+      allocator_->DeallocateRaw(data);
+    }
+  }
+}
+
+Status BatchBufferPool::Allocate(DataType dtype, const TensorShape& shape,
+                                 Tensor* out) {
+  const size_t num_bytes = shape.num_elements() * DataTypeSize(dtype);
+  if (!DataTypeCanUseMemcpy(dtype) || num_bytes == 0) {
+    *out = Tensor(allocator_, dtype, shape);
+    return OkStatus();
+  }
+  void* data = nullptr;
+  {
+    mutex_lock l(mu_);
+    auto it = free_buffers_.find(num_bytes);
+    if (it != free_buffers_.end() && !it->second.empty()) {
+      data = it->second.back();
+      it->second.pop_back();
+      cached_bytes_ -= num_bytes;
+    }
+  }
+  if (data == nullptr) {
+    data = allocator_->AllocateRaw(Allocator::kAllocatorAlignment, num_bytes);
+    if (data == nullptr) {
+      return errors::ResourceExhausted("Failed to allocate ", num_bytes,
+                                       " bytes for a batch buffer.");
+    }
+  }
+  PooledBuffer* buffer = new PooledBuffer(this, data, num_bytes);
+  *out = Tensor(dtype, shape, buffer);
+  buffer->Unref();
+  return OkStatus();
+}
+
+int64_t BatchBufferPool::cached_bytes() const {
+  mutex_lock l(mu_);
+  return cached_bytes_;
+}
+
+void BatchBufferPool::Release(void* data, size_t num_bytes) {
+  {
+    mutex_lock l(mu_);
+    if (cached_bytes_ + static_cast<int64_t>(num_bytes) <= max_cached_bytes_) {
+      free_buffers_[num_bytes].push_back(data);
+      cached_bytes_ += num_bytes;
+      return;
+    }
+  }
+  allocator_->DeallocateRaw(data);
+}
+
+}  // namespace data
+}  // namespace tensorflow
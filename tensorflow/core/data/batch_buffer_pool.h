@@ -0,0 +1,81 @@
+/* Copyright 2022 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_CORE_DATA_BATCH_BUFFER_POOL_H_
+#define TENSORFLOW_CORE_DATA_BATCH_BUFFER_POOL_H_
+
+#include <vector>
+
+#include "absl/container/flat_hash_map.h"
+#include "tensorflow/core/framework/allocator.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_shape.h"
+#include "tensorflow/core/framework/types.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/refcount.h"
+#include "tensorflow/core/platform/status.h"
+#include "tensorflow/core/platform/thread_annotations.h"
+
+namespace tensorflow {
+namespace data {
+
+// A pool of the buffers backing the batches produced by a batching iterator.
+//
+// Tensors allocated from the pool return their buffer to the pool, rather than
+// to the allocator, once the last reference to them is dropped (e.g. by the
+// consumer of the batch). Pipelines producing batches of a fixed shape thus
+// recycle the same few buffers instead of allocating one per batch. Buffers are
+// pooled by size, so tensors of different dtypes or shapes with the same size
+// share buffers.
+//
+// Only tensors of types that can be memcpy'd are pooled. The pool keeps at most
+// `max_cached_bytes` of unused buffers, and is kept alive by the tensors
+// allocated from it, so it can be released before them.
+class BatchBufferPool : public core::RefCounted {
+ public:
+  // The default number of bytes of unused buffers kept by a pool.
+  static constexpr int64_t kDefaultMaxCachedBytes = 64 << 20;  // 64 MiB
+
+  // `allocator` must outlive the pool.
+  BatchBufferPool(Allocator* allocator, int64_t max_cached_bytes);
+
+  ~BatchBufferPool() override;
+
+  // Allocates a tensor of the given type and shape into `out`. The contents of
+  // the tensor are uninitialized.
+  Status Allocate(DataType dtype, const TensorShape& shape, Tensor* out);
+
+  // Returns the number of bytes of unused buffers held by the pool.
+  int64_t cached_bytes() const TF_LOCKS_EXCLUDED(mu_);
+
+ private:
+  class PooledBuffer;
+
+  // Returns a buffer of `num_bytes` previously allocated by the pool.
+  void Release(void* data, size_t num_bytes) TF_LOCKS_EXCLUDED(mu_);
+
+  Allocator* const allocator_;  // Not owned.
+  const int64_t max_cached_bytes_;
+
+  mutable mutex mu_;
+  // Unused buffers, keyed by their size in bytes.
+  absl::flat_hash_map<size_t, std::vector<void*>> free_buffers_
+      TF_GUARDED_BY(mu_);
+  int64_t cached_bytes_ TF_GUARDED_BY(mu_) = 0;
+};
+
+}  // namespace data
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_DATA_BATCH_BUFFER_POOL_H_
@@ -0,0 +1,97 @@
+/* Copyright 2022 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/data/batch_buffer_pool.h"
+
+#include "tensorflow/core/framework/allocator.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_shape.h"
+#include "tensorflow/core/framework/tensor_testutil.h"
+#include "tensorflow/core/framework/types.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/refcount.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace data {
+namespace {
+
+TEST(BatchBufferPoolTest, RecyclesBuffers) {
+  core::RefCountPtr<BatchBufferPool> pool(
+      new BatchBufferPool(cpu_allocator(), /*max_cached_bytes=*/1 << 20));
+  const void* data = nullptr;
+  {
+    Tensor t;
+    TF_ASSERT_OK(pool->Allocate(DT_FLOAT, TensorShape({4, 8}), &t));
+    EXPECT_EQ(t.dtype(), DT_FLOAT);
+    EXPECT_EQ(t.shape(), TensorShape({4, 8}));
+    t.flat<float>().setConstant(1.0f);
+    data = t.tensor_data().data();
+    EXPECT_EQ(pool->cached_bytes(), 0);
+  }
+  EXPECT_EQ(pool->cached_bytes(), 4 * 8 * sizeof(float));
+
+  // A tensor of the same size, but a different dtype and shape, reuses the
+  // released buffer.
+  Tensor t;
+  TF_ASSERT_OK(pool->Allocate(DT_INT32, TensorShape({32}), &t));
+  EXPECT_EQ(t.tensor_data().data(), data);
+  EXPECT_EQ(pool->cached_bytes(), 0);
+
+  // A tensor of a different size does not.
+  Tensor other;
+  TF_ASSERT_OK(pool->Allocate(DT_INT32, TensorShape({16}), &other));
+  EXPECT_NE(other.tensor_data().data(), data);
+}
+
+TEST(BatchBufferPoolTest, MaxCachedBytes) {
+  core::RefCountPtr<BatchBufferPool> pool(
+      new BatchBufferPool(cpu_allocator(), /*max_cached_bytes=*/100));
+  {
+    Tensor t1, t2;
+    TF_ASSERT_OK(pool->Allocate(DT_UINT8, TensorShape({60}), &t1));
+    TF_ASSERT_OK(pool->Allocate(DT_UINT8, TensorShape({60}), &t2));
+  }
+  EXPECT_EQ(pool->cached_bytes(), 60);
+}
+
+TEST(BatchBufferPoolTest, NonMemcpyTypesAreNotPooled) {
+  core::RefCountPtr<BatchBufferPool> pool(
+      new BatchBufferPool(cpu_allocator(), /*max_cached_bytes=*/1 << 20));
+  {
+    Tensor t;
+    TF_ASSERT_OK(pool->Allocate(DT_STRING, TensorShape({2}), &t));
+    t.vec<tstring>()(0) = "a";
+    t.vec<tstring>()(1) = "b";
+    test::ExpectTensorEqual<tstring>(
+        t, test::AsTensor<tstring>({"a", "b"}, TensorShape({2})));
+  }
+  EXPECT_EQ(pool->cached_bytes(), 0);
+}
+
+TEST(BatchBufferPoolTest, TensorsOutlivePool) {
+  Tensor t;
+  {
+    core::RefCountPtr<BatchBufferPool> pool(
+        new BatchBufferPool(cpu_allocator(), /*max_cached_bytes=*/1 << 20));
+    TF_ASSERT_OK(pool->Allocate(DT_INT64, TensorShape({3}), &t));
+  }
+  t.vec<int64_t>().setConstant(7);
+  test::ExpectTensorEqual<int64_t>(
+      t, test::AsTensor<int64_t>({7, 7, 7}, TensorShape({3})));
+}
+
+}  // namespace
+}  // namespace data
+}  // namespace tensorflow
@@ -751,8 +751,14 @@ Status CopyBatch(CopyBatchParams params,
     TensorShape first_element_shape(first_element.shape());
     TensorShape batch_component_shape({num_batch_elements});
     batch_component_shape.AppendShape(first_element_shape);
-    out_tensors->emplace_back(params.allocator, first_element.dtype(),
-                              batch_component_shape);
+    if (params.buffer_pool != nullptr) {
+      out_tensors->emplace_back();
+      TF_RETURN_IF_ERROR(params.buffer_pool->Allocate(
+          first_element.dtype(), batch_component_shape, &out_tensors->back()));
+    } else {
+      out_tensors->emplace_back(params.allocator, first_element.dtype(),
+                                batch_component_shape);
+    }
     if (!out_tensors->back().IsInitialized()) {
       return errors::ResourceExhausted(
           "Failed to allocate memory for the batch of component ",
@@ -904,11 +910,15 @@ absl::flat_hash_map<string, int64_t> DatasetExperimentRegistry::Experiments() {
 
 namespace {
 
+REGISTER_DATASET_EXPERIMENT("adaptive_interleave_cycle_length", 0);
 REGISTER_DATASET_EXPERIMENT("allow_small_function_optimizations", 0);
+REGISTER_DATASET_EXPERIMENT("auto_cache", 0);
 REGISTER_DATASET_EXPERIMENT(kFilterParallelizationOpt, 50);
 REGISTER_DATASET_EXPERIMENT("inject_prefetch", 100);
+REGISTER_DATASET_EXPERIMENT("map_vectorization", 0);
 REGISTER_DATASET_EXPERIMENT("min_outer_interleave_parallelism", 0);
 REGISTER_DATASET_EXPERIMENT("reduce_interleave_prefetch", 0);
+REGISTER_DATASET_EXPERIMENT("shared_autotune_budget", 0);
 REGISTER_DATASET_EXPERIMENT("stage_based_autotune", 0);
 }  // namespace
 }  // namespace data
@@ -20,6 +20,7 @@ limitations under the License.
 
 #include "absl/container/flat_hash_set.h"
 #include "tensorflow/core/common_runtime/function.h"
+#include "tensorflow/core/data/batch_buffer_pool.h"
 #include "tensorflow/core/framework/dataset.h"
 #include "tensorflow/core/framework/function.h"
 #include "tensorflow/core/framework/resource_handle.h"
@@ -283,6 +284,8 @@ struct CopyBatchParams {
   Allocator* allocator;
   std::function<void(std::function<void()>)>* runner;
   int64 runner_threadpool_size;
+  // If set, the batch is allocated from this pool rather than `allocator`.
+  BatchBufferPool* buffer_pool = nullptr;
 
   explicit CopyBatchParams(IteratorContext* ctx) {
     allocator = ctx->allocator({});
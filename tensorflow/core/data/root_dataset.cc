@@ -17,15 +17,24 @@ limitations under the License.
 
 #include <algorithm>
 #include <functional>
+#include <memory>
 #include <string>
 #include <utility>
 
 #include "tensorflow/core/data/dataset_utils.h"
 #include "tensorflow/core/data/name_utils.h"
 #include "tensorflow/core/data/rewrite_utils.h"
+#include "tensorflow/core/data/step_time_breakdown.h"
+#include "tensorflow/core/framework/allocator.h"
+#include "tensorflow/core/framework/device.h"
+#include "tensorflow/core/framework/function.h"
 #include "tensorflow/core/framework/model.pb.h"
+#include "tensorflow/core/framework/thread_factory.h"
+#include "tensorflow/core/framework/types.h"
+#include "tensorflow/core/lib/gtl/cleanup.h"
 #include "tensorflow/core/platform/errors.h"
 #include "tensorflow/core/platform/host_info.h"
+#include "tensorflow/core/platform/numa.h"
 #include "tensorflow/core/platform/refcount.h"
 #include "tensorflow/core/platform/stringprintf.h"
 
@@ -41,6 +50,7 @@ constexpr char kExperiments[] = "experiments";
 constexpr char kInjectPrefetchEligibleOpt[] = "inject_prefetch_eligible";
 constexpr char kIntraOpParallelism[] = "intra_op_parallelism";
 constexpr char kMemBandwidth[] = "mem_bw_used_megabytes_per_sec";
+constexpr char kNumaNode[] = "numa_node";
 constexpr char kPrivateThreadpoolSize[] = "threadpool_size";
 constexpr char kRamBudget[] = "ram_budget_megabytes";
 constexpr char kRamUsage[] = "ram_usage_megabytes";
@@ -51,6 +61,49 @@ inline int64_t value_or_default(int64_t x, int64_t y, int64_t z) {
   return x == y ? z : x;
 }
 
+// Returns the NUMA node of the device consuming the iterator, or
+// `port::kNUMANoAffinity` if it is unknown.
+int ConsumerNumaNode(IteratorContext* ctx) {
+  if (!port::NUMAEnabled() || ctx->flr() == nullptr ||
+      ctx->flr()->device() == nullptr) {
+    return port::kNUMANoAffinity;
+  }
+  const int numa_node =
+      ctx->flr()->device()->attributes().locality().numa_node();
+  if (numa_node < 0 || numa_node >= port::NUMANumNodes()) {
+    return port::kNUMANoAffinity;
+  }
+  return numa_node;
+}
+
+// A `ThreadFactory` whose threads have affinity to a NUMA node.
+class NumaThreadFactory : public ThreadFactory {
+ public:
+  NumaThreadFactory(std::shared_ptr<ThreadFactory> thread_factory,
+                    int numa_node)
+      : thread_factory_(std::move(thread_factory)), numa_node_(numa_node) {}
+
+  std::unique_ptr<Thread> StartThread(const string& name,
+                                      std::function<void()> fn) override {
+    auto numa_fn = [numa_node = numa_node_, fn = std::move(fn)]() {
+      port::NUMASetThreadNodeAffinity(numa_node);
+      fn();
+      // The thread may be a logical thread that runs on a shared physical
+      // thread, so the affinity is not left behind.
+      port::NUMASetThreadNodeAffinity(port::kNUMANoAffinity);
+    };
+    if (thread_factory_) {
+      return thread_factory_->StartThread(name, std::move(numa_fn));
+    }
+    return std::unique_ptr<Thread>(
+        Env::Default()->StartThread({}, name, std::move(numa_fn)));
+  }
+
+ private:
+  const std::shared_ptr<ThreadFactory> thread_factory_;
+  const int numa_node_;
+};
+
 void SetRootDatasetParams(const Options& options, RootDataset::Params* params) {
   if (ShouldConfigureMaxIntraOpParallelism(options)) {
     params->max_intra_op_parallelism =
@@ -60,6 +113,7 @@ void SetRootDatasetParams(const Options& options, RootDataset::Params* params) {
     params->private_threadpool_size =
         options.threading_options().private_threadpool_size();
   }
+  params->numa_affinity = options.threading_options().numa_affinity();
   params->autotune = ShouldUseAutotuning(options);
   if (params->autotune) {
     params->autotune_algorithm = model::AutotuneAlgorithm::DEFAULT;
@@ -76,6 +130,8 @@ void SetRootDatasetParams(const Options& options, RootDataset::Params* params) {
     params->autotune_ram_budget =
         value_or_default(options.autotune_options().ram_budget(), 0,
                          model::kRamBudgetShare * port::AvailableRam());
+    params->autotune_share_budget =
+        GetExperiments().contains("shared_autotune_budget");
   }
 }
 
@@ -139,46 +195,73 @@ class RootDataset::Iterator : public DatasetIterator<RootDataset> {
       : DatasetIterator<RootDataset>(params) {
     if (dataset()->params_.autotune) {
       model_ = std::make_shared<model::Model>();
+      model_->ram_budget_manager()->SetBudget(
+          dataset()->params_.autotune_ram_budget);
     }
     if (dataset()->params_.max_intra_op_parallelism >= 0) {
       max_intra_op_parallelism_ =
           value_or_default(dataset()->params_.max_intra_op_parallelism, 0,
                            port::MaxParallelism());
     }
-    if (dataset()->params_.private_threadpool_size >= 0) {
-      threadpool_size_ =
-          value_or_default(dataset()->params_.private_threadpool_size, 0,
-                           port::MaxParallelism());
-      thread_pool_ = std::make_unique<thread::ThreadPool>(
-          Env::Default(), ThreadOptions{}, "data_private_threadpool",
-          threadpool_size_);
-    }
     cancellation_manager_ = std::make_unique<CancellationManager>();
   }
 
   ~Iterator() override { cancellation_manager_->StartCancel(); }
 
   Status Initialize(IteratorContext* ctx) override {
+    if (dataset()->params_.numa_affinity) {
+      numa_node_ = ConsumerNumaNode(ctx);
+      VLOG(2) << "Pinning tf.data threads to NUMA node " << numa_node_;
+    }
+    // Pinning the threads of the default runner would also pin threads shared
+    // with other work, so NUMA affinity always uses a private threadpool.
+    if (dataset()->params_.private_threadpool_size >= 0 ||
+        numa_node_ != port::kNUMANoAffinity) {
+      threadpool_size_ =
+          dataset()->params_.private_threadpool_size > 0
+              ? dataset()->params_.private_threadpool_size
+              : port::MaxParallelism(numa_node_);
+      ThreadOptions thread_options;
+      thread_options.numa_node = numa_node_;
+      thread_pool_ = std::make_unique<thread::ThreadPool>(
+          Env::Default(), thread_options, "data_private_threadpool",
+          threadpool_size_);
+    }
+    if (numa_node_ != port::kNUMANoAffinity) {
+      thread_factory_ = std::make_shared<NumaThreadFactory>(
+          ctx->thread_factory(), numa_node_);
+    }
     return dataset()->input_->MakeIterator(IteratorContext(CreateParams(ctx)),
                                            this, prefix(), &input_impl_);
   }
 
   Status GetNextInternal(IteratorContext* ctx, std::vector<Tensor>* out_tensors,
                          bool* end_of_sequence) override {
+    uint64_t gap_time_usec = 0;
     {
       tf_shared_lock l(mu_);
-      if (model_ != nullptr && end_time_usec_ > 0) {
-        model_->RecordIteratorGapTime(ctx->env()->NowMicros() - end_time_usec_);
+      if (end_time_usec_ > 0) {
+        gap_time_usec = ctx->env()->NowMicros() - end_time_usec_;
+        if (model_ != nullptr) model_->RecordIteratorGapTime(gap_time_usec);
       }
     }
     if (dataset()->params_.autotune) {
       TF_RETURN_IF_ERROR(EnsureModelThreadStarted(ctx));
     }
+    const uint64_t start_time_usec = ctx->env()->NowMicros();
     TF_RETURN_IF_ERROR(input_impl_->GetNext(IteratorContext(CreateParams(ctx)),
                                             out_tensors, end_of_sequence));
     {
+      const uint64_t now_usec = ctx->env()->NowMicros();
       mutex_lock l(mu_);
-      end_time_usec_ = std::max(ctx->env()->NowMicros(), end_time_usec_);
+      if (end_time_usec_ > 0 && !*end_of_sequence) {
+        StepTimeTracker::Get()->RecordStep(now_usec - start_time_usec,
+                                           gap_time_usec);
+      }
+      end_time_usec_ = std::max(now_usec, end_time_usec_);
+      if (model_ != nullptr) {
+        model_->RecordConsumerWaitTime(now_usec - start_time_usec);
+      }
     }
     return OkStatus();
   }
@@ -220,6 +303,10 @@ class RootDataset::Iterator : public DatasetIterator<RootDataset> {
                         static_cast<long long>(memory_info.total / 1.0e6),
                         static_cast<double>(100 * memory_usage) /
                             static_cast<double>(memory_info.total))));
+    if (numa_node_ != port::kNUMANoAffinity) {
+      traceme_metadata.push_back(std::make_pair(
+          kNumaNode, strings::Printf("%d", numa_node_)));
+    }
     if (model_node() != nullptr) {
       traceme_metadata.push_back(std::make_pair(
           kMaxBufferBytes,
@@ -236,12 +323,21 @@ class RootDataset::Iterator : public DatasetIterator<RootDataset> {
     if (dataset()->params_.autotune) {
       params.model = model_;
     }
-    if (dataset()->params_.private_threadpool_size >= 0) {
+    if (thread_pool_) {
       params.runner = [pool = thread_pool_.get()](std::function<void()> c) {
         pool->Schedule(std::move(c));
       };
       params.runner_threadpool_size = threadpool_size_;
     }
+    if (numa_node_ != port::kNUMANoAffinity) {
+      params.thread_factory = thread_factory_;
+      if (ctx->flr()->device()->device_type() == DEVICE_CPU) {
+        params.allocator_getter = [numa_node = numa_node_](
+                                      AllocatorAttributes attrs) {
+          return cpu_allocator(numa_node);
+        };
+      }
+    }
     if (dataset()->params_.max_intra_op_parallelism >= 0) {
       params.runner =
           RunnerWithMaxParallelism(params.runner, max_intra_op_parallelism_);
@@ -254,6 +350,12 @@ class RootDataset::Iterator : public DatasetIterator<RootDataset> {
     mutex_lock l(mu_);
     if (!model_thread_) {
       model_thread_ = ctx->StartThread("tf_data_model", [this]() {
+        if (dataset()->params_.autotune_share_budget) {
+          model::ModelCoordinator::Global()->Register(model_.get());
+        }
+        auto unregister = gtl::MakeCleanup([this]() {
+          model::ModelCoordinator::Global()->Unregister(model_.get());
+        });
         Status status =
             model_->OptimizeLoop(dataset()->params_.autotune_algorithm,
                                  dataset()->params_.autotune_cpu_budget,
@@ -276,6 +378,10 @@ class RootDataset::Iterator : public DatasetIterator<RootDataset> {
   int64_t max_intra_op_parallelism_;
   int64_t threadpool_size_;
   std::unique_ptr<thread::ThreadPool> thread_pool_;
+  // The NUMA node that the threads and elements of the iterator have affinity
+  // to, if `numa_affinity` is set.
+  int numa_node_ = port::kNUMANoAffinity;
+  std::shared_ptr<ThreadFactory> thread_factory_;
 
   // The end time of the previous `GetNextInternal` call.
   uint64_t end_time_usec_ TF_GUARDED_BY(mu_) = 0;
@@ -32,8 +32,12 @@ class RootDataset : public DatasetBase {
     model::AutotuneAlgorithm autotune_algorithm;
     int64_t autotune_cpu_budget = 0;
     int64_t autotune_ram_budget = 0;
+    // Whether to share the CPU and RAM budgets with the other input pipelines
+    // of the process through the global `model::ModelCoordinator`.
+    bool autotune_share_budget = false;
     int64_t max_intra_op_parallelism = 1;
     int64_t private_threadpool_size = 0;
+    bool numa_affinity = false;
   };
 
   static Status FromOptions(const DatasetBase* input, DatasetBase** output);
@@ -0,0 +1,81 @@
+/* Copyright 2022 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/data/service/auto_scaler.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <string>
+
+namespace tensorflow {
+namespace data {
+
+void AutoScaler::ReportTargetProcessingTime(int64_t client_id,
+                                            double target_processing_time_nsec,
+                                            int64_t now_micros) {
+  if (target_processing_time_nsec <= 0.0) {
+    return;
+  }
+  consumers_[client_id] = Report{target_processing_time_nsec, now_micros};
+}
+
+void AutoScaler::ReportProcessingTime(const std::string& worker_address,
+                                      double processing_time_nsec,
+                                      int64_t now_micros) {
+  if (processing_time_nsec <= 0.0) {
+    return;
+  }
+  workers_[worker_address] = Report{processing_time_nsec, now_micros};
+}
+
+void AutoScaler::RemoveConsumer(int64_t client_id) {
+  consumers_.erase(client_id);
+}
+
+void AutoScaler::RemoveWorker(const std::string& worker_address) {
+  workers_.erase(worker_address);
+}
+
+bool AutoScaler::IsFresh(const Report& report, int64_t now_micros) const {
+  return now_micros - report.reported_micros <= report_timeout_micros_;
+}
+
+int64_t AutoScaler::GetOptimalNumberOfWorkers(int64_t now_micros) const {
+  // Elements per nanosecond requested by all clients.
+  double consumption_rate = 0.0;
+  for (const auto& [client_id, report] : consumers_) {
+    if (IsFresh(report, now_micros)) {
+      consumption_rate += 1.0 / report.time_nsec;
+    }
+  }
+  // Average elements per nanosecond produced by a worker.
+  double worker_rate = 0.0;
+  int64_t num_workers = 0;
+  for (const auto& [address, report] : workers_) {
+    if (IsFresh(report, now_micros)) {
+      worker_rate += 1.0 / report.time_nsec;
+      ++num_workers;
+    }
+  }
+  if (consumption_rate == 0.0 || num_workers == 0) {
+    return 0;
+  }
+  worker_rate /= num_workers;
+  return std::max<int64_t>(
+      1, static_cast<int64_t>(std::ceil(consumption_rate / worker_rate)));
+}
+
+}  // namespace data
+}  // namespace tensorflow
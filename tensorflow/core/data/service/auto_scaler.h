@@ -0,0 +1,87 @@
+/* Copyright 2022 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_CORE_DATA_SERVICE_AUTO_SCALER_H_
+#define TENSORFLOW_CORE_DATA_SERVICE_AUTO_SCALER_H_
+
+#include <cstdint>
+#include <string>
+
+#include "absl/container/flat_hash_map.h"
+
+namespace tensorflow {
+namespace data {
+
+// Estimates how many tf.data service workers are needed to keep up with the
+// clients that consume from them.
+//
+// Each client reports its target processing time: the average time between
+// its requests for elements. Each worker reports its processing time: the
+// average time it takes to produce an element. The optimal number of workers
+// is the number needed for the aggregate worker throughput to match the
+// aggregate consumption rate:
+//
+//   ceil(sum_clients(1 / target_processing_time) /
+//        mean_workers(1 / processing_time))
+//
+// Reports that have not been refreshed within `report_timeout_micros` are
+// treated as stale and ignored, so clients and workers that go away stop
+// affecting the recommendation.
+//
+// This class is not thread-safe.
+class AutoScaler {
+ public:
+  explicit AutoScaler(int64_t report_timeout_micros)
+      : report_timeout_micros_(report_timeout_micros) {}
+
+  // Records the target processing time of client `client_id` at `now_micros`.
+  // Non-positive times are ignored.
+  void ReportTargetProcessingTime(int64_t client_id,
+                                  double target_processing_time_nsec,
+                                  int64_t now_micros);
+
+  // Records the processing time of `worker_address` at `now_micros`.
+  // Non-positive times are ignored.
+  void ReportProcessingTime(const std::string& worker_address,
+                            double processing_time_nsec, int64_t now_micros);
+
+  // Forgets the reports of `client_id`.
+  void RemoveConsumer(int64_t client_id);
+
+  // Forgets the reports of `worker_address`.
+  void RemoveWorker(const std::string& worker_address);
+
+  // Returns the optimal number of workers at `now_micros`, or 0 if there are
+  // no fresh reports from either clients or workers.
+  int64_t GetOptimalNumberOfWorkers(int64_t now_micros) const;
+
+ private:
+  struct Report {
+    double time_nsec = 0.0;
+    int64_t reported_micros = 0;
+  };
+
+  bool IsFresh(const Report& report, int64_t now_micros) const;
+
+  const int64_t report_timeout_micros_;
+  // Target processing times, keyed by client id.
+  absl::flat_hash_map<int64_t, Report> consumers_;
+  // Processing times, keyed by worker address.
+  absl::flat_hash_map<std::string, Report> workers_;
+};
+
+}  // namespace data
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_DATA_SERVICE_AUTO_SCALER_H_
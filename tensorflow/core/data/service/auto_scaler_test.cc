@@ -0,0 +1,95 @@
+/* Copyright 2022 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/data/service/auto_scaler.h"
+
+#include <cstdint>
+
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace data {
+namespace {
+
+constexpr int64_t kTimeoutMicros = 60 * 1000 * 1000;
+
+TEST(AutoScalerTest, NoReports) {
+  AutoScaler auto_scaler(kTimeoutMicros);
+  EXPECT_EQ(auto_scaler.GetOptimalNumberOfWorkers(/*now_micros=*/0), 0);
+}
+
+TEST(AutoScalerTest, NoWorkerReports) {
+  AutoScaler auto_scaler(kTimeoutMicros);
+  auto_scaler.ReportTargetProcessingTime(/*client_id=*/1, 1000.0, 0);
+  EXPECT_EQ(auto_scaler.GetOptimalNumberOfWorkers(0), 0);
+}
+
+TEST(AutoScalerTest, SingleConsumer) {
+  AutoScaler auto_scaler(kTimeoutMicros);
+  // The client wants an element every 1us, a worker produces one every 3.5us.
+  auto_scaler.ReportTargetProcessingTime(/*client_id=*/1, 1000.0, 0);
+  auto_scaler.ReportProcessingTime("worker", 3500.0, 0);
+  EXPECT_EQ(auto_scaler.GetOptimalNumberOfWorkers(0), 4);
+}
+
+TEST(AutoScalerTest, MultipleConsumersAndWorkers) {
+  AutoScaler auto_scaler(kTimeoutMicros);
+  // 3 elements per us are requested.
+  auto_scaler.ReportTargetProcessingTime(/*client_id=*/1, 1000.0, 0);
+  auto_scaler.ReportTargetProcessingTime(/*client_id=*/2, 500.0, 0);
+  // An average worker produces 0.5 elements per us.
+  auto_scaler.ReportProcessingTime("worker_1", 1000.0, 0);
+  auto_scaler.ReportProcessingTime("worker_2", 1.0e10, 0);
+  EXPECT_EQ(auto_scaler.GetOptimalNumberOfWorkers(0), 6);
+}
+
+TEST(AutoScalerTest, OverprovisionedRecommendsOneWorker) {
+  AutoScaler auto_scaler(kTimeoutMicros);
+  auto_scaler.ReportTargetProcessingTime(/*client_id=*/1, 1.0e9, 0);
+  auto_scaler.ReportProcessingTime("worker_1", 1000.0, 0);
+  auto_scaler.ReportProcessingTime("worker_2", 1000.0, 0);
+  EXPECT_EQ(auto_scaler.GetOptimalNumberOfWorkers(0), 1);
+}
+
+TEST(AutoScalerTest, IgnoreStaleReports) {
+  AutoScaler auto_scaler(kTimeoutMicros);
+  auto_scaler.ReportTargetProcessingTime(/*client_id=*/1, 1000.0, 0);
+  auto_scaler.ReportTargetProcessingTime(/*client_id=*/2, 1000.0,
+                                         kTimeoutMicros);
+  auto_scaler.ReportProcessingTime("worker", 1000.0, kTimeoutMicros);
+  EXPECT_EQ(auto_scaler.GetOptimalNumberOfWorkers(kTimeoutMicros), 2);
+  EXPECT_EQ(auto_scaler.GetOptimalNumberOfWorkers(kTimeoutMicros + 1), 1);
+}
+
+TEST(AutoScalerTest, RemoveConsumerAndWorker) {
+  AutoScaler auto_scaler(kTimeoutMicros);
+  auto_scaler.ReportTargetProcessingTime(/*client_id=*/1, 1000.0, 0);
+  auto_scaler.ReportTargetProcessingTime(/*client_id=*/2, 1000.0, 0);
+  auto_scaler.ReportProcessingTime("worker", 1000.0, 0);
+  auto_scaler.RemoveConsumer(1);
+  EXPECT_EQ(auto_scaler.GetOptimalNumberOfWorkers(0), 1);
+  auto_scaler.RemoveWorker("worker");
+  EXPECT_EQ(auto_scaler.GetOptimalNumberOfWorkers(0), 0);
+}
+
+TEST(AutoScalerTest, IgnoreNonPositiveTimes) {
+  AutoScaler auto_scaler(kTimeoutMicros);
+  auto_scaler.ReportTargetProcessingTime(/*client_id=*/1, 0.0, 0);
+  auto_scaler.ReportProcessingTime("worker", -1.0, 0);
+  EXPECT_EQ(auto_scaler.GetOptimalNumberOfWorkers(0), 0);
+}
+
+}  // namespace
+}  // namespace data
+}  // namespace tensorflow
@@ -267,6 +267,15 @@ TEST(DataServiceTest, GetWorkers) {
   EXPECT_EQ(1, workers.size());
 }
 
+TEST(DataServiceTest, GetOptimalNumberOfWorkersWithoutClients) {
+  TestCluster cluster(1);
+  TF_ASSERT_OK(cluster.Initialize());
+  DataServiceDispatcherClient dispatcher(cluster.DispatcherAddress(), "grpc");
+  int64_t optimal_number_of_workers = -1;
+  TF_EXPECT_OK(dispatcher.GetOptimalNumberOfWorkers(optimal_number_of_workers));
+  EXPECT_EQ(optimal_number_of_workers, 0);
+}
+
 TEST(DataServiceTest, DispatcherStateExport) {
   TestCluster cluster(1);
   TF_ASSERT_OK(cluster.Initialize());
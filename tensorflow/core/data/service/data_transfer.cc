@@ -19,6 +19,8 @@ limitations under the License.
 #include <memory>
 #include <string>
 #include <unordered_map>
+#include <utility>
+#include <vector>
 
 #include "absl/strings/str_join.h"
 #include "tensorflow/core/data/dataset.pb.h"
@@ -53,6 +55,24 @@ DataTransferClientFactories& transfer_client_factories() {
   static auto& factories = *new DataTransferClientFactories();
   return factories;
 }
+
+size_t EstimatedElementBytes(const std::vector<Tensor>& element) {
+  size_t size_bytes = element.size() * sizeof(Tensor);
+  for (const Tensor& tensor : element) {
+    size_bytes += tensor.TotalBytes();
+    if (tensor.dtype() != DT_VARIANT) {
+      continue;
+    }
+
+    // Estimates the memory usage of a compressed element.
+    const Variant& variant = tensor.scalar<Variant>()();
+    const CompressedElement* compressed = variant.get<CompressedElement>();
+    if (compressed) {
+      size_bytes += compressed->SpaceUsedLong();
+    }
+  }
+  return size_bytes;
+}
 }  // namespace
 
 GetElementResult GetElementResult::Copy() const {
@@ -61,27 +81,58 @@ GetElementResult GetElementResult::Copy() const {
   copy.element_index = element_index;
   copy.end_of_sequence = end_of_sequence;
   copy.skip = skip;
+  copy.additional_elements = additional_elements;
   return copy;
 }
 
 size_t GetElementResult::EstimatedMemoryUsageBytes() const {
-  size_t size_bytes = components.size() * sizeof(Tensor) +
-                      sizeof(element_index) + sizeof(end_of_sequence) +
-                      sizeof(skip);
-  for (const Tensor& tensor : components) {
-    size_bytes += tensor.TotalBytes();
-    if (tensor.dtype() != DT_VARIANT) {
-      continue;
-    }
+  size_t size_bytes = sizeof(element_index) + sizeof(end_of_sequence) +
+                      sizeof(skip) + EstimatedElementBytes(components);
+  for (const std::vector<Tensor>& element : additional_elements) {
+    size_bytes += EstimatedElementBytes(element);
+  }
+  return size_bytes;
+}
 
-    // Estimates the memory usage of a compressed element.
-    const Variant& variant = tensor.scalar<Variant>()();
-    const CompressedElement* compressed = variant.get<CompressedElement>();
-    if (compressed) {
-      size_bytes += compressed->SpaceUsedLong();
+int64_t BatchSize(const GetElementResult& result) {
+  return 1 + result.additional_elements.size();
+}
+
+std::vector<Tensor> FlattenBatch(GetElementResult& result) {
+  std::vector<Tensor> components = std::move(result.components);
+  for (std::vector<Tensor>& element : result.additional_elements) {
+    for (Tensor& component : element) {
+      components.push_back(std::move(component));
     }
   }
-  return size_bytes;
+  result.components.clear();
+  result.additional_elements.clear();
+  return components;
+}
+
+Status UnflattenBatch(std::vector<Tensor> components, int64_t batch_size,
+                      GetElementResult& result) {
+  if (batch_size <= 1) {
+    result.components = std::move(components);
+    return OkStatus();
+  }
+  if (components.size() % batch_size != 0) {
+    return errors::Internal("Expected a batch of ", batch_size,
+                            " elements, but got ", components.size(),
+                            " components.");
+  }
+  const size_t num_components = components.size() / batch_size;
+  result.components.assign(
+      std::make_move_iterator(components.begin()),
+      std::make_move_iterator(components.begin() + num_components));
+  result.additional_elements.resize(batch_size - 1);
+  for (int64_t i = 1; i < batch_size; ++i) {
+    auto begin = components.begin() + i * num_components;
+    result.additional_elements[i - 1].assign(
+        std::make_move_iterator(begin),
+        std::make_move_iterator(begin + num_components));
+  }
+  return OkStatus();
 }
 
 void DataTransferServer::Register(
@@ -60,8 +60,22 @@ struct GetElementResult {
   // reading from the worker. This is used for load balancing when doing round
   // robin reads.
   bool skip = false;
+  // Elements following `components` in a batched response, in order. Their
+  // element indices follow `element_index`.
+  std::vector<std::vector<Tensor>> additional_elements;
 };
 
+// Returns the number of elements held by `result`.
+int64_t BatchSize(const GetElementResult& result);
+
+// Moves the components of all elements in `result` into one vector, in order.
+std::vector<Tensor> FlattenBatch(GetElementResult& result);
+
+// Splits `components`, the concatenated components of `batch_size` elements,
+// into `result.components` and `result.additional_elements`.
+Status UnflattenBatch(std::vector<Tensor> components, int64_t batch_size,
+                      GetElementResult& result);
+
 // Client for communicating with the tf.data service transfer server.
 class DataTransferClient {
  public:
@@ -111,6 +111,34 @@ TEST(DataTransferTest, CopyGetElementResult) {
             result.EstimatedMemoryUsageBytes());
 }
 
+TEST(DataTransferTest, FlattenAndUnflattenBatch) {
+  GetElementResult result;
+  result.components = {Tensor(int64_t{0}), Tensor(tstring("a"))};
+  result.additional_elements = {{Tensor(int64_t{1}), Tensor(tstring("b"))},
+                                {Tensor(int64_t{2}), Tensor(tstring("c"))}};
+  EXPECT_EQ(BatchSize(result), 3);
+  std::vector<Tensor> components = FlattenBatch(result);
+  ASSERT_EQ(components.size(), 6);
+  EXPECT_TRUE(result.additional_elements.empty());
+
+  GetElementResult unflattened;
+  TF_ASSERT_OK(
+      UnflattenBatch(std::move(components), /*batch_size=*/3, unflattened));
+  ASSERT_EQ(BatchSize(unflattened), 3);
+  test::ExpectEqual(unflattened.components[0], Tensor(int64_t{0}));
+  test::ExpectEqual(unflattened.components[1], Tensor(tstring("a")));
+  test::ExpectEqual(unflattened.additional_elements[1][0], Tensor(int64_t{2}));
+  test::ExpectEqual(unflattened.additional_elements[1][1],
+                    Tensor(tstring("c")));
+}
+
+TEST(DataTransferTest, UnflattenBatchWithMismatchedComponents) {
+  std::vector<Tensor> components(5, Tensor(int64_t{0}));
+  GetElementResult result;
+  EXPECT_FALSE(
+      UnflattenBatch(std::move(components), /*batch_size=*/2, result).ok());
+}
+
 }  // namespace
 }  // namespace data
 }  // namespace tensorflow
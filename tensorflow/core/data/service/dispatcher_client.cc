@@ -92,6 +92,7 @@ Status DataServiceDispatcherClient::GetDatasetDef(const std::string& dataset_id,
 Status DataServiceDispatcherClient::GetSplit(int64_t iteration_id,
                                              int64_t repetition,
                                              int64_t split_provider_index,
+                                             const std::string& worker_address,
                                              Tensor& split,
                                              bool& end_of_splits) {
   TF_RETURN_IF_ERROR(EnsureInitialized());
@@ -99,6 +100,7 @@ Status DataServiceDispatcherClient::GetSplit(int64_t iteration_id,
   req.set_iteration_id(iteration_id);
   req.set_repetition(repetition);
   req.set_split_provider_index(split_provider_index);
+  req.set_worker_address(worker_address);
   GetSplitResponse resp;
   grpc::ClientContext client_ctx;
   grpc::Status status = stub_->GetSplit(&client_ctx, req, &resp);
@@ -245,6 +247,20 @@ Status DataServiceDispatcherClient::GetWorkers(
   return OkStatus();
 }
 
+Status DataServiceDispatcherClient::GetOptimalNumberOfWorkers(
+    int64_t& optimal_number_of_workers) {
+  TF_RETURN_IF_ERROR(EnsureInitialized());
+  GetOptimalNumberOfWorkersRequest req;
+  GetOptimalNumberOfWorkersResponse resp;
+  grpc::ClientContext ctx;
+  grpc::Status s = stub_->GetOptimalNumberOfWorkers(&ctx, req, &resp);
+  if (!s.ok()) {
+    return grpc_util::WrapError("Failed to get optimal number of workers", s);
+  }
+  optimal_number_of_workers = resp.optimal_number_of_workers();
+  return OkStatus();
+}
+
 Status DataServiceDispatcherClient::GetDataServiceMetadata(
     const std::string& dataset_id, DataServiceMetadata& metadata) {
   TF_RETURN_IF_ERROR(EnsureInitialized());
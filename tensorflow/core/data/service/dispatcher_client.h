@@ -61,9 +61,10 @@ class DataServiceDispatcherClient : public DataServiceClientBase {
   Status GetDatasetDef(const std::string& dataset_id, DatasetDef& dataset_def);
 
   // Gets the next split for the specified iteration id, repetition, and split
-  // provider index.
+  // provider index. `worker_address` identifies the requesting worker.
   Status GetSplit(int64_t iteration_id, int64_t repetition,
-                  int64_t split_provider_index, Tensor& split,
+                  int64_t split_provider_index,
+                  const std::string& worker_address, Tensor& split,
                   bool& end_of_splits);
 
   // Registers a dataset with the tf.data service, and stores the generated
@@ -108,6 +109,11 @@ class DataServiceDispatcherClient : public DataServiceClientBase {
   // stored in `workers`.
   Status GetWorkers(std::vector<WorkerInfo>& workers);
 
+  // Queries the dispatcher for the number of workers needed to meet the
+  // demand of its clients. The result is stored in `optimal_number_of_workers`.
+  // It is 0 if the dispatcher has not received enough heartbeats yet.
+  Status GetOptimalNumberOfWorkers(int64_t& optimal_number_of_workers);
+
   // Returns data service metadata for the registered dataset.
   Status GetDataServiceMetadata(const std::string& dataset_id,
                                 DataServiceMetadata& metadata);
@@ -16,6 +16,7 @@ limitations under the License.
 #include "tensorflow/core/data/service/dispatcher_impl.h"
 
 #include <algorithm>
+#include <chrono>  // NOLINT
 #include <memory>
 #include <string>
 #include <utility>
@@ -43,6 +44,7 @@ limitations under the License.
 #include "tensorflow/core/data/service/export.pb.h"
 #include "tensorflow/core/data/service/grpc_util.h"
 #include "tensorflow/core/data/service/journal.h"
+#include "tensorflow/core/data/service/journal.pb.h"
 #include "tensorflow/core/data/service/worker.grpc.pb.h"
 #include "tensorflow/core/data/standalone.h"
 #include "tensorflow/core/framework/dataset.h"
@@ -74,10 +76,14 @@ using ::tensorflow::protobuf::util::MessageDifferencer;
 constexpr char kJournalDir[] = "tf_data_dispatcher_journal";
 // The name of the datasets directory inside the dispatcher's working directory.
 constexpr char kDatasetsDir[] = "datasets";
+// The name of the state checkpoint directory inside the dispatcher's working
+// directory.
+constexpr char kCheckpointDir[] = "tf_data_dispatcher_checkpoints";
 constexpr int64_t kDefaultIterationGcCheckIntervalMs =
     10 * 60 * 1000;                                              // 10 minutes.
 constexpr int64_t kDefaultIterationGcTimeoutMs = 5 * 60 * 1000;  // 5 minutes.
 constexpr int64_t kDefaultClientTimeoutMs = 2 * 60 * 1000;       // 2 minutes.
+constexpr int64_t kDefaultStateCheckpointIntervalUpdates = 10000;
 
 constexpr std::array<const char*, 8> kNodeNameSharingOps = {
     "HashTable",
@@ -106,6 +112,10 @@ std::string DatasetsDir(const std::string& work_dir) {
   return io::JoinPath(work_dir, kDatasetsDir);
 }
 
+std::string CheckpointDir(const std::string& work_dir) {
+  return io::JoinPath(work_dir, kCheckpointDir);
+}
+
 std::string DatasetKey(const std::string& dataset_id, uint64 fingerprint) {
   return absl::StrCat("id_", dataset_id, "_fp_", fingerprint);
 }
@@ -150,6 +160,10 @@ DispatcherConfig ApplyConfigDefaults(const DispatcherConfig& config) {
   if (new_config.client_timeout_ms() == 0) {
     new_config.set_client_timeout_ms(kDefaultClientTimeoutMs);
   }
+  if (new_config.state_checkpoint_interval_updates() == 0) {
+    new_config.set_state_checkpoint_interval_updates(
+        kDefaultStateCheckpointIntervalUpdates);
+  }
   return new_config;
 }
 
@@ -166,6 +180,7 @@ DataServiceDispatcherImpl::DataServiceDispatcherImpl(
     const DispatcherConfig& config)
     : config_(ApplyConfigDefaults(config)),
       env_(Env::Default()),
+      auto_scaler_(config_.client_timeout_ms() * 1000),
       state_(config_) {
   if (config_.work_dir().empty()) {
     dataset_store_ = std::make_unique<MemoryDatasetStore>();
@@ -180,6 +195,7 @@ DataServiceDispatcherImpl::~DataServiceDispatcherImpl() {
     mutex_lock l(mu_);
     cancelled_ = true;
     iteration_gc_thread_cv_.notify_all();
+    split_produced_cv_.notify_all();
   }
   iteration_gc_thread_.reset();
 }
@@ -209,12 +225,26 @@ Status DataServiceDispatcherImpl::Start() {
       std::make_unique<FileJournalWriter>(env_, JournalDir(config_.work_dir()));
   LOG(INFO) << "Attempting to restore dispatcher state from journal in "
             << JournalDir(config_.work_dir());
+  DispatcherStateCheckpoint checkpoint;
+  int64_t checkpoint_sequence_number = -1;
+  TF_RETURN_IF_ERROR(ReadLatestDispatcherStateCheckpoint(
+      env_, CheckpointDir(config_.work_dir()), checkpoint,
+      checkpoint_sequence_number));
+  if (checkpoint_sequence_number >= 0) {
+    TF_RETURN_IF_ERROR(state_.RestoreCheckpoint(checkpoint));
+    LOG(INFO) << "Restored dispatcher state from checkpoint "
+              << DataServiceCheckpointFile(CheckpointDir(config_.work_dir()),
+                                           checkpoint_sequence_number);
+  }
   Update update;
   bool end_of_journal = false;
-  FileJournalReader reader(env_, JournalDir(config_.work_dir()));
+  FileJournalReader reader(env_, JournalDir(config_.work_dir()),
+                           std::max<int64_t>(checkpoint_sequence_number, 0));
   Status s = reader.Read(update, end_of_journal);
   if (errors::IsNotFound(s)) {
-    LOG(INFO) << "No journal found. Starting dispatcher from new state.";
+    if (checkpoint_sequence_number < 0) {
+      LOG(INFO) << "No journal found. Starting dispatcher from new state.";
+    }
   } else if (!s.ok()) {
     return s;
   } else {
@@ -360,6 +390,10 @@ Status DataServiceDispatcherImpl::WorkerHeartbeat(
       FindTasksToDelete(current_tasks, assigned_tasks, response));
   TF_RETURN_IF_ERROR(
       FindNewTasks(worker_address, current_tasks, assigned_tasks, response));
+  auto_scaler_.ReportProcessingTime(
+      worker_address, request->processing_time_nsec(), env_->NowMicros());
+  metrics::RecordTFDataServiceOptimalNumberOfWorkers(
+      auto_scaler_.GetOptimalNumberOfWorkers(env_->NowMicros()));
 
   VLOG(4) << "Finished worker heartbeat for worker at address "
           << request->worker_address();
@@ -419,6 +453,12 @@ Status DataServiceDispatcherImpl::GetSplit(const GetSplitRequest* request,
         "Cannot get split for iteration ", iteration_id,
         ", since it is not a distributed_epoch iteration.");
   }
+  if (config_.load_aware_split_assignment() &&
+      !request->worker_address().empty()) {
+    split_assignment_tracker_.RecordSplitRequest(
+        iteration_id, request->worker_address(), env_->NowMicros());
+    DeferStragglerSplitRequest(*request, *iteration, l);
+  }
   int64_t current_repetition =
       iteration->distributed_epoch_state.value().repetitions[provider_index];
   if (repetition < current_repetition) {
@@ -434,9 +474,15 @@ Status DataServiceDispatcherImpl::GetSplit(const GetSplitRequest* request,
   Tensor split;
   bool end_of_splits = false;
   TF_RETURN_IF_ERROR(split_provider->GetNext(&split, &end_of_splits));
+  if (end_of_splits) {
+    split_assignment_tracker_.RecordNumSplits(
+        iteration->job->dataset_id, provider_index,
+        iteration->distributed_epoch_state.value().indices[provider_index]);
+  }
   TF_RETURN_IF_ERROR(RecordSplitProduced(iteration_id, repetition,
                                          request->split_provider_index(),
                                          end_of_splits));
+  split_produced_cv_.notify_all();
   response->set_end_of_splits(end_of_splits);
   if (end_of_splits) {
     // Reset the split provider to prepare for the next iteration.
@@ -448,6 +494,38 @@ Status DataServiceDispatcherImpl::GetSplit(const GetSplitRequest* request,
   return OkStatus();
 }
 
+void DataServiceDispatcherImpl::DeferStragglerSplitRequest(
+    const GetSplitRequest& request, const Iteration& iteration,
+    mutex_lock& l) TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+  const int64_t provider_index = request.split_provider_index();
+  const DispatcherState::DistributedEpochState& epoch_state =
+      iteration.distributed_epoch_state.value();
+  if (request.repetition() < epoch_state.repetitions[provider_index]) {
+    return;
+  }
+  const int64_t deferral_micros = split_assignment_tracker_.DeferralMicros(
+      iteration.iteration_id, iteration.job->dataset_id, provider_index,
+      epoch_state.indices[provider_index], request.worker_address());
+  if (deferral_micros == 0) {
+    return;
+  }
+  VLOG(2) << "Deferring split request from straggler worker "
+          << request.worker_address() << " by " << deferral_micros
+          << " microseconds to let faster workers finish iteration "
+          << iteration.iteration_id;
+  const int64_t deadline_micros = env_->NowMicros() + deferral_micros;
+  // Wait until the deadline passes, or faster workers finish the repetition.
+  while (!cancelled_ &&
+         request.repetition() >= epoch_state.repetitions[provider_index]) {
+    const int64_t now_micros = env_->NowMicros();
+    if (now_micros >= deadline_micros) {
+      break;
+    }
+    split_produced_cv_.wait_for(
+        l, std::chrono::microseconds(deadline_micros - now_micros));
+  }
+}
+
 Status DataServiceDispatcherImpl::MakeSplitProviders(
     const std::string& dataset_id,
     std::vector<std::unique_ptr<SplitProvider>>& split_providers)
@@ -659,6 +737,7 @@ Status DataServiceDispatcherImpl::ReleaseIterationClient(
   release_iteration_client->set_iteration_client_id(iteration_client_id);
   release_iteration_client->set_time_micros(env_->NowMicros());
   TF_RETURN_IF_ERROR(Apply(update));
+  auto_scaler_.RemoveConsumer(iteration_client_id);
   return OkStatus();
 }
 
@@ -924,6 +1003,9 @@ Status DataServiceDispatcherImpl::ClientHeartbeat(
         "Consider configuring the dispatcher with a higher "
         "`iteration_gc_timeout_ms`.");
   }
+  auto_scaler_.ReportTargetProcessingTime(
+      request->iteration_client_id(), request->target_processing_time_nsec(),
+      env_->NowMicros());
   if (request->optional_current_round_case() ==
       ClientHeartbeatRequest::kCurrentRound) {
     round_robin_rounds_[request->iteration_client_id()] =
@@ -1008,6 +1090,18 @@ Status DataServiceDispatcherImpl::GetWorkers(const GetWorkersRequest* request,
   return OkStatus();
 }
 
+Status DataServiceDispatcherImpl::GetOptimalNumberOfWorkers(
+    const GetOptimalNumberOfWorkersRequest* request,
+    GetOptimalNumberOfWorkersResponse* response) {
+  TF_RETURN_IF_ERROR(CheckStarted());
+  mutex_lock l(mu_);
+  const int64_t optimal_number_of_workers =
+      auto_scaler_.GetOptimalNumberOfWorkers(env_->NowMicros());
+  metrics::RecordTFDataServiceOptimalNumberOfWorkers(optimal_number_of_workers);
+  response->set_optimal_number_of_workers(optimal_number_of_workers);
+  return OkStatus();
+}
+
 Status DataServiceDispatcherImpl::PopulateTaskDef(
     std::shared_ptr<const Task> task, TaskDef* task_def) const
     TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
@@ -1079,7 +1173,37 @@ Status DataServiceDispatcherImpl::Apply(const Update& update)
   if (journal_writer_.has_value()) {
     TF_RETURN_IF_ERROR(journal_writer_.value()->Write(update));
   }
-  return state_.Apply(update);
+  TF_RETURN_IF_ERROR(state_.Apply(update));
+  if (journal_writer_.has_value() &&
+      config_.state_checkpoint_interval_updates() > 0 &&
+      ++updates_since_checkpoint_ >=
+          config_.state_checkpoint_interval_updates()) {
+    Status s = CheckpointState();
+    if (!s.ok()) {
+      LOG(WARNING) << "Failed to checkpoint dispatcher state: " << s
+                   << ". The journal will be truncated at the next checkpoint.";
+    }
+  }
+  return OkStatus();
+}
+
+Status DataServiceDispatcherImpl::CheckpointState()
+    TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+  updates_since_checkpoint_ = 0;
+  // Updates are written to the new journal file from now on, so the
+  // checkpoint covers exactly the journal files before it.
+  TF_ASSIGN_OR_RETURN(int64_t sequence_number,
+                      journal_writer_.value()->StartNewFile());
+  DispatcherStateCheckpoint checkpoint;
+  state_.ExportCheckpoint(checkpoint);
+  const std::string checkpoint_dir = CheckpointDir(config_.work_dir());
+  TF_RETURN_IF_ERROR(WriteDispatcherStateCheckpoint(
+      env_, checkpoint_dir, sequence_number, checkpoint));
+  TF_RETURN_IF_ERROR(TruncateJournal(env_, JournalDir(config_.work_dir()),
+                                     checkpoint_dir, sequence_number));
+  VLOG(1) << "Checkpointed dispatcher state before journal file "
+          << sequence_number;
+  return OkStatus();
 }
 
 void DataServiceDispatcherImpl::IterationGcThread() {
@@ -1126,6 +1250,7 @@ Status DataServiceDispatcherImpl::ReleaseMissingClients()
       release_client->set_iteration_client_id(client_id);
       release_client->set_time_micros(now);
       TF_RETURN_IF_ERROR(Apply(update));
+      auto_scaler_.RemoveConsumer(client_id);
     }
   }
   return OkStatus();
@@ -1147,6 +1272,7 @@ Status DataServiceDispatcherImpl::GcOldIterations()
     update.mutable_garbage_collect_iteration()->set_iteration_id(
         iteration->iteration_id);
     TF_RETURN_IF_ERROR(state_.Apply(update));
+    split_assignment_tracker_.RemoveIteration(iteration->iteration_id);
     LOG(INFO) << "Garbage collected iteration " << iteration->DebugString();
   }
   return OkStatus();
@@ -24,12 +24,14 @@ limitations under the License.
 #include "absl/container/flat_hash_set.h"
 #include "absl/time/time.h"
 #include "absl/types/optional.h"
+#include "tensorflow/core/data/service/auto_scaler.h"
 #include "tensorflow/core/data/service/common.h"
 #include "tensorflow/core/data/service/common.pb.h"
 #include "tensorflow/core/data/service/dataset_store.h"
 #include "tensorflow/core/data/service/dispatcher.pb.h"
 #include "tensorflow/core/data/service/dispatcher_state.h"
 #include "tensorflow/core/data/service/export.pb.h"
+#include "tensorflow/core/data/service/split_assignment_tracker.h"
 #include "tensorflow/core/data/service/task_remover.h"
 #include "tensorflow/core/data/service/worker.grpc.pb.h"
 #include "tensorflow/core/framework/dataset.h"
@@ -174,6 +176,9 @@ class DataServiceDispatcherImpl {
                          ClientHeartbeatResponse* response);
   Status GetWorkers(const GetWorkersRequest* request,
                     GetWorkersResponse* response);
+  Status GetOptimalNumberOfWorkers(
+      const GetOptimalNumberOfWorkersRequest* request,
+      GetOptimalNumberOfWorkersResponse* response);
 
   // Exports the dispatcher state for debugging.
   DispatcherStateExport ExportState() const;
@@ -282,12 +287,20 @@ class DataServiceDispatcherImpl {
       TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
   // Checks that the dispatcher has started, returning UNAVAILABLE if it hasn't.
   Status CheckStarted() TF_LOCKS_EXCLUDED(mu_);
+  // Holds back the split request of a straggler worker near the end of a
+  // repetition, so that faster workers can produce the remaining splits.
+  void DeferStragglerSplitRequest(const GetSplitRequest& request,
+                                  const DispatcherState::Iteration& iteration,
+                                  mutex_lock& l)
+      TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
   // Records that a split was produced by a call to `GetSplit`.
   Status RecordSplitProduced(int64_t iteration_id, int64_t repetition,
                              int64_t split_provider_index, bool finished)
       TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
   // Applies a state update, updating both the journal and the in-memory state.
   Status Apply(const Update& update) TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+  // Writes a checkpoint of the dispatcher state and truncates the journal.
+  Status CheckpointState() TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
   // Applies a state update, but doesn't update the journal. Only meant to be
   // used when recovering state when the dispatcher starts.
   Status ApplyWithoutJournaling(const Update& update)
@@ -324,6 +337,13 @@ class DataServiceDispatcherImpl {
   // Mapping from iteration id to the split providers for the iteration.
   absl::flat_hash_map<int64_t, std::vector<std::unique_ptr<SplitProvider>>>
       split_providers_ TF_GUARDED_BY(mu_);
+  // Split request rates of workers, used for load-aware split assignment.
+  SplitAssignmentTracker split_assignment_tracker_ TF_GUARDED_BY(mu_);
+  // Consumption rates of clients and throughputs of workers, used to
+  // recommend a number of workers.
+  AutoScaler auto_scaler_ TF_GUARDED_BY(mu_);
+  // Notified when a split is produced.
+  condition_variable split_produced_cv_;
   // Mapping from round robin iteration id to the round the iteration is
   // currently on. This is based on the data provided by client heartbeats, and
   // may be stale.
@@ -338,6 +358,8 @@ class DataServiceDispatcherImpl {
   absl::optional<std::unique_ptr<JournalWriter>> journal_writer_
       TF_GUARDED_BY(mu_);
   DispatcherState state_ TF_GUARDED_BY(mu_);
+  // Number of updates written to the journal since the last state checkpoint.
+  int64_t updates_since_checkpoint_ TF_GUARDED_BY(mu_) = 0;
   // Condition variable for waking up the iteration gc thread.
   condition_variable iteration_gc_thread_cv_;
   std::unique_ptr<Thread> iteration_gc_thread_;
@@ -17,7 +17,10 @@ limitations under the License.
 #include <algorithm>
 #include <memory>
 #include <optional>
+#include <queue>
 #include <string>
+#include <tuple>
+#include <utility>
 #include <vector>
 
 #include "absl/container/flat_hash_map.h"
@@ -90,6 +93,262 @@ Status DispatcherState::Apply(const Update& update) {
   return OkStatus();
 }
 
+void DispatcherState::ExportCheckpoint(
+    DispatcherStateCheckpoint& checkpoint) const {
+  checkpoint.Clear();
+  for (const auto& [dataset_id, dataset] : datasets_by_id_) {
+    RegisterDatasetUpdate* register_dataset = checkpoint.add_datasets();
+    register_dataset->set_dataset_id(dataset_id);
+    register_dataset->set_fingerprint(dataset->fingerprint);
+    *register_dataset->mutable_metadata() = dataset->metadata;
+  }
+
+  // Workers are restored in the order of their indices, so that the worker
+  // index resolver assigns them the same indices.
+  std::vector<std::pair<int64_t, std::shared_ptr<Worker>>> workers;
+  for (const auto& [address, worker] : workers_) {
+    StatusOr<int64_t> index = worker_index_resolver_.GetWorkerIndex(address);
+    workers.push_back(
+        {index.ok() ? *index : static_cast<int64_t>(workers_.size()), worker});
+  }
+  std::sort(workers.begin(), workers.end(),
+            [](const auto& lhs, const auto& rhs) {
+              return std::tie(lhs.first, lhs.second->address) <
+                     std::tie(rhs.first, rhs.second->address);
+            });
+  for (const auto& [index, worker] : workers) {
+    RegisterWorkerUpdate* register_worker = checkpoint.add_workers();
+    register_worker->set_worker_address(worker->address);
+    register_worker->set_transfer_address(worker->transfer_address);
+    *register_worker->mutable_worker_tags() = {worker->tags.begin(),
+                                               worker->tags.end()};
+    register_worker->set_worker_uid(worker->uid);
+  }
+
+  for (const auto& [job_id, job] : jobs_by_id_) {
+    CreateJobUpdate* create_job = checkpoint.add_jobs();
+    create_job->set_job_id(job_id);
+    create_job->set_job_name(job->job_name);
+    create_job->set_dataset_id(job->dataset_id);
+    *create_job->mutable_processing_mode_def() = job->processing_mode;
+    if (job->num_consumers.has_value()) {
+      create_job->set_num_consumers(job->num_consumers.value());
+    }
+    create_job->set_target_workers(job->target_workers);
+    create_job->set_use_cross_trainer_cache(job->use_cross_trainer_cache);
+  }
+
+  std::vector<std::shared_ptr<Iteration>> iterations;
+  iterations.reserve(iterations_.size());
+  for (const auto& [iteration_id, iteration] : iterations_) {
+    iterations.push_back(iteration);
+  }
+  std::sort(iterations.begin(), iterations.end(),
+            [](const auto& lhs, const auto& rhs) {
+              return lhs->iteration_id < rhs->iteration_id;
+            });
+  // Removed tasks which are still pending need to be checkpointed as well.
+  absl::flat_hash_map<int64_t, std::shared_ptr<Task>> tasks(tasks_.begin(),
+                                                            tasks_.end());
+  for (const auto& iteration : iterations) {
+    IterationCheckpoint* iteration_checkpoint = checkpoint.add_iterations();
+    CreateIterationUpdate* create_iteration =
+        iteration_checkpoint->mutable_create_iteration();
+    create_iteration->set_iteration_id(iteration->iteration_id);
+    create_iteration->set_job_id(iteration->job->id);
+    create_iteration->set_repetition(iteration->iteration_key.repetition);
+    if (iteration->distributed_epoch_state.has_value()) {
+      const DistributedEpochState& state =
+          iteration->distributed_epoch_state.value();
+      create_iteration->set_num_split_providers(state.repetitions.size());
+      *iteration_checkpoint->mutable_repetitions() = {
+          state.repetitions.begin(), state.repetitions.end()};
+      *iteration_checkpoint->mutable_split_indices() = {state.indices.begin(),
+                                                        state.indices.end()};
+    }
+    auto tasks_it = tasks_by_iteration_.find(iteration->iteration_id);
+    if (tasks_it != tasks_by_iteration_.end()) {
+      for (const auto& task : tasks_it->second) {
+        iteration_checkpoint->add_task_ids(task->task_id);
+        tasks.try_emplace(task->task_id, task);
+      }
+    }
+    std::queue<PendingTask> pending_tasks = iteration->pending_tasks;
+    while (!pending_tasks.empty()) {
+      const PendingTask& pending_task = pending_tasks.front();
+      PendingTaskCheckpoint* pending_task_checkpoint =
+          iteration_checkpoint->add_pending_tasks();
+      pending_task_checkpoint->set_task_id(pending_task.task->task_id);
+      pending_task_checkpoint->set_target_round(pending_task.target_round);
+      *pending_task_checkpoint->mutable_ready_consumers() = {
+          pending_task.ready_consumers.begin(),
+          pending_task.ready_consumers.end()};
+      pending_task_checkpoint->set_failures(pending_task.failures);
+      tasks.try_emplace(pending_task.task->task_id, pending_task.task);
+      pending_tasks.pop();
+    }
+    iteration_checkpoint->set_num_clients(iteration->num_clients);
+    iteration_checkpoint->set_last_client_released_micros(
+        iteration->last_client_released_micros);
+    iteration_checkpoint->set_finished(iteration->finished);
+    iteration_checkpoint->set_garbage_collected(iteration->garbage_collected);
+  }
+
+  for (const auto& [task_id, task] : tasks) {
+    TaskCheckpoint* task_checkpoint = checkpoint.add_tasks();
+    CreateTaskUpdate* create_task = task_checkpoint->mutable_create_task();
+    create_task->set_task_id(task_id);
+    create_task->set_iteration_id(task->iteration->iteration_id);
+    create_task->set_worker_address(task->worker_address);
+    create_task->set_transfer_address(task->transfer_address);
+    *create_task->mutable_worker_tags() = {task->worker_tags.begin(),
+                                           task->worker_tags.end()};
+    create_task->set_worker_uid(task->worker_uid);
+    task_checkpoint->set_starting_round(task->starting_round);
+    task_checkpoint->set_finished(task->finished);
+    task_checkpoint->set_removed(task->removed);
+  }
+
+  for (const auto& [iteration_client_id, iteration] :
+       iterations_for_client_ids_) {
+    (*checkpoint.mutable_iteration_clients())[iteration_client_id] =
+        iteration->iteration_id;
+  }
+  checkpoint.set_next_available_job_id(next_available_job_id_);
+  checkpoint.set_next_available_iteration_id(next_available_iteration_id_);
+  checkpoint.set_next_available_iteration_client_id(
+      next_available_iteration_client_id_);
+  checkpoint.set_next_available_task_id(next_available_task_id_);
+}
+
+Status DispatcherState::RestoreCheckpoint(
+    const DispatcherStateCheckpoint& checkpoint) {
+  if (!datasets_by_id_.empty() || !workers_.empty() || !jobs_by_id_.empty() ||
+      !iterations_.empty() || !tasks_.empty()) {
+    return errors::FailedPrecondition(
+        "Dispatcher state checkpoints can only be restored into an empty "
+        "dispatcher state.");
+  }
+  for (const RegisterDatasetUpdate& register_dataset : checkpoint.datasets()) {
+    RegisterDataset(register_dataset);
+  }
+  for (const RegisterWorkerUpdate& register_worker : checkpoint.workers()) {
+    RegisterWorker(register_worker);
+  }
+  for (const CreateJobUpdate& create_job : checkpoint.jobs()) {
+    CreateJob(create_job);
+  }
+  for (const IterationCheckpoint& iteration_checkpoint :
+       checkpoint.iterations()) {
+    const CreateIterationUpdate& create_iteration =
+        iteration_checkpoint.create_iteration();
+    if (!jobs_by_id_.contains(create_iteration.job_id())) {
+      return errors::DataLoss("Dispatcher state checkpoint has iteration ",
+                              create_iteration.iteration_id(),
+                              " for unknown job ", create_iteration.job_id());
+    }
+    CreateIteration(create_iteration);
+    std::shared_ptr<Iteration> iteration =
+        iterations_[create_iteration.iteration_id()];
+    if (iteration->distributed_epoch_state.has_value()) {
+      DistributedEpochState& state = iteration->distributed_epoch_state.value();
+      if (iteration_checkpoint.repetitions_size() !=
+              static_cast<int>(state.repetitions.size()) ||
+          iteration_checkpoint.split_indices_size() !=
+              static_cast<int>(state.indices.size())) {
+        return errors::DataLoss(
+            "Dispatcher state checkpoint has an invalid distributed epoch "
+            "state for iteration ",
+            iteration->iteration_id);
+      }
+      state.repetitions.assign(iteration_checkpoint.repetitions().begin(),
+                               iteration_checkpoint.repetitions().end());
+      state.indices.assign(iteration_checkpoint.split_indices().begin(),
+                           iteration_checkpoint.split_indices().end());
+    }
+    iteration->num_clients = iteration_checkpoint.num_clients();
+    iteration->last_client_released_micros =
+        iteration_checkpoint.last_client_released_micros();
+    iteration->finished = iteration_checkpoint.finished();
+    iteration->garbage_collected = iteration_checkpoint.garbage_collected();
+  }
+
+  absl::flat_hash_map<int64_t, std::shared_ptr<Task>> tasks;
+  for (const TaskCheckpoint& task_checkpoint : checkpoint.tasks()) {
+    const CreateTaskUpdate& create_task = task_checkpoint.create_task();
+    auto iteration_it = iterations_.find(create_task.iteration_id());
+    if (iteration_it == iterations_.end()) {
+      return errors::DataLoss("Dispatcher state checkpoint has task ",
+                              create_task.task_id(), " for unknown iteration ",
+                              create_task.iteration_id());
+    }
+    auto task = std::make_shared<Task>(create_task, iteration_it->second);
+    task->starting_round = task_checkpoint.starting_round();
+    task->finished = task_checkpoint.finished();
+    task->removed = task_checkpoint.removed();
+    tasks[task->task_id] = task;
+    if (task->removed) {
+      continue;
+    }
+    tasks_[task->task_id] = task;
+    if (!task->finished) {
+      tasks_by_worker_[task->worker_address][task->task_id] = task;
+    }
+  }
+  for (const IterationCheckpoint& iteration_checkpoint :
+       checkpoint.iterations()) {
+    const int64_t iteration_id =
+        iteration_checkpoint.create_iteration().iteration_id();
+    std::vector<std::shared_ptr<Task>>& tasks_for_iteration =
+        tasks_by_iteration_[iteration_id];
+    for (int64_t task_id : iteration_checkpoint.task_ids()) {
+      auto task_it = tasks.find(task_id);
+      if (task_it == tasks.end()) {
+        return errors::DataLoss("Dispatcher state checkpoint is missing task ",
+                                task_id, " of iteration ", iteration_id);
+      }
+      tasks_for_iteration.push_back(task_it->second);
+    }
+    std::shared_ptr<Iteration>& iteration = iterations_[iteration_id];
+    for (const PendingTaskCheckpoint& pending_task :
+         iteration_checkpoint.pending_tasks()) {
+      auto task_it = tasks.find(pending_task.task_id());
+      if (task_it == tasks.end()) {
+        return errors::DataLoss(
+            "Dispatcher state checkpoint is missing pending task ",
+            pending_task.task_id(), " of iteration ", iteration_id);
+      }
+      iteration->pending_tasks.emplace(task_it->second,
+                                       pending_task.target_round());
+      iteration->pending_tasks.back().ready_consumers.insert(
+          pending_task.ready_consumers().begin(),
+          pending_task.ready_consumers().end());
+      iteration->pending_tasks.back().failures = pending_task.failures();
+    }
+  }
+
+  for (const auto& [iteration_client_id, iteration_id] :
+       checkpoint.iteration_clients()) {
+    auto iteration_it = iterations_.find(iteration_id);
+    if (iteration_it == iterations_.end()) {
+      return errors::DataLoss("Dispatcher state checkpoint has client ",
+                              iteration_client_id, " for unknown iteration ",
+                              iteration_id);
+    }
+    iterations_for_client_ids_[iteration_client_id] = iteration_it->second;
+  }
+  next_available_job_id_ =
+      std::max(next_available_job_id_, checkpoint.next_available_job_id());
+  next_available_iteration_id_ = std::max(
+      next_available_iteration_id_, checkpoint.next_available_iteration_id());
+  next_available_iteration_client_id_ =
+      std::max(next_available_iteration_client_id_,
+               checkpoint.next_available_iteration_client_id());
+  next_available_task_id_ =
+      std::max(next_available_task_id_, checkpoint.next_available_task_id());
+  return OkStatus();
+}
+
 void DispatcherState::RegisterDataset(
     const RegisterDatasetUpdate& register_dataset) {
   std::string dataset_id = register_dataset.dataset_id();
@@ -73,6 +73,12 @@ class DispatcherState {
   // Applies the given update to the dispatcher's state.
   Status Apply(const Update& update);
 
+  // Exports the dispatcher's state to `checkpoint`.
+  void ExportCheckpoint(DispatcherStateCheckpoint& checkpoint) const;
+  // Restores the state exported by `ExportCheckpoint`. The dispatcher state
+  // must be empty.
+  Status RestoreCheckpoint(const DispatcherStateCheckpoint& checkpoint);
+
   // A dataset registered with the dispatcher.
   struct Dataset {
     explicit Dataset(const std::string& dataset_id, int64_t fingerprint,
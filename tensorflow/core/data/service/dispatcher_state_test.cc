@@ -16,6 +16,7 @@ limitations under the License.
 
 #include <memory>
 #include <string>
+#include <vector>
 
 #include "absl/strings/numbers.h"
 #include "absl/strings/str_cat.h"
@@ -641,5 +642,70 @@ TEST(DispatcherState, ListActiveClients) {
   EXPECT_THAT(state.ListActiveClientIds(), UnorderedElementsAre(6, 8));
 }
 
+TEST(DispatcherState, CheckpointRoundTrip) {
+  std::string dataset_id = "dataset_id";
+  int64_t iteration_id = 3;
+  int64_t iteration_client_id = 6;
+  int64_t task_id_1 = 8;
+  int64_t task_id_2 = 9;
+  DispatcherState state;
+  TF_EXPECT_OK(RegisterDataset(dataset_id, state));
+  TF_EXPECT_OK(RegisterWorker("worker_1", state));
+  TF_EXPECT_OK(RegisterWorker("worker_2", state));
+  TF_EXPECT_OK(CreateIteration(iteration_id, dataset_id, state));
+  TF_EXPECT_OK(
+      AcquireIterationClientId(iteration_id, iteration_client_id, state));
+  TF_EXPECT_OK(CreateTask(task_id_1, iteration_id, "worker_1", state));
+  TF_EXPECT_OK(CreateTask(task_id_2, iteration_id, "worker_2", state));
+  TF_EXPECT_OK(FinishTask(task_id_1, state));
+
+  DispatcherStateCheckpoint checkpoint;
+  state.ExportCheckpoint(checkpoint);
+  DispatcherState restored;
+  TF_ASSERT_OK(restored.RestoreCheckpoint(checkpoint));
+
+  std::shared_ptr<const Dataset> dataset;
+  TF_EXPECT_OK(restored.DatasetFromId(dataset_id, dataset));
+  EXPECT_EQ(restored.NextAvailableDatasetId(), state.NextAvailableDatasetId());
+  EXPECT_THAT(restored.ListWorkers(), SizeIs(2));
+  EXPECT_EQ(restored.NextAvailableJobId(), state.NextAvailableJobId());
+  EXPECT_EQ(restored.NextAvailableIterationId(),
+            state.NextAvailableIterationId());
+  EXPECT_EQ(restored.NextAvailableIterationClientId(),
+            state.NextAvailableIterationClientId());
+  EXPECT_EQ(restored.NextAvailableTaskId(), state.NextAvailableTaskId());
+  std::shared_ptr<const Iteration> iteration;
+  TF_EXPECT_OK(
+      restored.IterationForIterationClientId(iteration_client_id, iteration));
+  EXPECT_EQ(iteration->iteration_id, iteration_id);
+  EXPECT_EQ(iteration->num_clients, 1);
+  EXPECT_FALSE(iteration->finished);
+  std::vector<std::shared_ptr<const Task>> tasks;
+  TF_EXPECT_OK(restored.TasksForIteration(iteration_id, tasks));
+  ASSERT_THAT(tasks, SizeIs(2));
+  EXPECT_EQ(tasks[0]->task_id, task_id_1);
+  EXPECT_TRUE(tasks[0]->finished);
+  EXPECT_EQ(tasks[1]->task_id, task_id_2);
+  EXPECT_FALSE(tasks[1]->finished);
+  TF_EXPECT_OK(restored.TasksForWorker("worker_1", tasks));
+  EXPECT_THAT(tasks, IsEmpty());
+  TF_EXPECT_OK(restored.TasksForWorker("worker_2", tasks));
+  EXPECT_THAT(tasks, SizeIs(1));
+
+  // Updates written after the checkpoint apply to the restored state.
+  TF_EXPECT_OK(FinishTask(task_id_2, restored));
+  TF_EXPECT_OK(restored.IterationFromId(iteration_id, iteration));
+  EXPECT_TRUE(iteration->finished);
+}
+
+TEST(DispatcherState, RestoreCheckpointIntoNonEmptyState) {
+  DispatcherState state;
+  TF_EXPECT_OK(RegisterDataset("dataset_id", state));
+  DispatcherStateCheckpoint checkpoint;
+  state.ExportCheckpoint(checkpoint);
+  EXPECT_THAT(state.RestoreCheckpoint(checkpoint),
+              StatusIs(error::FAILED_PRECONDITION));
+}
+
 }  // namespace data
 }  // namespace tensorflow
@@ -0,0 +1,332 @@
+/* Copyright 2022 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/data/service/element_cache.h"
+
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "absl/strings/str_cat.h"
+#include "tensorflow/core/data/snapshot_utils.h"
+#include "tensorflow/core/data/service/task_runner.h"
+#include "tensorflow/core/framework/dataset.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/types.h"
+#include "tensorflow/core/lib/io/compression.h"
+#include "tensorflow/core/lib/io/path.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/errors.h"
+#include "tensorflow/core/platform/logging.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/random.h"
+#include "tensorflow/core/platform/status.h"
+#include "tensorflow/core/platform/statusor.h"
+#include "tensorflow/core/protobuf/snapshot.pb.h"
+
+namespace tensorflow {
+namespace data {
+namespace {
+
+constexpr char kElementsFilename[] = "elements";
+constexpr int kFileFormatVersion = 2;
+
+size_t ElementSizeBytes(const std::vector<Tensor>& element) {
+  size_t size_bytes = 0;
+  for (const Tensor& tensor : element) {
+    size_bytes += sizeof(Tensor) + tensor.TotalBytes();
+  }
+  return size_bytes;
+}
+
+}  // namespace
+
+// Produces the elements of an entry held in memory.
+class ElementCache::MemoryIterator : public TaskIterator {
+ public:
+  explicit MemoryIterator(std::shared_ptr<const Elements> elements)
+      : elements_(std::move(elements)) {}
+
+  Status GetNext(std::vector<Tensor>& element, bool& end_of_sequence) override {
+    end_of_sequence = next_index_ >= elements_->size();
+    if (!end_of_sequence) {
+      element = (*elements_)[next_index_++];
+    }
+    return OkStatus();
+  }
+
+  int64_t Cardinality() const override { return elements_->size(); }
+
+ private:
+  const std::shared_ptr<const Elements> elements_;
+  size_t next_index_ = 0;
+};
+
+// Produces the elements of an entry stored on disk. If the entry fits in
+// memory, it is added to the in-memory cache once it has been fully read.
+class ElementCache::DiskIterator : public TaskIterator {
+ public:
+  DiskIterator(ElementCache& cache, uint64 fingerprint,
+               std::unique_ptr<snapshot_util::Reader> reader,
+               int64_t num_elements)
+      : cache_(cache),
+        fingerprint_(fingerprint),
+        reader_(std::move(reader)),
+        num_elements_(num_elements),
+        elements_(std::make_shared<Elements>()) {}
+
+  Status GetNext(std::vector<Tensor>& element, bool& end_of_sequence) override {
+    end_of_sequence = next_index_ >= num_elements_;
+    if (end_of_sequence) {
+      if (elements_ != nullptr) {
+        cache_.InsertInMemory(fingerprint_, std::move(elements_), size_bytes_);
+        elements_ = nullptr;
+      }
+      return OkStatus();
+    }
+    element.clear();
+    TF_RETURN_IF_ERROR(reader_->ReadTensors(&element));
+    ++next_index_;
+    if (elements_ != nullptr) {
+      size_bytes_ += ElementSizeBytes(element);
+      if (size_bytes_ <= cache_.max_memory_bytes_) {
+        elements_->push_back(element);
+      } else {
+        elements_ = nullptr;
+      }
+    }
+    return OkStatus();
+  }
+
+  int64_t Cardinality() const override { return num_elements_; }
+
+ private:
+  ElementCache& cache_;
+  const uint64 fingerprint_;
+  const std::unique_ptr<snapshot_util::Reader> reader_;
+  const int64_t num_elements_;
+  int64_t next_index_ = 0;
+  // Elements read so far, or nullptr if the entry doesn't fit in memory.
+  std::shared_ptr<Elements> elements_;
+  size_t size_bytes_ = 0;
+};
+
+// Produces the elements of the input iterator and records them in a temporary
+// directory, which becomes the committed entry when the input is exhausted.
+class ElementCache::RecordingIterator : public TaskIterator {
+ public:
+  RecordingIterator(ElementCache& cache, uint64 fingerprint,
+                    std::unique_ptr<TaskIterator> input)
+      : cache_(cache),
+        fingerprint_(fingerprint),
+        input_(std::move(input)),
+        tmp_directory_(absl::StrCat(cache.EntryDirectory(fingerprint),
+                                    ".tmp-", random::New64())),
+        elements_(std::make_shared<Elements>()) {}
+
+  ~RecordingIterator() override {
+    if (recording_) {
+      VLOG(2) << "Task did not finish; discarding the partially recorded "
+              << "element cache entry " << tmp_directory_;
+      Abandon();
+    }
+  }
+
+  Status GetNext(std::vector<Tensor>& element, bool& end_of_sequence) override {
+    TF_RETURN_IF_ERROR(input_->GetNext(element, end_of_sequence));
+    if (!recording_) {
+      return OkStatus();
+    }
+    Status s = end_of_sequence ? Commit() : Append(element);
+    if (!s.ok()) {
+      LOG(WARNING) << "Failed to write element cache entry " << tmp_directory_
+                   << ": " << s << ". The dataset will not be cached.";
+      Abandon();
+    }
+    return OkStatus();
+  }
+
+  int64_t Cardinality() const override { return input_->Cardinality(); }
+
+ private:
+  Status Append(const std::vector<Tensor>& element) {
+    if (writer_ == nullptr) {
+      for (const Tensor& tensor : element) {
+        dtypes_.push_back(tensor.dtype());
+      }
+      TF_RETURN_IF_ERROR(cache_.env_->RecursivelyCreateDir(tmp_directory_));
+      TF_RETURN_IF_ERROR(snapshot_util::Writer::Create(
+          cache_.env_, io::JoinPath(tmp_directory_, kElementsFilename),
+          io::compression::kSnappy, kFileFormatVersion, dtypes_, &writer_));
+    }
+    TF_RETURN_IF_ERROR(writer_->WriteTensors(element));
+    ++num_elements_;
+    if (elements_ != nullptr) {
+      size_bytes_ += ElementSizeBytes(element);
+      if (size_bytes_ <= cache_.max_memory_bytes_) {
+        elements_->push_back(element);
+      } else {
+        elements_ = nullptr;
+      }
+    }
+    return OkStatus();
+  }
+
+  Status Commit() {
+    recording_ = false;
+    if (writer_ != nullptr) {
+      TF_RETURN_IF_ERROR(writer_->Close());
+      writer_.reset();
+    }
+    experimental::SnapshotMetadataRecord metadata;
+    metadata.set_graph_hash(absl::StrCat(fingerprint_));
+    metadata.set_creation_timestamp(cache_.env_->NowMicros());
+    metadata.set_version(kFileFormatVersion);
+    for (DataType dtype : dtypes_) {
+      metadata.add_dtype(dtype);
+    }
+    metadata.set_num_elements(num_elements_);
+    metadata.set_finalized(true);
+    TF_RETURN_IF_ERROR(snapshot_util::WriteMetadataFile(
+        cache_.env_, tmp_directory_, &metadata));
+
+    const std::string entry_directory = cache_.EntryDirectory(fingerprint_);
+    if (cache_.env_->FileExists(entry_directory).ok()) {
+      // A concurrent task has committed the same entry first.
+      DeleteTmpDirectory();
+    } else {
+      TF_RETURN_IF_ERROR(
+          cache_.env_->RenameFile(tmp_directory_, entry_directory));
+      LOG(INFO) << "Committed " << num_elements_ << " elements to the element "
+                << "cache entry " << entry_directory;
+    }
+    if (elements_ != nullptr) {
+      cache_.InsertInMemory(fingerprint_, std::move(elements_), size_bytes_);
+      elements_ = nullptr;
+    }
+    return OkStatus();
+  }
+
+  void Abandon() {
+    recording_ = false;
+    writer_.reset();
+    elements_ = nullptr;
+    DeleteTmpDirectory();
+  }
+
+  void DeleteTmpDirectory() {
+    if (!cache_.env_->FileExists(tmp_directory_).ok()) {
+      return;
+    }
+    int64_t undeleted_files, undeleted_dirs;
+    Status s = cache_.env_->DeleteRecursively(tmp_directory_, &undeleted_files,
+                                              &undeleted_dirs);
+    if (!s.ok()) {
+      LOG(WARNING) << "Failed to delete temporary element cache directory "
+                   << tmp_directory_ << ": " << s;
+    }
+  }
+
+  ElementCache& cache_;
+  const uint64 fingerprint_;
+  const std::unique_ptr<TaskIterator> input_;
+  const std::string tmp_directory_;
+
+  bool recording_ = true;
+  std::unique_ptr<snapshot_util::Writer> writer_;
+  DataTypeVector dtypes_;
+  int64_t num_elements_ = 0;
+  // Elements recorded so far, or nullptr if the entry doesn't fit in memory.
+  std::shared_ptr<Elements> elements_;
+  size_t size_bytes_ = 0;
+};
+
+ElementCache::ElementCache(Env* env, const std::string& directory,
+                           size_t max_memory_bytes)
+    : env_(env), directory_(directory), max_memory_bytes_(max_memory_bytes) {}
+
+StatusOr<std::unique_ptr<TaskIterator>> ElementCache::Lookup(
+    uint64 fingerprint) {
+  {
+    mutex_lock l(mu_);
+    auto it = memory_index_.find(fingerprint);
+    if (it != memory_index_.end()) {
+      lru_.splice(lru_.begin(), lru_, it->second);
+      return std::unique_ptr<TaskIterator>(
+          std::make_unique<MemoryIterator>(it->second->elements));
+    }
+  }
+
+  const std::string entry_directory = EntryDirectory(fingerprint);
+  experimental::SnapshotMetadataRecord metadata;
+  bool file_exists = false;
+  TF_RETURN_IF_ERROR(snapshot_util::ReadMetadataFile(env_, entry_directory,
+                                                     &metadata, &file_exists));
+  if (!file_exists || !metadata.finalized()) {
+    return std::unique_ptr<TaskIterator>();
+  }
+  DataTypeVector dtypes(metadata.dtype().begin(), metadata.dtype().end());
+  std::unique_ptr<snapshot_util::Reader> reader;
+  if (metadata.num_elements() > 0) {
+    TF_RETURN_IF_ERROR(snapshot_util::Reader::Create(
+        env_, io::JoinPath(entry_directory, kElementsFilename),
+        io::compression::kSnappy, metadata.version(), dtypes, &reader));
+  }
+  return std::unique_ptr<TaskIterator>(std::make_unique<DiskIterator>(
+      *this, fingerprint, std::move(reader), metadata.num_elements()));
+}
+
+std::unique_ptr<TaskIterator> ElementCache::Record(
+    uint64 fingerprint, std::unique_ptr<TaskIterator> iterator) {
+  return std::make_unique<RecordingIterator>(*this, fingerprint,
+                                             std::move(iterator));
+}
+
+size_t ElementCache::MemoryBytes() const {
+  mutex_lock l(mu_);
+  return memory_bytes_;
+}
+
+std::string ElementCache::EntryDirectory(uint64 fingerprint) const {
+  return io::JoinPath(directory_,
+                      absl::StrCat(absl::Hex(fingerprint, absl::kZeroPad16)));
+}
+
+void ElementCache::InsertInMemory(uint64 fingerprint,
+                                  std::shared_ptr<const Elements> elements,
+                                  size_t size_bytes) {
+  if (size_bytes > max_memory_bytes_) {
+    return;
+  }
+  mutex_lock l(mu_);
+  if (memory_index_.contains(fingerprint)) {
+    return;
+  }
+  while (memory_bytes_ + size_bytes > max_memory_bytes_) {
+    const MemoryEntry& evicted = lru_.back();
+    VLOG(2) << "Evicting element cache entry " << evicted.fingerprint
+            << " from memory.";
+    memory_bytes_ -= evicted.size_bytes;
+    memory_index_.erase(evicted.fingerprint);
+    lru_.pop_back();
+  }
+  lru_.push_front({fingerprint, std::move(elements), size_bytes});
+  memory_index_[fingerprint] = lru_.begin();
+  memory_bytes_ += size_bytes;
+}
+
+}  // namespace data
+}  // namespace tensorflow
@@ -0,0 +1,110 @@
+/* Copyright 2022 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_CORE_DATA_SERVICE_ELEMENT_CACHE_H_
+#define TENSORFLOW_CORE_DATA_SERVICE_ELEMENT_CACHE_H_
+
+#include <cstddef>
+#include <list>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "absl/container/flat_hash_map.h"
+#include "tensorflow/core/data/service/task_runner.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/status.h"
+#include "tensorflow/core/platform/statusor.h"
+#include "tensorflow/core/platform/thread_annotations.h"
+#include "tensorflow/core/platform/types.h"
+
+namespace tensorflow {
+namespace data {
+
+// A worker-wide cache of the elements produced by tf.data service tasks, keyed
+// by the fingerprint of the dataset graph. Unlike `CrossTrainerCache`, which
+// shares a sliding window of one job between concurrent trainers, entries of
+// this cache outlive the job that produced them: a later task whose dataset has
+// the same fingerprint replays the cached elements instead of recomputing them.
+// This benefits e.g. hyperparameter sweeps running many jobs over the same
+// expensive input pipeline.
+//
+// A task records an entry by reading through an iterator returned by `Record`.
+// The entry is committed once the task reaches the end of its input, so only
+// finite datasets are cached. Committed entries are stored in `directory` and
+// survive worker restarts. Entries of up to `max_memory_bytes` in total are
+// additionally kept in memory, evicting the least recently used entries first.
+//
+// The cache assumes that datasets with the same fingerprint produce the same
+// elements. It should only be used for deterministic datasets.
+//
+// The `ElementCache` class is thread-safe.
+class ElementCache {
+ public:
+  ElementCache(Env* env, const std::string& directory, size_t max_memory_bytes);
+  ElementCache(const ElementCache&) = delete;
+  ElementCache& operator=(const ElementCache&) = delete;
+
+  // Returns an iterator over the cached elements of the dataset with
+  // `fingerprint`, or nullptr if there is no committed entry for it.
+  StatusOr<std::unique_ptr<TaskIterator>> Lookup(uint64 fingerprint);
+
+  // Returns an iterator which produces the elements of `iterator` and records
+  // them under `fingerprint`. Failures to write the cache are logged and do not
+  // affect the elements produced.
+  std::unique_ptr<TaskIterator> Record(uint64 fingerprint,
+                                       std::unique_ptr<TaskIterator> iterator);
+
+  // Returns the number of bytes of cached elements held in memory.
+  size_t MemoryBytes() const TF_LOCKS_EXCLUDED(mu_);
+
+ private:
+  class MemoryIterator;
+  class DiskIterator;
+  class RecordingIterator;
+  using Elements = std::vector<std::vector<Tensor>>;
+
+  struct MemoryEntry {
+    uint64 fingerprint = 0;
+    std::shared_ptr<const Elements> elements;
+    size_t size_bytes = 0;
+  };
+
+  // Returns the directory of the committed entry for `fingerprint`.
+  std::string EntryDirectory(uint64 fingerprint) const;
+
+  // Adds `elements` to the in-memory cache if they fit, evicting the least
+  // recently used entries as needed.
+  void InsertInMemory(uint64 fingerprint,
+                      std::shared_ptr<const Elements> elements,
+                      size_t size_bytes) TF_LOCKS_EXCLUDED(mu_);
+
+  Env* const env_;
+  const std::string directory_;
+  const size_t max_memory_bytes_;
+
+  mutable mutex mu_;
+  // In-memory entries, ordered from the most to the least recently used.
+  std::list<MemoryEntry> lru_ TF_GUARDED_BY(mu_);
+  absl::flat_hash_map<uint64, std::list<MemoryEntry>::iterator> memory_index_
+      TF_GUARDED_BY(mu_);
+  size_t memory_bytes_ TF_GUARDED_BY(mu_) = 0;
+};
+
+}  // namespace data
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_DATA_SERVICE_ELEMENT_CACHE_H_
@@ -0,0 +1,217 @@
+/* Copyright 2022 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/data/service/element_cache.h"
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "absl/strings/str_cat.h"
+#include "tensorflow/core/data/service/task_runner.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/path.h"
+#include "tensorflow/core/platform/random.h"
+#include "tensorflow/core/platform/statusor.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace data {
+namespace {
+
+using ::testing::ElementsAreArray;
+using ::testing::IsNull;
+using ::testing::NotNull;
+
+constexpr uint64 kFingerprint = 0x1234;
+constexpr size_t kLargeMemory = 1 << 20;
+
+class RangeIterator : public TaskIterator {
+ public:
+  explicit RangeIterator(int64_t range) : range_(range) {}
+
+  Status GetNext(std::vector<Tensor>& element, bool& end_of_sequence) override {
+    end_of_sequence = next_ >= range_;
+    if (!end_of_sequence) {
+      element = {Tensor{next_++}};
+    }
+    return OkStatus();
+  }
+
+  int64_t Cardinality() const override { return range_; }
+
+ private:
+  const int64_t range_;
+  int64_t next_ = 0;
+};
+
+std::string NewCacheDirectory() {
+  return io::JoinPath(testing::TmpDir(),
+                      absl::StrCat("element_cache_", random::New64()));
+}
+
+std::vector<int64_t> ReadAll(TaskIterator& iterator) {
+  std::vector<int64_t> result;
+  bool end_of_sequence = false;
+  while (true) {
+    std::vector<Tensor> element;
+    TF_CHECK_OK(iterator.GetNext(element, end_of_sequence));
+    if (end_of_sequence) {
+      return result;
+    }
+    result.push_back(element[0].scalar<int64_t>()());
+  }
+}
+
+std::vector<int64_t> Range(int64_t range) {
+  std::vector<int64_t> result;
+  for (int64_t i = 0; i < range; ++i) {
+    result.push_back(i);
+  }
+  return result;
+}
+
+TEST(ElementCacheTest, RecordAndLookupFromMemory) {
+  ElementCache cache(Env::Default(), NewCacheDirectory(), kLargeMemory);
+  std::unique_ptr<TaskIterator> recording =
+      cache.Record(kFingerprint, std::make_unique<RangeIterator>(10));
+  EXPECT_THAT(ReadAll(*recording), ElementsAreArray(Range(10)));
+  EXPECT_GT(cache.MemoryBytes(), 0);
+
+  TF_ASSERT_OK_AND_ASSIGN(std::unique_ptr<TaskIterator> cached,
+                          cache.Lookup(kFingerprint));
+  ASSERT_THAT(cached, NotNull());
+  EXPECT_EQ(cached->Cardinality(), 10);
+  EXPECT_THAT(ReadAll(*cached), ElementsAreArray(Range(10)));
+}
+
+TEST(ElementCacheTest, LookupFromDisk) {
+  const std::string directory = NewCacheDirectory();
+  {
+    ElementCache cache(Env::Default(), directory, kLargeMemory);
+    std::unique_ptr<TaskIterator> recording =
+        cache.Record(kFingerprint, std::make_unique<RangeIterator>(10));
+    EXPECT_THAT(ReadAll(*recording), ElementsAreArray(Range(10)));
+  }
+
+  // A new cache, e.g. after a worker restart, reads the committed entry.
+  ElementCache cache(Env::Default(), directory, kLargeMemory);
+  EXPECT_EQ(cache.MemoryBytes(), 0);
+  TF_ASSERT_OK_AND_ASSIGN(std::unique_ptr<TaskIterator> cached,
+                          cache.Lookup(kFingerprint));
+  ASSERT_THAT(cached, NotNull());
+  EXPECT_EQ(cached->Cardinality(), 10);
+  EXPECT_THAT(ReadAll(*cached), ElementsAreArray(Range(10)));
+  // Fully reading the entry promotes it to memory.
+  EXPECT_GT(cache.MemoryBytes(), 0);
+}
+
+TEST(ElementCacheTest, EmptyDataset) {
+  const std::string directory = NewCacheDirectory();
+  {
+    ElementCache cache(Env::Default(), directory, kLargeMemory);
+    std::unique_ptr<TaskIterator> recording =
+        cache.Record(kFingerprint, std::make_unique<RangeIterator>(0));
+    EXPECT_THAT(ReadAll(*recording), ElementsAreArray(Range(0)));
+  }
+
+  ElementCache cache(Env::Default(), directory, kLargeMemory);
+  TF_ASSERT_OK_AND_ASSIGN(std::unique_ptr<TaskIterator> cached,
+                          cache.Lookup(kFingerprint));
+  ASSERT_THAT(cached, NotNull());
+  EXPECT_THAT(ReadAll(*cached), ElementsAreArray(Range(0)));
+}
+
+TEST(ElementCacheTest, LookupMiss) {
+  ElementCache cache(Env::Default(), NewCacheDirectory(), kLargeMemory);
+  TF_ASSERT_OK_AND_ASSIGN(std::unique_ptr<TaskIterator> cached,
+                          cache.Lookup(kFingerprint));
+  EXPECT_THAT(cached, IsNull());
+}
+
+TEST(ElementCacheTest, EntryIsNotVisibleBeforeCommit) {
+  ElementCache cache(Env::Default(), NewCacheDirectory(), kLargeMemory);
+  std::unique_ptr<TaskIterator> recording =
+      cache.Record(kFingerprint, std::make_unique<RangeIterator>(10));
+  std::vector<Tensor> element;
+  bool end_of_sequence = false;
+  TF_ASSERT_OK(recording->GetNext(element, end_of_sequence));
+  ASSERT_FALSE(end_of_sequence);
+
+  TF_ASSERT_OK_AND_ASSIGN(std::unique_ptr<TaskIterator> cached,
+                          cache.Lookup(kFingerprint));
+  EXPECT_THAT(cached, IsNull());
+}
+
+TEST(ElementCacheTest, UnfinishedRecordingIsDiscarded) {
+  const std::string directory = NewCacheDirectory();
+  ElementCache cache(Env::Default(), directory, kLargeMemory);
+  {
+    std::unique_ptr<TaskIterator> recording =
+        cache.Record(kFingerprint, std::make_unique<RangeIterator>(10));
+    std::vector<Tensor> element;
+    bool end_of_sequence = false;
+    TF_ASSERT_OK(recording->GetNext(element, end_of_sequence));
+  }
+
+  TF_ASSERT_OK_AND_ASSIGN(std::unique_ptr<TaskIterator> cached,
+                          cache.Lookup(kFingerprint));
+  EXPECT_THAT(cached, IsNull());
+  std::vector<std::string> children;
+  TF_ASSERT_OK(Env::Default()->GetChildren(directory, &children));
+  EXPECT_TRUE(children.empty());
+}
+
+TEST(ElementCacheTest, EvictLeastRecentlyUsedFromMemory) {
+  const std::string directory = NewCacheDirectory();
+  // Fits one entry of 10 elements, but not two.
+  ElementCache cache(Env::Default(), directory,
+                     15 * (sizeof(Tensor) + sizeof(int64_t)));
+  for (uint64 fingerprint : {1, 2}) {
+    std::unique_ptr<TaskIterator> recording =
+        cache.Record(fingerprint, std::make_unique<RangeIterator>(10));
+    EXPECT_THAT(ReadAll(*recording), ElementsAreArray(Range(10)));
+  }
+  EXPECT_EQ(cache.MemoryBytes(), 10 * (sizeof(Tensor) + sizeof(int64_t)));
+
+  // The evicted entry is still served from disk.
+  for (uint64 fingerprint : {1, 2}) {
+    TF_ASSERT_OK_AND_ASSIGN(std::unique_ptr<TaskIterator> cached,
+                            cache.Lookup(fingerprint));
+    ASSERT_THAT(cached, NotNull());
+    EXPECT_THAT(ReadAll(*cached), ElementsAreArray(Range(10)));
+  }
+}
+
+TEST(ElementCacheTest, EntryTooLargeForMemory) {
+  ElementCache cache(Env::Default(), NewCacheDirectory(),
+                     /*max_memory_bytes=*/1);
+  std::unique_ptr<TaskIterator> recording =
+      cache.Record(kFingerprint, std::make_unique<RangeIterator>(10));
+  EXPECT_THAT(ReadAll(*recording), ElementsAreArray(Range(10)));
+  EXPECT_EQ(cache.MemoryBytes(), 0);
+
+  TF_ASSERT_OK_AND_ASSIGN(std::unique_ptr<TaskIterator> cached,
+                          cache.Lookup(kFingerprint));
+  ASSERT_THAT(cached, NotNull());
+  EXPECT_THAT(ReadAll(*cached), ElementsAreArray(Range(10)));
+}
+
+}  // namespace
+}  // namespace data
+}  // namespace tensorflow
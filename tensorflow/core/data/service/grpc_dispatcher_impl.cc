@@ -61,6 +61,7 @@ HANDLER(GetOrCreateJob);
 HANDLER(GetOrCreateIteration);
 HANDLER(ClientHeartbeat);
 HANDLER(GetWorkers);
+HANDLER(GetOptimalNumberOfWorkers);
 HANDLER(GetDataServiceMetadata);
 HANDLER(GetDataServiceConfig);
 #undef HANDLER
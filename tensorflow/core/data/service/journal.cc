@@ -17,8 +17,10 @@ limitations under the License.
 
 #include <algorithm>
 #include <string>
+#include <vector>
 
 #include "absl/memory/memory.h"
+#include "absl/strings/str_cat.h"
 #include "tensorflow/core/data/service/journal.pb.h"
 #include "tensorflow/core/lib/io/record_reader.h"
 #include "tensorflow/core/lib/io/record_writer.h"
@@ -26,12 +28,14 @@ limitations under the License.
 #include "tensorflow/core/platform/errors.h"
 #include "tensorflow/core/platform/path.h"
 #include "tensorflow/core/platform/regexp.h"
+#include "tensorflow/core/platform/statusor.h"
 
 namespace tensorflow {
 namespace data {
 
 namespace {
 constexpr StringPiece kJournal = "journal";
+constexpr StringPiece kCheckpoint = "checkpoint";
 
 Status ParseSequenceNumber(const std::string& journal_file,
                            int64_t* sequence_number) {
@@ -41,6 +45,14 @@ Status ParseSequenceNumber(const std::string& journal_file,
   }
   return OkStatus();
 }
+
+// Returns whether `checkpoint_file` is a complete checkpoint file, storing its
+// sequence number in `sequence_number`.
+bool ParseCheckpointSequenceNumber(const std::string& checkpoint_file,
+                                   int64_t* sequence_number) {
+  return RE2::FullMatch(checkpoint_file, "checkpoint_(\\d+)",
+                        sequence_number);
+}
 }  // namespace
 
 std::string DataServiceJournalFile(const std::string& journal_dir,
@@ -49,6 +61,75 @@ std::string DataServiceJournalFile(const std::string& journal_dir,
                       absl::StrCat(kJournal, "_", sequence_number));
 }
 
+std::string DataServiceCheckpointFile(const std::string& checkpoint_dir,
+                                      int64_t sequence_number) {
+  return io::JoinPath(checkpoint_dir,
+                      absl::StrCat(kCheckpoint, "_", sequence_number));
+}
+
+Status WriteDispatcherStateCheckpoint(
+    Env* env, const std::string& checkpoint_dir, int64_t sequence_number,
+    const DispatcherStateCheckpoint& checkpoint) {
+  TF_RETURN_IF_ERROR(env->RecursivelyCreateDir(checkpoint_dir));
+  std::string checkpoint_file =
+      DataServiceCheckpointFile(checkpoint_dir, sequence_number);
+  std::string tmp_file = absl::StrCat(checkpoint_file, ".tmp");
+  TF_RETURN_IF_ERROR(WriteBinaryProto(env, tmp_file, checkpoint));
+  TF_RETURN_IF_ERROR(env->RenameFile(tmp_file, checkpoint_file));
+  VLOG(1) << "Wrote dispatcher state checkpoint " << checkpoint_file;
+  return OkStatus();
+}
+
+Status ReadLatestDispatcherStateCheckpoint(
+    Env* env, const std::string& checkpoint_dir,
+    DispatcherStateCheckpoint& checkpoint, int64_t& sequence_number) {
+  sequence_number = -1;
+  if (!env->IsDirectory(checkpoint_dir).ok()) {
+    return OkStatus();
+  }
+  std::vector<std::string> files;
+  TF_RETURN_IF_ERROR(env->GetChildren(checkpoint_dir, &files));
+  for (const auto& file : files) {
+    int64_t file_sequence_number;
+    // Skips temporary files of checkpoints that failed to be written.
+    if (ParseCheckpointSequenceNumber(file, &file_sequence_number)) {
+      sequence_number = std::max(sequence_number, file_sequence_number);
+    }
+  }
+  if (sequence_number < 0) {
+    return OkStatus();
+  }
+  return ReadBinaryProto(
+      env, DataServiceCheckpointFile(checkpoint_dir, sequence_number),
+      &checkpoint);
+}
+
+Status TruncateJournal(Env* env, const std::string& journal_dir,
+                       const std::string& checkpoint_dir,
+                       int64_t sequence_number) {
+  std::vector<std::string> journal_files;
+  TF_RETURN_IF_ERROR(env->GetChildren(journal_dir, &journal_files));
+  for (const auto& file : journal_files) {
+    int64_t file_sequence_number;
+    TF_RETURN_IF_ERROR(ParseSequenceNumber(file, &file_sequence_number));
+    if (file_sequence_number < sequence_number) {
+      TF_RETURN_IF_ERROR(env->DeleteFile(io::JoinPath(journal_dir, file)));
+    }
+  }
+  std::vector<std::string> checkpoint_files;
+  TF_RETURN_IF_ERROR(env->GetChildren(checkpoint_dir, &checkpoint_files));
+  for (const auto& file : checkpoint_files) {
+    int64_t file_sequence_number;
+    if (!ParseCheckpointSequenceNumber(file, &file_sequence_number) ||
+        file_sequence_number < sequence_number) {
+      TF_RETURN_IF_ERROR(env->DeleteFile(io::JoinPath(checkpoint_dir, file)));
+    }
+  }
+  VLOG(1) << "Truncated journal " << journal_dir << " before sequence number "
+          << sequence_number;
+  return OkStatus();
+}
+
 FileJournalWriter::FileJournalWriter(Env* env, const std::string& journal_dir)
     : env_(env), journal_dir_(journal_dir) {}
 
@@ -65,10 +146,28 @@ Status FileJournalWriter::EnsureInitialized() {
     TF_RETURN_IF_ERROR(ParseSequenceNumber(file, &sequence_number));
     latest_sequence_number = std::max(latest_sequence_number, sequence_number);
   }
+  return OpenFile(latest_sequence_number + 1);
+}
+
+StatusOr<int64_t> FileJournalWriter::StartNewFile() {
+  TF_RETURN_IF_ERROR(EnsureInitialized());
+  TF_RETURN_IF_ERROR(writer_->Close());
+  writer_.reset();
+  TF_RETURN_IF_ERROR(file_->Close());
+  file_.reset();
+  TF_RETURN_IF_ERROR(OpenFile(sequence_number_ + 1));
+  return sequence_number_;
+}
+
+Status FileJournalWriter::OpenFile(int64_t sequence_number) {
   std::string journal_file =
-      DataServiceJournalFile(journal_dir_, latest_sequence_number + 1);
+      DataServiceJournalFile(journal_dir_, sequence_number);
   TF_RETURN_IF_ERROR(env_->NewAppendableFile(journal_file, &file_));
+  // Syncs the empty file so that the journal has no gaps in its sequence
+  // numbers if the dispatcher crashes before writing to it.
+  TF_RETURN_IF_ERROR(file_->Sync());
   writer_ = std::make_unique<io::RecordWriter>(file_.get());
+  sequence_number_ = sequence_number;
   VLOG(1) << "Created journal writer to write to " << journal_file;
   return OkStatus();
 }
@@ -89,14 +188,17 @@ Status FileJournalWriter::Write(const Update& update) {
   return OkStatus();
 }
 
-FileJournalReader::FileJournalReader(Env* env, StringPiece journal_dir)
-    : env_(env), journal_dir_(journal_dir) {}
+FileJournalReader::FileJournalReader(Env* env, StringPiece journal_dir,
+                                     int64_t start_sequence_number)
+    : env_(env),
+      journal_dir_(journal_dir),
+      sequence_number_(start_sequence_number) {}
 
 Status FileJournalReader::EnsureInitialized() {
   if (reader_) {
     return OkStatus();
   }
-  return UpdateFile(DataServiceJournalFile(journal_dir_, 0));
+  return UpdateFile(DataServiceJournalFile(journal_dir_, sequence_number_));
 }
 
 Status FileJournalReader::Read(Update& update, bool& end_of_journal) {
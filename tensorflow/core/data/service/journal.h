@@ -22,6 +22,7 @@ limitations under the License.
 #include "tensorflow/core/lib/io/record_reader.h"
 #include "tensorflow/core/lib/io/record_writer.h"
 #include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/statusor.h"
 
 namespace tensorflow {
 namespace data {
@@ -30,6 +31,33 @@ namespace data {
 std::string DataServiceJournalFile(const std::string& journal_dir,
                                    int64_t sequence_number);
 
+// Returns the location of the dispatcher state checkpoint within the checkpoint
+// directory. The checkpoint covers all journal files with sequence numbers
+// below `sequence_number`.
+std::string DataServiceCheckpointFile(const std::string& checkpoint_dir,
+                                      int64_t sequence_number);
+
+// Writes `checkpoint` to `checkpoint_dir`, covering all journal files with
+// sequence numbers below `sequence_number`. The checkpoint file is written
+// atomically.
+Status WriteDispatcherStateCheckpoint(
+    Env* env, const std::string& checkpoint_dir, int64_t sequence_number,
+    const DispatcherStateCheckpoint& checkpoint);
+
+// Reads the latest checkpoint in `checkpoint_dir` into `checkpoint`, and sets
+// `sequence_number` to the sequence number of the first journal file not
+// covered by the checkpoint. Sets `sequence_number` to -1 if there is no
+// checkpoint.
+Status ReadLatestDispatcherStateCheckpoint(
+    Env* env, const std::string& checkpoint_dir,
+    DispatcherStateCheckpoint& checkpoint, int64_t& sequence_number);
+
+// Deletes the journal files with sequence numbers below `sequence_number`, and
+// the checkpoints older than the checkpoint at `sequence_number`.
+Status TruncateJournal(Env* env, const std::string& journal_dir,
+                       const std::string& checkpoint_dir,
+                       int64_t sequence_number);
+
 // Interface for writing to a journal.
 class JournalWriter {
  public:
@@ -38,6 +66,9 @@ class JournalWriter {
   virtual Status Write(const Update& update) = 0;
   // Initializes the writer if it is not yet initialized.
   virtual Status EnsureInitialized() = 0;
+  // Starts writing to a new journal file. Returns the sequence number of the
+  // new file.
+  virtual StatusOr<int64_t> StartNewFile() = 0;
 };
 
 // FileJournalWriter is not thread-safe, requiring external synchronization when
@@ -67,10 +98,16 @@ class FileJournalWriter : public JournalWriter {
 
   Status Write(const Update& update) override;
   Status EnsureInitialized() override;
+  StatusOr<int64_t> StartNewFile() override;
 
  private:
+  // Opens the journal file with `sequence_number` for writing.
+  Status OpenFile(int64_t sequence_number);
+
   Env* env_;
   const std::string journal_dir_;
+  // Sequence number of current journal file.
+  int64_t sequence_number_ = -1;
   std::unique_ptr<WritableFile> file_;
   std::unique_ptr<io::RecordWriter> writer_;
 };
@@ -88,10 +125,12 @@ class JournalReader {
 // used by multiple threads.
 //
 // The journal reader reads through all journal files in the configured journal
-// directory, in order of their sequence numbers. See FileJournalWriter above.
+// directory, in order of their sequence numbers, starting from
+// `start_sequence_number`. See FileJournalWriter above.
 class FileJournalReader : public JournalReader {
  public:
-  explicit FileJournalReader(Env* env, StringPiece journal_dir);
+  explicit FileJournalReader(Env* env, StringPiece journal_dir,
+                             int64_t start_sequence_number = 0);
   FileJournalReader(const FileJournalReader&) = delete;
   FileJournalReader& operator=(const FileJournalReader&) = delete;
 
@@ -15,6 +15,7 @@ limitations under the License.
 #include "tensorflow/core/data/service/journal.h"
 
 #include <string>
+#include <vector>
 
 #include "absl/memory/memory.h"
 #include "tensorflow/core/data/service/common.pb.h"
@@ -22,6 +23,8 @@ limitations under the License.
 #include "tensorflow/core/lib/core/status_test_util.h"
 #include "tensorflow/core/platform/errors.h"
 #include "tensorflow/core/platform/path.h"
+#include "tensorflow/core/platform/status_matchers.h"
+#include "tensorflow/core/platform/statusor.h"
 #include "tensorflow/core/platform/test.h"
 #include "tensorflow/core/protobuf/data_service.pb.h"
 
@@ -29,6 +32,7 @@ namespace tensorflow {
 namespace data {
 
 namespace {
+using ::tensorflow::testing::IsOkAndHolds;
 using ::testing::HasSubstr;
 
 bool NewJournalDir(std::string& journal_dir) {
@@ -112,6 +116,69 @@ TEST(Journal, AppendExistingJournal) {
   TF_EXPECT_OK(CheckJournalContent(journal_dir, updates));
 }
 
+TEST(Journal, StartNewFile) {
+  std::string journal_dir;
+  EXPECT_TRUE(NewJournalDir(journal_dir));
+  std::vector<Update> updates = {MakeCreateIterationUpdate(),
+                                 MakeRegisterDatasetUpdate(),
+                                 MakeFinishTaskUpdate()};
+  FileJournalWriter writer(Env::Default(), journal_dir);
+  TF_EXPECT_OK(writer.Write(updates[0]));
+  EXPECT_THAT(writer.StartNewFile(), IsOkAndHolds(1));
+  TF_EXPECT_OK(writer.Write(updates[1]));
+  EXPECT_THAT(writer.StartNewFile(), IsOkAndHolds(2));
+  TF_EXPECT_OK(writer.Write(updates[2]));
+
+  TF_EXPECT_OK(CheckJournalContent(journal_dir, updates));
+}
+
+TEST(Journal, CheckpointAndTruncate) {
+  std::string journal_dir, checkpoint_dir;
+  EXPECT_TRUE(NewJournalDir(journal_dir));
+  EXPECT_TRUE(NewJournalDir(checkpoint_dir));
+  FileJournalWriter writer(Env::Default(), journal_dir);
+  TF_EXPECT_OK(writer.Write(MakeRegisterDatasetUpdate()));
+  TF_ASSERT_OK_AND_ASSIGN(int64_t sequence_number, writer.StartNewFile());
+  DispatcherStateCheckpoint checkpoint;
+  *checkpoint.add_datasets() = MakeRegisterDatasetUpdate().register_dataset();
+  checkpoint.set_next_available_task_id(10);
+  TF_ASSERT_OK(WriteDispatcherStateCheckpoint(Env::Default(), checkpoint_dir,
+                                              sequence_number, checkpoint));
+  TF_EXPECT_OK(writer.Write(MakeFinishTaskUpdate()));
+  TF_ASSERT_OK(TruncateJournal(Env::Default(), journal_dir, checkpoint_dir,
+                               sequence_number));
+
+  EXPECT_TRUE(errors::IsNotFound(
+      Env::Default()->FileExists(DataServiceJournalFile(journal_dir, 0))));
+  DispatcherStateCheckpoint restored;
+  int64_t restored_sequence_number = -1;
+  TF_ASSERT_OK(ReadLatestDispatcherStateCheckpoint(
+      Env::Default(), checkpoint_dir, restored, restored_sequence_number));
+  EXPECT_EQ(restored_sequence_number, sequence_number);
+  EXPECT_EQ(restored.SerializeAsString(), checkpoint.SerializeAsString());
+
+  FileJournalReader reader(Env::Default(), journal_dir,
+                           restored_sequence_number);
+  Update update;
+  bool end_of_journal = true;
+  TF_ASSERT_OK(reader.Read(update, end_of_journal));
+  EXPECT_FALSE(end_of_journal);
+  EXPECT_EQ(update.SerializeAsString(),
+            MakeFinishTaskUpdate().SerializeAsString());
+  TF_ASSERT_OK(reader.Read(update, end_of_journal));
+  EXPECT_TRUE(end_of_journal);
+}
+
+TEST(Journal, MissingCheckpoint) {
+  std::string checkpoint_dir;
+  EXPECT_TRUE(NewJournalDir(checkpoint_dir));
+  DispatcherStateCheckpoint checkpoint;
+  int64_t sequence_number = 0;
+  TF_ASSERT_OK(ReadLatestDispatcherStateCheckpoint(
+      Env::Default(), checkpoint_dir, checkpoint, sequence_number));
+  EXPECT_EQ(sequence_number, -1);
+}
+
 TEST(Journal, MissingFile) {
   std::string journal_dir;
   EXPECT_TRUE(NewJournalDir(journal_dir));
@@ -152,7 +152,12 @@ WorkerGrpcDataServer::WorkerGrpcDataServer(
                          std::move(options)),
       config_(config) {}
 
-WorkerGrpcDataServer::~WorkerGrpcDataServer() { delete service_; }
+WorkerGrpcDataServer::~WorkerGrpcDataServer() {
+  // The transfer server serves elements from `service_`, so it is shut down
+  // first.
+  transfer_server_.reset();
+  delete service_;
+}
 
 void WorkerGrpcDataServer::AddDataServiceToBuilder(
     ::grpc::ServerBuilder& builder) {
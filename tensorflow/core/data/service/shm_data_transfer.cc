@@ -0,0 +1,768 @@
+/* Copyright 2022 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/data/service/shm_data_transfer.h"
+
+#if defined(__linux__)
+#include <fcntl.h>
+#include <stdlib.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+#endif  // defined(__linux__)
+
+#include <cerrno>
+#include <cstddef>
+#include <cstring>
+#include <functional>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/container/flat_hash_set.h"
+#include "absl/memory/memory.h"
+#include "absl/strings/numbers.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/string_view.h"
+#include "tensorflow/core/data/dataset.pb.h"
+#include "tensorflow/core/data/service/data_transfer.h"
+#include "tensorflow/core/data/service/worker.pb.h"
+#include "tensorflow/core/framework/allocation_description.pb.h"
+#include "tensorflow/core/framework/allocator.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor.pb.h"
+#include "tensorflow/core/framework/tensor_shape.h"
+#include "tensorflow/core/framework/types.h"
+#include "tensorflow/core/framework/variant.h"
+#include "tensorflow/core/lib/core/refcount.h"
+#include "tensorflow/core/lib/gtl/cleanup.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/errors.h"
+#include "tensorflow/core/platform/logging.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/random.h"
+#include "tensorflow/core/platform/status.h"
+#include "tensorflow/core/platform/statusor.h"
+#include "tensorflow/core/platform/thread_annotations.h"
+#include "tensorflow/core/platform/types.h"
+
+namespace tensorflow {
+namespace data {
+
+std::string SharedMemorySocketName(int port) {
+  return absl::StrCat("tf_data_service_shm_", port);
+}
+
+StatusOr<int> ParseSharedMemoryTransferPort(absl::string_view address) {
+  size_t pos = address.rfind(':');
+  absl::string_view port_str =
+      pos == absl::string_view::npos ? address : address.substr(pos + 1);
+  int port = 0;
+  if (!absl::SimpleAtoi(port_str, &port) || port <= 0) {
+    return errors::InvalidArgument(
+        "Failed to parse shared memory transfer address ", address,
+        ". Expected an address of the form <host>:<port>.");
+  }
+  return port;
+}
+
+#if defined(__linux__)
+namespace {
+
+// Server ids are drawn from [1, kMaxServerId].
+constexpr int kMaxServerId = 1 << 30;
+constexpr int kMaxBindAttempts = 100;
+// Upper bound on the size of a frame payload, to detect corrupted frames.
+constexpr uint64 kMaxPayloadBytes = 1ull << 31;
+
+// Every message on the socket is a `FrameHeader` followed by `size` bytes of
+// payload. For successful responses the payload is a serialized proto, and for
+// errors it is the error message.
+struct FrameHeader {
+  int32 code = error::OK;
+  uint32 reserved = 0;
+  uint64 size = 0;
+};
+
+// Rounds `offset` up to the alignment expected for tensor buffers.
+size_t AlignOffset(size_t offset) {
+  constexpr size_t kAlignment = Allocator::kAllocatorAlignment;
+  return (offset + kAlignment - 1) / kAlignment * kAlignment;
+}
+
+sockaddr_un MakeSocketAddress(int port, socklen_t& length) {
+  sockaddr_un addr;
+  memset(&addr, 0, sizeof(addr));
+  addr.sun_family = AF_UNIX;
+  // A leading NUL byte places the socket in the abstract namespace, so that it
+  // is removed automatically when the server exits.
+  std::string name = SharedMemorySocketName(port);
+  memcpy(addr.sun_path + 1, name.data(), name.size());
+  length = offsetof(sockaddr_un, sun_path) + 1 + name.size();
+  return addr;
+}
+
+Status WriteFully(int socket, const char* data, size_t size) {
+  while (size > 0) {
+    ssize_t n = send(socket, data, size, MSG_NOSIGNAL);
+    if (n < 0) {
+      if (errno == EINTR) continue;
+      return errors::IOError("Failed to write to shared memory transfer socket",
+                             errno);
+    }
+    data += n;
+    size -= n;
+  }
+  return OkStatus();
+}
+
+Status ReadFully(int socket, char* data, size_t size) {
+  while (size > 0) {
+    ssize_t n = recv(socket, data, size, 0);
+    if (n < 0) {
+      if (errno == EINTR) continue;
+      return errors::IOError(
+          "Failed to read from shared memory transfer socket", errno);
+    }
+    if (n == 0) {
+      return errors::Unavailable("Shared memory transfer socket was closed.");
+    }
+    data += n;
+    size -= n;
+  }
+  return OkStatus();
+}
+
+// Sends a frame with `code` and `payload`. If `fd` is non-negative, the file
+// descriptor is passed to the peer along with the frame header.
+Status SendFrame(int socket, error::Code code, absl::string_view payload,
+                 int fd) {
+  FrameHeader header;
+  header.code = code;
+  header.size = payload.size();
+  iovec iov;
+  iov.iov_base = &header;
+  iov.iov_len = sizeof(header);
+  msghdr msg;
+  memset(&msg, 0, sizeof(msg));
+  msg.msg_iov = &iov;
+  msg.msg_iovlen = 1;
+  alignas(cmsghdr) char control[CMSG_SPACE(sizeof(int))];
+  if (fd >= 0) {
+    memset(control, 0, sizeof(control));
+    msg.msg_control = control;
+    msg.msg_controllen = sizeof(control);
+    cmsghdr* cmsg = CMSG_FIRSTHDR(&msg);
+    cmsg->cmsg_level = SOL_SOCKET;
+    cmsg->cmsg_type = SCM_RIGHTS;
+    cmsg->cmsg_len = CMSG_LEN(sizeof(int));
+    memcpy(CMSG_DATA(cmsg), &fd, sizeof(int));
+  }
+  ssize_t n;
+  do {
+    n = sendmsg(socket, &msg, MSG_NOSIGNAL);
+  } while (n < 0 && errno == EINTR);
+  if (n < 0) {
+    return errors::IOError("Failed to write to shared memory transfer socket",
+                           errno);
+  }
+  // The descriptor is attached to the first byte sent, so a partial write only
+  // needs the remaining bytes to follow.
+  TF_RETURN_IF_ERROR(WriteFully(
+      socket, reinterpret_cast<const char*>(&header) + n, sizeof(header) - n));
+  return WriteFully(socket, payload.data(), payload.size());
+}
+
+// Receives a frame into `header` and `payload`. If the peer passed a file
+// descriptor, it is returned in `fd`; otherwise `fd` is set to -1.
+Status ReceiveFrame(int socket, FrameHeader& header, std::string& payload,
+                    int& fd) {
+  fd = -1;
+  iovec iov;
+  iov.iov_base = &header;
+  iov.iov_len = sizeof(header);
+  msghdr msg;
+  memset(&msg, 0, sizeof(msg));
+  msg.msg_iov = &iov;
+  msg.msg_iovlen = 1;
+  alignas(cmsghdr) char control[CMSG_SPACE(sizeof(int))];
+  msg.msg_control = control;
+  msg.msg_controllen = sizeof(control);
+  ssize_t n;
+  do {
+    n = recvmsg(socket, &msg, MSG_CMSG_CLOEXEC);
+  } while (n < 0 && errno == EINTR);
+  if (n < 0) {
+    return errors::IOError("Failed to read from shared memory transfer socket",
+                           errno);
+  }
+  if (n == 0) {
+    return errors::Unavailable("Shared memory transfer socket was closed.");
+  }
+  for (cmsghdr* cmsg = CMSG_FIRSTHDR(&msg); cmsg != nullptr;
+       cmsg = CMSG_NXTHDR(&msg, cmsg)) {
+    if (cmsg->cmsg_level == SOL_SOCKET && cmsg->cmsg_type == SCM_RIGHTS) {
+      memcpy(&fd, CMSG_DATA(cmsg), sizeof(int));
+    }
+  }
+  Status s = ReadFully(socket, reinterpret_cast<char*>(&header) + n,
+                       sizeof(header) - n);
+  if (s.ok() && header.size > kMaxPayloadBytes) {
+    s = errors::DataLoss("Received a shared memory transfer frame of ",
+                         header.size, " bytes, which exceeds the limit of ",
+                         kMaxPayloadBytes, " bytes.");
+  }
+  if (s.ok()) {
+    payload.resize(header.size);
+    s = ReadFully(socket, &payload[0], header.size);
+  }
+  if (!s.ok() && fd >= 0) {
+    close(fd);
+    fd = -1;
+  }
+  return s;
+}
+
+// Creates an anonymous shared memory file of `size` bytes.
+StatusOr<int> CreateSharedMemoryFile(size_t size) {
+#if defined(MFD_CLOEXEC)
+  int fd = memfd_create("tf_data_transfer", MFD_CLOEXEC);
+#else
+  char path[] = "/dev/shm/tf_data_transfer_XXXXXX";
+  int fd = mkostemp(path, O_CLOEXEC);
+  if (fd >= 0) {
+    unlink(path);
+  }
+#endif  // defined(MFD_CLOEXEC)
+  if (fd < 0) {
+    return errors::IOError("Failed to create shared memory file", errno);
+  }
+  if (ftruncate(fd, size) != 0) {
+    int error_number = errno;
+    close(fd);
+    return errors::IOError("Failed to resize shared memory file", error_number);
+  }
+  return fd;
+}
+
+Status WriteAt(int fd, const char* data, size_t size, size_t offset) {
+  while (size > 0) {
+    ssize_t n = pwrite(fd, data, size, offset);
+    if (n < 0) {
+      if (errno == EINTR) continue;
+      return errors::IOError("Failed to write to shared memory file", errno);
+    }
+    data += n;
+    size -= n;
+    offset += n;
+  }
+  return OkStatus();
+}
+
+// Fills `response` with the metadata of `result`. The buffers of memcpy-able
+// components are written to a new shared memory file, whose descriptor is
+// returned in `fd`. If there are no such buffers, `fd` is set to -1.
+Status EncodeElement(GetElementResult& result, GetElementResponse& response,
+                     int& fd) {
+  fd = -1;
+  response.set_element_index(result.element_index);
+  response.set_end_of_sequence(result.end_of_sequence);
+  response.set_skip_task(result.skip);
+  if (result.end_of_sequence || result.skip) {
+    return OkStatus();
+  }
+  std::vector<Tensor> components;
+  if (!result.additional_elements.empty()) {
+    response.set_batch_size(BatchSize(result));
+    components = FlattenBatch(result);
+  } else {
+    components = std::move(result.components);
+  }
+  if (response.batch_size() == 0 && components.size() == 1 &&
+      components[0].dtype() == DT_VARIANT &&
+      TensorShapeUtils::IsScalar(components[0].shape())) {
+    CompressedElement* compressed =
+        components[0].scalar<Variant>()().get<CompressedElement>();
+    if (compressed != nullptr) {
+      *response.mutable_compressed() = std::move(*compressed);
+      return OkStatus();
+    }
+  }
+  UncompressedElement* uncompressed = response.mutable_uncompressed();
+  size_t total_bytes = 0;
+  for (const Tensor& component : components) {
+    TensorProto* proto = uncompressed->add_components();
+    if (DataTypeCanUseMemcpy(component.dtype())) {
+      proto->set_dtype(component.dtype());
+      component.shape().AsProto(proto->mutable_tensor_shape());
+      total_bytes = AlignOffset(total_bytes) + component.TotalBytes();
+    } else {
+      component.AsProtoField(proto);
+    }
+  }
+  if (total_bytes == 0) {
+    return OkStatus();
+  }
+  TF_ASSIGN_OR_RETURN(fd, CreateSharedMemoryFile(total_bytes));
+  size_t offset = 0;
+  for (const Tensor& component : components) {
+    if (!DataTypeCanUseMemcpy(component.dtype())) {
+      continue;
+    }
+    offset = AlignOffset(offset);
+    StringPiece data = component.tensor_data();
+    Status s = WriteAt(fd, data.data(), data.size(), offset);
+    if (!s.ok()) {
+      close(fd);
+      fd = -1;
+      return s;
+    }
+    offset += data.size();
+  }
+  return OkStatus();
+}
+
+// A mapping of a shared memory file received from the server.
+class SharedMemoryRegion : public core::RefCounted {
+ public:
+  SharedMemoryRegion(void* base, size_t size) : base_(base), size_(size) {}
+  ~SharedMemoryRegion() override { munmap(base_, size_); }
+
+  char* base() const { return static_cast<char*>(base_); }
+
+ private:
+  void* const base_;
+  const size_t size_;
+};
+
+// A tensor buffer backed by a slice of a `SharedMemoryRegion`. The region is
+// unmapped once all buffers referencing it are released.
+class SharedMemoryTensorBuffer : public TensorBuffer {
+ public:
+  SharedMemoryTensorBuffer(SharedMemoryRegion* region, size_t offset,
+                           size_t size)
+      : TensorBuffer(region->base() + offset), region_(region), size_(size) {
+    region_->Ref();
+  }
+  ~SharedMemoryTensorBuffer() override { region_->Unref(); }
+
+  size_t size() const override { return size_; }
+  TensorBuffer* root_buffer() override { return this; }
+  void FillAllocationDescription(AllocationDescription* proto) const override {
+    proto->set_requested_bytes(size_);
+    proto->set_allocator_name("shared_memory");
+  }
+
+ private:
+  SharedMemoryRegion* const region_;
+  const size_t size_;
+};
+
+// Fills `result` from `response`, wrapping the memcpy-able components around
+// the shared memory file `fd`. Takes ownership of `fd`.
+Status DecodeElement(GetElementResponse& response, int fd,
+                     GetElementResult& result) {
+  auto close_fd = gtl::MakeCleanup([fd] {
+    if (fd >= 0) {
+      close(fd);
+    }
+  });
+  result.element_index = response.element_index();
+  result.end_of_sequence = response.end_of_sequence();
+  result.skip = response.skip_task();
+  if (response.has_compressed()) {
+    Tensor tensor(DT_VARIANT, TensorShape{});
+    tensor.scalar<Variant>()() = std::move(*response.mutable_compressed());
+    result.components.push_back(std::move(tensor));
+    return OkStatus();
+  }
+  const UncompressedElement& uncompressed = response.uncompressed();
+  std::vector<TensorShape> shapes(uncompressed.components_size());
+  size_t total_bytes = 0;
+  for (int i = 0; i < uncompressed.components_size(); ++i) {
+    const TensorProto& proto = uncompressed.components(i);
+    if (!DataTypeCanUseMemcpy(proto.dtype())) {
+      continue;
+    }
+    TF_RETURN_IF_ERROR(
+        TensorShape::BuildTensorShapeBase(proto.tensor_shape(), &shapes[i]));
+    total_bytes = AlignOffset(total_bytes) +
+                  shapes[i].num_elements() * DataTypeSize(proto.dtype());
+  }
+  core::RefCountPtr<SharedMemoryRegion> region;
+  if (total_bytes > 0) {
+    struct stat file_stat;
+    if (fd < 0 || fstat(fd, &file_stat) != 0 ||
+        static_cast<size_t>(file_stat.st_size) < total_bytes) {
+      return errors::DataLoss(
+          "Shared memory transfer server did not provide the ", total_bytes,
+          " bytes of element data described by the response.");
+    }
+    // The mapping is private so that kernels may forward and overwrite the
+    // received buffers without affecting the file.
+    void* base = mmap(nullptr, total_bytes, PROT_READ | PROT_WRITE,
+                      MAP_PRIVATE, fd, 0);
+    if (base == MAP_FAILED) {
+      return errors::IOError("Failed to map shared memory file", errno);
+    }
+    region.reset(new SharedMemoryRegion(base, total_bytes));
+  }
+  std::vector<Tensor> components;
+  components.reserve(uncompressed.components_size());
+  size_t offset = 0;
+  for (int i = 0; i < uncompressed.components_size(); ++i) {
+    const TensorProto& proto = uncompressed.components(i);
+    if (!DataTypeCanUseMemcpy(proto.dtype())) {
+      components.emplace_back();
+      if (!components.back().FromProto(proto)) {
+        return errors::Internal("Failed to parse tensor.");
+      }
+      continue;
+    }
+    const size_t num_bytes =
+        shapes[i].num_elements() * DataTypeSize(proto.dtype());
+    if (num_bytes == 0) {
+      components.emplace_back(proto.dtype(), shapes[i]);
+      continue;
+    }
+    offset = AlignOffset(offset);
+    auto* buffer =
+        new SharedMemoryTensorBuffer(region.get(), offset, num_bytes);
+    components.emplace_back(proto.dtype(), shapes[i], buffer);
+    buffer->Unref();
+    offset += num_bytes;
+  }
+  return UnflattenBatch(std::move(components), response.batch_size(), result);
+}
+
+class SharedMemoryDataTransferServer : public DataTransferServer {
+ public:
+  explicit SharedMemoryDataTransferServer(GetElementT get_element)
+      : get_element_(std::move(get_element)) {}
+
+  ~SharedMemoryDataTransferServer() override { Stop(); }
+
+  Status Start() override {
+    mutex_lock l(mu_);
+    if (listen_fd_ >= 0) {
+      return errors::FailedPrecondition(
+          "Shared memory transfer server has already been started.");
+    }
+    int fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (fd < 0) {
+      return errors::IOError("Failed to create shared memory transfer socket",
+                             errno);
+    }
+    for (int attempt = 0; attempt < kMaxBindAttempts && port_ == 0;
+         ++attempt) {
+      int port = static_cast<int>(random::New64() % kMaxServerId) + 1;
+      socklen_t length;
+      sockaddr_un addr = MakeSocketAddress(port, length);
+      if (bind(fd, reinterpret_cast<sockaddr*>(&addr), length) == 0) {
+        port_ = port;
+      } else if (errno != EADDRINUSE) {
+        int error_number = errno;
+        close(fd);
+        return errors::IOError("Failed to bind shared memory transfer socket",
+                               error_number);
+      }
+    }
+    if (port_ == 0) {
+      close(fd);
+      return errors::Unavailable(
+          "Failed to find an unused shared memory transfer server id after ",
+          kMaxBindAttempts, " attempts.");
+    }
+    if (listen(fd, SOMAXCONN) != 0) {
+      int error_number = errno;
+      close(fd);
+      return errors::IOError(
+          "Failed to listen on shared memory transfer socket", error_number);
+    }
+    listen_fd_ = fd;
+    accept_thread_ = absl::WrapUnique(Env::Default()->StartThread(
+        {}, "tf_data_shm_transfer_server", [this, fd] { AcceptLoop(fd); }));
+    VLOG(1) << "Started shared memory transfer server on socket "
+            << SharedMemorySocketName(port_);
+    return OkStatus();
+  }
+
+  int get_port() override {
+    mutex_lock l(mu_);
+    return port_;
+  }
+
+ private:
+  void Stop() TF_LOCKS_EXCLUDED(mu_) {
+    std::unique_ptr<Thread> accept_thread;
+    absl::flat_hash_map<int64_t, std::unique_ptr<Thread>> connection_threads;
+    {
+      mutex_lock l(mu_);
+      cancelled_ = true;
+      if (listen_fd_ >= 0) {
+        shutdown(listen_fd_, SHUT_RDWR);
+      }
+      for (int fd : connection_fds_) {
+        shutdown(fd, SHUT_RDWR);
+      }
+      accept_thread = std::move(accept_thread_);
+    }
+    // Joins the accept thread before collecting the connection threads, since
+    // it may still be registering a new connection.
+    accept_thread.reset();
+    {
+      mutex_lock l(mu_);
+      connection_threads = std::move(connection_threads_);
+    }
+    connection_threads.clear();
+    mutex_lock l(mu_);
+    if (listen_fd_ >= 0) {
+      close(listen_fd_);
+      listen_fd_ = -1;
+    }
+  }
+
+  void AcceptLoop(int listen_fd) TF_LOCKS_EXCLUDED(mu_) {
+    while (true) {
+      int fd = accept4(listen_fd, nullptr, nullptr, SOCK_CLOEXEC);
+      const int accept_errno = errno;
+      std::vector<std::unique_ptr<Thread>> finished_threads;
+      mutex_lock l(mu_);
+      if (cancelled_) {
+        if (fd >= 0) {
+          close(fd);
+        }
+        return;
+      }
+      if (fd < 0) {
+        if (accept_errno == EINTR || accept_errno == ECONNABORTED) {
+          continue;
+        }
+        LOG(ERROR) << "Shared memory transfer server stopped accepting "
+                   << "connections: " << strerror(accept_errno);
+        return;
+      }
+      // Reaps the threads of connections which have been closed. They are
+      // joined outside of `mu_` when `finished_threads` goes out of scope.
+      for (int64_t id : finished_connections_) {
+        auto it = connection_threads_.find(id);
+        if (it != connection_threads_.end()) {
+          finished_threads.push_back(std::move(it->second));
+          connection_threads_.erase(it);
+        }
+      }
+      finished_connections_.clear();
+      const int64_t id = next_connection_id_++;
+      connection_fds_.insert(fd);
+      connection_threads_[id] = absl::WrapUnique(Env::Default()->StartThread(
+          {}, "tf_data_shm_transfer_connection",
+          [this, id, fd] { ServeConnection(id, fd); }));
+    }
+  }
+
+  void ServeConnection(int64_t id, int fd) TF_LOCKS_EXCLUDED(mu_) {
+    while (true) {
+      FrameHeader header;
+      std::string payload;
+      int unused_fd;
+      Status s = ReceiveFrame(fd, header, payload, unused_fd);
+      if (unused_fd >= 0) {
+        close(unused_fd);
+      }
+      if (s.ok()) {
+        s = HandleRequest(fd, payload);
+      }
+      if (!s.ok()) {
+        VLOG(2) << "Closing shared memory transfer connection: " << s;
+        break;
+      }
+    }
+    {
+      mutex_lock l(mu_);
+      connection_fds_.erase(fd);
+      finished_connections_.push_back(id);
+    }
+    close(fd);
+  }
+
+  Status HandleRequest(int fd, const std::string& payload) {
+    GetElementRequest request;
+    if (!request.ParseFromString(payload)) {
+      return SendFrame(fd, error::INVALID_ARGUMENT,
+                       "Failed to parse GetElementRequest.", /*fd=*/-1);
+    }
+    GetElementResult result;
+    Status s = get_element_(&request, &result);
+    GetElementResponse response;
+    int element_fd = -1;
+    if (s.ok()) {
+      s = EncodeElement(result, response, element_fd);
+    }
+    if (!s.ok()) {
+      return SendFrame(fd, s.code(), s.error_message(), /*fd=*/-1);
+    }
+    std::string serialized;
+    if (!response.SerializeToString(&serialized)) {
+      s = errors::Internal("Failed to serialize GetElementResponse.");
+    } else {
+      s = SendFrame(fd, error::OK, serialized, element_fd);
+    }
+    if (element_fd >= 0) {
+      close(element_fd);
+    }
+    return s;
+  }
+
+  const GetElementT get_element_;
+
+  mutex mu_;
+  int listen_fd_ TF_GUARDED_BY(mu_) = -1;
+  int port_ TF_GUARDED_BY(mu_) = 0;
+  bool cancelled_ TF_GUARDED_BY(mu_) = false;
+  std::unique_ptr<Thread> accept_thread_ TF_GUARDED_BY(mu_);
+  int64_t next_connection_id_ TF_GUARDED_BY(mu_) = 0;
+  // Sockets of the open connections, used to unblock them on shutdown.
+  absl::flat_hash_set<int> connection_fds_ TF_GUARDED_BY(mu_);
+  absl::flat_hash_map<int64_t, std::unique_ptr<Thread>> connection_threads_
+      TF_GUARDED_BY(mu_);
+  // Ids of connections whose threads have finished and can be joined.
+  std::vector<int64_t> finished_connections_ TF_GUARDED_BY(mu_);
+};
+
+class SharedMemoryDataTransferClient : public DataTransferClient {
+ public:
+  static Status Create(Config config,
+                       std::unique_ptr<DataTransferClient>* out) {
+    TF_ASSIGN_OR_RETURN(int port,
+                        ParseSharedMemoryTransferPort(config.address));
+    int fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (fd < 0) {
+      return errors::IOError("Failed to create shared memory transfer socket",
+                             errno);
+    }
+    socklen_t length;
+    sockaddr_un addr = MakeSocketAddress(port, length);
+    int result;
+    do {
+      result = connect(fd, reinterpret_cast<sockaddr*>(&addr), length);
+    } while (result != 0 && errno == EINTR);
+    if (result != 0) {
+      int error_number = errno;
+      close(fd);
+      return errors::Unavailable(
+          "Failed to connect to shared memory transfer server at ",
+          config.address, ": ", strerror(error_number),
+          ". The shared memory transfer protocol requires the client to run "
+          "on the same host as the tf.data service worker.");
+    }
+    *out = absl::WrapUnique(
+        new SharedMemoryDataTransferClient(config.address, fd));
+    return OkStatus();
+  }
+
+  ~SharedMemoryDataTransferClient() override { close(fd_); }
+
+  Status GetElement(const GetElementRequest& req,
+                    GetElementResult& result) override {
+    VLOG(3) << "GetElement for task " << req.task_id() << " from shared "
+            << "memory transfer server " << address_ << ".";
+    // Requests share one connection, so only one may be in flight at a time.
+    mutex_lock l(mu_);
+    TF_RETURN_IF_ERROR(VerifyClientIsNotCancelled());
+    std::string request;
+    if (!req.SerializeToString(&request)) {
+      return errors::Internal("Failed to serialize GetElementRequest.");
+    }
+    FrameHeader header;
+    std::string payload;
+    int element_fd = -1;
+    Status s = SendFrame(fd_, error::OK, request, /*fd=*/-1);
+    if (s.ok()) {
+      s = ReceiveFrame(fd_, header, payload, element_fd);
+    }
+    if (!s.ok()) {
+      TF_RETURN_IF_ERROR(VerifyClientIsNotCancelled());
+      return s;
+    }
+    if (header.code != error::OK) {
+      if (element_fd >= 0) {
+        close(element_fd);
+      }
+      return Status(static_cast<error::Code>(header.code), payload);
+    }
+    GetElementResponse response;
+    if (!response.ParseFromString(payload)) {
+      if (element_fd >= 0) {
+        close(element_fd);
+      }
+      return errors::DataLoss("Failed to parse GetElementResponse.");
+    }
+    return DecodeElement(response, element_fd, result);
+  }
+
+  void TryCancel() override {
+    VLOG(2) << "Cancel SharedMemoryDataTransferClient for worker " << address_
+            << ".";
+    mutex_lock l(cancel_mu_);
+    cancelled_ = true;
+    // Unblocks any request waiting on the server.
+    shutdown(fd_, SHUT_RDWR);
+  }
+
+ private:
+  SharedMemoryDataTransferClient(absl::string_view address, int fd)
+      : address_(address), fd_(fd) {}
+
+  Status VerifyClientIsNotCancelled() TF_LOCKS_EXCLUDED(cancel_mu_) {
+    mutex_lock l(cancel_mu_);
+    if (cancelled_) {
+      return errors::Cancelled("Client for worker ", address_,
+                               " has been cancelled.");
+    }
+    return OkStatus();
+  }
+
+  const std::string address_;
+  const int fd_;
+
+  // Serializes requests on `fd_`.
+  mutex mu_;
+  mutex cancel_mu_;
+  bool cancelled_ TF_GUARDED_BY(cancel_mu_) = false;
+};
+
+class SharedMemoryTransferRegistrar {
+ public:
+  SharedMemoryTransferRegistrar() {
+    DataTransferServer::Register(
+        kSharedMemoryTransferProtocol,
+        [](DataTransferServer::GetElementT get_element) {
+          return std::make_shared<SharedMemoryDataTransferServer>(
+              std::move(get_element));
+        });
+    DataTransferClient::Register(kSharedMemoryTransferProtocol,
+                                 SharedMemoryDataTransferClient::Create);
+  }
+};
+static SharedMemoryTransferRegistrar shm_transfer_registrar;
+
+}  // namespace
+#endif  // defined(__linux__)
+
+}  // namespace data
+}  // namespace tensorflow
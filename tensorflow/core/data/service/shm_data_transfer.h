@@ -0,0 +1,50 @@
+/* Copyright 2022 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_CORE_DATA_SERVICE_SHM_DATA_TRANSFER_H_
+#define TENSORFLOW_CORE_DATA_SERVICE_SHM_DATA_TRANSFER_H_
+
+#include <string>
+
+#include "absl/strings/string_view.h"
+#include "tensorflow/core/platform/statusor.h"
+
+namespace tensorflow {
+namespace data {
+
+// Data transfer protocol for clients colocated with the tf.data service worker.
+//
+// Requests and element metadata travel over a Unix domain socket, while the
+// tensor buffers of each element are written to an anonymous shared memory
+// file whose descriptor is passed to the client. The client maps the file and
+// wraps the mapping in tensors directly, so memcpy-able components are never
+// serialized. Components that cannot be memcpy'd (e.g. strings and variants)
+// and compressed elements fall back to proto encoding.
+//
+// The server is only available on Linux. Its "port" is the id of the abstract
+// socket it listens on, so the worker's `data_transfer_address` should be set
+// to "localhost:%port%".
+constexpr const char kSharedMemoryTransferProtocol[] = "shm";
+
+// Returns the name of the abstract Unix domain socket a shared memory transfer
+// server with id `port` listens on.
+std::string SharedMemorySocketName(int port);
+
+// Parses the server id from a transfer address of the form "<host>:<port>".
+StatusOr<int> ParseSharedMemoryTransferPort(absl::string_view address);
+
+}  // namespace data
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_DATA_SERVICE_SHM_DATA_TRANSFER_H_
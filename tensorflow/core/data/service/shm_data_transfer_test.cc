@@ -0,0 +1,153 @@
+/* Copyright 2022 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/data/service/shm_data_transfer.h"
+
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "absl/strings/str_cat.h"
+#include "tensorflow/core/data/service/data_transfer.h"
+#include "tensorflow/core/data/service/worker.pb.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_shape.h"
+#include "tensorflow/core/framework/tensor_testutil.h"
+#include "tensorflow/core/framework/types.pb.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/errors.h"
+#include "tensorflow/core/platform/status.h"
+#include "tensorflow/core/platform/status_matchers.h"
+#include "tensorflow/core/platform/test.h"
+#include "tensorflow/core/protobuf/error_codes.pb.h"
+
+namespace tensorflow {
+namespace data {
+namespace {
+
+using ::tensorflow::testing::IsOkAndHolds;
+using ::tensorflow::testing::StatusIs;
+using ::testing::HasSubstr;
+
+TEST(SharedMemoryDataTransferTest, ParsePort) {
+  EXPECT_THAT(ParseSharedMemoryTransferPort("localhost:1234"),
+              IsOkAndHolds(1234));
+  EXPECT_THAT(ParseSharedMemoryTransferPort("5678"), IsOkAndHolds(5678));
+  EXPECT_THAT(ParseSharedMemoryTransferPort("localhost:port"),
+              StatusIs(error::INVALID_ARGUMENT));
+  EXPECT_THAT(ParseSharedMemoryTransferPort("localhost:0"),
+              StatusIs(error::INVALID_ARGUMENT));
+}
+
+#if defined(__linux__)
+
+class SharedMemoryDataTransferServerTest : public ::testing::Test {
+ protected:
+  // Starts a server whose elements are produced by `get_element`, and a client
+  // connected to it.
+  void StartServer(DataTransferServer::GetElementT get_element) {
+    TF_ASSERT_OK(DataTransferServer::Build(kSharedMemoryTransferProtocol,
+                                           std::move(get_element), &server_));
+    TF_ASSERT_OK(server_->Start());
+    TF_ASSERT_OK(DataTransferClient::Build(
+        kSharedMemoryTransferProtocol,
+        {/*protocol=*/"grpc",
+         /*address=*/absl::StrCat("localhost:", server_->get_port())},
+        &client_));
+  }
+
+  std::shared_ptr<DataTransferServer> server_;
+  std::unique_ptr<DataTransferClient> client_;
+};
+
+TEST_F(SharedMemoryDataTransferServerTest, GetElement) {
+  Tensor int_tensor = test::AsTensor<int64_t>({1, 2, 3, 4, 5, 6}, {2, 3});
+  Tensor float_tensor = test::AsTensor<float>({1.5, 2.5});
+  Tensor string_tensor = test::AsScalar<tstring>("element");
+  Tensor empty_tensor(DT_FLOAT, TensorShape({0, 4}));
+  StartServer([&](const GetElementRequest* request, GetElementResult* result) {
+    result->components = {int_tensor, string_tensor, float_tensor,
+                          empty_tensor};
+    result->element_index = request->task_id();
+    return OkStatus();
+  });
+
+  GetElementRequest request;
+  request.set_task_id(7);
+  for (int i = 0; i < 3; ++i) {
+    GetElementResult result;
+    TF_ASSERT_OK(client_->GetElement(request, result));
+    EXPECT_FALSE(result.end_of_sequence);
+    EXPECT_EQ(result.element_index, 7);
+    ASSERT_EQ(result.components.size(), 4);
+    test::ExpectEqual(result.components[0], int_tensor);
+    test::ExpectEqual(result.components[1], string_tensor);
+    test::ExpectEqual(result.components[2], float_tensor);
+    test::ExpectEqual(result.components[3], empty_tensor);
+  }
+}
+
+TEST_F(SharedMemoryDataTransferServerTest, EndOfSequence) {
+  StartServer([](const GetElementRequest* request, GetElementResult* result) {
+    result->end_of_sequence = true;
+    return OkStatus();
+  });
+
+  GetElementResult result;
+  TF_ASSERT_OK(client_->GetElement(GetElementRequest(), result));
+  EXPECT_TRUE(result.end_of_sequence);
+  EXPECT_TRUE(result.components.empty());
+}
+
+TEST_F(SharedMemoryDataTransferServerTest, PropagatesErrors) {
+  StartServer([](const GetElementRequest* request, GetElementResult* result) {
+    return errors::FailedPrecondition("Task ", request->task_id(),
+                                      " has been deleted.");
+  });
+
+  GetElementRequest request;
+  request.set_task_id(3);
+  GetElementResult result;
+  EXPECT_THAT(client_->GetElement(request, result),
+              StatusIs(error::FAILED_PRECONDITION,
+                       HasSubstr("Task 3 has been deleted.")));
+}
+
+TEST_F(SharedMemoryDataTransferServerTest, Cancel) {
+  StartServer([](const GetElementRequest* request, GetElementResult* result) {
+    result->components = {test::AsScalar<int64_t>(1)};
+    return OkStatus();
+  });
+
+  client_->TryCancel();
+  GetElementResult result;
+  EXPECT_THAT(client_->GetElement(GetElementRequest(), result),
+              StatusIs(error::CANCELLED));
+}
+
+TEST(SharedMemoryDataTransferClientTest, ServerNotFound) {
+  std::unique_ptr<DataTransferClient> client;
+  EXPECT_THAT(DataTransferClient::Build(kSharedMemoryTransferProtocol,
+                                        {/*protocol=*/"grpc",
+                                         /*address=*/"localhost:1"},
+                                        &client),
+              StatusIs(error::UNAVAILABLE));
+}
+
+#endif  // defined(__linux__)
+
+}  // namespace
+}  // namespace data
+}  // namespace tensorflow
@@ -0,0 +1,94 @@
+/* Copyright 2022 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/data/service/split_assignment_tracker.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <string>
+
+namespace tensorflow {
+namespace data {
+
+void SplitAssignmentTracker::RecordSplitRequest(
+    int64_t iteration_id, const std::string& worker_address,
+    int64_t now_micros) {
+  auto [it, inserted] = rates_[iteration_id].try_emplace(worker_address);
+  WorkerRate& rate = it->second;
+  if (!inserted) {
+    const double interval =
+        std::max<int64_t>(now_micros - rate.last_request_micros, 0);
+    rate.split_interval_micros =
+        rate.split_interval_micros == 0.0
+            ? interval
+            : kSmoothingFactor * interval +
+                  (1 - kSmoothingFactor) * rate.split_interval_micros;
+  }
+  rate.last_request_micros = now_micros;
+}
+
+void SplitAssignmentTracker::RecordNumSplits(const std::string& dataset_id,
+                                             int64_t split_provider_index,
+                                             int64_t num_splits) {
+  num_splits_[{dataset_id, split_provider_index}] = num_splits;
+}
+
+int64_t SplitAssignmentTracker::DeferralMicros(
+    int64_t iteration_id, const std::string& dataset_id,
+    int64_t split_provider_index, int64_t splits_produced,
+    const std::string& worker_address) const {
+  auto num_splits_it = num_splits_.find({dataset_id, split_provider_index});
+  auto rates_it = rates_.find(iteration_id);
+  if (num_splits_it == num_splits_.end() || rates_it == rates_.end()) {
+    return 0;
+  }
+  const int64_t remaining_splits = num_splits_it->second - splits_produced;
+  if (remaining_splits <= 0) {
+    return 0;
+  }
+  const auto& worker_rates = rates_it->second;
+  auto worker_it = worker_rates.find(worker_address);
+  if (worker_it == worker_rates.end() ||
+      worker_it->second.split_interval_micros == 0.0) {
+    return 0;
+  }
+  const double worker_interval = worker_it->second.split_interval_micros;
+
+  // Throughput of the workers which are more than `kStragglerRatio` times
+  // faster than this worker, in splits per microsecond.
+  double faster_throughput = 0.0;
+  for (const auto& [address, rate] : worker_rates) {
+    if (address != worker_address && rate.split_interval_micros > 0.0 &&
+        rate.split_interval_micros * kStragglerRatio < worker_interval) {
+      faster_throughput += 1.0 / rate.split_interval_micros;
+    }
+  }
+  if (faster_throughput == 0.0) {
+    return 0;
+  }
+  const double drain_micros = remaining_splits / faster_throughput;
+  if (drain_micros >= worker_interval) {
+    // The remaining splits take longer to drain than this worker takes to
+    // process one, so it is not holding back the epoch.
+    return 0;
+  }
+  return std::max<int64_t>(static_cast<int64_t>(drain_micros), 1);
+}
+
+void SplitAssignmentTracker::RemoveIteration(int64_t iteration_id) {
+  rates_.erase(iteration_id);
+}
+
+}  // namespace data
+}  // namespace tensorflow
@@ -0,0 +1,91 @@
+/* Copyright 2022 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_CORE_DATA_SERVICE_SPLIT_ASSIGNMENT_TRACKER_H_
+#define TENSORFLOW_CORE_DATA_SERVICE_SPLIT_ASSIGNMENT_TRACKER_H_
+
+#include <cstdint>
+#include <string>
+#include <utility>
+
+#include "absl/container/flat_hash_map.h"
+
+namespace tensorflow {
+namespace data {
+
+// Tracks how fast each worker consumes the splits of distributed_epoch
+// iterations, to keep slow workers from becoming stragglers at the end of an
+// epoch.
+//
+// Splits are pulled by workers, so faster workers already receive more splits
+// while the epoch is in progress. The problem is the tail: if a slow worker
+// pulls one of the last splits, the epoch has to wait for it to finish even
+// though faster workers are idle. Once the number of splits per repetition of a
+// dataset is known (after its first repetition completes), `Deferral` holds
+// back a straggler's request if the faster workers are expected to produce all
+// remaining splits before the straggler would produce a single one.
+//
+// This class is not thread-safe.
+class SplitAssignmentTracker {
+ public:
+  // A worker is considered a straggler for the tail of an epoch if it takes
+  // more than `kStragglerRatio` times longer than the fastest worker to consume
+  // a split.
+  static constexpr double kStragglerRatio = 2.0;
+
+  // Records that `worker_address` requested a split of `iteration_id` at
+  // `now_micros`.
+  void RecordSplitRequest(int64_t iteration_id,
+                          const std::string& worker_address,
+                          int64_t now_micros);
+
+  // Records that a repetition of the split provider at `split_provider_index`
+  // of `dataset_id` produced `num_splits` splits.
+  void RecordNumSplits(const std::string& dataset_id,
+                       int64_t split_provider_index, int64_t num_splits);
+
+  // Returns how many microseconds to hold back the split request of
+  // `worker_address`, given that `splits_produced` splits of the current
+  // repetition have been produced. Returns 0 if the request should be served
+  // immediately.
+  int64_t DeferralMicros(int64_t iteration_id, const std::string& dataset_id,
+                         int64_t split_provider_index, int64_t splits_produced,
+                         const std::string& worker_address) const;
+
+  // Removes the state of `iteration_id`.
+  void RemoveIteration(int64_t iteration_id);
+
+ private:
+  struct WorkerRate {
+    int64_t last_request_micros = 0;
+    // Exponential moving average of the time between split requests. 0 if the
+    // worker has made fewer than two requests.
+    double split_interval_micros = 0.0;
+  };
+
+  // Weight of the latest interval in the moving average.
+  static constexpr double kSmoothingFactor = 0.3;
+
+  // Split request rates, keyed by iteration id and worker address.
+  absl::flat_hash_map<int64_t, absl::flat_hash_map<std::string, WorkerRate>>
+      rates_;
+  // Number of splits per repetition, keyed by dataset id and split provider
+  // index.
+  absl::flat_hash_map<std::pair<std::string, int64_t>, int64_t> num_splits_;
+};
+
+}  // namespace data
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_DATA_SERVICE_SPLIT_ASSIGNMENT_TRACKER_H_
@@ -0,0 +1,97 @@
+/* Copyright 2022 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/data/service/split_assignment_tracker.h"
+
+#include <cstdint>
+
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace data {
+namespace {
+
+constexpr int64_t kIterationId = 1;
+constexpr char kDatasetId[] = "dataset_id";
+constexpr int64_t kProviderIndex = 0;
+constexpr char kFastWorker[] = "fast";
+constexpr char kSlowWorker[] = "slow";
+
+// Records split requests of a fast worker every 10ms and a slow worker every
+// 100ms, for one second.
+void RecordRequests(SplitAssignmentTracker& tracker) {
+  for (int64_t micros = 0; micros <= 1000 * 1000; micros += 10 * 1000) {
+    tracker.RecordSplitRequest(kIterationId, kFastWorker, micros);
+    if (micros % (100 * 1000) == 0) {
+      tracker.RecordSplitRequest(kIterationId, kSlowWorker, micros);
+    }
+  }
+}
+
+TEST(SplitAssignmentTrackerTest, DeferStragglerAtTail) {
+  SplitAssignmentTracker tracker;
+  RecordRequests(tracker);
+  tracker.RecordNumSplits(kDatasetId, kProviderIndex, /*num_splits=*/100);
+  // The fast worker produces the 5 remaining splits in 50ms, before the slow
+  // worker would finish one split.
+  EXPECT_EQ(tracker.DeferralMicros(kIterationId, kDatasetId, kProviderIndex,
+                                   /*splits_produced=*/95, kSlowWorker),
+            50 * 1000);
+  EXPECT_EQ(tracker.DeferralMicros(kIterationId, kDatasetId, kProviderIndex,
+                                   /*splits_produced=*/95, kFastWorker),
+            0);
+}
+
+TEST(SplitAssignmentTrackerTest, DontDeferBeforeTail) {
+  SplitAssignmentTracker tracker;
+  RecordRequests(tracker);
+  tracker.RecordNumSplits(kDatasetId, kProviderIndex, /*num_splits=*/100);
+  EXPECT_EQ(tracker.DeferralMicros(kIterationId, kDatasetId, kProviderIndex,
+                                   /*splits_produced=*/50, kSlowWorker),
+            0);
+}
+
+TEST(SplitAssignmentTrackerTest, DontDeferWithUnknownNumSplits) {
+  SplitAssignmentTracker tracker;
+  RecordRequests(tracker);
+  EXPECT_EQ(tracker.DeferralMicros(kIterationId, kDatasetId, kProviderIndex,
+                                   /*splits_produced=*/95, kSlowWorker),
+            0);
+}
+
+TEST(SplitAssignmentTrackerTest, DontDeferSimilarWorkers) {
+  SplitAssignmentTracker tracker;
+  for (int64_t micros = 0; micros <= 1000 * 1000; micros += 10 * 1000) {
+    tracker.RecordSplitRequest(kIterationId, kFastWorker, micros);
+    tracker.RecordSplitRequest(kIterationId, kSlowWorker, micros + 1000);
+  }
+  tracker.RecordNumSplits(kDatasetId, kProviderIndex, /*num_splits=*/100);
+  EXPECT_EQ(tracker.DeferralMicros(kIterationId, kDatasetId, kProviderIndex,
+                                   /*splits_produced=*/99, kSlowWorker),
+            0);
+}
+
+TEST(SplitAssignmentTrackerTest, RemoveIteration) {
+  SplitAssignmentTracker tracker;
+  RecordRequests(tracker);
+  tracker.RecordNumSplits(kDatasetId, kProviderIndex, /*num_splits=*/100);
+  tracker.RemoveIteration(kIterationId);
+  EXPECT_EQ(tracker.DeferralMicros(kIterationId, kDatasetId, kProviderIndex,
+                                   /*splits_produced=*/95, kSlowWorker),
+            0);
+}
+
+}  // namespace
+}  // namespace data
+}  // namespace tensorflow
@@ -32,14 +32,17 @@ namespace data {
 // SplitProvider which reads splits from a tf.data service dispatcher over RPC.
 class DataServiceSplitProvider : public SplitProvider {
  public:
+  // `worker_address` is the address of the worker reading the splits.
   DataServiceSplitProvider(const std::string& address,
                            const std::string& protocol, int64_t iteration_id,
-                           int64_t split_provider_index, int64_t timeout_ms)
+                           int64_t split_provider_index, int64_t timeout_ms,
+                           const std::string& worker_address = "")
       : address_(address),
         protocol_(protocol),
         iteration_id_(iteration_id),
         split_provider_index_(split_provider_index),
-        timeout_ms_(timeout_ms) {}
+        timeout_ms_(timeout_ms),
+        worker_address_(worker_address) {}
 
   Status GetNext(Tensor* split, bool* end_of_splits) override;
   Status Reset() override;
@@ -54,6 +57,7 @@ class DataServiceSplitProvider : public SplitProvider {
   const int64_t iteration_id_;
   const int64_t split_provider_index_;
   const int64_t timeout_ms_;
+  const std::string worker_address_;
 
   mutex mu_;
   int64_t repetition_ = 0;
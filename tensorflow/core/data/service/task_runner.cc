@@ -102,10 +102,35 @@ FirstComeFirstServedTaskRunner::~FirstComeFirstServedTaskRunner() { Cancel(); }
 
 Status FirstComeFirstServedTaskRunner::GetNext(const GetElementRequest& req,
                                                GetElementResult& result) {
-  return GetNext(result);
+  TF_RETURN_IF_ERROR(GetNext(result));
+  if (req.max_bytes_per_request() <= 0 || result.end_of_sequence) {
+    return OkStatus();
+  }
+  const size_t max_batch_bytes = req.max_bytes_per_request();
+  size_t batch_bytes = result.EstimatedMemoryUsageBytes();
+  while (batch_bytes < max_batch_bytes) {
+    StatusOr<GetElementResult> next = buffer_.Pop();
+    if (!next.ok() || next->end_of_sequence) {
+      mutex_lock l(lookahead_mu_);
+      lookahead_ = std::move(next);
+      break;
+    }
+    batch_bytes += next->EstimatedMemoryUsageBytes();
+    result.additional_elements.push_back(std::move(next->components));
+  }
+  return OkStatus();
 }
 
 Status FirstComeFirstServedTaskRunner::GetNext(GetElementResult& result) {
+  {
+    mutex_lock l(lookahead_mu_);
+    if (lookahead_.has_value()) {
+      StatusOr<GetElementResult> next = std::move(*lookahead_);
+      lookahead_.reset();
+      TF_ASSIGN_OR_RETURN(result, std::move(next));
+      return OkStatus();
+    }
+  }
   TF_ASSIGN_OR_RETURN(result, buffer_.Pop());
   return OkStatus();
 }
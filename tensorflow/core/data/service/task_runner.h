@@ -16,6 +16,7 @@ limitations under the License.
 #define TENSORFLOW_CORE_DATA_SERVICE_TASK_RUNNER_H_
 
 #include <memory>
+#include <optional>
 #include <vector>
 
 #include "tensorflow/core/data/service/common.pb.h"
@@ -87,7 +88,10 @@ class FirstComeFirstServedTaskRunner : public TaskRunner {
       std::unique_ptr<TaskIterator> iterator);
   ~FirstComeFirstServedTaskRunner() override;
 
-  // Gets the next element. It may block if the element is not ready yet.
+  // Gets the next element. It may block if the element is not ready yet. If
+  // `req.max_bytes_per_request()` is positive, further elements are added to
+  // `result.additional_elements` until that many bytes have been gathered or
+  // the end of the task is reached.
   Status GetNext(const GetElementRequest& req,
                  GetElementResult& result) override;
   Status GetNext(GetElementResult& result);
@@ -112,6 +116,13 @@ class FirstComeFirstServedTaskRunner : public TaskRunner {
   ThreadSafeBuffer<GetElementResult> buffer_;
   std::unique_ptr<Thread> prefetch_thread_;
 
+  // A result popped from `buffer_` while gathering a batch which couldn't be
+  // added to the batch, i.e. an end of sequence or an error. It is returned by
+  // the next `GetNext` call.
+  mutex lookahead_mu_;
+  std::optional<StatusOr<GetElementResult>> lookahead_
+      TF_GUARDED_BY(lookahead_mu_);
+
   TF_DISALLOW_COPY_AND_ASSIGN(FirstComeFirstServedTaskRunner);
 };
 
@@ -180,6 +180,39 @@ TEST(FirstComeFirstServedTaskRunnerTest, GetNext) {
   EXPECT_TRUE(result.end_of_sequence);
 }
 
+TEST(FirstComeFirstServedTaskRunnerTest, BatchedGetNext) {
+  size_t range = 10;
+  FirstComeFirstServedTaskRunner runner(
+      std::make_unique<RangeIterator>(range, /*repeat=*/false));
+  GetElementRequest request;
+  request.set_max_bytes_per_request(1 << 20);
+
+  GetElementResult result;
+  TF_ASSERT_OK(runner.GetNext(request, result));
+  EXPECT_FALSE(result.end_of_sequence);
+  EXPECT_EQ(BatchSize(result), 10);
+  std::vector<int64_t> output;
+  for (const Tensor& tensor : FlattenBatch(result)) {
+    output.push_back(tensor.flat<int64_t>()(0));
+  }
+  EXPECT_THAT(output, ElementsAreArray(GetRange(range)));
+
+  // The end of sequence is not dropped when a batch stops short of it.
+  TF_ASSERT_OK(runner.GetNext(request, result));
+  EXPECT_TRUE(result.end_of_sequence);
+}
+
+TEST(FirstComeFirstServedTaskRunnerTest, BatchedGetNextSmallLimit) {
+  size_t range = 10;
+  FirstComeFirstServedTaskRunner runner(
+      std::make_unique<RangeIterator>(range, /*repeat=*/false));
+  GetElementRequest request;
+  request.set_max_bytes_per_request(1);
+  TF_ASSERT_OK_AND_ASSIGN(std::vector<int64_t> output,
+                          GetTaskRunnerOutput<int64_t>(runner, request));
+  EXPECT_THAT(output, ElementsAreArray(GetRange(range)));
+}
+
 TEST(FirstComeFirstServedTaskRunnerTest, EmptyDataset) {
   FirstComeFirstServedTaskRunner runner(
       std::make_unique<RangeIterator>(/*range=*/0, /*repeat=*/false));
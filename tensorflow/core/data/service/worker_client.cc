@@ -28,6 +28,7 @@ limitations under the License.
 #include "absl/memory/memory.h"
 #include "absl/strings/string_view.h"
 #include "absl/strings/substitute.h"
+#include "tensorflow/core/data/compression_utils.h"
 #include "tensorflow/core/data/dataset.pb.h"
 #include "tensorflow/core/data/service/credentials_factory.h"
 #include "tensorflow/core/data/service/data_transfer.h"
@@ -114,8 +115,13 @@ class GrpcDataTransferClient : public DataTransferClient {
     }
     GetElementResponse resp;
     grpc::Status s = stub_->GetElement(&ctx, req, &resp);
+    {
+      mutex_lock l(mu_);
+      active_contexts_.erase(&ctx);
+    }
     result.end_of_sequence = resp.end_of_sequence();
     result.skip = resp.skip_task();
+    result.element_index = resp.element_index();
     switch (resp.element_case()) {
       case GetElementResponse::kCompressed: {
         Tensor tensor(DT_VARIANT, TensorShape{});
@@ -131,13 +137,17 @@ class GrpcDataTransferClient : public DataTransferClient {
           }
         }
         break;
+      case GetElementResponse::kCompressedBatch: {
+        std::vector<Tensor> components;
+        TF_RETURN_IF_ERROR(
+            UncompressElement(resp.compressed_batch(), &components));
+        TF_RETURN_IF_ERROR(UnflattenBatch(std::move(components),
+                                          resp.batch_size(), result));
+        break;
+      }
       case GetElementResponse::ELEMENT_NOT_SET:
         break;
     }
-    {
-      mutex_lock l(mu_);
-      active_contexts_.erase(&ctx);
-    }
     if (!s.ok()) {
       return grpc_util::WrapError("Failed to get element", s);
     }
@@ -27,7 +27,9 @@ limitations under the License.
 #include "absl/strings/substitute.h"
 #include "tensorflow/c/c_api_internal.h"
 #include "tensorflow/c/tf_status_helper.h"
+#include "tensorflow/core/data/compression_utils.h"
 #include "tensorflow/core/data/dataset.pb.h"
+#include "tensorflow/core/data/hash_utils.h"
 #include "tensorflow/core/data/service/auto_shard_rewriter.h"
 #include "tensorflow/core/data/service/common.h"
 #include "tensorflow/core/data/service/common.pb.h"
@@ -36,6 +38,7 @@ limitations under the License.
 #include "tensorflow/core/data/service/dispatcher.grpc.pb.h"
 #include "tensorflow/core/data/service/dispatcher.pb.h"
 #include "tensorflow/core/data/service/dispatcher_client.h"
+#include "tensorflow/core/data/service/element_cache.h"
 #include "tensorflow/core/data/service/export.pb.h"
 #include "tensorflow/core/data/service/grpc_util.h"
 #include "tensorflow/core/data/service/split_provider.h"
@@ -43,6 +46,7 @@ limitations under the License.
 #include "tensorflow/core/data/service/utils.h"
 #include "tensorflow/core/data/service/worker.pb.h"
 #include "tensorflow/core/data/standalone.h"
+#include "tensorflow/core/framework/dataset.h"
 #include "tensorflow/core/framework/dataset_options.pb.h"
 #include "tensorflow/core/framework/metrics.h"
 #include "tensorflow/core/framework/tensor.h"
@@ -68,6 +72,8 @@ namespace {
 constexpr int64_t kRetryIntervalMicros = 5 * 1000 * 1000;        // 5 seconds.
 constexpr int64_t kDefaultHeartBeatIntervalMs = 30 * 1000;       // 30 seconds.
 constexpr int64_t kDefaultDispatcherTimeoutMs = 60 * 60 * 1000;  // 1 hour.
+// Weight of the latest element in the processing time moving average.
+constexpr double kProcessingTimeSmoothingFactor = 0.1;
 
 using WorkerConfig = experimental::WorkerConfig;
 
@@ -166,6 +172,11 @@ Status DataServiceWorkerImpl::Start(const std::string& worker_address,
   dispatcher_ = std::make_unique<DataServiceDispatcherClient>(
       config_.dispatcher_address(), config_.protocol());
   TF_RETURN_IF_ERROR(dispatcher_->Initialize());
+  if (!config_.element_cache_directory().empty()) {
+    element_cache_ = std::make_unique<ElementCache>(
+        Env::Default(), config_.element_cache_directory(),
+        config_.element_cache_memory_bytes());
+  }
 
   Status s = Heartbeat();
   while (!s.ok()) {
@@ -269,7 +280,21 @@ Status DataServiceWorkerImpl::GetElementResult(
     cv_.notify_all();
   });
   TF_RETURN_IF_ERROR(EnsureTaskInitialized(*task));
+  const uint64_t start_nsec = Env::Default()->NowNanos();
   TF_RETURN_IF_ERROR(task->task_runner->GetNext(*request, *result));
+  // Round-robin reads wait for the other consumers of the round, so their
+  // latency doesn't reflect the worker's throughput.
+  if (!result->skip && !result->end_of_sequence &&
+      task->task_def.optional_num_consumers_case() !=
+          TaskDef::kNumConsumers) {
+    const double elapsed_nsec = Env::Default()->NowNanos() - start_nsec;
+    mutex_lock l(mu_);
+    processing_time_nsec_ =
+        processing_time_nsec_ == 0.0
+            ? elapsed_nsec
+            : kProcessingTimeSmoothingFactor * elapsed_nsec +
+                  (1 - kProcessingTimeSmoothingFactor) * processing_time_nsec_;
+  }
 
   if (result->end_of_sequence) {
     mutex_lock l(mu_);
@@ -316,12 +341,8 @@ Status DataServiceWorkerImpl::EnsureTaskInitialized(
     return OkStatus();
   }
   TF_ASSIGN_OR_RETURN(DatasetDef dataset_def, GetDatasetDef(task.task_def));
-  TF_ASSIGN_OR_RETURN(std::unique_ptr<standalone::Dataset> dataset,
-                      MakeDataset(dataset_def, task.task_def));
-  TF_ASSIGN_OR_RETURN(std::unique_ptr<standalone::Iterator> iterator,
-                      MakeDatasetIterator(*dataset, task.task_def));
-  auto task_iterator = std::make_unique<StandaloneTaskIterator>(
-      std::move(dataset), std::move(iterator));
+  TF_ASSIGN_OR_RETURN(std::unique_ptr<TaskIterator> task_iterator,
+                      MakeTaskIterator(dataset_def, task.task_def));
   TF_RETURN_IF_ERROR(TaskRunner::Create(
       config_, task.task_def, std::move(task_iterator), task.task_runner));
 
@@ -330,6 +351,45 @@ Status DataServiceWorkerImpl::EnsureTaskInitialized(
   return OkStatus();
 }
 
+StatusOr<std::unique_ptr<TaskIterator>>
+DataServiceWorkerImpl::MakeTaskIterator(const DatasetDef& dataset_def,
+                                        const TaskDef& task_def) const {
+  // Only tasks which produce the whole dataset from start to end can share
+  // their elements with later jobs.
+  const bool use_element_cache =
+      element_cache_ != nullptr && IsNoShard(task_def.processing_mode_def()) &&
+      task_def.optional_num_consumers_case() != TaskDef::kNumConsumers;
+  uint64 fingerprint = 0;
+  if (use_element_cache) {
+    TF_RETURN_IF_ERROR(HashGraph(dataset_def.graph(), &fingerprint));
+    StatusOr<std::unique_ptr<TaskIterator>> cached =
+        element_cache_->Lookup(fingerprint);
+    if (!cached.ok()) {
+      LOG(WARNING) << "Failed to read the element cache for task "
+                   << task_def.task_id() << ": " << cached.status()
+                   << ". Falling back to processing the dataset.";
+    } else if (*cached != nullptr) {
+      VLOG(1) << "Serving task " << task_def.task_id()
+              << " from the element cache.";
+      return std::move(*cached);
+    }
+  }
+
+  TF_ASSIGN_OR_RETURN(std::unique_ptr<standalone::Dataset> dataset,
+                      MakeDataset(dataset_def, task_def));
+  TF_ASSIGN_OR_RETURN(std::unique_ptr<standalone::Iterator> iterator,
+                      MakeDatasetIterator(*dataset, task_def));
+  std::unique_ptr<TaskIterator> task_iterator =
+      std::make_unique<StandaloneTaskIterator>(std::move(dataset),
+                                               std::move(iterator));
+  if (use_element_cache &&
+      task_iterator->Cardinality() != kInfiniteCardinality) {
+    task_iterator =
+        element_cache_->Record(fingerprint, std::move(task_iterator));
+  }
+  return task_iterator;
+}
+
 StatusOr<DatasetDef> DataServiceWorkerImpl::GetDatasetDef(
     const TaskDef& task_def) const {
   switch (task_def.dataset_case()) {
@@ -383,7 +443,8 @@ DataServiceWorkerImpl::MakeDatasetIterator(standalone::Dataset& dataset,
     for (int i = 0; i < task_def.num_split_providers(); ++i) {
       split_providers.push_back(std::make_unique<DataServiceSplitProvider>(
           config_.dispatcher_address(), config_.protocol(),
-          task_def.iteration_id(), i, config_.dispatcher_timeout_ms()));
+          task_def.iteration_id(), i, config_.dispatcher_timeout_ms(),
+          worker_address_));
     }
     TF_RETURN_IF_ERROR(
         dataset.MakeIterator(std::move(split_providers), &iterator));
@@ -415,10 +476,19 @@ Status DataServiceWorkerImpl::GetElement(const GetElementRequest* request,
   TF_RETURN_IF_ERROR(GetElementResult(request, &result));
   response->set_end_of_sequence(result.end_of_sequence);
   response->set_skip_task(result.skip);
+  response->set_element_index(result.element_index);
   if (!response->end_of_sequence() && !response->skip_task()) {
-    TF_RETURN_IF_ERROR(
-        MoveElementToResponse(std::move(result.components), *response));
-    VLOG(3) << "Producing an element for task " << request->task_id();
+    if (result.additional_elements.empty()) {
+      TF_RETURN_IF_ERROR(
+          MoveElementToResponse(std::move(result.components), *response));
+      VLOG(3) << "Producing an element for task " << request->task_id();
+    } else {
+      response->set_batch_size(BatchSize(result));
+      TF_RETURN_IF_ERROR(CompressElement(FlattenBatch(result),
+                                         response->mutable_compressed_batch()));
+      VLOG(3) << "Producing " << response->batch_size()
+              << " elements for task " << request->task_id();
+    }
   }
   return OkStatus();
 }
@@ -514,11 +584,13 @@ void DataServiceWorkerImpl::HeartbeatThread() TF_LOCKS_EXCLUDED(mu_) {
 
 Status DataServiceWorkerImpl::Heartbeat() TF_LOCKS_EXCLUDED(mu_) {
   std::vector<int64_t> current_tasks;
+  double processing_time_nsec;
   {
     mutex_lock l(mu_);
     for (const auto& task : tasks_) {
       current_tasks.push_back(task.first);
     }
+    processing_time_nsec = processing_time_nsec_;
   }
   WorkerHeartbeatRequest request;
   request.set_worker_address(worker_address_);
@@ -527,6 +599,7 @@ Status DataServiceWorkerImpl::Heartbeat() TF_LOCKS_EXCLUDED(mu_) {
   request.set_worker_uid(worker_uid_);
   *request.mutable_current_tasks() = {current_tasks.begin(),
                                       current_tasks.end()};
+  request.set_processing_time_nsec(processing_time_nsec);
   TF_ASSIGN_OR_RETURN(WorkerHeartbeatResponse response,
                       dispatcher_->WorkerHeartbeat(request));
 
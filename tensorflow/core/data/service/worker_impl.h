@@ -26,6 +26,7 @@ limitations under the License.
 #include "tensorflow/core/data/service/data_transfer.h"
 #include "tensorflow/core/data/service/dispatcher.grpc.pb.h"
 #include "tensorflow/core/data/service/dispatcher_client.h"
+#include "tensorflow/core/data/service/element_cache.h"
 #include "tensorflow/core/data/service/export.pb.h"
 #include "tensorflow/core/data/service/task_runner.h"
 #include "tensorflow/core/data/service/worker.pb.h"
@@ -121,6 +122,10 @@ class DataServiceWorkerImpl {
   // Creates an iterator for `dataset`.
   StatusOr<std::unique_ptr<standalone::Iterator>> MakeDatasetIterator(
       standalone::Dataset& dataset, const TaskDef& task_def) const;
+  // Creates the task iterator for `task_def`, replaying the elements from the
+  // element cache if the dataset has been cached.
+  StatusOr<std::unique_ptr<TaskIterator>> MakeTaskIterator(
+      const DatasetDef& dataset_def, const TaskDef& task_def) const;
 
   const experimental::WorkerConfig config_;
   // Worker Borg job UID for telemetry. -1 if not supported.
@@ -130,6 +135,9 @@ class DataServiceWorkerImpl {
   std::string worker_address_;
   std::string transfer_address_;
   std::unique_ptr<DataServiceDispatcherClient> dispatcher_;
+  // Cache of elements shared by tasks across jobs. nullptr if
+  // `config_.element_cache_directory()` is not set.
+  std::unique_ptr<ElementCache> element_cache_;
 
   mutable mutex mu_;
   condition_variable cv_;
@@ -144,6 +152,9 @@ class DataServiceWorkerImpl {
   // again, the worker will return a non-retriable FailedPrecondition error.
   absl::flat_hash_set<int64_t> deleted_tasks_ TF_GUARDED_BY(mu_);
   bool cancelled_ TF_GUARDED_BY(mu_) = false;
+  // Exponential moving average of the time, in nanoseconds, to produce an
+  // element. Reported to the dispatcher to estimate worker throughput.
+  double processing_time_nsec_ TF_GUARDED_BY(mu_) = 0.0;
   // Whether the worker has registered with the dispatcher yet.
   bool registered_ TF_GUARDED_BY(mu_) = false;
   condition_variable task_completion_cv_ TF_GUARDED_BY(mu_);
@@ -35,6 +35,7 @@ limitations under the License.
 #include "tensorflow/core/lib/io/zlib_compression_options.h"
 #include "tensorflow/core/lib/io/zlib_inputstream.h"
 #include "tensorflow/core/lib/io/zlib_outputbuffer.h"
+#include "tensorflow/core/platform/blocking_counter.h"
 #include "tensorflow/core/platform/coding.h"
 #include "tensorflow/core/platform/errors.h"
 #include "tensorflow/core/platform/file_system.h"
@@ -54,6 +55,11 @@ constexpr const char* const kOutputTypes = "output_types";
 constexpr const char* const kOutputShapes = "output_shapes";
 constexpr const char* const kCompression = "compression";
 constexpr const char* const kVersion = "version";
+constexpr const char* const kNumParallelDecodes = "num_parallel_decodes";
+
+// The number of elements decoded by each thread of a `ParallelDecoder` per
+// batch. Larger batches amortize the synchronization with the thread pool.
+constexpr int kElementsPerDecodeThread = 4;
 constexpr const char* const kCurrentCheckpointID = "current_checkpoint_id";
 constexpr const char* const kIndex = "index";
 constexpr const char* const kStartIndex = "start_index";
@@ -338,18 +344,27 @@ Status Reader::Create(Env* env, const std::string& filename,
                       const string& compression_type, int version,
                       const DataTypeVector& dtypes,
                       std::unique_ptr<Reader>* out_reader) {
+  return Create(env, filename, compression_type, version, dtypes,
+                /*num_parallel_decodes=*/1, out_reader);
+}
+
+Status Reader::Create(Env* env, const std::string& filename,
+                      const string& compression_type, int version,
+                      const DataTypeVector& dtypes,
+                      int64_t num_parallel_decodes,
+                      std::unique_ptr<Reader>* out_reader) {
   switch (version) {
     // CustomReader is able to read a legacy snapshot file format (v0) though
     // custom writer doesn't have the ability to write it any more since it is
     // strictly worse than V1.
     case 0:
     case 1:
-      *out_reader = std::make_unique<CustomReader>(filename, compression_type,
-                                                   version, dtypes);
+      *out_reader = std::make_unique<CustomReader>(
+          filename, compression_type, version, dtypes, num_parallel_decodes);
       break;
     case 2:
-      *out_reader =
-          std::make_unique<TFRecordReader>(filename, compression_type, dtypes);
+      *out_reader = std::make_unique<TFRecordReader>(
+          filename, compression_type, dtypes, num_parallel_decodes);
       break;
     default:
       return errors::InvalidArgument("Snapshot reader version: ", version,
@@ -368,20 +383,70 @@ Status Reader::SkipRecords(int64_t num_records) {
   return OkStatus();
 }
 
+ParallelDecoder::ParallelDecoder(Env* env, int num_threads, ReadFn read_fn,
+                                 DecodeFn decode_fn)
+    : num_threads_(num_threads),
+      read_fn_(std::move(read_fn)),
+      decode_fn_(std::move(decode_fn)),
+      thread_pool_(env, "snapshot_parallel_decode", num_threads) {}
+
+Status ParallelDecoder::ReadTensors(std::vector<Tensor>* read_tensors) {
+  if (decoded_.empty() && read_status_.ok()) {
+    DecodeBatch();
+  }
+  if (decoded_.empty()) {
+    return read_status_;
+  }
+  Element element = std::move(decoded_.front());
+  decoded_.pop_front();
+  TF_RETURN_IF_ERROR(element.status);
+  *read_tensors = std::move(element.tensors);
+  return OkStatus();
+}
+
+void ParallelDecoder::DecodeBatch() {
+  profiler::TraceMe activity("ParallelDecoder::DecodeBatch",
+                             profiler::TraceMeLevel::kInfo);
+  const size_t batch_size = num_threads_ * kElementsPerDecodeThread;
+  std::vector<Element> batch;
+  batch.reserve(batch_size);
+  while (batch.size() < batch_size) {
+    Element element;
+    read_status_ = read_fn_(&element.records);
+    if (!read_status_.ok()) {
+      break;
+    }
+    batch.push_back(std::move(element));
+  }
+  BlockingCounter counter(batch.size());
+  for (auto& element : batch) {
+    thread_pool_.Schedule([this, &element, &counter]() {
+      element.status = decode_fn_(&element.records, &element.tensors);
+      element.records.clear();
+      counter.DecrementCount();
+    });
+  }
+  counter.Wait();
+  for (auto& element : batch) {
+    decoded_.push_back(std::move(element));
+  }
+}
+
 class Reader::Dataset : public DatasetBase {
  public:
   Dataset(DatasetContext&& ctx, const std::string& shard_dir,
           const std::string& compression, const int64_t version,
           const DataTypeVector& dtypes,
           const std::vector<PartialTensorShape>& shapes,
-          const int64_t start_index)
+          const int64_t start_index, const int64_t num_parallel_decodes)
       : DatasetBase(std::move(ctx)),
         shard_dir_(shard_dir),
         compression_(compression),
         version_(version),
         dtypes_(dtypes),
         shapes_(shapes),
-        start_index_(start_index) {}
+        start_index_(start_index),
+        num_parallel_decodes_(num_parallel_decodes) {}
 
   const DataTypeVector& output_dtypes() const override { return dtypes_; }
 
@@ -413,13 +478,18 @@ class Reader::Dataset : public DatasetBase {
     AttrValue version;
     b->BuildAttrValue(version_, &version);
 
+    AttrValue num_parallel_decodes;
+    b->BuildAttrValue(num_parallel_decodes_, &num_parallel_decodes);
+
     return b->AddDataset(
         this,
         /*inputs=*/
         {std::make_pair(0, shard_dir), std::make_pair(1, start_index)},
         /*list_inputs=*/{},
         /*attrs=*/
-        {{kCompression, compression}, {kVersion, version}},
+        {{kCompression, compression},
+         {kVersion, version},
+         {kNumParallelDecodes, num_parallel_decodes}},
         /*use_dataset_name=*/true, node);
   }
 
@@ -442,7 +512,8 @@ class Reader::Dataset : public DatasetBase {
       // the is_restoring bit ends up being inaccurate).
       TF_RETURN_IF_ERROR(Reader::Create(
           ctx->env(), GetCurrentFilename(), dataset()->compression_,
-          dataset()->version_, dataset()->dtypes_, &reader_));
+          dataset()->version_, dataset()->dtypes_,
+          dataset()->num_parallel_decodes_, &reader_));
       return AdvanceToStartIndex(ctx);
     }
 
@@ -482,7 +553,8 @@ class Reader::Dataset : public DatasetBase {
       TF_RETURN_IF_ERROR(ctx->env()->FileExists(GetCurrentFilename()));
       TF_RETURN_IF_ERROR(Reader::Create(
           ctx->env(), GetCurrentFilename(), dataset()->compression_,
-          dataset()->version_, dataset()->dtypes_, &reader_));
+          dataset()->version_, dataset()->dtypes_,
+          dataset()->num_parallel_decodes_, &reader_));
       return AdvanceToStartIndex(ctx);
     }
 
@@ -492,7 +564,8 @@ class Reader::Dataset : public DatasetBase {
       current_checkpoint_id_++;
       TF_RETURN_IF_ERROR(env->FileExists(GetCurrentFilename()));
       return Reader::Create(env, GetCurrentFilename(), dataset()->compression_,
-                            dataset()->version_, dataset()->dtypes_, &reader_);
+                            dataset()->version_, dataset()->dtypes_,
+                            dataset()->num_parallel_decodes_, &reader_);
     }
 
     std::string GetCurrentFilename() {
@@ -524,6 +597,7 @@ class Reader::Dataset : public DatasetBase {
   const DataTypeVector dtypes_;
   const std::vector<PartialTensorShape> shapes_;
   const int64_t start_index_;
+  const int64_t num_parallel_decodes_;
 };
 
 Reader::DatasetOp::DatasetOp(OpKernelConstruction* ctx) : DatasetOpKernel(ctx) {
@@ -531,6 +605,14 @@ Reader::DatasetOp::DatasetOp(OpKernelConstruction* ctx) : DatasetOpKernel(ctx) {
   OP_REQUIRES_OK(ctx, ctx->GetAttr(kOutputShapes, &output_shapes_));
   OP_REQUIRES_OK(ctx, ctx->GetAttr(kCompression, &compression_));
   OP_REQUIRES_OK(ctx, ctx->GetAttr(kVersion, &version_));
+  if (ctx->HasAttr(kNumParallelDecodes)) {
+    OP_REQUIRES_OK(ctx,
+                   ctx->GetAttr(kNumParallelDecodes, &num_parallel_decodes_));
+  }
+  OP_REQUIRES(ctx, num_parallel_decodes_ > 0,
+              errors::InvalidArgument(
+                  "`num_parallel_decodes` must be positive, but got ",
+                  num_parallel_decodes_, "."));
 }
 
 void Reader::DatasetOp::MakeDataset(OpKernelContext* ctx,
@@ -541,9 +623,9 @@ void Reader::DatasetOp::MakeDataset(OpKernelContext* ctx,
   int64_t start_index;
   OP_REQUIRES_OK(ctx, ParseScalarArgument(ctx, "start_index", &start_index));
 
-  *output =
-      new Reader::Dataset(DatasetContext(ctx), shard_dir, compression_,
-                          version_, output_types_, output_shapes_, start_index);
+  *output = new Reader::Dataset(DatasetContext(ctx), shard_dir, compression_,
+                               version_, output_types_, output_shapes_,
+                               start_index, num_parallel_decodes_);
 }
 
 class Reader::NestedDataset : public DatasetBase {
@@ -669,6 +751,19 @@ Status Reader::MakeNestedDataset(Env* env,
                                  const std::vector<PartialTensorShape>& shapes,
                                  const int64_t start_index,
                                  DatasetBase** output) {
+  return MakeNestedDataset(env, shard_dirs, compression_type, version, dtypes,
+                           shapes, start_index, /*num_parallel_decodes=*/1,
+                           output);
+}
+
+Status Reader::MakeNestedDataset(Env* env,
+                                 const std::vector<std::string>& shard_dirs,
+                                 const string& compression_type, int version,
+                                 const DataTypeVector& dtypes,
+                                 const std::vector<PartialTensorShape>& shapes,
+                                 const int64_t start_index,
+                                 int64_t num_parallel_decodes,
+                                 DatasetBase** output) {
   std::vector<DatasetBase*> datasets;
 
   datasets.reserve(shard_dirs.size());
@@ -685,7 +780,7 @@ Status Reader::MakeNestedDataset(Env* env,
                         {"SnapshotDatasetReader",
                          strings::StrCat("SnapshotDatasetReader/_", i)})),
                     shard_dirs.at(i), compression_type, version, dtypes, shapes,
-                    dataset_start_index));
+                    dataset_start_index, num_parallel_decodes));
     datasets.back()->Initialize(/*metadata=*/{});
   }
 
@@ -708,11 +803,13 @@ Status Reader::MakeNestedDataset(Env* env,
 
 TFRecordReader::TFRecordReader(const std::string& filename,
                                const string& compression_type,
-                               const DataTypeVector& dtypes)
+                               const DataTypeVector& dtypes,
+                               int64_t num_parallel_decodes)
     : filename_(filename),
       offset_(0),
       compression_type_(compression_type),
-      dtypes_(dtypes) {}
+      dtypes_(dtypes),
+      num_parallel_decodes_(num_parallel_decodes) {}
 
 Status TFRecordReader::Initialize(Env* env) {
   TF_RETURN_IF_ERROR(env->NewRandomAccessFile(filename_, &file_));
@@ -720,15 +817,38 @@ Status TFRecordReader::Initialize(Env* env) {
   record_reader_ = std::make_unique<io::RecordReader>(
       file_.get(), io::RecordReaderOptions::CreateRecordReaderOptions(
                        /*compression_type=*/compression_type_));
+  if (num_parallel_decodes_ > 1) {
+    decoder_ = std::make_unique<ParallelDecoder>(
+        env, static_cast<int>(num_parallel_decodes_),
+        [this](std::vector<tstring>* records) { return ReadRecords(records); },
+        [this](std::vector<tstring>* records, std::vector<Tensor>* tensors) {
+          return DecodeTensors(records, tensors);
+        });
+  }
   return OkStatus();
 }
 
 Status TFRecordReader::ReadTensors(std::vector<Tensor>* read_tensors) {
-  read_tensors->reserve(dtypes_.size());
-  for (int i = 0; i < dtypes_.size(); ++i) {
-    tstring record;
+  if (decoder_) {
+    return decoder_->ReadTensors(read_tensors);
+  }
+  std::vector<tstring> records;
+  TF_RETURN_IF_ERROR(ReadRecords(&records));
+  return DecodeTensors(&records, read_tensors);
+}
+
+Status TFRecordReader::ReadRecords(std::vector<tstring>* records) {
+  records->resize(dtypes_.size());
+  for (auto& record : *records) {
     TF_RETURN_IF_ERROR(record_reader_->ReadRecord(&offset_, &record));
+  }
+  return OkStatus();
+}
 
+Status TFRecordReader::DecodeTensors(std::vector<tstring>* records,
+                                     std::vector<Tensor>* read_tensors) const {
+  read_tensors->reserve(records->size());
+  for (const auto& record : *records) {
     TensorProto proto;
     proto.ParseFromArray(record.data(), record.size());
 
@@ -744,11 +864,13 @@ Status TFRecordReader::ReadTensors(std::vector<Tensor>* read_tensors) {
 
 CustomReader::CustomReader(const std::string& filename,
                            const string& compression_type, const int version,
-                           const DataTypeVector& dtypes)
+                           const DataTypeVector& dtypes,
+                           int64_t num_parallel_decodes)
     : filename_(filename),
       compression_type_(compression_type),
       version_(version),
-      dtypes_(dtypes) {}
+      dtypes_(dtypes),
+      num_parallel_decodes_(num_parallel_decodes) {}
 
 Status CustomReader::Initialize(Env* env) {
   TF_RETURN_IF_ERROR(env->NewRandomAccessFile(filename_, &file_));
@@ -789,6 +911,19 @@ Status CustomReader::Initialize(Env* env) {
     }
   }
 
+  // Only version 1 snappy files consist of independently compressed elements
+  // that can be decoded out of order.
+  if (num_parallel_decodes_ > 1 && version_ == 1 &&
+      compression_type_ == io::compression::kSnappy) {
+    decoder_ = std::make_unique<ParallelDecoder>(
+        env, static_cast<int>(num_parallel_decodes_),
+        [this](std::vector<tstring>* records) {
+          return ReadSnappyRecords(records);
+        },
+        [this](std::vector<tstring>* records, std::vector<Tensor>* tensors) {
+          return DecodeSnappyTensors(records, tensors);
+        });
+  }
   return OkStatus();
 }
 
@@ -806,10 +941,24 @@ Status CustomReader::ReadTensors(std::vector<Tensor>* read_tensors) {
     return errors::InvalidArgument("Compression ", compression_type_,
                                    " is not supported.");
   }
+  if (decoder_) {
+    return decoder_->ReadTensors(read_tensors);
+  }
+  std::vector<tstring> records;
+  TF_RETURN_IF_ERROR(ReadSnappyRecords(&records));
+  return DecodeSnappyTensors(&records, read_tensors);
+}
+
+Status CustomReader::ReadSnappyRecords(std::vector<tstring>* records) {
+  records->resize(2);
+  TF_RETURN_IF_ERROR(ReadRecord(&(*records)[0]));
+  return ReadRecord(&(*records)[1]);
+}
 
+Status CustomReader::DecodeSnappyTensors(
+    std::vector<tstring>* records, std::vector<Tensor>* read_tensors) const {
+  const tstring& metadata_str = (*records)[0];
   experimental::SnapshotTensorMetadata metadata;
-  tstring metadata_str;
-  TF_RETURN_IF_ERROR(ReadRecord(&metadata_str));
   if (!metadata.ParseFromArray(metadata_str.data(), metadata_str.size())) {
     return errors::DataLoss("Could not parse SnapshotTensorMetadata");
   }
@@ -819,8 +968,8 @@ Status CustomReader::ReadTensors(std::vector<Tensor>* read_tensors) {
   simple_tensors.reserve(num_simple_);
   std::vector<std::pair<std::unique_ptr<char[]>, size_t>> tensor_proto_strs;
   tensor_proto_strs.reserve(num_complex_);
-  TF_RETURN_IF_ERROR(
-      SnappyUncompress(&metadata, &simple_tensors, &tensor_proto_strs));
+  TF_RETURN_IF_ERROR(SnappyUncompress(&metadata, (*records)[1],
+                                      &simple_tensors, &tensor_proto_strs));
 
   int simple_index = 0;
   int complex_index = 0;
@@ -869,11 +1018,9 @@ Status CustomReader::ReadTensorsV0(std::vector<Tensor>* read_tensors) {
 
 Status CustomReader::SnappyUncompress(
     const experimental::SnapshotTensorMetadata* metadata,
-    std::vector<Tensor>* simple_tensors,
-    std::vector<std::pair<std::unique_ptr<char[]>, size_t>>*
-        tensor_proto_strs) {
-  tstring compressed;
-  TF_RETURN_IF_ERROR(ReadRecord(&compressed));
+    const tstring& compressed, std::vector<Tensor>* simple_tensors,
+    std::vector<std::pair<std::unique_ptr<char[]>, size_t>>* tensor_proto_strs)
+    const {
   size_t size;
   if (!port::Snappy_GetUncompressedLength(compressed.data(), compressed.size(),
                                           &size)) {
@@ -16,6 +16,12 @@ limitations under the License.
 #ifndef TENSORFLOW_CORE_DATA_SNAPSHOT_UTILS_H_
 #define TENSORFLOW_CORE_DATA_SNAPSHOT_UTILS_H_
 
+#include <deque>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
 #include "tensorflow/core/framework/dataset.h"
 #include "tensorflow/core/framework/op_kernel.h"
 #include "tensorflow/core/framework/tensor.h"
@@ -28,6 +34,7 @@ limitations under the License.
 #include "tensorflow/core/platform/file_system.h"
 #include "tensorflow/core/platform/path.h"
 #include "tensorflow/core/platform/status.h"
+#include "tensorflow/core/platform/threadpool.h"
 
 namespace tensorflow {
 
@@ -181,6 +188,7 @@ class Reader {
     std::vector<PartialTensorShape> output_shapes_;
     std::string compression_;
     int64_t version_;
+    int64_t num_parallel_decodes_ = 1;
   };
 
   // Op kernel that creates an instance of `Reader::NestedDataset` needed to
@@ -205,6 +213,15 @@ class Reader {
                        const DataTypeVector& dtypes,
                        std::unique_ptr<Reader>* out_reader);
 
+  // Like `Create`, but the returned reader decodes up to
+  // `num_parallel_decodes` elements of the file in parallel. Elements are
+  // still returned in the order in which they were written.
+  static Status Create(Env* env, const std::string& filename,
+                       const string& compression_type, int version,
+                       const DataTypeVector& dtypes,
+                       int64_t num_parallel_decodes,
+                       std::unique_ptr<Reader>* out_reader);
+
   // Returns a nested dataset for a set of given snapshot file names.
   //
   // This function takes a vector of snapshot files, and returns a nested
@@ -218,6 +235,17 @@ class Reader {
                                   const int64_t start_index,
                                   DatasetBase** output);
 
+  // Like `MakeNestedDataset`, but the readers of the nested datasets decode up
+  // to `num_parallel_decodes` elements of each file in parallel.
+  static Status MakeNestedDataset(Env* env,
+                                  const std::vector<std::string>& shard_dirs,
+                                  const string& compression_type, int version,
+                                  const DataTypeVector& dtypes,
+                                  const std::vector<PartialTensorShape>& shapes,
+                                  const int64_t start_index,
+                                  int64_t num_parallel_decodes,
+                                  DatasetBase** output);
+
   // Reads a vector of Tensors from the snapshot file.
   virtual Status ReadTensors(std::vector<Tensor>* read_tensors) = 0;
 
@@ -234,11 +262,52 @@ class Reader {
   class NestedDataset;
 };
 
+// ParallelDecoder reads the serialized elements of a snapshot file
+// sequentially, and decodes batches of them on a thread pool. This moves the
+// CPU-bound part of reading (decompression and tensor deserialization) off the
+// single thread that reads a file.
+class ParallelDecoder {
+ public:
+  // Reads the records making up the next element into `records`.
+  using ReadFn = std::function<Status(std::vector<tstring>* records)>;
+  // Decodes the element made up of `records` into `tensors`. May be called
+  // concurrently.
+  using DecodeFn = std::function<Status(std::vector<tstring>* records,
+                                        std::vector<Tensor>* tensors)>;
+
+  ParallelDecoder(Env* env, int num_threads, ReadFn read_fn,
+                  DecodeFn decode_fn);
+
+  // Returns the next decoded element, or the status that stopped reading
+  // (e.g. `OutOfRange` at the end of the file) once all elements read before
+  // it have been returned.
+  Status ReadTensors(std::vector<Tensor>* read_tensors);
+
+ private:
+  struct Element {
+    std::vector<tstring> records;
+    std::vector<Tensor> tensors;
+    Status status;
+  };
+
+  // Reads and decodes the next batch of elements into `decoded_`.
+  void DecodeBatch();
+
+  const int num_threads_;
+  const ReadFn read_fn_;
+  const DecodeFn decode_fn_;
+  std::deque<Element> decoded_;
+  // The status of the last read. Reading stops once it is not OK.
+  Status read_status_;
+  thread::ThreadPool thread_pool_;
+};
+
 // Reads snapshots previously written with `TFRecordWriter`.
 class TFRecordReader : public Reader {
  public:
   TFRecordReader(const std::string& filename, const string& compression_type,
-                 const DataTypeVector& dtypes);
+                 const DataTypeVector& dtypes,
+                 int64_t num_parallel_decodes = 1);
 
   Status ReadTensors(std::vector<Tensor>* read_tensors) override;
 
@@ -248,6 +317,13 @@ class TFRecordReader : public Reader {
   Status Initialize(Env* env) override;
 
  private:
+  // Reads the serialized tensors of the next element.
+  Status ReadRecords(std::vector<tstring>* records);
+
+  // Parses the tensors of an element read by `ReadRecords`.
+  Status DecodeTensors(std::vector<tstring>* records,
+                       std::vector<Tensor>* read_tensors) const;
+
   std::string filename_;
   std::unique_ptr<RandomAccessFile> file_;
   std::unique_ptr<io::RecordReader> record_reader_;
@@ -255,6 +331,8 @@ class TFRecordReader : public Reader {
 
   const string compression_type_;
   const DataTypeVector dtypes_;
+  const int64_t num_parallel_decodes_;
+  std::unique_ptr<ParallelDecoder> decoder_;
 };
 
 // Reads snapshots previously written with `CustomWriter`.
@@ -276,7 +354,8 @@ class CustomReader : public Reader {
   static constexpr const char* const kSeparator = "::";
 
   CustomReader(const std::string& filename, const string& compression_type,
-               const int version, const DataTypeVector& dtypes);
+               const int version, const DataTypeVector& dtypes,
+               int64_t num_parallel_decodes = 1);
 
   Status ReadTensors(std::vector<Tensor>* read_tensors) override;
 
@@ -288,11 +367,19 @@ class CustomReader : public Reader {
  private:
   Status ReadTensorsV0(std::vector<Tensor>* read_tensors);
 
+  // Reads the metadata and the compressed tensors of the next snappy
+  // compressed element.
+  Status ReadSnappyRecords(std::vector<tstring>* records);
+
+  // Decodes an element read by `ReadSnappyRecords`.
+  Status DecodeSnappyTensors(std::vector<tstring>* records,
+                             std::vector<Tensor>* read_tensors) const;
+
   Status SnappyUncompress(
       const experimental::SnapshotTensorMetadata* metadata,
-      std::vector<Tensor>* simple_tensors,
+      const tstring& compressed, std::vector<Tensor>* simple_tensors,
       std::vector<std::pair<std::unique_ptr<char[]>, size_t>>*
-          tensor_proto_strs);
+          tensor_proto_strs) const;
 
   Status ReadRecord(tstring* record);
 
@@ -306,9 +393,11 @@ class CustomReader : public Reader {
   const string compression_type_;
   const int version_;
   const DataTypeVector dtypes_;
+  const int64_t num_parallel_decodes_;
   int num_simple_ = 0;
   int num_complex_ = 0;
   std::vector<bool> simple_tensor_mask_;  // true for simple, false for complex.
+  std::unique_ptr<ParallelDecoder> decoder_;
 };
 
 // Writes snapshot metadata to the given directory.
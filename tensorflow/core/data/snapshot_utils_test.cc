@@ -19,6 +19,7 @@ limitations under the License.
 #include "tensorflow/core/lib/core/status_test_util.h"
 #include "tensorflow/core/lib/io/compression.h"
 #include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/errors.h"
 #include "tensorflow/core/platform/logging.h"
 #include "tensorflow/core/platform/test.h"
 #include "tensorflow/core/platform/test_benchmark.h"
@@ -38,7 +39,8 @@ void GenerateTensorVector(tensorflow::DataTypeVector& dtypes,
   }
 }
 
-void SnapshotRoundTrip(std::string compression_type, int version) {
+void SnapshotRoundTrip(std::string compression_type, int version,
+                       int64_t num_parallel_decodes = 1) {
   // Generate ground-truth tensors for writing and reading.
   std::vector<Tensor> tensors;
   tensorflow::DataTypeVector dtypes;
@@ -58,7 +60,7 @@ void SnapshotRoundTrip(std::string compression_type, int version) {
 
   std::unique_ptr<Reader> reader;
   TF_ASSERT_OK(Reader::Create(Env::Default(), filename, compression_type,
-                              version, dtypes, &reader));
+                              version, dtypes, num_parallel_decodes, &reader));
 
   for (int i = 0; i < 100; ++i) {
     std::vector<Tensor> read_tensors;
@@ -77,6 +79,10 @@ void SnapshotRoundTrip(std::string compression_type, int version) {
       EXPECT_EQ(proto_serialized, read_proto_serialized);
     }
   }
+  if (num_parallel_decodes > 1) {
+    std::vector<Tensor> read_tensors;
+    EXPECT_TRUE(errors::IsOutOfRange(reader->ReadTensors(&read_tensors)));
+  }
 
   TF_ASSERT_OK(Env::Default()->DeleteFile(filename));
 }
@@ -91,6 +97,17 @@ TEST(SnapshotUtilTest, CombinationRoundTripTest) {
   SnapshotRoundTrip(io::compression::kSnappy, 2);
 }
 
+TEST(SnapshotUtilTest, ParallelDecodeRoundTripTest) {
+  for (int64_t num_parallel_decodes : {2, 3, 8}) {
+    SnapshotRoundTrip(io::compression::kNone, 1, num_parallel_decodes);
+    SnapshotRoundTrip(io::compression::kSnappy, 1, num_parallel_decodes);
+
+    SnapshotRoundTrip(io::compression::kNone, 2, num_parallel_decodes);
+    SnapshotRoundTrip(io::compression::kGzip, 2, num_parallel_decodes);
+    SnapshotRoundTrip(io::compression::kSnappy, 2, num_parallel_decodes);
+  }
+}
+
 void SnapshotReaderBenchmarkLoop(::testing::benchmark::State& state,
                                  std::string compression_type, int version) {
   tensorflow::DataTypeVector dtypes;
@@ -0,0 +1,298 @@
+/* Copyright 2022 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+// Microbenchmarks of tf.data transformations, run through the standalone
+// tf.data runtime. Each benchmark is named
+// `BM_<Transformation>/<element size>[/<parallelism or buffer size>]`, where
+// the element size is the number of floats in each input element, and reports
+//
+//   * items_per_second: the number of elements produced per second,
+//   * bytes_per_second: the number of output bytes produced per second,
+//   * p50_us, p90_us, p99_us, max_us: the latency of `GetNext()` calls,
+//   * peak_bytes: the peak memory allocated by the CPU allocator, and
+//   * threads: the number of threads of the process after the run.
+//
+// Run with `--benchmark_filter=all --benchmark_format=json` to get output that
+// can be compared across builds.
+
+#include <algorithm>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "absl/strings/numbers.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/str_split.h"
+#include "absl/strings/strip.h"
+#include "tensorflow/core/data/standalone.h"
+#include "tensorflow/core/framework/allocator.h"
+#include "tensorflow/core/framework/function.h"
+#include "tensorflow/core/framework/function_testlib.h"
+#include "tensorflow/core/framework/graph.pb.h"
+#include "tensorflow/core/framework/node_def.pb.h"
+#include "tensorflow/core/framework/tensor_testutil.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/env_time.h"
+#include "tensorflow/core/platform/test.h"
+#include "tensorflow/core/platform/test_benchmark.h"
+
+namespace tensorflow {
+namespace data {
+namespace standalone {
+namespace {
+
+using test::function::GDef;
+using test::function::NDef;
+using FDH = FunctionDefHelper;
+
+// The number of elements produced before measuring, so that buffers are full.
+constexpr int kNumWarmupElements = 16;
+
+// Maps an int64 scalar to a float vector of `num_floats` copies of it.
+FunctionDef MakeElement(int64_t num_floats) {
+  return FDH::Define(
+      // Name
+      "MakeElement",
+      // Args
+      {"x: int64"},
+      // Return values
+      {"y: float"},
+      // Attr def
+      {},
+      // Nodes
+      {
+          {{"dims"},
+           "Const",
+           {},
+           {{"value", test::AsTensor<int64_t>({num_floats})},
+            {"dtype", DT_INT64}}},
+          {{"value"}, "Cast", {"x"}, {{"SrcT", DT_INT64}, {"DstT", DT_FLOAT}}},
+          {{"y"},
+           "Fill",
+           {"dims", "value"},
+           {{"T", DT_FLOAT}, {"index_type", DT_INT64}}},
+      });
+}
+
+// Builds the graph of an input pipeline that starts with an infinite dataset
+// of float vectors of `num_floats` elements.
+class PipelineBuilder {
+ public:
+  explicit PipelineBuilder(int64_t num_floats)
+      : shape_({num_floats}), function_(MakeElement(num_floats)) {
+    const std::string range = NewName("range");
+    nodes_.push_back(NDef(range, "RangeDataset",
+                          {Int64(0), Int64(kint64max), Int64(1)},
+                          {{"output_types", DataTypeVector({DT_INT64})},
+                           {"output_shapes", Shapes({})}}));
+    output_ = range;
+    Map();
+  }
+
+  PipelineBuilder& Map() {
+    return Add("MapDataset", {output_},
+               {{"f", FDH::FunctionRef("MakeElement")},
+                {"Targuments", DataTypeVector()}});
+  }
+
+  PipelineBuilder& ParallelMap(int64_t num_parallel_calls) {
+    return Add("ParallelMapDatasetV2", {output_, Int64(num_parallel_calls)},
+               {{"f", FDH::FunctionRef("MakeElement")},
+                {"Targuments", DataTypeVector()}});
+  }
+
+  PipelineBuilder& Batch(int64_t batch_size) {
+    shape_.InsertDim(0, batch_size);
+    return Add("BatchDatasetV2",
+               {output_, Int64(batch_size), Bool(true)});
+  }
+
+  PipelineBuilder& Shuffle(int64_t buffer_size) {
+    return Add("ShuffleDataset",
+               {output_, Int64(buffer_size), Int64(1), Int64(2)});
+  }
+
+  PipelineBuilder& Prefetch(int64_t buffer_size) {
+    return Add("PrefetchDataset", {output_, Int64(buffer_size)});
+  }
+
+  GraphDef Build() {
+    nodes_.push_back(
+        NDef("retval", "_Retval", {output_},
+             {{"T", DT_VARIANT}, {"index", 0}}));
+    return GDef(nodes_, {function_});
+  }
+
+ private:
+  PipelineBuilder& Add(
+      const std::string& op, std::vector<std::string> inputs,
+      std::vector<std::pair<string, FDH::AttrValueWrapper>> attrs = {}) {
+    attrs.emplace_back("output_types", DataTypeVector({DT_FLOAT}));
+    attrs.emplace_back("output_shapes", Shapes(shape_));
+    output_ = NewName(op);
+    nodes_.push_back(NDef(output_, op, inputs, attrs));
+    return *this;
+  }
+
+  std::string Int64(int64_t value) { return Const(test::AsScalar(value)); }
+
+  std::string Bool(bool value) { return Const(test::AsScalar(value)); }
+
+  std::string Const(const Tensor& value) {
+    const std::string name = NewName("const");
+    nodes_.push_back(
+        NDef(name, "Const", {}, {{"value", value}, {"dtype", value.dtype()}}));
+    return name;
+  }
+
+  std::string NewName(const std::string& prefix) {
+    return absl::StrCat(prefix, "_", nodes_.size());
+  }
+
+  static std::vector<PartialTensorShape> Shapes(const TensorShape& shape) {
+    return {PartialTensorShape(shape.dim_sizes())};
+  }
+
+  TensorShape shape_;
+  FunctionDef function_;
+  std::vector<NodeDef> nodes_;
+  std::string output_;
+};
+
+// Returns the number of threads of this process, or -1 if it is unknown.
+int64_t NumThreads() {
+  std::string status;
+  if (!ReadFileToString(Env::Default(), "/proc/self/status", &status).ok()) {
+    return -1;
+  }
+  for (absl::string_view line : absl::StrSplit(status, '\n')) {
+    int64_t num_threads;
+    if (absl::ConsumePrefix(&line, "Threads:") &&
+        absl::SimpleAtoi(line, &num_threads)) {
+      return num_threads;
+    }
+  }
+  return -1;
+}
+
+double PercentileMicros(const std::vector<uint64>& sorted_latencies,
+                        double percentile) {
+  const size_t index = std::min(
+      sorted_latencies.size() - 1,
+      static_cast<size_t>(percentile * sorted_latencies.size()));
+  return sorted_latencies[index] / 1000.0;
+}
+
+void RunPipeline(::testing::benchmark::State& state,
+                 const GraphDef& graph_def) {
+  EnableCPUAllocatorStats();
+  cpu_allocator()->ClearStats();
+  std::unique_ptr<Dataset> dataset;
+  TF_CHECK_OK(Dataset::FromGraph({}, graph_def, &dataset));
+  std::unique_ptr<Iterator> iterator;
+  TF_CHECK_OK(dataset->MakeIterator(&iterator));
+  std::vector<Tensor> outputs;
+  bool end_of_input = false;
+  for (int i = 0; i < kNumWarmupElements; ++i) {
+    TF_CHECK_OK(iterator->GetNext(&outputs, &end_of_input));
+  }
+
+  std::vector<uint64> latencies;
+  for (auto _ : state) {
+    const uint64 start = EnvTime::NowNanos();
+    TF_CHECK_OK(iterator->GetNext(&outputs, &end_of_input));
+    latencies.push_back(EnvTime::NowNanos() - start);
+    CHECK(!end_of_input);
+  }
+
+  int64_t element_bytes = 0;
+  for (const Tensor& output : outputs) {
+    element_bytes += output.TotalBytes();
+  }
+  state.SetItemsProcessed(state.iterations());
+  state.SetBytesProcessed(state.iterations() * element_bytes);
+  std::sort(latencies.begin(), latencies.end());
+  state.counters["p50_us"] = PercentileMicros(latencies, 0.5);
+  state.counters["p90_us"] = PercentileMicros(latencies, 0.9);
+  state.counters["p99_us"] = PercentileMicros(latencies, 0.99);
+  state.counters["max_us"] = latencies.back() / 1000.0;
+  absl::optional<AllocatorStats> stats = cpu_allocator()->GetStats();
+  if (stats) {
+    state.counters["peak_bytes"] = stats->peak_bytes_in_use;
+  }
+  state.counters["threads"] = NumThreads();
+  iterator.reset();
+  dataset.reset();
+  DisableCPUAllocatorStats();
+}
+
+void ElementSizes(::benchmark::internal::Benchmark* b) {
+  for (int64_t num_floats : {1, 1 << 10, 1 << 16}) {
+    b->Arg(num_floats);
+  }
+}
+
+void ElementSizesAndParallelism(::benchmark::internal::Benchmark* b) {
+  for (int64_t num_floats : {1, 1 << 10, 1 << 16}) {
+    for (int64_t parallelism : {1, 4, 16}) {
+      b->ArgPair(num_floats, parallelism);
+    }
+  }
+}
+
+void BM_Map(::testing::benchmark::State& state) {
+  RunPipeline(state, PipelineBuilder(state.range(0)).Build());
+}
+BENCHMARK(BM_Map)->Apply(ElementSizes)->UseRealTime();
+
+void BM_ParallelMap(::testing::benchmark::State& state) {
+  RunPipeline(
+      state,
+      PipelineBuilder(state.range(0)).ParallelMap(state.range(1)).Build());
+}
+BENCHMARK(BM_ParallelMap)->Apply(ElementSizesAndParallelism)->UseRealTime();
+
+void BM_Batch(::testing::benchmark::State& state) {
+  RunPipeline(state, PipelineBuilder(state.range(0)).Batch(32).Build());
+}
+BENCHMARK(BM_Batch)->Apply(ElementSizes)->UseRealTime();
+
+void BM_Shuffle(::testing::benchmark::State& state) {
+  RunPipeline(state, PipelineBuilder(state.range(0)).Shuffle(1024).Build());
+}
+BENCHMARK(BM_Shuffle)->Apply(ElementSizes)->UseRealTime();
+
+void BM_Prefetch(::testing::benchmark::State& state) {
+  RunPipeline(state, PipelineBuilder(state.range(0)).Prefetch(16).Build());
+}
+BENCHMARK(BM_Prefetch)->Apply(ElementSizes)->UseRealTime();
+
+// A typical input pipeline: parallel map, batch and prefetch.
+void BM_ParallelMapBatchPrefetch(::testing::benchmark::State& state) {
+  RunPipeline(state, PipelineBuilder(state.range(0))
+                         .ParallelMap(state.range(1))
+                         .Batch(32)
+                         .Prefetch(2)
+                         .Build());
+}
+BENCHMARK(BM_ParallelMapBatchPrefetch)
+    ->Apply(ElementSizesAndParallelism)
+    ->UseRealTime();
+
+}  // namespace
+}  // namespace standalone
+}  // namespace data
+}  // namespace tensorflow
@@ -0,0 +1,67 @@
+/* Copyright 2022 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/data/step_time_breakdown.h"
+
+#include <cstdint>
+
+#include "tensorflow/core/framework/metrics.h"
+#include "tensorflow/core/platform/mutex.h"
+
+namespace tensorflow {
+namespace data {
+namespace {
+
+void UpdateAverage(double value, int64_t num_steps, double* average) {
+  if (num_steps == 1) {
+    *average = value;
+  } else {
+    *average += StepTimeTracker::kSmoothingFactor * (value - *average);
+  }
+}
+
+}  // namespace
+
+StepTimeTracker* StepTimeTracker::Get() {
+  static StepTimeTracker* tracker = new StepTimeTracker();
+  return tracker;
+}
+
+void StepTimeTracker::RecordStep(uint64_t input_time_usec,
+                                 uint64_t compute_time_usec) {
+  StepTimeBreakdown breakdown;
+  {
+    mutex_lock l(mu_);
+    ++breakdown_.num_steps;
+    UpdateAverage(input_time_usec, breakdown_.num_steps,
+                  &breakdown_.input_time_usec);
+    UpdateAverage(compute_time_usec, breakdown_.num_steps,
+                  &breakdown_.compute_time_usec);
+    breakdown_.step_time_usec =
+        breakdown_.input_time_usec + breakdown_.compute_time_usec;
+    breakdown = breakdown_;
+  }
+  metrics::RecordTFDataStepTimeBreakdown(
+      static_cast<int64_t>(breakdown.step_time_usec),
+      static_cast<int64_t>(breakdown.input_time_usec),
+      static_cast<int64_t>(breakdown.compute_time_usec));
+}
+
+StepTimeBreakdown StepTimeTracker::GetBreakdown() const {
+  tf_shared_lock l(mu_);
+  return breakdown_;
+}
+
+}  // namespace data
+}  // namespace tensorflow
@@ -0,0 +1,71 @@
+/* Copyright 2022 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_CORE_DATA_STEP_TIME_BREAKDOWN_H_
+#define TENSORFLOW_CORE_DATA_STEP_TIME_BREAKDOWN_H_
+
+#include <cstdint>
+
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/thread_annotations.h"
+
+namespace tensorflow {
+namespace data {
+
+// The breakdown of the time of the steps consuming tf.data iterators. A step
+// is the interval between the ends of two consecutive `GetNext` calls on a
+// root iterator. Its input time is the time the consumer was blocked in the
+// second `GetNext` call, and its compute time is the time between the two
+// calls. The times are exponential moving averages, in microseconds.
+struct StepTimeBreakdown {
+  int64_t num_steps = 0;
+  double step_time_usec = 0;
+  double input_time_usec = 0;
+  double compute_time_usec = 0;
+
+  // The fraction of the step time blocked on input. Steps with a fraction
+  // close to 1 are input-bound and steps with a fraction close to 0 are
+  // compute-bound.
+  double input_fraction() const {
+    return step_time_usec > 0 ? input_time_usec / step_time_usec : 0;
+  }
+};
+
+// Tracks the step time breakdown of the tf.data iterators of the process, and
+// exports it to the `/tensorflow/data/step_time_breakdown` and
+// `/tensorflow/data/input_bound_percent` gauges. This class is thread-safe.
+class StepTimeTracker {
+ public:
+  // The weight of a new step in the moving averages.
+  static constexpr double kSmoothingFactor = 0.1;
+
+  // Returns the tracker of the process.
+  static StepTimeTracker* Get();
+
+  // Records a step that was blocked in `GetNext` for `input_time_usec` and
+  // spent `compute_time_usec` between `GetNext` calls.
+  void RecordStep(uint64_t input_time_usec, uint64_t compute_time_usec);
+
+  // Returns the current breakdown.
+  StepTimeBreakdown GetBreakdown() const;
+
+ private:
+  mutable mutex mu_;
+  StepTimeBreakdown breakdown_ TF_GUARDED_BY(mu_);
+};
+
+}  // namespace data
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_DATA_STEP_TIME_BREAKDOWN_H_
@@ -0,0 +1,75 @@
+/* Copyright 2022 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/data/step_time_breakdown.h"
+
+#include <cstdint>
+
+#include "tensorflow/core/lib/monitoring/cell_reader.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace data {
+namespace {
+
+using tensorflow::monitoring::testing::CellReader;
+
+TEST(StepTimeTrackerTest, FirstStep) {
+  StepTimeTracker tracker;
+  EXPECT_EQ(tracker.GetBreakdown().num_steps, 0);
+  EXPECT_DOUBLE_EQ(tracker.GetBreakdown().input_fraction(), 0);
+
+  tracker.RecordStep(/*input_time_usec=*/300, /*compute_time_usec=*/100);
+  StepTimeBreakdown breakdown = tracker.GetBreakdown();
+  EXPECT_EQ(breakdown.num_steps, 1);
+  EXPECT_DOUBLE_EQ(breakdown.step_time_usec, 400);
+  EXPECT_DOUBLE_EQ(breakdown.input_time_usec, 300);
+  EXPECT_DOUBLE_EQ(breakdown.compute_time_usec, 100);
+  EXPECT_DOUBLE_EQ(breakdown.input_fraction(), 0.75);
+}
+
+TEST(StepTimeTrackerTest, MovingAverage) {
+  StepTimeTracker tracker;
+  tracker.RecordStep(/*input_time_usec=*/0, /*compute_time_usec=*/1000);
+  tracker.RecordStep(/*input_time_usec=*/1000, /*compute_time_usec=*/0);
+  StepTimeBreakdown breakdown = tracker.GetBreakdown();
+  EXPECT_EQ(breakdown.num_steps, 2);
+  EXPECT_DOUBLE_EQ(breakdown.input_time_usec,
+                   1000 * StepTimeTracker::kSmoothingFactor);
+  EXPECT_DOUBLE_EQ(breakdown.compute_time_usec,
+                   1000 * (1 - StepTimeTracker::kSmoothingFactor));
+  EXPECT_DOUBLE_EQ(breakdown.step_time_usec, 1000);
+
+  // An input-bound pipeline converges to an input fraction of 1.
+  for (int i = 0; i < 200; ++i) {
+    tracker.RecordStep(/*input_time_usec=*/1000, /*compute_time_usec=*/0);
+  }
+  EXPECT_NEAR(tracker.GetBreakdown().input_fraction(), 1, 1e-6);
+}
+
+TEST(StepTimeTrackerTest, ExportsMetrics) {
+  CellReader<int64_t> step_time("/tensorflow/data/step_time_breakdown");
+  CellReader<int64_t> input_bound_percent(
+      "/tensorflow/data/input_bound_percent");
+  StepTimeTracker tracker;
+  tracker.RecordStep(/*input_time_usec=*/100, /*compute_time_usec=*/300);
+  EXPECT_EQ(step_time.Read("step"), 400);
+  EXPECT_EQ(step_time.Read("input"), 100);
+  EXPECT_EQ(step_time.Read("compute"), 300);
+  EXPECT_EQ(input_bound_percent.Read(), 25);
+}
+
+}  // namespace
+}  // namespace data
+}  // namespace tensorflow
@@ -96,7 +96,9 @@ CollectiveParamResolverDistributed::CollectiveParamResolverDistributed(
       worker_cache_(worker_cache),
       group_leader_(task_name == config.experimental().collective_group_leader()
                         ? ""
-                        : config.experimental().collective_group_leader()) {
+                        : config.experimental().collective_group_leader()),
+      local_instance_resolution_(
+          config.experimental().collective_local_instance_resolution()) {
   VLOG(1) << "CompleteParamResolverDistributed ctor task={" << task_name
           << "} config.collective_group_leader={"
           << config.experimental().collective_group_leader() << "}"
@@ -139,6 +141,44 @@ void CollectiveParamResolverDistributed::CompleteParamsAsync(
   }
 }
 
+void CollectiveParamResolverDistributed::CompleteParamsBatchAsync(
+    const DeviceAttributes& device, const std::vector<CollectiveParams*>& cps,
+    CancellationManager* cancel_mgr, const StatusCallback& done) {
+  if (cps.empty()) {
+    done(OkStatus());
+    return;
+  }
+  struct BatchState {
+    mutex mu;
+    int pending TF_GUARDED_BY(mu);
+    Status status TF_GUARDED_BY(mu);
+  };
+  auto* state = new BatchState;
+  {
+    mutex_lock l(state->mu);
+    state->pending = cps.size();
+  }
+  auto done_one = [state, done](const Status& s) {
+    Status status;
+    {
+      mutex_lock l(state->mu);
+      state->status.Update(s);
+      if (--state->pending > 0) return;
+      status = state->status;
+    }
+    delete state;
+    done(status);
+  };
+  CompleteParamsAsync(
+      device, cps[0], cancel_mgr,
+      [this, device, cps, cancel_mgr, done_one](const Status& s) {
+        for (size_t i = 1; i < cps.size(); ++i) {
+          CompleteParamsAsync(device, cps[i], cancel_mgr, done_one);
+        }
+        done_one(s);
+      });
+}
+
 void CollectiveParamResolverDistributed::CompleteGroupAsync(
     const DeviceAttributes& device, CollGroupParams* group_params,
     CancellationManager* cancel_mgr, const StatusCallback& done) {
@@ -368,6 +408,10 @@ void CollectiveParamResolverDistributed::CompleteInstanceDistributed(
     return CompleteInstanceLocal(device, cp, done);
   } else if (InstanceIsCached(cp->group.group_key, cp->instance.instance_key)) {
     return CompleteInstanceLocal(device, cp, done);
+  } else if (local_instance_resolution_ &&
+             cp->instance.type != BROADCAST_COLLECTIVE) {
+    // The leader would only tell us the source rank, which is unused.
+    return CompleteInstanceLocal(device, cp, done);
   } else {
     CompleteInstanceCall* call = new CompleteInstanceCall(
         cp->group, cp->instance, cp->name, device, cp->is_source, cancel_mgr,
@@ -15,6 +15,8 @@ limitations under the License.
 #ifndef TENSORFLOW_CORE_DISTRIBUTED_RUNTIME_COLLECTIVE_PARAM_RESOLVER_DISTRIBUTED_H_
 #define TENSORFLOW_CORE_DISTRIBUTED_RUNTIME_COLLECTIVE_PARAM_RESOLVER_DISTRIBUTED_H_
 
+#include <vector>
+
 #include "tensorflow/core/common_runtime/collective_param_resolver_local.h"
 #include "tensorflow/core/framework/cancellation.h"
 #include "tensorflow/core/framework/device_attributes.pb.h"
@@ -48,6 +50,17 @@ class CollectiveParamResolverDistributed : public CollectiveParamResolverLocal {
                              CancellationManager* cancel_mgr,
                              const StatusCallback& done) override;
 
+  // Completes all the params in "cps", which must be those of "device",
+  // calling "done" once they are all complete. The group of the first params
+  // is completed before the others are issued concurrently, so a batch of
+  // instances of the same group, e.g. all the instances of a job known at
+  // start-up, makes a single group resolution call to the leader, and later
+  // steps find their instances cached.
+  void CompleteParamsBatchAsync(const DeviceAttributes& device,
+                                const std::vector<CollectiveParams*>& cps,
+                                CancellationManager* cancel_mgr,
+                                const StatusCallback& done);
+
   void StartAbort(const Status& s) override;
 
  protected:
@@ -89,6 +102,8 @@ class CollectiveParamResolverDistributed : public CollectiveParamResolverLocal {
 
   WorkerCacheInterface* worker_cache_;  // Not owned
   const string group_leader_;
+  // If true, non-broadcast instances are resolved without asking the leader.
+  const bool local_instance_resolution_;
   CancellationManager abortion_cancel_mgr_;
 };
 
@@ -23,6 +23,7 @@ limitations under the License.
 #include "tensorflow/core/distributed_runtime/worker.h"
 #include "tensorflow/core/distributed_runtime/worker_env.h"
 #include "tensorflow/core/framework/cancellation.h"
+#include "tensorflow/core/lib/core/blocking_counter.h"
 #include "tensorflow/core/lib/core/notification.h"
 #include "tensorflow/core/lib/core/status_test_util.h"
 #include "tensorflow/core/lib/strings/strcat.h"
@@ -127,6 +128,8 @@ class DeviceResDistTest : public ::testing::Test {
     config.mutable_experimental()->set_collective_group_leader(
         "/job:worker/replica:0/task:0");
     config.mutable_experimental()->set_collective_nccl(nccl);
+    config.mutable_experimental()->set_collective_local_instance_resolution(
+        local_instance_resolution_);
 
     std::vector<std::unique_ptr<Device>> devices;
     for (int i = 0; i < num_devices; ++i) {
@@ -180,16 +183,16 @@ class DeviceResDistTest : public ::testing::Test {
   CollectiveParams* CreateCollectiveParams(int num_workers, int num_devices,
                                            const string& device_type,
                                            CollectiveType coll_type,
-                                           bool is_source) {
+                                           bool is_source,
+                                           int instance_key = 3) {
     const int kGroupKey = 5;
-    const int kInstanceKey = 3;
     auto* cp = new CollectiveParams();
     cp->is_source = is_source;
     cp->group.group_key = kGroupKey;
     cp->group.group_size = num_workers * num_devices;
     cp->group.device_type = DeviceType(device_type);
     cp->group.num_tasks = num_workers;
-    cp->instance.instance_key = kInstanceKey;
+    cp->instance.instance_key = instance_key;
     cp->instance.type = coll_type;
     cp->instance.data_type = DT_FLOAT;
     cp->instance.shape = TensorShape({64});
@@ -298,6 +301,7 @@ class DeviceResDistTest : public ::testing::Test {
     }
   }
 
+  bool local_instance_resolution_ = false;
   FakeCache wc_;
   FakeNcclCommunicator nccl_communicator_;
   CancellationManager cm_;
@@ -381,5 +385,72 @@ TEST_F(DeviceResDistTest, Workers4Devices3) {
   ValidateCollectiveParams(num_workers, num_devices);
 }
 
+TEST_F(DeviceResDistTest, LocalInstanceResolution) {
+  const int num_workers = 2;
+  const int num_devices = 2;
+  local_instance_resolution_ = true;
+  DefineWorkers(num_workers, num_devices, "CPU", /*nccl*/ false);
+  DefineCollectiveParams(num_workers, num_devices, "CPU");
+  IssueRequests(num_workers, num_devices);
+  ValidateCollectiveParams(num_workers, num_devices);
+}
+
+TEST_F(DeviceResDistTest, LocalInstanceResolutionBroadcast) {
+  const int num_workers = 2;
+  const int num_devices = 2;
+  const int source_rank = 3;
+  local_instance_resolution_ = true;
+  DefineWorkers(num_workers, num_devices, "CPU", /*nccl*/ false);
+  DefineCollectiveParams(num_workers, num_devices, "CPU", BROADCAST_COLLECTIVE,
+                         source_rank);
+  IssueRequests(num_workers, num_devices);
+  ValidateCollectiveParams(num_workers, num_devices);
+  for (const auto& name_param : cp_) {
+    EXPECT_EQ(name_param.second->source_rank, source_rank);
+  }
+}
+
+TEST_F(DeviceResDistTest, CompleteParamsBatch) {
+  const int num_workers = 2;
+  const int num_devices = 2;
+  const int num_instances = 3;
+  DefineWorkers(num_workers, num_devices, "CPU", /*nccl*/ false);
+  std::vector<CollectiveParams*> all_cps;
+  std::vector<Status> statuses(num_workers * num_devices);
+  BlockingCounter counter(num_workers * num_devices);
+  for (int wi = 0; wi < num_workers; ++wi) {
+    string task_name = strings::StrCat("/job:worker/replica:0/task:", wi);
+    for (int di = 0; di < num_devices; ++di) {
+      string device_name = strings::StrCat(task_name, "/device:CPU:", di);
+      std::vector<CollectiveParams*> cps;
+      for (int i = 0; i < num_instances; ++i) {
+        cps.push_back(CreateCollectiveParams(num_workers, num_devices, "CPU",
+                                             REDUCTION_COLLECTIVE,
+                                             /*is_source=*/false,
+                                             /*instance_key=*/i + 1));
+        all_cps.push_back(cps.back());
+      }
+      Device* device = nullptr;
+      TF_ASSERT_OK(device_mgrs_[task_name]->LookupDevice(device_name, &device));
+      Status* status = &statuses[wi * num_devices + di];
+      cp_resolvers_[task_name]->CompleteParamsBatchAsync(
+          device->attributes(), cps, &cm_,
+          [status, &counter](const Status& s) {
+            *status = s;
+            counter.DecrementCount();
+          });
+    }
+  }
+  counter.Wait();
+  for (const Status& s : statuses) {
+    TF_EXPECT_OK(s);
+  }
+  for (int i = 0; i < all_cps.size(); ++i) {
+    EXPECT_EQ(all_cps[i]->default_rank, i / num_instances);
+    EXPECT_EQ(all_cps[i]->group.members.size(), num_workers * num_devices);
+    all_cps[i]->Unref();
+  }
+}
+
 }  // namespace
 }  // namespace tensorflow
@@ -23,19 +23,85 @@ limitations under the License.
 namespace tensorflow {
 namespace eager {
 
+namespace {
+
+// The handles of a node sent in a (possibly coalesced) EnqueueRequest, and
+// the index of the node's operation in the EnqueueResponse.
+struct PendingNode {
+  gtl::InlinedVector<TensorHandle*, 4> inputs;
+  gtl::InlinedVector<TensorHandle*, 2> retvals;
+  Device* device;
+  int response_index;
+  StatusCallback done;
+};
+
+}  // namespace
+
 void RemoteExecuteNode::RunAsync(StatusCallback done) {
-  auto response = std::make_shared<EnqueueResponse>();
+  std::vector<StatusCallback> callbacks;
+  callbacks.push_back(std::move(done));
+  RunCoalescedAsync({}, std::move(callbacks));
+}
+
+bool RemoteExecuteNode::CanCoalesceWith(
+    const AsyncRemoteExecuteNode* next) const {
+  const auto* other = dynamic_cast<const RemoteExecuteNode*>(next);
+  return other != nullptr && !needs_remote_inputs_ &&
+         !other->needs_remote_inputs_ &&
+         other->eager_context_ == eager_context_ &&
+         other->eager_client_ == eager_client_ &&
+         other->context_view_id_ == context_view_id_ &&
+         other->cancellation_manager_ == cancellation_manager_ &&
+         other->request_->context_id() == request_->context_id();
+}
+
+void RemoteExecuteNode::RunCoalescedAsync(
+    absl::Span<AsyncRemoteExecuteNode* const> others,
+    std::vector<StatusCallback> done) {
+  DCHECK_EQ(done.size(), others.size() + 1);
+  std::vector<const RemoteExecuteNode*> nodes;
+  nodes.reserve(others.size() + 1);
+  nodes.push_back(this);
+  for (AsyncRemoteExecuteNode* other : others) {
+    DCHECK(CanCoalesceWith(other));
+    nodes.push_back(static_cast<const RemoteExecuteNode*>(other));
+  }
+
+  // A single node is sent with its own request. Coalesced nodes have their
+  // queue items concatenated, in order, into one request, so that the worker
+  // runs them as if they had been enqueued one after the other.
+  const EnqueueRequest* request = request_.get();
+  std::shared_ptr<EnqueueRequest> coalesced_request;
+  std::vector<PendingNode> pending(nodes.size());
+  int response_index = 0;
+  if (nodes.size() > 1) {
+    coalesced_request = std::make_shared<EnqueueRequest>();
+    coalesced_request->set_context_id(request_->context_id());
+    request = coalesced_request.get();
+  }
+  for (size_t i = 0; i < nodes.size(); ++i) {
+    const RemoteExecuteNode* node = nodes[i];
+    pending[i].inputs = node->inputs_;
+    pending[i].retvals = node->retvals_;
+    pending[i].device = node->device_;
+    pending[i].response_index = response_index;
+    pending[i].done = std::move(done[i]);
+    response_index += node->request_->queue_size();
+    if (coalesced_request != nullptr) {
+      for (const QueueItem& item : node->request_->queue()) {
+        *coalesced_request->add_queue() = item;
+      }
+    }
+  }
 
-  const gtl::InlinedVector<TensorHandle*, 4>& inputs = inputs_;
-  const gtl::InlinedVector<TensorHandle*, 2>& retvals = retvals_;
-  Device* device = device_;
+  auto response = std::make_shared<EnqueueResponse>();
 
   // Filled and used only when VLOG(3) is on.
   string rpc_description;
   if (VLOG_IS_ON(3)) {
     std::vector<string> ops;
-    ops.reserve(request_->queue_size());
-    for (const QueueItem& item : request_->queue()) {
+    ops.reserve(request->queue_size());
+    for (const QueueItem& item : request->queue()) {
       if (item.has_operation()) {
         ops.push_back(item.operation().name());
       } else {
@@ -57,67 +123,75 @@ void RemoteExecuteNode::RunAsync(StatusCallback done) {
   if (cm != nullptr) {
     token = cm->get_cancellation_token();
     const bool already_cancelled = !cm->RegisterCallback(
-        token, [call_opts, response, done]() { call_opts->StartCancel(); });
+        token, [call_opts, response]() { call_opts->StartCancel(); });
     if (already_cancelled) {
       Status s = errors::Cancelled("RemoteExecuteNode::RunAsync");
-      for (size_t i = 0; i < retvals.size(); ++i) {
-        retvals[i]->PoisonRemote(s, device, context_view_id_);
+      for (PendingNode& node : pending) {
+        for (auto handle : node.retvals) {
+          handle->PoisonRemote(s, node.device, context_view_id_);
+        }
+        node.done(s);
       }
-      done(s);
       return;
     }
   }
 
-  for (auto handle : inputs_) {
-    handle->Ref();
-  }
-  for (auto handle : retvals) {
-    handle->Ref();
+  for (const PendingNode& node : pending) {
+    for (auto handle : node.inputs) {
+      handle->Ref();
+    }
+    for (auto handle : node.retvals) {
+      handle->Ref();
+    }
   }
 
   eager_client_->StreamingEnqueueAsync(
-      eager_context_->Executor().StreamingEnqueue(), call_opts.get(),
-      request_.get(), response.get(),
-      [inputs, retvals, call_opts, response, device,
-       context_view_id = context_view_id_, rpc_description, cm, token,
-       done](const Status& status) {
+      eager_context_->Executor().StreamingEnqueue(), call_opts.get(), request,
+      response.get(),
+      [pending = std::move(pending), coalesced_request, call_opts, response,
+       context_view_id = context_view_id_, rpc_description, cm,
+       token](const Status& status) {
         if (cm != nullptr) {
           cm->TryDeregisterCallback(token);
         }
-        for (auto handle : inputs) {
-          handle->Unref();
-        }
         if (status.ok()) {
           VLOG(3) << "Completed successfully: " << rpc_description;
         } else {
           VLOG(3) << "Failed: " << rpc_description << " with status "
                   << status.ToString();
         }
-        for (size_t i = 0; i < retvals.size(); ++i) {
-          if (status.ok()) {
-            const string output_device =
-                response->queue_response(0).device().empty()
-                    ? ""
-                    : response->queue_response(0).device(i);
-            Status s = retvals[i]->SetRemoteShapeAndDevice(
-                response->queue_response(0).shape(i), device, context_view_id,
-                output_device);
-
-            if (!s.ok()) {
-              LOG(ERROR) << "Ignoring an error encountered when setting "
-                            "remote shape of tensor handle: "
-                         << retvals[i]
-                         << " with execute status: " << status.ToString()
-                         << " and SetRemoteShape status: " << s.ToString()
-                         << "\nThis should never happen. "
-                            "Please file an issue with the TensorFlow Team.";
+        for (const PendingNode& node : pending) {
+          for (auto handle : node.inputs) {
+            handle->Unref();
+          }
+          for (size_t i = 0; i < node.retvals.size(); ++i) {
+            TensorHandle* retval = node.retvals[i];
+            if (status.ok()) {
+              const QueueResponse& queue_response =
+                  response->queue_response(node.response_index);
+              const string output_device = queue_response.device().empty()
+                                               ? ""
+                                               : queue_response.device(i);
+              Status s = retval->SetRemoteShapeAndDevice(
+                  queue_response.shape(i), node.device, context_view_id,
+                  output_device);
+
+              if (!s.ok()) {
+                LOG(ERROR) << "Ignoring an error encountered when setting "
+                              "remote shape of tensor handle: "
+                           << retval
+                           << " with execute status: " << status.ToString()
+                           << " and SetRemoteShape status: " << s.ToString()
+                           << "\nThis should never happen. "
+                              "Please file an issue with the TensorFlow Team.";
+              }
+            } else {
+              retval->PoisonRemote(status, node.device, context_view_id);
             }
-          } else {
-            retvals[i]->PoisonRemote(status, device, context_view_id);
+            retval->Unref();
           }
-          retvals[i]->Unref();
+          node.done(status);
         }
-        done(status);
       });
 }
 
@@ -17,6 +17,7 @@ limitations under the License.
 #define TENSORFLOW_CORE_DISTRIBUTED_RUNTIME_EAGER_REMOTE_EXECUTE_NODE_H_
 
 #include <cstddef>
+#include <vector>
 
 #include "absl/types/span.h"
 #include "tensorflow/core/common_runtime/device.h"
@@ -96,6 +97,14 @@ class RemoteExecuteNode : public AsyncRemoteExecuteNode {
 
   void RunAsync(StatusCallback done) override;
 
+  // Nodes can be coalesced when they are sent over the same client to the
+  // same context, and neither runs a function with remote inputs.
+  bool CanCoalesceWith(const AsyncRemoteExecuteNode* next) const override;
+
+  // Sends the queue items of this node and `others` in one EnqueueRequest.
+  void RunCoalescedAsync(absl::Span<AsyncRemoteExecuteNode* const> others,
+                         std::vector<StatusCallback> done) override;
+
   Status SyncExecutors() override { return eager_context_->SyncExecutors(); }
 
   void Abort(Status status) override {
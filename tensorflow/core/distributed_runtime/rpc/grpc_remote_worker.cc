@@ -15,6 +15,8 @@ limitations under the License.
 
 #include "tensorflow/core/distributed_runtime/rpc/grpc_remote_worker.h"
 
+#include <algorithm>
+#include <atomic>
 #include <utility>
 
 #include "grpcpp/generic/generic_stub.h"
@@ -33,6 +35,7 @@ limitations under the License.
 #include "tensorflow/core/lib/core/threadpool.h"
 #include "tensorflow/core/lib/strings/str_util.h"
 #include "tensorflow/core/platform/logging.h"
+#include "tensorflow/core/platform/mutex.h"
 #include "tensorflow/core/platform/tracing.h"
 #include "tensorflow/core/protobuf/transport_options.pb.h"
 #include "tensorflow/core/protobuf/worker.pb.h"
@@ -67,9 +70,16 @@ class GrpcRemoteWorker : public WorkerInterface {
         getstepsequence_(Method(GrpcWorkerMethod::kGetStepSequence)),
         markrecvfinished_(Method(GrpcWorkerMethod::kMarkRecvFinished)),
         logger_(logger),
-        target_(target) {}
+        target_(target),
+        compression_threshold_bytes_(ReadInt64Flag(
+            "TF_GRPC_TENSOR_COMPRESSION_THRESHOLD_BYTES")),
+        compression_min_rtt_usec_(
+            ReadInt64Flag("TF_GRPC_TENSOR_COMPRESSION_MIN_RTT_MICROS")),
+        streaming_run_graph_(EnableStreamingRunGraph()),
+        run_graph_dispatcher_(&stub_, cq_,
+                              Method(GrpcWorkerMethod::kStreamingRunGraph)) {}
 
-  ~GrpcRemoteWorker() override {}
+  ~GrpcRemoteWorker() override { run_graph_dispatcher_.CancelCall(); }
 
   void GetStatusAsync(CallOptions* call_opts, const GetStatusRequest* request,
                       GetStatusResponse* response, bool fail_fast,
@@ -111,6 +121,11 @@ class GrpcRemoteWorker : public WorkerInterface {
   void RunGraphAsync(CallOptions* call_opts, RunGraphRequestWrapper* request,
                      MutableRunGraphResponseWrapper* response,
                      StatusCallback done) override {
+    if (streaming_run_graph_ && StartStreamingRunGraph()) {
+      StreamingRunGraph(call_opts, request->ToProto(),
+                        get_proto_from_wrapper(response), std::move(done));
+      return;
+    }
     IssueRequest(&request->ToProto(), get_proto_from_wrapper(response),
                  rungraph_, std::move(done), call_opts);
   }
@@ -204,6 +219,15 @@ class GrpcRemoteWorker : public WorkerInterface {
 
     auto callback = [this, request, response, done, start_usec,
                      logging_active](Status s) {
+      if (s.ok() && compression_threshold_bytes_ > 0 &&
+          response->tensor().TotalBytes() < compression_threshold_bytes_) {
+        // Small responses are dominated by latency rather than bandwidth,
+        // so they give a reasonable estimate of the channel round trip.
+        const int64_t rtt = Env::Default()->NowMicros() - start_usec;
+        const int64_t prev = rtt_usec_.load(std::memory_order_relaxed);
+        rtt_usec_.store(prev == 0 ? rtt : (7 * prev + rtt) / 8,
+                        std::memory_order_relaxed);
+      }
       if (logging_active) {
         if (logger_->LoggingActive()) {
           int64_t end_usec = Env::Default()->NowMicros();
@@ -253,6 +277,16 @@ class GrpcRemoteWorker : public WorkerInterface {
       done(s);
     };
 
+    if (UseCompression()) {
+      // The request is serialized when the RPC is issued, so a local copy
+      // is sufficient.
+      RecvTensorRequest compressed_request(*request);
+      compressed_request.set_compression_threshold_bytes(
+          compression_threshold_bytes_);
+      IssueRequest(&compressed_request, response, recvtensor_, callback,
+                   call_opts);
+      return;
+    }
     IssueRequest(request, response, recvtensor_, callback, call_opts);
   }
 
@@ -287,6 +321,56 @@ class GrpcRemoteWorker : public WorkerInterface {
                                  /*fail_fast=*/true, &target_);
   }
 
+  // Returns true if no step is running on the RunGraph stream, and marks the
+  // stream as used by the caller. Concurrent steps use unary calls instead,
+  // since the stream runs its steps one at a time, and a step may wait for
+  // another one to make progress.
+  bool StartStreamingRunGraph() {
+    mutex_lock l(run_graph_mu_);
+    if (run_graph_streaming_) return false;
+    run_graph_streaming_ = true;
+    return true;
+  }
+
+  void StreamingRunGraph(CallOptions* call_opts,
+                         const RunGraphRequest& request,
+                         RunGraphResponse* response, StatusCallback done) {
+    if (call_opts != nullptr) {
+      call_opts->SetCancelCallback(
+          [this]() { run_graph_dispatcher_.CancelCall(); });
+    }
+    const bool store_errors = request.store_errors_in_response_body();
+    run_graph_dispatcher_.SendNextRequest(
+        request, response,
+        [this, call_opts, response, store_errors,
+         done = std::move(done)](Status s) {
+          if (call_opts != nullptr) call_opts->ClearCancelCallback();
+          {
+            mutex_lock l(run_graph_mu_);
+            run_graph_streaming_ = false;
+          }
+          // The worker returns all the errors in the response body.
+          if (s.ok() && !store_errors && response->status_code() != error::OK) {
+            s = Status(response->status_code(),
+                       response->status_error_message());
+          }
+          if (callback_threadpool_ != nullptr) {
+            callback_threadpool_->Schedule([done, s]() { done(s); });
+          } else {
+            done(s);
+          }
+        });
+  }
+
+  // Returns true if RunGraph requests may be sent over a stream kept open
+  // across steps, instead of a call each.
+  static bool EnableStreamingRunGraph() {
+    bool result;
+    TF_CHECK_OK(ReadBoolFromEnvVar("TF_GRPC_WORKER_STREAMING_RUN_GRAPH",
+                                   false, &result));
+    return result;
+  }
+
   void IssueMarkRecvFinishedRequest(int64_t request_id) {
     VLOG(2) << "Send MarkRecvFinishedRequest for request " << request_id;
     MarkRecvFinishedRequest request;
@@ -308,6 +392,23 @@ class GrpcRemoteWorker : public WorkerInterface {
     return max_retries;
   }
 
+  // Reads a non-negative integer option from the environment, defaulting to 0.
+  static int64_t ReadInt64Flag(StringPiece name) {
+    int64_t value = 0;
+    TF_CHECK_OK(ReadInt64FromEnvVar(name, 0, &value));
+    return std::max<int64_t>(value, 0);
+  }
+
+  // Returns true if RecvTensor responses on this channel should be
+  // compressed. Compression is only requested once the measured round trip
+  // time shows that the channel is slow enough for it to pay off.
+  bool UseCompression() const {
+    if (compression_threshold_bytes_ <= 0) return false;
+    if (compression_min_rtt_usec_ == 0) return true;
+    return rtt_usec_.load(std::memory_order_relaxed) >=
+           compression_min_rtt_usec_;
+  }
+
   SharedGrpcChannelPtr channel_;
   ::grpc::GenericStub stub_;
   ::grpc::CompletionQueue* cq_;
@@ -334,6 +435,17 @@ class GrpcRemoteWorker : public WorkerInterface {
   WorkerCacheLogger* logger_;
   const string target_;
 
+  // Support for compressing RecvTensor responses on slow channels.
+  const int64_t compression_threshold_bytes_;
+  const int64_t compression_min_rtt_usec_;
+  std::atomic<int64_t> rtt_usec_{0};
+
+  // Support for running RunGraph requests over a stream.
+  const bool streaming_run_graph_;
+  StreamingRPCDispatcher<RunGraphResponse> run_graph_dispatcher_;
+  mutex run_graph_mu_;
+  bool run_graph_streaming_ TF_GUARDED_BY(run_graph_mu_) = false;
+
   TF_DISALLOW_COPY_AND_ASSIGN(GrpcRemoteWorker);
 };
 
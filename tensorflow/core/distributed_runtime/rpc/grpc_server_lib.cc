@@ -19,9 +19,11 @@ limitations under the License.
 #include <limits>
 #include <memory>
 #include <string>
+#include <unordered_map>
 #include <utility>
 #include <vector>
 
+#include "absl/strings/match.h"
 #include "grpcpp/grpcpp.h"
 #include "grpcpp/security/credentials.h"
 #include "grpcpp/server_builder.h"
@@ -94,6 +96,41 @@ RendezvousMgrInterface* NewRpcRendezvousMgr(const WorkerEnv* env) {
   return new RpcRendezvousMgr(env);
 }
 
+constexpr char kGrpcProtocol[] = "grpc";
+constexpr char kGrpcTransportProtocolPrefix[] = "grpc+";
+
+mutex* get_transport_lock() {
+  static mutex transport_lock(LINKER_INITIALIZED);
+  return &transport_lock;
+}
+
+typedef std::unordered_map<string, GrpcTransport> GrpcTransports;
+GrpcTransports* grpc_transports() {
+  static GrpcTransports* transports = new GrpcTransports;
+  return transports;
+}
+
+// Sets the options of a server using "protocol", which must be "grpc" or
+// name a registered transport.
+Status SetTransportOptions(const string& protocol,
+                           GrpcServerOptions* options) {
+  if (protocol == kGrpcProtocol) return OkStatus();
+  if (!absl::StartsWith(protocol, kGrpcTransportProtocolPrefix)) {
+    return errors::InvalidArgument("Unsupported protocol for gRPC servers: ",
+                                   protocol);
+  }
+  const string name = protocol.substr(strlen(kGrpcTransportProtocolPrefix));
+  mutex_lock l(*get_transport_lock());
+  const auto it = grpc_transports()->find(name);
+  if (it == grpc_transports()->end()) {
+    return errors::NotFound("No gRPC transport registered for protocol ",
+                            protocol);
+  }
+  options->rendezvous_mgr_func = it->second.rendezvous_mgr_func;
+  options->service_func = it->second.service_func;
+  return OkStatus();
+}
+
 }  // namespace
 
 GrpcServer::GrpcServer(const ServerDef& server_def, Env* env)
@@ -566,6 +603,13 @@ std::unique_ptr<Master> GrpcServer::CreateMaster(MasterEnv* master_env) {
   return std::unique_ptr<Master>(new Master(master_env, 0.0));
 }
 
+void RegisterGrpcTransport(const string& name, const GrpcTransport& transport) {
+  mutex_lock l(*get_transport_lock());
+  if (!grpc_transports()->insert({name, transport}).second) {
+    LOG(ERROR) << "Two gRPC transports are being registered under " << name;
+  }
+}
+
 /* static */
 Status GrpcServer::Create(const ServerDef& server_def, Env* env,
                           DeviceMgr* local_device_mgr,
@@ -575,7 +619,8 @@ Status GrpcServer::Create(const ServerDef& server_def, Env* env,
   GrpcServerOptions options;
   options.rendezvous_mgr_func = NewRpcRendezvousMgr;
   options.local_device_mgr = local_device_mgr;
-  Status s = ret->Init(options);
+  Status s = SetTransportOptions(server_def.protocol(), &options);
+  if (s.ok()) s = ret->Init(options);
   if (!s.ok()) {
     LOG(ERROR) << s;
     return s;
@@ -607,7 +652,8 @@ namespace {
 class GrpcServerFactory : public ServerFactory {
  public:
   bool AcceptsOptions(const ServerDef& server_def) override {
-    return server_def.protocol() == "grpc";
+    GrpcServerOptions options;
+    return SetTransportOptions(server_def.protocol(), &options).ok();
   }
 
   Status NewServer(const ServerDef& server_def, const Options& options,
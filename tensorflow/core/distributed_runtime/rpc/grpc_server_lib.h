@@ -72,6 +72,23 @@ struct GrpcServerOptions {
   DeviceMgr* local_device_mgr = nullptr;
 };
 
+// A transport moving tensors between the workers of the jobs that use it,
+// instead of the RecvTensor RPC, e.g. over RDMA. The transport's
+// RendezvousMgr receives remote tensors in RecvFromRemoteAsync, and may
+// register the memory it transfers from through the allocator visitors of
+// ProcessState and GPUProcessState.
+struct GrpcTransport {
+  // Creates the RendezvousMgr of the servers using the transport.
+  RendezvousMgrCreationFunction rendezvous_mgr_func = nullptr;
+  // Registers the services the transport needs with the servers using it,
+  // if any.
+  ServiceInitFunction service_func = nullptr;
+};
+
+// Registers "transport" under "name". The servers whose ServerDef sets the
+// protocol "grpc+<name>" use it.
+void RegisterGrpcTransport(const string& name, const GrpcTransport& transport);
+
 class GrpcServer : public ServerInterface {
  protected:
   GrpcServer(const ServerDef& server_def, Env* env);
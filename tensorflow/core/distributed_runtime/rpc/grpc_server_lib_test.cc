@@ -0,0 +1,65 @@
+/* Copyright 2022 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/distributed_runtime/rpc/grpc_server_lib.h"
+
+#include <memory>
+
+#include "tensorflow/core/distributed_runtime/rpc/rpc_rendezvous_mgr.h"
+#include "tensorflow/core/distributed_runtime/server_lib.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/lib/strings/strcat.h"
+#include "tensorflow/core/platform/errors.h"
+#include "tensorflow/core/platform/test.h"
+#include "tensorflow/core/protobuf/tensorflow_server.pb.h"
+
+namespace tensorflow {
+namespace {
+
+ServerDef MakeServerDef(const string& protocol) {
+  ServerDef server_def;
+  server_def.set_protocol(protocol);
+  server_def.set_job_name("localhost");
+  server_def.set_task_index(0);
+  JobDef* job = server_def.mutable_cluster()->add_job();
+  job->set_name("localhost");
+  (*job->mutable_tasks())[0] =
+      strings::StrCat("localhost:", testing::PickUnusedPortOrDie());
+  return server_def;
+}
+
+TEST(GrpcServerTest, UsesRegisteredTransport) {
+  int num_rendezvous_mgrs = 0;
+  GrpcTransport transport;
+  transport.rendezvous_mgr_func = [&num_rendezvous_mgrs](const WorkerEnv* env) {
+    ++num_rendezvous_mgrs;
+    return new RpcRendezvousMgr(env);
+  };
+  RegisterGrpcTransport("test_transport", transport);
+
+  std::unique_ptr<ServerInterface> server;
+  TF_ASSERT_OK(NewServer(MakeServerDef("grpc+test_transport"), &server));
+  EXPECT_EQ(1, num_rendezvous_mgrs);
+  EXPECT_NE(nullptr, server->worker_env()->rendezvous_mgr);
+}
+
+TEST(GrpcServerTest, UnknownTransport) {
+  std::unique_ptr<ServerInterface> server;
+  EXPECT_TRUE(errors::IsNotFound(
+      NewServer(MakeServerDef("grpc+unknown_transport"), &server)));
+}
+
+}  // namespace
+}  // namespace tensorflow
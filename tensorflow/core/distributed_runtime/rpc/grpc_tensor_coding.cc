@@ -18,6 +18,7 @@ limitations under the License.
 #include "grpcpp/support/byte_buffer.h"
 #include "grpcpp/support/slice.h"
 #include "tensorflow/core/common_runtime/dma_helper.h"
+#include "tensorflow/core/distributed_runtime/tensor_compression.h"
 #include "tensorflow/core/framework/tensor.h"
 #include "tensorflow/core/framework/tensor.pb.h"
 #include "tensorflow/core/framework/tensor_reference.h"
@@ -135,7 +136,8 @@ static void EncodeSkeleton(const Tensor& val, io::ProtoEncodeHelper* e) {
 }
 
 void EncodeTensorToByteBuffer(bool is_dead, const Tensor& val, bool require_ack,
-                              ::grpc::ByteBuffer* result) {
+                              ::grpc::ByteBuffer* result,
+                              int64_t compression_threshold_bytes) {
   const int kLargeTensorBytes = 1024;
   const int64_t kProtoBufLimitBytes = 1LL << 31;
 
@@ -152,6 +154,20 @@ void EncodeTensorToByteBuffer(bool is_dead, const Tensor& val, bool require_ack,
   }
   response.set_require_ack(require_ack);
   response.set_send_start_micros(Env::Default()->NowMicros());
+  if (compression_threshold_bytes > 0 && !is_dead &&
+      DataTypeCanUseMemcpy(val.dtype()) &&
+      val.TotalBytes() >= compression_threshold_bytes) {
+    const TensorCodec codec = CompressTensorContent(
+        val, response.mutable_compressed_tensor_content());
+    if (codec != TENSOR_CODEC_NONE) {
+      response.set_tensor_codec(codec);
+      TensorProto* proto = response.mutable_tensor();
+      proto->set_dtype(val.dtype());
+      val.shape().AsProto(proto->mutable_tensor_shape());
+      EncodeRecvTensorResponseToByteBuffer(response, result);
+      return;
+    }
+  }
   if (!DataTypeCanUseMemcpy(val.dtype())) {
     // Straightforward but slow path for complicated kinds of tensor data
     // TODO(jeff,sanjay): If this becomes an issue, we could
@@ -17,11 +17,18 @@ limitations under the License.
 
 #include "grpcpp/support/byte_buffer.h"
 #include "grpcpp/support/slice.h"
+#include "tensorflow/core/distributed_runtime/rpc/grpc_util.h"
+#include "tensorflow/core/distributed_runtime/tensor_coding.h"
+#include "tensorflow/core/framework/device_attributes.pb.h"
+#include "tensorflow/core/framework/device_base.h"
 #include "tensorflow/core/framework/tensor.h"
 #include "tensorflow/core/framework/tensor_testutil.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
 #include "tensorflow/core/lib/gtl/inlined_vector.h"
 #include "tensorflow/core/lib/strings/strcat.h"
+#include "tensorflow/core/platform/env.h"
 #include "tensorflow/core/platform/test.h"
+#include "tensorflow/core/platform/test_benchmark.h"
 #include "tensorflow/core/protobuf/worker.pb.h"
 
 namespace tensorflow {
@@ -100,4 +107,78 @@ TEST_F(GrpcTensorCodingTest, Simple) {
 
 TEST_F(GrpcTensorCodingTest, StringTensor) { DoTestForStrings(DT_STRING); }
 
+class DummyDevice : public DeviceBase {
+ public:
+  explicit DummyDevice(Env* env) : DeviceBase(env) {
+    attr_.set_device_type("CPU");
+  }
+
+  const DeviceAttributes& attributes() const override { return attr_; }
+
+  Allocator* GetAllocator(AllocatorAttributes attr) override {
+    return cpu_allocator();
+  }
+
+ private:
+  DeviceAttributes attr_;
+};
+
+// Encodes "t" into a ByteBuffer and parses it back with a GrpcByteSource.
+Tensor EncodeAndParse(const Tensor& t, const AllocatorAttributes& attrs) {
+  ::grpc::ByteBuffer buf;
+  grpc::EncodeTensorToByteBuffer(false, t, false, &buf);
+  DummyDevice cpu_device(Env::Default());
+  GrpcByteSource source(&buf);
+  TensorResponse response;
+  response.InitAlloc(&cpu_device, attrs);
+  TF_EXPECT_OK(response.ParseFrom(&source));
+  return response.tensor();
+}
+
+TEST(GrpcTensorResponseTest, SharesLargeTensorContent) {
+  Tensor t(DT_FLOAT, TensorShape({1 << 16}));
+  test::FillIota<float>(&t, 0.0f);
+  Tensor result = EncodeAndParse(t, AllocatorAttributes());
+  test::ExpectTensorEqual<float>(t, result);
+  // The encoded ByteBuffer references the memory of "t", which the parsed
+  // tensor references in turn.
+  EXPECT_EQ(t.tensor_data().data(), result.tensor_data().data());
+}
+
+TEST(GrpcTensorResponseTest, CopiesSmallTensorContent) {
+  Tensor t(DT_FLOAT, TensorShape({16}));
+  test::FillIota<float>(&t, 0.0f);
+  Tensor result = EncodeAndParse(t, AllocatorAttributes());
+  test::ExpectTensorEqual<float>(t, result);
+  EXPECT_NE(t.tensor_data().data(), result.tensor_data().data());
+}
+
+TEST(GrpcTensorResponseTest, CopiesForGpuCompatibleAllocations) {
+  Tensor t(DT_FLOAT, TensorShape({1 << 16}));
+  test::FillIota<float>(&t, 0.0f);
+  AllocatorAttributes attrs;
+  attrs.set_gpu_compatible(true);
+  Tensor result = EncodeAndParse(t, attrs);
+  test::ExpectTensorEqual<float>(t, result);
+  EXPECT_NE(t.tensor_data().data(), result.tensor_data().data());
+}
+
+static void BM_RecvTensorGrpc(::testing::benchmark::State& state) {
+  const int num_bytes = state.range(0);
+
+  Tensor t(DT_UINT8, TensorShape({num_bytes}));
+  t.flat<uint8>().setZero();
+  ::grpc::ByteBuffer buf;
+  grpc::EncodeTensorToByteBuffer(false, t, false, &buf);
+  DummyDevice cpu_device(Env::Default());
+  for (auto s : state) {
+    GrpcByteSource source(&buf);
+    TensorResponse response;
+    response.InitAlloc(&cpu_device, AllocatorAttributes());
+    TF_CHECK_OK(response.ParseFrom(&source));
+  }
+  state.SetBytesProcessed(state.iterations() * num_bytes);
+}
+BENCHMARK(BM_RecvTensorGrpc)->Arg(1 << 10)->Arg(1 << 20)->Arg(1 << 26);
+
 }  // namespace tensorflow
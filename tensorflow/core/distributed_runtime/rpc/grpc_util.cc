@@ -14,7 +14,11 @@ limitations under the License.
 ==============================================================================*/
 
 #include "tensorflow/core/distributed_runtime/rpc/grpc_util.h"
+
+#include <vector>
+
 #include "tensorflow/core/distributed_runtime/tensor_coding.h"
+#include "tensorflow/core/framework/allocation_description.pb.h"
 #include "tensorflow/core/lib/random/random.h"
 
 namespace tensorflow {
@@ -31,8 +35,44 @@ double GenerateUniformRandomNumberBetween(double a, double b) {
   return a + GenerateUniformRandomNumber() * (b - a);
 }
 
+// A TensorBuffer referencing bytes of a gRPC slice, which it keeps alive.
+class GrpcSliceBuffer : public TensorBuffer {
+ public:
+  GrpcSliceBuffer(const ::grpc::Slice& slice, const char* data,
+                  size_t num_bytes)
+      : TensorBuffer(const_cast<char*>(data)),
+        slice_(slice),
+        num_bytes_(num_bytes) {}
+
+  size_t size() const override { return num_bytes_; }
+  TensorBuffer* root_buffer() override { return this; }
+  void FillAllocationDescription(AllocationDescription* proto) const override {
+    proto->set_requested_bytes(num_bytes_);
+    proto->set_allocator_name("grpc_slice");
+  }
+  bool OwnsMemory() const override { return false; }
+
+ private:
+  const ::grpc::Slice slice_;
+  const size_t num_bytes_;
+};
+
 }  // namespace
 
+TensorBuffer* GrpcByteSource::ShareBytes(const char* data, size_t num_bytes) {
+  // Dump() references the slices of the buffer rather than copying them,
+  // except for inlined slices, which are too small to hold shared tensors.
+  std::vector<::grpc::Slice> slices;
+  if (!buffer_->Dump(&slices).ok()) return nullptr;
+  for (const ::grpc::Slice& slice : slices) {
+    const char* begin = reinterpret_cast<const char*>(slice.begin());
+    if (data >= begin && data + num_bytes <= begin + slice.size()) {
+      return new GrpcSliceBuffer(slice, data, num_bytes);
+    }
+  }
+  return nullptr;
+}
+
 int64_t ComputeBackoffMicroseconds(int current_retry_attempt, int64_t min_delay,
                                    int64_t max_delay) {
   DCHECK_GE(current_retry_attempt, 0);
@@ -57,6 +57,9 @@ class GrpcByteSource : public TensorResponse::Source {
     return stream_;
   }
 
+  // Shares the bytes if they lie within a single slice of the buffer.
+  TensorBuffer* ShareBytes(const char* data, size_t num_bytes) override;
+
  private:
   void DeleteStream() {
     if (stream_) {
@@ -149,6 +149,17 @@ class GrpcWorkerServiceThread {
     SETUP_FOR_REQUEST(CleanupGraph, 100, false);
     SETUP_FOR_REQUEST(MarkRecvFinished, 10, false);
 
+    // Each open StreamingRunGraph call requests the next one.
+    {
+      mutex_lock l(shutdown_mu_);
+      if (!is_shutdown_) {
+        StreamingCall<RunGraphRequest, RunGraphResponse>::EnqueueRequest(
+            worker_service_, cq_.get(),
+            &grpc::WorkerService::AsyncService::RequestStreamingRunGraph,
+            &GrpcWorkerServiceThread::StreamingRunGraphHandler);
+      }
+    }
+
     // TODO(ncteisen): Determine a better policy for enqueuing the
     // appropriate number of each request type.
     for (int i = 0;
@@ -163,8 +174,8 @@ class GrpcWorkerServiceThread {
     bool ok;
 
     while (cq_->Next(&tag, &ok)) {
-      UntypedCall<GrpcWorkerServiceThread>::Tag* callback_tag =
-          static_cast<UntypedCall<GrpcWorkerServiceThread>::Tag*>(tag);
+      GrpcCallTag<GrpcWorkerServiceThread>* callback_tag =
+          static_cast<GrpcCallTag<GrpcWorkerServiceThread>*>(tag);
       CHECK(callback_tag);
       callback_tag->OnCompleted(this, ok);
     }
@@ -185,6 +196,11 @@ class GrpcWorkerServiceThread {
   using WorkerCall =
       Call<GrpcWorkerServiceThread, grpc::WorkerService::AsyncService,
            RequestMessage, ResponseMessage>;
+  template <class RequestMessage, class ResponseMessage>
+  using StreamingCall =
+      ServerBidirectionalStreamingCall<GrpcWorkerServiceThread,
+                                       grpc::WorkerService::AsyncService,
+                                       RequestMessage, ResponseMessage>;
 
   // Handle all non-cancellable simple methods with a standard wrapper.
   // The boolean `may_block_on_compute_pool` indicates whether or not the
@@ -264,6 +280,36 @@ class GrpcWorkerServiceThread {
     ENQUEUE_REQUEST(RunGraph, true);
   }
 
+  // Called for each request of a StreamingRunGraph call. The call reads the
+  // next request once the response to this one is sent, so the steps of a
+  // stream run one at a time.
+  void StreamingRunGraphHandler(
+      StreamingCall<RunGraphRequest, RunGraphResponse>* call) {
+    Schedule([this, call]() {
+      CallOptions* call_opts = new CallOptions;
+      ProtoRunGraphRequest* wrapped_request =
+          new ProtoRunGraphRequest(&call->request());
+      NonOwnedProtoRunGraphResponse* wrapped_response =
+          new NonOwnedProtoRunGraphResponse(call->mutable_response());
+      worker_->RunGraphAsync(
+          call_opts, wrapped_request, wrapped_response,
+          [call, call_opts, wrapped_request,
+           wrapped_response](const Status& s) {
+            VLOG(3) << "StreamingRunGraph::Done";
+            // Ending the call would close the stream, so errors are always
+            // returned in the response body.
+            if (!s.ok()) {
+              VLOG(3) << "Bad response from StreamingRunGraph:" << s;
+              wrapped_response->set_status(s);
+            }
+            delete call_opts;
+            delete wrapped_request;
+            delete wrapped_response;
+            call->SendResponse();
+          });
+    });
+  }
+
   void RecvTensorHandlerRaw(
       WorkerCall<RecvTensorRequest, ::grpc::ByteBuffer>* call) {
     Schedule([this, call]() {
@@ -447,12 +493,16 @@ void GrpcWorker::GrpcRecvTensorAsync(CallOptions* opts,
   const int64_t step_id = request->step_id();
 
   bool cache_enabled = (response_cache_ != nullptr && request_id != 0);
+  const int64_t compression_threshold_bytes =
+      request->compression_threshold_bytes();
 
-  auto do_response = [response, done, cache_enabled](const Tensor& tensor,
-                                                     bool is_dead,
-                                                     const Status& status) {
+  auto do_response = [response, done, cache_enabled,
+                      compression_threshold_bytes](const Tensor& tensor,
+                                                   bool is_dead,
+                                                   const Status& status) {
     if (status.ok()) {
-      grpc::EncodeTensorToByteBuffer(is_dead, tensor, cache_enabled, response);
+      grpc::EncodeTensorToByteBuffer(is_dead, tensor, cache_enabled, response,
+                                     compression_threshold_bytes);
     }
     done(status);
   };
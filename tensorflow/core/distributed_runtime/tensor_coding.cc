@@ -18,6 +18,7 @@ limitations under the License.
 #include "google/protobuf/any.pb.h"
 
 #include "tensorflow/core/common_runtime/device.h"
+#include "tensorflow/core/distributed_runtime/tensor_compression.h"
 #include "tensorflow/core/framework/tensor.pb.h"
 #include "tensorflow/core/framework/tensor_shape.pb.h"
 
@@ -87,6 +88,15 @@ Status TensorResponse::ParseFrom(Source* source) {
     if (!meta_.ParseFromCodedStream(&input) || !input.ConsumedEntireMessage()) {
       return errors::InvalidArgument("Cannot parse tensor from response");
     }
+    if (meta_.tensor_codec() != TENSOR_CODEC_NONE) {
+      Tensor host_tensor(meta_.tensor().dtype(),
+                         TensorShape(meta_.tensor().tensor_shape()));
+      TF_RETURN_IF_ERROR(DecompressTensorContent(
+          meta_.tensor_codec(), meta_.compressed_tensor_content(),
+          &host_tensor));
+      host_tensor.AsProtoTensorContent(meta_.mutable_tensor());
+      meta_.clear_compressed_tensor_content();
+    }
     Status s =
         device_->MakeTensorFromProto(meta_.tensor(), alloc_attrs_, &tensor_);
     // Reduce memory usage for big tensors.
@@ -101,10 +111,20 @@ Status TensorResponse::ParseFrom(Source* source) {
     ClearTensor();
   }
   already_used_ = true;
-  if (ParseFast(source)) return OkStatus();
-  meta_.Clear();
-  if (ParseSlow(source)) return OkStatus();
-  return errors::InvalidArgument("Cannot parse tensor from response");
+  bool parsed = ParseFast(source);
+  if (!parsed) {
+    meta_.Clear();
+    parsed = ParseSlow(source);
+  }
+  if (!parsed) {
+    return errors::InvalidArgument("Cannot parse tensor from response");
+  }
+  if (meta_.tensor_codec() == TENSOR_CODEC_NONE) return OkStatus();
+  // The content was not in the tensor proto, so the tensor is newly allocated.
+  Status s = DecompressTensorContent(
+      meta_.tensor_codec(), meta_.compressed_tensor_content(), &tensor_);
+  meta_.clear_compressed_tensor_content();
+  return s;
 }
 
 // Define some helper routines for decoding protocol buffer wire format data
@@ -129,6 +149,10 @@ bool ReadVarintSizeAsInt(protobuf::io::CodedInputStream* input, int* result) {
   }
 }
 
+// Tensor contents of at least this many bytes are shared with the source when
+// possible, instead of being copied.
+constexpr int kMinSharedTensorBytes = 1024;
+
 bool ReadNestedMessage(protobuf::io::CodedInputStream* input,
                        protobuf::Message* value) {
   int length;
@@ -144,7 +168,8 @@ bool ReadNestedMessage(protobuf::io::CodedInputStream* input,
 }  // namespace
 
 bool TensorResponse::ParseTensorSubmessage(
-    protobuf::io::CodedInputStream* input, TensorProto* tensor_meta) {
+    Source* source, protobuf::io::CodedInputStream* input,
+    TensorProto* tensor_meta) {
   bool seen_tensor_content = false;
   while (true) {
     auto p = input->ReadTagWithCutoff(127);
@@ -195,12 +220,13 @@ bool TensorResponse::ParseTensorSubmessage(
         if (!ReadVarintSizeAsInt(input, &num_bytes)) return false;
         seen_tensor_content = true;
         TensorShape shape(tensor_meta->tensor_shape());
+        if (MaybeShareTensorContent(source, input, tensor_meta->dtype(), shape,
+                                    num_bytes)) {
+          break;
+        }
         Tensor t(allocator_, tensor_meta->dtype(), shape);
         StringPiece buf = t.tensor_data();
         if (static_cast<size_t>(num_bytes) != buf.size()) return false;
-        // TODO(jeff,sanjay): Figure out a way to avoid this copy if
-        // the underlying ZeroCopyInputStream data is properly aligned
-        // and compatible with what allocator_ wants.
         if (!input->ReadRaw(const_cast<char*>(buf.data()), num_bytes))
           return false;
         tensor_ = std::move(t);
@@ -215,6 +241,35 @@ bool TensorResponse::ParseTensorSubmessage(
   }
 }
 
+bool TensorResponse::MaybeShareTensorContent(
+    Source* source, protobuf::io::CodedInputStream* input, DataType dtype,
+    const TensorShape& shape, int num_bytes) {
+  // Memory which must be usable by devices can't come from the source.
+  if (num_bytes < kMinSharedTensorBytes || alloc_attrs_.gpu_compatible() ||
+      alloc_attrs_.nic_compatible() ||
+      shape.num_elements() * DataTypeSize(dtype) != num_bytes) {
+    return false;
+  }
+  // The content must be contiguous and aligned like allocated tensors.
+  const void* data;
+  int size;
+  if (!input->GetDirectBufferPointer(&data, &size) || size < num_bytes ||
+      reinterpret_cast<uintptr_t>(data) % Allocator::kAllocatorAlignment !=
+          0) {
+    return false;
+  }
+  TensorBuffer* buf =
+      source->ShareBytes(static_cast<const char*>(data), num_bytes);
+  if (buf == nullptr) return false;
+  if (!input->Skip(num_bytes)) {
+    buf->Unref();
+    return false;
+  }
+  tensor_ = Tensor(dtype, shape, buf);
+  buf->Unref();
+  return true;
+}
+
 bool TensorResponse::ParseFast(Source* source) {
   protobuf::io::CodedInputStream input(source->contents());
   while (true) {
@@ -233,7 +288,7 @@ bool TensorResponse::ParseFast(Source* source) {
         std::pair<protobuf::io::CodedInputStream::Limit, int> p =
             input.IncrementRecursionDepthAndPushLimit(length);
         if (p.second < 0 ||
-            !ParseTensorSubmessage(&input, meta_.mutable_tensor())) {
+            !ParseTensorSubmessage(source, &input, meta_.mutable_tensor())) {
           return false;
         }
         if (!input.DecrementRecursionDepthAndPopLimit(p.first)) {
@@ -265,6 +320,22 @@ bool TensorResponse::ParseFast(Source* source) {
         meta_.set_require_ack(v != 0);
         break;
       }
+      case RecvTensorResponse::kTensorCodecFieldNumber: {
+        uint32 v;
+        if ((wt != WIRETYPE_VARINT) || !input.ReadVarint32(&v)) return false;
+        meta_.set_tensor_codec(static_cast<TensorCodec>(static_cast<int>(v)));
+        break;
+      }
+      case RecvTensorResponse::kCompressedTensorContentFieldNumber: {
+        int length;
+        if ((wt != WIRETYPE_LENGTH_DELIMITED) ||
+            !ReadVarintSizeAsInt(&input, &length) ||
+            !input.ReadString(meta_.mutable_compressed_tensor_content(),
+                              length)) {
+          return false;
+        }
+        break;
+      }
       default: {
         // Unknown tag, so don't handle we can't handle on the fast path
         return false;
@@ -64,6 +64,17 @@ class TensorResponse {
     // Ownership of the returned stream is retained by the Source and
     // should not be deleted by the caller.
     virtual ::tensorflow::protobuf::io::ZeroCopyInputStream* contents() = 0;
+
+    // Return a buffer which shares the "num_bytes" bytes at "data", which
+    // must have been read from the stream last returned by contents(), and
+    // keeps their storage alive, or nullptr if they can't be shared.  The
+    // caller owns a reference on the returned buffer.
+    //
+    // This lets large tensors use the received bytes without copying
+    // them.
+    virtual TensorBuffer* ShareBytes(const char* data, size_t num_bytes) {
+      return nullptr;
+    }
   };
 
   // Parse the RecvTensorResponse encoded in the data yielded by
@@ -92,8 +103,15 @@ class TensorResponse {
   DeviceBase* device() const { return device_; }
 
  private:
-  bool ParseTensorSubmessage(protobuf::io::CodedInputStream* input,
+  bool ParseTensorSubmessage(Source* source,
+                             protobuf::io::CodedInputStream* input,
                              TensorProto* tensor_meta);
+  // Set tensor_ to share the "num_bytes" bytes of tensor content at the
+  // current position of "input" with "source", and skip them, if possible.
+  bool MaybeShareTensorContent(Source* source,
+                               protobuf::io::CodedInputStream* input,
+                               DataType dtype, const TensorShape& shape,
+                               int num_bytes);
   bool ParseFast(Source* source);
   bool ParseSlow(Source* source);
 
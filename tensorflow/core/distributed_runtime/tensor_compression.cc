@@ -0,0 +1,148 @@
+/* Copyright 2022 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/distributed_runtime/tensor_compression.h"
+
+#include <cstring>
+
+#include "tensorflow/core/framework/types.h"
+#include "tensorflow/core/lib/core/coding.h"
+#include "tensorflow/core/lib/core/errors.h"
+#include "tensorflow/core/platform/snappy.h"
+
+namespace tensorflow {
+namespace {
+
+bool IsFloatingPoint(DataType dtype) {
+  return dtype == DT_FLOAT || dtype == DT_DOUBLE || dtype == DT_HALF ||
+         dtype == DT_BFLOAT16;
+}
+
+// Moves byte `b` of element `i` to position `b * n + i`.
+void Shuffle(const char* in, int64_t n, int element_size, char* out) {
+  for (int64_t i = 0; i < n; ++i) {
+    for (int b = 0; b < element_size; ++b) {
+      out[b * n + i] = in[i * element_size + b];
+    }
+  }
+}
+
+void Unshuffle(const char* in, int64_t n, int element_size, char* out) {
+  for (int64_t i = 0; i < n; ++i) {
+    for (int b = 0; b < element_size; ++b) {
+      out[i * element_size + b] = in[b * n + i];
+    }
+  }
+}
+
+template <typename T>
+void DeltaEncode(const T* values, int64_t n, string* out) {
+  uint64 previous = 0;
+  for (int64_t i = 0; i < n; ++i) {
+    const uint64 value = static_cast<uint64>(static_cast<int64_t>(values[i]));
+    const int64_t delta = static_cast<int64_t>(value - previous);
+    core::PutVarint64(out, (static_cast<uint64>(delta) << 1) ^
+                               static_cast<uint64>(delta >> 63));
+    previous = value;
+  }
+}
+
+template <typename T>
+bool DeltaDecode(StringPiece data, int64_t n, T* values) {
+  uint64 previous = 0;
+  for (int64_t i = 0; i < n; ++i) {
+    uint64 zigzag;
+    if (!core::GetVarint64(&data, &zigzag)) return false;
+    const uint64 delta = (zigzag >> 1) ^ (0 - (zigzag & 1));
+    previous += delta;
+    values[i] = static_cast<T>(static_cast<int64_t>(previous));
+  }
+  return data.empty();
+}
+
+}  // namespace
+
+TensorCodec CompressTensorContent(const Tensor& tensor, string* out) {
+  const StringPiece content = tensor.tensor_data();
+  const int64_t n = tensor.NumElements();
+  string compressed;
+  TensorCodec codec = TENSOR_CODEC_NONE;
+  if (IsFloatingPoint(tensor.dtype())) {
+    string shuffled(content.size(), '\0');
+    Shuffle(content.data(), n, DataTypeSize(tensor.dtype()), &shuffled[0]);
+    if (!port::Snappy_Compress(shuffled.data(), shuffled.size(),
+                               &compressed)) {
+      return TENSOR_CODEC_NONE;
+    }
+    codec = TENSOR_CODEC_SHUFFLE_SNAPPY;
+  } else if (tensor.dtype() == DT_INT64) {
+    DeltaEncode(tensor.flat<int64_t>().data(), n, &compressed);
+    codec = TENSOR_CODEC_DELTA_VARINT;
+  } else if (tensor.dtype() == DT_INT32) {
+    DeltaEncode(tensor.flat<int32>().data(), n, &compressed);
+    codec = TENSOR_CODEC_DELTA_VARINT;
+  } else {
+    return TENSOR_CODEC_NONE;
+  }
+  if (compressed.size() >= content.size()) return TENSOR_CODEC_NONE;
+  *out = std::move(compressed);
+  return codec;
+}
+
+Status DecompressTensorContent(TensorCodec codec, StringPiece data,
+                               Tensor* tensor) {
+  const StringPiece content = tensor->tensor_data();
+  char* dst = const_cast<char*>(content.data());
+  const int64_t n = tensor->NumElements();
+  switch (codec) {
+    case TENSOR_CODEC_NONE:
+      if (data.size() != content.size()) break;
+      if (!data.empty()) std::memcpy(dst, data.data(), data.size());
+      return OkStatus();
+    case TENSOR_CODEC_SHUFFLE_SNAPPY: {
+      if (!IsFloatingPoint(tensor->dtype())) break;
+      size_t length;
+      if (!port::Snappy_GetUncompressedLength(data.data(), data.size(),
+                                              &length) ||
+          length != content.size()) {
+        break;
+      }
+      string shuffled(length, '\0');
+      if (!port::Snappy_Uncompress(data.data(), data.size(), &shuffled[0])) {
+        break;
+      }
+      Unshuffle(shuffled.data(), n, DataTypeSize(tensor->dtype()), dst);
+      return OkStatus();
+    }
+    case TENSOR_CODEC_DELTA_VARINT:
+      if (tensor->dtype() == DT_INT64 &&
+          DeltaDecode(data, n, tensor->flat<int64_t>().data())) {
+        return OkStatus();
+      }
+      if (tensor->dtype() == DT_INT32 &&
+          DeltaDecode(data, n, tensor->flat<int32>().data())) {
+        return OkStatus();
+      }
+      break;
+    default:
+      return errors::Unimplemented("Unknown tensor codec ", codec);
+  }
+  return errors::DataLoss("Cannot decompress a ",
+                          DataTypeString(tensor->dtype()), " tensor of shape ",
+                          tensor->shape().DebugString(), " with codec ",
+                          TensorCodec_Name(codec));
+}
+
+}  // namespace tensorflow
@@ -0,0 +1,45 @@
+/* Copyright 2022 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_CORE_DISTRIBUTED_RUNTIME_TENSOR_COMPRESSION_H_
+#define TENSORFLOW_CORE_DISTRIBUTED_RUNTIME_TENSOR_COMPRESSION_H_
+
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/lib/core/status.h"
+#include "tensorflow/core/platform/stringpiece.h"
+#include "tensorflow/core/platform/types.h"
+#include "tensorflow/core/protobuf/worker.pb.h"
+
+namespace tensorflow {
+
+// Compresses the content of `tensor` into `*out` with the codec suited to
+// its dtype:
+//  * floating point tensors are byte-shuffled, so that the bytes of the same
+//    significance, e.g. the exponents, are next to each other, and then
+//    compressed with snappy;
+//  * integer tensors, e.g. ids, are stored as the zigzag varint encoding of
+//    the differences between consecutive elements.
+// Returns the codec used, or TENSOR_CODEC_NONE if no codec applies to the
+// dtype or if the content doesn't get smaller.
+TensorCodec CompressTensorContent(const Tensor& tensor, string* out);
+
+// Decompresses `data`, encoded with `codec`, into `*tensor`, which must
+// already have the dtype and shape of the compressed tensor.
+Status DecompressTensorContent(TensorCodec codec, StringPiece data,
+                               Tensor* tensor);
+
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_DISTRIBUTED_RUNTIME_TENSOR_COMPRESSION_H_
@@ -0,0 +1,94 @@
+/* Copyright 2022 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/distributed_runtime/tensor_compression.h"
+
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_testutil.h"
+#include "tensorflow/core/lib/core/errors.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/snappy.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace {
+
+Tensor RoundTrip(const Tensor& t, TensorCodec expected_codec) {
+  string compressed;
+  EXPECT_EQ(expected_codec, CompressTensorContent(t, &compressed));
+  EXPECT_LT(compressed.size(), t.TotalBytes());
+  Tensor out(t.dtype(), t.shape());
+  TF_EXPECT_OK(DecompressTensorContent(expected_codec, compressed, &out));
+  return out;
+}
+
+TEST(TensorCompressionTest, Float) {
+  string probe;
+  if (!port::Snappy_Compress("abc", 3, &probe)) {
+    GTEST_SKIP() << "Snappy is not available on this platform.";
+  }
+  Tensor t(DT_FLOAT, TensorShape({4, 256}));
+  auto flat = t.flat<float>();
+  for (int i = 0; i < flat.size(); ++i) flat(i) = 1.0f + (i % 16) * 0.5f;
+  test::ExpectTensorEqual<float>(t, RoundTrip(t, TENSOR_CODEC_SHUFFLE_SNAPPY));
+}
+
+TEST(TensorCompressionTest, Int64Ids) {
+  Tensor t(DT_INT64, TensorShape({1024}));
+  auto flat = t.flat<int64_t>();
+  for (int i = 0; i < flat.size(); ++i) flat(i) = 1000000007LL + 3 * i;
+  flat(10) = -5;
+  test::ExpectTensorEqual<int64_t>(t, RoundTrip(t, TENSOR_CODEC_DELTA_VARINT));
+}
+
+TEST(TensorCompressionTest, Int32) {
+  Tensor t(DT_INT32, TensorShape({8, 64}));
+  auto flat = t.flat<int32>();
+  for (int i = 0; i < flat.size(); ++i) flat(i) = 70000 + i;
+  test::ExpectTensorEqual<int32>(t, RoundTrip(t, TENSOR_CODEC_DELTA_VARINT));
+}
+
+TEST(TensorCompressionTest, UnsupportedDtype) {
+  Tensor t(DT_BOOL, TensorShape({1024}));
+  t.flat<bool>().setConstant(true);
+  string compressed;
+  EXPECT_EQ(TENSOR_CODEC_NONE, CompressTensorContent(t, &compressed));
+}
+
+TEST(TensorCompressionTest, Incompressible) {
+  // Random deltas need the full varint width and don't make the content
+  // smaller.
+  Tensor t(DT_INT64, TensorShape({64}));
+  auto flat = t.flat<int64_t>();
+  uint64 x = 88172645463325252ULL;
+  for (int i = 0; i < flat.size(); ++i) {
+    x ^= x << 13;
+    x ^= x >> 7;
+    x ^= x << 17;
+    flat(i) = static_cast<int64_t>(x);
+  }
+  string compressed;
+  EXPECT_EQ(TENSOR_CODEC_NONE, CompressTensorContent(t, &compressed));
+}
+
+TEST(TensorCompressionTest, CorruptData) {
+  Tensor t(DT_INT64, TensorShape({16}));
+  t.flat<int64_t>().setConstant(7);
+  Status s = DecompressTensorContent(TENSOR_CODEC_DELTA_VARINT, "\x01", &t);
+  EXPECT_TRUE(errors::IsDataLoss(s)) << s;
+}
+
+}  // namespace
+}  // namespace tensorflow
@@ -20,6 +20,8 @@ limitations under the License.
 
 #include <functional>
 #include <limits>
+#include <utility>
+#include <vector>
 
 #include "absl/strings/string_view.h"
 #include "absl/types/optional.h"
@@ -403,6 +405,22 @@ class SubAllocator {
     return AllocatorMemoryType::kUnknown;
   }
 
+  // Returns the granularity in bytes at which Remap() can move memory, or 0 if
+  // this SubAllocator doesn't support Remap().
+  virtual size_t RemapGranularity() const { return 0; }
+
+  // Moves the memory behind the (address, size) `ranges` to a single new
+  // contiguous address range without copying it, and returns the start of
+  // that range, whose size is stored in `bytes_received`. Each range must lie
+  // within memory returned by Alloc(), and its address and size must be
+  // multiples of RemapGranularity(). The new range is in turn freed with
+  // Free(); the old addresses must no longer be accessed or freed. Returns
+  // nullptr, leaving `ranges` untouched, if the memory could not be moved.
+  virtual void* Remap(const std::vector<std::pair<void*, size_t>>& ranges,
+                      size_t* bytes_received) {
+    return nullptr;
+  }
+
  protected:
   // Implementation of Alloc() method must call this on newly allocated
   // value.
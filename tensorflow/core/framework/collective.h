@@ -48,6 +48,7 @@ enum CollectiveType {
   GATHER_COLLECTIVE,
   PERMUTE_COLLECTIVE,
   ALL_TO_ALL_COLLECTIVE,
+  ALL_TO_ALL_V_COLLECTIVE,
   UNDEFINED_COLLECTIVE,
 };
 
@@ -115,6 +116,9 @@ struct CollImplDetails {
                               // e.g. ring or nccl
   float timeout_seconds;      // If non zero, set a completion timeout for the
                               // collective op to detect staleness.
+  // If not DT_INVALID, the type in which RingReduce sends float chunks
+  // between devices, i.e. DT_BFLOAT16 or DT_HALF.
+  DataType wire_dtype = DT_INVALID;
 };
 
 // Data common to all members of a collective instance.
@@ -402,6 +406,13 @@ struct CollectiveContext {
   Device* device;       // The device for which this instance labors
   const string device_name;
   DeviceLocality device_locality;
+  // Number of rows of `input` sent to, and of `output` received from, each
+  // group member, and their offsets along the first dimension.  Only used by
+  // collectives with variable split sizes, e.g. all-to-all-v.
+  std::vector<int64_t> send_counts;
+  std::vector<int64_t> send_offsets;
+  std::vector<int64_t> recv_counts;
+  std::vector<int64_t> recv_offsets;
 
   CollectiveContext(CollectiveExecutor* col_exec,
                     NcclCommunicatorInterface* nccl_communicator,
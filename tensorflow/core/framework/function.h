@@ -56,6 +56,7 @@ class Graph;
 class GraphDef;
 class OpKernel;
 class ProcessFunctionLibraryRuntime;
+class RequestCost;
 class ResourceMgr;
 class Rendezvous;
 class ScopedStepContainer;
@@ -848,6 +849,9 @@ class FunctionLibraryRuntime {
     ScopedStepContainer* step_container = nullptr;
     StepStatsCollectorInterface* stats_collector = nullptr;
     CoordinationServiceAgent* coordination_service_agent = nullptr;
+    // If not null, the executors add the compute time and output bytes of the
+    // kernels they run to it.
+    RequestCost* request_cost = nullptr;
 
     absl::optional<ManagedStackTrace> stack_trace = absl::nullopt;
 
@@ -102,12 +102,17 @@ LocalRendezvous::~LocalRendezvous() {
   // calls have finished and the tensors have been released from the queue.
   {
     mutex_lock l(mu_);
-    while (pending_callback_counter_ != 0) {
+    while (pending_callback_counter_.load() != 0) {
       pending_callback_cond_var_.wait_for(l, std::chrono::milliseconds(50));
     }
   }
 
-  if (!table_.empty()) {
+  bool has_items = false;
+  for (Bucket& bucket : buckets_) {
+    mutex_lock l(bucket.mu);
+    has_items = has_items || !bucket.queues.empty();
+  }
+  if (has_items) {
     StartAbort(errors::Cancelled("LocalRendezvous deleted"));
   }
 }
@@ -116,6 +121,43 @@ namespace {
 uint64 KeyHash(const StringPiece& k) { return Hash64(k.data(), k.size()); }
 }  // namespace
 
+LocalRendezvous::ItemQueue* LocalRendezvous::FindQueue(Bucket* bucket,
+                                                       uint64 key_hash) {
+  for (auto& key_and_queue : bucket->queues) {
+    if (key_and_queue.first == key_hash) return &key_and_queue.second;
+  }
+  return nullptr;
+}
+
+LocalRendezvous::ItemQueue* LocalRendezvous::FindOrCreateQueue(
+    Bucket* bucket, uint64 key_hash) {
+  ItemQueue* queue = FindQueue(bucket, key_hash);
+  if (queue != nullptr) return queue;
+  bucket->queues.emplace_back(key_hash, ItemQueue());
+  return &bucket->queues.back().second;
+}
+
+void LocalRendezvous::EraseQueue(Bucket* bucket, uint64 key_hash) {
+  BucketQueues& queues = bucket->queues;
+  for (size_t i = 0; i < queues.size(); ++i) {
+    if (queues[i].first == key_hash) {
+      if (i + 1 != queues.size()) {
+        queues[i] = queues.back();
+      }
+      queues.pop_back();
+      return;
+    }
+  }
+  DCHECK(false) << "No queue for key hash " << key_hash;
+}
+
+void LocalRendezvous::PendingCallbackDone() {
+  if (pending_callback_counter_.fetch_sub(1) == 1) {
+    mutex_lock l(mu_);
+    pending_callback_cond_var_.notify_all();
+  }
+}
+
 Status LocalRendezvous::Send(const Rendezvous::ParsedKey& key,
                              const Rendezvous::Args& send_args,
                              const Tensor& val, const bool is_dead) {
@@ -132,15 +174,15 @@ Status LocalRendezvous::Send(const Rendezvous::ParsedKey& key,
         ->IncrementBy(1);
   }
 
-  mu_.lock();
-  if (!status_.ok()) {
+  Bucket& bucket = GetBucket(key_hash);
+  bucket.mu.lock();
+  if (is_aborted_.load(std::memory_order_relaxed)) {
     // Rendezvous has been aborted.
-    Status s = status_;
-    mu_.unlock();
-    return s;
+    bucket.mu.unlock();
+    return status();
   }
 
-  ItemQueue* queue = &table_[key_hash];
+  ItemQueue* queue = FindOrCreateQueue(&bucket, key_hash);
   if (queue->head == nullptr || queue->head->type == Item::kSend) {
     // There is no waiter for this message. Append the message
     // into the queue. The waiter will pick it up when arrives.
@@ -149,7 +191,7 @@ Status LocalRendezvous::Send(const Rendezvous::ParsedKey& key,
     // the lock.
     DVLOG(2) << "Enqueue Send Item (key:" << key.FullKey() << "). ";
     queue->push_back(new Item(send_args, val, is_dead));
-    mu_.unlock();
+    bucket.mu.unlock();
     return OkStatus();
   }
 
@@ -160,7 +202,7 @@ Status LocalRendezvous::Send(const Rendezvous::ParsedKey& key,
   // Delete the queue when the last element has been consumed.
   if (item->next == nullptr) {
     DVLOG(2) << "Clean up Send/Recv queue (key:" << key.FullKey() << "). ";
-    table_.erase(key_hash);
+    EraseQueue(&bucket, key_hash);
   } else {
     queue->head = item->next;
   }
@@ -176,17 +218,11 @@ Status LocalRendezvous::Send(const Rendezvous::ParsedKey& key,
   }
   pending_callback_counter_++;
   // Invoke the done-callback, without holding the lock.
-  mu_.unlock();
+  bucket.mu.unlock();
   DCHECK_EQ(item->type, Item::kRecv);
   (*item->recv_state.waiter)(OkStatus(), send_args, item->args, val, is_dead);
   delete item;
-  {
-    mutex_lock l(mu_);
-    pending_callback_counter_--;
-    if (pending_callback_counter_ == 0) {
-      pending_callback_cond_var_.notify_all();
-    }
-  }
+  PendingCallbackDone();
   return OkStatus();
 }
 
@@ -196,16 +232,16 @@ void LocalRendezvous::RecvAsync(const Rendezvous::ParsedKey& key,
   uint64 key_hash = KeyHash(key.FullKey());
   DVLOG(2) << "Recv " << this << " " << key_hash << " " << key.FullKey();
 
-  mu_.lock();
-  if (!status_.ok()) {
+  Bucket& bucket = GetBucket(key_hash);
+  bucket.mu.lock();
+  if (is_aborted_.load(std::memory_order_relaxed)) {
     // Rendezvous has been aborted.
-    Status s = status_;
-    mu_.unlock();
-    done(s, Rendezvous::Args(), recv_args, Tensor(), false);
+    bucket.mu.unlock();
+    done(status(), Rendezvous::Args(), recv_args, Tensor(), false);
     return;
   }
 
-  ItemQueue* queue = &table_[key_hash];
+  ItemQueue* queue = FindOrCreateQueue(&bucket, key_hash);
   if (queue->head == nullptr || queue->head->type == Item::kRecv) {
     // There is no message to pick up.
     // Only recv-related fields need to be filled.
@@ -231,11 +267,13 @@ void LocalRendezvous::RecvAsync(const Rendezvous::ParsedKey& key,
       already_cancelled = !cm->RegisterCallback(token, [this, token, key_hash] {
         Item* item = nullptr;
         {
-          mutex_lock l(mu_);
-          ItemQueue* queue = &table_[key_hash];
+          Bucket& bucket = GetBucket(key_hash);
+          mutex_lock l(bucket.mu);
+          ItemQueue* queue = FindQueue(&bucket, key_hash);
           // Find an item in the queue with a cancellation token that matches
           // `token`, and remove it.
-          if (queue->head != nullptr && queue->head->type == Item::kRecv) {
+          if (queue != nullptr && queue->head != nullptr &&
+              queue->head->type == Item::kRecv) {
             for (Item *prev = nullptr, *curr = queue->head; curr != nullptr;
                  prev = curr, curr = curr->next) {
               if (curr->recv_state.cancellation_token == token) {
@@ -243,7 +281,7 @@ void LocalRendezvous::RecvAsync(const Rendezvous::ParsedKey& key,
                 if (queue->head->next == nullptr) {
                   // We have a single-element queue, so we can erase it from
                   // the table.
-                  table_.erase(key_hash);
+                  EraseQueue(&bucket, key_hash);
                 } else {
                   // Remove the current item from the queue.
                   if (curr == queue->head) {
@@ -275,7 +313,10 @@ void LocalRendezvous::RecvAsync(const Rendezvous::ParsedKey& key,
       });
     }
     if (already_cancelled) {
-      mu_.unlock();
+      if (queue->head == nullptr) {
+        EraseQueue(&bucket, key_hash);
+      }
+      bucket.mu.unlock();
       // Unref case (2)
       if (rc_owner_) rc_owner_->Unref();
       done(StatusGroup::MakeDerived(
@@ -312,7 +353,7 @@ void LocalRendezvous::RecvAsync(const Rendezvous::ParsedKey& key,
       queue->push_back(new Item(recv_args, std::move(done), token));
     }
 
-    mu_.unlock();
+    bucket.mu.unlock();
     return;
   }
 
@@ -324,7 +365,7 @@ void LocalRendezvous::RecvAsync(const Rendezvous::ParsedKey& key,
   // Delete the queue when the last element has been consumed.
   if (item->next == nullptr) {
     DVLOG(2) << "Clean up Send/Recv queue (key:" << key.FullKey() << "). ";
-    table_.erase(key_hash);
+    EraseQueue(&bucket, key_hash);
   } else {
     queue->head = item->next;
   }
@@ -340,38 +381,38 @@ void LocalRendezvous::RecvAsync(const Rendezvous::ParsedKey& key,
   }
   pending_callback_counter_++;
   // Invoke the done-callback, without holding the lock.
-  mu_.unlock();
+  bucket.mu.unlock();
   DCHECK_EQ(item->type, Item::kSend);
   done(OkStatus(), item->args, recv_args, *item->send_state.value,
        item->send_state.is_dead);
   delete item;
-  {
-    mutex_lock l(mu_);
-    pending_callback_counter_--;
-    if (pending_callback_counter_ == 0) {
-      pending_callback_cond_var_.notify_all();
-    }
-  }
+  PendingCallbackDone();
 }
 
 void LocalRendezvous::StartAbort(const Status& status) {
   CHECK(!status.ok());
-  Table table;
   {
     mutex_lock l(mu_);
     status_.Update(status);
-    table_.swap(table);
   }
-  for (auto& p : table) {
-    Item* item = p.second.head;
-    while (item != nullptr) {
-      if (item->type == Item::kRecv) {
-        (*item->recv_state.waiter)(status, Rendezvous::Args(),
-                                   Rendezvous::Args(), Tensor(), false);
+  is_aborted_.store(true);
+  for (Bucket& bucket : buckets_) {
+    BucketQueues queues;
+    {
+      mutex_lock l(bucket.mu);
+      queues.swap(bucket.queues);
+    }
+    for (auto& key_and_queue : queues) {
+      Item* item = key_and_queue.second.head;
+      while (item != nullptr) {
+        if (item->type == Item::kRecv) {
+          (*item->recv_state.waiter)(status, Rendezvous::Args(),
+                                     Rendezvous::Args(), Tensor(), false);
+        }
+        Item* to_delete = item;
+        item = item->next;
+        delete to_delete;
       }
-      Item* to_delete = item;
-      item = item->next;
-      delete to_delete;
     }
   }
 }
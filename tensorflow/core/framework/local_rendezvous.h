@@ -16,10 +16,14 @@ limitations under the License.
 #ifndef TENSORFLOW_CORE_FRAMEWORK_LOCAL_RENDEZVOUS_H_
 #define TENSORFLOW_CORE_FRAMEWORK_LOCAL_RENDEZVOUS_H_
 
+#include <array>
+#include <atomic>
+#include <utility>
+
 #include "tensorflow/core/framework/rendezvous.h"
 #include "tensorflow/core/framework/tensor.h"
 #include "tensorflow/core/lib/core/status.h"
-#include "tensorflow/core/lib/gtl/flatmap.h"
+#include "tensorflow/core/lib/gtl/inlined_vector.h"
 #include "tensorflow/core/platform/macros.h"
 #include "tensorflow/core/platform/mutex.h"
 #include "tensorflow/core/platform/types.h"
@@ -66,17 +70,50 @@ class LocalRendezvous {
     Item* tail = nullptr;
   };
 
-  typedef gtl::FlatMap<uint64, ItemQueue> Table;
+  // The item queues are spread over `kNumBuckets` buckets by the hash of
+  // their key, each with its own lock, so that Send/Recv calls on different
+  // edges rarely contend. A bucket holds the queues of its keys inline and
+  // finds them by linear scan, so the table itself never allocates.
+  static constexpr int kNumBuckets = 32;
+  typedef gtl::InlinedVector<std::pair<uint64, ItemQueue>, 2> BucketQueues;
+  struct Bucket {
+    mutex mu;
+    BucketQueues queues TF_GUARDED_BY(mu);
+  };
+
+  Bucket& GetBucket(uint64 key_hash) {
+    return buckets_[key_hash % kNumBuckets];
+  }
+
+  // Returns the queue for `key_hash` in `bucket`, or nullptr if there is none.
+  static ItemQueue* FindQueue(Bucket* bucket, uint64 key_hash)
+      TF_EXCLUSIVE_LOCKS_REQUIRED(bucket->mu);
+  // Returns the queue for `key_hash` in `bucket`, creating an empty one if
+  // there is none.
+  static ItemQueue* FindOrCreateQueue(Bucket* bucket, uint64 key_hash)
+      TF_EXCLUSIVE_LOCKS_REQUIRED(bucket->mu);
+  // Removes the queue for `key_hash` from `bucket`. Invalidates pointers to
+  // the other queues of `bucket`.
+  static void EraseQueue(Bucket* bucket, uint64 key_hash)
+      TF_EXCLUSIVE_LOCKS_REQUIRED(bucket->mu);
+
+  // Decrements `pending_callback_counter_` and wakes up the destructor if it
+  // reaches zero.
+  void PendingCallbackDone();
 
   // Pointer to the owner class of this LocalRendezvous if it is refcounted.
   const Rendezvous* rc_owner_;
 
-  // TODO(zhifengc): shard table_.
+  std::array<Bucket, kNumBuckets> buckets_;
+
   mutex mu_;
-  Table table_ TF_GUARDED_BY(mu_);
   Status status_ TF_GUARDED_BY(mu_);
+  // Set after `status_` becomes an error. Read with a bucket lock held: an
+  // abort sets it before it empties the buckets, so a Send or Recv that does
+  // not see it enqueues an item that the abort will find.
+  std::atomic<bool> is_aborted_{false};
   // Track the number of pening callbacks using a counter.
-  int pending_callback_counter_ TF_GUARDED_BY(mu_);
+  std::atomic<int> pending_callback_counter_;
   condition_variable pending_callback_cond_var_ TF_GUARDED_BY(mu_);
 
   TF_DISALLOW_COPY_AND_ASSIGN(LocalRendezvous);
@@ -163,6 +163,12 @@ auto* tf_data_service_cross_trainer_cache_size_bytes =
         "/tensorflow/data/service/cross_trainer_cache_size_bytes",
         "tf.data service cross-trainer cache memory usage in bytes.");
 
+auto* tf_data_service_optimal_number_of_workers =
+    monitoring::Gauge<int64_t, 0>::New(
+        "/tensorflow/data/service/optimal_number_of_workers",
+        "Number of tf.data service workers needed to meet the demand of the "
+        "clients, or 0 if unknown.");
+
 auto* tf_data_filename_counter = monitoring::Counter<2>::New(
     "/tensorflow/data/filename", "The file name read by a tf.data Dataset.",
     "name", "filename");
@@ -171,6 +177,18 @@ auto* tf_data_model_gauge =
     monitoring::Gauge<std::function<std::string()>, 1>::New(
         "/tensorflow/data/model", "tf.data autotuning model proto.", "id");
 
+auto* tf_data_step_time_breakdown = monitoring::Gauge<int64_t, 1>::New(
+    "/tensorflow/data/step_time_breakdown",
+    "The moving averages (in microseconds) of the time of the steps consuming "
+    "tf.data iterators, and of the time blocked in `GetNext()` (input) and "
+    "spent between `GetNext()` calls (compute) in them.",
+    "component");
+
+auto* tf_data_input_bound_percent = monitoring::Gauge<int64_t, 0>::New(
+    "/tensorflow/data/input_bound_percent",
+    "The moving average of the percentage of the time of the steps consuming "
+    "tf.data iterators that is blocked in `GetNext()`.");
+
 auto* tf_data_auto_shard = monitoring::Gauge<int64, 2>::New(
     "/tensorflow/data/autoshard", "tf.data autoshard statistics.", "id",
     "name");
@@ -242,6 +260,46 @@ auto* bfc_allocator_delay =
                                 "The total time spent running each graph "
                                 "optimization pass in microseconds.");
 
+auto* event_mgr_callback_latency_usecs = monitoring::Sampler<0>::New(
+    {"/tensorflow/core/event_mgr/callback_latency_usecs",
+     "The time between the completion of a device event and the start of the "
+     "EventMgr callback waiting on it, in microseconds."},
+    // Power of 2 with bucket count 20 (> 1 second)
+    {monitoring::Buckets::Exponential(1, 2, 20)});
+
+auto* event_mgr_callback_batch_size = monitoring::Sampler<0>::New(
+    {"/tensorflow/core/event_mgr/callback_batch_size",
+     "The number of EventMgr callbacks dispatched together."},
+    // Power of 2 with bucket count 12 (2048)
+    {monitoring::Buckets::Exponential(1, 2, 12)});
+
+auto* bfc_allocation_bytes = monitoring::Sampler<2>::New(
+    {"/tensorflow/core/bfc_allocator/allocation_bytes",
+     "The size of BFC allocator allocations in bytes.", "allocator", "op"},
+    // Power of 4 with bucket count 16 (1GB)
+    {monitoring::Buckets::Exponential(256, 4, 16)});
+
+auto* bfc_allocation_lifetime_usecs = monitoring::Sampler<2>::New(
+    {"/tensorflow/core/bfc_allocator/allocation_lifetime_usecs",
+     "The time between a BFC allocator allocation and its deallocation in "
+     "microseconds.",
+     "allocator", "op"},
+    // Power of 2 with bucket count 30 (> 17 minutes)
+    {monitoring::Buckets::Exponential(1, 2, 30)});
+
+auto* bfc_fragmentation = monitoring::Sampler<1>::New(
+    {"/tensorflow/core/bfc_allocator/fragmentation",
+     "The fraction of free BFC allocator memory that lies outside the largest "
+     "free chunk, sampled periodically.",
+     "allocator"},
+    {monitoring::Buckets::Explicit(
+        {0.05, 0.1, 0.2, 0.3, 0.4, 0.5, 0.6, 0.7, 0.8, 0.9, 0.95})});
+
+auto* bfc_peak_bytes_in_use = monitoring::Gauge<int64_t, 2>::New(
+    "/tensorflow/core/bfc_allocator/peak_bytes_in_use",
+    "The peak number of bytes in use by a BFC allocator during a phase.",
+    "allocator", "phase");
+
 auto* tpu_variable_distribution_time_usecs = monitoring::Counter<0>::New(
     "/tensorflow/tpu/variable_distribution_time",
     "Time spent sending variables from primary task to other worker tasks "
@@ -345,6 +403,18 @@ void RecordTFDataIteratorGap(uint64 duration_us) {
   tf_data_iterator_gap_msec_histogram_cell->Add(duration_us * 0.001);
 }
 
+void RecordTFDataStepTimeBreakdown(int64_t step_time_us, int64_t input_time_us,
+                                   int64_t compute_time_us) {
+  static auto* step_cell = tf_data_step_time_breakdown->GetCell("step");
+  static auto* input_cell = tf_data_step_time_breakdown->GetCell("input");
+  static auto* compute_cell = tf_data_step_time_breakdown->GetCell("compute");
+  step_cell->Set(step_time_us);
+  input_cell->Set(input_time_us);
+  compute_cell->Set(compute_time_us);
+  tf_data_input_bound_percent->GetCell()->Set(
+      step_time_us > 0 ? 100 * input_time_us / step_time_us : 0);
+}
+
 void RecordTFDataOptimization(const string& name, int64_t num_changes) {
   tf_data_optimization_counter->GetCell(name)->IncrementBy(num_changes);
 }
@@ -394,6 +464,10 @@ void RecordTFDataServiceCrossTrainerCacheSizeBytes(size_t bytes) {
       static_cast<int64_t>(bytes));
 }
 
+void RecordTFDataServiceOptimalNumberOfWorkers(int64_t number_of_workers) {
+  tf_data_service_optimal_number_of_workers->GetCell()->Set(number_of_workers);
+}
+
 void RecordTFDataFilename(const string& name, const string& filename) {
   tf_data_filename_counter->GetCell(name, filename)->IncrementBy(1);
 }
@@ -507,6 +581,37 @@ void UpdateBfcAllocatorDelayTime(const uint64 delay_usecs) {
   }
 }
 
+void RecordEventMgrCallbackLatency(uint64 latency_usecs) {
+  static auto* event_mgr_callback_latency_usecs_cell =
+      event_mgr_callback_latency_usecs->GetCell();
+  event_mgr_callback_latency_usecs_cell->Add(latency_usecs);
+}
+
+void RecordEventMgrCallbackBatchSize(int64_t batch_size) {
+  static auto* event_mgr_callback_batch_size_cell =
+      event_mgr_callback_batch_size->GetCell();
+  event_mgr_callback_batch_size_cell->Add(batch_size);
+}
+
+monitoring::SamplerCell* GetBfcAllocationBytesSampler(const string& allocator,
+                                                      const string& op_name) {
+  return bfc_allocation_bytes->GetCell(allocator, op_name);
+}
+
+monitoring::SamplerCell* GetBfcAllocationLifetimeSampler(
+    const string& allocator, const string& op_name) {
+  return bfc_allocation_lifetime_usecs->GetCell(allocator, op_name);
+}
+
+monitoring::SamplerCell* GetBfcFragmentationSampler(const string& allocator) {
+  return bfc_fragmentation->GetCell(allocator);
+}
+
+monitoring::GaugeCell<int64_t>* GetBfcPeakBytesInUseGauge(
+    const string& allocator, const string& phase) {
+  return bfc_peak_bytes_in_use->GetCell(allocator, phase);
+}
+
 void RecordUnusedOutput(const string& op_name) {
   graph_unused_outputs->GetCell(op_name)->IncrementBy(1);
 }
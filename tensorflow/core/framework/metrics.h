@@ -20,6 +20,7 @@ limitations under the License.
 #include "tensorflow/core/framework/dataset_options.pb.h"
 #include "tensorflow/core/lib/monitoring/counter.h"
 #include "tensorflow/core/lib/monitoring/gauge.h"
+#include "tensorflow/core/lib/monitoring/sampler.h"
 #include "tensorflow/core/platform/env.h"
 #include "tensorflow/core/platform/statusor.h"
 #include "tensorflow/core/platform/types.h"
@@ -103,6 +104,12 @@ void RecordTFDataIteratorLifetime(uint64 duration_us);
 // request.
 void RecordTFDataIteratorGap(uint64 duration_us);
 
+// Records the moving averages (in microseconds) of the time of the steps
+// consuming tf.data iterators, of the time blocked in `GetNext()` in them, and
+// of the time between `GetNext()` calls.
+void RecordTFDataStepTimeBreakdown(int64_t step_time_us, int64_t input_time_us,
+                                   int64_t compute_time_us);
+
 // Records the number of independent graph changes resulting from the
 // application of a tf.data optimization.
 //
@@ -129,6 +136,10 @@ void RecordTFDataServiceCrossTrainerCacheQuery(bool cache_hit);
 // Records tf.data service cross-trainer cache memory usage in bytes.
 void RecordTFDataServiceCrossTrainerCacheSizeBytes(size_t bytes);
 
+// Records the number of tf.data service workers recommended by the dispatcher
+// based on the clients' consumption rate and the workers' throughput.
+void RecordTFDataServiceOptimalNumberOfWorkers(int64_t number_of_workers);
+
 // Records the file name read by a tf.data Dataset.
 //
 // The `name` argument identifies the Dataset type (e.g. "TFRecordDataset").
@@ -305,6 +316,33 @@ void UpdateXlaCompilationTime(const uint64 compilation_time_usecs);
 // Updates the metrics stored about time BFC allocator spents during delay.
 void UpdateBfcAllocatorDelayTime(const uint64 delay_usecs);
 
+// Records the time between the completion of a device event watched by an
+// EventMgr and the start of its callback, in microseconds.
+void RecordEventMgrCallbackLatency(uint64 latency_usecs);
+
+// Records the number of EventMgr callbacks dispatched to the threadpool
+// together.
+void RecordEventMgrCallbackBatchSize(int64_t batch_size);
+
+// Returns a sampler that can be used to record the sizes of the allocations
+// made by `op_name` through the BFC allocator named `allocator`.
+monitoring::SamplerCell* GetBfcAllocationBytesSampler(const string& allocator,
+                                                      const string& op_name);
+
+// Returns a sampler that can be used to record how long the allocations made by
+// `op_name` through the BFC allocator named `allocator` stay alive.
+monitoring::SamplerCell* GetBfcAllocationLifetimeSampler(
+    const string& allocator, const string& op_name);
+
+// Returns a sampler that can be used to record the fragmentation ratio of the
+// BFC allocator named `allocator` over time.
+monitoring::SamplerCell* GetBfcFragmentationSampler(const string& allocator);
+
+// Returns a gauge that can be used to record the peak bytes in use by the BFC
+// allocator named `allocator` during `phase` (e.g. "warmup" or "training").
+monitoring::GaugeCell<int64_t>* GetBfcPeakBytesInUseGauge(
+    const string& allocator, const string& phase);
+
 // Increments (by 1) a simple integer counter that is exposed for testing.
 void IncrementTestCounter(const string& name, const string& label);
 
@@ -16,6 +16,7 @@ limitations under the License.
 #include "tensorflow/core/framework/model.h"
 
 #include <algorithm>
+#include <cmath>
 #include <memory>
 #include <queue>
 
@@ -1590,8 +1591,8 @@ double Node::TotalProcessingTime(Node::NodeValues* processing_times) {
 }
 
 double Node::AverageBufferedElementSize() const {
-  DCHECK_GE(num_elements_, 0);
-  DCHECK_GE(buffered_elements_, 0);
+  DCHECK_GE(num_elements_.load(), 0);
+  DCHECK_GE(buffered_elements_.load(), 0);
   if (num_elements_ <= 0) {
     if (buffered_elements_ <= 0) {
       // If there are no produced elements or buffered elements recorded, return
@@ -1744,6 +1745,37 @@ void Node::CollectTunableParametersHelper(
   }
 }
 
+absl::flat_hash_map<string, double> Node::TunableParameterValues() const {
+  absl::flat_hash_map<string, double> values;
+  tf_shared_lock l(mu_);
+  for (const auto& [name, parameter] : parameters_) {
+    if (parameter->state == nullptr || !parameter->state->tunable) {
+      continue;
+    }
+    mutex_lock state_lock(*parameter->state->mu);
+    // The value is `kAutotune` until the pipeline picks an initial value.
+    if (parameter->state->value > 0) {
+      values[name] = parameter->state->value;
+    }
+  }
+  return values;
+}
+
+bool Node::SetTunableParameterValue(const string& name, double value) {
+  tf_shared_lock l(mu_);
+  auto it = parameters_.find(name);
+  if (it == parameters_.end() || it->second->state == nullptr ||
+      !it->second->state->tunable) {
+    return false;
+  }
+  const std::shared_ptr<Parameter>& parameter = it->second;
+  mutex_lock state_lock(*parameter->state->mu);
+  parameter->state->value =
+      std::min(std::max(value, parameter->min), parameter->max);
+  parameter->state->cond_var->notify_all();
+  return true;
+}
+
 void Node::DebugStringHelper(absl::flat_hash_map<string, string>* debug_strings)
     const TF_SHARED_LOCKS_REQUIRED(mu_) {
   string result;
@@ -1941,6 +1973,69 @@ Status Node::FromProto(ModelProto::Node node_proto,
   return FromProtoHelper(node_proto, *node);
 }
 
+bool RamBudgetManager::RequestBytes(int64_t delta) {
+  mutex_lock l(mu_);
+  if (delta > 0 && budget_ > 0 && reserved_bytes_ + delta > budget_) {
+    return false;
+  }
+  reserved_bytes_ += delta;
+  return true;
+}
+
+// static
+ModelCoordinator* ModelCoordinator::Global() {
+  static ModelCoordinator* coordinator = new ModelCoordinator();
+  return coordinator;
+}
+
+void ModelCoordinator::Register(const Model* model) {
+  mutex_lock l(mu_);
+  wait_fractions_.try_emplace(model, 0.0);
+}
+
+void ModelCoordinator::Unregister(const Model* model) {
+  mutex_lock l(mu_);
+  wait_fractions_.erase(model);
+}
+
+bool ModelCoordinator::IsRegistered(const Model* model) const {
+  tf_shared_lock l(mu_);
+  return wait_fractions_.contains(model);
+}
+
+void ModelCoordinator::RecordWaitFraction(const Model* model,
+                                          double wait_fraction) {
+  mutex_lock l(mu_);
+  auto it = wait_fractions_.find(model);
+  if (it != wait_fractions_.end()) {
+    it->second = std::min(std::max(wait_fraction, 0.0), 1.0);
+  }
+}
+
+double ModelCoordinator::Share(const Model* model) const {
+  tf_shared_lock l(mu_);
+  auto it = wait_fractions_.find(model);
+  if (it == wait_fractions_.end()) {
+    return 1.0;
+  }
+  double total_weight = 0.0;
+  for (const auto& [unused, wait_fraction] : wait_fractions_) {
+    total_weight += kMinWeight + wait_fraction;
+  }
+  return (kMinWeight + it->second) / total_weight;
+}
+
+int64_t ModelCoordinator::CpuBudget(const Model* model,
+                                    int64_t cpu_budget) const {
+  return std::max<int64_t>(
+      1, static_cast<int64_t>(std::round(cpu_budget * Share(model))));
+}
+
+int64_t ModelCoordinator::RamBudget(const Model* model,
+                                    int64_t ram_budget) const {
+  return static_cast<int64_t>(ram_budget * Share(model));
+}
+
 Model::Model() : optimization_period_ms_(kOptimizationPeriodMinMs) {
   model_gauge_cell_ = metrics::GetTFDataModelGauge(
       strings::StrCat(reinterpret_cast<uint64>(this)));
@@ -2088,6 +2183,10 @@ Status Model::OptimizeLoop(AutotuneAlgorithm algorithm, int64_t cpu_budget,
 
   int64_t last_optimization_ms = 0;
   int64_t current_time_ms = EnvTime::NowMicros() / EnvTime::kMillisToMicros;
+  // Consumer wait time at the previous optimization, used to compute the wait
+  // fraction reported to the `ModelCoordinator`.
+  uint64_t last_wait_time_usec = 0;
+  int64_t last_wait_time_check_usec = 0;
   while (true) {
     {
       mutex_lock l(mu_);
@@ -2105,6 +2204,27 @@ Status Model::OptimizeLoop(AutotuneAlgorithm algorithm, int64_t cpu_budget,
     }
 
     int64_t start_ms = EnvTime::NowMicros() / EnvTime::kMillisToMicros;
+    int64_t optimization_cpu_budget = cpu_budget;
+    int64_t optimization_ram_budget = ram_budget;
+    ModelCoordinator* coordinator = ModelCoordinator::Global();
+    if (coordinator->IsRegistered(this)) {
+      const uint64_t wait_time_usec = ConsumerWaitTimeUsec();
+      const int64_t now_usec = EnvTime::NowMicros();
+      if (last_wait_time_check_usec > 0 &&
+          now_usec > last_wait_time_check_usec) {
+        coordinator->RecordWaitFraction(
+            this, static_cast<double>(wait_time_usec - last_wait_time_usec) /
+                      (now_usec - last_wait_time_check_usec));
+      }
+      last_wait_time_usec = wait_time_usec;
+      last_wait_time_check_usec = now_usec;
+      optimization_cpu_budget = coordinator->CpuBudget(this, cpu_budget);
+      optimization_ram_budget = coordinator->RamBudget(this, ram_budget);
+      ram_budget_manager_->SetBudget(optimization_ram_budget);
+      VLOG(2) << "Optimizing with a CPU budget of " << optimization_cpu_budget
+              << " and a RAM budget of " << optimization_ram_budget
+              << " bytes shared with other input pipelines.";
+    }
     double model_input_time = 0.0;
     // Model input time is set to 0 for all optimization algorithms except for
     // stage-based optimization algorithm for historical reason. In stage-based
@@ -2113,8 +2233,8 @@ Status Model::OptimizeLoop(AutotuneAlgorithm algorithm, int64_t cpu_budget,
     if (algorithm == AutotuneAlgorithm::STAGE_BASED) {
       model_input_time = ComputeTargetTimeNsec();
     }
-    Optimize(algorithm, cpu_budget, ram_budget, model_input_time,
-             cancellation_manager);
+    Optimize(algorithm, optimization_cpu_budget, optimization_ram_budget,
+             model_input_time, cancellation_manager);
     int64_t end_ms = EnvTime::NowMicros() / EnvTime::kMillisToMicros;
     VLOG(2) << "Optimized for " << end_ms - start_ms << " ms.";
 
@@ -2128,6 +2248,18 @@ Status Model::OptimizeLoop(AutotuneAlgorithm algorithm, int64_t cpu_budget,
     current_time_ms = EnvTime::NowMicros() / EnvTime::kMillisToMicros;
     last_optimization_ms = current_time_ms;
     FlushMetrics();
+    string tunable_parameters_file;
+    {
+      tf_shared_lock l(mu_);
+      tunable_parameters_file = tunable_parameters_file_;
+    }
+    if (!tunable_parameters_file.empty()) {
+      Status s = SaveTunableParameters(tunable_parameters_file);
+      if (!s.ok()) {
+        LOG(WARNING) << "Failed to save tunable parameters to "
+                     << tunable_parameters_file << ": " << s;
+      }
+    }
   }
 }
 
@@ -2258,6 +2390,11 @@ void Model::OptimizeHillClimbHelper(
   UpdateStateValues(&parameters);
 }
 
+uint64_t Model::ConsumerWaitTimeUsec() const {
+  tf_shared_lock l(gap_mu_);
+  return wait_time_sum_usec_;
+}
+
 double Model::ComputeTargetTimeNsec() {
   tf_shared_lock l(gap_mu_);
   if (gap_time_count_ == 0) {
@@ -2455,6 +2592,62 @@ Status Model::Load(const string& fname, std::unique_ptr<Model>* model,
   return OkStatus();
 }
 
+Status Model::SaveTunableParameters(const string& fname) {
+  std::shared_ptr<Node> output;
+  {
+    tf_shared_lock l(mu_);
+    output = output_;
+  }
+  if (!output) {
+    return OkStatus();
+  }
+  Node::NodeVector nodes = output->CollectNodes(
+      TraversalOrder::BFS, [](const std::shared_ptr<Node>) { return true; });
+  nodes.push_back(output);
+  TunableParameterValuesProto proto;
+  for (const auto& node : nodes) {
+    for (const auto& [name, value] : node->TunableParameterValues()) {
+      (*proto.mutable_values())[strings::StrCat(node->long_name(), ":", name)] =
+          value;
+    }
+  }
+  // Write to a temporary file first so that a concurrent reader never observes
+  // a partially written file.
+  const string tmp_fname = strings::StrCat(fname, ".tmp");
+  TF_RETURN_IF_ERROR(WriteBinaryProto(Env::Default(), tmp_fname, proto));
+  return Env::Default()->RenameFile(tmp_fname, fname);
+}
+
+Status Model::RestoreTunableParameters(const string& fname) {
+  TunableParameterValuesProto proto;
+  TF_RETURN_IF_ERROR(ReadBinaryProto(Env::Default(), fname, &proto));
+  std::shared_ptr<Node> output;
+  {
+    tf_shared_lock l(mu_);
+    output = output_;
+  }
+  if (!output) {
+    return OkStatus();
+  }
+  Node::NodeVector nodes = output->CollectNodes(
+      TraversalOrder::BFS, [](const std::shared_ptr<Node>) { return true; });
+  nodes.push_back(output);
+  int64_t num_restored = 0;
+  for (const auto& node : nodes) {
+    for (const auto& [name, unused] : node->TunableParameterValues()) {
+      auto it = proto.values().find(
+          strings::StrCat(node->long_name(), ":", name));
+      if (it != proto.values().end() &&
+          node->SetTunableParameterValue(name, it->second)) {
+        ++num_restored;
+      }
+    }
+  }
+  VLOG(2) << "Restored " << num_restored << " tunable parameters from "
+          << fname;
+  return OkStatus();
+}
+
 std::string Model::DebugString() {
   constexpr int64_t kMinSecondsBetweenCalls = 30;
   if (absl::Now() < cache_until_) return cached_debug_string_;
@@ -15,6 +15,7 @@ limitations under the License.
 #ifndef TENSORFLOW_CORE_FRAMEWORK_MODEL_H_
 #define TENSORFLOW_CORE_FRAMEWORK_MODEL_H_
 
+#include <atomic>
 #include <list>
 #include <memory>
 #include <string>
@@ -23,6 +24,7 @@ limitations under the License.
 #include <utility>
 #include <vector>
 
+#include "absl/base/optimization.h"
 #include "absl/container/flat_hash_map.h"
 #include "tensorflow/core/framework/cancellation.h"
 #include "tensorflow/core/framework/metrics.h"
@@ -63,6 +65,68 @@ enum class TraversalOrder {
   REVERSE_BFS = 1,
 };
 
+// A counter that can be updated concurrently by many threads without them
+// contending on a single cache line.
+//
+// Updates go to one of `kNumShards` cache-line padded shards, picked per
+// thread, so threads running the same node (e.g. the threads of a parallel
+// map) mostly update different cache lines. Reading the counter sums the
+// shards, which is more expensive than an update and is meant for the
+// infrequent readers, such as the optimization loop.
+//
+// The interface mirrors `std::atomic<int64_t>` for the operations nodes use.
+class ShardedCounter {
+ public:
+  explicit ShardedCounter(int64_t value = 0) { store(value); }
+
+  ShardedCounter(const ShardedCounter&) = delete;
+  ShardedCounter& operator=(const ShardedCounter&) = delete;
+
+  // Adds `delta` to the counter.
+  void operator+=(int64_t delta) {
+    shards_[ShardIndex()].value.fetch_add(delta, std::memory_order_relaxed);
+  }
+
+  void operator++(int) { *this += 1; }
+
+  // Returns the sum of all shards.
+  int64_t load() const {
+    int64_t sum = 0;
+    for (const Shard& shard : shards_) {
+      sum += shard.value.load(std::memory_order_relaxed);
+    }
+    return sum;
+  }
+
+  operator int64_t() const { return load(); }  // NOLINT
+
+  // Sets the counter to `value`. Must not race with updates.
+  void store(int64_t value) {
+    shards_[0].value.store(value, std::memory_order_relaxed);
+    for (int i = 1; i < kNumShards; ++i) {
+      shards_[i].value.store(0, std::memory_order_relaxed);
+    }
+  }
+
+ private:
+  static constexpr int kNumShards = 16;
+
+  struct alignas(ABSL_CACHELINE_SIZE) Shard {
+    std::atomic<int64_t> value{0};
+  };
+
+  // Returns the shard of the calling thread. Threads are assigned shards
+  // round-robin the first time they update any counter.
+  static int ShardIndex() {
+    static std::atomic<int> next_shard{0};
+    thread_local const int shard =
+        next_shard.fetch_add(1, std::memory_order_relaxed) % kNumShards;
+    return shard;
+  }
+
+  Shard shards_[kNumShards];
+};
+
 // Represents thread-safe state that can be shared between an input pipeline and
 // the performance model.
 struct SharedState {
@@ -272,6 +336,17 @@ class Node {
     return parameters_.at(name)->state->value;
   }
 
+  // Returns the current values of the tunable parameters of this node, keyed
+  // by parameter name.
+  absl::flat_hash_map<string, double> TunableParameterValues() const
+      TF_LOCKS_EXCLUDED(mu_);
+
+  // Sets the current value of the tunable parameter `name`, clamped to the
+  // range of the parameter. Returns false if the node has no tunable parameter
+  // with that name.
+  bool SetTunableParameterValue(const string& name, double value)
+      TF_LOCKS_EXCLUDED(mu_);
+
   // Returns the aggregate processing time.
   int64_t processing_time() const TF_LOCKS_EXCLUDED(mu_) {
     return processing_time_;
@@ -605,12 +680,14 @@ class Node {
   // autotuning. In particular, if this is `false`, then the subtree is excluded
   // from computation of output time and processing time.
   std::atomic<bool> autotune_;
-  std::atomic<int64_t> buffered_bytes_;
-  std::atomic<int64_t> buffered_elements_;
-  std::atomic<int64_t> bytes_consumed_;
-  std::atomic<int64_t> bytes_produced_;
-  std::atomic<int64_t> num_elements_;
-  std::atomic<int64_t> processing_time_;
+  // Counters updated for every element are sharded so that the threads of a
+  // node do not contend on them.
+  ShardedCounter buffered_bytes_;
+  ShardedCounter buffered_elements_;
+  ShardedCounter bytes_consumed_;
+  ShardedCounter bytes_produced_;
+  ShardedCounter num_elements_;
+  ShardedCounter processing_time_;
   std::atomic<bool> record_metrics_;
   Metrics metrics_;
   absl::flat_hash_map<string, std::shared_ptr<Parameter>> parameters_
@@ -671,6 +748,95 @@ std::shared_ptr<Node> MakeAsyncUnknownRatioNode(
 // as pass-through between inputs and output.
 std::shared_ptr<Node> MakeUnknownNode(Node::Args args);
 
+// Tracks memory reserved by buffers that are sized outside of the optimization
+// loop, such as legacy-autotuned prefetch buffers, against the RAM budget of an
+// input pipeline so that all such buffers draw from a single shared budget.
+//
+// This class is thread-safe.
+class RamBudgetManager {
+ public:
+  RamBudgetManager() = default;
+
+  // Sets the budget in bytes. A non-positive budget means unlimited.
+  void SetBudget(int64_t budget) TF_LOCKS_EXCLUDED(mu_) {
+    mutex_lock l(mu_);
+    budget_ = budget;
+  }
+
+  // Attempts to reserve `delta` additional bytes, returning whether the
+  // reservation fits within the budget. A non-positive `delta` releases bytes
+  // and always succeeds.
+  bool RequestBytes(int64_t delta) TF_LOCKS_EXCLUDED(mu_);
+
+  // Returns the number of bytes currently reserved.
+  int64_t reserved_bytes() const TF_LOCKS_EXCLUDED(mu_) {
+    mutex_lock l(mu_);
+    return reserved_bytes_;
+  }
+
+ private:
+  mutable mutex mu_;
+  int64_t budget_ TF_GUARDED_BY(mu_) = 0;
+  int64_t reserved_bytes_ TF_GUARDED_BY(mu_) = 0;
+};
+
+class Model;
+
+// Divides the CPU and RAM budgets between the input pipelines of a process.
+//
+// By default, every input pipeline is autotuned as if it owned the entire
+// machine, so processes that run several pipelines at once (e.g. training,
+// evaluation and side inputs) oversubscribe the CPU. Models registered with the
+// coordinator instead receive a share of the budget proportional to the
+// fraction of time their consumer spends waiting for elements, so pipelines
+// that are the bottleneck get the most resources. Every registered model keeps
+// a minimum share so that its optimization can react when its consumer starts
+// waiting.
+//
+// This class is thread-safe.
+class ModelCoordinator {
+ public:
+  // Returns the process-wide coordinator.
+  static ModelCoordinator* Global();
+
+  // Starts sharing the budget with `model`.
+  void Register(const Model* model) TF_LOCKS_EXCLUDED(mu_);
+
+  // Stops sharing the budget with `model`.
+  void Unregister(const Model* model) TF_LOCKS_EXCLUDED(mu_);
+
+  // Returns whether `model` is registered.
+  bool IsRegistered(const Model* model) const TF_LOCKS_EXCLUDED(mu_);
+
+  // Records the fraction of time, between 0 and 1, that the consumer of
+  // `model` recently spent waiting for elements. Ignored if `model` is not
+  // registered.
+  void RecordWaitFraction(const Model* model, double wait_fraction)
+      TF_LOCKS_EXCLUDED(mu_);
+
+  // Returns the share of `cpu_budget` that `model` should use. Models that are
+  // not registered get the entire budget. Registered models get at least one
+  // CPU.
+  int64_t CpuBudget(const Model* model, int64_t cpu_budget) const
+      TF_LOCKS_EXCLUDED(mu_);
+
+  // Returns the share of `ram_budget` that `model` should use. Models that are
+  // not registered get the entire budget.
+  int64_t RamBudget(const Model* model, int64_t ram_budget) const
+      TF_LOCKS_EXCLUDED(mu_);
+
+ private:
+  // Weight every registered model has on top of its wait fraction.
+  static constexpr double kMinWeight = 0.05;
+
+  // Returns the fraction of the budget that `model` should use.
+  double Share(const Model* model) const TF_LOCKS_EXCLUDED(mu_);
+
+  mutable mutex mu_;
+  // Latest wait fraction of each registered model.
+  absl::flat_hash_map<const Model*, double> wait_fractions_ TF_GUARDED_BY(mu_);
+};
+
 // Abstract representation of a TensorFlow input pipeline that can be used
 // for collecting runtime information and optimizing performance. It collects
 // runtime information about execution of the input pipeline that is used to
@@ -708,7 +874,8 @@ class Model {
   std::string DebugString();
 
   // Uses the given algorithm and resource budgets to periodically perform the
-  // autotuning optimization.
+  // autotuning optimization. If the model is registered with the global
+  // `ModelCoordinator`, only its share of the budgets is used.
   //
   // To terminate the execution of the optimization loop, the caller needs to
   // invoke `cancellation_mgr->StartCancel()`.
@@ -748,6 +915,29 @@ class Model {
   static Status Load(const string& fname, std::unique_ptr<Model>* model,
                      OptimizationParams* optimization_params);
 
+  // Saves the current values of the tunable parameters to a file with the
+  // given name.
+  Status SaveTunableParameters(const string& fname) TF_LOCKS_EXCLUDED(mu_);
+
+  // Sets the tunable parameters of the existing nodes to the values saved by
+  // `SaveTunableParameters` in a file with the given name. Parameters that are
+  // not present in the file keep their values.
+  Status RestoreTunableParameters(const string& fname) TF_LOCKS_EXCLUDED(mu_);
+
+  // If not empty, the optimization loop saves the tunable parameter values to
+  // `fname` after every optimization.
+  void set_tunable_parameters_file(const string& fname)
+      TF_LOCKS_EXCLUDED(mu_) {
+    mutex_lock l(mu_);
+    tunable_parameters_file_ = fname;
+  }
+
+  // Returns the manager of the RAM budget shared by buffers of this pipeline
+  // that are not sized by the optimization loop.
+  const std::shared_ptr<RamBudgetManager>& ram_budget_manager() const {
+    return ram_budget_manager_;
+  }
+
   // Record gap time between consecutive `GetNext()` calls.
   void RecordIteratorGapTime(uint64_t duration_usec) {
     mutex_lock l(gap_mu_);
@@ -755,6 +945,12 @@ class Model {
     ++gap_time_count_;
   }
 
+  // Record the time the consumer spent waiting in a `GetNext()` call.
+  void RecordConsumerWaitTime(uint64_t duration_usec) {
+    mutex_lock l(gap_mu_);
+    wait_time_sum_usec_ += duration_usec;
+  }
+
  private:
   // Determines whether optimization should stop given total processing time,
   // estimated output time, and estimated number of buffers bytes.
@@ -821,6 +1017,9 @@ class Model {
   // algorithm.
   double ComputeTargetTimeNsec();
 
+  // Returns the total time the consumer spent waiting in `GetNext()`.
+  uint64_t ConsumerWaitTimeUsec() const TF_LOCKS_EXCLUDED(gap_mu_);
+
   // This is the first part of the stage-based optimization that optimizes
   // tunable parallelism parameters.
   void OptimizeStageBasedParallelism(
@@ -863,6 +1062,9 @@ class Model {
   // running optimizations.
   int64_t optimization_period_ms_ TF_GUARDED_BY(mu_);
 
+  // File the optimization loop saves the tunable parameter values to.
+  string tunable_parameters_file_ TF_GUARDED_BY(mu_);
+
   // Gauge cell that can be used to collect the state of the model.
   monitoring::GaugeCell<std::function<std::string()>>* model_gauge_cell_ =
       nullptr;
@@ -879,6 +1081,10 @@ class Model {
   // Gap time between consecutive `GetNext()` for a model.
   uint64_t gap_time_sum_usec_ TF_GUARDED_BY(gap_mu_) = 0;
   uint64_t gap_time_count_ TF_GUARDED_BY(gap_mu_) = 0;
+  // Total time the consumer spent waiting in `GetNext()`.
+  uint64_t wait_time_sum_usec_ TF_GUARDED_BY(gap_mu_) = 0;
+  const std::shared_ptr<RamBudgetManager> ram_budget_manager_ =
+      std::make_shared<RamBudgetManager>();
 };
 
 // Class to compute timing information for a model.
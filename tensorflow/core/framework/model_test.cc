@@ -18,11 +18,13 @@ limitations under the License.
 #include <memory>
 #include <string>
 #include <utility>
+#include <vector>
 
 #include "tensorflow/core/framework/cancellation.h"
 #include "tensorflow/core/lib/core/status_test_util.h"
 #include "tensorflow/core/lib/gtl/cleanup.h"
 #include "tensorflow/core/lib/monitoring/cell_reader.h"
+#include "tensorflow/core/platform/env.h"
 #include "tensorflow/core/platform/test.h"
 
 namespace tensorflow {
@@ -1157,6 +1159,63 @@ TEST(SaveModelTest, Model) {
   EXPECT_TRUE(restored_current->inputs().empty());
 }
 
+// Builds a model with a single parallel node whose parallelism is `value`.
+std::shared_ptr<SharedState> AddParallelNode(model::Model& model,
+                                             double value) {
+  auto state = std::make_shared<SharedState>(
+      /*value=*/model::kAutotune, std::make_shared<mutex>(),
+      std::make_shared<condition_variable>());
+  state->value = value;
+  std::shared_ptr<Node> node;
+  model.AddNode(
+      [&state](model::Node::Args args) {
+        return model::MakeAsyncKnownRatioNode(
+            std::move(args), 1,
+            {model::MakeParameter("parallelism", state, /*min=*/1,
+                                  /*max=*/16)});
+      },
+      "ParallelMap", nullptr, &node);
+  return state;
+}
+
+TEST(SaveTunableParametersTest, Model) {
+  const std::string fname = "/tmp/autotune_tunable_parameters_test";
+  model::Model model;
+  AddParallelNode(model, /*value=*/12);
+  TF_ASSERT_OK(model.SaveTunableParameters(fname));
+
+  model::Model restored_model;
+  std::shared_ptr<SharedState> state =
+      AddParallelNode(restored_model, /*value=*/1);
+  TF_ASSERT_OK(restored_model.RestoreTunableParameters(fname));
+  EXPECT_EQ(state->value, 12);
+}
+
+TEST(RestoreMissingTunableParametersTest, Model) {
+  model::Model model;
+  std::shared_ptr<SharedState> state = AddParallelNode(model, /*value=*/3);
+  EXPECT_TRUE(errors::IsNotFound(model.RestoreTunableParameters(
+      "/tmp/autotune_tunable_parameters_test_missing")));
+  EXPECT_EQ(state->value, 3);
+}
+
+TEST(SetTunableParameterValueTest, Node) {
+  auto state = std::make_shared<SharedState>(
+      /*value=*/model::kAutotune, std::make_shared<mutex>(),
+      std::make_shared<condition_variable>());
+  std::shared_ptr<Node> node = model::MakeAsyncKnownRatioNode(
+      {1, "1", nullptr}, 1,
+      {model::MakeParameter("parallelism", state, /*min=*/1, /*max=*/4),
+       model::MakeNonTunableParameter("cycle_length", 2)});
+  // Parameters without an initial value are not reported.
+  EXPECT_TRUE(node->TunableParameterValues().empty());
+  EXPECT_TRUE(node->SetTunableParameterValue("parallelism", 10));
+  EXPECT_EQ(state->value, 4);
+  EXPECT_FALSE(node->SetTunableParameterValue("cycle_length", 1));
+  EXPECT_FALSE(node->SetTunableParameterValue("unknown", 1));
+  EXPECT_EQ(node->TunableParameterValues().at("parallelism"), 4);
+}
+
 class ComputeWaitTimeTest
     : public ::testing::TestWithParam<std::tuple<double, double, double>> {};
 
@@ -1312,6 +1371,25 @@ TEST_P(OptimizeZeroRamBudgetTest, Model) {
 INSTANTIATE_TEST_SUITE_P(Test, OptimizeZeroRamBudgetTest,
                          ::testing::Values(0, 1, 2, 3));
 
+TEST(ShardedCounterTest, ConcurrentUpdates) {
+  ShardedCounter counter;
+  {
+    std::vector<std::unique_ptr<Thread>> threads;
+    for (int i = 0; i < 32; ++i) {
+      threads.emplace_back(Env::Default()->StartThread(
+          ThreadOptions(), "update_counter", [&counter]() {
+            for (int j = 0; j < 1000; ++j) {
+              counter++;
+              counter += 2;
+            }
+          }));
+    }
+  }
+  EXPECT_EQ(counter.load(), 32 * 1000 * 3);
+  counter.store(7);
+  EXPECT_EQ(counter.load(), 7);
+}
+
 TEST(RecordTimeTest, RecordTimeTest) {
   std::shared_ptr<Node> source = model::MakeSourceNode({});
   EXPECT_FALSE(source->is_recording());
@@ -1333,6 +1411,51 @@ TEST(ModelTest, ModelMetrics) {
                     HasSubstr("autotune: true")));
 }
 
+TEST(ModelCoordinatorTest, UnregisteredModelGetsEntireBudget) {
+  model::Model model;
+  ModelCoordinator coordinator;
+  EXPECT_FALSE(coordinator.IsRegistered(&model));
+  EXPECT_EQ(coordinator.CpuBudget(&model, 16), 16);
+  EXPECT_EQ(coordinator.RamBudget(&model, 1000), 1000);
+}
+
+TEST(ModelCoordinatorTest, SplitBudgetEvenlyWithoutWaitTime) {
+  model::Model model1, model2;
+  ModelCoordinator coordinator;
+  coordinator.Register(&model1);
+  coordinator.Register(&model2);
+  EXPECT_EQ(coordinator.CpuBudget(&model1, 16), 8);
+  EXPECT_EQ(coordinator.CpuBudget(&model2, 16), 8);
+  EXPECT_EQ(coordinator.RamBudget(&model1, 1000), 500);
+}
+
+TEST(ModelCoordinatorTest, WeightBudgetByWaitFraction) {
+  model::Model train, eval;
+  ModelCoordinator coordinator;
+  coordinator.Register(&train);
+  coordinator.Register(&eval);
+  coordinator.RecordWaitFraction(&train, 0.95);
+  coordinator.RecordWaitFraction(&eval, 0.0);
+  // The weights are 1.0 and 0.05.
+  EXPECT_EQ(coordinator.CpuBudget(&train, 21), 20);
+  EXPECT_EQ(coordinator.CpuBudget(&eval, 21), 1);
+  // Every registered model gets at least one CPU.
+  EXPECT_EQ(coordinator.CpuBudget(&eval, 4), 1);
+}
+
+TEST(ModelCoordinatorTest, Unregister) {
+  model::Model model1, model2;
+  ModelCoordinator coordinator;
+  coordinator.Register(&model1);
+  coordinator.Register(&model2);
+  coordinator.Unregister(&model2);
+  EXPECT_FALSE(coordinator.IsRegistered(&model2));
+  EXPECT_EQ(coordinator.CpuBudget(&model1, 16), 16);
+  // Wait fractions of unregistered models are ignored.
+  coordinator.RecordWaitFraction(&model2, 1.0);
+  EXPECT_FALSE(coordinator.IsRegistered(&model2));
+}
+
 class ModelTimingTest : public ::testing::Test {
  public:
   // Builds a Model from its text proto.
@@ -778,7 +778,22 @@ Status OpKernelContext::allocate_output(int index, const TensorShape& shape,
       op_kernel().name_view().data(), step_id(), "output", type,
       [&shape]() { return shape.DebugString(); });
   auto output_tensor = MakeUnique<Tensor>();
-  Status s = allocate_tensor(type, shape, output_tensor.get(), attr);
+  Allocator* planned_allocator = params_->output_allocator_array != nullptr
+                                     ? params_->output_allocator_array[index]
+                                     : nullptr;
+  Status s;
+  if (planned_allocator != nullptr && attr.value == 0 && attr.scope_id == 0 &&
+      !track_allocations() && !params_->log_memory) {
+    *output_tensor = Tensor(planned_allocator, type, shape);
+    if (!output_tensor->IsInitialized()) {
+      s = errors::ResourceExhausted(
+          "OOM when allocating tensor with shape", shape.DebugString(),
+          " and type ", DataTypeString(type), " on ", params_->device->name(),
+          " by allocator ", planned_allocator->Name());
+    }
+  } else {
+    s = allocate_tensor(type, shape, output_tensor.get(), attr);
+  }
   if (s.ok()) {
     outputs_[index] = TensorValue(output_tensor.release());
     *output = outputs_[index].tensor;
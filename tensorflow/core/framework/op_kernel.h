@@ -608,6 +608,12 @@ class OpKernelContext {
     // Array indexed by output number for this node
     const AllocatorAttributes* output_attr_array = nullptr;
 
+    // If not null, array indexed by output number for this node of the
+    // allocators that `allocate_output()` uses for outputs requested with
+    // default attributes, e.g. from a step memory plan. A null entry selects
+    // the device allocator.
+    Allocator* const* output_allocator_array = nullptr;
+
     // Shared resources accessible by this op kernel invocation.
     ResourceMgr* resource_manager = nullptr;
 
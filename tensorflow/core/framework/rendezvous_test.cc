@@ -331,6 +331,55 @@ TEST_F(LocalRendezvousTest, RandomSendRecv) {
   state.done.WaitForNotification();
 }
 
+TEST_F(LocalRendezvousTest, ManyPendingKeys) {
+  // More keys than the rendezvous has buckets, so that buckets hold several
+  // queues and queues are removed from the middle of a bucket.
+  static const int N = 200;
+  Rendezvous::Args args;
+  for (int i = 0; i < N; ++i) {
+    TF_ASSERT_OK(rendez_->Send(MakeKey(strings::StrCat(i)), args,
+                               V(strings::StrCat(i)), false));
+  }
+  for (int i = N - 1; i >= 0; i -= 2) {
+    Tensor val;
+    bool val_dead = false;
+    TF_ASSERT_OK(
+        rendez_->Recv(MakeKey(strings::StrCat(i)), args, &val, &val_dead));
+    EXPECT_EQ(strings::StrCat(i), V(val));
+  }
+  for (int i = 0; i < N; i += 2) {
+    Tensor val;
+    bool val_dead = false;
+    TF_ASSERT_OK(
+        rendez_->Recv(MakeKey(strings::StrCat(i)), args, &val, &val_dead));
+    EXPECT_EQ(strings::StrCat(i), V(val));
+  }
+
+  // Pending receives on many keys all see the abort.
+  BlockingState state;
+  state.counter = N;
+  for (int i = 0; i < N; ++i) {
+    rendez_->RecvAsync(
+        MakeKey(strings::StrCat("pending", i)), args,
+        [&state](const Status& status, const Rendezvous::Args& sender_args,
+                 const Rendezvous::Args& recver_args, const Tensor& val,
+                 const bool val_dead) {
+          EXPECT_TRUE(errors::IsAborted(status));
+          bool done = false;
+          {
+            mutex_lock l(state.lock);
+            state.counter--;
+            done = state.counter == 0;
+          }
+          if (done) {
+            state.done.Notify();
+          }
+        });
+  }
+  rendez_->StartAbort(errors::Aborted(""));
+  state.done.WaitForNotification();
+}
+
 void RandomSleep() {
   if (std::rand() % 10 == 0) {
     Env::Default()->SleepForMicroseconds(1000);
@@ -77,6 +77,7 @@ Status ValidateDevice(OpKernelContext* ctx, const ResourceHandle& p) {
 
 Status ResourceMgr::InsertDebugTypeName(uint64 hash_code,
                                         const string& type_name) {
+  mutex_lock l(debug_type_names_mu_);
   auto iter = debug_type_names_.emplace(hash_code, type_name);
   if (iter.first->second != type_name) {
     return errors::AlreadyExists("Duplicate hash code found for type ",
@@ -86,6 +87,7 @@ Status ResourceMgr::InsertDebugTypeName(uint64 hash_code,
 }
 
 const char* ResourceMgr::DebugTypeName(uint64 hash_code) const {
+  mutex_lock l(debug_type_names_mu_);
   auto type_name_iter = debug_type_names_.find(hash_code);
   if (type_name_iter == debug_type_names_.end()) {
     return "<unknown>";
@@ -138,19 +140,23 @@ ResourceMgr::~ResourceMgr() { Clear(); }
 void ResourceMgr::Clear() {
   // We do the deallocation outside of the lock to avoid a potential deadlock
   // in case any of the destructors access the resource manager.
-  absl::flat_hash_map<string, Container*> tmp_containers;
-  {
-    mutex_lock l(mu_);
-    tmp_containers = std::move(containers_);
-  }
-  for (const auto& p : tmp_containers) {
-    delete p.second;
+  for (Shard& shard : shards_) {
+    absl::flat_hash_map<string, Container*> tmp_containers;
+    {
+      mutex_lock l(shard.mu);
+      tmp_containers = std::move(shard.containers);
+      shard.containers.clear();
+      for (const auto& p : tmp_containers) {
+        UpdateContainerShardCount(p.first, -1);
+      }
+    }
+    for (const auto& p : tmp_containers) {
+      delete p.second;
+    }
   }
-  tmp_containers.clear();
 }
 
 string ResourceMgr::DebugString() const {
-  mutex_lock l(mu_);
   struct Line {
     const string* container;
     const string type;
@@ -158,35 +164,57 @@ string ResourceMgr::DebugString() const {
     const string detail;
   };
   std::vector<Line> lines;
-  for (const auto& p : containers_) {
-    const string& container = p.first;
-    for (const auto& q : *p.second) {
-      const Key& key = q.first;
-      const char* type = DebugTypeName(key.first);
-      const core::RefCountPtr<ResourceBase> resource = q.second.GetResource();
-      Line l{&container, port::Demangle(type), q.second.name.get(),
-             resource ? resource->DebugString() : "<nullptr>"};
-      lines.push_back(l);
-    }
-  }
   std::vector<string> text;
-  text.reserve(lines.size());
-  for (const Line& line : lines) {
-    text.push_back(strings::Printf(
-        "%-20s | %-40s | %-40s | %-s", line.container->c_str(),
-        line.type.c_str(), line.resource->c_str(), line.detail.c_str()));
+  for (const Shard& shard : shards_) {
+    mutex_lock l(shard.mu);
+    for (const auto& p : shard.containers) {
+      const string& container = p.first;
+      for (const auto& q : *p.second) {
+        const Key& key = q.first;
+        const char* type = DebugTypeName(key.first);
+        const core::RefCountPtr<ResourceBase> resource =
+            q.second.GetResource();
+        Line l{&container, port::Demangle(type), q.second.name.get(),
+               resource ? resource->DebugString() : "<nullptr>"};
+        lines.push_back(l);
+      }
+    }
+    // The lines borrow strings owned by the shard, so they are formatted
+    // before its lock is released.
+    for (const Line& line : lines) {
+      text.push_back(strings::Printf(
+          "%-20s | %-40s | %-40s | %-s", line.container->c_str(),
+          line.type.c_str(), line.resource->c_str(), line.detail.c_str()));
+    }
+    lines.clear();
   }
   std::sort(text.begin(), text.end());
   return absl::StrJoin(text, "\n");
 }
 
-Status ResourceMgr::DoCreate(const string& container_name, TypeIndex type,
-                             const string& name, ResourceBase* resource,
-                             bool owns_resource) {
-  Container* container = [&]() TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
-    Container** ptr = &containers_[container_name];
+bool ResourceMgr::ContainerExists(const string& container) const {
+  tf_shared_lock l(container_names_mu_);
+  return container_shard_counts_.contains(container);
+}
+
+void ResourceMgr::UpdateContainerShardCount(const string& container,
+                                            int delta) {
+  mutex_lock l(container_names_mu_);
+  auto iter = container_shard_counts_.emplace(container, 0).first;
+  iter->second += delta;
+  if (iter->second <= 0) {
+    container_shard_counts_.erase(iter);
+  }
+}
+
+Status ResourceMgr::DoCreate(Shard* shard, const string& container_name,
+                             TypeIndex type, const string& name,
+                             ResourceBase* resource, bool owns_resource) {
+  Container* container = [&]() TF_EXCLUSIVE_LOCKS_REQUIRED(shard->mu) {
+    Container** ptr = &shard->containers[container_name];
     if (*ptr == nullptr) {
       *ptr = new Container;
+      UpdateContainerShardCount(container_name, 1);
     }
     return *ptr;
   }();
@@ -200,8 +228,8 @@ Status ResourceMgr::DoCreate(const string& container_name, TypeIndex type,
   if (owns_resource) {
     resource_and_name.resource = core::RefCountPtr<ResourceBase>(resource);
   } else {
-    auto cleanup_fn = [this, container, type, borrowed_name]() {
-      mutex_lock l(mu_);
+    auto cleanup_fn = [shard, container, type, borrowed_name]() {
+      mutex_lock l(shard->mu);
       auto iter = container->find({type.hash_code(), borrowed_name});
       if (iter != container->end()) {
         container->erase(iter);
@@ -225,23 +253,29 @@ Status ResourceMgr::DoCreate(const string& container_name, TypeIndex type,
 
 Status ResourceMgr::Lookup(const ResourceHandle& handle,
                            ResourceBase** resource) const {
-  tf_shared_lock l(mu_);
-  return DoLookup(handle.container(), handle.hash_code(),
+  const Shard& shard = GetShard(handle.name());
+  tf_shared_lock l(shard.mu);
+  return DoLookup(shard, handle.container(), handle.hash_code(),
                   /*type_name=*/"ResourceBase", handle.name(), resource);
 }
 
-Status ResourceMgr::DoLookup(const string& container, TypeIndex type,
-                             const string& name,
+Status ResourceMgr::DoLookup(const Shard& shard, const string& container,
+                             TypeIndex type, const string& name,
                              ResourceBase** resource) const {
-  return DoLookup(container, type.hash_code(), type.name(), name, resource);
+  return DoLookup(shard, container, type.hash_code(), type.name(), name,
+                  resource);
 }
 
-Status ResourceMgr::DoLookup(const string& container, uint64 type_hash_code,
-                             const string& type_name,
+Status ResourceMgr::DoLookup(const Shard& shard, const string& container,
+                             uint64 type_hash_code, const string& type_name,
                              const string& resource_name,
                              ResourceBase** resource) const {
-  const Container* b = gtl::FindPtrOrNull(containers_, container);
+  const Container* b = gtl::FindPtrOrNull(shard.containers, container);
   if (b == nullptr) {
+    if (ContainerExists(container)) {
+      return errors::NotFound("Resource ", container, "/", resource_name, "/",
+                              type_name, " does not exist.");
+    }
     return errors::NotFound("Container ", container,
                             " does not exist. (Could not find resource: ",
                             container, "/", resource_name, ")");
@@ -265,9 +299,14 @@ Status ResourceMgr::PopResourceAndName(const string& container,
                                        const string& resource_name,
                                        const string& type_name,
                                        ResourceAndName& resource_and_name) {
-  mutex_lock l(mu_);
-  Container* b = gtl::FindPtrOrNull(containers_, container);
+  Shard& shard = GetShard(resource_name);
+  mutex_lock l(shard.mu);
+  Container* b = gtl::FindPtrOrNull(shard.containers, container);
   if (b == nullptr) {
+    if (ContainerExists(container)) {
+      return errors::NotFound("Resource ", container, "/", resource_name, "/",
+                              type_name, " does not exist.");
+    }
     return errors::NotFound("Container ", container, " does not exist.");
   }
   auto iter = b->find({type_hash_code, resource_name});
@@ -309,26 +348,26 @@ Status ResourceMgr::Delete(const ResourceHandle& handle) {
 }
 
 Status ResourceMgr::Cleanup(const string& container) {
-  {
-    tf_shared_lock l(mu_);
-    if (!gtl::FindOrNull(containers_, container)) {
-      // Nothing to cleanup.
-      return OkStatus();
-    }
+  if (!ContainerExists(container)) {
+    // Nothing to cleanup.
+    return OkStatus();
   }
-  Container* b = nullptr;
-  {
-    mutex_lock l(mu_);
-    auto iter = containers_.find(container);
-    if (iter == containers_.end()) {
-      // Nothing to cleanup, it's OK (concurrent cleanup).
-      return OkStatus();
+  for (Shard& shard : shards_) {
+    Container* b = nullptr;
+    {
+      mutex_lock l(shard.mu);
+      auto iter = shard.containers.find(container);
+      if (iter == shard.containers.end()) {
+        // Nothing to cleanup in this shard, it's OK (concurrent cleanup).
+        continue;
+      }
+      b = iter->second;
+      shard.containers.erase(iter);
+      UpdateContainerShardCount(container, -1);
     }
-    b = iter->second;
-    containers_.erase(iter);
+    CHECK(b != nullptr);
+    delete b;
   }
-  CHECK(b != nullptr);
-  delete b;
   return OkStatus();
 }
 
@@ -16,6 +16,7 @@ limitations under the License.
 #ifndef TENSORFLOW_CORE_FRAMEWORK_RESOURCE_MGR_H_
 #define TENSORFLOW_CORE_FRAMEWORK_RESOURCE_MGR_H_
 
+#include <array>
 #include <memory>
 #include <string>
 #include <typeindex>
@@ -194,9 +195,9 @@ class ResourceMgr {
   Status Lookup(const ResourceHandle& handle,
                 ResourceBase** resource) const TF_MUST_USE_RESULT;
 
-  // Similar to Lookup, but looks up multiple resources at once, with only a
-  // single lock acquisition.  If containers_and_names[i] is uninitialized
-  // then this function does not modify resources[i].
+  // Similar to Lookup, but looks up multiple resources at once.  If
+  // containers_and_names[i] is uninitialized then this function does not
+  // modify resources[i].
   template <typename T, bool use_dynamic_cast = false>
   Status LookupMany(absl::Span<std::pair<const string*, const string*> const>
                         containers_and_names,
@@ -271,31 +272,44 @@ class ResourceMgr {
   typedef absl::flat_hash_map<Key, ResourceAndName, KeyHash, KeyEqual>
       Container;
 
+  // The resources are spread over `kNumShards` shards by the hash of their
+  // name, each with its own lock, so that concurrent lookups of different
+  // resources (e.g. the variables read by one step) do not contend on a single
+  // lock. A container has an entry in every shard that holds or held one of
+  // its resources.
+  static constexpr int kNumShards = 16;
+  struct Shard {
+    mutable mutex mu;
+    absl::flat_hash_map<string, Container*> containers TF_GUARDED_BY(mu);
+  };
+
+  // Returns the shard that holds the resources named `name`.
+  Shard& GetShard(StringPiece name) const {
+    return shards_[Hash64(name.data(), name.size()) % kNumShards];
+  }
+
   const std::string default_container_;
-  mutable mutex mu_;
-  absl::flat_hash_map<string, Container*> containers_ TF_GUARDED_BY(mu_);
+  mutable std::array<Shard, kNumShards> shards_;
 
   template <typename T, bool use_dynamic_cast = false>
-  Status LookupInternal(const std::string& container, const std::string& name,
-                        T** resource) const
-      TF_SHARED_LOCKS_REQUIRED(mu_) TF_MUST_USE_RESULT;
-  Status LookupInternal(const std::string& container, uint64 type_hash_code,
-                        const std::string& name, ResourceBase** resource) const
-      TF_SHARED_LOCKS_REQUIRED(mu_) TF_MUST_USE_RESULT;
-
-  Status DoCreate(const std::string& container, TypeIndex type,
+  Status LookupInternal(const Shard& shard, const std::string& container,
+                        const std::string& name, T** resource) const
+      TF_SHARED_LOCKS_REQUIRED(shard.mu) TF_MUST_USE_RESULT;
+
+  Status DoCreate(Shard* shard, const std::string& container, TypeIndex type,
                   const std::string& name, ResourceBase* resource,
                   bool owns_resource)
-      TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) TF_MUST_USE_RESULT;
+      TF_EXCLUSIVE_LOCKS_REQUIRED(shard->mu) TF_MUST_USE_RESULT;
 
-  Status DoLookup(const std::string& container, TypeIndex type,
-                  const std::string& name, ResourceBase** resource) const
-      TF_SHARED_LOCKS_REQUIRED(mu_) TF_MUST_USE_RESULT;
-  Status DoLookup(const std::string& container, uint64 type_hash_code,
-                  const std::string& type_name,
+  Status DoLookup(const Shard& shard, const std::string& container,
+                  TypeIndex type, const std::string& name,
+                  ResourceBase** resource) const
+      TF_SHARED_LOCKS_REQUIRED(shard.mu) TF_MUST_USE_RESULT;
+  Status DoLookup(const Shard& shard, const std::string& container,
+                  uint64 type_hash_code, const std::string& type_name,
                   const std::string& resource_name,
                   ResourceBase** resource) const
-      TF_SHARED_LOCKS_REQUIRED(mu_) TF_MUST_USE_RESULT;
+      TF_SHARED_LOCKS_REQUIRED(shard.mu) TF_MUST_USE_RESULT;
 
   Status DoDelete(const std::string& container, uint64 type_hash_code,
                   const std::string& resource_name,
@@ -309,18 +323,34 @@ class ResourceMgr {
       const std::string& container, uint64 type_hash_code,
       const std::string& resource_name, const std::string& type_name,
       ResourceAndName& resource_and_name) TF_MUST_USE_RESULT;
+
+  // Returns true iff some shard has an entry for `container`. Only used to
+  // pick the error message of a failed lookup.
+  bool ContainerExists(const std::string& container) const;
+
+  // Adds `delta` to the number of shards that have an entry for `container`.
+  void UpdateContainerShardCount(const std::string& container, int delta);
+
   // Inserts the type name for 'hash_code' into the hash_code to type name map.
   Status InsertDebugTypeName(uint64 hash_code, const std::string& type_name)
-      TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) TF_MUST_USE_RESULT;
+      TF_MUST_USE_RESULT;
 
   // Returns the type name for the 'hash_code'.
   // Returns "<unknown>" if a resource with such a type was never inserted into
   // the container.
-  const char* DebugTypeName(uint64 hash_code) const
-      TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+  const char* DebugTypeName(uint64 hash_code) const;
+
+  // Maps each container name to the number of shards that have an entry for
+  // it. The lock of a shard may be held when acquiring `container_names_mu_`,
+  // but not the other way around.
+  mutable mutex container_names_mu_;
+  absl::flat_hash_map<string, int> container_shard_counts_
+      TF_GUARDED_BY(container_names_mu_);
 
   // Map from type hash_code to type name.
-  std::unordered_map<uint64, string> debug_type_names_ TF_GUARDED_BY(mu_);
+  mutable mutex debug_type_names_mu_;
+  std::unordered_map<uint64, string> debug_type_names_
+      TF_GUARDED_BY(debug_type_names_mu_);
 
   TF_DISALLOW_COPY_AND_ASSIGN(ResourceMgr);
 };
@@ -632,8 +662,9 @@ Status ResourceMgr::Create(const std::string& container,
                            const std::string& name, T* resource) {
   CheckDeriveFromResourceBase<T>();
   CHECK(resource != nullptr);
-  mutex_lock l(mu_);
-  return DoCreate(container, TypeIndex::Make<T>(), name, resource,
+  Shard& shard = GetShard(name);
+  mutex_lock l(shard.mu);
+  return DoCreate(&shard, container, TypeIndex::Make<T>(), name, resource,
                   /* owns_resource */ true);
 }
 
@@ -641,8 +672,9 @@ template <typename T>
 Status ResourceMgr::CreateUnowned(const std::string& container,
                                   const std::string& name, T* resource) {
   CheckDeriveFromResourceBase<T>();
-  mutex_lock l(mu_);
-  return DoCreate(container, TypeIndex::Make<T>(), name, resource,
+  Shard& shard = GetShard(name);
+  mutex_lock l(shard.mu);
+  return DoCreate(&shard, container, TypeIndex::Make<T>(), name, resource,
                   /* owns_resource */ false);
 }
 
@@ -650,8 +682,9 @@ template <typename T, bool use_dynamic_cast>
 Status ResourceMgr::Lookup(const std::string& container,
                            const std::string& name, T** resource) const {
   CheckDeriveFromResourceBase<T>();
-  tf_shared_lock l(mu_);
-  return LookupInternal<T, use_dynamic_cast>(container, name, resource);
+  const Shard& shard = GetShard(name);
+  tf_shared_lock l(shard.mu);
+  return LookupInternal<T, use_dynamic_cast>(shard, container, name, resource);
 }
 
 template <typename T, bool use_dynamic_cast>
@@ -660,13 +693,14 @@ Status ResourceMgr::LookupMany(
         containers_and_names,
     std::vector<std::unique_ptr<T, core::RefCountDeleter>>* resources) const {
   CheckDeriveFromResourceBase<T>();
-  tf_shared_lock l(mu_);
   resources->resize(containers_and_names.size());
   for (size_t i = 0; i < containers_and_names.size(); ++i) {
+    const string& name = *containers_and_names[i].second;
+    const Shard& shard = GetShard(name);
+    tf_shared_lock l(shard.mu);
     T* resource;
     Status s = LookupInternal<T, use_dynamic_cast>(
-        *containers_and_names[i].first, *containers_and_names[i].second,
-        &resource);
+        shard, *containers_and_names[i].first, name, &resource);
     if (s.ok()) {
       (*resources)[i].reset(resource);
     }
@@ -686,11 +720,12 @@ struct TypeCastFunctor<T, true> {
 };
 
 template <typename T, bool use_dynamic_cast>
-Status ResourceMgr::LookupInternal(const std::string& container,
+Status ResourceMgr::LookupInternal(const Shard& shard,
+                                   const std::string& container,
                                    const std::string& name,
                                    T** resource) const {
   ResourceBase* found = nullptr;
-  Status s = DoLookup(container, TypeIndex::Make<T>(), name, &found);
+  Status s = DoLookup(shard, container, TypeIndex::Make<T>(), name, &found);
   if (s.ok()) {
     // It's safe to down cast 'found' to T* since
     // typeid(T).hash_code() is part of the map key.
@@ -705,17 +740,18 @@ Status ResourceMgr::LookupOrCreate(const std::string& container,
                                    std::function<Status(T**)> creator) {
   CheckDeriveFromResourceBase<T>();
   *resource = nullptr;
+  Shard& shard = GetShard(name);
   Status s;
   {
-    tf_shared_lock l(mu_);
-    s = LookupInternal<T, use_dynamic_cast>(container, name, resource);
+    tf_shared_lock l(shard.mu);
+    s = LookupInternal<T, use_dynamic_cast>(shard, container, name, resource);
     if (s.ok()) return s;
   }
-  mutex_lock l(mu_);
-  s = LookupInternal<T, use_dynamic_cast>(container, name, resource);
+  mutex_lock l(shard.mu);
+  s = LookupInternal<T, use_dynamic_cast>(shard, container, name, resource);
   if (s.ok()) return s;
   TF_RETURN_IF_ERROR(creator(resource));
-  s = DoCreate(container, TypeIndex::Make<T>(), name, *resource,
+  s = DoCreate(&shard, container, TypeIndex::Make<T>(), name, *resource,
                /* owns_resource */ true);
   if (!s.ok()) {
     return errors::Internal("LookupOrCreate failed unexpectedly");
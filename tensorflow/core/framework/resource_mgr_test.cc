@@ -248,6 +248,50 @@ TEST(ResourceMgrTest, CreateOrLookupRaceCondition) {
   EXPECT_EQ(1, atomic_int);
 }
 
+TEST(ResourceMgrTest, ManyResourcesInOneContainer) {
+  // Enough resources that the container spans all shards of the manager.
+  constexpr int kNumResources = 256;
+  ResourceMgr rm;
+  for (int i = 0; i < kNumResources; ++i) {
+    TF_CHECK_OK(rm.Create("foo", strings::StrCat("var", i),
+                          new Resource(strings::StrCat(i))));
+  }
+  for (int i = 0; i < kNumResources; ++i) {
+    EXPECT_EQ(strings::StrCat("R/", i),
+              Find<Resource>(rm, "foo", strings::StrCat("var", i)));
+  }
+  // Missing resources of an existing container are reported as such, whatever
+  // their shard.
+  for (int i = 0; i < kNumResources; ++i) {
+    const string name = strings::StrCat("missing", i);
+    HasError(FindErr<Resource>(rm, "foo", name), error::NOT_FOUND,
+             strings::StrCat("Resource foo/", name));
+    HasError(rm.Delete<Resource>("foo", name), error::NOT_FOUND,
+             strings::StrCat("Resource foo/", name));
+  }
+
+  // Concurrent lookups of different resources.
+  {
+    thread::ThreadPool threads(Env::Default(), "concurrent_lookups", 8);
+    for (int t = 0; t < 8; ++t) {
+      threads.Schedule([&rm] {
+        for (int i = 0; i < kNumResources; ++i) {
+          Resource* r;
+          TF_CHECK_OK(rm.Lookup("foo", strings::StrCat("var", i), &r));
+          r->Unref();
+        }
+      });
+    }
+  }
+
+  TF_CHECK_OK(rm.Cleanup("foo"));
+  for (int i = 0; i < kNumResources; ++i) {
+    HasError(FindErr<Resource>(rm, "foo", strings::StrCat("var", i)),
+             error::NOT_FOUND, "Container foo");
+  }
+  EXPECT_EQ("", rm.DebugString());
+}
+
 Status ComputePolicy(const string& attr_container,
                      const string& attr_shared_name,
                      bool use_node_name_as_default, string* result) {
@@ -15,8 +15,11 @@ limitations under the License.
 
 #include "tensorflow/core/graph/graph_partition.h"
 
+#include <algorithm>
 #include <deque>
+#include <map>
 #include <queue>
+#include <tuple>
 #include <unordered_map>
 #include <unordered_set>
 #include <utility>
@@ -26,6 +29,9 @@ limitations under the License.
 #include "tensorflow/core/framework/function.h"
 #include "tensorflow/core/framework/memory_types.h"
 #include "tensorflow/core/framework/node_def_builder.h"
+#include "tensorflow/core/framework/node_def_util.h"
+#include "tensorflow/core/framework/shape_inference.h"
+#include "tensorflow/core/framework/tensor.h"
 #include "tensorflow/core/framework/tensor.pb.h"
 #include "tensorflow/core/framework/types.h"
 #include "tensorflow/core/framework/versions.pb.h"
@@ -978,6 +984,198 @@ void SetIncarnation(const PartitionOptions& opts, GraphDef* gdef) {
   }
 }
 
+namespace {
+
+// Returns, for every output of every op node in 'g', the size in bytes of the
+// tensors it produces, or -1 if that size is not known statically.
+std::vector<std::vector<int64_t>> StaticOutputBytes(
+    const Graph& g, const std::vector<Node*>& order) {
+  std::vector<std::vector<PartialTensorShape>> shapes(g.num_node_ids());
+  std::vector<std::vector<int64_t>> bytes(g.num_node_ids());
+  std::unordered_map<int, Tensor> constants;
+  for (const Node* n : order) {
+    if (!n->IsOp()) continue;
+    shapes[n->id()].resize(n->num_outputs());
+    bytes[n->id()].assign(n->num_outputs(), -1);
+    const OpRegistrationData* op_reg_data;
+    if (!g.op_registry()->LookUp(n->type_string(), &op_reg_data).ok() ||
+        op_reg_data->shape_inference_fn == nullptr) {
+      continue;
+    }
+    if (n->IsConstant()) {
+      const TensorProto* proto;
+      Tensor value;
+      if (TryGetNodeAttr(n->attrs(), "value", &proto) &&
+          value.FromProto(*proto)) {
+        constants[n->id()] = std::move(value);
+      }
+    }
+    std::vector<PartialTensorShape> input_shapes(n->num_inputs());
+    std::vector<const Tensor*> input_tensors(n->num_inputs(), nullptr);
+    for (const Edge* e : n->in_edges()) {
+      const Node* src = e->src();
+      if (e->IsControlEdge() || !src->IsOp() ||
+          e->src_output() >= static_cast<int>(shapes[src->id()].size())) {
+        continue;
+      }
+      input_shapes[e->dst_input()] = shapes[src->id()][e->src_output()];
+      auto it = constants.find(src->id());
+      if (it != constants.end()) input_tensors[e->dst_input()] = &it->second;
+    }
+    shape_inference::InferenceContext c(g.versions().producer(), n->attrs(),
+                                        op_reg_data->op_def, input_shapes,
+                                        input_tensors, {}, {});
+    if (!c.construction_status().ok() ||
+        !c.Run(op_reg_data->shape_inference_fn).ok()) {
+      continue;
+    }
+    for (int i = 0; i < n->num_outputs(); ++i) {
+      TensorShapeProto proto;
+      c.ShapeHandleToProto(c.output(i), &proto);
+      shapes[n->id()][i] = PartialTensorShape(proto);
+      const DataType dtype = n->output_type(i);
+      if (shapes[n->id()][i].IsFullyDefined() && DataTypeCanUseMemcpy(dtype)) {
+        bytes[n->id()][i] =
+            shapes[n->id()][i].num_elements() * DataTypeSize(dtype);
+      }
+    }
+  }
+  return bytes;
+}
+
+bool IsOnCpu(const Node* n) {
+  DeviceNameUtils::ParsedName parsed;
+  return DeviceNameUtils::ParseFullName(n->assigned_device_name(), &parsed) &&
+         parsed.type == DEVICE_CPU;
+}
+
+// Rewrites 'g' so that small tensors crossing from one CPU device to another
+// CPU device in a different partition are sent as a single packed buffer.
+// See PartitionOptions::coalesce_transfers_max_bytes.
+Status CoalesceSmallTransfers(const PartitionOptions& opts, Graph* g) {
+  for (const Node* n : g->op_nodes()) {
+    // Tensors produced in different frames or iterations cannot share a
+    // transfer.
+    if (n->IsControlFlow()) return OkStatus();
+  }
+
+  std::vector<Node*> order;
+  GetReversePostOrder(*g, &order);
+
+  // The cross-partition depth of a node is the largest number of partition
+  // boundaries crossed by a path reaching it. No tensor depends on the
+  // transfer of another tensor produced at the same depth, so packing them
+  // together cannot introduce a cycle.
+  std::vector<string> locs(g->num_node_ids());
+  std::vector<int> depths(g->num_node_ids(), 0);
+  for (const Node* n : order) {
+    if (!n->IsOp()) continue;
+    locs[n->id()] = opts.node_to_loc(n);
+    for (const Edge* e : n->in_edges()) {
+      if (!e->src()->IsOp()) continue;
+      const int src_id = e->src()->id();
+      depths[n->id()] =
+          std::max(depths[n->id()],
+                   depths[src_id] + (locs[src_id] != locs[n->id()] ? 1 : 0));
+    }
+  }
+
+  struct Transfer {
+    Node* src;
+    int src_output;
+    std::vector<const Edge*> edges;
+  };
+  struct TransferGroup {
+    std::vector<Transfer> transfers;
+    // Index in 'transfers' of each (src id, src output).
+    absl::flat_hash_map<std::pair<int, int>, int> index;
+  };
+  // Keyed by (src device, dst device, depth). Ordered for determinism.
+  std::map<std::tuple<string, string, int>, TransferGroup> groups;
+  const std::vector<std::vector<int64_t>> output_bytes =
+      StaticOutputBytes(*g, order);
+  for (const Node* dst : order) {
+    if (!dst->IsOp()) continue;
+    for (const Edge* e : dst->in_edges()) {
+      Node* src = e->src();
+      if (e->IsControlEdge() || !src->IsOp() ||
+          locs[src->id()] == locs[dst->id()] || !IsOnCpu(src) ||
+          !IsOnCpu(dst)) {
+        continue;
+      }
+      const DataType dtype = src->output_type(e->src_output());
+      if (IsRefType(EdgeType(e)) || IsRefType(dtype) ||
+          !DataTypeCanUseMemcpy(dtype) ||
+          (opts.should_cast && opts.should_cast(e) != dtype)) {
+        continue;
+      }
+      const int64_t bytes = output_bytes[src->id()][e->src_output()];
+      if (bytes < 0 || bytes > opts.coalesce_transfers_max_bytes) continue;
+
+      TransferGroup& group =
+          groups[std::make_tuple(src->assigned_device_name(),
+                                 dst->assigned_device_name(),
+                                 depths[src->id()])];
+      const int next_index = group.transfers.size();
+      auto inserted = group.index.emplace(
+          std::make_pair(src->id(), e->src_output()), next_index);
+      if (inserted.second) {
+        group.transfers.push_back({src, e->src_output(), {}});
+      }
+      group.transfers[inserted.first->second].edges.push_back(e);
+    }
+  }
+
+  for (auto& group : groups) {
+    std::vector<Transfer>& transfers = group.second.transfers;
+    if (transfers.size() < 2) continue;
+    std::sort(transfers.begin(), transfers.end(),
+              [](const Transfer& a, const Transfer& b) {
+                return std::make_pair(a.src->id(), a.src_output) <
+                       std::make_pair(b.src->id(), b.src_output);
+              });
+    std::vector<NodeBuilder::NodeOut> inputs;
+    DataTypeVector types;
+    for (const Transfer& t : transfers) {
+      inputs.emplace_back(t.src, t.src_output);
+      types.push_back(t.src->output_type(t.src_output));
+    }
+    Node* pack;
+    TF_RETURN_IF_ERROR(NodeBuilder(opts.new_name(transfers[0].src->name()),
+                                   "_PackTransfer", g->op_registry())
+                           .Input(inputs)
+                           .Finalize(g, &pack));
+    pack->set_assigned_device_name(std::get<0>(group.first));
+    Node* unpack;
+    TF_RETURN_IF_ERROR(NodeBuilder(opts.new_name(transfers[0].src->name()),
+                                   "_UnpackTransfer", g->op_registry())
+                           .Input(pack)
+                           .Attr("T", types)
+                           .Finalize(g, &unpack));
+    unpack->set_assigned_device_name(std::get<1>(group.first));
+    const Node* src = transfers[0].src;
+    const Node* dst = transfers[0].edges[0]->dst();
+    if (opts.node_to_loc(pack) != locs[src->id()] ||
+        opts.node_to_loc(unpack) != locs[dst->id()]) {
+      // 'node_to_loc' does not follow the assigned devices.
+      g->RemoveNode(unpack);
+      g->RemoveNode(pack);
+      continue;
+    }
+    for (int i = 0; i < static_cast<int>(transfers.size()); ++i) {
+      for (const Edge* e : transfers[i].edges) {
+        TF_RETURN_IF_ERROR(
+            g->UpdateEdge(unpack, i, e->dst(), e->dst_input()));
+      }
+    }
+    VLOG(1) << "Coalesced " << transfers.size() << " transfers from "
+            << std::get<0>(group.first) << " to " << std::get<1>(group.first);
+  }
+  return OkStatus();
+}
+
+}  // namespace
+
 Status Partition(const PartitionOptions& opts, Graph* g,
                  std::unordered_map<string, GraphDef>* partitions) {
   Status status;
@@ -994,6 +1192,12 @@ Status Partition(const PartitionOptions& opts, Graph* g,
     if (!status.ok()) return status;
   }
 
+  if (opts.coalesce_transfers_max_bytes > 0 && !opts.scheduling_for_recvs &&
+      !opts.need_to_record_start_times) {
+    status = CoalesceSmallTransfers(opts, g);
+    if (!status.ok()) return status;
+  }
+
   // At this point, all the graph mutations have been done. Build memory
   // and device type info for every node and edge in the graph.
   status = BuildMemoryDeviceInfo(*g, &g_info);
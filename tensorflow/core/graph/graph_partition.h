@@ -80,6 +80,18 @@ struct PartitionOptions {
   // Optional customized function to compute the "tensor_name" attr value of
   // Send/Recv ops inserted during partitioning.
   std::function<string(const Edge*)> get_tensor_name_attr = nullptr;
+
+  // If positive, tensors flowing between the same pair of CPU devices in
+  // different partitions whose size is statically known to be at most this
+  // many bytes are packed by a _PackTransfer node on the sending device and
+  // unpacked by an _UnpackTransfer node on the receiving device, so that
+  // they cost one Send/Recv pair instead of one each. Only tensors that
+  // become ready at the same cross-partition "depth" are packed together,
+  // which keeps the packed transfers free of new cyclic dependencies.
+  //
+  // Graphs with control flow, or partitioned with 'scheduling_for_recvs' or
+  // 'need_to_record_start_times', are left unchanged.
+  int64_t coalesce_transfers_max_bytes = 0;
 };
 
 // Partition "input" graph into a set of graphs, one per location.
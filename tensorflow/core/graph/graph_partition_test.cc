@@ -75,7 +75,8 @@ string DeviceName(const Node* node) {
 }
 
 void Partition(const GraphDef& graph_def,
-               std::unordered_map<string, GraphDef>* partitions) {
+               std::unordered_map<string, GraphDef>* partitions,
+               int64_t coalesce_transfers_max_bytes = 0) {
   Graph g(OpRegistry::Global());
   GraphConstructorOptions opts;
   TF_CHECK_OK(ConvertGraphDefToGraph(opts, graph_def, &g));
@@ -95,6 +96,7 @@ void Partition(const GraphDef& graph_def,
   popts.get_incarnation = [](const string& name) {
     return (name[0] - 'A') + 100;
   };
+  popts.coalesce_transfers_max_bytes = coalesce_transfers_max_bytes;
   Status s = Partition(popts, &g, partitions);
   CHECK(s.ok()) << s;
 
@@ -523,6 +525,62 @@ TEST_F(GraphPartitionTest, SetIncarnation) {
   }
 }
 
+int CountOps(const GraphDef& gdef, const string& op) {
+  int count = 0;
+  for (const NodeDef& ndef : gdef.node()) {
+    if (ndef.op() == op) ++count;
+  }
+  return count;
+}
+
+TEST_F(GraphPartitionTest, CoalesceSmallTransfers) {
+  auto a1 = Const(in_.WithOpName("A1"), {1.0f, 2.0f});
+  auto a2 = Const(in_.WithOpName("A2"), {3.0f, 4.0f});
+  // Larger than the coalescing threshold below.
+  auto a3 = Const(in_.WithOpName("A3"), 0.0f, {64});
+  auto b1 = Combine(in_.WithOpName("B1"), a1, a2);
+  Combine(in_.WithOpName("B2"), b1, a3);
+  Combine(in_.WithOpName("B3"), a1, a1);
+
+  Partition(ToGraphDef(), &partitions_, /*coalesce_transfers_max_bytes=*/16);
+  EXPECT_EQ(2, partitions_.size());
+  const GraphDef& a = partitions_["/job:a/replica:0/task:0/cpu:0"];
+  const GraphDef& b = partitions_["/job:a/replica:0/task:0/cpu:1"];
+  EXPECT_EQ(1, CountOps(a, "_PackTransfer"));
+  EXPECT_EQ(2, CountOps(a, "_Send"));
+  EXPECT_EQ(1, CountOps(b, "_UnpackTransfer"));
+  EXPECT_EQ(2, CountOps(b, "_Recv"));
+  string unpack;
+  for (const NodeDef& ndef : b.node()) {
+    if (ndef.op() == "_UnpackTransfer") unpack = ndef.name();
+  }
+  for (const NodeDef& ndef : b.node()) {
+    if (ndef.name() == "B1") {
+      EXPECT_EQ(std::vector<string>({unpack, strings::StrCat(unpack, ":1")}),
+                std::vector<string>(ndef.input().begin(), ndef.input().end()));
+    } else if (ndef.name() == "B3") {
+      EXPECT_EQ(std::vector<string>({unpack, unpack}),
+                std::vector<string>(ndef.input().begin(), ndef.input().end()));
+    }
+  }
+}
+
+TEST_F(GraphPartitionTest, CoalesceSmallTransfers_DependentTensors) {
+  // A2 depends on the transfer of A1, so they cannot share a transfer.
+  auto a1 = Const(in_.WithOpName("A1"), {1.0f, 2.0f});
+  auto b1 = Identity(in_.WithOpName("B1"), a1);
+  auto a2 = Identity(in_.WithOpName("A2"), b1);
+  Combine(in_.WithOpName("B2"), a1, a2);
+
+  Partition(ToGraphDef(), &partitions_, /*coalesce_transfers_max_bytes=*/16);
+  EXPECT_EQ(2, partitions_.size());
+  for (const auto& kv : partitions_) {
+    EXPECT_EQ(0, CountOps(kv.second, "_PackTransfer"));
+    EXPECT_EQ(0, CountOps(kv.second, "_UnpackTransfer"));
+  }
+  EXPECT_EQ(2, CountOps(partitions_["/job:a/replica:0/task:0/cpu:1"], "_Recv"));
+}
+
 TEST(TopologicalSortNodesWithTimePriorityTest, NoDependencies) {
   // Create placeholders, shuffle them so the order in the graph is not strictly
   // increasing.
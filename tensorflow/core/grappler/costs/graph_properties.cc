@@ -36,7 +36,9 @@ limitations under the License.
 #include "tensorflow/core/grappler/utils/topological_sort.h"
 #include "tensorflow/core/lib/gtl/cleanup.h"
 #include "tensorflow/core/lib/gtl/flatset.h"
+#include "tensorflow/core/lib/strings/proto_serialization.h"
 #include "tensorflow/core/lib/strings/str_util.h"
+#include "tensorflow/core/platform/fingerprint.h"
 
 namespace tensorflow {
 namespace grappler {
@@ -488,8 +490,60 @@ uint64 NumElementsFromTensorProto(const TensorProto& tensor_proto) {
   return num_elements;
 }
 
+// Returns the key of the properties inferred for `item` with the given options
+// in a GraphPropertiesCache.
+uint64 GraphPropertiesCacheKey(const GrapplerItem& item,
+                               bool assume_valid_feeds,
+                               bool aggressive_shape_inference,
+                               bool include_input_tensor_values,
+                               bool include_output_tensor_values) {
+  // Add up the hashes of the nodes, so that the key doesn't depend on the order
+  // of the nodes in the graph, which doesn't change their properties.
+  uint64 nodes_key = 0;
+  for (const NodeDef& node : item.graph.node()) {
+    nodes_key += DeterministicProtoHash64(node);
+  }
+  uint64 key = FingerprintCat64(nodes_key,
+                                DeterministicProtoHash64(item.graph.library()));
+  key = FingerprintCat64(key, DeterministicProtoHash64(item.graph.versions()));
+  for (const auto& feed : item.feed) {
+    key = FingerprintCat64(key, Fingerprint64(feed.first));
+  }
+  const uint64 options = (assume_valid_feeds ? 1 : 0) |
+                         (aggressive_shape_inference ? 2 : 0) |
+                         (include_input_tensor_values ? 4 : 0) |
+                         (include_output_tensor_values ? 8 : 0);
+  return FingerprintCat64(key, options);
+}
+
 }  // namespace
 
+std::shared_ptr<const GraphPropertiesCache::Entry> GraphPropertiesCache::Lookup(
+    uint64 key) {
+  mutex_lock l(mu_);
+  for (auto it = entries_.begin(); it != entries_.end(); ++it) {
+    if (it->first == key) {
+      entries_.splice(entries_.begin(), entries_, it);
+      ++num_hits_;
+      return entries_.front().second;
+    }
+  }
+  return nullptr;
+}
+
+void GraphPropertiesCache::Insert(uint64 key,
+                                  std::shared_ptr<const Entry> entry) {
+  mutex_lock l(mu_);
+  entries_.remove_if(
+      [key](const std::pair<uint64, std::shared_ptr<const Entry>>& e) {
+        return e.first == key;
+      });
+  entries_.emplace_front(key, std::move(entry));
+  while (entries_.size() > static_cast<size_t>(capacity_)) {
+    entries_.pop_back();
+  }
+}
+
 // Note that tensor_as_shape input should not include kUnknownDimFromConst.
 // This function check kUnknownDimFromConst, but will log WARNING.
 // If checking input_tensors_as_shape_to_propgate or output_tensors_as_shape,
@@ -2516,6 +2570,23 @@ Status GraphProperties::InferStatically(bool assume_valid_feeds,
                                         bool aggressive_shape_inference,
                                         bool include_input_tensor_values,
                                         bool include_output_tensor_values) {
+  GraphPropertiesCache* cache = item_.graph_properties_cache.get();
+  uint64 cache_key = 0;
+  if (cache != nullptr) {
+    cache_key = GraphPropertiesCacheKey(
+        item_, assume_valid_feeds, aggressive_shape_inference,
+        include_input_tensor_values, include_output_tensor_values);
+    std::shared_ptr<const GraphPropertiesCache::Entry> entry =
+        cache->Lookup(cache_key);
+    if (entry != nullptr) {
+      VLOG(2) << "Reusing the inferred shapes of " << item_.id;
+      input_properties_ = entry->input_properties;
+      output_properties_ = entry->output_properties;
+      incompatible_shape_nodes_ = entry->incompatible_shape_nodes;
+      return OkStatus();
+    }
+  }
+
   FunctionLibraryDefinition function_library(OpRegistry::Global(),
                                              item_.graph.library());
   absl::flat_hash_map<string, absl::flat_hash_set<int>> fed_ports;
@@ -2754,6 +2825,14 @@ Status GraphProperties::InferStatically(bool assume_valid_feeds,
   TF_RETURN_IF_ERROR(VerboseShapeInferenceLogging(item_.graph, refiner.get(),
                                                   shape_manager.get()));
 
+  if (cache != nullptr) {
+    auto entry = std::make_shared<GraphPropertiesCache::Entry>();
+    entry->input_properties = input_properties_;
+    entry->output_properties = output_properties_;
+    entry->incompatible_shape_nodes = incompatible_shape_nodes_;
+    cache->Insert(cache_key, std::move(entry));
+  }
+
   return OkStatus();
 }
 
@@ -16,8 +16,11 @@ limitations under the License.
 #ifndef TENSORFLOW_CORE_GRAPPLER_COSTS_GRAPH_PROPERTIES_H_
 #define TENSORFLOW_CORE_GRAPPLER_COSTS_GRAPH_PROPERTIES_H_
 
+#include <list>
+#include <memory>
 #include <unordered_map>
 #include <unordered_set>
+#include <utility>
 #include <vector>
 
 #include "absl/container/flat_hash_map.h"
@@ -25,6 +28,8 @@ limitations under the License.
 #include "tensorflow/core/grappler/clusters/cluster.h"
 #include "tensorflow/core/grappler/costs/op_performance_data.pb.h"
 #include "tensorflow/core/grappler/grappler_item.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/thread_annotations.h"
 
 namespace tensorflow {
 
@@ -72,6 +77,48 @@ ABSL_CONST_INIT const char kOutputShapes[] = "_output_shape_vector";
 class SymbolicShapeRefiner;
 class TopoQueue;
 
+// Keeps the results of the most recent GraphProperties::InferStatically calls
+// made for items sharing this cache (see GrapplerItem::graph_properties_cache).
+// Optimizers that run one after the other and don't change the graph, or only
+// reorder its nodes, reuse the shapes inferred by the previous optimizer
+// instead of running shape inference over the whole graph again.
+//
+// Results are keyed by the nodes of the graph regardless of their order, the
+// function library, the graph versions, the feeds and the inference options.
+class GraphPropertiesCache {
+ public:
+  explicit GraphPropertiesCache(int capacity = 2) : capacity_(capacity) {}
+
+  int64_t num_hits() const {
+    mutex_lock l(mu_);
+    return num_hits_;
+  }
+
+ private:
+  friend class GraphProperties;
+
+  struct Entry {
+    absl::flat_hash_map<string, std::vector<OpInfo::TensorProperties>>
+        input_properties;
+    absl::flat_hash_map<string, std::vector<OpInfo::TensorProperties>>
+        output_properties;
+    std::unordered_set<string> incompatible_shape_nodes;
+  };
+
+  // Returns the entry for `key`, or nullptr if there is none.
+  std::shared_ptr<const Entry> Lookup(uint64 key);
+  // Adds `entry` for `key`, evicting the least recently used entry if the cache
+  // is full.
+  void Insert(uint64 key, std::shared_ptr<const Entry> entry);
+
+  const int capacity_;
+  mutable mutex mu_;
+  // Most recently used entries first.
+  std::list<std::pair<uint64, std::shared_ptr<const Entry>>> entries_
+      TF_GUARDED_BY(mu_);
+  int64_t num_hits_ TF_GUARDED_BY(mu_) = 0;
+};
+
 // Infer OpInfo::TensorProperties for graph nodes inputs/outputs.
 //
 // Typical use case, is to infer tensor properties from a graph, before doing
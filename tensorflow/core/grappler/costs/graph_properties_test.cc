@@ -15,6 +15,9 @@ limitations under the License.
 
 #include "tensorflow/core/grappler/costs/graph_properties.h"
 
+#include <algorithm>
+#include <memory>
+
 #include "tensorflow/cc/framework/scope.h"
 #include "tensorflow/cc/ops/functional_ops.h"
 #include "tensorflow/cc/ops/standard_ops.h"
@@ -233,6 +236,46 @@ TEST_F(GraphPropertiesTest, Clear) {
   EXPECT_FALSE(properties.has_properties());
 }
 
+TEST_F(GraphPropertiesTest, ReusesCachedProperties) {
+  TrivialTestGraphInputYielder fake_input(4, 1, 10, false,
+                                          cluster_->GetDeviceNames());
+  GrapplerItem item;
+  CHECK(fake_input.NextItem(&item));
+  item.graph_properties_cache = std::make_shared<GraphPropertiesCache>();
+
+  GraphProperties properties(item);
+  TF_ASSERT_OK(properties.InferStatically(true));
+  EXPECT_EQ(0, item.graph_properties_cache->num_hits());
+
+  // Reordering the nodes doesn't change their properties.
+  GrapplerItem reordered_item = item;
+  std::reverse(reordered_item.graph.mutable_node()->begin(),
+               reordered_item.graph.mutable_node()->end());
+  GraphProperties reordered_properties(reordered_item);
+  TF_ASSERT_OK(reordered_properties.InferStatically(true));
+  EXPECT_EQ(1, item.graph_properties_cache->num_hits());
+  for (const auto& node : item.graph.node()) {
+    const auto& props = properties.GetOutputProperties(node.name());
+    const auto& cached_props =
+        reordered_properties.GetOutputProperties(node.name());
+    ASSERT_EQ(props.size(), cached_props.size());
+    for (int i = 0; i < props.size(); ++i) {
+      EXPECT_EQ(props[i].DebugString(), cached_props[i].DebugString());
+    }
+  }
+
+  // Neither other options nor a modified graph can use the cached properties.
+  GraphProperties other_options_properties(item);
+  TF_ASSERT_OK(other_options_properties.InferStatically(false));
+  EXPECT_EQ(1, item.graph_properties_cache->num_hits());
+
+  GrapplerItem modified_item = item;
+  modified_item.graph.mutable_node(0)->set_device("/cpu:1");
+  GraphProperties modified_properties(modified_item);
+  TF_ASSERT_OK(modified_properties.InferStatically(true));
+  EXPECT_EQ(1, item.graph_properties_cache->num_hits());
+}
+
 TEST_F(GraphPropertiesTest, DynamicProperties) {
   TrivialTestGraphInputYielder fake_input(4, 1, 10, false,
                                           cluster_->GetDeviceNames());
@@ -85,6 +85,13 @@ std::pair<int, int> GetDeviceGPUArch(
 }
 #endif
 
+// Whether the CPU has instructions for bfloat16 conversions and dot products
+// (AVX512_BF16 or AMX).
+bool HasFastBF16Support() {
+  return port::TestCPUFeature(port::CPUFeature::AVX512_BF16) ||
+         port::TestCPUFeature(port::CPUFeature::AMX_BF16);
+}
+
 // Returns true if FP16Support is valid
 // For CUDA, We compare the GPUArch with the kMinGPUArch, if GPUArch is >= min,
 // return true. For AMD the corresponding gfx arch string for the detected AMD
@@ -1016,6 +1023,8 @@ class AutoMixedPrecisionImpl {
         return std::make_unique<AutoMixedPrecisionListsCuda>(
             /*cuda_version=*/10000,   // Hardcode cuda and cudnn version so
             /*cudnn_version=*/8000);  // CPU emulates the same ops on GPU.
+      case AutoMixedPrecisionMode::CPU_BF16:
+        return std::make_unique<AutoMixedPrecisionListsCpuBf16>();
     }
   }
   Status PrintDebugLogs(bool preop, size_t timestamp);
@@ -1318,12 +1327,13 @@ Status AutoMixedPrecisionImpl::Optimize() {
       "TF_AUTO_MIXED_PRECISION_GRAPH_REWRITE_LEVEL", "", &optimization_level));
   optimization_level = absl::AsciiStrToUpper(optimization_level);
   force_all_fp16_ = optimization_level == "UNSAFE_FORCE_ALL";
-  if (force_all_fp16_ && mode_ == AutoMixedPrecisionMode::MKL) {
+  if (force_all_fp16_ && (mode_ == AutoMixedPrecisionMode::MKL ||
+                          mode_ == AutoMixedPrecisionMode::CPU_BF16)) {
     // Many ops do not support bfloat16 on the CPU so we disallowing forcing to
     // bfloat16.
     return errors::InvalidArgument(
         "TF_AUTO_MIXED_PRECISION_GRAPH_REWRITE_LEVEL cannot be set to "
-        "UNSAFE_FORCE_ALL when MKL is used");
+        "UNSAFE_FORCE_ALL when converting to bfloat16 on CPU");
   }
 
   treat_infer_as_deny_ = optimization_level == "TREAT_INFER_AS_DENY";
@@ -1360,6 +1370,7 @@ Status AutoMixedPrecisionImpl::Optimize() {
         break;
       case AutoMixedPrecisionMode::MKL:
       case AutoMixedPrecisionMode::CPU:
+      case AutoMixedPrecisionMode::CPU_BF16:
         should_process = !MustPreserve(node) && IsOnDevice(node, DEVICE_CPU);
         break;
     }
@@ -1787,8 +1798,9 @@ void AutoMixedPrecisionImpl::PropagateAllowThroughClear(
 void AutoMixedPrecisionImpl::AddInferToAllowIfFollowAllow(
     const absl::flat_hash_set<int>& deny_set,
     absl::flat_hash_set<int>* allow_set) const {
-  // Currently only target for MKL
-  if (mode_ != AutoMixedPrecisionMode::MKL) {
+  // Currently only target for bfloat16 on CPU.
+  if (mode_ != AutoMixedPrecisionMode::MKL &&
+      mode_ != AutoMixedPrecisionMode::CPU_BF16) {
     return;
   }
   for (int item_idx = 0; item_idx < graph_type_view_.num_nodes(); ++item_idx) {
@@ -2232,6 +2244,14 @@ Status AutoMixedPrecision::Optimize(Cluster* cluster, const GrapplerItem& item,
                  << " graph optimizer";
     return OkStatus();
   }
+  if (mode_ == AutoMixedPrecisionMode::CPU_BF16 &&
+      !ShouldIgnorePerformance() && !HasFastBF16Support()) {
+    // Without bfloat16 instructions, the conversions in the bfloat16 kernels
+    // cost more than the memory bandwidth they save.
+    LOG(WARNING) << "No CPU support for bfloat16 detected, skipping " << name()
+                 << " graph optimizer";
+    return OkStatus();
+  }
 
   // Optimize the output graph in-place.
   AutoMixedPrecisionImpl optimizer(cluster, item.NodesToPreserve(), output,
@@ -549,6 +549,30 @@ class AutoMixedPrecisionListsMkl : public AutoMixedPrecisionLists {
   }
 };
 
+// Lists for bfloat16 with the default CPU kernels. The infer, deny and clear
+// lists are shared with MKL; ops without a bfloat16 CPU kernel in the build are
+// left in float32 by the optimizer.
+class AutoMixedPrecisionListsCpuBf16 : public AutoMixedPrecisionListsMkl {
+ public:
+  AutoMixedPrecisionListsCpuBf16() {}
+
+  // Only ops which have bfloat16 CPU kernels outside of MKL should be added to
+  // the allow list.
+  gtl::FlatSet<string> AllowList() override {
+    auto list = gtl::FlatSet<string>{"Conv2D",
+                                     "Conv2DBackpropFilter",
+                                     "Conv2DBackpropInput",
+                                     "DepthwiseConv2dNative",
+                                     "DepthwiseConv2dNativeBackpropFilter",
+                                     "DepthwiseConv2dNativeBackpropInput",
+                                     "MatMul",
+                                     "BatchMatMul",
+                                     "BatchMatMulV2"};
+    UpdateList("ALLOWLIST", &list);
+    return list;
+  }
+};
+
 }  // end namespace grappler
 }  // end namespace tensorflow
 
@@ -1349,6 +1349,60 @@ TEST_F(AutoMixedPrecisionCpuTest, MixedFanout) {
 
 #endif  // GOOGLE_CUDA || TENSORFLOW_USE_ROCM
 
+#if !INTEL_MKL
+
+class AutoMixedPrecisionCpuBf16Test : public GrapplerTest {
+ protected:
+  void SetUp() override {
+    virtual_cluster_.reset(new SingleMachine(/* timeout_s = */ 10, 1, 0));
+    TF_CHECK_OK(virtual_cluster_->Provision());
+  }
+  void TearDown() override { TF_CHECK_OK(virtual_cluster_->Shutdown()); }
+
+  std::unique_ptr<Cluster> virtual_cluster_;
+};
+
+TEST_F(AutoMixedPrecisionCpuBf16Test, Simple) {
+  tensorflow::Scope s = tensorflow::Scope::NewRootScope().WithDevice(
+      "/job:localhost/replica:0/task:0/device:CPU:0");
+  Output input = ops::Const(s.WithOpName("input"), 1.f / 32, {32, 32});
+  Output deny1 = ops::Exp(s.WithOpName("deny1"), input);
+  Output allow1 = ops::MatMul(s.WithOpName("allow1"), deny1, deny1);
+  Output clr1 = ops::Relu(s.WithOpName("clr1"), allow1);
+  Output fetch = ops::Identity(s.WithOpName("fetch"), clr1);
+
+  GrapplerItem item;
+  item.fetch = {"fetch"};
+  TF_CHECK_OK(s.ToGraphDef(&item.graph));
+  auto tensors_expected = EvaluateNodes(item.graph, item.fetch);
+
+  AutoMixedPrecision optimizer{AutoMixedPrecisionMode::CPU_BF16};
+  GraphDef output;
+  TF_ASSERT_OK(optimizer.Optimize(virtual_cluster_.get(), item, &output));
+  VLOG(1) << output.DebugString();
+
+  GraphView output_view(&output);
+  EXPECT_EQ(output_view.GetNode("deny1")->attr().at("T").type(), DT_FLOAT);
+  if (!port::TestCPUFeature(port::CPUFeature::AVX512_BF16) &&
+      !port::TestCPUFeature(port::CPUFeature::AMX_BF16)) {
+    // The graph is not rewritten on CPUs without bfloat16 instructions.
+    EXPECT_EQ(output.node_size(), item.graph.node_size());
+    return;
+  }
+  EXPECT_EQ(output_view.GetNode("allow1")->attr().at("T").type(), DT_BFLOAT16);
+  EXPECT_EQ(output_view.GetNode("clr1")->attr().at("T").type(), DT_BFLOAT16);
+  EXPECT_EQ(output_view.GetNode("fetch")->attr().at("T").type(), DT_FLOAT);
+
+  auto tensors = EvaluateNodes(output, item.fetch);
+  EXPECT_EQ(tensors.size(), tensors_expected.size());
+  EXPECT_EQ(tensors.size(), item.fetch.size());
+  for (int i = 0; i < item.fetch.size(); ++i) {
+    test::ExpectClose(tensors_expected[i], tensors[i], -1, 5e-2);
+  }
+}
+
+#endif  // !INTEL_MKL
+
 #if INTEL_MKL
 
 class AutoMixedPrecisionMklTest : public GrapplerTest {
@@ -66,6 +66,7 @@ const ConfigList& DefaultPluginConfigs() {
                       {"auto_mixed_precision", RewriterConfig::ON},
                       {"auto_mixed_precision_mkl", RewriterConfig::ON},
                       {"auto_mixed_precision_cpu", RewriterConfig::ON},
+                      {"auto_mixed_precision_cpu_bf16", RewriterConfig::ON},
                       {"pin_to_host_optimization", RewriterConfig::ON},
                       {"layout_optimizer", RewriterConfig::ON},
                       {"remapping", RewriterConfig::ON},
@@ -0,0 +1,321 @@
+/* Copyright 2022 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/grappler/optimizers/data/auto_cache.h"
+
+#include <algorithm>
+#include <array>
+#include <vector>
+
+#include "absl/algorithm/container.h"
+#include "absl/strings/numbers.h"
+#include "absl/strings/str_join.h"
+#include "tensorflow/core/data/dataset_utils.h"
+#include "tensorflow/core/framework/model.h"
+#include "tensorflow/core/framework/node_def.pb.h"
+#include "tensorflow/core/framework/tensor_shape.h"
+#include "tensorflow/core/grappler/clusters/cluster.h"
+#include "tensorflow/core/grappler/grappler_item.h"
+#include "tensorflow/core/grappler/mutable_graph_view.h"
+#include "tensorflow/core/grappler/op_types.h"
+#include "tensorflow/core/grappler/optimizers/custom_graph_optimizer_registry.h"
+#include "tensorflow/core/grappler/optimizers/data/function_utils.h"
+#include "tensorflow/core/grappler/optimizers/data/graph_utils.h"
+#include "tensorflow/core/grappler/utils.h"
+#include "tensorflow/core/platform/mem.h"
+#include "tensorflow/core/platform/path.h"
+
+namespace tensorflow {
+namespace grappler {
+namespace {
+
+constexpr char kCacheDataset[] = "CacheDataset";
+constexpr int64_t kUnknown = -1;
+
+// Sources which produce the same, finite sequence of elements in every epoch.
+constexpr std::array<const char*, 6> kFiniteSources = {
+    "FixedLengthRecordDataset", "RangeDataset",  "TensorDataset",
+    "TensorSliceDataset",       "TFRecordDataset", "TextLineDataset"};
+
+// Transformations which produce the same elements in every epoch if their
+// input does, their functions are stateless and they are deterministic.
+constexpr std::array<const char*, 14> kDeterministicTransforms = {
+    "BatchDataset",
+    "FilterDataset",
+    "FlatMapDataset",
+    "InterleaveDataset",
+    "MapAndBatchDataset",
+    "MapDataset",
+    "PaddedBatchDataset",
+    "ParallelBatchDataset",
+    "ParallelInterleaveDataset",
+    "ParallelMapDataset",
+    "PrefetchDataset",
+    "ShardDataset",
+    "SkipDataset",
+    "TakeDataset",
+};
+
+bool MatchesAny(const NodeDef& node, absl::Span<const char* const> ops) {
+  return absl::c_any_of(ops, [&node](const char* op) {
+    return data::MatchesAnyVersion(op, node.op());
+  });
+}
+
+// Returns true if `node` produces the same elements in every epoch, given
+// that its input does.
+bool IsEpochInvariant(const NodeDef& node,
+                      const FunctionLibraryDefinition& library) {
+  // The first version of ParallelInterleaveDataset takes `sloppy` as an input.
+  if (!MatchesAny(node, kDeterministicTransforms) ||
+      node.op() == "ParallelInterleaveDataset") {
+    return false;
+  }
+  if (graph_utils::HasDeterministicAttr(node.op()) &&
+      node.attr().count("deterministic") > 0 &&
+      node.attr().at("deterministic").s() == "false") {
+    return false;
+  }
+  if (graph_utils::HasSloppyAttr(node.op()) &&
+      node.attr().count("sloppy") > 0 && node.attr().at("sloppy").b()) {
+    return false;
+  }
+  for (const auto& attr : node.attr()) {
+    if (!attr.second.has_func()) continue;
+    const FunctionDef* function = library.Find(attr.second.func().name());
+    if (function == nullptr ||
+        function_utils::IsFunctionStateful(library, *function,
+                                           /*skip_assert=*/true)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+bool HasFunction(const NodeDef& node) {
+  return absl::c_any_of(node.attr(), [](const auto& attr) {
+    return attr.second.has_func();
+  });
+}
+
+// Returns the value of the `index`-th input of `node` if it is a scalar int64
+// constant, and kUnknown otherwise.
+int64_t GetConstInput(const NodeDef& node, int index,
+                      const MutableGraphView& graph) {
+  const NodeDef* input = graph_utils::GetInputNode(node, graph, index);
+  int64_t value;
+  if (input == nullptr || !IsConstant(*input) ||
+      !graph_utils::GetScalarConstNodeValue(*input, &value).ok()) {
+    return kUnknown;
+  }
+  return value;
+}
+
+// Returns an upper bound of the number of elements produced by `node`, given
+// the upper bound `input_cardinality` of the number of elements of its input,
+// or kUnknown.
+int64_t CardinalityUpperBound(const NodeDef& node, int64_t input_cardinality,
+                              const MutableGraphView& graph) {
+  if (data::MatchesAnyVersion("RangeDataset", node.op())) {
+    const int64_t start = GetConstInput(node, 0, graph);
+    const int64_t stop = GetConstInput(node, 1, graph);
+    const int64_t step = GetConstInput(node, 2, graph);
+    if (start == kUnknown || stop == kUnknown || step <= 0) return kUnknown;
+    return stop > start ? (stop - start + step - 1) / step : 0;
+  }
+  if (data::MatchesAnyVersion("TensorDataset", node.op())) return 1;
+  if (data::MatchesAnyVersion("TensorSliceDataset", node.op())) {
+    const NodeDef* component = graph_utils::GetInputNode(node, graph, 0);
+    if (component == nullptr || !IsConstant(*component)) return kUnknown;
+    const TensorShapeProto& shape =
+        component->attr().at("value").tensor().tensor_shape();
+    return shape.dim_size() > 0 ? shape.dim(0).size() : kUnknown;
+  }
+  if (input_cardinality == kUnknown) return kUnknown;
+  if (data::MatchesAnyVersion("BatchDataset", node.op()) ||
+      data::MatchesAnyVersion("PaddedBatchDataset", node.op()) ||
+      data::MatchesAnyVersion("ParallelBatchDataset", node.op()) ||
+      data::MatchesAnyVersion("ShardDataset", node.op())) {
+    // The batch size, or the number of shards.
+    const int64_t divisor = GetConstInput(node, 1, graph);
+    if (divisor <= 0) return kUnknown;
+    return (input_cardinality + divisor - 1) / divisor;
+  }
+  if (data::MatchesAnyVersion("TakeDataset", node.op())) {
+    const int64_t count = GetConstInput(node, 1, graph);
+    return count < 0 ? input_cardinality : std::min(count, input_cardinality);
+  }
+  if (data::MatchesAnyVersion("SkipDataset", node.op())) {
+    const int64_t count = GetConstInput(node, 1, graph);
+    if (count < 0) return kUnknown;
+    return std::max<int64_t>(0, input_cardinality - count);
+  }
+  if (data::MatchesAnyVersion("MapDataset", node.op()) ||
+      data::MatchesAnyVersion("ParallelMapDataset", node.op()) ||
+      data::MatchesAnyVersion("FilterDataset", node.op()) ||
+      data::MatchesAnyVersion("PrefetchDataset", node.op())) {
+    return input_cardinality;
+  }
+  return kUnknown;
+}
+
+// Returns the size in bytes of the elements produced by `node`, or kUnknown
+// if they don't have a static size.
+int64_t ElementSize(const NodeDef& node) {
+  if (node.attr().count("output_shapes") == 0 ||
+      node.attr().count("output_types") == 0) {
+    return kUnknown;
+  }
+  const auto& shapes = node.attr().at("output_shapes").list().shape();
+  const auto& types = node.attr().at("output_types").list().type();
+  if (shapes.empty() || shapes.size() != types.size()) return kUnknown;
+  int64_t size = 0;
+  for (int i = 0; i < shapes.size(); ++i) {
+    PartialTensorShape shape(shapes.Get(i));
+    const int64_t type_size =
+        DataTypeSize(static_cast<DataType>(types.Get(i)));
+    if (!shape.IsFullyDefined() || type_size == 0) return kUnknown;
+    size += shape.num_elements() * type_size;
+  }
+  return size;
+}
+
+}  // namespace
+
+Status AutoCache::Init(
+    const tensorflow::RewriterConfig_CustomGraphOptimizer* config) {
+  if (!config) return OkStatus();
+
+  const auto& parameters = config->parameter_map();
+  if (parameters.count(kCacheDir) > 0) {
+    cache_dir_ = parameters.at(kCacheDir).s();
+  }
+  if (parameters.count(kMemoryBudget) > 0) {
+    const string& memory_budget = parameters.at(kMemoryBudget).s();
+    if (!absl::SimpleAtoi(memory_budget, &memory_budget_)) {
+      return errors::InvalidArgument("Received an invalid value for parameter ",
+                                     kMemoryBudget, ": ", memory_budget);
+    }
+  }
+  return OkStatus();
+}
+
+Status AutoCache::OptimizeAndCollectStats(Cluster* cluster,
+                                          const GrapplerItem& item,
+                                          GraphDef* output,
+                                          OptimizationStats* stats) {
+  *output = item.graph;
+  MutableGraphView graph(output);
+
+  // If the GrapplerItem is derived from a FunctionDef, we don't optimize it.
+  if (graph_utils::IsItemDerivedFromFunctionDef(item, graph)) {
+    return OkStatus();
+  }
+
+  if (item.fetch.size() != 1) {
+    return errors::InvalidArgument(
+        "Expected only one fetch node but there were ", item.fetch.size(), ": ",
+        absl::StrJoin(item.fetch, ", "));
+  }
+
+  // Collect the datasets of the pipeline, from the source to the last one.
+  std::vector<NodeDef*> pipeline;
+  NodeDef* sink_node = graph.GetNode(item.fetch.at(0));
+  for (NodeDef* node = graph_utils::GetInputNode(*sink_node, graph);
+       node != nullptr; node = graph_utils::GetInputNode(*node, graph)) {
+    if (data::MatchesAnyVersion(kCacheDataset, node->op())) {
+      VLOG(1) << "The optimization auto_cache is not applied because the "
+                 "input pipeline is already cached.";
+      return OkStatus();
+    }
+    pipeline.push_back(node);
+  }
+  std::reverse(pipeline.begin(), pipeline.end());
+  if (pipeline.empty() || !MatchesAny(*pipeline[0], kFiniteSources)) {
+    return OkStatus();
+  }
+
+  // Find the deepest transformation whose output is the same in every epoch
+  // and which follows a user-defined function.
+  FunctionLibraryDefinition function_library(OpRegistry::Global(),
+                                             item.graph.library());
+  NodeDef* cache_input = nullptr;
+  int64_t cardinality = CardinalityUpperBound(*pipeline[0], kUnknown, graph);
+  int64_t cache_input_cardinality = kUnknown;
+  bool has_function = false;
+  for (size_t i = 1; i < pipeline.size(); ++i) {
+    NodeDef* node = pipeline[i];
+    if (!IsEpochInvariant(*node, function_library)) break;
+    has_function |= HasFunction(*node);
+    cardinality = CardinalityUpperBound(*node, cardinality, graph);
+    // Prefetching is better done after caching.
+    if (has_function &&
+        !data::MatchesAnyVersion("PrefetchDataset", node->op())) {
+      cache_input = node;
+      cache_input_cardinality = cardinality;
+    }
+  }
+  if (cache_input == nullptr) return OkStatus();
+
+  const int64_t element_size = ElementSize(*cache_input);
+  const int64_t memory_budget =
+      memory_budget_ >= 0
+          ? memory_budget_
+          : static_cast<int64_t>(data::model::kRamBudgetShare *
+                                 port::AvailableRam());
+  string filename;
+  if (cache_input_cardinality == kUnknown || element_size == kUnknown ||
+      (element_size > 0 &&
+       cache_input_cardinality > memory_budget / element_size)) {
+    if (cache_dir_.empty()) {
+      VLOG(1) << "The optimization auto_cache is not applied because the "
+                 "elements of "
+              << cache_input->name() << " may not fit in memory.";
+      return OkStatus();
+    }
+    filename = io::JoinPath(cache_dir_, cache_input->name());
+  }
+
+  // Insert `cache(filename)` after the transformation.
+  NodeDef cache_node;
+  graph_utils::SetUniqueGraphNodeName(
+      strings::StrCat("auto_cache/cache_", cache_input->name()), graph.graph(),
+      &cache_node);
+  cache_node.set_op(kCacheDataset);
+  // `input_dataset` input
+  *cache_node.mutable_input()->Add() = cache_input->name();
+  // `filename` input
+  NodeDef* filename_node =
+      graph_utils::AddScalarConstNode(StringPiece(filename), &graph);
+  *cache_node.mutable_input()->Add() = filename_node->name();
+
+  if (!graph_utils::CopyShapesAndTypesAttrs(*cache_input, &cache_node)) {
+    return OkStatus();
+  }
+  TF_RETURN_IF_ERROR(
+      graph_utils::SetMetadataName(cache_node.name(), &cache_node));
+
+  auto* added_node = graph.AddNode(std::move(cache_node));
+  TF_RETURN_IF_ERROR(
+      graph.UpdateFanouts(cache_input->name(), added_node->name()));
+
+  stats->num_changes++;
+  return OkStatus();
+}
+
+REGISTER_GRAPH_OPTIMIZER_AS(AutoCache, "auto_cache");
+
+}  // namespace grappler
+}  // namespace tensorflow
@@ -0,0 +1,63 @@
+/* Copyright 2022 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_CORE_GRAPPLER_OPTIMIZERS_DATA_AUTO_CACHE_H_
+#define TENSORFLOW_CORE_GRAPPLER_OPTIMIZERS_DATA_AUTO_CACHE_H_
+
+#include "tensorflow/core/grappler/optimizers/data/optimizer_base.h"
+
+namespace tensorflow {
+namespace grappler {
+
+constexpr char kCacheDir[] = "cache_dir";
+constexpr char kMemoryBudget[] = "memory_budget";
+
+// This optimization inserts `cache()` after the deepest transformation of the
+// input pipeline whose output is the same in every epoch, so that expensive
+// transformations such as decoding images only run during the first epoch.
+//
+// The prefix of the pipeline up to that transformation must read from a
+// finite source, only use deterministic transformations with stateless
+// functions, and contain at least one user-defined function. The elements are
+// cached in memory if an upper bound of the size of the cached dataset is
+// known statically and fits in `memory_budget` bytes (by default, half of the
+// available RAM), and in files under `cache_dir` otherwise. If the size is
+// unknown and no `cache_dir` is given, the pipeline is left untouched.
+class AutoCache : public TFDataOptimizerBase {
+ public:
+  AutoCache() = default;
+  ~AutoCache() override = default;
+
+  string name() const override { return "auto_cache"; };
+
+  bool UsesFunctionLibrary() const override { return false; }
+
+  Status Init(
+      const tensorflow::RewriterConfig_CustomGraphOptimizer* config) override;
+
+  Status OptimizeAndCollectStats(Cluster* cluster, const GrapplerItem& item,
+                                 GraphDef* output,
+                                 OptimizationStats* stats) override;
+
+ private:
+  string cache_dir_;
+  // A negative value means half of the available RAM.
+  int64_t memory_budget_ = -1;
+};
+
+}  // namespace grappler
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_GRAPPLER_OPTIMIZERS_DATA_AUTO_CACHE_H_
@@ -0,0 +1,155 @@
+/* Copyright 2022 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/grappler/optimizers/data/auto_cache.h"
+
+#include "tensorflow/core/framework/attr_value_util.h"
+#include "tensorflow/core/framework/function_testlib.h"
+#include "tensorflow/core/framework/tensor_testutil.h"
+#include "tensorflow/core/grappler/grappler_item.h"
+#include "tensorflow/core/grappler/optimizers/data/graph_test_utils.h"
+#include "tensorflow/core/grappler/optimizers/data/graph_utils.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace grappler {
+namespace {
+
+using test::function::NDef;
+
+NodeDef MakeInt64Const(StringPiece name, int64_t value) {
+  return NDef(name, "Const", {},
+              {{"value", test::AsScalar<int64_t>(value)}, {"dtype", DT_INT64}});
+}
+
+Status OptimizeWithAutoCache(const GrapplerItem& item, GraphDef* output,
+                             const string& memory_budget,
+                             const string& cache_dir) {
+  AutoCache optimizer;
+  RewriterConfig_CustomGraphOptimizer config;
+  if (!memory_budget.empty()) {
+    (*config.mutable_parameter_map())[kMemoryBudget].set_s(memory_budget);
+  }
+  (*config.mutable_parameter_map())[kCacheDir].set_s(cache_dir);
+  TF_RETURN_IF_ERROR(optimizer.Init(&config));
+  return optimizer.Optimize(nullptr, item, output);
+}
+
+// Creates `range(10).map(f).prefetch(1)` where `map` produces int64 scalars.
+GrapplerItem MakeItem(const string& function_name) {
+  GrapplerItem item;
+  item.graph = test::function::GDef(
+      {MakeInt64Const("start", 0),
+       MakeInt64Const("stop", 10),
+       MakeInt64Const("step", 1),
+       NDef("range", "RangeDataset", {"start", "stop", "step"}, {}),
+       NDef("map", "MapDataset", {"range"},
+            {{"f", FunctionDefHelper::FunctionRef(function_name)},
+             {"Targuments", gtl::ArraySlice<DataType>{}},
+             {"output_shapes", gtl::ArraySlice<TensorShape>{TensorShape({})}},
+             {"output_types", gtl::ArraySlice<DataType>{DT_INT64}}}),
+       MakeInt64Const("buffer_size", 1),
+       graph_tests_utils::MakePrefetchNode("prefetch", "map", "buffer_size"),
+       NDef("Sink", "Identity", {"prefetch"}, {})},
+      // FunctionLib
+      {
+          test::function::XTimesTwo(),
+          test::function::RandomUniform(),
+      });
+  item.fetch.push_back("Sink");
+  return item;
+}
+
+// Returns the file name the output of `node_name` is cached to.
+string GetCacheFilename(const string& node_name, const GraphDef& output) {
+  const int index = graph_utils::FindGraphNodeWithOp("CacheDataset", output);
+  EXPECT_NE(index, -1);
+  if (index == -1) return "";
+  const NodeDef& cache_node = output.node(index);
+  EXPECT_EQ(cache_node.input(0), node_name);
+  const NodeDef& filename_node =
+      output.node(graph_utils::FindGraphNodeWithName(cache_node.input(1),
+                                                     output));
+  return filename_node.attr().at("value").tensor().string_val(0);
+}
+
+TEST(AutoCacheTest, CachesInMemory) {
+  GrapplerItem item = MakeItem("XTimesTwo");
+  GraphDef output;
+  TF_ASSERT_OK(OptimizeWithAutoCache(item, &output, /*memory_budget=*/"80",
+                                     /*cache_dir=*/""));
+  EXPECT_EQ(GetCacheFilename("map", output), "");
+
+  // The cache is inserted before the prefetch.
+  const NodeDef& prefetch_node =
+      output.node(graph_utils::FindGraphNodeWithName("prefetch", output));
+  EXPECT_EQ(
+      output.node(graph_utils::FindGraphNodeWithName(prefetch_node.input(0),
+                                                     output))
+          .op(),
+      "CacheDataset");
+}
+
+TEST(AutoCacheTest, CachesToFilesOverMemoryBudget) {
+  GrapplerItem item = MakeItem("XTimesTwo");
+  GraphDef output;
+  TF_ASSERT_OK(OptimizeWithAutoCache(item, &output, /*memory_budget=*/"79",
+                                     /*cache_dir=*/"/cache"));
+  EXPECT_EQ(GetCacheFilename("map", output), "/cache/map");
+}
+
+TEST(AutoCacheTest, NoCacheOverMemoryBudgetWithoutCacheDir) {
+  GrapplerItem item = MakeItem("XTimesTwo");
+  GraphDef output;
+  TF_ASSERT_OK(OptimizeWithAutoCache(item, &output, /*memory_budget=*/"79",
+                                     /*cache_dir=*/""));
+  EXPECT_FALSE(graph_utils::ContainsNodeWithOp("CacheDataset", output));
+}
+
+TEST(AutoCacheTest, NoCacheWithStatefulFunction) {
+  GrapplerItem item = MakeItem("RandomUniform");
+  GraphDef output;
+  TF_ASSERT_OK(OptimizeWithAutoCache(item, &output, /*memory_budget=*/"80",
+                                     /*cache_dir=*/""));
+  EXPECT_FALSE(graph_utils::ContainsNodeWithOp("CacheDataset", output));
+}
+
+TEST(AutoCacheTest, NoCacheAfterRepeat) {
+  GrapplerItem item;
+  item.graph = test::function::GDef(
+      {MakeInt64Const("start", 0),
+       MakeInt64Const("stop", 10),
+       MakeInt64Const("step", 1),
+       NDef("range", "RangeDataset", {"start", "stop", "step"}, {}),
+       MakeInt64Const("count", -1),
+       NDef("repeat", "RepeatDataset", {"range", "count"}, {}),
+       graph_tests_utils::MakeMapNode("map", "repeat"),
+       NDef("Sink", "Identity", {"map"}, {})},
+      // FunctionLib
+      {
+          test::function::XTimesTwo(),
+      });
+  item.fetch.push_back("Sink");
+
+  GraphDef output;
+  TF_ASSERT_OK(OptimizeWithAutoCache(item, &output, /*memory_budget=*/"",
+                                     /*cache_dir=*/"/cache"));
+  EXPECT_FALSE(graph_utils::ContainsNodeWithOp("CacheDataset", output));
+}
+
+}  // namespace
+}  // namespace grappler
+}  // namespace tensorflow
@@ -0,0 +1,255 @@
+/* Copyright 2022 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/grappler/optimizers/data/map_vectorization.h"
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/container/flat_hash_set.h"
+#include "absl/strings/string_view.h"
+#include "tensorflow/core/framework/attr_value.pb.h"
+#include "tensorflow/core/framework/function.h"
+#include "tensorflow/core/framework/node_def.pb.h"
+#include "tensorflow/core/framework/tensor_shape.pb.h"
+#include "tensorflow/core/grappler/clusters/cluster.h"
+#include "tensorflow/core/grappler/grappler_item.h"
+#include "tensorflow/core/grappler/mutable_graph_view.h"
+#include "tensorflow/core/grappler/op_types.h"
+#include "tensorflow/core/grappler/optimizers/custom_graph_optimizer_registry.h"
+#include "tensorflow/core/grappler/optimizers/data/graph_utils.h"
+#include "tensorflow/core/grappler/utils.h"
+
+namespace tensorflow {
+namespace grappler {
+namespace {
+
+constexpr char kMapDataset[] = "MapDataset";
+constexpr char kParallelMapDataset[] = "ParallelMapDataset";
+constexpr char kParallelMapDatasetV2[] = "ParallelMapDatasetV2";
+constexpr char kBatchDataset[] = "BatchDataset";
+constexpr char kBatchDatasetV2[] = "BatchDatasetV2";
+constexpr char kOutputShapes[] = "output_shapes";
+constexpr char kOutputTypes[] = "output_types";
+
+bool IsMap(const NodeDef& node) {
+  return node.op() == kMapDataset || node.op() == kParallelMapDataset ||
+         node.op() == kParallelMapDatasetV2;
+}
+
+bool IsBatch(const NodeDef& node) {
+  return node.op() == kBatchDataset || node.op() == kBatchDatasetV2;
+}
+
+bool IsUnaryCwiseOp(absl::string_view op) {
+  static const auto* const kOps = new absl::flat_hash_set<absl::string_view>{
+      "Abs", "Cast", "Ceil", "Exp", "Floor", "Identity", "IsFinite", "IsInf",
+      "IsNan", "Log", "Log1p", "LogicalNot", "Neg", "Reciprocal", "Relu",
+      "Rint", "Round", "Rsqrt", "Sigmoid", "Sign", "Sqrt", "Square",
+      "StopGradient", "Tanh"};
+  return kOps->contains(op);
+}
+
+bool IsBinaryCwiseOp(absl::string_view op) {
+  static const auto* const kOps = new absl::flat_hash_set<absl::string_view>{
+      "Add", "AddV2", "Div", "DivNoNan", "Equal", "FloorDiv", "FloorMod",
+      "Greater", "GreaterEqual", "Less", "LessEqual", "LogicalAnd", "LogicalOr",
+      "Maximum", "Minimum", "Mul", "NotEqual", "Pow", "RealDiv",
+      "SquaredDifference", "Sub", "TruncateDiv"};
+  return kOps->contains(op);
+}
+
+bool IsScalarConst(const NodeDef& node) {
+  if (node.op() != "Const") return false;
+  auto it = node.attr().find("value");
+  return it != node.attr().end() &&
+         it->second.tensor().tensor_shape().dim_size() == 0;
+}
+
+// Describes a value computed by the map function: either a scalar that does
+// not depend on the input element, or a value with the same shape as the
+// function argument it was derived from.
+struct ValueInfo {
+  bool is_scalar;
+  int source_arg;
+};
+
+// Returns true if applying `func` to a batch of elements is equivalent to
+// applying it to each element and batching the results.
+bool IsElementWise(const FunctionDef& func) {
+  absl::flat_hash_map<string, ValueInfo> values;
+  for (int i = 0; i < func.signature().input_arg_size(); ++i) {
+    values[func.signature().input_arg(i).name()] = {/*is_scalar=*/false,
+                                                    /*source_arg=*/i};
+  }
+  // Returns nullptr if `input` refers to a value that has not been classified
+  // yet.
+  auto lookup = [&values](absl::string_view input) -> const ValueInfo* {
+    auto it = values.find(input.substr(0, input.find(':')));
+    return it == values.end() ? nullptr : &it->second;
+  };
+
+  // Nodes in a function body are not necessarily topologically sorted, so we
+  // classify them iteratively until no more progress can be made.
+  absl::flat_hash_set<const NodeDef*> pending;
+  for (const NodeDef& node : func.node_def()) {
+    for (const string& input : node.input()) {
+      if (IsControlInput(input)) return false;
+    }
+    if (IsScalarConst(node)) {
+      if (node.input_size() != 0) return false;
+      values[node.name()] = {/*is_scalar=*/true, /*source_arg=*/-1};
+    } else if ((IsUnaryCwiseOp(node.op()) && node.input_size() == 1) ||
+               (IsBinaryCwiseOp(node.op()) && node.input_size() == 2)) {
+      pending.insert(&node);
+    } else {
+      VLOG(2) << "Op " << node.op() << " of node " << node.name()
+              << " in function " << func.signature().name()
+              << " has no batched form.";
+      return false;
+    }
+  }
+  bool progress = true;
+  while (!pending.empty() && progress) {
+    progress = false;
+    for (auto it = pending.begin(); it != pending.end();) {
+      const NodeDef& node = **it;
+      const ValueInfo* lhs = lookup(node.input(0));
+      const ValueInfo* rhs =
+          node.input_size() == 2 ? lookup(node.input(1)) : lhs;
+      if (lhs == nullptr || rhs == nullptr) {
+        ++it;
+        continue;
+      }
+      ValueInfo info;
+      if (lhs->is_scalar) {
+        info = *rhs;
+      } else if (rhs->is_scalar || lhs->source_arg == rhs->source_arg) {
+        info = *lhs;
+      } else {
+        // Operands derived from different inputs may rely on per-element
+        // broadcasting that does not carry over to batches.
+        return false;
+      }
+      values[node.name()] = info;
+      pending.erase(it++);
+      progress = true;
+    }
+  }
+  if (!pending.empty()) return false;
+
+  // Every return value must have a batch dimension once the function is
+  // applied to a batch.
+  for (const auto& ret : func.ret()) {
+    const ValueInfo* info = lookup(ret.second);
+    if (info == nullptr || info->is_scalar) return false;
+  }
+  return true;
+}
+
+// Returns the shapes of the batches of elements with the given shapes, using
+// the batch dimension of `batch_node`'s output.
+Status GetBatchedShapes(const NodeDef& batch_node,
+                        const AttrValue& element_shapes,
+                        AttrValue* batched_shapes) {
+  const auto& batch_shapes = batch_node.attr().at(kOutputShapes).list();
+  int64_t batch_dim = -1;
+  if (batch_shapes.shape_size() > 0 && !batch_shapes.shape(0).unknown_rank() &&
+      batch_shapes.shape(0).dim_size() > 0) {
+    batch_dim = batch_shapes.shape(0).dim(0).size();
+  }
+  for (const TensorShapeProto& element_shape : element_shapes.list().shape()) {
+    TensorShapeProto* shape = batched_shapes->mutable_list()->add_shape();
+    if (element_shape.unknown_rank()) {
+      shape->set_unknown_rank(true);
+      continue;
+    }
+    shape->add_dim()->set_size(batch_dim);
+    for (const auto& dim : element_shape.dim()) {
+      *shape->add_dim() = dim;
+    }
+  }
+  return OkStatus();
+}
+
+}  // namespace
+
+Status MapVectorization::OptimizeAndCollectStats(Cluster* cluster,
+                                                 const GrapplerItem& item,
+                                                 GraphDef* output,
+                                                 OptimizationStats* stats) {
+  *output = item.graph;
+  MutableGraphView graph(output);
+  absl::flat_hash_set<string> nodes_to_delete;
+  FunctionLibraryDefinition function_library(OpRegistry::Global(),
+                                             item.graph.library());
+
+  for (const NodeDef& node : item.graph.node()) {
+    if (!IsBatch(node)) continue;
+    // Use a more descriptive variable name now that we know the node type.
+    const NodeDef& batch_node = node;
+    NodeDef* map_node = graph_utils::GetInputNode(batch_node, graph);
+    if (map_node == nullptr || !IsMap(*map_node)) continue;
+    if (graph.GetFanouts(*map_node, /*include_controlled_nodes=*/true).size() !=
+        1) {
+      continue;
+    }
+    if (!map_node->attr().at("Targuments").list().type().empty()) continue;
+    if (!gtl::FindOrNull(batch_node.attr(), kOutputShapes)) continue;
+
+    const FunctionDef* func = function_library.Find(
+        map_node->attr().at("f").func().name());
+    if (func == nullptr || !IsElementWise(*func)) continue;
+
+    NodeDef* input_node = graph_utils::GetInputNode(*map_node, graph);
+    if (input_node == nullptr) continue;
+    const AttrValue* element_types =
+        gtl::FindOrNull(input_node->attr(), kOutputTypes);
+    const AttrValue* element_shapes =
+        gtl::FindOrNull(input_node->attr(), kOutputShapes);
+    if (element_types == nullptr || element_shapes == nullptr) continue;
+
+    // Batch the input elements first.
+    NodeDef new_batch_node = batch_node;
+    graph_utils::SetUniqueGraphNodeName(batch_node.op(), graph.graph(),
+                                        &new_batch_node);
+    new_batch_node.set_input(0, map_node->input(0));
+    (*new_batch_node.mutable_attr())[kOutputTypes] = *element_types;
+    AttrValue batched_shapes;
+    TF_RETURN_IF_ERROR(
+        GetBatchedShapes(batch_node, *element_shapes, &batched_shapes));
+    (*new_batch_node.mutable_attr())[kOutputShapes] = batched_shapes;
+    NodeDef* new_batch = graph.AddNode(std::move(new_batch_node));
+
+    // Then apply the map function to each batch.
+    NodeDef new_map_node = *map_node;
+    graph_utils::SetUniqueGraphNodeName(map_node->op(), graph.graph(),
+                                        &new_map_node);
+    new_map_node.set_input(0, new_batch->name());
+    graph_utils::CopyShapesAndTypesAttrs(batch_node, &new_map_node);
+    NodeDef* new_map = graph.AddNode(std::move(new_map_node));
+
+    TF_RETURN_IF_ERROR(graph.UpdateFanouts(batch_node.name(), new_map->name()));
+    nodes_to_delete.insert(map_node->name());
+    nodes_to_delete.insert(batch_node.name());
+    stats->num_changes++;
+  }
+
+  TF_RETURN_IF_ERROR(graph.DeleteNodes(nodes_to_delete));
+  return OkStatus();
+}
+
+REGISTER_GRAPH_OPTIMIZER_AS(MapVectorization, "map_vectorization");
+
+}  // namespace grappler
+}  // namespace tensorflow
@@ -0,0 +1,228 @@
+/* Copyright 2022 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/grappler/optimizers/inplace_forwarding.h"
+
+#include <deque>
+#include <string>
+#include <unordered_set>
+#include <vector>
+
+#include "absl/container/flat_hash_set.h"
+#include "tensorflow/core/framework/attr_value.pb.h"
+#include "tensorflow/core/framework/node_def.pb.h"
+#include "tensorflow/core/framework/node_def_util.h"
+#include "tensorflow/core/grappler/clusters/cluster.h"
+#include "tensorflow/core/grappler/costs/graph_memory.h"
+#include "tensorflow/core/grappler/costs/graph_properties.h"
+#include "tensorflow/core/grappler/grappler_item.h"
+#include "tensorflow/core/grappler/op_types.h"
+#include "tensorflow/core/grappler/utils.h"
+#include "tensorflow/core/grappler/utils/symbolic_shapes.h"
+#include "tensorflow/core/lib/core/errors.h"
+#include "tensorflow/core/lib/strings/strcat.h"
+#include "tensorflow/core/util/util.h"
+
+namespace tensorflow {
+namespace grappler {
+namespace {
+
+constexpr char kForwardInputAttr[] = "_forward_input";
+constexpr char kScopedAllocatorAttr[] = "_scoped_allocator";
+
+// Element-wise ops whose kernels call forward_input_or_allocate_output() on
+// all their inputs, for output 0. The executor fails ops which are marked with
+// kForwardInputAttr but allocate their output, so the list must only contain
+// ops which do for every device and type the pass applies to.
+bool IsForwardingOp(const NodeDef& node) {
+  static const auto* const kOps = new absl::flat_hash_set<string>{
+      "Abs", "Add", "AddV2", "Ceil", "Cos", "Elu", "Exp", "Expm1", "Floor",
+      "Log", "Log1p", "Maximum", "Minimum", "Mul", "Neg", "RealDiv",
+      "Reciprocal", "Relu", "Relu6", "Round", "Rsqrt", "Selu", "Sigmoid",
+      "Sign", "Sin", "Sqrt", "Square", "SquaredDifference", "Sub", "Tanh"};
+  return kOps->contains(node.op());
+}
+
+// Returns true if the outputs of `node` own their buffers, i.e. they are never
+// aliases of an input that is still referenced elsewhere, or of a persistent
+// buffer such as a variable or a constant.
+bool OwnsOutputBuffers(const NodeDef& node) {
+  if (IsForwardingOp(node) || node.op() == "MatMul" || IsBiasAdd(node)) {
+    return true;
+  }
+  // AddN of a single input forwards it.
+  int n = 0;
+  return IsAddN(node) && TryGetNodeAttr(node, "N", &n) && n > 1;
+}
+
+bool HasForwardableType(const NodeDef& node) {
+  const DataType type = GetDataTypeFromAttr(node, "T");
+  return type == DT_FLOAT || type == DT_DOUBLE || type == DT_HALF ||
+         type == DT_BFLOAT16;
+}
+
+bool IsSameTensor(const string& input, const string& other_input) {
+  return ParseTensorName(input) == ParseTensorName(other_input);
+}
+
+// Returns true if `target` is reachable from `source`.
+bool IsReachable(const NodeMap& node_map, const NodeDef* source,
+                 const NodeDef* target) {
+  std::unordered_set<const NodeDef*> visited = {source};
+  std::deque<const NodeDef*> queue = {source};
+  while (!queue.empty()) {
+    const NodeDef* node = queue.front();
+    queue.pop_front();
+    for (const NodeDef* fanout : node_map.GetOutputs(node->name())) {
+      if (fanout == target) return true;
+      if (visited.insert(fanout).second) queue.push_back(fanout);
+    }
+  }
+  return false;
+}
+
+}  // namespace
+
+Status InplaceForwarding::Optimize(Cluster* cluster, const GrapplerItem& item,
+                                   GraphDef* optimized_graph) {
+  // oneDNN kernels don't necessarily forward their inputs.
+  if (IsMKLEnabled()) {
+    return errors::Aborted("Nothing to do: oneDNN is enabled.");
+  }
+  *optimized_graph = item.graph;
+  GraphProperties properties(item);
+  TF_RETURN_IF_ERROR(properties.InferStatically(/*assume_valid_feeds=*/false));
+  NodeMap node_map(optimized_graph);
+  const std::unordered_set<string> nodes_to_preserve = item.NodesToPreserve();
+
+  // Control dependencies propagate deadness, so readers can't be reordered
+  // in graphs with v1 control flow.
+  bool can_reorder = true;
+  for (const NodeDef& node : optimized_graph->node()) {
+    if (IsSwitch(node)) can_reorder = false;
+  }
+
+  // Tensors live at the peak memory usage of their device.
+  bool has_peak_memory = false;
+  std::unordered_set<string> peak_tensors;
+  if (cluster != nullptr) {
+    GraphMemory memory(item);
+    if (memory.InferStatically(cluster->GetDevices()).ok()) {
+      has_peak_memory = true;
+      for (const auto& device : cluster->GetDevices()) {
+        for (const auto& live : memory.GetPeakMemoryUsage(device.first)
+                                    .live_tensors) {
+          peak_tensors.insert(strings::StrCat(live.node, ":", live.output_id));
+        }
+      }
+    }
+  }
+
+  int num_forwarded = 0;
+  int num_reordered = 0;
+  for (int n = 0; n < optimized_graph->node_size(); ++n) {
+    NodeDef* node = optimized_graph->mutable_node(n);
+    if (!IsForwardingOp(*node) || !HasForwardableType(*node) ||
+        (!NodeIsOnCpu(node) && !NodeIsOnGpu(node)) ||
+        node->attr().count(kForwardInputAttr) > 0 ||
+        node->attr().count(kScopedAllocatorAttr) > 0) {
+      continue;
+    }
+    // The output keeps the allocator attributes of the forwarded input, so it
+    // must not be sent to other devices.
+    bool local_outputs = true;
+    for (const NodeDef* fanout : node_map.GetOutputs(node->name())) {
+      if (fanout->device() != node->device()) local_outputs = false;
+    }
+    if (!local_outputs) continue;
+
+    const auto& input_props = properties.GetInputProperties(node->name());
+    const auto& output_props = properties.GetOutputProperties(node->name());
+    if (output_props.size() != 1) continue;
+    const int num_inputs = NumNonControlInputs(*node);
+    for (int i = 0; i < num_inputs && i < static_cast<int>(input_props.size());
+         ++i) {
+      const string& input = node->input(i);
+      const NodeDef* producer = node_map.GetNode(input);
+      if (producer == nullptr || !OwnsOutputBuffers(*producer) ||
+          producer->device() != node->device() ||
+          producer->attr().count(kScopedAllocatorAttr) > 0 ||
+          nodes_to_preserve.count(producer->name()) > 0 ||
+          !ShapesSymbolicallyEqual(input_props[i], output_props[0])) {
+        continue;
+      }
+      bool read_once = true;
+      for (int j = 0; j < num_inputs; ++j) {
+        if (j != i && IsSameTensor(node->input(j), input)) read_once = false;
+      }
+      if (!read_once) continue;
+
+      // The other readers of the input must not keep a reference to it.
+      std::vector<const NodeDef*> readers;
+      bool can_forward = true;
+      for (const NodeDef* fanout :
+           node_map.GetOutputsOrderedByNodeName(producer->name())) {
+        if (fanout == node) continue;
+        bool reads_input = false;
+        for (int j = 0; j < fanout->input_size(); ++j) {
+          if (IsSameTensor(fanout->input(j), input)) reads_input = true;
+        }
+        if (!reads_input) continue;
+        if (!OwnsOutputBuffers(*fanout) ||
+            fanout->device() != node->device() ||
+            fanout->attr().count(kForwardInputAttr) > 0) {
+          can_forward = false;
+          break;
+        }
+        readers.push_back(fanout);
+      }
+      if (!can_forward) continue;
+
+      if (!readers.empty()) {
+        if (!can_reorder ||
+            (has_peak_memory &&
+             peak_tensors.count(strings::StrCat(NodeName(input), ":",
+                                                NodePosition(input))) == 0)) {
+          continue;
+        }
+        bool creates_cycle = false;
+        for (const NodeDef* reader : readers) {
+          if (IsReachable(node_map, node, reader)) creates_cycle = true;
+        }
+        if (creates_cycle) continue;
+        for (const NodeDef* reader : readers) {
+          AddNodeControlInput(reader->name(), node);
+          node_map.AddOutput(reader->name(), node->name());
+        }
+        ++num_reordered;
+      }
+
+      AttrValue& forward_input = (*node->mutable_attr())[kForwardInputAttr];
+      forward_input.mutable_list()->add_i(i);
+      forward_input.mutable_list()->add_i(0);
+      ++num_forwarded;
+      break;
+    }
+  }
+  VLOG(1) << "Forwarding inputs of " << num_forwarded << " nodes, "
+          << num_reordered << " of which after reordering their readers";
+  if (num_forwarded == 0) {
+    return errors::Aborted("Nothing to do.");
+  }
+  return OkStatus();
+}
+
+}  // end namespace grappler
+}  // end namespace tensorflow
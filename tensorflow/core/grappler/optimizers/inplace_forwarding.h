@@ -0,0 +1,57 @@
+/* Copyright 2022 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_CORE_GRAPPLER_OPTIMIZERS_INPLACE_FORWARDING_H_
+#define TENSORFLOW_CORE_GRAPPLER_OPTIMIZERS_INPLACE_FORWARDING_H_
+
+#include "tensorflow/core/grappler/optimizers/graph_optimizer.h"
+#include "tensorflow/core/lib/core/status.h"
+
+namespace tensorflow {
+namespace grappler {
+
+// Makes element-wise ops write their output into the buffer of one of their
+// inputs.
+//
+// Element-wise kernels forward an input buffer to their output when nothing
+// else holds a reference to it, which depends on the order in which the
+// readers of the input run. For every tensor read by an element-wise op and
+// by other ops which don't keep a reference to it, this pass adds control
+// dependencies so that the element-wise op is the last reader, and marks the
+// element-wise op with the "_forward_input" attribute: the executor then
+// forwards the buffer without checking its reference count.
+//
+// When a cluster is available, readers are only reordered for the tensors
+// live at the peak memory usage estimated by GraphMemory.
+//
+// Other passes must not add readers to the tensors after this pass, so the
+// meta-optimizer runs it last.
+class InplaceForwarding : public GraphOptimizer {
+ public:
+  InplaceForwarding() {}
+  ~InplaceForwarding() override {}
+
+  string name() const override { return "inplace_forwarding"; };
+
+  bool UsesFunctionLibrary() const override { return false; }
+
+  Status Optimize(Cluster* cluster, const GrapplerItem& item,
+                  GraphDef* optimized_graph) override;
+};
+
+}  // end namespace grappler
+}  // end namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_GRAPPLER_OPTIMIZERS_INPLACE_FORWARDING_H_
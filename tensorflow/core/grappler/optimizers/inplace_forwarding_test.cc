@@ -0,0 +1,109 @@
+/* Copyright 2022 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/grappler/optimizers/inplace_forwarding.h"
+
+#include "tensorflow/cc/ops/standard_ops.h"
+#include "tensorflow/core/framework/node_def.pb.h"
+#include "tensorflow/core/framework/tensor_testutil.h"
+#include "tensorflow/core/grappler/grappler_item.h"
+#include "tensorflow/core/grappler/utils/grappler_test.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/test.h"
+#include "tensorflow/core/util/util.h"
+
+namespace tensorflow {
+namespace grappler {
+namespace {
+
+class InplaceForwardingTest : public GrapplerTest {};
+
+TEST_F(InplaceForwardingTest, ReordersReaders) {
+  if (IsMKLEnabled()) GTEST_SKIP() << "Pass disabled with oneDNN.";
+  tensorflow::Scope s = tensorflow::Scope::NewRootScope();
+  Output x = ops::Placeholder(s.WithOpName("x"), DT_FLOAT,
+                              ops::Placeholder::Shape({16}));
+  Output a = ops::Exp(s.WithOpName("a"), x);
+  Output b = ops::Sqrt(s.WithOpName("b"), a);
+  Output c = ops::Neg(s.WithOpName("c"), a);
+  Output d = ops::AddV2(s.WithOpName("d"), b, c);
+
+  GrapplerItem item;
+  TF_ASSERT_OK(s.ToGraphDef(&item.graph));
+  item.fetch = {"d"};
+  item.feed = {{"x", GenerateRandomTensor<DT_FLOAT>({16})}};
+  for (NodeDef& node : *item.graph.mutable_node()) {
+    node.set_device("/device:CPU:0");
+  }
+
+  InplaceForwarding optimizer;
+  GraphDef output;
+  TF_ASSERT_OK(optimizer.Optimize(nullptr, item, &output));
+
+  int found = 0;
+  for (const NodeDef& node : output.node()) {
+    if (node.name() == "b") {
+      // Sqrt runs after Neg, and overwrites the output of Exp.
+      ASSERT_EQ(2, node.input_size());
+      EXPECT_EQ("a", node.input(0));
+      EXPECT_EQ("^c", node.input(1));
+      ASSERT_EQ(1, node.attr().count("_forward_input"));
+      EXPECT_EQ(0, node.attr().at("_forward_input").list().i(0));
+      EXPECT_EQ(0, node.attr().at("_forward_input").list().i(1));
+      found++;
+    } else if (node.name() == "c") {
+      ASSERT_EQ(1, node.input_size());
+      EXPECT_EQ(0, node.attr().count("_forward_input"));
+      found++;
+    } else if (node.name() == "d") {
+      ASSERT_EQ(1, node.attr().count("_forward_input"));
+      found++;
+    }
+  }
+  EXPECT_EQ(3, found);
+
+  auto tensors_expected = EvaluateNodes(item.graph, item.fetch, item.feed);
+  auto tensors = EvaluateNodes(output, item.fetch, item.feed);
+  ASSERT_EQ(1, tensors_expected.size());
+  ASSERT_EQ(1, tensors.size());
+  test::ExpectTensorNear<float>(tensors_expected[0], tensors[0], 1e-6);
+}
+
+TEST_F(InplaceForwardingTest, AliasingReader) {
+  if (IsMKLEnabled()) GTEST_SKIP() << "Pass disabled with oneDNN.";
+  tensorflow::Scope s = tensorflow::Scope::NewRootScope();
+  Output x = ops::Placeholder(s.WithOpName("x"), DT_FLOAT,
+                              ops::Placeholder::Shape({16}));
+  Output a = ops::Exp(s.WithOpName("a"), x);
+  Output i = ops::Identity(s.WithOpName("i"), a);
+  Output b = ops::Sqrt(s.WithOpName("b"), a);
+
+  GrapplerItem item;
+  TF_ASSERT_OK(s.ToGraphDef(&item.graph));
+  item.fetch = {"i", "b"};
+  for (NodeDef& node : *item.graph.mutable_node()) {
+    node.set_device("/device:CPU:0");
+  }
+
+  // The output of Identity aliases the output of Exp, which must therefore
+  // not be overwritten.
+  InplaceForwarding optimizer;
+  GraphDef output;
+  EXPECT_EQ(error::ABORTED, optimizer.Optimize(nullptr, item, &output).code());
+}
+
+}  // namespace
+}  // namespace grappler
+}  // namespace tensorflow
@@ -440,9 +440,23 @@ void RecomputeSubgraph(
   }
 }
 
-void RecomputationRewritingPass(RewriterConfig::MemOptType optimization_level,
-                                const string& recomputation_targets_name_scope,
-                                GraphDef* graph, const GrapplerItem& item) {
+// Returns true if `node` is a node whose inputs we may want to recompute. This
+// matches node names that contain `recomputation_targets_name_scope` as a name
+// scope, meaning it either begins with or contains the name scope. Defaults to
+// "gradients/" which will match any node names that begins with "gradients/"
+// or contains "/gradients/".
+bool IsRecomputationTarget(const string& recomputation_targets_name_scope,
+                           const NodeDef& node) {
+  return absl::StartsWith(node.name(), recomputation_targets_name_scope) ||
+         static_cast<int>(
+             node.name().find("/" + recomputation_targets_name_scope)) != -1;
+}
+
+// Duplicates the groups of `is_candidate` nodes feeding into `is_target` nodes,
+// so that the targets use copies computed right before they are needed.
+void RecomputeCandidateSubgraphs(
+    const std::function<bool(const NodeDef&)>& is_candidate,
+    const std::function<bool(const NodeDef&)>& is_target, GraphDef* graph) {
   // The topological numberings and NodeMap will be stale as soon as we start
   // modifying the graph in RecomputeSubgraph. However, RecomputeSubgraph only
   // looks up nodes which were in the original graph, and preserves the graph
@@ -452,7 +466,26 @@ void RecomputationRewritingPass(RewriterConfig::MemOptType optimization_level,
   // start collecting those.
   TF_CHECK_OK(TopologicalSort(graph));
   NodeMap node_map(graph);
-  std::vector<RecomputedSubGraph> recomputed_subgraphs;
+  std::vector<RecomputedSubGraph> recomputed_subgraphs =
+      GetOpGroupsToRecompute(graph, node_map, is_candidate, is_target);
+  if (!recomputed_subgraphs.empty()) {
+    std::unordered_map<const NodeDef*, int> topological_numbering;
+    for (int node_number = 0; node_number < graph->node().size();
+         ++node_number) {
+      topological_numbering[graph->mutable_node(node_number)] =
+          graph->node().size() - node_number - 1;
+    }
+    // Duplicate the indicated sub-graphs and set up control dependencies
+    for (const RecomputedSubGraph& subgraph : recomputed_subgraphs) {
+      RecomputeSubgraph(subgraph.recomputed_source_nodes, subgraph.target_nodes,
+                        node_map, topological_numbering, graph);
+    }
+  }
+}
+
+void RecomputationRewritingPass(RewriterConfig::MemOptType optimization_level,
+                                const string& recomputation_targets_name_scope,
+                                GraphDef* graph, const GrapplerItem& item) {
   // Do not recompute nodes which are fed, since the recomputed node would not
   // take on the fed value (i.e. gradients would be incorrect).
   std::unordered_set<string> feeds;
@@ -461,15 +494,7 @@ void RecomputationRewritingPass(RewriterConfig::MemOptType optimization_level,
   }
   std::function<bool(const NodeDef&)> is_target =
       [&recomputation_targets_name_scope](const NodeDef& node) {
-        // Nodes whose inputs we may want to recompute. This matches node names
-        // that contain recomputation_targets_name_scope as a name scope,
-        // meaning it either begins with or contains the name scope.
-        // Defaults to "gradients/" which will match any node names that begins
-        // with "gradients/" or contains "/gradients/".
-        return absl::StartsWith(node.name(),
-                                recomputation_targets_name_scope) ||
-               static_cast<int>(node.name().find(
-                   "/" + recomputation_targets_name_scope)) != -1;
+        return IsRecomputationTarget(recomputation_targets_name_scope, node);
       };
 
   if (optimization_level == RewriterConfig::RECOMPUTATION_HEURISTICS ||
@@ -480,36 +505,133 @@ void RecomputationRewritingPass(RewriterConfig::MemOptType optimization_level,
     // separated by identity ops).
     std::unordered_set<string> cheap_to_recompute_ops =
         GetCheapToRecomputeOps();
-    recomputed_subgraphs = GetOpGroupsToRecompute(
-        graph, node_map,
+    RecomputeCandidateSubgraphs(
         [&cheap_to_recompute_ops, &feeds, &is_target](const NodeDef& node) {
           return !is_target(node) && feeds.count(node.name()) == 0 &&
                  (cheap_to_recompute_ops.count(node.op()) > 0 ||
                   node.attr().count(kRecomputeHint) > 0);
         },
-        is_target);
+        is_target, graph);
   } else if (optimization_level == RewriterConfig::MANUAL) {
-    recomputed_subgraphs = GetOpGroupsToRecompute(
-        graph, node_map,
+    RecomputeCandidateSubgraphs(
         [&feeds, &is_target](const NodeDef& node) {
           return !is_target(node) && feeds.count(node.name()) == 0 &&
                  node.attr().count(kRecomputeHint) > 0;
         },
-        is_target);
+        is_target, graph);
   }
-  if (!recomputed_subgraphs.empty()) {
-    std::unordered_map<const NodeDef*, int> topological_numbering;
-    for (int node_number = 0; node_number < graph->node().size();
-         ++node_number) {
-      topological_numbering[graph->mutable_node(node_number)] =
-          graph->node().size() - node_number - 1;
+}
+
+// Picks, on each device whose estimated peak memory usage exceeds its target,
+// the tensors live at the peak that are cheaper to recompute than to keep:
+// outputs of cheap ops which feed into recomputation targets. These are
+// recomputed right before the targets run, largest first, until the estimated
+// savings cover the excess. Whatever remains is left to SwappingPass.
+// `peak_memory_target` overrides the memory size of the devices if positive.
+bool PeakMemoryRecomputationPass(
+    Cluster* cluster, int64_t peak_memory_target,
+    const string& recomputation_targets_name_scope,
+    std::unique_ptr<GraphMemory>* memory_ptr, GrapplerItem* item,
+    std::unordered_set<string>* skip_list) {
+  if ((*memory_ptr) == nullptr) {
+    memory_ptr->reset(new GraphMemory(*item));
+    Status s = (*memory_ptr)->InferStatically(cluster->GetDevices());
+    if (!s.ok()) {
+      memory_ptr->reset();
+      VLOG(1) << "Failed to infer memory usage: " << s.error_message();
+      return false;
     }
-    // Duplicate the indicated sub-graphs and set up control dependencies
-    for (const RecomputedSubGraph& subgraph : recomputed_subgraphs) {
-      RecomputeSubgraph(subgraph.recomputed_source_nodes, subgraph.target_nodes,
-                        node_map, topological_numbering, graph);
+  }
+  const GraphMemory& memory = **memory_ptr;
+
+  std::unordered_set<string> feeds;
+  for (const auto& feed : item->feed) {
+    feeds.insert(NodeName(feed.first));
+  }
+  const std::unordered_set<string> cheap_to_recompute_ops =
+      GetCheapToRecomputeOps();
+  auto is_target = [&recomputation_targets_name_scope](const NodeDef& node) {
+    return IsRecomputationTarget(recomputation_targets_name_scope, node);
+  };
+  NodeMap node_map(&item->graph);
+
+  std::unordered_set<string> nodes_to_recompute;
+  for (const auto& device : cluster->GetDevices()) {
+    const int64_t memory_target = peak_memory_target > 0
+                                      ? peak_memory_target
+                                      : device.second.memory_size();
+    if (memory_target <= 0) {
+      VLOG(1) << "Peak memory target unknown for device " << device.first;
+      continue;
+    }
+    const GraphMemory::MemoryUsage& mem_usage =
+        memory.GetPeakMemoryUsage(device.first);
+    int64_t required_savings = mem_usage.used_memory - memory_target;
+    if (required_savings <= 0) {
+      continue;
     }
+
+    // Recompute the largest tensors first to duplicate as few nodes as
+    // possible.
+    std::vector<const GraphMemory::LiveTensor*> live_tensors;
+    for (const auto& live_tensor : mem_usage.live_tensors) {
+      live_tensors.push_back(&live_tensor);
+    }
+    std::sort(live_tensors.begin(), live_tensors.end(),
+              [](const GraphMemory::LiveTensor* a,
+                 const GraphMemory::LiveTensor* b) {
+                return a->memory_used > b->memory_used;
+              });
+    for (const GraphMemory::LiveTensor* live_tensor : live_tensors) {
+      if (required_savings <= 0 || live_tensor->memory_used <= 1024) {
+        // Don't bother with small tensors.
+        break;
+      }
+      if (skip_list->find(live_tensor->node) != skip_list->end()) {
+        continue;
+      }
+      const NodeDef* node = node_map.GetNode(live_tensor->node);
+      if (node == nullptr || feeds.count(node->name()) != 0 ||
+          cheap_to_recompute_ops.count(node->op()) == 0 || is_target(*node) ||
+          absl::StartsWith(node->name(), kRecomputedNodePrefix)) {
+        continue;
+      }
+      bool has_target_output = false;
+      for (const NodeDef* output : node_map.GetOutputs(node->name())) {
+        if (is_target(*output)) {
+          has_target_output = true;
+          break;
+        }
+      }
+      bool has_target_input = false;
+      for (const string& input_name : node->input()) {
+        const NodeDef* input_node = node_map.GetNode(input_name);
+        if (input_node != nullptr && is_target(*input_node)) {
+          has_target_input = true;
+          break;
+        }
+      }
+      if (!has_target_output || has_target_input) {
+        continue;
+      }
+      VLOG(1) << "Will recompute " << node->name() << " of size "
+              << live_tensor->memory_used << " on " << device.first;
+      nodes_to_recompute.insert(node->name());
+      // Don't attempt to recompute or swap this node in a subsequent pass.
+      skip_list->insert(node->name());
+      required_savings -= live_tensor->memory_used;
+    }
+  }
+  if (nodes_to_recompute.empty()) {
+    return false;
   }
+
+  RecomputeCandidateSubgraphs(
+      [&nodes_to_recompute](const NodeDef& node) {
+        return nodes_to_recompute.count(node.name()) != 0;
+      },
+      is_target, &item->graph);
+  return true;
 }
 
 bool SchedulingPass(Cluster* cluster, std::unique_ptr<GraphMemory>* memory_ptr,
@@ -978,7 +1100,7 @@ struct MemInfo {
 };
 
 static bool IdentifySwappingCandidates(
-    Cluster* cluster, GrapplerItem* item,
+    Cluster* cluster, int64_t peak_memory_target, GrapplerItem* item,
     std::unique_ptr<GraphMemory>* memory_ptr,
     std::unordered_set<string>* skip_list,
     std::unordered_map<NodeDef*, SwapInfo>* nodes_to_swap) {
@@ -1000,16 +1122,18 @@ static bool IdentifySwappingCandidates(
     if (prop.type() != "GPU") {
       continue;
     }
-    if (prop.memory_size() <= 0) {
+    const int64_t memory_target =
+        peak_memory_target > 0 ? peak_memory_target : prop.memory_size();
+    if (memory_target <= 0) {
       VLOG(1) << "Peak memory usage unknown for device " << name;
       continue;
     }
     const GraphMemory::MemoryUsage& mem_usage = memory.GetPeakMemoryUsage(name);
 
-    if (mem_usage.used_memory <= prop.memory_size()) {
+    if (mem_usage.used_memory <= memory_target) {
       continue;
     }
-    int64_t required_savings = mem_usage.used_memory - prop.memory_size();
+    int64_t required_savings = mem_usage.used_memory - memory_target;
 
     std::unordered_map<string, Costs::NanoSeconds> op_completion_times;
     {
@@ -1147,15 +1271,17 @@ static bool IdentifySwappingCandidates(
 }
 
 bool SwappingPass(RewriterConfig::MemOptType optimization_level,
-                  Cluster* cluster, std::unique_ptr<GraphMemory>* memory,
-                  GrapplerItem* item, std::unordered_set<string>* skip_list) {
+                  Cluster* cluster, int64_t peak_memory_target,
+                  std::unique_ptr<GraphMemory>* memory, GrapplerItem* item,
+                  std::unordered_set<string>* skip_list) {
   std::unordered_map<NodeDef*, SwapInfo> nodes_to_swap;
   if (optimization_level == RewriterConfig::DEFAULT_MEM_OPT ||
       optimization_level == RewriterConfig::SWAPPING_HEURISTICS ||
-      optimization_level == RewriterConfig::HEURISTICS) {
+      optimization_level == RewriterConfig::HEURISTICS ||
+      optimization_level == RewriterConfig::PEAK_MEMORY_HEURISTICS) {
     // Use heuristics to figure out what needs to be swapped;
-    IdentifySwappingCandidates(cluster, item, memory, skip_list,
-                               &nodes_to_swap);
+    IdentifySwappingCandidates(cluster, peak_memory_target, item, memory,
+                               skip_list, &nodes_to_swap);
   }
   // Look for manual annotations in the graph.
   for (auto& node : *item->graph.mutable_node()) {
@@ -1386,6 +1512,7 @@ Status MemoryOptimizer::Optimize(Cluster* cluster, const GrapplerItem& item,
   bool run_recomputation_pass =
       (optimization_level_ == RewriterConfig::RECOMPUTATION_HEURISTICS ||
        optimization_level_ == RewriterConfig::HEURISTICS ||
+       optimization_level_ == RewriterConfig::PEAK_MEMORY_HEURISTICS ||
        optimization_level_ == RewriterConfig::MANUAL);
   if (!run_recomputation_pass && nodes_to_relax.empty() && item.fetch.empty()) {
     return errors::Aborted("Nothing to do.");
@@ -1395,8 +1522,13 @@ Status MemoryOptimizer::Optimize(Cluster* cluster, const GrapplerItem& item,
   RelaxAssignNodes(nodes_to_relax, &optimized_item.graph);
 
   if (run_recomputation_pass) {
-    RecomputationRewritingPass(optimization_level_,
-                               recomputation_targets_name_scope_,
+    // The peak memory heuristics pick the nodes to recompute themselves, but
+    // still respect manual annotations.
+    RecomputationRewritingPass(
+        optimization_level_ == RewriterConfig::PEAK_MEMORY_HEURISTICS
+            ? RewriterConfig::MANUAL
+            : optimization_level_,
+        recomputation_targets_name_scope_,
                                &optimized_item.graph, item);
   }
 
@@ -1413,7 +1545,8 @@ Status MemoryOptimizer::Optimize(Cluster* cluster, const GrapplerItem& item,
       updated_graph = false;
       if ((optimization_level_ == RewriterConfig::DEFAULT_MEM_OPT ||
            optimization_level_ == RewriterConfig::SCHEDULING_HEURISTICS ||
-           optimization_level_ == RewriterConfig::HEURISTICS) &&
+           optimization_level_ == RewriterConfig::HEURISTICS ||
+           optimization_level_ == RewriterConfig::PEAK_MEMORY_HEURISTICS) &&
           cluster != nullptr) {
         if (SchedulingPass(cluster, &memory, &optimized_item)) {
           // Reset the inferred memory usage since the graph changed.
@@ -1422,13 +1555,30 @@ Status MemoryOptimizer::Optimize(Cluster* cluster, const GrapplerItem& item,
         }
       }
 
+      GRAPPLER_RETURN_IF_DEADLINE_EXCEEDED();
+      if (optimization_level_ == RewriterConfig::PEAK_MEMORY_HEURISTICS) {
+        // Recompute what is cheap to recompute first, and only swap the
+        // tensors needed to get under the target afterwards, since swapping
+        // costs PCIe bandwidth and may delay the consumers of the tensors.
+        if (PeakMemoryRecomputationPass(cluster, peak_memory_target_bytes_,
+                                        recomputation_targets_name_scope_,
+                                        &memory, &optimized_item,
+                                        &skip_list)) {
+          // Reset the inferred memory usage since the graph changed.
+          memory.reset();
+          updated_graph = true;
+        }
+      }
+
       GRAPPLER_RETURN_IF_DEADLINE_EXCEEDED();
       if ((optimization_level_ == RewriterConfig::DEFAULT_MEM_OPT ||
            optimization_level_ == RewriterConfig::SWAPPING_HEURISTICS ||
            optimization_level_ == RewriterConfig::HEURISTICS ||
+           optimization_level_ == RewriterConfig::PEAK_MEMORY_HEURISTICS ||
            optimization_level_ == RewriterConfig::MANUAL) &&
           cluster != nullptr) {
-        if (SwappingPass(optimization_level_, cluster, &memory, &optimized_item,
+        if (SwappingPass(optimization_level_, cluster,
+                         peak_memory_target_bytes_, &memory, &optimized_item,
                          &skip_list)) {
           // Reset the inferred memory usage since the graph changed.
           memory.reset();
@@ -346,6 +346,53 @@ TEST_F(MemoryOptimizerTest, SwappingHeuristics) {
 #endif
 }
 
+TEST_F(MemoryOptimizerTest, PeakMemoryRecomputation) {
+  tensorflow::Scope s = tensorflow::Scope::NewRootScope();
+  Output v = ops::Variable(s.WithOpName("v").WithDevice("/cpu:0"),
+                           {128, 128, 8}, DT_FLOAT);
+  Output a = ops::Square(s.WithOpName("a").WithDevice("/cpu:0"), v);
+  Output b = ops::Sqrt(s.WithOpName("b").WithDevice("/cpu:0"), a);
+  Output c = ops::Exp(s.WithOpName("c").WithDevice("/cpu:0"), b);
+  Output e =
+      ops::AddN(s.WithOpName("gradients/e").WithDevice("/cpu:0"), {a, c});
+
+  Output constant = ops::Const(s.WithOpName("constant"), 0.0f, {128, 128, 8});
+  Output init = ops::Assign(s.WithOpName("init"), v, constant);
+
+  GrapplerItem item;
+  TF_CHECK_OK(s.ToGraphDef(&item.graph));
+  item.fetch = {"gradients/e"};
+  item.init_ops = {init.name()};
+
+  std::unique_ptr<VirtualCluster> cluster(CreateVirtualCluster());
+
+  // a, b and c take 512KB each. Keeping a live until gradients/e runs exceeds
+  // the target, so a should be recomputed right before gradients/e instead.
+  MemoryOptimizer optimizer(RewriterConfig::PEAK_MEMORY_HEURISTICS,
+                            "gradients/",
+                            /*peak_memory_target_bytes=*/1024 * 1024);
+  GraphDef output;
+  Status status = optimizer.Optimize(cluster.get(), item, &output);
+  TF_EXPECT_OK(status);
+
+  NodeMap node_map(&output);
+  const NodeDef* recomputed_a = node_map.GetNode("Recomputed/a");
+  ASSERT_NE(recomputed_a, nullptr);
+  EXPECT_EQ("Square", recomputed_a->op());
+  const NodeDef* new_e = node_map.GetNode("gradients/e");
+  ASSERT_NE(new_e, nullptr);
+  EXPECT_EQ("Recomputed/a", new_e->input(0));
+  EXPECT_EQ("c", new_e->input(1));
+  // b doesn't feed into the gradients, and c isn't cheap to recompute.
+  EXPECT_EQ(nullptr, node_map.GetNode("Recomputed/b"));
+  EXPECT_EQ(nullptr, node_map.GetNode("Recomputed/c"));
+
+  auto tensors_expected = EvaluateFetchNodes(item);
+  GrapplerItem optimized = item.WithGraph(std::move(output));
+  auto tensors = EvaluateFetchNodes(optimized);
+  test::ExpectTensorEqual<float>(tensors_expected[0], tensors[0]);
+}
+
 TEST_F(MemoryOptimizerTest, UnswappableInputs) {
   tensorflow::Scope s = tensorflow::Scope::NewRootScope();
   Output v = ops::Variable(s.WithOpName("v").WithDevice("/gpu:0"),
@@ -17,6 +17,7 @@ limitations under the License.
 
 #include <algorithm>
 #include <functional>
+#include <map>
 #include <string>
 #include <utility>
 
@@ -33,6 +34,7 @@ limitations under the License.
 #include "tensorflow/core/framework/tensor_util.h"
 #include "tensorflow/core/framework/versions.pb.h"
 #include "tensorflow/core/grappler/clusters/virtual_cluster.h"
+#include "tensorflow/core/grappler/costs/graph_properties.h"
 #include "tensorflow/core/grappler/optimizers/arithmetic_optimizer.h"
 #include "tensorflow/core/grappler/optimizers/auto_mixed_precision.h"
 #include "tensorflow/core/grappler/optimizers/auto_parallel.h"
@@ -44,11 +46,16 @@ limitations under the License.
 #include "tensorflow/core/grappler/optimizers/function_optimizer.h"
 #include "tensorflow/core/grappler/optimizers/generic_layout_optimizer.h"
 #include "tensorflow/core/grappler/optimizers/implementation_selector.h"
+#include "tensorflow/core/grappler/optimizers/inplace_forwarding.h"
 #include "tensorflow/core/grappler/optimizers/loop_optimizer.h"
 #include "tensorflow/core/grappler/optimizers/memory_optimizer.h"
 #include "tensorflow/core/grappler/optimizers/model_pruner.h"
+#include "tensorflow/core/grappler/optimizers/parallelism_tuner.h"
 #include "tensorflow/core/grappler/optimizers/pin_to_host_optimizer.h"
+#include "tensorflow/core/grappler/optimizers/pipeline_parallel.h"
+#include "tensorflow/core/grappler/optimizers/prefetch_to_device.h"
 #include "tensorflow/core/grappler/optimizers/remapper.h"
+#include "tensorflow/core/grappler/optimizers/remote_gather_dedup.h"
 #include "tensorflow/core/grappler/optimizers/scoped_allocator_optimizer.h"
 #include "tensorflow/core/grappler/optimizers/shape_optimizer.h"
 #include "tensorflow/core/grappler/utils/canonicalizer.h"
@@ -57,8 +64,15 @@ limitations under the License.
 #include "tensorflow/core/grappler/utils/topological_sort.h"
 #include "tensorflow/core/grappler/utils/tpu.h"
 #include "tensorflow/core/grappler/verifiers/structure_verifier.h"
+#include "tensorflow/core/lib/core/blocking_counter.h"
 #include "tensorflow/core/lib/core/status.h"
+#include "tensorflow/core/lib/core/threadpool.h"
 #include "tensorflow/core/lib/gtl/map_util.h"
+#include "tensorflow/core/lib/io/path.h"
+#include "tensorflow/core/lib/random/random.h"
+#include "tensorflow/core/lib/strings/proto_serialization.h"
+#include "tensorflow/core/platform/fingerprint.h"
+#include "tensorflow/core/public/version.h"
 #include "tensorflow/core/util/dump_graph.h"
 #include "tensorflow/core/util/ptr_util.h"
 #include "tensorflow/core/util/util.h"
@@ -103,7 +117,8 @@ int NumIterations(const RewriterConfig& cfg) {
 // Check if optimizer is allowed to run only once.
 bool IsRunOnceOptimizer(const string& name) {
   return name == "layout" || name == "memory_optimizer" ||
-         name == "loop_optimizer" ||
+         name == "loop_optimizer" || name == "parallelism_tuner" ||
+         name == "pipeline_parallel" ||
          absl::StartsWith(name, "auto_mixed_precision");
 }
 
@@ -171,6 +186,95 @@ bool MemoryOptimizerEnabled(RewriterConfig::MemOptType mem_opt_type,
   return mem_opt_type != RewriterConfig::NO_MEM_OPT;
 }
 
+// Returns the key of `item` in the optimized graph cache. It covers everything
+// the optimized graph depends on: the graph with its feeds, fetches and
+// preserved nodes, the available devices, the config (other than the cache
+// location) and the TensorFlow version.
+uint64 OptimizedGraphCacheKey(const GrapplerItem& item, const Cluster* cluster,
+                              const ConfigProto& config) {
+  uint64 key = DeterministicProtoHash64(item.graph);
+  const auto add = [&key](absl::string_view s) {
+    key = FingerprintCat64(key, Fingerprint64(s));
+  };
+  const auto add_all = [&add](absl::string_view kind,
+                              const std::vector<string>& names) {
+    add(absl::StrCat(kind, ":", names.size()));
+    for (const string& name : names) add(name);
+  };
+
+  add(absl::StrCat("feed:", item.feed.size()));
+  for (const auto& feed : item.feed) {
+    add(feed.first);
+    add(DataTypeString(feed.second.dtype()));
+    add(feed.second.shape().DebugString());
+  }
+  add_all("fetch", item.fetch);
+  add_all("init_ops", item.init_ops);
+  add_all("keep_ops", item.keep_ops);
+  add_all("save_restore", {item.save_op, item.restore_op,
+                           item.save_restore_loc_tensor});
+
+  const GrapplerItem::OptimizationOptions& options =
+      item.optimization_options();
+  add(absl::StrCat("options:", options.allow_non_differentiable_rewrites,
+                   options.allow_pruning_stateful_and_dataset_ops,
+                   options.optimize_function_library, options.is_eager_mode));
+
+  std::vector<string> devices(item.devices().begin(), item.devices().end());
+  std::sort(devices.begin(), devices.end());
+  add_all("devices", devices);
+  if (cluster != nullptr) {
+    const std::map<string, DeviceProperties> cluster_devices(
+        cluster->GetDevices().begin(), cluster->GetDevices().end());
+    add(absl::StrCat("cluster_devices:", cluster_devices.size()));
+    for (const auto& device : cluster_devices) {
+      add(device.first);
+      key = FingerprintCat64(key, DeterministicProtoHash64(device.second));
+    }
+  }
+
+  ConfigProto cache_config = config;
+  cache_config.mutable_graph_options()
+      ->mutable_rewrite_options()
+      ->clear_experimental_optimized_graph_cache_dir();
+  key = FingerprintCat64(key, DeterministicProtoHash64(cache_config));
+  add(absl::StrCat(TF_VERSION_STRING, ":", TF_GRAPH_DEF_VERSION));
+  return key;
+}
+
+// Reads the graph cached at `path` into `graph`. Returns false if there is no
+// such graph or it can't be read.
+bool ReadOptimizedGraphFromCache(const string& path, GraphDef* graph) {
+  Env* env = Env::Default();
+  if (!env->FileExists(path).ok()) return false;
+  Status status = ReadBinaryProto(env, path, graph);
+  if (!status.ok()) {
+    LOG(WARNING) << "Ignoring optimized graph cache entry " << path << ": "
+                 << status;
+    graph->Clear();
+    return false;
+  }
+  return true;
+}
+
+// Caches `graph` at `path` in `cache_dir`. The graph is written to a temporary
+// file first and renamed into place, so that processes sharing the cache never
+// read a partially written entry. Failures are logged and otherwise ignored.
+void WriteOptimizedGraphToCache(const string& cache_dir, const string& path,
+                                const GraphDef& graph) {
+  Env* env = Env::Default();
+  const string tmp_path =
+      absl::StrCat(path, ".tmp.", absl::Hex(random::New64()));
+  Status status = env->RecursivelyCreateDir(cache_dir);
+  if (status.ok()) status = WriteBinaryProto(env, tmp_path, graph);
+  if (status.ok()) status = env->RenameFile(tmp_path, path);
+  if (!status.ok()) {
+    LOG(WARNING) << "Failed to write optimized graph cache entry " << path
+                 << ": " << status;
+    env->DeleteFile(tmp_path).IgnoreError();
+  }
+}
+
 Status GetGraphDevice(const GraphDef& g_def, std::set<std::string>* devices) {
   for (auto& node : g_def.node()) {
     DeviceNameUtils::ParsedName parsed_name;
@@ -234,6 +338,8 @@ std::unique_ptr<GraphOptimizer> MetaOptimizer::MakeNewOptimizer(
 #endif
   MK_OPT("auto_mixed_precision_cpu", "auto_mixed_precision_cpu",
          new AutoMixedPrecision(AutoMixedPrecisionMode::CPU));
+  MK_OPT("auto_mixed_precision_cpu_bf16", "auto_mixed_precision_cpu_bf16",
+         new AutoMixedPrecision(AutoMixedPrecisionMode::CPU_BF16));
   MK_OPT("memory", "memory_optimization",
          new MemoryOptimizer(RewriterConfig::MANUAL));
   MK_OPT("common_subgraph_elimination", "common_subgraph_elimination",
@@ -242,16 +348,28 @@ std::unique_ptr<GraphOptimizer> MetaOptimizer::MakeNewOptimizer(
          new ArithmeticOptimizer(cfg_.arithmetic_optimization()));
   MK_OPT("autoparallel", "auto_parallel",
          new AutoParallel(cfg_.auto_parallel().num_replicas()));
+  MK_OPT("pipeline_parallel", "experimental_pipeline_parallel",
+         new PipelineParallel(
+             cfg_.experimental_pipeline_parallel().num_stages(),
+             cfg_.experimental_pipeline_parallel().num_micro_batches()));
   MK_OPT("loop", "loop_optimization",
          new LoopOptimizer(cfg_.loop_optimization(), cpu_device_));
   MK_OPT("dependency", "dependency_optimization",
          new DependencyOptimizer(cfg_.dependency_optimization()));
   MK_OPT("debug_stripper", "debug_stripper", new DebugStripper());
+  MK_OPT("inplace_forwarding", "experimental_inplace_forwarding",
+         new InplaceForwarding());
+  MK_OPT("prefetch_to_device", "experimental_prefetch_to_device",
+         new PrefetchToDevice());
+  MK_OPT("remote_gather_dedup", "experimental_remote_gather_dedup",
+         new RemoteGatherDedup());
   MK_OPT("scoped_allocator", "scoped_allocator_optimization",
          new ScopedAllocatorOptimizer(cfg_.scoped_allocator_optimization(),
                                       cfg_.scoped_allocator_opts()));
   MK_OPT("pin_to_host", "pin_to_host_optimization",
          new PinToHostOptimizer(cfg_.pin_to_host_optimization()));
+  MK_OPT("parallelism_tuner", "experimental_parallelism_tuning",
+         new ParallelismTuner());
 
   return std::unique_ptr<GraphOptimizer>();
 }
@@ -383,6 +501,12 @@ Status MetaOptimizer::InitializeOptimizers(
     optimizers->push_back(
         MakeUnique<AutoMixedPrecision>(AutoMixedPrecisionMode::CPU));
   }
+  if (AutoMixedPrecisionEnabled(cfg_.auto_mixed_precision_cpu_bf16()) &&
+      AutoMixedPrecisionEnabled(
+          plugin_configs.toggle_config["auto_mixed_precision_cpu_bf16"])) {
+    optimizers->push_back(
+        MakeUnique<AutoMixedPrecision>(AutoMixedPrecisionMode::CPU_BF16));
+  }
   if (BOTH_ARE_ON(pin_to_host_optimization))
     optimizers->push_back(MakeUnique<PinToHostOptimizer>());
   else if (BOTH_ARE_EXPERIMENTAL_MLIR(pin_to_host_optimization) ||
@@ -451,17 +575,37 @@ Status MetaOptimizer::InitializeOptimizers(
     if (cfg_.memory_optimizer_target_node_name_scope().empty()) {
       optimizers->push_back(
           // Use the default target node name prefix "gradients/"
-          MakeUnique<MemoryOptimizer>(cfg_.memory_optimization()));
+          MakeUnique<MemoryOptimizer>(
+              cfg_.memory_optimization(), "gradients/",
+              cfg_.memory_optimizer_peak_memory_target_bytes()));
     } else {
       optimizers->push_back(MakeUnique<MemoryOptimizer>(
           cfg_.memory_optimization(),
-          cfg_.memory_optimizer_target_node_name_scope()));
+          cfg_.memory_optimizer_target_node_name_scope(),
+          cfg_.memory_optimizer_peak_memory_target_bytes()));
     }
   }
   if (cfg_.auto_parallel().enable() && PLUGIN_IS_ON(auto_parallel)) {
     optimizers->push_back(
         MakeUnique<AutoParallel>(cfg_.auto_parallel().num_replicas()));
   }
+  if (cfg_.experimental_pipeline_parallel().enable()) {
+    optimizers->push_back(MakeUnique<PipelineParallel>(
+        cfg_.experimental_pipeline_parallel().num_stages(),
+        cfg_.experimental_pipeline_parallel().num_micro_batches()));
+  }
+  if (USER_IS_ON(experimental_parallelism_tuning)) {
+    optimizers->push_back(MakeUnique<ParallelismTuner>());
+  }
+  if (USER_IS_ON(experimental_inplace_forwarding)) {
+    optimizers->push_back(MakeUnique<InplaceForwarding>());
+  }
+  if (USER_IS_ON(experimental_prefetch_to_device)) {
+    optimizers->push_back(MakeUnique<PrefetchToDevice>());
+  }
+  if (USER_IS_ON(experimental_remote_gather_dedup)) {
+    optimizers->push_back(MakeUnique<RemoteGatherDedup>());
+  }
 
 #ifndef ENABLE_MKL
   if (BOTH_ARE_ON(scoped_allocator_optimization)) {
@@ -615,6 +759,10 @@ void MetaOptimizer::PrintUserAndPluginConfigs(
     PRINT_CFG(loop_optimization)
     PRINT_CFG(dependency_optimization)
     PRINT_CFG(scoped_allocator_optimization)
+    PRINT_CFG(experimental_parallelism_tuning)
+    PRINT_CFG(experimental_inplace_forwarding)
+    PRINT_CFG(experimental_prefetch_to_device)
+    PRINT_CFG(experimental_remote_gather_dedup)
 #undef PRINT_CFG
     user_cfg.toggle_config["auto_mixed_precision"] =
         AutoMixedPrecisionEnabled(cfg_.auto_mixed_precision())
@@ -628,6 +776,10 @@ void MetaOptimizer::PrintUserAndPluginConfigs(
         AutoMixedPrecisionEnabled(cfg_.auto_mixed_precision_cpu())
             ? RewriterConfig::ON
             : RewriterConfig::OFF;
+    user_cfg.toggle_config["auto_mixed_precision_cpu_bf16"] =
+        AutoMixedPrecisionEnabled(cfg_.auto_mixed_precision_cpu_bf16())
+            ? RewriterConfig::ON
+            : RewriterConfig::OFF;
     user_cfg.toggle_config["memory_optimization"] =
         MemoryOptimizerEnabled(cfg_.memory_optimization(),
                                config_proto_.graph_options()
@@ -638,6 +790,9 @@ void MetaOptimizer::PrintUserAndPluginConfigs(
     user_cfg.toggle_config["auto_parallel"] = cfg_.auto_parallel().enable()
                                                   ? RewriterConfig::ON
                                                   : RewriterConfig::OFF;
+    user_cfg.toggle_config["experimental_pipeline_parallel"] =
+        cfg_.experimental_pipeline_parallel().enable() ? RewriterConfig::ON
+                                                       : RewriterConfig::OFF;
   } else {
     for (const string& optimizer_name : cfg_.optimizers()) {
       if (optimizer_name == "pruning") user_cfg.disable_model_pruning = true;
@@ -656,6 +811,8 @@ void MetaOptimizer::PrintUserAndPluginConfigs(
       PRINT_CFG("auto_mixed_precision", "auto_mixed_precision")
       PRINT_CFG("auto_mixed_precision_mkl", "auto_mixed_precision_mkl")
       PRINT_CFG("auto_mixed_precision_cpu", "auto_mixed_precision_cpu")
+      PRINT_CFG("auto_mixed_precision_cpu_bf16",
+                "auto_mixed_precision_cpu_bf16")
       PRINT_CFG("pin_to_host", "pin_to_host_optimization")
       PRINT_CFG("layout", "layout_optimizer")
       PRINT_CFG("remap", "remapping")
@@ -663,7 +820,12 @@ void MetaOptimizer::PrintUserAndPluginConfigs(
       PRINT_CFG("dependency", "dependency_optimization")
       PRINT_CFG("memory", "memory_optimization")
       PRINT_CFG("autoparallel", "auto_parallel")
+      PRINT_CFG("pipeline_parallel", "experimental_pipeline_parallel")
       PRINT_CFG("scoped_allocator", "scoped_allocator_optimization")
+      PRINT_CFG("parallelism_tuner", "experimental_parallelism_tuning")
+      PRINT_CFG("inplace_forwarding", "experimental_inplace_forwarding")
+      PRINT_CFG("prefetch_to_device", "experimental_prefetch_to_device")
+      PRINT_CFG("remote_gather_dedup", "experimental_remote_gather_dedup")
 #undef PRINT_CFG
     }
   }
@@ -696,6 +858,7 @@ void MetaOptimizer::PrintUserAndPluginConfigs(
         pair.first == "auto_mixed_precision" ||
         pair.first == "auto_mixed_precision_mkl" ||
         pair.first == "auto_mixed_precision_cpu" ||
+        pair.first == "auto_mixed_precision_cpu_bf16" ||
         pair.first == "pin_to_host_optimization" ||
         pair.first == "scoped_allocator_optimization") {
       // These optimizers are turned off by default.
@@ -760,6 +923,12 @@ Status MetaOptimizer::OptimizeGraph(
     return OkStatus();
   }
 
+  // Let the optimizers reuse the shapes inferred by the previous optimizer when
+  // it didn't change the graph.
+  if (item.graph_properties_cache == nullptr) {
+    item.graph_properties_cache = std::make_shared<GraphPropertiesCache>();
+  }
+
   // Invariant: optimized_graph contains the most recently optimized version of
   // the graph.
   auto original_producer = item.graph.versions().producer();
@@ -769,6 +938,7 @@ Status MetaOptimizer::OptimizeGraph(
 #ifndef ENABLE_MKL
   GraphOptimizer* sa_optimizer = nullptr;
 #endif
+  GraphOptimizer* inplace_optimizer = nullptr;
 
   // Constants in the graph are normally compressed after model_pruner.
   // Do it here if model pruner is disabled.
@@ -804,6 +974,10 @@ Status MetaOptimizer::OptimizeGraph(
         continue;
       }
 #endif
+      if (optimizer->name() == "inplace_forwarding") {
+        if (inplace_optimizer == nullptr) inplace_optimizer = optimizer.get();
+        continue;
+      }
 
       TF_RETURN_IF_ERROR(RunOptimizer(optimizer.get(), cluster, &item,
                                       optimized_graph, &optimization_result));
@@ -843,6 +1017,13 @@ Status MetaOptimizer::OptimizeGraph(
     GRAPPLER_RETURN_IF_DEADLINE_EXCEEDED();
   }
 #endif
+  // InplaceForwarding must run after any pass which could add readers to the
+  // tensors it lets ops overwrite.
+  if (inplace_optimizer != nullptr) {
+    TF_RETURN_IF_ERROR(RunOptimizer(inplace_optimizer, cluster, &item,
+                                    optimized_graph, &optimization_result));
+    GRAPPLER_RETURN_IF_DEADLINE_EXCEEDED();
+  }
 
   bool is_optimized = std::find_if(optimization_result.results.begin(),
                                    optimization_result.results.end(),
@@ -851,7 +1032,10 @@ Status MetaOptimizer::OptimizeGraph(
                                    }) != optimization_result.results.end();
 
   // Record graph optimization result.
-  optimization_results_.push_back(optimization_result);
+  {
+    mutex_lock l(optimization_results_mu_);
+    optimization_results_.push_back(optimization_result);
+  }
 
   if (is_optimized) {
     TF_RETURN_IF_ERROR(TopologicalSort(optimized_graph));
@@ -1012,12 +1196,40 @@ void PropagateTFDataAttrs(const FunctionLibraryDefinition& flib,
 
 Status MetaOptimizer::OptimizeConsumeItem(Cluster* cluster, GrapplerItem&& item,
                                           GraphDef* optimized_graph) {
+  const string& cache_dir = cfg_.experimental_optimized_graph_cache_dir();
+  if (cache_dir.empty()) {
+    return RunOptimizers(cluster, std::move(item), optimized_graph);
+  }
+
+  const string cache_path = io::JoinPath(
+      cache_dir,
+      absl::StrCat(absl::Hex(OptimizedGraphCacheKey(item, cluster,
+                                                    config_proto_),
+                             absl::kZeroPad16),
+                   ".pb"));
+  if (ReadOptimizedGraphFromCache(cache_path, optimized_graph)) {
+    VLOG(1) << "Read optimized graph for grappler item " << item.id
+            << " from " << cache_path;
+    mutex_lock l(optimization_results_mu_);
+    optimization_results_.clear();
+    return OkStatus();
+  }
+  TF_RETURN_IF_ERROR(RunOptimizers(cluster, std::move(item), optimized_graph));
+  WriteOptimizedGraphToCache(cache_dir, cache_path, *optimized_graph);
+  return OkStatus();
+}
+
+Status MetaOptimizer::RunOptimizers(Cluster* cluster, GrapplerItem&& item,
+                                    GraphDef* optimized_graph) {
   tensorflow::metrics::ScopedCounter<2> timings(
       tensorflow::metrics::GetGraphOptimizationCounter(),
       {kGrapplerCategory, "*"});
 
   VLOG(1) << "Starting optimization for grappler item: " << item.id;
-  optimization_results_.clear();
+  {
+    mutex_lock l(optimization_results_mu_);
+    optimization_results_.clear();
+  }
 
   // Constructs a FunctionLibraryDefinition with functions that are reachable
   // from the nodes of the graph.
@@ -1126,15 +1338,99 @@ Status MetaOptimizer::OptimizeConsumeItem(Cluster* cluster, GrapplerItem&& item,
   // True if this is a TPU graph using the old bridge.
   bool is_tpu_graph = IsLegacyTPUBridgeGraphDef(*optimized_graph);
 
+  // Makes a GrapplerItem from the FunctionDef `func`.
+  const auto make_func_item = [&](const FunctionDef& func,
+                                  GrapplerFunctionItem* func_item) -> Status {
+    const string& func_name = func.signature().name();
+    TF_RETURN_IF_ERROR(
+        MakeGrapplerFunctionItem(func, flib, producer, func_item));
+
+    // If we need to compute the gradient of optimized function at runtime, we
+    // can't perform non-differentiable rewrites.
+    func_item->optimization_options().allow_non_differentiable_rewrites =
+        !differentiable_functions.contains(func_name);
+
+    // Device set available to the function is defined only by the runtime,
+    // when we instantiate and execute the function. We can't use all devices
+    // available to the main graph, because after partitioning the function
+    // call node might execute on a remote worker.
+    if (!func_item->devices().empty()) {
+      return errors::Internal("GrapplerFunctionItem devices must be empty.");
+    }
+
+    // We are not allowed to prune certain types of ops from the graph
+    // instantiated by the function definition, because we must guarantee
+    // function execution semantics wrt side effects (see
+    // function_optimizer.cc).
+    func_item->optimization_options().allow_pruning_stateful_and_dataset_ops =
+        false;
+    return OkStatus();
+  };
+
+  // Optimizes the body graph of `func_item`. This does not access `flib`, so
+  // it may run for several functions concurrently.
+  const auto optimize_func_item = [&](const GrapplerFunctionItem& func_item,
+                                      GraphDef* optimized_func_graph)
+      -> Status {
+    if (is_tpu_graph) {
+      // Skip optimizing functions if this is a TPU graph. Currently, Grappler
+      // passes do not handle TPU functions correctly in a variety of ways
+      // (Note that due to the pre-placement TPU graph rewriting passes, the
+      // TPU-related ops are encapsulated away into functions). For example,
+      // TPU graphs contain TPUReplicateMetadata node that carries relevant
+      // TPU metadata and Grappler passes could prune that away. Grappler
+      // passes could also cause issues around shape inference. Since the
+      // desired and existing behavior is to not optimize TPU functions with
+      // Grappler, this check preserves that. The only exception is
+      // implementation selector what is required to swap in some TPU specific
+      // lowering code and is verified the work correctly on TPUs.
+      ImplementationSelector implementation_selector;
+
+      // Implementation selector needs to have access to valid function
+      // signature and attributes, and it doesn't need actual function body.
+      GrapplerFunctionItem func_item_copy = func_item;
+      std::unique_ptr<FunctionDefLibrary> func_item_function_library(
+          func_item_copy.graph.release_library());
+      *func_item_copy.graph.mutable_library() =
+          GetFunctionDefLibraryStub(*func_item_function_library);
+
+      return implementation_selector.Optimize(cluster, func_item_copy,
+                                              optimized_func_graph);
+    }
+    GrapplerFunctionItem func_item_copy = func_item;
+    return OptimizeGraph(cluster, std::move(func_item_copy),
+                         optimized_func_graph);
+  };
+
+  // Replaces the function of `func_item` in `flib` with its optimized body.
+  const auto update_flib = [&](GrapplerFunctionItem* func_item,
+                               GraphDef&& optimized_func_graph) -> Status {
+    // Function body optimization might have created new specialized
+    // functions for each instantiation context. Add them to the library.
+    for (const FunctionDef& func_def :
+         optimized_func_graph.library().function()) {
+      if (flib.Find(func_def.signature().name()) == nullptr) {
+        TF_RETURN_IF_ERROR(flib.AddFunctionDef(func_def));
+      }
+    }
+
+    // Convert optimized graph back to FunctionDef.
+    FunctionDef optimized_func;
+    func_item->SwapFunctionBody(std::move(optimized_func_graph));
+    TF_RETURN_IF_ERROR(MakeFunctionDef(*func_item, flib, &optimized_func));
+
+    // Replace optimized function with a new FunctionDef.
+    return flib.ReplaceFunction(func_item->id, optimized_func);
+  };
+
   // Optimize each function only once.
   absl::flat_hash_set<string> optimized_funcs;
   while (optimize_function_library) {
     optimize_function_library = false;
 
+    std::vector<const FunctionDef*> funcs_to_optimize;
     int function_idx = 0;
     for (const FunctionDef& func : optimized_graph->library().function()) {
-      GRAPPLER_RETURN_IF_DEADLINE_EXCEEDED();
-
       const string& func_name = func.signature().name();
 
       // Skip functions that are not reachable from the optimized graph.
@@ -1162,79 +1458,56 @@ Status MetaOptimizer::OptimizeConsumeItem(Cluster* cluster, GrapplerItem&& item,
       // have to reset the flag and do at least one more pass over the library.
       optimize_function_library = true;
       optimized_funcs.insert(func_name);
+      funcs_to_optimize.push_back(&func);
+    }
 
-      // Make a GrapplerItem from a FunctionDef.
-      GrapplerFunctionItem func_item;
-      TF_RETURN_IF_ERROR(
-          MakeGrapplerFunctionItem(func, flib, producer, &func_item));
-
-      // If we need to compute the gradient of optimized function at runtime, we
-      // can't perform non-differentiable rewrites.
-      func_item.optimization_options().allow_non_differentiable_rewrites =
-          !differentiable_functions.contains(func_name);
-
-      // Device set available to the function is defined only by the runtime,
-      // when we instantiate and execute the function. We can't use all devices
-      // available to the main graph, because after partitioning the function
-      // call node might execute on a remote worker.
-      if (!func_item.devices().empty()) {
-        return errors::Internal("GrapplerFunctionItem devices must be empty.");
+    const int num_threads =
+        std::min<int>(cfg_.experimental_function_optimization_threads(),
+                      funcs_to_optimize.size());
+    if (num_threads <= 1) {
+      // Optimize one function at a time, each against the library with the
+      // previously optimized functions.
+      for (const FunctionDef* func : funcs_to_optimize) {
+        GRAPPLER_RETURN_IF_DEADLINE_EXCEEDED();
+        GrapplerFunctionItem func_item;
+        TF_RETURN_IF_ERROR(make_func_item(*func, &func_item));
+        GraphDef optimized_func_graph;
+        TF_RETURN_IF_ERROR(
+            optimize_func_item(func_item, &optimized_func_graph));
+        TF_RETURN_IF_ERROR(
+            update_flib(&func_item, std::move(optimized_func_graph)));
       }
-
-      // We are not allowed to prune certain types of ops from the graph
-      // instantiated by the function definition, because we must guarantee
-      // function execution semantics wrt side effects (see
-      // function_optimizer.cc).
-      func_item.optimization_options().allow_pruning_stateful_and_dataset_ops =
-          false;
-
-      // Optimize function body graph.
-      GraphDef optimized_func_graph;
-      if (is_tpu_graph) {
-        // Skip optimizing functions if this is a TPU graph. Currently, Grappler
-        // passes do not handle TPU functions correctly in a variety of ways
-        // (Note that due to the pre-placement TPU graph rewriting passes, the
-        // TPU-related ops are encapsulated away into functions). For example,
-        // TPU graphs contain TPUReplicateMetadata node that carries relevant
-        // TPU metadata and Grappler passes could prune that away. Grappler
-        // passes could also cause issues around shape inference. Since the
-        // desired and existing behavior is to not optimize TPU functions with
-        // Grappler, this check preserves that. The only exception is
-        // implementation selector what is required to swap in some TPU specific
-        // lowering code and is verified the work correctly on TPUs.
-        ImplementationSelector implementation_selector;
-
-        // Implementation selector needs to have access to valid function
-        // signature and attributes, and it doesn't need actual function body.
-        std::unique_ptr<FunctionDefLibrary> func_item_function_library(
-            func_item.graph.release_library());
-        *func_item.graph.mutable_library() =
-            GetFunctionDefLibraryStub(*func_item_function_library);
-
-        TF_RETURN_IF_ERROR(implementation_selector.Optimize(
-            cluster, func_item, &optimized_func_graph));
-      } else {
-        GrapplerFunctionItem func_item_copy = func_item;
-        TF_RETURN_IF_ERROR(OptimizeGraph(cluster, std::move(func_item_copy),
-                                         &optimized_func_graph));
+    } else {
+      // Optimize all functions of this pass concurrently against the library
+      // as of the start of the pass, and merge the results in library order,
+      // so that the result does not depend on the number of threads.
+      GRAPPLER_RETURN_IF_DEADLINE_EXCEEDED();
+      const int num_funcs = funcs_to_optimize.size();
+      std::vector<GrapplerFunctionItem> func_items(num_funcs);
+      for (int i = 0; i < num_funcs; ++i) {
+        TF_RETURN_IF_ERROR(
+            make_func_item(*funcs_to_optimize[i], &func_items[i]));
       }
-
-      // Function body optimization might have created new specialized
-      // functions for each instantiation context. Add them to the library.
-      for (const FunctionDef& func_def :
-           optimized_func_graph.library().function()) {
-        if (flib.Find(func_def.signature().name()) == nullptr) {
-          TF_RETURN_IF_ERROR(flib.AddFunctionDef(func_def));
+      std::vector<GraphDef> optimized_func_graphs(num_funcs);
+      std::vector<Status> statuses(num_funcs);
+      {
+        thread::ThreadPool pool(Env::Default(), "grappler_function_optimizer",
+                                num_threads);
+        BlockingCounter counter(num_funcs);
+        for (int i = 0; i < num_funcs; ++i) {
+          pool.Schedule([&, i]() {
+            statuses[i] =
+                optimize_func_item(func_items[i], &optimized_func_graphs[i]);
+            counter.DecrementCount();
+          });
         }
+        counter.Wait();
+      }
+      for (int i = 0; i < num_funcs; ++i) {
+        TF_RETURN_IF_ERROR(statuses[i]);
+        TF_RETURN_IF_ERROR(
+            update_flib(&func_items[i], std::move(optimized_func_graphs[i])));
       }
-
-      // Convert optimized graph back to FunctionDef.
-      FunctionDef optimized_func;
-      func_item.SwapFunctionBody(std::move(optimized_func_graph));
-      TF_RETURN_IF_ERROR(MakeFunctionDef(func_item, flib, &optimized_func));
-
-      // Replace optimized function with a new FunctionDef.
-      TF_RETURN_IF_ERROR(flib.ReplaceFunction(func_name, optimized_func));
     }
 
     // If optimized at least one function, update the graph library.
@@ -1282,6 +1555,7 @@ Status MetaOptimizer::OptimizeConsumeItem(Cluster* cluster, GrapplerItem&& item,
 }
 
 string MetaOptimizer::GetResultString() const {
+  mutex_lock l(optimization_results_mu_);
   std::string result_string;
   for (const GraphOptimizationResult& graph_result : optimization_results_) {
     absl::StrAppend(&result_string,
@@ -1313,15 +1587,22 @@ bool MetaOptimizerEnabled(const ConfigProto& cfg) {
          rewrite_cfg.loop_optimization() != RewriterConfig::OFF ||
          rewrite_cfg.dependency_optimization() != RewriterConfig::OFF ||
          rewrite_cfg.auto_parallel().enable() ||
+         rewrite_cfg.experimental_pipeline_parallel().enable() ||
          rewrite_cfg.memory_optimization() != RewriterConfig::NO_MEM_OPT ||
          rewrite_cfg.debug_stripper() == RewriterConfig::ON ||
 #ifndef ENABLE_MKL
          rewrite_cfg.scoped_allocator_optimization() == RewriterConfig::ON ||
 #endif
          rewrite_cfg.pin_to_host_optimization() == RewriterConfig::ON ||
+         rewrite_cfg.experimental_parallelism_tuning() == RewriterConfig::ON ||
+         rewrite_cfg.experimental_inplace_forwarding() == RewriterConfig::ON ||
+         rewrite_cfg.experimental_prefetch_to_device() == RewriterConfig::ON ||
+         rewrite_cfg.experimental_remote_gather_dedup() == RewriterConfig::ON ||
          AutoMixedPrecisionEnabled(rewrite_cfg.auto_mixed_precision()) ||
          AutoMixedPrecisionEnabled(rewrite_cfg.auto_mixed_precision_mkl()) ||
          AutoMixedPrecisionEnabled(rewrite_cfg.auto_mixed_precision_cpu()) ||
+         AutoMixedPrecisionEnabled(
+             rewrite_cfg.auto_mixed_precision_cpu_bf16()) ||
          !rewrite_cfg.optimizers().empty() ||
          !rewrite_cfg.custom_optimizers().empty();
 }
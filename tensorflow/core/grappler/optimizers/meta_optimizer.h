@@ -24,6 +24,8 @@ limitations under the License.
 #include "tensorflow/core/grappler/optimizers/graph_optimizer.h"
 #include "tensorflow/core/grappler/verifiers/graph_verifier.h"
 #include "tensorflow/core/lib/core/status.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/thread_annotations.h"
 #include "tensorflow/core/protobuf/config.pb.h"
 #include "tensorflow/core/protobuf/rewriter_config.pb.h"
 #include "tensorflow/core/protobuf/verifier_config.pb.h"
@@ -47,6 +49,9 @@ class MetaOptimizer : public GraphOptimizer {
     return OptimizeConsumeItem(cluster, std::move(copy), optimized_graph);
   }
 
+  // Looks the optimized graph up in the optimized graph cache, if there is
+  // one (see RewriterConfig.experimental_optimized_graph_cache_dir), and runs
+  // the optimizers otherwise.
   Status OptimizeConsumeItem(Cluster* cluster, GrapplerItem&& item,
                              GraphDef* optimized_graph);
 
@@ -89,6 +94,10 @@ class MetaOptimizer : public GraphOptimizer {
 
   void PrintUserAndPluginConfigs(const std::set<string>& device_types) const;
 
+  // Runs all the optimizers over `item`, bypassing the optimized graph cache.
+  Status RunOptimizers(Cluster* cluster, GrapplerItem&& item,
+                       GraphDef* optimized_graph);
+
   // Run optimization pass over a single GrapplerItem. Meta optimizer might run
   // multiple such passes: 1) for the main graph 2) for the function library
   Status OptimizeGraph(
@@ -118,7 +127,10 @@ class MetaOptimizer : public GraphOptimizer {
                       GrapplerItem* optimized_item, GraphDef* optimized_graph,
                       GraphOptimizationResult* optimization_result);
 
-  std::vector<GraphOptimizationResult> optimization_results_;
+  // Functions in the library may be optimized concurrently.
+  mutable mutex optimization_results_mu_;
+  std::vector<GraphOptimizationResult> optimization_results_
+      TF_GUARDED_BY(optimization_results_mu_);
 };
 
 bool MetaOptimizerEnabled(const ConfigProto& cfg);
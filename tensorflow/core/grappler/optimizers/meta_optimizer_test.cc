@@ -32,8 +32,10 @@ limitations under the License.
 #include "tensorflow/core/grappler/utils/grappler_test.h"
 #include "tensorflow/core/lib/core/status_test_util.h"
 #include "tensorflow/core/lib/gtl/map_util.h"
+#include "tensorflow/core/lib/io/path.h"
 #include "tensorflow/core/platform/protobuf.h"
 #include "tensorflow/core/platform/test.h"
+#include "tensorflow/core/platform/test_benchmark.h"
 #include "tensorflow/core/protobuf/config.pb.h"
 
 namespace tensorflow {
@@ -218,6 +220,46 @@ TEST_F(MetaOptimizerTest, RunsPluginOptimizer) {
   EXPECT_TRUE(TestOptimizer::IsOptimized());
 }
 
+TEST_F(MetaOptimizerTest, ReadsOptimizedGraphFromCache) {
+  TrivialTestGraphInputYielder fake_input(4, 1, 10, false, {kDevice});
+  GrapplerItem item;
+  ASSERT_TRUE(fake_input.NextItem(&item));
+
+  ConfigProto config_proto;
+  auto& rewriter_config =
+      *config_proto.mutable_graph_options()->mutable_rewrite_options();
+  rewriter_config.add_optimizers("TestOptimizer");
+  rewriter_config.set_min_graph_nodes(-1);
+  const string cache_dir =
+      io::JoinPath(testing::TmpDir(), "optimized_graph_cache");
+  int64_t undeleted_files, undeleted_dirs;
+  Env::Default()
+      ->DeleteRecursively(cache_dir, &undeleted_files, &undeleted_dirs)
+      .IgnoreError();
+  rewriter_config.set_experimental_optimized_graph_cache_dir(cache_dir);
+
+  // The first run optimizes the graph and populates the cache.
+  TestOptimizer::SetOptimized(false);
+  GraphDef output;
+  TF_EXPECT_OK(MetaOptimizer(nullptr, config_proto)
+                   .Optimize(nullptr, item, &output));
+  EXPECT_TRUE(TestOptimizer::IsOptimized());
+
+  // An identical item is read from the cache.
+  TestOptimizer::SetOptimized(false);
+  GraphDef cached_output;
+  TF_EXPECT_OK(MetaOptimizer(nullptr, config_proto)
+                   .Optimize(nullptr, item, &cached_output));
+  EXPECT_FALSE(TestOptimizer::IsOptimized());
+  CompareGraphs(output, cached_output);
+
+  // A different fetch set misses the cache.
+  item.fetch.pop_back();
+  TF_EXPECT_OK(MetaOptimizer(nullptr, config_proto)
+                   .Optimize(nullptr, item, &cached_output));
+  EXPECT_TRUE(TestOptimizer::IsOptimized());
+}
+
 TEST_F(MetaOptimizerTest, RunOptimizersTwice) {
   TrivialTestGraphInputYielder fake_input(4, 1, 10, false, {kDevice});
   GrapplerItem item;
@@ -726,6 +768,77 @@ class SleepingOptimizer : public CustomGraphOptimizer {
 
 REGISTER_GRAPH_OPTIMIZER(SleepingOptimizer);
 
+// Builds a graph that calls `num_funcs` independent functions, each a chain of
+// `func_size` Identity nodes.
+GrapplerItem MakeIndependentFunctionsItem(int num_funcs, int func_size) {
+  using test::function::NDef;
+  std::vector<FunctionDef> funcs;
+  std::vector<NodeDef> nodes = {
+      NDef("x", "Placeholder", {}, {{"dtype", DT_FLOAT}}, kDevice)};
+  GrapplerItem item;
+  item.id = "tf_graph";
+  for (int i = 0; i < num_funcs; ++i) {
+    const string func_name = absl::StrCat("MyIdentityChain", i);
+    std::vector<FunctionDefHelper::Node> func_nodes;
+    string input = "x";
+    for (int j = 0; j < func_size; ++j) {
+      const string node_name = absl::StrCat("id", j);
+      func_nodes.push_back({{node_name}, "Identity", {input}, {{"T", "$T"}}});
+      input = absl::StrCat(node_name, ":output:0");
+    }
+    FunctionDef func = FunctionDefHelper::Create(
+        func_name, {"x:T"}, {"z:T"}, {"T: {float, double}"}, func_nodes,
+        /*ret_def=*/{{"z", input}});
+    (*func.mutable_attr())["_noinline"].set_b(true);
+    funcs.push_back(func);
+    const string call_name = absl::StrCat("call", i);
+    nodes.push_back(
+        NDef(call_name, func_name, {"x"}, {{"T", DT_FLOAT}}, kDevice));
+    nodes.push_back(NDef(absl::StrCat("out", i), "Identity", {call_name},
+                         {{"T", DT_FLOAT}}, kDevice));
+    item.fetch.push_back(absl::StrCat("out", i));
+  }
+  item.graph = test::function::GDef(nodes, funcs);
+  return item;
+}
+
+Status OptimizeIndependentFunctions(const GrapplerItem& item, int num_threads,
+                                    GraphDef* output) {
+  ConfigProto config_proto;
+  auto& rewriter_config =
+      *config_proto.mutable_graph_options()->mutable_rewrite_options();
+  rewriter_config.set_meta_optimizer_iterations(RewriterConfig::ONE);
+  rewriter_config.add_optimizers("function");
+  rewriter_config.add_optimizers("dependency");
+  rewriter_config.set_min_graph_nodes(-1);
+  rewriter_config.set_experimental_function_optimization_threads(num_threads);
+  MetaOptimizer optimizer(nullptr, config_proto);
+  return optimizer.Optimize(nullptr, item, output);
+}
+
+TEST_F(MetaOptimizerTest, OptimizeFunctionLibraryInParallel) {
+  GrapplerItem item = MakeIndependentFunctionsItem(/*num_funcs=*/8,
+                                                   /*func_size=*/4);
+  GraphDef serial_output;
+  TF_ASSERT_OK(OptimizeIndependentFunctions(item, /*num_threads=*/1,
+                                            &serial_output));
+  GraphDef parallel_output;
+  TF_ASSERT_OK(OptimizeIndependentFunctions(item, /*num_threads=*/4,
+                                            &parallel_output));
+
+  FunctionLibraryDefinition serial_flib(OpRegistry::Global(),
+                                        serial_output.library());
+  FunctionLibraryDefinition parallel_flib(OpRegistry::Global(),
+                                          parallel_output.library());
+  ASSERT_EQ(serial_flib.num_functions(), parallel_flib.num_functions());
+  for (const string& func_name : serial_flib.ListFunctionNames()) {
+    const FunctionDef* parallel_func = parallel_flib.Find(func_name);
+    ASSERT_NE(parallel_func, nullptr) << func_name;
+    EXPECT_TRUE(FunctionDefsEqual(*serial_flib.Find(func_name), *parallel_func))
+        << func_name;
+  }
+}
+
 TEST_F(MetaOptimizerTest, OptimizerTimesOut) {
   TrivialTestGraphInputYielder fake_input(4, 1, 10, false, {kDevice});
   GrapplerItem item;
@@ -1407,6 +1520,23 @@ INSTANTIATE_TEST_SUITE_P(
       return test_name;
     });
 
+static void BM_OptimizeFunctionLibrary(::testing::benchmark::State& state) {
+  const int num_funcs = state.range(0);
+  const int num_threads = state.range(1);
+  GrapplerItem item = MakeIndependentFunctionsItem(num_funcs,
+                                                   /*func_size=*/100);
+  for (auto s : state) {
+    GraphDef output;
+    TF_CHECK_OK(OptimizeIndependentFunctions(item, num_threads, &output));
+  }
+}
+BENCHMARK(BM_OptimizeFunctionLibrary)
+    ->ArgPair(16, 1)
+    ->ArgPair(16, 4)
+    ->ArgPair(256, 1)
+    ->ArgPair(256, 4)
+    ->ArgPair(256, 16);
+
 }  // namespace
 }  // namespace grappler
 }  // namespace tensorflow
@@ -0,0 +1,195 @@
+/* Copyright 2022 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/grappler/optimizers/parallelism_tuner.h"
+
+#include <algorithm>
+#include <map>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "tensorflow/core/framework/attr_value.pb.h"
+#include "tensorflow/core/framework/node_def.pb.h"
+#include "tensorflow/core/framework/step_stats.pb.h"
+#include "tensorflow/core/grappler/clusters/cluster.h"
+#include "tensorflow/core/grappler/clusters/virtual_cluster.h"
+#include "tensorflow/core/grappler/grappler_item.h"
+#include "tensorflow/core/grappler/utils.h"
+#include "tensorflow/core/grappler/utils/topological_sort.h"
+#include "tensorflow/core/lib/core/errors.h"
+#include "tensorflow/core/protobuf/config.pb.h"
+#include "tensorflow/core/protobuf/device_properties.pb.h"
+
+namespace tensorflow {
+namespace grappler {
+
+const char kMaxIntraOpParallelismAttr[] = "_max_intra_op_parallelism";
+
+namespace {
+
+// Cost of an op, in nanoseconds, that is worth giving to a thread of its own.
+// Matches Sharder::kMinCostPerShard.
+constexpr int64_t kMinCostPerShard = 10000;
+
+// Returns the numbers of intra-op threads to simulate: the powers of 2 below
+// `num_cores` and `num_cores` itself.
+std::vector<int> IntraOpCandidates(int num_cores) {
+  std::vector<int> candidates;
+  for (int threads = 1; threads < num_cores; threads *= 2) {
+    candidates.push_back(threads);
+  }
+  candidates.push_back(num_cores);
+  return candidates;
+}
+
+// Simulates `item` on `devices`, with the CPUs limited to `num_cores` cores,
+// and returns the execution time of each node.
+Status SimulateNodeTimes(
+    const std::unordered_map<string, DeviceProperties>& devices,
+    const GrapplerItem& item, int num_cores,
+    std::unordered_map<string, Costs::Duration>* node_times) {
+  std::unordered_map<string, DeviceProperties> simulated_devices = devices;
+  for (auto& device : simulated_devices) {
+    if (device.second.type() == "CPU") {
+      device.second.set_num_cores(num_cores);
+    }
+  }
+  VirtualCluster vcluster(simulated_devices);
+  TF_RETURN_IF_ERROR(vcluster.Provision());
+  TF_RETURN_IF_ERROR(vcluster.Initialize(item));
+  RunMetadata metadata;
+  Status s = vcluster.Run(item.graph, item.feed, item.fetch, &metadata);
+  if (!s.ok() && s.code() != error::RESOURCE_EXHAUSTED) {
+    return s;
+  }
+  for (const auto& dev_stats : metadata.step_stats().dev_stats()) {
+    for (const auto& node_stats : dev_stats.node_stats()) {
+      (*node_times)[node_stats.node_name()] =
+          Costs::Duration(node_stats.op_end_rel_nanos());
+    }
+  }
+  return OkStatus();
+}
+
+}  // namespace
+
+Status ParallelismTuner::Optimize(Cluster* cluster, const GrapplerItem& item,
+                                  GraphDef* optimized_graph) {
+  if (cluster == nullptr || item.fetch.empty()) {
+    return errors::Aborted("Nothing to do.");
+  }
+  const std::unordered_map<string, DeviceProperties>& devices =
+      cluster->GetDevices();
+  int num_cores = 0;
+  for (const auto& device : devices) {
+    if (device.second.type() == "CPU") {
+      num_cores = std::max(num_cores, device.second.num_cores());
+    }
+  }
+  if (num_cores <= 1) {
+    return errors::Aborted("Nothing to do: no CPU with multiple cores.");
+  }
+
+  const std::vector<int> candidates = IntraOpCandidates(num_cores);
+  std::map<int, std::unordered_map<string, Costs::Duration>> node_times;
+  for (int intra : candidates) {
+    TF_RETURN_IF_ERROR(
+        SimulateNodeTimes(devices, item, intra, &node_times[intra]));
+  }
+
+  // The number of threads each node can keep busy, based on its single
+  // threaded execution time.
+  std::unordered_map<string, int> useful_threads;
+  for (const auto& node_time : node_times[1]) {
+    useful_threads[node_time.first] = static_cast<int>(std::max<int64_t>(
+        1, std::min<int64_t>(num_cores,
+                             node_time.second.count() / kMinCostPerShard)));
+  }
+  // Returns the execution time of `node` with `intra` intra-op threads
+  // available, of which it uses no more than it can keep busy.
+  const auto node_time = [&](const string& node, int intra) {
+    auto it = useful_threads.find(node);
+    if (it == useful_threads.end()) {
+      return Costs::Duration();
+    }
+    const int limit = std::min(intra, it->second);
+    int threads = 1;
+    for (int candidate : candidates) {
+      if (candidate <= limit) threads = candidate;
+    }
+    const auto& times = node_times[threads];
+    auto time = times.find(node);
+    return time == times.end() ? Costs::Duration() : time->second;
+  };
+
+  std::vector<const NodeDef*> topo_order;
+  TF_RETURN_IF_ERROR(ComputeTopologicalOrder(item.graph, &topo_order));
+
+  ParallelismRecommendation best;
+  best.step_time = Costs::Duration::infinity();
+  // Try the largest number of intra-op threads first, so that they win ties:
+  // fewer concurrent ops means less contention on the caches.
+  for (auto intra = candidates.rbegin(); intra != candidates.rend(); ++intra) {
+    const int inter = std::max(1, num_cores / *intra);
+    std::unordered_map<string, Costs::Duration> finish_times;
+    Costs::Duration total_work;
+    Costs::Duration critical_path;
+    for (const NodeDef* node : topo_order) {
+      Costs::Duration start;
+      for (const string& input : node->input()) {
+        auto it = finish_times.find(NodeName(input));
+        if (it != finish_times.end()) {
+          start = std::max(start, it->second);
+        }
+      }
+      const Costs::Duration time = node_time(node->name(), *intra);
+      const Costs::Duration finish = start + time;
+      finish_times[node->name()] = finish;
+      total_work += time;
+      critical_path = std::max(critical_path, finish);
+    }
+    const Costs::Duration step_time =
+        std::max(critical_path, Costs::Duration(total_work / inter));
+    VLOG(2) << "intra_op_parallelism_threads=" << *intra
+            << " inter_op_parallelism_threads=" << inter
+            << ": critical path " << critical_path << ", total work "
+            << total_work << ", estimated step time " << step_time;
+    if (step_time < best.step_time) {
+      best.intra_op_parallelism_threads = *intra;
+      best.inter_op_parallelism_threads = inter;
+      best.step_time = step_time;
+    }
+  }
+  recommendation_ = best;
+  LOG(INFO) << "Recommended intra_op_parallelism_threads="
+            << best.intra_op_parallelism_threads
+            << " inter_op_parallelism_threads="
+            << best.inter_op_parallelism_threads << " for graph " << item.id
+            << " (estimated step time " << best.step_time << ")";
+
+  *optimized_graph = item.graph;
+  for (NodeDef& node : *optimized_graph->mutable_node()) {
+    auto it = useful_threads.find(node.name());
+    if (it != useful_threads.end() &&
+        it->second < best.intra_op_parallelism_threads) {
+      (*node.mutable_attr())[kMaxIntraOpParallelismAttr].set_i(it->second);
+    }
+  }
+  return OkStatus();
+}
+
+}  // end namespace grappler
+}  // end namespace tensorflow
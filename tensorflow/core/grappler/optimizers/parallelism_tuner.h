@@ -0,0 +1,76 @@
+/* Copyright 2022 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_CORE_GRAPPLER_OPTIMIZERS_PARALLELISM_TUNER_H_
+#define TENSORFLOW_CORE_GRAPPLER_OPTIMIZERS_PARALLELISM_TUNER_H_
+
+#include "tensorflow/core/grappler/costs/cost_estimator.h"
+#include "tensorflow/core/grappler/optimizers/graph_optimizer.h"
+#include "tensorflow/core/lib/core/status.h"
+
+namespace tensorflow {
+namespace grappler {
+
+// Node attribute holding the maximum number of intra-op threads the node can
+// make good use of. The CPU device runs the kernel of the node under a
+// ScopedPerThreadMaxParallelism with that value.
+ABSL_CONST_INIT extern const char kMaxIntraOpParallelismAttr[];
+
+// Split of the CPU cores between intra-op and inter-op parallelism.
+struct ParallelismRecommendation {
+  int intra_op_parallelism_threads = 0;
+  int inter_op_parallelism_threads = 0;
+  // Estimated duration of a step with this split.
+  Costs::Duration step_time;
+};
+
+// Simulates the graph with the VirtualScheduler and the analytical cost model
+// for several splits of the CPU cores between intra-op and inter-op threads,
+// and recommends the split with the shortest estimated step time.
+//
+// The step time of a split with `intra` threads per op and `inter` concurrent
+// ops is estimated as max(critical path, total work / inter), where each op
+// uses at most as many of the `intra` threads as its cost can keep busy (see
+// Shard()). Nodes which can't make use of all the recommended intra-op threads
+// are annotated with kMaxIntraOpParallelismAttr.
+//
+// The thread pools are created with the session, so the recommendation is only
+// logged and available through recommendation(): it is up to the user to
+// apply it to the ConfigProto of the next session.
+class ParallelismTuner : public GraphOptimizer {
+ public:
+  ParallelismTuner() {}
+  ~ParallelismTuner() override {}
+
+  string name() const override { return "parallelism_tuner"; };
+
+  bool UsesFunctionLibrary() const override { return false; }
+
+  Status Optimize(Cluster* cluster, const GrapplerItem& item,
+                  GraphDef* optimized_graph) override;
+
+  // The recommendation made for the last optimized graph.
+  const ParallelismRecommendation& recommendation() const {
+    return recommendation_;
+  }
+
+ private:
+  ParallelismRecommendation recommendation_;
+};
+
+}  // end namespace grappler
+}  // end namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_GRAPPLER_OPTIMIZERS_PARALLELISM_TUNER_H_
@@ -0,0 +1,102 @@
+/* Copyright 2022 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/grappler/optimizers/parallelism_tuner.h"
+
+#include <memory>
+#include <unordered_map>
+
+#include "tensorflow/cc/ops/standard_ops.h"
+#include "tensorflow/core/framework/node_def.pb.h"
+#include "tensorflow/core/grappler/clusters/virtual_cluster.h"
+#include "tensorflow/core/grappler/grappler_item.h"
+#include "tensorflow/core/grappler/utils/grappler_test.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/test.h"
+#include "tensorflow/core/protobuf/device_properties.pb.h"
+
+namespace tensorflow {
+namespace grappler {
+namespace {
+
+class ParallelismTunerTest : public GrapplerTest {
+ protected:
+  static std::unique_ptr<VirtualCluster> CreateVirtualCluster(int num_cores) {
+    DeviceProperties cpu_device;
+    cpu_device.set_type("CPU");
+    cpu_device.set_frequency(1000);
+    cpu_device.set_num_cores(num_cores);
+    cpu_device.set_bandwidth(32);
+    cpu_device.set_memory_size(1024LL * 1024 * 1024 * 16);
+    std::unordered_map<string, DeviceProperties> devices;
+    devices["/job:localhost/replica:0/task:0/cpu:0"] = cpu_device;
+    return std::make_unique<VirtualCluster>(devices);
+  }
+};
+
+TEST_F(ParallelismTunerTest, LargeOpUsesAllCores) {
+  tensorflow::Scope s = tensorflow::Scope::NewRootScope();
+  Output x = ops::Variable(s.WithOpName("x").WithDevice("/cpu:0"),
+                           {1024, 1024}, DT_FLOAT);
+  Output matmul =
+      ops::MatMul(s.WithOpName("matmul").WithDevice("/cpu:0"), x, x);
+  Output c = ops::Const(s.WithOpName("c").WithDevice("/cpu:0"), 1.0f, {2});
+  Output add = ops::AddN(s.WithOpName("add").WithDevice("/cpu:0"), {c, c});
+
+  GrapplerItem item;
+  TF_ASSERT_OK(s.ToGraphDef(&item.graph));
+  item.fetch = {"matmul", "add"};
+
+  std::unique_ptr<VirtualCluster> cluster = CreateVirtualCluster(8);
+  ParallelismTuner tuner;
+  GraphDef output;
+  TF_ASSERT_OK(tuner.Optimize(cluster.get(), item, &output));
+
+  // The MatMul dominates the step, and scales with the number of threads.
+  EXPECT_EQ(8, tuner.recommendation().intra_op_parallelism_threads);
+  EXPECT_EQ(1, tuner.recommendation().inter_op_parallelism_threads);
+  EXPECT_GT(tuner.recommendation().step_time, Costs::Duration());
+
+  ASSERT_EQ(item.graph.node_size(), output.node_size());
+  for (const NodeDef& node : output.node()) {
+    if (node.name() == "matmul") {
+      EXPECT_EQ(0, node.attr().count(kMaxIntraOpParallelismAttr));
+    } else if (node.name() == "add") {
+      // The AddN is too small to be split between threads.
+      ASSERT_EQ(1, node.attr().count(kMaxIntraOpParallelismAttr));
+      EXPECT_EQ(1, node.attr().at(kMaxIntraOpParallelismAttr).i());
+    }
+  }
+}
+
+TEST_F(ParallelismTunerTest, SingleCore) {
+  tensorflow::Scope s = tensorflow::Scope::NewRootScope();
+  Output c = ops::Const(s.WithOpName("c").WithDevice("/cpu:0"), 1.0f, {2});
+  Output add = ops::AddN(s.WithOpName("add").WithDevice("/cpu:0"), {c, c});
+
+  GrapplerItem item;
+  TF_ASSERT_OK(s.ToGraphDef(&item.graph));
+  item.fetch = {"add"};
+
+  std::unique_ptr<VirtualCluster> cluster = CreateVirtualCluster(1);
+  ParallelismTuner tuner;
+  GraphDef output;
+  EXPECT_EQ(error::ABORTED,
+            tuner.Optimize(cluster.get(), item, &output).code());
+}
+
+}  // namespace
+}  // namespace grappler
+}  // namespace tensorflow
@@ -0,0 +1,324 @@
+/* Copyright 2022 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/grappler/optimizers/pipeline_parallel.h"
+
+#include <algorithm>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+#include "tensorflow/core/framework/attr_value.pb.h"
+#include "tensorflow/core/framework/node_def.pb.h"
+#include "tensorflow/core/framework/node_def_util.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_shape.pb.h"
+#include "tensorflow/core/grappler/clusters/cluster.h"
+#include "tensorflow/core/grappler/costs/graph_properties.h"
+#include "tensorflow/core/grappler/costs/op_level_cost_estimator.h"
+#include "tensorflow/core/grappler/grappler_item.h"
+#include "tensorflow/core/grappler/op_types.h"
+#include "tensorflow/core/grappler/utils.h"
+#include "tensorflow/core/grappler/utils/topological_sort.h"
+#include "tensorflow/core/lib/core/errors.h"
+#include "tensorflow/core/lib/strings/strcat.h"
+#include "tensorflow/core/protobuf/device_properties.pb.h"
+
+namespace tensorflow {
+namespace grappler {
+namespace {
+
+string MicroBatchNodeName(const string& name, int micro_batch) {
+  return strings::StrCat(name, "/micro_batch_", micro_batch);
+}
+
+string SplitNodeName(const string& feed) {
+  return strings::StrCat(feed, "/micro_batch_split");
+}
+
+// Returns the input string for output `port` of `node`.
+string InputName(const string& node, int port) {
+  if (port < 0) return AsControlDependency(node);
+  if (port == 0) return node;
+  return strings::StrCat(node, ":", port);
+}
+
+// Returns true if the pass must not change the device of `node`.
+bool IsPinned(const NodeDef& node) {
+  if (IsVariable(node) || node.attr().count(kColocationAttrName) > 0) {
+    return true;
+  }
+  return !node.device().empty() && !NodeIsOnGpu(&node);
+}
+
+NodeDef MakeAxisNode(const string& name, const string& device) {
+  NodeDef node;
+  node.set_name(name);
+  node.set_op("Const");
+  node.set_device(device);
+  (*node.mutable_attr())["dtype"].set_type(DT_INT32);
+  Tensor axis(DT_INT32, TensorShape({}));
+  axis.scalar<int32>()() = 0;
+  axis.AsProtoTensorContent((*node.mutable_attr())["value"].mutable_tensor());
+  return node;
+}
+
+Costs::Duration NodeCost(const OpLevelCostEstimator& estimator,
+                         const GraphProperties& properties,
+                         const DeviceProperties& device, const NodeDef& node) {
+  OpContext op_context;
+  op_context.name = node.name();
+  op_context.device_name = node.device();
+  OpInfo& op_info = op_context.op_info;
+  op_info.set_op(node.op());
+  *op_info.mutable_attr() = node.attr();
+  for (const auto& input : properties.GetInputProperties(node.name())) {
+    *op_info.add_inputs() = input;
+  }
+  for (const auto& output : properties.GetOutputProperties(node.name())) {
+    *op_info.add_outputs() = output;
+  }
+  *op_info.mutable_device() = device;
+  return estimator.PredictCosts(op_context).execution_time;
+}
+
+// Returns OK if the nodes in `batch_nodes` can be cloned for each of
+// `num_micro_batches` micro-batches of `batch_feeds`.
+Status CanSplitMicroBatches(const GrapplerItem& item,
+                            const GraphProperties& properties,
+                            const std::unordered_set<string>& batch_feeds,
+                            const std::unordered_set<string>& batch_nodes,
+                            const std::unordered_set<string>& fetch_nodes,
+                            int num_micro_batches) {
+  for (const string& feed : batch_feeds) {
+    const TensorShapeProto& shape =
+        properties.GetOutputProperties(feed)[0].shape();
+    if (shape.dim(0).size() > 0 &&
+        shape.dim(0).size() % num_micro_batches != 0) {
+      return errors::InvalidArgument("Batch size ", shape.dim(0).size(),
+                                     " of ", feed, " is not a multiple of ",
+                                     num_micro_batches);
+    }
+  }
+  const std::unordered_set<string> nodes_to_preserve = item.NodesToPreserve();
+  for (const NodeDef& node : item.graph.node()) {
+    if (batch_nodes.count(node.name()) == 0) continue;
+    if (IsStateful(node) || IsControlFlow(node)) {
+      return errors::Unimplemented("Can't clone ", node.op(), " node ",
+                                   node.name());
+    }
+    if (nodes_to_preserve.count(node.name()) == 0) continue;
+    if (fetch_nodes.count(node.name()) == 0) {
+      return errors::Unimplemented("Can't clone preserved node ", node.name());
+    }
+    if (properties.GetOutputProperties(node.name()).size() != 1) {
+      return errors::Unimplemented("Can't concatenate outputs of fetch node ",
+                                   node.name());
+    }
+  }
+  return OkStatus();
+}
+
+}  // namespace
+
+Status PipelineParallel::Optimize(Cluster* cluster, const GrapplerItem& item,
+                                  GraphDef* optimized_graph) {
+  if (cluster == nullptr) {
+    return errors::Aborted("Nothing to do: no cluster.");
+  }
+  std::vector<string> gpus;
+  for (const auto& device : cluster->GetDevices()) {
+    if (device.second.type() == "GPU") gpus.push_back(device.first);
+  }
+  std::sort(gpus.begin(), gpus.end());
+  const int num_stages =
+      num_stages_ > 0 ? std::min<int>(num_stages_, gpus.size()) : gpus.size();
+  if (num_stages < 2) {
+    return errors::Aborted("Nothing to do: fewer than 2 GPUs.");
+  }
+  const DeviceProperties& gpu_properties = cluster->GetDevices().at(gpus[0]);
+
+  GraphProperties properties(item);
+  TF_RETURN_IF_ERROR(properties.InferStatically(/*assume_valid_feeds=*/false));
+  std::vector<const NodeDef*> topo_order;
+  TF_RETURN_IF_ERROR(ComputeTopologicalOrder(item.graph, &topo_order));
+
+  // The feeds with a batch dimension, and the nodes computed from them.
+  std::unordered_set<string> batch_feeds;
+  for (const auto& feed : item.feed) {
+    const string name = NodeName(feed.first);
+    if (!properties.HasOutputProperties(name)) continue;
+    const auto& outputs = properties.GetOutputProperties(name);
+    if (outputs.size() != 1) continue;
+    const TensorShapeProto& shape = outputs[0].shape();
+    if (!shape.unknown_rank() && shape.dim_size() > 0) batch_feeds.insert(name);
+  }
+  std::unordered_set<string> batch_nodes;
+  std::unordered_map<string, std::vector<string>> fanouts;
+  for (const NodeDef* node : topo_order) {
+    for (const string& input : node->input()) {
+      const string input_node = NodeName(input);
+      fanouts[input_node].push_back(node->name());
+      if (batch_feeds.count(node->name()) == 0 &&
+          (batch_feeds.count(input_node) > 0 ||
+           batch_nodes.count(input_node) > 0)) {
+        batch_nodes.insert(node->name());
+      }
+    }
+  }
+
+  // Cut the nodes computed from the batch (or all the nodes, if nothing is
+  // fed) into stages of about the same cost. Every node is assigned the stage
+  // holding the middle of its execution, so that the stages only feed later
+  // stages.
+  OpLevelCostEstimator estimator;
+  std::vector<const NodeDef*> balanced_nodes;
+  std::vector<double> costs;
+  double total_cost = 0;
+  for (const NodeDef* node : topo_order) {
+    if (IsPinned(*node)) continue;
+    if (!batch_nodes.empty() && batch_nodes.count(node->name()) == 0 &&
+        batch_feeds.count(node->name()) == 0) {
+      continue;
+    }
+    // Count every node for at least 1ns, so that the stages still get nodes
+    // when the costs can't be estimated.
+    const double cost = std::max<double>(
+        1, NodeCost(estimator, properties, gpu_properties, *node).count());
+    balanced_nodes.push_back(node);
+    costs.push_back(cost);
+    total_cost += cost;
+  }
+  std::unordered_map<string, int> stages;
+  std::vector<double> stage_costs(num_stages);
+  double cost_so_far = 0;
+  for (size_t i = 0; i < balanced_nodes.size(); ++i) {
+    const int stage = std::min(
+        num_stages - 1, static_cast<int>((cost_so_far + costs[i] / 2) *
+                                         num_stages / total_cost));
+    stages[balanced_nodes[i]->name()] = stage;
+    stage_costs[stage] += costs[i];
+    cost_so_far += costs[i];
+  }
+  // The other nodes, e.g. the weights, go with their first consumer.
+  for (auto it = topo_order.rbegin(); it != topo_order.rend(); ++it) {
+    const NodeDef* node = *it;
+    if (IsPinned(*node) || stages.count(node->name()) > 0) continue;
+    int stage = num_stages;
+    for (const string& fanout : fanouts[node->name()]) {
+      auto fanout_stage = stages.find(fanout);
+      if (fanout_stage != stages.end()) {
+        stage = std::min(stage, fanout_stage->second);
+      }
+    }
+    stages[node->name()] = stage < num_stages ? stage : 0;
+  }
+  for (int stage = 0; stage < num_stages; ++stage) {
+    VLOG(1) << "Pipeline stage " << stage << " on " << gpus[stage]
+            << ": estimated cost " << stage_costs[stage] << "ns";
+  }
+
+  GraphDef graph = item.graph;
+  std::unordered_map<string, const NodeDef*> nodes;
+  for (NodeDef& node : *graph.mutable_node()) {
+    auto stage = stages.find(node.name());
+    if (stage != stages.end()) node.set_device(gpus[stage->second]);
+    nodes[node.name()] = &node;
+  }
+
+  std::unordered_set<string> fetch_nodes;
+  for (const string& fetch : item.fetch) fetch_nodes.insert(NodeName(fetch));
+  if (num_micro_batches_ <= 1 || batch_nodes.empty()) {
+    *optimized_graph = std::move(graph);
+    return OkStatus();
+  }
+  const Status can_split =
+      CanSplitMicroBatches(item, properties, batch_feeds, batch_nodes,
+                           fetch_nodes, num_micro_batches_);
+  if (!can_split.ok()) {
+    VLOG(1) << "Not splitting the batch into micro-batches: " << can_split;
+    *optimized_graph = std::move(graph);
+    return OkStatus();
+  }
+
+  // Clone the nodes computed from the batch for every micro-batch, and
+  // concatenate the clones of the fetch nodes.
+  *optimized_graph->mutable_versions() = graph.versions();
+  *optimized_graph->mutable_library() = graph.library();
+  for (const NodeDef& node : graph.node()) {
+    if (batch_nodes.count(node.name()) == 0) {
+      *optimized_graph->add_node() = node;
+      continue;
+    }
+    for (int m = 0; m < num_micro_batches_; ++m) {
+      NodeDef* clone = optimized_graph->add_node();
+      *clone = node;
+      clone->set_name(MicroBatchNodeName(node.name(), m));
+      // The inferred shapes, if any, are those of the whole batch.
+      clone->mutable_attr()->erase("_output_shapes");
+      for (int i = 0; i < clone->input_size(); ++i) {
+        const TensorId input = ParseTensorName(clone->input(i));
+        const string input_node(input.node());
+        if (batch_feeds.count(input_node) > 0 && input.index() == 0) {
+          clone->set_input(i, InputName(SplitNodeName(input_node), m));
+        } else if (batch_nodes.count(input_node) > 0) {
+          clone->set_input(
+              i, InputName(MicroBatchNodeName(input_node, m), input.index()));
+        }
+      }
+    }
+    if (fetch_nodes.count(node.name()) > 0) {
+      const string axis_name =
+          strings::StrCat(node.name(), "/micro_batch_concat_axis");
+      *optimized_graph->add_node() = MakeAxisNode(axis_name, node.device());
+      NodeDef* concat = optimized_graph->add_node();
+      concat->set_name(node.name());
+      concat->set_op("ConcatV2");
+      concat->set_device(node.device());
+      for (int m = 0; m < num_micro_batches_; ++m) {
+        concat->add_input(MicroBatchNodeName(node.name(), m));
+      }
+      concat->add_input(axis_name);
+      auto* attr = concat->mutable_attr();
+      SetAttrValue(num_micro_batches_, &(*attr)["N"]);
+      SetAttrValue(properties.GetOutputProperties(node.name())[0].dtype(),
+                   &(*attr)["T"]);
+      SetAttrValue(DT_INT32, &(*attr)["Tidx"]);
+    }
+  }
+  for (const string& feed : batch_feeds) {
+    const string& device = nodes[feed]->device();
+    const string axis_name = strings::StrCat(SplitNodeName(feed), "_axis");
+    *optimized_graph->add_node() = MakeAxisNode(axis_name, device);
+    NodeDef* split = optimized_graph->add_node();
+    split->set_name(SplitNodeName(feed));
+    split->set_op("Split");
+    split->set_device(device);
+    split->add_input(axis_name);
+    split->add_input(feed);
+    auto* attr = split->mutable_attr();
+    SetAttrValue(num_micro_batches_, &(*attr)["num_split"]);
+    SetAttrValue(properties.GetOutputProperties(feed)[0].dtype(),
+                 &(*attr)["T"]);
+  }
+  VLOG(1) << "Split " << batch_feeds.size() << " feeds into "
+          << num_micro_batches_ << " micro-batches, cloning "
+          << batch_nodes.size() << " nodes";
+  return OkStatus();
+}
+
+}  // end namespace grappler
+}  // end namespace tensorflow
@@ -0,0 +1,65 @@
+/* Copyright 2022 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_CORE_GRAPPLER_OPTIMIZERS_PIPELINE_PARALLEL_H_
+#define TENSORFLOW_CORE_GRAPPLER_OPTIMIZERS_PIPELINE_PARALLEL_H_
+
+#include "tensorflow/core/grappler/optimizers/graph_optimizer.h"
+#include "tensorflow/core/lib/core/status.h"
+
+namespace tensorflow {
+namespace grappler {
+
+// Splits an inference graph into pipeline stages placed on different GPUs.
+//
+// The nodes are cut, in topological order, into `num_stages` contiguous
+// stages of about the same cost, as estimated by the OpLevelCostEstimator,
+// and stage k is placed on the k-th GPU. Nodes which don't depend on the feeds
+// (e.g. weights) are placed with their first consumer. Variables, nodes with
+// colocation constraints and nodes explicitly placed on other devices than
+// GPUs keep their device. The graph partitioner inserts the Send/Recv pairs
+// between the stages.
+//
+// The fed batch is then split into `num_micro_batches` micro-batches: the
+// nodes depending on the feeds are cloned for every micro-batch, and the
+// fetched tensors are concatenated back. Since every stage of a micro-batch
+// only waits for the previous stage of the same micro-batch, the GPUs work on
+// different micro-batches concurrently. This assumes that the examples of a
+// batch are processed independently, as is the case for most inference
+// graphs, and that the size of the fed batches is a multiple of
+// `num_micro_batches`.
+class PipelineParallel : public GraphOptimizer {
+ public:
+  // `num_stages` == 0 uses all the GPUs of the cluster.
+  PipelineParallel(int num_stages, int num_micro_batches)
+      : num_stages_(num_stages), num_micro_batches_(num_micro_batches) {}
+  ~PipelineParallel() override {}
+
+  string name() const override { return "pipeline_parallel"; };
+
+  bool UsesFunctionLibrary() const override { return false; }
+
+  Status Optimize(Cluster* cluster, const GrapplerItem& item,
+                  GraphDef* optimized_graph) override;
+
+ private:
+  int num_stages_;
+  int num_micro_batches_;
+};
+
+}  // end namespace grappler
+}  // end namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_GRAPPLER_OPTIMIZERS_PIPELINE_PARALLEL_H_
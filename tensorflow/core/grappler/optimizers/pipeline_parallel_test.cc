@@ -0,0 +1,144 @@
+/* Copyright 2022 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/grappler/optimizers/pipeline_parallel.h"
+
+#include <memory>
+#include <unordered_map>
+
+#include "tensorflow/cc/ops/standard_ops.h"
+#include "tensorflow/core/framework/node_def.pb.h"
+#include "tensorflow/core/framework/tensor_testutil.h"
+#include "tensorflow/core/grappler/clusters/virtual_cluster.h"
+#include "tensorflow/core/grappler/grappler_item.h"
+#include "tensorflow/core/grappler/utils/grappler_test.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/lib/strings/strcat.h"
+#include "tensorflow/core/platform/test.h"
+#include "tensorflow/core/protobuf/device_properties.pb.h"
+
+namespace tensorflow {
+namespace grappler {
+namespace {
+
+constexpr char kGpu0[] = "/job:localhost/replica:0/task:0/device:GPU:0";
+constexpr char kGpu1[] = "/job:localhost/replica:0/task:0/device:GPU:1";
+
+class PipelineParallelTest : public GrapplerTest {
+ protected:
+  static std::unique_ptr<VirtualCluster> CreateVirtualCluster(int num_gpus) {
+    std::unordered_map<string, DeviceProperties> devices;
+    DeviceProperties cpu_device;
+    cpu_device.set_type("CPU");
+    cpu_device.set_frequency(1000);
+    cpu_device.set_num_cores(4);
+    cpu_device.set_bandwidth(32);
+    devices["/job:localhost/replica:0/task:0/device:CPU:0"] = cpu_device;
+    for (int i = 0; i < num_gpus; ++i) {
+      DeviceProperties gpu_device;
+      gpu_device.set_type("GPU");
+      gpu_device.set_frequency(1000);
+      gpu_device.set_num_cores(60);
+      gpu_device.set_bandwidth(1024 * 1024 * 900);
+      gpu_device.set_memory_size(1024LL * 1024 * 1024 * 16);
+      devices[strings::StrCat("/job:localhost/replica:0/task:0/device:GPU:",
+                              i)] = gpu_device;
+    }
+    return std::make_unique<VirtualCluster>(devices);
+  }
+};
+
+TEST_F(PipelineParallelTest, SplitsStagesAndMicroBatches) {
+  tensorflow::Scope s = tensorflow::Scope::NewRootScope();
+  Output x = ops::Placeholder(s.WithOpName("x"), DT_FLOAT,
+                              ops::Placeholder::Shape({8, 64}));
+  Output w1 = ops::Const(s.WithOpName("w1"), 0.1f, {64, 64});
+  Output w2 = ops::Const(s.WithOpName("w2"), 0.2f, {64, 64});
+  Output a = ops::MatMul(s.WithOpName("a"), x, w1);
+  Output r = ops::Relu(s.WithOpName("r"), a);
+  Output b = ops::MatMul(s.WithOpName("b"), r, w2);
+  Output y = ops::Tanh(s.WithOpName("y"), b);
+
+  GrapplerItem item;
+  TF_ASSERT_OK(s.ToGraphDef(&item.graph));
+  item.fetch = {"y"};
+  item.feed = {{"x", GenerateRandomTensor<DT_FLOAT>({8, 64})}};
+
+  std::unique_ptr<VirtualCluster> cluster = CreateVirtualCluster(2);
+  PipelineParallel optimizer(/*num_stages=*/0, /*num_micro_batches=*/2);
+  GraphDef output;
+  TF_ASSERT_OK(optimizer.Optimize(cluster.get(), item, &output));
+
+  std::unordered_map<string, const NodeDef*> nodes;
+  for (const NodeDef& node : output.node()) nodes[node.name()] = &node;
+  EXPECT_EQ(0, nodes.count("a"));
+  EXPECT_EQ(0, nodes.count("b"));
+
+  ASSERT_EQ(1, nodes.count("x/micro_batch_split"));
+  EXPECT_EQ("Split", nodes["x/micro_batch_split"]->op());
+  EXPECT_EQ("x", nodes["x/micro_batch_split"]->input(1));
+
+  for (int m = 0; m < 2; ++m) {
+    const string a_name = strings::StrCat("a/micro_batch_", m);
+    const string b_name = strings::StrCat("b/micro_batch_", m);
+    ASSERT_EQ(1, nodes.count(a_name));
+    ASSERT_EQ(1, nodes.count(b_name));
+    EXPECT_EQ(m == 0 ? "x/micro_batch_split" : "x/micro_batch_split:1",
+              nodes[a_name]->input(0));
+    EXPECT_EQ("w1", nodes[a_name]->input(1));
+    EXPECT_EQ(strings::StrCat("r/micro_batch_", m), nodes[b_name]->input(0));
+    // The MatMuls dominate the cost, and end up in different stages.
+    EXPECT_EQ(kGpu0, nodes[a_name]->device());
+    EXPECT_EQ(kGpu1, nodes[b_name]->device());
+  }
+  // The weights are placed with their consumers.
+  EXPECT_EQ(kGpu0, nodes["w1"]->device());
+  EXPECT_EQ(kGpu1, nodes["w2"]->device());
+
+  ASSERT_EQ(1, nodes.count("y"));
+  EXPECT_EQ("ConcatV2", nodes["y"]->op());
+  ASSERT_EQ(3, nodes["y"]->input_size());
+  EXPECT_EQ("y/micro_batch_0", nodes["y"]->input(0));
+  EXPECT_EQ("y/micro_batch_1", nodes["y"]->input(1));
+
+  // The rewritten graph computes the same result.
+  for (NodeDef& node : *output.mutable_node()) node.clear_device();
+  auto tensors_expected = EvaluateNodes(item.graph, item.fetch, item.feed);
+  auto tensors = EvaluateNodes(output, item.fetch, item.feed);
+  ASSERT_EQ(1, tensors_expected.size());
+  ASSERT_EQ(1, tensors.size());
+  test::ExpectTensorNear<float>(tensors_expected[0], tensors[0], 1e-6);
+}
+
+TEST_F(PipelineParallelTest, SingleGpu) {
+  tensorflow::Scope s = tensorflow::Scope::NewRootScope();
+  Output x = ops::Placeholder(s.WithOpName("x"), DT_FLOAT,
+                              ops::Placeholder::Shape({8, 64}));
+  Output y = ops::Relu(s.WithOpName("y"), x);
+
+  GrapplerItem item;
+  TF_ASSERT_OK(s.ToGraphDef(&item.graph));
+  item.fetch = {"y"};
+
+  std::unique_ptr<VirtualCluster> cluster = CreateVirtualCluster(1);
+  PipelineParallel optimizer(/*num_stages=*/0, /*num_micro_batches=*/2);
+  GraphDef output;
+  EXPECT_EQ(error::ABORTED,
+            optimizer.Optimize(cluster.get(), item, &output).code());
+}
+
+}  // namespace
+}  // namespace grappler
+}  // namespace tensorflow
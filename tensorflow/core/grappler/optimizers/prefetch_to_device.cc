@@ -0,0 +1,254 @@
+/* Copyright 2022 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/grappler/optimizers/prefetch_to_device.h"
+
+#include <string>
+#include <unordered_set>
+
+#include "tensorflow/core/framework/attr_value.pb.h"
+#include "tensorflow/core/framework/function.h"
+#include "tensorflow/core/framework/node_def.pb.h"
+#include "tensorflow/core/framework/node_def_util.h"
+#include "tensorflow/core/framework/op.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/types.h"
+#include "tensorflow/core/grappler/grappler_item.h"
+#include "tensorflow/core/grappler/utils.h"
+#include "tensorflow/core/lib/core/errors.h"
+#include "tensorflow/core/lib/strings/strcat.h"
+
+namespace tensorflow {
+namespace grappler {
+namespace {
+
+constexpr char kCopyToDeviceDataset[] = "_CopyToDeviceDataset";
+constexpr char kPrefetchDataset[] = "PrefetchDataset";
+constexpr char kMakeIterator[] = "MakeIterator";
+// One element is consumed while the next one is copied.
+constexpr int64_t kDeviceBufferSize = 2;
+// Larger map functions are considered too expensive to move to the GPU.
+constexpr int kMaxOffloadedFunctionNodes = 16;
+
+bool IsIteratorGetNext(const NodeDef& node) {
+  return node.op() == "IteratorGetNext" || node.op() == "IteratorGetNextSync";
+}
+
+bool IsIterator(const NodeDef& node) {
+  return node.op() == "IteratorV2" || node.op() == "AnonymousIteratorV3";
+}
+
+bool IsMap(const NodeDef& node) {
+  return node.op() == "MapDataset" || node.op() == "ParallelMapDatasetV2";
+}
+
+// Returns true if `node` reads an output of the node called `name`.
+bool ReadsOutputOf(const NodeDef& node, const string& name) {
+  for (const string& input : node.input()) {
+    if (!IsControlInput(input) && NodeName(input) == name) return true;
+  }
+  return false;
+}
+
+// Returns true if the elements produced by the dataset `node` can be copied to
+// a device.
+bool HasCopyableTypes(const NodeDef& node) {
+  const auto it = node.attr().find("output_types");
+  if (it == node.attr().end() || it->second.list().type_size() == 0) {
+    return false;
+  }
+  for (int type : it->second.list().type()) {
+    if (!DataTypeCanUseMemcpy(static_cast<DataType>(type))) return false;
+  }
+  return true;
+}
+
+// Returns true if `function` is small, stateless, and only uses ops with a
+// kernel on `device`.
+bool CanRunOnDevice(const FunctionDef& function, const string& device) {
+  if (function.node_def_size() > kMaxOffloadedFunctionNodes) return false;
+  for (const NodeDef& node : function.node_def()) {
+    const OpDef* op_def = nullptr;
+    if (!OpRegistry::Global()->LookUpOpDef(node.op(), &op_def).ok() ||
+        op_def->is_stateful()) {
+      return false;
+    }
+    NodeDef placed_node = node;
+    placed_node.set_device(device);
+    if (!IsKernelRegisteredForNode(placed_node).ok()) return false;
+  }
+  return true;
+}
+
+void CopyShapesAndTypes(const NodeDef& from, NodeDef* to) {
+  for (const char* attr : {"output_shapes", "output_types"}) {
+    const auto it = from.attr().find(attr);
+    if (it != from.attr().end()) (*to->mutable_attr())[attr] = it->second;
+  }
+}
+
+string UniqueName(const string& name, const NodeMap& node_map) {
+  string unique_name = name;
+  for (int i = 1; node_map.NodeExists(unique_name); ++i) {
+    unique_name = strings::StrCat(name, "_", i);
+  }
+  return unique_name;
+}
+
+}  // namespace
+
+Status PrefetchToDevice::Optimize(Cluster* cluster, const GrapplerItem& item,
+                                  GraphDef* optimized_graph) {
+  *optimized_graph = item.graph;
+  NodeMap node_map(optimized_graph);
+  const std::unordered_set<string> nodes_to_preserve = item.NodesToPreserve();
+  FunctionLibraryDefinition function_library(OpRegistry::Global(),
+                                             item.graph.library());
+
+  int num_rewritten = 0;
+  const int num_nodes = optimized_graph->node_size();
+  for (int i = 0; i < num_nodes; ++i) {
+    NodeDef* get_next = optimized_graph->mutable_node(i);
+    if (!IsIteratorGetNext(*get_next) || !NodeIsOnCpu(get_next) ||
+        nodes_to_preserve.count(get_next->name()) > 0) {
+      continue;
+    }
+    // All the elements must be consumed on a single GPU.
+    string target_device;
+    bool single_gpu = true;
+    for (const NodeDef* fanout : node_map.GetOutputs(get_next->name())) {
+      if (!ReadsOutputOf(*fanout, get_next->name())) continue;
+      if (!NodeIsOnGpu(fanout) ||
+          (!target_device.empty() && fanout->device() != target_device)) {
+        single_gpu = false;
+        break;
+      }
+      target_device = fanout->device();
+    }
+    if (!single_gpu || target_device.empty()) continue;
+
+    // The iterator must only be initialized by MakeIterator and read by
+    // `get_next`.
+    NodeDef* iterator = node_map.GetNode(get_next->input(0));
+    if (iterator == nullptr || !IsIterator(*iterator) ||
+        iterator->device() != get_next->device() ||
+        nodes_to_preserve.count(iterator->name()) > 0) {
+      continue;
+    }
+    NodeDef* make_iterator = nullptr;
+    bool has_other_uses = false;
+    for (NodeDef* fanout : node_map.GetOutputs(iterator->name())) {
+      if (fanout == get_next) continue;
+      if (fanout->op() == kMakeIterator && make_iterator == nullptr &&
+          fanout->input_size() >= 2 &&
+          NodeName(fanout->input(1)) == iterator->name()) {
+        make_iterator = fanout;
+      } else {
+        has_other_uses = true;
+      }
+    }
+    if (make_iterator == nullptr || has_other_uses ||
+        nodes_to_preserve.count(make_iterator->name()) > 0) {
+      continue;
+    }
+    NodeDef* dataset = node_map.GetNode(make_iterator->input(0));
+    if (dataset == nullptr || !NodeIsOnCpu(dataset) ||
+        !HasCopyableTypes(*dataset)) {
+      continue;
+    }
+
+    // Move a trailing map transformation without captured inputs to the GPU
+    // if its function is cheap to run there.
+    NodeDef* offloaded_map = nullptr;
+    NodeDef* copy_input = dataset;
+    string copy_input_tensor = make_iterator->input(0);
+    if (IsMap(*dataset) && node_map.GetOutputs(dataset->name()).size() == 1 &&
+        dataset->attr().at("Targuments").list().type_size() == 0 &&
+        nodes_to_preserve.count(dataset->name()) == 0) {
+      const FunctionDef* function =
+          function_library.Find(dataset->attr().at("f").func().name());
+      NodeDef* map_input = node_map.GetNode(dataset->input(0));
+      if (function != nullptr && map_input != nullptr &&
+          HasCopyableTypes(*map_input) &&
+          CanRunOnDevice(*function, target_device)) {
+        offloaded_map = dataset;
+        copy_input = map_input;
+        copy_input_tensor = dataset->input(0);
+      }
+    }
+
+    NodeDef* copy = optimized_graph->add_node();
+    copy->set_name(UniqueName(
+        strings::StrCat(copy_input->name(), "/copy_to_device"), node_map));
+    copy->set_op(kCopyToDeviceDataset);
+    copy->set_device(copy_input->device());
+    copy->add_input(copy_input_tensor);
+    (*copy->mutable_attr())["target_device"].set_s(target_device);
+    CopyShapesAndTypes(*copy_input, copy);
+    node_map.AddNode(copy->name(), copy);
+    node_map.AddOutput(copy_input->name(), copy->name());
+
+    NodeDef* prefetch_input = copy;
+    if (offloaded_map != nullptr) {
+      node_map.UpdateInput(offloaded_map->name(), copy_input_tensor,
+                           copy->name());
+      offloaded_map->set_input(0, copy->name());
+      prefetch_input = offloaded_map;
+    }
+
+    const string prefetch_name = UniqueName(
+        strings::StrCat(get_next->name(), "/prefetch_to_device"), node_map);
+    NodeDef* buffer_size = optimized_graph->add_node();
+    buffer_size->set_name(strings::StrCat(prefetch_name, "/buffer_size"));
+    buffer_size->set_op("Const");
+    buffer_size->set_device(dataset->device());
+    (*buffer_size->mutable_attr())["dtype"].set_type(DT_INT64);
+    Tensor buffer_size_value(DT_INT64, TensorShape({}));
+    buffer_size_value.scalar<int64_t>()() = kDeviceBufferSize;
+    buffer_size_value.AsProtoTensorContent(
+        (*buffer_size->mutable_attr())["value"].mutable_tensor());
+    node_map.AddNode(buffer_size->name(), buffer_size);
+
+    NodeDef* prefetch = optimized_graph->add_node();
+    prefetch->set_name(prefetch_name);
+    prefetch->set_op(kPrefetchDataset);
+    prefetch->set_device(dataset->device());
+    prefetch->add_input(prefetch_input->name());
+    prefetch->add_input(buffer_size->name());
+    CopyShapesAndTypes(*dataset, prefetch);
+    node_map.AddNode(prefetch->name(), prefetch);
+    node_map.AddOutput(prefetch_input->name(), prefetch->name());
+    node_map.AddOutput(buffer_size->name(), prefetch->name());
+
+    node_map.UpdateInput(make_iterator->name(), make_iterator->input(0),
+                         prefetch->name());
+    make_iterator->set_input(0, prefetch->name());
+
+    // The elements are now produced on the GPU, and so must the iterator.
+    iterator->set_device(target_device);
+    make_iterator->set_device(target_device);
+    get_next->set_device(target_device);
+    ++num_rewritten;
+  }
+
+  VLOG(1) << "Prefetching " << num_rewritten << " iterators to GPUs";
+  if (num_rewritten == 0) {
+    return errors::Aborted("Nothing to do.");
+  }
+  return OkStatus();
+}
+
+}  // end namespace grappler
+}  // end namespace tensorflow
@@ -0,0 +1,53 @@
+/* Copyright 2022 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_CORE_GRAPPLER_OPTIMIZERS_PREFETCH_TO_DEVICE_H_
+#define TENSORFLOW_CORE_GRAPPLER_OPTIMIZERS_PREFETCH_TO_DEVICE_H_
+
+#include "tensorflow/core/grappler/optimizers/graph_optimizer.h"
+#include "tensorflow/core/lib/core/status.h"
+
+namespace tensorflow {
+namespace grappler {
+
+// Prefetches the elements of tf.data pipelines to the GPU which consumes them.
+//
+// When all the outputs of an IteratorGetNext op on the host are consumed on a
+// single GPU, this pass appends a _CopyToDeviceDataset, which copies the
+// elements to the GPU through pinned host buffers, and a PrefetchDataset to
+// the pipeline, and moves the iterator to the GPU. The copies then overlap
+// with the computation of the previous steps instead of delaying the
+// consumers.
+//
+// A trailing map transformation whose function is small, stateless and only
+// uses ops with GPU kernels is moved after the copy, so that it runs on the
+// GPU.
+class PrefetchToDevice : public GraphOptimizer {
+ public:
+  PrefetchToDevice() {}
+  ~PrefetchToDevice() override {}
+
+  string name() const override { return "prefetch_to_device"; };
+
+  bool UsesFunctionLibrary() const override { return false; }
+
+  Status Optimize(Cluster* cluster, const GrapplerItem& item,
+                  GraphDef* optimized_graph) override;
+};
+
+}  // end namespace grappler
+}  // end namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_GRAPPLER_OPTIMIZERS_PREFETCH_TO_DEVICE_H_
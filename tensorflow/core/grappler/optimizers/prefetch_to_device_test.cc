@@ -0,0 +1,126 @@
+/* Copyright 2022 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/grappler/optimizers/prefetch_to_device.h"
+
+#include <unordered_map>
+
+#include "tensorflow/core/framework/function_testlib.h"
+#include "tensorflow/core/framework/node_def.pb.h"
+#include "tensorflow/core/framework/tensor_testutil.h"
+#include "tensorflow/core/grappler/grappler_item.h"
+#include "tensorflow/core/grappler/utils/grappler_test.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace grappler {
+namespace {
+
+using test::function::NDef;
+
+constexpr char kCpu[] = "/job:localhost/replica:0/task:0/device:CPU:0";
+constexpr char kGpu[] = "/job:localhost/replica:0/task:0/device:GPU:0";
+
+class PrefetchToDeviceTest : public GrapplerTest {
+ protected:
+  // Creates a graph reading `range(10).map(XTimesTwo)` through an iterator on
+  // the CPU, and consuming the elements on `consumer_device`.
+  static GrapplerItem MakeItem(const string& consumer_device) {
+    GrapplerItem item;
+    item.graph = test::function::GDef(
+        {NDef("start", "Const", {},
+              {{"value", test::AsScalar<int64_t>(0)}, {"dtype", DT_INT64}},
+              kCpu),
+         NDef("stop", "Const", {},
+              {{"value", test::AsScalar<int64_t>(10)}, {"dtype", DT_INT64}},
+              kCpu),
+         NDef("step", "Const", {},
+              {{"value", test::AsScalar<int64_t>(1)}, {"dtype", DT_INT64}},
+              kCpu),
+         NDef("range", "RangeDataset", {"start", "stop", "step"},
+              {{"output_shapes", gtl::ArraySlice<TensorShape>{TensorShape({})}},
+               {"output_types", gtl::ArraySlice<DataType>{DT_INT64}}},
+              kCpu),
+         NDef("map", "MapDataset", {"range"},
+              {{"f", FunctionDefHelper::FunctionRef("XTimesTwo",
+                                                    {{"T", DT_INT64}})},
+               {"Targuments", gtl::ArraySlice<DataType>{}},
+               {"output_shapes", gtl::ArraySlice<TensorShape>{TensorShape({})}},
+               {"output_types", gtl::ArraySlice<DataType>{DT_INT64}}},
+              kCpu),
+         NDef("iterator", "IteratorV2", {},
+              {{"shared_name", "iterator"},
+               {"container", ""},
+               {"output_shapes", gtl::ArraySlice<TensorShape>{TensorShape({})}},
+               {"output_types", gtl::ArraySlice<DataType>{DT_INT64}}},
+              kCpu),
+         NDef("make_iterator", "MakeIterator", {"map", "iterator"}, {}, kCpu),
+         NDef("get_next", "IteratorGetNext", {"iterator", "^make_iterator"},
+              {{"output_shapes", gtl::ArraySlice<TensorShape>{TensorShape({})}},
+               {"output_types", gtl::ArraySlice<DataType>{DT_INT64}}},
+              kCpu),
+         NDef("y", "Identity", {"get_next"}, {{"T", DT_INT64}},
+              consumer_device)},
+        // FunctionLib
+        {
+            test::function::XTimesTwo(),
+        });
+    item.fetch = {"y"};
+    return item;
+  }
+};
+
+TEST_F(PrefetchToDeviceTest, PrefetchesToGpu) {
+  GrapplerItem item = MakeItem(kGpu);
+  PrefetchToDevice optimizer;
+  GraphDef output;
+  TF_ASSERT_OK(optimizer.Optimize(nullptr, item, &output));
+
+  std::unordered_map<string, const NodeDef*> nodes;
+  for (const NodeDef& node : output.node()) nodes[node.name()] = &node;
+
+  // XTimesTwo is polymorphic, so the map stays on the CPU.
+  ASSERT_EQ(1, nodes.count("map/copy_to_device"));
+  const NodeDef* copy = nodes["map/copy_to_device"];
+  EXPECT_EQ("_CopyToDeviceDataset", copy->op());
+  EXPECT_EQ(kCpu, copy->device());
+  ASSERT_EQ(1, copy->input_size());
+  EXPECT_EQ("map", copy->input(0));
+  EXPECT_EQ(kGpu, copy->attr().at("target_device").s());
+
+  ASSERT_EQ(1, nodes.count("get_next/prefetch_to_device"));
+  const NodeDef* prefetch = nodes["get_next/prefetch_to_device"];
+  EXPECT_EQ("PrefetchDataset", prefetch->op());
+  ASSERT_EQ(2, prefetch->input_size());
+  EXPECT_EQ("map/copy_to_device", prefetch->input(0));
+
+  EXPECT_EQ("get_next/prefetch_to_device", nodes["make_iterator"]->input(0));
+  EXPECT_EQ(kGpu, nodes["iterator"]->device());
+  EXPECT_EQ(kGpu, nodes["make_iterator"]->device());
+  EXPECT_EQ(kGpu, nodes["get_next"]->device());
+  EXPECT_EQ(kCpu, nodes["map"]->device());
+}
+
+TEST_F(PrefetchToDeviceTest, CpuConsumer) {
+  GrapplerItem item = MakeItem(kCpu);
+  PrefetchToDevice optimizer;
+  GraphDef output;
+  EXPECT_EQ(error::ABORTED, optimizer.Optimize(nullptr, item, &output).code());
+}
+
+}  // namespace
+}  // namespace grappler
+}  // namespace tensorflow
@@ -16,8 +16,11 @@ limitations under the License.
 #include "tensorflow/core/grappler/optimizers/remapper.h"
 
 #include "absl/container/flat_hash_set.h"
+#include "absl/strings/strip.h"
 #include "tensorflow/core/framework/versions.pb.h"
+#include "tensorflow/core/grappler/clusters/utils.h"
 #include "tensorflow/core/grappler/costs/graph_properties.h"
+#include "tensorflow/core/grappler/costs/op_level_cost_estimator.h"
 #include "tensorflow/core/grappler/graph_view.h"
 #include "tensorflow/core/grappler/grappler_item.h"
 #include "tensorflow/core/grappler/op_types.h"
@@ -59,6 +62,14 @@ namespace grappler {
 //
 // Sigmoid + Mul -> _MklSwish  // This fusion only works on Intel CPU.
 //
+// Chains of element-wise ops on CPU -> _FusedElementwise, when the cost model
+// predicts fusion to save memory time.
+//
+// Gather + SparseSegment{Sum,Mean,SqrtN}:
+//   (1) GatherV2 -> SparseSegment* reading the gather params with composed
+//       indices, which avoids materializing the gathered rows.
+//   (2) ResourceGather on CPU -> _ResourceSparseSegmentReduction
+//
 //
 // In all cases, the supported activation functions are Relu, Relu6, and Elu.
 //
@@ -73,6 +84,9 @@ constexpr char kFusedDepthwiseConv2dNative[] = "_FusedDepthwiseConv2dNative";
 constexpr char kFusedBatchNormEx[] = "_FusedBatchNormEx";
 constexpr char kFusedBatchNormGradEx[] = "_FusedBatchNormGradEx";
 constexpr char kTensorToHashBucket[] = "_TensorToHashBucketFast";
+constexpr char kFusedElementwise[] = "_FusedElementwise";
+constexpr char kResourceSparseSegmentReduction[] =
+    "_ResourceSparseSegmentReduction";
 
 constexpr char kDataFormat[] = "data_format";
 constexpr char kIsTraining[] = "is_training";
@@ -143,6 +157,23 @@ struct TensorToHashBucket {
   int string_to_hash_bucket = kMissingIndex;
 };
 
+// Chain of element-wise ops that can be replaced with a _FusedElementwise op.
+// The nodes are ordered from the first op of the chain to its root, and
+// `chain_ports[i]` is the input port of `nodes[i]` that reads the value
+// flowing through the chain (for the first node, the input of the fused op).
+struct ElementwiseChain {
+  std::vector<int> nodes;
+  std::vector<int> chain_ports;
+};
+
+// GatherV2 or ResourceGather feeding into SparseSegment{Sum,Mean,SqrtN}, so
+// that the reduction can read its rows straight from the gather params.
+struct GatherWithSparseSegmentReduction {
+  int gather = kMissingIndex;
+  int reduction = kMissingIndex;
+  bool resource_gather = false;
+};
+
 // Pad followed by Conv3D/FusedConv3D
 struct PadWithConv3D {
   PadWithConv3D() = default;
@@ -1794,6 +1825,269 @@ bool FindTensorToHashBucket(const RemapperContext& ctx, int node_index,
   return true;
 }
 
+bool IsFusableUnaryElementwise(const NodeDef& node) {
+  return node.op() == "Abs" || IsExp(node) || IsNeg(node) || IsRelu(node) ||
+         IsSigmoid(node) || IsSquare(node) || IsTanh(node);
+}
+
+bool IsFusableBinaryElementwise(const NodeDef& node) {
+  return IsAdd(node) || IsMaximum(node) || IsMinimum(node) || IsMul(node) ||
+         IsSub(node);
+}
+
+// Returns true if `node_view` is an element-wise op that _FusedElementwise
+// supports, on CPU.
+bool IsFusableElementwiseNode(const utils::MutableNodeView& node_view) {
+  const NodeDef* node_def = node_view.node();
+  const bool is_unary = IsFusableUnaryElementwise(*node_def);
+  if (!is_unary && !IsFusableBinaryElementwise(*node_def)) return false;
+  if (node_view.NumRegularFanins() != (is_unary ? 1 : 2)) return false;
+  if (!HasDataType(node_def, DT_FLOAT) && !HasDataType(node_def, DT_DOUBLE))
+    return false;
+  return NodeIsOnCpu(node_def) && !HasControlFaninOrFanout(node_view);
+}
+
+// Element-wise ops that read the output of a contraction, bias add or batch
+// norm are left to the fusions of those ops.
+bool ReadsFusableContraction(const utils::MutableNodeView& node_view) {
+  for (const auto& fanin : node_view.GetRegularFanins()) {
+    const NodeDef* node_def = fanin.node_view()->node();
+    if (IsBiasAdd(*node_def) || IsConv2D(*node_def) || IsConv3D(*node_def) ||
+        IsDepthwiseConv2dNative(*node_def) || IsAnyMatMul(*node_def) ||
+        IsFusedBatchNorm(*node_def)) {
+      return true;
+    }
+  }
+  return false;
+}
+
+// Returns true if OpLevelCostEstimator predicts that fusing `chain` saves a
+// significant share of its execution time. Fusion does not change the
+// computation, but intermediate results no longer make a round trip through
+// memory, so the memory time of the chain shrinks to that of its inputs from
+// outside the chain and its output.
+bool FusionSavesMemoryTime(const RemapperContext& ctx,
+                           const ElementwiseChain& chain) {
+  static const DeviceProperties* cpu_device =
+      new DeviceProperties(GetLocalCPUInfo());
+  constexpr double kMinSavedFraction = 0.1;
+
+  const auto is_scalar = [](const OpInfo::TensorProperties& props) {
+    return !props.shape().unknown_rank() && props.shape().dim_size() == 0;
+  };
+
+  OpLevelCostEstimator estimator;
+  Costs::Duration compute_time;
+  Costs::Duration memory_time;
+  // Tensors of the shape of the chain read or written, before and after
+  // fusion. Scalars are negligible.
+  int unfused_accesses = 0;
+  int fused_accesses = 1;  // The output.
+  for (size_t i = 0; i < chain.nodes.size(); ++i) {
+    const NodeDef* node_def = ctx.graph_view.GetNode(chain.nodes[i])->node();
+    const auto& inputs =
+        ctx.graph_properties.GetInputProperties(node_def->name());
+    const auto& outputs =
+        ctx.graph_properties.GetOutputProperties(node_def->name());
+    OpContext op_context;
+    op_context.name = node_def->name();
+    op_context.device_name = node_def->device();
+    OpInfo& op_info = op_context.op_info;
+    op_info.set_op(node_def->op());
+    *op_info.mutable_attr() = node_def->attr();
+    for (const auto& input : inputs) *op_info.add_inputs() = input;
+    for (const auto& output : outputs) *op_info.add_outputs() = output;
+    *op_info.mutable_device() = *cpu_device;
+    const Costs costs = estimator.PredictCosts(op_context);
+    compute_time += costs.compute_time;
+    memory_time += costs.memory_time;
+
+    unfused_accesses += outputs.size();
+    for (size_t port = 0; port < inputs.size(); ++port) {
+      if (is_scalar(inputs[port])) continue;
+      ++unfused_accesses;
+      if (i == 0 || port != chain.chain_ports[i]) ++fused_accesses;
+    }
+  }
+  if (unfused_accesses == 0) return false;
+
+  const double saved_memory_time =
+      memory_time.count() * (1.0 - static_cast<double>(fused_accesses) /
+                                       unfused_accesses);
+  return saved_memory_time >=
+         kMinSavedFraction * (compute_time.count() + memory_time.count());
+}
+
+bool FindElementwiseChain(const RemapperContext& ctx, int node_index,
+                          ElementwiseChain* matched) {
+  if (!ctx.inferred_graph_properties || ctx.xla_auto_clustering_on) {
+    return false;
+  }
+
+  // Root of the pattern must be a supported element-wise op with a known
+  // (possibly symbolic) output shape, which every op of the chain must
+  // produce.
+  const auto* root_view = ctx.graph_view.GetNode(node_index);
+  const NodeDef* root_def = root_view->node();
+  if (!IsFusableElementwiseNode(*root_view) ||
+      ReadsFusableContraction(*root_view)) {
+    return false;
+  }
+  const auto& root_props =
+      ctx.graph_properties.GetOutputProperties(root_def->name());
+  if (root_props.empty() || !ShapeIsSymbolicallyDefined(root_props[0])) {
+    return false;
+  }
+  const TensorShapeProto& shape = root_props[0].shape();
+
+  const auto has_chain_shape = [&](const utils::MutableNodeView& node_view,
+                                   size_t port) -> bool {
+    const auto& props =
+        ctx.graph_properties.GetInputProperties(node_view.node()->name());
+    return port < props.size() &&
+           ShapesSymbolicallyEqual(props[port].shape(), shape);
+  };
+  const auto is_scalar_or_has_chain_shape =
+      [&](const utils::MutableNodeView& node_view, size_t port) -> bool {
+    const auto& props =
+        ctx.graph_properties.GetInputProperties(node_view.node()->name());
+    if (port >= props.size()) return false;
+    const TensorShapeProto& arg_shape = props[port].shape();
+    return (!arg_shape.unknown_rank() && arg_shape.dim_size() == 0) ||
+           ShapesSymbolicallyEqual(arg_shape, shape);
+  };
+
+  // Walk up the chain from the root, following the fanins that are fusable
+  // element-wise ops only read by the chain.
+  ElementwiseChain chain;
+  const utils::MutableNodeView* node_view = root_view;
+  while (true) {
+    chain.nodes.push_back(node_view->node_index());
+    const bool is_binary = node_view->NumRegularFanins() == 2;
+    // The chain can only flow into the first input of a Sub.
+    const int num_chain_ports =
+        is_binary && !IsSub(*node_view->node()) ? 2 : 1;
+    const utils::MutableNodeView* next = nullptr;
+    int chain_port = 0;
+    for (int port = 0; port < num_chain_ports && next == nullptr; ++port) {
+      const auto* fanin_view = node_view->GetRegularFanin(port).node_view();
+      const NodeDef* fanin_def = fanin_view->node();
+      if (IsFusableElementwiseNode(*fanin_view) &&
+          !ReadsFusableContraction(*fanin_view) &&
+          HaveSameDataType(fanin_def, root_def) &&
+          fanin_def->device() == root_def->device() &&
+          fanin_view->NumRegularFanouts() == 1 &&
+          !IsInPreserveSet(ctx, fanin_def) &&
+          has_chain_shape(*node_view, port)) {
+        next = fanin_view;
+        chain_port = port;
+      }
+    }
+    if (next == nullptr) {
+      // `node_view` is the first op of the chain. Its input from outside the
+      // chain must have the shape of the chain, and must be its first input
+      // unless the op is commutative.
+      if (has_chain_shape(*node_view, 0)) {
+        chain_port = 0;
+      } else if (num_chain_ports == 2 && has_chain_shape(*node_view, 1)) {
+        chain_port = 1;
+      } else {
+        return false;
+      }
+    }
+    chain.chain_ports.push_back(chain_port);
+    if (is_binary && !is_scalar_or_has_chain_shape(*node_view, 1 - chain_port))
+      return false;
+    if (next == nullptr) break;
+    node_view = next;
+  }
+  if (chain.nodes.size() < 2) return false;
+
+  std::reverse(chain.nodes.begin(), chain.nodes.end());
+  std::reverse(chain.chain_ports.begin(), chain.chain_ports.end());
+  if (!FusionSavesMemoryTime(ctx, chain)) return false;
+
+  *matched = std::move(chain);
+  return true;
+}
+
+bool FindGatherWithSparseSegmentReduction(
+    const RemapperContext& ctx, int node_index,
+    GatherWithSparseSegmentReduction* matched) {
+  // Root of the pattern must be a SparseSegment{Sum,Mean,SqrtN}.
+  const auto* node_view = ctx.graph_view.GetNode(node_index);
+  const auto* node_def = node_view->node();
+  if (!IsAnySparseSegmentReduction(*node_def) ||
+      HasControlFaninOrFanout(*node_view) || node_view->NumRegularFanins() < 3)
+    return false;
+
+  // Input to the reduction must be a gather, only used by the reduction.
+  const auto* gather_node_view = node_view->GetRegularFanin(0).node_view();
+  const auto* gather_node_def = gather_node_view->node();
+  const bool is_gather_v2 = gather_node_def->op() == "GatherV2";
+  const bool is_resource_gather = gather_node_def->op() == "ResourceGather";
+  if ((!is_gather_v2 && !is_resource_gather) ||
+      HasControlFaninOrFanout(*gather_node_view) ||
+      !HasAtMostOneFanoutAtPort0(*gather_node_view) ||
+      IsInPreserveSet(ctx, gather_node_def))
+    return false;
+
+  int batch_dims = 0;
+  if (TryGetNodeAttr(*gather_node_def, "batch_dims", &batch_dims) &&
+      batch_dims != 0)
+    return false;
+  const DataType gather_index_type =
+      GetDataTypeFromAttr(*gather_node_def, "Tindices");
+  if (gather_index_type != DT_INT32 && gather_index_type != DT_INT64)
+    return false;
+
+  // The gather indices must be a vector, so that the reduction indices select
+  // gather indices rather than slices of them.
+  if (!ctx.inferred_graph_properties) return false;
+  const auto& gather_props =
+      ctx.graph_properties.GetInputProperties(gather_node_def->name());
+  if (gather_props.size() < 2) return false;
+  const TensorShapeProto& gather_indices_shape = gather_props[1].shape();
+  if (gather_indices_shape.unknown_rank() ||
+      gather_indices_shape.dim_size() != 1)
+    return false;
+
+  if (is_gather_v2) {
+    // Gathering rows means gathering along axis 0. The reduction reads the
+    // params instead of the gathered rows, so it must not move to another
+    // device than the params.
+    if (gather_node_view->NumRegularFanins() != 3 ||
+        gather_node_def->device() != node_def->device())
+      return false;
+    const auto* axis_node_def = gather_node_view->GetRegularFanin(2)
+                                    .node_view()
+                                    ->node();
+    Tensor axis;
+    if (!IsConstant(*axis_node_def) ||
+        !axis.FromProto(axis_node_def->attr().at("value").tensor()) ||
+        axis.NumElements() != 1)
+      return false;
+    const int64_t axis_value = axis.dtype() == DT_INT32
+                                   ? axis.flat<int32>()(0)
+                                   : axis.flat<int64_t>()(0);
+    if (axis_value != 0) return false;
+  } else {
+    // _ResourceSparseSegmentReduction has only a CPU kernel, without
+    // num_segments, and takes both indices with the same type.
+    if (!NodeIsOnCpu(node_def) || !NodeIsOnCpu(gather_node_def) ||
+        node_view->NumRegularFanins() != 3 ||
+        GetDataTypeFromAttr(*node_def, "Tidx") != gather_index_type)
+      return false;
+    if (!HasDataType(node_def, DT_FLOAT) && !HasDataType(node_def, DT_DOUBLE))
+      return false;
+  }
+
+  matched->gather = gather_node_view->node_index();
+  matched->reduction = node_index;
+  matched->resource_gather = is_resource_gather;
+  return true;
+}
+
 bool FindFusedBatchMatMul(RemapperContext* ctx, int node_index,
                           std::map<string, int>* matched_nodes_map,
                           std::set<int>* remove_node_indices) {
@@ -2907,6 +3201,124 @@ Status AddTensorToHashBucketNode(RemapperContext* ctx,
   return OkStatus();
 }
 
+Status AddFusedElementwiseNode(RemapperContext* ctx,
+                               const ElementwiseChain& matched,
+                               std::vector<bool>* invalidated_nodes,
+                               std::vector<bool>* nodes_to_delete) {
+  const GraphDef* graph = ctx->graph_view.graph();
+  const NodeDef& first = graph->node(matched.nodes.front());
+  const NodeDef& root = graph->node(matched.nodes.back());
+  VLOG(2) << "Fuse chain of " << matched.nodes.size()
+          << " element-wise ops: first=" << first.name()
+          << " root=" << root.name();
+
+  NodeDef fused_op;
+  fused_op.set_name(root.name());
+  fused_op.set_op(kFusedElementwise);
+  fused_op.set_device(root.device());
+  fused_op.add_input(first.input(matched.chain_ports.front()));  // 0: x
+
+  std::vector<string> fused_ops;
+  int num_args = 0;
+  for (size_t i = 0; i < matched.nodes.size(); ++i) {
+    const NodeDef& node = graph->node(matched.nodes[i]);
+    fused_ops.push_back(node.op());
+    if (IsFusableBinaryElementwise(node)) {
+      fused_op.add_input(node.input(1 - matched.chain_ports[i]));  // 1+: args
+      ++num_args;
+    }
+  }
+
+  auto* attr = fused_op.mutable_attr();
+  (*attr)["T"] = root.attr().at("T");
+  SetAttrValue(num_args, &(*attr)["num_args"]);
+  SetAttrValue(fused_ops, &(*attr)["fused_ops"]);
+
+  utils::Mutation* mutation = ctx->graph_view.GetMutationBuilder();
+  Status status;
+  mutation->AddNode(std::move(fused_op), &status);
+  TF_RETURN_IF_ERROR(status);
+  TF_RETURN_IF_ERROR(mutation->Apply());
+
+  (*invalidated_nodes)[matched.nodes.back()] = true;
+  for (size_t i = 0; i + 1 < matched.nodes.size(); ++i) {
+    (*nodes_to_delete)[matched.nodes[i]] = true;
+  }
+
+  return OkStatus();
+}
+
+Status AddGatherWithSparseSegmentReductionNodes(
+    RemapperContext* ctx, const GatherWithSparseSegmentReduction& matched,
+    std::vector<bool>* invalidated_nodes, std::vector<bool>* nodes_to_delete) {
+  const GraphDef* graph = ctx->graph_view.graph();
+  const NodeDef& gather = graph->node(matched.gather);
+  const NodeDef& reduction = graph->node(matched.reduction);
+  VLOG(2) << "Fuse " << gather.op() << " with " << reduction.op() << ":"
+          << " gather=" << gather.name() << " reduction=" << reduction.name();
+
+  utils::Mutation* mutation = ctx->graph_view.GetMutationBuilder();
+  Status status;
+  if (matched.resource_gather) {
+    NodeDef fused_op;
+    fused_op.set_name(reduction.name());
+    fused_op.set_op(kResourceSparseSegmentReduction);
+    fused_op.set_device(reduction.device());
+    fused_op.add_input(gather.input(0));     // 0: resource
+    fused_op.add_input(gather.input(1));     // 1: gather_indices
+    fused_op.add_input(reduction.input(1));  // 2: indices
+    fused_op.add_input(reduction.input(2));  // 3: segment_ids
+
+    auto* attr = fused_op.mutable_attr();
+    (*attr)["dtype"] = gather.attr().at("dtype");
+    (*attr)["Tidx"] = gather.attr().at("Tindices");
+    if (reduction.attr().count("Tsegmentids")) {
+      (*attr)["Tsegmentids"] = reduction.attr().at("Tsegmentids");
+    }
+    SetAttrValue(absl::StripPrefix(reduction.op(), "SparseSegment"),
+                 &(*attr)["reduction"]);
+    mutation->AddNode(std::move(fused_op), &status);
+    TF_RETURN_IF_ERROR(status);
+  } else {
+    // Row i of the gathered tensor is row gather_indices[i] of the params, so
+    // the reduction reads rows gather_indices[indices] of the params.
+    NodeDef composed_indices;
+    composed_indices.set_name(
+        AddPrefixToNodeName("composed_indices", reduction.name()));
+    composed_indices.set_op("GatherV2");
+    composed_indices.set_device(gather.device());
+    composed_indices.add_input(gather.input(1));     // 0: params
+    composed_indices.add_input(reduction.input(1));  // 1: indices
+    composed_indices.add_input(gather.input(2));     // 2: axis
+
+    auto* composed_attr = composed_indices.mutable_attr();
+    (*composed_attr)["Tparams"] = gather.attr().at("Tindices");
+    if (reduction.attr().count("Tidx")) {
+      (*composed_attr)["Tindices"] = reduction.attr().at("Tidx");
+    } else {
+      SetAttrValue(DT_INT32, &(*composed_attr)["Tindices"]);
+    }
+    (*composed_attr)["Taxis"] = gather.attr().at("Taxis");
+    SetAttrValue(0, &(*composed_attr)["batch_dims"]);
+
+    NodeDef new_reduction = reduction;
+    new_reduction.set_input(0, gather.input(0));
+    new_reduction.set_input(1, composed_indices.name());
+    (*new_reduction.mutable_attr())["Tidx"] = gather.attr().at("Tindices");
+
+    mutation->AddNode(std::move(composed_indices), &status);
+    TF_RETURN_IF_ERROR(status);
+    mutation->AddNode(std::move(new_reduction), &status);
+    TF_RETURN_IF_ERROR(status);
+  }
+  TF_RETURN_IF_ERROR(mutation->Apply());
+
+  (*invalidated_nodes)[matched.reduction] = true;
+  (*nodes_to_delete)[matched.gather] = true;
+
+  return OkStatus();
+}
+
 Status AddFusedBatchMatMul(RemapperContext* ctx,
                            const std::map<string, int>& matched_nodes_map,
                            const std::set<int>& remove_node_indices,
@@ -3201,14 +3613,36 @@ bool RequiresInferredShapes(const RemapperContext& ctx, int node_index) {
     return false;
   };
 
+  // Candidate for a Gather + SparseSegment* fusion.
+  const auto is_gather_with_sparse_segment_reduction_candidate = [&]() -> bool {
+    if (!IsAnySparseSegmentReduction(*node_def)) return false;
+    if (node_view->NumRegularFanins() < 1) return false;
+    const auto* fanin_0_node_def =
+        node_view->GetRegularFanin(0).node_view()->node();
+    return fanin_0_node_def->op() == "GatherV2" ||
+           fanin_0_node_def->op() == "ResourceGather";
+  };
+
+  // Candidate for an element-wise chain fusion.
+  const auto is_elementwise_chain_candidate = [&]() -> bool {
+    if (!IsFusableElementwiseNode(*node_view)) return false;
+    for (const auto& fanin : node_view->GetRegularFanins()) {
+      if (IsFusableElementwiseNode(*fanin.node_view())) return true;
+    }
+    return false;
+  };
+
   if (IsMKLEnabled())
     return is_batch_norm_candidate() || is_batch_norm_fusion_candidate() ||
            IsContractionWithAdd(ctx, node_index) ||
-           is_relu_biasadd_conv_candidate();
+           is_relu_biasadd_conv_candidate() ||
+           is_gather_with_sparse_segment_reduction_candidate();
 
   return is_relu_biasadd_conv_candidate() || is_batch_norm_candidate() ||
          is_batch_norm_fusion_candidate() ||
-         is_batch_norm_grad_fusion_candidate();
+         is_batch_norm_grad_fusion_candidate() ||
+         is_elementwise_chain_candidate() ||
+         is_gather_with_sparse_segment_reduction_candidate();
 }
 }  // namespace
 
@@ -3425,6 +3859,27 @@ Status Remapper::Optimize(Cluster* cluster, const GrapplerItem& item,
       continue;
     }
 
+    // Remap chains of element-wise ops into the _FusedElementwise. oneDNN
+    // builds rely on their own element-wise fusions instead.
+    ElementwiseChain elementwise_chain;
+    if (allow_non_differentiable_rewrites && !IsMKLEnabled() &&
+        FindElementwiseChain(ctx, i, &elementwise_chain)) {
+      TF_RETURN_IF_ERROR(AddFusedElementwiseNode(
+          &ctx, elementwise_chain, &invalidated_nodes, &nodes_to_delete));
+      continue;
+    }
+
+    // Remap Gather+SparseSegment{Sum,Mean,SqrtN} into a reduction over the
+    // gather params. The fused resource variant has no gradient.
+    GatherWithSparseSegmentReduction gather_with_reduction;
+    if (FindGatherWithSparseSegmentReduction(ctx, i, &gather_with_reduction) &&
+        (allow_non_differentiable_rewrites ||
+         !gather_with_reduction.resource_gather)) {
+      TF_RETURN_IF_ERROR(AddGatherWithSparseSegmentReductionNodes(
+          &ctx, gather_with_reduction, &invalidated_nodes, &nodes_to_delete));
+      continue;
+    }
+
     // During inference, most of the inputs to FusedBatchNorm are constant, and
     // we can therefore replace the op with a much cheaper set of primitives.
     FusedBatchNorm fused_batch_norm;
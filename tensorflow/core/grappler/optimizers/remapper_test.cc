@@ -16,6 +16,7 @@ limitations under the License.
 #include "tensorflow/core/grappler/optimizers/remapper.h"
 
 #include "tensorflow/cc/ops/nn_ops_internal.h"
+#include "tensorflow/cc/ops/resource_variable_ops.h"
 #include "tensorflow/cc/ops/standard_ops.h"
 #include "tensorflow/core/framework/tensor_testutil.h"
 #include "tensorflow/core/framework/types.h"
@@ -1352,6 +1353,178 @@ TEST_F(RemapperTensorToHashBucketTest, I32) { RunTest<DT_INT32>(); }
 
 TEST_F(RemapperTensorToHashBucketTest, I64) { RunTest<DT_INT64>(); }
 
+TEST_F(RemapperTest, FuseElementwiseChain) {
+  if (IsMKLEnabled()) GTEST_SKIP() << "Fusion not available with oneDNN.";
+  using ::tensorflow::ops::Placeholder;
+
+  tensorflow::Scope s = tensorflow::Scope::NewRootScope();
+
+  auto shape = ops::Placeholder::Shape({8, 32, 64});
+  auto x = Placeholder(s.WithOpName("x"), DT_FLOAT, shape);
+  auto w = Placeholder(s.WithOpName("w"), DT_FLOAT, shape);
+  auto c = ops::Const(s.WithOpName("c"), 0.5f, {});
+
+  auto mul = ops::Mul(s.WithOpName("mul"), x, w);
+  auto add = ops::AddV2(s.WithOpName("add"), mul, c);
+  auto relu = ops::Relu(s.WithOpName("relu"), add);
+  auto gate = ops::Mul(s.WithOpName("gate"), x, relu);
+  auto fetch = ops::Identity(s.WithOpName("fetch"), gate);
+
+  auto x_t = GenerateRandomTensor<DT_FLOAT>({8, 32, 64});
+  auto w_t = GenerateRandomTensor<DT_FLOAT>({8, 32, 64});
+
+  GrapplerItem item;
+  item.fetch = {"fetch"};
+  item.feed = {{"x", x_t}, {"w", w_t}};
+  TF_ASSERT_OK(s.ToGraphDef(&item.graph));
+
+  // Place all nodes on CPU.
+  for (int i = 0; i < item.graph.node_size(); ++i) {
+    item.graph.mutable_node(i)->set_device("/device:CPU:0");
+  }
+
+  Remapper optimizer(RewriterConfig::ON);
+  GraphDef output;
+  TF_ASSERT_OK(optimizer.Optimize(nullptr, item, &output));
+
+  int found = 0;
+  for (const NodeDef& node : output.node()) {
+    EXPECT_NE(node.name(), "mul");
+    EXPECT_NE(node.name(), "add");
+    EXPECT_NE(node.name(), "relu");
+    if (node.name() == "gate") {
+      EXPECT_EQ(node.op(), "_FusedElementwise");
+      ASSERT_EQ(node.input_size(), 4);
+      EXPECT_EQ(node.input(0), "x");
+      EXPECT_EQ(node.input(1), "w");
+      EXPECT_EQ(node.input(2), "c");
+      EXPECT_EQ(node.input(3), "x");
+      EXPECT_EQ(node.attr().at("num_args").i(), 3);
+
+      const auto fused_ops = node.attr().at("fused_ops").list().s();
+      ASSERT_EQ(fused_ops.size(), 4);
+      EXPECT_EQ(fused_ops[0], "Mul");
+      EXPECT_EQ(fused_ops[1], "AddV2");
+      EXPECT_EQ(fused_ops[2], "Relu");
+      EXPECT_EQ(fused_ops[3], "Mul");
+      found++;
+    }
+  }
+  EXPECT_EQ(found, 1);
+
+  auto tensors_expected = EvaluateNodes(item.graph, item.fetch, item.feed);
+  ASSERT_EQ(tensors_expected.size(), 1);
+  auto tensors = EvaluateNodes(output, item.fetch, item.feed);
+  ASSERT_EQ(tensors.size(), 1);
+  test::ExpectTensorNear<float>(tensors[0], tensors_expected[0], 1e-6);
+}
+
+TEST_F(RemapperTest, FuseGatherWithSparseSegmentSum) {
+  using ::tensorflow::ops::Placeholder;
+
+  tensorflow::Scope s = tensorflow::Scope::NewRootScope();
+
+  auto params = Placeholder(s.WithOpName("params"), DT_FLOAT,
+                            ops::Placeholder::Shape({16, 8}));
+  auto gather_indices = ops::Const(s.WithOpName("gather_indices"),
+                                   {3, 1, 4, 1, 5, 9, 2, 6}, {8});
+  auto axis = ops::Const(s.WithOpName("axis"), 0, {});
+  auto gather =
+      ops::GatherV2(s.WithOpName("gather"), params, gather_indices, axis);
+  auto indices = ops::Const(s.WithOpName("indices"), {0, 2, 3, 7}, {4});
+  auto segment_ids = ops::Const(s.WithOpName("segment_ids"), {0, 0, 1, 1}, {4});
+  auto reduction = ops::SparseSegmentSum(s.WithOpName("reduction"), gather,
+                                         indices, segment_ids);
+  auto fetch = ops::Identity(s.WithOpName("fetch"), reduction);
+
+  auto params_t = GenerateRandomTensor<DT_FLOAT>({16, 8});
+
+  GrapplerItem item;
+  item.fetch = {"fetch"};
+  item.feed = {{"params", params_t}};
+  TF_ASSERT_OK(s.ToGraphDef(&item.graph));
+
+  for (int i = 0; i < item.graph.node_size(); ++i) {
+    item.graph.mutable_node(i)->set_device("/device:CPU:0");
+  }
+
+  Remapper optimizer(RewriterConfig::ON);
+  GraphDef output;
+  TF_ASSERT_OK(optimizer.Optimize(nullptr, item, &output));
+
+  int found = 0;
+  for (const NodeDef& node : output.node()) {
+    EXPECT_NE(node.name(), "gather");
+    if (node.name() == "reduction") {
+      EXPECT_EQ(node.op(), "SparseSegmentSum");
+      ASSERT_EQ(node.input_size(), 3);
+      EXPECT_EQ(node.input(0), "params");
+      EXPECT_EQ(node.input(1), "reduction/composed_indices");
+      EXPECT_EQ(node.input(2), "segment_ids");
+      found++;
+    } else if (node.name() == "reduction/composed_indices") {
+      EXPECT_EQ(node.op(), "GatherV2");
+      ASSERT_EQ(node.input_size(), 3);
+      EXPECT_EQ(node.input(0), "gather_indices");
+      EXPECT_EQ(node.input(1), "indices");
+      EXPECT_EQ(node.input(2), "axis");
+      found++;
+    }
+  }
+  EXPECT_EQ(found, 2);
+
+  auto tensors_expected = EvaluateNodes(item.graph, item.fetch, item.feed);
+  ASSERT_EQ(tensors_expected.size(), 1);
+  auto tensors = EvaluateNodes(output, item.fetch, item.feed);
+  ASSERT_EQ(tensors.size(), 1);
+  test::ExpectTensorNear<float>(tensors[0], tensors_expected[0], 1e-6);
+}
+
+TEST_F(RemapperTest, FuseResourceGatherWithSparseSegmentMean) {
+  using ::tensorflow::ops::Placeholder;
+
+  tensorflow::Scope s = tensorflow::Scope::NewRootScope();
+
+  auto var = ops::VarHandleOp(s.WithOpName("var"), DT_FLOAT, {16, 8});
+  auto gather_indices = Placeholder(s.WithOpName("gather_indices"), DT_INT32,
+                                    ops::Placeholder::Shape({8}));
+  auto gather = ops::ResourceGather(s.WithOpName("gather"), var,
+                                    gather_indices, DT_FLOAT);
+  auto indices = ops::Const(s.WithOpName("indices"), {0, 2, 3, 7}, {4});
+  auto segment_ids = ops::Const(s.WithOpName("segment_ids"), {0, 0, 1, 1}, {4});
+  auto reduction = ops::SparseSegmentMean(s.WithOpName("reduction"), gather,
+                                          indices, segment_ids);
+  auto fetch = ops::Identity(s.WithOpName("fetch"), reduction);
+
+  GrapplerItem item;
+  item.fetch = {"fetch"};
+  TF_ASSERT_OK(s.ToGraphDef(&item.graph));
+
+  for (int i = 0; i < item.graph.node_size(); ++i) {
+    item.graph.mutable_node(i)->set_device("/device:CPU:0");
+  }
+
+  Remapper optimizer(RewriterConfig::ON);
+  GraphDef output;
+  TF_ASSERT_OK(optimizer.Optimize(nullptr, item, &output));
+
+  int found = 0;
+  for (const NodeDef& node : output.node()) {
+    EXPECT_NE(node.name(), "gather");
+    if (node.name() == "reduction") {
+      EXPECT_EQ(node.op(), "_ResourceSparseSegmentReduction");
+      ASSERT_EQ(node.input_size(), 4);
+      EXPECT_EQ(node.input(0), "var");
+      EXPECT_EQ(node.input(1), "gather_indices");
+      EXPECT_EQ(node.input(2), "indices");
+      EXPECT_EQ(node.input(3), "segment_ids");
+      EXPECT_EQ(node.attr().at("reduction").s(), "Mean");
+      found++;
+    }
+  }
+  EXPECT_EQ(found, 1);
+}
+
 class RemapperFuseMatMulWithBiasTest : public RemapperTest {
  public:
   template <DataType DTYPE>
@@ -0,0 +1,160 @@
+/* Copyright 2022 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/grappler/optimizers/remote_gather_dedup.h"
+
+#include <string>
+#include <unordered_set>
+#include <vector>
+
+#include "tensorflow/core/framework/attr_value.pb.h"
+#include "tensorflow/core/framework/node_def.pb.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/types.h"
+#include "tensorflow/core/grappler/costs/graph_properties.h"
+#include "tensorflow/core/grappler/grappler_item.h"
+#include "tensorflow/core/grappler/utils.h"
+#include "tensorflow/core/lib/core/errors.h"
+#include "tensorflow/core/lib/strings/strcat.h"
+#include "tensorflow/core/util/device_name_utils.h"
+
+namespace tensorflow {
+namespace grappler {
+namespace {
+
+constexpr char kResourceGather[] = "ResourceGather";
+
+// Returns true if `gather` can look up unique ids instead of its indices.
+bool IsDedupCandidate(const NodeDef& gather, const NodeDef& indices,
+                      const GraphProperties& properties) {
+  if (gather.op() != kResourceGather || gather.device().empty() ||
+      indices.device().empty() ||
+      DeviceNameUtils::IsSameAddressSpace(gather.device(), indices.device())) {
+    return false;
+  }
+  const auto batch_dims = gather.attr().find("batch_dims");
+  if (batch_dims != gather.attr().end() && batch_dims->second.i() != 0) {
+    return false;
+  }
+  // Unique only takes vectors.
+  const auto& input_props = properties.GetInputProperties(gather.name());
+  return input_props.size() == 2 && !input_props[1].shape().unknown_rank() &&
+         input_props[1].shape().dim_size() == 1;
+}
+
+string UniqueName(const string& name, const NodeMap& node_map) {
+  string unique_name = name;
+  for (int i = 1; node_map.NodeExists(unique_name); ++i) {
+    unique_name = strings::StrCat(name, "_", i);
+  }
+  return unique_name;
+}
+
+}  // namespace
+
+Status RemoteGatherDedup::Optimize(Cluster* cluster, const GrapplerItem& item,
+                                   GraphDef* optimized_graph) {
+  *optimized_graph = item.graph;
+  GraphProperties properties(item);
+  TF_RETURN_IF_ERROR(properties.InferStatically(/*assume_valid_feeds=*/false));
+  NodeMap node_map(optimized_graph);
+  const std::unordered_set<string> nodes_to_preserve = item.NodesToPreserve();
+
+  int num_rewritten = 0;
+  const int num_nodes = optimized_graph->node_size();
+  for (int i = 0; i < num_nodes; ++i) {
+    NodeDef* gather = optimized_graph->mutable_node(i);
+    if (gather->op() != kResourceGather || gather->input_size() < 2 ||
+        nodes_to_preserve.count(gather->name()) > 0) {
+      continue;
+    }
+    const string indices_tensor = gather->input(1);
+    const NodeDef* indices = node_map.GetNode(indices_tensor);
+    if (indices == nullptr ||
+        !IsDedupCandidate(*gather, *indices, properties)) {
+      continue;
+    }
+    const string& local_device = indices->device();
+    const DataType index_type = gather->attr().at("Tindices").type();
+
+    NodeDef* unique = optimized_graph->add_node();
+    unique->set_name(UniqueName(
+        strings::StrCat(gather->name(), "/dedup/unique"), node_map));
+    unique->set_op("Unique");
+    unique->set_device(local_device);
+    unique->add_input(indices_tensor);
+    (*unique->mutable_attr())["T"].set_type(index_type);
+    (*unique->mutable_attr())["out_idx"].set_type(DT_INT32);
+    node_map.AddNode(unique->name(), unique);
+    node_map.AddOutput(NodeName(indices_tensor), unique->name());
+
+    NodeDef* axis = optimized_graph->add_node();
+    axis->set_name(UniqueName(
+        strings::StrCat(gather->name(), "/dedup/axis"), node_map));
+    axis->set_op("Const");
+    axis->set_device(local_device);
+    (*axis->mutable_attr())["dtype"].set_type(DT_INT32);
+    Tensor axis_value(DT_INT32, TensorShape({}));
+    axis_value.scalar<int32>()() = 0;
+    axis_value.AsProtoTensorContent(
+        (*axis->mutable_attr())["value"].mutable_tensor());
+    // The axis must be evaluated in the frame of the indices.
+    *axis->add_input() = AsControlDependency(NodeName(indices_tensor));
+    node_map.AddNode(axis->name(), axis);
+    node_map.AddOutput(NodeName(indices_tensor), axis->name());
+
+    NodeDef* expand = optimized_graph->add_node();
+    expand->set_name(UniqueName(
+        strings::StrCat(gather->name(), "/dedup/expand"), node_map));
+    expand->set_op("GatherV2");
+    expand->set_device(local_device);
+    expand->add_input(gather->name());
+    expand->add_input(strings::StrCat(unique->name(), ":1"));
+    expand->add_input(axis->name());
+    (*expand->mutable_attr())["Tparams"].set_type(
+        gather->attr().at("dtype").type());
+    (*expand->mutable_attr())["Tindices"].set_type(DT_INT32);
+    (*expand->mutable_attr())["Taxis"].set_type(DT_INT32);
+    (*expand->mutable_attr())["batch_dims"].set_i(0);
+    node_map.AddNode(expand->name(), expand);
+
+    // The consumers of the gathered rows read the expanded rows instead.
+    const auto& outputs = node_map.GetOutputs(gather->name());
+    const std::vector<NodeDef*> fanouts(outputs.begin(), outputs.end());
+    for (NodeDef* fanout : fanouts) {
+      for (int j = 0; j < fanout->input_size(); ++j) {
+        const string& input = fanout->input(j);
+        if (!IsControlInput(input) && NodeName(input) == gather->name()) {
+          fanout->set_input(j, expand->name());
+          node_map.UpdateInput(fanout->name(), gather->name(), expand->name());
+        }
+      }
+    }
+    node_map.AddOutput(gather->name(), expand->name());
+
+    node_map.UpdateInput(gather->name(), indices_tensor, unique->name());
+    gather->set_input(1, unique->name());
+    ++num_rewritten;
+  }
+
+  VLOG(1) << "Deduplicated the ids of " << num_rewritten << " remote gathers";
+  if (num_rewritten == 0) {
+    return errors::Aborted("Nothing to do.");
+  }
+  return OkStatus();
+}
+
+}  // end namespace grappler
+}  // end namespace tensorflow
@@ -0,0 +1,49 @@
+/* Copyright 2022 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_CORE_GRAPPLER_OPTIMIZERS_REMOTE_GATHER_DEDUP_H_
+#define TENSORFLOW_CORE_GRAPPLER_OPTIMIZERS_REMOTE_GATHER_DEDUP_H_
+
+#include "tensorflow/core/grappler/optimizers/graph_optimizer.h"
+#include "tensorflow/core/lib/core/status.h"
+
+namespace tensorflow {
+namespace grappler {
+
+// Deduplicates the ids of embedding lookups on remote parameter servers.
+//
+// A ResourceGather of a variable in another task, whose 1-D indices are
+// computed locally, is rewritten into a Unique of the indices, a
+// ResourceGather of the unique ids on the parameter server, and a GatherV2
+// which expands the gathered rows back to the original ids. The lookup
+// request then carries each id once, the parameter server copies each row
+// once, and the response holds each row once.
+class RemoteGatherDedup : public GraphOptimizer {
+ public:
+  RemoteGatherDedup() {}
+  ~RemoteGatherDedup() override {}
+
+  string name() const override { return "remote_gather_dedup"; };
+
+  bool UsesFunctionLibrary() const override { return false; }
+
+  Status Optimize(Cluster* cluster, const GrapplerItem& item,
+                  GraphDef* optimized_graph) override;
+};
+
+}  // end namespace grappler
+}  // end namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_GRAPPLER_OPTIMIZERS_REMOTE_GATHER_DEDUP_H_
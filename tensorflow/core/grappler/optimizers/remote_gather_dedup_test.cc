@@ -0,0 +1,111 @@
+/* Copyright 2022 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/grappler/optimizers/remote_gather_dedup.h"
+
+#include <unordered_map>
+
+#include "tensorflow/core/framework/function_testlib.h"
+#include "tensorflow/core/framework/node_def.pb.h"
+#include "tensorflow/core/framework/tensor_testutil.h"
+#include "tensorflow/core/grappler/grappler_item.h"
+#include "tensorflow/core/grappler/utils/grappler_test.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace grappler {
+namespace {
+
+using test::function::NDef;
+
+constexpr char kPs[] = "/job:ps/replica:0/task:0/device:CPU:0";
+constexpr char kWorker[] = "/job:worker/replica:0/task:0/device:CPU:0";
+
+class RemoteGatherDedupTest : public GrapplerTest {
+ protected:
+  // Creates a graph looking up `ids`, computed on the worker, in a variable
+  // on `var_device`.
+  static GrapplerItem MakeItem(const string& var_device, const Tensor& ids) {
+    GrapplerItem item;
+    item.graph = test::function::GDef(
+        {NDef("var", "VarHandleOp", {},
+              {{"dtype", DT_FLOAT},
+               {"shape", TensorShape({10, 4})},
+               {"container", ""},
+               {"shared_name", "var"}},
+              var_device),
+         NDef("ids", "Const", {}, {{"value", ids}, {"dtype", DT_INT64}},
+              kWorker),
+         NDef("gather", "ResourceGather", {"var", "ids"},
+              {{"dtype", DT_FLOAT},
+               {"Tindices", DT_INT64},
+               {"batch_dims", 0},
+               {"validate_indices", true}},
+              var_device),
+         NDef("y", "Identity", {"gather"}, {{"T", DT_FLOAT}}, kWorker)},
+        {});
+    item.fetch = {"y"};
+    return item;
+  }
+};
+
+TEST_F(RemoteGatherDedupTest, DeduplicatesRemoteIds) {
+  GrapplerItem item =
+      MakeItem(kPs, test::AsTensor<int64_t>({1, 2, 1, 1}, {4}));
+  RemoteGatherDedup optimizer;
+  GraphDef output;
+  TF_ASSERT_OK(optimizer.Optimize(nullptr, item, &output));
+
+  std::unordered_map<string, const NodeDef*> nodes;
+  for (const NodeDef& node : output.node()) nodes[node.name()] = &node;
+
+  ASSERT_EQ(1, nodes.count("gather/dedup/unique"));
+  const NodeDef* unique = nodes["gather/dedup/unique"];
+  EXPECT_EQ("Unique", unique->op());
+  EXPECT_EQ(kWorker, unique->device());
+  EXPECT_EQ("ids", unique->input(0));
+  EXPECT_EQ("gather/dedup/unique", nodes["gather"]->input(1));
+  EXPECT_EQ(kPs, nodes["gather"]->device());
+
+  ASSERT_EQ(1, nodes.count("gather/dedup/expand"));
+  const NodeDef* expand = nodes["gather/dedup/expand"];
+  EXPECT_EQ("GatherV2", expand->op());
+  EXPECT_EQ(kWorker, expand->device());
+  ASSERT_EQ(3, expand->input_size());
+  EXPECT_EQ("gather", expand->input(0));
+  EXPECT_EQ("gather/dedup/unique:1", expand->input(1));
+  EXPECT_EQ("gather/dedup/expand", nodes["y"]->input(0));
+}
+
+TEST_F(RemoteGatherDedupTest, LocalVariable) {
+  GrapplerItem item =
+      MakeItem(kWorker, test::AsTensor<int64_t>({1, 2, 1, 1}, {4}));
+  RemoteGatherDedup optimizer;
+  GraphDef output;
+  EXPECT_EQ(error::ABORTED, optimizer.Optimize(nullptr, item, &output).code());
+}
+
+TEST_F(RemoteGatherDedupTest, MatrixIndices) {
+  GrapplerItem item =
+      MakeItem(kPs, test::AsTensor<int64_t>({1, 2, 1, 1}, {2, 2}));
+  RemoteGatherDedup optimizer;
+  GraphDef output;
+  EXPECT_EQ(error::ABORTED, optimizer.Optimize(nullptr, item, &output).code());
+}
+
+}  // namespace
+}  // namespace grappler
+}  // namespace tensorflow
@@ -14,11 +14,15 @@ limitations under the License.
 ==============================================================================*/
 #include "tensorflow/core/grappler/optimizers/scoped_allocator_optimizer.h"
 
+#include <algorithm>
+
 #include "tensorflow/core/common_runtime/scoped_allocator.h"
 #include "tensorflow/core/common_runtime/scoped_allocator_mgr.h"
 #include "tensorflow/core/framework/graph.pb.h"
 #include "tensorflow/core/framework/node_def_builder.h"
 #include "tensorflow/core/framework/node_def_util.h"
+#include "tensorflow/core/framework/partial_tensor_shape.h"
+#include "tensorflow/core/framework/types.h"
 #include "tensorflow/core/graph/graph.h"
 #include "tensorflow/core/grappler/costs/graph_properties.h"
 #include "tensorflow/core/grappler/grappler_item.h"
@@ -888,7 +892,7 @@ class UnaryElementwiseRewriter : public ScopedAllocatorOptimizer::Rewriter {
 
 ScopedAllocatorOptimizer::ScopedAllocatorOptimizer(
     RewriterConfig::Toggle opt_level, const ScopedAllocatorOptions& opts)
-    : opt_level_(opt_level) {
+    : opt_level_(opt_level), max_bucket_bytes_(opts.max_bucket_bytes()) {
   VLOG(1) << "ScopedAllocatorOptimizer::ScopedAllocatorOptimizer";
   Rewriter* r = new UnaryElementwiseRewriter();
   to_delete_.push_back(r);
@@ -1121,7 +1125,8 @@ Status ScopedAllocatorOptimizer::ProcessGraphDef(
         // in the same Tree struct.  Split those groups into subgroups that
         // share identical loop nesting.
         status = ApplyToAll(root.get(), [this, rewriter, graph, &frame_view,
-                                         &op_name, invocation_count](Tree* t) {
+                                         &graph_properties, &op_name,
+                                         invocation_count](Tree* t) {
           VLOG(2) << "applied to tree node " << t->edge_ << " at depth "
                   << t->depth_ << " of size " << t->nodes_.size();
           if (t->nodes_.size() > 1) {
@@ -1129,13 +1134,19 @@ Status ScopedAllocatorOptimizer::ProcessGraphDef(
             PartitionByLoopStructure(frame_view, t->nodes_, &loop_groups);
             for (auto& lg : loop_groups) {
               if (lg.size() > 1) {
-                bool applied = false;
                 Status s = OrderNodeSet(&lg);
                 TF_RETURN_IF_ERROR(s);
-                VLOG(1) << "Applying Rewriter for " << op_name;
-                s = rewriter->Rewrite(this, invocation_count, graph, op_name,
-                                      lg, &applied);
-                LOG_WARNING_AND_RETURN_IF_ERROR(s);
+                std::vector<std::vector<NodeDef*>> buckets;
+                SplitIntoBuckets(lg, graph_properties, &buckets);
+                for (const auto& bucket : buckets) {
+                  if (bucket.size() <= 1) continue;
+                  bool applied = false;
+                  VLOG(1) << "Applying Rewriter for " << op_name
+                          << " to a bucket of size " << bucket.size();
+                  s = rewriter->Rewrite(this, invocation_count, graph, op_name,
+                                        bucket, &applied);
+                  LOG_WARNING_AND_RETURN_IF_ERROR(s);
+                }
               }
             }
           }
@@ -1204,6 +1215,40 @@ Status ScopedAllocatorOptimizer::OrderNodeSet(
   return OkStatus();
 }
 
+void ScopedAllocatorOptimizer::SplitIntoBuckets(
+    const std::vector<NodeDef*>& nodes, const GraphProperties& graph_properties,
+    std::vector<std::vector<NodeDef*>>* buckets) const {
+  if (max_bucket_bytes_ <= 0) {
+    buckets->push_back(nodes);
+    return;
+  }
+  // Fill the buckets from the end of the order, so that the collective with
+  // the highest instance_key, which typically reduces the gradient computed
+  // first, is in the first bucket.  All the devices order the collectives
+  // the same way, and so make the same buckets.
+  int64_t bucket_bytes = 0;
+  for (auto it = nodes.rbegin(); it != nodes.rend(); ++it) {
+    int64_t bytes = 0;
+    const auto& inputs = graph_properties.GetInputProperties((*it)->name());
+    if (!inputs.empty()) {
+      const PartialTensorShape shape(inputs[0].shape());
+      if (shape.IsFullyDefined()) {
+        bytes = shape.num_elements() * DataTypeSize(inputs[0].dtype());
+      }
+    }
+    if (buckets->empty() ||
+        (bucket_bytes > 0 && bucket_bytes + bytes > max_bucket_bytes_)) {
+      buckets->emplace_back();
+      bucket_bytes = 0;
+    }
+    buckets->back().push_back(*it);
+    bucket_bytes += bytes;
+  }
+  for (auto& bucket : *buckets) {
+    std::reverse(bucket.begin(), bucket.end());
+  }
+}
+
 }  // namespace grappler
 }  // namespace tensorflow
 
@@ -107,7 +107,14 @@ class ScopedAllocatorOptimizer : public GraphOptimizer {
 
   Status OrderNodeSet(std::vector<NodeDef*>* nodes) const;
 
+  // Splits the ordered "nodes" into buckets whose inputs hold at most
+  // max_bucket_bytes_ bytes, preserving the order within each bucket.
+  void SplitIntoBuckets(const std::vector<NodeDef*>& nodes,
+                        const GraphProperties& graph_properties,
+                        std::vector<std::vector<NodeDef*>>* buckets) const;
+
   RewriterConfig::Toggle opt_level_;
+  const int64_t max_bucket_bytes_;
   std::unordered_set<string> nodes_to_preserve_;
   OpNameSet op_name_set_;
   absl::flat_hash_map<string, Rewriter*> rewriters_;
@@ -596,6 +596,42 @@ TEST_F(ScopedAllocatorOptimizerTest, ConstInput) {
   }
   EXPECT_EQ(num_identity_ops, 2);
 }
+
+// Returns the number of _ScopedAllocator nodes made for 4 Abs ops of 16 bytes
+// each when the buckets hold at most `max_bucket_bytes` bytes.
+int NumScopedAllocatorsWithBuckets(int64_t max_bucket_bytes) {
+  Scope s = Scope::NewRootScope();
+  s = s.WithDevice("/job:localhost/replica:0/task:0/device:CPU:0");
+  GrapplerItem item;
+  for (int i = 0; i < 4; ++i) {
+    Output c = ops::Const<float>(s.WithOpName(strings::StrCat("c", i)),
+                                 {1.0, -2.0, 3.0, 4.0}, {2, 2});
+    Output a = ops::Abs(s.WithOpName(strings::StrCat("a", i)), c);
+    ops::Reshape(s.WithOpName(strings::StrCat("r", i)), a, {1, 4});
+  }
+  TF_CHECK_OK(s.ToGraphDef(&item.graph));
+
+  ScopedAllocatorOptions opts;
+  opts.add_enable_op("Abs");
+  opts.set_max_bucket_bytes(max_bucket_bytes);
+  ScopedAllocatorOptimizer sao(RewriterConfig::ON, opts);
+  GraphDef optimized_graph;
+  TF_CHECK_OK(sao.Optimize(nullptr /*cluster*/, item, &optimized_graph));
+
+  int num_scoped_allocators = 0;
+  for (const NodeDef& node : optimized_graph.node()) {
+    if (node.op() == "_ScopedAllocator") ++num_scoped_allocators;
+  }
+  return num_scoped_allocators;
+}
+
+// Test that the ops are split into buckets of at most max_bucket_bytes bytes.
+TEST_F(ScopedAllocatorOptimizerTest, Buckets) {
+  EXPECT_EQ(NumScopedAllocatorsWithBuckets(0), 1);
+  EXPECT_EQ(NumScopedAllocatorsWithBuckets(64), 1);
+  EXPECT_EQ(NumScopedAllocatorsWithBuckets(32), 2);
+  EXPECT_EQ(NumScopedAllocatorsWithBuckets(40), 2);
+}
 #endif  // ENABLE_MKL
 
 }  // namespace
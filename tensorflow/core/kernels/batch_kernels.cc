@@ -201,7 +201,7 @@ class BatchResource : public serving::BatchResourceBase {
 
   void ProcessFuncBatchImpl(
       const BatchTask& last_task, absl::Span<const Tensor> inputs,
-      std::vector<Tensor>* combined_outputs,
+      std::vector<Tensor>* combined_outputs, RequestCost* request_cost,
       std::function<void(const Status&)> done) const override {
     auto* last_task_context = last_task.context;
     FunctionLibraryRuntime::Options opts;
@@ -211,6 +211,7 @@ class BatchResource : public serving::BatchResourceBase {
     opts.stats_collector = last_task_context->stats_collector();
     opts.runner = last_task_context->runner();
     opts.run_all_kernels_inline = last_task_context->run_all_kernels_inline();
+    opts.request_cost = request_cost;
     // We do not set 'opts.rendezvous', since if the function is run multiple
     // times in parallel with the same rendezvous, a _Send node from one run
     // might be matched with a _Recv node of a different run. Not setting the
@@ -255,6 +256,9 @@ BatchFunctionKernel::BatchFunctionKernel(OpKernelConstruction* c)
     enable_large_batch_splitting_ = false;
     has_attribute_enable_large_batch_splitting_ = false;
   }
+  if (c->HasAttr("max_shape_buckets")) {
+    OP_REQUIRES_OK(c, c->GetAttr("max_shape_buckets", &max_shape_buckets_));
+  }
 
   // Helper function `SetAdaptiveBatchSchedulerOptions` calls
   // `OP_REQUIRES_OK`, which exits the current function upon error.
@@ -353,12 +357,33 @@ void BatchFunctionKernel::ComputeAsync(OpKernelContext* c, DoneCallback done) {
                            container_, shared_name_, &br, creator),
                        done);
   const Status status =
-      br->RegisterInput(random::New64(), c, batcher_queue_, done);
+      br->RegisterInput(random::New64(), c, GetBatcherQueue(c), done);
   br->Unref();
   OP_REQUIRES_OK_ASYNC(c, status, done);
   // Assume br calls done, so nothing to do here.
 }
 
+string BatchFunctionKernel::GetBatcherQueue(OpKernelContext* c) {
+  if (max_shape_buckets_ <= 0) return batcher_queue_;
+  OpInputList tensors;
+  if (!c->input_list("in_tensors", &tensors).ok()) return batcher_queue_;
+  string shapes;
+  for (const Tensor& tensor : tensors) {
+    // RegisterInput() rejects scalars.
+    if (tensor.dims() == 0) return batcher_queue_;
+    TensorShape shape = tensor.shape();
+    shape.RemoveDim(0);
+    absl::StrAppend(&shapes, shape.DebugString());
+  }
+  mutex_lock l(mu_);
+  if (shape_buckets_.size() >= static_cast<size_t>(max_shape_buckets_) &&
+      shape_buckets_.count(shapes) == 0) {
+    return batcher_queue_;
+  }
+  shape_buckets_.insert(shapes);
+  return absl::StrCat(batcher_queue_, "/shapes:", shapes);
+}
+
 Status BatchFunctionKernel::InstantiateFunction(
     OpKernelContext* c, FunctionLibraryRuntime::Handle* handle) const {
   // TODO(b/173748062): Merge this instantiation logic with PartitionedCall.
@@ -16,6 +16,8 @@ limitations under the License.
 #ifndef TENSORFLOW_CORE_KERNELS_BATCH_KERNELS_H_
 #define TENSORFLOW_CORE_KERNELS_BATCH_KERNELS_H_
 
+#include <unordered_set>
+
 #include "absl/types/optional.h"
 #include "tensorflow/core/framework/function.h"
 #include "tensorflow/core/framework/op_kernel.h"
@@ -81,6 +83,11 @@ class BatchFunctionKernel : public AsyncOpKernel {
   //   Read from corresponding attributes as long as they are set.
   void SetAdaptiveBatchSchedulerOptions(OpKernelConstruction* c,
                                         int32_t num_batch_threads);
+
+  // Returns the name of the batcher queue for the inputs of `c`, which has the
+  // shapes of the inputs appended if they get a shape bucket of their own.
+  string GetBatcherQueue(OpKernelContext* c);
+
   string container_;
   string shared_name_;
   string batcher_queue_;
@@ -95,9 +102,13 @@ class BatchFunctionKernel : public AsyncOpKernel {
   bool enable_large_batch_splitting_;
   bool has_attribute_enable_large_batch_splitting_;
   bool enable_adaptive_batch_threads_ = false;
+  int32 max_shape_buckets_ = 0;
 
   mutex mu_;
 
+  // The input shapes that have a shape bucket.
+  std::unordered_set<string> shape_buckets_ TF_GUARDED_BY(mu_);
+
   // Parameters for adaptive batch scheduler only.
   // Note 'num_batch_threads_' above is shared by two implementations of batch
   // scheduler.
@@ -205,6 +205,32 @@ const string& GetModelName(OpKernelContext* ctx) {
   return ctx->session_metadata()->name();
 }
 
+// Splits `input` along the 0th dimension into pieces of `sizes` rows that
+// share its buffer, so that no rows are copied. Returns false, leaving
+// `outputs` empty, if a piece would not be aligned (which the kernels reading
+// it may require) or `sizes` do not cover `input`; the caller copies then.
+bool SliceAlongFirstDimension(const Tensor& input,
+                              const std::vector<int64_t>& sizes,
+                              std::vector<Tensor>* outputs) {
+  if (input.dims() == 0) return false;
+  int64_t total_size = 0;
+  for (const int64_t size : sizes) total_size += size;
+  if (total_size != input.dim_size(0)) return false;
+
+  outputs->reserve(sizes.size());
+  int64_t start = 0;
+  for (const int64_t size : sizes) {
+    Tensor slice = input.Slice(start, start + size);
+    if (!slice.IsAligned()) {
+      outputs->clear();
+      return false;
+    }
+    outputs->push_back(std::move(slice));
+    start += size;
+  }
+  return true;
+}
+
 }  // namespace
 
 std::unique_ptr<BatchResourceBase::BatchTask>
@@ -433,6 +459,15 @@ Status BatchResourceBase::ConcatInputTensors(
   const int num_inputs = batch.task(0).inputs.size();
   concatenated_tensors->reserve(num_inputs);
 
+  // A batch of a single task without padding is its inputs; pass them to the
+  // batch function without copying.
+  if (batch.num_tasks() == 1 && padding_amount == 0) {
+    for (int i = 0; i < num_inputs; ++i) {
+      concatenated_tensors->push_back(batch.task(0).inputs.at(i));
+    }
+    return OkStatus();
+  }
+
   // Process each input one at a time (the typical case has just one).
   for (int i = 0; i < num_inputs; ++i) {
     // Concatenate the tasks ith input tensors into a big output tensor.
@@ -541,15 +576,17 @@ Status BatchResourceBase::ConcatInputTensors(
   for (int i = 0; i < num_input_tensors; ++i) {
     std::vector<Tensor> split_tensors;
     const Tensor& input_tensor = input_task.inputs[i];
-    // TODO(b/154140947):
-    // Figure out the optimal implementation of Split, by using
-    // 'Tensor::Slice' and eliminating unnecessary memcpy as much as possible.
-    const Status split_status = Split(input_task.context, input_tensor,
-                                      output_task_sizes, &split_tensors);
-    if (!split_status.ok()) {
-      return errors::Internal(
-          "When splitting input, Tensor split operation failed: ",
-          split_status.error_message());
+    // The pieces are copied into the batches they join anyway, so alias the
+    // input when possible instead of copying the rows twice.
+    if (!SliceAlongFirstDimension(input_tensor, output_task_sizes,
+                                  &split_tensors)) {
+      const Status split_status = Split(input_task.context, input_tensor,
+                                        output_task_sizes, &split_tensors);
+      if (!split_status.ok()) {
+        return errors::Internal(
+            "When splitting input, Tensor split operation failed: ",
+            split_status.error_message());
+      }
     }
     if (split_tensors.size() != output_task_sizes.size()) {
       return errors::Internal(
@@ -609,13 +646,20 @@ Status BatchResourceBase::SplitOutputTensors(
           "the 0th dimension sizes of the input tensors");
     }
 
+    // The outputs of the tasks alias the batched output when possible, which
+    // keeps its buffer alive until every task's output is released but saves
+    // copying each row.
     std::vector<Tensor> split_tensor;
-    const Status split_status = tensor::Split(
-        output_tensor, task_sizes_plus_optional_padding, &split_tensor);
-    DCHECK(split_status.ok()) << split_status.ToString();
-    if (!split_status.ok()) {
-      return errors::Internal("Tensor split operation failed: ",
-                              split_status.error_message());
+    if (!SliceAlongFirstDimension(output_tensor,
+                                  task_sizes_plus_optional_padding,
+                                  &split_tensor)) {
+      const Status split_status = tensor::Split(
+          output_tensor, task_sizes_plus_optional_padding, &split_tensor);
+      DCHECK(split_status.ok()) << split_status.ToString();
+      if (!split_status.ok()) {
+        return errors::Internal("Tensor split operation failed: ",
+                                split_status.error_message());
+      }
     }
     DCHECK_EQ(split_tensor.size(), task_sizes_plus_optional_padding.size());
     if (split_tensor.size() != task_sizes_plus_optional_padding.size()) {
@@ -655,6 +699,8 @@ void BatchResourceBase::ProcessFuncBatch(std::unique_ptr<BatchT> batch) const {
   const CostMeasurement::Context batching_context{/*is_per_query=*/false};
   std::vector<std::unique_ptr<CostMeasurement>> batch_cost_measurements =
       CreateCostMeasurements(batching_context);
+  // Collects the costs of running the batch function.
+  RequestCost batch_request_cost;
 
   auto& last_task = batch->task(batch->num_tasks() - 1);
   OpKernelContext* last_task_context = last_task.context;
@@ -666,11 +712,13 @@ void BatchResourceBase::ProcessFuncBatch(std::unique_ptr<BatchT> batch) const {
   bool cleanup_done = false;
   int64_t processed_size = batch->size();
   auto cleanup_fn = [&cleanup_done, &batch, &processed_size,
-                     &batch_cost_measurements](const Status& status) {
+                     &batch_cost_measurements,
+                     &batch_request_cost](const Status& status) {
     if (cleanup_done) {
       return;
     }
     SplitBatchCosts(batch_cost_measurements, processed_size, *batch);
+    SplitBatchRequestCost(batch_request_cost, processed_size, *batch);
     // Clear the measurements before unblocking the batch task, as measurements
     // are associated with the task's thread context.
     batch_cost_measurements.clear();
@@ -722,7 +770,8 @@ void BatchResourceBase::ProcessFuncBatch(std::unique_ptr<BatchT> batch) const {
   // library runtime will handle it now.
   finally.release();
   ProcessFuncBatchImpl(
-      last_task, args, &combined_outputs, [&](const Status& run_status) {
+      last_task, args, &combined_outputs, &batch_request_cost,
+      [&](const Status& run_status) {
         Status final_status;
         auto run_finally = gtl::MakeCleanup([&]() {
           // We do the cleanup here as an optimization, so that
@@ -927,5 +976,47 @@ void BatchResourceBase::SplitBatchCosts(
   }
 }
 
+void BatchResourceBase::SplitBatchRequestCost(
+    const RequestCost& batch_request_cost, const int64_t processed_size,
+    BatchT& batch) {
+  const absl::flat_hash_map<std::string, absl::Duration> costs =
+      batch_request_cost.GetCosts();
+  const absl::flat_hash_map<std::string, double> metrics =
+      batch_request_cost.GetMetrics();
+  if (costs.empty() && metrics.empty()) return;
+  if (batch.size() == 0 || processed_size == 0) {
+    LOG_EVERY_N_SEC(ERROR, 60)
+        << "Non-zero cost collected but the batch or processed size is 0.";
+    return;
+  }
+
+  for (int i = 0; i < batch.num_tasks(); i++) {
+    RequestCost* request_cost = batch.task(i).request_cost;
+    // Skip recording the cost if the request_cost is null.
+    if (!request_cost) continue;
+
+    const int64_t task_size = batch.task(i).size();
+    std::vector<std::pair<absl::string_view, absl::Duration>> task_costs;
+    std::vector<std::string> cost_names;
+    cost_names.reserve(2 * costs.size());
+    for (const auto& cost : costs) {
+      cost_names.push_back(absl::StrCat(cost.first, kWithSmearSuffix));
+      task_costs.emplace_back(cost_names.back(),
+                              cost.second / batch.size() * task_size);
+      cost_names.push_back(absl::StrCat(cost.first, kNoSmearSuffix));
+      task_costs.emplace_back(cost_names.back(),
+                              cost.second / processed_size * task_size);
+    }
+    request_cost->RecordCost(task_costs);
+
+    std::vector<std::pair<absl::string_view, double>> task_metrics;
+    for (const auto& metric : metrics) {
+      task_metrics.emplace_back(metric.first,
+                                metric.second * task_size / batch.size());
+    }
+    request_cost->RecordMetrics(task_metrics);
+  }
+}
+
 }  // namespace serving
 }  // namespace tensorflow
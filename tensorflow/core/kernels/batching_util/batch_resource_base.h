@@ -196,11 +196,21 @@ class BatchResourceBase : public ResourceBase {
       std::vector<std::unique_ptr<CostMeasurement>>& batch_cost_measurements,
       const int64_t processed_size, BatchT& batch);
 
+  // Splits the costs and metrics recorded into `batch_request_cost` while
+  // processing the batch to the request_cost of each task, e.g. the compute
+  // time of the kernels of the batch function. Costs are split the same way as
+  // in SplitBatchCosts; metrics are split proportionally to each task's size.
+  static void SplitBatchRequestCost(const RequestCost& batch_request_cost,
+                                    const int64_t processed_size,
+                                    BatchT& batch);
+
  private:
-  // Implementation of calling the process batch function.
+  // Implementation of calling the process batch function. The costs of
+  // running the function should be added to `request_cost`.
   virtual void ProcessFuncBatchImpl(
       const BatchResourceBase::BatchTask& last_task,
       absl::Span<const Tensor> inputs, std::vector<Tensor>* combined_outputs,
+      RequestCost* request_cost,
       std::function<void(const Status&)> done) const = 0;
 
   // Factory method for creating a BatchTask, overridable by subclasses.
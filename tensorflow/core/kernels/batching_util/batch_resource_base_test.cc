@@ -164,6 +164,33 @@ TEST(SplitBatchCostTest, SplitMultiCostTypes) {
                            Pair("test_gcu_no_smear", absl::Milliseconds(90))));
 }
 
+TEST(SplitBatchRequestCostTest, SplitCostsAndMetrics) {
+  BatchResourceBase::BatchT batch;
+  RequestCost cost1, cost2;
+  batch.AddTask(MakeBatchTask(/*task_size=*/1, &cost1));
+  batch.AddTask(MakeBatchTask(/*task_size=*/9, &cost2));
+  batch.Close();
+
+  RequestCost batch_request_cost;
+  batch_request_cost.RecordCost({{"op_compute", absl::Milliseconds(100)}});
+  batch_request_cost.RecordMetrics({{"op_output_bytes", 1000}});
+  BatchResourceBase::SplitBatchRequestCost(batch_request_cost,
+                                           /*processed_size=*/20, batch);
+
+  EXPECT_THAT(batch.task(0).request_cost->GetCosts(),
+              UnorderedElementsAre(
+                  Pair("op_compute_with_smear", absl::Milliseconds(10)),
+                  Pair("op_compute_no_smear", absl::Milliseconds(5))));
+  EXPECT_THAT(batch.task(0).request_cost->GetMetrics(),
+              UnorderedElementsAre(Pair("op_output_bytes", 100)));
+  EXPECT_THAT(batch.task(1).request_cost->GetCosts(),
+              UnorderedElementsAre(
+                  Pair("op_compute_with_smear", absl::Milliseconds(90)),
+                  Pair("op_compute_no_smear", absl::Milliseconds(45))));
+  EXPECT_THAT(batch.task(1).request_cost->GetMetrics(),
+              UnorderedElementsAre(Pair("op_output_bytes", 900)));
+}
+
 }  // namespace
 }  // namespace serving
 }  // namespace tensorflow
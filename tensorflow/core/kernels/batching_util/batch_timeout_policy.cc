@@ -0,0 +1,131 @@
+/* Copyright 2022 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/kernels/batching_util/batch_timeout_policy.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace tensorflow {
+namespace serving {
+namespace internal {
+namespace {
+
+// The weight of a new observation in the estimates.
+constexpr double kDecay = 0.1;
+
+// Batches are grown until the fixed cost of a batch is at most
+// 1 / kAmortizedFraction of its processing time.
+constexpr double kAmortizedFraction = 10;
+
+void UpdateMean(double value, double* mean) {
+  *mean += kDecay * (value - *mean);
+}
+
+}  // namespace
+
+BatchTimeoutPolicy::BatchTimeoutPolicy(int64_t target_latency_micros,
+                                       int64_t max_batch_timeout_micros,
+                                       size_t max_batch_size)
+    : target_latency_micros_(target_latency_micros),
+      max_batch_timeout_micros_(max_batch_timeout_micros),
+      max_max_batch_size_(max_batch_size),
+      batch_timeout_micros_(max_batch_timeout_micros),
+      max_batch_size_(max_batch_size) {}
+
+void BatchTimeoutPolicy::RecordArrival(uint64_t now_micros,
+                                       size_t task_size) {
+  if (!has_arrival_) {
+    has_arrival_ = true;
+    mean_task_size_ = task_size;
+  } else {
+    const double gap =
+        now_micros > last_arrival_micros_ ? now_micros - last_arrival_micros_
+                                          : 0;
+    UpdateMean(gap, &mean_arrival_gap_micros_);
+    UpdateMean(task_size, &mean_task_size_);
+  }
+  last_arrival_micros_ = std::max(last_arrival_micros_, now_micros);
+  Update();
+}
+
+void BatchTimeoutPolicy::RecordBatch(size_t batch_size,
+                                     int64_t processing_micros) {
+  const double size = batch_size;
+  const double micros = std::max<int64_t>(processing_micros, 0);
+  if (!has_batch_) {
+    has_batch_ = true;
+    mean_size_ = size;
+    mean_micros_ = micros;
+    mean_size_squared_ = size * size;
+    mean_size_micros_ = size * micros;
+  } else {
+    UpdateMean(size, &mean_size_);
+    UpdateMean(micros, &mean_micros_);
+    UpdateMean(size * size, &mean_size_squared_);
+    UpdateMean(size * micros, &mean_size_micros_);
+  }
+  Update();
+}
+
+void BatchTimeoutPolicy::Update() {
+  if (!has_batch_ || mean_size_ <= 0) return;
+
+  // Fits the processing time to a + c * batch_size.  Without enough spread
+  // in the batch sizes, the time is taken to be a fixed cost, which keeps
+  // batching, and thereby spreading the sizes.
+  double a = mean_micros_;
+  double c = 0;
+  const double variance = mean_size_squared_ - mean_size_ * mean_size_;
+  if (variance >= 1) {
+    const double slope =
+        (mean_size_micros_ - mean_size_ * mean_micros_) / variance;
+    if (slope >= 0) {
+      a = std::max(0.0, mean_micros_ - slope * mean_size_);
+      c = slope;
+    }
+  }
+
+  const double budget = target_latency_micros_ - a;
+  if (c > 0) {
+    max_batch_size_ = static_cast<size_t>(std::max(
+        1.0, std::min<double>(std::floor(budget / c), max_max_batch_size_)));
+  } else {
+    max_batch_size_ = max_max_batch_size_;
+  }
+
+  // Within a timeout t, the batch grows to about
+  // mean_task_size_ + rate * t, so t + a + c * (mean_task_size_ + rate * t)
+  // must stay within the target.
+  const double rate = mean_arrival_gap_micros_ > 0
+                          ? mean_task_size_ / mean_arrival_gap_micros_
+                          : 0;
+  double timeout = (budget - c * mean_task_size_) / (1 + c * rate);
+  const double amortized_size =
+      c > 0 ? std::min<double>((kAmortizedFraction - 1) * a / c,
+                               max_batch_size_)
+            : max_batch_size_;
+  if (a == 0) {
+    timeout = 0;
+  } else if (rate > 0) {
+    timeout = std::min(timeout, (amortized_size - mean_task_size_) / rate);
+  }
+  batch_timeout_micros_ = static_cast<int64_t>(std::max(
+      0.0, std::min<double>(timeout, max_batch_timeout_micros_)));
+}
+
+}  // namespace internal
+}  // namespace serving
+}  // namespace tensorflow
@@ -0,0 +1,87 @@
+/* Copyright 2022 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_CORE_KERNELS_BATCHING_UTIL_BATCH_TIMEOUT_POLICY_H_
+#define TENSORFLOW_CORE_KERNELS_BATCHING_UTIL_BATCH_TIMEOUT_POLICY_H_
+
+#include <cstddef>
+#include <cstdint>
+
+namespace tensorflow {
+namespace serving {
+namespace internal {
+// BatchTimeoutPolicy picks the batch timeout and the size at which an open
+// batch is closed, so that tasks meet a latency target at any request rate.
+//
+// It keeps exponentially weighted estimates of the task arrival rate and of a
+// linear model of the batch processing time, `a + c * batch_size`.  A task
+// that opens a batch waits for the timeout `t` and is then processed with the
+// tasks that arrived meanwhile, so the timeout is bounded by the largest `t`
+// for which `t + a + c * expected_batch_size(t)` stays within the target.
+// Batches are closed at the largest size whose processing time does, and are
+// not held longer than it takes to grow them to the size at which the fixed
+// cost `a` is amortized, i.e. is a tenth of the processing time; without a
+// fixed cost there is nothing to gain from waiting.  The timeout never
+// exceeds `max_batch_timeout_micros`.
+//
+// Until a batch has been processed, the maximum timeout and batch size are
+// used.
+//
+// This is an internal helper class of internal::Queue<TaskType>, which
+// serializes the calls.
+class BatchTimeoutPolicy {
+ public:
+  BatchTimeoutPolicy(int64_t target_latency_micros,
+                     int64_t max_batch_timeout_micros, size_t max_batch_size);
+
+  // Records a task of size `task_size` scheduled at `now_micros`.
+  void RecordArrival(uint64_t now_micros, size_t task_size);
+
+  // Records a batch of size `batch_size` that took `processing_micros` to
+  // process.
+  void RecordBatch(size_t batch_size, int64_t processing_micros);
+
+  int64_t batch_timeout_micros() const { return batch_timeout_micros_; }
+  size_t max_batch_size() const { return max_batch_size_; }
+
+ private:
+  // Recomputes the timeout and the batch size from the estimates.
+  void Update();
+
+  const int64_t target_latency_micros_;
+  const int64_t max_batch_timeout_micros_;
+  const size_t max_max_batch_size_;
+
+  int64_t batch_timeout_micros_;
+  size_t max_batch_size_;
+
+  // Arrival estimates.
+  bool has_arrival_ = false;
+  uint64_t last_arrival_micros_ = 0;
+  double mean_arrival_gap_micros_ = 0;
+  double mean_task_size_ = 0;
+
+  // Moments of the batch sizes and processing times.
+  bool has_batch_ = false;
+  double mean_size_ = 0;
+  double mean_micros_ = 0;
+  double mean_size_squared_ = 0;
+  double mean_size_micros_ = 0;
+};
+}  // namespace internal
+}  // namespace serving
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_KERNELS_BATCHING_UTIL_BATCH_TIMEOUT_POLICY_H_
@@ -0,0 +1,97 @@
+/* Copyright 2022 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/kernels/batching_util/batch_timeout_policy.h"
+
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace serving {
+namespace internal {
+namespace {
+
+// Feeds `policy` tasks of size 1 every `arrival_gap_micros`, and batches of
+// sizes 1 to 100 that take `fixed_micros + micros_per_task * size`.
+void Feed(int64_t arrival_gap_micros, int64_t fixed_micros,
+          int64_t micros_per_task, BatchTimeoutPolicy* policy) {
+  uint64_t now_micros = 0;
+  for (int i = 0; i < 1000; ++i) {
+    policy->RecordArrival(now_micros, 1);
+    now_micros += arrival_gap_micros;
+    const int size = 1 + i % 100;
+    policy->RecordBatch(size, fixed_micros + micros_per_task * size);
+  }
+}
+
+TEST(BatchTimeoutPolicyTest, UsesMaximumsUntilBatchesAreProcessed) {
+  BatchTimeoutPolicy policy(/*target_latency_micros=*/5000,
+                            /*max_batch_timeout_micros=*/10000,
+                            /*max_batch_size=*/1000);
+  EXPECT_EQ(10000, policy.batch_timeout_micros());
+  EXPECT_EQ(1000, policy.max_batch_size());
+  policy.RecordArrival(0, 1);
+  policy.RecordArrival(100, 1);
+  EXPECT_EQ(10000, policy.batch_timeout_micros());
+  EXPECT_EQ(1000, policy.max_batch_size());
+}
+
+TEST(BatchTimeoutPolicyTest, MeetsTarget) {
+  BatchTimeoutPolicy policy(/*target_latency_micros=*/5000,
+                            /*max_batch_timeout_micros=*/10000,
+                            /*max_batch_size=*/1000);
+  Feed(/*arrival_gap_micros=*/100, /*fixed_micros=*/1000,
+       /*micros_per_task=*/10, &policy);
+  // Batches of 400 take 5000 microseconds.
+  EXPECT_NEAR(400, policy.max_batch_size(), 1);
+  // The timeout plus the processing time of the tasks that arrive within it
+  // is the target.
+  const double timeout = policy.batch_timeout_micros();
+  EXPECT_NEAR(5000, timeout + 1000 + 10 * (1 + timeout / 100), 20);
+
+  // At higher rates, more tasks arrive within a timeout, which is therefore
+  // shorter.
+  BatchTimeoutPolicy busy_policy(/*target_latency_micros=*/5000,
+                                 /*max_batch_timeout_micros=*/10000,
+                                 /*max_batch_size=*/1000);
+  Feed(/*arrival_gap_micros=*/1, /*fixed_micros=*/1000,
+       /*micros_per_task=*/10, &busy_policy);
+  EXPECT_LT(busy_policy.batch_timeout_micros(), timeout / 5);
+  EXPECT_GT(busy_policy.batch_timeout_micros(), 0);
+}
+
+TEST(BatchTimeoutPolicyTest, RespectsMaximums) {
+  BatchTimeoutPolicy policy(/*target_latency_micros=*/1000000,
+                            /*max_batch_timeout_micros=*/2000,
+                            /*max_batch_size=*/50);
+  Feed(/*arrival_gap_micros=*/1000, /*fixed_micros=*/1000,
+       /*micros_per_task=*/10, &policy);
+  EXPECT_EQ(2000, policy.batch_timeout_micros());
+  EXPECT_EQ(50, policy.max_batch_size());
+}
+
+TEST(BatchTimeoutPolicyTest, NoTimeoutWithoutFixedCost) {
+  BatchTimeoutPolicy policy(/*target_latency_micros=*/5000,
+                            /*max_batch_timeout_micros=*/10000,
+                            /*max_batch_size=*/1000);
+  Feed(/*arrival_gap_micros=*/100, /*fixed_micros=*/0,
+       /*micros_per_task=*/10, &policy);
+  EXPECT_EQ(0, policy.batch_timeout_micros());
+  EXPECT_NEAR(500, policy.max_batch_size(), 1);
+}
+
+}  // namespace
+}  // namespace internal
+}  // namespace serving
+}  // namespace tensorflow
@@ -0,0 +1,253 @@
+/* Copyright 2022 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_CORE_KERNELS_BATCHING_UTIL_CONTINUOUS_BATCH_SCHEDULER_H_
+#define TENSORFLOW_CORE_KERNELS_BATCHING_UTIL_CONTINUOUS_BATCH_SCHEDULER_H_
+
+#include <stddef.h>
+
+#include <deque>
+#include <functional>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "tensorflow/core/kernels/batching_util/batch_scheduler.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/errors.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/status.h"
+#include "tensorflow/core/platform/thread_annotations.h"
+#include "tensorflow/core/platform/types.h"
+
+namespace tensorflow {
+namespace serving {
+
+// A batch scheduler for tasks that are processed in a number of steps, e.g.
+// the sequences of an autoregressive decode loop, in which each task needs a
+// different number of steps.
+//
+// Rather than running a batch to completion before forming the next one, the
+// scheduler batches at the level of steps: a single thread repeatedly runs one
+// step of all active tasks, after which the finished tasks leave and waiting
+// tasks join the active set, in the order they were scheduled, as long as the
+// sizes of the active tasks add up to at most `max_batch_size`. Each task
+// keeps the state of its request (e.g. the decoded sequence and its cache)
+// between steps.
+//
+// The step callback is responsible for batching the active tasks, e.g. by
+// concatenating their states, running the step and splitting the results back
+// into the tasks.
+template <typename TaskType>
+class ContinuousBatchScheduler : public BatchScheduler<TaskType> {
+ public:
+  struct Options {
+    // The maximum total size of the active tasks.
+    size_t max_batch_size = 1000;
+
+    // The maximum number of tasks waiting to join the active set. Schedule()
+    // returns an UNAVAILABLE error beyond it.
+    size_t max_enqueued_tasks = 1000;
+
+    // The name to use for the thread that runs the steps.
+    string thread_name = "continuous_batch_thread";
+
+    // The environment to use.
+    Env* env = Env::Default();
+  };
+
+  // Runs one step of the tasks in `active`, and sets `(*finished)[i]` if
+  // `active[i]` is done after it. `finished` has the size of `active` and is
+  // all false on entry.
+  using StepCallback = std::function<void(const std::vector<TaskType*>& active,
+                                          std::vector<bool>* finished)>;
+
+  // Called with each finished task, on the thread that runs the steps.
+  using DoneCallback = std::function<void(std::unique_ptr<TaskType> task)>;
+
+  static Status Create(const Options& options, StepCallback step_callback,
+                       DoneCallback done_callback,
+                       std::unique_ptr<ContinuousBatchScheduler>* scheduler);
+
+  // Blocks until all scheduled tasks have finished.
+  ~ContinuousBatchScheduler() override;
+
+  Status Schedule(std::unique_ptr<TaskType>* task) override;
+
+  // The number of tasks waiting to join the active set.
+  size_t NumEnqueuedTasks() const override;
+  size_t SchedulingCapacity() const override;
+
+  size_t max_task_size() const override { return options_.max_batch_size; }
+
+  // The number of tasks in the active set.
+  size_t NumActiveTasks() const;
+
+ private:
+  ContinuousBatchScheduler(const Options& options, StepCallback step_callback,
+                           DoneCallback done_callback);
+
+  // The code executed by `thread_`.
+  void StepLoop();
+
+  const Options options_;
+  const StepCallback step_callback_;
+  const DoneCallback done_callback_;
+
+  mutable mutex mu_;
+  condition_variable tasks_waiting_cv_;
+  std::deque<std::unique_ptr<TaskType>> waiting_tasks_ TF_GUARDED_BY(mu_);
+  size_t num_active_tasks_ TF_GUARDED_BY(mu_) = 0;
+  bool closing_ TF_GUARDED_BY(mu_) = false;
+
+  // Declared last, so that the thread is joined before the other members are
+  // destroyed.
+  std::unique_ptr<Thread> thread_;
+
+  TF_DISALLOW_COPY_AND_ASSIGN(ContinuousBatchScheduler);
+};
+
+//////////
+// Implementation details follow. API users need not read.
+
+template <typename TaskType>
+Status ContinuousBatchScheduler<TaskType>::Create(
+    const Options& options, StepCallback step_callback,
+    DoneCallback done_callback,
+    std::unique_ptr<ContinuousBatchScheduler>* scheduler) {
+  if (options.max_batch_size == 0) {
+    return errors::InvalidArgument("max_batch_size must be positive; was ",
+                                   options.max_batch_size);
+  }
+  if (options.max_enqueued_tasks == 0) {
+    return errors::InvalidArgument("max_enqueued_tasks must be positive; was ",
+                                   options.max_enqueued_tasks);
+  }
+  scheduler->reset(new ContinuousBatchScheduler<TaskType>(
+      options, std::move(step_callback), std::move(done_callback)));
+  return OkStatus();
+}
+
+template <typename TaskType>
+ContinuousBatchScheduler<TaskType>::ContinuousBatchScheduler(
+    const Options& options, StepCallback step_callback,
+    DoneCallback done_callback)
+    : options_(options),
+      step_callback_(std::move(step_callback)),
+      done_callback_(std::move(done_callback)) {
+  thread_.reset(options_.env->StartThread({}, options_.thread_name,
+                                          [this] { StepLoop(); }));
+}
+
+template <typename TaskType>
+ContinuousBatchScheduler<TaskType>::~ContinuousBatchScheduler() {
+  {
+    mutex_lock l(mu_);
+    closing_ = true;
+  }
+  tasks_waiting_cv_.notify_all();
+  // Joins the thread, which returns once all tasks have finished.
+  thread_.reset();
+}
+
+template <typename TaskType>
+Status ContinuousBatchScheduler<TaskType>::Schedule(
+    std::unique_ptr<TaskType>* task) {
+  if ((*task)->size() > options_.max_batch_size) {
+    return errors::InvalidArgument("Task size ", (*task)->size(),
+                                   " is larger than maximum batch size ",
+                                   options_.max_batch_size);
+  }
+  {
+    mutex_lock l(mu_);
+    if (waiting_tasks_.size() >= options_.max_enqueued_tasks) {
+      return errors::Unavailable(
+          "The batch scheduling queue to which this task was submitted is "
+          "full");
+    }
+    waiting_tasks_.push_back(std::move(*task));
+  }
+  tasks_waiting_cv_.notify_one();
+  return OkStatus();
+}
+
+template <typename TaskType>
+size_t ContinuousBatchScheduler<TaskType>::NumEnqueuedTasks() const {
+  mutex_lock l(mu_);
+  return waiting_tasks_.size();
+}
+
+template <typename TaskType>
+size_t ContinuousBatchScheduler<TaskType>::SchedulingCapacity() const {
+  mutex_lock l(mu_);
+  return options_.max_enqueued_tasks - waiting_tasks_.size();
+}
+
+template <typename TaskType>
+size_t ContinuousBatchScheduler<TaskType>::NumActiveTasks() const {
+  mutex_lock l(mu_);
+  return num_active_tasks_;
+}
+
+template <typename TaskType>
+void ContinuousBatchScheduler<TaskType>::StepLoop() {
+  std::vector<std::unique_ptr<TaskType>> active_tasks;
+  size_t active_size = 0;
+  while (true) {
+    {
+      mutex_lock l(mu_);
+      num_active_tasks_ = active_tasks.size();
+      while (active_tasks.empty() && waiting_tasks_.empty() && !closing_) {
+        tasks_waiting_cv_.wait(l);
+      }
+      if (active_tasks.empty() && waiting_tasks_.empty()) return;
+      // Waiting tasks join in order, so that a large task isn't passed over
+      // indefinitely by smaller ones.
+      while (!waiting_tasks_.empty() &&
+             active_size + waiting_tasks_.front()->size() <=
+                 options_.max_batch_size) {
+        active_size += waiting_tasks_.front()->size();
+        active_tasks.push_back(std::move(waiting_tasks_.front()));
+        waiting_tasks_.pop_front();
+      }
+      num_active_tasks_ = active_tasks.size();
+    }
+
+    std::vector<TaskType*> active;
+    active.reserve(active_tasks.size());
+    for (const auto& task : active_tasks) {
+      active.push_back(task.get());
+    }
+    std::vector<bool> finished(active_tasks.size(), false);
+    step_callback_(active, &finished);
+
+    // The finished tasks leave the active set.
+    size_t num_remaining = 0;
+    for (size_t i = 0; i < active_tasks.size(); ++i) {
+      if (finished[i]) {
+        active_size -= active_tasks[i]->size();
+        done_callback_(std::move(active_tasks[i]));
+      } else {
+        active_tasks[num_remaining++] = std::move(active_tasks[i]);
+      }
+    }
+    active_tasks.resize(num_remaining);
+  }
+}
+
+}  // namespace serving
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_KERNELS_BATCHING_UTIL_CONTINUOUS_BATCH_SCHEDULER_H_
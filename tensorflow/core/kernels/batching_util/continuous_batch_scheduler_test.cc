@@ -0,0 +1,149 @@
+/* Copyright 2022 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/kernels/batching_util/continuous_batch_scheduler.h"
+
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "tensorflow/core/lib/core/notification.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/errors.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace serving {
+namespace {
+
+// A task that finishes after `num_steps` steps.
+class FakeTask : public BatchTask {
+ public:
+  FakeTask(size_t size, int num_steps) : size_(size), num_steps_(num_steps) {}
+
+  size_t size() const override { return size_; }
+
+  // Runs a step, and returns true if it was the last.
+  bool Step() { return ++num_steps_run_ == num_steps_; }
+
+  int num_steps() const { return num_steps_; }
+  int num_steps_run() const { return num_steps_run_; }
+
+ private:
+  const size_t size_;
+  const int num_steps_;
+  int num_steps_run_ = 0;
+
+  TF_DISALLOW_COPY_AND_ASSIGN(FakeTask);
+};
+
+using Scheduler = ContinuousBatchScheduler<FakeTask>;
+
+Status ScheduleTask(size_t size, int num_steps, Scheduler* scheduler) {
+  auto task = std::make_unique<FakeTask>(size, num_steps);
+  return scheduler->Schedule(&task);
+}
+
+void RunSteps(const std::vector<FakeTask*>& active,
+              std::vector<bool>* finished) {
+  for (int i = 0; i < active.size(); ++i) {
+    (*finished)[i] = active[i]->Step();
+  }
+}
+
+TEST(ContinuousBatchSchedulerTest, TasksJoinAndLeaveBetweenSteps) {
+  mutex mu;
+  std::vector<size_t> batch_sizes;
+  std::vector<int> done_steps;
+  Notification first_step_started, first_step_proceed;
+  auto step_callback = [&](const std::vector<FakeTask*>& active,
+                           std::vector<bool>* finished) {
+    size_t batch_size = 0;
+    for (const FakeTask* task : active) batch_size += task->size();
+    {
+      mutex_lock l(mu);
+      batch_sizes.push_back(batch_size);
+    }
+    if (!first_step_started.HasBeenNotified()) {
+      first_step_started.Notify();
+      first_step_proceed.WaitForNotification();
+    }
+    RunSteps(active, finished);
+  };
+  auto done_callback = [&](std::unique_ptr<FakeTask> task) {
+    EXPECT_EQ(task->num_steps(), task->num_steps_run());
+    mutex_lock l(mu);
+    done_steps.push_back(task->num_steps());
+  };
+
+  Scheduler::Options options;
+  options.max_batch_size = 4;
+  {
+    std::unique_ptr<Scheduler> scheduler;
+    TF_ASSERT_OK(
+        Scheduler::Create(options, step_callback, done_callback, &scheduler));
+    TF_ASSERT_OK(ScheduleTask(2, 3, scheduler.get()));
+    first_step_started.WaitForNotification();
+    // Both tasks join after the first step, and the second doesn't fit until
+    // the one-step task leaves.
+    TF_ASSERT_OK(ScheduleTask(1, 1, scheduler.get()));
+    TF_ASSERT_OK(ScheduleTask(2, 2, scheduler.get()));
+    EXPECT_EQ(2, scheduler->NumEnqueuedTasks());
+    EXPECT_EQ(1, scheduler->NumActiveTasks());
+    first_step_proceed.Notify();
+  }
+
+  mutex_lock l(mu);
+  EXPECT_EQ((std::vector<size_t>{2, 3, 4, 2}), batch_sizes);
+  EXPECT_EQ((std::vector<int>{1, 3, 2}), done_steps);
+}
+
+TEST(ContinuousBatchSchedulerTest, Errors) {
+  Scheduler::Options options;
+  options.max_batch_size = 4;
+  options.max_enqueued_tasks = 1;
+  Notification step_proceed;
+  std::unique_ptr<Scheduler> scheduler;
+  TF_ASSERT_OK(Scheduler::Create(
+      options,
+      [&step_proceed](const std::vector<FakeTask*>& active,
+                      std::vector<bool>* finished) {
+        step_proceed.WaitForNotification();
+        RunSteps(active, finished);
+      },
+      [](std::unique_ptr<FakeTask> task) {}, &scheduler));
+
+  EXPECT_TRUE(errors::IsInvalidArgument(ScheduleTask(5, 1, scheduler.get())));
+  TF_ASSERT_OK(ScheduleTask(4, 1, scheduler.get()));
+  // The first task may or may not have joined the active set yet, but the
+  // third one can't.
+  Status status;
+  for (int i = 0; i < 2 && status.ok(); ++i) {
+    status = ScheduleTask(4, 1, scheduler.get());
+  }
+  EXPECT_TRUE(errors::IsUnavailable(status)) << status;
+  step_proceed.Notify();
+
+  options.max_batch_size = 0;
+  std::unique_ptr<Scheduler> invalid_scheduler;
+  EXPECT_TRUE(errors::IsInvalidArgument(Scheduler::Create(
+      options, RunSteps, [](std::unique_ptr<FakeTask> task) {},
+      &invalid_scheduler)));
+}
+
+}  // namespace
+}  // namespace serving
+}  // namespace tensorflow
@@ -18,11 +18,14 @@ limitations under the License.
 
 #include <stddef.h>
 
+#include <algorithm>
 #include <deque>
 #include <functional>
 #include <list>
+#include <map>
 #include <memory>
 #include <string>
+#include <unordered_map>
 #include <utility>
 #include <vector>
 
@@ -31,6 +34,7 @@ limitations under the License.
 #include "absl/utility/utility.h"
 #include "tensorflow/core/kernels/batching_util/batch_input_task.h"
 #include "tensorflow/core/kernels/batching_util/batch_scheduler.h"
+#include "tensorflow/core/kernels/batching_util/batch_timeout_policy.h"
 #include "tensorflow/core/kernels/batching_util/periodic_function.h"
 #include "tensorflow/core/lib/core/errors.h"
 #include "tensorflow/core/lib/core/status.h"
@@ -84,6 +88,15 @@ namespace serving {
 // BasicBatchScheduler instance, in the sense that it has maximum batch size and
 // timeout parameters, which govern when a batch is eligible to be processed.
 //
+// Queues may be given priorities and weights (see QueueOptions). A batch is
+// only taken from a queue if no queue of a higher priority has one that is
+// eligible, and while a queue of a higher priority has tasks waiting, the
+// queues of lower priorities hold on to partially filled batches for up to
+// their timeout again, so that their threads are free for the higher priority
+// work. Among the queues of one priority the threads round-robin with a
+// deficit for each queue, so that e.g. with queues A and B having weights 1
+// and 2 respectively, the servicing pattern is ABBABB...
+//
 // Each queue is independently configured with a maximum size (in terms of the
 // maximum number of batches worth of enqueued tasks). For online serving, it is
 // recommended that the queue sizes be configured such that the sum of the sizes
@@ -100,11 +113,6 @@ namespace serving {
 // For bulk processing jobs and throughput-oriented benchmarks, you may want to
 // set the maximum queue size to a large value.
 //
-// TODO(b/26539183): Support queue servicing policies other than round-robin.
-// E.g. let each queue specify a "share" (an int >= 1), so e.g. with queues A
-// and B having shares 1 and 2 respectively, the servicing pattern is ABBABB...
-//
-//
 // PERFORMANCE TUNING: See README.md.
 //
 template <typename TaskType>
@@ -218,6 +226,21 @@ class SharedBatchScheduler
     // submit batches whose size is in a small set of allowed sizes, that can be
     // done by adding padding in the process-batch callback.
     size_t max_execution_batch_size = 1000;
+
+    // If positive, the queue adapts the batch timeout and the size at which
+    // it closes batches online, from the observed arrival rate and batch
+    // processing times, to keep the latency of tasks within this target; see
+    // internal::BatchTimeoutPolicy.  `batch_timeout_micros` and
+    // `max_execution_batch_size` then act as upper bounds.
+    int64_t target_latency_micros = 0;
+
+    // Batches of queues with higher priorities are processed before those of
+    // queues with lower priorities; see the class documentation above.
+    int priority = 0;
+
+    // The number of batches the queue may process in a row, relative to the
+    // other queues of the same priority. Must be positive.
+    int fair_share_weight = 1;
   };
   Status AddQueue(const QueueOptions& options,
                   std::function<void(std::unique_ptr<Batch<TaskType>>)>
@@ -232,9 +255,8 @@ class SharedBatchScheduler
       TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
 
   // The code executed in 'batch_threads_'. Obtains a batch to process from the
-  // queue pointed to by 'next_queue_to_schedule_', and processes it. If that
-  // queue declines to provide a batch to process, moves onto the next queue. If
-  // no queues provide a batch to process, just sleeps briefly and exits.
+  // queue chosen by GetNextWorkItem_Locked(), and processes it. If no queues
+  // provide a batch to process, just sleeps briefly and exits.
   void ThreadLogic();
 
   // Called by `AddQueue`.
@@ -260,9 +282,18 @@ class SharedBatchScheduler
   //  - have been removed but are not yet empty.
   QueueList queues_ TF_GUARDED_BY(mu_);
 
-  // An iterator over 'queues_', pointing to the queue from which the next
-  // available batch thread should grab work.
-  typename QueueList::iterator next_queue_to_schedule_ TF_GUARDED_BY(mu_);
+  // Where the round-robin through the queues of one priority stands: the queue
+  // that the last batch of the priority came from, and whether it still has
+  // batches of its `fair_share_weight` to process in this round.
+  struct RoundRobinPosition {
+    const internal::Queue<TaskType>* last_queue = nullptr;
+    bool stay = false;
+  };
+  std::map<int, RoundRobinPosition> round_robin_positions_ TF_GUARDED_BY(mu_);
+
+  // The number of batches each queue may still process in the current round.
+  std::unordered_map<const internal::Queue<TaskType>*, int>
+      fair_share_deficits_ TF_GUARDED_BY(mu_);
 
   // Used by idle batch threads to wait for work to enter the system. Notified
   // whenever a batch becomes schedulable.
@@ -344,15 +375,23 @@ class Queue {
   // size that's provided by caller of batch scheduler.
   size_t max_execution_batch_size() const { return max_execution_batch_size_; }
 
+  int priority() const { return options_.priority; }
+  int fair_share_weight() const { return options_.fair_share_weight; }
+
   // Called by a thread that is ready to process a batch, to request one from
   // this queue. Either returns a batch that is ready to be processed, or
   // nullptr if the queue declines to schedule a batch at this time. If it
   // returns a batch, the batch is guaranteed to be closed.
-  typename SharedBatchScheduler<TaskType>::BatchUniquePtr ScheduleBatch();
+  //
+  // If `defer_open_batch`, the open batch is only closed before it is full if
+  // it has been waiting for twice the batch timeout.
+  typename SharedBatchScheduler<TaskType>::BatchUniquePtr ScheduleBatch(
+      bool defer_open_batch = false);
 
   // A variant of `ScheduleBatch`.
   // Batches are guaranteed to form at task enqueue time.
-  std::unique_ptr<Batch<TaskType>> ScheduleBatchWithEagerSplit();
+  std::unique_ptr<Batch<TaskType>> ScheduleBatchWithEagerSplit(
+      bool defer_open_batch);
 
   // Processes a batch that has been returned earlier by ScheduleBatch().
   void ProcessBatch(std::unique_ptr<Batch<TaskType>> batch);
@@ -397,12 +436,18 @@ class Queue {
       TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
 
   // Determines whether the open batch residing at the back of 'batches_' is
-  // currently schedulable.
-  bool IsOpenBatchSchedulable() const TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+  // currently schedulable; see ScheduleBatch() for `defer_open_batch`.
+  bool IsOpenBatchSchedulable(bool defer_open_batch = false) const
+      TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+
+  // The timeout of the open batch and the size at which it is closed, as
+  // adapted by `timeout_policy_` if there is one.
+  int64_t batch_timeout_micros() const TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+  size_t open_batch_size_limit() const TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
 
   // A variant of `IsOpenBatchSchedulable`; used when batches are formed at
   // task enqueue time, and open batch is `batches_.back()`.
-  bool IsOpenBatchSchedulableAfterEagerSplit() const
+  bool IsOpenBatchSchedulableAfterEagerSplit(bool defer_open_batch) const
       TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
 
   // Same as SchedulingCapacity(), but assumes the caller already holds a
@@ -484,6 +529,9 @@ class Queue {
   // 'empty_notification_->Notify()'.
   Notification* empty_notification_ TF_GUARDED_BY(mu_) = nullptr;
 
+  // Adapts the batch timeout if `options_.target_latency_micros` is positive.
+  std::unique_ptr<BatchTimeoutPolicy> timeout_policy_ TF_GUARDED_BY(mu_);
+
   TF_DISALLOW_COPY_AND_ASSIGN(Queue);
 };
 
@@ -588,6 +636,15 @@ Status SharedBatchScheduler<TaskType>::AddQueueAfterRewritingOptions(
         "max_enqueued_batches must be positive; was ",
         options.max_enqueued_batches);
   }
+  if (options.target_latency_micros < 0) {
+    return errors::InvalidArgument(
+        "target_latency_micros must be non-negative; was ",
+        options.target_latency_micros);
+  }
+  if (options.fair_share_weight <= 0) {
+    return errors::InvalidArgument("fair_share_weight must be positive; was ",
+                                   options.fair_share_weight);
+  }
 
   if (options.enable_large_batch_splitting &&
       options.split_input_task_func == nullptr) {
@@ -627,9 +684,6 @@ Status SharedBatchScheduler<TaskType>::AddQueueAfterRewritingOptions(
   {
     mutex_lock l(mu_);
     queues_.push_back(std::move(internal_queue));
-    if (next_queue_to_schedule_ == queues_.end()) {
-      next_queue_to_schedule_ = queues_.begin();
-    }
   }
   *queue = std::move(handle);
   return OkStatus();
@@ -637,7 +691,7 @@ Status SharedBatchScheduler<TaskType>::AddQueueAfterRewritingOptions(
 
 template <typename TaskType>
 SharedBatchScheduler<TaskType>::SharedBatchScheduler(const Options& options)
-    : options_(options), next_queue_to_schedule_(queues_.end()) {
+    : options_(options) {
   // Kick off the batch threads.
   PeriodicFunction::Options periodic_fn_options;
   periodic_fn_options.thread_name_prefix =
@@ -663,43 +717,77 @@ template <typename TaskType>
 void SharedBatchScheduler<TaskType>::GetNextWorkItem_Locked(
     internal::Queue<TaskType>** queue_for_batch_out,
     BatchUniquePtr* batch_to_process_out) {
-  BatchUniquePtr batch_to_process;
-  internal::Queue<TaskType>* queue_for_batch = nullptr;
-  const int num_queues = queues_.size();
-  for (int num_queues_tried = 0;
-       (BatchExists(batch_to_process)) && num_queues_tried < num_queues;
-       ++num_queues_tried) {
-    DCHECK(next_queue_to_schedule_ != queues_.end());
-
-    // If a closed queue responds to ScheduleBatch() with nullptr, the queue
-    // will never yield any further batches so we can drop it. To avoid a
-    // race, we take a snapshot of the queue's closedness state *before*
-    // calling ScheduleBatch().
-    const bool queue_closed = (*next_queue_to_schedule_)->closed();
-
-    // Ask '*next_queue_to_schedule_' if it wants us to process a batch.
-    batch_to_process = (*next_queue_to_schedule_)->ScheduleBatch();
-
-    if (!BatchExists(batch_to_process)) {
-      queue_for_batch = next_queue_to_schedule_->get();
+  std::vector<int> priorities;
+  priorities.reserve(queues_.size());
+  for (const auto& queue : queues_) {
+    priorities.push_back(queue->priority());
+  }
+  std::sort(priorities.begin(), priorities.end(), std::greater<int>());
+  priorities.erase(std::unique(priorities.begin(), priorities.end()),
+                   priorities.end());
+
+  // Whether a queue of a higher priority than the current one has tasks
+  // waiting.
+  bool higher_priority_tasks_waiting = false;
+  for (const int priority : priorities) {
+    RoundRobinPosition& position = round_robin_positions_[priority];
+    // The queues of `priority`, in round-robin order from the current
+    // position.
+    std::vector<typename QueueList::iterator> candidates;
+    int first_candidate = 0;
+    for (auto it = queues_.begin(); it != queues_.end(); ++it) {
+      if ((*it)->priority() != priority) continue;
+      if (it->get() == position.last_queue) {
+        first_candidate = candidates.size() + (position.stay ? 0 : 1);
+      }
+      candidates.push_back(it);
     }
+    std::rotate(candidates.begin(),
+                candidates.begin() + first_candidate % candidates.size(),
+                candidates.end());
 
-    // Advance 'next_queue_to_schedule_'.
-    if (queue_closed && (*next_queue_to_schedule_)->IsEmpty() &&
-        (BatchExists(batch_to_process))) {
-      // We've encountered a closed queue with no work to do. Drop it.
-      DCHECK_NE(queue_for_batch, next_queue_to_schedule_->get());
-      next_queue_to_schedule_ = queues_.erase(next_queue_to_schedule_);
-    } else {
-      ++next_queue_to_schedule_;
-    }
-    if (next_queue_to_schedule_ == queues_.end() && !queues_.empty()) {
-      // We've hit the end. Wrap to the first queue.
-      next_queue_to_schedule_ = queues_.begin();
+    bool tasks_waiting = false;
+    for (const auto& it : candidates) {
+      internal::Queue<TaskType>* queue = it->get();
+
+      // If a closed queue responds to ScheduleBatch() with nullptr, the queue
+      // will never yield any further batches so we can drop it. To avoid a
+      // race, we take a snapshot of the queue's closedness state *before*
+      // calling ScheduleBatch().
+      const bool queue_closed = queue->closed();
+
+      // Ask 'queue' if it wants us to process a batch.
+      BatchUniquePtr batch_to_process =
+          queue->ScheduleBatch(higher_priority_tasks_waiting);
+
+      if (!BatchExists(batch_to_process)) {
+        int& deficit = fair_share_deficits_[queue];
+        if (deficit <= 0) deficit = queue->fair_share_weight();
+        --deficit;
+        position.last_queue = queue;
+        position.stay = deficit > 0;
+        *queue_for_batch_out = queue;
+        *batch_to_process_out = std::move(batch_to_process);
+        return;
+      }
+
+      // A queue without work to do gives up the rest of its round.
+      fair_share_deficits_.erase(queue);
+      if (queue_closed && queue->IsEmpty()) {
+        // We've encountered a closed queue with no work to do. Drop it.
+        if (position.last_queue == queue) position = RoundRobinPosition();
+        queues_.erase(it);
+        continue;
+      }
+      if (position.last_queue == queue) position.stay = false;
+      if (priorities.size() > 1 && !tasks_waiting) {
+        tasks_waiting = queue->NumEnqueuedTasks() > 0;
+      }
     }
+    higher_priority_tasks_waiting |= tasks_waiting;
   }
-  *queue_for_batch_out = queue_for_batch;
-  *batch_to_process_out = std::move(batch_to_process);
+  *queue_for_batch_out = nullptr;
+  *batch_to_process_out = BatchUniquePtr();
 }
 
 template <typename TaskType>
@@ -768,6 +856,11 @@ Queue<TaskType>::Queue(
   // time of the queue. This prevents the batches in different queues to have
   // the same traceme_context_id_counter_.
   traceme_context_id_counter_ = absl::GetCurrentTimeNanos() << 32;
+  if (options_.target_latency_micros > 0) {
+    timeout_policy_ = std::make_unique<BatchTimeoutPolicy>(
+        options_.target_latency_micros, options_.batch_timeout_micros,
+        max_execution_batch_size_);
+  }
   // Create an initial, open batch.
   if (options_.enable_lazy_split) {
     task_handle_batches_.emplace_back(
@@ -824,6 +917,9 @@ Status Queue<TaskType>::ScheduleWithLazySplit(std::unique_ptr<TaskType>* task) {
           "The batch scheduling queue to which this task was submitted is "
           "full");
     }
+    if (timeout_policy_ != nullptr) {
+      timeout_policy_->RecordArrival(env_->NowMicros(), (*task)->size());
+    }
     const int64 open_batch_capacity =
         max_execution_batch_size - this->tail_batch_task_size();
 
@@ -898,6 +994,9 @@ Status Queue<TaskType>::ScheduleWithoutOrEagerSplit(
           "The batch scheduling queue to which this task was submitted is "
           "full");
     }
+    if (timeout_policy_ != nullptr) {
+      timeout_policy_->RecordArrival(env_->NowMicros(), (*task)->size());
+    }
 
     const int64_t open_batch_remaining_slot =
         max_execution_batch_size() - batches_.back()->size();
@@ -1012,8 +1111,8 @@ bool Queue<TaskType>::BatchTaskExceedQueueCapacity(TaskType* task) const {
 }
 
 template <typename TaskType>
-std::unique_ptr<Batch<TaskType>>
-Queue<TaskType>::ScheduleBatchWithEagerSplit() {
+std::unique_ptr<Batch<TaskType>> Queue<TaskType>::ScheduleBatchWithEagerSplit(
+    bool defer_open_batch) {
   // The batch to schedule, which we may populate below. (If left as nullptr,
   // that means we are electing not to schedule a batch at this time.)
   std::unique_ptr<Batch<TaskType>> batch_to_schedule;
@@ -1022,7 +1121,7 @@ Queue<TaskType>::ScheduleBatchWithEagerSplit() {
     mutex_lock l(mu_);
 
     // Consider closing the open batch at this time, to schedule it.
-    if (batches_.size() == 1 && IsOpenBatchSchedulable()) {
+    if (batches_.size() == 1 && IsOpenBatchSchedulable(defer_open_batch)) {
       StartNewBatch();
     }
 
@@ -1041,9 +1140,9 @@ Queue<TaskType>::ScheduleBatchWithEagerSplit() {
 
 template <typename TaskType>
 typename SharedBatchScheduler<TaskType>::BatchUniquePtr
-Queue<TaskType>::ScheduleBatch() {
+Queue<TaskType>::ScheduleBatch(bool defer_open_batch) {
   if (!options_.enable_lazy_split) {
-    return ScheduleBatchWithEagerSplit();
+    return ScheduleBatchWithEagerSplit(defer_open_batch);
   }
   // The batch to schedule, which we may populate below. (If left as nullptr,
   // that means we are electing not to schedule a batch at this time.)
@@ -1054,7 +1153,8 @@ Queue<TaskType>::ScheduleBatch() {
     mutex_lock l(mu_);
 
     // Consider closing the open batch at this time, to schedule it.
-    if (task_handle_batches_.size() == 1 && IsOpenBatchSchedulable()) {
+    if (task_handle_batches_.size() == 1 &&
+        IsOpenBatchSchedulable(defer_open_batch)) {
       StartNewBatch();
     }
 
@@ -1081,10 +1181,16 @@ void Queue<TaskType>::ProcessBatch(std::unique_ptr<Batch<TaskType>> batch) {
       },
       profiler::ContextType::kSharedBatchScheduler,
       batch->traceme_context_id());
+  const uint64 start_time_micros = env_->NowMicros();
+  const size_t batch_size = batch->size();
   process_batch_callback_(std::move(batch));
 
   {
     mutex_lock l(mu_);
+    if (timeout_policy_ != nullptr) {
+      timeout_policy_->RecordBatch(batch_size,
+                                   env_->NowMicros() - start_time_micros);
+    }
     --num_batches_being_processed_;
     if (empty_notification_ != nullptr && IsEmptyInternal()) {
       empty_notification_->Notify();
@@ -1149,29 +1255,49 @@ Status Queue<TaskType>::SplitInputBatchIntoSubtasks(
 }
 
 template <typename TaskType>
-bool Queue<TaskType>::IsOpenBatchSchedulableAfterEagerSplit() const {
+bool Queue<TaskType>::IsOpenBatchSchedulableAfterEagerSplit(
+    bool defer_open_batch) const {
   Batch<TaskType>* open_batch = batches_.back().get();
   if (open_batch->empty()) {
     return false;
   }
-  return closed_ || open_batch->size() >= max_execution_batch_size() ||
-         env_->NowMicros() >=
-             open_batch_start_time_micros_ + options_.batch_timeout_micros;
+  const int64_t timeout_micros =
+      (defer_open_batch ? 2 : 1) * batch_timeout_micros();
+  return closed_ || open_batch->size() >= open_batch_size_limit() ||
+         env_->NowMicros() >= open_batch_start_time_micros_ + timeout_micros;
 }
 
 template <typename TaskType>
-bool Queue<TaskType>::IsOpenBatchSchedulable() const {
+bool Queue<TaskType>::IsOpenBatchSchedulable(bool defer_open_batch) const {
   if (!options_.enable_lazy_split) {
-    return IsOpenBatchSchedulableAfterEagerSplit();
+    return IsOpenBatchSchedulableAfterEagerSplit(defer_open_batch);
   }
   Batch<BatchInputTaskHandle<TaskType>>* open_batch =
       task_handle_batches_.back().get();
   if (open_batch->empty()) {
     return false;
   }
-  return closed_ || open_batch->size() >= max_execution_batch_size() ||
-         env_->NowMicros() >=
-             open_batch_start_time_micros_ + options_.batch_timeout_micros;
+  const int64_t timeout_micros =
+      (defer_open_batch ? 2 : 1) * batch_timeout_micros();
+  return closed_ || open_batch->size() >= open_batch_size_limit() ||
+         env_->NowMicros() >= open_batch_start_time_micros_ + timeout_micros;
+}
+
+template <typename TaskType>
+int64_t Queue<TaskType>::batch_timeout_micros() const {
+  if (timeout_policy_ != nullptr) {
+    return timeout_policy_->batch_timeout_micros();
+  }
+  return options_.batch_timeout_micros;
+}
+
+template <typename TaskType>
+size_t Queue<TaskType>::open_batch_size_limit() const {
+  if (timeout_policy_ != nullptr) {
+    return std::min(max_execution_batch_size(),
+                    timeout_policy_->max_batch_size());
+  }
+  return max_execution_batch_size();
 }
 
 template <typename TaskType>
@@ -544,6 +544,151 @@ TEST_P(SharedBatchSchedulerTest, Fairness) {
   stop_teardown.Notify();
 }
 
+// Returns a callback that appends `label` to `*order` for each batch, and
+// blocks the first batch of all queues until `first_batch_proceed` is notified.
+internal::Queue<FakeTask>::ProcessBatchCallback RecordingCallback(
+    char label, mutex* mu, string* order, Notification* first_batch_scheduled,
+    Notification* first_batch_proceed) {
+  return [=](std::unique_ptr<Batch<FakeTask>> batch) {
+    {
+      mutex_lock l(*mu);
+      order->push_back(label);
+    }
+    if (!first_batch_scheduled->HasBeenNotified()) {
+      first_batch_scheduled->Notify();
+      first_batch_proceed->WaitForNotification();
+    }
+  };
+}
+
+TEST_P(SharedBatchSchedulerTest, Priorities) {
+  mutex mu;
+  string order;
+  Notification first_batch_scheduled, first_batch_proceed;
+  auto scheduler = CreateSharedBatchScheduler(/*num_batch_threads=*/1);
+  QueueOptions queue_options =
+      CreateQueueOptions(10, 10, 1000 * 1000 /* batch_timeout_micros */, 100);
+  std::unique_ptr<BatchScheduler<FakeTask>> low_queue;
+  TF_ASSERT_OK(scheduler->AddQueue(
+      queue_options,
+      RecordingCallback('L', &mu, &order, &first_batch_scheduled,
+                        &first_batch_proceed),
+      &low_queue));
+  queue_options.priority = 1;
+  std::unique_ptr<BatchScheduler<FakeTask>> high_queue;
+  TF_ASSERT_OK(scheduler->AddQueue(
+      queue_options,
+      RecordingCallback('H', &mu, &order, &first_batch_scheduled,
+                        &first_batch_proceed),
+      &high_queue));
+
+  // Occupy the batch thread while full batches queue up on both queues.
+  TF_ASSERT_OK(ScheduleTask(10, low_queue.get()));
+  first_batch_scheduled.WaitForNotification();
+  for (int i = 0; i < 2; ++i) {
+    TF_ASSERT_OK(ScheduleTask(10, low_queue.get()));
+    TF_ASSERT_OK(ScheduleTask(10, high_queue.get()));
+  }
+  first_batch_proceed.Notify();
+  low_queue.reset();
+  high_queue.reset();
+
+  mutex_lock l(mu);
+  EXPECT_EQ("LHHLL", order);
+}
+
+TEST_P(SharedBatchSchedulerTest, FairShareWeights) {
+  mutex mu;
+  string order;
+  Notification first_batch_scheduled, first_batch_proceed;
+  auto scheduler = CreateSharedBatchScheduler(/*num_batch_threads=*/1);
+  QueueOptions queue_options =
+      CreateQueueOptions(10, 10, 1000 * 1000 /* batch_timeout_micros */, 100);
+  std::unique_ptr<BatchScheduler<FakeTask>> queue_a;
+  TF_ASSERT_OK(scheduler->AddQueue(
+      queue_options,
+      RecordingCallback('A', &mu, &order, &first_batch_scheduled,
+                        &first_batch_proceed),
+      &queue_a));
+  queue_options.fair_share_weight = 2;
+  std::unique_ptr<BatchScheduler<FakeTask>> queue_b;
+  TF_ASSERT_OK(scheduler->AddQueue(
+      queue_options,
+      RecordingCallback('B', &mu, &order, &first_batch_scheduled,
+                        &first_batch_proceed),
+      &queue_b));
+
+  // Occupy the batch thread while full batches queue up on both queues.
+  TF_ASSERT_OK(ScheduleTask(10, queue_a.get()));
+  first_batch_scheduled.WaitForNotification();
+  for (int i = 0; i < 3; ++i) {
+    TF_ASSERT_OK(ScheduleTask(10, queue_a.get()));
+  }
+  for (int i = 0; i < 4; ++i) {
+    TF_ASSERT_OK(ScheduleTask(10, queue_b.get()));
+  }
+  first_batch_proceed.Notify();
+  queue_a.reset();
+  queue_b.reset();
+
+  {
+    mutex_lock l(mu);
+    EXPECT_EQ("ABBABBAA", order);
+  }
+
+  queue_options.fair_share_weight = 0;
+  std::unique_ptr<BatchScheduler<FakeTask>> queue;
+  EXPECT_THAT(
+      scheduler->AddQueue(
+          queue_options, [](std::unique_ptr<Batch<FakeTask>> batch) {},
+          &queue),
+      testing::StatusIs(error::INVALID_ARGUMENT,
+                        "fair_share_weight must be positive; was 0"));
+}
+
+TEST_P(SharedBatchSchedulerTest, DefersPartialBatchesToHigherPriorities) {
+  test_util::FakeClockEnv env(Env::Default());
+  Notification start_teardown, stop_teardown;
+  std::unique_ptr<Thread> teardown_thread =
+      CreateFakeClockAdvancerThread(&env, &start_teardown, &stop_teardown);
+
+  {
+    Notification low_batch_processed;
+    auto low_callback =
+        [&low_batch_processed](std::unique_ptr<Batch<FakeTask>> batch) {
+          low_batch_processed.Notify();
+        };
+
+    auto scheduler = CreateSharedBatchScheduler(1, &env);
+    QueueOptions low_queue_options =
+        CreateQueueOptions(10, 10, 100 /* batch_timeout_micros */, 100);
+    std::unique_ptr<BatchScheduler<FakeTask>> low_queue;
+    TF_ASSERT_OK(
+        scheduler->AddQueue(low_queue_options, low_callback, &low_queue));
+    QueueOptions high_queue_options =
+        CreateQueueOptions(10, 10, 1000 * 1000 /* batch_timeout_micros */, 100);
+    high_queue_options.priority = 1;
+    std::unique_ptr<BatchScheduler<FakeTask>> high_queue;
+    TF_ASSERT_OK(scheduler->AddQueue(
+        high_queue_options, [](std::unique_ptr<Batch<FakeTask>> batch) {},
+        &high_queue));
+
+    // The partial batch of the low priority queue waits for twice its timeout
+    // while the high priority queue has tasks waiting.
+    TF_ASSERT_OK(ScheduleTask(1, high_queue.get()));
+    TF_ASSERT_OK(ScheduleTask(1, low_queue.get()));
+    env.AdvanceByMicroseconds(150);
+    Env::Default()->SleepForMicroseconds(10 * 1000 /* 10 milliseconds */);
+    EXPECT_FALSE(low_batch_processed.HasBeenNotified());
+    env.AdvanceByMicroseconds(100);
+    low_batch_processed.WaitForNotification();
+
+    // Shut everything down.
+    start_teardown.Notify();
+  }
+  stop_teardown.Notify();
+}
+
 TEST_P(SharedBatchSchedulerTest, ConstMethods) {
   for (const int max_enqueued_batches : {1, 2, 5}) {
     Notification processing, proceed;
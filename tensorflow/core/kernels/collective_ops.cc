@@ -1259,5 +1259,59 @@ REGISTER_KERNEL_BUILDER(Name("CollectiveAllToAllV3").Device(DEVICE_CPU),
                         CollectiveAllToAllV3OpKernel);
 REGISTER_KERNEL_BUILDER(Name("CollectiveAllToAllV3").Device(DEVICE_GPU),
                         CollectiveAllToAllV3OpKernel);
+
+class CollectiveAllToAllVV3OpKernel : public CollectiveOpV3Kernel {
+ public:
+  explicit CollectiveAllToAllVV3OpKernel(OpKernelConstruction* c)
+      : CollectiveOpV3Kernel(c) {
+    name_ = strings::StrCat(c->def().name(), ": AllToAllVV3");
+    VLOG(2) << "CollectiveAllToAllVV3 " << this << " name " << name_;
+  }
+
+  void ComputeAsync(OpKernelContext* c, DoneCallback done) override {
+    auto col_params = new CollectiveParams();
+    auto done_with_cleanup = [col_params, done = std::move(done)]() {
+      done();
+      col_params->Unref();
+    };
+    core::RefCountPtr<CollectiveGroupResource> resource;
+    OP_REQUIRES_OK_ASYNC(c, LookupResource(c, HandleFromInput(c, 2), &resource),
+                         done_with_cleanup);
+
+    Tensor group_assignment = c->input(3);
+
+    OP_REQUIRES_OK_ASYNC(
+        c,
+        FillCollectiveParams(col_params, group_assignment,
+                             ALL_TO_ALL_V_COLLECTIVE, resource.get()),
+        done_with_cleanup);
+    const Tensor& input = c->input(0);
+    OP_REQUIRES_ASYNC(c, input.dims() >= 1,
+                      errors::InvalidArgument(
+                          "input to all-to-all-v must be at least 1-D, got ",
+                          input.shape().DebugString()),
+                      done_with_cleanup);
+    // Members send different numbers of rows, so only the shape of a row has
+    // to agree across the group.
+    TensorShape row_shape = input.shape();
+    row_shape.RemoveDim(0);
+    col_params->instance.shape = row_shape;
+    VLOG(1) << "CollectiveAllToAllV group_size "
+            << col_params->group.group_size << " group_key "
+            << col_params->group.group_key << " instance_key "
+            << col_params->instance.instance_key;
+    // The outputs are allocated by the collective once the number of rows
+    // sent by each member is known.
+    Run(c, col_params, std::move(done_with_cleanup));
+  }
+};
+
+REGISTER_KERNEL_BUILDER(Name("CollectiveAllToAllVV3").Device(DEVICE_CPU),
+                        CollectiveAllToAllVV3OpKernel);
+REGISTER_KERNEL_BUILDER(Name("CollectiveAllToAllVV3")
+                            .Device(DEVICE_GPU)
+                            .HostMemory("send_counts")
+                            .HostMemory("recv_counts"),
+                        CollectiveAllToAllVV3OpKernel);
 }  // namespace
 }  // namespace tensorflow
@@ -644,6 +644,11 @@ class Conv2DCustomBackpropFilterOp : public OpKernel {
 TF_CALL_half(REGISTER_CPU_KERNELS);
 TF_CALL_float(REGISTER_CPU_KERNELS);
 TF_CALL_double(REGISTER_CPU_KERNELS);
+// MKL builds register a placeholder bfloat16 kernel that is rewritten to the
+// MKL kernel.
+#if !defined(INTEL_MKL)
+TF_CALL_bfloat16(REGISTER_CPU_KERNELS);
+#endif  // !INTEL_MKL
 #undef REGISTER_CPU_KERNELS
 
 // To be used inside depthwise_conv_grad_op.cc.
@@ -0,0 +1,26 @@
+/* Copyright 2022 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/kernels/conv_grad_input_ops.h"
+
+namespace tensorflow {
+
+// MKL builds register a placeholder bfloat16 kernel that is rewritten to the
+// MKL kernel.
+#if !defined(INTEL_MKL)
+TF_CALL_bfloat16(REGISTER_CONV_2D_BACKPROP_CPU_KERNELS);
+#endif  // !INTEL_MKL
+
+}  // namespace tensorflow
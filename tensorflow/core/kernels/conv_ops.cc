@@ -755,6 +755,11 @@ TF_CALL_half(REGISTER_CPU);
 TF_CALL_float(REGISTER_CPU);
 TF_CALL_double(REGISTER_CPU);
 TF_CALL_int32(REGISTER_CPU);
+// MKL builds register a placeholder bfloat16 kernel that is rewritten to the
+// MKL kernel.
+#if !defined(INTEL_MKL)
+TF_CALL_bfloat16(REGISTER_CPU);
+#endif  // !INTEL_MKL
 #endif  // USE_GEMM_FOR_CONV
 
 // To be used inside depthwise_conv_op.cc.
@@ -17,6 +17,7 @@ limitations under the License.
 #include <algorithm>
 #include <utility>
 
+#include "tensorflow/core/data/batch_buffer_pool.h"
 #include "tensorflow/core/data/dataset_utils.h"
 #include "tensorflow/core/data/name_utils.h"
 #include "tensorflow/core/framework/dataset.h"
@@ -181,6 +182,8 @@ class BatchDatasetOp::Dataset : public DatasetBase {
         : DatasetIterator<Dataset>(params) {}
 
     Status Initialize(IteratorContext* ctx) override {
+      buffer_pool_.reset(new BatchBufferPool(
+          ctx->allocator({}), BatchBufferPool::kDefaultMaxCachedBytes));
       return dataset()->input_->MakeIterator(ctx, this, prefix(), &input_impl_);
     }
 
@@ -229,9 +232,12 @@ class BatchDatasetOp::Dataset : public DatasetBase {
       // respective slice locations. This would require a different GetNext()
       // overload that supports zero-copy, and might make sense in an
       // optimization pass.
-      TF_RETURN_IF_ERROR(CopyBatch(
-          CopyBatchParams(ctx), batch_elements, dataset()->parallel_copy_,
-          /*allocation_callback=*/nullptr, out_tensors));
+      CopyBatchParams params(ctx);
+      params.buffer_pool = buffer_pool_.get();
+      TF_RETURN_IF_ERROR(CopyBatch(std::move(params), batch_elements,
+                                   dataset()->parallel_copy_,
+                                   /*allocation_callback=*/nullptr,
+                                   out_tensors));
 
       *end_of_sequence = false;
       return OkStatus();
@@ -270,6 +276,8 @@ class BatchDatasetOp::Dataset : public DatasetBase {
     }
 
    private:
+    // Recycles the buffers of the batches once they are no longer referenced.
+    core::RefCountPtr<BatchBufferPool> buffer_pool_;
     mutex mu_;
     std::unique_ptr<IteratorBase> input_impl_ TF_GUARDED_BY(mu_);
   };
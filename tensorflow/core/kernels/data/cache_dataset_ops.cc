@@ -46,6 +46,7 @@ namespace data {
 /* static */ constexpr const char* const CacheDatasetOp::kFileName;
 /* static */ constexpr const char* const CacheDatasetOp::kOutputTypes;
 /* static */ constexpr const char* const CacheDatasetOp::kOutputShapes;
+/* static */ constexpr const char* const CacheDatasetOp::kUseMmap;
 
 namespace {
 
@@ -134,10 +135,11 @@ class PartialCache {
 class CacheDatasetOp::FileDatasetBase : public DatasetBase {
  public:
   FileDatasetBase(OpKernelContext* ctx, const DatasetBase* input,
-                  string filename, Env* env)
+                  string filename, Env* env, bool use_mmap)
       : DatasetBase(DatasetContext(ctx)),
         input_(input),
         filename_(std::move(filename)),
+        use_mmap_(use_mmap),
         env_(env),
         num_tensors_(input->output_dtypes().size()),
         tensor_index_padding_size_(StringPaddingSize(num_tensors_)),
@@ -187,6 +189,9 @@ class CacheDatasetOp::FileDatasetBase : public DatasetBase {
  protected:
   const DatasetBase* const input_;
   const tstring filename_;
+  // If true, cache entries are written aligned so that later epochs can read
+  // them back as tensors backed by the memory-mapped cache files.
+  const bool use_mmap_;
 
  private:
   static size_t StringPaddingSize(size_t num_tensors) {
@@ -198,6 +203,20 @@ class CacheDatasetOp::FileDatasetBase : public DatasetBase {
                            tensor_index);
   }
 
+  BundleWriter::Options WriterOptions() const {
+    BundleWriter::Options options;
+    if (use_mmap_) {
+      options.data_alignment = EIGEN_MAX_ALIGN_BYTES;
+    }
+    return options;
+  }
+
+  BundleReader::Options ReaderOptions() const {
+    BundleReader::Options options;
+    options.use_mmap = use_mmap_;
+    return options;
+  }
+
   class FileIterator : public DatasetIterator<FileDatasetBase> {
    public:
     explicit FileIterator(const Params& params)
@@ -438,7 +457,8 @@ class CacheDatasetOp::FileDatasetBase : public DatasetBase {
         }
         filename_ = strings::StrCat(dataset()->filename_, "_", shard_id_);
         lockfile_ = strings::StrCat(filename_, kLockFileSuffix);
-        writer_ = std::make_unique<BundleWriter>(dataset()->env_, filename_);
+        writer_ = std::make_unique<BundleWriter>(dataset()->env_, filename_,
+                                                 dataset()->WriterOptions());
         return OkStatus();
       }
 
@@ -500,7 +520,8 @@ class CacheDatasetOp::FileDatasetBase : public DatasetBase {
         // conditions are not met since BundleWriter's constructor creates
         // new temp files which can delete the temp files created by a
         // BundleWriter in another Session.
-        writer_ = std::make_unique<BundleWriter>(dataset()->env_, filename_);
+        writer_ = std::make_unique<BundleWriter>(dataset()->env_, filename_,
+                                                 dataset()->WriterOptions());
         lockfile_created_ = true;
         return OkStatus();
       }
@@ -554,7 +575,8 @@ class CacheDatasetOp::FileDatasetBase : public DatasetBase {
       explicit FileReaderIterator(const Params& params)
           : DatasetIterator<FileDatasetBase>(params),
             cur_index_(0),
-            reader_(dataset()->env_, dataset()->filename_),
+            reader_(dataset()->env_, dataset()->filename_,
+                    dataset()->ReaderOptions()),
             iterator_restored_(false) {}
 
       Status GetNextInternal(IteratorContext* ctx,
@@ -689,7 +711,11 @@ class CacheDatasetOp::FileDataset : public CacheDatasetOp::FileDatasetBase {
     TF_RETURN_IF_ERROR(b->AddInputDataset(ctx, input_, &input_graph));
     Node* filename = nullptr;
     TF_RETURN_IF_ERROR(b->AddScalar(filename_, &filename));
-    TF_RETURN_IF_ERROR(b->AddDataset(this, {input_graph, filename}, output));
+    AttrValue use_mmap;
+    b->BuildAttrValue(use_mmap_, &use_mmap);
+    TF_RETURN_IF_ERROR(b->AddDataset(this, {input_graph, filename},
+                                     {std::make_pair(kUseMmap, use_mmap)},
+                                     output));
     return OkStatus();
   }
 };
@@ -697,9 +723,9 @@ class CacheDatasetOp::FileDataset : public CacheDatasetOp::FileDatasetBase {
 class CacheDatasetOp::FileDatasetV2 : public CacheDatasetOp::FileDatasetBase {
  public:
   explicit FileDatasetV2(OpKernelContext* ctx, const DatasetBase* input,
-                         string filename, Env* env,
+                         string filename, Env* env, bool use_mmap,
                          const Tensor& resource_handle)
-      : FileDatasetBase(ctx, input, filename, env),
+      : FileDatasetBase(ctx, input, filename, env, use_mmap),
         resource_handle_(resource_handle) {}
 
  protected:
@@ -712,8 +738,11 @@ class CacheDatasetOp::FileDatasetV2 : public CacheDatasetOp::FileDatasetBase {
     TF_RETURN_IF_ERROR(b->AddScalar(filename_, &filename_node));
     Node* resource_handle_node = nullptr;
     TF_RETURN_IF_ERROR(b->AddTensor(resource_handle_, &resource_handle_node));
-    TF_RETURN_IF_ERROR(b->AddDataset(
-        this, {input_node, filename_node, resource_handle_node}, output));
+    AttrValue use_mmap;
+    b->BuildAttrValue(use_mmap_, &use_mmap);
+    TF_RETURN_IF_ERROR(
+        b->AddDataset(this, {input_node, filename_node, resource_handle_node},
+                      {std::make_pair(kUseMmap, use_mmap)}, output));
     return OkStatus();
   }
 
@@ -1112,7 +1141,11 @@ class CacheDatasetOp::MemoryDatasetV2
 
 CacheDatasetOp::CacheDatasetOp(OpKernelConstruction* ctx)
     : UnaryDatasetOpKernel(ctx),
-      op_version_(ctx->def().op() == kCacheDataset ? 1 : 2) {}
+      op_version_(ctx->def().op() == kCacheDataset ? 1 : 2) {
+  if (ctx->HasAttr(kUseMmap)) {
+    OP_REQUIRES_OK(ctx, ctx->GetAttr(kUseMmap, &use_mmap_));
+  }
+}
 
 void CacheDatasetOp::MakeDataset(OpKernelContext* ctx, DatasetBase* input,
                                  DatasetBase** output) {
@@ -1161,10 +1194,10 @@ void CacheDatasetOp::MakeDataset(OpKernelContext* ctx, DatasetBase* input,
     }
   } else {
     if (op_version_ == 2) {
-      *output =
-          new FileDatasetV2(ctx, input, filename, ctx->env(), ctx->input(2));
+      *output = new FileDatasetV2(ctx, input, filename, ctx->env(), use_mmap_,
+                                  ctx->input(2));
     } else {
-      *output = new FileDataset(ctx, input, filename, ctx->env());
+      *output = new FileDataset(ctx, input, filename, ctx->env(), use_mmap_);
     }
   }
 }
@@ -30,6 +30,7 @@ class CacheDatasetOp : public UnaryDatasetOpKernel {
   static constexpr const char* const kFileName = "filename";
   static constexpr const char* const kOutputTypes = "output_types";
   static constexpr const char* const kOutputShapes = "output_shapes";
+  static constexpr const char* const kUseMmap = "use_mmap";
 
   explicit CacheDatasetOp(OpKernelConstruction* ctx);
 
@@ -44,6 +45,7 @@ class CacheDatasetOp : public UnaryDatasetOpKernel {
   class MemoryDatasetV2;
 
   const int op_version_;
+  bool use_mmap_ = false;
 };
 
 }  // namespace data
@@ -0,0 +1,228 @@
+/* Copyright 2022 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include <cstring>
+
+#include "tensorflow/core/common_runtime/device.h"
+#include "tensorflow/core/common_runtime/device_mgr.h"
+#include "tensorflow/core/framework/dataset.h"
+#include "tensorflow/core/framework/function.h"
+#include "tensorflow/core/framework/partial_tensor_shape.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/types.h"
+
+namespace tensorflow {
+namespace data {
+namespace experimental {
+namespace {
+
+constexpr char kTargetDevice[] = "target_device";
+
+// Iterates its input on the device the op is placed on, and copies the
+// elements to `target_device` through buffers in pinned host memory. The
+// transformations following it in the pipeline run on `target_device`, which
+// is where the iterator of the pipeline must live.
+class CopyToDeviceDatasetOp : public UnaryDatasetOpKernel {
+ public:
+  explicit CopyToDeviceDatasetOp(OpKernelConstruction* ctx)
+      : UnaryDatasetOpKernel(ctx) {
+    OP_REQUIRES_OK(ctx, ctx->GetAttr(kTargetDevice, &target_device_));
+  }
+
+  void MakeDataset(OpKernelContext* ctx, DatasetBase* input,
+                   DatasetBase** output) override {
+    FunctionLibraryRuntime* flr = ctx->function_library();
+    OP_REQUIRES(ctx, flr != nullptr,
+                errors::Internal("No function library is available."));
+    Device* target_device = nullptr;
+    OP_REQUIRES_OK(ctx, flr->device_mgr()->LookupDevice(target_device_,
+                                                        &target_device));
+    const DeviceBase::AcceleratorDeviceInfo* device_info =
+        target_device->tensorflow_accelerator_device_info();
+    OP_REQUIRES(ctx,
+                device_info != nullptr && device_info->default_context,
+                errors::InvalidArgument("Elements can't be copied to ",
+                                        target_device_,
+                                        ", which is not an accelerator."));
+    for (DataType dtype : input->output_dtypes()) {
+      OP_REQUIRES(ctx, DataTypeCanUseMemcpy(dtype),
+                  errors::InvalidArgument("Elements of type ",
+                                          DataTypeString(dtype),
+                                          " can't be copied to a device."));
+    }
+    AllocatorAttributes pinned;
+    pinned.set_on_host(true);
+    pinned.set_gpu_compatible(true);
+    *output = new Dataset(ctx, input, target_device_, target_device,
+                          device_info->default_context, flr,
+                          ctx->device()->GetAllocator(pinned));
+  }
+
+ private:
+  class Dataset : public DatasetBase {
+   public:
+    Dataset(OpKernelContext* ctx, const DatasetBase* input,
+            const string& target_device_name, Device* target_device,
+            DeviceContext* device_context, FunctionLibraryRuntime* source_flr,
+            Allocator* pinned_allocator)
+        : DatasetBase(DatasetContext(ctx)),
+          input_(input),
+          target_device_name_(target_device_name),
+          target_device_(target_device),
+          device_context_(device_context),
+          source_flr_(source_flr),
+          pinned_allocator_(pinned_allocator) {
+      input_->Ref();
+    }
+
+    ~Dataset() override { input_->Unref(); }
+
+    std::unique_ptr<IteratorBase> MakeIteratorInternal(
+        const string& prefix) const override {
+      return std::make_unique<Iterator>(
+          Iterator::Params{this, strings::StrCat(prefix, "::CopyToDevice")});
+    }
+
+    const DataTypeVector& output_dtypes() const override {
+      return input_->output_dtypes();
+    }
+    const std::vector<PartialTensorShape>& output_shapes() const override {
+      return input_->output_shapes();
+    }
+
+    string DebugString() const override {
+      return "CopyToDeviceDatasetOp::Dataset";
+    }
+
+    int64_t CardinalityInternal() const override {
+      return input_->Cardinality();
+    }
+
+    Status InputDatasets(
+        std::vector<const DatasetBase*>* inputs) const override {
+      inputs->push_back(input_);
+      return OkStatus();
+    }
+
+    Status CheckExternalState() const override {
+      return input_->CheckExternalState();
+    }
+
+   protected:
+    Status AsGraphDefInternal(SerializationContext* ctx,
+                              DatasetGraphDefBuilder* b,
+                              Node** output) const override {
+      Node* input_graph_node = nullptr;
+      TF_RETURN_IF_ERROR(b->AddInputDataset(ctx, input_, &input_graph_node));
+      AttrValue target_device;
+      b->BuildAttrValue(target_device_name_, &target_device);
+      return b->AddDataset(this, {input_graph_node},
+                           {{kTargetDevice, target_device}}, output);
+    }
+
+   private:
+    class Iterator : public DatasetIterator<Dataset> {
+     public:
+      explicit Iterator(const Params& params)
+          : DatasetIterator<Dataset>(params) {}
+
+      Status Initialize(IteratorContext* ctx) override {
+        IteratorContext source_ctx(SourceParams(ctx));
+        return dataset()->input_->MakeIterator(&source_ctx, this, prefix(),
+                                               &input_impl_);
+      }
+
+      Status GetNextInternal(IteratorContext* ctx,
+                             std::vector<Tensor>* out_tensors,
+                             bool* end_of_sequence) override {
+        std::vector<Tensor> host_tensors;
+        {
+          mutex_lock l(mu_);
+          IteratorContext source_ctx(SourceParams(ctx));
+          TF_RETURN_IF_ERROR(input_impl_->GetNext(&source_ctx, &host_tensors,
+                                                  end_of_sequence));
+        }
+        if (*end_of_sequence) return OkStatus();
+
+        out_tensors->reserve(host_tensors.size());
+        for (const Tensor& host_tensor : host_tensors) {
+          // Staging the element in pinned memory lets the copy to the device
+          // run at full DMA bandwidth.
+          Tensor pinned_tensor(dataset()->pinned_allocator_,
+                               host_tensor.dtype(), host_tensor.shape());
+          if (host_tensor.TotalBytes() > 0) {
+            std::memcpy(pinned_tensor.data(), host_tensor.data(),
+                        host_tensor.TotalBytes());
+          }
+          Tensor device_tensor(
+              dataset()->target_device_->GetAllocator(AllocatorAttributes()),
+              host_tensor.dtype(), host_tensor.shape());
+          TF_RETURN_IF_ERROR(
+              dataset()->device_context_->CopyCPUTensorToDeviceSync(
+                  &pinned_tensor, dataset()->target_device_, &device_tensor));
+          out_tensors->push_back(std::move(device_tensor));
+        }
+        return OkStatus();
+      }
+
+     protected:
+      std::shared_ptr<model::Node> CreateNode(
+          IteratorContext* ctx, model::Node::Args args) const override {
+        return model::MakeKnownRatioNode(std::move(args),
+                                         /*ratio=*/1);
+      }
+
+      Status SaveInternal(SerializationContext* ctx,
+                          IteratorStateWriter* writer) override {
+        mutex_lock l(mu_);
+        return SaveInput(ctx, writer, input_impl_);
+      }
+
+      Status RestoreInternal(IteratorContext* ctx,
+                             IteratorStateReader* reader) override {
+        mutex_lock l(mu_);
+        IteratorContext source_ctx(SourceParams(ctx));
+        return RestoreInput(&source_ctx, reader, input_impl_);
+      }
+
+     private:
+      // Returns the parameters of the context in which the input is iterated.
+      IteratorContext::Params SourceParams(IteratorContext* ctx) const {
+        IteratorContext::Params params(ctx);
+        params.flr = dataset()->source_flr_;
+        return params;
+      }
+
+      mutex mu_;
+      std::unique_ptr<IteratorBase> input_impl_ TF_GUARDED_BY(mu_);
+    };
+
+    const DatasetBase* const input_;
+    const string target_device_name_;
+    Device* const target_device_;
+    DeviceContext* const device_context_;
+    FunctionLibraryRuntime* const source_flr_;
+    Allocator* const pinned_allocator_;
+  };
+
+  string target_device_;
+};
+
+REGISTER_KERNEL_BUILDER(Name("_CopyToDeviceDataset").Device(DEVICE_CPU),
+                        CopyToDeviceDatasetOp);
+
+}  // namespace
+}  // namespace experimental
+}  // namespace data
+}  // namespace tensorflow
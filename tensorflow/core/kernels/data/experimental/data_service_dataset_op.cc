@@ -97,6 +97,8 @@ namespace data {
 /* static */ constexpr const char* const DataServiceDatasetOp::kUncompressFn;
 /* static */ constexpr const char* const
     DataServiceDatasetOp::kCrossTrainerCacheOptions;
+/* static */ constexpr const char* const
+    DataServiceDatasetOp::kMaxBytesPerRequest;
 
 namespace {
 // Default interval between task list refreshes.
@@ -111,6 +113,8 @@ constexpr const char kDistributedEpoch[] = "distributed_epoch";
 
 // Same timeout used by the RegisterDatasetOp.
 constexpr absl::Duration kGetMetadataRetryTimeout = absl::Hours(1);
+// Weight of the latest interval in the target processing time moving average.
+constexpr double kTargetProcessingTimeSmoothingFactor = 0.1;
 
 bool IsColocatedTask(const TaskInfo& task) {
   return absl::c_any_of(task.worker_tags(), [](absl::string_view worker_tag) {
@@ -191,7 +195,7 @@ class DataServiceDatasetOp::Dataset : public DatasetBase {
           std::unique_ptr<CapturedFunction> captured_uncompress_func,
           const std::optional<CrossTrainerCacheOptions>&
               cross_trainer_cache_options,
-          const DataTypeVector& output_types,
+          int64_t max_bytes_per_request, const DataTypeVector& output_types,
           const std::vector<PartialTensorShape>& output_shapes)
       : DatasetBase(DatasetContext(ctx)),
         op_version_(op_version),
@@ -214,6 +218,7 @@ class DataServiceDatasetOp::Dataset : public DatasetBase {
         resource_mgr_(ctx->resource_manager()),
         captured_uncompress_func_(std::move(captured_uncompress_func)),
         cross_trainer_cache_options_(cross_trainer_cache_options),
+        max_bytes_per_request_(max_bytes_per_request),
         output_types_(output_types),
         output_shapes_(output_shapes) {}
 
@@ -374,6 +379,11 @@ class DataServiceDatasetOp::Dataset : public DatasetBase {
       b->BuildAttrValue(captured_uncompress_func_->func(), &uncompress_fn_attr);
       attrs.push_back({kUncompressFn, uncompress_fn_attr});
 
+      // Attr: max_bytes_per_request
+      AttrValue max_bytes_per_request_attr;
+      b->BuildAttrValue(max_bytes_per_request_, &max_bytes_per_request_attr);
+      attrs.push_back({kMaxBytesPerRequest, max_bytes_per_request_attr});
+
       std::vector<Node*> uncompress_arguments;
       DataTypeVector uncompress_arguments_types;
       TF_RETURN_IF_ERROR(captured_uncompress_func_->AddToGraph(
@@ -468,6 +478,7 @@ class DataServiceDatasetOp::Dataset : public DatasetBase {
                            bool* end_of_sequence) override {
       VLOG(3) << "Calling GetNext in data service dataset's iterator.";
       mutex_lock l(mu_);
+      UpdateTargetProcessingTime();
       EnsureThreadsStarted(ctx);
       Result result;
       do {
@@ -503,6 +514,7 @@ class DataServiceDatasetOp::Dataset : public DatasetBase {
         }
         out_tensors->swap(result.element);
       }
+      last_get_next_end_nsec_ = EnvTime::NowNanos();
       return OkStatus();
     }
 
@@ -729,14 +741,34 @@ class DataServiceDatasetOp::Dataset : public DatasetBase {
       return OkStatus();
     }
 
+    // Updates the moving average of the time the consumer spends between
+    // receiving an element and asking for the next one. This is how often the
+    // consumer would request elements if the data service had no latency.
+    void UpdateTargetProcessingTime() TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+      if (last_get_next_end_nsec_ == 0) {
+        return;
+      }
+      const double interval_nsec =
+          EnvTime::NowNanos() - last_get_next_end_nsec_;
+      target_processing_time_nsec_ =
+          target_processing_time_nsec_ == 0.0
+              ? interval_nsec
+              : kTargetProcessingTimeSmoothingFactor * interval_nsec +
+                    (1 - kTargetProcessingTimeSmoothingFactor) *
+                        target_processing_time_nsec_;
+    }
+
     void Heartbeat() TF_LOCKS_EXCLUDED(mu_) {
       ClientHeartbeatRequest req;
       req.set_iteration_client_id(iteration_client_id_);
-      if (StrictRoundRobin()) {
+      {
         mutex_lock l(mu_);
-        req.set_current_round(current_round_);
-        if (round_robin_round_limit_.has_value()) {
-          req.set_blocked_round(round_robin_round_limit_.value());
+        req.set_target_processing_time_nsec(target_processing_time_nsec_);
+        if (StrictRoundRobin()) {
+          req.set_current_round(current_round_);
+          if (round_robin_round_limit_.has_value()) {
+            req.set_blocked_round(round_robin_round_limit_.value());
+          }
         }
       }
       ClientHeartbeatResponse resp;
@@ -1029,6 +1061,8 @@ class DataServiceDatasetOp::Dataset : public DatasetBase {
       if (dataset()->cross_trainer_cache_options_) {
         req.set_trainer_id(
             dataset()->cross_trainer_cache_options_->trainer_id());
+      } else if (!StrictRoundRobin()) {
+        req.set_max_bytes_per_request(dataset()->max_bytes_per_request_);
       }
       return task.worker->GetElement(req, result);
     }
@@ -1053,6 +1087,19 @@ class DataServiceDatasetOp::Dataset : public DatasetBase {
       }
       if (enqueue_result && !result.end_of_sequence) {
         results_.push(std::move(result));
+        // Elements after the first one in a batched response are enqueued in
+        // order after it.
+        for (size_t i = 0; i < get_element_result.additional_elements.size();
+             ++i) {
+          Result additional_result;
+          additional_result.ready = true;
+          additional_result.element =
+              std::move(get_element_result.additional_elements[i]);
+          additional_result.element_index =
+              get_element_result.element_index + i + 1;
+          additional_result.task_id = task.info.task_id();
+          results_.push(std::move(additional_result));
+        }
       }
       get_next_cv_.notify_all();
     }
@@ -1234,6 +1281,11 @@ class DataServiceDatasetOp::Dataset : public DatasetBase {
     int64_t iteration_client_id_;
     std::unique_ptr<DataServiceDispatcherClient> dispatcher_;
     int64_t get_next_index_ TF_GUARDED_BY(mu_) = 0;
+    // Time at which the last GetNext call returned, or 0 before the first one.
+    uint64_t last_get_next_end_nsec_ TF_GUARDED_BY(mu_) = 0;
+    // Moving average of the time between a GetNext call returning and the next
+    // GetNext call, reported to the dispatcher for autoscaling.
+    double target_processing_time_nsec_ TF_GUARDED_BY(mu_) = 0.0;
 
     bool iteration_finished_ = false;
     bool should_finish_iteration_ TF_GUARDED_BY(mu_) = true;
@@ -1265,6 +1317,9 @@ class DataServiceDatasetOp::Dataset : public DatasetBase {
   ResourceMgr* const resource_mgr_;  // Not owned
   const std::unique_ptr<CapturedFunction> captured_uncompress_func_;
   const absl::optional<CrossTrainerCacheOptions> cross_trainer_cache_options_;
+  // If positive, the number of bytes of elements to request from a worker in
+  // one GetElement call, for reads which support batching.
+  const int64_t max_bytes_per_request_;
   const DataTypeVector output_types_;
   const std::vector<PartialTensorShape> output_shapes_;
 };
@@ -1320,6 +1375,15 @@ DataServiceDatasetOp::DataServiceDatasetOp(OpKernelConstruction* ctx)
     OP_REQUIRES_OK(ctx, ctx->GetAttr(kCrossTrainerCacheOptions,
                                      &seriazlied_cross_trainer_cache_options_));
   }
+
+  if (ctx->HasAttr(kMaxBytesPerRequest)) {
+    OP_REQUIRES_OK(ctx,
+                   ctx->GetAttr(kMaxBytesPerRequest, &max_bytes_per_request_));
+    OP_REQUIRES(ctx, max_bytes_per_request_ >= 0,
+                errors::InvalidArgument(kMaxBytesPerRequest,
+                                        " must be non-negative, but got ",
+                                        max_bytes_per_request_, "."));
+  }
 }
 
 void DataServiceDatasetOp::MakeDataset(OpKernelContext* ctx,
@@ -1467,7 +1531,8 @@ void DataServiceDatasetOp::MakeDataset(OpKernelContext* ctx,
       max_outstanding_requests, task_refresh_interval_hint_ms_, target_workers_,
       *metadata, iteration_counter, owns_resource, iteration_counter_handle,
       std::move(captured_uncompress_func), cross_trainer_cache_options,
-      data_service_output_types, data_service_output_shapes);
+      max_bytes_per_request_, data_service_output_types,
+      data_service_output_shapes);
   if (should_uncompress) {
     VLOG(2) << "Inserting a ParallelMap dataset to uncompress tf.data service "
             << "dataset " << dataset_id << ".";
@@ -19,6 +19,7 @@ limitations under the License.
 #include "tensorflow/core/framework/partial_tensor_shape.h"
 #include "tensorflow/core/framework/tensor.h"
 #include "tensorflow/core/framework/tensor_shape.h"
+#include "tensorflow/core/kernels/file_metadata_cache.h"
 #include "tensorflow/core/lib/core/blocking_counter.h"
 #include "tensorflow/core/lib/core/errors.h"
 #include "tensorflow/core/lib/core/threadpool.h"
@@ -297,7 +298,8 @@ class MatchingFilesDatasetOp : public DatasetOpKernel {
           // If current_path is a directory, search its children.
           const string& current_dir = current_path.first;
           std::vector<string> children;
-          ret.Update(fs->GetChildren(current_dir, &children));
+          ret.Update(
+              FileMetadataCache::Global()->GetChildren(current_dir, &children));
 
           // Handle the error cases: 1) continue the search if the status is
           // NOT_FOUND; 2) return the non-ok status immediately if it is not
@@ -317,7 +319,7 @@ class MatchingFilesDatasetOp : public DatasetOpKernel {
 
           // This IsDirectory call can be expensive for some FS. Parallelizing
           // it.
-          auto is_directory_fn = [fs, current_dir, &children, &fixed_prefix,
+          auto is_directory_fn = [current_dir, &children, &fixed_prefix,
                                   &children_dir_status](int i) {
             const string child_path = io::JoinPath(current_dir, children[i]);
             // In case the child_path doesn't start with the fixed_prefix, then
@@ -326,7 +328,8 @@ class MatchingFilesDatasetOp : public DatasetOpKernel {
               children_dir_status[i] =
                   errors::Cancelled("Operation not needed");
             } else {
-              children_dir_status[i] = fs->IsDirectory(child_path);
+              children_dir_status[i] =
+                  FileMetadataCache::Global()->IsDirectory(child_path);
             }
           };
 
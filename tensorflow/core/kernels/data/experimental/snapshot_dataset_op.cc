@@ -83,6 +83,8 @@ namespace experimental {
     SnapshotDatasetV2Op::kReaderFuncTarguments;
 /* static */ constexpr const char* const
     SnapshotDatasetV2Op::kShardFuncTarguments;
+/* static */ constexpr const char* const
+    SnapshotDatasetV2Op::kNumParallelDecodes;
 /* static */ constexpr const int SnapshotDatasetV2Op::kFileFormatVersion;
 
 // ==== Snapshot Implementation ====
@@ -121,7 +123,8 @@ class SnapshotDatasetV2Op::Dataset : public DatasetBase {
           const std::string& path, const std::string& compression,
           const std::string& reader_prefix, const std::string& writer_prefix,
           std::unique_ptr<CapturedFunction> reader_func,
-          std::unique_ptr<CapturedFunction> shard_func)
+          std::unique_ptr<CapturedFunction> shard_func,
+          int64_t num_parallel_decodes)
       : DatasetBase(DatasetContext(ctx)),
         input_(input),
         hash_(hash),
@@ -129,6 +132,7 @@ class SnapshotDatasetV2Op::Dataset : public DatasetBase {
         compression_(compression),
         reader_prefix_(reader_prefix),
         writer_prefix_(writer_prefix),
+        num_parallel_decodes_(num_parallel_decodes),
         reader_func_(std::move(reader_func)),
         shard_func_(std::move(shard_func)) {
     input_->Ref();
@@ -220,6 +224,9 @@ class SnapshotDatasetV2Op::Dataset : public DatasetBase {
     b->BuildAttrValue(shard_func_other_args_types,
                       &shard_func_arguments_types_attr);
 
+    AttrValue num_parallel_decodes_attr;
+    b->BuildAttrValue(num_parallel_decodes_, &num_parallel_decodes_attr);
+
     return b->AddDataset(
         this,
         /*inputs=*/
@@ -236,7 +243,8 @@ class SnapshotDatasetV2Op::Dataset : public DatasetBase {
          {kReaderFunc, reader_func_attr},
          {kShardFunc, shard_func_attr},
          {kReaderFuncTarguments, reader_func_arguments_types_attr},
-         {kShardFuncTarguments, shard_func_arguments_types_attr}},
+         {kShardFuncTarguments, shard_func_arguments_types_attr},
+         {kNumParallelDecodes, num_parallel_decodes_attr}},
         output);
   }
 
@@ -247,6 +255,7 @@ class SnapshotDatasetV2Op::Dataset : public DatasetBase {
   const std::string compression_;
   const std::string reader_prefix_;
   const std::string writer_prefix_;
+  const int64_t num_parallel_decodes_;
 
   std::unique_ptr<CapturedFunction> reader_func_;
   std::unique_ptr<CapturedFunction> shard_func_;
@@ -287,7 +296,7 @@ class SnapshotDatasetV2Op::Dataset : public DatasetBase {
           ctx->env(), snapshot_shard_dirs, dataset()->compression_,
           metadata.version(), dataset()->output_dtypes(),
           dataset()->output_shapes(), start_index_,
-          &dataset_of_snapshot_files));
+          dataset()->num_parallel_decodes_, &dataset_of_snapshot_files));
 
       Tensor input_dataset_tensor(DT_VARIANT, TensorShape({}));
       TF_RETURN_IF_ERROR(StoreDatasetInVariantTensor(dataset_of_snapshot_files,
@@ -748,6 +757,14 @@ SnapshotDatasetV2Op::SnapshotDatasetV2Op(OpKernelConstruction* ctx)
   int64_t hash;
   OP_REQUIRES_OK(ctx, ctx->GetAttr(kHash, &hash));
   hash_ = static_cast<uint64>(hash);
+  if (ctx->HasAttr(kNumParallelDecodes)) {
+    OP_REQUIRES_OK(ctx,
+                   ctx->GetAttr(kNumParallelDecodes, &num_parallel_decodes_));
+  }
+  OP_REQUIRES(ctx, num_parallel_decodes_ > 0,
+              errors::InvalidArgument(
+                  "`num_parallel_decodes` must be positive, but got ",
+                  num_parallel_decodes_, "."));
 
   OP_REQUIRES_OK(ctx, FunctionMetadata::Create(ctx, kReaderFunc, reader_params,
                                                &reader_func_metadata_));
@@ -792,7 +809,7 @@ void SnapshotDatasetV2Op::MakeDataset(OpKernelContext* ctx, DatasetBase* input,
 
   *output = new SnapshotDatasetV2Op::Dataset(
       ctx, input, hash, path, compression, reader_prefix_, writer_prefix_,
-      std::move(reader_func), std::move(shard_func));
+      std::move(reader_func), std::move(shard_func), num_parallel_decodes_);
 }
 
 namespace {
@@ -60,6 +60,8 @@ class SnapshotDatasetV2Op : public UnaryDatasetOpKernel {
   static constexpr const char* const kReaderFuncTarguments =
       "Treader_func_args";
   static constexpr const char* const kShardFuncTarguments = "Tshard_func_args";
+  static constexpr const char* const kNumParallelDecodes =
+      "num_parallel_decodes";
   // Note: If a new constant is declared here, it *must* be defined in
   // snapshot_dataset_op.cc, otherwise it will not compile in debug mode.
 
@@ -83,6 +85,7 @@ class SnapshotDatasetV2Op : public UnaryDatasetOpKernel {
   std::string writer_prefix_;
   bool hash_valid_;
   uint64 hash_;
+  int64_t num_parallel_decodes_ = 1;
 
   std::shared_ptr<FunctionMetadata> reader_func_metadata_;
   std::shared_ptr<FunctionMetadata> shard_func_metadata_;
@@ -67,8 +67,9 @@ void MakeDatasetHelper(OpKernelContext* ctx, bool has_captured_ref,
     int64_t cpu_budget;
     int64_t ram_budget;
     GetModelDatasetParams(options, &algorithm, &cpu_budget, &ram_budget);
-    ModelDatasetOp::MakeDatasetFromOptions(ctx, input, algorithm, cpu_budget,
-                                           ram_budget, output);
+    ModelDatasetOp::MakeDatasetFromOptions(
+        ctx, input, algorithm, cpu_budget, ram_budget,
+        options.autotune_options().warm_start_dir(), output);
     input->Unref();
     input = *output;
   }
@@ -14,6 +14,8 @@ limitations under the License.
 ==============================================================================*/
 #include "tensorflow/core/kernels/data/fixed_length_record_dataset_op.h"
 
+#include <algorithm>
+
 #include "tensorflow/core/data/name_utils.h"
 #include "tensorflow/core/data/utils.h"
 #include "tensorflow/core/framework/metrics.h"
@@ -94,6 +96,63 @@ class FixedLengthRecordDatasetOp::Dataset : public DatasetBase {
     return name_utils::DatasetDebugString(kDatasetType, params);
   }
 
+  // The cardinality of uncompressed files follows from the file sizes, which
+  // are only read with a moderate compute level.
+  int64_t CardinalityInternal(CardinalityOptions options) const override {
+    if (!compression_type_.empty() ||
+        options.compute_level() <
+            CardinalityOptions::CARDINALITY_COMPUTE_MODERATE) {
+      return kUnknownCardinality;
+    }
+    mutex_lock l(num_records_mu_);
+    if (!ComputeNumRecordsLocked(Env::Default()).ok()) {
+      return kUnknownCardinality;
+    }
+    return cumulative_num_records_.empty() ? 0
+                                           : cumulative_num_records_.back();
+  }
+
+  Status Get(OpKernelContext* ctx, int64 index,
+             std::vector<Tensor>* out_tensors) const override {
+    TF_RETURN_IF_ERROR(CheckRandomAccessCompatible(index));
+    size_t file_index;
+    int64_t record_number;
+    {
+      mutex_lock l(num_records_mu_);
+      TF_RETURN_IF_ERROR(ComputeNumRecordsLocked(ctx->env()));
+      file_index = std::upper_bound(cumulative_num_records_.begin(),
+                                    cumulative_num_records_.end(), index) -
+                   cumulative_num_records_.begin();
+      record_number = index;
+      if (file_index > 0) {
+        record_number -= cumulative_num_records_[file_index - 1];
+      }
+    }
+    std::unique_ptr<RandomAccessFile> file;
+    TF_RETURN_IF_ERROR(ctx->env()->NewRandomAccessFile(
+        TranslateFileName(filenames_[file_index]), &file));
+    Tensor record(DT_STRING, TensorShape({}));
+    tstring& data = record.scalar<tstring>()();
+    data.resize_uninitialized(record_bytes_);
+    StringPiece result;
+    TF_RETURN_IF_ERROR(
+        file->Read(header_bytes_ + record_number * record_bytes_,
+                   record_bytes_, &result, &data[0]));
+    if (result.size() != record_bytes_) {
+      return errors::DataLoss("Truncated record ", record_number, " in file ",
+                              filenames_[file_index]);
+    }
+    if (result.data() != data.data()) {
+      data.assign(result.data(), result.size());
+    }
+    static monitoring::CounterCell* bytes_counter =
+        metrics::GetTFDataBytesReadCounter(kDatasetType);
+    bytes_counter->IncrementBy(record_bytes_);
+    out_tensors->clear();
+    out_tensors->push_back(std::move(record));
+    return OkStatus();
+  }
+
   Status InputDatasets(std::vector<const DatasetBase*>* inputs) const override {
     return OkStatus();
   }
@@ -169,29 +228,48 @@ class FixedLengthRecordDatasetOp::Dataset : public DatasetBase {
         }
 
         // Actually move on to next file.
-        uint64 file_size;
-        const std::string& next_filename =
-            dataset()->filenames_[current_file_index_];
-        TF_RETURN_IF_ERROR(ctx->env()->GetFileSize(next_filename, &file_size));
-        file_pos_limit_ = file_size - dataset()->footer_bytes_;
+        TF_RETURN_IF_ERROR(OpenNextFileLocked(ctx));
+      } while (true);
+    }
 
-        uint64 body_size =
-            file_size - (dataset()->header_bytes_ + dataset()->footer_bytes_);
-
-        if (body_size % dataset()->record_bytes_ != 0) {
-          return errors::InvalidArgument(
-              "Excluding the header (", dataset()->header_bytes_,
-              " bytes) and footer (", dataset()->footer_bytes_,
-              " bytes), input file \"", next_filename, "\" has body length ",
-              body_size,
-              " bytes, which is not an exact multiple of the record length (",
-              dataset()->record_bytes_, " bytes).");
+    // Records have a fixed length, so skipping seeks past them instead of
+    // reading them.
+    Status SkipInternal(IteratorContext* ctx, int num_to_skip,
+                        bool* end_of_sequence, int* num_skipped) override {
+      *num_skipped = 0;
+      mutex_lock l(mu_);
+      do {
+        if (input_buffer_) {
+          const int64_t current_pos = input_buffer_->Tell();
+          DCHECK_GE(file_pos_limit_, 0);
+          const int64_t num_records =
+              std::min<int64_t>(num_to_skip - *num_skipped,
+                                (file_pos_limit_ - current_pos) /
+                                    dataset()->record_bytes_);
+          if (num_records > 0) {
+            TF_RETURN_IF_ERROR(input_buffer_->Seek(
+                current_pos + num_records * dataset()->record_bytes_));
+            *num_skipped += num_records;
+          }
+          if (*num_skipped == num_to_skip) {
+            *end_of_sequence = false;
+            return OkStatus();
+          }
+
+          // We have reached the end of the current file, so maybe move on to
+          // next file.
+          input_buffer_.reset();
+          file_.reset();
+          ++current_file_index_;
         }
-        TF_RETURN_IF_ERROR(ctx->env()->NewRandomAccessFile(
-            TranslateFileName(next_filename), &file_));
-        input_buffer_ = std::make_unique<io::InputBuffer>(
-            file_.get(), dataset()->buffer_size_);
-        TF_RETURN_IF_ERROR(input_buffer_->SkipNBytes(dataset()->header_bytes_));
+
+        // Iteration ends when there are no more files to process.
+        if (current_file_index_ == dataset()->filenames_.size()) {
+          *end_of_sequence = true;
+          return OkStatus();
+        }
+
+        TF_RETURN_IF_ERROR(OpenNextFileLocked(ctx));
       } while (true);
     }
 
@@ -243,6 +321,34 @@ class FixedLengthRecordDatasetOp::Dataset : public DatasetBase {
     }
 
    private:
+    // Opens the file at `current_file_index_` and skips its header.
+    Status OpenNextFileLocked(IteratorContext* ctx)
+        TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+      uint64 file_size;
+      const std::string& next_filename =
+          dataset()->filenames_[current_file_index_];
+      TF_RETURN_IF_ERROR(ctx->env()->GetFileSize(next_filename, &file_size));
+      file_pos_limit_ = file_size - dataset()->footer_bytes_;
+
+      uint64 body_size =
+          file_size - (dataset()->header_bytes_ + dataset()->footer_bytes_);
+
+      if (body_size % dataset()->record_bytes_ != 0) {
+        return errors::InvalidArgument(
+            "Excluding the header (", dataset()->header_bytes_,
+            " bytes) and footer (", dataset()->footer_bytes_,
+            " bytes), input file \"", next_filename, "\" has body length ",
+            body_size,
+            " bytes, which is not an exact multiple of the record length (",
+            dataset()->record_bytes_, " bytes).");
+      }
+      TF_RETURN_IF_ERROR(ctx->env()->NewRandomAccessFile(
+          TranslateFileName(next_filename), &file_));
+      input_buffer_ = std::make_unique<io::InputBuffer>(
+          file_.get(), dataset()->buffer_size_);
+      return input_buffer_->SkipNBytes(dataset()->header_bytes_);
+    }
+
     mutex mu_;
     size_t current_file_index_ TF_GUARDED_BY(mu_) = 0;
     std::unique_ptr<RandomAccessFile> file_
@@ -450,6 +556,36 @@ class FixedLengthRecordDatasetOp::Dataset : public DatasetBase {
     tstring lookahead_cache_ TF_GUARDED_BY(mu_);
   };
 
+  // Computes the number of records in each file from its size, once.
+  Status ComputeNumRecordsLocked(Env* env) const
+      TF_EXCLUSIVE_LOCKS_REQUIRED(num_records_mu_) {
+    if (!num_records_status_.ok() || !cumulative_num_records_.empty() ||
+        filenames_.empty()) {
+      return num_records_status_;
+    }
+    std::vector<int64_t> cumulative_num_records(filenames_.size());
+    int64_t num_records = 0;
+    for (size_t i = 0; i < filenames_.size(); ++i) {
+      uint64 file_size;
+      num_records_status_ = env->GetFileSize(filenames_[i], &file_size);
+      if (!num_records_status_.ok()) return num_records_status_;
+      const int64_t body_size = file_size - (header_bytes_ + footer_bytes_);
+      if (body_size < 0 || body_size % record_bytes_ != 0) {
+        num_records_status_ = errors::InvalidArgument(
+            "Excluding the header (", header_bytes_, " bytes) and footer (",
+            footer_bytes_, " bytes), input file \"", filenames_[i],
+            "\" has body length ", body_size,
+            " bytes, which is not an exact multiple of the record length (",
+            record_bytes_, " bytes).");
+        return num_records_status_;
+      }
+      num_records += body_size / record_bytes_;
+      cumulative_num_records[i] = num_records;
+    }
+    cumulative_num_records_ = std::move(cumulative_num_records);
+    return OkStatus();
+  }
+
   const std::vector<string> filenames_;
   const int64_t header_bytes_;
   const int64_t record_bytes_;
@@ -457,6 +593,13 @@ class FixedLengthRecordDatasetOp::Dataset : public DatasetBase {
   const int64_t buffer_size_;
   const tstring compression_type_;
   const int op_version_;
+
+  mutable mutex num_records_mu_;
+  // The number of records in the files up to and including each file.
+  // Computed on the first random access.
+  mutable std::vector<int64_t> cumulative_num_records_
+      TF_GUARDED_BY(num_records_mu_);
+  mutable Status num_records_status_ TF_GUARDED_BY(num_records_mu_);
 };
 
 FixedLengthRecordDatasetOp::FixedLengthRecordDatasetOp(
@@ -189,6 +189,26 @@ GetNextTestCases() {
 ITERATOR_GET_NEXT_TEST_P(FixedLengthRecordDatasetOpTest,
                          FixedLengthRecordDatasetParams, GetNextTestCases())
 
+std::vector<SkipTestCase<FixedLengthRecordDatasetParams>> SkipTestCases() {
+  return {{/*dataset_params=*/FixedLengthRecordDatasetParams1(),
+           /*num_to_skip*/ 4, /*expected_num_skipped*/ 4, /*get_next*/ true,
+           /*expected_outputs=*/
+           CreateTensors<tstring>(TensorShape({}), {{"bbb"}})},
+          {/*dataset_params=*/FixedLengthRecordDatasetParams3(),
+           /*num_to_skip*/ 2, /*expected_num_skipped*/ 2, /*get_next*/ true,
+           /*expected_outputs=*/
+           CreateTensors<tstring>(TensorShape({}), {{"333"}})},
+          {/*dataset_params=*/FixedLengthRecordDatasetParams3(),
+           /*num_to_skip*/ 4, /*expected_num_skipped*/ 4, /*get_next*/ true,
+           /*expected_outputs=*/
+           CreateTensors<tstring>(TensorShape({}), {{"bbb"}})},
+          {/*dataset_params=*/FixedLengthRecordDatasetParams3(),
+           /*num_to_skip*/ 7, /*expected_num_skipped*/ 5}};
+}
+
+ITERATOR_SKIP_TEST_P(FixedLengthRecordDatasetOpTest,
+                     FixedLengthRecordDatasetParams, SkipTestCases())
+
 TEST_F(FixedLengthRecordDatasetOpTest, DatasetNodeName) {
   auto dataset_params = FixedLengthRecordDatasetParams1();
   TF_ASSERT_OK(Initialize(dataset_params));
@@ -222,6 +242,32 @@ TEST_F(FixedLengthRecordDatasetOpTest, Cardinality) {
   TF_ASSERT_OK(CheckDatasetCardinality(kUnknownCardinality));
 }
 
+TEST_F(FixedLengthRecordDatasetOpTest, RandomAccess) {
+  auto dataset_params = FixedLengthRecordDatasetParams3();
+  TF_ASSERT_OK(Initialize(dataset_params));
+  CardinalityOptions options;
+  options.set_compute_level(CardinalityOptions::CARDINALITY_COMPUTE_MODERATE);
+  EXPECT_EQ(dataset_->Cardinality(options), 5);
+  const std::vector<tstring> expected = {"111", "222", "333", "aaa", "bbb"};
+  for (int64_t i : {4, 0, 3, 1, 2}) {
+    std::vector<Tensor> out_tensors;
+    TF_ASSERT_OK(dataset_->Get(dataset_ctx_.get(), i, &out_tensors));
+    ASSERT_EQ(out_tensors.size(), 1);
+    EXPECT_EQ(out_tensors[0].scalar<tstring>()(), expected[i]);
+  }
+  std::vector<Tensor> out_tensors;
+  EXPECT_TRUE(errors::IsOutOfRange(
+      dataset_->Get(dataset_ctx_.get(), 5, &out_tensors)));
+}
+
+TEST_F(FixedLengthRecordDatasetOpTest, CompressedFilesAreNotRandomAccessible) {
+  auto dataset_params = FixedLengthRecordDatasetParams1();
+  TF_ASSERT_OK(Initialize(dataset_params));
+  CardinalityOptions options;
+  options.set_compute_level(CardinalityOptions::CARDINALITY_COMPUTE_MODERATE);
+  EXPECT_EQ(dataset_->Cardinality(options), kUnknownCardinality);
+}
+
 TEST_F(FixedLengthRecordDatasetOpTest, IteratorOutputDtypes) {
   auto dataset_params = FixedLengthRecordDatasetParams1();
   TF_ASSERT_OK(Initialize(dataset_params));
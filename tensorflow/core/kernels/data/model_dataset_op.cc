@@ -21,6 +21,8 @@ limitations under the License.
 // dependencies are available there. The op is replaced with a no-op.
 #if !defined(IS_MOBILE_PLATFORM)
 #include "absl/memory/memory.h"
+#include "tensorflow/core/data/hash_utils.h"
+#include "tensorflow/core/data/serialization_utils.h"
 #include "tensorflow/core/framework/dataset.h"
 #include "tensorflow/core/framework/metrics.h"
 #include "tensorflow/core/framework/model.h"
@@ -28,6 +30,7 @@ limitations under the License.
 #include "tensorflow/core/framework/tensor.h"
 #include "tensorflow/core/lib/random/random.h"
 #include "tensorflow/core/platform/cpu_info.h"
+#include "tensorflow/core/platform/path.h"
 #include "tensorflow/core/platform/stringprintf.h"
 #include "tensorflow/core/util/ptr_util.h"
 
@@ -38,6 +41,47 @@ namespace {
 // Default share of available RAM that can be used by model's internal buffers.
 constexpr double kRamBudgetShare = 0.5;
 
+// Returns the file in `warm_start_dir` that holds the tunable parameter values
+// of `input`. Pipelines with the same graph share the file.
+Status GetWarmStartFile(OpKernelContext* ctx, const DatasetBase* input,
+                        const std::string& warm_start_dir,
+                        std::string* warm_start_file) {
+  SerializationContext::Params params(ctx);
+  std::vector<std::pair<string, Tensor>> input_list;
+  params.input_list = &input_list;
+  params.external_state_policy =
+      SerializationContext::ExternalStatePolicy::kIgnore;
+  GraphDef graph_def;
+  TF_RETURN_IF_ERROR(
+      AsGraphDef(input, SerializationContext(params), &graph_def));
+  uint64 hash;
+  TF_RETURN_IF_ERROR(HashGraph(graph_def, &hash));
+  TF_RETURN_IF_ERROR(ctx->env()->RecursivelyCreateDir(warm_start_dir));
+  *warm_start_file = io::JoinPath(
+      warm_start_dir, strings::Printf("autotune_%llx.pb",
+                                      static_cast<unsigned long long>(hash)));
+  return OkStatus();
+}
+
+// Returns the warm start file for `input`, or an empty string if warm starting
+// is disabled or the file cannot be determined.
+std::string MaybeGetWarmStartFile(OpKernelContext* ctx,
+                                  const DatasetBase* input,
+                                  const std::string& warm_start_dir) {
+  if (warm_start_dir.empty()) {
+    return "";
+  }
+  std::string warm_start_file;
+  Status s = GetWarmStartFile(ctx, input, warm_start_dir, &warm_start_file);
+  if (!s.ok()) {
+    LOG(WARNING) << "Failed to determine the autotuning warm start file in "
+                 << warm_start_dir << ". Autotuning will start from the "
+                 << "default parameter values: " << s;
+    return "";
+  }
+  return warm_start_file;
+}
+
 }  // namespace
 
 /* static */ constexpr const char* const ModelDatasetOp::kDatasetType;
@@ -45,23 +89,28 @@ constexpr double kRamBudgetShare = 0.5;
 /* static */ constexpr const char* const ModelDatasetOp::kAlgorithm;
 /* static */ constexpr const char* const ModelDatasetOp::kCpuBudget;
 /* static */ constexpr const char* const ModelDatasetOp::kRamBudget;
+/* static */ constexpr const char* const ModelDatasetOp::kWarmStartDir;
 
 class ModelDatasetOp::Dataset : public DatasetBase {
  public:
   Dataset(OpKernelContext* ctx, const DatasetBase* input,
           model::AutotuneAlgorithm algorithm, int64_t cpu_budget,
-          int64_t ram_budget)
-      : Dataset(DatasetContext(ctx), input, algorithm, cpu_budget, ram_budget) {
-  }
+          int64_t ram_budget, const std::string& warm_start_dir)
+      : Dataset(DatasetContext(ctx), input, algorithm, cpu_budget, ram_budget,
+                warm_start_dir,
+                MaybeGetWarmStartFile(ctx, input, warm_start_dir)) {}
 
   Dataset(DatasetContext&& ctx, const DatasetBase* input,
           model::AutotuneAlgorithm algorithm, int64_t cpu_budget,
-          int64_t ram_budget)
+          int64_t ram_budget, const std::string& warm_start_dir,
+          const std::string& warm_start_file)
       : DatasetBase(std::move(ctx)),
         input_(input),
         algorithm_(algorithm),
         cpu_budget_(cpu_budget),
         ram_budget_(ram_budget),
+        warm_start_dir_(warm_start_dir),
+        warm_start_file_(warm_start_file),
         traceme_metadata_(
             {{"algorithm", model::AutotuneAlgorithm_Name(algorithm)},
              {"cpu_budget",
@@ -111,12 +160,15 @@ class ModelDatasetOp::Dataset : public DatasetBase {
     b->BuildAttrValue(cpu_budget_, &cpu_budget_attr);
     AttrValue ram_budget_attr;
     b->BuildAttrValue(ram_budget_, &ram_budget_attr);
+    AttrValue warm_start_dir_attr;
+    b->BuildAttrValue(warm_start_dir_, &warm_start_dir_attr);
 
     TF_RETURN_IF_ERROR(
         b->AddDataset(this, {input_graph_node},
                       {std::make_pair(kAlgorithm, algorithm_attr),
                        std::make_pair(kCpuBudget, cpu_budget_attr),
-                       std::make_pair(kRamBudget, ram_budget_attr)},
+                       std::make_pair(kRamBudget, ram_budget_attr),
+                       std::make_pair(kWarmStartDir, warm_start_dir_attr)},
                       output));
     return OkStatus();
   }
@@ -138,8 +190,13 @@ class ModelDatasetOp::Dataset : public DatasetBase {
     ~Iterator() override { cancellation_manager_->StartCancel(); }
 
     Status Initialize(IteratorContext* ctx) override {
-      return dataset()->input_->MakeIterator(IteratorContext(CreateParams(ctx)),
-                                             this, prefix(), &input_impl_);
+      TF_RETURN_IF_ERROR(
+          dataset()->input_->MakeIterator(IteratorContext(CreateParams(ctx)),
+                                          this, prefix(), &input_impl_));
+      if (!ctx->model() && !dataset()->warm_start_file_.empty()) {
+        MaybeWarmStart(dataset()->warm_start_file_);
+      }
+      return OkStatus();
     }
 
     Status GetNextInternal(IteratorContext* ctx,
@@ -184,6 +241,20 @@ class ModelDatasetOp::Dataset : public DatasetBase {
       return params;
     }
 
+    // Starts from the tunable parameter values saved by an earlier run of the
+    // same pipeline, if any, and saves the optimized values for later runs.
+    void MaybeWarmStart(const std::string& warm_start_file) {
+      Status s = model_->RestoreTunableParameters(warm_start_file);
+      if (errors::IsNotFound(s)) {
+        VLOG(1) << "No autotuning warm start file found at "
+                << warm_start_file;
+      } else if (!s.ok()) {
+        LOG(WARNING) << "Failed to restore tunable parameters from "
+                     << warm_start_file << ": " << s;
+      }
+      model_->set_tunable_parameters_file(warm_start_file);
+    }
+
     Status EnsureOptimizationLoopThreadStarted(IteratorContext* ctx)
         TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
       if (!model_thread_) {
@@ -214,6 +285,10 @@ class ModelDatasetOp::Dataset : public DatasetBase {
   const model::AutotuneAlgorithm algorithm_;
   const int64_t cpu_budget_;
   const int64_t ram_budget_;
+  const std::string warm_start_dir_;
+  // File for the tunable parameter values of this pipeline, or empty if warm
+  // starting is disabled.
+  const std::string warm_start_file_;
   const TraceMeMetadata traceme_metadata_;
 };
 
@@ -223,11 +298,13 @@ void ModelDatasetOp::MakeDatasetFromOptions(OpKernelContext* ctx,
                                             model::AutotuneAlgorithm algorithm,
                                             int64_t cpu_budget,
                                             int64_t ram_budget,
+                                            const std::string& warm_start_dir,
                                             DatasetBase** output) {
   *output = new ModelDatasetOp::Dataset(
       DatasetContext(DatasetContext::Params(
           {ModelDatasetOp::kDatasetType, ModelDatasetOp::kDatasetOp})),
-      input, algorithm, cpu_budget, ram_budget);
+      input, algorithm, cpu_budget, ram_budget, warm_start_dir,
+      MaybeGetWarmStartFile(ctx, input, warm_start_dir));
 }
 
 ModelDatasetOp::ModelDatasetOp(OpKernelConstruction* ctx)
@@ -251,12 +328,15 @@ ModelDatasetOp::ModelDatasetOp(OpKernelConstruction* ctx)
   OP_REQUIRES(ctx, ram_budget_ >= 0,
               errors::InvalidArgument("RAM budget must be positive but is ",
                                       ram_budget_, "."));
+  if (ctx->HasAttr(kWarmStartDir)) {
+    OP_REQUIRES_OK(ctx, ctx->GetAttr(kWarmStartDir, &warm_start_dir_));
+  }
 }
 
 void ModelDatasetOp::MakeDataset(OpKernelContext* ctx, DatasetBase* input,
                                  DatasetBase** output) {
   *output = new ModelDatasetOp::Dataset(ctx, input, algorithm_, cpu_budget_,
-                                        ram_budget_);
+                                        ram_budget_, warm_start_dir_);
 }
 
 namespace {
@@ -273,6 +353,7 @@ void ModelDatasetOp::MakeDatasetFromOptions(OpKernelContext* ctx,
                                             DatasetBase* input,
                                             model::AutotuneAlgorithm algorithm,
                                             bool cpu_budget, bool ram_budget,
+                                            const std::string& warm_start_dir,
                                             DatasetBase** output) {
   input->Ref();
   *output = input;
@@ -33,12 +33,14 @@ class ModelDatasetOp : public UnaryDatasetOpKernel {
   static constexpr const char* const kAlgorithm = "algorithm";
   static constexpr const char* const kCpuBudget = "cpu_budget";
   static constexpr const char* const kRamBudget = "ram_budget";
+  static constexpr const char* const kWarmStartDir = "warm_start_dir";
 
   // Executes the logic of the ModelDatasetOp directly (as opposed to through
   // executing the ModelDatasetOp op kernel).
   static void MakeDatasetFromOptions(OpKernelContext* ctx, DatasetBase* input,
                                      model::AutotuneAlgorithm algorithm,
                                      int64_t cpu_budget, int64_t ram_budget,
+                                     const std::string& warm_start_dir,
                                      DatasetBase** output);
 
   explicit ModelDatasetOp(OpKernelConstruction* ctx);
@@ -53,6 +55,7 @@ class ModelDatasetOp : public UnaryDatasetOpKernel {
   model::AutotuneAlgorithm algorithm_;
   int64_t cpu_budget_;
   int64_t ram_budget_;
+  std::string warm_start_dir_;
 };
 
 }  // namespace data
@@ -71,6 +74,7 @@ class ModelDatasetOp : public UnaryDatasetOpKernel {
   static void MakeDatasetFromOptions(OpKernelContext* ctx, DatasetBase* input,
                                      model::AutotuneAlgorithm algorithm,
                                      bool cpu_budget, bool ram_budget,
+                                     const std::string& warm_start_dir,
                                      DatasetBase** output);
 
   explicit ModelDatasetOp(OpKernelConstruction* ctx);
@@ -14,6 +14,7 @@ limitations under the License.
 ==============================================================================*/
 #include "tensorflow/core/kernels/data/padded_batch_dataset_op.h"
 
+#include "tensorflow/core/data/batch_buffer_pool.h"
 #include "tensorflow/core/data/dataset_utils.h"
 #include "tensorflow/core/data/name_utils.h"
 #include "tensorflow/core/framework/dataset.h"
@@ -188,6 +189,8 @@ class PaddedBatchDatasetOp::Dataset : public DatasetBase {
         : DatasetIterator<Dataset>(params) {}
 
     Status Initialize(IteratorContext* ctx) override {
+      buffer_pool_.reset(new BatchBufferPool(
+          ctx->allocator({}), BatchBufferPool::kDefaultMaxCachedBytes));
       return dataset()->input_->MakeIterator(ctx, this, prefix(), &input_impl_);
     }
 
@@ -331,9 +334,10 @@ class PaddedBatchDatasetOp::Dataset : public DatasetBase {
 
         // 2. Copy each batch element to the appropriate location in
         // the output component tensor.
-        out_tensors->emplace_back(ctx->allocator({}),
-                                  output_dtypes()[component_index],
-                                  batch_component_shape);
+        out_tensors->emplace_back();
+        TF_RETURN_IF_ERROR(buffer_pool_->Allocate(
+            output_dtypes()[component_index], batch_component_shape,
+            &out_tensors->back()));
         Tensor& batch_component = out_tensors->back();
         TF_RETURN_IF_ERROR(batch_util::SetElementZero(
             &batch_component, dataset()->padding_values_[component_index]));
@@ -398,6 +402,8 @@ class PaddedBatchDatasetOp::Dataset : public DatasetBase {
       return OkStatus();
     }
 
+    // Recycles the buffers of the batches once they are no longer referenced.
+    core::RefCountPtr<BatchBufferPool> buffer_pool_;
     mutex mu_;
     std::unique_ptr<IteratorBase> input_impl_ TF_GUARDED_BY(mu_);
   };
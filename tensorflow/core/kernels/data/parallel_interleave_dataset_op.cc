@@ -151,6 +151,15 @@ int64_t ComputeMaxBufferedElements(int64_t prefetch_input_elements,
   return (prefetch_input_elements + cycle_length) * buffer_output_elements;
 }
 
+// Returns whether the number of active elements in the interleave cycle should
+// be autotuned. Changing the active cycle length changes the order in which
+// elements are produced, so this is only done when the user lets both the cycle
+// length be autotuned and outputs be produced in nondeterministic order.
+bool UseAdaptiveCycleLength(bool autotune_cycle_length, bool deterministic) {
+  return autotune_cycle_length && !deterministic &&
+         GetExperiments().contains("adaptive_interleave_cycle_length");
+}
+
 int64_t OpVersionFromOpName(absl::string_view op_name) {
   if (op_name == kParallelInterleaveDatasetV2) {
     return 2;
@@ -173,14 +182,16 @@ class ParallelInterleaveDatasetOp::Dataset : public DatasetBase {
  public:
   Dataset(OpKernelContext* ctx, const DatasetBase* input,
           std::unique_ptr<CapturedFunction> captured_func, int64_t cycle_length,
-          int64_t block_length, int64_t buffer_output_elements,
-          int64_t prefetch_input_elements, int64_t num_parallel_calls,
+          bool autotune_cycle_length, int64_t block_length,
+          int64_t buffer_output_elements, int64_t prefetch_input_elements,
+          int64_t num_parallel_calls,
           DeterminismPolicy deterministic, const DataTypeVector& output_types,
           const std::vector<PartialTensorShape>& output_shapes, int op_version)
       : DatasetBase(DatasetContext(ctx)),
         input_(input),
         captured_func_(std::move(captured_func)),
         cycle_length_(cycle_length),
+        autotune_cycle_length_(autotune_cycle_length),
         block_length_(block_length),
         buffer_output_elements_(
             ComputeBufferOutputElements(buffer_output_elements, block_length)),
@@ -327,6 +338,13 @@ class ParallelInterleaveDatasetOp::Dataset : public DatasetBase {
           num_parallel_calls_(std::make_shared<model::SharedState>(
               params.dataset->num_parallel_calls_, mu_,
               num_parallel_calls_cond_var_)),
+          cycle_length_cond_var_(std::make_shared<condition_variable>()),
+          active_cycle_length_(std::make_shared<model::SharedState>(
+              UseAdaptiveCycleLength(params.dataset->autotune_cycle_length_,
+                                     deterministic)
+                  ? model::kAutotune
+                  : params.dataset->cycle_length_,
+              mu_, cycle_length_cond_var_)),
           deterministic_(deterministic),
           current_elements_(params.dataset->cycle_length_) {}
 
@@ -359,6 +377,11 @@ class ParallelInterleaveDatasetOp::Dataset : public DatasetBase {
         num_parallel_calls_->value = std::min(
             GetAutotuneDefaultParallelism(ctx), dataset()->cycle_length_);
       }
+      // Start with the full cycle and let autotuning shrink it if fewer
+      // concurrently open input elements suffice.
+      if (active_cycle_length_->value == model::kAutotune) {
+        active_cycle_length_->value = dataset()->cycle_length_;
+      }
       ctx_ = std::make_unique<IteratorContext>(*ctx);
       cancellation_manager_ = std::make_unique<CancellationManager>();
       IteratorContext::Params params(ctx);
@@ -424,12 +447,18 @@ class ParallelInterleaveDatasetOp::Dataset : public DatasetBase {
                     static_cast<double>(dataset()->cycle_length_),
                     std::ceil(std::pow(27 * dataset()->cycle_length_, 0.5)))
               : 1;
+      std::shared_ptr<model::Parameter> cycle_length =
+          active_cycle_length_->tunable
+              ? model::MakeParameter(kCycleLength, active_cycle_length_,
+                                     /*min=*/1,
+                                     /*max=*/dataset()->cycle_length_)
+              : model::MakeNonTunableParameter(kCycleLength,
+                                               dataset()->cycle_length_);
       return model::MakeAsyncInterleaveManyNode(
           std::move(args),
           {model::MakeParameter(kParallelism, num_parallel_calls_, /*min=*/min,
                                 /*max=*/dataset()->cycle_length_),
-           model::MakeNonTunableParameter(kCycleLength,
-                                          dataset()->cycle_length_),
+           std::move(cycle_length),
            model::MakeNonTunableParameter(kDeterministic,
                                           deterministic_ ? 1.0 : 0.0),
            model::MakeNonTunableParameter(
@@ -647,7 +676,7 @@ class ParallelInterleaveDatasetOp::Dataset : public DatasetBase {
 
     void EnsureInitialElementsCreated() TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
       if (!initial_elements_created_) {
-        for (int i = 0; i < dataset()->cycle_length_; ++i) {
+        for (int i = 0; i < ActiveCycleLength(); ++i) {
           current_elements_[i] = MakeElement();
           if (!current_elements_[i]) {
             break;
@@ -696,6 +725,9 @@ class ParallelInterleaveDatasetOp::Dataset : public DatasetBase {
       if (deterministic_) {
         return ConsumeHelper(result);
       }
+      if (active_cycle_length_->tunable) {
+        FillActiveCycle();
+      }
       // If we are allowed to be nondeterministic (i.e. return results out of
       // order), try to find an element in the cycle that has a result
       // available.
@@ -746,10 +778,14 @@ class ParallelInterleaveDatasetOp::Dataset : public DatasetBase {
           // The element is still producing results, so we wait.
           return false;
         }
-        // We've consumed all results from the element. Get a new element from
-        // future_elements, or create a new element if no future elements are
-        // available.
-        if (!future_elements_.empty()) {
+        // We've consumed all results from the element. If autotuning has
+        // shrunk the cycle below this slot, retire the slot. Otherwise, get a
+        // new element from future_elements, or create a new element if no
+        // future elements are available.
+        if (cycle_index_ >= ActiveCycleLength()) {
+          current_elements_[cycle_index_].reset();
+          UpdateLastValidCurrentElement();
+        } else if (!future_elements_.empty()) {
           std::shared_ptr<Element> future_element =
               std::move(future_elements_.front());
           future_elements_.pop_front();
@@ -770,15 +806,7 @@ class ParallelInterleaveDatasetOp::Dataset : public DatasetBase {
             element->cycle_index = cycle_index_;
             current_workers_cond_var_.notify_one();
           }
-          while (last_valid_current_element_ >= 0 &&
-                 !current_elements_[last_valid_current_element_]) {
-            last_valid_current_element_--;
-            if (cycle_index_ > last_valid_current_element_) {
-              // We are about to move the cycle index below in
-              // AdvanceToNextInCycle().
-              cycle_index_ = last_valid_current_element_;
-            }
-          }
+          UpdateLastValidCurrentElement();
         }
         if (last_valid_current_element_ != -1) {
           AdvanceToNextInCycle();
@@ -786,6 +814,72 @@ class ParallelInterleaveDatasetOp::Dataset : public DatasetBase {
       }
     }
 
+    // Moves `last_valid_current_element_` back past trailing empty slots of
+    // `current_elements_`.
+    void UpdateLastValidCurrentElement() TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+      while (last_valid_current_element_ >= 0 &&
+             !current_elements_[last_valid_current_element_]) {
+        last_valid_current_element_--;
+        if (cycle_index_ > last_valid_current_element_) {
+          // We are about to move the cycle index in AdvanceToNextInCycle().
+          cycle_index_ = last_valid_current_element_;
+        }
+      }
+    }
+
+    // Returns the number of slots of `current_elements_` that may hold an
+    // element.
+    int64_t ActiveCycleLength() const TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+      return std::clamp(static_cast<int64_t>(active_cycle_length_->value),
+                        int64_t{1}, dataset()->cycle_length_);
+    }
+
+    // Fills the empty slots of the active cycle after autotuning has grown the
+    // active cycle length.
+    void FillActiveCycle() TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+      if (!initial_elements_created_) {
+        return;
+      }
+      const int64_t active_cycle_length = ActiveCycleLength();
+      for (int64_t i = 0; i < active_cycle_length && !end_of_input_; ++i) {
+        if (current_elements_[i]) {
+          continue;
+        }
+        if (!future_elements_.empty()) {
+          current_elements_[i] = std::move(future_elements_.front());
+          future_elements_.pop_front();
+          if (current_elements_[i]->iterator) {
+            EnableAutotune(ctx_.get(), current_elements_[i]->iterator.get());
+          }
+          future_workers_cond_var_.notify_one();
+        } else {
+          current_elements_[i] = MakeElement();
+          if (!current_elements_[i]) {
+            break;
+          }
+        }
+        current_elements_[i]->cycle_index = i;
+        if (!current_elements_[i]->active) {
+          elements_to_process_.push_back(i);
+          current_workers_cond_var_.notify_one();
+        }
+        last_valid_current_element_ = std::max(last_valid_current_element_, i);
+      }
+    }
+
+    // Returns the number of results to buffer for the given element. Elements
+    // of the current cycle share a readahead budget of `cycle_length *
+    // buffer_output_elements` results, so shrinking the active cycle lets each
+    // remaining element read further ahead.
+    int64_t BufferOutputElements(const std::shared_ptr<Element>& element) const
+        TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+      if (!active_cycle_length_->tunable || element->cycle_index == -1) {
+        return dataset()->buffer_output_elements_;
+      }
+      return dataset()->buffer_output_elements_ * dataset()->cycle_length_ /
+             ActiveCycleLength();
+    }
+
     // Creates a new element.
     std::shared_ptr<Element> MakeElement() TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
       if (end_of_input_) {
@@ -1028,7 +1122,7 @@ class ParallelInterleaveDatasetOp::Dataset : public DatasetBase {
         mutex_lock l(*mu_);
         element->results.push_back(std::move(result));
         NotifyElementUpdate(element);
-        if (element->results.size() == dataset()->buffer_output_elements_) {
+        if (element->results.size() >= BufferOutputElements(element)) {
           break;
         }
       }
@@ -1130,7 +1224,7 @@ class ParallelInterleaveDatasetOp::Dataset : public DatasetBase {
         return true;
       }
       return element->iterator &&
-             element->results.size() < dataset()->buffer_output_elements_;
+             element->results.size() < BufferOutputElements(element);
     }
 
     inline void IncrementCurrentWorkers() TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
@@ -1562,6 +1656,16 @@ class ParallelInterleaveDatasetOp::Dataset : public DatasetBase {
     // Identifies the maximum number of parallel calls.
     const std::shared_ptr<model::SharedState> num_parallel_calls_;
 
+    // Condition variable notified whenever autotuning changes
+    // `active_cycle_length_`. Nothing waits on it because the active cycle
+    // length is re-read each time a result is consumed.
+    std::shared_ptr<condition_variable> cycle_length_cond_var_;
+
+    // Identifies the number of slots of `current_elements_` in use. Tunable
+    // only when `UseAdaptiveCycleLength()` holds; otherwise it is fixed to the
+    // dataset's cycle length.
+    const std::shared_ptr<model::SharedState> active_cycle_length_;
+
     // The number of current workers currently alive or scheduled to be started.
     // This includes current workers which are blocked waiting for work.
     int num_current_workers_ TF_GUARDED_BY(mu_) = 0;
@@ -1635,6 +1739,8 @@ class ParallelInterleaveDatasetOp::Dataset : public DatasetBase {
   const DatasetBase* const input_;
   const std::unique_ptr<CapturedFunction> captured_func_;
   const int64_t cycle_length_;
+  // Whether `cycle_length_` was resolved from `model::kAutotune`.
+  const bool autotune_cycle_length_;
   const int64_t block_length_;
   const int64_t buffer_output_elements_;
   const int64_t prefetch_input_elements_;
@@ -1710,7 +1816,8 @@ void ParallelInterleaveDatasetOp::MakeDataset(OpKernelContext* ctx,
       errors::InvalidArgument("num_parallel_calls must be greater than zero."));
   int64_t cycle_length = 0;
   OP_REQUIRES_OK(ctx, ParseScalarArgument(ctx, kCycleLength, &cycle_length));
-  if (cycle_length == model::kAutotune) {
+  const bool autotune_cycle_length = cycle_length == model::kAutotune;
+  if (autotune_cycle_length) {
     if (num_parallel_calls != model::kAutotune) {
       cycle_length = std::min(num_parallel_calls,
                               static_cast<int64_t>(port::MaxParallelism()));
@@ -1741,9 +1848,10 @@ void ParallelInterleaveDatasetOp::MakeDataset(OpKernelContext* ctx,
   }
 
   *output = new Dataset(
-      ctx, input, std::move(captured_func), cycle_length, block_length,
-      buffer_output_elements, prefetch_input_elements, num_parallel_calls,
-      deterministic_, output_types_, output_shapes_, op_version_);
+      ctx, input, std::move(captured_func), cycle_length,
+      autotune_cycle_length, block_length, buffer_output_elements,
+      prefetch_input_elements, num_parallel_calls, deterministic_,
+      output_types_, output_shapes_, op_version_);
 }
 
 namespace {
@@ -14,6 +14,7 @@ limitations under the License.
 ==============================================================================*/
 #include "tensorflow/core/kernels/data/parallel_map_dataset_op.h"
 
+#include <atomic>
 #include <deque>
 
 #include "tensorflow/core/common_runtime/function.h"
@@ -277,11 +278,13 @@ class ParallelMapDatasetOp::Dataset : public DatasetBase {
       {
         mutex_lock l(*mu_);
         EnsureThreadsStarted(ctx);
+        call_counter_.AddWaiter();
         while (ShouldWait(&result)) {
           RecordStop(ctx);
           cond_var_->wait(l);
           RecordStart(ctx);
         }
+        call_counter_.RemoveWaiter();
         if (cancelled_) {
           return errors::Cancelled("Iterator was cancelled");
         }
@@ -312,10 +315,12 @@ class ParallelMapDatasetOp::Dataset : public DatasetBase {
           dataset()->captured_func_->CheckExternalState()));
       mutex_lock l(*mu_);
       // Wait for all in-flight calls to complete.
-      while (num_calls_ > 0) {
+      call_counter_.AddWaiter();
+      while (call_counter_.num_calls() > 0) {
         cond_var_->wait(l);
       }
-      if (num_calls_ != 0) {
+      call_counter_.RemoveWaiter();
+      if (call_counter_.num_calls() != 0) {
         return errors::FailedPrecondition(
             "Unexpected outstanding calls encountered.");
       }
@@ -420,15 +425,62 @@ class ParallelMapDatasetOp::Dataset : public DatasetBase {
       const int64_t uid;
     };
 
+    // Tracks the number of outstanding calls together with the number of
+    // threads blocked on `cond_var_`, packed into a single atomic word so that
+    // both can be read and updated in one step.
+    //
+    // Call completions are by far the most frequent event on the iterator and
+    // arrive from many threads at once. Packing the two counts lets a
+    // completing call decrement the call count without acquiring `mu_` when
+    // nobody is waiting: a waiter registers itself (while holding `mu_`)
+    // before inspecting the state it waits on, so a lock-free decrement that
+    // wins the race is always observed by any waiter that registers later,
+    // and a decrement that loses the race falls back to updating the count
+    // under `mu_` and notifying `cond_var_`.
+    class CallCounter {
+     public:
+      int64_t num_calls() const { return state_.load() >> kCallsShift; }
+
+      void AddCall() { state_.fetch_add(kOneCall); }
+
+      // Decrements the call count if there are no registered waiters. Returns
+      // false, leaving the state unchanged, otherwise.
+      bool TryRemoveCallWithoutWaiters() {
+        int64_t state = state_.load();
+        while ((state & kWaitersMask) == 0) {
+          if (state_.compare_exchange_weak(state, state - kOneCall)) {
+            return true;
+          }
+        }
+        return false;
+      }
+
+      // REQUIRES: the caller holds `mu_` and notifies `cond_var_` afterwards.
+      void RemoveCall() { state_.fetch_sub(kOneCall); }
+
+      // REQUIRES: the caller holds `mu_`.
+      void AddWaiter() { state_.fetch_add(1); }
+      void RemoveWaiter() { state_.fetch_sub(1); }
+
+     private:
+      static constexpr int kCallsShift = 32;
+      static constexpr int64_t kOneCall = int64_t{1} << kCallsShift;
+      static constexpr int64_t kWaitersMask = kOneCall - 1;
+
+      std::atomic<int64_t> state_{0};
+    };
+
     void CancelThreads(bool wait) TF_LOCKS_EXCLUDED(mu_) {
       cancellation_manager_->StartCancel();
       mutex_lock l(*mu_);
       cancelled_ = true;
       cond_var_->notify_all();
       // Wait for all in-flight calls to complete.
-      while (wait && num_calls_ > 0) {
+      call_counter_.AddWaiter();
+      while (wait && call_counter_.num_calls() > 0) {
         cond_var_->wait(l);
       }
+      call_counter_.RemoveWaiter();
     }
 
     void EnsureThreadsStarted(IteratorContext* ctx)
@@ -449,9 +501,15 @@ class ParallelMapDatasetOp::Dataset : public DatasetBase {
     void CallCompleted(const std::shared_ptr<IteratorContext>& ctx,
                        const std::shared_ptr<InvocationResult>& result)
         TF_LOCKS_EXCLUDED(*mu_) {
-      mutex_lock l(*mu_);
-      num_calls_--;
       result->notification.Notify();
+      // NOTE: When no thread is waiting, the call count update must be the
+      // last access to `this`, as the iterator may be destroyed as soon as
+      // the count drops to zero.
+      if (call_counter_.TryRemoveCallWithoutWaiters()) {
+        return;
+      }
+      mutex_lock l(*mu_);
+      call_counter_.RemoveCall();
       cond_var_->notify_all();
     }
 
@@ -551,24 +609,26 @@ class ParallelMapDatasetOp::Dataset : public DatasetBase {
       }
       auto busy = [this]() TF_EXCLUSIVE_LOCKS_REQUIRED(*mu_) -> bool {
         int64_t num_parallel_calls = num_parallel_calls_->value;
-        return num_calls_ >= num_parallel_calls ||
+        return call_counter_.num_calls() >= num_parallel_calls ||
                invocation_results_.size() >= num_parallel_calls;
       };
       while (true) {
         {
           mutex_lock l(*mu_);
+          call_counter_.AddWaiter();
           while (!cancelled_ && busy()) {
             RecordStop(ctx.get());
             cond_var_->wait(l);
             RecordStart(ctx.get());
           }
+          call_counter_.RemoveWaiter();
           if (cancelled_) {
             return;
           }
           while (!busy()) {
             invocation_results_.push_back(std::make_shared<InvocationResult>());
             new_calls.push_back(invocation_results_.back());
-            num_calls_++;
+            call_counter_.AddCall();
           }
           cond_var_->notify_all();
         }
@@ -624,7 +684,7 @@ class ParallelMapDatasetOp::Dataset : public DatasetBase {
           if (cancelled_) {
             return;
           }
-          num_calls = num_calls_;
+          num_calls = call_counter_.num_calls();
           num_parallel_calls = num_parallel_calls_->value;
         }
         if (num_parallel_calls == 0) {
@@ -681,8 +741,9 @@ class ParallelMapDatasetOp::Dataset : public DatasetBase {
     const bool deterministic_;
     const bool preserve_cardinality_;
     const bool autotune_;
-    // Counts the number of outstanding calls.
-    int64_t num_calls_ TF_GUARDED_BY(*mu_) = 0;
+    // Counts the number of outstanding calls and of the threads waiting for
+    // them to complete.
+    CallCounter call_counter_;
     // Controls cancellation of `input_impl_`. Must be ordered before
     // `input_impl_` so that `input_impl_` is destroyed first.
     std::unique_ptr<CancellationManager> cancellation_manager_;
@@ -15,20 +15,32 @@ limitations under the License.
 
 #include "tensorflow/core/kernels/data/prefetch_autotuner.h"
 
+#include <memory>
+#include <utility>
+
 #include "tensorflow/core/framework/model.h"
+#include "tensorflow/core/platform/logging.h"
 
 namespace tensorflow {
 namespace data {
 
-PrefetchAutotuner::PrefetchAutotuner(int64_t initial_buffer_size,
-                                     int64_t buffer_size_min)
-    : buffer_limit_(initial_buffer_size) {
+PrefetchAutotuner::PrefetchAutotuner(
+    int64_t initial_buffer_size, int64_t buffer_size_min,
+    std::shared_ptr<model::RamBudgetManager> ram_budget_manager)
+    : buffer_limit_(initial_buffer_size),
+      ram_budget_manager_(std::move(ram_budget_manager)) {
   if (initial_buffer_size == model::kAutotune) {
     mode_ = Mode::kUpswing;
     buffer_limit_ = std::max(int64_t{1}, buffer_size_min);
   }
 }
 
+PrefetchAutotuner::~PrefetchAutotuner() {
+  if (ram_budget_manager_ && reserved_bytes_ > 0) {
+    ram_budget_manager_->RequestBytes(-reserved_bytes_);
+  }
+}
+
 namespace {
 // Determines what strategy to use for increasing the buffer size limit. For
 // limits less than the threshold, an exponential increase is used, while for
@@ -47,16 +59,38 @@ void PrefetchAutotuner::RecordConsumption(size_t current_buffer_size) {
       return;
     case Mode::kDownswing:
       if (current_buffer_size == 0) {
+        int64_t new_buffer_limit;
         if (buffer_limit_ >= static_cast<int64_t>(kBufferLimitThreshold)) {
-          buffer_limit_ += kBufferLimitThreshold;
+          new_buffer_limit = buffer_limit_ + kBufferLimitThreshold;
         } else {
-          buffer_limit_ *= 2;
+          new_buffer_limit = buffer_limit_ * 2;
+        }
+        if (!ReserveMemory(new_buffer_limit)) {
+          // Growing the buffer would exceed the RAM budget, so we stay at the
+          // current size.
+          return;
         }
+        buffer_limit_ = new_buffer_limit;
         mode_ = Mode::kUpswing;
       }
       return;
   }
 }
 
+bool PrefetchAutotuner::ReserveMemory(int64_t new_buffer_limit) {
+  if (!ram_budget_manager_ || element_size_ <= 0) {
+    return true;
+  }
+  const int64_t delta = (new_buffer_limit - buffer_limit_) * element_size_;
+  if (!ram_budget_manager_->RequestBytes(delta)) {
+    VLOG(2) << "Not increasing prefetch buffer limit beyond " << buffer_limit_
+            << " elements of " << element_size_
+            << " bytes since it would exceed the RAM budget.";
+    return false;
+  }
+  reserved_bytes_ += delta;
+  return true;
+}
+
 }  // namespace data
 }  // namespace tensorflow
@@ -16,10 +16,15 @@ limitations under the License.
 #ifndef TENSORFLOW_CORE_KERNELS_DATA_PREFETCH_AUTOTUNER_H_
 #define TENSORFLOW_CORE_KERNELS_DATA_PREFETCH_AUTOTUNER_H_
 
+#include <memory>
+
 #include "tensorflow/core/platform/types.h"
 
 namespace tensorflow {
 namespace data {
+namespace model {
+class RamBudgetManager;
+}  // namespace model
 
 // PrefetchAutotuner dynamically adjusts the buffer size of a prefetch iterator.
 //
@@ -33,17 +38,29 @@ namespace data {
 // if the prefetching thread is able to successfully fill the buffer at its
 // current size.
 //
+// If a `RamBudgetManager` is provided, every increase of the buffer_limit is
+// charged against its budget at `SetElementSize()` bytes per element, and the
+// buffer_limit is not increased if the budget would be exceeded. This lets
+// pipelines with large elements avoid prefetching more than fits in memory,
+// while prefetches sharing the same manager draw from a common budget.
+//
 // Note: in the current implementation, we never decrease the buffer_limit().
 // This should change in the future!
 //
 // PrefetchAutotuner is NOT thread safe.
 class PrefetchAutotuner {
  public:
-  explicit PrefetchAutotuner(int64_t initial_buffer_size,
-                             int64_t buffer_size_min);
+  explicit PrefetchAutotuner(
+      int64_t initial_buffer_size, int64_t buffer_size_min,
+      std::shared_ptr<model::RamBudgetManager> ram_budget_manager = nullptr);
+
+  ~PrefetchAutotuner();
 
   int64_t buffer_limit() const { return buffer_limit_; }
 
+  // Sets the estimated size of a buffered element in bytes.
+  void SetElementSize(int64_t element_size) { element_size_ = element_size; }
+
   void RecordConsumption(size_t current_buffer_size);
   void RecordEmpty() { RecordConsumption(0); }
 
@@ -62,8 +79,16 @@ class PrefetchAutotuner {
     kDownswing,
   };
 
+  // Attempts to reserve memory for growing the buffer to `new_buffer_limit`
+  // elements, returning whether the growth fits within the RAM budget.
+  bool ReserveMemory(int64_t new_buffer_limit);
+
   int64_t buffer_limit_;
   Mode mode_ = Mode::kDisabled;
+  const std::shared_ptr<model::RamBudgetManager> ram_budget_manager_;
+  int64_t element_size_ = 0;
+  // Bytes reserved from `ram_budget_manager_` by growing the buffer.
+  int64_t reserved_bytes_ = 0;
 };
 
 }  // namespace data
@@ -15,6 +15,8 @@ limitations under the License.
 
 #include "tensorflow/core/kernels/data/prefetch_autotuner.h"
 
+#include <memory>
+
 #include "tensorflow/core/framework/model.h"
 #include "tensorflow/core/platform/test.h"
 
@@ -103,6 +105,49 @@ TEST(PrefetchAutotuner, StartWithMin) {
   }
 }
 
+TEST(PrefetchAutotuner, RamBudget) {
+  auto ram_budget_manager = std::make_shared<model::RamBudgetManager>();
+  ram_budget_manager->SetBudget(100);
+  {
+    PrefetchAutotuner t(model::kAutotune, 0, ram_budget_manager);
+    t.SetElementSize(10);
+    EXPECT_EQ(1, t.buffer_limit());
+    t.RecordConsumption(1);
+    t.RecordConsumption(0);  // Expect buffer limit to increase.
+    EXPECT_EQ(2, t.buffer_limit());
+    t.RecordConsumption(2);
+    t.RecordConsumption(0);  // Expect buffer limit to increase.
+    EXPECT_EQ(4, t.buffer_limit());
+    t.RecordConsumption(4);
+    t.RecordConsumption(0);  // Expect buffer limit to increase.
+    EXPECT_EQ(8, t.buffer_limit());
+    EXPECT_EQ(70, ram_budget_manager->reserved_bytes());
+    t.RecordConsumption(8);
+    t.RecordConsumption(0);  // Expect buffer limit to stay within budget.
+    EXPECT_EQ(8, t.buffer_limit());
+    t.RecordConsumption(0);
+    EXPECT_EQ(8, t.buffer_limit());
+    EXPECT_EQ(70, ram_budget_manager->reserved_bytes());
+  }
+  // Destroying the autotuner releases its reservation.
+  EXPECT_EQ(0, ram_budget_manager->reserved_bytes());
+}
+
+TEST(PrefetchAutotuner, SharedRamBudget) {
+  auto ram_budget_manager = std::make_shared<model::RamBudgetManager>();
+  ram_budget_manager->SetBudget(30);
+  PrefetchAutotuner t1(model::kAutotune, 0, ram_budget_manager);
+  PrefetchAutotuner t2(model::kAutotune, 0, ram_budget_manager);
+  t1.SetElementSize(20);
+  t2.SetElementSize(20);
+  t1.RecordConsumption(1);
+  t1.RecordConsumption(0);  // Expect buffer limit to increase.
+  EXPECT_EQ(2, t1.buffer_limit());
+  t2.RecordConsumption(1);
+  t2.RecordConsumption(0);  // The budget is used up by `t1`.
+  EXPECT_EQ(1, t2.buffer_limit());
+}
+
 }  // namespace
 }  // namespace data
 }  // namespace tensorflow
@@ -0,0 +1,133 @@
+/* Copyright 2022 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/kernels/data/prefetching_random_access_file.h"
+
+#include <algorithm>
+#include <cstring>
+#include <utility>
+
+#include "tensorflow/core/platform/errors.h"
+
+namespace tensorflow {
+namespace data {
+
+PrefetchingRandomAccessFile::PrefetchingRandomAccessFile(
+    RandomAccessFile* file, size_t block_size, int max_outstanding_reads,
+    thread::ThreadPool* thread_pool)
+    : file_(file),
+      block_size_(block_size),
+      max_outstanding_reads_(std::max(1, max_outstanding_reads)),
+      thread_pool_(thread_pool) {}
+
+PrefetchingRandomAccessFile::~PrefetchingRandomAccessFile() {
+  mutex_lock l(mu_);
+  blocks_.clear();
+  while (num_outstanding_reads_ > 0) {
+    cond_var_.wait(l);
+  }
+}
+
+Status PrefetchingRandomAccessFile::Name(StringPiece* result) const {
+  return file_->Name(result);
+}
+
+Status PrefetchingRandomAccessFile::Read(uint64 offset, size_t n,
+                                         StringPiece* result,
+                                         char* scratch) const {
+  mutex_lock l(mu_);
+  if (blocks_.empty() || offset < blocks_.front()->offset ||
+      offset >= next_block_offset_) {
+    // The read does not continue from the buffered blocks, so restart
+    // prefetching at `offset`.
+    blocks_.clear();
+    next_block_offset_ = offset;
+  }
+  size_t copied = 0;
+  Status status;
+  while (copied < n) {
+    ScheduleReadsLocked();
+    if (blocks_.empty()) {
+      status = errors::OutOfRange("Reached end of file");
+      break;
+    }
+    std::shared_ptr<Block> block = blocks_.front();
+    while (!block->done) {
+      cond_var_.wait(l);
+    }
+    const size_t block_offset = offset + copied - block->offset;
+    if (block_offset < block->data.size()) {
+      const size_t to_copy =
+          std::min(n - copied, block->data.size() - block_offset);
+      std::memcpy(scratch + copied, block->data.data() + block_offset,
+                  to_copy);
+      copied += to_copy;
+      if (block_offset + to_copy < block->data.size()) {
+        // `n` bytes have been read before the end of the block.
+        break;
+      }
+    }
+    if (!block->status.ok() && !errors::IsOutOfRange(block->status)) {
+      status = block->status;
+      blocks_.clear();
+      break;
+    }
+    if (block->data.size() < block_size_) {
+      // The block ends the file. It is kept buffered so that subsequent reads
+      // at the end of the file do not issue new reads.
+      if (copied < n) {
+        status = errors::OutOfRange("Reached end of file");
+      }
+      break;
+    }
+    blocks_.pop_front();
+  }
+  *result = StringPiece(scratch, copied);
+  return status;
+}
+
+void PrefetchingRandomAccessFile::ScheduleReadsLocked() const {
+  for (const auto& block : blocks_) {
+    if (block->done && block->data.size() < block_size_) {
+      return;
+    }
+  }
+  while (blocks_.size() < static_cast<size_t>(max_outstanding_reads_)) {
+    auto block = std::make_shared<Block>(next_block_offset_);
+    next_block_offset_ += block_size_;
+    blocks_.push_back(block);
+    ++num_outstanding_reads_;
+    thread_pool_->Schedule([this, block]() { ReadBlock(block); });
+  }
+}
+
+void PrefetchingRandomAccessFile::ReadBlock(
+    std::shared_ptr<Block> block) const {
+  block->data.resize(block_size_);
+  StringPiece data;
+  Status s = file_->Read(block->offset, block_size_, &data, &block->data[0]);
+  if (data.data() == block->data.data()) {
+    block->data.resize(data.size());
+  } else {
+    block->data.assign(data.data(), data.size());
+  }
+  mutex_lock l(mu_);
+  block->status = s;
+  block->done = true;
+  --num_outstanding_reads_;
+  cond_var_.notify_all();
+}
+
+}  // namespace data
+}  // namespace tensorflow
@@ -0,0 +1,100 @@
+/* Copyright 2022 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_CORE_KERNELS_DATA_PREFETCHING_RANDOM_ACCESS_FILE_H_
+#define TENSORFLOW_CORE_KERNELS_DATA_PREFETCHING_RANDOM_ACCESS_FILE_H_
+
+#include <deque>
+#include <memory>
+#include <string>
+
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/file_system.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/status.h"
+#include "tensorflow/core/platform/stringpiece.h"
+#include "tensorflow/core/platform/threadpool.h"
+#include "tensorflow/core/platform/types.h"
+
+namespace tensorflow {
+namespace data {
+
+// PrefetchingRandomAccessFile wraps a RandomAccessFile that is read mostly
+// sequentially, and keeps up to `max_outstanding_reads` reads of `block_size`
+// bytes in flight ahead of the last read offset. The reads are issued on
+// `thread_pool`, so that a single reader can saturate storage whose throughput
+// only scales with the number of concurrent requests.
+//
+// A read that does not continue from the previously read data (e.g. after a
+// seek) discards the prefetched blocks and restarts prefetching at the new
+// offset.
+//
+// The wrapped file and the thread pool are not owned, and must outlive this
+// object. Like any RandomAccessFile, this class is thread-safe, although
+// concurrent readers of different regions will defeat the prefetching.
+class PrefetchingRandomAccessFile : public RandomAccessFile {
+ public:
+  PrefetchingRandomAccessFile(RandomAccessFile* file, size_t block_size,
+                              int max_outstanding_reads,
+                              thread::ThreadPool* thread_pool);
+
+  // Blocks until all outstanding reads have completed.
+  ~PrefetchingRandomAccessFile() override;
+
+  Status Name(StringPiece* result) const override;
+
+  Status Read(uint64 offset, size_t n, StringPiece* result,
+              char* scratch) const override;
+
+ private:
+  // A block of the file read by a background thread.
+  struct Block {
+    explicit Block(uint64 offset) : offset(offset) {}
+
+    const uint64 offset;
+    // The data read, and the status of the read. The read reached the end of
+    // the file if `data` is shorter than the block size.
+    std::string data;
+    Status status;
+    bool done = false;
+  };
+
+  // Schedules reads until `max_outstanding_reads_` blocks are buffered or a
+  // buffered block is known to end the file.
+  void ScheduleReadsLocked() const TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+
+  // Reads `block` from the file. Runs on `thread_pool_`.
+  void ReadBlock(std::shared_ptr<Block> block) const TF_LOCKS_EXCLUDED(mu_);
+
+  RandomAccessFile* const file_;  // Not owned.
+  const size_t block_size_;
+  const int max_outstanding_reads_;
+  thread::ThreadPool* const thread_pool_;  // Not owned.
+
+  mutable mutex mu_;
+  mutable condition_variable cond_var_;
+  // Buffered blocks, ordered by offset. Blocks are contiguous and the first
+  // one contains the offset that the next sequential read will start at.
+  mutable std::deque<std::shared_ptr<Block>> blocks_ TF_GUARDED_BY(mu_);
+  // Offset of the next block to schedule.
+  mutable uint64 next_block_offset_ TF_GUARDED_BY(mu_) = 0;
+  // Number of reads running on `thread_pool_`, including reads of blocks that
+  // have since been discarded.
+  mutable int64_t num_outstanding_reads_ TF_GUARDED_BY(mu_) = 0;
+};
+
+}  // namespace data
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_KERNELS_DATA_PREFETCHING_RANDOM_ACCESS_FILE_H_
@@ -0,0 +1,129 @@
+/* Copyright 2022 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/kernels/data/prefetching_random_access_file.h"
+
+#include <memory>
+#include <string>
+
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/errors.h"
+#include "tensorflow/core/platform/path.h"
+#include "tensorflow/core/platform/test.h"
+#include "tensorflow/core/platform/threadpool.h"
+
+namespace tensorflow {
+namespace data {
+namespace {
+
+constexpr size_t kBlockSize = 16;
+
+std::string TestContents(size_t size) {
+  std::string contents(size, '\0');
+  for (size_t i = 0; i < size; ++i) {
+    contents[i] = static_cast<char>('a' + i % 26);
+  }
+  return contents;
+}
+
+class PrefetchingRandomAccessFileTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    thread_pool_ = std::make_unique<thread::ThreadPool>(
+        Env::Default(), "prefetching_random_access_file_test", 4);
+  }
+
+  void CreateFile(const std::string& contents) {
+    filename_ = io::JoinPath(testing::TmpDir(),
+                             "prefetching_random_access_file_test");
+    TF_ASSERT_OK(WriteStringToFile(Env::Default(), filename_, contents));
+    TF_ASSERT_OK(Env::Default()->NewRandomAccessFile(filename_, &base_file_));
+  }
+
+  std::unique_ptr<PrefetchingRandomAccessFile> Prefetching(
+      int max_outstanding_reads) {
+    return std::make_unique<PrefetchingRandomAccessFile>(
+        base_file_.get(), kBlockSize, max_outstanding_reads,
+        thread_pool_.get());
+  }
+
+  std::string filename_;
+  std::unique_ptr<RandomAccessFile> base_file_;
+  std::unique_ptr<thread::ThreadPool> thread_pool_;
+};
+
+TEST_F(PrefetchingRandomAccessFileTest, SequentialReads) {
+  const std::string contents = TestContents(10 * kBlockSize + 5);
+  CreateFile(contents);
+  for (int max_outstanding_reads : {1, 2, 8}) {
+    auto file = Prefetching(max_outstanding_reads);
+    std::string read;
+    char scratch[7];
+    uint64 offset = 0;
+    while (true) {
+      StringPiece result;
+      Status s = file->Read(offset, sizeof(scratch), &result, scratch);
+      read.append(result.data(), result.size());
+      offset += result.size();
+      if (errors::IsOutOfRange(s)) break;
+      TF_ASSERT_OK(s);
+      ASSERT_EQ(result.size(), sizeof(scratch));
+    }
+    EXPECT_EQ(read, contents);
+  }
+}
+
+TEST_F(PrefetchingRandomAccessFileTest, Seek) {
+  const std::string contents = TestContents(6 * kBlockSize);
+  CreateFile(contents);
+  auto file = Prefetching(/*max_outstanding_reads=*/2);
+  char scratch[2 * kBlockSize];
+  StringPiece result;
+  TF_ASSERT_OK(file->Read(3, 10, &result, scratch));
+  EXPECT_EQ(result, StringPiece(contents).substr(3, 10));
+  TF_ASSERT_OK(file->Read(4 * kBlockSize + 1, 20, &result, scratch));
+  EXPECT_EQ(result, StringPiece(contents).substr(4 * kBlockSize + 1, 20));
+  TF_ASSERT_OK(file->Read(1, sizeof(scratch), &result, scratch));
+  EXPECT_EQ(result, StringPiece(contents).substr(1, sizeof(scratch)));
+}
+
+TEST_F(PrefetchingRandomAccessFileTest, EndOfFile) {
+  const std::string contents = TestContents(2 * kBlockSize);
+  CreateFile(contents);
+  auto file = Prefetching(/*max_outstanding_reads=*/4);
+  char scratch[3 * kBlockSize];
+  StringPiece result;
+  Status s = file->Read(kBlockSize + 2, sizeof(scratch), &result, scratch);
+  EXPECT_TRUE(errors::IsOutOfRange(s)) << s;
+  EXPECT_EQ(result, StringPiece(contents).substr(kBlockSize + 2));
+  s = file->Read(2 * kBlockSize, 1, &result, scratch);
+  EXPECT_TRUE(errors::IsOutOfRange(s)) << s;
+  EXPECT_TRUE(result.empty());
+  s = file->Read(10 * kBlockSize, 1, &result, scratch);
+  EXPECT_TRUE(errors::IsOutOfRange(s)) << s;
+  EXPECT_TRUE(result.empty());
+}
+
+TEST_F(PrefetchingRandomAccessFileTest, Name) {
+  CreateFile(TestContents(1));
+  auto file = Prefetching(/*max_outstanding_reads=*/1);
+  StringPiece name;
+  TF_ASSERT_OK(file->Name(&name));
+  EXPECT_EQ(name, filename_);
+}
+
+}  // namespace
+}  // namespace data
+}  // namespace tensorflow
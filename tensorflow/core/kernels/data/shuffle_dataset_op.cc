@@ -14,6 +14,8 @@ limitations under the License.
 ==============================================================================*/
 #include "tensorflow/core/kernels/data/shuffle_dataset_op.h"
 
+#include <array>
+#include <atomic>
 #include <cstdint>
 #include <deque>
 #include <string>
@@ -24,16 +26,20 @@ limitations under the License.
 #include "tensorflow/core/data/dataset_utils.h"
 #include "tensorflow/core/data/name_utils.h"
 #include "tensorflow/core/data/serialization_utils.h"
+#include "tensorflow/core/data/snapshot_utils.h"
 #include "tensorflow/core/framework/dataset.h"
 #include "tensorflow/core/framework/partial_tensor_shape.h"
 #include "tensorflow/core/framework/resource_mgr.h"
 #include "tensorflow/core/framework/tensor.h"
 #include "tensorflow/core/kernels/data/random_seed_ops.h"
+#include "tensorflow/core/kernels/random_index_shuffle.h"
 #include "tensorflow/core/lib/core/errors.h"
+#include "tensorflow/core/lib/io/compression.h"
 #include "tensorflow/core/lib/random/philox_random.h"
 #include "tensorflow/core/lib/random/random.h"
 #include "tensorflow/core/lib/random/random_distributions.h"
 #include "tensorflow/core/platform/errors.h"
+#include "tensorflow/core/platform/path.h"
 #include "tensorflow/core/platform/stringprintf.h"
 
 namespace tensorflow {
@@ -50,6 +56,9 @@ namespace data {
 /* static */ constexpr const char* const ShuffleDatasetOpBase::kOutputShapes;
 /* static */ constexpr const char* const
     ShuffleDatasetOpBase::kReshuffleEachIteration;
+/* static */ constexpr const char* const
+    ShuffleDatasetOpBase::kMemoryBudgetBytes;
+/* static */ constexpr const char* const ShuffleDatasetOpBase::kSpillDirectory;
 
 /* static */ constexpr const char* const ShuffleDatasetOp::kDatasetType;
 
@@ -59,6 +68,8 @@ namespace data {
 
 const int64_t kLogIntervalMicros = 10 * 1000000;  // 10 seconds.
 const int64_t kMaxEpochsInBuffer = 3;
+// Snapshot file format version used for spilled shuffle runs.
+const int kSpillFileVersion = 2;
 
 constexpr char kNumRandomSamples[] = "num_random_samples";
 constexpr char kDataProduced[] = "data_produced";
@@ -85,12 +96,15 @@ class ShuffleDatasetOpBase::ShuffleDatasetBase : public DatasetBase {
   ShuffleDatasetBase(OpKernelContext* ctx, const DatasetBase* input,
                      int64_t buffer_size,
                      std::shared_ptr<SeedGenerator> seed_generator,
-                     int64_t count)
+                     int64_t count, int64_t memory_budget_bytes = 0,
+                     std::string spill_directory = "")
       : DatasetBase(DatasetContext(ctx)),
         input_(input),
         buffer_size_(buffer_size),
         seed_generator_(std::move(seed_generator)),
         count_(count),
+        memory_budget_bytes_(memory_budget_bytes),
+        spill_directory_(std::move(spill_directory)),
         traceme_metadata_(
             {{"buffer_size",
               strings::Printf("%lld", static_cast<long long>(buffer_size))}}) {
@@ -141,18 +155,17 @@ class ShuffleDatasetOpBase::ShuffleDatasetBase : public DatasetBase {
   Status Get(OpKernelContext* ctx, int64 index,
              std::vector<Tensor>* out_tensors) const override {
     TF_RETURN_IF_ERROR(CheckRandomAccessCompatible(index));
-    {
-      mutex_lock l(mu_);
-      if (shuffled_indices_.empty()) {
-        InitializeRandomAccessIndices();
-      }
-    }
-    int64 shuffled_index;
-    {
-      tf_shared_lock l(mu_);
-      shuffled_index = shuffled_indices_[index];
+    CardinalityOptions options;
+    options.set_compute_level(CardinalityOptions::CARDINALITY_COMPUTE_MODERATE);
+    const int64_t num_elements = input_->Cardinality(options);
+    if (num_elements <= 0) {
+      return errors::OutOfRange("Index out of range [0, ", num_elements,
+                                "):", index);
     }
-    TF_RETURN_IF_ERROR(input_->Get(ctx, shuffled_index, out_tensors));
+    TF_RETURN_IF_ERROR(input_->Get(
+        ctx, ShuffledIndex(index % num_elements, index / num_elements,
+                           num_elements),
+        out_tensors));
     return OkStatus();
   }
 
@@ -165,27 +178,30 @@ class ShuffleDatasetOpBase::ShuffleDatasetBase : public DatasetBase {
 
   std::unique_ptr<IteratorBase> MakeIteratorInternal(
       const string& prefix) const override {
+    if (memory_budget_bytes_ > 0) {
+      return std::make_unique<SpillingIterator>(
+          SpillingIterator::Params{
+              this, name_utils::IteratorPrefix(op_type(), prefix)},
+          seed_generator_.get());
+    }
     return std::make_unique<Iterator>(
         Iterator::Params{this, name_utils::IteratorPrefix(op_type(), prefix)},
         seed_generator_.get());
   }
 
-  void InitializeRandomAccessIndices() const TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
-    const int64 cardinality = Cardinality();
-    shuffled_indices_ = std::vector<std::int64_t>(cardinality);
-    std::iota(shuffled_indices_.begin(), shuffled_indices_.end(), 0);
-    int64_t shuffled_index = 0;
-    random::PhiloxRandom parent_generator =
-        random::PhiloxRandom(seed_generator_->seed(), seed_generator_->seed2());
-    random::SingleSampleAdapter<random::PhiloxRandom> generator =
-        random::SingleSampleAdapter<random::PhiloxRandom>(&parent_generator);
-
-    while (shuffled_index < cardinality) {
-      int64_t offset = generator() % (cardinality - shuffled_index);
-      std::swap(shuffled_indices_[shuffled_index + offset],
-                shuffled_indices_[shuffled_index]);
-      shuffled_index += 1;
-    }
+  // Returns the position of `index` in the permutation of the
+  // `num_elements` input elements for `epoch`. The permutation is computed
+  // in O(1) time and memory, so random access does not materialize the
+  // shuffled order of the whole dataset.
+  int64_t ShuffledIndex(int64_t index, int64_t epoch,
+                        int64_t num_elements) const {
+    auto fold = [](int64_t seed) {
+      return static_cast<uint32_t>(seed ^ (static_cast<uint64_t>(seed) >> 32));
+    };
+    const std::array<uint32_t, 3> key = {fold(seed_generator_->seed()),
+                                         fold(seed_generator_->seed2()),
+                                         static_cast<uint32_t>(epoch)};
+    return random::index_shuffle(index, key, num_elements - 1);
   }
 
  protected:
@@ -500,6 +516,235 @@ class ShuffleDatasetOpBase::ShuffleDatasetBase : public DatasetBase {
     bool data_produced_ TF_GUARDED_BY(mu_) = false;
   };
 
+  // Iterator used when `memory_budget_bytes_` is positive. Rather than keeping
+  // a sliding window of `buffer_size_` elements in memory, it reads windows of
+  // up to `buffer_size_` elements, and every time the buffered elements exceed
+  // the memory budget it permutes them and spills them to a run file in
+  // `spill_directory_`. A window is then drained by repeatedly picking a run
+  // with probability proportional to its number of remaining elements and
+  // producing the next element of that run, which yields a uniformly random
+  // permutation of the window while holding at most one spilled element per
+  // run in memory.
+  //
+  // Spilled runs live only as long as the iterator, so this iterator does not
+  // support checkpointing.
+  class SpillingIterator : public DatasetIterator<ShuffleDatasetBase> {
+   public:
+    explicit SpillingIterator(const Params& params,
+                              SeedGenerator* seed_generator)
+        : DatasetIterator<ShuffleDatasetBase>(params),
+          seed_generator_(seed_generator),
+          parent_generator_(seed_generator->seed(), seed_generator->seed2()),
+          generator_(&parent_generator_) {}
+
+    ~SpillingIterator() override {
+      mutex_lock l(mu_);
+      DeleteRuns();
+    }
+
+    Status Initialize(IteratorContext* ctx) override {
+      mutex_lock l(mu_);
+      env_ = ctx->env();
+      seed_generator_->GenerateSeeds(&seed_, &seed2_);
+      parent_generator_ = random::PhiloxRandom(seed_, seed2_);
+      generator_ =
+          random::SingleSampleAdapter<random::PhiloxRandom>(&parent_generator_);
+      std::string directory = dataset()->spill_directory_;
+      if (directory.empty()) {
+        std::vector<string> local_temp_directories;
+        env_->GetLocalTempDirectories(&local_temp_directories);
+        if (local_temp_directories.empty()) {
+          return errors::FailedPrecondition(
+              "No local temporary directory is available for spilling shuffle "
+              "buffer runs. Please set `spill_directory`.");
+        }
+        directory = local_temp_directories.front();
+      }
+      TF_RETURN_IF_ERROR(env_->RecursivelyCreateDir(directory));
+      static std::atomic<int64_t> iterator_id_counter(0);
+      run_prefix_ = io::JoinPath(
+          directory, strings::StrCat("shuffle_spill_",
+                                     iterator_id_counter.fetch_add(1), "_"));
+      if (!env_->CreateUniqueFileName(&run_prefix_, "")) {
+        return errors::Internal(
+            "Failed to create a unique file name for shuffle spill runs in ",
+            directory);
+      }
+      return dataset()->input_->MakeIterator(ctx, this, prefix(),
+                                             &input_impl_);
+    }
+
+    Status GetNextInternal(IteratorContext* ctx,
+                           std::vector<Tensor>* out_tensors,
+                           bool* end_of_sequence) override {
+      mutex_lock l(mu_);
+      if (num_remaining_ == 0) {
+        DeleteRuns();
+        TF_RETURN_IF_ERROR(FillWindow(ctx));
+        if (num_remaining_ == 0) {
+          *end_of_sequence = true;
+          return OkStatus();
+        }
+      }
+      *end_of_sequence = false;
+      int64_t index = Random() % num_remaining_;
+      num_remaining_--;
+      if (index < static_cast<int64_t>(memory_run_.size())) {
+        // `memory_run_` has already been permuted, so any of its elements is
+        // as good as the one selected.
+        *out_tensors = std::move(memory_run_.back());
+        memory_run_.pop_back();
+        RecordBufferDequeue(ctx, *out_tensors);
+        return OkStatus();
+      }
+      index -= memory_run_.size();
+      for (auto& run : runs_) {
+        if (index < run.remaining) {
+          TF_RETURN_IF_ERROR(run.reader->ReadTensors(out_tensors));
+          if (--run.remaining == 0) {
+            run.reader.reset();
+          }
+          return OkStatus();
+        }
+        index -= run.remaining;
+      }
+      return errors::Internal("Shuffle spill runs are inconsistent with the ",
+                              "number of remaining elements.");
+    }
+
+   protected:
+    std::shared_ptr<model::Node> CreateNode(
+        IteratorContext* ctx, model::Node::Args args) const override {
+      return model::MakeKnownRatioNode(std::move(args),
+                                       /*ratio=*/1);
+    }
+
+    Status SaveInternal(SerializationContext* ctx,
+                        IteratorStateWriter* writer) override {
+      return errors::Unimplemented(
+          "Checkpointing is not supported for shuffle datasets with a "
+          "positive `memory_budget_bytes`.");
+    }
+
+    Status RestoreInternal(IteratorContext* ctx,
+                           IteratorStateReader* reader) override {
+      return errors::Unimplemented(
+          "Checkpointing is not supported for shuffle datasets with a "
+          "positive `memory_budget_bytes`.");
+    }
+
+    TraceMeMetadata GetTraceMeMetadata() const override {
+      return this->dataset()->traceme_metadata_;
+    }
+
+   private:
+    // A permuted run of elements spilled to disk.
+    struct Run {
+      std::string filename;
+      std::unique_ptr<snapshot_util::Reader> reader;
+      int64_t remaining = 0;
+    };
+
+    random::SingleSampleAdapter<random::PhiloxRandom>::ResultType Random()
+        TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+      return generator_();
+    }
+
+    // Shuffles `elements` in place with a Fisher-Yates shuffle.
+    void Permute(std::vector<std::vector<Tensor>>* elements)
+        TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+      for (size_t i = elements->size(); i > 1; --i) {
+        std::swap((*elements)[i - 1], (*elements)[Random() % i]);
+      }
+    }
+
+    // Reads up to `buffer_size_` elements from the input, spilling them to
+    // disk whenever the memory budget is exceeded.
+    Status FillWindow(IteratorContext* ctx) TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+      while (input_impl_ && num_remaining_ < dataset()->buffer_size_) {
+        std::vector<Tensor> element;
+        bool end_of_input_sequence = false;
+        TF_RETURN_IF_ERROR(
+            input_impl_->GetNext(ctx, &element, &end_of_input_sequence));
+        if (end_of_input_sequence) {
+          input_impl_.reset();
+          break;
+        }
+        RecordBufferEnqueue(ctx, element);
+        memory_run_bytes_ += GetTotalBytes(element);
+        memory_run_.push_back(std::move(element));
+        num_remaining_++;
+        if (memory_run_bytes_ >= dataset()->memory_budget_bytes_) {
+          TF_RETURN_IF_ERROR(SpillMemoryRun(ctx));
+        }
+      }
+      Permute(&memory_run_);
+      memory_run_bytes_ = 0;
+      if (!runs_.empty()) {
+        VLOG(2) << "Shuffle window of " << num_remaining_
+                << " elements spilled to " << runs_.size() << " runs.";
+      }
+      return OkStatus();
+    }
+
+    // Permutes `memory_run_` and writes it out as a new run.
+    Status SpillMemoryRun(IteratorContext* ctx)
+        TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+      Permute(&memory_run_);
+      runs_.emplace_back();
+      Run& run = runs_.back();
+      run.filename = strings::StrCat(run_prefix_, "_", num_runs_spilled_++);
+      std::unique_ptr<snapshot_util::Writer> writer;
+      TF_RETURN_IF_ERROR(snapshot_util::Writer::Create(
+          env_, run.filename, io::compression::kNone, kSpillFileVersion,
+          dataset()->output_dtypes(), &writer));
+      for (const auto& element : memory_run_) {
+        TF_RETURN_IF_ERROR(writer->WriteTensors(element));
+        RecordBufferDequeue(ctx, element);
+      }
+      TF_RETURN_IF_ERROR(writer->Close());
+      TF_RETURN_IF_ERROR(snapshot_util::Reader::Create(
+          env_, run.filename, io::compression::kNone, kSpillFileVersion,
+          dataset()->output_dtypes(), &run.reader));
+      run.remaining = memory_run_.size();
+      memory_run_.clear();
+      memory_run_bytes_ = 0;
+      return OkStatus();
+    }
+
+    void DeleteRuns() TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+      for (auto& run : runs_) {
+        run.reader.reset();
+        Status s = env_->DeleteFile(run.filename);
+        if (!s.ok() && !errors::IsNotFound(s)) {
+          LOG(WARNING) << "Failed to delete shuffle spill file "
+                       << run.filename << ": " << s.ToString();
+        }
+      }
+      runs_.clear();
+    }
+
+    mutex mu_;
+    SeedGenerator* const seed_generator_ TF_GUARDED_BY(mu_);  // Not owned.
+    Env* env_ TF_GUARDED_BY(mu_) = nullptr;
+    std::unique_ptr<IteratorBase> input_impl_ TF_GUARDED_BY(mu_);
+    // Prefix of the run files written by this iterator.
+    std::string run_prefix_ TF_GUARDED_BY(mu_);
+    int64_t num_runs_spilled_ TF_GUARDED_BY(mu_) = 0;
+    // Runs of the current window that have been spilled to disk.
+    std::vector<Run> runs_ TF_GUARDED_BY(mu_);
+    // Elements of the current window that have not been spilled.
+    std::vector<std::vector<Tensor>> memory_run_ TF_GUARDED_BY(mu_);
+    int64_t memory_run_bytes_ TF_GUARDED_BY(mu_) = 0;
+    // Number of elements of the current window not yet produced.
+    int64_t num_remaining_ TF_GUARDED_BY(mu_) = 0;
+    int64_t seed_ TF_GUARDED_BY(mu_) = 0;
+    int64_t seed2_ TF_GUARDED_BY(mu_) = 0;
+    random::PhiloxRandom parent_generator_ TF_GUARDED_BY(mu_);
+    random::SingleSampleAdapter<random::PhiloxRandom> generator_
+        TF_GUARDED_BY(mu_);
+  };
+
   const DatasetBase* const input_;
   const int64_t buffer_size_;
   const std::shared_ptr<SeedGenerator> seed_generator_;
@@ -507,9 +752,11 @@ class ShuffleDatasetOpBase::ShuffleDatasetBase : public DatasetBase {
   // fuse shuffle and repeat together, and make the shuffle dataset op
   // responsible for repeating as well.
   const int64_t count_;
+  // If positive, iterators spill the shuffle buffer to `spill_directory_`
+  // once it holds more than this many bytes.
+  const int64_t memory_budget_bytes_;
+  const std::string spill_directory_;
   const TraceMeMetadata traceme_metadata_;
-  mutable mutex mu_;
-  mutable std::vector<std::int64_t> shuffled_indices_ TF_GUARDED_BY(mu_);
 };  // ShuffleDatasetBase
 
 // This version of memory dataset has an exclusive ownership of the seed
@@ -520,8 +767,10 @@ class ShuffleDatasetOp::Dataset : public ShuffleDatasetBase {
  public:
   Dataset(OpKernelContext* ctx, const DatasetBase* input, int64_t buffer_size,
           int64_t count, RandomSeeds&& seeds, SeedGeneratorManager* manager,
-          ResourceHandle&& resource_handle)
-      : ShuffleDatasetBase(ctx, input, buffer_size, manager->get(), count),
+          ResourceHandle&& resource_handle, int64_t memory_budget_bytes,
+          std::string spill_directory)
+      : ShuffleDatasetBase(ctx, input, buffer_size, manager->get(), count,
+                           memory_budget_bytes, std::move(spill_directory)),
         manager_(manager),
         resource_handle_(std::move(resource_handle)),
         resource_mgr_(ctx->resource_manager()),
@@ -554,11 +803,16 @@ class ShuffleDatasetOp::Dataset : public ShuffleDatasetBase {
     TF_RETURN_IF_ERROR(b->AddScalar(seeds_.input_seed2(), &seed2_node));
     b->BuildAttrValue(seed_generator_->reshuffle_each_iteration(),
                       &reshuffle_each_iteration);
+    AttrValue memory_budget_bytes;
+    b->BuildAttrValue(memory_budget_bytes_, &memory_budget_bytes);
+    AttrValue spill_directory;
+    b->BuildAttrValue(spill_directory_, &spill_directory);
     TF_RETURN_IF_ERROR(b->AddDataset(
         this,
         {input_graph_node, buffer_size_node, seed_node, seed2_node},  // Inputs
-        {std::make_pair(kReshuffleEachIteration,
-                        reshuffle_each_iteration)},  // Attrs
+        {std::make_pair(kReshuffleEachIteration, reshuffle_each_iteration),
+         std::make_pair(kMemoryBudgetBytes, memory_budget_bytes),
+         std::make_pair(kSpillDirectory, spill_directory)},  // Attrs
         output));
     return OkStatus();
   }
@@ -632,8 +886,10 @@ class ShuffleDatasetOp::DatasetV3 : public ShuffleDatasetBase {
  public:
   DatasetV3(OpKernelContext* ctx, const DatasetBase* input, int64_t buffer_size,
             int64_t count, RandomSeeds&& seeds, SeedGeneratorManager* manager,
-            ResourceHandle&& resource_handle, bool owns_resource)
-      : ShuffleDatasetBase(ctx, input, buffer_size, manager->get(), count),
+            ResourceHandle&& resource_handle, bool owns_resource,
+            int64_t memory_budget_bytes, std::string spill_directory)
+      : ShuffleDatasetBase(ctx, input, buffer_size, manager->get(), count,
+                           memory_budget_bytes, std::move(spill_directory)),
         manager_(manager),
         owns_resource_(owns_resource),
         resource_handle_(std::move(resource_handle)),
@@ -672,13 +928,18 @@ class ShuffleDatasetOp::DatasetV3 : public ShuffleDatasetBase {
     AttrValue reshuffle_each_iteration;
     b->BuildAttrValue(seed_generator_->reshuffle_each_iteration(),
                       &reshuffle_each_iteration);
-    TF_RETURN_IF_ERROR(
-        b->AddDataset(this,
-                      {input_graph_node, buffer_size_node, seed_node,
-                       seed2_node, resource_handle_node},  // Inputs
-                      {std::make_pair(kReshuffleEachIteration,
-                                      reshuffle_each_iteration)},  // Attrs
-                      output));
+    AttrValue memory_budget_bytes;
+    b->BuildAttrValue(memory_budget_bytes_, &memory_budget_bytes);
+    AttrValue spill_directory;
+    b->BuildAttrValue(spill_directory_, &spill_directory);
+    TF_RETURN_IF_ERROR(b->AddDataset(
+        this,
+        {input_graph_node, buffer_size_node, seed_node, seed2_node,
+         resource_handle_node},  // Inputs
+        {std::make_pair(kReshuffleEachIteration, reshuffle_each_iteration),
+         std::make_pair(kMemoryBudgetBytes, memory_budget_bytes),
+         std::make_pair(kSpillDirectory, spill_directory)},  // Attrs
+        output));
     return OkStatus();
   }
 
@@ -704,6 +965,17 @@ ShuffleDatasetOp::ShuffleDatasetOp(OpKernelConstruction* ctx)
     OP_REQUIRES_OK(
         ctx, ctx->GetAttr(kReshuffleEachIteration, &reshuffle_each_iteration_));
   }
+  if (ctx->HasAttr(kMemoryBudgetBytes)) {
+    OP_REQUIRES_OK(ctx,
+                   ctx->GetAttr(kMemoryBudgetBytes, &memory_budget_bytes_));
+    OP_REQUIRES(ctx, memory_budget_bytes_ >= 0,
+                errors::InvalidArgument(
+                    "memory_budget_bytes must be greater than or equal to "
+                    "zero."));
+  }
+  if (ctx->HasAttr(kSpillDirectory)) {
+    OP_REQUIRES_OK(ctx, ctx->GetAttr(kSpillDirectory, &spill_directory_));
+  }
 }
 
 void ShuffleDatasetOp::MakeDataset(OpKernelContext* ctx, DatasetBase* input,
@@ -754,9 +1026,10 @@ void ShuffleDatasetOp::MakeDataset(OpKernelContext* ctx, DatasetBase* input,
     }
 
     // Ownership of manager is transferred onto `DatasetV3`.
-    *output = new ShuffleDatasetOp::DatasetV3(ctx, input, buffer_size, count,
-                                              std::move(seeds), manager,
-                                              std::move(handle), owns_resource);
+    *output = new ShuffleDatasetOp::DatasetV3(
+        ctx, input, buffer_size, count, std::move(seeds), manager,
+        std::move(handle), owns_resource, memory_budget_bytes_,
+        spill_directory_);
   } else if (op_version_ == 2) {
     auto handle = HandleFromInput(ctx, 2);
     SeedGeneratorManager* manager = nullptr;
@@ -816,9 +1089,9 @@ void ShuffleDatasetOp::MakeDataset(OpKernelContext* ctx, DatasetBase* input,
         MakeResourceHandle<SeedGeneratorManager>(ctx, container, name);
 
     // Ownership of manager is transferred onto `Dataset`.
-    *output = new ShuffleDatasetOp::Dataset(ctx, input, buffer_size, count,
-                                            std::move(seeds), manager,
-                                            std::move(handle));
+    *output = new ShuffleDatasetOp::Dataset(
+        ctx, input, buffer_size, count, std::move(seeds), manager,
+        std::move(handle), memory_budget_bytes_, spill_directory_);
   }
 }
 
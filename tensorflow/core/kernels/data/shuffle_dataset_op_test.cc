@@ -17,6 +17,7 @@ limitations under the License.
 #include "tensorflow/core/data/dataset_test_base.h"
 #include "tensorflow/core/data/dataset_utils.h"
 #include "tensorflow/core/data/serialization_utils.h"
+#include "tensorflow/core/platform/path.h"
 
 namespace tensorflow {
 namespace data {
@@ -33,14 +34,17 @@ class ShuffleDatasetParams : public DatasetParams {
                        bool reshuffle_each_iteration,
                        DataTypeVector output_dtypes,
                        std::vector<PartialTensorShape> output_shapes,
-                       string node_name)
+                       string node_name, int64_t memory_budget_bytes = 0,
+                       string spill_directory = "")
       : DatasetParams(std::move(output_dtypes), std::move(output_shapes),
                       std::move(node_name)),
         buffer_size_(buffer_size),
         seed_(seed),
         seed2_(seed2),
         count_(count),
-        reshuffle_each_iteration_(reshuffle_each_iteration) {
+        reshuffle_each_iteration_(reshuffle_each_iteration),
+        memory_budget_bytes_(memory_budget_bytes),
+        spill_directory_(std::move(spill_directory)) {
     input_dataset_params_.push_back(std::make_unique<T>(input_dataset_params));
     iterator_prefix_ =
         name_utils::IteratorPrefix(input_dataset_params.dataset_type(),
@@ -78,6 +82,10 @@ class ShuffleDatasetParams : public DatasetParams {
     attr_vector->emplace_back("reshuffle_each_iteration",
                               reshuffle_each_iteration_);
     attr_vector->emplace_back("metadata", "");
+    if (count_ == 1) {
+      attr_vector->emplace_back("memory_budget_bytes", memory_budget_bytes_);
+      attr_vector->emplace_back("spill_directory", spill_directory_);
+    }
     return OkStatus();
   }
 
@@ -96,6 +104,8 @@ class ShuffleDatasetParams : public DatasetParams {
   int64_t seed2_;
   int64_t count_;
   bool reshuffle_each_iteration_;
+  int64_t memory_budget_bytes_;
+  string spill_directory_;
 };
 
 class ShuffleDatasetOpTest : public DatasetOpsTestBase {};
@@ -244,6 +254,22 @@ ShuffleDatasetParams ShuffleAndRepeatDatasetParamsWithInvalidCount() {
                               /*node_name=*/kShuffleAndRepeatNodeName);
 }
 
+// Test case 9: test shuffle_dataset with a memory budget of two int64
+// elements, so that the buffer is spilled to disk.
+ShuffleDatasetParams ShuffleDatasetParams9(const string& spill_directory) {
+  return ShuffleDatasetParams(RangeDatasetParams(0, 10, 1),
+                              /*buffer_size=*/6,
+                              /*seed=*/1,
+                              /*seed2=*/2,
+                              /*count=*/1,
+                              /*reshuffle_each_iteration=*/false,
+                              /*output_dtypes=*/{DT_INT64},
+                              /*output_shapes=*/{PartialTensorShape({})},
+                              /*node_name=*/kShuffleNodeName,
+                              /*memory_budget_bytes=*/16,
+                              /*spill_directory=*/spill_directory);
+}
+
 template <typename T>
 struct GetNextTestCase {
   T dataset_params;
@@ -554,6 +580,43 @@ INSTANTIATE_TEST_CASE_P(ShuffleDatasetOpTest,
                         ParameterizedIteratorSaveAndRestoreTest,
                         ::testing::ValuesIn(IteratorSaveAndRestoreTestCases()));
 
+TEST_F(ShuffleDatasetOpTest, SpillToDisk) {
+  const string spill_directory =
+      io::JoinPath(testing::TmpDir(), "shuffle_spill_to_disk");
+  TF_ASSERT_OK(Initialize(ShuffleDatasetParams9(spill_directory)));
+
+  bool end_of_sequence = false;
+  std::vector<Tensor> out_tensors;
+  TF_ASSERT_OK(
+      iterator_->GetNext(iterator_ctx_.get(), &out_tensors, &end_of_sequence));
+  ASSERT_FALSE(end_of_sequence);
+  // The first window of 6 elements is spilled as 3 runs of 2 elements.
+  std::vector<string> children;
+  TF_ASSERT_OK(Env::Default()->GetChildren(spill_directory, &children));
+  EXPECT_EQ(children.size(), 3);
+
+  while (!end_of_sequence) {
+    std::vector<Tensor> next;
+    TF_ASSERT_OK(
+        iterator_->GetNext(iterator_ctx_.get(), &next, &end_of_sequence));
+    out_tensors.insert(out_tensors.end(), next.begin(), next.end());
+  }
+  ASSERT_EQ(out_tensors.size(), 10);
+  // Elements are shuffled within windows of `buffer_size` elements.
+  TF_EXPECT_OK(ExpectEqual(
+      std::vector<Tensor>(out_tensors.begin(), out_tensors.begin() + 6),
+      CreateTensors<int64_t>(TensorShape({}),
+                             {{0}, {1}, {2}, {3}, {4}, {5}}),
+      /*compare_order=*/false));
+  TF_EXPECT_OK(ExpectEqual(
+      std::vector<Tensor>(out_tensors.begin() + 6, out_tensors.end()),
+      CreateTensors<int64_t>(TensorShape({}), {{6}, {7}, {8}, {9}}),
+      /*compare_order=*/false));
+  // Spilled runs are deleted once they have been consumed.
+  TF_ASSERT_OK(Env::Default()->GetChildren(spill_directory, &children));
+  EXPECT_TRUE(children.empty());
+}
+
 TEST_F(ShuffleDatasetOpTest, InvalidArguments) {
   std::vector<ShuffleDatasetParams> dataset_params_vec(
       {ShuffleDatasetParamsWithInvalidBufferSize(),
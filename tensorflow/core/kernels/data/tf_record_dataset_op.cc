@@ -14,11 +14,14 @@ limitations under the License.
 ==============================================================================*/
 #include "tensorflow/core/kernels/data/tf_record_dataset_op.h"
 
+#include <algorithm>
+
 #include "tensorflow/core/data/name_utils.h"
 #include "tensorflow/core/data/utils.h"
 #include "tensorflow/core/framework/metrics.h"
 #include "tensorflow/core/framework/partial_tensor_shape.h"
 #include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/kernels/data/prefetching_random_access_file.h"
 #include "tensorflow/core/lib/io/buffered_inputstream.h"
 #include "tensorflow/core/lib/io/inputbuffer.h"
 #include "tensorflow/core/lib/io/random_inputstream.h"
@@ -36,6 +39,8 @@ namespace data {
 /* static */ constexpr const char* const TFRecordDatasetOp::kFileNames;
 /* static */ constexpr const char* const TFRecordDatasetOp::kCompressionType;
 /* static */ constexpr const char* const TFRecordDatasetOp::kBufferSize;
+/* static */ constexpr const char* const
+    TFRecordDatasetOp::kNumOutstandingReads;
 
 constexpr char kCurrentFileIndex[] = "current_file_index";
 constexpr char kOffset[] = "offset";
@@ -43,6 +48,11 @@ constexpr char kGcsFsPrefix[] = "gs://";
 constexpr char kS3FsPrefix[] = "s3://";
 constexpr int64_t kCloudTpuBlockSize = 127LL << 20;  // 127MB.
 constexpr int64_t kS3BlockSize = kCloudTpuBlockSize;
+// Block size of asynchronous reads when no `buffer_size` is given.
+constexpr int64_t kDefaultAsyncReadBlockSize = 256 << 10;  // 256KB.
+// Suffix of the record index written by `io::RecordWriter::WriteIndex()` next
+// to a file, which allows random access to the records of the file.
+constexpr char kIndexFileSuffix[] = ".index";
 
 bool is_cloud_tpu_gcs_fs() {
 #if (defined(PLATFORM_CLOUD_TPU) && defined(TPU_GCS_FS)) || \
@@ -55,10 +65,12 @@ bool is_cloud_tpu_gcs_fs() {
 class TFRecordDatasetOp::Dataset : public DatasetBase {
  public:
   explicit Dataset(OpKernelContext* ctx, std::vector<string> filenames,
-                   const string& compression_type, int64_t buffer_size)
+                   const string& compression_type, int64_t buffer_size,
+                   int64_t num_outstanding_reads)
       : DatasetBase(DatasetContext(ctx)),
         filenames_(std::move(filenames)),
         compression_type_(compression_type),
+        num_outstanding_reads_(num_outstanding_reads),
         options_(io::RecordReaderOptions::CreateRecordReaderOptions(
             compression_type)) {
     if (buffer_size > 0) {
@@ -87,6 +99,57 @@ class TFRecordDatasetOp::Dataset : public DatasetBase {
     return name_utils::DatasetDebugString(kDatasetType);
   }
 
+  // The cardinality is known if every file has a record index, which is only
+  // read with a moderate compute level.
+  int64_t CardinalityInternal(CardinalityOptions options) const override {
+    if (!compression_type_.empty() ||
+        options.compute_level() <
+            CardinalityOptions::CARDINALITY_COMPUTE_MODERATE) {
+      return kUnknownCardinality;
+    }
+    mutex_lock l(index_mu_);
+    if (!ReadIndexesLocked(Env::Default()).ok()) {
+      return kUnknownCardinality;
+    }
+    return cumulative_num_records_.empty() ? 0
+                                           : cumulative_num_records_.back();
+  }
+
+  Status Get(OpKernelContext* ctx, int64 index,
+             std::vector<Tensor>* out_tensors) const override {
+    TF_RETURN_IF_ERROR(CheckRandomAccessCompatible(index));
+    size_t file_index;
+    int64_t record_number;
+    io::RecordIndex record_index;
+    {
+      mutex_lock l(index_mu_);
+      TF_RETURN_IF_ERROR(ReadIndexesLocked(ctx->env()));
+      file_index = std::upper_bound(cumulative_num_records_.begin(),
+                                    cumulative_num_records_.end(), index) -
+                   cumulative_num_records_.begin();
+      record_number = index;
+      if (file_index > 0) {
+        record_number -= cumulative_num_records_[file_index - 1];
+      }
+      record_index = indexes_[file_index];
+    }
+    std::unique_ptr<RandomAccessFile> file;
+    TF_RETURN_IF_ERROR(ctx->env()->NewRandomAccessFile(
+        TranslateFileName(filenames_[file_index]), &file));
+    io::RecordReader reader(file.get());
+    uint64 offset;
+    TF_RETURN_IF_ERROR(
+        reader.SeekToRecord(record_index, record_number, &offset));
+    Tensor record(DT_STRING, TensorShape({}));
+    TF_RETURN_IF_ERROR(reader.ReadRecord(&offset, &record.scalar<tstring>()()));
+    static monitoring::CounterCell* bytes_counter =
+        metrics::GetTFDataBytesReadCounter(kDatasetType);
+    bytes_counter->IncrementBy(record.scalar<tstring>()().size());
+    out_tensors->clear();
+    out_tensors->push_back(std::move(record));
+    return OkStatus();
+  }
+
   Status InputDatasets(std::vector<const DatasetBase*>* inputs) const override {
     return OkStatus();
   }
@@ -103,8 +166,12 @@ class TFRecordDatasetOp::Dataset : public DatasetBase {
     TF_RETURN_IF_ERROR(b->AddScalar(compression_type_, &compression_type));
     Node* buffer_size = nullptr;
     TF_RETURN_IF_ERROR(b->AddScalar(options_.buffer_size, &buffer_size));
+    AttrValue num_outstanding_reads;
+    b->BuildAttrValue(num_outstanding_reads_, &num_outstanding_reads);
     TF_RETURN_IF_ERROR(b->AddDataset(
-        this, {filenames, compression_type, buffer_size}, output));
+        this, {filenames, compression_type, buffer_size},
+        {std::make_pair(kNumOutstandingReads, num_outstanding_reads)},
+        output));
     return OkStatus();
   }
 
@@ -156,7 +223,7 @@ class TFRecordDatasetOp::Dataset : public DatasetBase {
           return OkStatus();
         }
 
-        TF_RETURN_IF_ERROR(SetupStreamsLocked(ctx->env()));
+        TF_RETURN_IF_ERROR(SetupStreamsLocked(ctx));
       } while (true);
     }
 
@@ -197,7 +264,7 @@ class TFRecordDatasetOp::Dataset : public DatasetBase {
           return OkStatus();
         }
 
-        TF_RETURN_IF_ERROR(SetupStreamsLocked(ctx->env()));
+        TF_RETURN_IF_ERROR(SetupStreamsLocked(ctx));
       } while (true);
     }
 
@@ -231,7 +298,7 @@ class TFRecordDatasetOp::Dataset : public DatasetBase {
       if (reader->Contains(full_name(kOffset))) {
         int64_t offset;
         TF_RETURN_IF_ERROR(reader->ReadScalar(full_name(kOffset), &offset));
-        TF_RETURN_IF_ERROR(SetupStreamsLocked(ctx->env()));
+        TF_RETURN_IF_ERROR(SetupStreamsLocked(ctx));
         TF_RETURN_IF_ERROR(reader_->SeekOffset(offset));
       }
       return OkStatus();
@@ -239,7 +306,8 @@ class TFRecordDatasetOp::Dataset : public DatasetBase {
 
    private:
     // Sets up reader streams to read from the file at `current_file_index_`.
-    Status SetupStreamsLocked(Env* env) TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+    Status SetupStreamsLocked(IteratorContext* ctx)
+        TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
       if (current_file_index_ >= dataset()->filenames_.size()) {
         return errors::InvalidArgument(
             "current_file_index_:", current_file_index_,
@@ -247,36 +315,112 @@ class TFRecordDatasetOp::Dataset : public DatasetBase {
       }
 
       // Actually move on to next file.
-      TF_RETURN_IF_ERROR(env->NewRandomAccessFile(
+      TF_RETURN_IF_ERROR(ctx->env()->NewRandomAccessFile(
           TranslateFileName(dataset()->filenames_[current_file_index_]),
           &file_));
+      RandomAccessFile* file = file_.get();
+      if (dataset()->num_outstanding_reads_ > 0) {
+        if (!thread_pool_) {
+          thread_pool_ = ctx->CreateThreadPool(
+              "tf_record_reads",
+              static_cast<int>(dataset()->num_outstanding_reads_));
+        }
+        const int64_t block_size = dataset()->options_.buffer_size > 0
+                                       ? dataset()->options_.buffer_size
+                                       : kDefaultAsyncReadBlockSize;
+        prefetching_file_ = std::make_unique<PrefetchingRandomAccessFile>(
+            file_.get(), block_size,
+            static_cast<int>(dataset()->num_outstanding_reads_),
+            thread_pool_.get());
+        file = prefetching_file_.get();
+      }
       reader_ = std::make_unique<io::SequentialRecordReader>(
-          file_.get(), dataset()->options_);
+          file, dataset()->options_);
       return OkStatus();
     }
 
     // Resets all reader streams.
     void ResetStreamsLocked() TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
       reader_.reset();
+      prefetching_file_.reset();
       file_.reset();
     }
 
     mutex mu_;
     size_t current_file_index_ TF_GUARDED_BY(mu_) = 0;
 
-    // `reader_` will borrow the object that `file_` points to, so
-    // we must destroy `reader_` before `file_`.
+    // Runs the reads of `prefetching_file_`. Must be ordered before it so
+    // that it is destroyed after all reads have completed.
+    std::unique_ptr<thread::ThreadPool> thread_pool_ TF_GUARDED_BY(mu_);
+    // `reader_` will borrow the object that `prefetching_file_` (if
+    // asynchronous reads are enabled) or `file_` points to, and
+    // `prefetching_file_` borrows `file_`, so we must destroy them in reverse
+    // order.
     std::unique_ptr<RandomAccessFile> file_ TF_GUARDED_BY(mu_);
+    std::unique_ptr<PrefetchingRandomAccessFile> prefetching_file_
+        TF_GUARDED_BY(mu_);
     std::unique_ptr<io::SequentialRecordReader> reader_ TF_GUARDED_BY(mu_);
   };
 
+  // Reads the record indexes of all files, once.
+  Status ReadIndexesLocked(Env* env) const
+      TF_EXCLUSIVE_LOCKS_REQUIRED(index_mu_) {
+    if (!indexes_status_.ok() || !indexes_.empty() || filenames_.empty()) {
+      return indexes_status_;
+    }
+    std::vector<io::RecordIndex> indexes(filenames_.size());
+    std::vector<int64_t> cumulative_num_records(filenames_.size());
+    int64_t num_records = 0;
+    for (size_t i = 0; i < filenames_.size(); ++i) {
+      std::unique_ptr<RandomAccessFile> index_file;
+      indexes_status_ = env->NewRandomAccessFile(
+          TranslateFileName(filenames_[i] + kIndexFileSuffix), &index_file);
+      if (indexes_status_.ok()) {
+        indexes_status_ =
+            io::RecordReader::ReadIndex(index_file.get(), &indexes[i]);
+      }
+      if (!indexes_status_.ok()) {
+        indexes_status_ = errors::FailedPrecondition(
+            "Random access to ", filenames_[i],
+            " requires a record index in ", filenames_[i], kIndexFileSuffix,
+            ": ", indexes_status_.error_message());
+        return indexes_status_;
+      }
+      num_records += indexes[i].num_records;
+      cumulative_num_records[i] = num_records;
+    }
+    indexes_ = std::move(indexes);
+    cumulative_num_records_ = std::move(cumulative_num_records);
+    return OkStatus();
+  }
+
   const std::vector<string> filenames_;
   const tstring compression_type_;
+  // Number of block reads to keep in flight per file. If zero, files are read
+  // synchronously.
+  const int64_t num_outstanding_reads_;
   io::RecordReaderOptions options_;
+
+  mutable mutex index_mu_;
+  // The record indexes of the files, and the number of records in the files
+  // up to and including each file. Read on the first random access.
+  mutable std::vector<io::RecordIndex> indexes_ TF_GUARDED_BY(index_mu_);
+  mutable std::vector<int64_t> cumulative_num_records_
+      TF_GUARDED_BY(index_mu_);
+  mutable Status indexes_status_ TF_GUARDED_BY(index_mu_);
 };
 
 TFRecordDatasetOp::TFRecordDatasetOp(OpKernelConstruction* ctx)
-    : DatasetOpKernel(ctx) {}
+    : DatasetOpKernel(ctx) {
+  if (ctx->HasAttr(kNumOutstandingReads)) {
+    OP_REQUIRES_OK(ctx,
+                   ctx->GetAttr(kNumOutstandingReads, &num_outstanding_reads_));
+    OP_REQUIRES(ctx, num_outstanding_reads_ >= 0,
+                errors::InvalidArgument(
+                    "`num_outstanding_reads` must be >= 0 (0 == synchronous "
+                    "reads)"));
+  }
+}
 
 void TFRecordDatasetOp::MakeDataset(OpKernelContext* ctx,
                                     DatasetBase** output) {
@@ -324,8 +468,8 @@ void TFRecordDatasetOp::MakeDataset(OpKernelContext* ctx,
     buffer_size = kS3BlockSize;
   }
 
-  *output =
-      new Dataset(ctx, std::move(filenames), compression_type, buffer_size);
+  *output = new Dataset(ctx, std::move(filenames), compression_type,
+                        buffer_size, num_outstanding_reads_);
 }
 
 namespace {
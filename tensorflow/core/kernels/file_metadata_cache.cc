@@ -0,0 +1,85 @@
+/* Copyright 2022 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/kernels/file_metadata_cache.h"
+
+#include "tensorflow/core/platform/errors.h"
+#include "tensorflow/core/platform/logging.h"
+#include "tensorflow/core/util/env_var.h"
+
+namespace tensorflow {
+
+FileMetadataCache::FileMetadataCache(uint64 max_age, size_t max_entries,
+                                     Env* env)
+    : env_(env),
+      matching_paths_cache_(max_age, max_entries, env),
+      children_cache_(max_age, max_entries, env),
+      is_directory_cache_(max_age, max_entries, env) {}
+
+FileMetadataCache* FileMetadataCache::Global() {
+  static FileMetadataCache* cache = []() {
+    int64_t max_age;
+    Status s = ReadInt64FromEnvVar("TF_FILE_METADATA_CACHE_MAX_AGE", 0,
+                                   &max_age);
+    if (!s.ok() || max_age < 0) {
+      LOG(WARNING) << "Ignoring TF_FILE_METADATA_CACHE_MAX_AGE: " << s;
+      max_age = 0;
+    }
+    int64_t max_entries;
+    s = ReadInt64FromEnvVar("TF_FILE_METADATA_CACHE_MAX_ENTRIES", 65536,
+                            &max_entries);
+    if (!s.ok() || max_entries < 0) {
+      LOG(WARNING) << "Ignoring TF_FILE_METADATA_CACHE_MAX_ENTRIES: " << s;
+      max_entries = 65536;
+    }
+    return new FileMetadataCache(max_age, max_entries);
+  }();
+  return cache;
+}
+
+// The lookups do not use ExpiringLRUCache::LookupOrCompute, which holds the
+// cache lock while it computes, so that misses can run in parallel.
+
+Status FileMetadataCache::GetMatchingPaths(const string& pattern,
+                                           std::vector<string>* results) {
+  if (matching_paths_cache_.Lookup(pattern, results)) return OkStatus();
+  TF_RETURN_IF_ERROR(env_->GetMatchingPaths(pattern, results));
+  matching_paths_cache_.Insert(pattern, *results);
+  return OkStatus();
+}
+
+Status FileMetadataCache::GetChildren(const string& dir,
+                                      std::vector<string>* result) {
+  if (children_cache_.Lookup(dir, result)) return OkStatus();
+  TF_RETURN_IF_ERROR(env_->GetChildren(dir, result));
+  children_cache_.Insert(dir, *result);
+  return OkStatus();
+}
+
+Status FileMetadataCache::IsDirectory(const string& path) {
+  bool is_directory;
+  if (!is_directory_cache_.Lookup(path, &is_directory)) {
+    Status s = env_->IsDirectory(path);
+    if (!s.ok() && !errors::IsFailedPrecondition(s)) return s;
+    is_directory = s.ok();
+    is_directory_cache_.Insert(path, is_directory);
+  }
+  if (!is_directory) {
+    return errors::FailedPrecondition(path, " is not a directory");
+  }
+  return OkStatus();
+}
+
+}  // namespace tensorflow
@@ -0,0 +1,69 @@
+/* Copyright 2022 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_CORE_KERNELS_FILE_METADATA_CACHE_H_
+#define TENSORFLOW_CORE_KERNELS_FILE_METADATA_CACHE_H_
+
+#include <string>
+#include <vector>
+
+#include "tensorflow/core/platform/cloud/expiring_lru_cache.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/macros.h"
+#include "tensorflow/core/platform/status.h"
+#include "tensorflow/core/platform/types.h"
+
+namespace tensorflow {
+
+// A cache of the directory listings, glob results and directory checks of
+// any file system, for the ops that expand file patterns.  Concurrent input
+// pipelines and repeated epochs over the same prefixes then share one set of
+// List and Stat calls instead of sending their own to the file system.
+//
+// Entries can be stale for up to `max_age` seconds, so the cache suits
+// datasets that are not written while they are read.  Errors are not cached.
+//
+// This class is thread safe.
+class FileMetadataCache {
+ public:
+  // A `max_age` of 0 disables the cache; see ExpiringLRUCache.
+  FileMetadataCache(uint64 max_age, size_t max_entries,
+                    Env* env = Env::Default());
+
+  // The cache used by the MatchingFiles and MatchingFilesDataset ops.
+  // Disabled unless the environment variable TF_FILE_METADATA_CACHE_MAX_AGE
+  // is set to a positive number of seconds.
+  // TF_FILE_METADATA_CACHE_MAX_ENTRIES limits the number of entries of each
+  // kind and defaults to 65536.
+  static FileMetadataCache* Global();
+
+  // Like the Env methods of the same names.
+  Status GetMatchingPaths(const string& pattern, std::vector<string>* results);
+  Status GetChildren(const string& dir, std::vector<string>* result);
+  // Returns OK for directories and FAILED_PRECONDITION for other files.
+  Status IsDirectory(const string& path);
+
+ private:
+  Env* const env_;
+  ExpiringLRUCache<std::vector<string>> matching_paths_cache_;
+  ExpiringLRUCache<std::vector<string>> children_cache_;
+  ExpiringLRUCache<bool> is_directory_cache_;
+
+  TF_DISALLOW_COPY_AND_ASSIGN(FileMetadataCache);
+};
+
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_KERNELS_FILE_METADATA_CACHE_H_
@@ -0,0 +1,91 @@
+/* Copyright 2022 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/kernels/file_metadata_cache.h"
+
+#include <algorithm>
+#include <string>
+#include <vector>
+
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/lib/io/path.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/errors.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace {
+
+class FileMetadataCacheTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    dir_ = io::JoinPath(testing::TmpDir(), "file_metadata_cache_test");
+    int64_t undeleted_files, undeleted_dirs;
+    Env::Default()
+        ->DeleteRecursively(dir_, &undeleted_files, &undeleted_dirs)
+        .IgnoreError();
+    TF_ASSERT_OK(Env::Default()->RecursivelyCreateDir(dir_));
+    WriteFile("a.txt");
+  }
+
+  void WriteFile(const string& name) {
+    TF_ASSERT_OK(WriteStringToFile(Env::Default(), io::JoinPath(dir_, name),
+                                   "contents"));
+  }
+
+  string dir_;
+};
+
+TEST_F(FileMetadataCacheTest, CachesUntilMaxAge) {
+  FileMetadataCache cache(/*max_age=*/3600, /*max_entries=*/10);
+  const string pattern = io::JoinPath(dir_, "*.txt");
+  std::vector<string> paths;
+  TF_ASSERT_OK(cache.GetMatchingPaths(pattern, &paths));
+  EXPECT_EQ(std::vector<string>({io::JoinPath(dir_, "a.txt")}), paths);
+  std::vector<string> children;
+  TF_ASSERT_OK(cache.GetChildren(dir_, &children));
+  EXPECT_EQ(std::vector<string>({"a.txt"}), children);
+
+  // The cached results do not see the new file.
+  WriteFile("b.txt");
+  TF_ASSERT_OK(cache.GetMatchingPaths(pattern, &paths));
+  EXPECT_EQ(1, paths.size());
+  TF_ASSERT_OK(cache.GetChildren(dir_, &children));
+  EXPECT_EQ(1, children.size());
+
+  // A disabled cache does.
+  FileMetadataCache disabled(/*max_age=*/0, /*max_entries=*/10);
+  TF_ASSERT_OK(disabled.GetMatchingPaths(pattern, &paths));
+  EXPECT_EQ(2, paths.size());
+  TF_ASSERT_OK(disabled.GetChildren(dir_, &children));
+  EXPECT_EQ(2, children.size());
+}
+
+TEST_F(FileMetadataCacheTest, IsDirectory) {
+  FileMetadataCache cache(/*max_age=*/3600, /*max_entries=*/10);
+  for (int i = 0; i < 2; ++i) {
+    TF_EXPECT_OK(cache.IsDirectory(dir_));
+    EXPECT_TRUE(errors::IsFailedPrecondition(
+        cache.IsDirectory(io::JoinPath(dir_, "a.txt"))));
+  }
+  // Errors are not cached.
+  const string missing = io::JoinPath(dir_, "missing");
+  EXPECT_TRUE(errors::IsNotFound(cache.IsDirectory(missing)));
+  TF_ASSERT_OK(Env::Default()->CreateDir(missing));
+  TF_EXPECT_OK(cache.IsDirectory(missing));
+}
+
+}  // namespace
+}  // namespace tensorflow
@@ -0,0 +1,261 @@
+/* Copyright 2022 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+// See docs in ../ops/math_ops.cc.
+//
+// Implements the _FusedElementwise op, which Grappler's Remapper creates from
+// chains of element-wise ops. Instead of making a pass over memory per op, the
+// kernel splits the output into blocks small enough to stay in cache, and
+// applies the whole chain to one block before moving on to the next.
+
+#define EIGEN_USE_THREADS
+
+#include <algorithm>
+#include <string>
+#include <vector>
+
+#include "absl/strings/str_join.h"
+#include "third_party/eigen3/unsupported/Eigen/CXX11/Tensor"
+#include "tensorflow/core/framework/op_kernel.h"
+#include "tensorflow/core/framework/register_types.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_shape.h"
+#include "tensorflow/core/framework/tensor_types.h"
+#include "tensorflow/core/lib/core/errors.h"
+#include "tensorflow/core/util/work_sharder.h"
+
+namespace tensorflow {
+
+typedef Eigen::ThreadPoolDevice CPUDevice;
+
+namespace {
+
+enum class FusedOp {
+  // Unary ops.
+  kAbs,
+  kExp,
+  kNeg,
+  kRelu,
+  kSigmoid,
+  kSquare,
+  kTanh,
+  // Binary ops. These take their second input from `args`.
+  kAdd,
+  kMaximum,
+  kMinimum,
+  kMul,
+  kSub,
+};
+
+bool IsBinary(FusedOp op) { return op >= FusedOp::kAdd; }
+
+Status ParseFusedOp(const string& name, FusedOp* op) {
+  if (name == "Abs") {
+    *op = FusedOp::kAbs;
+  } else if (name == "Exp") {
+    *op = FusedOp::kExp;
+  } else if (name == "Neg") {
+    *op = FusedOp::kNeg;
+  } else if (name == "Relu") {
+    *op = FusedOp::kRelu;
+  } else if (name == "Sigmoid") {
+    *op = FusedOp::kSigmoid;
+  } else if (name == "Square") {
+    *op = FusedOp::kSquare;
+  } else if (name == "Tanh") {
+    *op = FusedOp::kTanh;
+  } else if (name == "Add" || name == "AddV2") {
+    *op = FusedOp::kAdd;
+  } else if (name == "Maximum") {
+    *op = FusedOp::kMaximum;
+  } else if (name == "Minimum") {
+    *op = FusedOp::kMinimum;
+  } else if (name == "Mul") {
+    *op = FusedOp::kMul;
+  } else if (name == "Sub") {
+    *op = FusedOp::kSub;
+  } else {
+    return errors::Unimplemented("Unsupported fused element-wise op: ", name);
+  }
+  return OkStatus();
+}
+
+// Number of elements the fused ops are applied to at a time. A block of the
+// output and of each arg comfortably fits in L1 cache.
+constexpr int64_t kBlockSize = 1024;
+
+}  // namespace
+
+template <typename T>
+class FusedElementwiseOp : public OpKernel {
+ public:
+  explicit FusedElementwiseOp(OpKernelConstruction* context)
+      : OpKernel(context) {
+    std::vector<string> fused_ops;
+    OP_REQUIRES_OK(context, context->GetAttr("fused_ops", &fused_ops));
+    OP_REQUIRES(context, !fused_ops.empty(),
+                errors::InvalidArgument("Fused ops must not be empty"));
+    int num_args;
+    OP_REQUIRES_OK(context, context->GetAttr("num_args", &num_args));
+
+    int num_binary_ops = 0;
+    for (const string& name : fused_ops) {
+      Step step;
+      OP_REQUIRES_OK(context, ParseFusedOp(name, &step.op));
+      if (IsBinary(step.op)) step.arg = num_binary_ops++;
+      steps_.push_back(step);
+    }
+    OP_REQUIRES(context, num_binary_ops == num_args,
+                errors::InvalidArgument(
+                    "Fused ops [", absl::StrJoin(fused_ops, ","), "] take ",
+                    num_binary_ops, " args, but num_args=", num_args));
+  }
+
+  void Compute(OpKernelContext* context) override {
+    const Tensor& x = context->input(0);
+    OpInputList args;
+    OP_REQUIRES_OK(context, context->input_list("args", &args));
+    for (int i = 0; i < args.size(); ++i) {
+      OP_REQUIRES(context,
+                  args[i].shape() == x.shape() ||
+                      TensorShapeUtils::IsScalar(args[i].shape()),
+                  errors::InvalidArgument(
+                      "Fused op arg ", i, " must be a scalar or have shape ",
+                      x.shape().DebugString(), ", got ",
+                      args[i].shape().DebugString()));
+    }
+
+    Tensor* y = nullptr;
+    OP_REQUIRES_OK(context, context->forward_input_or_allocate_output(
+                                {0}, 0, x.shape(), &y));
+    const int64_t size = x.NumElements();
+    if (size == 0) return;
+
+    const T* x_data = x.flat<T>().data();
+    T* y_data = y->flat<T>().data();
+    std::vector<const T*> arg_data;
+    std::vector<bool> arg_is_scalar;
+    for (int i = 0; i < args.size(); ++i) {
+      arg_data.push_back(args[i].flat<T>().data());
+      arg_is_scalar.push_back(args[i].NumElements() == 1);
+    }
+
+    auto compute_blocks = [&](int64_t begin_block, int64_t end_block) {
+      for (int64_t b = begin_block; b < end_block; ++b) {
+        const int64_t begin = b * kBlockSize;
+        const int64_t n = std::min(kBlockSize, size - begin);
+        typename TTypes<T>::Flat block(y_data + begin, n);
+        if (y_data != x_data) {
+          block = typename TTypes<T>::ConstFlat(x_data + begin, n);
+        }
+        for (const Step& step : steps_) {
+          if (!IsBinary(step.op)) {
+            ApplyUnary(step.op, &block);
+          } else if (arg_is_scalar[step.arg]) {
+            ApplyBinary(step.op, block.constant(arg_data[step.arg][0]),
+                        &block);
+          } else {
+            ApplyBinary(step.op,
+                        typename TTypes<T>::ConstFlat(
+                            arg_data[step.arg] + begin, n),
+                        &block);
+          }
+        }
+      }
+    };
+
+    const int64_t num_blocks = Eigen::divup(size, kBlockSize);
+    // Transcendental ops dominate the cost of a chain, count them generously.
+    const int64_t cost_per_block =
+        kBlockSize * static_cast<int64_t>(steps_.size()) * 10;
+    const auto& worker_threads =
+        *context->device()->tensorflow_cpu_worker_threads();
+    Shard(worker_threads.num_threads, worker_threads.workers, num_blocks,
+          cost_per_block, compute_blocks);
+  }
+
+ private:
+  struct Step {
+    FusedOp op;
+    int arg = -1;  // Index into `args` of the second input of binary ops.
+  };
+
+  static void ApplyUnary(FusedOp op, typename TTypes<T>::Flat* block) {
+    auto& b = *block;
+    switch (op) {
+      case FusedOp::kAbs:
+        b = b.abs();
+        break;
+      case FusedOp::kExp:
+        b = b.exp();
+        break;
+      case FusedOp::kNeg:
+        b = -b;
+        break;
+      case FusedOp::kRelu:
+        b = b.template cwiseMax<Eigen::PropagateNaN>(static_cast<T>(0));
+        break;
+      case FusedOp::kSigmoid:
+        b = b.sigmoid();
+        break;
+      case FusedOp::kSquare:
+        b = b.square();
+        break;
+      case FusedOp::kTanh:
+        b = b.tanh();
+        break;
+      default:
+        LOG(FATAL) << "Not a unary op";  // Crash OK
+    }
+  }
+
+  template <typename Arg>
+  static void ApplyBinary(FusedOp op, const Arg& arg,
+                          typename TTypes<T>::Flat* block) {
+    auto& b = *block;
+    switch (op) {
+      case FusedOp::kAdd:
+        b = b + arg;
+        break;
+      case FusedOp::kMaximum:
+        b = b.template cwiseMax<Eigen::PropagateNaN>(arg);
+        break;
+      case FusedOp::kMinimum:
+        b = b.template cwiseMin<Eigen::PropagateNaN>(arg);
+        break;
+      case FusedOp::kMul:
+        b = b * arg;
+        break;
+      case FusedOp::kSub:
+        b = b - arg;
+        break;
+      default:
+        LOG(FATAL) << "Not a binary op";  // Crash OK
+    }
+  }
+
+  std::vector<Step> steps_;
+};
+
+#define REGISTER_CPU(T)                                                   \
+  REGISTER_KERNEL_BUILDER(                                                \
+      Name("_FusedElementwise").Device(DEVICE_CPU).TypeConstraint<T>("T"), \
+      FusedElementwiseOp<T>);
+
+TF_CALL_float(REGISTER_CPU);
+TF_CALL_double(REGISTER_CPU);
+#undef REGISTER_CPU
+
+}  // namespace tensorflow
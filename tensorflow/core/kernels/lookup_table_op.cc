@@ -24,6 +24,7 @@ limitations under the License.
 #include "tensorflow/core/framework/types.h"
 #include "tensorflow/core/framework/variant.h"
 #include "tensorflow/core/kernels/initializable_lookup_table.h"
+#include "tensorflow/core/kernels/sharded_hash_map.h"
 #include "tensorflow/core/lib/gtl/inlined_vector.h"
 #include "tensorflow/core/lib/hash/hash.h"
 #include "tensorflow/core/platform/random.h"
@@ -36,11 +37,13 @@ std::string UniqueNodeName(const std::string& base) {
   return strings::StrCat(base, "/", counter.fetch_add(1), "/", random::New64());
 }
 
-// Lookup table that wraps an unordered_map, where the key and value data type
+// Lookup table that wraps a ShardedHashMap, where the key and value data type
 // is specified. Each individual value must be a scalar. If vector values are
 // required, use MutableHashTableOfTensors.
 //
 // This table is mutable and thread safe - Insert can be called at any time.
+// Find, Insert and Remove only lock the shards of the keys they touch, so
+// concurrent calls from many threads rarely contend.
 //
 // Sample use case:
 //
@@ -55,10 +58,7 @@ class MutableHashTableOfScalars final : public LookupInterface {
  public:
   MutableHashTableOfScalars(OpKernelContext* ctx, OpKernel* kernel) {}
 
-  size_t size() const override {
-    tf_shared_lock l(mu_);
-    return table_.size();
-  }
+  size_t size() const override { return table_.size(); }
 
   Status Find(OpKernelContext* ctx, const Tensor& key, Tensor* value,
               const Tensor& default_value) override {
@@ -70,7 +70,6 @@ class MutableHashTableOfScalars final : public LookupInterface {
     int64_t default_total = default_flat.size();
     bool is_full_size_default = (total == default_total);
 
-    tf_shared_lock l(mu_);
     for (int64_t i = 0; i < key_values.size(); ++i) {
       // is_full_size_default is true:
       //   Each key has an independent default value, key_values(i)
@@ -78,9 +77,11 @@ class MutableHashTableOfScalars final : public LookupInterface {
       //
       // is_full_size_default is false:
       //   All keys will share the default_flat(0) as default value.
-      value_values(i) = gtl::FindWithDefault(
-          table_, SubtleMustCopyIfIntegral(key_values(i)),
-          is_full_size_default ? default_flat(i) : default_flat(0));
+      if (!table_.Find(SubtleMustCopyIfIntegral(key_values(i)),
+                       [&](const V& v) { value_values(i) = v; })) {
+        value_values(i) =
+            is_full_size_default ? default_flat(i) : default_flat(0);
+      }
     }
 
     return OkStatus();
@@ -90,13 +91,19 @@ class MutableHashTableOfScalars final : public LookupInterface {
     const auto key_values = keys.flat<K>();
     const auto value_values = values.flat<V>();
 
-    mutex_lock l(mu_);
     if (clear) {
-      table_.clear();
+      // Imports replace the whole table at once.
+      typename ShardedHashMap<K, V>::WriterLock l(&table_);
+      l.Clear();
+      for (int64_t i = 0; i < key_values.size(); ++i) {
+        l.InsertOrAssign(SubtleMustCopyIfIntegral(key_values(i)),
+                         SubtleMustCopyIfIntegral(value_values(i)));
+      }
+      return OkStatus();
     }
     for (int64_t i = 0; i < key_values.size(); ++i) {
-      gtl::InsertOrUpdate(&table_, SubtleMustCopyIfIntegral(key_values(i)),
-                          SubtleMustCopyIfIntegral(value_values(i)));
+      table_.InsertOrAssign(SubtleMustCopyIfIntegral(key_values(i)),
+                            SubtleMustCopyIfIntegral(value_values(i)));
     }
     return OkStatus();
   }
@@ -109,9 +116,8 @@ class MutableHashTableOfScalars final : public LookupInterface {
   Status Remove(OpKernelContext* ctx, const Tensor& keys) override {
     const auto key_values = keys.flat<K>();
 
-    mutex_lock l(mu_);
     for (int64_t i = 0; i < key_values.size(); ++i) {
-      table_.erase(SubtleMustCopyIfIntegral(key_values(i)));
+      table_.Erase(SubtleMustCopyIfIntegral(key_values(i)));
     }
     return OkStatus();
   }
@@ -122,8 +128,8 @@ class MutableHashTableOfScalars final : public LookupInterface {
   }
 
   Status ExportValues(OpKernelContext* ctx) override {
-    tf_shared_lock l(mu_);
-    int64_t size = table_.size();
+    typename ShardedHashMap<K, V>::ReaderLock l(table_);
+    int64_t size = l.size();
 
     Tensor* keys;
     Tensor* values;
@@ -131,7 +137,7 @@ class MutableHashTableOfScalars final : public LookupInterface {
         ctx->allocate_output("keys", TensorShape({size}), &keys));
     TF_RETURN_IF_ERROR(
         ctx->allocate_output("values", TensorShape({size}), &values));
-    ExportKeysAndValues(keys, values);
+    ExportKeysAndValues(l, keys, values);
     return OkStatus();
   }
 
@@ -144,25 +150,15 @@ class MutableHashTableOfScalars final : public LookupInterface {
   TensorShape value_shape() const override { return TensorShape(); }
 
   int64_t MemoryUsed() const override {
-    int64_t ret = 0;
-    tf_shared_lock l(mu_);
-    for (unsigned i = 0; i < table_.bucket_count(); ++i) {
-      size_t bucket_size = table_.bucket_size(i);
-      if (bucket_size == 0) {
-        ret++;
-      } else {
-        ret += bucket_size;
-      }
-    }
-    return sizeof(MutableHashTableOfScalars) + ret;
+    return sizeof(MutableHashTableOfScalars) + table_.capacity();
   }
 
   Status AsGraphDef(GraphDefBuilder* builder, Node** out) const override {
-    tf_shared_lock l(mu_);
-    int64_t size = table_.size();
+    typename ShardedHashMap<K, V>::ReaderLock l(table_);
+    int64_t size = l.size();
     Tensor keys(key_dtype(), TensorShape({size}));
     Tensor values(value_dtype(), TensorShape({size}));
-    ExportKeysAndValues(&keys, &values);
+    ExportKeysAndValues(l, &keys, &values);
 
     // We set use_node_name_sharing with a unique node name so that the resource
     // can outlive the MutableHashTableV2 kernel. This means that the lifetime
@@ -196,23 +192,23 @@ class MutableHashTableOfScalars final : public LookupInterface {
 
  private:
   // Writes all keys and values into `keys` and `values`. `keys` and `values`
-  // must point to tensors of size `table_.size()`.
-  void ExportKeysAndValues(Tensor* keys, Tensor* values) const
-      TF_SHARED_LOCKS_REQUIRED(mu_) {
+  // must point to tensors of size `l.size()`.
+  void ExportKeysAndValues(const typename ShardedHashMap<K, V>::ReaderLock& l,
+                           Tensor* keys, Tensor* values) const {
     auto keys_data = keys->flat<K>();
     auto values_data = values->flat<V>();
     int64_t i = 0;
-    for (auto it = table_.begin(); it != table_.end(); ++it, ++i) {
-      keys_data(i) = it->first;
-      values_data(i) = it->second;
-    }
+    l.ForEach([&](const K& key, const V& value) {
+      keys_data(i) = key;
+      values_data(i) = value;
+      ++i;
+    });
   }
 
-  mutable mutex mu_;
-  std::unordered_map<K, V> table_ TF_GUARDED_BY(mu_);
+  ShardedHashMap<K, V> table_;
 };
 
-// Lookup table that wraps an unordered_map. Behaves identical to
+// Lookup table that wraps a ShardedHashMap. Behaves identical to
 // MutableHashTableOfScalars except that each value must be a vector.
 template <class K, class V>
 class MutableHashTableOfTensors final : public LookupInterface {
@@ -226,10 +222,7 @@ class MutableHashTableOfTensors final : public LookupInterface {
                                 value_shape_.DebugString()));
   }
 
-  size_t size() const override {
-    tf_shared_lock l(mu_);
-    return table_.size();
-  }
+  size_t size() const override { return table_.size(); }
 
   Status Find(OpKernelContext* ctx, const Tensor& key, Tensor* value,
               const Tensor& default_value) override {
@@ -242,15 +235,15 @@ class MutableHashTableOfTensors final : public LookupInterface {
     int64_t default_total = default_flat.size();
     bool is_full_size_default = (total == default_total);
 
-    tf_shared_lock l(mu_);
     for (int64_t i = 0; i < key_values.size(); ++i) {
-      ValueArray* value_vec =
-          gtl::FindOrNull(table_, SubtleMustCopyIfIntegral(key_values(i)));
-      if (value_vec != nullptr) {
-        for (int64_t j = 0; j < value_dim; j++) {
-          value_values(i, j) = value_vec->at(j);
-        }
-      } else {
+      const bool found =
+          table_.Find(SubtleMustCopyIfIntegral(key_values(i)),
+                      [&](const ValueArray& value_vec) {
+                        for (int64_t j = 0; j < value_dim; j++) {
+                          value_values(i, j) = value_vec.at(j);
+                        }
+                      });
+      if (!found) {
         // is_full_size_default is true:
         //   Each key has an independent default value, key_values(i)
         //   corresponding uses default_flat(i) as its default value.
@@ -271,19 +264,28 @@ class MutableHashTableOfTensors final : public LookupInterface {
     const auto key_values = keys.flat<K>();
     const auto value_values = values.flat_inner_dims<V, 2>();
     int64_t value_dim = value_shape_.dim_size(0);
-
-    mutex_lock l(mu_);
-    if (clear) {
-      table_.clear();
-    }
-    for (int64_t i = 0; i < key_values.size(); ++i) {
+    auto make_value = [&](int64_t i) {
       ValueArray value_vec;
       for (int64_t j = 0; j < value_dim; j++) {
         V value = value_values(i, j);
         value_vec.push_back(value);
       }
-      gtl::InsertOrUpdate(&table_, SubtleMustCopyIfIntegral(key_values(i)),
-                          value_vec);
+      return value_vec;
+    };
+
+    if (clear) {
+      // Imports replace the whole table at once.
+      typename ShardedHashMap<K, ValueArray>::WriterLock l(&table_);
+      l.Clear();
+      for (int64_t i = 0; i < key_values.size(); ++i) {
+        l.InsertOrAssign(SubtleMustCopyIfIntegral(key_values(i)),
+                         make_value(i));
+      }
+      return OkStatus();
+    }
+    for (int64_t i = 0; i < key_values.size(); ++i) {
+      table_.InsertOrAssign(SubtleMustCopyIfIntegral(key_values(i)),
+                            make_value(i));
     }
     return OkStatus();
   }
@@ -296,9 +298,8 @@ class MutableHashTableOfTensors final : public LookupInterface {
   Status Remove(OpKernelContext* ctx, const Tensor& keys) override {
     const auto key_values = keys.flat<K>();
 
-    mutex_lock l(mu_);
     for (int64_t i = 0; i < key_values.size(); ++i) {
-      table_.erase(SubtleMustCopyIfIntegral(key_values(i)));
+      table_.Erase(SubtleMustCopyIfIntegral(key_values(i)));
     }
     return OkStatus();
   }
@@ -309,8 +310,8 @@ class MutableHashTableOfTensors final : public LookupInterface {
   }
 
   Status ExportValues(OpKernelContext* ctx) override {
-    tf_shared_lock l(mu_);
-    int64_t size = table_.size();
+    typename ShardedHashMap<K, ValueArray>::ReaderLock l(table_);
+    int64_t size = l.size();
     int64_t value_dim = value_shape_.dim_size(0);
 
     Tensor* keys;
@@ -319,7 +320,7 @@ class MutableHashTableOfTensors final : public LookupInterface {
         ctx->allocate_output("keys", TensorShape({size}), &keys));
     TF_RETURN_IF_ERROR(ctx->allocate_output(
         "values", TensorShape({size, value_dim}), &values));
-    ExportKeysAndValues(keys, values);
+    ExportKeysAndValues(l, keys, values);
     return OkStatus();
   }
 
@@ -332,25 +333,15 @@ class MutableHashTableOfTensors final : public LookupInterface {
   TensorShape value_shape() const override { return value_shape_; }
 
   int64_t MemoryUsed() const override {
-    int64_t ret = 0;
-    tf_shared_lock l(mu_);
-    for (unsigned i = 0; i < table_.bucket_count(); ++i) {
-      size_t bucket_size = table_.bucket_size(i);
-      if (bucket_size == 0) {
-        ret++;
-      } else {
-        ret += bucket_size;
-      }
-    }
-    return sizeof(MutableHashTableOfTensors) + ret;
+    return sizeof(MutableHashTableOfTensors) + table_.capacity();
   }
 
   Status AsGraphDef(GraphDefBuilder* builder, Node** out) const override {
-    tf_shared_lock l(mu_);
-    int64_t size = table_.size();
+    typename ShardedHashMap<K, ValueArray>::ReaderLock l(table_);
+    int64_t size = l.size();
     Tensor keys(key_dtype(), TensorShape({size}));
     Tensor values(value_dtype(), TensorShape({size, value_shape_.dim_size(0)}));
-    ExportKeysAndValues(&keys, &values);
+    ExportKeysAndValues(l, &keys, &values);
 
     // We set use_node_name_sharing with a unique node name so that the resource
     // can outlive the MutableHashTableOfTensorsV2 kernel. This means that the
@@ -384,28 +375,28 @@ class MutableHashTableOfTensors final : public LookupInterface {
   }
 
  private:
+  typedef gtl::InlinedVector<V, 4> ValueArray;
+
   // Writes all keys and values into `keys` and `values`. `keys` and `values`
-  // must point to tensors of size `table_.size()`.
-  void ExportKeysAndValues(Tensor* keys, Tensor* values) const
-      TF_SHARED_LOCKS_REQUIRED(mu_) {
+  // must point to tensors of size `l.size()`.
+  void ExportKeysAndValues(
+      const typename ShardedHashMap<K, ValueArray>::ReaderLock& l,
+      Tensor* keys, Tensor* values) const {
     int64_t value_dim = value_shape_.dim_size(0);
     auto keys_data = keys->flat<K>();
     auto values_data = values->matrix<V>();
     int64_t i = 0;
-    for (auto it = table_.begin(); it != table_.end(); ++it, ++i) {
-      K key = it->first;
-      ValueArray value = it->second;
+    l.ForEach([&](const K& key, const ValueArray& value) {
       keys_data(i) = key;
       for (int64_t j = 0; j < value_dim; j++) {
         values_data(i, j) = value[j];
       }
-    }
+      ++i;
+    });
   }
 
   TensorShape value_shape_;
-  mutable mutex mu_;
-  typedef gtl::InlinedVector<V, 4> ValueArray;
-  std::unordered_map<K, ValueArray> table_ TF_GUARDED_BY(mu_);
+  ShardedHashMap<K, ValueArray> table_;
 };
 
 namespace {
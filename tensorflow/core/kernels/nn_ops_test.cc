@@ -1527,4 +1527,11 @@ BM_TopKCPU(128, 70000, 70000, 16, "topk_nmt_r_128_c_70000_k_70000_th_16");
 BM_TopKCPU(128, 175000, 175000, 16, "topk_nmt_r_128_c_175000_k_175000_th_16");
 BM_TopKCPU(128, 350000, 350000, 16, "topk_nmt_r_128_c_350000_k_350000_th_16");
 
+// Long rows with large k, e.g. retrieval over a large vocabulary.
+BM_TopKGPU(1, 1000000, 100, 1, "topk_r_1_c_1000000_k_100_th_1");
+BM_TopKGPU(1, 1000000, 1000, 1, "topk_r_1_c_1000000_k_1000_th_1");
+BM_TopKGPU(1, 10000000, 10000, 1, "topk_r_1_c_10000000_k_10000_th_1");
+BM_TopKGPU(32, 100000, 1000, 1, "topk_r_32_c_100000_k_1000_th_1");
+BM_TopKGPU(128, 100000, 10000, 1, "topk_r_128_c_100000_k_10000_th_1");
+
 }  // namespace tensorflow
@@ -28,6 +28,7 @@ limitations under the License.
 #include "tensorflow/core/kernels/conv_ops.h"
 #include "tensorflow/core/kernels/meta_support.h"
 #include "tensorflow/core/kernels/quantization_utils.h"
+#include "tensorflow/core/kernels/quantized_gemm_x86.h"
 #include "tensorflow/core/kernels/reference_gemm.h"
 #include "tensorflow/core/lib/core/errors.h"
 #include "tensorflow/core/platform/errors.h"
@@ -399,6 +400,15 @@ class Im2ColConvFunctor {
         meta::QuantizedGemm(context, transpose_a, transpose_b, im2col_buffer,
                             filter_data, chunk_output_data, m, n, k,
                             -input_offset, -filter_offset, lda, ldb, ldc);
+      } else if (x86_qgemm::IsSupported() && std::is_same<T1, quint8>() &&
+                 std::is_same<T2, quint8>() && std::is_same<T3, qint32>() &&
+                 (output_offset == 0) && (output_mult == 1) &&
+                 (output_shift == 0) && (transpose_c == false)) {
+        // Native eight-bit kernels for x86 CPUs with AVX512-VNNI or AMX.
+        x86_qgemm::QuantizedGemm(context, transpose_a, transpose_b,
+                                 im2col_buffer, filter_data, chunk_output_data,
+                                 m, n, k, input_offset, filter_offset, lda, ldb,
+                                 ldc);
       } else if (std::is_same<T1, quint8>() && std::is_same<T2, quint8>() &&
                  std::is_same<T3, qint32>() && (output_offset == 0) &&
                  (output_mult == 1) && (output_shift == 0)) {
@@ -0,0 +1,411 @@
+/* Copyright 2022 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/kernels/quantized_gemm_x86.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <vector>
+
+#include "tensorflow/core/framework/op_kernel.h"
+#include "tensorflow/core/platform/cpu_info.h"
+#include "tensorflow/core/platform/logging.h"
+#include "tensorflow/core/util/work_sharder.h"
+
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+#define TF_X86_QGEMM_KERNELS 1
+#include <immintrin.h>
+#if defined(__linux__)
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif  // __linux__
+#endif  // __x86_64__ && (__GNUC__ || __clang__)
+
+namespace tensorflow {
+namespace x86_qgemm {
+namespace {
+
+#if defined(TF_X86_QGEMM_KERNELS)
+bool AmxIsPermitted() {
+#if defined(__linux__)
+  // Linux only saves the AMX tile data of processes that ask for it.
+  constexpr int kArchReqXcompPerm = 0x1023;
+  constexpr int kXFeatureXTileData = 18;
+  return syscall(SYS_arch_prctl, kArchReqXcompPerm, kXFeatureXTileData) == 0;
+#else
+  return false;
+#endif  // __linux__
+}
+#endif  // TF_X86_QGEMM_KERNELS
+
+Isa SupportedIsa() {
+#if defined(TF_X86_QGEMM_KERNELS)
+  using port::CPUFeature;
+  using port::TestCPUFeature;
+  if (!TestCPUFeature(CPUFeature::AVX512F) ||
+      !TestCPUFeature(CPUFeature::AVX512BW) ||
+      !TestCPUFeature(CPUFeature::AVX512VL) ||
+      !TestCPUFeature(CPUFeature::AVX512_VNNI)) {
+    return Isa::kNone;
+  }
+  if (TestCPUFeature(CPUFeature::AMX_TILE) &&
+      TestCPUFeature(CPUFeature::AMX_INT8) && AmxIsPermitted()) {
+    return Isa::kAmx;
+  }
+  return Isa::kAvx512Vnni;
+#else
+  return Isa::kNone;
+#endif
+}
+
+Isa GetSupportedIsa() {
+  static const Isa isa = SupportedIsa();
+  return isa;
+}
+
+std::atomic<Isa> max_isa{Isa::kAmx};
+
+// Where and how the sums are written.
+struct Output {
+  qint32* c32 = nullptr;
+  quint8* c8 = nullptr;
+  const int32* bias = nullptr;
+  const float* scales = nullptr;
+  int offset_c = 0;
+  int ldc = 0;
+};
+
+#if defined(TF_X86_QGEMM_KERNELS)
+
+// The kernels compute the product in tiles of kTileRows x kTileCols entries.
+// A tile is 2 x 2 AMX accumulator tiles of kAmxRows x kBlockCols entries, or
+// rows of two 16-lane AVX512 accumulators.
+constexpr int kTileRows = 32;
+constexpr int kTileCols = 32;
+constexpr int kBlockCols = 16;
+constexpr int kAmxRows = 16;
+// AMX tiles hold 64 bytes per row, i.e. that many entries of the inner
+// dimension.  The VNNI instructions consume four at a time.
+constexpr int kAmxDepthStep = 64;
+constexpr int kVnniDepthStep = 4;
+
+int RoundUp(int value, int multiple) {
+  return (value + multiple - 1) / multiple * multiple;
+}
+
+// The operands repacked for the kernels, and the terms that account for the
+// operand offsets.
+//
+// The instructions multiply unsigned by signed bytes, so b is stored as
+// int8(b - 128).  The sum of the products then is
+//   sum((a - offset_a) * (b - offset_b))
+//     = sum(a * (b - 128)) + (128 - offset_b) * sum(a)
+//       - offset_a * sum(b) + k * offset_a * offset_b,
+// where the second term is kept per row and the others per column.
+struct PackedOperands {
+  int m;
+  int n;
+  // The inner dimension padded with zeros to the step of the kernel, which
+  // don't change the sums.
+  int depth;
+  // a_data as `rows` x `depth` row major bytes, with `rows` rounded up to
+  // kTileRows.
+  std::vector<uint8> a;
+  // b_data as blocks of kBlockCols columns, rounded up to kTileCols.  Every
+  // block is stored as `depth / 4` rows that hold four consecutive entries of
+  // the inner dimension for each of its columns.  That is the layout of the
+  // VNNI instructions and of AMX B tiles.
+  std::vector<int8> b;
+  std::vector<int32> row_terms;
+  std::vector<int32> column_terms;
+
+  const uint8* a_row(int i) const { return a.data() + int64{i} * depth; }
+  const int8* b_block(int block) const {
+    return b.data() + int64{block} * depth * kBlockCols;
+  }
+};
+
+void PackOperands(const DeviceBase::CpuWorkerThreads& worker_threads,
+                  bool transpose_a, bool transpose_b, const quint8* a_data,
+                  const quint8* b_data, int m, int n, int k, int offset_a,
+                  int offset_b, int lda, int ldb, int depth_step,
+                  PackedOperands* packed) {
+  packed->m = m;
+  packed->n = n;
+  packed->depth = RoundUp(k, depth_step);
+  const int depth = packed->depth;
+  const int rows = RoundUp(m, kTileRows);
+  const int cols = RoundUp(n, kTileCols);
+  packed->a.assign(int64{rows} * depth, 0);
+  packed->b.assign(int64{cols} * depth, 0);
+  packed->row_terms.assign(rows, 0);
+  packed->column_terms.assign(cols, 0);
+
+  const int64 a_row_stride = transpose_a ? 1 : lda;
+  const int64 a_depth_stride = transpose_a ? lda : 1;
+  auto pack_a = [&](int64 begin, int64 end) {
+    for (int64 i = begin; i < end; ++i) {
+      uint8* row = packed->a.data() + i * depth;
+      int32 sum = 0;
+      for (int l = 0; l < k; ++l) {
+        const uint8 value = a_data[i * a_row_stride + l * a_depth_stride].value;
+        row[l] = value;
+        sum += value;
+      }
+      packed->row_terms[i] = (128 - offset_b) * sum;
+    }
+  };
+  Shard(worker_threads.num_threads, worker_threads.workers, m, 2 * k, pack_a);
+
+  const int64 b_col_stride = transpose_b ? ldb : 1;
+  const int64 b_depth_stride = transpose_b ? 1 : ldb;
+  auto pack_b = [&](int64 begin, int64 end) {
+    for (int64 block = begin; block < end; ++block) {
+      int8* packed_block = packed->b.data() + block * depth * kBlockCols;
+      const int64 col_begin = block * kBlockCols;
+      const int64 col_end = std::min<int64>(n, col_begin + kBlockCols);
+      for (int64 j = col_begin; j < col_end; ++j) {
+        int8* packed_col = packed_block + (j - col_begin) * kVnniDepthStep;
+        int32 sum = 0;
+        for (int l = 0; l < k; ++l) {
+          const uint8 value =
+              b_data[j * b_col_stride + l * b_depth_stride].value;
+          packed_col[(l / kVnniDepthStep) * kBlockCols * kVnniDepthStep +
+                     l % kVnniDepthStep] = static_cast<int8>(value ^ 0x80);
+          sum += value;
+        }
+        packed->column_terms[j] = k * offset_a * offset_b - offset_a * sum;
+      }
+    }
+  };
+  Shard(worker_threads.num_threads, worker_threads.workers,
+        cols / kBlockCols, 2 * k * kBlockCols, pack_b);
+}
+
+#define TF_X86_QGEMM_VNNI \
+  __attribute__((target("avx512f,avx512bw,avx512vl,avx512vnni")))
+#define TF_X86_QGEMM_AMX                                                 \
+  __attribute__((target("avx512f,avx512bw,avx512vl,avx512vnni,amx-tile," \
+                        "amx-int8")))
+
+// Adds the offset terms to the sums of row i and the kBlockCols columns from
+// j, and writes the valid ones.
+TF_X86_QGEMM_VNNI inline void StoreBlock(const PackedOperands& packed,
+                                         const Output& output, int i, int j,
+                                         __m512i sums) {
+  const int valid_cols = std::min(kBlockCols, packed.n - j);
+  if (valid_cols <= 0) return;
+  const __mmask16 mask = static_cast<__mmask16>((1u << valid_cols) - 1);
+  sums = _mm512_add_epi32(sums, _mm512_set1_epi32(packed.row_terms[i]));
+  sums = _mm512_add_epi32(
+      sums, _mm512_loadu_si512(packed.column_terms.data() + j));
+  const int64 offset = int64{i} * output.ldc + j;
+  if (output.c32 != nullptr) {
+    _mm512_mask_storeu_epi32(&output.c32[offset].value, mask, sums);
+    return;
+  }
+  if (output.bias != nullptr) {
+    sums = _mm512_add_epi32(sums,
+                            _mm512_maskz_loadu_epi32(mask, output.bias + j));
+  }
+  const __m512 scaled = _mm512_mul_ps(_mm512_cvtepi32_ps(sums),
+                                      _mm512_maskz_loadu_ps(mask,
+                                                            output.scales + j));
+  __m512i values = _mm512_add_epi32(
+      _mm512_cvt_roundps_epi32(scaled,
+                               _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC),
+      _mm512_set1_epi32(output.offset_c));
+  values = _mm512_max_epi32(values, _mm512_setzero_si512());
+  values = _mm512_min_epi32(values, _mm512_set1_epi32(255));
+  _mm_mask_storeu_epi8(&output.c8[offset].value, mask,
+                       _mm512_cvtepi32_epi8(values));
+}
+
+// Computes the tile at (row, col) with AVX512-VNNI, four rows at a time.
+TF_X86_QGEMM_VNNI void VnniTile(const PackedOperands& packed,
+                                const Output& output, int row, int col) {
+  constexpr int kRowStep = 4;
+  const int8* b0 = packed.b_block(col / kBlockCols);
+  const int8* b1 = packed.b_block(col / kBlockCols + 1);
+  for (int i0 = row; i0 < std::min(row + kTileRows, packed.m);
+       i0 += kRowStep) {
+    __m512i sums[kRowStep][2];
+    const uint8* a[kRowStep];
+    for (int r = 0; r < kRowStep; ++r) {
+      sums[r][0] = _mm512_setzero_si512();
+      sums[r][1] = _mm512_setzero_si512();
+      a[r] = packed.a_row(i0 + r);
+    }
+    for (int l = 0; l < packed.depth; l += kVnniDepthStep) {
+      const __m512i b0_values = _mm512_loadu_si512(b0 + l * kBlockCols);
+      const __m512i b1_values = _mm512_loadu_si512(b1 + l * kBlockCols);
+      for (int r = 0; r < kRowStep; ++r) {
+        int32 a_values;
+        std::memcpy(&a_values, a[r] + l, sizeof(a_values));
+        const __m512i a_broadcast = _mm512_set1_epi32(a_values);
+        sums[r][0] = _mm512_dpbusd_epi32(sums[r][0], a_broadcast, b0_values);
+        sums[r][1] = _mm512_dpbusd_epi32(sums[r][1], a_broadcast, b1_values);
+      }
+    }
+    for (int r = 0; r < kRowStep && i0 + r < packed.m; ++r) {
+      StoreBlock(packed, output, i0 + r, col, sums[r][0]);
+      StoreBlock(packed, output, i0 + r, col + kBlockCols, sums[r][1]);
+    }
+  }
+}
+
+// The AMX tile configuration, see the Intel architecture instruction set
+// extensions programming reference.
+struct AmxTileConfig {
+  uint8 palette_id;
+  uint8 start_row;
+  uint8 reserved[14];
+  uint16 colsb[16];
+  uint8 rows[16];
+};
+static_assert(sizeof(AmxTileConfig) == 64, "AMX tile configuration size");
+
+// Tiles 0 to 3 accumulate the 2 x 2 blocks of a tile, tiles 4 and 5 hold
+// the rows of a and tiles 6 and 7 the column blocks of b.
+TF_X86_QGEMM_AMX void ConfigureAmxTiles() {
+  AmxTileConfig config;
+  std::memset(&config, 0, sizeof(config));
+  config.palette_id = 1;
+  for (int t = 0; t < 8; ++t) {
+    config.colsb[t] = kAmxDepthStep;
+    config.rows[t] = kAmxRows;
+  }
+  _tile_loadconfig(&config);
+}
+
+// Computes the tile at (row, col) with AMX.
+TF_X86_QGEMM_AMX void AmxTile(const PackedOperands& packed,
+                              const Output& output, int row, int col) {
+  const uint8* a0 = packed.a_row(row);
+  const uint8* a1 = packed.a_row(row + kAmxRows);
+  const int8* b0 = packed.b_block(col / kBlockCols);
+  const int8* b1 = packed.b_block(col / kBlockCols + 1);
+  constexpr int kBStride = kBlockCols * kVnniDepthStep;
+  _tile_zero(0);
+  _tile_zero(1);
+  _tile_zero(2);
+  _tile_zero(3);
+  for (int l = 0; l < packed.depth; l += kAmxDepthStep) {
+    _tile_loadd(4, a0 + l, packed.depth);
+    _tile_loadd(5, a1 + l, packed.depth);
+    _tile_loadd(6, b0 + l * kBlockCols, kBStride);
+    _tile_loadd(7, b1 + l * kBlockCols, kBStride);
+    _tile_dpbusd(0, 4, 6);
+    _tile_dpbusd(1, 4, 7);
+    _tile_dpbusd(2, 5, 6);
+    _tile_dpbusd(3, 5, 7);
+  }
+  int32 sums[kTileRows][kTileCols];
+  constexpr int kSumsStride = kTileCols * sizeof(int32);
+  _tile_stored(0, &sums[0][0], kSumsStride);
+  _tile_stored(1, &sums[0][kBlockCols], kSumsStride);
+  _tile_stored(2, &sums[kAmxRows][0], kSumsStride);
+  _tile_stored(3, &sums[kAmxRows][kBlockCols], kSumsStride);
+  for (int r = 0; r < kTileRows && row + r < packed.m; ++r) {
+    StoreBlock(packed, output, row + r, col, _mm512_loadu_si512(sums[r]));
+    StoreBlock(packed, output, row + r, col + kBlockCols,
+               _mm512_loadu_si512(sums[r] + kBlockCols));
+  }
+}
+
+TF_X86_QGEMM_AMX void AmxTiles(const PackedOperands& packed,
+                               const Output& output, int tile_cols,
+                               int64 begin, int64 end) {
+  ConfigureAmxTiles();
+  for (int64 t = begin; t < end; ++t) {
+    AmxTile(packed, output, (t / tile_cols) * kTileRows,
+            (t % tile_cols) * kTileCols);
+  }
+  _tile_release();
+}
+
+#endif  // TF_X86_QGEMM_KERNELS
+
+void Gemm(OpKernelContext* context, bool transpose_a, bool transpose_b,
+          const quint8* a_data, const quint8* b_data, int m, int n, int k,
+          int offset_a, int offset_b, int lda, int ldb,
+          const Output& output) {
+  const Isa isa = GetIsa();
+  CHECK(isa != Isa::kNone)
+      << "Quantized x86 GEMM called on a CPU that doesn't support it.";
+  if (m == 0 || n == 0) return;
+#if defined(TF_X86_QGEMM_KERNELS)
+  const auto& worker_threads =
+      *(context->device()->tensorflow_cpu_worker_threads());
+  PackedOperands packed;
+  PackOperands(worker_threads, transpose_a, transpose_b, a_data, b_data, m, n,
+               k, offset_a, offset_b, lda, ldb,
+               isa == Isa::kAmx ? kAmxDepthStep : kVnniDepthStep, &packed);
+
+  const int tile_rows = RoundUp(m, kTileRows) / kTileRows;
+  const int tile_cols = RoundUp(n, kTileCols) / kTileCols;
+  const int64 cost_per_tile = int64{kTileRows} * kTileCols * packed.depth / 16;
+  auto compute_tiles = [&](int64 begin, int64 end) {
+    if (isa == Isa::kAmx) {
+      AmxTiles(packed, output, tile_cols, begin, end);
+      return;
+    }
+    for (int64 t = begin; t < end; ++t) {
+      VnniTile(packed, output, (t / tile_cols) * kTileRows,
+               (t % tile_cols) * kTileCols);
+    }
+  };
+  Shard(worker_threads.num_threads, worker_threads.workers,
+        int64{tile_rows} * tile_cols, cost_per_tile, compute_tiles);
+#endif  // TF_X86_QGEMM_KERNELS
+}
+
+}  // namespace
+
+Isa GetIsa() { return std::min(GetSupportedIsa(), max_isa.load()); }
+
+void SetIsa(Isa isa) { max_isa.store(isa); }
+
+void QuantizedGemm(OpKernelContext* context, bool transpose_a, bool transpose_b,
+                   const quint8* a_data, const quint8* b_data, qint32* c_data,
+                   int m, int n, int k, int offset_a, int offset_b, int lda,
+                   int ldb, int ldc) {
+  Output output;
+  output.c32 = c_data;
+  output.ldc = ldc;
+  Gemm(context, transpose_a, transpose_b, a_data, b_data, m, n, k, offset_a,
+       offset_b, lda, ldb, output);
+}
+
+void QuantizedGemmRequantized(OpKernelContext* context, bool transpose_a,
+                              bool transpose_b, const quint8* a_data,
+                              const quint8* b_data, const int32* bias,
+                              const float* scales, int offset_c,
+                              quint8* c_data, int m, int n, int k,
+                              int offset_a, int offset_b, int lda, int ldb,
+                              int ldc) {
+  Output output;
+  output.c8 = c_data;
+  output.bias = bias;
+  output.scales = scales;
+  output.offset_c = offset_c;
+  output.ldc = ldc;
+  Gemm(context, transpose_a, transpose_b, a_data, b_data, m, n, k, offset_a,
+       offset_b, lda, ldb, output);
+}
+
+}  // namespace x86_qgemm
+}  // namespace tensorflow
@@ -0,0 +1,87 @@
+/* Copyright 2022 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_CORE_KERNELS_QUANTIZED_GEMM_X86_H_
+#define TENSORFLOW_CORE_KERNELS_QUANTIZED_GEMM_X86_H_
+
+#include "tensorflow/core/framework/numeric_types.h"
+#include "tensorflow/core/platform/types.h"
+
+namespace tensorflow {
+
+class OpKernelContext;
+
+namespace x86_qgemm {
+
+// Eight-bit matrix multiplication kernels for x86 CPUs with AVX512-VNNI or
+// AMX, used by the quantized kernels when gemmlowp/meta and oneDNN are not
+// available.  The kernels are compiled for these instruction sets regardless
+// of the build flags, and are picked at runtime from the features that
+// port::TestCPUFeature reports.
+
+// The instruction sets the kernels can run on, from slowest to fastest.
+enum class Isa {
+  kNone,        // No x86 kernel can run on this CPU.
+  kAvx512Vnni,  // AVX512F, AVX512BW, AVX512VL and AVX512_VNNI.
+  kAmx,         // AMX_TILE and AMX_INT8, in addition to kAvx512Vnni.
+};
+
+// Returns the instruction set the kernels run on.  That is the fastest one
+// the CPU and, for AMX, the operating system support, unless SetIsa lowered
+// it.
+Isa GetIsa();
+
+// Limits the kernels to `isa`, or to the fastest supported instruction set if
+// that is slower.  Meant for tests and benchmarks.
+void SetIsa(Isa isa);
+
+// Returns true if the compute functions below can be called.
+inline bool IsSupported() { return GetIsa() != Isa::kNone; }
+
+// Calculates the quantized matrix multiplication:
+//
+// for (i, j) in [0, m) x [0, n) do
+//   c_data[i, j] :=
+//     sum((a_data[i, l] - offset_a) * (b_data[l, j] - offset_b)) : l in [0, k)
+//
+// If transpose_a is false the lhs operand has row major layout, otherwise
+// column major. Similarly transpose_b describes the layout of the rhs operand.
+// lda, ldb, and ldc are the strides of the lhs operand, rhs operand and the
+// result arrays.  The result is row major.
+void QuantizedGemm(OpKernelContext* context, bool transpose_a, bool transpose_b,
+                   const quint8* a_data, const quint8* b_data, qint32* c_data,
+                   int m, int n, int k, int offset_a, int offset_b, int lda,
+                   int ldb, int ldc);
+
+// Like QuantizedGemm, but requantizes the int32 sums to eight bits with
+// per-column (i.e. per-channel) parameters before they are written:
+//
+//   c_data[i, j] :=
+//     clamp(round((sum + bias[j]) * scales[j]) + offset_c, 0, 255)
+//
+// `bias` may be null.  Values are rounded to the nearest integer, with ties
+// to even.
+void QuantizedGemmRequantized(OpKernelContext* context, bool transpose_a,
+                              bool transpose_b, const quint8* a_data,
+                              const quint8* b_data, const int32* bias,
+                              const float* scales, int offset_c,
+                              quint8* c_data, int m, int n, int k,
+                              int offset_a, int offset_b, int lda, int ldb,
+                              int ldc);
+
+}  // namespace x86_qgemm
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_KERNELS_QUANTIZED_GEMM_X86_H_
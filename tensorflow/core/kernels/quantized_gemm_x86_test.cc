@@ -0,0 +1,156 @@
+/* Copyright 2022 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/kernels/quantized_gemm_x86.h"
+
+#include <algorithm>
+#include <cmath>
+#include <memory>
+#include <random>
+#include <vector>
+
+#include "tensorflow/core/common_runtime/device.h"
+#include "tensorflow/core/common_runtime/device_factory.h"
+#include "tensorflow/core/framework/op_kernel.h"
+#include "tensorflow/core/kernels/reference_gemm.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace x86_qgemm {
+namespace {
+
+class QuantizedGemmX86Test : public ::testing::TestWithParam<Isa> {
+ protected:
+  void SetUp() override {
+    SetIsa(GetParam());
+    if (GetIsa() != GetParam()) {
+      SetIsa(Isa::kAmx);
+      GTEST_SKIP() << "The CPU doesn't support the instruction set.";
+    }
+    device_ = DeviceFactory::NewDevice("CPU", {}, "/job:a/replica:0/task:0");
+    params_.device = device_.get();
+    context_ = std::make_unique<OpKernelContext>(&params_);
+  }
+
+  void TearDown() override { SetIsa(Isa::kAmx); }
+
+  std::unique_ptr<Device> device_;
+  OpKernelContext::Params params_;
+  std::unique_ptr<OpKernelContext> context_;
+};
+
+struct Operands {
+  Operands(std::mt19937* rng, int m, int n, int k, bool transpose_a,
+           bool transpose_b)
+      : lda((transpose_a ? m : k) + 3),
+        ldb((transpose_b ? k : n) + 1),
+        a((transpose_a ? k : m) * lda),
+        b((transpose_b ? n : k) * ldb) {
+    for (quint8& value : a) value = static_cast<uint8>((*rng)());
+    for (quint8& value : b) value = static_cast<uint8>((*rng)());
+  }
+
+  int lda;
+  int ldb;
+  std::vector<quint8> a;
+  std::vector<quint8> b;
+};
+
+TEST_P(QuantizedGemmX86Test, MatchesReferenceGemm) {
+  std::mt19937 rng(42);
+  // Edge cases of the tile and depth sizes, and a few random shapes.
+  std::vector<std::vector<int>> shapes = {
+      {1, 1, 1}, {32, 32, 64}, {33, 31, 65}, {7, 100, 3}, {64, 16, 1000}};
+  for (int i = 0; i < 20; ++i) {
+    shapes.push_back({1 + static_cast<int>(rng() % 80),
+                      1 + static_cast<int>(rng() % 80),
+                      1 + static_cast<int>(rng() % 300)});
+  }
+  for (const auto& shape : shapes) {
+    const int m = shape[0];
+    const int n = shape[1];
+    const int k = shape[2];
+    for (int transpose = 0; transpose < 4; ++transpose) {
+      const bool transpose_a = transpose & 1;
+      const bool transpose_b = transpose & 2;
+      Operands operands(&rng, m, n, k, transpose_a, transpose_b);
+      const int offset_a = rng() % 256;
+      const int offset_b = rng() % 256;
+      const int ldc = n + 2;
+      std::vector<qint32> expected(m * ldc);
+      ReferenceGemm<quint8, quint8, qint32>(
+          transpose_a, transpose_b, false, m, n, k, operands.a.data(),
+          offset_a, operands.lda, operands.b.data(), offset_b, operands.ldb,
+          expected.data(), 0, 0, 1, ldc);
+      std::vector<qint32> actual(m * ldc);
+      QuantizedGemm(context_.get(), transpose_a, transpose_b,
+                    operands.a.data(), operands.b.data(), actual.data(), m, n,
+                    k, offset_a, offset_b, operands.lda, operands.ldb, ldc);
+      for (int i = 0; i < m; ++i) {
+        for (int j = 0; j < n; ++j) {
+          ASSERT_EQ(expected[i * ldc + j].value, actual[i * ldc + j].value)
+              << "m=" << m << " n=" << n << " k=" << k << " transpose_a="
+              << transpose_a << " transpose_b=" << transpose_b << " at (" << i
+              << ", " << j << ")";
+        }
+      }
+    }
+  }
+}
+
+TEST_P(QuantizedGemmX86Test, Requantized) {
+  std::mt19937 rng(7);
+  const int m = 45;
+  const int n = 70;
+  const int k = 130;
+  const int offset_a = 3;
+  const int offset_b = 200;
+  const int offset_c = 11;
+  Operands operands(&rng, m, n, k, /*transpose_a=*/false,
+                    /*transpose_b=*/true);
+  std::vector<qint32> sums(m * n);
+  ReferenceGemm<quint8, quint8, qint32>(
+      false, true, false, m, n, k, operands.a.data(), offset_a, operands.lda,
+      operands.b.data(), offset_b, operands.ldb, sums.data(), 0, 0, 1, n);
+  std::vector<int32> bias(n);
+  std::vector<float> scales(n);
+  for (int j = 0; j < n; ++j) {
+    bias[j] = static_cast<int>(rng() % 20001) - 10000;
+    scales[j] = 1e-5f * (1 + rng() % 100);
+  }
+
+  std::vector<quint8> actual(m * n);
+  QuantizedGemmRequantized(context_.get(), false, true, operands.a.data(),
+                           operands.b.data(), bias.data(), scales.data(),
+                           offset_c, actual.data(), m, n, k, offset_a,
+                           offset_b, operands.lda, operands.ldb, n);
+  for (int i = 0; i < m; ++i) {
+    for (int j = 0; j < n; ++j) {
+      const float scaled =
+          static_cast<float>(sums[i * n + j].value + bias[j]) * scales[j];
+      const int expected = std::min(
+          255, std::max(0, static_cast<int>(std::nearbyint(scaled)) +
+                               offset_c));
+      ASSERT_EQ(expected, actual[i * n + j].value) << i << ", " << j;
+    }
+  }
+}
+
+INSTANTIATE_TEST_SUITE_P(Isas, QuantizedGemmX86Test,
+                         ::testing::Values(Isa::kAvx512Vnni, Isa::kAmx));
+
+}  // namespace
+}  // namespace x86_qgemm
+}  // namespace tensorflow
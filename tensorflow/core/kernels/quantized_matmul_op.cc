@@ -23,6 +23,7 @@ limitations under the License.
 #include "tensorflow/core/framework/tensor.h"
 #include "tensorflow/core/kernels/meta_support.h"
 #include "tensorflow/core/kernels/quantization_utils.h"
+#include "tensorflow/core/kernels/quantized_gemm_x86.h"
 #include "tensorflow/core/kernels/reference_gemm.h"
 #include "tensorflow/core/lib/core/errors.h"
 
@@ -140,6 +141,15 @@ class QuantizedMatMulOp : public OpKernel {
       // allows optimized quantized 8bit to 32bit gemm.
       meta::QuantizedGemm(context, transpose_a_, transpose_b_, a_data, b_data,
                           c_data, m, n, k, -offset_a, -offset_b, lda, ldb, ldc);
+    } else if (x86_qgemm::IsSupported() && std::is_same<T1, quint8>() &&
+               std::is_same<T2, quint8>() && std::is_same<Toutput, qint32>() &&
+               (offset_c == 0) && (mult_c == 1) && (shift_c == 0) &&
+               (transpose_c == false)) {
+      // Native eight-bit kernels for x86 CPUs with AVX512-VNNI or AMX, which
+      // pick the instruction set at runtime.
+      x86_qgemm::QuantizedGemm(context, transpose_a_, transpose_b_, a_data,
+                               b_data, c_data, m, n, k, offset_a, offset_b,
+                               lda, ldb, ldc);
     } else if (std::is_same<T1, quint8>() && std::is_same<T2, quint8>() &&
                std::is_same<Toutput, qint32>() && (offset_c == 0) &&
                (mult_c == 1) && (shift_c == 0) && (transpose_c == false)) {
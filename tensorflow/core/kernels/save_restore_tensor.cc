@@ -250,6 +250,10 @@ namespace {
 // Tensors larger than this threshold will be restored from a thread-pool.
 const int64_t kLargeShapeThreshold = 16 << 20;  // 16M
 
+// The number of threads that read full tensors when they add up to more than
+// kLargeShapeThreshold elements.
+const int kNumFullTensorReaderThreads = 16;
+
 // A restore operation for a single tensor.  Small tensors may be restored
 // directly from the op thread to improve read locality.  Large tensors can be
 // restored from a thread pool: this requires creating a separate BundleReader
@@ -364,7 +368,8 @@ struct RestoreOp {
 Status RestoreTensorsV2(OpKernelContext* context, const Tensor& prefix,
                         const Tensor& tensor_names,
                         const Tensor& shape_and_slices,
-                        gtl::ArraySlice<DataType> dtypes) {
+                        gtl::ArraySlice<DataType> dtypes, bool use_mmap,
+                        int64_t lazy_mmap_min_bytes) {
   const string& prefix_string = prefix.scalar<tstring>()();
 
   const auto& tensor_names_flat = tensor_names.flat<tstring>();
@@ -377,7 +382,10 @@ Status RestoreTensorsV2(OpKernelContext* context, const Tensor& prefix,
                            shape_and_slices_flat(i), prefix_string, dtypes[i]});
   }
 
-  BundleReader default_reader(Env::Default(), prefix_string);
+  BundleReader::Options reader_options;
+  reader_options.use_mmap = use_mmap;
+  reader_options.lazy_mmap_min_bytes = lazy_mmap_min_bytes;
+  BundleReader default_reader(Env::Default(), prefix_string, reader_options);
   TF_RETURN_IF_ERROR(default_reader.status());
 
   TF_RETURN_IF_ERROR(default_reader.SortForSequentialAccess<RestoreOp>(
@@ -402,10 +410,33 @@ Status RestoreTensorsV2(OpKernelContext* context, const Tensor& prefix,
     return errors::InvalidArgument(error_msg);
   }
 
+  // Full tensors are read together by BundleReader::LookupMany, which issues
+  // their reads in file order from a thread pool.  Slices are restored one
+  // at a time, as they may need to be assembled from several saved slices.
+  std::vector<StringPiece> full_tensor_names;
+  std::vector<Tensor*> full_tensors;
+  int64_t num_full_tensor_elements = 0;
   std::vector<RestoreOp*> pool_restore_ops;
   std::vector<RestoreOp*> direct_restore_ops;
   for (RestoreOp& restore_op : restore_ops) {
-    if (restore_op.should_run_in_pool(&default_reader)) {
+    if (restore_op.shape_and_slice.empty() && use_mmap) {
+      // The reader replaces the buffer of the looked up tensor with the
+      // mapped data, so there is no output to allocate.
+      Tensor restored_tensor;
+      TF_RETURN_IF_ERROR(
+          default_reader.Lookup(restore_op.tensor_name, &restored_tensor));
+      context->set_output(restore_op.idx, restored_tensor);
+    } else if (restore_op.shape_and_slice.empty()) {
+      TensorShape restored_full_shape;
+      TF_RETURN_IF_ERROR(default_reader.LookupTensorShape(
+          restore_op.tensor_name, &restored_full_shape));
+      Tensor* restored_tensor;
+      TF_RETURN_IF_ERROR(context->allocate_output(
+          restore_op.idx, restored_full_shape, &restored_tensor));
+      full_tensor_names.push_back(restore_op.tensor_name);
+      full_tensors.push_back(restored_tensor);
+      num_full_tensor_elements += restored_full_shape.num_elements();
+    } else if (restore_op.should_run_in_pool(&default_reader)) {
       pool_restore_ops.push_back(&restore_op);
     } else {
       direct_restore_ops.push_back(&restore_op);
@@ -424,6 +455,19 @@ Status RestoreTensorsV2(OpKernelContext* context, const Tensor& prefix,
       }
     }
 
+    if (!full_tensors.empty()) {
+      VLOG(1) << "Restoring " << full_tensors.size() << " full tensors : "
+              << num_full_tensor_elements;
+      std::unique_ptr<thread::ThreadPool> full_tensor_reader_pool;
+      if (num_full_tensor_elements > kLargeShapeThreshold) {
+        full_tensor_reader_pool.reset(
+            new thread::ThreadPool(Env::Default(), "restore_full_tensors",
+                                   kNumFullTensorReaderThreads));
+      }
+      TF_RETURN_IF_ERROR(default_reader.LookupMany(
+          full_tensor_names, full_tensors, full_tensor_reader_pool.get()));
+    }
+
     // Read small tensors from the op thread
     for (auto* op : direct_restore_ops) {
       TF_RETURN_IF_ERROR(op->run(&default_reader));
@@ -16,6 +16,8 @@ limitations under the License.
 #ifndef TENSORFLOW_CORE_KERNELS_SAVE_RESTORE_TENSOR_H_
 #define TENSORFLOW_CORE_KERNELS_SAVE_RESTORE_TENSOR_H_
 
+#include <limits>
+
 #include "tensorflow/core/util/tensor_slice_reader.h"
 #include "tensorflow/core/util/tensor_slice_writer.h"
 
@@ -59,6 +61,13 @@ void RestoreTensor(OpKernelContext* context,
 //
 // "context" is only used for allocating outputs.  In particular, the inputs are
 // explicitly provided and not accessed via the "input(i)" methods.
+//
+// If "use_mmap" is true, full tensors are restored with
+// BundleReader::Options::use_mmap, i.e. the outputs of those whose data is
+// suitably aligned are read-only views of the mapped data files rather than
+// copies.  Mapped tensors of at least "lazy_mmap_min_bytes" bytes are not
+// checksummed, so that they are only read from the data files on first
+// access; see BundleReader::Options::lazy_mmap_min_bytes.
 // REQUIRES:
 //   * "prefix" has 1 element, DT_STRING.
 //   * "tensor_names" and "shape_and_slices" shaped {N}, both DT_STRING.
@@ -66,7 +75,10 @@ void RestoreTensor(OpKernelContext* context,
 Status RestoreTensorsV2(OpKernelContext* context, const Tensor& prefix,
                         const Tensor& tensor_names,
                         const Tensor& shape_and_slices,
-                        gtl::ArraySlice<DataType> dtypes);
+                        gtl::ArraySlice<DataType> dtypes,
+                        bool use_mmap = false,
+                        int64_t lazy_mmap_min_bytes =
+                            std::numeric_limits<int64_t>::max());
 
 }  // namespace tensorflow
 
@@ -15,25 +15,32 @@ limitations under the License.
 
 // See docs in ../ops/io_ops.cc.
 
+#include <limits>
 #include <string>
 #include <vector>
 
+#include "absl/container/flat_hash_map.h"
 #include "tensorflow/core/framework/bounds_check.h"
 #include "tensorflow/core/framework/op_kernel.h"
 #include "tensorflow/core/framework/resource_mgr.h"
 #include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_util.h"
 #include "tensorflow/core/framework/types.h"
 #include "tensorflow/core/framework/types.pb.h"
 #include "tensorflow/core/kernels/checkpoint_callback_manager.h"
 #include "tensorflow/core/kernels/save_restore_tensor.h"
 #include "tensorflow/core/lib/core/status.h"
+#include "tensorflow/core/lib/core/threadpool.h"
 #include "tensorflow/core/lib/io/path.h"
 #include "tensorflow/core/platform/env.h"
 #include "tensorflow/core/platform/logging.h"
+#include "tensorflow/core/platform/mutex.h"
 #include "tensorflow/core/platform/types.h"
+#include "tensorflow/core/util/env_var.h"
 #include "tensorflow/core/util/saved_tensor_slice_util.h"
 #include "tensorflow/core/util/tensor_bundle/tensor_bundle.h"
 #include "tensorflow/core/util/tensor_slice_reader.h"
+#include "tensorflow/core/util/work_sharder.h"
 
 namespace tensorflow {
 
@@ -87,12 +94,159 @@ void ValidateInputs(bool is_save_op, OpKernelContext* context,
   }
 }
 
+// Writes "tensors" to the tensor bundle "prefix".  "shape_and_slices" holds
+// the shape and slice spec of each tensor, or an empty string for a full
+// tensor.
+Status WriteBundle(const string& prefix, const std::vector<string>& names,
+                   const std::vector<string>& shape_and_slices,
+                   const std::vector<Tensor>& tensors,
+                   const BundleWriter::Options& options) {
+  BundleWriter writer(Env::Default(), prefix, options);
+  TF_RETURN_IF_ERROR(writer.status());
+  VLOG(1) << "BundleWriter, prefix_string: " << prefix;
+
+  for (size_t i = 0; i < names.size(); ++i) {
+    const string& tensor_name = names[i];
+    const Tensor& tensor = tensors[i];
+    VLOG(2) << "Starting save of " << tensor_name;
+
+    if (!shape_and_slices[i].empty()) {
+      const string& shape_spec = shape_and_slices[i];
+      TensorShape shape;
+      TensorSlice slice(tensor.dims());
+      TensorShape slice_shape;
+
+      TF_RETURN_IF_ERROR(checkpoint::ParseShapeAndSlice(shape_spec, &shape,
+                                                        &slice, &slice_shape));
+      if (!slice_shape.IsSameSize(tensor.shape())) {
+        return errors::InvalidArgument(
+            "Slice in shape_and_slice specification does not match the shape "
+            "of the tensor to  save: ",
+            shape_spec, ", tensor: ", tensor.shape().DebugString());
+      }
+
+      TF_RETURN_IF_ERROR(writer.AddSlice(tensor_name, shape, slice, tensor));
+    } else {
+      TF_RETURN_IF_ERROR(writer.Add(tensor_name, tensor));
+    }
+
+    if (VLOG_IS_ON(5)) {
+      if (tensor.dtype() == DT_FLOAT) {
+        const float* t_data = tensor.flat<float>().data();
+        float min = std::numeric_limits<float>::infinity();
+        float max = -std::numeric_limits<float>::infinity();
+        double avg = 0.0;
+        for (int i = 0; i < tensor.NumElements(); ++i) {
+          if (t_data[i] < min) min = t_data[i];
+          if (t_data[i] > max) max = t_data[i];
+          avg += t_data[i];
+        }
+        VLOG(5) << " min " << min << " max " << max << " avg "
+                << avg / tensor.NumElements() << " total elts "
+                << tensor.NumElements();
+      }
+    }
+
+    VLOG(2) << "Done save of " << tensor_name;
+  }
+  TF_RETURN_IF_ERROR(writer.Finish());
+  VLOG(1) << "Done BundleWriter, prefix_string: " << prefix;
+  return OkStatus();
+}
+
+// The bundles that SaveV2 writes in the background.  MergeV2Checkpoints and
+// RestoreV2 wait for the writes of their input bundles to finish, and pick up
+// their errors.
+class PendingBundleWrites {
+ public:
+  static PendingBundleWrites* Global() {
+    static PendingBundleWrites* pending = new PendingBundleWrites;
+    return pending;
+  }
+
+  void Start(const string& prefix) {
+    mutex_lock l(mu_);
+    ++num_pending_[prefix];
+  }
+
+  void Finish(const string& prefix, const Status& status) {
+    mutex_lock l(mu_);
+    if (!status.ok()) errors_[prefix].Update(status);
+    if (--num_pending_[prefix] == 0) {
+      num_pending_.erase(prefix);
+      cv_.notify_all();
+    }
+  }
+
+  // Waits until no write of "prefix" is pending, and returns the first error
+  // of the writes since the last call.
+  Status Wait(const string& prefix) {
+    mutex_lock l(mu_);
+    while (num_pending_.contains(prefix)) cv_.wait(l);
+    auto it = errors_.find(prefix);
+    if (it == errors_.end()) return OkStatus();
+    Status status = it->second;
+    errors_.erase(it);
+    return status;
+  }
+
+ private:
+  mutex mu_;
+  condition_variable cv_;
+  absl::flat_hash_map<string, int> num_pending_ TF_GUARDED_BY(mu_);
+  absl::flat_hash_map<string, Status> errors_ TF_GUARDED_BY(mu_);
+};
+
+// Threads that write the bundles of asynchronous saves.
+thread::ThreadPool* AsyncSaveThreadPool() {
+  static thread::ThreadPool* pool =
+      new thread::ThreadPool(Env::Default(), "async_checkpoint_save", 4);
+  return pool;
+}
+
+// The number of snapshots a SaveV2 kernel holds while their bundles are
+// written.  A save that would exceed it waits for the oldest write.
+const int kMaxPendingAsyncSaves = 2;
+
+// The bytes of a snapshot that one worker thread copies at a time.
+const int64_t kSnapshotBlockBytes = 1 << 20;
+
 }  // namespace
 
 // Saves a list of named tensors using the tensor bundle library.
+//
+// The environment variable TF_CHECKPOINT_DATA_ALIGNMENT sets
+// BundleWriter::Options::data_alignment, e.g. to EIGEN_MAX_ALIGN_BYTES for
+// checkpoints that RestoreV2 memory-maps.
+//
+// If the environment variable TF_ASYNC_CHECKPOINT_SAVE is true, the op only
+// copies its inputs to host buffers, so that the variables can be updated
+// again right away, and writes the bundle from a background thread.  Each
+// kernel keeps at most kMaxPendingAsyncSaves such snapshots.  The bundle is
+// complete once MergeV2Checkpoints or RestoreV2 read it, which wait for the
+// write and report its errors.  Errors are also reported by the next run of
+// the kernel.
 class SaveV2 : public OpKernel {
  public:
-  explicit SaveV2(OpKernelConstruction* context) : OpKernel(context) {}
+  explicit SaveV2(OpKernelConstruction* context) : OpKernel(context) {
+    OP_REQUIRES_OK(context, ReadBoolFromEnvVar("TF_ASYNC_CHECKPOINT_SAVE",
+                                               false, &async_save_));
+    int64_t data_alignment;
+    OP_REQUIRES_OK(context,
+                   ReadInt64FromEnvVar("TF_CHECKPOINT_DATA_ALIGNMENT",
+                                       writer_options_.data_alignment,
+                                       &data_alignment));
+    OP_REQUIRES(context, data_alignment > 0,
+                errors::InvalidArgument(
+                    "TF_CHECKPOINT_DATA_ALIGNMENT must be positive, got ",
+                    data_alignment));
+    writer_options_.data_alignment = data_alignment;
+  }
+
+  ~SaveV2() override {
+    mutex_lock l(mu_);
+    while (num_pending_saves_ > 0) cv_.wait(l);
+  }
 
   void Compute(OpKernelContext* context) override {
     const Tensor& prefix = context->input(0);
@@ -108,57 +262,25 @@ class SaveV2 : public OpKernel {
     const auto& tensor_names_flat = tensor_names.flat<tstring>();
     const auto& shape_and_slices_flat = shape_and_slices.flat<tstring>();
 
-    BundleWriter writer(Env::Default(), prefix_string);
-    OP_REQUIRES_OK(context, writer.status());
-    VLOG(1) << "BundleWriter, prefix_string: " << prefix_string;
-
+    std::vector<string> names(num_tensors);
+    std::vector<string> shape_and_slice_specs(num_tensors);
+    std::vector<Tensor> tensors(num_tensors);
     for (int i = 0; i < num_tensors; ++i) {
-      const string& tensor_name = tensor_names_flat(i);
-      const Tensor& tensor = context->input(i + kFixedInputs);
-      VLOG(2) << "Starting save of " << tensor_name;
-
-      if (!shape_and_slices_flat(i).empty()) {
-        const string& shape_spec = shape_and_slices_flat(i);
-        TensorShape shape;
-        TensorSlice slice(tensor.dims());
-        TensorShape slice_shape;
-
-        OP_REQUIRES_OK(context, checkpoint::ParseShapeAndSlice(
-                                    shape_spec, &shape, &slice, &slice_shape));
-        OP_REQUIRES(context, slice_shape.IsSameSize(tensor.shape()),
-                    errors::InvalidArgument("Slice in shape_and_slice "
-                                            "specification does not match the "
-                                            "shape of the tensor to  save: ",
-                                            shape_spec, ", tensor: ",
-                                            tensor.shape().DebugString()));
-
-        OP_REQUIRES_OK(context,
-                       writer.AddSlice(tensor_name, shape, slice, tensor));
-      } else {
-        OP_REQUIRES_OK(context, writer.Add(tensor_name, tensor));
-      }
-
-      if (VLOG_IS_ON(5)) {
-        if (tensor.dtype() == DT_FLOAT) {
-          const float* t_data = tensor.flat<float>().data();
-          float min = std::numeric_limits<float>::infinity();
-          float max = -std::numeric_limits<float>::infinity();
-          double avg = 0.0;
-          for (int i = 0; i < tensor.NumElements(); ++i) {
-            if (t_data[i] < min) min = t_data[i];
-            if (t_data[i] > max) max = t_data[i];
-            avg += t_data[i];
-          }
-          VLOG(5) << " min " << min << " max " << max << " avg "
-                  << avg / tensor.NumElements() << " total elts "
-                  << tensor.NumElements();
-        }
-      }
+      names[i] = tensor_names_flat(i);
+      shape_and_slice_specs[i] = shape_and_slices_flat(i);
+      tensors[i] = context->input(i + kFixedInputs);
+    }
 
-      VLOG(2) << "Done save of " << tensor_name;
+    if (async_save_) {
+      OP_REQUIRES_OK(context, SnapshotTensors(context, &tensors));
+      OP_REQUIRES_OK(context, StartAsyncSave(prefix_string, std::move(names),
+                                             std::move(shape_and_slice_specs),
+                                             std::move(tensors)));
+    } else {
+      OP_REQUIRES_OK(context,
+                     WriteBundle(prefix_string, names, shape_and_slice_specs,
+                                 tensors, writer_options_));
     }
-    OP_REQUIRES_OK(context, writer.Finish());
-    VLOG(1) << "Done BundleWriter, prefix_string: " << prefix_string;
 
     ResourceMgr* resource_manager = context->resource_manager();
     if (resource_manager != nullptr) {
@@ -179,14 +301,122 @@ class SaveV2 : public OpKernel {
       checkpoint_callback_manager->Unref();
     }
   }
+
+ private:
+  // Replaces "tensors" with copies that the op owns.  The bytes of numeric
+  // tensors are copied block by block on the CPU worker threads.
+  Status SnapshotTensors(OpKernelContext* context,
+                         std::vector<Tensor>* tensors) {
+    struct Block {
+      const char* src;
+      char* dst;
+      int64_t size;
+    };
+    std::vector<Block> blocks;
+    for (Tensor& tensor : *tensors) {
+      if (!DataTypeCanUseMemcpy(tensor.dtype())) {
+        tensor = tensor::DeepCopy(tensor);
+        continue;
+      }
+      Tensor copy;
+      AllocatorAttributes attr;
+      attr.set_on_host(true);
+      TF_RETURN_IF_ERROR(
+          context->allocate_temp(tensor.dtype(), tensor.shape(), &copy, attr));
+      const char* src = tensor.tensor_data().data();
+      char* dst = const_cast<char*>(copy.tensor_data().data());
+      const int64_t size = tensor.TotalBytes();
+      for (int64_t offset = 0; offset < size; offset += kSnapshotBlockBytes) {
+        blocks.push_back({src + offset, dst + offset,
+                          std::min(kSnapshotBlockBytes, size - offset)});
+      }
+      tensor = std::move(copy);
+    }
+    auto worker_threads = context->device()->tensorflow_cpu_worker_threads();
+    Shard(worker_threads->num_threads, worker_threads->workers, blocks.size(),
+          kSnapshotBlockBytes, [&blocks](int64_t begin, int64_t end) {
+            for (int64_t i = begin; i < end; ++i) {
+              memcpy(blocks[i].dst, blocks[i].src, blocks[i].size);
+            }
+          });
+    return OkStatus();
+  }
+
+  // Writes the bundle from a background thread, once fewer than
+  // kMaxPendingAsyncSaves earlier saves of this kernel are in flight.
+  // Returns the first error of the earlier saves, if any.
+  Status StartAsyncSave(const string& prefix, std::vector<string> names,
+                        std::vector<string> shape_and_slices,
+                        std::vector<Tensor> tensors) {
+    {
+      mutex_lock l(mu_);
+      while (num_pending_saves_ >= kMaxPendingAsyncSaves) cv_.wait(l);
+      if (!async_save_status_.ok()) {
+        Status status = async_save_status_;
+        async_save_status_ = OkStatus();
+        return status;
+      }
+      ++num_pending_saves_;
+    }
+    PendingBundleWrites::Global()->Start(prefix);
+    AsyncSaveThreadPool()->Schedule([this, prefix, names = std::move(names),
+                                     shape_and_slices =
+                                         std::move(shape_and_slices),
+                                     tensors = std::move(tensors)]() {
+      const Status status = WriteBundle(prefix, names, shape_and_slices,
+                                        tensors, writer_options_);
+      if (!status.ok()) {
+        LOG(ERROR) << "Asynchronous save of " << prefix
+                   << " failed: " << status;
+      }
+      PendingBundleWrites::Global()->Finish(prefix, status);
+      mutex_lock l(mu_);
+      async_save_status_.Update(status);
+      --num_pending_saves_;
+      cv_.notify_all();
+    });
+    return OkStatus();
+  }
+
+  bool async_save_ = false;
+  BundleWriter::Options writer_options_;
+  mutex mu_;
+  condition_variable cv_;
+  int num_pending_saves_ TF_GUARDED_BY(mu_) = 0;
+  Status async_save_status_ TF_GUARDED_BY(mu_);
 };
 REGISTER_KERNEL_BUILDER(Name("SaveV2").Device(DEVICE_CPU), SaveV2);
 
 // Restores a list of named tensors from a tensor bundle (V2 checkpoint format).
+//
+// If the environment variable TF_CHECKPOINT_RESTORE_USE_MMAP is true, full
+// tensors are restored from memory-mapped data files and their outputs share
+// the mapped pages instead of holding copies, which suits checkpoints that
+// are restored once and then only read, e.g. for serving.  Resource
+// variables copy such values on their first update.  Only entries aligned to
+// EIGEN_MAX_ALIGN_BYTES are mapped, see TF_CHECKPOINT_DATA_ALIGNMENT.
+//
+// If the environment variable TF_CHECKPOINT_RESTORE_LAZY_MIN_BYTES is set,
+// full tensors are restored the same way, and mapped tensors of at least that
+// many bytes are not checksummed.  Restoring such a tensor only maps it, its
+// pages are read from the checkpoint on first access and the OS can evict
+// them again, so that e.g. large embedding tables with mostly cold rows can be
+// served without reading them in full first.
 class RestoreV2 : public OpKernel {
  public:
   explicit RestoreV2(OpKernelConstruction* context) : OpKernel(context) {
     OP_REQUIRES_OK(context, context->GetAttr("dtypes", &dtypes_));
+    OP_REQUIRES_OK(context,
+                   ReadBoolFromEnvVar("TF_CHECKPOINT_RESTORE_USE_MMAP", false,
+                                      &use_mmap_));
+    int64_t lazy_min_bytes;
+    OP_REQUIRES_OK(context,
+                   ReadInt64FromEnvVar("TF_CHECKPOINT_RESTORE_LAZY_MIN_BYTES",
+                                       -1, &lazy_min_bytes));
+    if (lazy_min_bytes >= 0) {
+      use_mmap_ = true;
+      lazy_mmap_min_bytes_ = lazy_min_bytes;
+    }
   }
 
   void Compute(OpKernelContext* context) override {
@@ -202,6 +432,7 @@ class RestoreV2 : public OpKernel {
     if (!context->status().ok()) return;
 
     const string& prefix_string = prefix.scalar<tstring>()();
+    OP_REQUIRES_OK(context, PendingBundleWrites::Global()->Wait(prefix_string));
 
     // Intention: we plan to use the RestoreV2 op as a backward-compatible
     // reader as we upgrade to the V2 format.  This allows transparent upgrade.
@@ -224,8 +455,10 @@ class RestoreV2 : public OpKernel {
       return;
     }
     // If found, invokes the V2 reader.
-    OP_REQUIRES_OK(context, RestoreTensorsV2(context, prefix, tensor_names,
-                                             shape_and_slices, dtypes_));
+    OP_REQUIRES_OK(context,
+                   RestoreTensorsV2(context, prefix, tensor_names,
+                                    shape_and_slices, dtypes_, use_mmap_,
+                                    lazy_mmap_min_bytes_));
 
     ResourceMgr* resource_manager = context->resource_manager();
     if (resource_manager != nullptr) {
@@ -250,6 +483,8 @@ class RestoreV2 : public OpKernel {
  private:
   // Expected dtypes of the to-restore tensors.
   std::vector<DataType> dtypes_;
+  bool use_mmap_ = false;
+  int64_t lazy_mmap_min_bytes_ = std::numeric_limits<int64_t>::max();
 };
 REGISTER_KERNEL_BUILDER(Name("RestoreV2").Device(DEVICE_CPU), RestoreV2);
 
@@ -279,6 +514,10 @@ class MergeV2Checkpoints : public OpKernel {
         gtl::ArraySlice<tstring>(checkpoint_prefixes.flat<tstring>());
     Env* env = Env::Default();
     const string& merged_prefix = destination_prefix.scalar<tstring>()();
+    for (const tstring& input_prefix : input_prefixes) {
+      OP_REQUIRES_OK(context,
+                     PendingBundleWrites::Global()->Wait(input_prefix));
+    }
     OP_REQUIRES_OK(
         context, tensorflow::MergeBundles(env, input_prefixes, merged_prefix));
 
@@ -18,7 +18,9 @@ limitations under the License.
 #ifndef TENSORFLOW_CORE_KERNELS_SEGMENT_REDUCTION_OPS_IMPL_H_
 #define TENSORFLOW_CORE_KERNELS_SEGMENT_REDUCTION_OPS_IMPL_H_
 
+#include <algorithm>
 #include <cstdint>
+#include <vector>
 
 #include "tensorflow/core/framework/op_requires.h"
 #include "tensorflow/core/platform/types.h"
@@ -40,8 +42,11 @@ limitations under the License.
 #include "tensorflow/core/kernels/segment_reduction_ops.h"
 #include "tensorflow/core/lib/core/status.h"
 #include "tensorflow/core/platform/logging.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/prefetch.h"
 #include "tensorflow/core/util/determinism.h"
 #include "tensorflow/core/util/util.h"
+#include "tensorflow/core/util/work_sharder.h"
 
 #if GOOGLE_CUDA || TENSORFLOW_USE_ROCM
 #include "tensorflow/core/common_runtime/gpu/gpu_event_mgr.h"
@@ -532,10 +537,14 @@ class SparseSegmentReductionOpBase : public OpKernel {
         default_value_(default_value) {}
 
   void Compute(OpKernelContext* context) override {
-    const Tensor& input = context->input(0);
-    const Tensor& indices = context->input(1);
-    const Tensor& segment_ids = context->input(2);
+    ReduceRows(context, context->input(0), context->input(1),
+               context->input(2));
+  }
 
+ protected:
+  // Reduces the rows `indices` of `input` into the segments `segment_ids`.
+  void ReduceRows(OpKernelContext* context, const Tensor& input,
+                  const Tensor& indices, const Tensor& segment_ids) {
     OP_REQUIRES_OK(
         context, internal::ValidateSparseSegmentReduction(
                      context, input, indices, segment_ids, has_num_segments_));
@@ -602,9 +611,13 @@ class SparseSegmentReductionOpBase : public OpKernel {
     }
     auto temp_flat = temp.flat_outer_dims<float>();
 
+    // Validate the segment ids and collect the segments, so that they can be
+    // reduced in parallel.  Segment `k` reduces the rows
+    // [segment_starts[k], segment_starts[k + 1]) of `indices` into output row
+    // segment_out[k].
+    std::vector<int64_t> segment_starts;
+    std::vector<SegmentId> segment_out;
     int64_t start = 0, end = 1;
-    // Index from which the output is not initialized.
-    SegmentId uninitialized_index = 0;
     SegmentId out_index = internal::SubtleMustCopy(segment_vec(start));
 
     while (true) {
@@ -629,34 +642,69 @@ class SparseSegmentReductionOpBase : public OpKernel {
               "Segment id ", out_index, " out of range [0, ", output_rows,
               "), possibly because 'segment_ids' input is not sorted."));
 
-      // If there is a gap between two indices, we need to set that gap to the
-      // default value.
-      if (out_index > uninitialized_index) {
-        Eigen::DSizes<Eigen::DenseIndex, 2> gap_slice_shape(
-            out_index - uninitialized_index, num_col);
-        Eigen::TensorMap<Eigen::Tensor<T, 2, Eigen::RowMajor>, Eigen::Unaligned>
-            gap_slice(&output_flat(uninitialized_index, 0), gap_slice_shape);
-        gap_slice.setConstant(default_value_);
-      }
-
-      auto out = output_flat.template chip<0>(out_index);
-      auto temp = temp_flat.template chip<0>(out_index);
-      const int bad_offset = Reduce<T, Index>(input_flat, indices_vec, start,
-                                              end - start, out, temp);
-      OP_REQUIRES(context, bad_offset < 0,
-                  errors::InvalidArgument(
-                      "Bad: indices[", start + bad_offset,
-                      "] == ", indices_vec(start + bad_offset),
-                      " out of range [0, ", input_flat.dimension(0), ")"));
-
+      segment_starts.push_back(start);
+      segment_out.push_back(out_index);
       start = end;
       ++end;
-      uninitialized_index = out_index + 1;
       out_index = next_index;
       if (end > num_indices) break;
     }
+    const int64_t num_segments = segment_out.size();
+    segment_starts.push_back(num_indices);
+
+    // Shards are ranges of `indices` rather than of segments, so that the work
+    // is balanced when segment sizes vary.  A shard reduces the segments that
+    // start within its range.
+    mutex mu;
+    int64_t bad_position = num_indices;
+    auto work = [&](int64_t begin, int64_t limit) {
+      int64_t k = std::lower_bound(segment_starts.begin(),
+                                   segment_starts.begin() + num_segments,
+                                   begin) -
+                  segment_starts.begin();
+      for (; k < num_segments && segment_starts[k] < limit; ++k) {
+        const int64_t seg_begin = segment_starts[k];
+        const int64_t seg_end = segment_starts[k + 1];
+        // If there is a gap between two segments, we need to set that gap to
+        // the default value.  Segment `k` owns the gap before it.
+        const SegmentId gap_begin = k == 0 ? 0 : segment_out[k - 1] + 1;
+        if (segment_out[k] > gap_begin) {
+          Eigen::DSizes<Eigen::DenseIndex, 2> gap_slice_shape(
+              segment_out[k] - gap_begin, num_col);
+          Eigen::TensorMap<Eigen::Tensor<T, 2, Eigen::RowMajor>,
+                           Eigen::Unaligned>
+              gap_slice(&output_flat(gap_begin, 0), gap_slice_shape);
+          gap_slice.setConstant(default_value_);
+        }
+        // Fetch the rows of the next segment while this one is reduced, since
+        // the rows are scattered and each one is a cache miss otherwise.
+        if (k + 1 < num_segments) {
+          PrefetchRows<T, Index>(input_flat, indices_vec, seg_end,
+                                 std::min(segment_starts[k + 2],
+                                          seg_end + kMaxPrefetchRows));
+        }
+        auto out = output_flat.template chip<0>(segment_out[k]);
+        auto temp = temp_flat.template chip<0>(segment_out[k]);
+        const int64_t bad_offset = Reduce<T, Index>(
+            input_flat, indices_vec, seg_begin, seg_end - seg_begin, out, temp);
+        if (bad_offset >= 0) {
+          mutex_lock l(mu);
+          bad_position = std::min(bad_position, seg_begin + bad_offset);
+          return;
+        }
+      }
+    };
+    auto worker_threads = context->device()->tensorflow_cpu_worker_threads();
+    Shard(worker_threads->num_threads, worker_threads->workers, num_indices,
+          /*cost_per_unit=*/num_col * 4, work);
+    OP_REQUIRES(context, bad_position == num_indices,
+                errors::InvalidArgument(
+                    "Bad: indices[", bad_position,
+                    "] == ", indices_vec(bad_position), " out of range [0, ",
+                    input_flat.dimension(0), ")"));
 
     // Fill the gap at the end with the default value.
+    const SegmentId uninitialized_index = segment_out[num_segments - 1] + 1;
     if (uninitialized_index < output_rows) {
       Eigen::DSizes<Eigen::DenseIndex, 2> gap_slice_shape(
           output_rows - uninitialized_index, num_col);
@@ -667,6 +715,27 @@ class SparseSegmentReductionOpBase : public OpKernel {
   }
 
  private:
+  // The number of rows of the next segment fetched ahead of their use.
+  static constexpr int64_t kMaxPrefetchRows = 16;
+
+  // Prefetches the rows `indices_vec[begin:end]` of `input_flat` into the
+  // cache.  Out of range indices are skipped; they are reported by Reduce.
+  template <typename Tin, typename Tindex>
+  void PrefetchRows(const typename TTypes<Tin>::ConstMatrix& input_flat,
+                    const typename TTypes<Tindex>::ConstVec& indices_vec,
+                    int64_t begin, int64_t end) {
+    constexpr int64_t kCacheLineSize = 64;
+    const int64_t row_bytes = input_flat.dimension(1) * sizeof(Tin);
+    for (int64_t i = begin; i < end; ++i) {
+      const Tindex index = indices_vec(i);
+      if (!FastBoundsCheck(index, input_flat.dimension(0))) continue;
+      const char* row = reinterpret_cast<const char*>(&input_flat(index, 0));
+      for (int64_t offset = 0; offset < row_bytes; offset += kCacheLineSize) {
+        port::prefetch<port::PREFETCH_HINT_T0>(row + offset);
+      }
+    }
+  }
+
   const DataType dtidx_;
   template <typename Tin>
   using EnableIfBfloat16OrHalf =
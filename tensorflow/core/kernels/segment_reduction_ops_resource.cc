@@ -0,0 +1,124 @@
+/* Copyright 2022 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+// See docs in ../ops/resource_variable_ops.cc.
+//
+// Implements the _ResourceSparseSegmentReduction op, which Grappler's Remapper
+// creates from a ResourceGather feeding into a SparseSegment{Sum,Mean,SqrtN}.
+// The rows are reduced straight from the variable, instead of being gathered
+// into an intermediate tensor first.
+
+#define EIGEN_USE_THREADS
+
+#include <string>
+
+#include "tensorflow/core/framework/bounds_check.h"
+#include "tensorflow/core/framework/resource_mgr.h"
+#include "tensorflow/core/framework/resource_var.h"
+#include "tensorflow/core/kernels/segment_reduction_ops_impl.h"
+#include "tensorflow/core/kernels/training_op_helpers.h"
+
+namespace tensorflow {
+
+template <class T, typename Index, typename SegmentId>
+class ResourceSparseSegmentReductionOp
+    : public SparseSegmentReductionOpBase<CPUDevice, T, Index, SegmentId> {
+ public:
+  explicit ResourceSparseSegmentReductionOp(OpKernelConstruction* context)
+      : SparseSegmentReductionOpBase<CPUDevice, T, Index, SegmentId>(
+            context, /*is_mean=*/GetReduction(context) == "Mean",
+            /*is_sqrtn=*/GetReduction(context) == "SqrtN",
+            /*has_num_segments=*/false, /*default_value=*/T(0)) {}
+
+  void Compute(OpKernelContext* context) override {
+    core::RefCountPtr<Var> variable;
+    OP_REQUIRES_OK(context, LookupResource(context, HandleFromInput(context, 0),
+                                           &variable));
+    OP_REQUIRES_OK(context, EnsureSparseVariableAccess<CPUDevice, T>(
+                                context, variable.get()));
+    tf_shared_lock ml(*variable->mu());
+    const Tensor& params = *variable->tensor();
+    OP_REQUIRES(
+        context, params.dtype() == DataTypeToEnum<T>::v(),
+        errors::InvalidArgument("Trying to read variable with wrong dtype. "
+                                "Expected ",
+                                DataTypeString(DataTypeToEnum<T>::v()), " got ",
+                                DataTypeString(params.dtype())));
+
+    const Tensor& gather_indices = context->input(1);
+    const Tensor& indices = context->input(2);
+    OP_REQUIRES(context, TensorShapeUtils::IsVector(gather_indices.shape()),
+                errors::InvalidArgument("gather_indices should be a vector."));
+    OP_REQUIRES(context, TensorShapeUtils::IsVector(indices.shape()),
+                errors::InvalidArgument("indices should be a vector."));
+
+    // Row indices[i] of the gathered tensor is row gather_indices[indices[i]]
+    // of the variable.
+    Tensor params_indices;
+    OP_REQUIRES_OK(context,
+                   context->allocate_temp(DataTypeToEnum<Index>::v(),
+                                          indices.shape(), &params_indices));
+    const auto gather_indices_vec = gather_indices.vec<Index>();
+    const auto indices_vec = indices.vec<Index>();
+    auto params_indices_vec = params_indices.vec<Index>();
+    const Index num_gathered = gather_indices_vec.dimension(0);
+    for (int64_t i = 0; i < indices_vec.dimension(0); ++i) {
+      const Index index = internal::SubtleMustCopy(indices_vec(i));
+      OP_REQUIRES(context, FastBoundsCheck(index, num_gathered),
+                  errors::InvalidArgument("indices[", i, "] == ", index,
+                                          " out of range [0, ", num_gathered,
+                                          ")"));
+      params_indices_vec(i) = gather_indices_vec(index);
+    }
+
+    this->ReduceRows(context, params, params_indices, context->input(3));
+  }
+
+ private:
+  static string GetReduction(OpKernelConstruction* context) {
+    string reduction;
+    // The op definition restricts the values of the attr, a missing attr is
+    // reported by the kernel registration.
+    context->GetAttr("reduction", &reduction).IgnoreError();
+    return reduction;
+  }
+};
+
+#define REGISTER_KERNELS(type, index_type, segment_ids_type)     \
+  REGISTER_KERNEL_BUILDER(                                       \
+      Name("_ResourceSparseSegmentReduction")                    \
+          .Device(DEVICE_CPU)                                    \
+          .HostMemory("resource")                                \
+          .TypeConstraint<type>("dtype")                         \
+          .TypeConstraint<index_type>("Tidx")                    \
+          .TypeConstraint<segment_ids_type>("Tsegmentids"),      \
+      ResourceSparseSegmentReductionOp<type, index_type, segment_ids_type>);
+
+#define REGISTER_KERNELS_FOR_EACH_SEGMENT_ID_TYPE(type, index_type) \
+  REGISTER_KERNELS(type, index_type, int32)                         \
+  REGISTER_KERNELS(type, index_type, int64_t)
+
+#define REGISTER_KERNELS_FOR_EACH_INDEX_TYPE(type)            \
+  REGISTER_KERNELS_FOR_EACH_SEGMENT_ID_TYPE(type, int32)      \
+  REGISTER_KERNELS_FOR_EACH_SEGMENT_ID_TYPE(type, int64_t)
+
+TF_CALL_float(REGISTER_KERNELS_FOR_EACH_INDEX_TYPE);
+TF_CALL_double(REGISTER_KERNELS_FOR_EACH_INDEX_TYPE);
+
+#undef REGISTER_KERNELS_FOR_EACH_INDEX_TYPE
+#undef REGISTER_KERNELS_FOR_EACH_SEGMENT_ID_TYPE
+#undef REGISTER_KERNELS
+
+}  // namespace tensorflow
@@ -290,4 +290,68 @@ BENCHMARK(BM_SparseSegmentMeanGrad_High_FP16)
     ->Arg(1000)
     ->Arg(100000);
 
+// Looks up bags of uneven sizes in an embedding table of `num_rows` rows of
+// `embedding_dim` elements, like a batch of sparse features does.
+template <DataType T>
+static void SparseSegmentSumHelper(::testing::benchmark::State& state,
+                                   int num_rows, int embedding_dim,
+                                   int num_bags) {
+  Graph* g = new Graph(OpRegistry::Global());
+
+  std::vector<int32> indices, segments;
+  uint32 x = 12345;
+  for (int bag = 0; bag < num_bags; ++bag) {
+    // Bags hold between 1 and 64 rows.
+    x = x * 1103515245 + 12345;
+    const int bag_size = 1 + (x >> 16) % 64;
+    for (int j = 0; j < bag_size; ++j) {
+      x = x * 1103515245 + 12345;
+      indices.push_back((x >> 8) % num_rows);
+      segments.push_back(bag);
+    }
+  }
+  const int num_indices = indices.size();
+
+  Tensor input(T, TensorShape({num_rows, embedding_dim}));
+  input.flat<typename EnumToDataType<T>::Type>().setRandom();
+
+  Node* node;
+  TF_CHECK_OK(
+      NodeBuilder(g->NewName("n"), "SparseSegmentSum")
+          .Input(test::graph::Constant(g, input))
+          .Input(test::graph::Constant(
+              g, test::AsTensor<int32>(indices, TensorShape({num_indices}))))
+          .Input(test::graph::Constant(
+              g, test::AsTensor<int32>(segments, TensorShape({num_indices}))))
+          .Attr("T", T)
+          .Finalize(g, &node));
+
+  test::Benchmark("cpu", g, /*old_benchmark_api*/ false).Run(state);
+  state.SetBytesProcessed(static_cast<int64_t>(state.iterations()) *
+                          num_indices * embedding_dim * DataTypeSize(T));
+}
+
+static void BM_SparseSegmentSum_FP32(::testing::benchmark::State& state) {
+  SparseSegmentSumHelper<DT_FLOAT>(state, 1 << 20, state.range(0),
+                                   state.range(1));
+}
+
+static void BM_SparseSegmentSum_BF16(::testing::benchmark::State& state) {
+  SparseSegmentSumHelper<DT_BFLOAT16>(state, 1 << 20, state.range(0),
+                                      state.range(1));
+}
+
+BENCHMARK(BM_SparseSegmentSum_FP32)
+    ->UseRealTime()
+    ->ArgPair(16, 1024)
+    ->ArgPair(64, 1024)
+    ->ArgPair(64, 8192)
+    ->ArgPair(256, 8192);
+BENCHMARK(BM_SparseSegmentSum_BF16)
+    ->UseRealTime()
+    ->ArgPair(16, 1024)
+    ->ArgPair(64, 1024)
+    ->ArgPair(64, 8192)
+    ->ArgPair(256, 8192);
+
 }  // namespace tensorflow
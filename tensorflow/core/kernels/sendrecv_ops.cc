@@ -15,6 +15,8 @@ limitations under the License.
 
 #include "tensorflow/core/kernels/sendrecv_ops.h"
 
+#include <cstring>
+
 #include "tensorflow/core/framework/attr_value.pb.h"
 #include "tensorflow/core/framework/op.h"
 #include "tensorflow/core/framework/op_def_util.h"
@@ -228,6 +230,109 @@ REGISTER_KERNEL_BUILDER(Name("Recv").Device(DEVICE_DEFAULT), RecvOp);
 REGISTER_KERNEL_BUILDER(
     Name("_HostRecv").Device(DEVICE_DEFAULT).HostMemory("tensor"), RecvOp);
 
+namespace {
+
+// Every field and every tensor payload in a packed transfer buffer starts at
+// a multiple of this many bytes, so that the unpacked tensors can be copied
+// out of the buffer with aligned accesses.
+constexpr int64_t kPackedTransferAlignment = sizeof(int64_t);
+
+int64_t PaddedTransferBytes(int64_t bytes) {
+  return (bytes + kPackedTransferAlignment - 1) / kPackedTransferAlignment *
+         kPackedTransferAlignment;
+}
+
+}  // namespace
+
+// Packs its inputs into one uint8 buffer laid out as, for every input,
+// [rank][dim_0]...[dim_{rank-1}][contents], where rank and dims are int64s and
+// the contents are padded to kPackedTransferAlignment.
+class PackTransferOp : public OpKernel {
+ public:
+  explicit PackTransferOp(OpKernelConstruction* ctx) : OpKernel(ctx) {}
+
+  void Compute(OpKernelContext* ctx) override {
+    OpInputList inputs;
+    OP_REQUIRES_OK(ctx, ctx->input_list("inputs", &inputs));
+    int64_t total_bytes = 0;
+    for (const Tensor& input : inputs) {
+      OP_REQUIRES(ctx, DataTypeCanUseMemcpy(input.dtype()),
+                  errors::InvalidArgument("Cannot pack a tensor of type ",
+                                          DataTypeString(input.dtype())));
+      total_bytes += (1 + input.dims()) * sizeof(int64_t) +
+                     PaddedTransferBytes(input.TotalBytes());
+    }
+    Tensor* packed = nullptr;
+    OP_REQUIRES_OK(
+        ctx, ctx->allocate_output(0, TensorShape({total_bytes}), &packed));
+    char* dst = reinterpret_cast<char*>(packed->flat<uint8>().data());
+    for (const Tensor& input : inputs) {
+      const int64_t rank = input.dims();
+      memcpy(dst, &rank, sizeof(rank));
+      dst += sizeof(rank);
+      for (int d = 0; d < input.dims(); ++d) {
+        const int64_t dim = input.dim_size(d);
+        memcpy(dst, &dim, sizeof(dim));
+        dst += sizeof(dim);
+      }
+      const StringPiece data = input.tensor_data();
+      memcpy(dst, data.data(), data.size());
+      memset(dst + data.size(), 0,
+             PaddedTransferBytes(data.size()) - data.size());
+      dst += PaddedTransferBytes(data.size());
+    }
+  }
+};
+
+// Inverse of PackTransferOp.
+class UnpackTransferOp : public OpKernel {
+ public:
+  explicit UnpackTransferOp(OpKernelConstruction* ctx) : OpKernel(ctx) {}
+
+  void Compute(OpKernelContext* ctx) override {
+    const Tensor& packed = ctx->input(0);
+    OP_REQUIRES(ctx, TensorShapeUtils::IsVector(packed.shape()),
+                errors::InvalidArgument("Packed transfer must be a vector, ",
+                                        "got ", packed.shape().DebugString()));
+    const char* src =
+        reinterpret_cast<const char*>(packed.flat<uint8>().data());
+    const char* const end = src + packed.NumElements();
+    auto read_int64 = [&src, end](int64_t* value) {
+      if (end - src < static_cast<ptrdiff_t>(sizeof(*value))) return false;
+      memcpy(value, src, sizeof(*value));
+      src += sizeof(*value);
+      return true;
+    };
+    for (int i = 0; i < num_outputs(); ++i) {
+      int64_t rank;
+      OP_REQUIRES(ctx, read_int64(&rank) && rank >= 0,
+                  errors::InvalidArgument("Truncated packed transfer"));
+      TensorShape shape;
+      for (int64_t d = 0; d < rank; ++d) {
+        int64_t dim;
+        OP_REQUIRES(ctx, read_int64(&dim),
+                    errors::InvalidArgument("Truncated packed transfer"));
+        OP_REQUIRES_OK(ctx, shape.AddDimWithStatus(dim));
+      }
+      Tensor* output = nullptr;
+      OP_REQUIRES_OK(ctx, ctx->allocate_output(i, shape, &output));
+      const StringPiece data = output->tensor_data();
+      OP_REQUIRES(ctx, end - src >= PaddedTransferBytes(data.size()),
+                  errors::InvalidArgument("Truncated packed transfer"));
+      memcpy(const_cast<char*>(data.data()), src, data.size());
+      src += PaddedTransferBytes(data.size());
+    }
+    OP_REQUIRES(ctx, src == end,
+                errors::InvalidArgument("Packed transfer has ", end - src,
+                                        " trailing bytes"));
+  }
+};
+
+REGISTER_KERNEL_BUILDER(Name("_PackTransfer").Device(DEVICE_CPU),
+                        PackTransferOp);
+REGISTER_KERNEL_BUILDER(Name("_UnpackTransfer").Device(DEVICE_CPU),
+                        UnpackTransferOp);
+
 // Environment variable `DISABLE_HOST_SEND_RECV_REGISTRATION` is used to disable
 // hostSend and hostRecv registration on CPU device in the mock environment.
 static bool InitModule() {
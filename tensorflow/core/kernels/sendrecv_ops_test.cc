@@ -14,7 +14,12 @@ limitations under the License.
 ==============================================================================*/
 
 #include "tensorflow/core/common_runtime/kernel_benchmark_testlib.h"
+#include "tensorflow/core/framework/fake_input.h"
+#include "tensorflow/core/framework/node_def_builder.h"
 #include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_testutil.h"
+#include "tensorflow/core/kernels/ops_testutil.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
 #include "tensorflow/core/platform/test.h"
 #include "tensorflow/core/platform/test_benchmark.h"
 
@@ -70,5 +75,42 @@ void BM_Recv(::testing::benchmark::State& state) {
 }
 BENCHMARK(BM_Recv)->UseRealTime();
 
+class PackTransferOpTest : public OpsTestBase {};
+
+TEST_F(PackTransferOpTest, RoundTrip) {
+  TF_ASSERT_OK(NodeDefBuilder("pack", "_PackTransfer")
+                   .Input(FakeInput({DT_FLOAT, DT_INT32, DT_BOOL}))
+                   .Finalize(node_def()));
+  TF_ASSERT_OK(InitOp());
+  AddInputFromArray<float>(TensorShape({2, 2}), {1, 2, 3, 4});
+  AddInputFromArray<int32>(TensorShape({}), {7});
+  AddInputFromArray<bool>(TensorShape({0}), {});
+  TF_ASSERT_OK(RunOpKernel());
+  // (rank, 2 dims, 16 bytes) + (rank, 4 bytes padded to 8) + (rank, 1 dim).
+  Tensor packed = *GetOutput(0);
+  EXPECT_EQ(40 + 16 + 16, packed.NumElements());
+
+  TF_ASSERT_OK(NodeDefBuilder("unpack", "_UnpackTransfer")
+                   .Input(FakeInput(DT_UINT8))
+                   .Attr("T", {DT_FLOAT, DT_INT32, DT_BOOL})
+                   .Finalize(node_def()));
+  TF_ASSERT_OK(InitOp());
+  inputs_.clear();
+  inputs_.push_back(TensorValue(&packed));
+  TF_ASSERT_OK(RunOpKernel());
+  test::ExpectTensorEqual<float>(
+      *GetOutput(0), test::AsTensor<float>({1, 2, 3, 4}, TensorShape({2, 2})));
+  test::ExpectTensorEqual<int32>(*GetOutput(1), test::AsScalar<int32>(7));
+  EXPECT_EQ(TensorShape({0}), GetOutput(2)->shape());
+
+  // A truncated buffer is rejected.
+  Tensor truncated(DT_UINT8, TensorShape({packed.NumElements() - 8}));
+  truncated.flat<uint8>() = packed.Slice(0, truncated.NumElements())
+                                .flat<uint8>();
+  inputs_.clear();
+  inputs_.push_back(TensorValue(&truncated));
+  EXPECT_TRUE(errors::IsInvalidArgument(RunOpKernel()));
+}
+
 }  // namespace
 }  // namespace tensorflow
@@ -0,0 +1,213 @@
+/* Copyright 2022 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_CORE_KERNELS_SHARDED_HASH_MAP_H_
+#define TENSORFLOW_CORE_KERNELS_SHARDED_HASH_MAP_H_
+
+#include <cstddef>
+#include <memory>
+#include <utility>
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/hash/hash.h"
+#include "absl/strings/string_view.h"
+#include "tensorflow/core/platform/logging.h"
+#include "tensorflow/core/platform/macros.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/thread_annotations.h"
+#include "tensorflow/core/platform/tstring.h"
+
+namespace tensorflow {
+namespace lookup {
+
+// Hash function of the keys of a ShardedHashMap.
+template <class K>
+struct ShardedHashMapHash {
+  size_t operator()(const K& key) const { return absl::Hash<K>()(key); }
+};
+
+template <>
+struct ShardedHashMapHash<tstring> {
+  size_t operator()(const tstring& key) const {
+    return absl::Hash<absl::string_view>()(
+        absl::string_view(key.data(), key.size()));
+  }
+};
+
+// A hash map split into shards that are each guarded by their own mutex, for
+// tables that are read and updated by many threads at once.
+//
+// Operations on single keys only lock the shard of the key, so that lookups
+// and inserts of different keys rarely contend.  Since each shard grows
+// independently, a growing map rehashes one shard at a time instead of
+// blocking every reader while all entries are moved.  Shards are
+// absl::flat_hash_maps, i.e. open-addressing tables that probe a group of
+// slots at a time using SIMD instructions where available.
+//
+// Operations that need a consistent view of the whole map, e.g. exporting
+// it, hold a ReaderLock or WriterLock, which locks all shards.
+template <class K, class V>
+class ShardedHashMap {
+ public:
+  static constexpr int kDefaultNumShards = 64;
+
+  explicit ShardedHashMap(int num_shards = kDefaultNumShards)
+      : num_shards_(num_shards), shards_(new Shard[num_shards]) {
+    CHECK_GT(num_shards, 0);
+  }
+
+  // Returns the number of entries.
+  size_t size() const {
+    size_t size = 0;
+    for (int i = 0; i < num_shards_; ++i) {
+      tf_shared_lock l(shards_[i].mu);
+      size += shards_[i].map.size();
+    }
+    return size;
+  }
+
+  // Returns the number of slots allocated by all shards.
+  size_t capacity() const {
+    size_t capacity = 0;
+    for (int i = 0; i < num_shards_; ++i) {
+      tf_shared_lock l(shards_[i].mu);
+      capacity += shards_[i].map.capacity();
+    }
+    return capacity;
+  }
+
+  // If `key` is present, calls `fn(value)` while holding the lock of its
+  // shard and returns true.  Otherwise returns false.
+  template <typename Fn>
+  bool Find(const K& key, Fn fn) const {
+    const Shard& shard = ShardOf(key);
+    tf_shared_lock l(shard.mu);
+    auto it = shard.map.find(key);
+    if (it == shard.map.end()) return false;
+    fn(it->second);
+    return true;
+  }
+
+  // Inserts `key` with `value`, or replaces the value if `key` is present.
+  void InsertOrAssign(const K& key, V value) {
+    Shard& shard = ShardOf(key);
+    mutex_lock l(shard.mu);
+    shard.map.insert_or_assign(key, std::move(value));
+  }
+
+  // Removes `key` if present.
+  void Erase(const K& key) {
+    Shard& shard = ShardOf(key);
+    mutex_lock l(shard.mu);
+    shard.map.erase(key);
+  }
+
+  // Holds the locks of all shards for reading, in shard order.
+  class ReaderLock {
+   public:
+    explicit ReaderLock(const ShardedHashMap& map)
+        TF_NO_THREAD_SAFETY_ANALYSIS : map_(map) {
+      for (int i = 0; i < map_.num_shards_; ++i) {
+        map_.shards_[i].mu.lock_shared();
+      }
+    }
+    ~ReaderLock() TF_NO_THREAD_SAFETY_ANALYSIS {
+      for (int i = map_.num_shards_ - 1; i >= 0; --i) {
+        map_.shards_[i].mu.unlock_shared();
+      }
+    }
+
+    // Returns the number of entries.
+    size_t size() const TF_NO_THREAD_SAFETY_ANALYSIS {
+      size_t size = 0;
+      for (int i = 0; i < map_.num_shards_; ++i) {
+        size += map_.shards_[i].map.size();
+      }
+      return size;
+    }
+
+    // Calls `fn(key, value)` for every entry.
+    template <typename Fn>
+    void ForEach(Fn fn) const TF_NO_THREAD_SAFETY_ANALYSIS {
+      for (int i = 0; i < map_.num_shards_; ++i) {
+        for (const auto& entry : map_.shards_[i].map) {
+          fn(entry.first, entry.second);
+        }
+      }
+    }
+
+   private:
+    const ShardedHashMap& map_;
+    TF_DISALLOW_COPY_AND_ASSIGN(ReaderLock);
+  };
+
+  // Holds the locks of all shards for writing, in shard order.
+  class WriterLock {
+   public:
+    explicit WriterLock(ShardedHashMap* map) TF_NO_THREAD_SAFETY_ANALYSIS
+        : map_(map) {
+      for (int i = 0; i < map_->num_shards_; ++i) {
+        map_->shards_[i].mu.lock();
+      }
+    }
+    ~WriterLock() TF_NO_THREAD_SAFETY_ANALYSIS {
+      for (int i = map_->num_shards_ - 1; i >= 0; --i) {
+        map_->shards_[i].mu.unlock();
+      }
+    }
+
+    // Removes all entries.
+    void Clear() TF_NO_THREAD_SAFETY_ANALYSIS {
+      for (int i = 0; i < map_->num_shards_; ++i) {
+        map_->shards_[i].map.clear();
+      }
+    }
+
+    // Inserts `key` with `value`, or replaces the value if `key` is present.
+    void InsertOrAssign(const K& key, V value) TF_NO_THREAD_SAFETY_ANALYSIS {
+      map_->ShardOf(key).map.insert_or_assign(key, std::move(value));
+    }
+
+   private:
+    ShardedHashMap* const map_;
+    TF_DISALLOW_COPY_AND_ASSIGN(WriterLock);
+  };
+
+ private:
+  struct Shard {
+    mutable mutex mu;
+    absl::flat_hash_map<K, V, ShardedHashMapHash<K>> map TF_GUARDED_BY(mu);
+  };
+
+  // The shard is picked from the high bits of the hash, while the shard's
+  // flat_hash_map probes with all of them, so keys of one shard still spread
+  // over its slots.
+  size_t ShardIndex(const K& key) const {
+    const size_t hash = ShardedHashMapHash<K>()(key);
+    return (hash >> (sizeof(size_t) * 4)) % num_shards_;
+  }
+  Shard& ShardOf(const K& key) { return shards_[ShardIndex(key)]; }
+  const Shard& ShardOf(const K& key) const { return shards_[ShardIndex(key)]; }
+
+  const int num_shards_;
+  std::unique_ptr<Shard[]> shards_;
+
+  TF_DISALLOW_COPY_AND_ASSIGN(ShardedHashMap);
+};
+
+}  // namespace lookup
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_KERNELS_SHARDED_HASH_MAP_H_
@@ -0,0 +1,109 @@
+/* Copyright 2022 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/kernels/sharded_hash_map.h"
+
+#include <map>
+
+#include "tensorflow/core/lib/core/threadpool.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace lookup {
+namespace {
+
+TEST(ShardedHashMapTest, InsertFindErase) {
+  ShardedHashMap<int64_t, int64_t> map(4);
+  EXPECT_EQ(0, map.size());
+  for (int64_t i = 0; i < 100; ++i) map.InsertOrAssign(i, 2 * i);
+  map.InsertOrAssign(7, -1);
+  EXPECT_EQ(100, map.size());
+
+  int64_t value = 0;
+  EXPECT_TRUE(map.Find(7, [&](int64_t v) { value = v; }));
+  EXPECT_EQ(-1, value);
+  EXPECT_TRUE(map.Find(42, [&](int64_t v) { value = v; }));
+  EXPECT_EQ(84, value);
+  EXPECT_FALSE(map.Find(100, [&](int64_t v) { value = v; }));
+
+  map.Erase(42);
+  map.Erase(1000);
+  EXPECT_EQ(99, map.size());
+  EXPECT_FALSE(map.Find(42, [&](int64_t v) { value = v; }));
+}
+
+TEST(ShardedHashMapTest, StringKeys) {
+  ShardedHashMap<tstring, int> map;
+  map.InsertOrAssign("a", 1);
+  map.InsertOrAssign(tstring(std::string(100, 'b')), 2);
+  int value = 0;
+  EXPECT_TRUE(map.Find("a", [&](int v) { value = v; }));
+  EXPECT_EQ(1, value);
+  EXPECT_TRUE(
+      map.Find(tstring(std::string(100, 'b')), [&](int v) { value = v; }));
+  EXPECT_EQ(2, value);
+  EXPECT_FALSE(map.Find("c", [&](int v) { value = v; }));
+}
+
+TEST(ShardedHashMapTest, Locks) {
+  ShardedHashMap<int64_t, int64_t> map(8);
+  {
+    ShardedHashMap<int64_t, int64_t>::WriterLock l(&map);
+    l.Clear();
+    for (int64_t i = 0; i < 50; ++i) l.InsertOrAssign(i, i + 1);
+  }
+  {
+    ShardedHashMap<int64_t, int64_t>::WriterLock l(&map);
+    l.Clear();
+    for (int64_t i = 10; i < 20; ++i) l.InsertOrAssign(i, i + 1);
+  }
+  ShardedHashMap<int64_t, int64_t>::ReaderLock l(map);
+  EXPECT_EQ(10, l.size());
+  std::map<int64_t, int64_t> entries;
+  l.ForEach([&](int64_t k, int64_t v) { entries[k] = v; });
+  ASSERT_EQ(10, entries.size());
+  for (const auto& entry : entries) {
+    EXPECT_EQ(entry.first + 1, entry.second);
+    EXPECT_GE(entry.first, 10);
+    EXPECT_LT(entry.first, 20);
+  }
+}
+
+TEST(ShardedHashMapTest, ConcurrentInsertAndFind) {
+  ShardedHashMap<int64_t, int64_t> map;
+  constexpr int kThreads = 8;
+  constexpr int64_t kKeysPerThread = 10000;
+  {
+    thread::ThreadPool pool(Env::Default(), "test", kThreads);
+    for (int t = 0; t < kThreads; ++t) {
+      pool.Schedule([&map, t]() {
+        for (int64_t i = 0; i < kKeysPerThread; ++i) {
+          const int64_t key = t * kKeysPerThread + i;
+          map.InsertOrAssign(key, key);
+          int64_t value = -1;
+          EXPECT_TRUE(map.Find(key, [&](int64_t v) { value = v; }));
+          EXPECT_EQ(key, value);
+        }
+      });
+    }
+  }
+  EXPECT_EQ(kThreads * kKeysPerThread, map.size());
+  EXPECT_GE(map.capacity(), map.size());
+}
+
+}  // namespace
+}  // namespace lookup
+}  // namespace tensorflow
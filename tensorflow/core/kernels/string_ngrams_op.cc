@@ -23,6 +23,7 @@ limitations under the License.
 #include "tensorflow/core/framework/op_requires.h"
 #include "tensorflow/core/platform/errors.h"
 #include "tensorflow/core/platform/types.h"
+#include "tensorflow/core/util/work_sharder.h"
 
 namespace tensorflow {
 namespace text {
@@ -127,42 +128,6 @@ class StringNGramsOp : public tensorflow::OpKernel {
         num_ngrams += ngrams_or.ValueOrDie();
       }
       if (preserve_short_ && length > 0 && num_ngrams == 0) {
-        num_ngrams = 1;
-      }
-      ngrams_splits_data[i] = ngrams_splits_data[i - 1] + num_ngrams;
-    }
-
-    tensorflow::Tensor* ngrams;
-    OP_REQUIRES_OK(
-        context,
-        context->allocate_output(
-            0, TensorShape({ngrams_splits_data[num_batch_items]}), &ngrams));
-    auto ngrams_data = ngrams->flat<tstring>().data();
-
-    for (int i = 0; i < num_batch_items; ++i) {
-      auto data_start = &input_data[splits_vec(i)];
-      int output_start_idx = ngrams_splits_data[i];
-      for (int ngram_width : ngram_widths_) {
-        auto output_start = &ngrams_data[output_start_idx];
-        int length = splits_vec(i + 1) - splits_vec(i);
-        auto ngrams_or = get_num_ngrams(length, ngram_width);
-        OP_REQUIRES_OK(context, ngrams_or.status());
-        int num_ngrams = ngrams_or.ValueOrDie();
-        CreateNgrams(data_start, output_start, num_ngrams, ngram_width);
-        output_start_idx += num_ngrams;
-      }
-      // If we're preserving short sequences, check to see if no sequence was
-      // generated by comparing the current output start idx to the original
-      // one (ngram_splits_data). If no ngrams were generated, then they will
-      // be equal (since we increment output_start_idx by num_ngrams every
-      // time we create a set of ngrams.)
-      if (preserve_short_ && output_start_idx == ngrams_splits_data[i]) {
-        int data_length = splits_vec(i + 1) - splits_vec(i);
-        // One legitimate reason to not have any ngrams when preserve_short_
-        // is true is if the sequence itself is empty. In that case, move on.
-        if (data_length == 0) {
-          continue;
-        }
         // We don't have to worry about dynamic padding sizes here: if padding
         // was dynamic, every sequence would have had sufficient padding to
         // generate at least one ngram.
@@ -176,12 +141,57 @@ class StringNGramsOp : public tensorflow::OpKernel {
                                     "preserve_short_sequences is True and "
                                     "ngram_widths are not provided, got ",
                                     pad_width_));
-        int ngram_width = data_length + 2 * pad_width_;
-        auto output_start = &ngrams_data[output_start_idx];
-        int num_ngrams = 1;
-        CreateNgrams(data_start, output_start, num_ngrams, ngram_width);
+        num_ngrams = 1;
       }
+      ngrams_splits_data[i] = ngrams_splits_data[i - 1] + num_ngrams;
     }
+
+    tensorflow::Tensor* ngrams;
+    OP_REQUIRES_OK(
+        context,
+        context->allocate_output(
+            0, TensorShape({ngrams_splits_data[num_batch_items]}), &ngrams));
+    auto ngrams_data = ngrams->flat<tstring>().data();
+
+    // Every batch item writes its own range of the output, so the items are
+    // processed in parallel. The sizes were validated above, so nothing can
+    // fail from here on.
+    auto create_batch_ngrams = [&](int64_t start, int64_t limit) {
+      for (int64_t i = start; i < limit; ++i) {
+        auto data_start = &input_data[splits_vec(i)];
+        int output_start_idx = ngrams_splits_data[i];
+        int length = splits_vec(i + 1) - splits_vec(i);
+        for (int ngram_width : ngram_widths_) {
+          auto output_start = &ngrams_data[output_start_idx];
+          int num_ngrams = get_num_ngrams(length, ngram_width).ValueOrDie();
+          CreateNgrams(data_start, output_start, num_ngrams, ngram_width);
+          output_start_idx += num_ngrams;
+        }
+        // If we're preserving short sequences, check to see if no sequence was
+        // generated by comparing the current output start idx to the original
+        // one (ngram_splits_data). If no ngrams were generated, then they will
+        // be equal (since we increment output_start_idx by num_ngrams every
+        // time we create a set of ngrams.)
+        if (preserve_short_ && output_start_idx == ngrams_splits_data[i]) {
+          // One legitimate reason to not have any ngrams when preserve_short_
+          // is true is if the sequence itself is empty. In that case, move on.
+          if (length == 0) {
+            continue;
+          }
+          int ngram_width = length + 2 * pad_width_;
+          auto output_start = &ngrams_data[output_start_idx];
+          int num_ngrams = 1;
+          CreateNgrams(data_start, output_start, num_ngrams, ngram_width);
+        }
+      }
+    };
+    // Items are weighted by the average number of ngrams they build.
+    const int64_t cost_per_item =
+        100 * (1 + ngrams_splits_data[num_batch_items] /
+                       std::max(num_batch_items, 1));
+    auto worker_threads = context->device()->tensorflow_cpu_worker_threads();
+    Shard(worker_threads->num_threads, worker_threads->workers,
+          num_batch_items, cost_per_item, create_batch_ngrams);
   }
 
   void CreateNgrams(const tstring* data, tstring* output, int num_ngrams,
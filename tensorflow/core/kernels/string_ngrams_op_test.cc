@@ -14,6 +14,7 @@ limitations under the License.
 ==============================================================================*/
 #include <vector>
 
+#include "absl/strings/str_cat.h"
 #include "tensorflow/core/framework/fake_input.h"
 #include "tensorflow/core/framework/node_def_builder.h"
 #include "tensorflow/core/framework/shape_inference.h"
@@ -578,6 +579,38 @@ TEST_F(NgramKernelTest, TestNoTokensNoPad) {
   assert_int64_equal(expected_splits, *GetOutput(1));
 }
 
+TEST_F(NgramKernelTest, TestManyBatchItems) {
+  MakeOp("|", {2}, "LP", "RP", -1, false);
+  // Enough batch items that they are split over several threads. Batch item i
+  // holds the i % 3 + 1 tokens "a<i>", "b<i>", ...
+  constexpr int kNumBatchItems = 10000;
+  std::vector<tstring> data;
+  std::vector<int64_t> splits({0});
+  std::vector<tstring> expected_values;
+  std::vector<int64_t> expected_splits({0});
+  for (int i = 0; i < kNumBatchItems; ++i) {
+    const int length = i % 3 + 1;
+    std::vector<tstring> tokens({"LP"});
+    for (int j = 0; j < length; ++j) {
+      tokens.push_back(absl::StrCat(string(1, 'a' + j), i));
+      data.push_back(tokens.back());
+    }
+    tokens.push_back("RP");
+    for (size_t j = 0; j + 1 < tokens.size(); ++j) {
+      expected_values.push_back(absl::StrCat(tokens[j], "|", tokens[j + 1]));
+    }
+    splits.push_back(data.size());
+    expected_splits.push_back(expected_values.size());
+  }
+  AddInputFromArray<tstring>(TensorShape({static_cast<int64_t>(data.size())}),
+                             data);
+  AddInputFromArray<int64_t>(TensorShape({kNumBatchItems + 1}), splits);
+  TF_ASSERT_OK(RunOpKernel());
+
+  assert_string_equal(expected_values, *GetOutput(0));
+  assert_int64_equal(expected_splits, *GetOutput(1));
+}
+
 TEST_F(NgramKernelTest, ShapeFn) {
   ShapeInferenceTestOp op("StringNGrams");
   INFER_OK(op, "?;?", "[?];[?]");
@@ -15,7 +15,9 @@ limitations under the License.
 
 // See docs in ../ops/string_ops.cc.
 
+#include <algorithm>
 #include <string>
+#include <vector>
 
 #include "tensorflow/core/framework/kernel_def_builder.h"
 #include "tensorflow/core/framework/op_kernel.h"
@@ -24,43 +26,45 @@ limitations under the License.
 #include "tensorflow/core/lib/core/status.h"
 #include "tensorflow/core/lib/core/stringpiece.h"
 #include "tensorflow/core/lib/strings/str_util.h"
+#include "tensorflow/core/util/work_sharder.h"
 
 namespace tensorflow {
 namespace {
+// The split functions below append the tokens of `str` to `result` and return
+// how many tokens they appended. The tokens of all the rows of a batch go into
+// one vector, so that splitting a row doesn't allocate a vector of its own.
+// The StringPieces are valid as long as input `str` is valid.
+
 // Split input string `str` based on a character delimiter.
-// Returns a vector of StringPieces which are valid as long as input `str`
-// is valid.
 // Note: The single character delimiter is a common case and is implemented as
 // a series of finds in the input string, making it much more efficient than
 // SplitOnCharSet.
 template <typename Predicate>
-std::vector<StringPiece> SplitOnChar(const tstring& str, const char delim,
-                                     Predicate p) {
-  std::vector<StringPiece> result;
+int64_t SplitOnChar(const tstring& str, const char delim, Predicate p,
+                    std::vector<StringPiece>* result) {
+  const size_t start_size = result->size();
   StringPiece text(str);
   auto f = text.find(delim);
   while (f != StringPiece::npos) {
     StringPiece token = text.substr(0, f);
     if (p(token)) {
-      result.emplace_back(token);
+      result->emplace_back(token);
     }
     text.remove_prefix(f + 1);
     f = text.find(delim);
   }
   if (p(text)) {
-    result.push_back(text);
+    result->push_back(text);
   }
-  return result;
+  return result->size() - start_size;
 }
 
 // Split input string `str` based on a set of character delimiters.
-// Returns a vector of StringPieces which are valid as long as input `str`
-// is valid.
 // Based on str_util::Split.
 template <typename Predicate>
-std::vector<StringPiece> SplitOnCharSet(const tstring& str,
-                                        const tstring& delim_set, Predicate p) {
-  std::vector<StringPiece> result;
+int64_t SplitOnCharSet(const tstring& str, const tstring& delim_set,
+                       Predicate p, std::vector<StringPiece>* result) {
+  const size_t start_size = result->size();
   StringPiece text(str);
   StringPiece delims(delim_set);
   size_t token_start = 0;
@@ -68,39 +72,35 @@ std::vector<StringPiece> SplitOnCharSet(const tstring& str,
     if ((i == text.size()) || (delims.find(text[i]) != StringPiece::npos)) {
       StringPiece token(text.data() + token_start, i - token_start);
       if (p(token)) {
-        result.emplace_back(token);
+        result->emplace_back(token);
       }
       token_start = i + 1;
     }
   }
-  return result;
+  return result->size() - start_size;
 }
 
 // Split input string `str` based on given delimiter.
-// Returns a vector of StringPieces which are valid as long as input `str`
-// is valid.
 template <typename Predicate>
-std::vector<StringPiece> Split(const tstring& str, const tstring& delimiter,
-                               Predicate predicate) {
+int64_t Split(const tstring& str, const tstring& delimiter,
+              Predicate predicate, std::vector<StringPiece>* result) {
   if (str.empty()) {
-    return std::vector<StringPiece>();
+    return 0;
   }
   if (delimiter.empty()) {
-    std::vector<StringPiece> result;
-    result.resize(str.size());
     for (size_t i = 0; i < str.size(); ++i) {
-      result[i] = StringPiece(str.data() + i, 1);
+      result->emplace_back(str.data() + i, 1);
     }
-    return result;
+    return str.size();
   }
   if (delimiter.size() == 1) {
-    return SplitOnChar(str, delimiter[0], predicate);
+    return SplitOnChar(str, delimiter[0], predicate, result);
   }
-  return SplitOnCharSet(str, delimiter, predicate);
+  return SplitOnCharSet(str, delimiter, predicate, result);
 }
 
-std::vector<StringPiece> SplitV2(const tstring& str, StringPiece sep,
-                                 int maxsplit) {
+int64_t SplitV2(const tstring& str, StringPiece sep, int maxsplit,
+                std::vector<StringPiece>* result) {
   // This SplitV2 method matches the behavior of python's str.split:
   //   If sep is given, consecutive delimiters are not grouped together
   //   and are deemed to delimit empty strings (for example, '1,,2'.split(',')
@@ -115,12 +115,11 @@ std::vector<StringPiece> SplitV2(const tstring& str, StringPiece sep,
   //   splitting an empty string or a string consisting of just whitespace
   //   with a None separator returns [].
 
-  std::vector<StringPiece> result;
-
+  const size_t start_size = result->size();
   StringPiece text(str);
   if (maxsplit == 0) {
-    result.emplace_back(text);
-    return result;
+    result->emplace_back(text);
+    return result->size() - start_size;
   }
 
   if (sep.empty()) {
@@ -129,32 +128,80 @@ std::vector<StringPiece> SplitV2(const tstring& str, StringPiece sep,
     str_util::RemoveLeadingWhitespace(&text);
     int split = 0;
     while (str_util::ConsumeNonWhitespace(&text, &token)) {
-      result.push_back(token);
+      result->push_back(token);
       str_util::RemoveLeadingWhitespace(&text);
       ++split;
       if (maxsplit > 0 && split == maxsplit) {
-        result.push_back(text);
-        return result;
+        result->push_back(text);
+        return result->size() - start_size;
       }
     }
-    return result;
+    return result->size() - start_size;
   }
   auto p = std::search(text.begin(), text.end(), sep.begin(), sep.end());
   int split = 0;
   while (p != text.end()) {
     StringPiece token = text.substr(0, p - text.begin());
-    result.push_back(token);
+    result->push_back(token);
     text.remove_prefix(token.size());
     text.remove_prefix(sep.size());
     ++split;
     if (maxsplit > 0 && split == maxsplit) {
-      result.push_back(StringPiece(text));
-      return result;
+      result->push_back(StringPiece(text));
+      return result->size() - start_size;
     }
     p = std::search(text.begin(), text.end(), sep.begin(), sep.end());
   }
-  result.push_back(text);
-  return result;
+  result->push_back(text);
+  return result->size() - start_size;
+}
+
+// Writes the outputs of StringSplit and StringSplitV2, where `tokens` holds
+// the tokens of all rows and `num_indices[i]` is the number of tokens of row i.
+// The rows are copied in parallel, since copying the tokens that don't fit in
+// place makes an allocation per token.
+void WriteSparseTokens(OpKernelContext* ctx,
+                       const std::vector<StringPiece>& tokens,
+                       const std::vector<int64_t>& num_indices,
+                       int64_t max_num_entries) {
+  const int64_t batch_size = num_indices.size();
+  const int64_t output_size = tokens.size();
+  Tensor* sp_indices_t;
+  OP_REQUIRES_OK(ctx, ctx->allocate_output(0, TensorShape({output_size, 2}),
+                                           &sp_indices_t));
+  Tensor* sp_tokens_t;
+  OP_REQUIRES_OK(
+      ctx, ctx->allocate_output(1, TensorShape({output_size}), &sp_tokens_t));
+  Tensor* sp_shape_t;
+  OP_REQUIRES_OK(ctx, ctx->allocate_output(2, TensorShape({2}), &sp_shape_t));
+
+  auto sp_indices = sp_indices_t->matrix<int64_t>();
+  auto sp_tokens = sp_tokens_t->vec<tstring>();
+  auto sp_shape = sp_shape_t->vec<int64_t>();
+  sp_shape(0) = batch_size;
+  sp_shape(1) = max_num_entries;
+
+  std::vector<int64_t> row_starts(batch_size + 1, 0);
+  for (int64_t i = 0; i < batch_size; ++i) {
+    row_starts[i + 1] = row_starts[i] + num_indices[i];
+  }
+  auto write_rows = [&](int64_t start, int64_t limit) {
+    for (int64_t i = start; i < limit; ++i) {
+      int64_t c = row_starts[i];
+      for (int64_t j = 0; j < num_indices[i]; ++j) {
+        sp_indices(c, 0) = i;
+        sp_indices(c, 1) = j;
+        sp_tokens(c).assign(tokens[c].data(), tokens[c].size());
+        ++c;
+      }
+    }
+  };
+  // Rows are weighted by their average number of tokens.
+  const int64_t cost_per_row =
+      50 * (1 + output_size / std::max<int64_t>(batch_size, 1));
+  auto worker_threads = ctx->device()->tensorflow_cpu_worker_threads();
+  Shard(worker_threads->num_threads, worker_threads->workers, batch_size,
+        cost_per_row, write_rows);
 }
 
 }  // namespace
@@ -195,44 +242,19 @@ class StringSplitOp : public OpKernel {
     static constexpr int kReserveSize = 4;
     tokens.reserve(batch_size * kReserveSize);
 
-    int64_t output_size = 0;
     int64_t max_num_entries = 0;
     std::vector<int64_t> num_indices(batch_size);
     for (int64_t i = 0; i < batch_size; ++i) {
-      std::vector<StringPiece> parts =
-          skip_empty_ ? Split(input_vec(i), delimiter, str_util::SkipEmpty())
-                      : Split(input_vec(i), delimiter, str_util::AllowEmpty());
-      int64_t n_entries = parts.size();
+      int64_t n_entries =
+          skip_empty_
+              ? Split(input_vec(i), delimiter, str_util::SkipEmpty(), &tokens)
+              : Split(input_vec(i), delimiter, str_util::AllowEmpty(),
+                      &tokens);
       num_indices[i] = n_entries;
-      output_size += n_entries;
       max_num_entries = std::max(max_num_entries, n_entries);
-      tokens.insert(tokens.end(), std::make_move_iterator(parts.begin()),
-                    std::make_move_iterator(parts.end()));
     }
 
-    Tensor* sp_indices_t;
-    OP_REQUIRES_OK(ctx, ctx->allocate_output(0, TensorShape({output_size, 2}),
-                                             &sp_indices_t));
-    Tensor* sp_tokens_t;
-    OP_REQUIRES_OK(
-        ctx, ctx->allocate_output(1, TensorShape({output_size}), &sp_tokens_t));
-    Tensor* sp_shape_t;
-    OP_REQUIRES_OK(ctx, ctx->allocate_output(2, TensorShape({2}), &sp_shape_t));
-
-    auto sp_indices = sp_indices_t->matrix<int64_t>();
-    auto sp_tokens = sp_tokens_t->vec<tstring>();
-    auto sp_shape = sp_shape_t->vec<int64_t>();
-    sp_shape(0) = batch_size;
-    sp_shape(1) = max_num_entries;
-    size_t c = 0;
-    for (size_t i = 0; i < batch_size; ++i) {
-      for (size_t j = 0; j < num_indices[i]; ++j) {
-        sp_indices(c, 0) = i;
-        sp_indices(c, 1) = j;
-        sp_tokens(c).assign(tokens[c].data(), tokens[c].size());
-        ++c;
-      }
-    }
+    WriteSparseTokens(ctx, tokens, num_indices, max_num_entries);
   }
 
  private:
@@ -268,41 +290,15 @@ class StringSplitV2Op : public OpKernel {
     static constexpr int kReserveSize = 4;
     tokens.reserve(batch_size * kReserveSize);
 
-    int64_t output_size = 0;
     int64_t max_num_entries = 0;
     std::vector<int64_t> num_indices(batch_size);
     for (int64_t i = 0; i < batch_size; ++i) {
-      std::vector<StringPiece> parts = SplitV2(input_vec(i), sep, maxsplit_);
-      int64_t n_entries = parts.size();
+      int64_t n_entries = SplitV2(input_vec(i), sep, maxsplit_, &tokens);
       num_indices[i] = n_entries;
-      output_size += n_entries;
       max_num_entries = std::max(max_num_entries, n_entries);
-      tokens.insert(tokens.end(), parts.begin(), parts.end());
     }
 
-    Tensor* sp_indices_t;
-    OP_REQUIRES_OK(ctx, ctx->allocate_output(0, TensorShape({output_size, 2}),
-                                             &sp_indices_t));
-    Tensor* sp_tokens_t;
-    OP_REQUIRES_OK(
-        ctx, ctx->allocate_output(1, TensorShape({output_size}), &sp_tokens_t));
-    Tensor* sp_shape_t;
-    OP_REQUIRES_OK(ctx, ctx->allocate_output(2, TensorShape({2}), &sp_shape_t));
-
-    auto sp_indices = sp_indices_t->matrix<int64_t>();
-    auto sp_tokens = sp_tokens_t->vec<tstring>();
-    auto sp_shape = sp_shape_t->vec<int64_t>();
-    sp_shape(0) = batch_size;
-    sp_shape(1) = max_num_entries;
-    size_t c = 0;
-    for (size_t i = 0; i < batch_size; ++i) {
-      for (size_t j = 0; j < num_indices[i]; ++j) {
-        sp_indices(c, 0) = i;
-        sp_indices(c, 1) = j;
-        sp_tokens(c).assign(tokens[c].data(), tokens[c].size());
-        ++c;
-      }
-    }
+    WriteSparseTokens(ctx, tokens, num_indices, max_num_entries);
   }
 
  private:
@@ -23,6 +23,7 @@ limitations under the License.
 #include "tensorflow/core/summary/schema.h"
 #include "tensorflow/core/summary/summary_db_writer.h"
 #include "tensorflow/core/summary/summary_file_writer.h"
+#include "tensorflow/core/util/env_var.h"
 #include "tensorflow/core/util/event.pb.h"
 
 namespace tensorflow {
@@ -53,14 +54,19 @@ class CreateSummaryFileWriterOp : public OpKernel {
     OP_REQUIRES(ctx, TensorShapeUtils::IsScalar(tmp->shape()),
                 errors::InvalidArgument("filename_suffix must be a scalar"));
     const string filename_suffix = tmp->scalar<tstring>()();
+    // When positive, summaries are converted and written by a background
+    // thread, and dropped once this many are waiting to be written.
+    int64_t max_pending;
+    OP_REQUIRES_OK(ctx, ReadInt64FromEnvVar("TF_SUMMARY_WRITER_MAX_PENDING",
+                                            0, &max_pending));
 
     core::RefCountPtr<SummaryWriterInterface> s;
     OP_REQUIRES_OK(ctx, LookupOrCreateResource<SummaryWriterInterface>(
                             ctx, HandleFromInput(ctx, 0), &s,
-                            [max_queue, flush_millis, logdir, filename_suffix,
-                             ctx](SummaryWriterInterface** s) {
-                              return CreateSummaryFileWriter(
-                                  max_queue, flush_millis, logdir,
+                            [max_queue, flush_millis, max_pending, logdir,
+                             filename_suffix, ctx](SummaryWriterInterface** s) {
+                              return CreateAsyncSummaryFileWriter(
+                                  max_queue, flush_millis, max_pending, logdir,
                                   filename_suffix, ctx->env(), s);
                             }));
   }
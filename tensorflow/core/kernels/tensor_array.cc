@@ -16,6 +16,8 @@ limitations under the License.
 #define EIGEN_USE_THREADS
 #include "tensorflow/core/kernels/tensor_array.h"
 
+#include <cstring>
+
 #include "third_party/eigen3/unsupported/Eigen/CXX11/Tensor"
 #include "tensorflow/core/framework/register_types.h"
 #include "tensorflow/core/framework/tensor_util.h"
@@ -81,6 +83,95 @@ TF_CALL_COMPLEX_TYPES(TENSOR_ARRAY_SET_ZERO_GPU);
 
 std::atomic<int64_t> TensorArray::tensor_array_counter{0};
 
+void TensorArray::EnableContiguousStorage() {
+  mutex_lock l(mu_);
+  if (dynamic_size_ || multiple_writes_aggregate_ || is_grad_ ||
+      tensors_.empty() || !element_shape_.IsFullyDefined() ||
+      !DataTypeCanUseMemcpy(dtype_)) {
+    return;
+  }
+  element_shape_.AsTensorShape(&storage_element_shape_);  // Always succeeds.
+  // Reads return slices of the storage, which kernels may require to be
+  // aligned.
+  const size_t element_bytes =
+      storage_element_shape_.num_elements() * DataTypeSize(dtype_);
+  if (element_bytes == 0 ||
+      element_bytes % Allocator::kAllocatorAlignment != 0) {
+    return;
+  }
+  claimed_.reset(new std::atomic<bool>[tensors_.size()]);
+  for (size_t i = 0; i < tensors_.size(); ++i) {
+    claimed_[i].store(false, std::memory_order_relaxed);
+  }
+  contiguous_storage_ = true;
+}
+
+Status TensorArray::WriteToStorage(OpKernelContext* ctx, const int32_t index,
+                                   const Tensor* value, bool* written) {
+  {
+    tf_shared_lock l(mu_);
+    if (storage_.IsInitialized()) {
+      *written = SharedLockedWriteToStorage(index, value);
+      return OkStatus();
+    }
+  }
+  {
+    mutex_lock l(mu_);
+    if (closed_) {
+      *written = false;
+      return OkStatus();
+    }
+    if (!storage_.IsInitialized()) {
+      TensorShape storage_shape = storage_element_shape_;
+      storage_shape.InsertDim(0, tensors_.size());
+      TF_RETURN_IF_ERROR(ctx->allocate_temp(dtype_, storage_shape, &storage_));
+    }
+  }
+  tf_shared_lock l(mu_);
+  *written =
+      storage_.IsInitialized() && SharedLockedWriteToStorage(index, value);
+  return OkStatus();
+}
+
+bool TensorArray::SharedLockedWriteToStorage(const int32_t index,
+                                             const Tensor* value) {
+  if (closed_ || index < 0 || static_cast<size_t>(index) >= tensors_.size() ||
+      value->dtype() != dtype_ || value->shape() != storage_element_shape_) {
+    return false;
+  }
+  if (claimed_[index].exchange(true, std::memory_order_relaxed)) return false;
+
+  // Only this write touches tensors_[index] until it releases mu_: all other
+  // accesses to it either claim the index first or hold mu_ exclusively.
+  TensorAndState& t = tensors_[index];
+  DCHECK(!t.written && !t.read);
+  Tensor element = storage_.SubSlice(index);
+  if (value->TotalBytes() > 0) {
+    memcpy(element.data(), value->data(), value->TotalBytes());
+  }
+  t.tensor = std::move(element);
+  t.shape = storage_element_shape_;
+  t.written = true;
+  t.in_storage = true;
+  return true;
+}
+
+bool TensorArray::GetStackedStorage(const std::vector<int32>& indices,
+                                    Tensor* value) {
+  mutex_lock l(mu_);
+  if (!storage_.IsInitialized() || indices.size() != tensors_.size()) {
+    return false;
+  }
+  for (size_t i = 0; i < indices.size(); ++i) {
+    if (indices[i] != static_cast<int32>(i) || !tensors_[i].in_storage) {
+      return false;
+    }
+  }
+  // Every index has been written, so no later write can change the storage.
+  *value = storage_;
+  return true;
+}
+
 Status TensorArray::CopyShapesFrom(TensorArray* rhs,
                                    const TensorShape* shape_to_prepend) {
   mutex_lock l(mu_);
@@ -17,6 +17,9 @@ limitations under the License.
 #define TENSORFLOW_CORE_KERNELS_TENSOR_ARRAY_H_
 
 #include <limits.h>
+
+#include <atomic>
+#include <memory>
 #include <vector>
 
 #include "tensorflow/core/framework/op_kernel.h"
@@ -183,9 +186,17 @@ class TensorArray : public ResourceBase {
   //
   // Note, value is passed as a pointer because we its underlying
   // Tensor's shape is accessed.  Otherwise it is not modified.
+  //
+  // If contiguous storage is enabled, the value is copied into the storage
+  // instead, and writes to distinct indices only hold the lock for reading.
   template <typename Device, typename T>
   Status WriteOrAggregate(OpKernelContext* ctx, const int32_t index,
                           const Tensor* value) {
+    if (contiguous_storage_) {
+      bool written = false;
+      TF_RETURN_IF_ERROR(WriteToStorage(ctx, index, value, &written));
+      if (written) return OkStatus();
+    }
     mutex_lock l(mu_);
     return LockedWriteOrAggregate<Device, T>(ctx, index, value);
   }
@@ -240,6 +251,23 @@ class TensorArray : public ResourceBase {
     return OkStatus();
   }
 
+  // Makes WriteOrAggregate copy the values into one Tensor of shape
+  // [N] + element_shape, allocated on the first write, so that stacking all
+  // the elements needs no concatenation (see GetStackedStorage).  Does
+  // nothing unless the element shape is fully defined, the array can neither
+  // grow nor aggregate, and its elements can be copied with memcpy and start
+  // at aligned addresses in the storage.
+  //
+  // Must be called before the TensorArray is shared, and only for arrays
+  // whose elements live in host memory.
+  void EnableContiguousStorage();
+
+  // If contiguous storage is enabled, every element has been written to it
+  // and `indices` are 0, 1, ..., N - 1, sets '*value' to the storage and
+  // returns true.  The caller is expected to have read the elements with
+  // ReadMany first.
+  bool GetStackedStorage(const std::vector<int32>& indices, Tensor* value);
+
   DataType ElemType() const { return dtype_; }
 
   PartialTensorShape ElemShape() {
@@ -337,6 +365,7 @@ class TensorArray : public ResourceBase {
   void ClearAndMarkClosed() {
     mutex_lock l(mu_);
     tensors_.clear();
+    storage_ = Tensor();
     closed_ = true;
   }
 
@@ -361,6 +390,26 @@ class TensorArray : public ResourceBase {
   Status LockedRead(OpKernelContext* ctx, const int32_t index, Tensor* value)
       TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
 
+  // Tries to write 'value' to the contiguous storage, allocating it first if
+  // needed.  Sets '*written' to false, without returning an error, if the
+  // write must take the general path instead.
+  Status WriteToStorage(OpKernelContext* ctx, const int32_t index,
+                        const Tensor* value, bool* written)
+      TF_LOCKS_EXCLUDED(mu_);
+
+  // Like WriteToStorage, but the storage must be allocated already, and mu_
+  // held for reading.  Returns whether the value was written.  Updates the
+  // state of the claimed index, hence no thread safety analysis.
+  bool SharedLockedWriteToStorage(const int32_t index, const Tensor* value)
+      TF_NO_THREAD_SAFETY_ANALYSIS;
+
+  // Marks 'index' as taken, so that writes to it take the general path.
+  void LockedClaim(const int32_t index) TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+    if (contiguous_storage_) {
+      claimed_[index].store(true, std::memory_order_relaxed);
+    }
+  }
+
   Status LockedReturnIfClosed() const TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
     if (closed_) {
       return errors::InvalidArgument("TensorArray ", handle_.vec<tstring>()(1),
@@ -411,12 +460,33 @@ class TensorArray : public ResourceBase {
   // was not fully defined.
   const bool identical_element_shapes_;
 
+  // Whether single writes copy their values into storage_.  Only set by
+  // EnableContiguousStorage, before the array is shared.
+  bool contiguous_storage_ = false;
+
+  // The shape of the elements in storage_.
+  TensorShape storage_element_shape_;
+
+  // Holds the elements at [index, ...], once allocated by the first write
+  // with contiguous storage enabled.
+  Tensor storage_ TF_GUARDED_BY(mu_);
+
+  // With contiguous storage enabled, claimed_[index] is set by the first
+  // write or read of the index.  Writes to storage_ claim it while holding
+  // mu_ for reading only, so that at most one write of an index copies its
+  // value; the others take the general path, which reports the error.
+  std::unique_ptr<std::atomic<bool>[]> claimed_;
+
   // TensorAndState is used to keep track of the Tensors stored in the
   // TensorArray, along with their shapes, and a boolean that determines whether
   // they have already been read or not.
   struct TensorAndState {
     TensorAndState()
-        : written(false), read(false), cleared(false), local_copy(false) {}
+        : written(false),
+          read(false),
+          cleared(false),
+          local_copy(false),
+          in_storage(false) {}
     Tensor tensor;
     TensorShape shape;
     bool written;  // True if a Tensor has been written to the index.
@@ -431,6 +501,9 @@ class TensorArray : public ResourceBase {
     // aggregated value.  This flag marks that such a Tensor is being
     // used.  All future writes will aggregate to the existing local Tensor.
     bool local_copy;
+
+    // True if 'tensor' is a slice of the contiguous storage.
+    bool in_storage;
   };
   // The list of underlying Tensors and states.
   std::vector<TensorAndState> tensors_ TF_GUARDED_BY(mu_);
@@ -534,6 +607,7 @@ Status TensorArray::LockedWriteOrAggregate(OpKernelContext* ctx,
     t.tensor = *value;
     t.shape = value->shape();
     t.written = true;
+    LockedClaim(index);
   }
   return OkStatus();
 }
@@ -618,6 +692,7 @@ Status TensorArray::LockedRead(OpKernelContext* ctx, const int32_t index,
     t.cleared = true;
   }
   t.read = true;
+  LockedClaim(index);
   return OkStatus();
 }
 
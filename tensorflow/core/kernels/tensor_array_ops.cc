@@ -150,7 +150,6 @@ class TensorArrayCreationOp : public OpKernel {
                                    Tensor* tensor_array_output_handle,
                                    TensorArray** output_tensor_array) = 0;
 
- private:
   const DeviceType device_type_;
 };
 
@@ -209,6 +208,9 @@ class TensorArrayOp : public TensorArrayCreationOp {
         identical_element_shapes_, dynamic_size_,
         false /* multiple_writes_aggregate */, false /* is_grad */,
         -1 /* marked_size */, clear_after_read_);
+    // On GPUs the elements would have to be copied on the compute stream, so
+    // only arrays on the host keep them contiguously.
+    if (device_type_ == DEVICE_CPU) tensor_array->EnableContiguousStorage();
 
     TF_RETURN_IF_ERROR(ctx->step_container()->Create(rm, key, tensor_array));
 
@@ -662,6 +664,14 @@ class TensorArrayPackOrGatherOp : public OpKernel {
                                 " which does not match the Tensor at index 0: ",
                                 value_0_t->shape().DebugString()));
 
+    // If the elements were written to contiguous storage in order, the
+    // storage already holds the stacked Tensor.
+    Tensor stacked;
+    if (tensor_array->GetStackedStorage(indices, &stacked)) {
+      ctx->set_output(0, stacked);
+      return;
+    }
+
     TensorShape output_shape(value_0_t->shape());
     output_shape.InsertDim(0, num_indices);
 
@@ -0,0 +1,455 @@
+/* Copyright 2022 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/kernels/tiered_embedding_var.h"
+
+#include <algorithm>
+#include <cstring>
+#include <utility>
+
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_shape.h"
+#include "tensorflow/core/framework/tensor_slice.h"
+#include "tensorflow/core/platform/errors.h"
+#include "tensorflow/core/platform/path.h"
+#include "tensorflow/core/platform/random.h"
+#include "tensorflow/core/platform/str_util.h"
+#include "tensorflow/core/platform/strcat.h"
+
+namespace tensorflow {
+
+namespace {
+
+// Rows are saved and restored in slices of at most this many rows.
+constexpr int64_t kSliceRows = 4096;
+
+// Records are appended to the log in batches of about this many bytes.
+constexpr size_t kLogBatchBytes = 1 << 20;
+
+// The log is compacted once its superseded records make up more than half of
+// it, and at least this many bytes.
+constexpr uint64 kMinCompactionBytes = 16 << 20;
+
+}  // namespace
+
+Status TieredEmbeddingVar::Create(Env* env, const Options& options,
+                                  const std::string& name,
+                                  TieredEmbeddingVar** var) {
+  if (options.value_dim <= 0) {
+    return errors::InvalidArgument("value_dim must be positive, got ",
+                                   options.value_dim);
+  }
+  if (options.promotion_threshold < 1) {
+    return errors::InvalidArgument("promotion_threshold must be positive, got ",
+                                   options.promotion_threshold);
+  }
+  std::string storage_path;
+  if (options.memory_capacity > 0) {
+    if (options.storage_dir.empty()) {
+      return errors::InvalidArgument(
+          "A storage_dir is required when memory_capacity is set");
+    }
+    TF_RETURN_IF_ERROR(env->RecursivelyCreateDir(options.storage_dir));
+    storage_path = io::JoinPath(
+        options.storage_dir,
+        strings::StrCat(str_util::StringReplace(name, "/", "_", true), "-",
+                        random::New64(), ".rows"));
+  }
+  std::unique_ptr<TieredEmbeddingVar> result(
+      new TieredEmbeddingVar(env, options, storage_path));
+  {
+    mutex_lock l(result->mu_);
+    TF_RETURN_IF_ERROR(result->Reset());
+  }
+  *var = result.release();
+  return OkStatus();
+}
+
+TieredEmbeddingVar::TieredEmbeddingVar(Env* env, const Options& options,
+                                       const std::string& storage_path)
+    : env_(env), options_(options), storage_path_(storage_path) {
+  scratch_.resize(record_bytes());
+}
+
+TieredEmbeddingVar::~TieredEmbeddingVar() {
+  mutex_lock l(mu_);
+  if (log_writer_ == nullptr) return;
+  log_reader_.reset();
+  log_writer_->Close().IgnoreError();
+  log_writer_.reset();
+  env_->DeleteFile(storage_path_).IgnoreError();
+}
+
+Status TieredEmbeddingVar::OpenStorage() {
+  log_reader_.reset();
+  log_writer_.reset();
+  TF_RETURN_IF_ERROR(env_->NewWritableFile(storage_path_, &log_writer_));
+  TF_RETURN_IF_ERROR(log_writer_->Flush());
+  TF_RETURN_IF_ERROR(env_->NewRandomAccessFile(storage_path_, &log_reader_));
+  log_bytes_ = 0;
+  stale_log_bytes_ = 0;
+  return OkStatus();
+}
+
+Status TieredEmbeddingVar::Reset() {
+  memory_index_.clear();
+  values_.clear();
+  slot_keys_.clear();
+  slot_freqs_.clear();
+  free_slots_.clear();
+  storage_index_.clear();
+  if (storage_path_.empty()) return OkStatus();
+  return OpenStorage();
+}
+
+int64_t TieredEmbeddingVar::AddToMemory(int64_t key, int64_t freq) {
+  int64_t slot;
+  if (!free_slots_.empty()) {
+    slot = free_slots_.back();
+    free_slots_.pop_back();
+  } else {
+    slot = slot_keys_.size();
+    slot_keys_.push_back(0);
+    slot_freqs_.push_back(0);
+    values_.resize(values_.size() + options_.value_dim);
+  }
+  slot_keys_[slot] = key;
+  slot_freqs_[slot] = freq;
+  memory_index_[key] = slot;
+  return slot;
+}
+
+Status TieredEmbeddingVar::ReadStoredRow(int64_t key, uint64 offset,
+                                         float* values) {
+  StringPiece record;
+  TF_RETURN_IF_ERROR(
+      log_reader_->Read(offset, record_bytes(), &record, scratch_.data()));
+  int64_t stored_key = 0;
+  if (record.size() == record_bytes()) {
+    memcpy(&stored_key, record.data(), sizeof(stored_key));
+  }
+  if (record.size() != record_bytes() || stored_key != key) {
+    return errors::DataLoss("Corrupted record for key ", key, " at offset ",
+                            offset, " of ", storage_path_);
+  }
+  memcpy(values, record.data() + sizeof(stored_key),
+         options_.value_dim * sizeof(float));
+  return OkStatus();
+}
+
+Status TieredEmbeddingVar::FindOrAddToMemory(int64_t key,
+                                             const float* default_value,
+                                             int64_t* slot) {
+  auto it = memory_index_.find(key);
+  if (it != memory_index_.end()) {
+    *slot = it->second;
+    ++slot_freqs_[*slot];
+    return OkStatus();
+  }
+  auto stored = storage_index_.find(key);
+  if (stored == storage_index_.end()) {
+    *slot = AddToMemory(key, 1);
+    std::copy_n(default_value, options_.value_dim, SlotValues(*slot));
+    return OkStatus();
+  }
+  *slot = AddToMemory(key, stored->second.freq + 1);
+  Status status = ReadStoredRow(key, stored->second.offset, SlotValues(*slot));
+  if (!status.ok()) {
+    memory_index_.erase(key);
+    free_slots_.push_back(*slot);
+    return status;
+  }
+  storage_index_.erase(stored);
+  stale_log_bytes_ += record_bytes();
+  return OkStatus();
+}
+
+Status TieredEmbeddingVar::Gather(absl::Span<const int64_t> keys,
+                                  const float* default_value, float* values) {
+  mutex_lock l(mu_);
+  const int64_t dim = options_.value_dim;
+  for (size_t i = 0; i < keys.size(); ++i) {
+    const int64_t key = keys[i];
+    float* row = values + i * dim;
+    auto it = memory_index_.find(key);
+    if (it != memory_index_.end()) {
+      ++slot_freqs_[it->second];
+      std::copy_n(SlotValues(it->second), dim, row);
+      continue;
+    }
+    auto stored = storage_index_.find(key);
+    if (stored == storage_index_.end()) {
+      std::copy_n(default_value, dim, row);
+    } else if (stored->second.freq + 1 < options_.promotion_threshold) {
+      ++stored->second.freq;
+      TF_RETURN_IF_ERROR(ReadStoredRow(key, stored->second.offset, row));
+    } else {
+      int64_t slot;
+      TF_RETURN_IF_ERROR(FindOrAddToMemory(key, default_value, &slot));
+      std::copy_n(SlotValues(slot), dim, row);
+    }
+  }
+  return MaybeEvict();
+}
+
+Status TieredEmbeddingVar::ApplyGradientDescent(float alpha,
+                                                absl::Span<const int64_t> keys,
+                                                const float* grad,
+                                                const float* default_value) {
+  mutex_lock l(mu_);
+  const int64_t dim = options_.value_dim;
+  for (size_t i = 0; i < keys.size(); ++i) {
+    int64_t slot;
+    TF_RETURN_IF_ERROR(FindOrAddToMemory(keys[i], default_value, &slot));
+    float* row = SlotValues(slot);
+    const float* row_grad = grad + i * dim;
+    for (int64_t j = 0; j < dim; ++j) {
+      row[j] -= alpha * row_grad[j];
+    }
+  }
+  return MaybeEvict();
+}
+
+Status TieredEmbeddingVar::MaybeEvict() {
+  const int64_t capacity = options_.memory_capacity;
+  if (capacity <= 0 || static_cast<int64_t>(memory_index_.size()) <= capacity) {
+    return OkStatus();
+  }
+
+  // Evict a tenth of the capacity at once, to amortize the selection of the
+  // victims and the writes to the log.
+  const int64_t target = capacity - capacity / 10;
+  std::vector<int64_t> slots;
+  slots.reserve(memory_index_.size());
+  for (const auto& key_and_slot : memory_index_) {
+    slots.push_back(key_and_slot.second);
+  }
+  const int64_t num_evicted = slots.size() - target;
+  std::nth_element(slots.begin(), slots.begin() + num_evicted, slots.end(),
+                   [this](int64_t a, int64_t b) {
+                     return std::make_pair(slot_freqs_[a], slot_keys_[a]) <
+                            std::make_pair(slot_freqs_[b], slot_keys_[b]);
+                   });
+
+  std::string batch;
+  uint64 batch_offset = log_bytes_;
+  for (int64_t i = 0; i < num_evicted; ++i) {
+    const int64_t slot = slots[i];
+    const int64_t key = slot_keys_[slot];
+    storage_index_[key] = {batch_offset + batch.size(), 0};
+    batch.append(reinterpret_cast<const char*>(&key), sizeof(key));
+    batch.append(reinterpret_cast<const char*>(SlotValues(slot)),
+                 options_.value_dim * sizeof(float));
+    memory_index_.erase(key);
+    free_slots_.push_back(slot);
+    if (batch.size() >= kLogBatchBytes || i == num_evicted - 1) {
+      TF_RETURN_IF_ERROR(log_writer_->Append(batch));
+      batch_offset += batch.size();
+      batch.clear();
+    }
+  }
+  TF_RETURN_IF_ERROR(log_writer_->Flush());
+  log_bytes_ = batch_offset;
+
+  // Age the rows that stay in memory.
+  for (size_t i = num_evicted; i < slots.size(); ++i) {
+    slot_freqs_[slots[i]] /= 2;
+  }
+  return MaybeCompact();
+}
+
+Status TieredEmbeddingVar::MaybeCompact() {
+  if (stale_log_bytes_ < kMinCompactionBytes ||
+      2 * stale_log_bytes_ < log_bytes_) {
+    return OkStatus();
+  }
+  // Copy the live records in log order, so that the old log is read
+  // sequentially.
+  std::vector<std::pair<uint64, int64_t>> live;
+  live.reserve(storage_index_.size());
+  for (const auto& key_and_row : storage_index_) {
+    live.emplace_back(key_and_row.second.offset, key_and_row.first);
+  }
+  std::sort(live.begin(), live.end());
+
+  const std::string compacted_path = strings::StrCat(storage_path_, ".tmp");
+  std::unique_ptr<WritableFile> compacted;
+  TF_RETURN_IF_ERROR(env_->NewWritableFile(compacted_path, &compacted));
+  std::string batch;
+  for (size_t i = 0; i < live.size(); ++i) {
+    StringPiece record;
+    TF_RETURN_IF_ERROR(log_reader_->Read(live[i].first, record_bytes(),
+                                         &record, scratch_.data()));
+    if (record.size() != record_bytes()) {
+      return errors::DataLoss("Truncated record at offset ", live[i].first,
+                              " of ", storage_path_);
+    }
+    batch.append(record.data(), record.size());
+    if (batch.size() >= kLogBatchBytes || i == live.size() - 1) {
+      TF_RETURN_IF_ERROR(compacted->Append(batch));
+      batch.clear();
+    }
+  }
+  TF_RETURN_IF_ERROR(compacted->Close());
+
+  log_reader_.reset();
+  TF_RETURN_IF_ERROR(log_writer_->Close());
+  log_writer_.reset();
+  TF_RETURN_IF_ERROR(env_->RenameFile(compacted_path, storage_path_));
+  TF_RETURN_IF_ERROR(env_->NewAppendableFile(storage_path_, &log_writer_));
+  TF_RETURN_IF_ERROR(env_->NewRandomAccessFile(storage_path_, &log_reader_));
+  for (size_t i = 0; i < live.size(); ++i) {
+    storage_index_[live[i].second].offset = i * record_bytes();
+  }
+  log_bytes_ = live.size() * record_bytes();
+  stale_log_bytes_ = 0;
+  return OkStatus();
+}
+
+Status TieredEmbeddingVar::Save(const std::string& tensor_name,
+                                BundleWriter* writer) {
+  mutex_lock l(mu_);
+  const std::string keys_name = strings::StrCat(tensor_name, "-keys");
+  const std::string values_name = strings::StrCat(tensor_name, "-values");
+  const std::string freqs_name = strings::StrCat(tensor_name, "-freqs");
+  const int64_t dim = options_.value_dim;
+  const int64_t num_rows = memory_index_.size() + storage_index_.size();
+  if (num_rows == 0) {
+    const Tensor no_ints(DT_INT64, TensorShape({0}));
+    TF_RETURN_IF_ERROR(writer->Add(keys_name, no_ints));
+    TF_RETURN_IF_ERROR(
+        writer->Add(values_name, Tensor(DT_FLOAT, TensorShape({0, dim}))));
+    return writer->Add(freqs_name, no_ints);
+  }
+
+  // The memory tier is saved first, then the storage tier.
+  auto memory_it = memory_index_.begin();
+  auto storage_it = storage_index_.begin();
+  for (int64_t start = 0; start < num_rows; start += kSliceRows) {
+    const int64_t rows = std::min(kSliceRows, num_rows - start);
+    Tensor keys(DT_INT64, TensorShape({rows}));
+    Tensor values(DT_FLOAT, TensorShape({rows, dim}));
+    Tensor freqs(DT_INT64, TensorShape({rows}));
+    for (int64_t i = 0; i < rows; ++i) {
+      float* row = values.flat<float>().data() + i * dim;
+      if (memory_it != memory_index_.end()) {
+        keys.flat<int64_t>()(i) = memory_it->first;
+        freqs.flat<int64_t>()(i) = slot_freqs_[memory_it->second];
+        std::copy_n(SlotValues(memory_it->second), dim, row);
+        ++memory_it;
+      } else {
+        keys.flat<int64_t>()(i) = storage_it->first;
+        freqs.flat<int64_t>()(i) = storage_it->second.freq;
+        TF_RETURN_IF_ERROR(
+            ReadStoredRow(storage_it->first, storage_it->second.offset, row));
+        ++storage_it;
+      }
+    }
+    TensorSlice slice(1);
+    slice.set_start(0, start);
+    slice.set_length(0, rows);
+    TF_RETURN_IF_ERROR(
+        writer->AddSlice(keys_name, TensorShape({num_rows}), slice, keys));
+    TF_RETURN_IF_ERROR(
+        writer->AddSlice(freqs_name, TensorShape({num_rows}), slice, freqs));
+    TensorSlice values_slice(2);
+    values_slice.set_start(0, start);
+    values_slice.set_length(0, rows);
+    TF_RETURN_IF_ERROR(writer->AddSlice(
+        values_name, TensorShape({num_rows, dim}), values_slice, values));
+  }
+  return OkStatus();
+}
+
+Status TieredEmbeddingVar::Restore(const std::string& tensor_name,
+                                   BundleReader* reader) {
+  mutex_lock l(mu_);
+  const std::string keys_name = strings::StrCat(tensor_name, "-keys");
+  const std::string values_name = strings::StrCat(tensor_name, "-values");
+  const std::string freqs_name = strings::StrCat(tensor_name, "-freqs");
+  const int64_t dim = options_.value_dim;
+  TensorShape keys_shape;
+  TF_RETURN_IF_ERROR(reader->LookupTensorShape(keys_name, &keys_shape));
+  TensorShape values_shape;
+  TF_RETURN_IF_ERROR(reader->LookupTensorShape(values_name, &values_shape));
+  if (keys_shape.dims() != 1 ||
+      values_shape != TensorShape({keys_shape.dim_size(0), dim})) {
+    return errors::InvalidArgument(
+        "Cannot restore ", tensor_name, " with keys of shape ",
+        keys_shape.DebugString(), " and values of shape ",
+        values_shape.DebugString(), " into a variable with value_dim ", dim);
+  }
+
+  TF_RETURN_IF_ERROR(Reset());
+  const int64_t num_rows = keys_shape.dim_size(0);
+  for (int64_t start = 0; start < num_rows; start += kSliceRows) {
+    const int64_t rows = std::min(kSliceRows, num_rows - start);
+    Tensor keys(DT_INT64, TensorShape({rows}));
+    Tensor values(DT_FLOAT, TensorShape({rows, dim}));
+    Tensor freqs(DT_INT64, TensorShape({rows}));
+    TensorSlice slice(1);
+    slice.set_start(0, start);
+    slice.set_length(0, rows);
+    TF_RETURN_IF_ERROR(reader->LookupSlice(keys_name, slice, &keys));
+    TF_RETURN_IF_ERROR(reader->LookupSlice(freqs_name, slice, &freqs));
+    TensorSlice values_slice(2);
+    values_slice.set_start(0, start);
+    values_slice.set_length(0, rows);
+    TF_RETURN_IF_ERROR(reader->LookupSlice(values_name, values_slice, &values));
+    for (int64_t i = 0; i < rows; ++i) {
+      const int64_t key = keys.flat<int64_t>()(i);
+      if (memory_index_.contains(key) || storage_index_.contains(key)) {
+        return errors::DataLoss("Duplicate key ", key, " in ", tensor_name);
+      }
+      const int64_t slot = AddToMemory(key, freqs.flat<int64_t>()(i));
+      std::copy_n(values.flat<float>().data() + i * dim, dim,
+                  SlotValues(slot));
+    }
+    TF_RETURN_IF_ERROR(MaybeEvict());
+  }
+  return OkStatus();
+}
+
+int64_t TieredEmbeddingVar::memory_size() {
+  mutex_lock l(mu_);
+  return memory_index_.size();
+}
+
+int64_t TieredEmbeddingVar::storage_size() {
+  mutex_lock l(mu_);
+  return storage_index_.size();
+}
+
+bool TieredEmbeddingVar::IsInMemory(int64_t key) {
+  mutex_lock l(mu_);
+  return memory_index_.contains(key);
+}
+
+std::string TieredEmbeddingVar::DebugString() const {
+  tf_shared_lock l(mu_);
+  return strings::StrCat("TieredEmbeddingVar(value_dim=", options_.value_dim,
+                         ", memory_rows=", memory_index_.size(),
+                         ", storage_rows=", storage_index_.size(), ")");
+}
+
+int64_t TieredEmbeddingVar::MemoryUsed() const {
+  tf_shared_lock l(mu_);
+  return values_.size() * sizeof(float) +
+         slot_keys_.size() * 2 * sizeof(int64_t) +
+         memory_index_.size() * 2 * sizeof(int64_t) +
+         storage_index_.size() * (sizeof(int64_t) + sizeof(StoredRow));
+}
+
+}  // namespace tensorflow
@@ -0,0 +1,178 @@
+/* Copyright 2022 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_CORE_KERNELS_TIERED_EMBEDDING_VAR_H_
+#define TENSORFLOW_CORE_KERNELS_TIERED_EMBEDDING_VAR_H_
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/types/span.h"
+#include "tensorflow/core/framework/resource_base.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/status.h"
+#include "tensorflow/core/platform/thread_annotations.h"
+#include "tensorflow/core/util/tensor_bundle/tensor_bundle.h"
+
+namespace tensorflow {
+
+// A float embedding table, keyed by int64 ids, that does not need to fit in
+// memory.
+//
+// Rows live in one of two tiers:
+//  - the memory tier, which holds at most `memory_capacity` rows in host
+//    memory, and
+//  - the storage tier, an append-only log of rows in a local file (typically
+//    on an SSD), indexed in memory by key.
+//
+// Every access to a row bumps its access count. When the memory tier
+// overflows, its least frequently accessed rows are appended to the log and
+// the counts of the remaining rows are halved, so that rows which stop being
+// accessed eventually cool down. A row in the storage tier is read directly
+// from the log until it has been accessed `promotion_threshold` times, at
+// which point it is promoted back to the memory tier. Writes always promote.
+// The log is rewritten without its superseded records once they make up most
+// of it.
+//
+// Rows that were never written read as the caller-provided default value.
+// The log only extends the memory of the process: it is deleted with the
+// variable, and the contents of the table are persisted by Save() and
+// Restore() instead.
+class TieredEmbeddingVar : public ResourceBase {
+ public:
+  struct Options {
+    // Number of elements of every row.
+    int64_t value_dim = 0;
+    // Maximum number of rows in the memory tier. If not positive, all rows
+    // stay in memory and no storage tier is created.
+    int64_t memory_capacity = 0;
+    // Directory in which the log of the storage tier is created. Required if
+    // `memory_capacity` is positive.
+    std::string storage_dir;
+    // Number of accesses while in the storage tier after which a row is
+    // promoted to the memory tier.
+    int64_t promotion_threshold = 2;
+  };
+
+  // Creates a variable named `name`. The name is only used to name the log
+  // of the storage tier.
+  static Status Create(Env* env, const Options& options,
+                       const std::string& name, TieredEmbeddingVar** var);
+
+  ~TieredEmbeddingVar() override;
+
+  int64_t value_dim() const { return options_.value_dim; }
+
+  // Copies the rows of `keys` to `values`, a `keys.size()` x `value_dim()`
+  // row-major buffer. `default_value` holds `value_dim()` elements.
+  Status Gather(absl::Span<const int64_t> keys, const float* default_value,
+                float* values);
+
+  // For every i, does rows[keys[i]] -= alpha * grad[i], where `grad` is a
+  // `keys.size()` x `value_dim()` row-major buffer. A row that was never
+  // written starts from `default_value`.
+  Status ApplyGradientDescent(float alpha, absl::Span<const int64_t> keys,
+                              const float* grad, const float* default_value);
+
+  // Writes all the rows under "<tensor_name>-keys", "<tensor_name>-values" and
+  // "<tensor_name>-freqs", in slices of bounded size so that the table never
+  // has to be materialized as a single tensor.
+  Status Save(const std::string& tensor_name, BundleWriter* writer);
+
+  // Replaces the contents of the variable with rows written by Save().
+  Status Restore(const std::string& tensor_name, BundleReader* reader);
+
+  // The number of rows in each tier.
+  int64_t memory_size();
+  int64_t storage_size();
+
+  // Returns true if the row of `key` is in the memory tier.
+  bool IsInMemory(int64_t key);
+
+  std::string DebugString() const override;
+  int64_t MemoryUsed() const override;
+
+ private:
+  // A row in the storage tier.
+  struct StoredRow {
+    // Offset of the latest record of the row in the log.
+    uint64 offset;
+    // Accesses since the row was demoted.
+    int64_t freq;
+  };
+
+  TieredEmbeddingVar(Env* env, const Options& options,
+                     const std::string& storage_path);
+
+  // Opens a new, empty log at `storage_path_`.
+  Status OpenStorage() TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+  // Drops all the rows.
+  Status Reset() TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+
+  // Returns a pointer to the row of `slot` in the memory tier.
+  float* SlotValues(int64_t slot) TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+    return values_.data() + slot * options_.value_dim;
+  }
+  // Adds a row for `key` to the memory tier and returns its slot.
+  int64_t AddToMemory(int64_t key, int64_t freq)
+      TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+  // Returns the slot of `key` in the memory tier, promoting or creating the
+  // row if needed.
+  Status FindOrAddToMemory(int64_t key, const float* default_value,
+                           int64_t* slot) TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+  // Reads the row stored at `offset` in the log into `values`.
+  Status ReadStoredRow(int64_t key, uint64 offset, float* values)
+      TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+  // Demotes rows until the memory tier is within capacity.
+  Status MaybeEvict() TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+  // Rewrites the log without its superseded records if they dominate it.
+  Status MaybeCompact() TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+
+  // Size of a record in the log: the key followed by the row.
+  int64_t record_bytes() const {
+    return sizeof(int64_t) + options_.value_dim * sizeof(float);
+  }
+
+  Env* const env_;
+  const Options options_;
+  const std::string storage_path_;
+
+  mutable mutex mu_;
+  // The memory tier. Rows are stored in slots of `values_`; a slot whose key
+  // is not in `memory_index_` is in `free_slots_`.
+  absl::flat_hash_map<int64_t, int64_t> memory_index_ TF_GUARDED_BY(mu_);
+  std::vector<float> values_ TF_GUARDED_BY(mu_);
+  std::vector<int64_t> slot_keys_ TF_GUARDED_BY(mu_);
+  std::vector<int64_t> slot_freqs_ TF_GUARDED_BY(mu_);
+  std::vector<int64_t> free_slots_ TF_GUARDED_BY(mu_);
+
+  // The storage tier.
+  absl::flat_hash_map<int64_t, StoredRow> storage_index_ TF_GUARDED_BY(mu_);
+  std::unique_ptr<WritableFile> log_writer_ TF_GUARDED_BY(mu_);
+  std::unique_ptr<RandomAccessFile> log_reader_ TF_GUARDED_BY(mu_);
+  // Bytes appended to the log, and how many of them are superseded.
+  uint64 log_bytes_ TF_GUARDED_BY(mu_) = 0;
+  uint64 stale_log_bytes_ TF_GUARDED_BY(mu_) = 0;
+  std::vector<char> scratch_ TF_GUARDED_BY(mu_);
+
+  TF_DISALLOW_COPY_AND_ASSIGN(TieredEmbeddingVar);
+};
+
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_KERNELS_TIERED_EMBEDDING_VAR_H_
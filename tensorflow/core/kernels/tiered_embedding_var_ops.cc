@@ -0,0 +1,223 @@
+/* Copyright 2022 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+// Kernels for TieredEmbeddingVar, declared in ops/resource_variable_ops.cc.
+
+#include "tensorflow/core/framework/op_kernel.h"
+#include "tensorflow/core/framework/resource_mgr.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_shape.h"
+#include "tensorflow/core/kernels/tiered_embedding_var.h"
+#include "tensorflow/core/platform/errors.h"
+#include "tensorflow/core/util/tensor_bundle/tensor_bundle.h"
+
+namespace tensorflow {
+
+namespace {
+
+// Checks that `default_value` is a row of `var`, and that `t` holds one row
+// for each of `indices`.
+Status ValidateRows(const TieredEmbeddingVar& var, const Tensor& indices,
+                    const Tensor& default_value, const Tensor* t) {
+  if (!TensorShapeUtils::IsVector(default_value.shape()) ||
+      default_value.dim_size(0) != var.value_dim()) {
+    return errors::InvalidArgument(
+        "default_value must be a vector of ", var.value_dim(),
+        " elements, got shape ", default_value.shape().DebugString());
+  }
+  if (t != nullptr) {
+    TensorShape expected = indices.shape();
+    expected.AddDim(var.value_dim());
+    if (t->shape() != expected) {
+      return errors::InvalidArgument("Expected rows of shape ",
+                                     expected.DebugString(), ", got ",
+                                     t->shape().DebugString());
+    }
+  }
+  return OkStatus();
+}
+
+// Checks the `prefix` and `tensor_name` inputs of the save and restore ops.
+Status ValidateCheckpointInputs(OpKernelContext* ctx) {
+  for (int i : {1, 2}) {
+    if (!TensorShapeUtils::IsScalar(ctx->input(i).shape())) {
+      return errors::InvalidArgument(
+          "Input ", i, " must be a scalar, got shape ",
+          ctx->input(i).shape().DebugString());
+    }
+  }
+  return OkStatus();
+}
+
+}  // namespace
+
+class TieredEmbeddingVarHandleOp : public OpKernel {
+ public:
+  explicit TieredEmbeddingVarHandleOp(OpKernelConstruction* ctx)
+      : OpKernel(ctx) {
+    OP_REQUIRES_OK(ctx, ctx->GetAttr("container", &container_));
+    OP_REQUIRES_OK(ctx, ctx->GetAttr("shared_name", &shared_name_));
+    if (shared_name_.empty()) shared_name_ = name();
+    OP_REQUIRES_OK(ctx, ctx->GetAttr("value_dim", &options_.value_dim));
+    OP_REQUIRES_OK(ctx,
+                   ctx->GetAttr("memory_capacity", &options_.memory_capacity));
+    OP_REQUIRES_OK(ctx, ctx->GetAttr("storage_dir", &options_.storage_dir));
+    OP_REQUIRES_OK(ctx, ctx->GetAttr("promotion_threshold",
+                                     &options_.promotion_threshold));
+  }
+
+  void Compute(OpKernelContext* ctx) override {
+    const ResourceHandle handle =
+        MakeResourceHandle<TieredEmbeddingVar>(ctx, container_, shared_name_);
+    TieredEmbeddingVar* var;
+    OP_REQUIRES_OK(ctx, LookupOrCreateResource<TieredEmbeddingVar>(
+                            ctx, handle, &var,
+                            [this, ctx](TieredEmbeddingVar** ret) {
+                              return TieredEmbeddingVar::Create(
+                                  ctx->env(), options_, shared_name_, ret);
+                            }));
+    var->Unref();
+    Tensor* output;
+    OP_REQUIRES_OK(ctx, ctx->allocate_output(0, TensorShape({}), &output));
+    output->scalar<ResourceHandle>()() = handle;
+  }
+
+ private:
+  std::string container_;
+  std::string shared_name_;
+  TieredEmbeddingVar::Options options_;
+};
+
+class TieredEmbeddingVarGatherOp : public OpKernel {
+ public:
+  explicit TieredEmbeddingVarGatherOp(OpKernelConstruction* ctx)
+      : OpKernel(ctx) {}
+
+  void Compute(OpKernelContext* ctx) override {
+    core::RefCountPtr<TieredEmbeddingVar> var;
+    OP_REQUIRES_OK(ctx, LookupResource(ctx, HandleFromInput(ctx, 0), &var));
+    const Tensor& indices = ctx->input(1);
+    const Tensor& default_value = ctx->input(2);
+    OP_REQUIRES_OK(ctx, ValidateRows(*var, indices, default_value, nullptr));
+    TensorShape output_shape = indices.shape();
+    output_shape.AddDim(var->value_dim());
+    Tensor* output;
+    OP_REQUIRES_OK(ctx, ctx->allocate_output(0, output_shape, &output));
+    OP_REQUIRES_OK(
+        ctx, var->Gather(absl::MakeConstSpan(indices.flat<int64_t>().data(),
+                                             indices.NumElements()),
+                         default_value.flat<float>().data(),
+                         output->flat<float>().data()));
+  }
+};
+
+class TieredEmbeddingVarSparseApplyGradientDescentOp : public OpKernel {
+ public:
+  explicit TieredEmbeddingVarSparseApplyGradientDescentOp(
+      OpKernelConstruction* ctx)
+      : OpKernel(ctx) {}
+
+  void Compute(OpKernelContext* ctx) override {
+    core::RefCountPtr<TieredEmbeddingVar> var;
+    OP_REQUIRES_OK(ctx, LookupResource(ctx, HandleFromInput(ctx, 0), &var));
+    const Tensor& alpha = ctx->input(1);
+    const Tensor& grad = ctx->input(2);
+    const Tensor& indices = ctx->input(3);
+    const Tensor& default_value = ctx->input(4);
+    OP_REQUIRES(ctx, TensorShapeUtils::IsScalar(alpha.shape()),
+                errors::InvalidArgument("alpha must be a scalar, got shape ",
+                                        alpha.shape().DebugString()));
+    OP_REQUIRES_OK(ctx, ValidateRows(*var, indices, default_value, &grad));
+    OP_REQUIRES_OK(ctx, var->ApplyGradientDescent(
+                            alpha.scalar<float>()(),
+                            absl::MakeConstSpan(indices.flat<int64_t>().data(),
+                                                indices.NumElements()),
+                            grad.flat<float>().data(),
+                            default_value.flat<float>().data()));
+  }
+};
+
+class TieredEmbeddingVarSizeOp : public OpKernel {
+ public:
+  explicit TieredEmbeddingVarSizeOp(OpKernelConstruction* ctx)
+      : OpKernel(ctx) {}
+
+  void Compute(OpKernelContext* ctx) override {
+    core::RefCountPtr<TieredEmbeddingVar> var;
+    OP_REQUIRES_OK(ctx, LookupResource(ctx, HandleFromInput(ctx, 0), &var));
+    Tensor* memory_size;
+    OP_REQUIRES_OK(ctx,
+                   ctx->allocate_output(0, TensorShape({}), &memory_size));
+    memory_size->scalar<int64_t>()() = var->memory_size();
+    Tensor* storage_size;
+    OP_REQUIRES_OK(ctx,
+                   ctx->allocate_output(1, TensorShape({}), &storage_size));
+    storage_size->scalar<int64_t>()() = var->storage_size();
+  }
+};
+
+// Saves the rows of a TieredEmbeddingVar to a bundle of its own at `prefix`,
+// which can then be merged with the other shards of a checkpoint by
+// MergeV2Checkpoints.
+class SaveTieredEmbeddingVarOp : public OpKernel {
+ public:
+  explicit SaveTieredEmbeddingVarOp(OpKernelConstruction* ctx)
+      : OpKernel(ctx) {}
+
+  void Compute(OpKernelContext* ctx) override {
+    OP_REQUIRES_OK(ctx, ValidateCheckpointInputs(ctx));
+    core::RefCountPtr<TieredEmbeddingVar> var;
+    OP_REQUIRES_OK(ctx, LookupResource(ctx, HandleFromInput(ctx, 0), &var));
+    const tstring& prefix = ctx->input(1).scalar<tstring>()();
+    const tstring& tensor_name = ctx->input(2).scalar<tstring>()();
+    BundleWriter writer(ctx->env(), prefix);
+    OP_REQUIRES_OK(ctx, writer.status());
+    OP_REQUIRES_OK(ctx, var->Save(tensor_name, &writer));
+    OP_REQUIRES_OK(ctx, writer.Finish());
+  }
+};
+
+class RestoreTieredEmbeddingVarOp : public OpKernel {
+ public:
+  explicit RestoreTieredEmbeddingVarOp(OpKernelConstruction* ctx)
+      : OpKernel(ctx) {}
+
+  void Compute(OpKernelContext* ctx) override {
+    OP_REQUIRES_OK(ctx, ValidateCheckpointInputs(ctx));
+    core::RefCountPtr<TieredEmbeddingVar> var;
+    OP_REQUIRES_OK(ctx, LookupResource(ctx, HandleFromInput(ctx, 0), &var));
+    const tstring& prefix = ctx->input(1).scalar<tstring>()();
+    const tstring& tensor_name = ctx->input(2).scalar<tstring>()();
+    BundleReader reader(ctx->env(), prefix);
+    OP_REQUIRES_OK(ctx, reader.status());
+    OP_REQUIRES_OK(ctx, var->Restore(tensor_name, &reader));
+  }
+};
+
+REGISTER_KERNEL_BUILDER(Name("TieredEmbeddingVarHandleOp").Device(DEVICE_CPU),
+                        TieredEmbeddingVarHandleOp);
+REGISTER_KERNEL_BUILDER(Name("TieredEmbeddingVarGather").Device(DEVICE_CPU),
+                        TieredEmbeddingVarGatherOp);
+REGISTER_KERNEL_BUILDER(
+    Name("TieredEmbeddingVarSparseApplyGradientDescent").Device(DEVICE_CPU),
+    TieredEmbeddingVarSparseApplyGradientDescentOp);
+REGISTER_KERNEL_BUILDER(Name("TieredEmbeddingVarSize").Device(DEVICE_CPU),
+                        TieredEmbeddingVarSizeOp);
+REGISTER_KERNEL_BUILDER(Name("SaveTieredEmbeddingVar").Device(DEVICE_CPU),
+                        SaveTieredEmbeddingVarOp);
+REGISTER_KERNEL_BUILDER(Name("RestoreTieredEmbeddingVar").Device(DEVICE_CPU),
+                        RestoreTieredEmbeddingVarOp);
+
+}  // namespace tensorflow
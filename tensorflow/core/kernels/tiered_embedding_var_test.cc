@@ -0,0 +1,170 @@
+/* Copyright 2022 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/kernels/tiered_embedding_var.h"
+
+#include <vector>
+
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/errors.h"
+#include "tensorflow/core/platform/path.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace {
+
+core::RefCountPtr<TieredEmbeddingVar> CreateVar(
+    const TieredEmbeddingVar::Options& options) {
+  TieredEmbeddingVar* var = nullptr;
+  TF_CHECK_OK(
+      TieredEmbeddingVar::Create(Env::Default(), options, "embedding", &var));
+  return core::RefCountPtr<TieredEmbeddingVar>(var);
+}
+
+TieredEmbeddingVar::Options TieredOptions(int64_t memory_capacity) {
+  TieredEmbeddingVar::Options options;
+  options.value_dim = 1;
+  options.memory_capacity = memory_capacity;
+  options.storage_dir = io::JoinPath(testing::TmpDir(), "tiered_embedding");
+  options.promotion_threshold = 2;
+  return options;
+}
+
+// Sets the row of every key in [begin, end) to the key.
+void SetRowsToKeys(TieredEmbeddingVar* var, int64_t begin, int64_t end) {
+  const float zero = 0;
+  for (int64_t key = begin; key < end; ++key) {
+    const float grad = -key;
+    TF_ASSERT_OK(var->ApplyGradientDescent(1, {key}, &grad, &zero));
+  }
+}
+
+float GatherOne(TieredEmbeddingVar* var, int64_t key) {
+  const float zero = 0;
+  float value;
+  TF_CHECK_OK(var->Gather({key}, &zero, &value));
+  return value;
+}
+
+TEST(TieredEmbeddingVarTest, MemoryOnly) {
+  TieredEmbeddingVar::Options options;
+  options.value_dim = 2;
+  auto var = CreateVar(options);
+
+  const float default_value[] = {0.5, 1.5};
+  std::vector<float> values(4);
+  TF_ASSERT_OK(var->Gather({1, 2}, default_value, values.data()));
+  EXPECT_EQ(std::vector<float>({0.5, 1.5, 0.5, 1.5}), values);
+  EXPECT_EQ(0, var->memory_size());
+
+  // Duplicate keys are applied in turn.
+  const float grad[] = {1, 1, 2, 2};
+  TF_ASSERT_OK(var->ApplyGradientDescent(1, {1, 1}, grad, default_value));
+  TF_ASSERT_OK(var->Gather({1, 2}, default_value, values.data()));
+  EXPECT_EQ(std::vector<float>({-2.5, -1.5, 0.5, 1.5}), values);
+  EXPECT_EQ(1, var->memory_size());
+  EXPECT_EQ(0, var->storage_size());
+}
+
+TEST(TieredEmbeddingVarTest, DemotesAndPromotes) {
+  auto var = CreateVar(TieredOptions(/*memory_capacity=*/10));
+  SetRowsToKeys(var.get(), 0, 20);
+  EXPECT_LE(var->memory_size(), 10);
+  EXPECT_EQ(20, var->memory_size() + var->storage_size());
+  for (int64_t key = 0; key < 20; ++key) {
+    EXPECT_EQ(key, GatherOne(var.get(), key));
+  }
+
+  // A row that keeps being accessed stays in memory.
+  for (int64_t key = 20; key < 30; ++key) {
+    SetRowsToKeys(var.get(), key, key + 1);
+    EXPECT_EQ(3, GatherOne(var.get(), 3));
+  }
+  EXPECT_TRUE(var->IsInMemory(3));
+  EXPECT_LE(var->memory_size(), 10);
+  EXPECT_EQ(30, var->memory_size() + var->storage_size());
+
+  // A cold row is promoted on its second access.
+  ASSERT_FALSE(var->IsInMemory(20));
+  EXPECT_EQ(20, GatherOne(var.get(), 20));
+  EXPECT_FALSE(var->IsInMemory(20));
+  EXPECT_EQ(20, GatherOne(var.get(), 20));
+  EXPECT_TRUE(var->IsInMemory(20));
+
+  // Writes promote, and keep the rows in the other tier intact.
+  for (int64_t key = 0; key < 30; ++key) {
+    const float zero = 0;
+    const float grad = 1;
+    TF_ASSERT_OK(var->ApplyGradientDescent(1, {key}, &grad, &zero));
+  }
+  for (int64_t key = 0; key < 30; ++key) {
+    EXPECT_EQ(key - 1, GatherOne(var.get(), key));
+  }
+}
+
+TEST(TieredEmbeddingVarTest, SaveAndRestore) {
+  auto var = CreateVar(TieredOptions(/*memory_capacity=*/4));
+  SetRowsToKeys(var.get(), 0, 10);
+  ASSERT_GT(var->storage_size(), 0);
+
+  const string prefix = io::JoinPath(testing::TmpDir(), "tiered_checkpoint");
+  {
+    BundleWriter writer(Env::Default(), prefix);
+    TF_ASSERT_OK(var->Save("embedding", &writer));
+    TF_ASSERT_OK(writer.Finish());
+  }
+
+  BundleReader reader(Env::Default(), prefix);
+  TF_ASSERT_OK(reader.status());
+  TieredEmbeddingVar::Options options;
+  options.value_dim = 1;
+  auto restored = CreateVar(options);
+  SetRowsToKeys(restored.get(), 100, 101);
+  TF_ASSERT_OK(restored->Restore("embedding", &reader));
+  EXPECT_EQ(10, restored->memory_size());
+  for (int64_t key = 0; key < 10; ++key) {
+    EXPECT_EQ(key, GatherOne(restored.get(), key));
+  }
+  // Rows that were not in the checkpoint are gone.
+  EXPECT_EQ(0, GatherOne(restored.get(), 100));
+
+  // Restoring into a tiered variable demotes the rows beyond the capacity.
+  auto tiered = CreateVar(TieredOptions(/*memory_capacity=*/4));
+  TF_ASSERT_OK(tiered->Restore("embedding", &reader));
+  EXPECT_LE(tiered->memory_size(), 4);
+  EXPECT_EQ(10, tiered->memory_size() + tiered->storage_size());
+  for (int64_t key = 0; key < 10; ++key) {
+    EXPECT_EQ(key, GatherOne(tiered.get(), key));
+  }
+
+  options.value_dim = 2;
+  auto wrong_dim = CreateVar(options);
+  EXPECT_TRUE(
+      errors::IsInvalidArgument(wrong_dim->Restore("embedding", &reader)));
+}
+
+TEST(TieredEmbeddingVarTest, InvalidOptions) {
+  TieredEmbeddingVar* var = nullptr;
+  TieredEmbeddingVar::Options options;
+  EXPECT_TRUE(errors::IsInvalidArgument(
+      TieredEmbeddingVar::Create(Env::Default(), options, "var", &var)));
+  options.value_dim = 4;
+  options.memory_capacity = 16;
+  EXPECT_TRUE(errors::IsInvalidArgument(
+      TieredEmbeddingVar::Create(Env::Default(), options, "var", &var)));
+}
+
+}  // namespace
+}  // namespace tensorflow
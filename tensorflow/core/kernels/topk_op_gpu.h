@@ -19,6 +19,7 @@ limitations under the License.
 
 #define EIGEN_USE_GPU
 
+#include <algorithm>
 #include <cmath>
 #include <string>
 #include <vector>
@@ -539,21 +540,407 @@ Status LaunchSortKernel(OpKernelContext* ctx, const T* input, int num_rows,
   return Status::OK();
 }
 
+// Radix-select TopK, for large rows and large k.
+//
+// The heap kernel above keeps k entries per thread in shared memory and the
+// sort kernel sorts whole rows, so both get slow when k is in the thousands
+// and rows have millions of entries.  Radix select instead finds the k-th
+// largest key of every row one 8-bit digit at a time, from the most
+// significant digit down: each pass builds a histogram of the current digit
+// over the keys that match the digits found so far, and picks the digit
+// under which the k-th largest key falls.  The keys above the k-th largest
+// one and the first of the keys equal to it then are gathered in index order,
+// and only those k survivors are sorted.  All rows are processed by the same
+// launches, so batches of rows don't run one after the other.
+
+constexpr int kRadixSelectBits = 8;
+constexpr int kRadixSelectBins = 1 << kRadixSelectBits;
+constexpr int kRadixSelectBlockSize = 256;
+
+template <int kSize>
+struct RadixSelectUnsignedBits;
+template <>
+struct RadixSelectUnsignedBits<1> {
+  typedef uint8 Type;
+};
+template <>
+struct RadixSelectUnsignedBits<2> {
+  typedef uint16 Type;
+};
+template <>
+struct RadixSelectUnsignedBits<4> {
+  typedef uint32 Type;
+};
+template <>
+struct RadixSelectUnsignedBits<8> {
+  typedef uint64 Type;
+};
+
+// Maps a value to an unsigned key with the same order, i.e. the order
+// gpuprim::DeviceSegmentedRadixSort sorts in.
+template <typename T>
+__device__ EIGEN_STRONG_INLINE uint64 RadixSelectKey(T value) {
+  typedef typename RadixSelectUnsignedBits<sizeof(T)>::Type Bits;
+  constexpr Bits kSignBit = Bits(1) << (sizeof(T) * 8 - 1);
+  const Bits bits = Eigen::numext::bit_cast<Bits>(value);
+  if (Eigen::NumTraits<T>::IsInteger) {
+    return Eigen::NumTraits<T>::IsSigned ? bits ^ kSignBit : bits;
+  }
+  // Negative floating point values are ordered by their inverted bits.
+  return (bits & kSignBit) ? Bits(~bits) : Bits(bits | kSignBit);
+}
+
+// Resets the selection state of every row: no digit of the k-th largest key
+// is known yet and all k entries remain to be found.  Templated on the
+// input type like the other kernels, since this header is compiled into one
+// .cu.cc file per type.
+template <typename T>
+__global__ void RadixSelectInitKernel(int num_rows, int k,
+                                      uint64* __restrict__ prefixes,
+                                      int* __restrict__ remaining,
+                                      int* __restrict__ histograms) {
+  for (int i : GpuGridRangeX(num_rows * kRadixSelectBins)) {
+    histograms[i] = 0;
+    if (i < num_rows) {
+      prefixes[i] = 0;
+      remaining[i] = k;
+    }
+  }
+}
+
+// Counts the digits at `shift` of the keys of each row that match the digits
+// of the k-th largest key found so far, i.e. the bits in `high_mask`.  Row
+// blockIdx.x is split over gridDim.y blocks.
+template <typename T>
+__global__ void RadixSelectHistogramKernel(const T* __restrict__ input,
+                                           int num_cols, int shift,
+                                           uint64 high_mask,
+                                           const uint64* __restrict__ prefixes,
+                                           int* __restrict__ histograms) {
+  __shared__ int histogram[kRadixSelectBins];
+  for (int i = threadIdx.x; i < kRadixSelectBins; i += blockDim.x) {
+    histogram[i] = 0;
+  }
+  __syncthreads();
+
+  const int row = blockIdx.x;
+  const T* row_input = input + static_cast<int64>(row) * num_cols;
+  const uint64 prefix = prefixes[row];
+  for (int i = blockIdx.y * blockDim.x + threadIdx.x; i < num_cols;
+       i += gridDim.y * blockDim.x) {
+    const uint64 key = RadixSelectKey(row_input[i]);
+    if ((key & high_mask) == prefix) {
+      atomicAdd(&histogram[(key >> shift) & (kRadixSelectBins - 1)], 1);
+    }
+  }
+  __syncthreads();
+
+  int* row_histogram = histograms + row * kRadixSelectBins;
+  for (int i = threadIdx.x; i < kRadixSelectBins; i += blockDim.x) {
+    if (histogram[i] > 0) {
+      atomicAdd(&row_histogram[i], histogram[i]);
+    }
+  }
+}
+
+// Picks the digit at `shift` of the k-th largest key of every row from the
+// histogram of the pass, and clears the histogram for the next pass.
+template <typename T>
+__global__ void RadixSelectUpdateKernel(int num_rows, int shift,
+                                        uint64* __restrict__ prefixes,
+                                        int* __restrict__ remaining,
+                                        int* __restrict__ histograms) {
+  for (int row : GpuGridRangeX(num_rows)) {
+    int* row_histogram = histograms + row * kRadixSelectBins;
+    int row_remaining = remaining[row];
+    int digit = kRadixSelectBins - 1;
+    for (; digit > 0; --digit) {
+      const int count = row_histogram[digit];
+      if (count >= row_remaining) break;
+      row_remaining -= count;
+    }
+    prefixes[row] |= static_cast<uint64>(digit) << shift;
+    remaining[row] = row_remaining;
+    for (int i = 0; i < kRadixSelectBins; ++i) row_histogram[i] = 0;
+  }
+}
+
+// Returns the part of a row that block blockIdx.y of the gather kernels
+// handles.
+__device__ EIGEN_STRONG_INLINE void RadixSelectChunk(int num_cols, int* begin,
+                                                     int* end) {
+  const int chunk_size = (num_cols + gridDim.y - 1) / gridDim.y;
+  *begin = min(num_cols, static_cast<int>(blockIdx.y) * chunk_size);
+  *end = min(num_cols, *begin + chunk_size);
+}
+
+// Counts the keys of each block's chunk that are greater than, and equal to,
+// the k-th largest key of the row.
+template <typename T>
+__global__ void RadixSelectCountKernel(const T* __restrict__ input,
+                                       int num_cols,
+                                       const uint64* __restrict__ prefixes,
+                                       int* __restrict__ block_counts) {
+  __shared__ int counts[2];
+  if (threadIdx.x < 2) counts[threadIdx.x] = 0;
+  __syncthreads();
+
+  const int row = blockIdx.x;
+  const T* row_input = input + static_cast<int64>(row) * num_cols;
+  const uint64 kth_key = prefixes[row];
+  int begin, end;
+  RadixSelectChunk(num_cols, &begin, &end);
+  int num_greater = 0;
+  int num_equal = 0;
+  for (int i = begin + threadIdx.x; i < end; i += blockDim.x) {
+    const uint64 key = RadixSelectKey(row_input[i]);
+    num_greater += key > kth_key;
+    num_equal += key == kth_key;
+  }
+  if (num_greater > 0) atomicAdd(&counts[0], num_greater);
+  if (num_equal > 0) atomicAdd(&counts[1], num_equal);
+  __syncthreads();
+
+  if (threadIdx.x < 2) {
+    block_counts[2 * (row * gridDim.y + blockIdx.y) + threadIdx.x] =
+        counts[threadIdx.x];
+  }
+}
+
+// Writes the k survivors of every row: the keys greater than the k-th largest
+// key in index order, followed by the lowest-index keys equal to it.  Ties
+// are broken towards lower indices like in the other kernels.
+template <typename T>
+__global__ void RadixSelectGatherKernel(const T* __restrict__ input,
+                                        int num_cols, int k,
+                                        const uint64* __restrict__ prefixes,
+                                        const int* __restrict__ remaining,
+                                        const int* __restrict__ block_counts,
+                                        T* __restrict__ output,
+                                        int* __restrict__ indices) {
+  typedef gpuprim::BlockScan<int, kRadixSelectBlockSize> BlockScan;
+  __shared__ typename BlockScan::TempStorage temp_storage;
+  __shared__ int offsets[2];
+
+  const int row = blockIdx.x;
+  const int* row_counts = block_counts + 2 * row * gridDim.y;
+  if (threadIdx.x < 2) {
+    int offset = 0;
+    for (int b = 0; b < static_cast<int>(blockIdx.y); ++b) {
+      offset += row_counts[2 * b + threadIdx.x];
+    }
+    offsets[threadIdx.x] = offset;
+  }
+  __syncthreads();
+
+  const T* row_input = input + static_cast<int64>(row) * num_cols;
+  T* row_output = output + static_cast<int64>(row) * k;
+  int* row_indices = indices + static_cast<int64>(row) * k;
+  const uint64 kth_key = prefixes[row];
+  const int num_equal_kept = remaining[row];
+  const int num_greater = k - num_equal_kept;
+  int greater_offset = offsets[0];
+  int equal_offset = offsets[1];
+  int begin, end;
+  RadixSelectChunk(num_cols, &begin, &end);
+  // The tiles are scanned in order, so positions follow the input order.
+  // Greater keys count in the low and equal keys in the high 16 bits, which
+  // can't overflow within a tile.
+  for (int tile = begin; tile < end; tile += kRadixSelectBlockSize) {
+    const int i = tile + threadIdx.x;
+    T value = T();
+    int flags = 0;
+    if (i < end) {
+      value = row_input[i];
+      const uint64 key = RadixSelectKey(value);
+      flags = key > kth_key ? 1 : (key == kth_key ? 1 << 16 : 0);
+    }
+    int rank, tile_count;
+    BlockScan(temp_storage).ExclusiveSum(flags, rank, tile_count);
+    if (flags == 1) {
+      const int pos = greater_offset + (rank & 0xffff);
+      row_output[pos] = value;
+      row_indices[pos] = i;
+    } else if (flags != 0) {
+      const int equal_rank = equal_offset + (rank >> 16);
+      if (equal_rank < num_equal_kept) {
+        row_output[num_greater + equal_rank] = value;
+        row_indices[num_greater + equal_rank] = i;
+      }
+    }
+    greater_offset += tile_count & 0xffff;
+    equal_offset += tile_count >> 16;
+    // The temp storage is reused by the next tile.
+    __syncthreads();
+  }
+}
+
+// Sorts the k survivors of every row in descending order.  The radix sort is
+// stable, so equal values stay in index order.
+template <typename T>
+Status SortRadixSelectSurvivors(OpKernelContext* ctx, const T* values_in,
+                                const int* indices_in, int num_rows, int k,
+                                T* values_out, int* indices_out) {
+  const auto& cu_stream = GetGpuStream(ctx);
+  gpuprim::CountingInputIterator<int> counting_iter(0);
+  gpuprim::TransformInputIterator<int, SegmentOffsetCreator,
+                                  gpuprim::CountingInputIterator<int>>
+      segment_offsets_t(counting_iter, SegmentOffsetCreator(k));
+  size_t temp_storage_bytes = 0;
+  auto err = gpuprim::DeviceSegmentedRadixSort::SortPairsDescending(
+      /* d_temp_storage */ nullptr,
+      /* temp_storage_bytes */ temp_storage_bytes,
+      /* d_keys_in */ values_in,
+      /* d_keys_out */ values_out,
+      /* d_values_in */ indices_in,
+      /* d_values_out */ indices_out,
+      /* num_items */ k * num_rows,
+      /* num_segments */ num_rows,
+      /* d_begin_offsets */ segment_offsets_t,
+      /* d_end_offsets */ segment_offsets_t + 1,
+      /* begin_bit */ 0,
+      /* end_bit */ sizeof(T) * 8,
+      /* stream */ cu_stream);
+  if (err != cudaSuccess) {
+    return errors::Internal(
+        "TopKOp: Could not launch "
+        "gpuprim::DeviceSegmentedRadixSort::SortPairsDescending to calculate "
+        "temp_storage_bytes, status: ",
+        cudaGetErrorString(err));
+  }
+  Tensor temp_storage;
+  TF_RETURN_IF_ERROR(ctx->allocate_temp(
+      DT_INT8, TensorShape({static_cast<int64_t>(temp_storage_bytes)}),
+      &temp_storage));
+  err = gpuprim::DeviceSegmentedRadixSort::SortPairsDescending(
+      /* d_temp_storage */ temp_storage.flat<int8>().data(),
+      /* temp_storage_bytes */ temp_storage_bytes,
+      /* d_keys_in */ values_in,
+      /* d_keys_out */ values_out,
+      /* d_values_in */ indices_in,
+      /* d_values_out */ indices_out,
+      /* num_items */ k * num_rows,
+      /* num_segments */ num_rows,
+      /* d_begin_offsets */ segment_offsets_t,
+      /* d_end_offsets */ segment_offsets_t + 1,
+      /* begin_bit */ 0,
+      /* end_bit */ sizeof(T) * 8,
+      /* stream */ cu_stream);
+  if (err != cudaSuccess) {
+    return errors::Internal(
+        "TopKOp: Could not launch "
+        "gpuprim::DeviceSegmentedRadixSort::SortPairsDescending to sort the "
+        "top k entries, temp_storage_bytes: ",
+        temp_storage_bytes, ", status: ", cudaGetErrorString(err));
+  }
+  return Status::OK();
+}
+
+template <typename T>
+Status LaunchRadixSelectKernel(OpKernelContext* ctx, const T* input,
+                               int num_rows, int num_cols, int k, bool sorted,
+                               typename TTypes<T, 2>::Tensor values,
+                               TTypes<int, 2>::Tensor indices) {
+  const GPUDevice& d = ctx->eigen_device<GPUDevice>();
+
+  Tensor prefixes;
+  TF_RETURN_IF_ERROR(
+      ctx->allocate_temp(DT_UINT64, TensorShape({num_rows}), &prefixes));
+  Tensor remaining;
+  TF_RETURN_IF_ERROR(
+      ctx->allocate_temp(DT_INT32, TensorShape({num_rows}), &remaining));
+  Tensor histograms;
+  TF_RETURN_IF_ERROR(ctx->allocate_temp(
+      DT_INT32, TensorShape({num_rows, kRadixSelectBins}), &histograms));
+  uint64* prefixes_ptr = prefixes.flat<uint64>().data();
+  int* remaining_ptr = remaining.flat<int32>().data();
+  int* histograms_ptr = histograms.flat<int32>().data();
+
+  // Split each row over enough blocks to fill the device, with at least 16
+  // entries per thread.
+  const int max_blocks = 4 * d.getNumGpuMultiProcessors();
+  const int blocks_per_row = std::max(
+      1, std::min(Eigen::divup(num_cols, 16 * kRadixSelectBlockSize),
+                  max_blocks / num_rows));
+  const dim3 grid(num_rows, blocks_per_row);
+
+  GpuLaunchConfig config = GetGpuLaunchConfig(num_rows * kRadixSelectBins, d);
+  TF_RETURN_IF_ERROR(GpuLaunchKernel(RadixSelectInitKernel<T>,
+                                     config.block_count,
+                                     config.thread_per_block, 0, d.stream(),
+                                     num_rows, k, prefixes_ptr, remaining_ptr,
+                                     histograms_ptr));
+  constexpr int kKeyBits = sizeof(T) * 8;
+  GpuLaunchConfig update_config = GetGpuLaunchConfig(num_rows, d);
+  for (int shift = kKeyBits - kRadixSelectBits; shift >= 0;
+       shift -= kRadixSelectBits) {
+    const int high_shift = shift + kRadixSelectBits;
+    const uint64 high_mask = high_shift >= 64 ? 0 : ~uint64{0} << high_shift;
+    TF_RETURN_IF_ERROR(GpuLaunchKernel(
+        RadixSelectHistogramKernel<T>, grid, kRadixSelectBlockSize, 0,
+        d.stream(), input, num_cols, shift, high_mask, prefixes_ptr,
+        histograms_ptr));
+    TF_RETURN_IF_ERROR(GpuLaunchKernel(
+        RadixSelectUpdateKernel<T>, update_config.block_count,
+        update_config.thread_per_block, 0, d.stream(), num_rows, shift,
+        prefixes_ptr, remaining_ptr, histograms_ptr));
+  }
+
+  Tensor block_counts;
+  TF_RETURN_IF_ERROR(ctx->allocate_temp(
+      DT_INT32, TensorShape({num_rows, blocks_per_row, 2}), &block_counts));
+  int* block_counts_ptr = block_counts.flat<int32>().data();
+  TF_RETURN_IF_ERROR(GpuLaunchKernel(RadixSelectCountKernel<T>, grid,
+                                     kRadixSelectBlockSize, 0, d.stream(),
+                                     input, num_cols, prefixes_ptr,
+                                     block_counts_ptr));
+
+  if (!sorted) {
+    return GpuLaunchKernel(RadixSelectGatherKernel<T>, grid,
+                           kRadixSelectBlockSize, 0, d.stream(), input,
+                           num_cols, k, prefixes_ptr, remaining_ptr,
+                           block_counts_ptr, values.data(), indices.data());
+  }
+  Tensor survivor_values;
+  TF_RETURN_IF_ERROR(ctx->allocate_temp(
+      DataTypeToEnum<T>::value, TensorShape({num_rows, k}), &survivor_values));
+  Tensor survivor_indices;
+  TF_RETURN_IF_ERROR(ctx->allocate_temp(
+      DT_INT32, TensorShape({num_rows, k}), &survivor_indices));
+  TF_RETURN_IF_ERROR(GpuLaunchKernel(
+      RadixSelectGatherKernel<T>, grid, kRadixSelectBlockSize, 0, d.stream(),
+      input, num_cols, k, prefixes_ptr, remaining_ptr, block_counts_ptr,
+      survivor_values.flat<T>().data(), survivor_indices.flat<int32>().data()));
+  return SortRadixSelectSurvivors(ctx, survivor_values.flat<T>().data(),
+                                  survivor_indices.flat<int32>().data(),
+                                  num_rows, k, values.data(), indices.data());
+}
+
 }  // end namespace impl
 
 namespace functor {
 
 template <typename T>
 struct TopKFunctor<GPUDevice, T> {
+  static constexpr int kRadixSelectMinK = 100;
+  static constexpr int kRadixSelectMinCols = 1 << 15;
+
   static EIGEN_ALWAYS_INLINE Status
   Compute(OpKernelContext* context, bool sorted, int k,
           const typename TTypes<T, 2>::ConstTensor& input, const int64 num_rows,
           const int64 num_cols, typename TTypes<T, 2>::Tensor values,
           typename TTypes<int, 2>::Tensor indices) {
     // For small k, use the heap implementation.  For larger k, use
-    // the in-place gpuprim sort.  For k == num_cols, always use the
+    // the in-place gpuprim sort, or radix select if the rows are long and k
+    // is well below their length.  For k == num_cols, always use the
     // in-place gpuprim sort.  The thresholds for n and k were determined
     // empirically.
+    if (k >= kRadixSelectMinK && num_cols >= kRadixSelectMinCols &&
+        k <= num_cols / 4) {
+      return impl::LaunchRadixSelectKernel(context, input.data(), num_rows,
+                                           num_cols, k, sorted, values,
+                                           indices);
+    }
     if (num_cols <= 1000 || k == num_cols || k >= 100) {
       return impl::LaunchSortKernel(context, input.data(), num_rows, num_cols,
                                     k, values, indices);
@@ -15,10 +15,20 @@ limitations under the License.
 
 #include "tensorflow/core/kernels/training_op_helpers.h"
 
+#include "tensorflow/core/lib/hash/hash.h"
 #include "tensorflow/core/util/ptr_util.h"
 
 namespace tensorflow {
 
+mutex* SparseUpdateRowLock(const void* var_data, int64_t row) {
+  // Rows of different variables may share a lock, which only costs some
+  // contention.
+  static constexpr int kNumRowLocks = 1024;
+  static mutex* row_locks = new mutex[kNumRowLocks];
+  const uint64 h = Hash64Combine(reinterpret_cast<uintptr_t>(var_data), row);
+  return &row_locks[h % kNumRowLocks];
+}
+
 
 void MaybeForwardRefInputToRefOutput(OpKernelContext* ctx, int input,
                                      int output) {
@@ -16,12 +16,19 @@ limitations under the License.
 #ifndef TENSORFLOW_CORE_KERNELS_TRAINING_OP_HELPERS_H_
 #define TENSORFLOW_CORE_KERNELS_TRAINING_OP_HELPERS_H_
 
+#include <vector>
+
+#include "absl/container/flat_hash_map.h"
+#include "tensorflow/core/framework/bounds_check.h"
 #include "tensorflow/core/framework/op_kernel.h"
 #include "tensorflow/core/framework/tensor.h"
 #include "tensorflow/core/framework/variant_op_registry.h"
 #include "tensorflow/core/kernels/dense_update_functor.h"
 #include "tensorflow/core/kernels/variable_ops.h"
 #include "tensorflow/core/lib/core/refcount.h"
+#include "tensorflow/core/lib/strings/strcat.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/util/work_sharder.h"
 
 namespace tensorflow {
 
@@ -252,6 +259,101 @@ Status GetInputTensorFromVariable(OpKernelContext* ctx, int input,
   return OkStatus();
 }
 
+// Deduplicates the sparse gradient with rows `grad` of `inner_dim` elements
+// at the row indices `indices`, by adding up the rows with equal indices in
+// the order of their offsets.  Sets `*unique_indices` to the distinct indices
+// in order of first occurrence and `*unique_grad` to a [num_unique,
+// inner_dim] matrix of the matching rows, which shares the buffer of `grad`
+// if there are no duplicates.  Fails if an index is not in
+// [0, first_dim_size).
+template <typename T, typename Tindex>
+Status DeduplicateSparseGradient(OpKernelContext* ctx, const Tensor& grad,
+                                 const Tensor& indices, int64_t inner_dim,
+                                 int64_t first_dim_size,
+                                 std::vector<Tindex>* unique_indices,
+                                 Tensor* unique_grad) {
+  const auto indices_vec = indices.vec<Tindex>();
+  const int64_t N = indices_vec.dimension(0);
+  // `slots[i]` is the position of `indices(i)` in `unique_indices`.
+  std::vector<int64_t> slots(N);
+  absl::flat_hash_map<Tindex, int64_t> positions;
+  positions.reserve(N);
+  unique_indices->clear();
+  for (int64_t i = 0; i < N; ++i) {
+    const Tindex index = internal::SubtleMustCopy(indices_vec(i));
+    if (!FastBoundsCheck(index, first_dim_size)) {
+      return errors::InvalidArgument(strings::StrCat(
+          "Index ", index, " at offset ", i, " in indices is out of range"));
+    }
+    auto it = positions.emplace(index, unique_indices->size());
+    if (it.second) unique_indices->push_back(index);
+    slots[i] = it.first->second;
+  }
+  const int64_t num_unique = unique_indices->size();
+  if (num_unique == N) {
+    return unique_grad->BitcastFrom(grad, grad.dtype(),
+                                    TensorShape({N, inner_dim}));
+  }
+
+  // Group the offsets of each unique index, in increasing order, so that every
+  // unique row is summed by one thread in a deterministic order.
+  std::vector<int64_t> starts(num_unique + 1, 0);
+  for (int64_t i = 0; i < N; ++i) ++starts[slots[i] + 1];
+  for (int64_t j = 0; j < num_unique; ++j) starts[j + 1] += starts[j];
+  std::vector<int64_t> offsets(N);
+  {
+    std::vector<int64_t> next(starts.begin(), starts.end() - 1);
+    for (int64_t i = 0; i < N; ++i) offsets[next[slots[i]]++] = i;
+  }
+
+  TF_RETURN_IF_ERROR(ctx->allocate_temp(
+      DataTypeToEnum<T>::value, TensorShape({num_unique, inner_dim}),
+      unique_grad));
+  const auto grad_flat = grad.shaped<T, 2>({N, inner_dim});
+  auto unique_flat = unique_grad->matrix<T>();
+  auto worker_threads = ctx->device()->tensorflow_cpu_worker_threads();
+  Shard(worker_threads->num_threads, worker_threads->workers, num_unique,
+        /*cost_per_unit=*/inner_dim * (N / num_unique),
+        [&](int64_t begin, int64_t end) {
+          for (int64_t j = begin; j < end; ++j) {
+            auto row = unique_flat.template chip<0>(j);
+            row = grad_flat.template chip<0>(offsets[starts[j]]);
+            for (int64_t k = starts[j] + 1; k < starts[j + 1]; ++k) {
+              row += grad_flat.template chip<0>(offsets[k]);
+            }
+          }
+        });
+  return OkStatus();
+}
+
+// Returns one of a fixed set of locks that serialize updates of row `row` of
+// the variable whose buffer is `var_data`, for sparse updates that hold the
+// variable's lock in shared mode and only lock the rows they update.
+mutex* SparseUpdateRowLock(const void* var_data, int64_t row);
+
+// Calls `update(j, rows[j])` for every j on the intra-op thread pool of `ctx`.
+// `rows` must be distinct rows of `var`, so that the calls don't race with
+// each other.  If `lock_rows` is true, every call holds the lock of its row
+// to serialize it with concurrent updates of the same row by other kernels.
+template <typename Tindex, typename Fn>
+void ParallelUpdateSparseRows(OpKernelContext* ctx, const Tensor& var,
+                              const std::vector<Tindex>& rows, bool lock_rows,
+                              int64_t cost_per_row, Fn update) {
+  const void* var_data = var.tensor_data().data();
+  auto worker_threads = ctx->device()->tensorflow_cpu_worker_threads();
+  Shard(worker_threads->num_threads, worker_threads->workers, rows.size(),
+        cost_per_row, [&](int64_t begin, int64_t end) {
+          for (int64_t j = begin; j < end; ++j) {
+            if (lock_rows) {
+              mutex_lock l(*SparseUpdateRowLock(var_data, rows[j]));
+              update(j, rows[j]);
+            } else {
+              update(j, rows[j]);
+            }
+          }
+        });
+}
+
 }  // end namespace tensorflow
 
 #endif  // TENSORFLOW_CORE_KERNELS_TRAINING_OP_HELPERS_H_
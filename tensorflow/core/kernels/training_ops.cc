@@ -17,6 +17,7 @@ limitations under the License.
 #include "tensorflow/core/kernels/training_ops.h"
 
 #include <algorithm>  // NOLINT
+#include <vector>
 
 #include "tensorflow/core/framework/bounds_check.h"
 #include "tensorflow/core/framework/op_kernel.h"
@@ -2014,12 +2015,22 @@ class SparseApplyAdagradV2Op : public OpKernel {
   explicit SparseApplyAdagradV2Op(OpKernelConstruction* ctx) : OpKernel(ctx) {
     OP_REQUIRES_OK(ctx, ctx->GetAttr("use_locking", &use_exclusive_lock_));
     OP_REQUIRES_OK(ctx, ctx->GetAttr("update_slots", &update_slots_));
+    if (ctx->HasAttr("deduplicate_indices")) {
+      OP_REQUIRES_OK(
+          ctx, ctx->GetAttr("deduplicate_indices", &deduplicate_indices_));
+    }
+    OP_REQUIRES(ctx,
+                !deduplicate_indices_ || std::is_same<Device, CPUDevice>::value,
+                errors::InvalidArgument(
+                    "deduplicate_indices is only supported on CPU"));
   }
 
   void Compute(OpKernelContext* ctx) override TF_NO_THREAD_SAFETY_ANALYSIS {
     const bool sparse = true;
+    // Deduplicated updates only hold the variables' locks in shared mode, and
+    // lock the rows they update instead.
     auto locks = MaybeLockVariableInputMutexesInOrder<Device, T>(
-        ctx, use_exclusive_lock_, sparse, {0, 1});
+        ctx, use_exclusive_lock_ && !deduplicate_indices_, sparse, {0, 1});
     Tensor var;
     OP_REQUIRES_OK(ctx, GetInputTensorFromVariable<Device, T>(
                             ctx, 0, use_exclusive_lock_, sparse, &var));
@@ -2072,6 +2083,12 @@ class SparseApplyAdagradV2Op : public OpKernel {
                 errors::InvalidArgument(
                     "Inner dimension should be greater than zero."));
 
+    if (deduplicate_indices_) {
+      ApplyDeduplicated(ctx, &var, &accum, lr, epsilon, grad, indices,
+                        inner_dim);
+      return;
+    }
+
     const Device& device = ctx->template eigen_device<Device>();
     OP_REQUIRES_OK(
         ctx, functor::SparseApplyAdagrad<Device, T, Tindex,
@@ -2084,8 +2101,40 @@ class SparseApplyAdagradV2Op : public OpKernel {
   }
 
  private:
+  // Adds up the gradient rows of duplicate indices, then updates each unique
+  // row once, in parallel.
+  void ApplyDeduplicated(OpKernelContext* ctx, Tensor* var, Tensor* accum,
+                         const Tensor& lr,
+                         const Tensor& epsilon, const Tensor& grad,
+                         const Tensor& indices, int64_t inner_dim) {
+    std::vector<Tindex> unique_indices;
+    Tensor unique_grad;
+    OP_REQUIRES_OK(ctx, DeduplicateSparseGradient<T, Tindex>(
+                            ctx, grad, indices, inner_dim, var->dim_size(0),
+                            &unique_indices, &unique_grad));
+    auto var_flat = var->shaped<T, 2>({var->dim_size(0), inner_dim});
+    auto accum_flat = accum->shaped<T, 2>({var->dim_size(0), inner_dim});
+    const auto grad_flat = unique_grad.matrix<T>();
+    const T lr_scalar = lr.scalar<T>()();
+    const T epsilon_scalar = epsilon.scalar<T>()();
+    const int64_t cost_per_row = inner_dim * 10;
+    ParallelUpdateSparseRows(
+        ctx, *var, unique_indices, use_exclusive_lock_, cost_per_row,
+        [&](int64_t j, Tindex index) {
+          auto a = accum_flat.template chip<0>(index);
+          auto g = grad_flat.template chip<0>(j);
+          auto v = var_flat.template chip<0>(index);
+          if (update_slots_) {
+            a += g.square();
+          }
+          v -= g.constant(lr_scalar) * g /
+               (a.sqrt() + a.constant(epsilon_scalar));
+        });
+  }
+
   bool use_exclusive_lock_;
   bool update_slots_;
+  bool deduplicate_indices_ = false;
 };
 
 #define REGISTER_KERNELS(D, T, Tindices)                                   \
@@ -3654,6 +3703,150 @@ REGISTER_KERNELS(GPU, complex128);
 #undef REGISTER_CPU_KERNELS
 #undef REGISTER_KERNELS
 
+// Applies Adam to the rows of `var` that have a gradient, adding up the
+// gradient rows of duplicate indices first.  Unique rows are updated in
+// parallel, each holding its row lock if `use_locking` is set.
+template <typename T, typename Tindex>
+class SparseApplyAdamOp : public OpKernel {
+ public:
+  explicit SparseApplyAdamOp(OpKernelConstruction* ctx) : OpKernel(ctx) {
+    OP_REQUIRES_OK(ctx, ctx->GetAttr("use_locking", &use_locking_));
+  }
+
+  void Compute(OpKernelContext* ctx) override TF_NO_THREAD_SAFETY_ANALYSIS {
+    const bool sparse = true;
+    // The variables are only locked in shared mode; row locks serialize
+    // concurrent updates of the same rows.
+    auto locks = MaybeLockVariableInputMutexesInOrder<CPUDevice, T>(
+        ctx, /*do_lock=*/false, sparse, {0, 1, 2});
+    Tensor var;
+    OP_REQUIRES_OK(ctx, GetInputTensorFromVariable<CPUDevice, T>(
+                            ctx, 0, /*lock_held=*/false, sparse, &var));
+    Tensor m;
+    OP_REQUIRES_OK(ctx, GetInputTensorFromVariable<CPUDevice, T>(
+                            ctx, 1, /*lock_held=*/false, sparse, &m));
+    Tensor v;
+    OP_REQUIRES_OK(ctx, GetInputTensorFromVariable<CPUDevice, T>(
+                            ctx, 2, /*lock_held=*/false, sparse, &v));
+    OP_REQUIRES(
+        ctx, var.IsInitialized(),
+        errors::FailedPrecondition(
+            "Attempting to use uninitialized variables: ", requested_input(0)));
+    OP_REQUIRES(
+        ctx, m.IsInitialized(),
+        errors::FailedPrecondition(
+            "Attempting to use uninitialized variables: ", requested_input(1)));
+    OP_REQUIRES(
+        ctx, v.IsInitialized(),
+        errors::FailedPrecondition(
+            "Attempting to use uninitialized variables: ", requested_input(2)));
+    OP_REQUIRES(ctx, var.shape().IsSameSize(m.shape()),
+                errors::InvalidArgument("var and m do not have the same shape",
+                                        var.shape().DebugString(), " ",
+                                        m.shape().DebugString()));
+    OP_REQUIRES(ctx, var.shape().IsSameSize(v.shape()),
+                errors::InvalidArgument("var and v do not have the same shape",
+                                        var.shape().DebugString(), " ",
+                                        v.shape().DebugString()));
+    OP_REQUIRES(ctx, TensorShapeUtils::IsVectorOrHigher(var.shape()),
+                errors::InvalidArgument("var must be at least 1 dimensional"));
+
+    const Tensor& beta1_power = ctx->input(3);
+    const Tensor& beta2_power = ctx->input(4);
+    const Tensor& lr = ctx->input(5);
+    const Tensor& beta1 = ctx->input(6);
+    const Tensor& beta2 = ctx->input(7);
+    const Tensor& epsilon = ctx->input(8);
+    OP_REQUIRES(ctx, TensorShapeUtils::IsScalar(beta1_power.shape()),
+                errors::InvalidArgument("beta1_power is not a scalar: ",
+                                        beta1_power.shape().DebugString()));
+    OP_REQUIRES(ctx, TensorShapeUtils::IsScalar(beta2_power.shape()),
+                errors::InvalidArgument("beta2_power is not a scalar: ",
+                                        beta2_power.shape().DebugString()));
+    OP_REQUIRES(ctx, TensorShapeUtils::IsScalar(lr.shape()),
+                errors::InvalidArgument("lr is not a scalar : ",
+                                        lr.shape().DebugString()));
+    OP_REQUIRES(ctx, TensorShapeUtils::IsScalar(beta1.shape()),
+                errors::InvalidArgument("beta1 is not a scalar: ",
+                                        beta1.shape().DebugString()));
+    OP_REQUIRES(ctx, TensorShapeUtils::IsScalar(beta2.shape()),
+                errors::InvalidArgument("beta2 is not a scalar: ",
+                                        beta2.shape().DebugString()));
+    OP_REQUIRES(ctx, TensorShapeUtils::IsScalar(epsilon.shape()),
+                errors::InvalidArgument("epsilon is not a scalar: ",
+                                        epsilon.shape().DebugString()));
+
+    const Tensor& grad = ctx->input(9);
+    const Tensor& indices = ctx->input(10);
+    OP_REQUIRES(ctx, TensorShapeUtils::IsVector(indices.shape()),
+                errors::InvalidArgument("indices must be one-dimensional"));
+    OP_REQUIRES(
+        ctx, grad.dims() == var.dims(),
+        errors::InvalidArgument("var and grad must have the same rank"));
+    int64_t inner_dim = 1;
+    for (int d = 1; d < var.dims(); d++) {
+      OP_REQUIRES(ctx, var.dim_size(d) == grad.dim_size(d),
+                  errors::InvalidArgument(strings::StrCat(
+                      "var and grad must match in dimension ", d)));
+      inner_dim *= grad.dim_size(d);
+    }
+    OP_REQUIRES(
+        ctx, grad.dim_size(0) == indices.dim_size(0),
+        errors::InvalidArgument(
+            "grad must be the same size as indices in the first dimension."));
+    if (indices.NumElements() == 0 || inner_dim == 0) return;
+
+    std::vector<Tindex> unique_indices;
+    Tensor unique_grad;
+    OP_REQUIRES_OK(ctx, DeduplicateSparseGradient<T, Tindex>(
+                            ctx, grad, indices, inner_dim, var.dim_size(0),
+                            &unique_indices, &unique_grad));
+
+    const int64_t first_dim = var.dim_size(0);
+    auto var_flat = var.shaped<T, 2>({first_dim, inner_dim});
+    auto m_flat = m.shaped<T, 2>({first_dim, inner_dim});
+    auto v_flat = v.shaped<T, 2>({first_dim, inner_dim});
+    const auto grad_flat = unique_grad.matrix<T>();
+    const T beta1_scalar = beta1.scalar<T>()();
+    const T beta2_scalar = beta2.scalar<T>()();
+    const T epsilon_scalar = epsilon.scalar<T>()();
+    const T alpha =
+        lr.scalar<T>()() *
+        Eigen::numext::sqrt(T(1) - beta2_power.scalar<T>()()) /
+        (T(1) - beta1_power.scalar<T>()());
+    const int64_t cost_per_row = inner_dim * 20;
+    ParallelUpdateSparseRows(
+        ctx, var, unique_indices, use_locking_, cost_per_row,
+        [&](int64_t j, Tindex index) {
+          auto g = grad_flat.template chip<0>(j);
+          auto m_row = m_flat.template chip<0>(index);
+          auto v_row = v_flat.template chip<0>(index);
+          auto var_row = var_flat.template chip<0>(index);
+          m_row += (g - m_row) * (T(1) - beta1_scalar);
+          v_row += (g.square() - v_row) * (T(1) - beta2_scalar);
+          var_row -= (m_row * alpha) / (v_row.sqrt() + epsilon_scalar);
+        });
+  }
+
+ private:
+  bool use_locking_;
+};
+
+#define REGISTER_KERNELS(T, Tindices)                                \
+  REGISTER_KERNEL_BUILDER(Name("ResourceSparseApplyAdam")            \
+                              .Device(DEVICE_CPU)                    \
+                              .TypeConstraint<T>("T")                \
+                              .TypeConstraint<Tindices>("Tindices"), \
+                          SparseApplyAdamOp<T, Tindices>);
+#define REGISTER_CPU_KERNELS(T) \
+  REGISTER_KERNELS(T, int32);   \
+  REGISTER_KERNELS(T, int64_t);
+
+TF_CALL_FLOAT_TYPES(REGISTER_CPU_KERNELS);
+
+#undef REGISTER_CPU_KERNELS
+#undef REGISTER_KERNELS
+
 template <typename Device, typename T>
 class ApplyAdamWithAmsgradOp : public OpKernel {
  public:
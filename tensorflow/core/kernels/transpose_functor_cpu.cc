@@ -16,6 +16,9 @@ limitations under the License.
 #define EIGEN_USE_THREADS
 
 #include <complex>
+#include <functional>
+#include <memory>
+#include <utility>
 
 #include "third_party/eigen3/unsupported/Eigen/CXX11/Tensor"
 #include "tensorflow/core/framework/attr_value.pb.h"
@@ -25,6 +28,12 @@ limitations under the License.
 #include "tensorflow/core/lib/core/status.h"
 #include "tensorflow/core/lib/gtl/array_slice.h"
 #include "tensorflow/core/lib/gtl/inlined_vector.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/platform.h"
+
+#if !defined(IS_MOBILE_PLATFORM)
+#include "tensorflow/compiler/xla/pjrt/transpose.h"
+#endif  // !defined(IS_MOBILE_PLATFORM)
 
 typedef Eigen::ThreadPoolDevice CPUDevice;
 
@@ -68,12 +77,57 @@ void TransposeSimple(const CPUDevice& device, const Tensor& in,
   device.parallelFor(in.NumElements(), cost, std::move(transpose_fn));
 }
 
+#if !defined(IS_MOBILE_PLATFORM)
+// Smaller transposes are left to Eigen, since looking up a plan costs about as
+// much as moving this many elements.
+constexpr int64_t kMinTransposePlanElements = 4096;
+
+// Transposes 'in' with an xla::TransposePlan, which blocks the loops over the
+// permuted dimensions for the caches and moves the innermost blocks with SIMD
+// microkernels.  Plans are cached by shape, permutation, element size and
+// number of threads.  Returns false if there is no plan for 'in'.
+template <typename T>
+bool TransposeUsingPlan(const CPUDevice& device, const Tensor& in,
+                        const gtl::ArraySlice<int32> perm, Tensor* out) {
+  static constexpr int kPlanCacheCapacity = 64;
+  static mutex* mu = new mutex;
+  static xla::TransposePlanCache* cache =
+      new xla::TransposePlanCache(kPlanCacheCapacity);
+
+  const gtl::InlinedVector<int64_t, 4> dims = in.shape().dim_sizes();
+  gtl::InlinedVector<int64_t, 8> permutation(perm.begin(), perm.end());
+  std::shared_ptr<xla::TransposePlan> plan;
+  {
+    mutex_lock l(*mu);
+    auto plan_or = cache->GetOrCreate(
+        sizeof(T), dims, permutation,
+        /*input_layout=*/xla::TransposePlan::Tiling{},
+        /*output_tiling=*/xla::TransposePlan::Tiling{},
+        xla::TransposePlan::Transformation::kNone, device.numThreads());
+    if (!plan_or.ok()) return false;
+    plan = std::move(plan_or).value();
+  }
+  plan->Execute(in.data(), out->data(),
+                [&device](std::function<void()> fn) {
+                  device.enqueueNoNotification(std::move(fn));
+                });
+  return true;
+}
+#endif  // !defined(IS_MOBILE_PLATFORM)
+
 }  // namespace
 
 template <typename T, bool conjugate>
 struct Transpose<CPUDevice, T, conjugate> {
   static void run(const CPUDevice& d, const Tensor& in,
                   const gtl::ArraySlice<int32> perm, Tensor* out) {
+#if !defined(IS_MOBILE_PLATFORM)
+    // The plans only move elements, so conjugation is left to Eigen.
+    if (!conjugate && in.NumElements() >= kMinTransposePlanElements &&
+        TransposeUsingPlan<T>(d, in, perm, out)) {
+      return;
+    }
+#endif  // !defined(IS_MOBILE_PLATFORM)
     switch (in.dims()) {
       case 2:
         internal::TransposeUsingEigen<CPUDevice, T, 2>(d, in, perm, conjugate,
@@ -14,8 +14,10 @@ limitations under the License.
 ==============================================================================*/
 
 #include <functional>
+#include <type_traits>
 #include <unordered_map>
 #include <utility>
+#include <vector>
 
 #include "absl/container/flat_hash_map.h"
 #include "tensorflow/core/framework/bounds_check.h"
@@ -26,6 +28,7 @@ limitations under the License.
 #include "tensorflow/core/lib/core/status.h"
 #include "tensorflow/core/lib/hash/hash.h"
 #include "tensorflow/core/platform/bfloat16.h"
+#include "tensorflow/core/util/work_sharder.h"
 
 namespace tensorflow {
 namespace {
@@ -68,6 +71,193 @@ struct UniqueOpHashMap<bfloat16, TIndex> {
   using map_type = std::unordered_map<bfloat16, TIndex>;
 };
 
+// Vectors with fewer elements are uniquified on the calling thread, since
+// partitioning them costs more than building a single hash map.
+constexpr int64_t kParallelUniqueMinElements = 64 * 1024;
+
+// Returns the partition of an element with hash `h`.  The hash is scrambled
+// first because some hashers, e.g. `std::hash<Eigen::half>`, return the raw
+// bits of the value.
+inline int UniquePartition(size_t h, int num_partitions) {
+  const uint64 scrambled = static_cast<uint64>(h) * 0x9E3779B97F4A7C15ULL;
+  return static_cast<int>((scrambled >> 32) % num_partitions);
+}
+
+// Uniquifies the elements of the vector `Tin` using the intra-op thread pool,
+// and allocates and fills output 0.  The outputs are identical to those of the
+// single-threaded implementation: unique elements appear in the order of
+// their first occurrence.
+//
+// The elements are split into partitions by hash, so that equal elements end
+// up in the same partition, and every partition is uniquified by a separate
+// thread with its own hash map.  The first occurrences found by all
+// partitions are then renumbered in input order with a prefix sum.
+template <typename T, typename TIndex>
+void ParallelUnique(OpKernelContext* context, const Tensor& input,
+                    int64_t axis, typename TTypes<TIndex>::Vec idx_vec,
+                    int64_t* uniq_size) {
+  using map_type = typename UniqueOpHashMap<T, TIndex>::map_type;
+  using key_type = typename map_type::key_type;
+  auto Tin = input.flat<T>();
+  const int64_t N = static_cast<int64_t>(Tin.size());
+  auto worker_threads = context->device()->tensorflow_cpu_worker_threads();
+  const int num_parts = worker_threads->num_threads;
+  const int64_t block_size = (N + num_parts - 1) / num_parts;
+  const int64_t cost_per_block = block_size * 10;
+
+  // `buckets[b * num_parts + p]` holds the positions of the elements of input
+  // block `b` that belong to partition `p`, in increasing order.
+  std::vector<std::vector<int32>> buckets(num_parts * num_parts);
+  Shard(num_parts, worker_threads->workers, num_parts, cost_per_block,
+        [&](int64_t start, int64_t limit) {
+          typename map_type::hasher hasher;
+          for (int64_t b = start; b < limit; ++b) {
+            std::vector<int32>* block_buckets = &buckets[b * num_parts];
+            const int64_t end = std::min(N, (b + 1) * block_size);
+            for (int64_t i = b * block_size; i < end; ++i) {
+              const int p = UniquePartition(hasher(key_type(Tin(i))),
+                                            num_parts);
+              block_buckets[p].push_back(static_cast<int32>(i));
+            }
+          }
+        });
+
+  // `first[i]` is the position of the first element equal to element `i`.
+  // Visiting the blocks of a partition in order finds the first occurrence of
+  // every element before its repetitions.
+  std::vector<int32> first(N);
+  Shard(num_parts, worker_threads->workers, num_parts, cost_per_block,
+        [&](int64_t start, int64_t limit) {
+          for (int64_t p = start; p < limit; ++p) {
+            size_t part_size = 0;
+            for (int b = 0; b < num_parts; ++b) {
+              part_size += buckets[b * num_parts + p].size();
+            }
+            map_type uniq;
+            uniq.reserve(part_size);
+            for (int b = 0; b < num_parts; ++b) {
+              for (const int32 i : buckets[b * num_parts + p]) {
+                first[i] = uniq.emplace(Tin(i), i).first->second;
+              }
+            }
+          }
+        });
+  buckets.clear();
+
+  // Number the first occurrences in input order.
+  std::vector<int64_t> block_offsets(num_parts + 1, 0);
+  Shard(num_parts, worker_threads->workers, num_parts, cost_per_block,
+        [&](int64_t start, int64_t limit) {
+          for (int64_t b = start; b < limit; ++b) {
+            const int64_t end = std::min(N, (b + 1) * block_size);
+            int64_t count = 0;
+            for (int64_t i = b * block_size; i < end; ++i) {
+              count += (first[i] == i);
+            }
+            block_offsets[b + 1] = count;
+          }
+        });
+  for (int b = 0; b < num_parts; ++b) {
+    block_offsets[b + 1] += block_offsets[b];
+  }
+  *uniq_size = block_offsets[num_parts];
+
+  TensorShape output_shape(input.shape());
+  output_shape.set_dim(axis, *uniq_size);
+  Tensor* output = nullptr;
+  OP_REQUIRES_OK(context, context->allocate_output(0, output_shape, &output));
+  auto Tout = output->flat<T>();
+  Shard(num_parts, worker_threads->workers, num_parts, cost_per_block,
+        [&](int64_t start, int64_t limit) {
+          for (int64_t b = start; b < limit; ++b) {
+            const int64_t end = std::min(N, (b + 1) * block_size);
+            TIndex j = static_cast<TIndex>(block_offsets[b]);
+            for (int64_t i = b * block_size; i < end; ++i) {
+              if (first[i] == i) {
+                Tout(j) = Tin(i);
+                idx_vec(i) = j++;
+              }
+            }
+          }
+        });
+  // Repetitions only read the indices of first occurrences, which are all
+  // set by now.
+  Shard(num_parts, worker_threads->workers, num_parts, cost_per_block,
+        [&](int64_t start, int64_t limit) {
+          for (int64_t b = start; b < limit; ++b) {
+            const int64_t end = std::min(N, (b + 1) * block_size);
+            for (int64_t i = b * block_size; i < end; ++i) {
+              if (first[i] != i) idx_vec(i) = idx_vec(first[i]);
+            }
+          }
+        });
+}
+
+// Uniquifies the integer vector `Tin` with a least-significant-digit radix
+// sort, and allocates and fills output 0 with the unique elements in
+// ascending order.  Unlike hashing, the cost doesn't depend on the number of
+// unique elements, and the outputs don't depend on the order of the input.
+template <typename T, typename TIndex>
+void SortedUnique(OpKernelContext* context, const Tensor& input,
+                  typename TTypes<TIndex>::Vec idx_vec, int64_t* uniq_size) {
+  static_assert(std::is_same<T, int32>::value ||
+                    std::is_same<T, int64_t>::value,
+                "SortedUnique only supports int32 and int64.");
+  using U = typename std::make_unsigned<T>::type;
+  constexpr int kRadixBits = 8;
+  constexpr int kRadix = 1 << kRadixBits;
+  // Flipping the sign bit makes the unsigned order match the signed order.
+  constexpr U kSignBit = U{1} << (sizeof(U) * 8 - 1);
+
+  auto Tin = input.flat<T>();
+  const int64_t N = static_cast<int64_t>(Tin.size());
+  std::vector<U> keys(N), sorted_keys(N);
+  std::vector<int32> positions(N), sorted_positions(N);
+  for (int64_t i = 0; i < N; ++i) {
+    keys[i] = static_cast<U>(Tin(i)) ^ kSignBit;
+    positions[i] = static_cast<int32>(i);
+  }
+  constexpr int kKeyBits = sizeof(U) * 8;
+  for (int shift = 0; shift < kKeyBits; shift += kRadixBits) {
+    int64_t offsets[kRadix] = {0};
+    for (int64_t i = 0; i < N; ++i) {
+      ++offsets[(keys[i] >> shift) & (kRadix - 1)];
+    }
+    // Digits shared by all elements don't reorder anything.
+    if (N == 0 || offsets[(keys[0] >> shift) & (kRadix - 1)] == N) continue;
+    int64_t sum = 0;
+    for (int d = 0; d < kRadix; ++d) {
+      const int64_t count = offsets[d];
+      offsets[d] = sum;
+      sum += count;
+    }
+    for (int64_t i = 0; i < N; ++i) {
+      const int64_t dst = offsets[(keys[i] >> shift) & (kRadix - 1)]++;
+      sorted_keys[dst] = keys[i];
+      sorted_positions[dst] = positions[i];
+    }
+    keys.swap(sorted_keys);
+    positions.swap(sorted_positions);
+  }
+
+  int64_t num_unique = 0;
+  for (int64_t i = 0; i < N; ++i) {
+    if (i == 0 || keys[i] != keys[i - 1]) ++num_unique;
+  }
+  *uniq_size = num_unique;
+  Tensor* output = nullptr;
+  OP_REQUIRES_OK(context, context->allocate_output(
+                              0, TensorShape({num_unique}), &output));
+  auto Tout = output->flat<T>();
+  TIndex j = -1;
+  for (int64_t i = 0; i < N; ++i) {
+    if (i == 0 || keys[i] != keys[i - 1]) {
+      Tout(++j) = static_cast<T>(keys[i] ^ kSignBit);
+    }
+    idx_vec(positions[i]) = j;
+  }
+}
+
 // `UniqueOp` computes the unique elements in the input tensor.
 //
 // * `T` is the element type.
@@ -76,7 +266,19 @@ struct UniqueOpHashMap<bfloat16, TIndex> {
 template <typename T, typename TIndex>
 class UniqueOp : public OpKernel {
  public:
-  explicit UniqueOp(OpKernelConstruction* context) : OpKernel(context) {}
+  explicit UniqueOp(OpKernelConstruction* context) : OpKernel(context) {
+    if (context->HasAttr("sort_output")) {
+      OP_REQUIRES_OK(context, context->GetAttr("sort_output", &sort_output_));
+    }
+    if (sort_output_) {
+      OP_REQUIRES(
+          context,
+          std::is_same<T, int32>::value || std::is_same<T, int64_t>::value,
+          errors::InvalidArgument("sort_output requires int32 or int64 "
+                                  "elements, but got ",
+                                  DataTypeString(DataTypeToEnum<T>::v())));
+    }
+  }
 
   void Compute(OpKernelContext* context) override {
     const Tensor& input = context->input(0);
@@ -143,7 +345,21 @@ class UniqueOp : public OpKernel {
     auto idx_vec = idx->template vec<TIndex>();
 
     int64_t uniq_size;
-    if (new_sizes[0] == 1 && new_sizes[2] == 1) {
+    if constexpr (std::is_same<T, int32>::value ||
+                  std::is_same<T, int64_t>::value) {
+      if (sort_output_) {
+        SortedUnique<T, TIndex>(context, input, idx_vec, &uniq_size);
+        if (!context->status().ok()) return;
+        CountUniqueElements(context, idx_vec, uniq_size);
+        return;
+      }
+    }
+    if (new_sizes[0] == 1 && new_sizes[2] == 1 &&
+        new_sizes[1] >= kParallelUniqueMinElements &&
+        context->device()->tensorflow_cpu_worker_threads()->num_threads > 1) {
+      ParallelUnique<T, TIndex>(context, input, axis, idx_vec, &uniq_size);
+      if (!context->status().ok()) return;
+    } else if (new_sizes[0] == 1 && new_sizes[2] == 1) {
       // Specialized and faster implementation when unique is run over single
       // elements. Here we put T directly into the map rather than ints pointing
       // to them as in the general case.
@@ -225,6 +441,14 @@ class UniqueOp : public OpKernel {
       }
     }
 
+    CountUniqueElements(context, idx_vec, uniq_size);
+  }
+
+ private:
+  // Allocates and fills the counts output of UniqueWithCounts{,V2}.
+  void CountUniqueElements(OpKernelContext* context,
+                           typename TTypes<TIndex>::Vec idx_vec,
+                           int64_t uniq_size) {
     if (num_outputs() > 2) {
       Tensor* output = nullptr;
       OP_REQUIRES_OK(context, context->allocate_output(
@@ -237,6 +461,8 @@ class UniqueOp : public OpKernel {
       }
     }
   }
+
+  bool sort_output_ = false;
 };
 
 #define REGISTER_UNIQUE(type)                                      \
@@ -14,11 +14,16 @@ limitations under the License.
 ==============================================================================*/
 
 #include <functional>
+#include <limits>
 #include <memory>
+#include <unordered_map>
 
 #include "tensorflow/core/common_runtime/kernel_benchmark_testlib.h"
+#include "tensorflow/core/framework/fake_input.h"
+#include "tensorflow/core/framework/node_def_builder.h"
 #include "tensorflow/core/framework/tensor.h"
 #include "tensorflow/core/framework/tensor.pb.h"
+#include "tensorflow/core/framework/tensor_testutil.h"
 #include "tensorflow/core/framework/tensor_shape.pb.h"
 #include "tensorflow/core/framework/types.h"
 #include "tensorflow/core/framework/types.pb.h"
@@ -28,6 +33,8 @@ limitations under the License.
 #include "tensorflow/core/kernels/ops_testutil.h"
 #include "tensorflow/core/kernels/ops_util.h"
 #include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/lib/hash/hash.h"
+#include "tensorflow/core/lib/strings/strcat.h"
 #include "tensorflow/core/platform/test.h"
 #include "tensorflow/core/platform/test_benchmark.h"
 
@@ -37,6 +44,111 @@ namespace {
 
 const int kMaxStrLen = 40;
 
+class UniqueOpTest : public OpsTestBase {
+ protected:
+  Status MakeOp(const string& op, DataType dtype, bool sort_output) {
+    TF_RETURN_IF_ERROR(NodeDefBuilder("unique", op)
+                           .Input(FakeInput(dtype))
+                           .Attr("out_idx", DT_INT64)
+                           .Attr("sort_output", sort_output)
+                           .Finalize(node_def()));
+    return InitOp();
+  }
+
+  // Checks the outputs against unique elements in order of first occurrence.
+  template <typename T>
+  void ExpectFirstOccurrenceOrder(const std::vector<T>& x) {
+    std::unordered_map<T, int64_t> ids;
+    std::vector<T> y;
+    std::vector<int64_t> idx, count;
+    for (const T& v : x) {
+      auto it = ids.emplace(v, y.size());
+      if (it.second) {
+        y.push_back(v);
+        count.push_back(0);
+      }
+      idx.push_back(it.first->second);
+      ++count[it.first->second];
+    }
+    const int64_t n = x.size();
+    const int64_t num_unique = y.size();
+    test::ExpectTensorEqual<T>(*GetOutput(0),
+                               test::AsTensor<T>(y, TensorShape({num_unique})));
+    test::ExpectTensorEqual<int64_t>(
+        *GetOutput(1), test::AsTensor<int64_t>(idx, TensorShape({n})));
+    if (context_->num_outputs() > 2) {
+      test::ExpectTensorEqual<int64_t>(
+          *GetOutput(2),
+          test::AsTensor<int64_t>(count, TensorShape({num_unique})));
+    }
+  }
+};
+
+// Large enough to be uniquified by multiple threads.
+constexpr int kLargeDim = 200 * 1000;
+
+TEST_F(UniqueOpTest, LargeInt64) {
+  TF_ASSERT_OK(MakeOp("UniqueWithCounts", DT_INT64, false));
+  std::vector<int64_t> x(kLargeDim);
+  for (int i = 0; i < kLargeDim; ++i) {
+    x[i] = (static_cast<int64_t>(i) * 7919 % 4999 - 2000) << 33;
+  }
+  AddInputFromArray<int64_t>(TensorShape({kLargeDim}), x);
+  TF_ASSERT_OK(RunOpKernel());
+  ExpectFirstOccurrenceOrder(x);
+}
+
+TEST_F(UniqueOpTest, LargeString) {
+  TF_ASSERT_OK(MakeOp("Unique", DT_STRING, false));
+  std::vector<tstring> x(kLargeDim);
+  for (int i = 0; i < kLargeDim; ++i) {
+    x[i] = strings::StrCat("id_", i * 104729 % 30011);
+  }
+  AddInputFromArray<tstring>(TensorShape({kLargeDim}), x);
+  TF_ASSERT_OK(RunOpKernel());
+  ExpectFirstOccurrenceOrder(x);
+}
+
+TEST_F(UniqueOpTest, SortOutputInt32) {
+  TF_ASSERT_OK(MakeOp("UniqueWithCounts", DT_INT32, true));
+  const int32 kMin = std::numeric_limits<int32>::min();
+  const int32 kMax = std::numeric_limits<int32>::max();
+  AddInputFromArray<int32>(TensorShape({10}),
+                           {4, 5, 1, -2, 3, 3, 4, kMax, kMin, 5});
+  TF_ASSERT_OK(RunOpKernel());
+  test::ExpectTensorEqual<int32>(
+      *GetOutput(0), test::AsTensor<int32>({kMin, -2, 1, 3, 4, 5, kMax}));
+  test::ExpectTensorEqual<int64_t>(
+      *GetOutput(1),
+      test::AsTensor<int64_t>({4, 5, 2, 1, 3, 3, 4, 6, 0, 5}));
+  test::ExpectTensorEqual<int64_t>(
+      *GetOutput(2), test::AsTensor<int64_t>({1, 1, 1, 2, 2, 2, 1}));
+}
+
+TEST_F(UniqueOpTest, SortOutputInt64) {
+  TF_ASSERT_OK(MakeOp("Unique", DT_INT64, true));
+  std::vector<int64_t> x(kLargeDim);
+  for (int i = 0; i < kLargeDim; ++i) {
+    x[i] = (static_cast<int64_t>(i) * 7919 % 4999 - 2000) << 33;
+  }
+  AddInputFromArray<int64_t>(TensorShape({kLargeDim}), x);
+  TF_ASSERT_OK(RunOpKernel());
+  const Tensor& y = *GetOutput(0);
+  const Tensor& idx = *GetOutput(1);
+  ASSERT_EQ(4999, y.NumElements());
+  for (int i = 1; i < y.NumElements(); ++i) {
+    EXPECT_LT(y.vec<int64_t>()(i - 1), y.vec<int64_t>()(i));
+  }
+  for (int i = 0; i < kLargeDim; ++i) {
+    EXPECT_EQ(x[i], y.vec<int64_t>()(idx.vec<int64_t>()(i)));
+  }
+}
+
+TEST_F(UniqueOpTest, SortOutputRequiresIntegers) {
+  Status s = MakeOp("Unique", DT_FLOAT, true);
+  EXPECT_TRUE(errors::IsInvalidArgument(s)) << s;
+}
+
 TensorProto GetRandomInt32TensorProto(int dim, int max_int) {
   TensorProto tensor_proto;
   tensor_proto.set_dtype(DT_INT32);
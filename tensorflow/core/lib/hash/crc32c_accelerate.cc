@@ -16,35 +16,40 @@ limitations under the License.
 #include <stddef.h>
 #include <stdint.h>
 
-// SSE4.2 accelerated CRC32c.
-
-// See if the SSE4.2 crc32c instruction is available.
-#undef USE_SSE_CRC32C
-#ifdef __SSE4_2__
-#if defined(__x86_64__) && defined(__GNUC__) && \
-    (__GNUC__ > 4 || (__GNUC__ == 4 && __GNUC_MINOR__ >= 8))
-#define USE_SSE_CRC32C 1
-#elif defined(__x86_64__) && defined(__clang__)
-#if __has_builtin(__builtin_cpu_supports)
-#define USE_SSE_CRC32C 1
+// Hardware accelerated CRC32c, using the SSE4.2 crc32 instruction on x86-64
+// CPUs that support it, or the ARMv8 CRC32 extension when the build targets
+// it.
+//
+// The x86-64 code is compiled for SSE4.2 regardless of the build flags and
+// only runs if the CPU supports it.
+
+#undef USE_HW_CRC32C
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+#define USE_HW_CRC32C 1
+#define CRC32C_TARGET __attribute__((target("sse4.2")))
+#elif defined(__aarch64__) && defined(__ARM_FEATURE_CRC32)
+#define USE_HW_CRC32C 1
+#define CRC32C_TARGET
 #endif
-#endif
-#endif /* __SSE4_2__ */
 
 // This version of Apple clang has a bug:
 // https://llvm.org/bugs/show_bug.cgi?id=25510
 #if defined(__APPLE__) && (__clang_major__ <= 8)
-#undef USE_SSE_CRC32C
+#undef USE_HW_CRC32C
 #endif
 
-#ifdef USE_SSE_CRC32C
+#ifdef USE_HW_CRC32C
+#if defined(__x86_64__)
 #include <nmmintrin.h>
+#else
+#include <arm_acle.h>
+#endif
 #endif
 
 namespace tensorflow {
 namespace crc32c {
 
-#ifndef USE_SSE_CRC32C
+#ifndef USE_HW_CRC32C
 
 bool CanAccelerate() { return false; }
 uint32_t AcceleratedExtend(uint32_t crc, const char *buf, size_t size) {
@@ -54,43 +59,158 @@ uint32_t AcceleratedExtend(uint32_t crc, const char *buf, size_t size) {
 
 #else
 
-// SSE4.2 optimized crc32c computation.
-bool CanAccelerate() { return __builtin_cpu_supports("sse4.2"); }
+namespace {
 
-uint32_t AcceleratedExtend(uint32_t crc, const char *buf, size_t size) {
-  const uint8_t *p = reinterpret_cast<const uint8_t *>(buf);
-  const uint8_t *e = p + size;
-  uint32_t l = crc ^ 0xffffffffu;
-
-  // Advance p until aligned to 8-bytes..
-  // Point x at first 7-byte aligned byte in string.  This might be
-  // just past the end of the string.
-  const uintptr_t pval = reinterpret_cast<uintptr_t>(p);
-  const uint8_t *x = reinterpret_cast<const uint8_t *>(((pval + 7) >> 3) << 3);
-  if (x <= e) {
-    // Process bytes until finished or p is 8-byte aligned
-    while (p != x) {
-      l = _mm_crc32_u8(l, *p);
-      p++;
+#if defined(__x86_64__)
+CRC32C_TARGET inline uint32_t Crc8(uint32_t crc, uint8_t v) {
+  return _mm_crc32_u8(crc, v);
+}
+CRC32C_TARGET inline uint64_t Crc64(uint64_t crc, uint64_t v) {
+  return _mm_crc32_u64(crc, v);
+}
+#else
+inline uint32_t Crc8(uint32_t crc, uint8_t v) { return __crc32cb(crc, v); }
+inline uint64_t Crc64(uint64_t crc, uint64_t v) {
+  return __crc32cd(static_cast<uint32_t>(crc), v);
+}
+#endif
+
+// The crc instructions have a latency of several cycles, but can start every
+// cycle.  Buffers are therefore processed in blocks of three streams of
+// kLongStream or kShortStream bytes, whose CRCs are computed independently
+// and combined at the end of the block.
+constexpr size_t kLongStream = 8192;
+constexpr size_t kShortStream = 256;
+
+// Tables that shift a CRC over a fixed number of zero bytes, i.e. that
+// calculate the CRC of concat(A, zeros) from the CRC of A.  The shift is
+// linear over GF(2), so it is applied one byte of the CRC at a time.
+class ZerosTable {
+ public:
+  explicit ZerosTable(size_t num_zeros) {
+    uint32_t op[32];
+    ZerosOperator(num_zeros, op);
+    for (uint32_t n = 0; n < 256; ++n) {
+      for (int i = 0; i < 4; ++i) table_[i][n] = MatrixTimes(op, n << (8 * i));
+    }
+  }
+
+  uint32_t Shift(uint32_t crc) const {
+    return table_[0][crc & 0xff] ^ table_[1][(crc >> 8) & 0xff] ^
+           table_[2][(crc >> 16) & 0xff] ^ table_[3][crc >> 24];
+  }
+
+ private:
+  // Multiplies the 32x32 matrix "mat" over GF(2) with the vector "vec".
+  static uint32_t MatrixTimes(const uint32_t *mat, uint32_t vec) {
+    uint32_t sum = 0;
+    for (; vec != 0; vec >>= 1, ++mat) {
+      if (vec & 1) sum ^= *mat;
     }
+    return sum;
   }
 
-  // Process bytes 16 at a time
-  uint64_t l64 = l;
-  while ((e - p) >= 16) {
-    l64 = _mm_crc32_u64(l64, *reinterpret_cast<const uint64_t *>(p));
-    l64 = _mm_crc32_u64(l64, *reinterpret_cast<const uint64_t *>(p + 8));
-    p += 16;
+  static void MatrixSquare(const uint32_t *mat, uint32_t *square) {
+    for (int n = 0; n < 32; ++n) square[n] = MatrixTimes(mat, mat[n]);
   }
 
-  // Process remaining bytes one at a time.
-  l = l64;
-  while (p < e) {
-    l = _mm_crc32_u8(l, *p);
-    p++;
+  // Sets "op" to the operator that shifts a CRC over "num_zeros" zero bytes.
+  // REQUIRES: "num_zeros" is a power of two.
+  static void ZerosOperator(size_t num_zeros, uint32_t *op) {
+    // The operator for one zero bit.
+    uint32_t odd[32];
+    odd[0] = 0x82f63b78u;  // The reversed CRC32c polynomial.
+    for (int n = 1; n < 32; ++n) odd[n] = 1u << (n - 1);
+    // The operators for two and four zero bits.
+    uint32_t even[32];
+    MatrixSquare(odd, even);
+    MatrixSquare(even, odd);
+    // Squares the operator for one zero byte until it covers "num_zeros".
+    uint32_t *from = odd;
+    uint32_t *to = even;
+    MatrixSquare(from, to);
+    for (num_zeros >>= 1; num_zeros != 0; num_zeros >>= 1) {
+      uint32_t *tmp = from;
+      from = to;
+      to = tmp;
+      MatrixSquare(from, to);
+    }
+    for (int n = 0; n < 32; ++n) op[n] = to[n];
   }
 
-  return l ^ 0xffffffffu;
+  uint32_t table_[4][256];
+};
+
+const ZerosTable &LongZeros() {
+  static const ZerosTable *table = new ZerosTable(kLongStream);
+  return *table;
+}
+
+const ZerosTable &ShortZeros() {
+  static const ZerosTable *table = new ZerosTable(kShortStream);
+  return *table;
+}
+
+inline uint64_t Load64(const uint8_t *p) {
+  return *reinterpret_cast<const uint64_t *>(p);
+}
+
+// Extends "crc0" over blocks of three streams of "stream_size" bytes, and
+// returns the number of bytes processed.
+CRC32C_TARGET inline size_t ExtendStreams(const uint8_t *p, size_t size,
+                                          size_t stream_size,
+                                          const ZerosTable &zeros,
+                                          uint64_t *crc0) {
+  const uint8_t *const begin = p;
+  while (size >= 3 * stream_size) {
+    uint64_t crc1 = 0;
+    uint64_t crc2 = 0;
+    const uint8_t *const e = p + stream_size;
+    do {
+      *crc0 = Crc64(*crc0, Load64(p));
+      crc1 = Crc64(crc1, Load64(p + stream_size));
+      crc2 = Crc64(crc2, Load64(p + 2 * stream_size));
+      p += 8;
+    } while (p < e);
+    *crc0 = zeros.Shift(static_cast<uint32_t>(*crc0)) ^ crc1;
+    *crc0 = zeros.Shift(static_cast<uint32_t>(*crc0)) ^ crc2;
+    p += 2 * stream_size;
+    size -= 3 * stream_size;
+  }
+  return p - begin;
+}
+
+}  // namespace
+
+#if defined(__x86_64__)
+bool CanAccelerate() { return __builtin_cpu_supports("sse4.2"); }
+#else
+bool CanAccelerate() { return true; }
+#endif
+
+CRC32C_TARGET uint32_t AcceleratedExtend(uint32_t crc, const char *buf,
+                                         size_t size) {
+  const uint8_t *p = reinterpret_cast<const uint8_t *>(buf);
+  uint64_t l = crc ^ 0xffffffffu;
+
+  // Process bytes until p is 8-byte aligned.
+  while (size > 0 && (reinterpret_cast<uintptr_t>(p) & 7) != 0) {
+    l = Crc8(static_cast<uint32_t>(l), *p++);
+    --size;
+  }
+
+  size_t n = ExtendStreams(p, size, kLongStream, LongZeros(), &l);
+  p += n;
+  size -= n;
+  n = ExtendStreams(p, size, kShortStream, ShortZeros(), &l);
+  p += n;
+  size -= n;
+
+  // Process the remaining bytes 8 at a time, then one at a time.
+  for (; size >= 8; size -= 8, p += 8) l = Crc64(l, Load64(p));
+  for (; size > 0; --size) l = Crc8(static_cast<uint32_t>(l), *p++);
+
+  return static_cast<uint32_t>(l) ^ 0xffffffffu;
 }
 
 #endif
@@ -62,6 +62,37 @@ TEST(CRC, Extend) {
   ASSERT_EQ(Value("hello world", 11), Extend(Value("hello ", 6), "world", 5));
 }
 
+// A bitwise CRC32c, to check the table and accelerated implementations
+// against.
+static uint32 BitwiseExtend(uint32 crc, const char* buf, size_t size) {
+  crc = ~crc;
+  for (size_t i = 0; i < size; ++i) {
+    crc ^= static_cast<uint8>(buf[i]);
+    for (int k = 0; k < 8; ++k) crc = (crc >> 1) ^ (0x82f63b78u & -(crc & 1));
+  }
+  return ~crc;
+}
+
+TEST(CRC, LargeBuffers) {
+  // Covers the unaligned head, the interleaved blocks of three streams and
+  // the tail of the buffer.
+  string buf(3 * 3 * 8192 + 3 * 256 + 100, 0);
+  for (size_t i = 0; i < buf.size(); ++i) buf[i] = (i * 7919) % 251;
+  const size_t sizes[] = {
+      0, 1, 15, 3 * 256, 3 * 256 + 9, 3 * 8192 - 1, 3 * 8192 + 3 * 256 + 17,
+      buf.size() - 7};
+  for (size_t offset : {0, 1, 7}) {
+    for (size_t size : sizes) {
+      ASSERT_EQ(BitwiseExtend(0, buf.data() + offset, size),
+                Value(buf.data() + offset, size))
+          << offset << " " << size;
+    }
+  }
+  ASSERT_EQ(BitwiseExtend(0, buf.data(), buf.size()),
+            Extend(Value(buf.data(), 5000), buf.data() + 5000,
+                   buf.size() - 5000));
+}
+
 TEST(CRC, Mask) {
   uint32 crc = Value("foo", 3);
   ASSERT_NE(crc, Mask(crc));
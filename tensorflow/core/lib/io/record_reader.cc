@@ -241,6 +241,49 @@ Status RecordReader::SkipRecords(uint64* offset, int num_to_skip,
   return OkStatus();
 }
 
+/* static */
+Status RecordReader::ReadIndex(RandomAccessFile* index_file,
+                               RecordIndex* index) {
+  RecordReader reader(index_file);
+  uint64 offset = 0;
+  tstring record;
+  TF_RETURN_IF_ERROR(reader.ReadRecord(&offset, &record));
+  if (record.size() < 2 * sizeof(uint64) ||
+      record.size() % sizeof(uint64) != 0) {
+    return errors::DataLoss("Record index of invalid size ", record.size());
+  }
+  const char* data = record.data();
+  index->interval = core::DecodeFixed64(data);
+  index->num_records = core::DecodeFixed64(data + sizeof(uint64));
+  const size_t num_offsets = record.size() / sizeof(uint64) - 2;
+  if (index->interval <= 0 || index->num_records < 0 ||
+      num_offsets != static_cast<size_t>((index->num_records +
+                                          index->interval - 1) /
+                                         index->interval)) {
+    return errors::DataLoss("Corrupted record index of ", index->num_records,
+                            " records every ", index->interval, " with ",
+                            num_offsets, " offsets");
+  }
+  index->offsets.resize(num_offsets);
+  for (size_t i = 0; i < num_offsets; ++i) {
+    index->offsets[i] = core::DecodeFixed64(data + (i + 2) * sizeof(uint64));
+  }
+  return OkStatus();
+}
+
+Status RecordReader::SeekToRecord(const RecordIndex& index,
+                                  int64_t record_number, uint64* offset) {
+  if (record_number < 0 || record_number >= index.num_records) {
+    return errors::OutOfRange("Record ", record_number, " is out of range [0, ",
+                              index.num_records, ")");
+  }
+  *offset = index.offsets[record_number / index.interval];
+  const int num_to_skip = record_number % index.interval;
+  if (num_to_skip == 0) return OkStatus();
+  int num_skipped;
+  return SkipRecords(offset, num_to_skip, &num_skipped);
+}
+
 SequentialRecordReader::SequentialRecordReader(
     RandomAccessFile* file, const RecordReaderOptions& options)
     : underlying_(file, options), offset_(0) {}
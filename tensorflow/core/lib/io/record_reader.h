@@ -16,6 +16,8 @@ limitations under the License.
 #ifndef TENSORFLOW_CORE_LIB_IO_RECORD_READER_H_
 #define TENSORFLOW_CORE_LIB_IO_RECORD_READER_H_
 
+#include <vector>
+
 #include "tensorflow/core/lib/core/errors.h"
 #include "tensorflow/core/lib/core/stringpiece.h"
 #include "tensorflow/core/lib/io/inputstream_interface.h"
@@ -57,6 +59,14 @@ struct RecordReaderOptions {
 #endif  // IS_SLIM_BUILD
 };
 
+// The index of a TFRecord file, as written by RecordWriter::WriteIndex().
+struct RecordIndex {
+  // Record number i * interval starts at offsets[i].
+  int64_t interval = 0;
+  int64_t num_records = 0;
+  std::vector<uint64> offsets;
+};
+
 // Low-level interface to read TFRecord files.
 //
 // If using compression or buffering, consider using SequentialRecordReader.
@@ -104,6 +114,19 @@ class RecordReader {
   // are actually skipped. It should be equal to num_to_skip on success.
   Status SkipRecords(uint64* offset, int num_to_skip, int* num_skipped);
 
+  // Reads the index in "*index_file", as written by RecordWriter::WriteIndex(),
+  // into "*index".
+  static Status ReadIndex(RandomAccessFile* index_file, RecordIndex* index);
+
+  // Sets "*offset" to the offset of record number "record_number", reading
+  // the headers of at most "index.interval - 1" records.  Returns
+  // OUT_OF_RANGE if the file has no such record.  Together with the index,
+  // this allows splitting a file into ranges of records for several readers.
+  // REQUIRES: "index" is the index of the file, and the file is neither
+  // compressed nor buffered.
+  Status SeekToRecord(const RecordIndex& index, int64_t record_number,
+                      uint64* offset);
+
   // Return the metadata of the Record file.
   //
   // The current implementation scans the file to completion,
@@ -229,6 +229,69 @@ TEST(RecordReaderWriterTest, TestSkipOutOfRange) {
   }
 }
 
+TEST(RecordReaderWriterTest, TestIndex) {
+  Env* env = Env::Default();
+  string fname = testing::TmpDir() + "/record_reader_writer_index_test";
+  string index_fname = fname + ".index";
+  const int kNumRecords = 23;
+
+  {
+    std::unique_ptr<WritableFile> file;
+    TF_CHECK_OK(env->NewWritableFile(fname, &file));
+    std::unique_ptr<WritableFile> index_file;
+    TF_CHECK_OK(env->NewWritableFile(index_fname, &index_file));
+
+    io::RecordWriterOptions options;
+    options.index_interval = 5;
+    io::RecordWriter writer(file.get(), options);
+    for (int i = 0; i < kNumRecords; ++i) {
+      TF_EXPECT_OK(writer.WriteRecord(string(i, 'a' + i)));
+    }
+    TF_CHECK_OK(writer.Close());
+    TF_CHECK_OK(writer.WriteIndex(index_file.get()));
+    TF_CHECK_OK(index_file->Close());
+  }
+
+  std::unique_ptr<RandomAccessFile> index_file;
+  TF_CHECK_OK(env->NewRandomAccessFile(index_fname, &index_file));
+  io::RecordIndex index;
+  TF_CHECK_OK(io::RecordReader::ReadIndex(index_file.get(), &index));
+  EXPECT_EQ(5, index.interval);
+  EXPECT_EQ(kNumRecords, index.num_records);
+  EXPECT_EQ(5, index.offsets.size());
+
+  std::unique_ptr<RandomAccessFile> read_file;
+  TF_CHECK_OK(env->NewRandomAccessFile(fname, &read_file));
+  io::RecordReader reader(read_file.get());
+  for (int i : {7, 0, 22, 15, 4}) {
+    uint64 offset;
+    tstring record;
+    TF_CHECK_OK(reader.SeekToRecord(index, i, &offset));
+    TF_CHECK_OK(reader.ReadRecord(&offset, &record));
+    EXPECT_EQ(string(i, 'a' + i), record);
+  }
+  uint64 offset;
+  EXPECT_TRUE(errors::IsOutOfRange(
+      reader.SeekToRecord(index, kNumRecords, &offset)));
+}
+
+TEST(RecordReaderWriterTest, TestIndexRequiresNoCompression) {
+  Env* env = Env::Default();
+  string fname = testing::TmpDir() + "/record_reader_writer_index_zlib_test";
+  std::unique_ptr<WritableFile> file;
+  TF_CHECK_OK(env->NewWritableFile(fname, &file));
+  std::unique_ptr<WritableFile> index_file;
+  TF_CHECK_OK(env->NewWritableFile(fname + ".index", &index_file));
+
+  io::RecordWriterOptions options;
+  options.compression_type = io::RecordWriterOptions::ZLIB_COMPRESSION;
+  options.index_interval = 5;
+  io::RecordWriter writer(file.get(), options);
+  TF_EXPECT_OK(writer.WriteRecord("abc"));
+  EXPECT_TRUE(
+      errors::IsFailedPrecondition(writer.WriteIndex(index_file.get())));
+}
+
 TEST(RecordReaderWriterTest, TestSnappy) {
   Env* env = Env::Default();
   string fname = testing::TmpDir() + "/record_reader_writer_snappy_test";
@@ -16,6 +16,7 @@ limitations under the License.
 #include "tensorflow/core/lib/io/record_writer.h"
 
 #include "tensorflow/core/lib/core/coding.h"
+#include "tensorflow/core/lib/core/errors.h"
 #include "tensorflow/core/lib/hash/crc32c.h"
 #include "tensorflow/core/lib/io/compression.h"
 #include "tensorflow/core/platform/env.h"
@@ -112,7 +113,9 @@ Status RecordWriter::WriteRecord(StringPiece data) {
   PopulateFooter(footer, data.data(), data.size());
   TF_RETURN_IF_ERROR(dest_->Append(StringPiece(header, sizeof(header))));
   TF_RETURN_IF_ERROR(dest_->Append(data));
-  return dest_->Append(StringPiece(footer, sizeof(footer)));
+  TF_RETURN_IF_ERROR(dest_->Append(StringPiece(footer, sizeof(footer))));
+  AddToIndex(data.size());
+  return OkStatus();
 }
 
 #if defined(TF_CORD_SUPPORT)
@@ -132,7 +135,9 @@ Status RecordWriter::WriteRecord(const absl::Cord& data) {
   PopulateFooter(footer, data);
   TF_RETURN_IF_ERROR(dest_->Append(StringPiece(header, sizeof(header))));
   TF_RETURN_IF_ERROR(dest_->Append(data));
-  return dest_->Append(StringPiece(footer, sizeof(footer)));
+  TF_RETURN_IF_ERROR(dest_->Append(StringPiece(footer, sizeof(footer))));
+  AddToIndex(data.size());
+  return OkStatus();
 }
 #endif
 
@@ -147,6 +152,35 @@ Status RecordWriter::Close() {
   return OkStatus();
 }
 
+void RecordWriter::AddToIndex(size_t n) {
+  if (options_.index_interval > 0 &&
+      num_records_ % options_.index_interval == 0) {
+    index_offsets_.push_back(offset_);
+  }
+  offset_ += kHeaderSize + n + kFooterSize;
+  ++num_records_;
+}
+
+Status RecordWriter::WriteIndex(WritableFile* dest) const {
+  if (options_.index_interval <= 0 ||
+      options_.compression_type != RecordWriterOptions::NONE) {
+    return errors::FailedPrecondition(
+        "Only uncompressed writers with a positive index_interval write an "
+        "index");
+  }
+  // Format of the single record of the index:
+  //  uint64    index_interval
+  //  uint64    number of records
+  //  uint64    offsets[ceil(number of records / index_interval)]
+  string index;
+  core::PutFixed64(&index, options_.index_interval);
+  core::PutFixed64(&index, num_records_);
+  for (uint64 offset : index_offsets_) core::PutFixed64(&index, offset);
+  RecordWriter writer(dest);
+  TF_RETURN_IF_ERROR(writer.WriteRecord(index));
+  return writer.Close();
+}
+
 Status RecordWriter::Flush() {
   if (dest_ == nullptr) {
     return Status(::tensorflow::error::FAILED_PRECONDITION,
@@ -16,6 +16,8 @@ limitations under the License.
 #ifndef TENSORFLOW_CORE_LIB_IO_RECORD_WRITER_H_
 #define TENSORFLOW_CORE_LIB_IO_RECORD_WRITER_H_
 
+#include <vector>
+
 #include "tensorflow/core/lib/core/coding.h"
 #include "tensorflow/core/lib/core/status.h"
 #include "tensorflow/core/lib/core/stringpiece.h"
@@ -45,6 +47,11 @@ struct RecordWriterOptions {
   };
   CompressionType compression_type = NONE;
 
+  // If positive, the writer records the offset of every index_interval-th
+  // record, which RecordWriter::WriteIndex() writes to a sidecar index.  Only
+  // supported without compression.
+  int64_t index_interval = 0;
+
   static RecordWriterOptions CreateRecordWriterOptions(
       const string& compression_type);
 
@@ -94,6 +101,13 @@ class RecordWriter {
   // are invalid.
   Status Close();
 
+  // Writes the index of the records written so far to "*dest", a TFRecord
+  // file that RecordReader::ReadIndex() reads.  The index allows readers to
+  // seek to records by number, see RecordReader::SeekToRecord().  Returns
+  // FAILED_PRECONDITION unless "options.index_interval" is positive and the
+  // records are not compressed.  Does *not* close the WritableFile.
+  Status WriteIndex(WritableFile* dest) const;
+
   // Utility method to populate TFRecord headers.  Populates record-header in
   // "header[0,kHeaderSize-1]".  The record-header is based on data[0, n-1].
   inline static void PopulateHeader(char* header, const char* data, size_t n);
@@ -114,6 +128,15 @@ class RecordWriter {
   WritableFile* dest_;
   RecordWriterOptions options_;
 
+  // Adds a record of "n" bytes that was just written to the index.
+  void AddToIndex(size_t n);
+
+  // The offset of the next record, and the number of records written.
+  uint64 offset_ = 0;
+  int64_t num_records_ = 0;
+  // The offsets of every options_.index_interval-th record, if indexed.
+  std::vector<uint64> index_offsets_;
+
   inline static uint32 MaskedCrc(const char* data, size_t n) {
     return crc32c::Mask(crc32c::Value(data, n));
   }
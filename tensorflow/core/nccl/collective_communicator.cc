@@ -160,6 +160,26 @@ void NcclCommunicator::Enqueue(std::shared_ptr<CollectiveContext> col_ctx,
       }
       break;
     }
+    case ALL_TO_ALL_V_COLLECTIVE: {
+      // The context holds row counts; NCCL expects element counts.
+      int64_t row_elements = 1;
+      for (int d = 1; d < col_ctx->input->dims(); ++d) {
+        row_elements *= col_ctx->input->dim_size(d);
+      }
+      auto to_elements = [row_elements](const std::vector<int64_t>& rows) {
+        std::vector<int64_t> elements(rows.size());
+        for (size_t i = 0; i < rows.size(); ++i) {
+          elements[i] = rows[i] * row_elements;
+        }
+        return elements;
+      };
+      participant->send_counts = to_elements(col_ctx->send_counts);
+      participant->send_offsets = to_elements(col_ctx->send_offsets);
+      participant->recv_counts = to_elements(col_ctx->recv_counts);
+      participant->recv_offsets = to_elements(col_ctx->recv_offsets);
+      nccl_manager_.AddToAllToAllV(std::move(participant), context);
+      break;
+    }
     default: {
       participant->done_callback(errors::Internal("Unexpected CollectiveType ",
                                                   col_params->instance.type));
@@ -441,6 +441,12 @@ void NcclManager::AddToAllGather(std::unique_ptr<Participant> participant,
                  ncclSum /* unused */);
 }
 
+void NcclManager::AddToAllToAllV(std::unique_ptr<Participant> participant,
+                                 const Context& context) {
+  AddParticipant(std::move(participant), context, kAllToAllV,
+                 ncclSum /* unused */);
+}
+
 void NcclManager::AddBroadcastSend(std::unique_ptr<Participant> participant,
                                    const Context& context) {
   participant->root = true;
@@ -577,6 +583,17 @@ void NcclManager::AddParticipant(std::unique_ptr<Participant> participant,
             " expected data types compatible with NCCL but instead got ",
             DataTypeString(collective->data_type));
       }
+      if (collective->status.ok() && collective_type == kAllToAllV) {
+        const size_t n = context.num_global_devices;
+        if (participant->send_counts.size() != n ||
+            participant->send_offsets.size() != n ||
+            participant->recv_counts.size() != n ||
+            participant->recv_offsets.size() != n) {
+          collective->status = errors::Internal(
+              "Collective ", collective->collective_key,
+              " expected send and receive counts for ", n, " ranks");
+        }
+      }
 
       if (context.source_rank >= 0) {
         collective->root_rank = context.source_rank;
@@ -828,6 +845,49 @@ void NcclManager::LoopKernelLaunches(NcclStream* nccl_stream) {
                                     data_type, nccl_comm, *cu_stream);
         break;
       }
+      case kAllToAllV: {
+        const char* sendbuff = p->input->tensor_data().data();
+        char* recvbuff = const_cast<char*>(p->output->tensor_data().data());
+        const int element_size = DataTypeSize(collective->data_type);
+
+        VLOG(2) << "call NcclAllToAllV collective_key "
+                << collective->collective_key << " participant " << p_idx
+                << " sendbuff " << static_cast<const void*>(sendbuff)
+                << " recvbuff " << static_cast<void*>(recvbuff)
+                << " nccl_comm " << nccl_comm << " comm_stream " << comm_stream
+                << " cuda_stream " << cu_stream;
+        profiler::AnnotatedTraceMe traceme([&] {
+          return profiler::TraceMeEncode(
+              "ncclAllToAllV",
+              {{"buffer_size", ComputeBufferSize(p, collective->data_type)},
+               {"collective_type", "all_to_all_v"}});
+        });
+#if NCCL_MAJOR > 2 || (NCCL_MAJOR == 2 && NCCL_MINOR >= 7)
+        // Point-to-point operations within a group are issued concurrently,
+        // which is what makes this an all-to-all rather than a sequence of
+        // blocking exchanges.
+        nccl_result = ncclGroupStart();
+        for (int peer = 0;
+             nccl_result == ncclSuccess && peer < p->send_counts.size();
+             ++peer) {
+          if (p->send_counts[peer] > 0) {
+            nccl_result = ncclSend(
+                sendbuff + p->send_offsets[peer] * element_size,
+                p->send_counts[peer], data_type, peer, nccl_comm, *cu_stream);
+          }
+          if (nccl_result == ncclSuccess && p->recv_counts[peer] > 0) {
+            nccl_result = ncclRecv(
+                recvbuff + p->recv_offsets[peer] * element_size,
+                p->recv_counts[peer], data_type, peer, nccl_comm, *cu_stream);
+          }
+        }
+        const ncclResult_t group_end_result = ncclGroupEnd();
+        if (nccl_result == ncclSuccess) nccl_result = group_end_result;
+#else
+        nccl_result = ncclInvalidUsage;
+#endif
+        break;
+      }
     }
 
     // Run the done_callback when the nccl kernel finishes running.
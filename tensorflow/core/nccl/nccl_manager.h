@@ -127,6 +127,13 @@ class NcclManager {
 
     // True if this is the root of the collective, e.g. source of broadcast.
     bool root;
+
+    // Number of elements sent to, and received from, each rank and their
+    // offsets into `input` and `output`.  Only used by all-to-all-v.
+    std::vector<int64_t> send_counts;
+    std::vector<int64_t> send_offsets;
+    std::vector<int64_t> recv_counts;
+    std::vector<int64_t> recv_offsets;
   };
 
   // Data that provides context for the collective operation, including the
@@ -170,6 +177,11 @@ class NcclManager {
   void AddToAllGather(std::unique_ptr<Participant> participant,
                       const Context& context);
 
+  // Adds one participant to an all-to-all with variable split sizes.  The
+  // participant's send and receive counts and offsets must be set.
+  void AddToAllToAllV(std::unique_ptr<Participant> participant,
+                      const Context& context);
+
   // AddBroadcastSend and AddBroadcastRecv combine to send data from one sender
   // to all receivers.
   void AddBroadcastSend(std::unique_ptr<Participant> participant,
@@ -206,6 +218,7 @@ class NcclManager {
     kBroadcast = 2,
     kReduce = 3,
     kAllGather = 4,
+    kAllToAllV = 5,
   };
   struct Collective;
   struct Communicator;
@@ -54,6 +54,10 @@ REGISTER_OP("BatchFunction")
     // NOTE: Support for `enable_large_batch_splitting == true` is still
     // developed in progress.
     .Attr("enable_large_batch_splitting: bool = false")
+    // If 'max_shape_buckets' is positive, invocations are batched separately
+    // by the shapes of their inputs beyond the 0th dimension, e.g. by the
+    // lengths that sequences are padded to.
+    .Attr("max_shape_buckets: int = 0")
     // TODO(apassos): Fix this shape inference function. It requires shape
     // inference of function calls.
     .SetShapeFn(shape_inference::UnknownShape)
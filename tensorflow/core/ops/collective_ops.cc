@@ -236,4 +236,28 @@ REGISTER_OP("CollectiveAllToAllV3")
     .SetIsDistributedCommunication()
     .SetShapeFn(shape_inference::UnchangedShape);
 
+REGISTER_OP("CollectiveAllToAllVV3")
+    .Input("input: T")
+    .Input("send_counts: int64")
+    .Input("communicator: resource")
+    .Input("group_assignment: int32")
+    .Output("data: T")
+    .Output("recv_counts: int64")
+    .Attr("T: {bfloat16, float, float16, float64, int32, int64}")
+    .Attr("timeout_seconds: float = 0")
+    .SetIsStateful()
+    .SetIsDistributedCommunication()
+    .SetShapeFn([](shape_inference::InferenceContext* c) {
+      // The number of rows received is only known once the collective runs.
+      shape_inference::ShapeHandle input;
+      TF_RETURN_IF_ERROR(c->WithRankAtLeast(c->input(0), 1, &input));
+      shape_inference::ShapeHandle data;
+      TF_RETURN_IF_ERROR(c->ReplaceDim(input, 0, c->UnknownDim(), &data));
+      shape_inference::ShapeHandle send_counts;
+      TF_RETURN_IF_ERROR(c->WithRank(c->input(1), 1, &send_counts));
+      c->set_output(0, data);
+      c->set_output(1, send_counts);
+      return OkStatus();
+    });
+
 }  // namespace tensorflow
@@ -189,6 +189,18 @@ REGISTER_OP("ComputeBatchSize")
     .Output("batch_size : int64")
     .SetShapeFn(shape_inference::ScalarShape);
 
+// Copies the elements of `input_dataset`, which is iterated on the device
+// the op is placed on, to `target_device`.
+REGISTER_OP("_CopyToDeviceDataset")
+    .Input("input_dataset: variant")
+    .Output("handle: variant")
+    .Attr("target_device: string")
+    .Attr("output_types: list(type) >= 1")
+    .Attr("output_shapes: list(shape) >= 1")
+    .SetTypeConstructor(full_type::VariadicTensorContainer(TFT_DATASET,
+                                                           "output_types"))
+    .SetShapeFn(shape_inference::ScalarShape);
+
 REGISTER_OP("CSVDataset")
     .Input("filenames: string")
     .Input("compression_type: string")
@@ -1126,6 +1138,7 @@ REGISTER_OP("SnapshotDatasetV2")
     .Attr("Treader_func_args: list(type) >= 0")
     .Attr("Tshard_func_args: list(type) >= 0")
     .Attr("metadata: string = ''")
+    .Attr("num_parallel_decodes: int = 1")
     .SetTypeConstructor(full_type::VariadicTensorContainer(TFT_DATASET,
                                                            "output_types"))
     .SetShapeFn([](shape_inference::InferenceContext* c) {
@@ -1197,6 +1210,7 @@ REGISTER_OP("SnapshotDatasetReader")
     .Attr("output_shapes: list(shape) >= 1")
     .Attr("compression: string = ''")
     .Attr("version: int")
+    .Attr("num_parallel_decodes: int = 1")
     .SetTypeConstructor(full_type::VariadicTensorContainer(TFT_DATASET,
                                                            "output_types"))
     .SetShapeFn([](shape_inference::InferenceContext* c) {
@@ -1461,6 +1475,7 @@ REGISTER_OP("DataServiceDatasetV3")
     .Attr("uncompress: bool = false")
     .Attr("uncompress_fn: func")
     .Attr("cross_trainer_cache_options: string = ''")
+    .Attr("max_bytes_per_request: int = 0")
     .SetIsStateful()
     .SetTypeConstructor(full_type::VariadicTensorContainer(TFT_DATASET,
                                                            "output_types"))
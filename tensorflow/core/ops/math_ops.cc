@@ -1015,6 +1015,30 @@ _FusedConv2D output.
 expected to create these operators.
 )doc");
 
+REGISTER_OP("_FusedElementwise")
+    .Input("x: T")
+    .Input("args: num_args * T")
+    .Output("y: T")
+    .Attr("T: {float, double}")
+    .Attr("num_args: int >= 0")
+    .Attr("fused_ops: list(string)")
+    .SetShapeFn(shape_inference::UnchangedShape)
+    .Doc(R"doc(
+Performs a chain of element-wise operations in a single pass over memory.
+
+The operations are specified by the `fused_ops` attribute, which is a list of
+TF op names specified as strings (e.g. "Tanh"). They are performed in order,
+where the (first) input to each op is the output of the preceding op, and `x`
+is the input to the first op. Binary ops take their second input from `args`,
+in order. Each of `args` must be a scalar or have the shape of `x`.
+
+Supported unary ops are {"Abs","Exp","Neg","Relu","Sigmoid","Square","Tanh"},
+and supported binary ops are {"Add","AddV2","Maximum","Minimum","Mul","Sub"}.
+
+*NOTE*: Do not invoke this operator directly in Python. Grappler is
+expected to create these operators.
+)doc");
+
 // --------------------------------------------------------------------------
 
 // For operations where the output is a reduction function along some
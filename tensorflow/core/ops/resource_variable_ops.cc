@@ -317,6 +317,40 @@ REGISTER_OP("ResourceGatherNd")
     .Attr("Tindices: {int32,int64}")
     .SetShapeFn(shape_inference::GatherNdShape);
 
+// Computes SparseSegment<reduction>(ResourceGather(resource, gather_indices),
+// indices, segment_ids) without materializing the gathered rows. Created by
+// Grappler's Remapper.
+REGISTER_OP("_ResourceSparseSegmentReduction")
+    .Input("resource: resource")
+    .Input("gather_indices: Tidx")
+    .Input("indices: Tidx")
+    .Input("segment_ids: Tsegmentids")
+    .Output("output: dtype")
+    .Attr("dtype: {float, double}")
+    .Attr("Tidx: {int32, int64} = DT_INT32")
+    .Attr("Tsegmentids: {int32, int64} = DT_INT32")
+    .Attr("reduction: {'Sum', 'Mean', 'SqrtN'}")
+    .SetShapeFn([](InferenceContext* c) {
+      std::vector<ShapeAndType> handle_shape_and_type;
+      TF_RETURN_IF_ERROR(shape_inference::ValidateVariableResourceHandle(
+          c, &handle_shape_and_type));
+      ShapeHandle unused;
+      TF_RETURN_IF_ERROR(c->WithRank(c->input(1), 1, &unused));
+      TF_RETURN_IF_ERROR(c->WithRank(c->input(2), 1, &unused));
+      TF_RETURN_IF_ERROR(c->WithRank(c->input(3), 1, &unused));
+
+      // The output shape is [num_segments] + params_shape[1:].
+      ShapeHandle params_subshape;
+      TF_RETURN_IF_ERROR(
+          c->Subshape(handle_shape_and_type[0].shape, 1, &params_subshape));
+      ShapeHandle out;
+      TF_RETURN_IF_ERROR(
+          c->Concatenate(c->Vector(InferenceContext::kUnknownDim),
+                         params_subshape, &out));
+      c->set_output(0, out);
+      return OkStatus();
+    });
+
 namespace {
 
 Status ResourceScatterUpdateShape(InferenceContext* c) {
@@ -438,4 +472,79 @@ REGISTER_OP("DisableCopyOnRead")
     .Input("resource: resource")
     .SetShapeFn(shape_inference::NoOutputs);
 
+REGISTER_OP("TieredEmbeddingVarHandleOp")
+    .Attr("container: string = ''")
+    .Attr("shared_name: string = ''")
+    .Attr("value_dim: int >= 1")
+    .Attr("memory_capacity: int = 0")
+    .Attr("storage_dir: string = ''")
+    .Attr("promotion_threshold: int >= 1 = 2")
+    .Output("resource: resource")
+    .SetIsStateful()
+    .SetShapeFn(shape_inference::ScalarShape);
+
+REGISTER_OP("TieredEmbeddingVarGather")
+    .Input("resource: resource")
+    .Input("indices: int64")
+    .Input("default_value: float")
+    .Output("output: float")
+    .SetShapeFn([](InferenceContext* c) {
+      ShapeHandle default_value;
+      TF_RETURN_IF_ERROR(c->WithRank(c->input(2), 1, &default_value));
+      ShapeHandle out;
+      TF_RETURN_IF_ERROR(c->Concatenate(c->input(1), default_value, &out));
+      c->set_output(0, out);
+      return OkStatus();
+    });
+
+REGISTER_OP("TieredEmbeddingVarSparseApplyGradientDescent")
+    .Input("resource: resource")
+    .Input("alpha: float")
+    .Input("grad: float")
+    .Input("indices: int64")
+    .Input("default_value: float")
+    .SetShapeFn([](InferenceContext* c) {
+      ShapeHandle unused;
+      TF_RETURN_IF_ERROR(c->WithRank(c->input(1), 0, &unused));
+      ShapeHandle default_value;
+      TF_RETURN_IF_ERROR(c->WithRank(c->input(4), 1, &default_value));
+      ShapeHandle grad;
+      TF_RETURN_IF_ERROR(c->Concatenate(c->input(3), default_value, &grad));
+      return c->Merge(c->input(2), grad, &unused);
+    });
+
+REGISTER_OP("TieredEmbeddingVarSize")
+    .Input("resource: resource")
+    .Output("memory_size: int64")
+    .Output("storage_size: int64")
+    .SetShapeFn([](InferenceContext* c) {
+      c->set_output(0, c->Scalar());
+      c->set_output(1, c->Scalar());
+      return OkStatus();
+    });
+
+REGISTER_OP("SaveTieredEmbeddingVar")
+    .Input("resource: resource")
+    .Input("prefix: string")
+    .Input("tensor_name: string")
+    .SetIsStateful()
+    .SetShapeFn([](InferenceContext* c) {
+      ShapeHandle unused;
+      TF_RETURN_IF_ERROR(c->WithRank(c->input(1), 0, &unused));
+      TF_RETURN_IF_ERROR(c->WithRank(c->input(2), 0, &unused));
+      return OkStatus();
+    });
+
+REGISTER_OP("RestoreTieredEmbeddingVar")
+    .Input("resource: resource")
+    .Input("prefix: string")
+    .Input("tensor_name: string")
+    .SetIsStateful()
+    .SetShapeFn([](InferenceContext* c) {
+      ShapeHandle unused;
+      TF_RETURN_IF_ERROR(c->WithRank(c->input(1), 0, &unused));
+      TF_RETURN_IF_ERROR(c->WithRank(c->input(2), 0, &unused));
+      return OkStatus();
+    });
+
 }  // namespace tensorflow
@@ -145,4 +145,37 @@ client_terminated: If set to true, this indicates that the node was added
   locally by the caller.
 )doc");
 
+REGISTER_OP("_PackTransfer")
+    .Input("inputs: T")
+    .Output("packed: uint8")
+    .Attr("T: list(type)")
+    .SetShapeFn([](shape_inference::InferenceContext* c) {
+      c->set_output(0, c->Vector(c->UnknownDim()));
+      return OkStatus();
+    })
+    .Doc(R"doc(
+Packs a list of tensors into a single buffer.
+
+Added by graph partitioning to coalesce several small tensors sent between
+the same pair of devices into one Send/Recv pair. The buffer holds, for each
+input, its rank, its dimensions and its contents, and is only meant to be
+consumed by _UnpackTransfer.
+
+inputs: The tensors to pack. All of them must be memcpy-able.
+packed: The packed buffer.
+)doc");
+
+REGISTER_OP("_UnpackTransfer")
+    .Input("packed: uint8")
+    .Output("outputs: T")
+    .Attr("T: list(type)")
+    .SetShapeFn(shape_inference::UnknownShape)
+    .Doc(R"doc(
+Unpacks a buffer produced by _PackTransfer into the original tensors.
+
+packed: The packed buffer.
+outputs: The unpacked tensors.
+T: The types of the packed tensors, in order.
+)doc");
+
 }  // end namespace tensorflow
@@ -369,6 +369,7 @@ REGISTER_OP("ResourceSparseApplyAdagradV2")
     .Attr("Tindices: {int32, int64}")
     .Attr("use_locking: bool = false")
     .Attr("update_slots: bool = true")
+    .Attr("deduplicate_indices: bool = false")
     .SetShapeFn(
         ApplyAdagradV2ShapeFn</*is_sparse=*/true, /*is_resource=*/true>);
 
@@ -826,6 +827,42 @@ REGISTER_OP("ResourceApplyAdam")
     .Attr("use_nesterov: bool = false")
     .SetShapeFn(ApplyAdamShapeFn</*is_resource=*/true>);
 
+static Status SparseApplyAdamShapeFn(InferenceContext* c) {
+  ShapeHandle unused;
+  ShapeHandle s = ShapeOrHandleShape</*is_resource=*/true>(c, 0);  // var
+  TF_RETURN_IF_ERROR(
+      c->Merge(s, ShapeOrHandleShape</*is_resource=*/true>(c, 1), &s));  // m
+  TF_RETURN_IF_ERROR(
+      c->Merge(s, ShapeOrHandleShape</*is_resource=*/true>(c, 2), &s));  // v
+  TF_RETURN_IF_ERROR(c->WithRank(c->input(3), 0, &unused));  // beta1_power
+  TF_RETURN_IF_ERROR(c->WithRank(c->input(4), 0, &unused));  // beta2_power
+  TF_RETURN_IF_ERROR(c->WithRank(c->input(5), 0, &unused));  // lr
+  TF_RETURN_IF_ERROR(c->WithRank(c->input(6), 0, &unused));  // beta1
+  TF_RETURN_IF_ERROR(c->WithRank(c->input(7), 0, &unused));  // beta2
+  TF_RETURN_IF_ERROR(c->WithRank(c->input(8), 0, &unused));  // epsilon
+  TF_RETURN_IF_ERROR(
+      HandleGradAndIndicesInputs</*is_sparse=*/true, /*is_resource=*/true>(
+          c, 9 /* grad_idx */, &s));
+  return OkStatus();
+}
+
+REGISTER_OP("ResourceSparseApplyAdam")
+    .Input("var: resource")
+    .Input("m: resource")
+    .Input("v: resource")
+    .Input("beta1_power: T")
+    .Input("beta2_power: T")
+    .Input("lr: T")
+    .Input("beta1: T")
+    .Input("beta2: T")
+    .Input("epsilon: T")
+    .Input("grad: T")
+    .Input("indices: Tindices")
+    .Attr("T: numbertype")
+    .Attr("Tindices: {int32, int64}")
+    .Attr("use_locking: bool = false")
+    .SetShapeFn(SparseApplyAdamShapeFn);
+
 template <bool is_resource>
 static Status ApplyAdamWithAmsgradShapeFn(InferenceContext* c) {
   ShapeHandle unused;
@@ -131,6 +131,17 @@ constexpr char kThrottleBucket[] = "GCS_THROTTLE_BUCKET_SIZE";
 constexpr char kTokensPerRequest[] = "GCS_TOKENS_PER_REQUEST";
 // The environment variable to configure the initial tokens (format: <int64_t>)
 constexpr char kInitialTokens[] = "GCS_INITIAL_TOKENS";
+// The environment variable that enables reading ahead of sequential reads
+// with up to this many concurrent requests per file, if the block cache is
+// disabled (format: <int>).
+constexpr char kPrefetchMaxRequests[] = "GCS_READ_PREFETCH_MAX_REQUESTS";
+// The environment variables that override the size that prefetched blocks
+// grow to, and the maximum number of bytes prefetched per file (format: MB).
+constexpr char kPrefetchMaxBlockSize[] = "GCS_READ_PREFETCH_MAX_BLOCK_SIZE_MB";
+constexpr char kPrefetchWindowSize[] = "GCS_READ_PREFETCH_WINDOW_SIZE_MB";
+// The number of prefetching threads per allowed concurrent request, so that
+// a few files can be scanned at full speed at once.
+constexpr int kPrefetchThreadsPerRequest = 4;
 
 // The environment variable to customize which GCS bucket locations are allowed,
 // if the list is empty defaults to using the region of the zone (format, comma
@@ -810,6 +821,27 @@ GcsFileSystem::GcsFileSystem(bool make_default_cache) {
           << "block size = " << block_size_ << " ; "
           << "max staleness = " << max_staleness;
   file_block_cache_ = MakeFileBlockCache(block_size_, max_bytes, max_staleness);
+
+  // Apply the overrides for reading ahead of sequential reads, if provided.
+  if (GetEnvVar(kPrefetchMaxRequests, strings::safe_strtou64, &value) &&
+      value > 0) {
+    prefetch_options_.max_concurrent_requests = static_cast<int>(value);
+    if (GetEnvVar(kPrefetchMaxBlockSize, strings::safe_strtou64, &value)) {
+      prefetch_options_.max_block_size = value * 1024 * 1024;
+    }
+    if (GetEnvVar(kPrefetchWindowSize, strings::safe_strtou64, &value)) {
+      prefetch_options_.max_prefetch_bytes = value * 1024 * 1024;
+    }
+    prefetch_options_.initial_block_size = std::min(
+        prefetch_options_.initial_block_size, prefetch_options_.max_block_size);
+    VLOG(1) << "GCS prefetch max requests = "
+            << prefetch_options_.max_concurrent_requests << " ; "
+            << "max block size = " << prefetch_options_.max_block_size << " ; "
+            << "window size = " << prefetch_options_.max_prefetch_bytes;
+    prefetch_thread_pool_ = std::make_unique<thread::ThreadPool>(
+        Env::Default(), "gcs_prefetch",
+        kPrefetchThreadsPerRequest * prefetch_options_.max_concurrent_requests);
+  }
   // Apply overrides for the stat cache max age and max entries, if provided.
   uint64 stat_cache_max_age = kStatCacheDefaultMaxAge;
   size_t stat_cache_max_entries = kStatCacheDefaultMaxEntries;
@@ -996,22 +1028,29 @@ Status GcsFileSystem::NewRandomAccessFile(
       return OkStatus();
     }));
   } else {
-    result->reset(new BufferedGcsRandomAccessFile(
-        fname, block_size_,
-        [this, bucket, object](const string& fname, uint64 offset, size_t n,
-                               StringPiece* result, char* scratch) {
-          *result = StringPiece();
-          size_t bytes_transferred;
-          TF_RETURN_IF_ERROR(
-              LoadBufferFromGCS(fname, offset, n, scratch, &bytes_transferred));
-          *result = StringPiece(scratch, bytes_transferred);
-          if (bytes_transferred < n) {
-            return errors::OutOfRange("EOF reached, ", result->size(),
-                                      " bytes were read out of ", n,
-                                      " bytes requested.");
-          }
-          return OkStatus();
-        }));
+    auto read_fn = [this, bucket, object](const string& fname, uint64 offset,
+                                          size_t n, StringPiece* result,
+                                          char* scratch) {
+      *result = StringPiece();
+      size_t bytes_transferred;
+      TF_RETURN_IF_ERROR(
+          LoadBufferFromGCS(fname, offset, n, scratch, &bytes_transferred));
+      *result = StringPiece(scratch, bytes_transferred);
+      if (bytes_transferred < n) {
+        return errors::OutOfRange("EOF reached, ", result->size(),
+                                  " bytes were read out of ", n,
+                                  " bytes requested.");
+      }
+      return OkStatus();
+    };
+    if (prefetch_thread_pool_ != nullptr) {
+      result->reset(new PrefetchingRandomAccessFile(
+          fname, std::move(read_fn), prefetch_options_,
+          prefetch_thread_pool_.get()));
+    } else {
+      result->reset(new BufferedGcsRandomAccessFile(fname, block_size_,
+                                                    std::move(read_fn)));
+    }
   }
   return OkStatus();
 }
@@ -29,6 +29,7 @@ limitations under the License.
 #include "tensorflow/core/platform/cloud/gcs_dns_cache.h"
 #include "tensorflow/core/platform/cloud/gcs_throttle.h"
 #include "tensorflow/core/platform/cloud/http_request.h"
+#include "tensorflow/core/platform/cloud/prefetching_random_access_file.h"
 #include "tensorflow/core/platform/file_system.h"
 #include "tensorflow/core/platform/retrying_file_system.h"
 #include "tensorflow/core/platform/status.h"
@@ -422,6 +423,12 @@ class GcsFileSystem : public FileSystem {
       TF_GUARDED_BY(block_cache_lock_);
 
   bool cache_enabled_;
+
+  // Runs the block fetches of files that read ahead, if reading ahead is
+  // enabled.  Used when the block cache is disabled.
+  std::unique_ptr<thread::ThreadPool> prefetch_thread_pool_;
+  PrefetchingRandomAccessFile::Options prefetch_options_;
+
   std::unique_ptr<GcsDnsCache> dns_cache_;
   GcsThrottle throttle_;
 
@@ -0,0 +1,162 @@
+/* Copyright 2022 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/platform/cloud/prefetching_random_access_file.h"
+
+#include <algorithm>
+#include <cstring>
+#include <limits>
+
+#include "tensorflow/core/platform/errors.h"
+
+namespace tensorflow {
+
+PrefetchingRandomAccessFile::PrefetchingRandomAccessFile(
+    const string& filename, ReadFn read_fn, const Options& options,
+    thread::ThreadPool* pool)
+    : filename_(filename),
+      read_fn_(std::move(read_fn)),
+      options_(options),
+      pool_(pool),
+      block_size_(options.initial_block_size),
+      eof_(std::numeric_limits<uint64>::max()) {}
+
+PrefetchingRandomAccessFile::~PrefetchingRandomAccessFile() {
+  mutex_lock l(mu_);
+  while (num_fetches_in_flight_ > 0) cv_.wait(l);
+}
+
+Status PrefetchingRandomAccessFile::Read(uint64 offset, size_t n,
+                                         StringPiece* result,
+                                         char* scratch) const {
+  bool sequential;
+  {
+    mutex_lock l(mu_);
+    sequential = offset == next_offset_;
+    next_offset_ = offset + n;
+    if (!sequential) {
+      // Starts over, and only reads ahead if the next read continues this
+      // one.
+      ResetWindow(offset + n);
+      block_size_ = options_.initial_block_size;
+    }
+  }
+  if (!sequential) return read_fn_(filename_, offset, n, result, scratch);
+
+  mutex_lock l(mu_);
+  size_t copied = 0;
+  Status status;
+  while (copied < n) {
+    const uint64 pos = offset + copied;
+    DropBlocksBefore(pos);
+    if (blocks_.empty()) ResetWindow(pos);
+    Prefetch();
+    if (blocks_.empty()) {
+      if (window_end_ >= eof_) break;
+      // Fetches of dropped blocks use up all requests.
+      cv_.wait(l);
+      continue;
+    }
+    const std::shared_ptr<Block> block = blocks_.front();
+    if (block->offset > pos) {
+      // Another reader moved the window.
+      ResetWindow(pos);
+      continue;
+    }
+    while (!block->done) cv_.wait(l);
+    if (!block->status.ok()) {
+      status = block->status;
+      // Drops the window to avoid caching bad reads.
+      ResetWindow(pos);
+      break;
+    }
+    const uint64 block_end = block->offset + block->data.size();
+    if (block->data.size() < block->size && block_end < eof_) {
+      // The block hit the end of the file, so the blocks after it are empty.
+      eof_ = block_end;
+      while (blocks_.size() > 1) blocks_.pop_back();
+      window_end_ = block->offset + block->size;
+    }
+    if (pos >= block_end) break;
+    const size_t copy_size =
+        std::min(n - copied, static_cast<size_t>(block_end - pos));
+    memcpy(scratch + copied, block->data.data() + (pos - block->offset),
+           copy_size);
+    copied += copy_size;
+  }
+  if (status.ok()) Prefetch();
+  *result = StringPiece(scratch, copied);
+  if (!status.ok()) return status;
+  if (copied < n) {
+    // Forget the end of the file to allow for clients that poll on the same
+    // file.
+    ResetWindow(offset + copied);
+    return errors::OutOfRange("EOF reached. Requested to read ", n,
+                              " bytes from ", offset, ".");
+  }
+  return OkStatus();
+}
+
+void PrefetchingRandomAccessFile::DropBlocksBefore(uint64 offset) const {
+  while (!blocks_.empty() &&
+         blocks_.front()->offset + blocks_.front()->size <= offset) {
+    blocks_.pop_front();
+    // The scan is sequential, so grow the fetches.
+    block_size_ = std::min(2 * block_size_, options_.max_block_size);
+  }
+}
+
+void PrefetchingRandomAccessFile::ResetWindow(uint64 offset) const {
+  blocks_.clear();
+  window_end_ = offset;
+  eof_ = std::numeric_limits<uint64>::max();
+}
+
+void PrefetchingRandomAccessFile::Prefetch() const {
+  while (num_fetches_in_flight_ < options_.max_concurrent_requests &&
+         window_end_ < eof_ &&
+         (blocks_.empty() || window_end_ - blocks_.front()->offset <
+                                 options_.max_prefetch_bytes)) {
+    auto block = std::make_shared<Block>();
+    block->offset = window_end_;
+    block->size = block_size_;
+    window_end_ += block_size_;
+    blocks_.push_back(block);
+    ++num_fetches_in_flight_;
+    pool_->Schedule([this, block]() {
+      // Only this fetch touches the block until it is done.
+      block->data.resize(block->size);
+      StringPiece data;
+      Status status = read_fn_(filename_, block->offset, block->size, &data,
+                               &block->data[0]);
+      if (status.ok() || errors::IsOutOfRange(status)) {
+        if (data.data() != block->data.data()) {
+          memmove(&block->data[0], data.data(), data.size());
+        }
+        block->data.resize(data.size());
+        status = OkStatus();
+      } else {
+        block->data.clear();
+      }
+      mutex_lock l(mu_);
+      block->status = status;
+      block->done = true;
+      --num_fetches_in_flight_;
+      cv_.notify_all();
+    });
+  }
+}
+
+}  // namespace tensorflow
@@ -0,0 +1,122 @@
+/* Copyright 2022 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_CORE_PLATFORM_CLOUD_PREFETCHING_RANDOM_ACCESS_FILE_H_
+#define TENSORFLOW_CORE_PLATFORM_CLOUD_PREFETCHING_RANDOM_ACCESS_FILE_H_
+
+#include <deque>
+#include <functional>
+#include <memory>
+#include <string>
+
+#include "tensorflow/core/platform/file_system.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/status.h"
+#include "tensorflow/core/platform/stringpiece.h"
+#include "tensorflow/core/platform/thread_annotations.h"
+#include "tensorflow/core/platform/threadpool.h"
+#include "tensorflow/core/platform/types.h"
+
+namespace tensorflow {
+
+/// \brief A random access file that reads ahead of sequential scans with
+/// several concurrent range requests.
+///
+/// While reads are sequential, the file keeps a window of blocks after the
+/// last read in flight or buffered, and fetches each block with a separate
+/// call to the read function on a shared thread pool.  The block size starts
+/// small and doubles with every block that is consumed sequentially, so that
+/// short scans stay cheap and long scans issue few, large requests.  A read
+/// that is not sequential drops the window, resets the block size and reads
+/// the requested bytes directly.
+class PrefetchingRandomAccessFile : public RandomAccessFile {
+ public:
+  /// Reads `n` bytes from `filename` at `offset` into `scratch`, with the
+  /// semantics of RandomAccessFile::Read.  Must be thread safe.
+  typedef std::function<Status(const string& filename, uint64 offset, size_t n,
+                               StringPiece* result, char* scratch)>
+      ReadFn;
+
+  struct Options {
+    /// The size of the first block of a sequential scan.
+    size_t initial_block_size = 4 * 1024 * 1024;
+    /// The size the blocks grow to.
+    size_t max_block_size = 64 * 1024 * 1024;
+    /// The maximum number of block fetches in flight.
+    int max_concurrent_requests = 8;
+    /// The maximum number of bytes in flight or buffered ahead of the reader.
+    size_t max_prefetch_bytes = 256 * 1024 * 1024;
+  };
+
+  /// `pool` runs the block fetches and must outlive the file.
+  PrefetchingRandomAccessFile(const string& filename, ReadFn read_fn,
+                              const Options& options,
+                              thread::ThreadPool* pool);
+
+  /// Waits for the block fetches in flight.
+  ~PrefetchingRandomAccessFile() override;
+
+  Status Name(StringPiece* result) const override {
+    *result = filename_;
+    return OkStatus();
+  }
+
+  /// Thread safe.  Returns `OUT_OF_RANGE` if fewer than n bytes were stored
+  /// in `*result` because of EOF.
+  Status Read(uint64 offset, size_t n, StringPiece* result,
+              char* scratch) const override;
+
+ private:
+  struct Block {
+    uint64 offset;
+    size_t size;  // The requested size.
+    string data;  // Shorter than `size` after a fetch that hit EOF.
+    Status status;
+    bool done = false;
+  };
+
+  // Drops the blocks that end at or before `offset`.
+  void DropBlocksBefore(uint64 offset) const TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+  // Drops all blocks and starts a new window at `offset`.
+  void ResetWindow(uint64 offset) const TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+  // Schedules fetches of the blocks after window_end_ until the limits of
+  // `options_` or the end of the file are reached.
+  void Prefetch() const TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+
+  const string filename_;
+  const ReadFn read_fn_;
+  const Options options_;
+  thread::ThreadPool* const pool_;
+
+  mutable mutex mu_;
+  mutable condition_variable cv_;
+  // The offset a sequential read starts at.
+  mutable uint64 next_offset_ TF_GUARDED_BY(mu_) = 0;
+  // The size of the next block to fetch.
+  mutable size_t block_size_ TF_GUARDED_BY(mu_);
+  // The blocks of the window, ordered by offset and without gaps.
+  mutable std::deque<std::shared_ptr<Block>> blocks_ TF_GUARDED_BY(mu_);
+  // The end of the window, i.e. the offset of the next block to fetch.
+  mutable uint64 window_end_ TF_GUARDED_BY(mu_) = 0;
+  // The end of the file, once a fetch hit it.
+  mutable uint64 eof_ TF_GUARDED_BY(mu_);
+  mutable int num_fetches_in_flight_ TF_GUARDED_BY(mu_) = 0;
+
+  TF_DISALLOW_COPY_AND_ASSIGN(PrefetchingRandomAccessFile);
+};
+
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_PLATFORM_CLOUD_PREFETCHING_RANDOM_ACCESS_FILE_H_
@@ -0,0 +1,158 @@
+/* Copyright 2022 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/platform/cloud/prefetching_random_access_file.h"
+
+#include <algorithm>
+#include <cstring>
+#include <limits>
+#include <utility>
+#include <vector>
+
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/errors.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace {
+
+// A file of `size` bytes that records the reads of it.
+class FakeFile {
+ public:
+  explicit FakeFile(size_t size) : contents_(size, 0) {
+    for (size_t i = 0; i < size; ++i) contents_[i] = static_cast<char>(i % 251);
+  }
+
+  PrefetchingRandomAccessFile::ReadFn read_fn() {
+    return [this](const string& filename, uint64 offset, size_t n,
+                  StringPiece* result, char* scratch) {
+      {
+        mutex_lock l(mu_);
+        reads_.emplace_back(offset, n);
+        if (offset >= fail_from_) {
+          return errors::Unavailable("Read of ", offset, " failed.");
+        }
+      }
+      const size_t size =
+          offset < contents_.size() ? std::min(n, contents_.size() - offset)
+                                    : 0;
+      if (size > 0) memcpy(scratch, contents_.data() + offset, size);
+      *result = StringPiece(scratch, size);
+      if (size < n) return errors::OutOfRange("EOF");
+      return OkStatus();
+    };
+  }
+
+  std::vector<std::pair<uint64, size_t>> reads() {
+    mutex_lock l(mu_);
+    return reads_;
+  }
+
+  void FailFrom(uint64 offset) {
+    mutex_lock l(mu_);
+    fail_from_ = offset;
+  }
+
+  const string& contents() const { return contents_; }
+
+ private:
+  string contents_;
+  mutex mu_;
+  std::vector<std::pair<uint64, size_t>> reads_ TF_GUARDED_BY(mu_);
+  uint64 fail_from_ TF_GUARDED_BY(mu_) = std::numeric_limits<uint64>::max();
+};
+
+PrefetchingRandomAccessFile::Options TestOptions() {
+  PrefetchingRandomAccessFile::Options options;
+  options.initial_block_size = 16;
+  options.max_block_size = 64;
+  options.max_concurrent_requests = 2;
+  options.max_prefetch_bytes = 256;
+  return options;
+}
+
+TEST(PrefetchingRandomAccessFileTest, SequentialScan) {
+  FakeFile fake_file(1000);
+  thread::ThreadPool pool(Env::Default(), "test", 4);
+  string scanned;
+  {
+    PrefetchingRandomAccessFile file("file", fake_file.read_fn(),
+                                     TestOptions(), &pool);
+    char scratch[10];
+    StringPiece result;
+    Status status;
+    for (uint64 offset = 0; status.ok(); offset += sizeof(scratch)) {
+      status = file.Read(offset, sizeof(scratch), &result, scratch);
+      scanned.append(result.data(), result.size());
+    }
+    EXPECT_TRUE(errors::IsOutOfRange(status)) << status;
+  }
+  EXPECT_EQ(fake_file.contents(), scanned);
+
+  // The blocks grow from the initial to the maximum block size.
+  auto reads = fake_file.reads();
+  std::sort(reads.begin(), reads.end());
+  ASSERT_GE(reads.size(), 3);
+  EXPECT_EQ(reads[0], std::make_pair(uint64{0}, size_t{16}));
+  size_t max_size = 0;
+  for (const auto& read : reads) max_size = std::max(max_size, read.second);
+  EXPECT_EQ(64, max_size);
+  // Most of the file was read by a few large requests.
+  EXPECT_LT(reads.size(), 40);
+}
+
+TEST(PrefetchingRandomAccessFileTest, RandomReadsAreDirect) {
+  FakeFile fake_file(1000);
+  thread::ThreadPool pool(Env::Default(), "test", 4);
+  PrefetchingRandomAccessFile file("file", fake_file.read_fn(), TestOptions(),
+                                   &pool);
+  char scratch[10];
+  StringPiece result;
+  TF_EXPECT_OK(file.Read(500, 10, &result, scratch));
+  EXPECT_EQ(fake_file.contents().substr(500, 10), result);
+  TF_EXPECT_OK(file.Read(100, 10, &result, scratch));
+  EXPECT_EQ(fake_file.contents().substr(100, 10), result);
+  EXPECT_TRUE(errors::IsOutOfRange(file.Read(995, 10, &result, scratch)));
+  EXPECT_EQ(fake_file.contents().substr(995), result);
+  const std::vector<std::pair<uint64, size_t>> expected = {
+      {500, 10}, {100, 10}, {995, 10}};
+  EXPECT_EQ(expected, fake_file.reads());
+}
+
+TEST(PrefetchingRandomAccessFileTest, Error) {
+  FakeFile fake_file(1000);
+  fake_file.FailFrom(100);
+  thread::ThreadPool pool(Env::Default(), "test", 4);
+  PrefetchingRandomAccessFile file("file", fake_file.read_fn(), TestOptions(),
+                                   &pool);
+  char scratch[40];
+  StringPiece result;
+  TF_EXPECT_OK(file.Read(0, 40, &result, scratch));
+  Status status;
+  for (uint64 offset = 40; status.ok(); offset += sizeof(scratch)) {
+    status = file.Read(offset, sizeof(scratch), &result, scratch);
+  }
+  EXPECT_TRUE(errors::IsUnavailable(status)) << status;
+
+  // Bad reads are not buffered.
+  fake_file.FailFrom(std::numeric_limits<uint64>::max());
+  TF_EXPECT_OK(file.Read(120, 40, &result, scratch));
+  EXPECT_EQ(fake_file.contents().substr(120, 40), result);
+}
+
+}  // namespace
+}  // namespace tensorflow
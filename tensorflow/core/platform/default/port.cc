@@ -24,6 +24,7 @@ limitations under the License.
 
 #if defined(__linux__) && !defined(__ANDROID__)
 #include <sched.h>
+#include <sys/mman.h>
 #include <sys/sysinfo.h>
 #else
 #include <sys/syscall.h>
@@ -298,6 +299,64 @@ void NUMAFree(void* ptr, size_t size) {
   Free(ptr);
 }
 
+void* NUMAMallocHugePages(int node, size_t size, size_t page_size) {
+#if defined(__linux__) && !defined(__ANDROID__)
+  DCHECK_EQ(page_size & (page_size - 1), 0);
+  DCHECK_EQ(size % page_size, 0);
+  void* ptr = MAP_FAILED;
+#if defined(MAP_HUGETLB) && defined(MAP_HUGE_SHIFT)
+  // Huge pages reserved with the OS (hugetlbfs) of exactly page_size.
+  const int log2_page_size = __builtin_ctzll(page_size);
+  ptr = mmap(nullptr, size, PROT_READ | PROT_WRITE,
+             MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB |
+                 (log2_page_size << MAP_HUGE_SHIFT),
+             -1, 0);
+#endif  // defined(MAP_HUGETLB) && defined(MAP_HUGE_SHIFT)
+  if (ptr == MAP_FAILED) {
+#ifdef MADV_HUGEPAGE
+    // Fall back to transparent huge pages, which require the range to be
+    // aligned to page_size: over-map and trim the excess on both sides.
+    void* base = mmap(nullptr, size + page_size, PROT_READ | PROT_WRITE,
+                      MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (base == MAP_FAILED) return nullptr;
+    const uintptr_t begin = reinterpret_cast<uintptr_t>(base);
+    const uintptr_t aligned = (begin + page_size - 1) & ~(page_size - 1);
+    if (aligned > begin) munmap(base, aligned - begin);
+    munmap(reinterpret_cast<void*>(aligned + size),
+           page_size - (aligned - begin));
+    ptr = reinterpret_cast<void*>(aligned);
+    if (madvise(ptr, size, MADV_HUGEPAGE) != 0) {
+      munmap(ptr, size);
+      return nullptr;
+    }
+#else
+    return nullptr;
+#endif  // MADV_HUGEPAGE
+  }
+#ifdef TENSORFLOW_USE_NUMA
+  // Bind before the pages are first touched, so they are faulted in on node.
+  if (node != kNUMANoAffinity && HaveHWLocTopology()) {
+    hwloc_obj_t numa_node = GetHWLocTypeIndex(HWLOC_OBJ_NUMANODE, node);
+    if (numa_node == nullptr ||
+        hwloc_set_area_membind(hwloc_topology_handle, ptr, size,
+                               numa_node->nodeset, HWLOC_MEMBIND_BIND,
+                               HWLOC_MEMBIND_BYNODESET) != 0) {
+      LOG(ERROR) << "Failed to bind huge pages to hwloc NUMA node " << node;
+    }
+  }
+#endif  // TENSORFLOW_USE_NUMA
+  return ptr;
+#else
+  return nullptr;
+#endif  // defined(__linux__) && !defined(__ANDROID__)
+}
+
+void NUMAFreeHugePages(void* ptr, size_t size) {
+#if defined(__linux__) && !defined(__ANDROID__)
+  munmap(ptr, size);
+#endif
+}
+
 int NUMAGetMemAffinity(const void* addr) {
   int node = kNUMANoAffinity;
 #ifdef TENSORFLOW_USE_NUMA
@@ -54,6 +54,21 @@ void* NUMAMalloc(int node, size_t size, int minimum_alignment);
 // Memory allocated by NUMAMalloc must be freed via NUMAFree.
 void NUMAFree(void* ptr, size_t size);
 
+// Allocates `size` bytes backed by huge pages of `page_size` bytes (e.g. 2MiB
+// or 1GiB), bound to the specified NUMA node unless node == kNUMANoAffinity.
+// Returns nullptr if huge pages are not supported on this platform or none
+// could be obtained.
+//
+// Notes:
+//  1. page_size must be a power of two, and size a multiple of page_size.
+//  2. The memory returned is aligned to page_size.
+//  3. If no huge pages of page_size are reserved with the OS, the memory may be
+//     backed by transparent huge pages instead.
+void* NUMAMallocHugePages(int node, size_t size, size_t page_size);
+
+// Memory allocated by NUMAMallocHugePages must be freed via NUMAFreeHugePages.
+void NUMAFreeHugePages(void* ptr, size_t size);
+
 // Returns NUMA node affinity of memory address, kNUMANoAffinity if none.
 int NUMAGetMemAffinity(const void* ptr);
 
@@ -15,6 +15,8 @@ limitations under the License.
 
 #include "tensorflow/core/platform/numa.h"
 
+#include <cstring>
+
 #include "tensorflow/core/platform/logging.h"
 #include "tensorflow/core/platform/test.h"
 
@@ -42,6 +44,16 @@ TEST(Numa, Malloc) {
   }
 }
 
+TEST(Numa, MallocHugePages) {
+  const size_t kPageSize = 2 << 20;
+  void* ptr = port::NUMAMallocHugePages(port::kNUMANoAffinity, 2 * kPageSize,
+                                        kPageSize);
+  if (ptr == nullptr) return;  // Huge pages are not supported.
+  EXPECT_EQ(0, reinterpret_cast<uintptr_t>(ptr) % kPageSize);
+  memset(ptr, 0, 2 * kPageSize);
+  port::NUMAFreeHugePages(ptr, 2 * kPageSize);
+}
+
 TEST(Numa, SetNodeAffinity) {
   // NOTE(tucker): This test is not reliable when executed under tap because
   // the virtual machine may not have access to all of the available NUMA
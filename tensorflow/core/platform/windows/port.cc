@@ -130,6 +130,12 @@ void* NUMAMalloc(int node, size_t size, int minimum_alignment) {
 
 void NUMAFree(void* ptr, size_t size) { Free(ptr); }
 
+void* NUMAMallocHugePages(int node, size_t size, size_t page_size) {
+  return nullptr;
+}
+
+void NUMAFreeHugePages(void* ptr, size_t size) {}
+
 int NUMAGetMemAffinity(const void* addr) { return kNUMANoAffinity; }
 
 void MallocExtension_ReleaseToSystem(std::size_t num_bytes) {
@@ -20,9 +20,11 @@ limitations under the License.
 #include <vector>
 
 #include "tensorflow/core/platform/errors.h"
+#include "tensorflow/core/platform/logging.h"
 #include "tensorflow/core/platform/status.h"
 #include "tensorflow/core/platform/types.h"
 #include "tensorflow/core/profiler/backends/cpu/host_tracer_utils.h"
+#include "tensorflow/core/profiler/backends/cpu/perf_counters.h"
 #include "tensorflow/core/profiler/backends/cpu/traceme_recorder.h"
 #include "tensorflow/core/profiler/lib/profiler_interface.h"
 #include "tensorflow/core/profiler/protobuf/xplane.pb.h"
@@ -39,7 +41,7 @@ namespace {
 // Thread-safety: This class is go/thread-compatible.
 class HostTracer : public ProfilerInterface {
  public:
-  explicit HostTracer(int host_trace_level);
+  explicit HostTracer(const HostTracerOptions& options);
   ~HostTracer() override;
 
   Status Start() override;
@@ -52,6 +54,9 @@ class HostTracer : public ProfilerInterface {
   // Level of host tracing.
   const int host_trace_level_;
 
+  // Whether to read the perf counters for the traced ops.
+  const bool enable_perf_counters_;
+
   // True if currently recording.
   bool recording_ = false;
 
@@ -62,8 +67,9 @@ class HostTracer : public ProfilerInterface {
   TraceMeRecorder::Events events_;
 };
 
-HostTracer::HostTracer(int host_trace_level)
-    : host_trace_level_(host_trace_level) {}
+HostTracer::HostTracer(const HostTracerOptions& options)
+    : host_trace_level_(options.trace_level),
+      enable_perf_counters_(options.enable_perf_counters) {}
 
 HostTracer::~HostTracer() { Stop().IgnoreError(); }
 
@@ -80,6 +86,9 @@ Status HostTracer::Start() {
   if (!recording_) {
     return errors::Internal("Failed to start TraceMeRecorder");
   }
+  if (enable_perf_counters_ && !PerfCounters::Enable()) {
+    LOG(WARNING) << "Hardware performance counters are unavailable.";
+  }
   return OkStatus();
 }
 
@@ -87,6 +96,7 @@ Status HostTracer::Stop() {
   if (!recording_) {
     return errors::Internal("TraceMeRecorder not started");
   }
+  if (enable_perf_counters_) PerfCounters::Disable();
   events_ = TraceMeRecorder::Stop();
   recording_ = false;
   return OkStatus();
@@ -111,7 +121,7 @@ Status HostTracer::CollectData(XSpace* space) {
 std::unique_ptr<ProfilerInterface> CreateHostTracer(
     const HostTracerOptions& options) {
   if (options.trace_level == 0) return nullptr;
-  return absl::make_unique<HostTracer>(options.trace_level);
+  return absl::make_unique<HostTracer>(options);
 }
 
 }  // namespace profiler
@@ -32,6 +32,10 @@ struct HostTracerOptions {
   // - Level 3 enables tracing of all level 2 TraceMe(s) and more verbose
   //           (low-level) program execution details (cheap TF ops, etc).
   int trace_level = 2;
+
+  // Whether to attach the hardware performance counters of the host threads
+  // to the traced ops, if available.
+  bool enable_perf_counters = false;
 };
 
 std::unique_ptr<ProfilerInterface> CreateHostTracer(
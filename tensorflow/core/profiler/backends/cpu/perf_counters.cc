@@ -0,0 +1,139 @@
+/* Copyright 2022 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/profiler/backends/cpu/perf_counters.h"
+
+#include <atomic>
+#include <string>
+
+#include "tensorflow/core/platform/logging.h"
+#include "tensorflow/core/platform/types.h"
+#include "tensorflow/core/profiler/lib/traceme_encode.h"
+
+#if defined(__linux__)
+#include <linux/perf_event.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include <cstring>
+#endif
+
+namespace tensorflow {
+namespace profiler {
+namespace internal {
+
+std::atomic<bool> g_perf_counters_enabled(false);
+
+}  // namespace internal
+
+namespace {
+
+#if defined(__linux__)
+
+// The counters of a thread, read together as a group.
+class ThreadPerfCounters {
+ public:
+  ThreadPerfCounters() {
+    fds_[0] = Open(PERF_COUNT_HW_CPU_CYCLES, /*group_fd=*/-1);
+    if (fds_[0] < 0) return;
+    fds_[1] = Open(PERF_COUNT_HW_INSTRUCTIONS, fds_[0]);
+    fds_[2] = Open(PERF_COUNT_HW_CACHE_MISSES, fds_[0]);
+    if (fds_[1] < 0 || fds_[2] < 0) {
+      VLOG(1) << "Failed to open the perf event counters.";
+      Close();
+    }
+  }
+
+  ~ThreadPerfCounters() { Close(); }
+
+  bool Read(PerfCounterValues* values) const {
+    if (fds_[0] < 0) return false;
+    // The number of counters followed by their values.
+    uint64 buffer[1 + kNumCounters];
+    if (read(fds_[0], buffer, sizeof(buffer)) != sizeof(buffer) ||
+        buffer[0] != kNumCounters) {
+      return false;
+    }
+    values->cycles = buffer[1];
+    values->instructions = buffer[2];
+    values->llc_misses = buffer[3];
+    return true;
+  }
+
+ private:
+  static constexpr int kNumCounters = 3;
+
+  static int Open(uint64 config, int group_fd) {
+    perf_event_attr attr;
+    memset(&attr, 0, sizeof(attr));
+    attr.type = PERF_TYPE_HARDWARE;
+    attr.size = sizeof(attr);
+    attr.config = config;
+    attr.read_format = PERF_FORMAT_GROUP;
+    // Counting user space only works with the default perf_event_paranoid.
+    attr.exclude_kernel = 1;
+    attr.exclude_hv = 1;
+    return syscall(__NR_perf_event_open, &attr, /*pid=*/0, /*cpu=*/-1,
+                   group_fd, /*flags=*/0);
+  }
+
+  void Close() {
+    for (int& fd : fds_) {
+      if (fd >= 0) close(fd);
+      fd = -1;
+    }
+  }
+
+  int fds_[kNumCounters] = {-1, -1, -1};
+};
+
+const ThreadPerfCounters& GetThreadPerfCounters() {
+  static thread_local ThreadPerfCounters counters;
+  return counters;
+}
+
+#endif  // defined(__linux__)
+
+}  // namespace
+
+/*static*/ bool PerfCounters::Enable() {
+  PerfCounterValues values;
+  if (!Read(&values)) return false;
+  internal::g_perf_counters_enabled.store(true, std::memory_order_release);
+  return true;
+}
+
+/*static*/ void PerfCounters::Disable() {
+  internal::g_perf_counters_enabled.store(false, std::memory_order_release);
+}
+
+/*static*/ bool PerfCounters::Read(PerfCounterValues* values) {
+#if defined(__linux__)
+  return GetThreadPerfCounters().Read(values);
+#else
+  return false;
+#endif
+}
+
+std::string PerfCounterScope::EncodeDeltas() const {
+  PerfCounterValues end;
+  if (!active_ || !PerfCounters::Read(&end)) return "";
+  return TraceMeEncode({{"cpu_cycles", end.cycles - start_.cycles},
+                        {"cpu_instructions",
+                         end.instructions - start_.instructions},
+                        {"llc_misses", end.llc_misses - start_.llc_misses}});
+}
+
+}  // namespace profiler
+}  // namespace tensorflow
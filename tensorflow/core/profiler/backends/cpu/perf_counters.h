@@ -0,0 +1,95 @@
+/* Copyright 2022 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_CORE_PROFILER_BACKENDS_CPU_PERF_COUNTERS_H_
+#define TENSORFLOW_CORE_PROFILER_BACKENDS_CPU_PERF_COUNTERS_H_
+
+#include <atomic>
+#include <string>
+
+#include "tensorflow/core/platform/macros.h"
+#include "tensorflow/core/platform/types.h"
+
+namespace tensorflow {
+namespace profiler {
+namespace internal {
+
+// Whether the counters are read for the traced ops.
+// Static atomic so PerfCounters::Enabled can be fast and non-blocking.
+TF_EXPORT extern std::atomic<bool> g_perf_counters_enabled;
+
+}  // namespace internal
+
+// Hardware performance counters of a thread, counted in user space only.
+struct PerfCounterValues {
+  uint64 cycles = 0;
+  uint64 instructions = 0;
+  // Last level cache misses.
+  uint64 llc_misses = 0;
+};
+
+// Reads hardware performance counters of the calling thread with the Linux
+// perf_event interface. The counters of a thread are opened on its first read
+// and stay open until the thread exits. Unavailable on other platforms, or if
+// the kernel doesn't allow perf events (see perf_event_paranoid).
+class PerfCounters {
+ public:
+  // Enables reading counters for the traced ops. Returns false if the counters
+  // are unavailable.
+  static bool Enable();
+
+  static void Disable();
+
+  static bool Enabled() {
+    return internal::g_perf_counters_enabled.load(std::memory_order_acquire);
+  }
+
+  // Reads the counters of the calling thread. Returns false if they are
+  // unavailable.
+  static bool Read(PerfCounterValues* values);
+};
+
+// Reads the counters of the calling thread when constructed, if the counters
+// are enabled, to encode the counts of the scope in TraceMe metadata, e.g.:
+//
+//   profiler::TraceMe trace_me("op");
+//   profiler::PerfCounterScope perf_counters;
+//   ... compute ...
+//   if (perf_counters.active()) {
+//     trace_me.AppendMetadata([&] { return perf_counters.EncodeDeltas(); });
+//   }
+class PerfCounterScope {
+ public:
+  PerfCounterScope()
+      : active_(PerfCounters::Enabled() && PerfCounters::Read(&start_)) {}
+
+  bool active() const { return active_; }
+
+  // Returns the counts since construction as the "cpu_cycles",
+  // "cpu_instructions" and "llc_misses" TraceMe metadata, or an empty string if
+  // the counters can't be read.
+  std::string EncodeDeltas() const;
+
+ private:
+  // Declared first, as it is set while active_ is initialized.
+  PerfCounterValues start_;
+  const bool active_;
+
+  TF_DISALLOW_COPY_AND_ASSIGN(PerfCounterScope);
+};
+
+}  // namespace profiler
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_PROFILER_BACKENDS_CPU_PERF_COUNTERS_H_
@@ -0,0 +1,54 @@
+/* Copyright 2022 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/profiler/backends/cpu/perf_counters.h"
+
+#include <string>
+
+#include "absl/strings/match.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace profiler {
+namespace {
+
+TEST(PerfCountersTest, EncodeDeltas) {
+  if (!PerfCounters::Enable()) {
+    GTEST_SKIP() << "Perf event counters are unavailable.";
+  }
+  PerfCounterValues start;
+  ASSERT_TRUE(PerfCounters::Read(&start));
+  std::string encoded;
+  {
+    PerfCounterScope perf_counters;
+    ASSERT_TRUE(perf_counters.active());
+    volatile double sum = 0;
+    for (int i = 0; i < 100000; ++i) sum = sum + i;
+    encoded = perf_counters.EncodeDeltas();
+  }
+  PerfCounterValues end;
+  ASSERT_TRUE(PerfCounters::Read(&end));
+  EXPECT_GT(end.cycles, start.cycles);
+  EXPECT_GT(end.instructions, start.instructions);
+  EXPECT_TRUE(absl::StartsWith(encoded, "#cpu_cycles=")) << encoded;
+  EXPECT_TRUE(absl::StrContains(encoded, ",cpu_instructions=")) << encoded;
+  EXPECT_TRUE(absl::StrContains(encoded, ",llc_misses=")) << encoded;
+
+  PerfCounters::Disable();
+  EXPECT_FALSE(PerfCounterScope().active());
+}
+
+}  // namespace
+}  // namespace profiler
+}  // namespace tensorflow
@@ -45,6 +45,12 @@ static_assert(ATOMIC_INT_LOCK_FREE == 2, "Assumed atomic<int> was lock free");
 
 namespace {
 
+// The options of sampling, set while holding TraceMeRecorder::mutex_ before
+// the trace level is raised. `g_sampling_events_per_thread` is zero when not
+// sampling.
+std::atomic<size_t> g_sampling_events_per_thread(0);
+std::atomic<int64_t> g_sampling_min_duration_ns(0);
+
 // Track events created by ActivityStart and merge their data into events
 // created by ActivityEnd. TraceMe records events in its destructor, so this
 // results in complete events sorted by their end_time in the thread they ended.
@@ -261,6 +267,44 @@ class TraceMeRecorder::ThreadLocalRecorder {
   // Record is only called from the owner thread.
   void Record(TraceMeRecorder::Event&& event) { queue_.Push(std::move(event)); }
 
+  // RecordSample is only called from the owner thread. Keeps `event` in place
+  // of the oldest one once `capacity` events are kept.
+  void RecordSample(TraceMeRecorder::Event&& event, size_t capacity) {
+    mutex_lock lock(samples_mutex_);
+    if (samples_.size() > capacity) ClearSamplesLocked();
+    if (samples_.size() < capacity) {
+      samples_.push_back(std::move(event));
+    } else {
+      samples_[next_sample_] = std::move(event);
+      next_sample_ = (next_sample_ + 1) % capacity;
+    }
+  }
+
+  // GetSamples and ClearSamples are called from the control thread.
+  TF_MUST_USE_RESULT TraceMeRecorder::ThreadEvents GetSamples(
+      SplitEventTracker* split_event_tracker) {
+    TraceMeRecorder::ThreadEvents result = {info_, {}};
+    mutex_lock lock(samples_mutex_);
+    for (size_t i = 0; i < samples_.size(); ++i) {
+      TraceMeRecorder::Event event =
+          samples_[(next_sample_ + i) % samples_.size()];
+      if (event.IsStart()) {
+        split_event_tracker->AddStart(std::move(event));
+        continue;
+      }
+      result.events.push_back(std::move(event));
+      if (result.events.back().IsEnd()) {
+        split_event_tracker->AddEnd(&result.events.back());
+      }
+    }
+    return result;
+  }
+
+  void ClearSamples() {
+    mutex_lock lock(samples_mutex_);
+    ClearSamplesLocked();
+  }
+
   // Clear is called from the control thread when tracing starts to remove any
   // elements added due to Record racing with Consume.
   void Clear() { queue_.Clear(); }
@@ -272,9 +316,21 @@ class TraceMeRecorder::ThreadLocalRecorder {
   }
 
  private:
+  void ClearSamplesLocked() TF_EXCLUSIVE_LOCKS_REQUIRED(samples_mutex_) {
+    samples_.clear();
+    next_sample_ = 0;
+  }
+
   TraceMeRecorder::ThreadInfo info_;
   EventQueue queue_;
   std::atomic<int> active_{1};  // std::atomic<bool> is not always lock-free.
+
+  // A ring buffer of the events kept by sampling. Only contended while the
+  // samples are dumped.
+  mutex samples_mutex_;
+  std::vector<TraceMeRecorder::Event> samples_ TF_GUARDED_BY(samples_mutex_);
+  // The slot to overwrite once `samples_` is full, i.e. the oldest event.
+  size_t next_sample_ TF_GUARDED_BY(samples_mutex_) = 0;
 };
 
 // An instance of this wrapper is allocated in thread_local storage.
@@ -292,6 +348,10 @@ class TraceMeRecorder::ThreadLocalRecorderWrapper {
     recorder_->Record(std::move(event));
   }
 
+  void RecordSample(TraceMeRecorder::Event&& event, size_t capacity) {
+    recorder_->RecordSample(std::move(event), capacity);
+  }
+
   ~ThreadLocalRecorderWrapper() {
     recorder_->SetInactive();
     TraceMeRecorder::Get()->UnregisterThread(recorder_->ThreadId());
@@ -316,8 +376,13 @@ void TraceMeRecorder::RegisterThread(
 }
 
 void TraceMeRecorder::UnregisterThread(uint32 tid) {
-  // If tracing is active, keep the ThreadLocalRecorder alive.
-  if (Active()) return;
+  // If tracing is active, keep the ThreadLocalRecorder alive. The samples of
+  // finished threads are dropped, so that sampling can stay on while threads
+  // come and go.
+  if (Active() &&
+      g_sampling_events_per_thread.load(std::memory_order_acquire) == 0) {
+    return;
+  }
   // If tracing is inactive, destroy the ThreadLocalRecorder.
   mutex_lock lock(mutex_);
   threads_.erase(tid);
@@ -381,12 +446,28 @@ bool TraceMeRecorder::StartRecording(int level) {
 
 void TraceMeRecorder::Record(Event&& event) {
   static thread_local ThreadLocalRecorderWrapper thread_local_recorder;
+  const size_t sampling_events_per_thread =
+      g_sampling_events_per_thread.load(std::memory_order_relaxed);
+  if (TF_PREDICT_FALSE(sampling_events_per_thread > 0)) {
+    if (event.IsComplete() &&
+        event.end_time - event.start_time <
+            g_sampling_min_duration_ns.load(std::memory_order_relaxed)) {
+      return;
+    }
+    thread_local_recorder.RecordSample(std::move(event),
+                                       sampling_events_per_thread);
+    return;
+  }
   thread_local_recorder.Record(std::move(event));
 }
 
 TraceMeRecorder::Events TraceMeRecorder::StopRecording() {
   TraceMeRecorder::Events events;
   mutex_lock lock(mutex_);
+  // Sampling is stopped by StopSampling().
+  if (g_sampling_events_per_thread.load(std::memory_order_relaxed) > 0) {
+    return events;
+  }
   // Change trace_level_ while holding mutex_.
   if (internal::g_trace_level.exchange(
           kTracingDisabled, std::memory_order_acq_rel) != kTracingDisabled) {
@@ -395,6 +476,57 @@ TraceMeRecorder::Events TraceMeRecorder::StopRecording() {
   return events;
 }
 
+bool TraceMeRecorder::StartSamplingInternal(const SamplingOptions& options) {
+  if (options.level <= 0 || options.events_per_thread == 0) return false;
+  mutex_lock lock(mutex_);
+  if (internal::g_trace_level.load(std::memory_order_acquire) !=
+      kTracingDisabled) {
+    return false;
+  }
+  for (auto& id_and_recorder : threads_) {
+    id_and_recorder.second->ClearSamples();
+  }
+  g_sampling_min_duration_ns.store(options.min_duration_ns,
+                                   std::memory_order_relaxed);
+  g_sampling_events_per_thread.store(options.events_per_thread,
+                                     std::memory_order_release);
+  // Raise the trace level last, so that events are only recorded once the
+  // sampling options are visible.
+  internal::g_trace_level.store(options.level, std::memory_order_release);
+  return true;
+}
+
+TraceMeRecorder::Events TraceMeRecorder::DumpSamplesInternal() {
+  TraceMeRecorder::Events result;
+  mutex_lock lock(mutex_);
+  if (g_sampling_events_per_thread.load(std::memory_order_relaxed) == 0) {
+    return result;
+  }
+  result.reserve(threads_.size());
+  SplitEventTracker split_event_tracker;
+  for (auto& id_and_recorder : threads_) {
+    TraceMeRecorder::ThreadEvents events =
+        id_and_recorder.second->GetSamples(&split_event_tracker);
+    if (!events.events.empty()) {
+      result.push_back(std::move(events));
+    }
+  }
+  split_event_tracker.HandleCrossThreadEvents();
+  return result;
+}
+
+void TraceMeRecorder::StopSamplingInternal() {
+  mutex_lock lock(mutex_);
+  if (g_sampling_events_per_thread.load(std::memory_order_relaxed) == 0) {
+    return;
+  }
+  internal::g_trace_level.store(kTracingDisabled, std::memory_order_release);
+  g_sampling_events_per_thread.store(0, std::memory_order_release);
+  for (auto& id_and_recorder : threads_) {
+    id_and_recorder.second->ClearSamples();
+  }
+}
+
 /*static*/ int64_t TraceMeRecorder::NewActivityId() {
   // Activity IDs: To avoid contention over a counter, the top 32 bits identify
   // the originating thread, the bottom 32 bits name the event within a thread.
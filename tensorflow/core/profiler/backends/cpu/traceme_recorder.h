@@ -49,6 +49,12 @@ TF_EXPORT extern std::atomic<int> g_trace_level;
 // events. TraceMe::ActivityStart records start events, and TraceMe::ActivityEnd
 // records end events. The profiler then stops the recorder and finds start/end
 // pairs. (Unpaired start/end events are discarded at that point).
+//
+// Alternatively, StartSampling() arms the recorder to keep only the most recent
+// events of each thread, optionally only those lasting at least a threshold,
+// in per-thread ring buffers that can be inspected with DumpSamples() at any
+// time, e.g. after a request took too long. Sampling and Start() exclude each
+// other.
 class TraceMeRecorder {
  public:
   // An Event is either the start of a TraceMe, the end of a TraceMe, or both.
@@ -80,6 +86,16 @@ class TraceMeRecorder {
   };
   using Events = std::vector<ThreadEvents>;
 
+  struct SamplingOptions {
+    // Only traces <= level will be recorded. Must be positive.
+    int level = 1;
+    // Complete events shorter than this are dropped. Start and end events of
+    // TraceMe::ActivityStart/End are always kept.
+    int64_t min_duration_ns = 0;
+    // The number of most recent events kept for each thread. Must be positive.
+    size_t events_per_thread = 4096;
+  };
+
   // Starts recording of TraceMe().
   // Only traces <= level will be recorded.
   // Level must be >= 0. If level is 0, no traces will be recorded.
@@ -89,6 +105,20 @@ class TraceMeRecorder {
   // Events passed to Record after Stop has started will be dropped.
   static Events Stop() { return Get()->StopRecording(); }
 
+  // Starts keeping the most recent events of each thread, as configured by
+  // `options`. Returns false if the recorder was already started, by either
+  // Start() or StartSampling().
+  static bool StartSampling(const SamplingOptions& options) {
+    return Get()->StartSamplingInternal(options);
+  }
+
+  // Returns the events currently kept by sampling, oldest first for each
+  // thread, without removing them. Returns no events if not sampling.
+  static Events DumpSamples() { return Get()->DumpSamplesInternal(); }
+
+  // Stops sampling and drops the events kept.
+  static void StopSampling() { Get()->StopSamplingInternal(); }
+
   // Returns whether we're currently recording. Racy, but cheap!
   static inline bool Active(int level = 1) {
     return internal::g_trace_level.load(std::memory_order_acquire) >= level;
@@ -119,6 +149,9 @@ class TraceMeRecorder {
 
   bool StartRecording(int level);
   Events StopRecording();
+  bool StartSamplingInternal(const SamplingOptions& options);
+  Events DumpSamplesInternal();
+  void StopSamplingInternal();
 
   // Clears events from all active threads that were added due to Record
   // racing with StopRecording.
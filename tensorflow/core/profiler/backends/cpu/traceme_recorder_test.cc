@@ -57,6 +57,36 @@ TEST(RecorderTest, SingleThreaded) {
               ElementsAre(Named("during1"), Named("during2")));
 }
 
+TEST(RecorderTest, Sampling) {
+  int64_t start_time = GetCurrentTimeNanos();
+  TraceMeRecorder::SamplingOptions options;
+  options.min_duration_ns = 100;
+  options.events_per_thread = 2;
+  ASSERT_TRUE(TraceMeRecorder::StartSampling(options));
+  EXPECT_FALSE(TraceMeRecorder::Start(/*level=*/1));
+  EXPECT_TRUE(TraceMeRecorder::Stop().empty());
+
+  TraceMeRecorder::Record({"long1", start_time, start_time + 100});
+  TraceMeRecorder::Record({"short", start_time, start_time + 99});
+  TraceMeRecorder::Record({"long2", start_time, start_time + 1000});
+  TraceMeRecorder::Record({"long3", start_time, start_time + 1000});
+  // Dumping keeps the samples.
+  for (int i = 0; i < 2; ++i) {
+    auto results = TraceMeRecorder::DumpSamples();
+    ASSERT_EQ(results.size(), 1);
+    EXPECT_THAT(results[0].events, ElementsAre(Named("long2"), Named("long3")));
+  }
+
+  TraceMeRecorder::StopSampling();
+  EXPECT_FALSE(TraceMeRecorder::Active());
+  EXPECT_TRUE(TraceMeRecorder::DumpSamples().empty());
+  ASSERT_TRUE(TraceMeRecorder::Start(/*level=*/1));
+  TraceMeRecorder::Record({"during", start_time, start_time + 1});
+  auto results = TraceMeRecorder::Stop();
+  ASSERT_EQ(results.size(), 1);
+  EXPECT_THAT(results[0].events, ElementsAre(Named("during")));
+}
+
 // Checks the functional behavior of the recorder, when used from several
 // unsynchronized threads.
 //
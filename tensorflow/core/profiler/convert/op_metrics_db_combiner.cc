@@ -76,6 +76,9 @@ void CombineOpMetrics(const OpMetrics& src, OpMetrics* dst,
   CombineMemoryAccessedBreakdown(src.memory_accessed_breakdown(),
                                  dst->mutable_memory_accessed_breakdown());
   dst->set_dma_stall_ps(src.dma_stall_ps() + dst->dma_stall_ps());
+  dst->set_cpu_cycles(src.cpu_cycles() + dst->cpu_cycles());
+  dst->set_cpu_instructions(src.cpu_instructions() + dst->cpu_instructions());
+  dst->set_llc_misses(src.llc_misses() + dst->llc_misses());
 }
 
 void CombineMemoryAccessedBreakdown(
@@ -60,6 +60,8 @@ struct TfActivity {
   TfOp tf_op;
   // Whether it is eagerly executed.
   bool is_eager;
+  // The hardware performance counters of the Op, set on its end.
+  HostOpCounters counters;
 };
 
 // TF Op metrics stored as element in OpStack.
@@ -96,7 +98,8 @@ void ProcessOneTfActivity(const TfActivity& activity,
           PicoSpan(info->start_timestamp_ps, activity.timestamp_ps);
       tf_metrics_data->tf_metrics_db_builder.EnterOp(
           activity.tf_op.name, activity.tf_op.type, activity.is_eager,
-          tf_op_span.duration_ps(), info->children_duration_ps);
+          tf_op_span.duration_ps(), info->children_duration_ps,
+          activity.counters);
       TfOpInfo* parent_info = tf_op_stack->Top();
       if (parent_info != nullptr) {
         parent_info->children_duration_ps += tf_op_span.duration_ps();
@@ -142,11 +145,26 @@ void CollectTfActivities(const XLineVisitor& line,
               event.GetStat(StatType::kIsEager)) {
         is_eager = stat->IntValue();
       }
+      HostOpCounters counters;
+      event.ForEachStat([&counters](const XStatVisitor& stat) {
+        if (!stat.Type().has_value()) return;
+        switch (stat.Type().value()) {
+          case StatType::kCpuCycles:
+            counters.cpu_cycles = stat.IntOrUintValue();
+            break;
+          case StatType::kCpuInstructions:
+            counters.cpu_instructions = stat.IntOrUintValue();
+            break;
+          case StatType::kLlcMisses:
+            counters.llc_misses = stat.IntOrUintValue();
+            break;
+        }
+      });
       Timespan span = event.GetTimespan();
       tf_activities->push_back(
           {span.begin_ps(), tf_op_id, kTfOpBegin, *tf_op, is_eager});
       tf_activities->push_back(
-          {span.end_ps(), tf_op_id, kTfOpEnd, *tf_op, is_eager});
+          {span.end_ps(), tf_op_id, kTfOpEnd, *tf_op, is_eager, counters});
     }
   });
 }
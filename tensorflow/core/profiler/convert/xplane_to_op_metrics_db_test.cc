@@ -101,6 +101,39 @@ TEST(ConvertXPlaneToOpMetricsDb, HostOpMetricsDb) {
   EXPECT_EQ(NanoToPico(kTfOp2DurationNs), op_2.time_ps());
 }
 
+TEST(ConvertXPlaneToOpMetricsDb, HostOpHardwareCounters) {
+  static constexpr char kTfOp1[] = "TfOp1";
+
+  XSpace xspace;
+  XPlane* xplane = GetOrCreateHostXPlane(&xspace);
+  XPlaneBuilder host_plane(xplane);
+  XLineBuilder thread = host_plane.GetOrCreateLine(/*line_id=*/10);
+  for (int64_t start_ns : {100000, 200000}) {
+    XEventBuilder event = thread.AddEvent(*host_plane.GetOrCreateEventMetadata(
+        absl::StrCat(kTfOp1, ":", kTfOp1)));
+    event.SetTimestampNs(start_ns);
+    event.SetDurationNs(1000);
+    event.AddStatValue(*host_plane.GetOrCreateStatMetadata(
+                           GetStatTypeStr(StatType::kCpuCycles)),
+                       uint64{1000});
+    event.AddStatValue(*host_plane.GetOrCreateStatMetadata(
+                           GetStatTypeStr(StatType::kCpuInstructions)),
+                       uint64{3000});
+    event.AddStatValue(*host_plane.GetOrCreateStatMetadata(
+                           GetStatTypeStr(StatType::kLlcMisses)),
+                       uint64{6});
+  }
+
+  OpMetricsDb op_metrics = ConvertHostThreadsXPlaneToOpMetricsDb(*xplane);
+  const OpMetrics& op_1 = op_metrics.metrics_db().at(0);
+  EXPECT_EQ(kTfOp1, op_1.name());
+  EXPECT_EQ(2000, op_1.cpu_cycles());
+  EXPECT_EQ(6000, op_1.cpu_instructions());
+  EXPECT_EQ(12, op_1.llc_misses());
+  EXPECT_EQ(3.0, InstructionsPerCycle(op_1).value_or(0));
+  EXPECT_EQ(2.0, LlcMissesPerKiloInstructions(op_1).value_or(0));
+}
+
 TEST(ConvertXPlaneToOpMetricsDb, DeviceOpMetricsDb) {
   // TfOp1 has kernel1 and kernel2; TfOp2 has kernel3.
   static constexpr char kTfOp1[] = "TfOp1";
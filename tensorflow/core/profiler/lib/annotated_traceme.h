@@ -48,6 +48,15 @@ class AnnotatedTraceMe {
     }
   }
 
+  // Appends metadata to the TraceMe, see TraceMe::AppendMetadata.
+  template <typename MetadataGeneratorT>
+  void AppendMetadata(MetadataGeneratorT&& metadata_generator) {
+    if (trace_me_.has_value()) {
+      trace_me_->AppendMetadata(
+          std::forward<MetadataGeneratorT>(metadata_generator));
+    }
+  }
+
  private:
   absl::optional<TraceMe> trace_me_;
   absl::optional<ScopedAnnotation> scoped_annotation_;
@@ -85,6 +85,41 @@ Status ProfilerSession::CollectData(profiler::XSpace* space) {
   return OkStatus();
 }
 
+Status ProfilerSession::CollectDataAndRestart(profiler::XSpace* space,
+                                              uint64* start_time_ns,
+                                              uint64* end_time_ns) {
+#if defined(IS_MOBILE_PLATFORM)
+  return errors::Unimplemented(
+      "Profiler is unimplemented for mobile platforms.");
+#else
+  std::unique_ptr<profiler::ProfilerInterface> profilers;
+  uint64 interval_start_time_ns;
+  uint64 interval_end_time_ns;
+  {
+    mutex_lock l(mutex_);
+    TF_RETURN_IF_ERROR(status_);
+    if (profilers_ == nullptr) {
+      return errors::FailedPrecondition(
+          "Profiler session data has already been collected.");
+    }
+    profilers_->Stop().IgnoreError();
+    profilers = std::move(profilers_);
+    interval_start_time_ns = start_time_ns_;
+    interval_end_time_ns = profiler::GetCurrentTimeNanos();
+    start_time_ns_ = interval_end_time_ns;
+    profilers_ = absl::make_unique<profiler::ProfilerCollection>(
+        profiler::CreateProfilers(options_));
+    profilers_->Start().IgnoreError();
+  }
+  space->add_hostnames(port::Hostname());
+  profilers->CollectData(space).IgnoreError();
+  PostProcessSingleHostXSpace(space, interval_start_time_ns);
+  if (start_time_ns != nullptr) *start_time_ns = interval_start_time_ns;
+  if (end_time_ns != nullptr) *end_time_ns = interval_end_time_ns;
+  return OkStatus();
+#endif
+}
+
 ProfilerSession::ProfilerSession(const ProfileOptions& options)
 #if defined(IS_MOBILE_PLATFORM)
     : status_(errors::Unimplemented(
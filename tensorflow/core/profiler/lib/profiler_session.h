@@ -65,6 +65,16 @@ class ProfilerSession {
   tensorflow::Status CollectData(profiler::XSpace* space)
       TF_LOCKS_EXCLUDED(mutex_);
 
+  // Collects the profile data since the session started or the last call into
+  // XSpace, and keeps profiling. The profilers are stopped and new ones are
+  // started before the data is collected, so that the gap between two
+  // intervals is as short as possible. If not null, `*start_time_ns` and
+  // `*end_time_ns` are set to the collected interval.
+  tensorflow::Status CollectDataAndRestart(profiler::XSpace* space,
+                                           uint64* start_time_ns = nullptr,
+                                           uint64* end_time_ns = nullptr)
+      TF_LOCKS_EXCLUDED(mutex_);
+
  private:
   friend class DeviceProfilerSession;
 
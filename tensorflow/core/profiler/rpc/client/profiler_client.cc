@@ -83,6 +83,28 @@ Status MonitorGrpc(const std::string& service_address,
   return OkStatus();
 }
 
+Status ProfileStreamGrpc(
+    const std::string& service_address, const ProfileStreamRequest& request,
+    const std::function<bool(const ProfileStreamResponse&)>& on_chunk) {
+  ::grpc::ClientContext context;
+  std::unique_ptr<grpc::ProfilerService::Stub> stub =
+      CreateStub<grpc::ProfilerService>(service_address);
+  std::unique_ptr<::grpc::ClientReader<ProfileStreamResponse>> reader =
+      stub->ProfileStream(&context, request);
+  ProfileStreamResponse chunk;
+  while (reader->Read(&chunk)) {
+    if (!on_chunk(chunk)) {
+      context.TryCancel();
+      // Drains the stream so that Finish doesn't block.
+      while (reader->Read(&chunk)) {
+      }
+      reader->Finish().ok();
+      return OkStatus();
+    }
+  }
+  return FromGrpcStatus(reader->Finish());
+}
+
 /*static*/ std::unique_ptr<RemoteProfilerSession> RemoteProfilerSession::Create(
     const std::string& service_address, absl::Time deadline,
     const ProfileRequest& profile_request) {
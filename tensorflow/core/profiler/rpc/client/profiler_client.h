@@ -17,6 +17,7 @@ limitations under the License.
 #ifndef TENSORFLOW_CORE_PROFILER_RPC_CLIENT_PROFILER_CLIENT_H_
 #define TENSORFLOW_CORE_PROFILER_RPC_CLIENT_PROFILER_CLIENT_H_
 
+#include <functional>
 #include <memory>
 #include <string>
 
@@ -41,6 +42,13 @@ Status NewSessionGrpc(const std::string& service_address,
 Status MonitorGrpc(const std::string& service_address,
                    const MonitorRequest& request, MonitorResponse* response);
 
+// Starts a streaming profiling session and calls `on_chunk` with each chunk of
+// data it receives, until the session ends or `on_chunk` returns false, which
+// cancels the session.
+Status ProfileStreamGrpc(
+    const std::string& service_address, const ProfileStreamRequest& request,
+    const std::function<bool(const ProfileStreamResponse&)>& on_chunk);
+
 class RemoteProfilerSession {
  public:
   // Creates an instance and starts a remote profiling session immediately.
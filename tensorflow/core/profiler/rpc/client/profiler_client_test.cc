@@ -16,6 +16,7 @@ limitations under the License.
 
 #include <memory>
 #include <string>
+#include <vector>
 
 #include "absl/time/clock.h"
 #include "absl/time/time.h"
@@ -147,6 +148,56 @@ TEST(RemoteProfilerSession, LongDuration) {
   EXPECT_THAT(elapsed, DurationApproxLess(max_duration));
 }
 
+TEST(ProfileStreamGrpc, FlushesChunks) {
+  absl::Duration duration = absl::Milliseconds(500);
+  ProfileRequest profile_request;
+  std::string service_addr;
+  auto server = StartServer(duration, &service_addr, &profile_request);
+
+  ProfileStreamRequest request;
+  *request.mutable_opts() = profile_request.opts();
+  request.set_flush_interval_ms(100);
+  request.set_session_id("test_stream_session");
+  request.set_include_xspace(true);
+  request.set_include_op_stats(true);
+  std::vector<ProfileStreamResponse> chunks;
+  Status status = ProfileStreamGrpc(service_addr, request,
+                                    [&](const ProfileStreamResponse& chunk) {
+                                      chunks.push_back(chunk);
+                                      return true;
+                                    });
+  EXPECT_TRUE(status.ok()) << status;
+  ASSERT_GE(chunks.size(), 2);
+  for (int i = 0; i < chunks.size(); ++i) {
+    EXPECT_EQ(chunks[i].sequence_number(), i);
+    EXPECT_LE(chunks[i].start_time_ns(), chunks[i].end_time_ns());
+    EXPECT_FALSE(chunks[i].xspace().empty());
+    // Consecutive chunks cover adjacent intervals.
+    if (i > 0) {
+      EXPECT_GE(chunks[i].start_time_ns(), chunks[i - 1].end_time_ns());
+    }
+  }
+}
+
+TEST(ProfileStreamGrpc, StopsWhenCallbackReturnsFalse) {
+  absl::Duration duration = absl::Seconds(30);
+  ProfileRequest profile_request;
+  std::string service_addr;
+  auto server = StartServer(duration, &service_addr, &profile_request);
+
+  ProfileStreamRequest request;
+  *request.mutable_opts() = profile_request.opts();
+  request.set_flush_interval_ms(10);
+  int num_chunks = 0;
+  absl::Time approx_start = absl::Now();
+  Status status = ProfileStreamGrpc(
+      service_addr, request,
+      [&](const ProfileStreamResponse& chunk) { return ++num_chunks < 3; });
+  EXPECT_TRUE(status.ok()) << status;
+  EXPECT_EQ(num_chunks, 3);
+  EXPECT_THAT(absl::Now() - approx_start, DurationApproxLess(duration / 2));
+}
+
 }  // namespace
 }  // namespace profiler
 }  // namespace tensorflow
@@ -15,6 +15,8 @@ limitations under the License.
 
 #include "tensorflow/core/profiler/rpc/profiler_service_impl.h"
 
+#include <algorithm>
+#include <limits>
 #include <memory>
 
 #include "grpcpp/support/status.h"
@@ -27,9 +29,11 @@ limitations under the License.
 #include "tensorflow/core/platform/macros.h"
 #include "tensorflow/core/platform/mutex.h"
 #include "tensorflow/core/platform/status.h"
+#include "tensorflow/core/profiler/convert/xplane_to_op_stats.h"
 #include "tensorflow/core/profiler/lib/profiler_session.h"
 #include "tensorflow/core/profiler/profiler_service.grpc.pb.h"
 #include "tensorflow/core/profiler/profiler_service.pb.h"
+#include "tensorflow/core/profiler/protobuf/op_stats.pb.h"
 #include "tensorflow/core/profiler/protobuf/xplane.pb.h"
 #include "tensorflow/core/profiler/utils/file_system_utils.h"
 #include "tensorflow/core/profiler/utils/time_utils.h"
@@ -69,6 +73,29 @@ Status CollectDataToRepository(const ProfileRequest& request,
   return WriteBinaryProto(Env::Default(), out_path, xspace);
 }
 
+// Collects the data of the last interval of a streaming session into a chunk.
+Status CollectChunk(const ProfileStreamRequest& request,
+                    ProfilerSession* profiler, ProfileStreamResponse* chunk) {
+  XSpace xspace;
+  uint64 start_time_ns;
+  uint64 end_time_ns;
+  TF_RETURN_IF_ERROR(
+      profiler->CollectDataAndRestart(&xspace, &start_time_ns, &end_time_ns));
+  chunk->set_start_time_ns(start_time_ns);
+  chunk->set_end_time_ns(end_time_ns);
+  if (request.include_op_stats()) {
+    OpStatsOptions options;
+    options.generate_op_metrics_db = true;
+    options.generate_kernel_stats_db = true;
+    ConvertXSpaceToOpStats(xspace, options)
+        .SerializeToString(chunk->mutable_op_stats());
+  }
+  if (request.include_xspace()) {
+    xspace.SerializeToString(chunk->mutable_xspace());
+  }
+  return OkStatus();
+}
+
 class ProfilerServiceImpl : public grpc::ProfilerService::Service {
  public:
   ::grpc::Status Monitor(::grpc::ServerContext* ctx, const MonitorRequest* req,
@@ -111,6 +138,62 @@ class ProfilerServiceImpl : public grpc::ProfilerService::Service {
     return ::grpc::Status::OK;
   }
 
+  ::grpc::Status ProfileStream(
+      ::grpc::ServerContext* ctx, const ProfileStreamRequest* req,
+      ::grpc::ServerWriter<ProfileStreamResponse>* writer) override {
+    VLOG(1) << "Received a profile stream request: " << req->DebugString();
+    if (req->flush_interval_ms() == 0) {
+      return ::grpc::Status(::grpc::StatusCode::INVALID_ARGUMENT,
+                            "flush_interval_ms must be positive.");
+    }
+    std::unique_ptr<ProfilerSession> profiler =
+        ProfilerSession::Create(req->opts());
+    Status status = profiler->Status();
+    if (!status.ok()) {
+      return ::grpc::Status(::grpc::StatusCode::INTERNAL,
+                            status.error_message());
+    }
+
+    Env* env = Env::Default();
+    const uint64 duration_ns = MilliToNano(req->opts().duration_ms());
+    const uint64 deadline = duration_ns > 0
+                                ? GetCurrentTimeNanos() + duration_ns
+                                : std::numeric_limits<uint64>::max();
+    const uint64 flush_interval_ns = MilliToNano(req->flush_interval_ms());
+    uint64 next_flush = GetCurrentTimeNanos() + flush_interval_ns;
+    bool done = false;
+    for (uint64 sequence_number = 0; !done; ++sequence_number) {
+      while (GetCurrentTimeNanos() < std::min(next_flush, deadline)) {
+        env->SleepForMicroseconds(EnvTime::kMillisToMicros);
+        if (ctx->IsCancelled()) {
+          return ::grpc::Status::CANCELLED;
+        }
+        if (TF_PREDICT_FALSE(IsStopped(req->session_id()))) {
+          mutex_lock lock(mutex_);
+          stop_signals_per_session_.erase(req->session_id());
+          done = true;
+          break;
+        }
+      }
+      done = done || GetCurrentTimeNanos() >= deadline;
+      next_flush += flush_interval_ns;
+
+      // Each chunk is released once it is written.
+      ProfileStreamResponse chunk;
+      chunk.set_sequence_number(sequence_number);
+      status = CollectChunk(*req, profiler.get(), &chunk);
+      if (!status.ok()) {
+        return ::grpc::Status(::grpc::StatusCode::INTERNAL,
+                              status.error_message());
+      }
+      if (!writer->Write(chunk)) {
+        // The stream is closed.
+        return ::grpc::Status::CANCELLED;
+      }
+    }
+    return ::grpc::Status::OK;
+  }
+
   ::grpc::Status Terminate(::grpc::ServerContext* ctx,
                            const TerminateRequest* req,
                            TerminateResponse* response) override {
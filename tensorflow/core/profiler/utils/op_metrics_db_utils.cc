@@ -104,6 +104,17 @@ void AddIdleOp(OpMetricsDb& db) {
   SetIdleOp(idle_time_ps, *db.add_metrics_db());
 }
 
+absl::optional<double> InstructionsPerCycle(const OpMetrics& metrics) {
+  if (metrics.cpu_cycles() == 0) return absl::nullopt;
+  return static_cast<double>(metrics.cpu_instructions()) /
+         metrics.cpu_cycles();
+}
+
+absl::optional<double> LlcMissesPerKiloInstructions(const OpMetrics& metrics) {
+  if (metrics.cpu_instructions() == 0) return absl::nullopt;
+  return 1000.0 * metrics.llc_misses() / metrics.cpu_instructions();
+}
+
 absl::optional<double> HostInfeedEnqueueRatio(const OpMetricsDb& db) {
   if (db.total_host_infeed_enq_start_timestamp_ps_diff() > 0) {
     // We use total_host_infeed_enq_start_timestamp_ps_diff to approximate the
@@ -98,6 +98,14 @@ inline uint64_t ChildrenTimePs(const OpMetrics& metrics) {
   return metrics.time_ps() - metrics.self_time_ps();
 }
 
+// Returns the instructions per cycle of a host op, if its hardware counters
+// were recorded.
+absl::optional<double> InstructionsPerCycle(const OpMetrics& metrics);
+
+// Returns the last level cache misses per thousand instructions of a host op,
+// if its hardware counters were recorded.
+absl::optional<double> LlcMissesPerKiloInstructions(const OpMetrics& metrics);
+
 // Returns the ratio of time spent sending data from the host to the device
 // relative to the total time the host was active.
 absl::optional<double> HostInfeedEnqueueRatio(const OpMetricsDb& db);
@@ -42,7 +42,8 @@ double GetCappedPerf(double perf, uint64 time, double rate_limit) {
 
 void HostOpMetricsDbBuilder::EnterOp(absl::string_view name,
                                      absl::string_view category, bool is_eager,
-                                     uint64 time_ps, uint64 children_time_ps) {
+                                     uint64 time_ps, uint64 children_time_ps,
+                                     const HostOpCounters& counters) {
   uint64 self_time_ps = time_ps - children_time_ps;
   DCHECK_GE(time_ps, self_time_ps);
   OpMetrics* op_metrics = LookupOrInsertNewOpMetrics(/*hlo_module_id=*/0, name);
@@ -53,6 +54,10 @@ void HostOpMetricsDbBuilder::EnterOp(absl::string_view name,
   op_metrics->set_occurrences(op_metrics->occurrences() + 1);
   op_metrics->set_time_ps(op_metrics->time_ps() + time_ps);
   op_metrics->set_self_time_ps(op_metrics->self_time_ps() + self_time_ps);
+  op_metrics->set_cpu_cycles(op_metrics->cpu_cycles() + counters.cpu_cycles);
+  op_metrics->set_cpu_instructions(op_metrics->cpu_instructions() +
+                                   counters.cpu_instructions);
+  op_metrics->set_llc_misses(op_metrics->llc_misses() + counters.llc_misses);
   db()->set_total_op_time_ps(db()->total_op_time_ps() + self_time_ps);
 }
 
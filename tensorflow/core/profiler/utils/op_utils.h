@@ -26,6 +26,13 @@ limitations under the License.
 namespace tensorflow {
 namespace profiler {
 
+// Hardware performance counters of an occurrence of a host op.
+struct HostOpCounters {
+  uint64 cpu_cycles = 0;
+  uint64 cpu_instructions = 0;
+  uint64 llc_misses = 0;
+};
+
 class HostOpMetricsDbBuilder : public OpMetricsDbBuilder {
  public:
   explicit HostOpMetricsDbBuilder(OpMetricsDb* db) : OpMetricsDbBuilder(db) {}
@@ -39,8 +46,11 @@ class HostOpMetricsDbBuilder : public OpMetricsDbBuilder {
   //             the execution time of its children.
   //   children_time_ps = the execution time of the children of this OP in
   //                      picoseconds
+  //   counters = the hardware performance counters of the OP, including its
+  //              children, or zeros if they were not recorded.
   void EnterOp(absl::string_view name, absl::string_view category,
-               bool is_eager, uint64 time_ps, uint64 children_time_ps);
+               bool is_eager, uint64 time_ps, uint64 children_time_ps,
+               const HostOpCounters& counters = {});
 
   // Updates total_host_infeed_enq_duration_ps_ and
   // total_host_infeed_enq_duration_ps_.
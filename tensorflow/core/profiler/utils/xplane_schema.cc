@@ -287,6 +287,10 @@ const StatTypeMap& GetStatTypeMap() {
       {"hlo_category", kHloCategory},
       {"tf_op_name", kTfOpName},
       {"dma_stall_duration_ps", kDmaStallDurationPs},
+      // Hardware performance counters.
+      {"cpu_cycles", kCpuCycles},
+      {"cpu_instructions", kCpuInstructions},
+      {"llc_misses", kLlcMisses},
   });
   DCHECK_EQ(stat_type_map->size(), kNumStatTypes);
   return *stat_type_map;
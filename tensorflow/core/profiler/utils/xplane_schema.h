@@ -278,7 +278,11 @@ enum StatType {
   kSymbolId,
   kTfOpName,
   kDmaStallDurationPs,
-  kLastStatType = kDmaStallDurationPs
+  // Hardware performance counters.
+  kCpuCycles,
+  kCpuInstructions,
+  kLlcMisses,
+  kLastStatType = kLlcMisses
 };
 
 inline std::string TpuPlaneName(int32_t device_ordinal) {
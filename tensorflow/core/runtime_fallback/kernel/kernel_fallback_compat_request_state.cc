@@ -14,6 +14,7 @@ limitations under the License.
 ==============================================================================*/
 #include "tensorflow/core/runtime_fallback/kernel/kernel_fallback_compat_request_state.h"
 
+#include <atomic>
 #include <functional>
 #include <memory>
 #include <optional>
@@ -58,6 +59,11 @@ static CancellationManager* GetDefaultCancellationManager() {
   return default_cancellation_manager;
 }
 
+uint64_t KernelFallbackCompatRequestState::NextUniqueId() {
+  static std::atomic<uint64_t> next_id{1};
+  return next_id.fetch_add(1, std::memory_order_relaxed);
+}
+
 KernelFallbackCompatRequestState::KernelFallbackCompatRequestState(
     std::function<void(std::function<void()>)>* runner,
     const tensorflow::DeviceMgr* device_manager, int64_t step_id,
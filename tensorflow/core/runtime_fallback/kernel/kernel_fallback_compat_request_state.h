@@ -132,7 +132,15 @@ class KernelFallbackCompatRequestState {
 
   const SessionMetadata& session_metadata() const { return session_metadata_; }
 
+  // Returns an id that is unique among the request states created in this
+  // process, and never 0.
+  uint64_t unique_id() const { return unique_id_; }
+
  private:
+  static uint64_t NextUniqueId();
+
+  const uint64_t unique_id_ = NextUniqueId();
+
   // Below are resources needed by current tensorflow.
   std::function<void(std::function<void()>)>* runner_ = nullptr;
   ::tfrt::OwnedOrUnownedPtr<ScopedStepContainer> step_container_;
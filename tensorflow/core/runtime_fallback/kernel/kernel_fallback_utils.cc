@@ -35,10 +35,17 @@ void SetUpParams(const tfrt_stub::OpKernelRunner& runner,
   params.resource_manager = runner.resource_manager();
   params.input_alloc_attrs = &runner.input_alloc_attrs();
   params.output_attr_array = runner.output_alloc_attrs().data();
-  params.step_container = fallback_request_state.step_container();
-  // Following two parameters are used to support executing tf.data via
-  // fallback.
+  // Together with `params.runner` below, used to support executing tf.data
+  // via fallback.
   params.function_library = runner.function_library_runtime();
+
+  // The per-request objects are the same for all the kernels of a request, so
+  // a reused `run_state` only needs them set up for the first one.
+  if (run_state.request_params_id == fallback_request_state.unique_id()) {
+    return;
+  }
+  run_state.request_params_id = fallback_request_state.unique_id();
+  params.step_container = fallback_request_state.step_container();
   params.runner = fallback_request_state.runner();
   params.collective_executor = fallback_request_state.collective_executor();
   params.rendezvous = fallback_request_state.rendezvous();
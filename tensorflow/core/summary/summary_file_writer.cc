@@ -14,6 +14,11 @@ limitations under the License.
 ==============================================================================*/
 #include "tensorflow/core/summary/summary_file_writer.h"
 
+#include <functional>
+#include <memory>
+#include <utility>
+#include <vector>
+
 #include "absl/strings/match.h"
 #include "absl/strings/str_cat.h"
 #include "tensorflow/core/framework/graph.pb.h"
@@ -22,6 +27,9 @@ limitations under the License.
 #include "tensorflow/core/framework/summary.pb.h"
 #include "tensorflow/core/framework/types.h"
 #include "tensorflow/core/lib/io/path.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/logging.h"
+#include "tensorflow/core/platform/mutex.h"
 #include "tensorflow/core/summary/summary_converter.h"
 #include "tensorflow/core/util/events_writer.h"
 #include "tensorflow/core/util/ptr_util.h"
@@ -31,11 +39,12 @@ namespace {
 
 class SummaryFileWriter : public SummaryWriterInterface {
  public:
-  SummaryFileWriter(int max_queue, int flush_millis, Env* env)
+  SummaryFileWriter(int max_queue, int flush_millis, int max_pending, Env* env)
       : SummaryWriterInterface(),
         is_initialized_(false),
         max_queue_(max_queue),
         flush_millis_(flush_millis),
+        max_pending_(max_pending),
         env_(env) {}
 
   Status Initialize(const string& logdir, const string& filename_suffix) {
@@ -54,102 +63,204 @@ class SummaryFileWriter : public SummaryWriterInterface {
     string sep = absl::StartsWith(filename_suffix, ".") ? "" : ".";
     const string uniquified_filename_suffix = absl::StrCat(
         ".", pid, ".", file_id_counter.fetch_add(1), sep, filename_suffix);
-    mutex_lock ml(mu_);
-    events_writer_ =
-        tensorflow::MakeUnique<EventsWriter>(io::JoinPath(logdir, "events"));
-    TF_RETURN_WITH_CONTEXT_IF_ERROR(
-        events_writer_->InitWithSuffix(uniquified_filename_suffix),
-        "Could not initialize events writer.");
-    last_flush_ = env_->NowMicros();
-    is_initialized_ = true;
+    {
+      mutex_lock ml(mu_);
+      events_writer_ =
+          tensorflow::MakeUnique<EventsWriter>(io::JoinPath(logdir, "events"));
+      TF_RETURN_WITH_CONTEXT_IF_ERROR(
+          events_writer_->InitWithSuffix(uniquified_filename_suffix),
+          "Could not initialize events writer.");
+      last_flush_ = env_->NowMicros();
+      is_initialized_ = true;
+    }
+    if (max_pending_ > 0) {
+      writer_thread_.reset(env_->StartThread(ThreadOptions(),
+                                             "tf_summary_file_writer",
+                                             [this]() { WriterLoop(); }));
+    }
     return OkStatus();
   }
 
   Status Flush() override {
+    Status async_status;
+    if (max_pending_ > 0) {
+      // Waits for the summaries enqueued so far to be written.
+      mutex_lock l(pending_mu_);
+      const int64_t enqueued = enqueued_;
+      while (written_ < enqueued) {
+        written_cv_.wait(l);
+      }
+      async_status = async_status_;
+      async_status_ = OkStatus();
+    }
     mutex_lock ml(mu_);
     if (!is_initialized_) {
       return errors::FailedPrecondition("Class was not properly initialized.");
     }
+    TF_RETURN_IF_ERROR(async_status);
     return InternalFlush();
   }
 
   ~SummaryFileWriter() override {
+    if (writer_thread_) {
+      {
+        mutex_lock l(pending_mu_);
+        shutdown_ = true;
+        pending_cv_.notify_all();
+      }
+      // Joins the writer thread once it has written the pending summaries.
+      writer_thread_.reset();
+    }
     (void)Flush();  // Ignore errors.
   }
 
   Status WriteTensor(int64_t global_step, Tensor t, const string& tag,
                      const string& serialized_metadata) override {
-    std::unique_ptr<Event> e{new Event};
-    e->set_step(global_step);
-    e->set_wall_time(GetWallTime());
-    Summary::Value* v = e->mutable_summary()->add_value();
-
-    if (t.dtype() == DT_STRING) {
-      // Treat DT_STRING specially, so that tensor_util.MakeNdarray in Python
-      // can convert the TensorProto to string-type numpy array. MakeNdarray
-      // does not work with strings encoded by AsProtoTensorContent() in
-      // tensor_content.
-      t.AsProtoField(v->mutable_tensor());
-    } else {
-      t.AsProtoTensorContent(v->mutable_tensor());
-    }
-    v->set_tag(tag);
-    if (!serialized_metadata.empty()) {
-      v->mutable_metadata()->ParseFromString(serialized_metadata);
-    }
-    return WriteEvent(std::move(e));
+    return WriteSummary(global_step, [t = std::move(t), tag,
+                                      serialized_metadata](Event* e) {
+      Summary::Value* v = e->mutable_summary()->add_value();
+      if (t.dtype() == DT_STRING) {
+        // Treat DT_STRING specially, so that tensor_util.MakeNdarray in Python
+        // can convert the TensorProto to string-type numpy array. MakeNdarray
+        // does not work with strings encoded by AsProtoTensorContent() in
+        // tensor_content.
+        t.AsProtoField(v->mutable_tensor());
+      } else {
+        t.AsProtoTensorContent(v->mutable_tensor());
+      }
+      v->set_tag(tag);
+      if (!serialized_metadata.empty()) {
+        v->mutable_metadata()->ParseFromString(serialized_metadata);
+      }
+      return OkStatus();
+    });
   }
 
   Status WriteScalar(int64_t global_step, Tensor t,
                      const string& tag) override {
-    std::unique_ptr<Event> e{new Event};
-    e->set_step(global_step);
-    e->set_wall_time(GetWallTime());
-    TF_RETURN_IF_ERROR(
-        AddTensorAsScalarToSummary(t, tag, e->mutable_summary()));
-    return WriteEvent(std::move(e));
+    return WriteSummary(global_step, [t = std::move(t), tag](Event* e) {
+      return AddTensorAsScalarToSummary(t, tag, e->mutable_summary());
+    });
   }
 
   Status WriteHistogram(int64_t global_step, Tensor t,
                         const string& tag) override {
-    std::unique_ptr<Event> e{new Event};
-    e->set_step(global_step);
-    e->set_wall_time(GetWallTime());
-    TF_RETURN_IF_ERROR(
-        AddTensorAsHistogramToSummary(t, tag, e->mutable_summary()));
-    return WriteEvent(std::move(e));
+    return WriteSummary(global_step, [t = std::move(t), tag](Event* e) {
+      return AddTensorAsHistogramToSummary(t, tag, e->mutable_summary());
+    });
   }
 
   Status WriteImage(int64_t global_step, Tensor t, const string& tag,
                     int max_images, Tensor bad_color) override {
-    std::unique_ptr<Event> e{new Event};
-    e->set_step(global_step);
-    e->set_wall_time(GetWallTime());
-    TF_RETURN_IF_ERROR(AddTensorAsImageToSummary(t, tag, max_images, bad_color,
-                                                 e->mutable_summary()));
-    return WriteEvent(std::move(e));
+    return WriteSummary(
+        global_step, [t = std::move(t), tag, max_images,
+                      bad_color = std::move(bad_color)](Event* e) {
+          return AddTensorAsImageToSummary(t, tag, max_images, bad_color,
+                                           e->mutable_summary());
+        });
   }
 
   Status WriteAudio(int64_t global_step, Tensor t, const string& tag,
                     int max_outputs, float sample_rate) override {
-    std::unique_ptr<Event> e{new Event};
-    e->set_step(global_step);
-    e->set_wall_time(GetWallTime());
-    TF_RETURN_IF_ERROR(AddTensorAsAudioToSummary(
-        t, tag, max_outputs, sample_rate, e->mutable_summary()));
-    return WriteEvent(std::move(e));
+    return WriteSummary(global_step, [t = std::move(t), tag, max_outputs,
+                                      sample_rate](Event* e) {
+      return AddTensorAsAudioToSummary(t, tag, max_outputs, sample_rate,
+                                       e->mutable_summary());
+    });
   }
 
   Status WriteGraph(int64_t global_step,
                     std::unique_ptr<GraphDef> graph) override {
+    std::shared_ptr<GraphDef> shared_graph = std::move(graph);
+    return WriteSummary(global_step, [shared_graph](Event* e) {
+      shared_graph->SerializeToString(e->mutable_graph_def());
+      return OkStatus();
+    });
+  }
+
+  Status WriteEvent(std::unique_ptr<Event> event) override {
+    if (max_pending_ > 0) {
+      return Enqueue(std::move(event), nullptr);
+    }
+    return WriteConvertedEvent(std::move(event));
+  }
+
+  string DebugString() const override { return "SummaryFileWriter"; }
+
+ private:
+  // Converts the summary input into the summary of the event. The function is
+  // called on the writer thread when summaries are written asynchronously, so
+  // it must own its inputs.
+  using ConvertFn = std::function<Status(Event*)>;
+
+  // An event whose summary is converted by the writer thread.
+  struct PendingSummary {
+    std::unique_ptr<Event> event;
+    ConvertFn convert;
+  };
+
+  double GetWallTime() {
+    return static_cast<double>(env_->NowMicros()) / 1.0e6;
+  }
+
+  Status WriteSummary(int64_t global_step, ConvertFn convert) {
     std::unique_ptr<Event> e{new Event};
     e->set_step(global_step);
     e->set_wall_time(GetWallTime());
-    graph->SerializeToString(e->mutable_graph_def());
-    return WriteEvent(std::move(e));
+    if (max_pending_ > 0) {
+      return Enqueue(std::move(e), std::move(convert));
+    }
+    TF_RETURN_IF_ERROR(convert(e.get()));
+    return WriteConvertedEvent(std::move(e));
   }
 
-  Status WriteEvent(std::unique_ptr<Event> event) override {
+  // Hands the event to the writer thread. Drops the event if max_pending_
+  // events are already waiting to be written, so that the caller never waits
+  // for the writer thread.
+  Status Enqueue(std::unique_ptr<Event> event, ConvertFn convert) {
+    mutex_lock l(pending_mu_);
+    if (pending_.size() >= static_cast<size_t>(max_pending_)) {
+      ++dropped_;
+      LOG_EVERY_N_SEC(WARNING, 60)
+          << "Dropped " << dropped_ << " summaries in total because "
+          << max_pending_ << " summaries are waiting to be written.";
+      return OkStatus();
+    }
+    pending_.push_back({std::move(event), std::move(convert)});
+    ++enqueued_;
+    pending_cv_.notify_one();
+    return OkStatus();
+  }
+
+  // Converts and writes batches of pending summaries until the writer is
+  // destroyed.
+  void WriterLoop() {
+    std::vector<PendingSummary> batch;
+    while (true) {
+      {
+        mutex_lock l(pending_mu_);
+        while (pending_.empty() && !shutdown_) {
+          pending_cv_.wait(l);
+        }
+        if (pending_.empty()) return;
+        batch.swap(pending_);
+      }
+      Status status;
+      for (PendingSummary& summary : batch) {
+        Status s = summary.convert ? summary.convert(summary.event.get())
+                                   : OkStatus();
+        if (s.ok()) s = WriteConvertedEvent(std::move(summary.event));
+        status.Update(s);
+      }
+      mutex_lock l(pending_mu_);
+      written_ += batch.size();
+      async_status_.Update(status);
+      written_cv_.notify_all();
+      batch.clear();
+    }
+  }
+
+  Status WriteConvertedEvent(std::unique_ptr<Event> event) {
     mutex_lock ml(mu_);
     queue_.emplace_back(std::move(event));
     if (queue_.size() > max_queue_ ||
@@ -159,13 +270,6 @@ class SummaryFileWriter : public SummaryWriterInterface {
     return OkStatus();
   }
 
-  string DebugString() const override { return "SummaryFileWriter"; }
-
- private:
-  double GetWallTime() {
-    return static_cast<double>(env_->NowMicros()) / 1.0e6;
-  }
-
   Status InternalFlush() TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
     for (const std::unique_ptr<Event>& e : queue_) {
       events_writer_->WriteEvent(*e);
@@ -180,6 +284,9 @@ class SummaryFileWriter : public SummaryWriterInterface {
   bool is_initialized_;
   const int max_queue_;
   const int flush_millis_;
+  // The maximum number of summaries waiting for the writer thread, or 0 if
+  // summaries are written synchronously.
+  const int max_pending_;
   uint64 last_flush_;
   Env* env_;
   mutex mu_;
@@ -188,6 +295,19 @@ class SummaryFileWriter : public SummaryWriterInterface {
   std::unique_ptr<EventsWriter> events_writer_ TF_GUARDED_BY(mu_);
   std::vector<std::pair<string, SummaryMetadata>> registered_summaries_
       TF_GUARDED_BY(mu_);
+
+  mutex pending_mu_;
+  condition_variable pending_cv_;
+  condition_variable written_cv_;
+  std::vector<PendingSummary> pending_ TF_GUARDED_BY(pending_mu_);
+  // The numbers of summaries enqueued, and enqueued and written.
+  int64_t enqueued_ TF_GUARDED_BY(pending_mu_) = 0;
+  int64_t written_ TF_GUARDED_BY(pending_mu_) = 0;
+  int64_t dropped_ TF_GUARDED_BY(pending_mu_) = 0;
+  // The errors of the writer thread since the last flush.
+  Status async_status_ TF_GUARDED_BY(pending_mu_);
+  bool shutdown_ TF_GUARDED_BY(pending_mu_) = false;
+  std::unique_ptr<Thread> writer_thread_;
 };
 
 }  // namespace
@@ -196,7 +316,17 @@ Status CreateSummaryFileWriter(int max_queue, int flush_millis,
                                const string& logdir,
                                const string& filename_suffix, Env* env,
                                SummaryWriterInterface** result) {
-  SummaryFileWriter* w = new SummaryFileWriter(max_queue, flush_millis, env);
+  return CreateAsyncSummaryFileWriter(max_queue, flush_millis,
+                                      /*max_pending=*/0, logdir,
+                                      filename_suffix, env, result);
+}
+
+Status CreateAsyncSummaryFileWriter(int max_queue, int flush_millis,
+                                    int max_pending, const string& logdir,
+                                    const string& filename_suffix, Env* env,
+                                    SummaryWriterInterface** result) {
+  SummaryFileWriter* w =
+      new SummaryFileWriter(max_queue, flush_millis, max_pending, env);
   const Status s = w->Initialize(logdir, filename_suffix);
   if (!s.ok()) {
     w->Unref();
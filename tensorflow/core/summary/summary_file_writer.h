@@ -38,6 +38,21 @@ Status CreateSummaryFileWriter(int max_queue, int flush_millis,
                                const string& filename_suffix, Env* env,
                                SummaryWriterInterface** result);
 
+/// \brief Creates SummaryWriterInterface which writes to a file from a
+/// background thread.
+///
+/// Like CreateSummaryFileWriter, except that the summaries are converted to
+/// tf.Event protos and written by a background thread, so that the summary
+/// ops only enqueue their input tensors. Up to max_pending summaries wait for
+/// the background thread; further summaries are dropped until it catches up.
+/// Flush() waits for the summaries enqueued before it to be written, and
+/// returns the errors of converting or writing them. A max_pending of 0 writes
+/// the summaries synchronously.
+Status CreateAsyncSummaryFileWriter(int max_queue, int flush_millis,
+                                    int max_pending, const string& logdir,
+                                    const string& filename_suffix, Env* env,
+                                    SummaryWriterInterface** result);
+
 }  // namespace tensorflow
 
 #endif  // TENSORFLOW_CORE_SUMMARY_SUMMARY_FILE_WRITER_H_
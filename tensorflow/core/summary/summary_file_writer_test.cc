@@ -14,6 +14,8 @@ limitations under the License.
 ==============================================================================*/
 #include "tensorflow/core/summary/summary_file_writer.h"
 
+#include <limits>
+
 #include "tensorflow/core/framework/summary.pb.h"
 #include "tensorflow/core/framework/tensor.pb.h"
 #include "tensorflow/core/framework/types.h"
@@ -281,5 +283,57 @@ TEST_F(SummaryFileWriterTest, AvoidFilenameCollision) {
       << "files = [" << absl::StrJoin(files, ", ") << "]";
 }
 
+TEST_F(SummaryFileWriterTest, AsyncWrite) {
+  const string test_name = "async_write_test";
+  const int num_steps = 20;
+  {
+    SummaryWriterInterface* writer;
+    TF_CHECK_OK(CreateAsyncSummaryFileWriter(
+        1, 1, /*max_pending=*/num_steps, testing::TmpDir(), test_name, &env_,
+        &writer));
+    core::ScopedUnref deleter(writer);
+    for (int step = 0; step < num_steps; ++step) {
+      Tensor t(DT_FLOAT, TensorShape({2}));
+      t.flat<float>().setConstant(step);
+      TF_CHECK_OK(writer->WriteHistogram(step, t, "name"));
+    }
+    TF_CHECK_OK(writer->Flush());
+
+    // Conversion errors are returned by the next flush.
+    Tensor nan(DT_FLOAT, TensorShape({}));
+    nan.scalar<float>()() = std::numeric_limits<float>::quiet_NaN();
+    TF_CHECK_OK(writer->WriteHistogram(num_steps, nan, "nan"));
+    EXPECT_TRUE(errors::IsInvalidArgument(writer->Flush()));
+    TF_CHECK_OK(writer->Flush());
+  }
+
+  std::vector<string> files;
+  TF_CHECK_OK(env_.GetChildren(testing::TmpDir(), &files));
+  int num_files = 0;
+  for (const string& f : files) {
+    if (!absl::StrContains(f, test_name)) continue;
+    ++num_files;
+    std::unique_ptr<RandomAccessFile> read_file;
+    TF_CHECK_OK(env_.NewRandomAccessFile(io::JoinPath(testing::TmpDir(), f),
+                                         &read_file));
+    io::RecordReader reader(read_file.get(), io::RecordReaderOptions());
+    tstring record;
+    uint64 offset = 0;
+    // The first event is irrelevant.
+    TF_CHECK_OK(reader.ReadRecord(&offset, &record));
+    for (int step = 0; step < num_steps; ++step) {
+      TF_CHECK_OK(reader.ReadRecord(&offset, &record));
+      Event e;
+      e.ParseFromString(record);
+      EXPECT_EQ(e.step(), step);
+      CHECK_EQ(e.summary().value_size(), 1);
+      EXPECT_EQ(e.summary().value(0).tag(), "name");
+      EXPECT_EQ(e.summary().value(0).histo().min(), step);
+    }
+    EXPECT_TRUE(errors::IsOutOfRange(reader.ReadRecord(&offset, &record)));
+  }
+  EXPECT_EQ(num_files, 1);
+}
+
 }  // namespace
 }  // namespace tensorflow
@@ -100,6 +100,10 @@ struct OpKernelRunState {
   gtl::InlinedVector<tensorflow::Tensor, 4> input_tf_tensors;
   gtl::InlinedVector<tensorflow::TensorValue, 4> input_tf_tensor_values;
   OpKernelContext::Params params;
+  // The unique id of the request whose per-request objects are set in
+  // `params`, or 0 if there is none. It allows a run state that is reused
+  // across kernels to set up those objects only once per request.
+  uint64_t request_params_id = 0;
 
   OpKernelRunState() = default;
   OpKernelRunState(
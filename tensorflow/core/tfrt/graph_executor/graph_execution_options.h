@@ -50,6 +50,18 @@ struct GraphExecutionOptions {
   tensorflow::SessionMetadata model_metadata;
 
   tensorflow::TfrtCompileOptions compile_options;
+
+  // If positive, the client graphs loaded by `GraphExecutor` are evicted in
+  // least recently used order to keep the total size of their BEF under this
+  // many bytes. The most recently loaded client graph is always kept, and an
+  // evicted one is only freed after the runs using it finish.
+  int64_t max_loaded_client_graphs_bytes = 0;
+
+  // If true and a run requests a client graph that is not loaded yet, a loaded
+  // client graph with the same feeds and targets that fetches a superset of
+  // the requested outputs is run instead, while the requested one is compiled
+  // in the background for later runs.
+  bool enable_background_compilation = false;
 };
 
 // Per-request options for graph execution.
@@ -26,6 +26,7 @@ limitations under the License.
 #include <vector>
 
 #include "absl/strings/str_cat.h"
+#include "absl/strings/str_join.h"
 #include "absl/strings/string_view.h"
 #include "absl/time/clock.h"
 #include "absl/time/time.h"
@@ -36,6 +37,7 @@ limitations under the License.
 #include "tensorflow/core/framework/tensor.h"
 #include "tensorflow/core/lib/gtl/cleanup.h"
 #include "tensorflow/core/platform/errors.h"
+#include "tensorflow/core/platform/logging.h"
 #include "tensorflow/core/platform/status.h"
 #include "tensorflow/core/platform/statusor.h"
 #include "tensorflow/core/platform/threadpool_interface.h"
@@ -335,6 +337,44 @@ void CreateSortedNamesAndOriginalIndices(absl::Span<const std::string> names,
   }
 }
 
+// Returns the position of each of the sorted `names` in the sorted
+// `superset_names`, or an empty vector if some name is missing.
+std::vector<int> FindSortedNames(absl::Span<const std::string> superset_names,
+                                 absl::Span<const std::string> names) {
+  std::vector<int> indices;
+  indices.reserve(names.size());
+  for (const auto& name : names) {
+    auto iter =
+        std::lower_bound(superset_names.begin(), superset_names.end(), name);
+    if (iter == superset_names.end() || *iter != name) return {};
+    indices.push_back(iter - superset_names.begin());
+  }
+  return indices;
+}
+
+GraphExecutor::ClientGraph CreateClientGraph(
+    std::string joined_name, absl::Span<const std::string> input_tensor_names,
+    absl::Span<const tensorflow::DataType> input_tensor_dtypes,
+    absl::Span<const std::string> output_tensor_names,
+    absl::Span<const std::string> target_tensor_names) {
+  tensorflow::GraphImportConfig::InputArrays input_nodes;
+  DCHECK_EQ(input_tensor_names.size(), input_tensor_dtypes.size());
+  for (int i = 0; i < input_tensor_names.size(); ++i) {
+    const auto& input_name = input_tensor_names[i];
+    auto input_dtype = input_tensor_dtypes[i];
+
+    tensorflow::ArrayInfo array_info;
+    array_info.imported_dtype = input_dtype;
+    array_info.shape.set_unknown_rank(true);
+    input_nodes[input_name] = array_info;
+  }
+  return GraphExecutor::ClientGraph{
+      std::move(joined_name),
+      std::move(input_nodes),
+      {output_tensor_names.begin(), output_tensor_names.end()},
+      {target_tensor_names.begin(), target_tensor_names.end()}};
+}
+
 }  // namespace
 
 tensorflow::Status GraphExecutor::Run(
@@ -375,10 +415,13 @@ tensorflow::Status GraphExecutor::Run(
   std::sort(sorted_target_node_names.begin(), sorted_target_node_names.end());
 
   // Load the client graph.
-  TF_ASSIGN_OR_RETURN(const LoadedClientGraph& loaded_client_graph,
-                      GetOrCreateLoadedClientGraph(
-                          sorted_input_names, sorted_input_dtypes,
-                          sorted_output_names, sorted_target_node_names));
+  std::vector<int> output_indices;
+  TF_ASSIGN_OR_RETURN(
+      std::shared_ptr<const LoadedClientGraph> loaded_client_graph_ptr,
+      GetOrCreateLoadedClientGraph(sorted_input_names, sorted_input_dtypes,
+                                   sorted_output_names,
+                                   sorted_target_node_names, &output_indices));
+  const LoadedClientGraph& loaded_client_graph = *loaded_client_graph_ptr;
 
   const auto* func = loaded_client_graph.bef_file->GetFunction(
       tensorflow::kImportModelDefaultGraphFuncName);
@@ -399,6 +442,16 @@ tensorflow::Status GraphExecutor::Run(
       loaded_client_graph.resource_context.get(), runtime(), fallback_state_,
       req_deadline_tracker_));
 
+  // If a client graph fetching more outputs was run, pick the requested ones.
+  if (!output_indices.empty()) {
+    std::vector<tensorflow::Tensor> selected_outputs;
+    selected_outputs.reserve(output_indices.size());
+    for (int index : output_indices) {
+      selected_outputs.push_back(flat_outputs[index]);
+    }
+    flat_outputs = std::move(selected_outputs);
+  }
+
   // Create the outputs from the actual function results, which are sorted
   // according to the output tensor names.
   auto flat_output_iter = flat_outputs.begin();
@@ -411,10 +464,55 @@ tensorflow::Status GraphExecutor::Run(
   return OkStatus();
 }
 
+tensorflow::Status GraphExecutor::Warmup(
+    absl::Span<const ClientGraphSpec> specs) {
+  for (const auto& spec : specs) {
+    if (spec.input_tensor_names.size() != spec.input_tensor_dtypes.size()) {
+      return errors::InvalidArgument(
+          "Expected as many input dtypes as input names, got ",
+          spec.input_tensor_dtypes.size(), " and ",
+          spec.input_tensor_names.size());
+    }
+    // Sort the names the same way as `Run()` does, so that the cache keys
+    // match.
+    std::vector<std::string> sorted_input_names;
+    std::vector<int> input_original_indices;
+    CreateSortedNamesAndOriginalIndices(
+        spec.input_tensor_names, sorted_input_names, input_original_indices);
+    std::vector<tensorflow::DataType> sorted_input_dtypes;
+    sorted_input_dtypes.reserve(input_original_indices.size());
+    for (int original_index : input_original_indices) {
+      sorted_input_dtypes.push_back(spec.input_tensor_dtypes[original_index]);
+    }
+
+    std::vector<std::string> sorted_output_names;
+    std::vector<int> output_original_indices;
+    CreateSortedNamesAndOriginalIndices(
+        spec.output_tensor_names, sorted_output_names, output_original_indices);
+
+    std::vector<std::string> sorted_target_node_names(
+        spec.target_tensor_names.begin(), spec.target_tensor_names.end());
+    std::sort(sorted_target_node_names.begin(),
+              sorted_target_node_names.end());
+
+    TF_RETURN_IF_ERROR(GetOrCreateLoadedClientGraph(
+                           sorted_input_names, sorted_input_dtypes,
+                           sorted_output_names, sorted_target_node_names,
+                           /*output_indices=*/nullptr)
+                           .status());
+  }
+  return OkStatus();
+}
+
 tensorflow::Status GraphExecutor::Extend(const GraphDef& graph) {
   return graph_execution_state_->Extend(graph);
 }
 
+int64_t GraphExecutor::loaded_client_graphs_bytes() {
+  tensorflow::mutex_lock l(loaded_client_graphs_mu_);
+  return loaded_client_graphs_bytes_;
+}
+
 StatusOr<std::unique_ptr<GraphExecutor::LoadedClientGraph>>
 GraphExecutor::ImportAndCompileClientGraph(
     const GraphExecutor::ClientGraph& client_graph) {
@@ -507,50 +605,132 @@ tensorflow::Status GraphExecutor::InitBef(
   return OkStatus();
 }
 
-StatusOr<std::reference_wrapper<const GraphExecutor::LoadedClientGraph>>
+StatusOr<std::shared_ptr<const GraphExecutor::LoadedClientGraph>>
 GraphExecutor::GetOrCreateLoadedClientGraph(
     absl::Span<const std::string> input_tensor_names,
     absl::Span<const tensorflow::DataType> input_tensor_dtypes,
     absl::Span<const std::string> output_tensor_names,
-    absl::Span<const std::string> target_tensor_names) {
+    absl::Span<const std::string> target_tensor_names,
+    std::vector<int>* output_indices) {
   // The format of the joined name is illustrated as in the following example:
   // input1-input2^output1-output2^target1-target2
+  std::string joined_input_names =
+      absl::StrJoin(input_tensor_names, kTensorNameJoiningDelimiter);
+  std::string joined_target_names =
+      absl::StrJoin(target_tensor_names, kTensorNameJoiningDelimiter);
   const auto joined_name = absl::StrCat(
-      absl::StrJoin(input_tensor_names, kTensorNameJoiningDelimiter),
-      kArgumentTypeJoiningDelimiter,
+      joined_input_names, kArgumentTypeJoiningDelimiter,
       absl::StrJoin(output_tensor_names, kTensorNameJoiningDelimiter),
-      kArgumentTypeJoiningDelimiter,
-      absl::StrJoin(target_tensor_names, kTensorNameJoiningDelimiter));
+      kArgumentTypeJoiningDelimiter, joined_target_names);
 
   tensorflow::mutex_lock l(loaded_client_graphs_mu_);
 
-  // Cache hit; return immediately.
+  // Cache hit; mark the client graph as most recently used and return.
   const auto iter = loaded_client_graphs_.find(joined_name);
-  if (iter != loaded_client_graphs_.end()) return {*iter->second};
-
-  // Cache miss; populate a `ClientGraph` and load it.
-  tensorflow::GraphImportConfig::InputArrays input_nodes;
-  DCHECK_EQ(input_tensor_names.size(), input_tensor_dtypes.size());
-  for (int i = 0; i < input_tensor_names.size(); ++i) {
-    const auto& input_name = input_tensor_names[i];
-    auto input_dtype = input_tensor_dtypes[i];
+  if (iter != loaded_client_graphs_.end()) {
+    lru_client_graphs_.splice(lru_client_graphs_.begin(), lru_client_graphs_,
+                              iter->second.lru_iter);
+    return iter->second.loaded_client_graph;
+  }
 
-    tensorflow::ArrayInfo array_info;
-    array_info.imported_dtype = input_dtype;
-    array_info.shape.set_unknown_rank(true);
-    input_nodes[input_name] = array_info;
+  // Cache miss; if enabled, look for a loaded client graph with the same feeds
+  // and targets that fetches a superset of the outputs, preferring the one
+  // with the fewest outputs, and compile the requested one in the background.
+  if (output_indices != nullptr && compile_thread_pool_ != nullptr &&
+      !output_tensor_names.empty()) {
+    const CachedClientGraph* superset = nullptr;
+    for (const auto& entry : loaded_client_graphs_) {
+      const CachedClientGraph& cached = entry.second;
+      if (cached.joined_input_names != joined_input_names ||
+          cached.joined_target_names != joined_target_names ||
+          (superset != nullptr &&
+           cached.output_names.size() >= superset->output_names.size())) {
+        continue;
+      }
+      std::vector<int> indices =
+          FindSortedNames(cached.output_names, output_tensor_names);
+      if (indices.empty()) continue;
+      superset = &cached;
+      *output_indices = std::move(indices);
+    }
+    if (superset != nullptr) {
+      lru_client_graphs_.splice(lru_client_graphs_.begin(), lru_client_graphs_,
+                                superset->lru_iter);
+      if (background_compilations_.insert(joined_name).second) {
+        compile_thread_pool_->Schedule(
+            [this, client_graph = CreateClientGraph(
+                       joined_name, input_tensor_names, input_tensor_dtypes,
+                       output_tensor_names, target_tensor_names),
+             joined_input_names = std::move(joined_input_names),
+             joined_target_names = std::move(joined_target_names)]() {
+              auto loaded_client_graph = LoadClientGraph(client_graph);
+              tensorflow::mutex_lock l(loaded_client_graphs_mu_);
+              if (!loaded_client_graph.ok()) {
+                // Keep the name in `background_compilations_`, so that the
+                // compilation is not retried and the superset keeps serving.
+                LOG(WARNING) << "Background compilation of client graph "
+                             << client_graph.name << " failed: "
+                             << loaded_client_graph.status();
+                return;
+              }
+              background_compilations_.erase(client_graph.name);
+              InsertLoadedClientGraph(client_graph.name, joined_input_names,
+                                      joined_target_names,
+                                      client_graph.output_nodes,
+                                      std::move(loaded_client_graph).value());
+            });
+      }
+      return superset->loaded_client_graph;
+    }
   }
-  ClientGraph client_graph{
-      joined_name,
-      std::move(input_nodes),
-      {output_tensor_names.begin(), output_tensor_names.end()},
-      {target_tensor_names.begin(), target_tensor_names.end()}};
-  TF_ASSIGN_OR_RETURN(auto loaded_client_graph, LoadClientGraph(client_graph));
+
+  // Otherwise populate a `ClientGraph` and load it.
+  TF_ASSIGN_OR_RETURN(
+      auto loaded_client_graph,
+      LoadClientGraph(CreateClientGraph(joined_name, input_tensor_names,
+                                        input_tensor_dtypes,
+                                        output_tensor_names,
+                                        target_tensor_names)));
 
   // Store the new loaded client graph in cache and return.
-  const auto* loaded_client_graph_ptr = loaded_client_graph.get();
-  loaded_client_graphs_[joined_name] = std::move(loaded_client_graph);
-  return {*loaded_client_graph_ptr};
+  return InsertLoadedClientGraph(
+      joined_name, std::move(joined_input_names),
+      std::move(joined_target_names),
+      {output_tensor_names.begin(), output_tensor_names.end()},
+      std::move(loaded_client_graph));
+}
+
+std::shared_ptr<const GraphExecutor::LoadedClientGraph>
+GraphExecutor::InsertLoadedClientGraph(
+    const std::string& joined_name, std::string joined_input_names,
+    std::string joined_target_names, std::vector<std::string> output_names,
+    std::unique_ptr<LoadedClientGraph> loaded_client_graph) {
+  auto inserted = loaded_client_graphs_.try_emplace(joined_name);
+  CachedClientGraph& cached = inserted.first->second;
+  if (!inserted.second) return cached.loaded_client_graph;
+
+  loaded_client_graphs_bytes_ += loaded_client_graph->bef.size();
+  cached.loaded_client_graph = std::move(loaded_client_graph);
+  cached.joined_input_names = std::move(joined_input_names);
+  cached.joined_target_names = std::move(joined_target_names);
+  cached.output_names = std::move(output_names);
+  lru_client_graphs_.push_front(joined_name);
+  cached.lru_iter = lru_client_graphs_.begin();
+  std::shared_ptr<const LoadedClientGraph> result = cached.loaded_client_graph;
+
+  // Evict the least recently used client graphs, but never the new one.
+  const int64_t max_bytes = options_.max_loaded_client_graphs_bytes;
+  while (max_bytes > 0 && loaded_client_graphs_bytes_ > max_bytes &&
+         lru_client_graphs_.size() > 1) {
+    auto evicted = loaded_client_graphs_.find(lru_client_graphs_.back());
+    DCHECK(evicted != loaded_client_graphs_.end());
+    VLOG(1) << "Evicting loaded client graph " << evicted->first;
+    loaded_client_graphs_bytes_ -=
+        evicted->second.loaded_client_graph->bef.size();
+    loaded_client_graphs_.erase(evicted);
+    lru_client_graphs_.pop_back();
+  }
+  return result;
 }
 
 }  // namespace tfrt_stub
@@ -16,12 +16,17 @@ limitations under the License.
 #define TENSORFLOW_CORE_TFRT_GRAPH_EXECUTOR_GRAPH_EXECUTOR_H_
 
 #include <functional>
+#include <list>
 #include <memory>
 #include <string>
 #include <utility>
+#include <vector>
 
+#include "absl/container/flat_hash_map.h"
+#include "absl/container/flat_hash_set.h"
 #include "mlir/IR/BuiltinOps.h"  // from @llvm-project
 #include "tensorflow/core/common_runtime/graph_execution_state.h"
+#include "tensorflow/core/platform/threadpool.h"
 #include "tensorflow/core/protobuf/config.pb.h"
 #include "tensorflow/core/tfrt/fallback/fallback_state.h"
 #include "tensorflow/core/tfrt/graph_executor/graph_execution_options.h"
@@ -103,6 +108,15 @@ class GraphExecutor {
     std::vector<std::string> target_nodes;
   };
 
+  // The feeds, fetches and targets of a `Run()` call, used to load the client
+  // graph for it ahead of time.
+  struct ClientGraphSpec {
+    std::vector<std::string> input_tensor_names;
+    std::vector<tensorflow::DataType> input_tensor_dtypes;
+    std::vector<std::string> output_tensor_names;
+    std::vector<std::string> target_tensor_names;
+  };
+
   // Creates a `GraphExecutor` given the args.
   static StatusOr<std::unique_ptr<GraphExecutor>> Create(
       Options options, const FallbackState& fallback_state,
@@ -119,7 +133,13 @@ class GraphExecutor {
         tpu_model_resource_(tpu_model_resource),
         graph_execution_state_(std::move(graph_execution_state)),
         req_deadline_tracker_(
-            options_.runtime->core_runtime()->GetHostContext()) {}
+            options_.runtime->core_runtime()->GetHostContext()),
+        compile_thread_pool_(
+            options_.enable_background_compilation
+                ? std::make_unique<tensorflow::thread::ThreadPool>(
+                      tensorflow::Env::Default(), "tfrt_graph_compilation",
+                      /*num_threads=*/1)
+                : nullptr) {}
 
   // Runs on the graph according to given input/output.
   tensorflow::Status Run(
@@ -129,9 +149,19 @@ class GraphExecutor {
       absl::Span<const std::string> target_tensor_names,
       std::vector<tensorflow::Tensor>* outputs);
 
+  // Loads the client graphs for `specs`, so that the first `Run()` calls with
+  // the same feeds, fetches and targets do not have to compile them. If
+  // `options.max_loaded_client_graphs_bytes` is set, later specs may evict
+  // earlier ones.
+  tensorflow::Status Warmup(absl::Span<const ClientGraphSpec> specs);
+
   // Extends the current graph by `graph`.
   tensorflow::Status Extend(const GraphDef& graph);
 
+  // Returns the total size of the BEF of the loaded client graphs.
+  int64_t loaded_client_graphs_bytes() TF_LOCKS_EXCLUDED(
+      loaded_client_graphs_mu_);
+
   tensorflow::tfrt_stub::TfrtGraphExecutionState& graph_execution_state()
       const {
     return *graph_execution_state_;
@@ -158,16 +188,45 @@ class GraphExecutor {
   tensorflow::Status InitBef(tfrt::BEFFile* bef_file,
                              tfrt::ResourceContext* resource_context);
 
-  // Returns a `LoadedClientGraph` given input/output tensor info. If there is
-  // no existing one yet, creates one first.
-  StatusOr<std::reference_wrapper<const GraphExecutor::LoadedClientGraph>>
+  // A loaded client graph in the cache.
+  struct CachedClientGraph {
+    std::shared_ptr<const LoadedClientGraph> loaded_client_graph;
+    // The joined input names and joined target names of the client graph.
+    std::string joined_input_names;
+    std::string joined_target_names;
+    // The sorted output names of the client graph.
+    std::vector<std::string> output_names;
+    // The position of this client graph in `lru_client_graphs_`.
+    std::list<std::string>::iterator lru_iter;
+  };
+
+  // Returns a `LoadedClientGraph` given the sorted input/output tensor info.
+  // If there is no existing one yet, creates one first.
+  //
+  // If `output_indices` is not null and background compilation is enabled, a
+  // loaded client graph fetching a superset of the outputs may be returned
+  // instead while the requested one is compiled. In that case
+  // `output_indices` is set to the positions of the requested outputs among
+  // the outputs of the returned client graph; otherwise it is left empty.
+  StatusOr<std::shared_ptr<const GraphExecutor::LoadedClientGraph>>
   GetOrCreateLoadedClientGraph(
       absl::Span<const std::string> input_tensor_names,
       absl::Span<const tensorflow::DataType> input_tensor_dtypes,
       absl::Span<const std::string> output_tensor_names,
-      absl::Span<const std::string> target_tensor_names)
+      absl::Span<const std::string> target_tensor_names,
+      std::vector<int>* output_indices)
       TF_LOCKS_EXCLUDED(loaded_client_graphs_mu_);
 
+  // Adds `loaded_client_graph` to the cache as the most recently used client
+  // graph and evicts others if the cache is over its size limit. Returns the
+  // cached client graph, which is an existing one if `joined_name` is already
+  // cached.
+  std::shared_ptr<const LoadedClientGraph> InsertLoadedClientGraph(
+      const std::string& joined_name, std::string joined_input_names,
+      std::string joined_target_names, std::vector<std::string> output_names,
+      std::unique_ptr<LoadedClientGraph> loaded_client_graph)
+      TF_EXCLUSIVE_LOCKS_REQUIRED(loaded_client_graphs_mu_);
+
   Options options_;
   std::reference_wrapper<const FallbackState> fallback_state_;
   tfrt::tpu::TpuModelResource* tpu_model_resource_;  // NOT owned.
@@ -178,12 +237,23 @@ class GraphExecutor {
   tfrt::RequestDeadlineTracker req_deadline_tracker_;
 
   tensorflow::mutex loaded_client_graphs_mu_;
-  // Caches `LoadedClientGraph` by the joined name.
-  // For pointer stability of values in `absl::flat_hash_map<>`, additional
-  // `std::unique_ptr<>` is necessary. (See https://abseil.io/tips/136.)
-  absl::flat_hash_map<std::string /*joined_name*/,
-                      std::unique_ptr<LoadedClientGraph>>
+  // Caches `LoadedClientGraph` by the joined name. Runs hold a reference to
+  // the client graph they execute, so that it survives eviction.
+  absl::flat_hash_map<std::string /*joined_name*/, CachedClientGraph>
       loaded_client_graphs_ TF_GUARDED_BY(loaded_client_graphs_mu_);
+  // The joined names of the cached client graphs, most recently used first.
+  std::list<std::string> lru_client_graphs_
+      TF_GUARDED_BY(loaded_client_graphs_mu_);
+  int64_t loaded_client_graphs_bytes_ TF_GUARDED_BY(loaded_client_graphs_mu_) =
+      0;
+  // The joined names of the client graphs being compiled in the background,
+  // or whose background compilation failed.
+  absl::flat_hash_set<std::string> background_compilations_
+      TF_GUARDED_BY(loaded_client_graphs_mu_);
+
+  // Compiles client graphs in the background if enabled. Declared last so
+  // that pending compilations finish before the other members are destroyed.
+  std::unique_ptr<tensorflow::thread::ThreadPool> compile_thread_pool_;
 };
 
 }  // namespace tfrt_stub
@@ -20,6 +20,7 @@ limitations under the License.
 
 #include <gmock/gmock.h>
 #include <gtest/gtest.h>
+#include "absl/strings/str_cat.h"
 #include "tensorflow/cc/ops/array_ops.h"
 #include "tensorflow/cc/ops/const_op.h"
 #include "tensorflow/cc/ops/functional_ops.h"
@@ -31,6 +32,7 @@ limitations under the License.
 #include "tensorflow/core/grappler/utils/grappler_test.h"
 #include "tensorflow/core/lib/core/status_test_util.h"
 #include "tensorflow/core/platform/statusor.h"
+#include "tensorflow/core/platform/test_benchmark.h"
 #include "tensorflow/core/protobuf/rewriter_config.pb.h"
 #include "tensorflow/core/tfrt/saved_model/saved_model_testutil.h"
 
@@ -135,6 +137,160 @@ TEST_F(GraphExecutorTest, Extend) {
               ::testing::ElementsAreArray({2}));
 }
 
+GraphDef RankAndSizeGraph() {
+  GraphDef graph_def;
+  auto scope = tensorflow::Scope::NewRootScope().WithDevice("/device:CPU:0");
+  auto input = ops::Placeholder(scope.WithOpName("input"), DT_INT32);
+  auto rank = ops::Rank(scope.WithOpName("rank"), input);
+  auto size = ops::Size(scope.WithOpName("size"), input);
+  TF_CHECK_OK(scope.ToGraphDef(&graph_def));
+  return graph_def;
+}
+
+TEST_F(GraphExecutorTest, WarmupWithEviction) {
+  GraphDef graph_def = RankAndSizeGraph();
+  auto runtime = DefaultTfrtRuntime(/*num_threads=*/1);
+  auto tpu_model_resource = std::make_unique<tfrt::tpu::TpuModelResource>();
+  const std::vector<GraphExecutor::ClientGraphSpec> specs = {
+      {{"input"}, {DT_INT32}, {"rank"}, {}},
+      {{"input"}, {DT_INT32}, {"size"}, {}}};
+
+  int64_t unbounded_bytes = 0;
+  {
+    GraphExecutor::Options options(runtime.get());
+    TF_ASSERT_OK_AND_ASSIGN(
+        auto fallback_state,
+        FallbackState::Create(CreateDefaultSessionOptions(options),
+                              graph_def.library()));
+    TF_ASSERT_OK_AND_ASSIGN(
+        auto graph_executor,
+        GraphExecutor::Create(std::move(options), *fallback_state,
+                              tpu_model_resource.get(), graph_def));
+    TF_ASSERT_OK(graph_executor->Warmup(specs));
+    unbounded_bytes = graph_executor->loaded_client_graphs_bytes();
+  }
+
+  GraphExecutor::Options options(runtime.get());
+  options.max_loaded_client_graphs_bytes = 1;
+  TF_ASSERT_OK_AND_ASSIGN(
+      auto fallback_state,
+      FallbackState::Create(CreateDefaultSessionOptions(options),
+                            graph_def.library()));
+  TF_ASSERT_OK_AND_ASSIGN(
+      auto graph_executor,
+      GraphExecutor::Create(std::move(options), *fallback_state,
+                            tpu_model_resource.get(), graph_def));
+  TF_ASSERT_OK(graph_executor->Warmup(specs));
+  // Only the most recently loaded client graph is kept.
+  EXPECT_GT(graph_executor->loaded_client_graphs_bytes(), 0);
+  EXPECT_LT(graph_executor->loaded_client_graphs_bytes(), unbounded_bytes);
+
+  std::vector<std::pair<std::string, tensorflow::Tensor>> inputs;
+  inputs.push_back({"input", CreateTfTensor<int32_t>(
+                                 /*shape=*/{1, 3}, /*data=*/{1, 1, 1})});
+  std::vector<tensorflow::Tensor> outputs;
+  TF_ASSERT_OK(graph_executor->Run(/*run_options=*/{}, inputs,
+                                   /*output_tensor_names=*/{"rank"},
+                                   /*target_tensor_names=*/{}, &outputs));
+  ASSERT_EQ(outputs.size(), 1);
+  EXPECT_THAT(GetTfTensorData<int32_t>(outputs[0]),
+              ::testing::ElementsAreArray({2}));
+}
+
+TEST_F(GraphExecutorTest, BackgroundCompilationUsesSuperset) {
+  GraphDef graph_def = RankAndSizeGraph();
+  auto runtime = DefaultTfrtRuntime(/*num_threads=*/1);
+  GraphExecutor::Options options(runtime.get());
+  options.enable_background_compilation = true;
+  TF_ASSERT_OK_AND_ASSIGN(
+      auto fallback_state,
+      FallbackState::Create(CreateDefaultSessionOptions(options),
+                            graph_def.library()));
+  auto tpu_model_resource = std::make_unique<tfrt::tpu::TpuModelResource>();
+  TF_ASSERT_OK_AND_ASSIGN(
+      auto graph_executor,
+      GraphExecutor::Create(std::move(options), *fallback_state,
+                            tpu_model_resource.get(), graph_def));
+
+  std::vector<std::pair<std::string, tensorflow::Tensor>> inputs;
+  inputs.push_back({"input", CreateTfTensor<int32_t>(
+                                 /*shape=*/{1, 3}, /*data=*/{1, 1, 1})});
+  std::vector<tensorflow::Tensor> outputs;
+  TF_ASSERT_OK(graph_executor->Run(/*run_options=*/{}, inputs,
+                                   /*output_tensor_names=*/{"size", "rank"},
+                                   /*target_tensor_names=*/{}, &outputs));
+  ASSERT_EQ(outputs.size(), 2);
+  EXPECT_THAT(GetTfTensorData<int32_t>(outputs[0]),
+              ::testing::ElementsAreArray({3}));
+  EXPECT_THAT(GetTfTensorData<int32_t>(outputs[1]),
+              ::testing::ElementsAreArray({2}));
+
+  // Served by the client graph above until its own one is compiled.
+  for (int i = 0; i < 2; ++i) {
+    outputs.clear();
+    TF_ASSERT_OK(graph_executor->Run(/*run_options=*/{}, inputs,
+                                     /*output_tensor_names=*/{"size"},
+                                     /*target_tensor_names=*/{}, &outputs));
+    ASSERT_EQ(outputs.size(), 1);
+    EXPECT_THAT(GetTfTensorData<int32_t>(outputs[0]),
+                ::testing::ElementsAreArray({3}));
+  }
+}
+
+// Measures the per-op overhead of `GraphExecutor::Run()` with a chain of tiny
+// Square ops on a scalar, for comparison with the benchmarks in
+// common_runtime/dispatch_overhead_benchmark_test.cc. Square is used instead
+// of Identity because grappler removes Identity chains.
+void BM_GraphExecutorRun(::testing::benchmark::State& state) {
+  const int num_ops = state.range(0);
+  const int num_threads = state.range(1);
+  GraphDef graph_def;
+  {
+    auto scope = tensorflow::Scope::NewRootScope().WithDevice("/device:CPU:0");
+    Output output = ops::Placeholder(scope.WithOpName("input"), DT_INT32);
+    for (int i = 0; i < num_ops; ++i) {
+      output =
+          ops::Square(scope.WithOpName(absl::StrCat("square_", i)), output);
+    }
+    TF_CHECK_OK(scope.ToGraphDef(&graph_def));
+  }
+
+  auto runtime = DefaultTfrtRuntime(num_threads);
+  GraphExecutor::Options options(runtime.get());
+  auto fallback_state = tensorflow::tfrt_stub::FallbackState::Create(
+                            CreateDefaultSessionOptions(options),
+                            graph_def.library())
+                            .ValueOrDie();
+  auto tpu_model_resource = std::make_unique<tfrt::tpu::TpuModelResource>();
+  auto graph_executor =
+      GraphExecutor::Create(std::move(options), *fallback_state,
+                            tpu_model_resource.get(), graph_def)
+          .ValueOrDie();
+
+  std::vector<std::pair<std::string, tensorflow::Tensor>> inputs;
+  inputs.push_back(
+      {"input", CreateTfTensor<int32_t>(/*shape=*/{}, /*data=*/{1})});
+  const std::vector<std::string> output_names = {
+      absl::StrCat("square_", num_ops - 1)};
+  std::vector<tensorflow::Tensor> outputs;
+  // The first run compiles the client graph, which is not measured.
+  TF_CHECK_OK(graph_executor->Run(/*run_options=*/{}, inputs, output_names,
+                                  /*target_tensor_names=*/{}, &outputs));
+  for (auto _ : state) {
+    outputs.clear();
+    TF_CHECK_OK(graph_executor->Run(/*run_options=*/{}, inputs, output_names,
+                                    /*target_tensor_names=*/{}, &outputs));
+  }
+  state.SetItemsProcessed(static_cast<int64_t>(state.iterations()) * num_ops);
+}
+BENCHMARK(BM_GraphExecutorRun)
+    ->ArgPair(1, 1)
+    ->ArgPair(16, 1)
+    ->ArgPair(256, 1)
+    ->ArgPair(256, 4)
+    ->ArgPair(256, 16)
+    ->UseRealTime();
+
 }  // namespace
 }  // namespace tfrt_stub
 }  // namespace tensorflow
@@ -18,6 +18,7 @@ limitations under the License.
 
 #include "third_party/eigen3/unsupported/Eigen/CXX11/Tensor"
 #include "tensorflow/core/lib/core/threadpool_interface.h"
+#include "tensorflow/core/lib/monitoring/sampler.h"
 #include "tensorflow/core/lib/strings/strcat.h"
 #include "tensorflow/core/platform/context.h"
 #include "tensorflow/core/platform/denormal.h"
@@ -40,6 +41,12 @@ namespace {
 typedef typename internal::RunHandlerEnvironment::Task Task;
 typedef Eigen::RunQueue<Task, 1024> Queue;
 
+auto* request_queueing_delay_usecs = tensorflow::monitoring::Sampler<1>::New(
+    {"/tensorflow/tfrt/run_handler/request_queueing_delay_usecs",
+     "The mean and max queueing delay of the tasks of each request.", "stat"},
+    // Scale of 1 microsecond up to ~16 seconds.
+    tensorflow::monitoring::Buckets::Exponential(1, 2, 24));
+
 }  // namespace
 
 namespace internal {
@@ -74,6 +81,7 @@ RunHandlerEnvironment::Task RunHandlerEnvironment::CreateTask(TaskFunction f) {
           std::move(f),
           tensorflow::Context(tensorflow::ContextKind::kThread),
           id,
+          tensorflow::EnvTime::NowMicros(),
       }),
   };
 }
@@ -132,6 +140,9 @@ ThreadWorkSource::ThreadWorkSource()
       blocking_inflight_(0),
       non_blocking_inflight_(0),
       pending_tasks_(0),
+      executed_tasks_(0),
+      total_queueing_delay_us_(0),
+      max_queueing_delay_us_(0),
       traceme_id_(0),
       version_(0),
       sub_thread_pool_waiter_(nullptr) {
@@ -319,6 +330,35 @@ void ThreadWorkSource::DecrementPendingTaskCount() {
   pending_tasks_.fetch_sub(1, std::memory_order_release);
 }
 
+void ThreadWorkSource::RecordQueueingDelay(uint64_t delay_us) {
+  executed_tasks_.fetch_add(1, std::memory_order_relaxed);
+  total_queueing_delay_us_.fetch_add(delay_us, std::memory_order_relaxed);
+  uint64_t max_delay_us =
+      max_queueing_delay_us_.load(std::memory_order_relaxed);
+  while (delay_us > max_delay_us &&
+         !max_queueing_delay_us_.compare_exchange_weak(
+             max_delay_us, delay_us, std::memory_order_relaxed)) {
+  }
+}
+
+int64_t ThreadWorkSource::GetExecutedTaskCount() {
+  return executed_tasks_.load(std::memory_order_relaxed);
+}
+
+uint64_t ThreadWorkSource::GetTotalQueueingDelayMicros() {
+  return total_queueing_delay_us_.load(std::memory_order_relaxed);
+}
+
+uint64_t ThreadWorkSource::GetMaxQueueingDelayMicros() {
+  return max_queueing_delay_us_.load(std::memory_order_relaxed);
+}
+
+void ThreadWorkSource::ResetQueueingDelayStats() {
+  executed_tasks_.store(0, std::memory_order_relaxed);
+  total_queueing_delay_us_.store(0, std::memory_order_relaxed);
+  max_queueing_delay_us_.store(0, std::memory_order_relaxed);
+}
+
 unsigned ThreadWorkSource::NonBlockingWorkShardingFactor() {
   return non_blocking_work_sharding_factor_;
 }
@@ -348,6 +388,8 @@ RunHandlerThreadPool::RunHandlerThreadPool(
       blocking_thread_max_waiting_time_(
           options.blocking_threads_max_sleep_time_micro_sec),
       enable_wake_up_(options.enable_wake_up),
+      min_idle_time_before_stealing_(
+          options.min_idle_time_before_stealing_micro_sec),
       thread_data_(num_threads_),
       env_(env, thread_options, name),
       name_(name),
@@ -467,7 +509,10 @@ int RunHandlerThreadPool::NumNonBlockingThreads() const {
 }
 
 RunHandlerThreadPool::ThreadData::ThreadData()
-    : new_version(0), current_index(0), current_version(0) {}
+    : new_version(0),
+      current_index(0),
+      current_version(0),
+      idle_start_time_us(0) {}
 
 Task RunHandlerThreadPool::FindTask(
     int searching_range_start, int searching_range_end, int thread_id,
@@ -507,6 +552,35 @@ Task RunHandlerThreadPool::FindTask(
   return t;
 }
 
+Task RunHandlerThreadPool::StealTask(
+    int own_range_start, int own_range_end, int thread_id,
+    int max_blocking_inflight,
+    const Eigen::MaxSizeVector<ThreadWorkSource*>& thread_work_sources,
+    bool* task_from_blocking_queue, ThreadWorkSource** tws) {
+  Task t;
+  *task_from_blocking_queue = false;
+  // The work sources are sorted by priority, so the scan picks the task of the
+  // request with the highest priority first.
+  for (int i = 0; i < thread_work_sources.size(); ++i) {
+    if (i >= own_range_start && i < own_range_end) {
+      continue;
+    }
+    *tws = thread_work_sources[i];
+    if ((*tws)->GetInflightTaskCount(true) < max_blocking_inflight) {
+      t = (*tws)->PopBlockingTask();
+      if (t.f) {
+        *task_from_blocking_queue = true;
+        break;
+      }
+    }
+    t = (*tws)->PopNonBlockingTask(thread_id, true);
+    if (t.f) {
+      break;
+    }
+  }
+  return t;
+}
+
 // Main worker thread loop.
 void RunHandlerThreadPool::WorkerLoop(int thread_id,
                                       bool may_steal_blocking_work) {
@@ -554,13 +628,27 @@ void RunHandlerThreadPool::WorkerLoop(int thread_id,
                    sub_thread_pool_id, kMaxBlockingInflight,
                    /*may_steal_blocking_work=*/true, *thread_work_sources,
                    &task_from_blocking_queue, &tws);
-      if (!t.f) {
-        // Search from all requests if the thread cannot find tasks from
-        // requests that belong to its own sub thread pool.
-        t = FindTask(0, active_requests, thread_id, sub_thread_pool_id,
-                     kMaxBlockingInflight,
-                     /*may_steal_blocking_work=*/true, *thread_work_sources,
-                     &task_from_blocking_queue, &tws);
+      ThreadData& thread_data = thread_data_[thread_id];
+      if (t.f) {
+        thread_data.idle_start_time_us = 0;
+      } else {
+        // Steal from requests of the other sub thread pools only if the thread
+        // has been idle for long enough, so that a short gap between two tasks
+        // of its own requests doesn't make it take work from other requests.
+        bool may_steal = true;
+        if (min_idle_time_before_stealing_ > 0) {
+          uint64_t now = tensorflow::EnvTime::NowMicros();
+          if (thread_data.idle_start_time_us == 0) {
+            thread_data.idle_start_time_us = now;
+          }
+          may_steal = now - thread_data.idle_start_time_us >=
+                      static_cast<uint64_t>(min_idle_time_before_stealing_);
+        }
+        if (may_steal) {
+          t = StealTask(search_range_start, search_range_end, thread_id,
+                        kMaxBlockingInflight, *thread_work_sources,
+                        &task_from_blocking_queue, &tws);
+        }
       }
     } else {
       // For non-blocking threads, it will always search from all pending
@@ -573,6 +661,8 @@ void RunHandlerThreadPool::WorkerLoop(int thread_id,
     if (t.f) {
       VLOG(2) << "Running " << (task_from_blocking_queue ? "inter" : "intra")
               << " work from " << tws->GetTracemeId();
+      tws->RecordQueueingDelay(tensorflow::EnvTime::NowMicros() -
+                               t.f->create_time_us);
       tws->IncrementInflightTaskCount(task_from_blocking_queue);
       env_.ExecuteTask(t);
       tws->DecrementInflightTaskCount(task_from_blocking_queue);
@@ -724,7 +814,8 @@ class RunHandlerPool::Impl {
                 options.use_adaptive_waiting_time, options.enable_wake_up,
                 options.max_concurrent_handler,
                 options.num_threads_in_sub_thread_pool,
-                options.sub_thread_request_percentage),
+                options.sub_thread_request_percentage,
+                options.min_idle_time_before_stealing_micro_sec),
             tensorflow::Env::Default(), tensorflow::ThreadOptions(),
             "tf_run_handler_pool", &waiters_mu_, &queue_waiters_)),
         iterations_(0),
@@ -837,6 +928,15 @@ class RunHandlerPool::Impl {
     double elapsed = (now - handler->start_time_us()) / 1000.0;
     time_hist_.Add(elapsed);
 
+    int64_t executed_tasks = handler->tws()->GetExecutedTaskCount();
+    if (executed_tasks > 0) {
+      request_queueing_delay_usecs->GetCell("mean")->Add(
+          handler->tws()->GetTotalQueueingDelayMicros() /
+          static_cast<double>(executed_tasks));
+      request_queueing_delay_usecs->GetCell("max")->Add(
+          handler->tws()->GetMaxQueueingDelayMicros());
+    }
+
     // Erase from and update sorted_active_handlers_. Add it to the end of
     // free_handlers_.
     auto iter = std::find(sorted_active_handlers_.begin(),
@@ -1010,6 +1110,7 @@ void RunHandler::Impl::Reset(int64_t step_id,
   step_id_ = step_id;
   options_ = options;
   tws_.SetTracemeId(step_id);
+  tws_.ResetQueueingDelayStats();
 }
 
 int RunHandler::Impl::RunHandlerEigenThreadPool::NumThreads() const {
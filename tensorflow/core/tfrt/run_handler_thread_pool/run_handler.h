@@ -101,6 +101,12 @@ class RunHandlerPool {
 
     // If true, threads will be waken up by new tasks.
     bool enable_wake_up = true;
+
+    // Minimum time a blocking thread needs to be idle, i.e. find no task from
+    // the requests of its own sub thread pool, before it steals tasks from the
+    // requests of other sub thread pools. Stolen tasks are picked in priority
+    // order. 0 means threads steal as soon as they run out of work.
+    int min_idle_time_before_stealing_micro_sec = 0;
   };
   explicit RunHandlerPool(Options options);
   ~RunHandlerPool();
@@ -175,6 +181,9 @@ class RunHandlerEnvironment {
     TaskFunction f;
     tensorflow::Context context;
     uint64_t trace_id;
+    // Time (in microseconds) when the task is created, used to measure how long
+    // the task waits in the queue.
+    uint64_t create_time_us;
   };
   tensorflow::Env* const env_;
   const tensorflow::ThreadOptions thread_options_;
@@ -246,6 +255,19 @@ class ThreadWorkSource {
 
   void DecrementPendingTaskCount();
 
+  // Records the time a task of this request spent in the queue.
+  void RecordQueueingDelay(uint64_t delay_us);
+
+  // Returns the number of tasks recorded by RecordQueueingDelay() and their
+  // total and maximum queueing delay (in microseconds).
+  int64_t GetExecutedTaskCount();
+  uint64_t GetTotalQueueingDelayMicros();
+  uint64_t GetMaxQueueingDelayMicros();
+
+  // Clears the queueing delay stats when the work source is reused by a new
+  // request.
+  void ResetQueueingDelayStats();
+
   unsigned NonBlockingWorkShardingFactor();
 
   std::string ToString();
@@ -267,6 +289,11 @@ class ThreadWorkSource {
   // The number of tasks that are enqueued and not finished.
   std::atomic<int64_t> pending_tasks_;
 
+  // The queueing delay stats of the tasks executed by the worker threads.
+  std::atomic<int64_t> executed_tasks_;
+  std::atomic<uint64_t> total_queueing_delay_us_;
+  std::atomic<uint64_t> max_queueing_delay_us_;
+
   Queue blocking_work_queue_;
   tensorflow::mutex blocking_queue_op_mu_;
   char pad_[128];
@@ -294,6 +321,7 @@ class RunHandlerThreadPool {
     int max_concurrent_handler;
     std::vector<int> num_threads_in_sub_thread_pool;
     std::vector<double> sub_thread_request_percentage;
+    int min_idle_time_before_stealing_micro_sec;
     Options(int num_blocking_threads, int num_non_blocking_threads,
             bool wait_if_no_active_request,
             int non_blocking_threads_sleep_time_micro_sec,
@@ -301,7 +329,8 @@ class RunHandlerThreadPool {
             bool use_adaptive_waiting_time, bool enable_wake_up,
             int max_concurrent_handler,
             const std::vector<int>& num_threads_in_sub_thread_pool,
-            const std::vector<double>& sub_thread_request_percentage)
+            const std::vector<double>& sub_thread_request_percentage,
+            int min_idle_time_before_stealing_micro_sec = 0)
         : num_blocking_threads(num_blocking_threads),
           num_non_blocking_threads(num_non_blocking_threads),
           wait_if_no_active_request(wait_if_no_active_request),
@@ -313,7 +342,9 @@ class RunHandlerThreadPool {
           enable_wake_up(enable_wake_up),
           max_concurrent_handler(max_concurrent_handler),
           num_threads_in_sub_thread_pool(num_threads_in_sub_thread_pool),
-          sub_thread_request_percentage(sub_thread_request_percentage) {}
+          sub_thread_request_percentage(sub_thread_request_percentage),
+          min_idle_time_before_stealing_micro_sec(
+              min_idle_time_before_stealing_micro_sec) {}
   };
   struct PerThread {
     constexpr PerThread() : pool(nullptr), thread_id(-1) {}
@@ -362,6 +393,14 @@ class RunHandlerThreadPool {
       const Eigen::MaxSizeVector<ThreadWorkSource*>& thread_work_sources,
       bool* task_from_blocking_queue, ThreadWorkSource** tws);
 
+  // Search tasks from requests outside of the range own_range_start to
+  // own_range_end, starting from the request with the highest priority.
+  Task StealTask(
+      int own_range_start, int own_range_end, int thread_id,
+      int max_blocking_inflight,
+      const Eigen::MaxSizeVector<ThreadWorkSource*>& thread_work_sources,
+      bool* task_from_blocking_queue, ThreadWorkSource** tws);
+
   void WaitForWorkInSubThreadPool(int thread_id, bool is_blocking,
                                   int sub_thread_pool_id);
 
@@ -382,6 +421,11 @@ class RunHandlerThreadPool {
         current_thread_work_sources;
 
     int sub_thread_pool_id;
+
+    // Time (in microseconds) since the thread found no task from the requests
+    // of its own sub thread pool. 0 if the thread is not idle. Should only be
+    // accessed by one thread.
+    uint64_t idle_start_time_us;
   };
 
   const int num_threads_;
@@ -392,6 +436,7 @@ class RunHandlerThreadPool {
   const int non_blocking_thread_sleep_time_;
   const int blocking_thread_max_waiting_time_;
   const bool enable_wake_up_;
+  const int min_idle_time_before_stealing_;
   Eigen::MaxSizeVector<ThreadData> thread_data_;
   internal::RunHandlerEnvironment env_;
   std::atomic<bool> cancelled_;
@@ -31,6 +31,7 @@ limitations under the License.
 #include "third_party/eigen3/unsupported/Eigen/CXX11/Tensor"
 #include "tensorflow/core/lib/core/blocking_counter.h"
 #include "tensorflow/core/lib/strings/strcat.h"
+#include "tensorflow/core/platform/env.h"
 #include "tensorflow/core/platform/logging.h"
 #include "tensorflow/core/platform/test.h"
 #include "tfrt/host_context/task_function.h"  // from @tf_runtime
@@ -636,6 +637,77 @@ TEST_P(RunHandlerThreadPoolTest, MultipleSubThreadPool) {
   delete run_handler_thread_pool;
 }
 
+TEST_P(RunHandlerThreadPoolTest, StealAfterIdleTime) {
+  constexpr int kMinIdleTimeBeforeStealingMicros = 50000;
+  Eigen::MaxSizeVector<tensorflow::mutex> waiters_mu(2);
+  waiters_mu.resize(2);
+  Eigen::MaxSizeVector<internal::Waiter> waiters(2);
+  waiters.resize(2);
+  internal::RunHandlerThreadPool* run_handler_thread_pool =
+      new internal::RunHandlerThreadPool(
+          internal::RunHandlerThreadPool::Options(
+              /*num_blocking_threads=*/1, /*num_non_blocking_threads=*/0,
+              wait_if_no_active_request(),
+              /*non_blocking_threads_sleep_time_micro_sec=*/250,
+              /*blocking_threads_max_sleep_time_micro_sec=*/250,
+              adaptive_waiting_time(), /*enable_wake_up=*/true,
+              /*max_concurrent_handler=*/128,
+              /*num_threads_in_sub_thread_pool=*/{1, 1},
+              /*sub_thread_request_percentage=*/{0.5, 1},
+              kMinIdleTimeBeforeStealingMicros),
+          tensorflow::Env::Default(), tensorflow::ThreadOptions(),
+          "tf_run_handler_pool", &waiters_mu, &waiters);
+  Eigen::MaxSizeVector<internal::ThreadWorkSource*> thread_work_sources(4);
+  thread_work_sources.resize(4);
+  internal::ThreadWorkSource tws[4];
+  for (int i = 0; i < 4; ++i) {
+    tws[i].SetWaiter(1, &waiters[i / 2], &waiters_mu[i / 2]);
+    thread_work_sources[i] = &tws[i];
+  }
+
+  // Only the requests of the second sub thread pool have tasks.
+  tensorflow::mutex mu;
+  std::vector<int> executed;
+  tensorflow::BlockingCounter counter(2);
+  for (int i : {3, 2}) {
+    run_handler_thread_pool->AddWorkToQueue(
+        &tws[i], /*is_blocking=*/true,
+        TaskFunction([&mu, &executed, &counter, i] {
+          {
+            tensorflow::mutex_lock l(mu);
+            executed.push_back(i);
+          }
+          counter.DecrementCount();
+        }));
+  }
+  const uint64_t start_us = tensorflow::Env::Default()->NowMicros();
+  run_handler_thread_pool->StartOneThreadForTesting();
+  run_handler_thread_pool->SetThreadWorkSources(
+      /*tid=*/0, /*version=*/1, thread_work_sources);
+  counter.Wait();
+
+  // The thread of the first sub thread pool only steals after being idle for
+  // long enough, and steals from the request with higher priority first.
+  EXPECT_GE(tensorflow::Env::Default()->NowMicros() - start_us,
+            uint64_t{kMinIdleTimeBeforeStealingMicros});
+  {
+    tensorflow::mutex_lock l(mu);
+    EXPECT_EQ(executed, std::vector<int>({2, 3}));
+  }
+  delete run_handler_thread_pool;
+
+  for (int i : {2, 3}) {
+    EXPECT_EQ(tws[i].GetExecutedTaskCount(), 1);
+    EXPECT_GE(tws[i].GetMaxQueueingDelayMicros(),
+              uint64_t{kMinIdleTimeBeforeStealingMicros});
+    EXPECT_EQ(tws[i].GetTotalQueueingDelayMicros(),
+              tws[i].GetMaxQueueingDelayMicros());
+  }
+  tws[2].ResetQueueingDelayStats();
+  EXPECT_EQ(tws[2].GetExecutedTaskCount(), 0);
+  EXPECT_EQ(tws[2].GetMaxQueueingDelayMicros(), 0);
+}
+
 INSTANTIATE_TEST_SUITE_P(Parameter, RunHandlerThreadPoolTest,
                          testing::Combine(::testing::Bool(),
                                           ::testing::Bool()));
@@ -16,18 +16,24 @@ limitations under the License.
 // For Google-internal use only.
 #include "tensorflow/core/util/autotune_maps/autotune_serialize.h"
 
+#include <cstdlib>
 #include <map>
 #include <string>
 #include <unordered_map>
 #include <vector>
 
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/hash.h"
+#include "tensorflow/core/platform/path.h"
 #include "tensorflow/core/platform/str_util.h"
+#include "tensorflow/core/platform/strcat.h"
 #include "tensorflow/core/util/activation_mode.h"
 #include "tensorflow/core/util/autotune_maps/autotune_map.pb.h"
 #include "tensorflow/core/util/autotune_maps/autotune_maps_utils.h"
 #include "tensorflow/core/util/autotune_maps/conv_autotune_maps.h"
 #include "tensorflow/core/util/autotune_maps/conv_parameters.h"
 #include "tensorflow/core/util/autotune_maps/conv_parameters.pb.h"
+#include "tensorflow/core/util/env_var.h"
 #include "tensorflow/stream_executor/dnn.h"
 #include "tensorflow/stream_executor/dnn.pb.h"
 
@@ -215,4 +221,83 @@ void ResetAutotuneMaps() {
 #endif  // GOOGLE_CUDA || TENSORFLOW_USE_ROCM
 }
 
+std::string AutotuneMapsCacheFile(absl::string_view cache_dir,
+                                  absl::string_view dnn_version) {
+  std::string key(dnn_version);
+#if GOOGLE_CUDA || TENSORFLOW_USE_ROCM
+  for (const string &device_identifier :
+       autotune_maps_utils::GetDeviceIdToIdentifierMap()) {
+    strings::StrAppend(&key, ";", device_identifier);
+  }
+#endif  // GOOGLE_CUDA || TENSORFLOW_USE_ROCM
+  return io::JoinPath(
+      cache_dir, strings::StrCat("tf_autotune_",
+                                 strings::Hex(Hash64(key), strings::kZeroPad16),
+                                 ".pb"));
+}
+
+Status LoadAutotuneMapsFromFile(const std::string &path) {
+  std::string serialized;
+  TF_RETURN_IF_ERROR(ReadFileToString(Env::Default(), path, &serialized));
+  return LoadSerializedAutotuneMaps(serialized);
+}
+
+Status SaveAutotuneMapsToFile(const std::string &path) {
+  std::string serialized;
+  TF_RETURN_IF_ERROR(SerializeAutotuneMaps(&serialized));
+  Env *env = Env::Default();
+  std::string tmp_path = path;
+  if (!env->CreateUniqueFileName(&tmp_path, ".tmp")) {
+    return errors::Internal("Failed to create a temporary file name for ",
+                            path);
+  }
+  TF_RETURN_IF_ERROR(WriteStringToFile(env, tmp_path, serialized));
+  Status status = env->RenameFile(tmp_path, path);
+  if (!status.ok()) {
+    env->DeleteFile(tmp_path).IgnoreError();
+  }
+  return status;
+}
+
+void MaybeEnablePersistentAutotuneCache(absl::string_view dnn_version) {
+  // Leaked so that it is still alive when the exit handler runs.
+  static std::string *cache_file = nullptr;
+  static bool initialized = [&] {
+    std::string cache_dir;
+    Status status =
+        ReadStringFromEnvVar("TF_AUTOTUNE_CACHE_DIR", "", &cache_dir);
+    if (!status.ok()) {
+      LOG(ERROR) << status;
+      return true;
+    }
+    if (cache_dir.empty()) return true;
+    status = Env::Default()->RecursivelyCreateDir(cache_dir);
+    if (!status.ok()) {
+      LOG(WARNING) << "Not persisting autotune results: " << status;
+      return true;
+    }
+    cache_file =
+        new std::string(AutotuneMapsCacheFile(cache_dir, dnn_version));
+    if (Env::Default()->FileExists(*cache_file).ok()) {
+      status = LoadAutotuneMapsFromFile(*cache_file);
+      if (status.ok()) {
+        VLOG(1) << "Loaded autotune results from " << *cache_file;
+      } else {
+        // A stale or corrupt cache is replaced at exit.
+        LOG(WARNING) << "Ignoring autotune cache " << *cache_file << ": "
+                     << status;
+      }
+    }
+    std::atexit([] {
+      Status status = SaveAutotuneMapsToFile(*cache_file);
+      if (!status.ok()) {
+        LOG(WARNING) << "Failed to save autotune results to " << *cache_file
+                     << ": " << status;
+      }
+    });
+    return true;
+  }();
+  (void)initialized;
+}
+
 }  // namespace tensorflow
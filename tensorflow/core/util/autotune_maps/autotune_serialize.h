@@ -43,6 +43,27 @@ Status SerializeAutotuneMaps(std::string* output);
 // Resets all autotune maps. For test use only.
 void ResetAutotuneMaps();
 
+// Returns the path of the autotune cache file in `cache_dir` for the GPUs
+// visible to this process and the given DNN library version. Autotune results
+// are only valid for the exact device models and library they were measured
+// with, so both are part of the file name.
+std::string AutotuneMapsCacheFile(absl::string_view cache_dir,
+                                  absl::string_view dnn_version);
+
+// Loads the autotune maps from a file written by SaveAutotuneMapsToFile.
+Status LoadAutotuneMapsFromFile(const std::string& path);
+
+// Serializes all the autotune maps into `path`. The file is written to a
+// temporary location first and then renamed, so concurrent readers never see
+// a partially written cache.
+Status SaveAutotuneMapsToFile(const std::string& path);
+
+// If the TF_AUTOTUNE_CACHE_DIR environment variable is set, loads previously
+// saved autotune results for the current GPUs and `dnn_version` from that
+// directory and arranges for the autotune maps to be saved back there at
+// process exit. Only the first call has any effect.
+void MaybeEnablePersistentAutotuneCache(absl::string_view dnn_version);
+
 }  // namespace tensorflow
 
 #endif  // TENSORFLOW_CORE_UTIL_AUTOTUNE_MAPS_AUTOTUNE_SERIALIZE_H_
@@ -173,6 +173,41 @@ TEST(AutotuneSerializeTest, VersionControl) {
                HasSubstr("Aborted because the loaded autotune results")));
   EXPECT_EQ(ConvAutotuneMap::GetInstance()->GetMap().size(), 0);
 }
+
+// Tests that the autotune maps survive a round trip through a cache file.
+TEST(AutotuneSerializeTest, FileRoundTrip) {
+  TF_CHECK_OK(GpuDriver::Init());
+  ResetAutotuneMaps();
+  ConvParameters conv_params_example_a = {
+      /*batch=*/1,
+      /*in_depths=*/1,
+      /*in=*/{{1, 1}},
+      /*data_format=*/TensorFormat::FORMAT_NCHW,
+      /*out_depths=*/1,
+      /*filter=*/{{1, 1}},
+      /*dilation=*/{{1, 1}},
+      /*stride=*/{{1, 1}},
+      /*padding=*/{{1, 1}},
+      /*dtype=*/DataType::DT_INT8,
+      /*device_id=*/0,
+      /*group_count=*/1};
+  AlgorithmDesc algorithm(/*algo_id=*/1, /*use_tensor_ops=*/true);
+  AutotuneEntry<se::dnn::ConvOp> example_a(algorithm, absl::nullopt);
+  ConvAutotuneMap::GetInstance()->Insert(conv_params_example_a, example_a);
+
+  const std::string cache_file =
+      AutotuneMapsCacheFile(testing::TmpDir(), "8.1.0");
+  EXPECT_NE(cache_file, AutotuneMapsCacheFile(testing::TmpDir(), "8.2.0"));
+  TF_CHECK_OK(SaveAutotuneMapsToFile(cache_file));
+  ResetAutotuneMaps();
+  TF_CHECK_OK(LoadAutotuneMapsFromFile(cache_file));
+  EXPECT_EQ(ConvAutotuneMap::GetInstance()->GetMap().size(), 1);
+
+  AutotuneEntry<se::dnn::ConvOp> entry;
+  EXPECT_TRUE(
+      ConvAutotuneMap::GetInstance()->Find(conv_params_example_a, &entry));
+  EXPECT_EQ(entry, example_a);
+}
 }  // namespace
 }  // namespace tensorflow
 #endif  // GOOGLE_CUDA || TENSORFLOW_USE_ROCM
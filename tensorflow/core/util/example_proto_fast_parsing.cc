@@ -109,6 +109,55 @@ uint8 PeekTag(protobuf::io::CodedInputStream* stream) {
   return *static_cast<const uint8*>(ptr);
 }
 
+// Returns a pointer to the next `length` bytes of `stream` if they are
+// available in its current buffer, or nullptr otherwise.
+const uint8* GetDirectBuffer(protobuf::io::CodedInputStream* stream,
+                             uint32 length) {
+  const void* ptr;
+  int size;
+  if (!stream->GetDirectBufferPointer(&ptr, &size) ||
+      static_cast<uint32>(size) < length) {
+    return nullptr;
+  }
+  return static_cast<const uint8*>(ptr);
+}
+
+// Returns the number of varints in the packed buffer [begin, end), or -1 if
+// the last varint is truncated. Every varint ends with its only byte that has
+// the most significant bit clear, so this reduces to a branch-free byte count
+// the compiler can vectorize.
+int64_t CountPackedVarints(const uint8* begin, const uint8* end) {
+  if (begin != end && end[-1] >= 0x80) return -1;
+  int64_t count = 0;
+  for (const uint8* p = begin; p != end; ++p) {
+    count += *p < 0x80;
+  }
+  return count;
+}
+
+// Decodes the first `num_values` varints of a packed buffer into `out`. The
+// buffer must have been validated with `CountPackedVarints`. Returns false if
+// a varint is longer than 10 bytes.
+template <typename T>
+bool DecodePackedVarints(const uint8* begin, int64_t num_values, T* out) {
+  const uint8* p = begin;
+  for (int64_t i = 0; i < num_values; ++i) {
+    uint64 value = *p & 0x7f;
+    if (*p++ >= 0x80) {
+      int shift = 7;
+      uint8 byte;
+      do {
+        if (shift > 63) return false;
+        byte = *p++;
+        value |= static_cast<uint64>(byte & 0x7f) << shift;
+        shift += 7;
+      } while (byte >= 0x80);
+    }
+    out[i] = static_cast<T>(value);
+  }
+  return true;
+}
+
 constexpr uint8 kVarintTag(uint32 tag) { return (tag << 3) | 0; }
 constexpr uint8 kDelimitedTag(uint32 tag) { return (tag << 3) | 2; }
 constexpr uint8 kFixed32Tag(uint32 tag) { return (tag << 3) | 5; }
@@ -301,10 +350,30 @@ class Feature {
         if (!stream.ReadVarint32(&packed_length)) return false;
         auto packed_limit = stream.PushLimit(packed_length);
 
-        while (!stream.ExpectAtEnd()) {
-          protobuf_uint64 n;  // There is no API for int64
-          if (!stream.ReadVarint64(&n)) return false;
-          int64_list->push_back(static_cast<int64_t>(n));
+        const uint8* packed = GetDirectBuffer(&stream, packed_length);
+        if (packed != nullptr) {
+          // Resize the output once and decode straight from the serialized
+          // buffer instead of pushing back one varint at a time.
+          const int64_t num_values =
+              CountPackedVarints(packed, packed + packed_length);
+          if (num_values < 0) return false;
+          const size_t initial_size = int64_list->size();
+          int64_list->resize(initial_size + num_values);
+          // The buffer available can be less than what we requested in
+          // resize in case of a LimitedArraySlice.
+          const int64_t num_to_decode = std::min<int64_t>(
+              num_values, int64_list->size() - initial_size);
+          if (!DecodePackedVarints(packed, num_to_decode,
+                                   int64_list->data() + initial_size)) {
+            return false;
+          }
+          if (!stream.Skip(packed_length)) return false;
+        } else {
+          while (!stream.ExpectAtEnd()) {
+            protobuf_uint64 n;  // There is no API for int64
+            if (!stream.ReadVarint64(&n)) return false;
+            int64_list->push_back(static_cast<int64_t>(n));
+          }
         }
 
         stream.PopLimit(packed_limit);
@@ -1087,18 +1156,37 @@ class TensorVector {
   T* data_ = nullptr;
 };
 
-void CountSparseFeatures(
-    const std::vector<std::vector<SparseBuffer>>& sparse_buffers, size_t d,
-    size_t* total_num_features, size_t* max_num_features) {
-  for (auto& sparse_values_tmp : sparse_buffers) {
-    const std::vector<size_t>& end_indices =
-        sparse_values_tmp[d].example_end_indices;
-    *total_num_features += end_indices.back();
-    *max_num_features = std::max(*max_num_features, end_indices[0]);
-    for (size_t i = 1; i < end_indices.size(); ++i) {
-      size_t example_size = end_indices[i] - end_indices[i - 1];
-      *max_num_features = std::max(*max_num_features, example_size);
-    }
+// Returns the offsets of the values of every minibatch in the merged values of
+// every feature: the values of feature d in minibatch i start at
+// offsets[d * (num_minibatches + 1) + i], and the total number of values of
+// feature d is offsets[d * (num_minibatches + 1) + num_minibatches].
+std::vector<size_t> MinibatchValueOffsets(
+    const std::vector<std::vector<SparseBuffer>>& buffers,
+    size_t num_features) {
+  const size_t num_minibatches = buffers.size();
+  std::vector<size_t> offsets(num_features * (num_minibatches + 1));
+  for (size_t d = 0; d < num_features; ++d) {
+    size_t* feature_offsets = &offsets[d * (num_minibatches + 1)];
+    for (size_t i = 0; i < num_minibatches; ++i) {
+      const std::vector<size_t>& end_indices =
+          buffers[i][d].example_end_indices;
+      feature_offsets[i + 1] =
+          feature_offsets[i] + (end_indices.empty() ? 0 : end_indices.back());
+    }
+  }
+  return offsets;
+}
+
+// Runs fn(begin, end) over [0, total) on `thread_pool`, or inline if it is
+// null.
+void ParallelForRange(int64_t total, int64_t cost_per_unit,
+                      const std::function<void(int64_t, int64_t)>& fn,
+                      thread::ThreadPool* thread_pool) {
+  if (total == 0) return;
+  if (thread_pool == nullptr) {
+    fn(0, total);
+  } else {
+    thread_pool->ParallelFor(total, cost_per_unit, fn);
   }
 }
 
@@ -1208,8 +1296,31 @@ Status FastParseExample(const Config& config,
                             std::min<size_t>(max_minibatches, result));
   }();
 
+  // Split the examples into minibatches of about the same number of bytes
+  // rather than of examples, so that a few large examples, e.g. ones with very
+  // long sequences, don't end up in one minibatch and keep one thread busy
+  // while the others are idle.  Every minibatch gets at least one example.
+  std::vector<size_t> minibatch_starts(num_minibatches + 1, serialized.size());
+  {
+    size_t total_bytes = 0;
+    for (const tstring& example : serialized) total_bytes += example.size() + 1;
+    size_t e = 0;
+    size_t bytes_before_e = 0;
+    for (size_t i = 0; i < num_minibatches; ++i) {
+      const size_t target_bytes = total_bytes * i / num_minibatches;
+      const size_t min_start = i == 0 ? 0 : minibatch_starts[i - 1] + 1;
+      const size_t max_start = serialized.size() - (num_minibatches - i);
+      while (e < max_start &&
+             (e < min_start || bytes_before_e < target_bytes)) {
+        bytes_before_e += serialized[e].size() + 1;
+        ++e;
+      }
+      minibatch_starts[i] = e;
+    }
+  }
+
   auto first_example_of_minibatch = [&](size_t minibatch) -> size_t {
-    return (serialized.size() * minibatch) / num_minibatches;
+    return minibatch_starts[minibatch];
   };
 
   // TODO(lew): A big performance low-hanging fruit here is to improve
@@ -1252,121 +1363,117 @@ Status FastParseExample(const Config& config,
     TF_RETURN_IF_ERROR(status);
   }
 
-  result->sparse_indices.reserve(config.sparse.size());
-  result->sparse_values.reserve(config.sparse.size());
-  result->sparse_shapes.reserve(config.sparse.size());
   result->dense_values.reserve(config.dense.size());
-  result->ragged_values.reserve(config.ragged.size());
-  result->ragged_splits.reserve(config.ragged.size());
-
   for (size_t d = 0; d < config.dense.size(); ++d) {
     result->dense_values.push_back(std::move(fixed_dense_values[d]));
   }
 
-  // Merge SparseBuffers from all minibatches for every config.sparse.
-  auto MergeSparseMinibatches = [&](size_t d) {
-    // Loop over minibatches
-    size_t total_num_features = 0;
-    size_t max_num_features = 0;
-    CountSparseFeatures(sparse_buffers, d, &total_num_features,
-                        &max_num_features);
+  // Allocate the outputs of sparse and ragged features, and find where the
+  // values of every minibatch go in them.  The minibatches are then merged
+  // in parallel by feature and by minibatch, each writing its indices,
+  // row_splits and values straight to their final offsets.
+  const size_t num_sparse = config.sparse.size();
+  const size_t num_ragged = config.ragged.size();
+  const std::vector<size_t> sparse_offsets =
+      MinibatchValueOffsets(sparse_buffers, num_sparse);
+  const std::vector<size_t> ragged_offsets =
+      MinibatchValueOffsets(ragged_buffers, num_ragged);
+  size_t total_num_values = 0;
+
+  result->sparse_indices.reserve(num_sparse);
+  result->sparse_values.reserve(num_sparse);
+  result->sparse_shapes.reserve(num_sparse);
+  for (size_t d = 0; d < num_sparse; ++d) {
+    const size_t total_num_features =
+        sparse_offsets[d * (num_minibatches + 1) + num_minibatches];
+    total_num_values += total_num_features;
+    result->sparse_indices.emplace_back(
+        DT_INT64, TensorShape({static_cast<int64_t>(total_num_features), 2}));
+    result->sparse_values.emplace_back(
+        config.sparse[d].dtype,
+        TensorShape({static_cast<int64_t>(total_num_features)}));
+    result->sparse_shapes.emplace_back(DT_INT64, TensorShape({2}));
+  }
 
-    TensorShape indices_shape;
-    indices_shape.AddDim(total_num_features);
-    indices_shape.AddDim(2);
-    result->sparse_indices.emplace_back(DT_INT64, indices_shape);
-    Tensor* indices = &result->sparse_indices.back();
+  result->ragged_values.reserve(num_ragged);
+  result->ragged_splits.reserve(num_ragged);
+  for (size_t d = 0; d < num_ragged; ++d) {
+    const size_t total_num_features =
+        ragged_offsets[d * (num_minibatches + 1) + num_minibatches];
+    total_num_values += total_num_features;
+    result->ragged_values.emplace_back(
+        config.ragged[d].dtype,
+        TensorShape({static_cast<int64_t>(total_num_features)}));
+    result->ragged_splits.emplace_back(
+        config.ragged[d].splits_dtype,
+        TensorShape({static_cast<int64_t>(serialized.size() + 1)}));
+    Tensor* row_splits = &result->ragged_splits.back();
+    if (config.ragged[d].splits_dtype == DT_INT64) {
+      row_splits->flat<int64_t>()(0) = 0;
+    } else {
+      row_splits->flat<int32>()(0) = 0;
+    }
+  }
 
-    TensorShape values_shape;
-    values_shape.AddDim(total_num_features);
-    result->sparse_values.emplace_back(config.sparse[d].dtype, values_shape);
-    Tensor* values = &result->sparse_values.back();
+  // The largest number of values of feature d in an example of minibatch i,
+  // at [d * num_minibatches + i].
+  std::vector<size_t> sparse_max_num_features(num_sparse * num_minibatches);
 
-    result->sparse_shapes.emplace_back(DT_INT64, TensorShape({2}));
-    auto shapes_shape_t = result->sparse_shapes.back().vec<int64_t>();
-    shapes_shape_t(0) = serialized.size();
-    shapes_shape_t(1) = max_num_features;
+  // Merge the SparseBuffer of minibatch i for config.sparse[d].
+  auto MergeSparseMinibatch = [&](size_t d, size_t i) {
+    SparseBuffer& buffer = sparse_buffers[i][d];
+    const size_t offset = sparse_offsets[d * (num_minibatches + 1) + i];
+    Tensor* indices = &result->sparse_indices[d];
 
-    size_t offset = 0;
-    for (size_t i = 0; i < sparse_buffers.size(); ++i) {
-      SparseBuffer& buffer = sparse_buffers[i][d];
-
-      // Update indices.
-      size_t delta = 0;
-
-      if (indices->NumElements() > 0) {
-        int64* ix_p = &indices->matrix<int64_t>()(offset, 0);
-        size_t example_index = first_example_of_minibatch(i);
-        for (size_t example_end_index : buffer.example_end_indices) {
-          size_t feature_index = 0;
-          for (; delta < example_end_index; ++delta) {
-            // Column 0: example index
-            *ix_p = example_index;
-            // Column 1: the feature index buffer example
-            *(ix_p + 1) = feature_index;
-            ix_p += 2;
-            ++feature_index;
-          }
-          ++example_index;
+    // Update indices.
+    size_t delta = 0;
+    size_t max_num_features = 0;
+    if (indices->NumElements() > 0) {
+      int64* ix_p = &indices->matrix<int64_t>()(offset, 0);
+      size_t example_index = first_example_of_minibatch(i);
+      for (size_t example_end_index : buffer.example_end_indices) {
+        size_t feature_index = 0;
+        for (; delta < example_end_index; ++delta) {
+          // Column 0: example index
+          *ix_p = example_index;
+          // Column 1: the feature index buffer example
+          *(ix_p + 1) = feature_index;
+          ix_p += 2;
+          ++feature_index;
         }
+        max_num_features = std::max(max_num_features, feature_index);
+        ++example_index;
       }
-
-      CopySparseBufferToTensor(config.sparse[d].dtype, offset, &buffer, values);
-      offset += delta;
     }
+    sparse_max_num_features[d * num_minibatches + i] = max_num_features;
+
+    CopySparseBufferToTensor(config.sparse[d].dtype, offset, &buffer,
+                             &result->sparse_values[d]);
   };
 
-  // Merge SparseBuffers from all minibatches for every config.ragged.
-  auto MergeRaggedMinibatches = [&](size_t d) {
-    // Loop over minibatches
-    size_t total_num_features = 0;
-    size_t max_num_features = 0;
-    CountSparseFeatures(ragged_buffers, d, &total_num_features,
-                        &max_num_features);
+  // Merge the SparseBuffer of minibatch i for config.ragged[d].
+  auto MergeRaggedMinibatch = [&](size_t d, size_t i) {
+    SparseBuffer& buffer = ragged_buffers[i][d];
+    const size_t offset = ragged_offsets[d * (num_minibatches + 1) + i];
+    Tensor* row_splits = &result->ragged_splits[d];
 
-    TensorShape row_splits_shape;
-    row_splits_shape.AddDim(serialized.size() + 1);
-    result->ragged_splits.emplace_back(config.ragged[d].splits_dtype,
-                                       row_splits_shape);
-    Tensor* row_splits = &result->ragged_splits.back();
+    // Update row_splits.  row_splits are formed by concatenating the example
+    // end_indices (adjusting each to start after the previous one ends).
+    const size_t splits_offset = first_example_of_minibatch(i) + 1;
     if (config.ragged[d].splits_dtype == DT_INT64) {
-      row_splits->flat<int64_t>()(0) = 0;
+      int64* row_splits_out = &row_splits->flat<int64_t>()(splits_offset);
+      for (size_t example_end_index : buffer.example_end_indices) {
+        *row_splits_out++ = offset + example_end_index;
+      }
     } else {
-      row_splits->flat<int32>()(0) = 0;
-    }
-
-    TensorShape values_shape;
-    values_shape.AddDim(total_num_features);
-    result->ragged_values.emplace_back(config.ragged[d].dtype, values_shape);
-    Tensor* values = &result->ragged_values.back();
-
-    size_t values_offset = 0;
-    size_t splits_offset = 0;
-    for (size_t i = 0; i < ragged_buffers.size(); ++i) {
-      SparseBuffer& buffer = ragged_buffers[i][d];
-      if (buffer.example_end_indices.empty()) continue;
-
-      // Update row_splits.  row_splits are formed by concatenating the example
-      // end_indices (adjusting each to start after the previous one ends).
-      if (config.ragged[d].splits_dtype == DT_INT64) {
-        int64* row_splits_out = &row_splits->flat<int64_t>()(splits_offset);
-        int64_t start = *row_splits_out;
-        for (size_t example_end_index : buffer.example_end_indices) {
-          *++row_splits_out = start + example_end_index;
-        }
-      } else {
-        int32* row_splits_out = &row_splits->flat<int32>()(splits_offset);
-        int32_t start = *row_splits_out;
-        for (size_t example_end_index : buffer.example_end_indices) {
-          *++row_splits_out = start + example_end_index;
-        }
+      int32* row_splits_out = &row_splits->flat<int32>()(splits_offset);
+      for (size_t example_end_index : buffer.example_end_indices) {
+        *row_splits_out++ = offset + example_end_index;
       }
-
-      CopySparseBufferToTensor(config.ragged[d].dtype, values_offset, &buffer,
-                               values);
-      values_offset += buffer.example_end_indices.back();
-      splits_offset += buffer.example_end_indices.size();
     }
+
+    CopySparseBufferToTensor(config.ragged[d].dtype, offset, &buffer,
+                             &result->ragged_values[d]);
   };
 
   // Merge SparseBuffers from all minibatches for every config.dense having
@@ -1426,16 +1533,47 @@ Status FastParseExample(const Config& config,
     }
   };
 
-  for (size_t d = 0; d < config.dense.size(); ++d) {
-    MergeDenseVarLenMinibatches(d);
-  }
-
-  for (size_t d = 0; d < config.sparse.size(); ++d) {
-    MergeSparseMinibatches(d);
-  }
+  // Work items are (feature, minibatch) pairs of the sparse and the ragged
+  // features, followed by the variable-length dense features, which are
+  // padded and merged one whole feature at a time.
+  const size_t num_sparse_items = num_sparse * num_minibatches;
+  const size_t num_ragged_items = num_ragged * num_minibatches;
+  const size_t num_items =
+      num_sparse_items + num_ragged_items + config.dense.size();
+  static constexpr int64_t kCostPerValue = 10;
+  static constexpr int64_t kCostPerItem = 1000;
+  const int64_t cost_per_item =
+      kCostPerItem +
+      kCostPerValue * static_cast<int64_t>(total_num_values /
+                                           std::max<size_t>(num_items, 1));
+  ParallelForRange(
+      num_items, cost_per_item,
+      [&](int64_t begin, int64_t end) {
+        for (size_t item = begin; item < static_cast<size_t>(end); ++item) {
+          if (item < num_sparse_items) {
+            MergeSparseMinibatch(item / num_minibatches,
+                                 item % num_minibatches);
+          } else if (item < num_sparse_items + num_ragged_items) {
+            const size_t ragged_item = item - num_sparse_items;
+            MergeRaggedMinibatch(ragged_item / num_minibatches,
+                                 ragged_item % num_minibatches);
+          } else {
+            MergeDenseVarLenMinibatches(item - num_sparse_items -
+                                        num_ragged_items);
+          }
+        }
+      },
+      thread_pool);
 
-  for (size_t d = 0; d < config.ragged.size(); ++d) {
-    MergeRaggedMinibatches(d);
+  for (size_t d = 0; d < num_sparse; ++d) {
+    size_t max_num_features = 0;
+    for (size_t i = 0; i < num_minibatches; ++i) {
+      max_num_features = std::max(
+          max_num_features, sparse_max_num_features[d * num_minibatches + i]);
+    }
+    auto shapes_shape_t = result->sparse_shapes[d].vec<int64_t>();
+    shapes_shape_t(0) = serialized.size();
+    shapes_shape_t(1) = max_num_features;
   }
 
   return OkStatus();
@@ -1972,15 +2110,27 @@ inline int ParseInt64Feature(protobuf::io::CodedInputStream* stream,
         return -1;
       }
       auto packed_limit = stream->PushLimit(packed_length);
-      while (!stream->ExpectAtEnd()) {
-        protobuf_uint64 n;  // There is no API for int64
-        if (!stream->ReadVarint64(&n)) {
+      const uint8* packed = GetDirectBuffer(stream, packed_length);
+      if (packed != nullptr) {
+        const int64_t num_values =
+            CountPackedVarints(packed, packed + packed_length);
+        if (num_values < 0 ||
+            (out != nullptr && !DecodePackedVarints(packed, num_values, out)) ||
+            !stream->Skip(packed_length)) {
           return -1;
         }
-        if (out != nullptr) {
-          *out++ = n;
+        num_elements = num_values;
+      } else {
+        while (!stream->ExpectAtEnd()) {
+          protobuf_uint64 n;  // There is no API for int64
+          if (!stream->ReadVarint64(&n)) {
+            return -1;
+          }
+          if (out != nullptr) {
+            *out++ = n;
+          }
+          num_elements++;
         }
-        num_elements++;
       }
       stream->PopLimit(packed_limit);
     } else if (peek_tag == kVarintTag(1)) {
@@ -13,14 +13,17 @@ See the License for the specific language governing permissions and
 limitations under the License.
 ==============================================================================*/
 
+#include <limits>
 #include <utility>
 
 #include "tensorflow/core/util/example_proto_fast_parsing.h"
 
 #include "tensorflow/core/example/example.pb.h"
 #include "tensorflow/core/example/feature.pb.h"
+#include "tensorflow/core/lib/core/threadpool.h"
 #include "tensorflow/core/lib/random/philox_random.h"
 #include "tensorflow/core/lib/random/simple_philox.h"
+#include "tensorflow/core/platform/env.h"
 #include "tensorflow/core/platform/protobuf.h"
 #include "tensorflow/core/platform/test.h"
 #include "tensorflow/core/platform/test_benchmark.h"
@@ -170,6 +173,26 @@ TEST(FastParse, Packed) {
       "\x0a\x0d\x0a\x0b\x0a\x03\x61\x67\x65\x12\x04\x1a\x02\x08\x0d");
 }
 
+TEST(FastParse, PackedMultiByteVarints) {
+  Example example;
+  auto* int64_list = (*example.mutable_features()->mutable_feature())["ids"]
+                         .mutable_int64_list();
+  for (int64_t value : {int64_t{0}, int64_t{1}, int64_t{127}, int64_t{128},
+                        int64_t{300}, int64_t{-1}, int64_t{1} << 40,
+                        std::numeric_limits<int64_t>::max(),
+                        std::numeric_limits<int64_t>::min()}) {
+    int64_list->add_value(value);
+  }
+  TestCorrectness(Serialize(example));
+}
+
+TEST(FastParse, TruncatedPackedVarint) {
+  Example example;
+  EXPECT_FALSE(TestFastParse(
+      "\x0a\x0e\x0a\x0c\x0a\x03\x61\x67\x65\x12\x05\x1a\x03\x0a\x01\x80",
+      &example));
+}
+
 TEST(FastParse, ValueBeforeKeyInMap) {
   TestCorrectness("\x0a\x12\x0a\x10\x12\x09\x0a\x07\x0a\x05value\x0a\x03key");
 }
@@ -417,6 +440,66 @@ TEST(FastParse, FuzzTest) {
   }
 }
 
+TEST(TestFastParseExample, SkewedSparseAndRagged) {
+  // A few examples have many more values than the others, so that they are
+  // split over minibatches by size, and merged in parallel.
+  constexpr int kNumExamples = 100;
+  std::vector<tstring> serialized;
+  for (int i = 0; i < kNumExamples; ++i) {
+    Example example;
+    auto& features = *example.mutable_features()->mutable_feature();
+    const int num_values = i % 10 == 3 ? 20000 : i % 3;
+    for (int j = 0; j < num_values; ++j) {
+      features["ragged"].mutable_int64_list()->add_value(i * 100000 + j);
+      features["sparse"].mutable_float_list()->add_value(i + j);
+    }
+    if (i % 7 != 0) features["other"].mutable_bytes_list()->add_value("x");
+    serialized.push_back(example.SerializeAsString());
+  }
+
+  FastParseExampleConfig config;
+  config.ragged.emplace_back("ragged", DT_INT64, DT_INT32);
+  config.ragged.emplace_back("other", DT_STRING, DT_INT64);
+  AddSparseFeature("sparse", DT_FLOAT, &config);
+
+  thread::ThreadPool thread_pool(Env::Default(), "test", 4);
+  const std::vector<thread::ThreadPool*> pools = {&thread_pool, nullptr};
+  for (thread::ThreadPool* pool : pools) {
+    Result result;
+    TF_ASSERT_OK(FastParseExample(config, serialized, {}, pool, &result));
+
+    ASSERT_EQ(2, result.ragged_splits.size());
+    auto splits = result.ragged_splits[0].vec<int32>();
+    auto values = result.ragged_values[0].vec<int64_t>();
+    auto other_splits = result.ragged_splits[1].vec<int64_t>();
+    ASSERT_EQ(kNumExamples + 1, splits.size());
+    EXPECT_EQ(0, splits(0));
+    EXPECT_EQ(0, other_splits(0));
+    for (int i = 0; i < kNumExamples; ++i) {
+      const int num_values = i % 10 == 3 ? 20000 : i % 3;
+      ASSERT_EQ(num_values, splits(i + 1) - splits(i)) << i;
+      for (int j = 0; j < num_values; ++j) {
+        ASSERT_EQ(i * 100000 + j, values(splits(i) + j));
+      }
+      EXPECT_EQ(i % 7 != 0 ? 1 : 0, other_splits(i + 1) - other_splits(i));
+    }
+    EXPECT_EQ(values.size(), splits(kNumExamples));
+    EXPECT_EQ(result.ragged_values[1].NumElements(),
+              other_splits(kNumExamples));
+
+    ASSERT_EQ(1, result.sparse_indices.size());
+    auto indices = result.sparse_indices[0].matrix<int64_t>();
+    auto sparse_values = result.sparse_values[0].vec<float>();
+    auto shape = result.sparse_shapes[0].vec<int64_t>();
+    EXPECT_EQ(kNumExamples, shape(0));
+    EXPECT_EQ(20000, shape(1));
+    ASSERT_EQ(values.size(), sparse_values.size());
+    for (int n = 0; n < sparse_values.size(); ++n) {
+      EXPECT_EQ(indices(n, 0) + indices(n, 1), sparse_values(n));
+    }
+  }
+}
+
 TEST(TestFastParseExample, Empty) {
   Result result;
   FastParseExampleConfig config;
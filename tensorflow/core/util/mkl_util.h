@@ -17,6 +17,8 @@ limitations under the License.
 #define TENSORFLOW_CORE_UTIL_MKL_UTIL_H_
 #ifdef INTEL_MKL
 
+#include <algorithm>
+#include <atomic>
 #include <list>
 #include <memory>
 #include <string>
@@ -1759,14 +1761,26 @@ const dnnl::memory::dims NONE_DIMS = {};
 // cached items. When the cache reaches its capacity, the LRU item will
 // be removed and replaced by a new one from SetOp call.
 //
+// Caches may also share a budget of `total_capacity` items, counted in
+// `total_size`, so that the many thread-local caches of a process with a
+// large thread pool do not each grow to `capacity`. When the shared budget is
+// used up, SetOp evicts the LRU items of this cache before inserting.
+//
 template <typename T>
 class LRUCache {
  public:
-  explicit LRUCache(size_t capacity) {
+  explicit LRUCache(size_t capacity) : LRUCache(capacity, 0, nullptr) {}
+
+  // `total_capacity` of 0 means the shared budget is unlimited.
+  LRUCache(size_t capacity, size_t total_capacity,
+           std::atomic<size_t>* total_size)
+      : total_capacity_(total_capacity), total_size_(total_size) {
     capacity_ = capacity;
     Clear();
   }
 
+  ~LRUCache() { Clear(); }
+
   T* GetOp(const string& key) {
 #ifdef DNNL_AARCH64_USE_ACL
     mutex_lock lock(lru_mu_);
@@ -1790,6 +1804,12 @@ class LRUCache {
     if (lru_list_.size() >= capacity_) {
       Delete();
     }
+    if (total_size_ != nullptr) {
+      while (total_capacity_ > 0 && *total_size_ >= total_capacity_ &&
+             Delete()) {
+      }
+      ++*total_size_;
+    }
 
     // Insert an entry to the front of the LRU list
     lru_list_.push_front(key);
@@ -1804,6 +1824,7 @@ class LRUCache {
     if (lru_list_.empty()) return;
 
     // Clean up the cache
+    if (total_size_ != nullptr) *total_size_ -= lru_list_.size();
     cache_.clear();
     lru_list_.clear();
   }
@@ -1859,12 +1880,18 @@ class LRUCache {
     string key = lru_list_.back();
     lru_list_.pop_back();
     cache_.erase(key);
+    if (total_size_ != nullptr) --*total_size_;
     return true;
   }
 
   // Cache capacity
   size_t capacity_;
 
+  // The budget shared with other caches, and the number of items the caches
+  // sharing it hold.
+  const size_t total_capacity_;
+  std::atomic<size_t>* const total_size_;
+
   // The cache, a map from string key to a LRU entry.
   std::unordered_map<string, Entry> cache_;
 
@@ -1884,6 +1911,13 @@ class LRUCache {
 #endif
 };
 
+// The number of primitives held by the caches of all MklPrimitiveFactory
+// types on all threads.
+inline std::atomic<size_t>* MklPrimitiveCacheTotalSize() {
+  static std::atomic<size_t> total_size{0};
+  return &total_size;
+}
+
 template <typename T>
 class MklPrimitiveFactory {
  public:
@@ -1972,12 +2006,41 @@ class MklPrimitiveFactory {
 #endif
 
  private:
+  // Each primitive type caches up to TF_MKL_PRIMITIVE_CACHE_CAPACITY
+  // primitives (per thread, unless built with ACL). The caches of all types
+  // and threads together hold at most TF_MKL_PRIMITIVE_CACHE_TOTAL_CAPACITY
+  // primitives, if that is set. The compiled kernels behind the primitives
+  // are shared across threads by oneDNN's own primitive cache, so a smaller
+  // budget mostly costs the re-creation of cheap wrappers.
+  static int64_t GetCacheCapacity() {
+    static const int64_t capacity = [] {
+      int64_t value;
+      TF_CHECK_OK(ReadInt64FromEnvVar("TF_MKL_PRIMITIVE_CACHE_CAPACITY", 1024,
+                                      &value));
+      return std::max<int64_t>(value, 1);
+    }();
+    return capacity;
+  }
+
+  static int64_t GetCacheTotalCapacity() {
+    static const int64_t total_capacity = [] {
+      int64_t value;
+      TF_CHECK_OK(ReadInt64FromEnvVar("TF_MKL_PRIMITIVE_CACHE_TOTAL_CAPACITY",
+                                      0, &value));
+      return std::max<int64_t>(value, 0);
+    }();
+    return total_capacity;
+  }
+
   static inline LRUCache<MklPrimitive>& GetLRUCache() {
-    static const int kCapacity = 1024;  // cache capacity
 #ifndef DNNL_AARCH64_USE_ACL
-    static thread_local LRUCache<MklPrimitive> lru_cache_(kCapacity);
+    static thread_local LRUCache<MklPrimitive> lru_cache_(
+        GetCacheCapacity(), GetCacheTotalCapacity(),
+        MklPrimitiveCacheTotalSize());
 #else
-    static LRUCache<MklPrimitive> lru_cache_(kCapacity);
+    static LRUCache<MklPrimitive> lru_cache_(GetCacheCapacity(),
+                                             GetCacheTotalCapacity(),
+                                             MklPrimitiveCacheTotalSize());
     TF_GUARDED_BY(lru_mu_)
 #endif
     return lru_cache_;
@@ -115,6 +115,40 @@ TEST(MklUtilTest, LRUCacheTest) {
   }
 }
 
+TEST(MklUtilTest, LRUCacheSharedBudgetTest) {
+  // Two caches of capacity 10 share a budget of 12 objects.
+  std::atomic<size_t> total_size{0};
+  LRUCache<int> cache_a(10, 12, &total_size);
+  LRUCache<int> cache_b(10, 12, &total_size);
+  for (int k = 0; k < 10; k++) {
+    cache_a.SetOp(std::to_string(k), new int(k));
+  }
+  EXPECT_EQ(total_size, 10);
+
+  // Once the budget is used up, cache_b evicts its own objects rather than
+  // growing to its capacity.
+  for (int k = 0; k < 5; k++) {
+    cache_b.SetOp(std::to_string(k), new int(k));
+  }
+  EXPECT_EQ(total_size, 12);
+  for (int k = 0; k < 3; k++) {
+    EXPECT_EQ(nullptr, cache_b.GetOp(std::to_string(k)));
+  }
+  EXPECT_NE(nullptr, cache_b.GetOp("3"));
+  EXPECT_NE(nullptr, cache_b.GetOp("4"));
+  EXPECT_NE(nullptr, cache_a.GetOp("0"));
+
+  // Clearing or destroying a cache returns its share of the budget.
+  cache_a.Clear();
+  EXPECT_EQ(total_size, 2);
+  {
+    LRUCache<int> cache_c(10, 12, &total_size);
+    cache_c.SetOp("0", new int(0));
+    EXPECT_EQ(total_size, 3);
+  }
+  EXPECT_EQ(total_size, 2);
+}
+
 }  // namespace
 }  // namespace tensorflow
 
@@ -16,11 +16,14 @@ limitations under the License.
 #include "tensorflow/core/util/tensor_bundle/tensor_bundle.h"
 
 #include <algorithm>
+#include <atomic>
 #include <cstdlib>
 #include <cstring>
 #include <memory>
+#include <tuple>
 #include <utility>
 
+#include "tensorflow/core/framework/allocation_description.pb.h"
 #include "tensorflow/core/framework/register_types.h"
 #include "tensorflow/core/framework/tensor.pb.h"
 #include "tensorflow/core/framework/tensor_shape.pb.h"
@@ -42,8 +45,10 @@ limitations under the License.
 #include "tensorflow/core/lib/strings/stringprintf.h"
 #include "tensorflow/core/platform/bfloat16.h"
 #include "tensorflow/core/platform/cord.h"
+#include "tensorflow/core/platform/blocking_counter.h"
 #include "tensorflow/core/platform/errors.h"
 #include "tensorflow/core/platform/mem.h"
+#include "tensorflow/core/platform/mutex.h"
 #include "tensorflow/core/util/env_var.h"
 #include "tensorflow/core/util/saved_tensor_slice_util.h"
 #include "tensorflow/core/util/tensor_bundle/byte_swap.h"
@@ -62,6 +67,9 @@ const int kTensorBundleVersion = 1;
 
 // Size of our input buffer for streaming reads
 static const int kBufferSize = 1024 * 1024;
+// The largest read of BundleReader::LookupMany.  Larger tensors are split
+// into several reads, so that they are read by several threads.
+static const int64_t kMaxLookupManyReadBytes = 8 * 1024 * 1024;
 
 // Key to the special BundleHeaderProto entry.  Do not change this, as clients
 // can make the assumption that the header is always the first entry in the
@@ -409,6 +417,31 @@ Status PadAlignment(FileOutputBuffer* out, int alignment, int64_t* size) {
   return status;
 }
 
+// A TensorBuffer pointing into a memory-mapped bundle data file.  Holds a
+// reference on the mapping so that it outlives the BundleReader if needed.
+class MappedTensorBuffer : public TensorBuffer {
+ public:
+  MappedTensorBuffer(core::RefCounted* mapping, const char* data, size_t len)
+      : TensorBuffer(const_cast<char*>(data)), mapping_(mapping), len_(len) {
+    mapping_->Ref();
+  }
+  ~MappedTensorBuffer() override { mapping_->Unref(); }
+
+  size_t size() const override { return len_; }
+  TensorBuffer* root_buffer() override { return this; }
+  void FillAllocationDescription(AllocationDescription* proto) const override {
+    proto->set_requested_bytes(static_cast<int64_t>(len_));
+    proto->set_allocator_name("BundleReaderMmap");
+  }
+  // The mapping is read-only, so the buffer must never be forwarded to an
+  // op that would update it in place.
+  bool OwnsMemory() const override { return false; }
+
+ private:
+  core::RefCounted* const mapping_;
+  const size_t len_;
+};
+
 }  // namespace
 
 BundleWriter::BundleWriter(Env* env, StringPiece prefix, const Options& options)
@@ -743,9 +776,27 @@ Status MergeBundles(Env* env, gtl::ArraySlice<tstring> prefixes,
 
 // Interface for reading a tensor bundle.
 
-BundleReader::BundleReader(Env* env, StringPiece prefix)
+// A refcounted memory-mapped data file, shared between the owning BundleReader
+// and every tensor handed out from it.
+class BundleReader::MappedDataFile : public core::RefCounted {
+ public:
+  explicit MappedDataFile(std::unique_ptr<ReadOnlyMemoryRegion> region)
+      : region_(std::move(region)) {}
+
+  const char* data() const {
+    return reinterpret_cast<const char*>(region_->data());
+  }
+  uint64 length() const { return region_->length(); }
+
+ private:
+  const std::unique_ptr<ReadOnlyMemoryRegion> region_;
+};
+
+BundleReader::BundleReader(Env* env, StringPiece prefix,
+                           const Options& options)
     : env_(env),
       prefix_(prefix),
+      options_(options),
       metadata_(nullptr),
       table_(nullptr),
       index_cache_(nullptr),
@@ -817,8 +868,12 @@ BundleReader::~BundleReader() {
   for (auto& temp : tensor_slices_) {
     delete temp.second;
   }
+  for (auto& temp : mapped_data_) {
+    if (temp.second != nullptr) temp.second->Unref();
+  }
   data_.clear();
   tensor_slices_.clear();
+  mapped_data_.clear();
 }
 
 Status BundleReader::GetBundleEntryProto(StringPiece key,
@@ -842,6 +897,21 @@ Status BundleReader::GetBundleEntryProto(StringPiece key,
   return OkStatus();
 }
 
+Status BundleReader::GetDataFile(int32 shard_id,
+                                 io::InputBuffer** buffered_file) {
+  // Open the data file if it has not been opened.
+  io::InputBuffer*& file_for_shard = data_[shard_id];
+  if (file_for_shard == nullptr) {
+    std::unique_ptr<RandomAccessFile> file = nullptr;
+    TF_RETURN_IF_ERROR(env_->NewRandomAccessFile(
+        DataFilename(prefix_, shard_id, num_shards_), &file));
+    // The InputBuffer and RandomAccessFile objects are both released in dtor.
+    file_for_shard = new io::InputBuffer(file.release(), kBufferSize);
+  }
+  *buffered_file = file_for_shard;
+  return OkStatus();
+}
+
 Status BundleReader::GetValue(const BundleEntryProto& entry, Tensor* val) {
   Tensor* ret = val;
   const TensorShape stored_shape(TensorShape(entry.shape()));
@@ -871,17 +941,21 @@ Status BundleReader::GetValue(const BundleEntryProto& entry, Tensor* val) {
     }
   }
 
-  // Open the data file if it has not been opened.
-  io::InputBuffer* buffered_file = data_[entry.shard_id()];
-  if (buffered_file == nullptr) {
-    std::unique_ptr<RandomAccessFile> file = nullptr;
-    TF_RETURN_IF_ERROR(env_->NewRandomAccessFile(
-        DataFilename(prefix_, entry.shard_id(), num_shards_), &file));
-    buffered_file = new io::InputBuffer(file.release(), kBufferSize);
-    // The InputBuffer and RandomAccessFile objects are both released in dtor.
-    data_[entry.shard_id()] = buffered_file;
+  if (options_.use_mmap && DataTypeCanUseMemcpy(entry.dtype()) &&
+      !need_to_swap_bytes_) {
+    bool mapped = false;
+    Status s = GetMappedValue(entry, ret, &mapped);
+    if (!s.ok() || mapped) {
+      if (ret != val) {
+        if (s.ok()) *val = *ret;
+        delete ret;
+      }
+      return s;
+    }
   }
-  CHECK(buffered_file != nullptr);
+
+  io::InputBuffer* buffered_file;
+  TF_RETURN_IF_ERROR(GetDataFile(entry.shard_id(), &buffered_file));
 
   TF_RETURN_IF_ERROR(buffered_file->Seek(entry.offset()));
   uint32 actual_crc32c = 0;
@@ -938,6 +1012,61 @@ Status BundleReader::GetValue(const BundleEntryProto& entry, Tensor* val) {
   return OkStatus();
 }
 
+Status BundleReader::GetMappedValue(const BundleEntryProto& entry,
+                                    Tensor* val, bool* mapped) {
+  *mapped = false;
+  if (entry.size() == 0) return OkStatus();
+
+  auto it = mapped_data_.find(entry.shard_id());
+  if (it == mapped_data_.end()) {
+    MappedDataFile* mapped_file = nullptr;
+    const string filename =
+        DataFilename(prefix_, entry.shard_id(), num_shards_);
+    std::unique_ptr<ReadOnlyMemoryRegion> region;
+    Status s = env_->NewReadOnlyMemoryRegionFromFile(filename, &region);
+    if (s.ok()) {
+      mapped_file = new MappedDataFile(std::move(region));
+    } else {
+      VLOG(1) << "Unable to memory-map " << filename
+              << ", falling back to buffered reads: " << s;
+    }
+    it = mapped_data_.emplace(entry.shard_id(), mapped_file).first;
+  }
+  MappedDataFile* mapped_file = it->second;
+  if (mapped_file == nullptr) return OkStatus();
+
+  if (entry.offset() < 0 ||
+      static_cast<uint64>(entry.offset()) + entry.size() >
+          mapped_file->length()) {
+    return errors::DataLoss("TensorBundle at ", prefix_, " shard ",
+                            entry.shard_id(), ": entry at offset ",
+                            entry.offset(), " (", entry.size(),
+                            " bytes) extends past the end of the data file (",
+                            mapped_file->length(), " bytes)");
+  }
+  const char* data = mapped_file->data() + entry.offset();
+  if (reinterpret_cast<uintptr_t>(data) % EIGEN_MAX_ALIGN_BYTES != 0) {
+    return OkStatus();
+  }
+
+  if (entry.size() < options_.lazy_mmap_min_bytes) {
+    const uint32 actual_crc32c = crc32c::Value(data, entry.size());
+    if (crc32c::Unmask(entry.crc32c()) != actual_crc32c) {
+      return errors::DataLoss(
+          "TensorBundle at ", prefix_, " shard ", entry.shard_id(), " (",
+          entry.size(), " bytes): Checksum does not match: stored ",
+          strings::Printf("%08u", crc32c::Unmask(entry.crc32c())),
+          " vs. calculated on the mapped bytes ", actual_crc32c);
+    }
+  }
+
+  core::RefCountPtr<TensorBuffer> buf(
+      new MappedTensorBuffer(mapped_file, data, entry.size()));
+  *val = Tensor(entry.dtype(), TensorShape(entry.shape()), std::move(buf));
+  *mapped = true;
+  return OkStatus();
+}
+
 Status BundleReader::Lookup(StringPiece key, Tensor* val) {
   CHECK(val != nullptr);
   BundleEntryProto entry;
@@ -952,6 +1081,137 @@ Status BundleReader::Lookup(StringPiece key, Tensor* val) {
   }
 }
 
+Status BundleReader::LookupMany(gtl::ArraySlice<StringPiece> keys,
+                                gtl::ArraySlice<Tensor*> vals,
+                                thread::ThreadPool* pool) {
+  CHECK_EQ(keys.size(), vals.size());
+  // A tensor whose bytes are read straight into its buffer.
+  struct Target {
+    StringPiece key;
+    BundleEntryProto entry;
+    RandomAccessFile* file;
+    char* data;
+    // The number of reads of the tensor not yet done.  The read that brings
+    // it to zero validates the checksum.
+    std::atomic<int> num_pending_reads{0};
+  };
+  // A read of bytes [begin, end) of a target.
+  struct Read {
+    Target* target;
+    int64_t begin;
+    int64_t end;
+  };
+  std::unique_ptr<Target[]> targets(new Target[keys.size()]);
+  size_t num_targets = 0;
+  std::vector<Read> reads;
+
+  for (size_t i = 0; i < keys.size(); ++i) {
+    Tensor* val = vals[i];
+    CHECK(val != nullptr);
+    BundleEntryProto entry;
+    TF_RETURN_IF_ERROR(GetBundleEntryProto(keys[i], &entry));
+    if (!entry.slices().empty()) {
+      TF_RETURN_IF_ERROR(GetSliceValue(
+          keys[i], entry,
+          /* a full slice */ TensorSlice(TensorShape(entry.shape()).dims()),
+          val));
+      continue;
+    }
+    if (options_.use_mmap || need_to_swap_bytes_ ||
+        !DataTypeCanUseMemcpy(entry.dtype()) ||
+        entry.dtype() != val->dtype() || entry.size() == 0 ||
+        entry.size() != val->TotalBytes()) {
+      // Also reports any mismatch of the entry and "val".
+      TF_RETURN_IF_ERROR(GetValue(entry, val));
+      continue;
+    }
+
+    io::InputBuffer* buffered_file;
+    TF_RETURN_IF_ERROR(GetDataFile(entry.shard_id(), &buffered_file));
+    Target& target = targets[num_targets++];
+    target.key = keys[i];
+    target.file = buffered_file->file();
+    target.data = static_cast<char*>(val->data());
+    for (int64_t begin = 0; begin < entry.size();
+         begin += kMaxLookupManyReadBytes) {
+      reads.push_back({&target, begin,
+                       std::min<int64_t>(begin + kMaxLookupManyReadBytes,
+                                         entry.size())});
+      target.num_pending_reads.fetch_add(1, std::memory_order_relaxed);
+    }
+    target.entry.Swap(&entry);
+  }
+  if (reads.empty()) return OkStatus();
+
+  // Reading the files front to back lets the file systems read ahead.
+  std::sort(reads.begin(), reads.end(), [](const Read& a, const Read& b) {
+    const BundleEntryProto& entry_a = a.target->entry;
+    const BundleEntryProto& entry_b = b.target->entry;
+    return std::make_tuple(entry_a.shard_id(), entry_a.offset() + a.begin) <
+           std::make_tuple(entry_b.shard_id(), entry_b.offset() + b.begin);
+  });
+
+  mutex mu;
+  Status status;
+  std::atomic<bool> failed{false};
+  std::atomic<size_t> next_read{0};
+  auto read_fn = [&]() {
+    for (size_t r = next_read.fetch_add(1); r < reads.size() && !failed;
+         r = next_read.fetch_add(1)) {
+      const Read& read = reads[r];
+      Target& target = *read.target;
+      const BundleEntryProto& entry = target.entry;
+      const size_t length = read.end - read.begin;
+      char* buffer = target.data + read.begin;
+      StringPiece result;
+      Status s = target.file->Read(entry.offset() + read.begin, length,
+                                   &result, buffer);
+      if (s.ok() && result.size() != length) {
+        s = errors::DataLoss("TensorBundle at ", prefix_, " shard ",
+                             entry.shard_id(), ": requested ", length,
+                             " bytes of ", target.key, " but read ",
+                             result.size());
+      } else if (errors::IsOutOfRange(s)) {
+        s = errors::DataLoss("TensorBundle at ", prefix_, " shard ",
+                             entry.shard_id(), ": ", s.error_message());
+      }
+      if (s.ok() && result.data() != buffer) {
+        memmove(buffer, result.data(), length);
+      }
+      if (s.ok() && target.num_pending_reads.fetch_sub(1) == 1) {
+        const uint32 actual_crc32c = crc32c::Value(target.data, entry.size());
+        if (crc32c::Unmask(entry.crc32c()) != actual_crc32c) {
+          s = errors::DataLoss(
+              "TensorBundle at ", prefix_, " shard ", entry.shard_id(), " (",
+              entry.size(), " bytes): Checksum does not match: stored ",
+              strings::Printf("%08u", crc32c::Unmask(entry.crc32c())),
+              " vs. calculated on the restored bytes ", actual_crc32c);
+        }
+      }
+      if (!s.ok()) {
+        mutex_lock l(mu);
+        status.Update(s);
+        failed = true;
+      }
+    }
+  };
+
+  const int num_threads =
+      pool == nullptr ? 1
+                      : static_cast<int>(std::min<size_t>(pool->NumThreads(),
+                                                          reads.size()));
+  BlockingCounter counter(num_threads - 1);
+  for (int i = 1; i < num_threads; ++i) {
+    pool->Schedule([&read_fn, &counter]() {
+      read_fn();
+      counter.DecrementCount();
+    });
+  }
+  read_fn();
+  counter.Wait();
+  return status;
+}
+
 Status BundleReader::ReadCurrent(Tensor* val) {
   CHECK(val != nullptr);
   BundleEntryProto entry;
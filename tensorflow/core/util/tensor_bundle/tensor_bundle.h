@@ -61,6 +61,7 @@ limitations under the License.
 #ifndef TENSORFLOW_CORE_UTIL_TENSOR_BUNDLE_TENSOR_BUNDLE_H_
 #define TENSORFLOW_CORE_UTIL_TENSOR_BUNDLE_TENSOR_BUNDLE_H_
 
+#include <limits>
 #include <map>
 #include <string>
 #include <unordered_map>
@@ -80,6 +81,7 @@ limitations under the License.
 #include "tensorflow/core/platform/env.h"
 #include "tensorflow/core/platform/file_system.h"
 #include "tensorflow/core/platform/macros.h"
+#include "tensorflow/core/platform/threadpool.h"
 #include "tensorflow/core/platform/types.h"
 #include "tensorflow/core/protobuf/tensor_bundle.pb.h"
 #include "tensorflow/core/util/tensor_bundle/naming.h"
@@ -186,7 +188,31 @@ Status MergeBundles(Env* env, gtl::ArraySlice<tstring> prefixes,
 // All threads accessing the same BundleReader must synchronize.
 class BundleReader {
  public:
-  BundleReader(Env* const env, StringPiece prefix);
+  struct Options {
+    Options() {}
+    // If true, data files are memory-mapped (when the underlying filesystem
+    // supports it) and tensors of memcpy-able dtypes are returned backed
+    // directly by the mapped pages instead of being copied into a new
+    // allocation.  Only entries whose data is aligned to
+    // EIGEN_MAX_ALIGN_BYTES can be mapped; see BundleWriter::Options.  All
+    // other entries silently fall back to buffered reads.
+    //
+    // A mapped tensor replaces the buffer of the output tensor passed to
+    // Lookup() and ReadCurrent(), is read-only, and keeps the mapping alive
+    // for as long as it is referenced, including past the lifetime of the
+    // reader.
+    bool use_mmap{false};
+
+    // Mapped entries of at least this many bytes are not checksummed when
+    // they are looked up, so that their pages are only read from the data
+    // file on first access and the OS can drop them again under memory
+    // pressure.  Corruption of such entries goes undetected.  Only takes
+    // effect with "use_mmap".
+    int64_t lazy_mmap_min_bytes{std::numeric_limits<int64_t>::max()};
+  };
+
+  BundleReader(Env* const env, StringPiece prefix,
+               const Options& options = Options());
   ~BundleReader();
 
   // Is ok() iff the reader construction is successful (completed the read of
@@ -235,6 +261,22 @@ class BundleReader {
   // REQUIRES: status().ok()
   Status Lookup(StringPiece key, Tensor* val) TF_MUST_USE_RESULT;
 
+  // Looks up the tensors keyed by "keys" into "vals", with the same contract
+  // as calling Lookup() on every (key, val) pair.
+  //
+  // Unpartitioned tensors of memcpy-able dtypes are read straight into the
+  // buffers of "vals" with positional reads of the data files.  The reads
+  // are ordered by shard and offset, larger tensors are split over several
+  // reads, and the reads and checksums run on "pool", with at most one read
+  // in flight per thread.  The other tensors, and all of them when the
+  // bundle needs byte swapping or "options.use_mmap" is set, are looked up
+  // one at a time on the calling thread.  "pool" may be null, in which case
+  // all reads are issued from the calling thread.
+  // REQUIRES: status().ok() && keys.size() == vals.size()
+  Status LookupMany(gtl::ArraySlice<StringPiece> keys,
+                    gtl::ArraySlice<Tensor*> vals,
+                    thread::ThreadPool* pool) TF_MUST_USE_RESULT;
+
   // Looks up the tensor pointed to by the internal iterator.
   //
   // On error, "val" may contain nonsense data.
@@ -286,11 +328,22 @@ class BundleReader {
   Status GetBundleEntryProto(StringPiece key,
                              BundleEntryProto* entry) TF_MUST_USE_RESULT;
 
+  // Returns the buffered data file of shard "shard_id", opening it if needed.
+  Status GetDataFile(int32 shard_id,
+                     io::InputBuffer** buffered_file) TF_MUST_USE_RESULT;
+
   // Reads the tensor value described by the metadata proto "entry".
   // Usage for "val" follows the comment of "Lookup()".
   Status GetValue(const BundleEntryProto& entry,
                   Tensor* val) TF_MUST_USE_RESULT;
 
+  // Points "val" at the memory-mapped data described by "entry".  Sets
+  // "*mapped" to false, leaving "val" untouched, if the data file cannot be
+  // mapped or the entry is not suitably aligned.
+  // REQUIRES: options_.use_mmap && DataTypeCanUseMemcpy(entry.dtype())
+  Status GetMappedValue(const BundleEntryProto& entry, Tensor* val,
+                        bool* mapped) TF_MUST_USE_RESULT;
+
   // Reads the slice described by "slice_spec".  The corresponding full tensor
   // has key "ful_tensor_key" and metadata proto "full_tensor_entry".
   // REQUIRES: full_tensor_entry.slices_size() > 0
@@ -301,6 +354,7 @@ class BundleReader {
 
   Env* env_;  // Not owned.
   const string prefix_;
+  const Options options_;
 
   Status status_;
   RandomAccessFile* metadata_;  // Owned.
@@ -309,6 +363,11 @@ class BundleReader {
   table::Iterator* iter_;
   // Owned the InputBuffer objects and their underlying RandomAccessFile's.
   std::unordered_map<int32, io::InputBuffer*> data_;
+  // Memory-mapped data files, keyed by shard id; populated on-demand when
+  // "options_.use_mmap" is set.  A null value records that the shard could not
+  // be mapped so that we do not retry on every lookup.
+  class MappedDataFile;
+  std::unordered_map<int32, MappedDataFile*> mapped_data_;
 
   // Maps each partitioned tensor's key to its stored slices (represented in a
   // TensorSliceSet).  Populated on-demand.
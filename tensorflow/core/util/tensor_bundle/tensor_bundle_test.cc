@@ -1153,6 +1153,154 @@ TEST_F(TensorBundleAlignmentTest, AlignmentTest) {
   }
 }
 
+TEST(TensorBundleTest, MmapReads) {
+  {
+    BundleWriter::Options opts;
+    opts.data_alignment = EIGEN_MAX_ALIGN_BYTES;
+    BundleWriter writer(Env::Default(), Prefix("mmap"), opts);
+    TF_EXPECT_OK(writer.Add("foo_000", Constant_2x3<float>(0)));
+    TF_EXPECT_OK(writer.Add("foo_001", Constant_2x3<int64_t>(1)));
+    TF_EXPECT_OK(writer.Add("foo_002", Constant_2x3<tstring>("two")));
+    TF_ASSERT_OK(writer.Finish());
+  }
+  Tensor mapped;
+  {
+    BundleReader::Options opts;
+    opts.use_mmap = true;
+    BundleReader reader(Env::Default(), Prefix("mmap"), opts);
+    TF_ASSERT_OK(reader.status());
+    Expect<float>(&reader, "foo_000", Constant_2x3<float>(0));
+    Expect<int64_t>(&reader, "foo_001", Constant_2x3<int64_t>(1));
+    Expect<tstring>(&reader, "foo_002", Constant_2x3<tstring>("two"));
+
+    // Memcpy-able tensors are backed by the read-only mapping, which must
+    // never be forwarded for in-place updates.
+    TF_ASSERT_OK(reader.Lookup("foo_000", &mapped));
+    EXPECT_FALSE(mapped.RefCountIsOne());
+    Tensor str;
+    TF_ASSERT_OK(reader.Lookup("foo_002", &str));
+    EXPECT_TRUE(str.RefCountIsOne());
+  }
+  // The mapping outlives the reader.
+  test::ExpectTensorEqual<float>(mapped, Constant_2x3<float>(0));
+}
+
+TEST(TensorBundleTest, MmapFallsBackForUnalignedData) {
+  {
+    BundleWriter writer(Env::Default(), Prefix("mmap_unaligned"));
+    TF_EXPECT_OK(writer.Add("foo_000", Constant(true, TensorShape({1}))));
+    TF_EXPECT_OK(writer.Add("foo_001", Constant_2x3<float>(1)));
+    TF_ASSERT_OK(writer.Finish());
+  }
+  BundleReader::Options opts;
+  opts.use_mmap = true;
+  BundleReader reader(Env::Default(), Prefix("mmap_unaligned"), opts);
+  TF_ASSERT_OK(reader.status());
+  // "foo_001" starts one byte into the data file, so it cannot be mapped.
+  Tensor val;
+  TF_ASSERT_OK(reader.Lookup("foo_001", &val));
+  EXPECT_TRUE(val.RefCountIsOne());
+  test::ExpectTensorEqual<float>(val, Constant_2x3<float>(1));
+}
+
+TEST(TensorBundleTest, LazyMmapSkipsChecksum) {
+  {
+    BundleWriter::Options opts;
+    opts.data_alignment = EIGEN_MAX_ALIGN_BYTES;
+    BundleWriter writer(Env::Default(), Prefix("lazy_mmap"), opts);
+    TF_EXPECT_OK(writer.Add("foo", Constant_2x3<float>(1)));
+    TF_ASSERT_OK(writer.Finish());
+  }
+  // Corrupts the first byte of "foo".
+  const string datafile = DataFilename(Prefix("lazy_mmap"), 0, 1);
+  string data;
+  TF_ASSERT_OK(ReadFileToString(Env::Default(), datafile, &data));
+  data[0] = ~data[0];
+  TF_ASSERT_OK(WriteStringToFile(Env::Default(), datafile, data));
+
+  BundleReader::Options opts;
+  opts.use_mmap = true;
+  opts.lazy_mmap_min_bytes = 6 * sizeof(float) + 1;
+  {
+    BundleReader reader(Env::Default(), Prefix("lazy_mmap"), opts);
+    TF_ASSERT_OK(reader.status());
+    Tensor val;
+    EXPECT_TRUE(errors::IsDataLoss(reader.Lookup("foo", &val)));
+  }
+  opts.lazy_mmap_min_bytes = 6 * sizeof(float);
+  {
+    BundleReader reader(Env::Default(), Prefix("lazy_mmap"), opts);
+    TF_ASSERT_OK(reader.status());
+    Tensor val;
+    TF_ASSERT_OK(reader.Lookup("foo", &val));
+    EXPECT_FALSE(val.RefCountIsOne());
+    EXPECT_EQ(data.substr(0, 6 * sizeof(float)), val.tensor_data());
+  }
+}
+
+TEST(TensorBundleTest, LookupMany) {
+  // Large enough to be split over two reads.
+  Tensor large(DT_FLOAT, TensorShape({3 << 20}));
+  auto large_flat = large.flat<float>();
+  for (int64_t i = 0; i < large.NumElements(); ++i) large_flat(i) = i;
+  {
+    BundleWriter writer(Env::Default(), Prefix("lookup_many"));
+    TF_EXPECT_OK(writer.Add("foo_000", Constant_2x3<int64_t>(0)));
+    TF_EXPECT_OK(writer.Add("foo_001", large));
+    TF_EXPECT_OK(writer.Add("foo_002", Constant_2x3<tstring>("two")));
+    TF_EXPECT_OK(writer.Add("foo_003", Constant_2x3<double>(3)));
+    TF_ASSERT_OK(writer.Finish());
+  }
+  thread::ThreadPool pool(Env::Default(), "lookup_many", 4);
+  thread::ThreadPool* no_pool = nullptr;
+  for (thread::ThreadPool* p : {&pool, no_pool}) {
+    BundleReader reader(Env::Default(), Prefix("lookup_many"));
+    TF_ASSERT_OK(reader.status());
+    Tensor vals[] = {Tensor(DT_DOUBLE, TensorShape({2, 3})),
+                     Tensor(DT_INT64, TensorShape({2, 3})),
+                     Tensor(DT_FLOAT, large.shape()),
+                     Tensor(DT_STRING, TensorShape({2, 3}))};
+    TF_ASSERT_OK(reader.LookupMany({"foo_003", "foo_000", "foo_001", "foo_002"},
+                                   {&vals[0], &vals[1], &vals[2], &vals[3]},
+                                   p));
+    test::ExpectTensorEqual<double>(vals[0], Constant_2x3<double>(3));
+    test::ExpectTensorEqual<int64_t>(vals[1], Constant_2x3<int64_t>(0));
+    test::ExpectTensorEqual<float>(vals[2], large);
+    test::ExpectTensorEqual<tstring>(vals[3], Constant_2x3<tstring>("two"));
+  }
+
+  BundleReader reader(Env::Default(), Prefix("lookup_many"));
+  TF_ASSERT_OK(reader.status());
+  Tensor val(DT_FLOAT, TensorShape({2}));
+  EXPECT_TRUE(
+      errors::IsDataLoss(reader.LookupMany({"foo_001"}, {&val}, &pool)));
+  EXPECT_TRUE(
+      errors::IsNotFound(reader.LookupMany({"nonexist"}, {&val}, &pool)));
+}
+
+TEST(TensorBundleTest, LookupManyChecksum) {
+  Tensor large = Constant(1.f, TensorShape({3 << 20}));
+  {
+    BundleWriter writer(Env::Default(), Prefix("lookup_many_checksum"));
+    TF_EXPECT_OK(writer.Add("foo", large));
+    TF_ASSERT_OK(writer.Finish());
+  }
+  // Corrupts a byte of the second read.
+  const string datafile = DataFilename(Prefix("lookup_many_checksum"), 0, 1);
+  string data;
+  TF_ASSERT_OK(ReadFileToString(Env::Default(), datafile, &data));
+  data[data.size() - 1] = ~data[data.size() - 1];
+  TF_ASSERT_OK(WriteStringToFile(Env::Default(), datafile, data));
+
+  thread::ThreadPool pool(Env::Default(), "lookup_many", 4);
+  BundleReader reader(Env::Default(), Prefix("lookup_many_checksum"));
+  TF_ASSERT_OK(reader.status());
+  Tensor val(DT_FLOAT, large.shape());
+  Status status = reader.LookupMany({"foo"}, {&val}, &pool);
+  EXPECT_TRUE(errors::IsDataLoss(status));
+  EXPECT_TRUE(absl::StrContains(status.ToString(), "Checksum does not match"));
+}
+
 static void BM_BundleAlignment(::testing::benchmark::State& state) {
   {
     const int alignment = state.range(0);
@@ -97,5 +97,18 @@ int ReduceInBfloat16MaxGroupSize() {
   return 8;
 }
 
+int64_t RelayoutAllGatherChunkSizeBytes() {
+  char* dtensor_relayout_all_gather_chunk_size_bytes_str =
+      std::getenv("DTENSOR_RELAYOUT_ALL_GATHER_CHUNK_SIZE_BYTES");
+  if (dtensor_relayout_all_gather_chunk_size_bytes_str == nullptr) return 0;
+  int64_t dtensor_relayout_all_gather_chunk_size_bytes;
+  if (absl::SimpleAtoi(dtensor_relayout_all_gather_chunk_size_bytes_str,
+                       &dtensor_relayout_all_gather_chunk_size_bytes))
+    return dtensor_relayout_all_gather_chunk_size_bytes;
+  LOG(WARNING) << "Invalid DTENSOR_RELAYOUT_ALL_GATHER_CHUNK_SIZE_BYTES, using "
+                  "the default value 0.";
+  return 0;
+}
+
 }  // namespace dtensor
 }  // namespace tensorflow
@@ -16,6 +16,8 @@ limitations under the License.
 #ifndef TENSORFLOW_DTENSOR_CC_DTENSOR_UTILS_H_
 #define TENSORFLOW_DTENSOR_CC_DTENSOR_UTILS_H_
 
+#include <cstdint>
+
 namespace tensorflow {
 namespace dtensor {
 
@@ -51,6 +53,11 @@ bool DoNotFuseReduceScatter();
 // reduce op.
 int ReduceInBfloat16MaxGroupSize();
 
+// Returns the size in bytes above which the AllGather of a relayout is split
+// into several smaller AllGathers, so that the collectives can be pipelined
+// with other computation. 0 disables the splitting.
+int64_t RelayoutAllGatherChunkSizeBytes();
+
 }  // namespace dtensor
 }  // namespace tensorflow
 
@@ -15,6 +15,9 @@ limitations under the License.
 
 #include "tensorflow/dtensor/cc/save_restore_util.h"
 
+#include <algorithm>
+#include <numeric>
+
 namespace tensorflow {
 namespace dtensor {
 
@@ -24,6 +27,25 @@ namespace {
 // save_v2.tensor_names[2] should have "spec_a" and "spec_b" saved.
 using SliceSpecByName = absl::flat_hash_map<int64_t, std::vector<std::string>>;
 
+// Number of elements saved by each device so far, used to spread the saving of
+// replicated slices across devices.
+using SavedElementsByDevice = absl::flat_hash_map<int64_t, int64_t>;
+
+// Returns the device among `candidates` (ordered by device_id) that has saved
+// the fewest elements so far, and accounts `num_elements` to it. Ties go to the
+// smallest device_id.
+int64_t PickSavingDevice(absl::Span<const int64_t> candidates,
+                         int64_t num_elements,
+                         SavedElementsByDevice& saved_elements) {
+  int64_t saving_device = candidates[0];
+  for (int64_t device_id : candidates) {
+    if (saved_elements[device_id] < saved_elements[saving_device])
+      saving_device = device_id;
+  }
+  saved_elements[saving_device] += num_elements;
+  return saving_device;
+}
+
 // Builds a map from tensor slice spec to saving device_id for the given Tensor
 // and layout. The output would record the saving device and the slices it needs
 // to save.
@@ -32,23 +54,27 @@ using SliceSpecByName = absl::flat_hash_map<int64_t, std::vector<std::string>>;
 // it isn't necessary a unique copy. For a 2 way sharded Tensor in a (2,4) mesh
 // on the first dimension, device [0-3] and device [4-7] will hold the same
 // slice data. To avoid saving duplicated copies of the Tensor slice, the map
-// would only contain the min(device_id) that occupies the slice and save from
-// there.
+// would only contain one of the devices that occupies the slice and save from
+// there. The device is picked by PickSavingDevice, so that the saving of other
+// tensors with the same layout goes to other copies, possibly on other hosts,
+// rather than all going to the devices with the smallest device_id.
 //
 // Furthermore, to save a Tensor that isn't on CPU mesh, send/recv is necessary
 // from saving device to its corresponding host(CPU) devices. Since we don't
 // have multi-mesh execution yet, this isn't implemented yet.
 StatusOr<SliceSpecByName> BuildSliceSpecDeviceMap(
-    absl::Span<const int64_t> global_shape, Layout layout) {
+    absl::Span<const int64_t> global_shape, Layout layout,
+    SavedElementsByDevice& saved_elements) {
   if (!layout.mesh().is_cpu_mesh())
     return errors::Unimplemented(
         "Saving tensors on non CPU mesh needs explicit send/receive and isn't "
         "implemented yet");
 
-  // Result map that records the minimum device_id that occupies the unique
-  // copy.
+  // Records all the devices that occupy a copy of each unique slice, and the
+  // order in which the unique slices are found.
   // Note that llvm::SmallDenseMap won't accept std::string as a key.
-  absl::flat_hash_map<std::string, int64_t> min_device_for_slice_spec;
+  absl::flat_hash_map<std::string, std::vector<int64_t>> devices_for_slice_spec;
+  std::vector<std::string> slice_spec_order;
   // Records the map of device_ids and a list of slice_spec that it needs to
   // save.
   SliceSpecByName device_slices;
@@ -69,19 +95,22 @@ StatusOr<SliceSpecByName> BuildSliceSpecDeviceMap(
     // Concat shape spec and slice spec to form a complete shape_and_slice.
     std::string shape_and_slice = absl::StrCat(shape_spec, " ", slice_spec);
 
-    // Only record the min device_id for the unique slice_spec on a given
-    // Tensor.
-    if (min_device_for_slice_spec.find(shape_and_slice) ==
-            min_device_for_slice_spec.end() ||
-        device_id < min_device_for_slice_spec[shape_and_slice]) {
-      min_device_for_slice_spec[shape_and_slice] = device_id;
-    }
+    std::vector<int64_t>& devices = devices_for_slice_spec[shape_and_slice];
+    if (devices.empty()) slice_spec_order.push_back(shape_and_slice);
+    devices.push_back(device_id);
   }
 
   // Constructs device_id keyed map for future save operation conditioned on
-  // device_ids.
-  for (const auto& spec_and_id : min_device_for_slice_spec) {
-    device_slices[spec_and_id.second].push_back(spec_and_id.first);
+  // device_ids. The slices are visited in a fixed order so that every client
+  // picks the same saving devices.
+  int64_t num_elements = 1;
+  for (int64_t dim_size : global_shape) num_elements *= dim_size;
+  num_elements /= std::max<int64_t>(slice_spec_order.size(), 1);
+  for (const std::string& shape_and_slice : slice_spec_order) {
+    int64_t saving_device =
+        PickSavingDevice(devices_for_slice_spec[shape_and_slice], num_elements,
+                         saved_elements);
+    device_slices[saving_device].push_back(shape_and_slice);
   }
 
   return device_slices;
@@ -95,6 +124,7 @@ BuildSavingSpec(absl::Span<const SavingTensorMetadata> tensor_metadatas) {
   absl::flat_hash_map<int64_t,
                       absl::flat_hash_map<int64_t, std::vector<std::string>>>
       saving_specs;
+  SavedElementsByDevice saved_elements;
   for (const SavingTensorMetadata& tensor_metadata : tensor_metadatas) {
     // We use index to select the tensor names and shape_and_slices from the
     // inputs. This is generic regardless whether the inputs are constants or
@@ -104,13 +134,24 @@ BuildSavingSpec(absl::Span<const SavingTensorMetadata> tensor_metadatas) {
     absl::Span<const int64_t> tensor_shape = tensor_metadata.shape;
 
     if (layout.IsFullyReplicated()) {
-      // Push a fully replicated save on device 0, where slice_spec is simply
-      // empty string.
-      saving_specs[0][index].push_back("");
+      // Push a fully replicated save, where slice_spec is simply empty string.
+      // On CPU meshes any device can save it, so spread the replicated
+      // tensors across the devices. Otherwise save on device 0.
+      int64_t saving_device_id = 0;
+      if (layout.mesh().is_cpu_mesh()) {
+        std::vector<int64_t> devices(layout.mesh().size());
+        std::iota(devices.begin(), devices.end(), 0);
+        int64_t num_elements = 1;
+        for (int64_t dim_size : tensor_shape) num_elements *= dim_size;
+        saving_device_id =
+            PickSavingDevice(devices, num_elements, saved_elements);
+      }
+      saving_specs[saving_device_id][index].push_back("");
     } else {
       // Calculate shape_and_slices for sharded case here.
-      TF_ASSIGN_OR_RETURN(const auto& slice_specs,
-                          BuildSliceSpecDeviceMap(tensor_shape, layout));
+      TF_ASSIGN_OR_RETURN(
+          const auto& slice_specs,
+          BuildSliceSpecDeviceMap(tensor_shape, layout, saved_elements));
       // Push specs for each device into the global map.
       for (const auto& slice_spec : slice_specs) {
         int64_t saving_device_id = slice_spec.first;
@@ -83,7 +83,10 @@ struct SaveOpSpecs {
 // <tensor_index -> (tensor_global_shape, tensor_layout)>.
 //
 // (tensor_global_shape, tensor_layout & tensor_layout.mesh) defines which
-// device saves what slices of the Tensor.
+// device saves what slices of the Tensor. A slice (or replicated Tensor) held
+// by several devices is saved by the one that saved the fewest elements so far,
+// so that the saving of replicated data is spread across devices and hosts
+// instead of always going to the smallest device_id.
 //
 // For a complete definition of shape_and_slices field, please see:
 // third_party/tensorflow/core/framework/tensor_slice.h
@@ -15,8 +15,10 @@ limitations under the License.
 
 #include "tensorflow/dtensor/mlir/collectives.h"
 
+#include <algorithm>
 #include <cstdint>
 #include <string>
+#include <vector>
 
 #include "absl/container/flat_hash_set.h"
 #include "absl/strings/string_view.h"
@@ -28,6 +30,7 @@ limitations under the License.
 #include "tensorflow/compiler/mlir/tensorflow/transforms/collection_ops_util.h"
 #include "tensorflow/core/platform/errors.h"
 #include "tensorflow/dtensor/cc/dstatus.h"
+#include "tensorflow/dtensor/cc/dtensor_utils.h"
 #include "tensorflow/dtensor/cc/tensor_layout.h"
 #include "tensorflow/dtensor/mlir/collectives_common.h"
 #include "tensorflow/dtensor/mlir/dtensor_location.h"
@@ -45,6 +48,100 @@ namespace {
 
 namespace ops_util = ::mlir::TF::collection_ops_util;
 
+// Maximum number of chunks the AllGather of a relayout is split into.
+constexpr int kMaxRelayoutAllGatherChunks = 8;
+
+// Returns the number of chunks the AllGather from `src_layout` to `tgt_layout`
+// of a local tensor of `input_type` is split into, and sets `chunk_dim` to the
+// dimension to split along. A chunk is gathered independently of the others,
+// so the following computation only waits on the chunks it reads and the
+// collectives of different chunks can overlap with other computation. Returns
+// 1 if the AllGather should not be split.
+int NumRelayoutAllGatherChunks(const Layout& src_layout,
+                               const Layout& tgt_layout,
+                               mlir::RankedTensorType input_type,
+                               int* chunk_dim) {
+  const int64_t chunk_size_bytes = RelayoutAllGatherChunkSizeBytes();
+  if (chunk_size_bytes <= 0 || !input_type.hasStaticShape() ||
+      !input_type.getElementType().isIntOrFloat())
+    return 1;
+
+  // The gathered tensor is as large as the local tensor times the number of
+  // shards of the gathered dimensions. Only dimensions with the same sharding
+  // in both layouts are split, so every chunk is a valid AllGather with the
+  // same layouts.
+  int64_t gathered_size = input_type.getNumElements() *
+                          input_type.getElementTypeBitWidth() / 8;
+  *chunk_dim = -1;
+  for (int i = 0; i < src_layout.rank(); ++i) {
+    if (src_layout.sharding_spec(i) != tgt_layout.sharding_spec(i)) {
+      gathered_size *= src_layout.num_shards_for_dim(src_layout.dim(i));
+    } else if (*chunk_dim == -1 || input_type.getDimSize(i) >
+                                       input_type.getDimSize(*chunk_dim)) {
+      *chunk_dim = i;
+    }
+  }
+  if (*chunk_dim == -1 || gathered_size <= chunk_size_bytes) return 1;
+
+  int num_chunks = std::min<int64_t>(
+      kMaxRelayoutAllGatherChunks,
+      (gathered_size + chunk_size_bytes - 1) / chunk_size_bytes);
+  while (num_chunks > 1 && input_type.getDimSize(*chunk_dim) % num_chunks != 0)
+    --num_chunks;
+  return num_chunks;
+}
+
+// Emits the AllGather of a relayout, split into chunks along one dimension if
+// the gathered tensor is large. See NumRelayoutAllGatherChunks.
+StatusOr<mlir::Value> EmitRelayoutAllGather(
+    mlir::OpBuilder& builder, mlir::Value input, const Layout& src_layout,
+    const Layout& tgt_layout,
+    llvm::SmallPtrSet<mlir::Operation*, 4>* newly_created_ops) {
+  const auto input_type = input.getType().dyn_cast<mlir::RankedTensorType>();
+  int chunk_dim;
+  const int num_chunks =
+      src_layout == tgt_layout || !input_type
+          ? 1
+          : NumRelayoutAllGatherChunks(src_layout, tgt_layout, input_type,
+                                       &chunk_dim);
+  if (num_chunks == 1)
+    return EmitAllGather(builder, input, src_layout, tgt_layout,
+                         newly_created_ops);
+
+  mlir::TF::SplitOp split;
+  TF_RETURN_IF_ERROR(CreateSplitOp(num_chunks, chunk_dim, input.getLoc(),
+                                   input, &builder, &split));
+  SetLayoutOnOp(split, builder,
+                std::vector<absl::optional<Layout>>(num_chunks, src_layout));
+  if (newly_created_ops != nullptr) {
+    newly_created_ops->insert(split.split_dim().getDefiningOp());
+    newly_created_ops->insert(split);
+  }
+
+  llvm::SmallVector<mlir::Value, 4> gathered_chunks;
+  for (mlir::Value chunk : split.output()) {
+    TF_ASSIGN_OR_RETURN(mlir::Value gathered_chunk,
+                        EmitAllGather(builder, chunk, src_layout, tgt_layout,
+                                      newly_created_ops));
+    gathered_chunks.push_back(gathered_chunk);
+  }
+
+  TF_ASSIGN_OR_RETURN(mlir::TensorType global_type,
+                      GlobalTypeFromLocalType(src_layout, input_type));
+  TF_ASSIGN_OR_RETURN(mlir::TensorType output_type,
+                      LocalTypeFromGlobalType(tgt_layout, global_type));
+  mlir::Value concat_axis =
+      CreateIntScalarConst(chunk_dim, builder, input.getLoc());
+  mlir::TF::ConcatV2Op concat = builder.create<mlir::TF::ConcatV2Op>(
+      input.getLoc(), output_type, gathered_chunks, concat_axis);
+  SetSingleLayoutOnOp(concat, tgt_layout);
+  if (newly_created_ops != nullptr) {
+    newly_created_ops->insert(concat_axis.getDefiningOp());
+    newly_created_ops->insert(concat);
+  }
+  return concat.output();
+}
+
 }  // namespace
 
 StatusOr<mlir::Value> EmitAllGather(
@@ -264,8 +361,8 @@ StatusOr<mlir::Value> EmitRelayout(
 
   TF_ASSIGN_OR_RETURN(
       mlir::Value concat_result,
-      EmitAllGather(builder, split_result, intermediate_layout_1,
-                    intermediate_layout_2, newly_created_ops));
+      EmitRelayoutAllGather(builder, split_result, intermediate_layout_1,
+                            intermediate_layout_2, newly_created_ops));
 
   auto all_scatter =
       EmitAllScatter(builder, concat_result, intermediate_layout_2, tgt_layout,
@@ -46,7 +46,9 @@ StatusOr<const mlir::Value> EmitAllScatter(
     llvm::SmallPtrSet<mlir::Operation*, 4>* newly_created_ops = nullptr);
 
 // Emits splits and calls EmitAllGather (once) to relayout from the src layout
-// to the tgt layout on a single mesh.
+// to the tgt layout on a single mesh. If the gathered tensor is larger than
+// DTENSOR_RELAYOUT_ALL_GATHER_CHUNK_SIZE_BYTES, the AllGather is split into
+// chunks along a dimension whose sharding doesn't change.
 // Shape of input is expected to be the local shape for src_layout.
 StatusOr<mlir::Value> EmitRelayout(
     mlir::Value input, const dtensor::Layout& src_layout,
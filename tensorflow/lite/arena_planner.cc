@@ -25,6 +25,8 @@ limitations under the License.
 
 #include "tensorflow/lite/c/common.h"
 #include "tensorflow/lite/graph_info.h"
+#include "tensorflow/lite/node_dependencies.h"
+#include "tensorflow/lite/offline_memory_planner.h"
 #include "tensorflow/lite/simple_memory_arena.h"
 
 namespace tflite {
@@ -155,6 +157,21 @@ TfLiteStatus ArenaPlanner::PlanAllocations() {
   for (size_t i = 0; i < graph_info_->num_execution_nodes(); ++i) {
     const TfLiteNode& node = graph_info_->node(i);
 
+    if (preserve_all_tensors_) {
+      // Also keeps the inputs that no node writes, which the interpreter may
+      // fill right before the node runs, e.g. the private tensors of a
+      // pipelined delegate kernel.
+      TfLiteIntArray* node_inputs = node.inputs;
+      for (int j = 0; j < node_inputs->size; ++j) {
+        int tensor_index = node_inputs->data[j];
+        if (tensor_index != kTfLiteOptionalTensor &&
+            graph_info_->tensor(tensor_index)->allocation_type ==
+                kTfLiteArenaRw) {
+          TF_LITE_ENSURE_STATUS(allocate(i, tensor_index));
+        }
+      }
+    }
+
     // First queue output tensors for allocation.
     TfLiteIntArray* node_outputs = node.outputs;
     for (int j = 0; j < node_outputs->size; ++j) {
@@ -178,6 +195,28 @@ TfLiteStatus ArenaPlanner::PlanAllocations() {
     }
   }
 
+  if (plan_for_concurrent_nodes_) {
+    // Keeps the tensors until the nodes that may run at the same time as their
+    // last use are done too.
+    last_concurrent_nodes_ =
+        NodeDependencies(graph_info_.get()).LastConcurrentNodes();
+    for (size_t i = 0; i < graph_info_->num_execution_nodes(); ++i) {
+      const TfLiteNode& node = graph_info_->node(i);
+      for (const TfLiteIntArray* tensors : {node.inputs, node.outputs}) {
+        for (int j = 0; j < tensors->size; ++j) {
+          const int tensor_index = tensors->data[j];
+          if (tensor_index != kTfLiteOptionalTensor &&
+              dealloc_node_[tensor_index] != kNodeNotAssigned) {
+            dealloc_node_[tensor_index] = std::max(dealloc_node_[tensor_index],
+                                                   last_concurrent_nodes_[i]);
+          }
+        }
+      }
+    }
+  } else {
+    last_concurrent_nodes_.clear();
+  }
+
   // Note that graph outputs will never be scheduled for deallocation. We
   // could do that here for completeness, but it won't have any effect.
   return kTfLiteOk;
@@ -200,7 +239,9 @@ TfLiteStatus ArenaPlanner::ExecuteAllocations(int first_node, int last_node) {
       int tensor_index = node_temporaries->data[j];
       alloc_node_[tensor_index] = i;
       if (!preserve_all_tensors_) {
-        dealloc_node_[tensor_index] = i;
+        dealloc_node_[tensor_index] =
+            i < last_concurrent_nodes_.size() ? last_concurrent_nodes_[i]
+                                              : static_cast<int32_t>(i);
       }
     }
   }
@@ -257,6 +298,18 @@ TfLiteStatus ArenaPlanner::Commit() {
   return kTfLiteOk;
 }
 
+size_t ArenaPlanner::GetPeakLiveArenaBytes() {
+  std::vector<OfflinePlannedBuffer> buffers;
+  for (int i = 0; i < static_cast<int>(allocs_.size()); ++i) {
+    if (graph_info_->tensor(i)->allocation_type == kTfLiteArenaRw &&
+        allocs_[i].size != 0) {
+      buffers.push_back(
+          {allocs_[i].size, allocs_[i].first_node, allocs_[i].last_node});
+    }
+  }
+  return PeakLiveBytes(buffers);
+}
+
 std::vector<int32_t> ArenaPlanner::CreateTensorAllocationVector(int first_node,
                                                                 int last_node) {
   auto tensor_compare = [this](int idx1, int idx2) {
@@ -298,11 +351,150 @@ std::vector<int32_t> ArenaPlanner::CreateTensorAllocationVector(int first_node,
   return tensor_order;
 }
 
+std::vector<int32_t> ArenaPlanner::SortByBreadth(
+    int first_node, int last_node, const std::vector<int32_t>& tensors) {
+  last_node = std::min(
+      last_node, static_cast<int>(graph_info_->num_execution_nodes()) - 1);
+  if (last_node < first_node) {
+    return tensors;
+  }
+  std::vector<size_t> breadth(last_node - first_node + 1, 0);
+  for (int32_t tensor_index : tensors) {
+    const int32_t last_use = std::min(dealloc_node_[tensor_index], last_node);
+    for (int32_t node = alloc_node_[tensor_index]; node <= last_use; ++node) {
+      breadth[node - first_node] += graph_info_->tensor(tensor_index)->bytes;
+    }
+  }
+  std::vector<int32_t> nodes(breadth.size());
+  for (int i = 0; i < static_cast<int>(nodes.size()); ++i) {
+    nodes[i] = first_node + i;
+  }
+  std::stable_sort(nodes.begin(), nodes.end(), [&](int32_t a, int32_t b) {
+    return breadth[a - first_node] > breadth[b - first_node];
+  });
+
+  // Takes the tensors used by each node, from the widest node on, in order of
+  // their size.
+  std::vector<int32_t> tensor_order;
+  tensor_order.reserve(tensors.size());
+  std::vector<bool> ordered(tensors.size(), false);
+  for (int32_t node : nodes) {
+    for (int i = 0; i < static_cast<int>(tensors.size()); ++i) {
+      if (!ordered[i] && alloc_node_[tensors[i]] <= node &&
+          dealloc_node_[tensors[i]] >= node) {
+        ordered[i] = true;
+        tensor_order.push_back(tensors[i]);
+      }
+    }
+  }
+  for (int i = 0; i < static_cast<int>(tensors.size()); ++i) {
+    if (!ordered[i]) {
+      tensor_order.push_back(tensors[i]);
+    }
+  }
+  return tensor_order;
+}
+
+bool ArenaPlanner::ChooseBestFitOrder(int first_node, int last_node,
+                                      std::vector<int32_t>* tensors) {
+  // Returns the size of the arena with `tensor_order` planned on top of the
+  // current plan.
+  auto arena_size = [this](const std::vector<int32_t>& tensor_order,
+                           bool best_fit) {
+    SimpleMemoryArena arena = arena_.CopyPlan();
+    ArenaAllocWithUsageInterval alloc;
+    for (int32_t tensor_index : tensor_order) {
+      const size_t bytes = graph_info_->tensor(tensor_index)->bytes;
+      const TfLiteStatus status =
+          best_fit ? arena.AllocateBestFit(context_, tensor_alignment_, bytes,
+                                           tensor_index,
+                                           alloc_node_[tensor_index],
+                                           dealloc_node_[tensor_index], &alloc)
+                   : arena.Allocate(context_, tensor_alignment_, bytes,
+                                    tensor_index, alloc_node_[tensor_index],
+                                    dealloc_node_[tensor_index], &alloc);
+      if (status != kTfLiteOk) {
+        return std::numeric_limits<size_t>::max();
+      }
+    }
+    return arena.GetHighWaterMark();
+  };
+
+  std::vector<int32_t> by_first_use = *tensors;
+  std::stable_sort(by_first_use.begin(), by_first_use.end(),
+                   [this](int32_t a, int32_t b) {
+                     return alloc_node_[a] < alloc_node_[b];
+                   });
+  const std::vector<int32_t>* best_order = nullptr;
+  size_t best_size = arena_size(*tensors, /*best_fit=*/false);
+  const std::vector<int32_t> by_breadth =
+      SortByBreadth(first_node, last_node, *tensors);
+  const std::vector<int32_t>* candidates[] = {&by_breadth, &by_first_use,
+                                              tensors};
+  for (const std::vector<int32_t>* tensor_order : candidates) {
+    const size_t size = arena_size(*tensor_order, /*best_fit=*/true);
+    if (size < best_size) {
+      best_size = size;
+      best_order = tensor_order;
+    }
+  }
+  if (best_order == nullptr) {
+    return false;
+  }
+  if (best_order != tensors) {
+    *tensors = *best_order;
+  }
+  return true;
+}
+
+void ArenaPlanner::SetPlanCacheSize(int num_plans) {
+  plan_cache_size_ = std::max(num_plans, 0);
+  while (plan_cache_.size() > static_cast<size_t>(plan_cache_size_)) {
+    plan_cache_.pop_back();
+  }
+  arena_.SetGrowGeometrically(plan_cache_size_ > 0);
+}
+
+std::vector<size_t> ArenaPlanner::CreatePlanCacheKey() {
+  std::vector<size_t> key;
+  for (int i = 0; i < static_cast<int>(graph_info_->num_tensors()); ++i) {
+    const TfLiteTensor& tensor = *graph_info_->tensor(i);
+    if (tensor.allocation_type == kTfLiteArenaRw &&
+        alloc_node_[i] != kNodeNotAssigned) {
+      key.insert(key.end(), {static_cast<size_t>(i), tensor.bytes,
+                             static_cast<size_t>(alloc_node_[i]),
+                             static_cast<size_t>(dealloc_node_[i])});
+    }
+  }
+  return key;
+}
+
 TfLiteStatus ArenaPlanner::CalculateAllocations(int first_node, int last_node) {
   // Indices of tensors in order their allocation offsets will be calculated.
   const std::vector<int32_t> tensor_order =
       CreateTensorAllocationVector(first_node, last_node);
 
+  // A plan of all the nodes replaces the whole arena plan, so it can come from
+  // the plan cache.
+  std::vector<size_t> plan_cache_key;
+  if (plan_cache_size_ > 0 && first_node == 0 &&
+      last_node >= static_cast<int>(graph_info_->num_execution_nodes()) - 1) {
+    plan_cache_key = CreatePlanCacheKey();
+    for (auto it = plan_cache_.begin(); it != plan_cache_.end(); ++it) {
+      if (it->key != plan_cache_key) continue;
+      plan_cache_.splice(plan_cache_.begin(), plan_cache_, it);
+      arena_.SetPlan(it->arena);
+      for (const auto& tensor_index : tensor_order) {
+        if (graph_info_->tensor(tensor_index)->allocation_type ==
+            kTfLiteArenaRw) {
+          allocs_[tensor_index] = it->allocs[tensor_index];
+        }
+      }
+      ++plan_cache_hits_;
+      return CalculatePersistentAllocations(tensor_order);
+    }
+  }
+
   // Deallocate if the tensor was already allocated.
   for (const auto& tensor_index : tensor_order) {
     TfLiteTensor& tensor = *graph_info_->tensor(tensor_index);
@@ -312,15 +504,64 @@ TfLiteStatus ArenaPlanner::CalculateAllocations(int first_node, int last_node) {
     }
   }
 
-  // Vector of ids of already allocated tensors, ordered by offset.
+  // Place the tensors with offline planned offsets first, so that the other
+  // tensors are planned around them.
+  std::vector<bool> placed_offline;
+  if (!offline_offsets_.empty()) {
+    placed_offline.resize(graph_info_->num_tensors(), false);
+    for (const auto& tensor_index : tensor_order) {
+      TfLiteTensor& tensor = *graph_info_->tensor(tensor_index);
+      if (tensor.allocation_type != kTfLiteArenaRw ||
+          tensor_index >= static_cast<int>(offline_offsets_.size()) ||
+          offline_offsets_[tensor_index] == kOnlinePlannedOffset) {
+        continue;
+      }
+      placed_offline[tensor_index] = arena_.TryAllocateAt(
+          tensor_alignment_, offline_offsets_[tensor_index], tensor.bytes,
+          tensor_index, alloc_node_[tensor_index], dealloc_node_[tensor_index],
+          &allocs_[tensor_index]);
+    }
+  }
+
+  std::vector<int32_t> arena_tensors;
   for (const auto& tensor_index : tensor_order) {
-    TfLiteTensor& tensor = *graph_info_->tensor(tensor_index);
-    if (tensor.allocation_type == kTfLiteArenaRw) {
+    if (graph_info_->tensor(tensor_index)->allocation_type == kTfLiteArenaRw &&
+        (placed_offline.empty() || !placed_offline[tensor_index])) {
+      arena_tensors.push_back(tensor_index);
+    }
+  }
+  const bool best_fit =
+      use_best_fit_planning_ &&
+      ChooseBestFitOrder(first_node, last_node, &arena_tensors);
+  for (const auto& tensor_index : arena_tensors) {
+    const TfLiteTensor& tensor = *graph_info_->tensor(tensor_index);
+    if (best_fit) {
+      TF_LITE_ENSURE_STATUS(arena_.AllocateBestFit(
+          context_, tensor_alignment_, tensor.bytes, tensor_index,
+          alloc_node_[tensor_index], dealloc_node_[tensor_index],
+          &allocs_[tensor_index]));
+    } else {
       TF_LITE_ENSURE_STATUS(
           arena_.Allocate(context_, tensor_alignment_, tensor.bytes,
                           tensor_index, alloc_node_[tensor_index],
                           dealloc_node_[tensor_index], &allocs_[tensor_index]));
     }
+  }
+
+  if (!plan_cache_key.empty()) {
+    if (plan_cache_.size() >= static_cast<size_t>(plan_cache_size_)) {
+      plan_cache_.pop_back();
+    }
+    plan_cache_.push_front(
+        CachedPlan{std::move(plan_cache_key), arena_.CopyPlan(), allocs_});
+  }
+  return CalculatePersistentAllocations(tensor_order);
+}
+
+TfLiteStatus ArenaPlanner::CalculatePersistentAllocations(
+    const std::vector<int32_t>& tensor_order) {
+  for (const auto& tensor_index : tensor_order) {
+    TfLiteTensor& tensor = *graph_info_->tensor(tensor_index);
     // Check allocs_[].size to prevent from reallocation of persistent tensors.
     if (tensor.allocation_type == kTfLiteArenaRwPersistent &&
         allocs_[tensor_index].size == 0) {
@@ -16,7 +16,9 @@ limitations under the License.
 #define TENSORFLOW_LITE_ARENA_PLANNER_H_
 
 #include <cstdint>
+#include <list>
 #include <memory>
+#include <utility>
 #include <vector>
 
 #include "tensorflow/lite/c/common.h"
@@ -67,6 +69,53 @@ class ArenaPlanner : public MemoryPlanner {
   // Returns the base arena location for a given allocation type.
   std::intptr_t BasePointer(TfLiteAllocationType type);
 
+  // Sets kTfLiteArenaRw offsets that were planned ahead of time, e.g. by the
+  // converter, indexed by tensor. Tensors with an offset other than
+  // kOnlinePlannedOffset are placed at it, before the other tensors, unless it
+  // is used by another tensor at the same time, e.g. because delegates or
+  // resized inputs changed the plan. Those tensors are then planned like the
+  // tensors without offsets.
+  void SetOfflinePlannedOffsets(std::vector<int32_t> offsets) {
+    offline_offsets_ = std::move(offsets);
+  }
+
+  // Also tries to plan the kTfLiteArenaRw tensors with
+  // SimpleMemoryArena::AllocateBestFit(), which puts each tensor in the
+  // smallest hole it fits in, in a few orders: by breadth, i.e. the largest
+  // tensors of the node that uses the most bytes first, then those of the
+  // next widest node and so on; by first use; and by size. The smallest of
+  // these plans and the default one is kept, at the cost of planning the
+  // tensors several times.
+  void SetUseBestFitPlanning(bool value) { use_best_fit_planning_ = value; }
+
+  // Plans the kTfLiteArenaRw tensors so that nodes can run at the same time as
+  // the nodes they don't depend on, see NodeDependencies. A tensor then only
+  // shares memory with the tensors of the nodes that depend on all the nodes
+  // that use it, so the arena may grow. Takes effect at the next
+  // PlanAllocations().
+  void SetPlanForConcurrentNodes(bool value) {
+    plan_for_concurrent_nodes_ = value;
+  }
+
+  // Keeps the kTfLiteArenaRw plans of the `num_plans` most recently planned
+  // sets of tensor sizes, e.g. one per input shape of a model whose inputs are
+  // resized often, and reuses them instead of planning the tensors again when
+  // all the nodes are planned at once. The arena then also grows
+  // geometrically, see SimpleMemoryArena::SetGrowGeometrically().
+  void SetPlanCacheSize(int num_plans);
+
+  // Returns the number of plans that were reused from the plan cache.
+  int GetPlanCacheHits() const { return plan_cache_hits_; }
+
+  // Returns the size of the kTfLiteArenaRw arena that the current plan needs,
+  // without the padding of the underlying buffer.
+  size_t GetArenaSize() const { return arena_.GetHighWaterMark(); }
+
+  // Returns the largest number of bytes of the kTfLiteArenaRw tensors that are
+  // used at the same time in the current plan, which is a lower bound of
+  // GetArenaSize().
+  size_t GetPeakLiveArenaBytes();
+
  private:
   // Make sure all the arenas have reserved enough memory to store all their
   // tensors.
@@ -82,14 +131,36 @@ class ArenaPlanner : public MemoryPlanner {
   std::vector<int32_t> CreateTensorAllocationVector(int first_node,
                                                     int last_node);
 
+  // Returns `tensors`, which are in the order of CreateTensorAllocationVector,
+  // in the order of the breadth of the nodes in [first_node, last_node] that
+  // use them. See SetUseBestFitPlanning().
+  std::vector<int32_t> SortByBreadth(int first_node, int last_node,
+                                     const std::vector<int32_t>& tensors);
+
+  // Returns whether placing the kTfLiteArenaRw tensors `tensors`, in the order
+  // of CreateTensorAllocationVector, with SimpleMemoryArena::AllocateBestFit()
+  // in one of the orders of SetUseBestFitPlanning() needs a smaller arena than
+  // the default plan, and reorders `tensors` in the best order if so.
+  bool ChooseBestFitOrder(int first_node, int last_node,
+                          std::vector<int32_t>* tensors);
+
   // Traverse the allocation queue and reserve space in the appropriate arena
   // for all tensors affected by ops in the interval [first_node, last_node].
   TfLiteStatus CalculateAllocations(int first_node, int last_node);
 
+  // Reserves space in the persistent arena for the kTfLiteArenaRwPersistent
+  // tensors of `tensor_order` that don't have it yet.
+  TfLiteStatus CalculatePersistentAllocations(
+      const std::vector<int32_t>& tensor_order);
+
   // Assign absolute memory location to a tensor, based on its relative
   // position inside the corresponding arena buffer.
   TfLiteStatus ResolveTensorAllocation(int tensor_index);
 
+  // Returns the sizes and usage intervals of the kTfLiteArenaRw tensors, which
+  // identify a plan of the plan cache.
+  std::vector<size_t> CreatePlanCacheKey();
+
   // Register an allocation for all internal (temporary) tensors of
   // 'node_index'.
   TfLiteStatus CalculateAllocationOfInternalTensors(int node_index);
@@ -127,6 +198,32 @@ class ArenaPlanner : public MemoryPlanner {
 
   // Number of bytes that tensor buffers should be aligned to.
   int tensor_alignment_;
+
+  // The offsets set by SetOfflinePlannedOffsets().
+  std::vector<int32_t> offline_offsets_;
+
+  // Set by SetUseBestFitPlanning().
+  bool use_best_fit_planning_ = false;
+
+  // A plan of the plan cache.
+  struct CachedPlan {
+    std::vector<size_t> key;
+    SimpleMemoryArena arena;
+    std::vector<ArenaAllocWithUsageInterval> allocs;
+  };
+
+  // Set by SetPlanCacheSize().
+  int plan_cache_size_ = 0;
+  // The cached plans, most recently used first.
+  std::list<CachedPlan> plan_cache_;
+  int plan_cache_hits_ = 0;
+
+  // Set by SetPlanForConcurrentNodes().
+  bool plan_for_concurrent_nodes_ = false;
+
+  // NodeDependencies::LastConcurrentNodes() of the plan, if
+  // plan_for_concurrent_nodes_.
+  std::vector<int32_t> last_concurrent_nodes_;
 };
 
 }  // namespace tflite
@@ -30,6 +30,7 @@ limitations under the License.
 #include "tensorflow/core/platform/logging.h"
 #include "tensorflow/lite/c/common.h"
 #include "tensorflow/lite/graph_info.h"
+#include "tensorflow/lite/offline_memory_planner.h"
 #include "tensorflow/lite/testing/util.h"
 
 namespace tflite {
@@ -333,6 +334,156 @@ TEST_F(ArenaPlannerTest, SimpleGraphWithTemporary) {
   EXPECT_EQ(GetOffset(1), 4);
 }
 
+TEST_F(ArenaPlannerTest, SimpleGraphWithOfflinePlannedOffsets) {
+  TestGraph graph({0, 1},
+                  {
+                      /* in, out, tmp */
+                      {{0, 1}, {2}, {}},     // First op
+                      {{2, 0}, {4, 5}, {}},  // Second op
+                      {{4, 5}, {3}, {}}      // Third op
+                  },
+                  {3});
+  SetGraph(&graph);
+  // #3 reuses the memory of #2, which is freed after the second op.
+  planner_->SetOfflinePlannedOffsets({0, 4, 12, 12, 24, 40});
+  Execute(0, 10);
+
+  EXPECT_EQ(GetOffset(0), 0);
+  EXPECT_EQ(GetOffset(1), 4);
+  EXPECT_EQ(GetOffset(2), 12);
+  EXPECT_EQ(GetOffset(3), 12);
+  EXPECT_EQ(GetOffset(4), 24);
+  EXPECT_EQ(GetOffset(5), 40);
+}
+
+TEST_F(ArenaPlannerTest, SimpleGraphWithConflictingOfflinePlannedOffsets) {
+  TestGraph graph({0, 1},
+                  {
+                      /* in, out, tmp */
+                      {{0, 1}, {2}, {}},     // First op
+                      {{2, 0}, {4, 5}, {}},  // Second op
+                      {{4, 5}, {3}, {}}      // Third op
+                  },
+                  {3});
+  SetGraph(&graph);
+  // #2 and #4 are both used by the second op, so #2, which is placed after
+  // the larger #4, is planned online.
+  planner_->SetOfflinePlannedOffsets({kOnlinePlannedOffset,
+                                      kOnlinePlannedOffset, 12,
+                                      kOnlinePlannedOffset, 12});
+  Execute(0, 10);
+
+  EXPECT_EQ(GetOffset(4), 12);
+  const bool overlap = GetOffset(2) < GetOffset(4) + 15 &&
+                       GetOffset(4) < GetOffset(2) + 9;
+  EXPECT_FALSE(overlap);
+}
+
+TEST_F(ArenaPlannerTest, GraphWithBestFitPlanning) {
+  TestGraph graph({0, 1},
+                  {
+                      /* in, out, tmp */
+                      {{1}, {2}, {}},        // First op
+                      {{0, 2}, {3}, {4}},    // Second op, with temporary
+                      {{3, 2}, {5}, {}},     // Third op
+                      {{1}, {6}, {}}         // Fourth op
+                  },
+                  {6});
+  SetGraph(&graph);
+  Execute(0, 10);
+  EXPECT_EQ(planner_->GetArenaSize(), 77);
+
+  // #6, the largest tensor, reuses the memory of #3, which is free after the
+  // third op.
+  SetGraph(&graph);
+  planner_->SetUseBestFitPlanning(true);
+  Execute(0, 10);
+  EXPECT_EQ(planner_->GetArenaSize(), 53);
+  EXPECT_EQ(planner_->GetPeakLiveArenaBytes(), 48);
+  EXPECT_EQ(GetOffset(0), 0);
+  EXPECT_EQ(GetOffset(1), GetOffsetAfter(0));
+  EXPECT_EQ(GetOffset(4), GetOffsetAfter(1));
+  EXPECT_EQ(GetOffset(5), GetOffsetAfter(1));
+  EXPECT_EQ(GetOffset(3), GetOffsetAfter(5));
+  EXPECT_EQ(GetOffset(2), GetOffsetAfter(3));
+  EXPECT_EQ(GetOffset(6), GetOffset(3));
+}
+
+TEST_F(ArenaPlannerTest, GraphWithPlanCache) {
+  TestGraph graph({0, 1},
+                  {
+                      /* in, out, tmp */
+                      {{0, 1}, {2}, {}},   // First op
+                      {{2, 0}, {4}, {5}},  // Second op, with temporary
+                      {{4}, {3}, {}}       // Third op
+                  },
+                  {3});
+  SetGraph(&graph);
+  auto plan_with_input_size = [&](size_t bytes) {
+    (*graph.tensors())[0].bytes = bytes;
+    CHECK(planner_->ResetAllocations() == kTfLiteOk);
+    Execute(0, 10);
+  };
+  planner_->SetPlanCacheSize(1);
+  plan_with_input_size(3);
+  std::vector<std::ptrdiff_t> offsets;
+  for (int i = 0; i <= 5; ++i) offsets.push_back(GetOffset(i));
+  const size_t buffer_size = planner_->GetArenaSize();
+
+  // A resized input gets a new plan, which replaces the cached one.
+  plan_with_input_size(100);
+  EXPECT_EQ(planner_->GetPlanCacheHits(), 0);
+  EXPECT_GT(planner_->GetArenaSize(), buffer_size);
+  plan_with_input_size(3);
+  EXPECT_EQ(planner_->GetPlanCacheHits(), 0);
+
+  planner_->SetPlanCacheSize(2);
+  plan_with_input_size(100);
+  EXPECT_EQ(planner_->GetPlanCacheHits(), 0);
+  plan_with_input_size(3);
+  EXPECT_EQ(planner_->GetPlanCacheHits(), 1);
+  plan_with_input_size(100);
+  EXPECT_EQ(planner_->GetPlanCacheHits(), 2);
+
+  // The plan of the original sizes comes from the cache.
+  plan_with_input_size(3);
+  EXPECT_EQ(planner_->GetPlanCacheHits(), 3);
+  EXPECT_EQ(planner_->GetArenaSize(), buffer_size);
+  for (int i = 0; i <= 5; ++i) EXPECT_EQ(GetOffset(i), offsets[i]) << i;
+
+  // Partial plans don't use the cache.
+  ResetAllocationsAfter(0);
+  Execute(1, 10);
+  EXPECT_EQ(planner_->GetPlanCacheHits(), 3);
+}
+
+TEST_F(ArenaPlannerTest, GraphWithConcurrentNodes) {
+  TestGraph graph({0, 1},
+                  {
+                      /* in, out, tmp */
+                      {{1}, {2}, {}},      // First op
+                      {{0, 2}, {3}, {4}},  // Second op, with temporary
+                      {{3, 2}, {5}, {}},   // Third op
+                      {{1}, {6}, {7}}      // Fourth op, independent
+                  },
+                  {5, 6});
+  SetGraph(&graph);
+  planner_->SetPlanForConcurrentNodes(true);
+  CHECK(planner_->PlanAllocations() == kTfLiteOk);
+  Execute(0, 10);
+
+  auto overlap = [this](int a, int b) {
+    return GetOffset(a) < GetOffsetAfter(b) && GetOffset(b) < GetOffsetAfter(a);
+  };
+  // The fourth op may run at the same time as the others, so its tensors don't
+  // share memory with theirs.
+  for (int tensor : {2, 3, 4, 5}) {
+    EXPECT_FALSE(overlap(6, tensor)) << tensor;
+    EXPECT_FALSE(overlap(7, tensor)) << tensor;
+  }
+  EXPECT_FALSE(overlap(6, 7));
+}
+
 TEST_F(ArenaPlannerTest, SimpleGraphWithResetAllocationsAfter) {
   TestGraph graph({0, 1},
                   {
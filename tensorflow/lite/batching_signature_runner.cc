@@ -0,0 +1,275 @@
+/* Copyright 2022 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/lite/batching_signature_runner.h"
+
+#include <algorithm>
+#include <chrono>  // NOLINT(build/c++11)
+#include <cstring>
+#include <memory>
+#include <mutex>  // NOLINT(build/c++11)
+#include <thread>  // NOLINT(build/c++11)
+#include <vector>
+
+#include "tensorflow/lite/c/common.h"
+#include "tensorflow/lite/core/api/error_reporter.h"
+#include "tensorflow/lite/interpreter.h"
+#include "tensorflow/lite/signature_runner.h"
+#include "tensorflow/lite/stderr_reporter.h"
+
+namespace tflite {
+
+std::unique_ptr<BatchingSignatureRunner> BatchingSignatureRunner::Create(
+    const std::vector<Interpreter*>& interpreters, const char* signature_key,
+    const Options& options) {
+  ErrorReporter* error_reporter = interpreters.empty()
+                                      ? DefaultErrorReporter()
+                                      : interpreters[0]->error_reporter();
+  if (interpreters.empty()) {
+    TF_LITE_REPORT_ERROR(error_reporter, "No interpreters were given.");
+    return nullptr;
+  }
+  const std::vector<int>& batch_sizes = options.allowed_batch_sizes;
+  if (batch_sizes.empty() || batch_sizes[0] <= 0 ||
+      !std::is_sorted(batch_sizes.begin(), batch_sizes.end())) {
+    TF_LITE_REPORT_ERROR(error_reporter,
+                         "The allowed batch sizes must be positive and in "
+                         "ascending order.");
+    return nullptr;
+  }
+
+  std::unique_ptr<BatchingSignatureRunner> batching_runner(
+      new BatchingSignatureRunner(options, error_reporter));
+  for (Interpreter* interpreter : interpreters) {
+    SignatureRunner* runner = interpreter->GetSignatureRunner(signature_key);
+    if (runner == nullptr) {
+      TF_LITE_REPORT_ERROR(error_reporter, "Signature %s was not found.",
+                           signature_key);
+      return nullptr;
+    }
+    if (batching_runner->workers_.empty()) {
+      batching_runner->input_names_ = runner->input_names();
+      batching_runner->output_names_ = runner->output_names();
+    } else if (runner->input_names().size() !=
+                   batching_runner->input_names_.size() ||
+               runner->output_names().size() !=
+                   batching_runner->output_names_.size()) {
+      TF_LITE_REPORT_ERROR(error_reporter,
+                           "The signatures of the interpreters differ.");
+      return nullptr;
+    }
+
+    // Plans the arena for the largest batch up front.
+    for (const char* name : batching_runner->input_names_) {
+      const TfLiteTensor* tensor = runner->input_tensor(name);
+      if (tensor == nullptr || tensor->dims->size == 0 ||
+          tensor->type == kTfLiteString) {
+        TF_LITE_REPORT_ERROR(error_reporter,
+                             "Input %s can't be batched along its first "
+                             "dimension.",
+                             name);
+        return nullptr;
+      }
+      std::vector<int> shape(tensor->dims->data,
+                             tensor->dims->data + tensor->dims->size);
+      shape[0] = batching_runner->max_batch_size_;
+      if (runner->ResizeInputTensor(name, shape) != kTfLiteOk) return nullptr;
+    }
+    if (runner->AllocateTensors() != kTfLiteOk) return nullptr;
+
+    std::vector<size_t> input_row_bytes;
+    for (const char* name : batching_runner->input_names_) {
+      input_row_bytes.push_back(runner->input_tensor(name)->bytes /
+                                batching_runner->max_batch_size_);
+    }
+    if (batching_runner->workers_.empty()) {
+      batching_runner->input_row_bytes_ = input_row_bytes;
+    } else if (input_row_bytes != batching_runner->input_row_bytes_) {
+      TF_LITE_REPORT_ERROR(error_reporter,
+                           "The input shapes of the interpreters differ.");
+      return nullptr;
+    }
+
+    auto worker = std::make_unique<Worker>();
+    worker->interpreter = interpreter;
+    worker->runner = runner;
+    batching_runner->workers_.push_back(std::move(worker));
+  }
+
+  for (auto& worker : batching_runner->workers_) {
+    worker->thread = std::thread(&BatchingSignatureRunner::WorkerLoop,
+                                 batching_runner.get(), worker.get());
+  }
+  return batching_runner;
+}
+
+BatchingSignatureRunner::BatchingSignatureRunner(
+    const Options& options, ErrorReporter* error_reporter)
+    : options_(options),
+      max_batch_size_(options.allowed_batch_sizes.back()),
+      error_reporter_(error_reporter) {}
+
+BatchingSignatureRunner::~BatchingSignatureRunner() {
+  {
+    std::lock_guard<std::mutex> lock(mu_);
+    exiting_ = true;
+  }
+  queue_cv_.notify_all();
+  for (auto& worker : workers_) {
+    if (worker->thread.joinable()) worker->thread.join();
+  }
+}
+
+TfLiteStatus BatchingSignatureRunner::Run(
+    int batch_size, const std::vector<const void*>& inputs,
+    std::vector<std::vector<char>>* outputs) {
+  if (batch_size <= 0 || batch_size > max_batch_size_) {
+    TF_LITE_REPORT_ERROR(error_reporter_,
+                         "Batch size %d is not in [1, %d].", batch_size,
+                         max_batch_size_);
+    return kTfLiteError;
+  }
+  if (inputs.size() != input_names_.size()) {
+    TF_LITE_REPORT_ERROR(error_reporter_, "Expected %d inputs, got %d.",
+                         static_cast<int>(input_names_.size()),
+                         static_cast<int>(inputs.size()));
+    return kTfLiteError;
+  }
+  outputs->resize(output_names_.size());
+
+  Request request;
+  request.batch_size = batch_size;
+  request.inputs = &inputs;
+  request.outputs = outputs;
+  std::unique_lock<std::mutex> lock(mu_);
+  if (num_queued_rows_ + batch_size >
+      options_.max_enqueued_batches * max_batch_size_) {
+    TF_LITE_REPORT_ERROR(error_reporter_, "The batching queue is full.");
+    return kTfLiteError;
+  }
+  request.enqueue_time = std::chrono::steady_clock::now();
+  queue_.push_back(&request);
+  num_queued_rows_ += batch_size;
+  queue_cv_.notify_one();
+  done_cv_.wait(lock, [&request] { return request.done; });
+  return request.status;
+}
+
+int64_t BatchingSignatureRunner::num_batches() const {
+  std::lock_guard<std::mutex> lock(mu_);
+  return num_batches_;
+}
+
+void BatchingSignatureRunner::WorkerLoop(Worker* worker) {
+  std::unique_lock<std::mutex> lock(mu_);
+  while (true) {
+    if (queue_.empty()) {
+      if (exiting_) return;
+      queue_cv_.wait(lock);
+      continue;
+    }
+    const auto deadline =
+        queue_.front()->enqueue_time +
+        std::chrono::microseconds(options_.batch_timeout_micros);
+    if (!exiting_ && num_queued_rows_ < max_batch_size_ &&
+        std::chrono::steady_clock::now() < deadline) {
+      queue_cv_.wait_until(lock, deadline);
+      continue;
+    }
+
+    std::vector<Request*> batch;
+    int num_rows = 0;
+    while (!queue_.empty() &&
+           num_rows + queue_.front()->batch_size <= max_batch_size_) {
+      num_rows += queue_.front()->batch_size;
+      batch.push_back(queue_.front());
+      queue_.pop_front();
+    }
+    num_queued_rows_ -= num_rows;
+    ++num_batches_;
+    // Another worker can take the next batch.
+    if (!queue_.empty()) queue_cv_.notify_one();
+
+    lock.unlock();
+    RunBatch(worker, batch);
+    lock.lock();
+    for (Request* request : batch) request->done = true;
+    done_cv_.notify_all();
+  }
+}
+
+void BatchingSignatureRunner::RunBatch(Worker* worker,
+                                       const std::vector<Request*>& batch) {
+  const TfLiteStatus status = RunBatchImpl(worker, batch);
+  for (Request* request : batch) request->status = status;
+}
+
+TfLiteStatus BatchingSignatureRunner::RunBatchImpl(
+    Worker* worker, const std::vector<Request*>& batch) {
+  int num_rows = 0;
+  for (const Request* request : batch) num_rows += request->batch_size;
+  const std::vector<int>& batch_sizes = options_.allowed_batch_sizes;
+  const int batch_size =
+      *std::lower_bound(batch_sizes.begin(), batch_sizes.end(), num_rows);
+  SignatureRunner* runner = worker->runner;
+
+  bool resized = false;
+  for (const char* name : input_names_) {
+    const TfLiteTensor* tensor = runner->input_tensor(name);
+    if (tensor->dims->data[0] == batch_size) continue;
+    std::vector<int> shape(tensor->dims->data,
+                           tensor->dims->data + tensor->dims->size);
+    shape[0] = batch_size;
+    TF_LITE_ENSURE_STATUS(runner->ResizeInputTensor(name, shape));
+    resized = true;
+  }
+  if (resized) TF_LITE_ENSURE_STATUS(runner->AllocateTensors());
+
+  for (size_t i = 0; i < input_names_.size(); ++i) {
+    TfLiteTensor* tensor = runner->input_tensor(input_names_[i]);
+    size_t offset = 0;
+    for (const Request* request : batch) {
+      const size_t bytes = request->batch_size * input_row_bytes_[i];
+      std::memcpy(tensor->data.raw + offset, (*request->inputs)[i], bytes);
+      offset += bytes;
+    }
+    // Pads the batch with zeros rather than the rows of the last batch.
+    std::memset(tensor->data.raw + offset, 0, tensor->bytes - offset);
+  }
+
+  TF_LITE_ENSURE_STATUS(runner->Invoke());
+
+  for (size_t i = 0; i < output_names_.size(); ++i) {
+    const TfLiteTensor* tensor = runner->output_tensor(output_names_[i]);
+    if (tensor->dims->size == 0 || tensor->dims->data[0] != batch_size ||
+        tensor->type == kTfLiteString) {
+      TF_LITE_REPORT_ERROR(error_reporter_,
+                           "Output %s can't be split along its first "
+                           "dimension.",
+                           output_names_[i]);
+      return kTfLiteError;
+    }
+    const size_t row_bytes = tensor->bytes / batch_size;
+    size_t offset = 0;
+    for (Request* request : batch) {
+      const size_t bytes = request->batch_size * row_bytes;
+      (*request->outputs)[i].assign(tensor->data.raw + offset,
+                                    tensor->data.raw + offset + bytes);
+      offset += bytes;
+    }
+  }
+  return kTfLiteOk;
+}
+
+}  // namespace tflite
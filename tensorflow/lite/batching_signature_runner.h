@@ -0,0 +1,167 @@
+/* Copyright 2022 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_LITE_BATCHING_SIGNATURE_RUNNER_H_
+#define TENSORFLOW_LITE_BATCHING_SIGNATURE_RUNNER_H_
+
+#include <chrono>  // NOLINT(build/c++11)
+#include <condition_variable>  // NOLINT(build/c++11)
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>  // NOLINT(build/c++11)
+#include <thread>  // NOLINT(build/c++11)
+#include <vector>
+
+#include "tensorflow/lite/c/common.h"
+#include "tensorflow/lite/core/api/error_reporter.h"
+#include "tensorflow/lite/interpreter.h"
+#include "tensorflow/lite/signature_runner.h"
+
+namespace tflite {
+
+/// WARNING: Experimental interface, subject to change
+///
+/// Runs concurrent requests for a signature as batches on a pool of
+/// interpreters, to amortize the overhead of Invoke() over several requests.
+///
+/// Every input and output of the signature must have the batch as its first
+/// dimension. The requests that are queued are concatenated along it, the
+/// batch is padded with zeros to the smallest of
+/// `Options::allowed_batch_sizes` that fits it, the inputs are resized to
+/// that size, and the rows of the outputs are copied back to the requests.
+/// Like `BasicBatchScheduler` in tensorflow/core/kernels/batching_util, a
+/// batch runs once it is full or once its first request has waited for
+/// `Options::batch_timeout_micros`.
+///
+/// Each interpreter runs one batch at a time on a thread of its own, so the
+/// arenas of the interpreters are not shared. Since the inputs only take the
+/// allowed batch sizes, an arena never grows past the plan for the largest
+/// one, and with `InterpreterOptions::SetArenaPlanCacheSize` set to the
+/// number of allowed batch sizes, switching between them doesn't plan the
+/// arena again.
+///
+/// Usage:
+///
+/// <pre><code>
+/// std::vector<std::unique_ptr<tflite::Interpreter>> interpreters = ...;
+/// std::vector<tflite::Interpreter*> pool;
+/// for (auto& interpreter : interpreters) pool.push_back(interpreter.get());
+/// auto runner = tflite::BatchingSignatureRunner::Create(
+///     pool, "serving_default", tflite::BatchingSignatureRunner::Options());
+/// if (runner == nullptr) {
+///   // Return error.
+/// }
+///
+/// // From any thread:
+/// std::vector<std::vector<char>> outputs;
+/// if (runner->Run(/*batch_size=*/1, {input_data}, &outputs) != kTfLiteOk) {
+///   // Return failure.
+/// }
+/// </code></pre>
+class BatchingSignatureRunner {
+ public:
+  struct Options {
+    /// The sizes the batch dimension of the inputs is resized to, in
+    /// ascending order. The last one is the maximum batch size.
+    std::vector<int> allowed_batch_sizes = {1, 2, 4, 8, 16, 32};
+    /// How long a request waits for other requests to fill its batch.
+    int64_t batch_timeout_micros = 1000;
+    /// The maximum number of rows that wait for a batch, in multiples of the
+    /// maximum batch size. Run() fails once they are exceeded.
+    int max_enqueued_batches = 16;
+  };
+
+  /// Creates a runner for the signature `signature_key` of `interpreters`,
+  /// which must all be built from the same model and outlive the runner.
+  /// Allocates the tensors of the signature. Returns nullptr on failure.
+  static std::unique_ptr<BatchingSignatureRunner> Create(
+      const std::vector<Interpreter*>& interpreters, const char* signature_key,
+      const Options& options);
+
+  /// Waits for the queued requests to finish.
+  ~BatchingSignatureRunner();
+
+  BatchingSignatureRunner(const BatchingSignatureRunner&) = delete;
+  BatchingSignatureRunner& operator=(const BatchingSignatureRunner&) = delete;
+
+  /// Names of the inputs and outputs of the signature, in the order of the
+  /// buffers of Run().
+  const std::vector<const char*>& input_names() const { return input_names_; }
+  const std::vector<const char*>& output_names() const {
+    return output_names_;
+  }
+
+  /// Returns the size in bytes of one row of input `i`.
+  size_t input_row_bytes(int i) const { return input_row_bytes_[i]; }
+
+  /// Runs a request of `batch_size` rows and blocks until it is done.
+  /// `inputs[i]` holds `batch_size * input_row_bytes(i)` bytes for input
+  /// `input_names()[i]`, and `(*outputs)[i]` receives the rows of output
+  /// `output_names()[i]`. `batch_size` must not exceed the maximum batch
+  /// size. Thread safe.
+  TfLiteStatus Run(int batch_size, const std::vector<const void*>& inputs,
+                   std::vector<std::vector<char>>* outputs);
+
+  /// Returns the number of batches that were invoked.
+  int64_t num_batches() const;
+
+ private:
+  struct Request {
+    int batch_size;
+    const std::vector<const void*>* inputs;
+    std::vector<std::vector<char>>* outputs;
+    std::chrono::steady_clock::time_point enqueue_time;
+    TfLiteStatus status = kTfLiteOk;
+    bool done = false;
+  };
+
+  struct Worker {
+    Interpreter* interpreter;
+    SignatureRunner* runner;
+    std::thread thread;
+  };
+
+  BatchingSignatureRunner(const Options& options,
+                          ErrorReporter* error_reporter);
+
+  void WorkerLoop(Worker* worker);
+  // Runs `batch` on the interpreter of `worker` and sets the status of its
+  // requests.
+  void RunBatch(Worker* worker, const std::vector<Request*>& batch);
+  TfLiteStatus RunBatchImpl(Worker* worker, const std::vector<Request*>& batch);
+
+  const Options options_;
+  const int max_batch_size_;
+  ErrorReporter* const error_reporter_;
+  std::vector<const char*> input_names_;
+  std::vector<const char*> output_names_;
+  std::vector<size_t> input_row_bytes_;
+  std::vector<std::unique_ptr<Worker>> workers_;
+
+  mutable std::mutex mu_;
+  // Signals the workers that requests were queued or that they have to exit.
+  std::condition_variable queue_cv_;
+  // Signals the callers of Run() that requests are done.
+  std::condition_variable done_cv_;
+  std::deque<Request*> queue_;
+  int num_queued_rows_ = 0;
+  int64_t num_batches_ = 0;
+  bool exiting_ = false;
+};
+
+}  // namespace tflite
+
+#endif  // TENSORFLOW_LITE_BATCHING_SIGNATURE_RUNNER_H_
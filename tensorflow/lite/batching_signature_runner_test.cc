@@ -0,0 +1,125 @@
+/* Copyright 2022 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/lite/batching_signature_runner.h"
+
+#include <memory>
+#include <thread>  // NOLINT(build/c++11)
+#include <vector>
+
+#include <gtest/gtest.h>
+#include "tensorflow/lite/interpreter.h"
+#include "tensorflow/lite/interpreter_builder.h"
+#include "tensorflow/lite/kernels/register.h"
+#include "tensorflow/lite/model_builder.h"
+#include "tensorflow/lite/testing/util.h"
+
+namespace tflite {
+namespace {
+
+class BatchingSignatureRunnerTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    // The "add" signature adds 2 to its input `x`.
+    model_ = FlatBufferModel::BuildFromFile(
+        "tensorflow/lite/testdata/multi_signatures.bin", &reporter_);
+    ASSERT_TRUE(model_);
+    ops::builtin::BuiltinOpResolver resolver;
+    for (int i = 0; i < 2; ++i) {
+      std::unique_ptr<Interpreter> interpreter;
+      ASSERT_EQ(InterpreterBuilder(*model_, resolver)(&interpreter),
+                kTfLiteOk);
+      pool_.push_back(interpreter.get());
+      interpreters_.push_back(std::move(interpreter));
+    }
+  }
+
+  TestErrorReporter reporter_;
+  std::unique_ptr<FlatBufferModel> model_;
+  std::vector<std::unique_ptr<Interpreter>> interpreters_;
+  std::vector<Interpreter*> pool_;
+};
+
+TEST_F(BatchingSignatureRunnerTest, CoalescesConcurrentRequests) {
+  BatchingSignatureRunner::Options options;
+  options.allowed_batch_sizes = {1, 2, 4};
+  // Only a full batch runs.
+  options.batch_timeout_micros = 60 * 1000 * 1000;
+  auto runner = BatchingSignatureRunner::Create(pool_, "add", options);
+  ASSERT_NE(runner, nullptr);
+  ASSERT_EQ(runner->input_names().size(), 1);
+  ASSERT_EQ(runner->output_names().size(), 1);
+  EXPECT_EQ(runner->input_row_bytes(0), sizeof(float));
+
+  std::vector<std::thread> threads;
+  std::vector<float> outputs(4);
+  std::vector<TfLiteStatus> statuses(4, kTfLiteError);
+  for (int i = 0; i < 4; ++i) {
+    threads.emplace_back([&, i] {
+      const float input = i;
+      std::vector<std::vector<char>> output;
+      statuses[i] = runner->Run(1, {&input}, &output);
+      if (statuses[i] == kTfLiteOk && output[0].size() == sizeof(float)) {
+        outputs[i] = *reinterpret_cast<const float*>(output[0].data());
+      }
+    });
+  }
+  for (std::thread& thread : threads) thread.join();
+  for (int i = 0; i < 4; ++i) {
+    EXPECT_EQ(statuses[i], kTfLiteOk);
+    EXPECT_EQ(outputs[i], i + 2);
+  }
+  EXPECT_EQ(runner->num_batches(), 1);
+}
+
+TEST_F(BatchingSignatureRunnerTest, PadsToAllowedBatchSize) {
+  BatchingSignatureRunner::Options options;
+  options.allowed_batch_sizes = {2, 4};
+  options.batch_timeout_micros = 0;
+  auto runner = BatchingSignatureRunner::Create(pool_, "add", options);
+  ASSERT_NE(runner, nullptr);
+
+  const std::vector<float> input = {1, 2, 3};
+  std::vector<std::vector<char>> output;
+  ASSERT_EQ(runner->Run(3, {input.data()}, &output), kTfLiteOk);
+  ASSERT_EQ(output.size(), 1);
+  ASSERT_EQ(output[0].size(), 3 * sizeof(float));
+  const float* values = reinterpret_cast<const float*>(output[0].data());
+  EXPECT_EQ(values[0], 3);
+  EXPECT_EQ(values[1], 4);
+  EXPECT_EQ(values[2], 5);
+  EXPECT_EQ(runner->num_batches(), 1);
+}
+
+TEST_F(BatchingSignatureRunnerTest, InvalidRequests) {
+  BatchingSignatureRunner::Options options;
+  options.allowed_batch_sizes = {1, 2};
+  auto runner = BatchingSignatureRunner::Create(pool_, "add", options);
+  ASSERT_NE(runner, nullptr);
+  const std::vector<float> input = {1, 2, 3};
+  std::vector<std::vector<char>> output;
+  EXPECT_EQ(runner->Run(3, {input.data()}, &output), kTfLiteError);
+  EXPECT_EQ(runner->Run(0, {input.data()}, &output), kTfLiteError);
+  EXPECT_EQ(runner->Run(1, {}, &output), kTfLiteError);
+  EXPECT_EQ(runner->num_batches(), 0);
+
+  EXPECT_EQ(BatchingSignatureRunner::Create(pool_, "dummy", options),
+            nullptr);
+  options.allowed_batch_sizes = {2, 1};
+  EXPECT_EQ(BatchingSignatureRunner::Create(pool_, "add", options), nullptr);
+  EXPECT_EQ(BatchingSignatureRunner::Create({}, "add", options), nullptr);
+}
+
+}  // namespace
+}  // namespace tflite
@@ -100,6 +100,33 @@ void TfLiteSetAllowBufferHandleOutput(const TfLiteInterpreter* interpreter,
   interpreter->impl->SetAllowBufferHandleOutput(allow_buffer_handle_output);
 }
 
+TfLiteStatus TfLiteInterpreterSetCustomAllocationForTensor(
+    TfLiteInterpreter* interpreter, int tensor_index,
+    const TfLiteCustomAllocation* allocation, int64_t flags) {
+  if (allocation == nullptr || tensor_index < 0 ||
+      tensor_index >= interpreter->impl->tensors_size()) {
+    return kTfLiteError;
+  }
+  return interpreter->impl->SetCustomAllocationForTensor(tensor_index,
+                                                         *allocation, flags);
+}
+
+TfLiteStatus TfLiteInterpreterSetBufferHandle(TfLiteInterpreter* interpreter,
+                                              int tensor_index,
+                                              TfLiteBufferHandle buffer_handle,
+                                              TfLiteDelegate* delegate) {
+  return interpreter->impl->SetBufferHandle(tensor_index, buffer_handle,
+                                            delegate);
+}
+
+TfLiteStatus TfLiteInterpreterGetBufferHandle(TfLiteInterpreter* interpreter,
+                                              int tensor_index,
+                                              TfLiteBufferHandle* buffer_handle,
+                                              TfLiteDelegate** delegate) {
+  return interpreter->impl->GetBufferHandle(tensor_index, buffer_handle,
+                                            delegate);
+}
+
 TfLiteStatus TfLiteInterpreterModifyGraphWithDelegate(
     const TfLiteInterpreter* interpreter, TfLiteDelegate* delegate) {
   return interpreter->impl->ModifyGraphWithDelegate(delegate);
@@ -197,6 +197,48 @@ TFL_CAPI_EXPORT extern void TfLiteInterpreterOptionsSetEnableDelegateFallback(
 TFL_CAPI_EXPORT extern void TfLiteSetAllowBufferHandleOutput(
     const TfLiteInterpreter* interpreter, bool allow_buffer_handle_output);
 
+/// Binds a caller-owned buffer to the tensor with index `tensor_index`, so that
+/// inference reads (for inputs) or writes (for outputs) it directly instead of
+/// the memory owned by the interpreter, which avoids the copies of
+/// TfLiteTensorCopyFromBuffer() and TfLiteTensorCopyToBuffer().
+///
+/// `allocation->data` must be aligned to 64 bytes unless
+/// `kTfLiteCustomAllocationFlagsSkipAlignCheck` is set in `flags`, and must
+/// stay valid while it is bound. The interpreter does not take ownership.
+///
+/// The tensors must be (re)allocated with TfLiteInterpreterAllocateTensors()
+/// after a tensor is first bound. Once they are allocated, a new buffer can be
+/// bound to the same tensor before every TfLiteInterpreterInvoke() without
+/// reallocating; its size is then checked by this call. Resizing an input
+/// requires TfLiteInterpreterAllocateTensors() again, which fails if a bound
+/// buffer is too small.
+///
+/// WARNING: This is an experimental API and subject to change.
+TFL_CAPI_EXPORT extern TfLiteStatus
+TfLiteInterpreterSetCustomAllocationForTensor(
+    TfLiteInterpreter* interpreter, int tensor_index,
+    const TfLiteCustomAllocation* allocation, int64_t flags);
+
+/// Sets the delegate buffer handle of the tensor with index `tensor_index`,
+/// e.g. to bind a GPU buffer or texture in place of the tensor data. The
+/// `delegate` must be the one that handles the tensor. Use
+/// TfLiteSetAllowBufferHandleOutput() to also keep the outputs in their buffer
+/// handles. A previous buffer handle of the tensor is freed with the
+/// `FreeBufferHandle` callback of the delegate.
+///
+/// WARNING: This is an experimental API and subject to change.
+TFL_CAPI_EXPORT extern TfLiteStatus TfLiteInterpreterSetBufferHandle(
+    TfLiteInterpreter* interpreter, int tensor_index,
+    TfLiteBufferHandle buffer_handle, TfLiteDelegate* delegate);
+
+/// Gets the delegate buffer handle of the tensor with index `tensor_index`,
+/// and the delegate that handles it.
+///
+/// WARNING: This is an experimental API and subject to change.
+TFL_CAPI_EXPORT extern TfLiteStatus TfLiteInterpreterGetBufferHandle(
+    TfLiteInterpreter* interpreter, int tensor_index,
+    TfLiteBufferHandle* buffer_handle, TfLiteDelegate** delegate);
+
 /// Allow a delegate to look at the graph and modify the graph to handle
 /// parts of the graph themselves. After this is called, the graph may
 /// contain new nodes that replace 1 more nodes.
@@ -64,6 +64,82 @@ TEST(CApiExperimentalTest, Smoke) {
   TfLiteModelDelete(model);
 }
 
+TEST(CApiExperimentalTest, CustomAllocation) {
+  TfLiteModel* model =
+      TfLiteModelCreateFromFile("tensorflow/lite/testdata/add.bin");
+  ASSERT_NE(model, nullptr);
+  TfLiteInterpreter* interpreter = TfLiteInterpreterCreate(model, nullptr);
+  ASSERT_NE(interpreter, nullptr);
+  const int input_dims[] = {2};
+  ASSERT_EQ(TfLiteInterpreterResizeInputTensor(interpreter, 0, input_dims, 1),
+            kTfLiteOk);
+  ASSERT_EQ(TfLiteInterpreterAllocateTensors(interpreter), kTfLiteOk);
+  const int input_index = TfLiteInterpreterGetInputTensorIndex(interpreter, 0);
+  const int output_index =
+      TfLiteInterpreterGetOutputTensorIndex(interpreter, 0);
+
+  alignas(64) float inputs[2][16] = {{1.f, 3.f}, {2.f, 4.f}};
+  alignas(64) float outputs[2][16];
+  TfLiteCustomAllocation input_alloc{inputs[0], 2 * sizeof(float)};
+  TfLiteCustomAllocation output_alloc{outputs[0], 2 * sizeof(float)};
+  ASSERT_EQ(TfLiteInterpreterSetCustomAllocationForTensor(
+                interpreter, input_index, &input_alloc,
+                kTfLiteCustomAllocationFlagsNone),
+            kTfLiteOk);
+  ASSERT_EQ(TfLiteInterpreterSetCustomAllocationForTensor(
+                interpreter, output_index, &output_alloc,
+                kTfLiteCustomAllocationFlagsNone),
+            kTfLiteOk);
+  ASSERT_EQ(TfLiteInterpreterAllocateTensors(interpreter), kTfLiteOk);
+  ASSERT_EQ(TfLiteInterpreterInvoke(interpreter), kTfLiteOk);
+  EXPECT_EQ(outputs[0][0], 3.f);
+  EXPECT_EQ(outputs[0][1], 9.f);
+
+  // Other buffers can be bound before the next invocation without
+  // reallocating the tensors.
+  input_alloc.data = inputs[1];
+  output_alloc.data = outputs[1];
+  ASSERT_EQ(TfLiteInterpreterSetCustomAllocationForTensor(
+                interpreter, input_index, &input_alloc,
+                kTfLiteCustomAllocationFlagsNone),
+            kTfLiteOk);
+  ASSERT_EQ(TfLiteInterpreterSetCustomAllocationForTensor(
+                interpreter, output_index, &output_alloc,
+                kTfLiteCustomAllocationFlagsNone),
+            kTfLiteOk);
+  ASSERT_EQ(TfLiteInterpreterInvoke(interpreter), kTfLiteOk);
+  EXPECT_EQ(outputs[1][0], 6.f);
+  EXPECT_EQ(outputs[1][1], 12.f);
+  EXPECT_EQ(outputs[0][0], 3.f);
+
+  // Buffers that are too small or misaligned are rejected.
+  TfLiteCustomAllocation small_alloc{inputs[0], sizeof(float)};
+  EXPECT_EQ(TfLiteInterpreterSetCustomAllocationForTensor(
+                interpreter, input_index, &small_alloc,
+                kTfLiteCustomAllocationFlagsNone),
+            kTfLiteError);
+  TfLiteCustomAllocation misaligned_alloc{&inputs[0][1], 2 * sizeof(float)};
+  EXPECT_EQ(TfLiteInterpreterSetCustomAllocationForTensor(
+                interpreter, input_index, &misaligned_alloc,
+                kTfLiteCustomAllocationFlagsNone),
+            kTfLiteError);
+  EXPECT_EQ(TfLiteInterpreterSetCustomAllocationForTensor(
+                interpreter, -1, &input_alloc,
+                kTfLiteCustomAllocationFlagsNone),
+            kTfLiteError);
+
+  TfLiteBufferHandle buffer_handle;
+  TfLiteDelegate* delegate;
+  ASSERT_EQ(TfLiteInterpreterGetBufferHandle(interpreter, input_index,
+                                             &buffer_handle, &delegate),
+            kTfLiteOk);
+  EXPECT_EQ(buffer_handle, kTfLiteNullBufferHandle);
+  EXPECT_EQ(delegate, nullptr);
+
+  TfLiteInterpreterDelete(interpreter);
+  TfLiteModelDelete(model);
+}
+
 // Test using TfLiteInterpreterCreateWithSelectedOps.
 TEST(CApiExperimentalTest, SelectedBuiltins) {
   TfLiteModel* model =
@@ -19,11 +19,13 @@ limitations under the License.
 #include <stddef.h>
 
 #include <algorithm>
+#include <atomic>
 #include <cstdint>
 #include <cstdlib>
 #include <cstring>
 #include <iterator>
 #include <memory>
+#include <mutex>  // NOLINT(build/c++11)
 #include <string>
 #include <utility>
 #include <vector>
@@ -42,6 +44,11 @@ limitations under the License.
 #include "tensorflow/lite/graph_info.h"
 #include "tensorflow/lite/memory_planner.h"
 #include "tensorflow/lite/minimal_logging.h"
+#include "tensorflow/lite/node_dependencies.h"
+#include "tensorflow/lite/offline_memory_planner.h"
+#include "tensorflow/lite/parallel_node_executor.h"
+#include "tensorflow/lite/pipeline_executor.h"
+#include "tensorflow/lite/pipeline_plan.h"
 #include "tensorflow/lite/schema/schema_generated.h"
 #include "tensorflow/lite/util.h"
 #ifdef TFLITE_USE_SIMPLE_MEMORY_PLANNER
@@ -263,6 +270,8 @@ Subgraph::Subgraph(ErrorReporter* error_reporter,
 }
 
 Subgraph::~Subgraph() {
+  // The stage threads run nodes.
+  pipeline_executor_.reset();
   for (int node_index = 0; node_index < nodes_and_registration_.size();
        ++node_index) {
     CleanupNode(node_index);
@@ -372,6 +381,30 @@ TfLiteDelegateParams* CreateDelegateParams(TfLiteDelegate* delegate,
   return params;
 }
 
+// Returns a copy of `quantization` for another tensor.
+TfLiteQuantization CopyQuantization(const TfLiteQuantization& quantization) {
+  TfLiteQuantization copy = {kTfLiteNoQuantization, nullptr};
+  if (quantization.type != kTfLiteAffineQuantization ||
+      quantization.params == nullptr) {
+    return copy;
+  }
+  const auto* params =
+      static_cast<const TfLiteAffineQuantization*>(quantization.params);
+  auto* copy_params = static_cast<TfLiteAffineQuantization*>(
+      malloc(sizeof(TfLiteAffineQuantization)));
+  copy_params->scale = nullptr;
+  if (params->scale != nullptr) {
+    copy_params->scale = TfLiteFloatArrayCreate(params->scale->size);
+    memcpy(copy_params->scale->data, params->scale->data,
+           sizeof(float) * params->scale->size);
+  }
+  copy_params->zero_point = TfLiteIntArrayCopy(params->zero_point);
+  copy_params->quantized_dimension = params->quantized_dimension;
+  copy.type = kTfLiteAffineQuantization;
+  copy.params = copy_params;
+  return copy;
+}
+
 // Assumes that params is not nullptr.
 void PopulatePreviewDelegateParams(const NodeSubset& node_subset,
                                    TfLiteDelegateParams* params) {
@@ -438,6 +471,9 @@ TfLiteStatus Subgraph::ReplaceNodeSubsetsWithDelegateKernels(
       case NodeSubset::kTfPartition: {
         int node_index;
 
+        if (PipelineDepth() > 1) {
+          TF_LITE_ENSURE_STATUS(UsePrivateBoundaryTensors(&node_subset));
+        }
         TfLiteDelegateParams* params =
             CreateDelegateParams(delegate, node_subset);
         TF_LITE_ENSURE_STATUS(AddNodeWithParameters(
@@ -461,11 +497,100 @@ TfLiteStatus Subgraph::ReplaceNodeSubsetsWithDelegateKernels(
         break;
     }
   }
+  pipeline_plan_.reset();
+  return kTfLiteOk;
+}
+
+TfLiteStatus Subgraph::UsePrivateBoundaryTensors(NodeSubset* node_subset) {
+  // Maps the tensors to their private copies.
+  std::unordered_map<int, int> private_tensors;
+  for (std::vector<int>* tensors :
+       {&node_subset->input_tensors, &node_subset->output_tensors}) {
+    for (int& tensor_index : *tensors) {
+      if (tensor_index == kTfLiteOptionalTensor) continue;
+      auto it = private_tensors.find(tensor_index);
+      if (it == private_tensors.end()) {
+        // Constant, variable and dynamic tensors are used in place.
+        if (tensors_[tensor_index].allocation_type != kTfLiteArenaRw) continue;
+        int private_index;
+        TF_LITE_ENSURE_STATUS(AddTensors(1, &private_index));
+        const TfLiteTensor& tensor = tensors_[tensor_index];
+        TfLiteTensor& private_tensor = tensors_[private_index];
+        private_tensor.type = tensor.type;
+        private_tensor.name = tensor.name;
+        private_tensor.allocation_type = kTfLiteArenaRw;
+        private_tensor.bytes = tensor.bytes;
+        private_tensor.dims = TfLiteIntArrayCopy(tensor.dims);
+        private_tensor.dims_signature =
+            TfLiteIntArrayCopy(tensor.dims_signature);
+        private_tensor.params = tensor.params;
+        private_tensor.quantization = CopyQuantization(tensor.quantization);
+        pipeline_private_tensors_[private_index] = tensor_index;
+        it = private_tensors.emplace(tensor_index, private_index).first;
+      }
+      tensor_index = it->second;
+    }
+  }
+  for (int node_index : node_subset->nodes) {
+    TfLiteNode& node = nodes_and_registration_[node_index].first;
+    for (TfLiteIntArray* tensors : {node.inputs, node.outputs}) {
+      for (int i = 0; i < tensors->size; ++i) {
+        auto it = private_tensors.find(tensors->data[i]);
+        if (it != private_tensors.end()) tensors->data[i] = it->second;
+      }
+    }
+  }
+  return kTfLiteOk;
+}
+
+void Subgraph::RestorePrivateBoundaryTensors() {
+  if (pipeline_private_tensors_.empty()) return;
+  for (int node_index : execution_plan_) {
+    TfLiteNode& node = nodes_and_registration_[node_index].first;
+    for (TfLiteIntArray* tensors : {node.inputs, node.outputs}) {
+      for (int i = 0; i < tensors->size; ++i) {
+        auto it = pipeline_private_tensors_.find(tensors->data[i]);
+        if (it != pipeline_private_tensors_.end()) {
+          tensors->data[i] = it->second;
+        }
+      }
+    }
+  }
+  pipeline_private_tensors_.clear();
+  pipeline_plan_.reset();
+  pipeline_executor_.reset();
+}
+
+TfLiteStatus Subgraph::ResizePrivateBoundaryTensors(const TfLiteNode& node,
+                                                    bool outputs) {
+  if (pipeline_private_tensors_.empty()) return kTfLiteOk;
+  const TfLiteIntArray* tensors = outputs ? node.outputs : node.inputs;
+  for (int i = 0; i < tensors->size; ++i) {
+    auto it = pipeline_private_tensors_.find(tensors->data[i]);
+    if (it == pipeline_private_tensors_.end()) continue;
+    TfLiteTensor* from = &tensors_[outputs ? it->first : it->second];
+    TfLiteTensor* to = &tensors_[outputs ? it->second : it->first];
+    if (!TfLiteIntArrayEqual(from->dims, to->dims)) {
+      TF_LITE_ENSURE_STATUS(
+          ResizeTensorImpl(to, TfLiteIntArrayCopy(from->dims)));
+    }
+  }
   return kTfLiteOk;
 }
 
 TfLiteExternalContext* Subgraph::GetExternalContext(
     TfLiteExternalContextType type) {
+  if (type == kTfLiteCpuBackendContext) {
+    // The nodes that run on the worker threads of a ParallelNodeExecutor use
+    // the CPU backend context of the thread.
+    TfLiteExternalContext* worker_context =
+        ParallelNodeExecutor::WorkerCpuBackendContext();
+    if (worker_context != nullptr) return worker_context;
+    // And so do the nodes that run on the stage threads of a pipeline.
+    TfLiteExternalContext* stage_context =
+        PipelineExecutor::StageCpuBackendContext();
+    if (stage_context != nullptr) return stage_context;
+  }
   if (static_cast<int>(type) >= 0 && type < kTfLiteMaxExternalContexts) {
     return external_contexts_[type];
   }
@@ -537,6 +662,21 @@ TfLiteStatus Subgraph::GetModelMetadata(const char* name, const char** ptr,
   return kTfLiteError;
 }
 
+bool Subgraph::GetOfflinePlannedOffsets(std::vector<int32_t>* offsets) {
+  const char* data;
+  size_t bytes;
+  if (GetModelMetadata(kOfflineMemoryAllocationMetadata, &data, &bytes) !=
+      kTfLiteOk) {
+    return false;
+  }
+  for (int i = 0; i < static_cast<int>(subgraphs_->size()); ++i) {
+    if ((*subgraphs_)[i].get() == this) {
+      return ParseOfflineMemoryAllocation(data, bytes, i, offsets);
+    }
+  }
+  return false;
+}
+
 TfLiteStatus Subgraph::GetModelMetadata(const struct TfLiteContext* context,
                                         const char* name, const char** ptr,
                                         size_t* bytes) {
@@ -707,6 +847,10 @@ TfLiteStatus Subgraph::AllocateTensors() {
     ReportError("AllocateTensors() called on inconsistent model.");
     return kTfLiteError;
   }
+  if (!async_invocations_.empty()) {
+    ReportError("AllocateTensors() called with invocations in flight.");
+    return kTfLiteError;
+  }
 
   // Restore delegation state if applicable.
   TF_LITE_ENSURE_STATUS(RedoAllDelegates());
@@ -742,6 +886,9 @@ TfLiteStatus Subgraph::AllocateTensors() {
   if (memory_planner_) {
     TF_LITE_ENSURE_STATUS(memory_planner_->ResetAllocations());
   }
+  // The graph or the sizes of the tensors may have changed.
+  pipeline_plan_.reset();
+  pipeline_executor_.reset();
 
   TF_LITE_ENSURE_STATUS(PrepareOpsAndTensors());
 
@@ -1046,6 +1193,13 @@ TfLiteStatus Subgraph::PrepareOpsStartingAt(
     has_dynamic_tensors_ =
         HasDynamicTensorImpl(context_, outputs(), &dynamic_tensor_index_);
   }
+  // The private tensors of the pipeline are resized between the nodes.
+  if (ShouldPrepareInParallel() && &execution_plan == &execution_plan_ &&
+      pipeline_private_tensors_.empty() &&
+      execution_plan.size() - first_execution_plan_index > 1) {
+    return PrepareOpsInParallel(first_execution_plan_index,
+                                last_execution_plan_index_prepared);
+  }
   for (int execution_plan_index = first_execution_plan_index;
        execution_plan_index < execution_plan.size(); execution_plan_index++) {
     int node_index = execution_plan[execution_plan_index];
@@ -1053,12 +1207,14 @@ TfLiteStatus Subgraph::PrepareOpsStartingAt(
     const TfLiteRegistration& registration =
         nodes_and_registration_[node_index].second;
     EnsureTensorsVectorCapacity();
+    TF_LITE_ENSURE_STATUS(ResizePrivateBoundaryTensors(node, false));
     const TfLiteStatus op_prepare_status = OpPrepare(registration, &node);
     if (op_prepare_status != kTfLiteOk) {
       ReportOpError(&context_, node, registration, node_index,
                     "failed to prepare");
       return op_prepare_status;
     }
+    TF_LITE_ENSURE_STATUS(ResizePrivateBoundaryTensors(node, true));
 
     *last_execution_plan_index_prepared = execution_plan_index;
 
@@ -1073,14 +1229,104 @@ TfLiteStatus Subgraph::PrepareOpsStartingAt(
   return kTfLiteOk;
 }
 
+TfLiteStatus Subgraph::PrepareOpsInParallel(
+    int first_execution_plan_index, int* last_execution_plan_index_prepared) {
+  ParallelNodeExecutor* executor =
+      GetParallelNodeExecutor(options_->GetParallelPrepareThreads());
+  std::unique_ptr<NodeDependencies> dependencies = CreateNodeDependencies();
+  const int num_nodes = execution_plan_.size();
+  // Each Prepare may add up to kTensorsCapacityHeadroom tensors, which must not
+  // move the tensors that the other nodes use.
+  const size_t required_capacity =
+      tensors_.size() +
+      kTensorsCapacityHeadroom * (num_nodes - first_execution_plan_index);
+  if (required_capacity > tensors_.capacity()) {
+    tensors_.reserve(required_capacity);
+    context_.tensors = tensors_.data();
+  }
+
+  // Whether a node has dynamic outputs, or depends on such a node and isn't
+  // prepared.
+  std::unique_ptr<std::atomic<bool>[]> dynamic(
+      new std::atomic<bool>[num_nodes]);
+  for (int i = 0; i < num_nodes; ++i) dynamic[i] = false;
+  auto prepare_node = [&](int execution_plan_index) {
+    if (execution_plan_index < first_execution_plan_index) return kTfLiteOk;
+    if (!dynamic[execution_plan_index]) {
+      auto& node_and_registration =
+          nodes_and_registration_[execution_plan_[execution_plan_index]];
+      TfLiteNode& node = node_and_registration.first;
+      TF_LITE_ENSURE_STATUS(OpPrepare(node_and_registration.second, &node));
+      // HasDynamicTensor() keeps the index of the dynamic tensor it finds,
+      // which is only reported in order.
+      if (!HasDynamicTensor(context_, node.outputs, nullptr)) {
+        return kTfLiteOk;
+      }
+      dynamic[execution_plan_index] = true;
+    }
+    for (int successor : dependencies->successors(execution_plan_index)) {
+      dynamic[successor] = true;
+    }
+    return kTfLiteOk;
+  };
+
+  int failed_execution_plan_index = -1;
+  preparing_in_parallel_ = true;
+  const TfLiteStatus status = executor->Run(*dependencies, prepare_node,
+                                            &failed_execution_plan_index);
+  preparing_in_parallel_ = false;
+  if (status != kTfLiteOk) {
+    const int node_index = execution_plan_[failed_execution_plan_index];
+    ReportOpError(&context_, nodes_and_registration_[node_index].first,
+                  nodes_and_registration_[node_index].second, node_index,
+                  "failed to prepare");
+    return status;
+  }
+
+  // As in order, the prepared nodes end at the first node with dynamic
+  // outputs. The later nodes that were prepared are prepared again once the
+  // dynamic tensors have their sizes.
+  for (int execution_plan_index = first_execution_plan_index;
+       execution_plan_index < num_nodes; ++execution_plan_index) {
+    *last_execution_plan_index_prepared = execution_plan_index;
+    if (dynamic[execution_plan_index]) {
+      const TfLiteNode& node =
+          nodes_and_registration_[execution_plan_[execution_plan_index]].first;
+      HasDynamicTensor(context_, node.outputs, &dynamic_tensor_index_);
+      has_dynamic_tensors_ = true;
+      break;
+    }
+  }
+  return kTfLiteOk;
+}
+
 TfLiteStatus Subgraph::PrepareOpsAndTensors() {
+  // The execution plan may have changed.
+  node_dependencies_.reset();
   if (!memory_planner_) {
 #ifdef TFLITE_USE_SIMPLE_MEMORY_PLANNER
     memory_planner_.reset(new SimplePlanner(&context_, CreateGraphInfo()));
+    // Tensors don't share memory.
+    memory_planned_for_concurrent_nodes_ = true;
+    memory_planned_for_pipeline_ = true;
 #else
-    memory_planner_ = std::make_unique<ArenaPlanner>(
-        &context_, CreateGraphInfo(), ShouldPreserveAllTensors(),
+    // The stages of a pipeline run at the same time on different invocations,
+    // so their tensors can't share memory.
+    memory_planned_for_pipeline_ = PipelineDepth() > 1;
+    auto arena_planner = std::make_unique<ArenaPlanner>(
+        &context_, CreateGraphInfo(),
+        ShouldPreserveAllTensors() || memory_planned_for_pipeline_,
         kDefaultTensorAlignment);
+    std::vector<int32_t> offline_offsets;
+    if (GetOfflinePlannedOffsets(&offline_offsets)) {
+      arena_planner->SetOfflinePlannedOffsets(std::move(offline_offsets));
+    }
+    arena_planner->SetUseBestFitPlanning(ShouldUseBestFitArenaPlanning());
+    arena_planner->SetPlanCacheSize(ArenaPlanCacheSize());
+    memory_planned_for_concurrent_nodes_ = ShouldUseParallelNodeExecution();
+    arena_planner->SetPlanForConcurrentNodes(
+        memory_planned_for_concurrent_nodes_);
+    memory_planner_ = std::move(arena_planner);
 #endif
     memory_planner_->PlanAllocations();
   }
@@ -1200,6 +1446,20 @@ TfLiteStatus Subgraph::Invoke() {
   }
   TFLITE_SCOPED_TAGGED_DEFAULT_PROFILE(profiler_.get(), "Invoke");
 
+  if (!pipeline_private_tensors_.empty()) EnsurePipelinePlan();
+  if (CanInvokePipelined()) {
+    if (!async_invocations_.empty()) {
+      ReportError("Invoke called with invocations in flight.");
+      return kTfLiteError;
+    }
+    int64_t handle;
+    TF_LITE_ENSURE_STATUS(InvokeAsync(&handle));
+    return Wait(handle);
+  }
+  if (CanInvokeInParallel()) {
+    return InvokeInParallel();
+  }
+
   // Invocations are always done in node order.
   // Note that calling Invoke repeatedly will cause the original memory plan to
   // be reused, unless either ResizeInputTensor() or AllocateTensors() has been
@@ -1220,6 +1480,12 @@ TfLiteStatus Subgraph::Invoke() {
     if (profiler_) op_name = GetTFLiteOpName(registration);
     TFLITE_SCOPED_TAGGED_OPERATOR_PROFILE(profiler_.get(), op_name, node_index);
 
+    if (pipeline_plan_) {
+      for (const auto& copy :
+           pipeline_plan_->ordered_copies_before(execution_plan_index)) {
+        TF_LITE_ENSURE_STATUS(CopyTensorData(copy.first, copy.second));
+      }
+    }
     for (int i = 0; i < node.inputs->size; ++i) {
       int tensor_index = node.inputs->data[i];
       if (tensor_index == kTfLiteOptionalTensor) {
@@ -1267,6 +1533,12 @@ TfLiteStatus Subgraph::Invoke() {
       return ReportOpError(&context_, node, registration, node_index,
                            "failed to invoke");
     }
+    if (pipeline_plan_) {
+      for (const auto& copy :
+           pipeline_plan_->ordered_copies_after(execution_plan_index)) {
+        TF_LITE_ENSURE_STATUS(CopyTensorData(copy.first, copy.second));
+      }
+    }
 
     // Force execution prep for downstream ops if the latest op triggered the
     // resize of a dynamic tensor.
@@ -1294,9 +1566,315 @@ TfLiteStatus Subgraph::Invoke() {
   return status;
 }
 
+bool Subgraph::CanInvokeInParallel() {
+  // Profilers aren't thread safe, and dynamic tensors change the plan while
+  // the nodes run.
+  // The private tensors of delegate kernels are copied between the nodes.
+  return ShouldUseParallelNodeExecution() &&
+         memory_planned_for_concurrent_nodes_ &&
+         pipeline_private_tensors_.empty() && !profiler_ &&
+         !has_dynamic_tensors_ && !ShouldOptimizeMemoryForLargeTensors() &&
+         execution_plan_.size() > 1 &&
+         next_execution_plan_index_to_prepare_ == execution_plan_.size();
+}
+
+std::unique_ptr<NodeDependencies> Subgraph::CreateNodeDependencies() {
+  // Control flow ops invoke other subgraphs, which run one invocation at a
+  // time.
+  std::vector<bool> exclusive_nodes(execution_plan_.size());
+  for (int i = 0; i < execution_plan_.size(); ++i) {
+    const int32_t builtin_code =
+        nodes_and_registration_[execution_plan_[i]].second.builtin_code;
+    exclusive_nodes[i] = builtin_code == kTfLiteBuiltinIf ||
+                         builtin_code == kTfLiteBuiltinWhile ||
+                         builtin_code == kTfLiteBuiltinCallOnce;
+  }
+  return std::make_unique<NodeDependencies>(CreateGraphInfo().get(),
+                                            exclusive_nodes);
+}
+
+ParallelNodeExecutor* Subgraph::GetParallelNodeExecutor(int num_threads) {
+  if (!parallel_node_executor_ ||
+      parallel_node_executor_->num_threads() != num_threads) {
+    parallel_node_executor_ =
+        std::make_unique<ParallelNodeExecutor>(num_threads);
+  }
+  return parallel_node_executor_.get();
+}
+
+TfLiteStatus Subgraph::InvokeInParallel() {
+  ParallelNodeExecutor* executor =
+      GetParallelNodeExecutor(options_->GetParallelNodeExecutionThreads());
+  if (!node_dependencies_) {
+    node_dependencies_ = CreateNodeDependencies();
+  }
+  EnsureTensorsVectorCapacity();
+
+  // Errors are reported once the nodes are done, from this thread.
+  std::atomic<bool> cancelled(false);
+  std::atomic<int> input_without_data(-1);
+  // Copies of delegate buffers into tensors that several nodes read.
+  std::mutex copy_mutex;
+  auto run_node = [&](int execution_plan_index) {
+    TfLiteNode& node =
+        nodes_and_registration_[execution_plan_[execution_plan_index]].first;
+    const TfLiteRegistration& registration =
+        nodes_and_registration_[execution_plan_[execution_plan_index]].second;
+    for (int i = 0; i < node.inputs->size; ++i) {
+      int tensor_index = node.inputs->data[i];
+      if (tensor_index == kTfLiteOptionalTensor) {
+        continue;
+      }
+      TfLiteTensor* tensor = &tensors_[tensor_index];
+      if (tensor->delegate && tensor->delegate != node.delegate) {
+        std::lock_guard<std::mutex> lock(copy_mutex);
+        if (tensor->data_is_stale) {
+          TF_LITE_ENSURE_STATUS(EnsureTensorDataIsReadable(tensor_index));
+        }
+      }
+      // See Invoke() for the exception of the shape input of reshape.
+      if (tensor->data.raw == nullptr && tensor->bytes > 0 &&
+          !(registration.builtin_code == kTfLiteBuiltinReshape && i == 1 &&
+            tensor->dims->size != 1)) {
+        input_without_data = tensor_index;
+        return kTfLiteError;
+      }
+    }
+    if (check_cancelled_func_ != nullptr &&
+        check_cancelled_func_(cancellation_data_)) {
+      cancelled = true;
+      return kTfLiteError;
+    }
+    return OpInvoke(registration, &node);
+  };
+
+  int failed_execution_plan_index = -1;
+  if (executor->Run(*node_dependencies_, run_node,
+                    &failed_execution_plan_index) == kTfLiteOk) {
+    return kTfLiteOk;
+  }
+  if (cancelled) {
+    ReportError("Client requested cancel during Invoke()");
+    return kTfLiteError;
+  }
+  if (input_without_data >= 0) {
+    ReportError("Input tensor %d lacks data", input_without_data.load());
+    return kTfLiteError;
+  }
+  const int node_index = execution_plan_[failed_execution_plan_index];
+  return ReportOpError(&context_, nodes_and_registration_[node_index].first,
+                       nodes_and_registration_[node_index].second, node_index,
+                       "failed to invoke");
+}
+
+void Subgraph::EnsurePipelinePlan() {
+  if (!pipeline_plan_) {
+    pipeline_plan_ = std::make_unique<PipelinePlan>(CreateGraphInfo().get(),
+                                                    pipeline_private_tensors_);
+  }
+}
+
+bool Subgraph::CanInvokePipelined() {
+  // Profilers aren't thread safe, and dynamic tensors change the plan while
+  // the nodes run.
+  return PipelineDepth() > 1 && memory_planned_for_pipeline_ &&
+         pipeline_plan_ && pipeline_plan_->num_stages() > 1 && !profiler_ &&
+         !has_dynamic_tensors_ && !ShouldOptimizeMemoryForLargeTensors() &&
+         next_execution_plan_index_to_prepare_ == execution_plan_.size();
+}
+
+TfLiteStatus Subgraph::InvokeAsync(int64_t* handle) {
+  if (!consistent_) {
+    ReportError("InvokeAsync called on model that is not consistent.");
+    return kTfLiteError;
+  }
+  if (state_ == kStateUninvokable) {
+    ReportError("InvokeAsync called on model that is not ready.");
+    return kTfLiteError;
+  } else if (memory_planner_ && !memory_planner_->HasNonPersistentMemory()) {
+    ReportError("Non-persistent memory is not available.");
+    return kTfLiteError;
+  }
+  if (!pipeline_private_tensors_.empty()) EnsurePipelinePlan();
+
+  AsyncInvocation invocation;
+  if (!CanInvokePipelined()) {
+    if (pipeline_executor_ && pipeline_executor_->num_in_flight() > 0) {
+      ReportError("InvokeAsync can't run with invocations in flight.");
+      return kTfLiteError;
+    }
+    // Runs the invocation right away.
+    invocation.pipelined = false;
+    invocation.status = Invoke();
+  } else {
+    if (!pipeline_executor_) {
+      const int depth = PipelineDepth();
+      std::vector<bool> output_stages(pipeline_plan_->num_stages());
+      for (int i = 0; i < output_stages.size(); ++i) {
+        output_stages[i] = pipeline_plan_->writes_outputs(i);
+      }
+      pipeline_buffers_.clear();
+      for (int tensor_index : pipeline_plan_->buffer_tensors()) {
+        for (int slot = 0; slot < depth; ++slot) {
+          pipeline_buffers_.emplace_back(tensors_[tensor_index].bytes);
+        }
+      }
+      pipeline_errors_.assign(depth, PipelineError());
+      EnsureTensorsVectorCapacity();
+      pipeline_executor_ = std::make_unique<PipelineExecutor>(
+          pipeline_plan_->num_stages(), depth,
+          pipeline_plan_->last_input_stage(), output_stages,
+          [this](int stage, int slot) {
+            return RunPipelineStage(stage, slot);
+          });
+    }
+    if (pipeline_executor_->num_in_flight() == pipeline_executor_->depth()) {
+      ReportError("InvokeAsync called with %d invocations in flight.",
+                  pipeline_executor_->depth());
+      return kTfLiteError;
+    }
+    for (const PipelinePlan::Copy& copy : pipeline_plan_->input_publishes()) {
+      TF_LITE_ENSURE_STATUS(EnsureTensorDataIsReadable(copy.tensor));
+    }
+    invocation.pipelined = true;
+    TF_LITE_ENSURE_STATUS(pipeline_executor_->Start(
+        [this](int slot) {
+          pipeline_errors_[slot] = PipelineError();
+          for (const PipelinePlan::Copy& copy :
+               pipeline_plan_->input_publishes()) {
+            const TfLiteTensor& tensor = tensors_[copy.tensor];
+            memcpy(PipelineBuffer(copy.buffer, slot), tensor.data.raw,
+                   tensor.bytes);
+          }
+        },
+        &invocation.executor_handle));
+  }
+  async_invocations_.push_back(invocation);
+  *handle = num_async_invocations_++;
+  return kTfLiteOk;
+}
+
+TfLiteStatus Subgraph::Wait(int64_t handle) {
+  if (async_invocations_.empty() ||
+      handle != num_async_invocations_ - async_invocations_.size()) {
+    ReportError("Wait called for invocation %lld, which isn't the first one "
+                "in flight.",
+                static_cast<long long>(handle));  // NOLINT(runtime/int)
+    return kTfLiteError;
+  }
+  const AsyncInvocation invocation = async_invocations_.front();
+  async_invocations_.pop_front();
+  if (!invocation.pipelined) return invocation.status;
+
+  int failed_slot = -1;
+  const TfLiteStatus status = pipeline_executor_->Wait(
+      invocation.executor_handle,
+      [this, &failed_slot](int slot) {
+        if (!pipeline_errors_[slot].cancelled &&
+            pipeline_errors_[slot].failed_node < 0 &&
+            pipeline_errors_[slot].input_without_data < 0) {
+          for (const PipelinePlan::Copy& copy :
+               pipeline_plan_->output_fetches()) {
+            TfLiteTensor& tensor = tensors_[copy.tensor];
+            memcpy(tensor.data.raw, PipelineBuffer(copy.buffer, slot),
+                   tensor.bytes);
+          }
+        } else {
+          failed_slot = slot;
+        }
+      },
+      nullptr);
+  if (failed_slot >= 0) return ReportPipelineError(failed_slot);
+  return status;
+}
+
+TfLiteStatus Subgraph::RunPipelineStage(int stage, int slot) {
+  PipelineError& error = pipeline_errors_[slot];
+  for (int execution_plan_index = pipeline_plan_->stage_begin(stage);
+       execution_plan_index < pipeline_plan_->stage_end(stage);
+       ++execution_plan_index) {
+    TfLiteNode& node =
+        nodes_and_registration_[execution_plan_[execution_plan_index]].first;
+    const TfLiteRegistration& registration =
+        nodes_and_registration_[execution_plan_[execution_plan_index]].second;
+    for (const PipelinePlan::Copy& copy :
+         pipeline_plan_->fetches(execution_plan_index)) {
+      TfLiteTensor& tensor = tensors_[copy.tensor];
+      memcpy(tensor.data.raw, PipelineBuffer(copy.buffer, slot), tensor.bytes);
+    }
+    for (int i = 0; i < node.inputs->size; ++i) {
+      int tensor_index = node.inputs->data[i];
+      if (tensor_index == kTfLiteOptionalTensor) {
+        continue;
+      }
+      TfLiteTensor* tensor = &tensors_[tensor_index];
+      if (tensor->delegate && tensor->delegate != node.delegate &&
+          tensor->data_is_stale) {
+        TF_LITE_ENSURE_STATUS(EnsureTensorDataIsReadable(tensor_index));
+      }
+      // See Invoke() for the exception of the shape input of reshape.
+      if (tensor->data.raw == nullptr && tensor->bytes > 0 &&
+          !(registration.builtin_code == kTfLiteBuiltinReshape && i == 1 &&
+            tensor->dims->size != 1)) {
+        error.input_without_data = tensor_index;
+        return kTfLiteError;
+      }
+    }
+    if (check_cancelled_func_ != nullptr &&
+        check_cancelled_func_(cancellation_data_)) {
+      error.cancelled = true;
+      return kTfLiteError;
+    }
+    if (OpInvoke(registration, &node) != kTfLiteOk) {
+      error.failed_node = execution_plan_index;
+      return kTfLiteError;
+    }
+    for (const PipelinePlan::Copy& copy :
+         pipeline_plan_->publishes(execution_plan_index)) {
+      TF_LITE_ENSURE_STATUS(EnsureTensorDataIsReadable(copy.tensor));
+      const TfLiteTensor& tensor = tensors_[copy.tensor];
+      memcpy(PipelineBuffer(copy.buffer, slot), tensor.data.raw, tensor.bytes);
+    }
+  }
+  return kTfLiteOk;
+}
+
+TfLiteStatus Subgraph::ReportPipelineError(int slot) {
+  const PipelineError& error = pipeline_errors_[slot];
+  if (error.cancelled) {
+    ReportError("Client requested cancel during Invoke()");
+    return kTfLiteError;
+  }
+  if (error.input_without_data >= 0) {
+    ReportError("Input tensor %d lacks data", error.input_without_data);
+    return kTfLiteError;
+  }
+  const int node_index = execution_plan_[error.failed_node];
+  return ReportOpError(&context_, nodes_and_registration_[node_index].first,
+                       nodes_and_registration_[node_index].second, node_index,
+                       "failed to invoke");
+}
+
+TfLiteStatus Subgraph::CopyTensorData(int from, int to) {
+  TF_LITE_ENSURE_STATUS(EnsureTensorDataIsReadable(from));
+  const TfLiteTensor& from_tensor = tensors_[from];
+  TfLiteTensor& to_tensor = tensors_[to];
+  TF_LITE_ENSURE_EQ(&context_, from_tensor.bytes, to_tensor.bytes);
+  if (from_tensor.bytes > 0) {
+    TF_LITE_ENSURE(&context_, from_tensor.data.raw != nullptr &&
+                                  to_tensor.data.raw != nullptr);
+    memcpy(to_tensor.data.raw, from_tensor.data.raw, from_tensor.bytes);
+  }
+  return kTfLiteOk;
+}
+
 TfLiteStatus Subgraph::ResizeTensor(TfLiteContext* context,
                                     TfLiteTensor* tensor,
                                     TfLiteIntArray* new_size) {
+  auto* subgraph = static_cast<Subgraph*>(context->impl_);
+  std::unique_lock<std::mutex> lock(subgraph->parallel_prepare_mutex_,
+                                    std::defer_lock);
+  if (subgraph->preparing_in_parallel_) lock.lock();
   // If the dimensions don't change, avoiding
   // unnecessary (re)allocations.
   //
@@ -1316,8 +1894,7 @@ TfLiteStatus Subgraph::ResizeTensor(TfLiteContext* context,
   // Note here that context->impl_ is recovering the this pointer for an
   // instance of Interpreter to call into the member function ResizeTensorImpl
   // (this function is static).
-  return static_cast<Subgraph*>(context->impl_)
-      ->ResizeTensorImpl(tensor, new_size);
+  return subgraph->ResizeTensorImpl(tensor, new_size);
 }
 
 void Subgraph::ReportErrorImpl(const char* format, va_list args) {
@@ -1328,6 +1905,9 @@ void Subgraph::ReportErrorC(TfLiteContext* context, const char* format, ...) {
   va_list args;
   va_start(args, format);
   auto* f = static_cast<Subgraph*>(context->impl_);
+  std::unique_lock<std::mutex> lock(f->parallel_prepare_mutex_,
+                                    std::defer_lock);
+  if (f->preparing_in_parallel_) lock.lock();
   // Note here that context->impl_ is recovering the this pointer for an
   // instance of Subgraph to call into the member function ReportErrorImpl
   // (this function is static).
@@ -1356,18 +1936,31 @@ TfLiteStatus Subgraph::AddTensors(int tensors_to_add,
     memset(&tensors_[i], 0, sizeof(tensors_[i]));
     tensors_[i].buffer_handle = kTfLiteNullBufferHandle;
   }
-  context_.tensors = tensors_.data();
+  // The kernels prepared in parallel read the pointer while this runs.
+  if (context_.tensors != tensors_.data()) context_.tensors = tensors_.data();
   context_.tensors_size = tensors_.size();
   return kTfLiteOk;
 }
 
 TfLiteStatus Subgraph::AddTensors(TfLiteContext* context, int tensors_to_add,
                                   int* first_new_tensor_index) {
+  auto* subgraph = static_cast<Subgraph*>(context->impl_);
+  std::unique_lock<std::mutex> lock(subgraph->parallel_prepare_mutex_,
+                                    std::defer_lock);
+  if (subgraph->preparing_in_parallel_) {
+    lock.lock();
+    // The other nodes being prepared hold pointers to the tensors.
+    if (subgraph->tensors_.size() + tensors_to_add >
+        subgraph->tensors_.capacity()) {
+      subgraph->ReportError(
+          "Too many tensors added while preparing nodes in parallel.");
+      return kTfLiteError;
+    }
+  }
   // Note here that context->impl_ is recovering the this pointer for an
   // instance of Interpreter to call into the member function AddTensors
   // (this function is static).
-  return static_cast<Subgraph*>(context->impl_)
-      ->AddTensors(tensors_to_add, first_new_tensor_index);
+  return subgraph->AddTensors(tensors_to_add, first_new_tensor_index);
 }
 
 TfLiteStatus Subgraph::GetNodeAndRegistration(
@@ -1501,6 +2094,8 @@ TfLiteStatus Subgraph::SetExecutionPlan(const std::vector<int>& new_plan) {
                                   node_index < nodes_and_registration_.size());
   }
   execution_plan_ = new_plan;
+  pipeline_plan_.reset();
+  pipeline_executor_.reset();
   return kTfLiteOk;
 }
 
@@ -1614,6 +2209,7 @@ TfLiteStatus Subgraph::UndoAllDelegates() {
   // Reset execution plan.
   execution_plan_ = pre_delegation_execution_plan_;
   pre_delegation_execution_plan_.clear();
+  RestorePrivateBoundaryTensors();
 
   // Handling FP16 delegation (if applies).
   //
@@ -1856,6 +2452,15 @@ TfLiteStatus Subgraph::SetCustomAllocationForTensor(
     const intptr_t data_ptr_value = reinterpret_cast<intptr_t>(allocation.data);
     TF_LITE_ENSURE(context(), data_ptr_value % kDefaultTensorAlignment == 0);
   }
+  // Once the tensors are allocated, the size of the tensor is known unless it
+  // is dynamic, and the allocation takes effect without AllocateTensors().
+  if (state_ != kStateUninvokable && tensor->bytes > allocation.bytes &&
+      tensor->allocation_type != kTfLiteDynamic) {
+    TF_LITE_KERNEL_LOG(context(),
+                       "Custom allocation is too small for tensor idx: %d",
+                       tensor_index);
+    return kTfLiteError;
+  }
 
   const auto iter_and_success =
       custom_allocations_.insert({tensor_index, allocation});
@@ -20,10 +20,13 @@ limitations under the License.
 
 #include <cstdint>
 #include <cstdlib>
+#include <deque>
 #include <map>
 #include <memory>
+#include <mutex>  // NOLINT(build/c++11)
 #include <set>
 #include <string>
+#include <unordered_map>
 #include <utility>
 #include <vector>
 
@@ -37,6 +40,10 @@ limitations under the License.
 #include "tensorflow/lite/graph_info.h"
 #include "tensorflow/lite/interpreter_options.h"
 #include "tensorflow/lite/memory_planner.h"
+#include "tensorflow/lite/node_dependencies.h"
+#include "tensorflow/lite/parallel_node_executor.h"
+#include "tensorflow/lite/pipeline_executor.h"
+#include "tensorflow/lite/pipeline_plan.h"
 #include "tensorflow/lite/util.h"
 
 namespace tflite {
@@ -251,6 +258,19 @@ class Subgraph {
   // Returns status of success or failure.
   TfLiteStatus Invoke();
 
+  // Starts an invocation of the subgraph and stores its handle in `handle`.
+  // With `InterpreterOptions::SetPipelineDepth()`, the invocation runs in the
+  // background, and the call returns once the inputs may be overwritten.
+  // Otherwise the invocation runs before the call returns.
+  // WARNING: This is an experimental API and subject to change.
+  TfLiteStatus InvokeAsync(int64_t* handle);
+
+  // Waits for the invocation of `handle`, which must be the first one started
+  // by InvokeAsync() that wasn't waited for, and returns its status. The
+  // outputs hold its results until the next call to Wait() or Invoke().
+  // WARNING: This is an experimental API and subject to change.
+  TfLiteStatus Wait(int64_t handle);
+
   // Entry point for C node plugin API to report an error.
   void ReportError(const char* format, ...);
 
@@ -334,7 +354,11 @@ class Subgraph {
   // `flags` is a bitmask, see TfLiteCustomAllocationFlags.
   // The runtime does NOT take ownership of the underlying memory.
   //
-  // NOTE: User needs to call AllocateTensors() after this.
+  // NOTE: User needs to call AllocateTensors() after this, unless the tensors
+  // are already allocated and no input was resized since. In that case the
+  // size of the allocation is checked here and the tensor uses it from the
+  // next Invoke() on, without replanning the arena, so that e.g. a new
+  // camera frame can be bound to an input before every Invoke().
   // Invalid/insufficient buffers will cause an error during AllocateTensors or
   // Invoke (in case of dynamic shapes in the graph).
   //
@@ -387,6 +411,40 @@ class Subgraph {
     return (options_ && options_->GetEnsureDynamicTensorsAreReleased());
   }
 
+  // WARNING: This is an experimental API and subject to change.
+  // True if the arena should also be planned with best fit placements.
+  bool ShouldUseBestFitArenaPlanning() const {
+    return (options_ && options_->GetBestFitArenaPlanning());
+  }
+
+  // WARNING: This is an experimental API and subject to change.
+  // The number of arena plans to cache, see
+  // `InterpreterOptions::SetArenaPlanCacheSize`.
+  int ArenaPlanCacheSize() const {
+    return options_ ? options_->GetArenaPlanCacheSize() : 0;
+  }
+
+  // WARNING: This is an experimental API and subject to change.
+  // True if the nodes that don't depend on each other should run at the same
+  // time.
+  bool ShouldUseParallelNodeExecution() const {
+    return (options_ && options_->GetParallelNodeExecutionThreads() > 1);
+  }
+
+  // WARNING: This is an experimental API and subject to change.
+  // True if the nodes that don't depend on each other should be prepared at
+  // the same time.
+  bool ShouldPrepareInParallel() const {
+    return (options_ && options_->GetParallelPrepareThreads() > 1);
+  }
+
+  // WARNING: This is an experimental API and subject to change.
+  // The number of invocations in flight of the pipeline of delegate and CPU
+  // partitions, see `InterpreterOptions::SetPipelineDepth`.
+  int PipelineDepth() const {
+    return options_ ? options_->GetPipelineDepth() : 0;
+  }
+
   /// WARNING: This is an experimental API and subject to change.
   /// Use dynamic tensor allocation and deallocation method for large tensors
   /// instead of static memory planner. Dynamic tensors are allocated just
@@ -493,6 +551,53 @@ class Subgraph {
   // to wait until Invoke() to resolve the sizes of dynamic tensors.
   TfLiteStatus PrepareOpsAndTensors();
 
+  // Returns whether Invoke() can run the nodes with InvokeInParallel(), i.e.
+  // parallel node execution is enabled and all the nodes are prepared, without
+  // dynamic tensors.
+  bool CanInvokeInParallel();
+
+  // Runs the nodes of the execution plan on parallel_node_executor_, each node
+  // once the nodes it depends on are done.
+  TfLiteStatus InvokeInParallel();
+
+  // Gives the delegate kernel of `node_subset` private copies of the tensors
+  // at the boundary of the partition, so that it can run at the same time as
+  // the other partitions on other invocations. Updates the tensors of the
+  // subset and of its nodes.
+  TfLiteStatus UsePrivateBoundaryTensors(NodeSubset* node_subset);
+
+  // Makes the nodes use the tensors of pipeline_private_tensors_ again, and
+  // forgets them.
+  void RestorePrivateBoundaryTensors();
+
+  // Resizes the private tensors that `node` reads to the tensors they stand
+  // for, or, if `outputs`, the tensors that its private outputs stand for.
+  TfLiteStatus ResizePrivateBoundaryTensors(const TfLiteNode& node,
+                                            bool outputs);
+
+  // Builds pipeline_plan_ if there is none.
+  void EnsurePipelinePlan();
+
+  // Returns whether InvokeAsync() can run the stages of pipeline_plan_ on
+  // pipeline_executor_, i.e. the pipeline is enabled and all the nodes are
+  // prepared, without dynamic tensors.
+  bool CanInvokePipelined();
+
+  // Runs the nodes of `stage` of pipeline_plan_ for the invocation in `slot`.
+  TfLiteStatus RunPipelineStage(int stage, int slot);
+
+  // Reports the error of the invocation in `slot` of pipeline_executor_.
+  TfLiteStatus ReportPipelineError(int slot);
+
+  // Copies the data of tensor `from` into tensor `to`.
+  TfLiteStatus CopyTensorData(int from, int to);
+
+  // Returns the slot of `buffer` of pipeline_plan_.
+  char* PipelineBuffer(int buffer, int slot) {
+    return pipeline_buffers_[buffer * pipeline_executor_->depth() + slot]
+        .data();
+  }
+
   // Call OpPrepare() for all ops starting at 'first_node'. Stop when a
   // dynamic tensors is found or all ops have been prepared. Fill
   // 'last_node_prepared' with the id of the op containing dynamic tensors, or
@@ -501,6 +606,20 @@ class Subgraph {
                                     const std::vector<int>& execution_plan,
                                     int* last_execution_plan_index_prepared);
 
+  // Same as PrepareOpsStartingAt() for `execution_plan_`, but prepares the
+  // nodes on GetParallelNodeExecutor(), each node once the nodes it depends on
+  // are prepared. The nodes that depend on a node with dynamic outputs aren't
+  // prepared.
+  TfLiteStatus PrepareOpsInParallel(int first_execution_plan_index,
+                                    int* last_execution_plan_index_prepared);
+
+  // Returns the dependencies between the nodes of `execution_plan_`, with the
+  // control flow ops exclusive.
+  std::unique_ptr<NodeDependencies> CreateNodeDependencies();
+
+  // Returns parallel_node_executor_, (re)created with `num_threads` threads.
+  ParallelNodeExecutor* GetParallelNodeExecutor(int num_threads);
+
   // Tensors needed by the interpreter. Use `AddTensors` to add more blank
   // tensor entries. Note, `tensors_.data()` needs to be synchronized to the
   // `context_` whenever this std::vector is reallocated. Currently this
@@ -606,6 +725,11 @@ class Subgraph {
   TfLiteStatus GetModelMetadata(const char* name, const char** ptr,
                                 size_t* bytes);
 
+  // Reads the kTfLiteArenaRw offsets of this subgraph from the
+  // kOfflineMemoryAllocationMetadata metadata of the model. Returns false if
+  // the model doesn't plan this subgraph ahead of time.
+  bool GetOfflinePlannedOffsets(std::vector<int32_t>* offsets);
+
   // Entry point for C node plugin API to get model metadata based on name.
   static TfLiteStatus GetModelMetadata(const struct TfLiteContext* context,
                                        const char* name, const char** ptr,
@@ -816,6 +940,58 @@ class Subgraph {
 
   std::unique_ptr<MemoryPlanner> memory_planner_;
 
+  // Whether memory_planner_ lets nodes run at the same time as the nodes they
+  // don't depend on.
+  bool memory_planned_for_concurrent_nodes_ = false;
+
+  // The dependencies between the nodes of the execution plan, which
+  // InvokeInParallel() builds and PrepareOpsAndTensors() resets.
+  std::unique_ptr<NodeDependencies> node_dependencies_;
+
+  // Runs the nodes in InvokeInParallel() and PrepareOpsInParallel().
+  std::unique_ptr<ParallelNodeExecutor> parallel_node_executor_;
+
+  // Set while PrepareOpsInParallel() runs, when the context functions that
+  // the kernels call in Prepare lock parallel_prepare_mutex_.
+  bool preparing_in_parallel_ = false;
+  std::mutex parallel_prepare_mutex_;
+
+  // Maps the private tensors that delegate kernels use, with a pipeline depth
+  // above 1, to the tensors they stand for.
+  std::unordered_map<int, int> pipeline_private_tensors_;
+
+  // Whether memory_planner_ doesn't share memory between tensors, so that the
+  // stages of the pipeline can run at the same time.
+  bool memory_planned_for_pipeline_ = false;
+
+  // The stages of the execution plan and the copies between the private
+  // tensors and the tensors they stand for, which EnsurePipelinePlan() builds
+  // and AllocateTensors() resets.
+  std::unique_ptr<PipelinePlan> pipeline_plan_;
+
+  // Runs the stages in InvokeAsync(), with pipeline_buffers_, which holds a
+  // slot for each invocation in flight of each buffer of pipeline_plan_.
+  std::unique_ptr<PipelineExecutor> pipeline_executor_;
+  std::vector<std::vector<char>> pipeline_buffers_;
+
+  // The error of the invocation in each slot of pipeline_executor_.
+  struct PipelineError {
+    int failed_node = -1;
+    int input_without_data = -1;
+    bool cancelled = false;
+  };
+  std::vector<PipelineError> pipeline_errors_;
+
+  // The invocations started by InvokeAsync() and not waited for, with the
+  // handle of pipeline_executor_ or, if they ran in InvokeAsync(), the status.
+  struct AsyncInvocation {
+    bool pipelined;
+    int64_t executor_handle;
+    TfLiteStatus status;
+  };
+  std::deque<AsyncInvocation> async_invocations_;
+  int64_t num_async_invocations_ = 0;
+
   // Maps tensor index to custom allocation for all applicable tensors.
   std::map<int, TfLiteCustomAllocation> custom_allocations_;
 
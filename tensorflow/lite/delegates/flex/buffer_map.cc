@@ -47,10 +47,10 @@ const tensorflow::Tensor* BufferMap::GetTensorPtr(int tensor_index) const {
 }
 
 void BufferMap::SetFromTfLite(int tensor_index, const TfLiteTensor* tensor,
-                              bool allow_reusing) {
-  TFLITE_CHECK(
-      SetTfTensorFromTfLite(tensor, &id_to_tensor_[tensor_index], allow_reusing)
-          .ok());
+                              bool allow_reusing, bool reuse_arena_memory) {
+  TFLITE_CHECK(SetTfTensorFromTfLite(tensor, &id_to_tensor_[tensor_index],
+                                     allow_reusing, reuse_arena_memory)
+                   .ok());
   if (IsResourceOrVariant(tensor)) {
     owned_by_tf_.insert(tensor_index);
     return;
@@ -60,9 +60,12 @@ class BufferMap {
   // Same as above but creates a new tensorflow::Tensor with a copy of the
   // given TfLiteTensor's data. If `allow_reusing=false`, then we explicitly
   // disallow reusing the TF Lite tensor buffer when constructing the new
-  // tensorflow Tensor.
+  // tensorflow Tensor. If `reuse_arena_memory=true`, the buffer of an arena
+  // tensor is reused too, and the tensorflow::Tensor must not be read once the
+  // arena memory is reused by other tensors.
   void SetFromTfLite(int tensor_index, const TfLiteTensor* tensor,
-                     bool allow_reusing = true);
+                     bool allow_reusing = true,
+                     bool reuse_arena_memory = false);
 
  private:
   // Mapping from TL Lite tensor ID to TensorFlow's Tensor. All tensors that
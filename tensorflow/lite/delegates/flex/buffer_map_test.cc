@@ -288,6 +288,31 @@ TEST(BufferMapTest, ExplicitlyDisableBufferReuse) {
   TfLiteTensorDataFree(&tensor);
 }
 
+TEST(BufferMapTest, ArenaBufferReuse) {
+  alignas(EIGEN_MAX_ALIGN_BYTES) char arena[16];
+  TfLiteTensor tensor = {};
+  tensor.allocation_type = kTfLiteArenaRw;
+  tensor.data.raw = arena;
+  tensor.bytes = sizeof(arena);
+
+  // Arena buffers are only reused when explicitly requested.
+  TfLiteTensorBuffer* tensor_buffer = new TfLiteTensorBuffer(&tensor);
+  EXPECT_FALSE(tensor_buffer->BufferReusedFromTfLiteTensor());
+  EXPECT_NE(tensor_buffer->data(), tensor.data.raw);
+  tensor_buffer->Unref();
+
+  tensor_buffer = new TfLiteTensorBuffer(&tensor, /*allow_reusing=*/true,
+                                         /*reuse_arena_memory=*/true);
+  EXPECT_TRUE(tensor_buffer->BufferReusedFromTfLiteTensor());
+  EXPECT_EQ(tensor_buffer->data(), tensor.data.raw);
+  tensor_buffer->Unref();
+
+  tensor_buffer = new TfLiteTensorBuffer(&tensor, /*allow_reusing=*/false,
+                                         /*reuse_arena_memory=*/true);
+  EXPECT_FALSE(tensor_buffer->BufferReusedFromTfLiteTensor());
+  tensor_buffer->Unref();
+}
+
 }  // namespace
 }  // namespace flex
 }  // namespace tflite
@@ -31,16 +31,18 @@ namespace flex {
 namespace {
 // Returns a boolean to indicate whether we should reuse memory from the
 // TfLiteTensor.
-inline bool ShouldReuseTensorMemory(const TfLiteTensor* tensor) {
+inline bool ShouldReuseTensorMemory(const TfLiteTensor* tensor,
+                                    bool reuse_arena_memory) {
   // TODO(b/205153246): Currently arena-alloated memory could not be reused
   // since it might be invalid after the original arena grow in size and copied
-  // over to a new memory block.
+  // over to a new memory block, unless the caller only uses the buffer while
+  // the arena memory is valid.
   // First check alignment is consistent with Tensorflow.
   if (EIGEN_MAX_ALIGN_BYTES != 0 &&
       reinterpret_cast<intptr_t>(tensor->data.raw) % EIGEN_MAX_ALIGN_BYTES) {
     return false;
   }
-  return tensor->allocation_type != kTfLiteArenaRw;
+  return reuse_arena_memory || tensor->allocation_type != kTfLiteArenaRw;
 }
 }  // namespace
 
@@ -69,8 +71,9 @@ void BaseTfLiteTensorBuffer::LogDeallocation() {
 }
 
 void* TfLiteTensorBuffer::MaybeAllocateTensorflowBuffer(
-    const TfLiteTensor* tensor, bool allow_reusing) const {
-  if (allow_reusing && ShouldReuseTensorMemory(tensor)) {
+    const TfLiteTensor* tensor, bool allow_reusing,
+    bool reuse_arena_memory) const {
+  if (allow_reusing && ShouldReuseTensorMemory(tensor, reuse_arena_memory)) {
     return tensor->data.raw;
   }
   return tensorflow::cpu_allocator()->AllocateRaw(EIGEN_MAX_ALIGN_BYTES,
@@ -78,12 +81,14 @@ void* TfLiteTensorBuffer::MaybeAllocateTensorflowBuffer(
 }
 
 TfLiteTensorBuffer::TfLiteTensorBuffer(const TfLiteTensor* tensor,
-                                       bool allow_reusing)
-    : BaseTfLiteTensorBuffer(
-          MaybeAllocateTensorflowBuffer(tensor, allow_reusing)) {
+                                       bool allow_reusing,
+                                       bool reuse_arena_memory)
+    : BaseTfLiteTensorBuffer(MaybeAllocateTensorflowBuffer(
+          tensor, allow_reusing, reuse_arena_memory)) {
   len_ = tensor->bytes;
 
-  reused_buffer_from_tflite_ = allow_reusing && ShouldReuseTensorMemory(tensor);
+  reused_buffer_from_tflite_ =
+      allow_reusing && ShouldReuseTensorMemory(tensor, reuse_arena_memory);
 
   if (data() && !reused_buffer_from_tflite_) {
     LogAllocation();
@@ -133,7 +138,8 @@ StringTfLiteTensorBuffer::StringTfLiteTensorBuffer(const TfLiteTensor* tensor,
 
 tensorflow::Status SetTfTensorFromTfLite(const TfLiteTensor* tensor,
                                          tensorflow::Tensor* tf_tensor,
-                                         bool allow_reusing) {
+                                         bool allow_reusing,
+                                         bool reuse_arena_memory) {
   if (resource::IsBuiltinResource(tensor)) {
     // If this is native TF Lite resource variable, then we create a TF resource
     // tensor where the tensor handle encodes the identifier of the TF Lite
@@ -181,7 +187,7 @@ tensorflow::Status SetTfTensorFromTfLite(const TfLiteTensor* tensor,
   if (tensor->type == kTfLiteString) {
     buf = new StringTfLiteTensorBuffer(tensor);
   } else {
-    buf = new TfLiteTensorBuffer(tensor, allow_reusing);
+    buf = new TfLiteTensorBuffer(tensor, allow_reusing, reuse_arena_memory);
   }
   tensorflow::Tensor t = tensorflow::TensorCApi::MakeTensor(
       GetTensorFlowDataType(tensor->type), shape, buf);
@@ -48,9 +48,12 @@ class BaseTfLiteTensorBuffer : public tensorflow::TensorBuffer {
 class TfLiteTensorBuffer : public BaseTfLiteTensorBuffer {
  public:
   // If `allow_reusing=false`, then the tensor buffer won't be reused from the
-  // TfLiteTensor.
+  // TfLiteTensor. Buffers in the arena are only reused if
+  // `reuse_arena_memory=true`, in which case this TensorBuffer must not be
+  // read once the arena memory is reused by other tensors or reallocated.
   explicit TfLiteTensorBuffer(const TfLiteTensor* tensor,
-                              bool allow_reusing = true);
+                              bool allow_reusing = true,
+                              bool reuse_arena_memory = false);
 
   ~TfLiteTensorBuffer() override;
 
@@ -67,7 +70,8 @@ class TfLiteTensorBuffer : public BaseTfLiteTensorBuffer {
   // TODO(b/205153246): Also consider reusing memory to avoid copying from
   // tensorflow::Tensor to TfLiteTensor.
   void* MaybeAllocateTensorflowBuffer(const TfLiteTensor* tensor,
-                                      bool allow_reusing) const;
+                                      bool allow_reusing,
+                                      bool reuse_arena_memory = false) const;
 
  private:
   size_t len_;
@@ -94,10 +98,12 @@ class StringTfLiteTensorBuffer : public BaseTfLiteTensorBuffer {
 
 // Sets the `tensorflow::Tensor` content from `TfLiteTensor` object. If
 // `allow_reusing=false`, then we explicitly disallow reusing the TF Lite
-// tensor buffer when constructing the new tensorflow Tensor.
+// tensor buffer when constructing the new tensorflow Tensor. See
+// TfLiteTensorBuffer for `reuse_arena_memory`.
 tensorflow::Status SetTfTensorFromTfLite(const TfLiteTensor* tensor,
                                          tensorflow::Tensor* tf_tensor,
-                                         bool allow_reusing = true);
+                                         bool allow_reusing = true,
+                                         bool reuse_arena_memory = false);
 
 }  // namespace flex
 }  // namespace tflite
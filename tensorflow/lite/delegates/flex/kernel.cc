@@ -26,6 +26,7 @@ limitations under the License.
 #include "tensorflow/core/common_runtime/eager/context.h"
 #include "tensorflow/core/framework/node_def.pb.h"
 #include "tensorflow/core/framework/node_def_util.h"
+#include "tensorflow/core/framework/tensor_util.h"
 #include "tensorflow/core/lib/core/errors.h"
 #include "tensorflow/core/platform/status.h"
 #include "tensorflow/core/protobuf/error_codes.pb.h"
@@ -177,6 +178,9 @@ struct OpDataInfo {
   // For output tensors that don't need to be preserved in the BufferMap, we
   // copy them to TF Lite tensors and keep the tensor indexes in this set.
   std::set<int> already_transferred_outputs;
+  // The arena buffers that the inputs given to TensorFlow reuse in the current
+  // Eval(), as [begin, end) ranges.
+  std::vector<std::pair<const char*, const char*>> borrowed_arena_buffers;
 };
 
 // A single node within the larger 'op'. Note that this kernel executes many
@@ -291,6 +295,18 @@ class OpNode {
     return ::tensorflow::OkStatus();
   }
 
+  // Decides which outputs of the subgraph are preserved in the buffer map,
+  // once the tensor types and lifetimes are known, so that Eval() doesn't have
+  // to look them up.
+  void InitializePersistedOutputs(TfLiteContext* context,
+                                  const OpDataInfo* shared_info) {
+    persisted_outputs_.resize(outputs_.Size());
+    for (int i = 0; i < outputs_.Size(); ++i) {
+      persisted_outputs_[i] = ShouldPersistTensorflowTensor(
+          context, shared_info, outputs_.TfLiteIndex(i), index_);
+    }
+  }
+
   // Returns whether an output tensor should be preserved in the buffer map by
   // checking its lifetime information.
   // The eager tensor doesn't need to be persisted in the buffer map if it has
@@ -352,13 +368,17 @@ class OpNode {
         tensorflow::Tensor& tf_tensor = tensors->at(i);
         const int tflite_index = outputs_.TfLiteIndex(i);
         TfLiteTensor* tensor = &context->tensors[tflite_index];
-        if (!ShouldPersistTensorflowTensor(context, shared_info, tflite_index,
-                                           node_index)) {
+        if (!persisted_outputs_[i]) {
           if (CopyToTfLiteTensor(context, shared_info, tensor, &tf_tensor,
                                  tflite_index) != kTfLiteOk) {
             return tensorflow::Status(tensorflow::error::INTERNAL,
                                       "failed to copy data from TF tensor");
           }
+        } else if (AliasesBorrowedArenaBuffer(shared_info, tf_tensor)) {
+          // Outputs such as the one of Identity can share the buffer of an
+          // input, which the arena may reuse after this Eval().
+          shared_info->buffer_map->SetFromTensorFlow(
+              outputs_.TfLiteIndex(i), tensorflow::tensor::DeepCopy(tf_tensor));
         } else {
           shared_info->buffer_map->SetFromTensorFlow(outputs_.TfLiteIndex(i),
                                                      tf_tensor);
@@ -372,6 +392,19 @@ class OpNode {
   OpNode(const OpNode&) = delete;
   OpNode& operator=(const OpNode&) = delete;
 
+  static bool AliasesBorrowedArenaBuffer(const OpDataInfo* shared_info,
+                                         const tensorflow::Tensor& tf_tensor) {
+    if (shared_info->borrowed_arena_buffers.empty() ||
+        !tensorflow::DataTypeCanUseMemcpy(tf_tensor.dtype())) {
+      return false;
+    }
+    const char* data = tf_tensor.tensor_data().data();
+    for (const auto& buffer : shared_info->borrowed_arena_buffers) {
+      if (data >= buffer.first && data < buffer.second) return true;
+    }
+    return false;
+  }
+
   // The name of the TensorFlow op to execute.
   string name_;
   // Index of this node into TF Lite's operator list.
@@ -384,6 +417,9 @@ class OpNode {
   OpInputs inputs_;
   // List of outputs, as TF Lite tensor indices.
   OpOutputs outputs_;
+  // Whether each output that is an output of the subgraph is preserved in the
+  // buffer map, or copied to its TF Lite tensor.
+  std::vector<bool> persisted_outputs_;
 
   tensorflow::tfrt_stub::OpKernelRunner op_kernel_runner_;
 };
@@ -399,7 +435,13 @@ struct OpData {
       disable_reusing_buffer_tensors;  // A list of input tensor indexes which
                                        // input buffer should not be reused by
                                        // tensorflow::Tensor.
+  // Whether the inputs in the arena are given to TensorFlow without a copy.
+  // This is only done when no op of the subgraph is stateful, so that no
+  // kernel keeps a reference to them past Eval().
+  bool borrow_arena_inputs = false;
   OpDataInfo shared_info;
+  // Reused across the ops and the calls to Eval().
+  tensorflow::tfrt_stub::OpKernelRunState run_state;
 };
 
 tensorflow::Status DelegateKernel::ExecuteOpKernelRunner(
@@ -602,11 +644,16 @@ TfLiteStatus DelegateKernel::Prepare(TfLiteContext* context, TfLiteNode* node) {
   // All tensors that are referenced exactly once are marked as "forwardable",
   // meaning that we will allow TensorFlow to reuse its buffer as the output of
   // an op.
+  op_data_->borrow_arena_inputs = true;
   for (auto& node_data : op_data_->nodes) {
     for (int i = 0; i < node_data->inputs().Size(); ++i) {
       bool f = (tensor_ref_count[node_data->inputs().TfLiteIndex(i)] == 1);
       node_data->mutable_inputs()->SetForwardable(i, f);
     }
+    node_data->InitializePersistedOutputs(context, &op_data_->shared_info);
+    if (node_data->op_reg_data()->op_def.is_stateful()) {
+      op_data_->borrow_arena_inputs = false;
+    }
   }
 
   return kTfLiteOk;
@@ -710,6 +757,8 @@ TfLiteStatus DelegateKernel::Eval(TfLiteContext* context, TfLiteNode* node) {
 
   // Insert a tensor in the buffer map for all inputs that are not constant.
   // Constants were handled in Prepare() already.
+  auto& borrowed_arena_buffers = op_data_->shared_info.borrowed_arena_buffers;
+  borrowed_arena_buffers.clear();
   for (auto tensor_index : op_data_->subgraph_inputs) {
     TfLiteTensor* tensor = &context->tensors[tensor_index];
     if (!IsConstantTensor(tensor)) {
@@ -717,9 +766,17 @@ TfLiteStatus DelegateKernel::Eval(TfLiteContext* context, TfLiteNode* node) {
       // to the BufferMap again, because TF already knows about it and its
       // contents are kept automatically up-to-date.
       if (!tensor->data_is_stale || !buffer_map->HasTensor(tensor_index)) {
-        buffer_map->SetFromTfLite(
-            tensor_index, tensor,
-            !op_data_->disable_reusing_buffer_tensors.count(tensor_index));
+        const bool allow_reusing =
+            !op_data_->disable_reusing_buffer_tensors.count(tensor_index);
+        buffer_map->SetFromTfLite(tensor_index, tensor, allow_reusing,
+                                  op_data_->borrow_arena_inputs);
+        if (allow_reusing && op_data_->borrow_arena_inputs &&
+            tensor->allocation_type == kTfLiteArenaRw &&
+            buffer_map->GetTensorPtr(tensor_index)->tensor_data().data() ==
+                tensor->data.raw) {
+          borrowed_arena_buffers.emplace_back(
+              tensor->data.raw_const, tensor->data.raw_const + tensor->bytes);
+        }
       }
     }
   }
@@ -727,7 +784,7 @@ TfLiteStatus DelegateKernel::Eval(TfLiteContext* context, TfLiteNode* node) {
   auto& eager_context = *op_data_->eager_context;
 
   {
-    tensorflow::tfrt_stub::OpKernelRunState run_state;
+    auto& run_state = op_data_->run_state;
 
     run_state.params.step_container = eager_context.StepContainer();
     auto* device = eager_context.local_device_mgr()->HostCPU();
@@ -756,6 +813,8 @@ TfLiteStatus DelegateKernel::Eval(TfLiteContext* context, TfLiteNode* node) {
       auto status = ExecuteOpKernelRunner(&run_state, context, node_data.get());
       TF_LITE_ENSURE_OK(context, ConvertStatus(context, status));
     }
+    // Don't hold on to the inputs of the last op until the next Eval().
+    for (auto& tensor : run_state.input_tf_tensors) tensor = {};
   }
 
   for (auto tensor_index : op_data_->subgraph_outputs) {
@@ -362,6 +362,11 @@ std::string CLDevice::GetPlatformVersion() const {
   return GetPlatformInfo(platform_id_, CL_PLATFORM_VERSION);
 }
 
+std::string CLDevice::GetDriverFingerprint() const {
+  return absl::StrCat(GetPlatformVersion(), "_", info_.opencl_info.device_name,
+                      "_", info_.opencl_info.driver_version);
+}
+
 void CLDevice::DisableOneLayerTextureArray() {
   info_.adreno_info.support_one_layer_texture_array = false;
 }
@@ -45,6 +45,10 @@ class CLDevice {
   cl_device_id id() const { return id_; }
   cl_platform_id platform() const { return platform_id_; }
   std::string GetPlatformVersion() const;
+  // Identifies the device and the driver that compiles programs for it.
+  // Program binaries and tuned work group sizes are only valid for the same
+  // fingerprint.
+  std::string GetDriverFingerprint() const;
 
   // To track bug on some Adreno. b/131099086
   void DisableOneLayerTextureArray();
@@ -352,12 +352,12 @@ absl::Status InferenceContext::RestoreDeserialized(
     return absl::DataLossError("Deserialization failed.");
   }
   auto decoded_fb = data::GetInferenceContext(serialized_model.data());
-  std::string platform_version(decoded_fb->driver_version()->c_str(),
-                               decoded_fb->driver_version()->size());
-  if (env->GetDevicePtr()->GetPlatformVersion() != platform_version) {
+  std::string driver_fingerprint(decoded_fb->driver_version()->c_str(),
+                                 decoded_fb->driver_version()->size());
+  if (env->GetDevicePtr()->GetDriverFingerprint() != driver_fingerprint) {
     return absl::InvalidArgumentError(
-        "OpenCL driver changed, model respresentation invalid, must be "
-        "regenerated.");
+        "OpenCL device or driver changed, model respresentation invalid, must "
+        "be regenerated.");
   }
   GpuModel gpu_model;
   RETURN_IF_ERROR(tflite::gpu::Decode(decoded_fb->gpu_model(), &gpu_model));
@@ -965,7 +965,7 @@ flatbuffers::Offset<data::InferenceContext> InferenceContext::Encode(
     binary_programs_fb.push_back(program_builder.Finish());
   }
   auto binary_programs_fb_vec = builder->CreateVector(binary_programs_fb);
-  auto driver_version = builder->CreateString(device.GetPlatformVersion());
+  auto driver_version = builder->CreateString(device.GetDriverFingerprint());
 
   data::InferenceContextBuilder inf_builder(*builder);
   inf_builder.add_gpu_model(gpu_model_fb);
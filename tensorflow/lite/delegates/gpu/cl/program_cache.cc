@@ -54,7 +54,7 @@ uint64_t GetProgramFingerprint(const std::string& code,
 }
 
 std::string GetDriverVersion(const CLDevice& device) {
-  return device.GetPlatformVersion() + "_jet_version_0";
+  return device.GetDriverFingerprint() + "_jet_version_0";
 }
 
 }  // namespace
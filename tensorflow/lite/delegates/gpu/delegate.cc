@@ -374,15 +374,24 @@ class DelegateKernel {
           options, std::move(*graph), builder));
     } else {
       // If serialization data is found, initialize CL from it & return early.
-      if (MaybeInitializeSerializedOpenCL(context, delegate_params, builder,
-                                          &options, &env_options, &properties,
-                                          serialization)
-              .ok()) {
+      const absl::Status serialized_status = MaybeInitializeSerializedOpenCL(
+          context, delegate_params, builder, &options, &env_options,
+          &properties, serialization);
+      if (serialized_status.ok()) {
         return absl::OkStatus();
       }
+      if (!absl::IsNotFound(serialized_status)) {
+        // Typically data of another device or driver; it is replaced below.
+        TFLITE_LOG_PROD(tflite::TFLITE_LOG_WARNING,
+                        "Ignoring serialized GPU delegate data: %s",
+                        std::string(serialized_status.message()).c_str());
+      }
 
-      RETURN_IF_ERROR(cl::NewInferenceEnvironment(env_options, &cl_environment_,
-                                                  &properties));
+      // The environment of rejected serialized data is reused.
+      if (!cl_environment_) {
+        RETURN_IF_ERROR(cl::NewInferenceEnvironment(
+            env_options, &cl_environment_, &properties));
+      }
       *graph_is_destroyed = true;
       std::vector<uint8_t> serialized_model;
       RETURN_IF_ERROR(cl_environment_->BuildSerializedModel(
@@ -0,0 +1,249 @@
+/* Copyright 2022 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/lite/delegates/xnnpack/weights_cache_file.h"
+
+#if !defined(_WIN32)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <string>
+
+#include "xnnpack.h"  // from @XNNPACK
+#include "xnnpack/allocator.h"  // from @XNNPACK
+#include "xnnpack/cache.h"  // from @XNNPACK
+#include "tensorflow/lite/minimal_logging.h"
+
+namespace tflite {
+namespace xnnpack {
+namespace {
+
+constexpr char kMagic[8] = {'T', 'F', 'L', 'X', 'N', 'N', 'W', 'C'};
+constexpr uint32_t kVersion = 1;
+
+// The file holds this header, the hash table of the cache and, at
+// `weights_offset`, the packed weights.
+struct FileHeader {
+  char magic[8];
+  uint32_t version;
+  // The sizes of the structures of the XNNPACK cache, which change with the
+  // way XNNPACK indexes the packed weights.
+  uint32_t bucket_size;
+  uint32_t cache_size;
+  // Packed weights are aligned to pages, so they depend on the page size.
+  uint32_t page_size;
+  uint64_t fingerprint;
+  uint64_t num_buckets;
+  uint64_t num_entries;
+  // The size of the largest packed weights of an operator.
+  uint64_t max_weights_size;
+  // A multiple of the page size, so that the packed weights can be mapped.
+  uint64_t weights_offset;
+  uint64_t weights_size;
+};
+
+#if !defined(_WIN32)
+
+size_t RoundUp(size_t value, size_t multiple) {
+  return (value + multiple - 1) / multiple * multiple;
+}
+
+FileHeader CreateHeader(uint64_t fingerprint, size_t page_size) {
+  FileHeader header;
+  std::memset(&header, 0, sizeof(header));
+  std::memcpy(header.magic, kMagic, sizeof(kMagic));
+  header.version = kVersion;
+  header.bucket_size = sizeof(xnn_cache_bucket);
+  header.cache_size = sizeof(xnn_weights_cache);
+  header.page_size = page_size;
+  header.fingerprint = fingerprint;
+  return header;
+}
+
+bool Write(FILE* file, const void* data, size_t size) {
+  return size == 0 || std::fwrite(data, size, 1, file) == 1;
+}
+
+bool Read(int fd, void* data, size_t size, off_t offset) {
+  return pread(fd, data, size, offset) == static_cast<ssize_t>(size);
+}
+
+// Returns whether the header and the hash table read from the file are
+// consistent with each other and with a file of `file_size` bytes.
+bool IsValid(const FileHeader& header, const xnn_cache_bucket* buckets,
+             size_t file_size) {
+  for (size_t i = 0; i < header.num_buckets; ++i) {
+    if (buckets[i].size != 0 &&
+        (buckets[i].size > header.max_weights_size ||
+         buckets[i].size > header.weights_size ||
+         buckets[i].offset > header.weights_size - buckets[i].size)) {
+      return false;
+    }
+  }
+  return header.weights_offset <= file_size &&
+         header.weights_size == file_size - header.weights_offset;
+}
+
+xnn_weights_cache_t LoadWeightsCacheFromFile(int fd, uint64_t fingerprint) {
+  struct stat file_stat;
+  FileHeader header;
+  if (fstat(fd, &file_stat) != 0 || !Read(fd, &header, sizeof(header), 0)) {
+    return nullptr;
+  }
+  const size_t page_size = sysconf(_SC_PAGESIZE);
+  const FileHeader expected_header = CreateHeader(fingerprint, page_size);
+  if (std::memcmp(header.magic, expected_header.magic, sizeof(kMagic)) != 0 ||
+      header.version != expected_header.version ||
+      header.bucket_size != expected_header.bucket_size ||
+      header.cache_size != expected_header.cache_size ||
+      header.page_size != expected_header.page_size) {
+    TFLITE_LOG(TFLITE_LOG_INFO,
+               "Ignoring XNNPACK weights cache file written by another build.");
+    return nullptr;
+  }
+  if (header.fingerprint != fingerprint) {
+    TFLITE_LOG(TFLITE_LOG_INFO,
+               "Ignoring XNNPACK weights cache file of other models.");
+    return nullptr;
+  }
+  const size_t file_size = file_stat.st_size;
+  // The hash table of XNNPACK has a power of two buckets.
+  if (header.num_entries == 0 || header.num_buckets < header.num_entries ||
+      (header.num_buckets & (header.num_buckets - 1)) != 0 ||
+      header.num_buckets > file_size / sizeof(xnn_cache_bucket) ||
+      header.weights_offset % page_size != 0 ||
+      header.weights_offset <
+          sizeof(header) + header.num_buckets * sizeof(xnn_cache_bucket) ||
+      header.weights_size == 0 || header.weights_size > file_size) {
+    return nullptr;
+  }
+
+  const size_t buckets_size = header.num_buckets * sizeof(xnn_cache_bucket);
+  auto* buckets =
+      static_cast<xnn_cache_bucket*>(xnn_allocate_zero_memory(buckets_size));
+  if (buckets == nullptr) {
+    return nullptr;
+  }
+  if (!Read(fd, buckets, buckets_size, sizeof(header)) ||
+      !IsValid(header, buckets, file_size)) {
+    xnn_release_memory(buckets);
+    return nullptr;
+  }
+
+  // Maps the packed weights read-only, followed by private memory for the
+  // weights of one operator, which XNNPACK packs before it looks them up.
+  const size_t mapped_size = RoundUp(header.weights_size, page_size);
+  const size_t capacity =
+      mapped_size + RoundUp(header.max_weights_size, page_size);
+  void* start = mmap(nullptr, capacity, PROT_READ | PROT_WRITE,
+                     MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+  if (start == MAP_FAILED) {
+    xnn_release_memory(buckets);
+    return nullptr;
+  }
+  if (mmap(start, header.weights_size, PROT_READ, MAP_PRIVATE | MAP_FIXED, fd,
+           header.weights_offset) == MAP_FAILED) {
+    munmap(start, capacity);
+    xnn_release_memory(buckets);
+    return nullptr;
+  }
+
+  xnn_weights_cache_t cache = nullptr;
+  if (xnn_create_weights_cache(&cache) != xnn_status_success) {
+    munmap(start, capacity);
+    xnn_release_memory(buckets);
+    return nullptr;
+  }
+  // Replaces the empty hash table and weights of the new cache. XNNPACK
+  // releases them like its own, since the weights start at a page and span
+  // whole pages.
+  xnn_release_memory(cache->cache.buckets);
+  cache->cache.buckets = buckets;
+  cache->cache.num_buckets = header.num_buckets;
+  cache->cache.num_entries = header.num_entries;
+  xnn_release_weights_memory(&cache->cache.weights);
+  cache->cache.weights.start = start;
+  cache->cache.weights.size = mapped_size;
+  cache->cache.weights.capacity = capacity;
+  return cache;
+}
+
+#endif  // !defined(_WIN32)
+
+}  // namespace
+
+bool SaveWeightsCache(xnn_weights_cache_t cache, const char* path,
+                      uint64_t fingerprint) {
+#if defined(_WIN32)
+  return false;
+#else
+  const xnn_cache& index = cache->cache;
+  const size_t page_size = sysconf(_SC_PAGESIZE);
+  FileHeader header = CreateHeader(fingerprint, page_size);
+  header.num_buckets = index.num_buckets;
+  header.num_entries = index.num_entries;
+  for (size_t i = 0; i < index.num_buckets; ++i) {
+    header.max_weights_size =
+        std::max<uint64_t>(header.max_weights_size, index.buckets[i].size);
+  }
+  const size_t buckets_size = index.num_buckets * sizeof(xnn_cache_bucket);
+  header.weights_offset = RoundUp(sizeof(header) + buckets_size, page_size);
+  header.weights_size = index.weights.size;
+
+  const std::string temp_path =
+      std::string(path) + ".tmp" + std::to_string(getpid());
+  FILE* file = std::fopen(temp_path.c_str(), "wb");
+  if (file == nullptr) {
+    return false;
+  }
+  const std::string padding(
+      header.weights_offset - sizeof(header) - buckets_size, '\0');
+  bool ok = Write(file, &header, sizeof(header)) &&
+            Write(file, index.buckets, buckets_size) &&
+            Write(file, padding.data(), padding.size()) &&
+            Write(file, index.weights.start, index.weights.size);
+  ok = std::fclose(file) == 0 && ok;
+  if (!ok || std::rename(temp_path.c_str(), path) != 0) {
+    std::remove(temp_path.c_str());
+    return false;
+  }
+  return true;
+#endif
+}
+
+xnn_weights_cache_t LoadWeightsCache(const char* path, uint64_t fingerprint) {
+#if defined(_WIN32)
+  return nullptr;
+#else
+  const int fd = open(path, O_RDONLY | O_CLOEXEC);
+  if (fd < 0) {
+    return nullptr;
+  }
+  // The mapping of the packed weights outlives the descriptor.
+  xnn_weights_cache_t cache = LoadWeightsCacheFromFile(fd, fingerprint);
+  close(fd);
+  return cache;
+#endif
+}
+
+}  // namespace xnnpack
+}  // namespace tflite
@@ -0,0 +1,46 @@
+/* Copyright 2022 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_LITE_DELEGATES_XNNPACK_WEIGHTS_CACHE_FILE_H_
+#define TENSORFLOW_LITE_DELEGATES_XNNPACK_WEIGHTS_CACHE_FILE_H_
+
+#include <cstdint>
+
+#include "xnnpack.h"  // from @XNNPACK
+
+namespace tflite {
+namespace xnnpack {
+
+// Writes the packed weights and the index of `cache` to the file at `path`,
+// tagged with `fingerprint`. The file is written to a temporary file first
+// and renamed, so that processes that load it concurrently never see a
+// partial file. Returns false on error.
+bool SaveWeightsCache(xnn_weights_cache_t cache, const char* path,
+                      uint64_t fingerprint);
+
+// Creates a weights cache from a file written by SaveWeightsCache(). The
+// packed weights are mapped read-only from the file, so that all processes
+// that load the same file share their memory, and the cache has room to pack
+// the weights of one operator without growing. Packed weights that aren't in
+// the file are added to the cache as usual, in private memory.
+//
+// Returns nullptr if the file is missing or malformed, or was written with
+// another fingerprint or by a build whose XNNPACK uses another cache layout.
+xnn_weights_cache_t LoadWeightsCache(const char* path, uint64_t fingerprint);
+
+}  // namespace xnnpack
+}  // namespace tflite
+
+#endif  // TENSORFLOW_LITE_DELEGATES_XNNPACK_WEIGHTS_CACHE_FILE_H_
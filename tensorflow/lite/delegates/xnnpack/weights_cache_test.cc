@@ -13,7 +13,9 @@ See the License for the specific language governing permissions and
 limitations under the License.
 ==============================================================================*/
 
+#include <cstdint>
 #include <memory>  // For std::unique_ptr.
+#include <string>
 #include <thread>  // NOLINT(build/c++11)
 #include <utility>
 #include <vector>
@@ -133,6 +135,63 @@ TEST(XNNPACK_WEIGHTS_CACHE, SoftFinalization) {
   ASSERT_EQ(kTfLiteOk, interpreter2->Invoke());
 }
 
+TEST(XNNPACK_WEIGHTS_CACHE, SaveAndLoad) {
+  std::vector<char> buffer = Conv2DTester().CreateTfLiteModel();
+  const Model* model = GetModel(buffer.data());
+  ops::builtin::BuiltinOpResolverWithoutDefaultDelegates resolver;
+  const std::string path = ::testing::TempDir() + "/weights_cache";
+  constexpr uint64_t kFingerprint = 0x1234;
+
+  {
+    std::unique_ptr<TfLiteXNNPackDelegateWeightsCache,
+                    decltype(&TfLiteXNNPackDelegateWeightsCacheDelete)>
+        weights_cache(TfLiteXNNPackDelegateWeightsCacheCreate(),
+                      TfLiteXNNPackDelegateWeightsCacheDelete);
+    TfLiteXNNPackDelegateOptions delegate_options =
+        TfLiteXNNPackDelegateOptionsDefault();
+    delegate_options.weights_cache = weights_cache.get();
+
+    std::unique_ptr<Interpreter> interpreter;
+    ASSERT_EQ(kTfLiteOk, InterpreterBuilder(model, resolver)(&interpreter));
+    ASSERT_EQ(kTfLiteOk, interpreter->AllocateTensors());
+    std::unique_ptr<TfLiteDelegate, decltype(&TfLiteXNNPackDelegateDelete)>
+        delegate(TfLiteXNNPackDelegateCreate(&delegate_options),
+                 TfLiteXNNPackDelegateDelete);
+    ASSERT_EQ(kTfLiteOk, interpreter->ModifyGraphWithDelegate(delegate.get()));
+    ASSERT_TRUE(
+        TfLiteXNNPackDelegateWeightsCacheFinalizeSoft(weights_cache.get()));
+    ASSERT_TRUE(TfLiteXNNPackDelegateWeightsCacheSave(weights_cache.get(),
+                                                      path.c_str(),
+                                                      kFingerprint));
+  }
+
+  EXPECT_EQ(nullptr, TfLiteXNNPackDelegateWeightsCacheCreateFromFile(
+                         path.c_str(), kFingerprint + 1));
+  EXPECT_EQ(nullptr, TfLiteXNNPackDelegateWeightsCacheCreateFromFile(
+                         (path + ".missing").c_str(), kFingerprint));
+
+  std::unique_ptr<TfLiteXNNPackDelegateWeightsCache,
+                  decltype(&TfLiteXNNPackDelegateWeightsCacheDelete)>
+      weights_cache(TfLiteXNNPackDelegateWeightsCacheCreateFromFile(
+                        path.c_str(), kFingerprint),
+                    TfLiteXNNPackDelegateWeightsCacheDelete);
+  ASSERT_NE(nullptr, weights_cache);
+  TfLiteXNNPackDelegateOptions delegate_options =
+      TfLiteXNNPackDelegateOptionsDefault();
+  delegate_options.weights_cache = weights_cache.get();
+
+  std::unique_ptr<Interpreter> interpreter;
+  ASSERT_EQ(kTfLiteOk, InterpreterBuilder(model, resolver)(&interpreter));
+  ASSERT_EQ(kTfLiteOk, interpreter->AllocateTensors());
+  std::unique_ptr<TfLiteDelegate, decltype(&TfLiteXNNPackDelegateDelete)>
+      delegate(TfLiteXNNPackDelegateCreate(&delegate_options),
+               TfLiteXNNPackDelegateDelete);
+  ASSERT_EQ(kTfLiteOk, interpreter->ModifyGraphWithDelegate(delegate.get()));
+  ASSERT_TRUE(
+      TfLiteXNNPackDelegateWeightsCacheFinalizeHard(weights_cache.get()));
+  ASSERT_EQ(kTfLiteOk, interpreter->Invoke());
+}
+
 // Dummy class to use with parameterized test.
 class WeightsCacheTest : public testing::TestWithParam<size_t> {};
 
@@ -34,6 +34,7 @@ limitations under the License.
 #include "tensorflow/lite/c/common.h"
 #include "tensorflow/lite/core/api/profiler.h"
 #include "tensorflow/lite/delegates/xnnpack/quantization_util.h"
+#include "tensorflow/lite/delegates/xnnpack/weights_cache_file.h"
 #include "tensorflow/lite/kernels/internal/compatibility.h"
 #include "tensorflow/lite/kernels/internal/tensor_ctypes.h"
 #include "tensorflow/lite/kernels/internal/utils/sparsity_format_converter.h"
@@ -5205,6 +5206,31 @@ bool TfLiteXNNPackDelegateWeightsCacheFinalizeHard(
   return status == xnn_status_success;
 }
 
+bool TfLiteXNNPackDelegateWeightsCacheSave(
+    TfLiteXNNPackDelegateWeightsCache* cache, const char* path,
+    uint64_t fingerprint) {
+  return tflite::xnnpack::SaveWeightsCache(
+      reinterpret_cast<xnn_weights_cache_t>(cache), path, fingerprint);
+}
+
+TfLiteXNNPackDelegateWeightsCache*
+TfLiteXNNPackDelegateWeightsCacheCreateFromFile(const char* path,
+                                                 uint64_t fingerprint) {
+  xnn_status status = xnn_initialize(/*allocator=*/nullptr);
+  if (status != xnn_status_success) {
+    return nullptr;
+  }
+
+  xnn_weights_cache_t weights_cache =
+      tflite::xnnpack::LoadWeightsCache(path, fingerprint);
+  if (weights_cache == nullptr) {
+    // Balances the initialization, like deleting the cache would.
+    xnn_deinitialize();
+    return nullptr;
+  }
+  return reinterpret_cast<TfLiteXNNPackDelegateWeightsCache*>(weights_cache);
+}
+
 void TfLiteXNNPackDelegateWeightsCacheDelete(
     TfLiteXNNPackDelegateWeightsCache* cache) {
   if (cache == nullptr) {
@@ -88,6 +88,32 @@ TFL_CAPI_EXPORT bool TfLiteXNNPackDelegateWeightsCacheFinalizeSoft(
 // Returns true on success, false on error.
 TFL_CAPI_EXPORT bool TfLiteXNNPackDelegateWeightsCacheFinalizeHard(
     struct TfLiteXNNPackDelegateWeightsCache* cache);
+// Writes the packed weights in a weights cache to the file at `path`, so that
+// later processes can map them with
+// `TfLiteXNNPackDelegateWeightsCacheCreateFromFile`. The cache should be
+// finalized, and must not be used by delegates while it is written.
+// `fingerprint` identifies the models whose weights are in the cache, e.g. a
+// hash of their contents, and is checked when the file is loaded. The file is
+// only valid on devices with the same CPU and a build of the same version.
+// Returns true on success, false on error.
+// WARNING: This API is experimental and subject to change.
+TFL_CAPI_EXPORT bool TfLiteXNNPackDelegateWeightsCacheSave(
+    struct TfLiteXNNPackDelegateWeightsCache* cache, const char* path,
+    uint64_t fingerprint);
+// Creates a new weights cache like `TfLiteXNNPackDelegateWeightsCacheCreate`,
+// which holds the packed weights of the file at `path`, written by
+// `TfLiteXNNPackDelegateWeightsCacheSave`. The packed weights are mapped
+// read-only, so they don't take private memory and all processes that load
+// the same file share them. XNNPACK still packs the weights of each operator
+// to look them up, and adds the ones that aren't in the file to the cache.
+// The cache has to be finalized like a new one.
+// Returns NULL if the file doesn't exist, or is malformed, or was written with
+// another `fingerprint` or by a build whose XNNPACK stores weights differently.
+// In that case, create a new cache, and save it once it's finalized.
+// WARNING: This API is experimental and subject to change.
+TFL_CAPI_EXPORT struct TfLiteXNNPackDelegateWeightsCache*
+TfLiteXNNPackDelegateWeightsCacheCreateFromFile(const char* path,
+                                                 uint64_t fingerprint);
 // Destroys a weights cache created with
 // `TfLiteXNNPackDelegateWeightsCacheCreate` call.
 TFL_CAPI_EXPORT void TfLiteXNNPackDelegateWeightsCacheDelete(
@@ -0,0 +1,118 @@
+/* Copyright 2022 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/lite/experimental/acceleration/mini_benchmark/auto_acceleration.h"
+
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "flatbuffers/flatbuffers.h"  // from @flatbuffers
+#include "tensorflow/lite/experimental/acceleration/configuration/configuration_generated.h"
+#include "tensorflow/lite/experimental/acceleration/configuration/delegate_registry.h"
+#include "tensorflow/lite/experimental/acceleration/mini_benchmark/mini_benchmark.h"
+#include "tensorflow/lite/minimal_logging.h"
+
+namespace tflite {
+namespace acceleration {
+namespace {
+
+// Returns the name of the delegate plugin for `delegate`, or an empty string
+// if the delegate is not supported by the automatic acceleration.
+std::string DelegatePluginName(Delegate delegate) {
+  switch (delegate) {
+    case Delegate_NNAPI:
+      return "NnapiPlugin";
+    case Delegate_GPU:
+      return "GpuPlugin";
+    case Delegate_XNNPACK:
+      return "XNNPackPlugin";
+    default:
+      return "";
+  }
+}
+
+}  // namespace
+
+std::vector<TFLiteSettingsT> DefaultAccelerationsToTest() {
+  std::vector<TFLiteSettingsT> accelerations(3);
+  accelerations[0].delegate = Delegate_XNNPACK;
+  accelerations[1].delegate = Delegate_GPU;
+  accelerations[2].delegate = Delegate_NNAPI;
+  return accelerations;
+}
+
+AutoAcceleration::AutoAcceleration(const MinibenchmarkSettings& settings,
+                                   const std::string& model_namespace,
+                                   const std::string& model_id)
+    : delegate_(nullptr, [](TfLiteDelegate*) {}) {
+  MinibenchmarkSettingsT copy;
+  settings.UnPackTo(&copy);
+  if (copy.settings_to_test.empty()) {
+    for (TFLiteSettingsT& acceleration : DefaultAccelerationsToTest()) {
+      copy.settings_to_test.emplace_back(
+          std::make_unique<TFLiteSettingsT>(std::move(acceleration)));
+    }
+  }
+  settings_buffer_.Finish(MinibenchmarkSettings::Pack(settings_buffer_, &copy));
+  mini_benchmark_ = CreateMiniBenchmark(
+      *flatbuffers::GetRoot<MinibenchmarkSettings>(
+          settings_buffer_.GetBufferPointer()),
+      model_namespace, model_id);
+}
+
+TfLiteStatus AutoAcceleration::ApplyTo(InterpreterBuilder* builder) {
+  const ComputeSettingsT best = mini_benchmark_->GetBestAcceleration();
+  if (best.tflite_settings == nullptr) {
+    // Either the benchmark hasn't completed, or CPU was the fastest. Only the
+    // missing benchmarks are run, so this is cheap in the latter case.
+    mini_benchmark_->TriggerMiniBenchmark();
+    return kTfLiteOk;
+  }
+
+  const std::string plugin_name =
+      DelegatePluginName(best.tflite_settings->delegate);
+  if (plugin_name.empty()) return kTfLiteOk;
+  // The delegate is created once and reused for later builders, unless the
+  // decision has changed in between.
+  bool reuse_delegate = false;
+  if (delegate_) {
+    std::unique_ptr<TFLiteSettingsT> current(selected_settings()->UnPack());
+    reuse_delegate = *current == *best.tflite_settings;
+  }
+  if (!reuse_delegate) {
+    selected_settings_buffer_.Clear();
+    selected_settings_buffer_.Finish(TFLiteSettings::Pack(
+        selected_settings_buffer_, best.tflite_settings.get()));
+    delegate_.reset();
+    plugin_ = delegates::DelegatePluginRegistry::CreateByName(
+        plugin_name, *flatbuffers::GetRoot<TFLiteSettings>(
+                         selected_settings_buffer_.GetBufferPointer()));
+    if (plugin_ != nullptr) delegate_ = plugin_->Create();
+    if (!delegate_) {
+      TFLITE_LOG_PROD(TFLITE_LOG_WARNING,
+                      "Failed to create the %s delegate picked by the "
+                      "mini-benchmark, running on CPU.",
+                      plugin_name.c_str());
+      plugin_.reset();
+      return kTfLiteOk;
+    }
+  }
+  builder->AddDelegate(delegate_.get());
+  return kTfLiteOk;
+}
+
+}  // namespace acceleration
+}  // namespace tflite
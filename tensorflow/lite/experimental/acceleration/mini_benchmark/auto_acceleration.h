@@ -0,0 +1,83 @@
+/* Copyright 2022 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_LITE_EXPERIMENTAL_ACCELERATION_MINI_BENCHMARK_AUTO_ACCELERATION_H_
+#define TENSORFLOW_LITE_EXPERIMENTAL_ACCELERATION_MINI_BENCHMARK_AUTO_ACCELERATION_H_
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "flatbuffers/flatbuffers.h"  // from @flatbuffers
+#include "tensorflow/lite/c/common.h"
+#include "tensorflow/lite/experimental/acceleration/configuration/configuration_generated.h"
+#include "tensorflow/lite/experimental/acceleration/configuration/delegate_registry.h"
+#include "tensorflow/lite/experimental/acceleration/mini_benchmark/mini_benchmark.h"
+#include "tensorflow/lite/interpreter_builder.h"
+
+namespace tflite {
+namespace acceleration {
+
+// Returns the accelerations that are benchmarked when the settings given to
+// AutoAcceleration don't list any: XNNPACK, GPU and NNAPI, with their default
+// options.
+std::vector<TFLiteSettingsT> DefaultAccelerationsToTest();
+
+// Picks the acceleration of a model automatically, based on the
+// mini-benchmark.
+//
+// On the first launch for a (model_namespace, model_id) pair, ApplyTo()
+// triggers the mini-benchmark in the background and leaves the interpreter on
+// CPU. Once the benchmark has completed, the fastest acceleration is persisted
+// in the mini-benchmark storage, and ApplyTo() adds its delegate to the
+// InterpreterBuilder on this and later launches. Accelerations whose results
+// didn't match the expected outputs of the validation model are never picked,
+// and the interpreter stays on CPU when the picked delegate cannot be created.
+//
+// Instances are thread-compatible, as MiniBenchmark.
+class AutoAcceleration {
+ public:
+  // `settings` needs the model_file and the storage_paths; settings_to_test
+  // may be left empty for DefaultAccelerationsToTest().
+  AutoAcceleration(const MinibenchmarkSettings& settings,
+                   const std::string& model_namespace,
+                   const std::string& model_id);
+
+  // Adds the delegate of the best acceleration found so far to `builder`, or
+  // triggers the missing benchmarks when there is none. The delegate is owned
+  // by this instance, which must outlive the interpreters built by `builder`.
+  TfLiteStatus ApplyTo(InterpreterBuilder* builder);
+
+  // Returns the settings of the delegate added by the last ApplyTo(), or
+  // nullptr if the interpreter runs on CPU.
+  const TFLiteSettings* selected_settings() const {
+    return delegate_ ? flatbuffers::GetRoot<TFLiteSettings>(
+                           selected_settings_buffer_.GetBufferPointer())
+                     : nullptr;
+  }
+
+  MiniBenchmark* mini_benchmark() { return mini_benchmark_.get(); }
+
+ private:
+  flatbuffers::FlatBufferBuilder settings_buffer_;
+  std::unique_ptr<MiniBenchmark> mini_benchmark_;
+  flatbuffers::FlatBufferBuilder selected_settings_buffer_;
+  std::unique_ptr<delegates::DelegatePluginInterface> plugin_;
+  delegates::TfLiteDelegatePtr delegate_;
+};
+
+}  // namespace acceleration
+}  // namespace tflite
+
+#endif  // TENSORFLOW_LITE_EXPERIMENTAL_ACCELERATION_MINI_BENCHMARK_AUTO_ACCELERATION_H_
@@ -0,0 +1,128 @@
+/* Copyright 2022 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/lite/experimental/acceleration/mini_benchmark/auto_acceleration.h"
+
+#include <unistd.h>
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>
+#include "absl/time/clock.h"
+#include "absl/time/time.h"
+#include "flatbuffers/flatbuffers.h"  // from @flatbuffers
+#include "tensorflow/lite/experimental/acceleration/configuration/configuration.pb.h"
+#include "tensorflow/lite/experimental/acceleration/configuration/configuration_generated.h"
+#include "tensorflow/lite/experimental/acceleration/configuration/proto_to_flatbuffer.h"
+#include "tensorflow/lite/experimental/acceleration/mini_benchmark/embedded_mobilenet_float_validation_model.h"
+#include "tensorflow/lite/experimental/acceleration/mini_benchmark/mini_benchmark_test_helper.h"
+#include "tensorflow/lite/interpreter.h"
+#include "tensorflow/lite/kernels/register.h"
+#include "tensorflow/lite/model_builder.h"
+
+namespace tflite {
+namespace acceleration {
+namespace {
+
+TEST(DefaultAccelerationsToTestTest, CoversDelegates) {
+  const std::vector<TFLiteSettingsT> accelerations =
+      DefaultAccelerationsToTest();
+  ASSERT_EQ(3, accelerations.size());
+  EXPECT_EQ(Delegate_XNNPACK, accelerations[0].delegate);
+  EXPECT_EQ(Delegate_GPU, accelerations[1].delegate);
+  EXPECT_EQ(Delegate_NNAPI, accelerations[2].delegate);
+}
+
+class AutoAccelerationTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    MiniBenchmarkTestHelper helper;
+    should_perform_test_ = helper.should_perform_test();
+    if (!should_perform_test_) return;
+
+    model_path_ = MiniBenchmarkTestHelper::DumpToTempFile(
+        "mobilenet_float_with_validation.tflite",
+        g_tflite_acceleration_embedded_mobilenet_float_validation_model,
+        g_tflite_acceleration_embedded_mobilenet_float_validation_model_len);
+    proto::MinibenchmarkSettings settings;
+    settings.mutable_model_file()->set_filename(model_path_);
+    proto::BenchmarkStoragePaths* paths = settings.mutable_storage_paths();
+    paths->set_storage_file_path(::testing::TempDir() + "/auto_storage.fb");
+    (void)unlink(paths->storage_file_path().c_str());
+    (void)unlink((paths->storage_file_path() + ".extra.fb").c_str());
+    paths->set_data_directory_path(::testing::TempDir());
+    settings_ = ConvertFromProto(settings, &settings_buffer_);
+
+    model_ = FlatBufferModel::BuildFromFile(model_path_.c_str());
+    ASSERT_NE(nullptr, model_);
+  }
+
+  void WaitForValidationCompletion(AutoAcceleration* auto_acceleration) {
+    absl::Time deadline = absl::Now() + absl::Seconds(300);
+    while (absl::Now() < deadline) {
+      if (auto_acceleration->mini_benchmark()
+              ->NumRemainingAccelerationTests() == 0) {
+        return;
+      }
+      absl::SleepFor(absl::Milliseconds(200));
+    }
+    FAIL() << "The mini-benchmark didn't complete.";
+  }
+
+  TfLiteStatus Build(AutoAcceleration* auto_acceleration) {
+    ops::builtin::BuiltinOpResolver resolver;
+    InterpreterBuilder builder(*model_, resolver);
+    TF_LITE_ENSURE_STATUS(auto_acceleration->ApplyTo(&builder));
+    std::unique_ptr<Interpreter> interpreter;
+    TF_LITE_ENSURE_STATUS(builder(&interpreter));
+    return interpreter->AllocateTensors();
+  }
+
+  const std::string ns_ = "org.tensorflow.lite.mini_benchmark.test";
+  const std::string model_id_ = "test_auto_acceleration_model";
+
+  bool should_perform_test_ = true;
+  std::string model_path_;
+  std::unique_ptr<FlatBufferModel> model_;
+  flatbuffers::FlatBufferBuilder settings_buffer_;
+  const MinibenchmarkSettings* settings_;
+};
+
+TEST_F(AutoAccelerationTest, AppliesPersistedDecision) {
+  if (!should_perform_test_) return;
+
+  {
+    // The first launch runs on CPU while the benchmark runs.
+    AutoAcceleration auto_acceleration(*settings_, ns_, model_id_);
+    EXPECT_EQ(kTfLiteOk, Build(&auto_acceleration));
+    EXPECT_EQ(nullptr, auto_acceleration.selected_settings());
+    WaitForValidationCompletion(&auto_acceleration);
+  }
+
+  // Later launches read the decision from storage. Only XNNPACK is linked in
+  // and passes validation here, so it is the only delegate that may be picked.
+  AutoAcceleration auto_acceleration(*settings_, ns_, model_id_);
+  EXPECT_EQ(kTfLiteOk, Build(&auto_acceleration));
+  if (auto_acceleration.selected_settings() != nullptr) {
+    EXPECT_EQ(Delegate_XNNPACK,
+              auto_acceleration.selected_settings()->delegate());
+  }
+  EXPECT_EQ(kTfLiteOk, Build(&auto_acceleration));
+}
+
+}  // namespace
+}  // namespace acceleration
+}  // namespace tflite
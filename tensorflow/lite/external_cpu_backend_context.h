@@ -15,6 +15,8 @@ limitations under the License.
 #ifndef TENSORFLOW_LITE_EXTERNAL_CPU_BACKEND_CONTEXT_H_
 #define TENSORFLOW_LITE_EXTERNAL_CPU_BACKEND_CONTEXT_H_
 
+#include <stdint.h>
+
 #include <memory>
 #include <utility>
 
@@ -92,9 +94,22 @@ class ExternalCpuBackendContext : public TfLiteExternalContext {
     return internal_backend_context_.get();
   }
 
+  // Sets the maximum size, in bytes, of the cache of the data that kernels
+  // derive from constant weights, e.g. dequantized or transposed weights. When
+  // it is not negative, the kernels don't keep that data in persistent memory,
+  // but derive it again when it isn't in the cache. When it is negative, the
+  // default, they keep it for the lifetime of the interpreter. Kernels read it
+  // when they are prepared.
+  void set_weights_cache_size(int64_t max_size_bytes) {
+    weights_cache_size_ = max_size_bytes;
+  }
+
+  int64_t weights_cache_size() const { return weights_cache_size_; }
+
  private:
   // Note the actual internal backend context object is lazily initialized.
   std::unique_ptr<TfLiteInternalBackendContext> internal_backend_context_;
+  int64_t weights_cache_size_ = -1;
 
   ExternalCpuBackendContext(const ExternalCpuBackendContext&) = delete;
   ExternalCpuBackendContext& operator=(const ExternalCpuBackendContext&) =
@@ -241,6 +241,32 @@ TfLiteStatus Interpreter::Invoke() {
   return kTfLiteOk;
 }
 
+TfLiteStatus Interpreter::InvokeAsync(int64_t* handle) {
+  ScopedRuntimeInstrumentationProfile scoped_runtime_event(root_profiler_.get(),
+                                                           "invoke_async");
+  ruy::ScopedSuppressDenormals suppress_denormals;
+  TF_LITE_ENSURE_STATUS_WITH_SCOPED_INSTRUMENTATION(
+      scoped_runtime_event, primary_subgraph().InvokeAsync(handle));
+  return kTfLiteOk;
+}
+
+TfLiteStatus Interpreter::Wait(int64_t handle) {
+  ScopedRuntimeInstrumentationProfile scoped_runtime_event(root_profiler_.get(),
+                                                           "wait");
+  TF_LITE_ENSURE_STATUS_WITH_SCOPED_INSTRUMENTATION(
+      scoped_runtime_event, primary_subgraph().Wait(handle));
+
+  if (!allow_buffer_handle_output_) {
+    for (int tensor_index : outputs()) {
+      TF_LITE_ENSURE_STATUS_WITH_SCOPED_INSTRUMENTATION(
+          scoped_runtime_event,
+          primary_subgraph().EnsureTensorDataIsReadable(tensor_index));
+    }
+  }
+
+  return kTfLiteOk;
+}
+
 TfLiteStatus Interpreter::AddTensors(int tensors_to_add,
                                      int* first_new_tensor_index) {
   return primary_subgraph().AddTensors(tensors_to_add, first_new_tensor_index);
@@ -466,6 +492,15 @@ TfLiteStatus Interpreter::ApplyOptionsImpl(InterpreterOptions* options) {
           options->GetDynamicAllocationForLargeTensors());
     }
   }
+
+  // Handle `experimental_weights_cache_size_`, which the kernels read from the
+  // CPU backend context.
+  auto* cpu_backend_context = static_cast<ExternalCpuBackendContext*>(
+      external_contexts_[kTfLiteCpuBackendContext]);
+  if (options->GetWeightsCacheSize() >= 0 && cpu_backend_context != nullptr) {
+    cpu_backend_context->set_weights_cache_size(
+        options->GetWeightsCacheSize());
+  }
   return kTfLiteOk;
 }
 
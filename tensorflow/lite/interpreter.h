@@ -479,6 +479,19 @@ class Interpreter {
   /// Returns status of success or failure.
   TfLiteStatus Invoke();
 
+  /// Start an invocation of the interpreter and store its handle in `handle`.
+  /// With `InterpreterOptions::SetPipelineDepth()`, the invocation runs in the
+  /// background, and the call returns once the inputs may be written for the
+  /// next invocation. Otherwise the invocation runs before the call returns.
+  /// WARNING: This is an experimental API and subject to change.
+  TfLiteStatus InvokeAsync(int64_t* handle);
+
+  /// Wait for the invocation of `handle`, which must be the first one started
+  /// by `InvokeAsync()` that wasn't waited for, and return its status. The
+  /// outputs hold its results until the next call to `Wait()` or `Invoke()`.
+  /// WARNING: This is an experimental API and subject to change.
+  TfLiteStatus Wait(int64_t handle);
+
   /// Set the number of threads available to the interpreter.
   ///
   /// NOTE: `num_threads` should be >= -1. Setting `num_threads` to 0 has the
@@ -670,7 +683,11 @@ class Interpreter {
   /// `flags` is a bitmask, see TfLiteCustomAllocationFlags.
   /// The runtime does NOT take ownership of the underlying memory.
   ///
-  /// NOTE: User needs to call AllocateTensors() after this.
+  /// NOTE: User needs to call AllocateTensors() after this, unless the tensors
+  /// are already allocated and no input was resized since. In that case the
+  /// size of the allocation is checked here and the tensor uses it from the
+  /// next Invoke() on, without replanning the arena, so that e.g. a new
+  /// camera frame can be bound to an input before every Invoke().
   /// Invalid/insufficient buffers will cause an error during AllocateTensors or
   /// Invoke (in case of dynamic shapes in the graph).
   ///
@@ -18,6 +18,8 @@ limitations under the License.
 #ifndef TENSORFLOW_LITE_INTERPRETER_OPTIONS_H_
 #define TENSORFLOW_LITE_INTERPRETER_OPTIONS_H_
 
+#include <stdint.h>
+
 namespace tflite {
 
 /// Options class for `Interpreter`.
@@ -27,7 +29,13 @@ class InterpreterOptions {
   InterpreterOptions()
       : experimental_preserve_all_tensors_(false),
         experimental_ensure_dynamic_tensors_are_released_(false),
-        experimental_optimize_memory_for_large_tensors_(0) {}
+        experimental_optimize_memory_for_large_tensors_(0),
+        experimental_best_fit_arena_planning_(false),
+        experimental_parallel_node_execution_threads_(0),
+        experimental_parallel_prepare_threads_(0),
+        experimental_arena_plan_cache_size_(0),
+        experimental_pipeline_depth_(0),
+        experimental_weights_cache_size_(-1) {}
 
   /// Preserving all intermediates tensors for debugging.
   /// WARNING: This is an experimental API and subject to change.
@@ -76,10 +84,133 @@ class InterpreterOptions {
     return experimental_optimize_memory_for_large_tensors_;
   }
 
+  /// Also plan the tensors of the arena by putting each tensor in the smallest
+  /// hole it fits in, in a few orders of the tensors, including by the breadth
+  /// of the nodes that use them, and keep the plan that uses the least memory.
+  /// It never grows the arena compared to the default plan, but makes
+  /// `AllocateTensors()` slower.
+  /// WARNING: This is an experimental API and subject to change.
+  void SetBestFitArenaPlanning(bool value = true) {
+    experimental_best_fit_arena_planning_ = value;
+  }
+
+  /// Returns if the `experimental_best_fit_arena_planning_` feature is
+  /// enabled.
+  /// WARNING: This is an experimental API and subject to change.
+  bool GetBestFitArenaPlanning() {
+    return experimental_best_fit_arena_planning_;
+  }
+
+  /// Run the nodes that don't depend on each other, e.g. the branches of a
+  /// multi-head model or independent delegate partitions, at the same time on
+  /// `num_threads` threads, one of which is the thread that calls `Invoke()`.
+  /// The arena is planned so that such nodes don't share memory, so it may
+  /// grow. Subgraphs with dynamic tensors, and invocations with a profiler,
+  /// still run the nodes in order, and so do subgraphs whose tensors were
+  /// allocated before the option was set.
+  /// Kernels of different nodes must not share mutable state. Each thread has
+  /// its own CPU backend context, with the number of threads of
+  /// `Interpreter::SetNumThreads()`.
+  /// WARNING: This is an experimental API and subject to change.
+  void SetParallelNodeExecution(int num_threads) {
+    experimental_parallel_node_execution_threads_ = num_threads;
+  }
+
+  /// Returns the number of threads that run independent nodes at the same
+  /// time, or at most 1 if the nodes run in order.
+  /// WARNING: This is an experimental API and subject to change.
+  int GetParallelNodeExecutionThreads() {
+    return experimental_parallel_node_execution_threads_;
+  }
+
+  /// Prepare the nodes that don't depend on each other at the same time on
+  /// `num_threads` threads, one of which is the thread that calls
+  /// `AllocateTensors()`, so that the weight packing some kernels do in
+  /// `Prepare` overlaps on large models. A node is prepared once the nodes
+  /// whose outputs it reads are, and the nodes after one with dynamic outputs
+  /// are still prepared in `Invoke()`. Subgraphs whose delegate partitions run
+  /// in a pipeline are prepared in order.
+  /// Kernels of different nodes must not share mutable state in `Prepare`.
+  /// Each thread has its own CPU backend context.
+  /// WARNING: This is an experimental API and subject to change.
+  void SetParallelPrepare(int num_threads) {
+    experimental_parallel_prepare_threads_ = num_threads;
+  }
+
+  /// Returns the number of threads that prepare independent nodes at the same
+  /// time, or at most 1 if the nodes are prepared in order.
+  /// WARNING: This is an experimental API and subject to change.
+  int GetParallelPrepareThreads() {
+    return experimental_parallel_prepare_threads_;
+  }
+
+  /// Keep the arena plans of the `num_plans` most recently used sets of tensor
+  /// sizes, e.g. of input shapes, and reuse them when `AllocateTensors()` is
+  /// called after the inputs are resized back to one of them. The ops are
+  /// still prepared for the new shapes. The arena then also grows to at least
+  /// twice its size when it is too small, and never shrinks, so that inputs
+  /// whose shapes change on every invocation rarely reallocate it.
+  /// WARNING: This is an experimental API and subject to change.
+  void SetArenaPlanCacheSize(int num_plans) {
+    experimental_arena_plan_cache_size_ = num_plans;
+  }
+
+  /// Returns the number of cached arena plans.
+  /// WARNING: This is an experimental API and subject to change.
+  int GetArenaPlanCacheSize() { return experimental_arena_plan_cache_size_; }
+
+  /// Pipeline the delegate partitions and the CPU nodes between them across
+  /// invocations, with up to `depth` invocations started by
+  /// `Interpreter::InvokeAsync()` in flight, so that e.g. the GPU runs a
+  /// partition of one invocation while the CPU runs the next partition of the
+  /// previous one. Each delegate kernel gets private copies of the tensors at
+  /// the boundary of its partition, which are copied through `depth` buffers
+  /// between the stages, and the arena is planned so that no tensors share
+  /// memory, so it grows. Partitions that share tensors used by both run in
+  /// one stage. Subgraphs with dynamic tensors, and invocations with a
+  /// profiler, run the invocations in order. Must be set before
+  /// `ModifyGraphWithDelegate()` is called, and delegates must not use buffer
+  /// handles for the boundary tensors.
+  /// WARNING: This is an experimental API and subject to change.
+  void SetPipelineDepth(int depth) { experimental_pipeline_depth_ = depth; }
+
+  /// Returns the number of invocations in flight of the pipeline, or at most 1
+  /// if the invocations run in order.
+  /// WARNING: This is an experimental API and subject to change.
+  int GetPipelineDepth() { return experimental_pipeline_depth_; }
+
+  /// Don't keep the data that kernels derive from the constant weights of the
+  /// model when they are prepared, e.g. the outputs of DEQUANTIZE ops of
+  /// constant weights, or the transposed weights of CONV_2D and BATCH_MATMUL,
+  /// in persistent memory for the lifetime of the interpreter. The kernels
+  /// derive it from the weights, which stay in the (memory mapped) model, when
+  /// they run, into memory of the arena that other nodes reuse, and keep the
+  /// most recently used of it in a cache of at most `max_size_bytes` bytes,
+  /// which may be 0. It reduces the resident memory of large models at the
+  /// cost of latency. Applies to the CPU backend context of the interpreter,
+  /// and must be set before `AllocateTensors()` is called. A negative size,
+  /// the default, disables it.
+  /// WARNING: This is an experimental API and subject to change.
+  void SetWeightsCacheSize(int64_t max_size_bytes) {
+    experimental_weights_cache_size_ = max_size_bytes;
+  }
+
+  /// Returns the maximum size of the cache of the data derived from constant
+  /// weights, or a negative size if the kernels keep that data in persistent
+  /// memory.
+  /// WARNING: This is an experimental API and subject to change.
+  int64_t GetWeightsCacheSize() { return experimental_weights_cache_size_; }
+
  private:
   bool experimental_preserve_all_tensors_;
   bool experimental_ensure_dynamic_tensors_are_released_;
   int experimental_optimize_memory_for_large_tensors_;
+  bool experimental_best_fit_arena_planning_;
+  int experimental_parallel_node_execution_threads_;
+  int experimental_parallel_prepare_threads_;
+  int experimental_arena_plan_cache_size_;
+  int experimental_pipeline_depth_;
+  int64_t experimental_weights_cache_size_;
 };
 
 }  // namespace tflite
@@ -1113,6 +1113,211 @@ TEST(BasicInterpreter, ReleaseDynamicTensors) {
   ASSERT_EQ(interpreter.tensor(3)->bytes, sizeof(float) * 6 * 6);
 }
 
+TEST(BasicInterpreter, ParallelNodeExecution) {
+  // Two branches of two negate ops each.
+  Interpreter interpreter;
+  InterpreterOptions options;
+  options.SetParallelNodeExecution(2);
+  interpreter.ApplyOptions(&options);
+  interpreter.AddTensors(5);
+  interpreter.SetInputs({0});
+  interpreter.SetOutputs({2, 4});
+  TfLiteQuantizationParams quant;
+  for (int i = 0; i < 5; ++i) {
+    interpreter.SetTensorParametersReadWrite(
+        /*tensor_index=*/i, /*type=*/kTfLiteFloat32, /*name=*/"",
+        /*dims=*/{3}, /*quantization=*/quant);
+  }
+  TfLiteRegistration* neg_op = tflite::ops::builtin::Register_NEG();
+  for (const std::pair<int, int>& edge :
+       std::vector<std::pair<int, int>>{{0, 1}, {1, 2}, {0, 3}, {3, 4}}) {
+    ASSERT_EQ(interpreter.AddNodeWithParameters(
+                  /*inputs=*/{edge.first}, /*outputs=*/{edge.second},
+                  /*init_data=*/nullptr, /*init_data_size=*/0,
+                  /*builtin_data=*/nullptr, /*registration=*/neg_op),
+              kTfLiteOk);
+  }
+  ASSERT_EQ(interpreter.AllocateTensors(), kTfLiteOk);
+
+  for (int run = 0; run < 10; ++run) {
+    float* input = interpreter.typed_tensor<float>(0);
+    for (int i = 0; i < 3; ++i) input[i] = run + i;
+    ASSERT_EQ(interpreter.Invoke(), kTfLiteOk);
+    for (int output : {2, 4}) {
+      for (int i = 0; i < 3; ++i) {
+        EXPECT_EQ(interpreter.typed_tensor<float>(output)[i], run + i);
+      }
+    }
+  }
+}
+
+TEST(BasicInterpreter, ParallelPrepare) {
+  // A branch with a dynamically sized pad followed by a negate op, and a
+  // branch of two negate ops.
+  Interpreter interpreter;
+  InterpreterOptions options;
+  options.SetParallelPrepare(3);
+  interpreter.ApplyOptions(&options);
+  interpreter.AddTensors(6);
+  interpreter.SetInputs({0, 1});
+  interpreter.SetOutputs({3, 5});
+  TfLiteQuantizationParams quant;
+  for (int i : {0, 2, 3, 4, 5}) {
+    interpreter.SetTensorParametersReadWrite(
+        /*tensor_index=*/i, /*type=*/kTfLiteFloat32, /*name=*/"",
+        /*dims=*/{2, 2, 1, 1}, /*quantization=*/quant);
+  }
+  interpreter.SetTensorParametersReadWrite(
+      /*tensor_index=*/1, /*type=*/kTfLiteInt32, /*name=*/"", /*dims=*/{4, 2},
+      /*quantization=*/quant);
+  TfLiteRegistration* pad_op = tflite::ops::builtin::Register_PADV2();
+  TfLiteRegistration* neg_op = tflite::ops::builtin::Register_NEG();
+  ASSERT_EQ(interpreter.AddNodeWithParameters({0, 1}, {2}, nullptr, 0,
+                                              nullptr, pad_op),
+            kTfLiteOk);
+  for (const std::pair<int, int>& edge :
+       std::vector<std::pair<int, int>>{{2, 3}, {0, 4}, {4, 5}}) {
+    ASSERT_EQ(interpreter.AddNodeWithParameters(
+                  {edge.first}, {edge.second}, nullptr, 0, nullptr, neg_op),
+              kTfLiteOk);
+  }
+  ASSERT_EQ(interpreter.AllocateTensors(), kTfLiteOk);
+  ASSERT_EQ(interpreter.tensor(2)->allocation_type, kTfLiteDynamic);
+
+  float* input = interpreter.typed_tensor<float>(0);
+  for (int i = 0; i < 4; ++i) input[i] = i;
+  const std::vector<int> padding = {1, 1, 0, 0, 0, 0, 0, 0};
+  for (int i = 0; i < padding.size(); ++i) {
+    interpreter.typed_tensor<int>(1)[i] = padding[i];
+  }
+  ASSERT_EQ(interpreter.Invoke(), kTfLiteOk);
+  ASSERT_EQ(interpreter.tensor(3)->bytes, sizeof(float) * 4 * 2);
+  const float* padded = interpreter.typed_tensor<float>(3);
+  for (int i = 0; i < 8; ++i) {
+    EXPECT_EQ(padded[i], (i < 2 || i >= 6) ? 0 : -(i - 2));
+  }
+  for (int i = 0; i < 4; ++i) {
+    EXPECT_EQ(interpreter.typed_tensor<float>(5)[i], i);
+  }
+}
+
+TEST(BasicInterpreter, PipelinedDelegatePartition) {
+  // neg -> delegate kernel that doubles -> neg.
+  Interpreter interpreter;
+  InterpreterOptions options;
+  options.SetPipelineDepth(2);
+  interpreter.ApplyOptions(&options);
+  interpreter.AddTensors(4);
+  interpreter.SetInputs({0});
+  interpreter.SetOutputs({3});
+  TfLiteQuantizationParams quant;
+  for (int i = 0; i < 4; ++i) {
+    interpreter.SetTensorParametersReadWrite(
+        /*tensor_index=*/i, /*type=*/kTfLiteFloat32, /*name=*/"",
+        /*dims=*/{3}, /*quantization=*/quant);
+  }
+  TfLiteRegistration* neg_op = tflite::ops::builtin::Register_NEG();
+  for (int i = 0; i < 3; ++i) {
+    ASSERT_EQ(interpreter.AddNodeWithParameters({i}, {i + 1}, nullptr, 0,
+                                                nullptr, neg_op),
+              kTfLiteOk);
+  }
+
+  TfLiteDelegate delegate = TfLiteDelegateCreate();
+  delegate.Prepare = [](TfLiteContext* context,
+                        TfLiteDelegate* delegate) -> TfLiteStatus {
+    TfLiteRegistration registration = {nullptr, nullptr, nullptr, nullptr};
+    registration.prepare = [](TfLiteContext* context, TfLiteNode* node) {
+      const TfLiteTensor& input = context->tensors[node->inputs->data[0]];
+      return context->ResizeTensor(context,
+                                   &context->tensors[node->outputs->data[0]],
+                                   TfLiteIntArrayCopy(input.dims));
+    };
+    registration.invoke = [](TfLiteContext* context, TfLiteNode* node) {
+      const TfLiteTensor& input = context->tensors[node->inputs->data[0]];
+      TfLiteTensor& output = context->tensors[node->outputs->data[0]];
+      for (int i = 0; i < NumElements(&input); ++i) {
+        output.data.f[i] = 2 * input.data.f[i];
+      }
+      return kTfLiteOk;
+    };
+    registration.custom_name = "double";
+    registration.builtin_code = kTfLiteBuiltinDelegate;
+    TfLiteIntArray* nodes_to_replace = TfLiteIntArrayCreate(1);
+    nodes_to_replace->data[0] = 1;
+    const TfLiteStatus status = context->ReplaceNodeSubsetsWithDelegateKernels(
+        context, registration, nodes_to_replace, delegate);
+    TfLiteIntArrayFree(nodes_to_replace);
+    return status;
+  };
+  ASSERT_EQ(interpreter.ModifyGraphWithDelegate(&delegate), kTfLiteOk);
+  ASSERT_EQ(interpreter.AllocateTensors(), kTfLiteOk);
+
+  // Invoke() runs the pipeline too.
+  float* input = interpreter.typed_tensor<float>(0);
+  for (int i = 0; i < 3; ++i) input[i] = i;
+  ASSERT_EQ(interpreter.Invoke(), kTfLiteOk);
+  for (int i = 0; i < 3; ++i) {
+    EXPECT_EQ(interpreter.typed_tensor<float>(3)[i], 2 * i);
+  }
+
+  // Each invocation is waited for after the next one starts.
+  int64_t previous_handle = -1;
+  for (int run = 0; run <= 10; ++run) {
+    int64_t handle = -1;
+    if (run < 10) {
+      for (int i = 0; i < 3; ++i) input[i] = run + i;
+      ASSERT_EQ(interpreter.InvokeAsync(&handle), kTfLiteOk);
+    }
+    if (previous_handle >= 0) {
+      ASSERT_EQ(interpreter.Wait(previous_handle), kTfLiteOk);
+      for (int i = 0; i < 3; ++i) {
+        EXPECT_EQ(interpreter.typed_tensor<float>(3)[i], 2 * (run - 1 + i));
+      }
+    }
+    previous_handle = handle;
+  }
+  // Handles must be waited for in order.
+  int64_t first_handle, second_handle;
+  ASSERT_EQ(interpreter.InvokeAsync(&first_handle), kTfLiteOk);
+  ASSERT_EQ(interpreter.InvokeAsync(&second_handle), kTfLiteOk);
+  EXPECT_EQ(interpreter.Wait(second_handle), kTfLiteError);
+  EXPECT_EQ(interpreter.Wait(first_handle), kTfLiteOk);
+  EXPECT_EQ(interpreter.Wait(second_handle), kTfLiteOk);
+}
+
+TEST(BasicInterpreter, ArenaPlanCache) {
+  Interpreter interpreter;
+  InterpreterOptions options;
+  options.SetArenaPlanCacheSize(2);
+  interpreter.ApplyOptions(&options);
+  interpreter.AddTensors(3);
+  interpreter.SetInputs({0});
+  interpreter.SetOutputs({2});
+  TfLiteQuantizationParams quant;
+  for (int i = 0; i < 3; ++i) {
+    interpreter.SetTensorParametersReadWrite(
+        /*tensor_index=*/i, /*type=*/kTfLiteFloat32, /*name=*/"",
+        /*dims=*/{1}, /*quantization=*/quant);
+  }
+  TfLiteRegistration* neg_op = tflite::ops::builtin::Register_NEG();
+  interpreter.AddNodeWithParameters({0}, {1}, nullptr, 0, nullptr, neg_op);
+  interpreter.AddNodeWithParameters({1}, {2}, nullptr, 0, nullptr, neg_op);
+
+  // The plans of the sizes that come back are reused.
+  for (int size : {3, 8, 3, 8, 5, 3}) {
+    ASSERT_EQ(interpreter.ResizeInputTensor(0, {size}), kTfLiteOk);
+    ASSERT_EQ(interpreter.AllocateTensors(), kTfLiteOk);
+    float* input = interpreter.typed_tensor<float>(0);
+    for (int i = 0; i < size; ++i) input[i] = i;
+    ASSERT_EQ(interpreter.Invoke(), kTfLiteOk);
+    ASSERT_EQ(interpreter.tensor(2)->bytes, sizeof(float) * size);
+    for (int i = 0; i < size; ++i) {
+      EXPECT_EQ(interpreter.typed_tensor<float>(2)[i], i);
+    }
+  }
+}
+
 TEST(InterpreterTensorsCapacityTest, TestWithinHeadroom) {
   Interpreter interpreter;
   ASSERT_EQ(interpreter.AddTensors(Interpreter::kTensorsReservedCapacity),
@@ -1688,6 +1893,33 @@ TEST_F(TestCustomAllocation, InsufficientBytes) {
   ASSERT_EQ(interpreter_->Invoke(), kTfLiteError);
 }
 
+TEST_F(TestCustomAllocation, ReassignAfterAllocateTensors) {
+  ASSERT_EQ(interpreter_->AllocateTensors(), kTfLiteOk);
+  AssignCustomAllocForTensor(interpreter_->inputs()[0],
+                             /*required_alignment=*/kDefaultTensorAlignment);
+  AssignCustomAllocForTensor(interpreter_->outputs()[0],
+                             /*required_alignment=*/kDefaultTensorAlignment);
+  // The tensors are already allocated, so the allocations take effect without
+  // AllocateTensors().
+  VerifyInvoke();
+  const TfLiteTensor* output = interpreter_->tensor(interpreter_->outputs()[0]);
+  const void* first_output_data = output->data.raw;
+
+  AssignCustomAllocForTensor(interpreter_->inputs()[0],
+                             /*required_alignment=*/kDefaultTensorAlignment);
+  AssignCustomAllocForTensor(interpreter_->outputs()[0],
+                             /*required_alignment=*/kDefaultTensorAlignment);
+  EXPECT_NE(first_output_data, output->data.raw);
+  VerifyInvoke();
+
+  // Too small allocations are rejected right away.
+  auto small_alloc = NewCustomAlloc(4, kDefaultTensorAlignment);
+  ASSERT_EQ(interpreter_->SetCustomAllocationForTensor(
+                interpreter_->inputs()[0], small_alloc),
+            kTfLiteError);
+  VerifyInvoke();
+}
+
 TEST_F(TestCustomAllocation, CustomInputAlloc) {
   // Set custom allocation for one input tensor.
   AssignCustomAllocForTensor(interpreter_->inputs()[0],
@@ -1191,9 +1191,15 @@ TfLiteStatus SoftmaxQuantized<int16, int16>(TfLiteContext* context,
                                             SoftmaxOpData* data,
                                             KernelType kernel_type) {
   if (NumDimensions(input) >= 1 && NumDimensions(input) <= 4) {
-    reference_ops::SoftmaxInt16(
-        data->params, GetTensorShape(input), GetTensorData<int16_t>(input),
-        GetTensorShape(output), GetTensorData<int16_t>(output));
+    if (kernel_type == kReference) {
+      reference_ops::SoftmaxInt16(
+          data->params, GetTensorShape(input), GetTensorData<int16_t>(input),
+          GetTensorShape(output), GetTensorData<int16_t>(output));
+    } else {
+      optimized_ops::SoftmaxInt16(
+          data->params, GetTensorShape(input), GetTensorData<int16_t>(input),
+          GetTensorShape(output), GetTensorData<int16_t>(output));
+    }
     return kTfLiteOk;
   } else {
     TF_LITE_KERNEL_LOG(context,
@@ -1548,6 +1548,39 @@ TEST_P(SoftmaxOpTest, Softmax2DInt16) {
                   kQuantizedToleranceInt16)));
 }
 
+TEST_P(SoftmaxOpTest, Softmax2DInt16Wide) {
+  // Rows wide enough to exercise the vectorized loops as well as the
+  // leftovers.
+  const float kMin = -1;
+  const float kMax = 32767.f / 32768.f;
+  const int kDepth = 21;
+  QuantizedActivationsOpModel m(
+      GetRegistration(), 0.5,
+      /*input=*/{TensorType_INT16, {2, kDepth}, 10 * kMin, 10 * kMax},
+      TensorType_INT16);
+  std::vector<float> input(2 * kDepth);
+  for (int i = 0; i < 2 * kDepth; ++i) {
+    input[i] = static_cast<float>((i * 7) % 19) * 0.5f - 4.0f;
+  }
+  m.SetInput<int16_t>(input);
+  ASSERT_EQ(m.Invoke(), kTfLiteOk);
+
+  std::vector<float> expected(2 * kDepth);
+  for (int row = 0; row < 2; ++row) {
+    const float* in = input.data() + row * kDepth;
+    const float max_in_row = *std::max_element(in, in + kDepth);
+    float sum = 0.f;
+    for (int c = 0; c < kDepth; ++c) {
+      expected[row * kDepth + c] = std::exp(0.5f * (in[c] - max_in_row));
+      sum += expected[row * kDepth + c];
+    }
+    for (int c = 0; c < kDepth; ++c) expected[row * kDepth + c] /= sum;
+  }
+  EXPECT_THAT(m.GetDequantizedOutput<int16_t>(),
+              ElementsAreArray(
+                  ArrayFloatNear(expected, kQuantizedToleranceInt16)));
+}
+
 TEST_P(SoftmaxOpTest, Softmax3DInt16) {
   const float kMin = -1;
   const float kMax = 32767.f / 32768.f;
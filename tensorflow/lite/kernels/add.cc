@@ -336,7 +336,11 @@ TfLiteStatus EvalAddQuantized(TfLiteContext* context, TfLiteNode* node,
       }
     } else if (output->type == kTfLiteInt16) {
       if (need_broadcast) {
-        TF_LITE_ADD(reference_ops, BroadcastAdd4DSlow, int16_t);
+        if (kernel_type == kReference) {
+          TF_LITE_ADD(reference_ops, BroadcastAdd4DSlow, int16_t);
+        } else {
+          TF_LITE_ADD(optimized_integer_ops, BroadcastAddDispatch, int16_t);
+        }
       } else {
         if (kernel_type == kReference) {
           reference_ops::Add(
@@ -16,6 +16,7 @@ limitations under the License.
 #include "tensorflow/lite/kernels/internal/reference/batch_matmul.h"
 
 #include <stddef.h>
+#include <string.h>
 
 #include <algorithm>
 #include <cstdint>
@@ -33,6 +34,7 @@ limitations under the License.
 #include "tensorflow/lite/kernels/internal/tensor_utils.h"
 #include "tensorflow/lite/kernels/internal/types.h"
 #include "tensorflow/lite/kernels/kernel_util.h"
+#include "tensorflow/lite/kernels/weights_cache.h"
 
 namespace tflite {
 namespace ops {
@@ -190,7 +192,11 @@ TfLiteStatus InitializeTemporaries(TfLiteContext* context, TfLiteNode* node,
     scratch_buffer_size->data[rhs_rank - 2] = rhs->dims->data[rhs_rank - 1];
     scratch_buffer_size->data[rhs_rank - 1] = rhs->dims->data[rhs_rank - 2];
 
-    if (IsConstantTensor(op_context->rhs)) {
+    // With a weights cache, a constant RHS is transposed into the arena upon
+    // each eval, or copied from the cache.
+    if (IsConstantTensor(op_context->rhs) &&
+        CpuBackendContext::GetFromContext(context)->weights_cache() ==
+            nullptr) {
       scratch_buffer->allocation_type = kTfLiteArenaRwPersistent;
     } else {
       scratch_buffer->allocation_type = kTfLiteArenaRw;
@@ -432,6 +438,32 @@ TfLiteStatus TransposeRowsColumns(TfLiteContext* context,
   }
 }
 
+// Transposes the constant `rhs` into the non-persistent `transposed_rhs`,
+// copying it from the weights cache when it is there.
+TfLiteStatus TransposeConstantRhs(TfLiteContext* context,
+                                  const TfLiteTensor* rhs,
+                                  TfLiteTensor* transposed_rhs) {
+  WeightsCache* weights_cache =
+      CpuBackendContext::GetFromContext(context)->weights_cache();
+  if (weights_cache == nullptr) {
+    return TransposeRowsColumns(context, rhs, transposed_rhs);
+  }
+  if (const void* cached = weights_cache->Find(
+          rhs->data.raw_const, kWeightsCacheBatchMatMulTransposedRhs,
+          transposed_rhs->bytes)) {
+    memcpy(transposed_rhs->data.raw, cached, transposed_rhs->bytes);
+    return kTfLiteOk;
+  }
+  TF_LITE_ENSURE_OK(context,
+                    TransposeRowsColumns(context, rhs, transposed_rhs));
+  if (void* buffer = weights_cache->Insert(
+          rhs->data.raw_const, kWeightsCacheBatchMatMulTransposedRhs,
+          transposed_rhs->bytes)) {
+    memcpy(buffer, transposed_rhs->data.raw, transposed_rhs->bytes);
+  }
+  return kTfLiteOk;
+}
+
 RuntimeShape SwapRowColumnDims(const RuntimeShape& shape) {
   RuntimeShape swapped_shape(shape);
   const int32_t dims = shape.DimensionsCount();
@@ -725,8 +757,13 @@ TfLiteStatus Eval(TfLiteContext* context, TfLiteNode* node) {
   if (!adj_y) {
     // TODO(b/154760341) Constant tensors should already be transposed, but
     // we transpose once if necessary for now.
-    if (!(IsConstantTensor(rhs) && op_data->rhs_transposed)) {
-      TransposeRowsColumns(context, rhs, GetTemporary(context, node, 1));
+    TfLiteTensor* transposed_rhs = GetTemporary(context, node, 1);
+    if (IsConstantTensor(rhs) &&
+        transposed_rhs->allocation_type != kTfLiteArenaRwPersistent) {
+      TF_LITE_ENSURE_OK(context,
+                        TransposeConstantRhs(context, rhs, transposed_rhs));
+    } else if (!(IsConstantTensor(rhs) && op_data->rhs_transposed)) {
+      TransposeRowsColumns(context, rhs, transposed_rhs);
       op_data->rhs_transposed = true;
     }
   }
@@ -357,6 +357,15 @@ class ConstRHSBatchMatMulOpModel : public MultiOpModel {
     return GetTensorShape(neg_output_id_);
   }
 
+  // Switches the interpreter to the bounded weights cache mode, in which the
+  // transposed RHS is not kept in a persistent tensor.
+  TfLiteStatus SetWeightsCacheSize(int64_t max_size_bytes) {
+    InterpreterOptions options;
+    options.SetWeightsCacheSize(max_size_bytes);
+    TF_LITE_ENSURE_STATUS(interpreter_->ApplyOptions(&options));
+    return interpreter_->AllocateTensors();
+  }
+
  protected:
   int lhs_id_;
   int rhs_id_;
@@ -384,6 +393,26 @@ TEST(ConstRHSBatchMatMulOpModel, RHSNotAdjoint) {
   EXPECT_THAT(model.GetOutputShape(), ElementsAreArray({1, 6, 3}));
 }
 
+TEST(ConstRHSBatchMatMulOpModel, RHSNotAdjointWithWeightsCache) {
+  // A cache of 0 bytes transposes the RHS on every evaluation; a larger one
+  // serves it from the cache after the first.
+  for (int64_t cache_size : {0, 1024}) {
+    ConstRHSBatchMatMulOpModel model({TensorType_FLOAT32, {1, 6, 2}}, {2, 3},
+                                     {6, 3, 7, 4, 6, 9});
+    ASSERT_EQ(model.SetWeightsCacheSize(cache_size), kTfLiteOk);
+    for (int i = 0; i < 2; ++i) {
+      model.PopulateTensor<float>(model.lhs(),
+                                  {6, 3, 7, 4, 6, 9, 2, 6, 7, 4, 3, 7});
+      ASSERT_EQ(model.Invoke(), kTfLiteOk);
+      EXPECT_THAT(model.GetOutput(),
+                  ElementsAreArray({-48, -36, -69, -58, -45, -85, -72, -72,
+                                    -123, -36, -42, -68, -58, -45, -85, -46,
+                                    -51, -84}));
+      EXPECT_THAT(model.GetOutputShape(), ElementsAreArray({1, 6, 3}));
+    }
+  }
+}
+
 // In the hybrid model the weights are quantized int8. But the input
 // and output are expected to be in float precision.
 class HybridBatchMatMulOpModel : public SingleOpModel {
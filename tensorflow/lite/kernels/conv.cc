@@ -37,6 +37,7 @@ limitations under the License.
 #include "tensorflow/lite/kernels/internal/optimized/multithreaded_conv.h"
 #endif
 #include "tensorflow/lite/kernels/internal/optimized/optimized_ops.h"
+#include "tensorflow/lite/kernels/internal/optimized/sparse_ops/fully_connected.h"
 #include "tensorflow/lite/kernels/internal/quantization_util.h"
 #include "tensorflow/lite/kernels/internal/reference/conv.h"
 #include "tensorflow/lite/kernels/internal/reference/integer_ops/conv.h"
@@ -45,6 +46,7 @@ limitations under the License.
 #include "tensorflow/lite/kernels/internal/tensor_utils.h"
 #include "tensorflow/lite/kernels/kernel_util.h"
 #include "tensorflow/lite/kernels/padding.h"
+#include "tensorflow/lite/kernels/weights_cache.h"
 #include "tensorflow/lite/util.h"
 
 namespace tflite {
@@ -120,6 +122,14 @@ struct OpData {
 
   // Number of convolution groups.
   int32_t groups = 1;
+
+  // A 1x1 convolution with a block sparse filter runs on the sparse
+  // FullyConnected kernels, with the filter seen as a 2D
+  // [output_channels, input_channels] matrix. `sparse_filter` describes that
+  // matrix and shares the segments and indices of the filter's sparsity.
+  bool is_sparse_1x1 = false;
+  TfLiteDimensionMetadata sparse_filter_dim_metadata[3];
+  TfLiteSparsity sparse_filter;
 };
 
 inline PaddingType RuntimePaddingType(TfLitePadding padding) {
@@ -155,11 +165,11 @@ void Free(TfLiteContext* context, void* buffer) {
 // Naive implementation of transpose for floats. Could be optimized to be more
 // cache friendly, but for now it's a one-time cost on first run, and we would
 // prefer to remove the need to do this at all eventually.
-void TransposeFloatTensor(const TfLiteTensor* input, TfLiteTensor* output) {
+void TransposeFloatTensor(const TfLiteTensor* input,
+                          const TfLiteTensor* output, float* output_data) {
   const int rows = output->dims->data[1];
   const int cols = output->dims->data[0];
   const float* input_data = GetTensorData<float>(input);
-  float* output_data = GetTensorData<float>(output);
   for (int i = 0; i < rows; ++i) {
     for (int j = 0; j < cols; ++j) {
       const float in_value = input_data[i * cols + j];
@@ -168,6 +178,38 @@ void TransposeFloatTensor(const TfLiteTensor* input, TfLiteTensor* output) {
   }
 }
 
+// Returns the filter transposed to HWCN. The transposed filter stays in the
+// persistent `hwcn_weights`, or, with a weights cache, is looked up in the
+// cache and otherwise transposed again.
+const float* GetHwcnWeights(TfLiteContext* context, OpData* data,
+                            const TfLiteTensor* filter,
+                            TfLiteTensor* hwcn_weights) {
+  float* hwcn_weights_data = GetTensorData<float>(hwcn_weights);
+  if (hwcn_weights->allocation_type == kTfLiteArenaRwPersistent) {
+    if (!data->have_weights_been_transposed) {
+      TransposeFloatTensor(filter, hwcn_weights, hwcn_weights_data);
+      data->have_weights_been_transposed = true;
+    }
+    return hwcn_weights_data;
+  }
+  WeightsCache* weights_cache =
+      CpuBackendContext::GetFromContext(context)->weights_cache();
+  if (weights_cache != nullptr) {
+    if (void* cached = weights_cache->Find(filter->data.raw_const,
+                                           kWeightsCacheConvHwcnFilter,
+                                           hwcn_weights->bytes)) {
+      return static_cast<const float*>(cached);
+    }
+    if (void* buffer = weights_cache->Insert(filter->data.raw_const,
+                                             kWeightsCacheConvHwcnFilter,
+                                             hwcn_weights->bytes)) {
+      hwcn_weights_data = static_cast<float*>(buffer);
+    }
+  }
+  TransposeFloatTensor(filter, hwcn_weights, hwcn_weights_data);
+  return hwcn_weights_data;
+}
+
 // Check if im2col needs to be allocated, as some version of optimized Conv dont
 // use it. If any change is supporting im2col in any of the Conv versions, then
 // it should be updated here as well
@@ -330,6 +372,62 @@ static TfLiteStatus AllocateTemporaryTensorsIfRequired(
   return kTfLiteOk;
 }
 
+// Sets up the 2D view of a block sparse filter. Only 1x1 convolutions with
+// unit strides and dilations, and [output_channels, 1, 1, input_channels]
+// float filters blocked along the input channels as the converter writes them
+// are supported.
+TfLiteStatus PrepareSparse1x1Filter(TfLiteContext* context,
+                                    const TfLiteConvParams* params,
+                                    const TfLiteTensor* input,
+                                    const TfLiteTensor* filter, OpData* data) {
+  const TfLiteSparsity& sparsity = *filter->sparsity;
+  const TfLiteDimensionMetadata* dim_metadata = sparsity.dim_metadata;
+  const bool is_1x1 = filter->dims->data[1] == 1 &&
+                      filter->dims->data[2] == 1 && params->stride_width == 1 &&
+                      params->stride_height == 1 &&
+                      params->dilation_width_factor == 1 &&
+                      params->dilation_height_factor == 1 && data->groups == 1;
+  bool is_supported_format =
+      sparsity.dim_metadata_size == 5 && sparsity.traversal_order != nullptr &&
+      sparsity.traversal_order->size == 5 && sparsity.block_map != nullptr &&
+      sparsity.block_map->size == 1 && sparsity.block_map->data[0] == 3 &&
+      dim_metadata[0].format == kTfLiteDimDense &&
+      dim_metadata[1].format == kTfLiteDimDense &&
+      dim_metadata[2].format == kTfLiteDimDense &&
+      dim_metadata[3].format == kTfLiteDimSparseCSR &&
+      dim_metadata[4].format == kTfLiteDimDense &&
+      (dim_metadata[4].dense_size == 4 || dim_metadata[4].dense_size == 16);
+  for (int i = 0; is_supported_format && i < 5; ++i) {
+    is_supported_format = sparsity.traversal_order->data[i] == i;
+  }
+  if (input->type != kTfLiteFloat32 || filter->type != kTfLiteFloat32 ||
+      !is_1x1 || !is_supported_format) {
+    TF_LITE_KERNEL_LOG(context, "Unsupported sparse convolution filter.");
+    return kTfLiteError;
+  }
+
+  const int output_channels = filter->dims->data[0];
+  const int input_channels = filter->dims->data[3];
+  const int block_size = dim_metadata[4].dense_size;
+  const TfLiteIntArray* segments = dim_metadata[3].array_segments;
+  const TfLiteIntArray* indices = dim_metadata[3].array_indices;
+  TF_LITE_ENSURE_EQ(context, input_channels % block_size, 0);
+  TF_LITE_ENSURE_EQ(context, segments->size, output_channels + 1);
+  for (int i = 0; i < indices->size; ++i) {
+    TF_LITE_ENSURE(context, indices->data[i] >= 0 &&
+                                indices->data[i] < input_channels / block_size);
+  }
+
+  data->sparse_filter_dim_metadata[0] = dim_metadata[0];
+  data->sparse_filter_dim_metadata[1] = dim_metadata[3];
+  data->sparse_filter_dim_metadata[2] = dim_metadata[4];
+  data->sparse_filter = sparsity;
+  data->sparse_filter.dim_metadata = data->sparse_filter_dim_metadata;
+  data->sparse_filter.dim_metadata_size = 3;
+  data->is_sparse_1x1 = true;
+  return kTfLiteOk;
+}
+
 TfLiteStatus Prepare(KernelType kernel_type, TfLiteContext* context,
                      TfLiteNode* node) {
   auto* params = reinterpret_cast<TfLiteConvParams*>(node->builtin_data);
@@ -433,6 +531,15 @@ TfLiteStatus Prepare(KernelType kernel_type, TfLiteContext* context,
       (params->dilation_height_factor == 1) &&
       (filter->allocation_type != kTfLiteArenaRw) && !IsDynamicTensor(filter);
 
+  data->is_sparse_1x1 = false;
+  if (filter->sparsity != nullptr) {
+    TF_LITE_ENSURE_STATUS(
+        PrepareSparse1x1Filter(context, params, input, filter, data));
+    // The sparse kernels read the compressed filter directly, without HWCN
+    // weights or im2col.
+    data->supports_multithreaded_kernel = false;
+  }
+
   int channels_in = filter->dims->data[3];
   int channels_out = filter->dims->data[0];
   int width = input->dims->data[2];
@@ -533,7 +640,12 @@ TfLiteStatus Prepare(KernelType kernel_type, TfLiteContext* context,
     TfLiteTensor* hwcn_weights =
         &context->tensors[node->temporaries->data[data->hwcn_weights_index]];
     hwcn_weights->type = input_type;
-    hwcn_weights->allocation_type = kTfLiteArenaRwPersistent;
+    // With a weights cache, the transposed weights are looked up in the cache
+    // upon each eval, and otherwise transposed again into the arena.
+    hwcn_weights->allocation_type =
+        CpuBackendContext::GetFromContext(context)->weights_cache() != nullptr
+            ? kTfLiteArenaRw
+            : kTfLiteArenaRwPersistent;
 
     auto hwcn_weights_status =
         context->ResizeTensor(context, hwcn_weights, hwcn_weights_size);
@@ -858,10 +970,42 @@ void EvalFloat(TfLiteContext* context, TfLiteNode* node,
                TfLiteConvParams* params, OpData* data,
                const TfLiteTensor* input, const TfLiteTensor* filter,
                const TfLiteTensor* bias, TfLiteTensor* im2col,
-               TfLiteTensor* hwcn_weights, TfLiteTensor* output) {
+               const float* hwcn_weights_data, TfLiteTensor* output) {
   float output_activation_min, output_activation_max;
   CalculateActivationRange(params->activation, &output_activation_min,
                            &output_activation_max);
+
+  if (data->is_sparse_1x1) {
+    // A 1x1 convolution is a fully connected layer over the pixels.
+    FullyConnectedParams fc_params;
+    fc_params.float_activation_min = output_activation_min;
+    fc_params.float_activation_max = output_activation_max;
+    const int input_depth = filter->dims->data[3];
+    const int output_depth = filter->dims->data[0];
+    const int pixels = NumElements(input) / input_depth;
+    const RuntimeShape fc_input_shape({pixels, input_depth});
+    const RuntimeShape fc_filter_shape({output_depth, input_depth});
+    const RuntimeShape fc_output_shape({pixels, output_depth});
+    if (data->sparse_filter.dim_metadata[2].dense_size == 4) {
+      optimized_ops::FullyConnectedSparseWeight1x4(
+          data->sparse_filter, fc_params, fc_input_shape,
+          GetTensorData<float>(input), fc_filter_shape,
+          GetTensorData<float>(filter), GetTensorShape(bias),
+          GetTensorData<float>(bias), fc_output_shape,
+          GetTensorData<float>(output),
+          CpuBackendContext::GetFromContext(context));
+    } else {
+      optimized_ops::FullyConnectedSparseWeight1x16(
+          data->sparse_filter, fc_params, fc_input_shape,
+          GetTensorData<float>(input), fc_filter_shape,
+          GetTensorData<float>(filter), GetTensorShape(bias),
+          GetTensorData<float>(bias), fc_output_shape,
+          GetTensorData<float>(output),
+          CpuBackendContext::GetFromContext(context));
+    }
+    return;
+  }
+
   KernelType effective_kernel_type = kernel_type;
   // Fall back to the optimized path if multi-threaded conv is unsupported.
   if ((kernel_type == kMultithreadOptimized) &&
@@ -928,7 +1072,7 @@ void EvalFloat(TfLiteContext* context, TfLiteNode* node,
 #if defined(TFLITE_WITH_MULTITHREADED_EIGEN)
       const float* filter_data;
       if (data->need_hwcn_weights) {
-        filter_data = GetTensorData<float>(hwcn_weights);
+        filter_data = hwcn_weights_data;
       } else {
         filter_data = GetTensorData<float>(filter);
       }
@@ -1163,10 +1307,10 @@ TfLiteStatus EvalImpl(TfLiteContext* context, TfLiteNode* node) {
           ? &context->tensors[node->temporaries->data[data->hwcn_weights_index]]
           : nullptr;
 
-  if (data->need_hwcn_weights && !data->have_weights_been_transposed) {
-    TransposeFloatTensor(filter, hwcn_weights);
-    data->have_weights_been_transposed = true;
-  }
+  const float* hwcn_weights_data =
+      data->need_hwcn_weights
+          ? GetHwcnWeights(context, data, filter, hwcn_weights)
+          : nullptr;
 
   TFLITE_DCHECK_EQ(input_type, input->type);
   switch (input_type) {  // Already know in/outtypes are same.
@@ -1190,7 +1334,7 @@ TfLiteStatus EvalImpl(TfLiteContext* context, TfLiteNode* node) {
         }
       } else {
         EvalFloat<kernel_type>(context, node, params, data, input, filter, bias,
-                               im2col, hwcn_weights, output);
+                               im2col, hwcn_weights_data, output);
       }
       break;
     case kTfLiteUInt8:
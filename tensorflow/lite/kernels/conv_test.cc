@@ -478,6 +478,79 @@ TEST_P(ConvolutionOpTest, PointwiseFloat32) {
                              }));
 }
 
+class SparseConvolutionOpModel : public SingleOpModel {
+ public:
+  SparseConvolutionOpModel(TfLiteRegistration* registration,
+                           const TensorData& input, const TensorData& filter,
+                           const std::vector<float>& filter_data,
+                           int num_threads = -1) {
+    input_ = AddInput(input);
+    filter_ = AddConstSparseInput(filter, filter_data);
+    bias_ = AddInput({TensorType_FLOAT32, {filter.shape[0]}});
+    output_ = AddOutput({TensorType_FLOAT32, {}});
+
+    SetBuiltinOp(
+        BuiltinOperator_CONV_2D, BuiltinOptions_Conv2DOptions,
+        CreateConv2DOptions(builder_, Padding_VALID, /*stride_w=*/1,
+                            /*stride_h=*/1, ActivationFunctionType_NONE)
+            .Union());
+    resolver_ = std::make_unique<SingleOpResolver>(BuiltinOperator_CONV_2D,
+                                                   registration);
+    BuildInterpreter({GetShape(input_), GetShape(filter_), GetShape(bias_)},
+                     num_threads, /*allow_fp32_relax_to_fp16=*/false,
+                     /*apply_delegate=*/false);
+  }
+
+  void SetBias(std::initializer_list<float> f) { PopulateTensor(bias_, f); }
+  void SetInput(std::initializer_list<float> data) {
+    PopulateTensor(input_, data);
+  }
+  std::vector<float> GetOutput() { return ExtractVector<float>(output_); }
+  std::vector<int> GetOutputShape() { return GetTensorShape(output_); }
+
+ private:
+  int input_;
+  int filter_;
+  int bias_;
+  int output_;
+};
+
+TEST_P(ConvolutionOpTest, PointwiseSparse1x4Float32) {
+  TensorData filter = {TensorType_FLOAT32, {3, 1, 1, 4}};
+  filter.traversal_order = {0, 1, 2, 3, 4};
+  filter.format = {kTfLiteDimDense, kTfLiteDimDense, kTfLiteDimDense,
+                   kTfLiteDimSparseCSR};
+  filter.block_map = {3};
+  filter.block_size = {4};
+  for (int num_threads = 1; num_threads <= 2; num_threads++) {
+    SparseConvolutionOpModel m(GetRegistration(),
+                               {TensorType_FLOAT32, {1, 2, 2, 4}}, filter,
+                               {
+                                   1, 2, 3, 4,   // first filter
+                                   0, 0, 0, 0,   // second filter
+                                   -1, 0, 1, 0,  // third filter
+                               },
+                               num_threads);
+    m.SetInput({
+        1, 1, 1, 1,    // x = 0, y = 0
+        1, 2, 3, 4,    // x = 1, y = 0
+        0, 0, 0, 0,    // x = 0, y = 1
+        -1, 1, -1, 1,  // x = 1, y = 1
+    });
+    m.SetBias({1, 2, 3});
+
+    ASSERT_EQ(m.Invoke(), kTfLiteOk);
+
+    EXPECT_THAT(m.GetOutputShape(), ElementsAreArray({1, 2, 2, 3}));
+    EXPECT_THAT(m.GetOutput(), ElementsAreArray({
+                                   11, 2, 3,  // x = 0, y = 0
+                                   31, 2, 5,  // x = 1, y = 0
+                                   1, 2, 3,   // x = 0, y = 1
+                                   3, 2, 3,   // x = 1, y = 1
+                               }));
+  }
+}
+
 // TODO(alanchiao): this passes locally, but fails on continuous build system.
 // Re-enable when root cause found.
 TEST_P(ConvolutionOpTest, DISABLED_PointwiseMultifilterFloat32) {
@@ -80,6 +80,10 @@ bool CpuBackendContext::CpuInfo::Avx512() {
          cpuinfo_has_x86_avx512dq() && cpuinfo_has_x86_avx512cd() &&
          cpuinfo_has_x86_avx512bw() && cpuinfo_has_x86_avx512vl();
 }
+
+bool CpuBackendContext::CpuInfo::Avx512Vnni() {
+  return Avx512() && cpuinfo_has_x86_avx512vnni();
+}
 #else
 
 CpuBackendContext::CpuInfo::~CpuInfo() {}
@@ -97,6 +101,8 @@ bool CpuBackendContext::CpuInfo::Avx2Fma() { return false; }
 bool CpuBackendContext::CpuInfo::Avx() { return false; }
 
 bool CpuBackendContext::CpuInfo::Avx512() { return false; }
+
+bool CpuBackendContext::CpuInfo::Avx512Vnni() { return false; }
 #endif  // TFLITE_HAVE_CPUINFO
 
 CpuBackendContext* CpuBackendContext::GetFromContext(TfLiteContext* context) {
@@ -119,6 +125,12 @@ CpuBackendContext* CpuBackendContext::GetFromContext(TfLiteContext* context) {
     external_context->set_internal_backend_context(
         std::unique_ptr<TfLiteInternalBackendContext>(cpu_backend_context));
   }
+  const int64_t weights_cache_size = external_context->weights_cache_size();
+  const WeightsCache* weights_cache = cpu_backend_context->weights_cache();
+  if ((weights_cache ? static_cast<int64_t>(weights_cache->max_size_bytes())
+                     : -1) != weights_cache_size) {
+    cpu_backend_context->SetWeightsCacheSize(weights_cache_size);
+  }
 
   return cpu_backend_context;
 }
@@ -148,6 +160,14 @@ void CpuBackendContext::SetMaxNumThreads(int max_num_threads) {
 
 void CpuBackendContext::SetUseCaching(bool flag) { use_caching_ = flag; }
 
+void CpuBackendContext::SetWeightsCacheSize(int64_t max_size_bytes) {
+  if (max_size_bytes < 0) {
+    weights_cache_.reset();
+  } else {
+    weights_cache_ = std::make_unique<WeightsCache>(max_size_bytes);
+  }
+}
+
 bool CpuBackendContext::PreferGemmlowpOnX86() {
   bool use_gemmlowp_on_x86 = false;
 #if defined(TFLITE_X86_PLATFORM) && TFLITE_HAS_ATTRIBUTE_WEAK && \
@@ -21,12 +21,14 @@ limitations under the License.
 #define TFLITE_X86_PLATFORM
 #endif
 
+#include <cstdint>
 #include <memory>
 
 #include "public/gemmlowp.h"
 #include "ruy/context.h"  // from @ruy
 #include "tensorflow/lite/c/common.h"
 #include "tensorflow/lite/external_cpu_backend_context.h"
+#include "tensorflow/lite/kernels/weights_cache.h"
 
 namespace tflite {
 
@@ -53,12 +55,28 @@ class CpuBackendContext final : public TfLiteInternalBackendContext {
 
   bool use_caching() const { return use_caching_; }
 
-  void ClearCaches() override { ruy_context_->ClearPrepackedCache(); }
+  void ClearCaches() override {
+    ruy_context_->ClearPrepackedCache();
+    if (weights_cache_) weights_cache_->Clear();
+  }
+
+  // Sets the maximum size of the cache of the data derived from constant
+  // weights, see ExternalCpuBackendContext::set_weights_cache_size(). A
+  // negative size removes the cache.
+  void SetWeightsCacheSize(int64_t max_size_bytes);
+
+  // Returns the cache of the data derived from constant weights, or nullptr if
+  // the kernels keep that data in persistent memory.
+  WeightsCache* weights_cache() const { return weights_cache_.get(); }
 
   // Gemmlowp on x86 is a deprecated path but some clients may still use
   // this path based on link time dependencies.
   bool PreferGemmlowpOnX86();
 
+  // Whether the CPU supports the AVX512-VNNI instructions of the int8 GEMM
+  // path for x86, see cpu_backend_gemm_avx512_vnni.h.
+  bool HasAvx512Vnni() { return cpuinfo_.Avx512Vnni(); }
+
  private:
   bool RuyHasAvxOrAbove();
 
@@ -72,6 +90,7 @@ class CpuBackendContext final : public TfLiteInternalBackendContext {
     bool Avx();
     bool Avx2Fma();
     bool Avx512();
+    bool Avx512Vnni();
 
    private:
     enum class InitStatus {
@@ -114,6 +133,7 @@ class CpuBackendContext final : public TfLiteInternalBackendContext {
   // CpuBackendGem operations to a library that permits such an optimization
   // (currently the Ruy library only).
   bool use_caching_;
+  std::unique_ptr<WeightsCache> weights_cache_;
 
   CpuBackendContext(const CpuBackendContext&) = delete;
 };
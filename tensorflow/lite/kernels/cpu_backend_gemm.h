@@ -45,10 +45,12 @@ namespace cpu_backend_gemm {
 // * - Ruy if NEON is not available.
 
 //  On x86 platforms:
-//  (default)         |      gemmlowp   |     Ruy        | eigen |
+//  (default)         |      gemmlowp   |     Ruy**      | eigen |
 //  TFLITE_X86_RUY_\  |      Ruy        |     Ruy        | Ruy   |
 //  ENABLED && (AVX
 //  or above available)
+// ** - AVX512-VNNI kernels if the CPU has them, see
+//      cpu_backend_gemm_avx512_vnni.h.
 
 #if !defined(TFLITE_WITH_RUY) && defined(TFLITE_X86_PLATFORM)
 /* GEMM dispatch implementation for x86.
@@ -0,0 +1,289 @@
+/* Copyright 2022 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/lite/kernels/cpu_backend_gemm_avx512_vnni.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+
+#include "ruy/profiler/instrumentation.h"  // from @ruy
+#include "tensorflow/lite/kernels/cpu_backend_context.h"
+#include "tensorflow/lite/kernels/cpu_backend_gemm_params.h"
+#include "tensorflow/lite/kernels/cpu_backend_threadpool.h"
+#include "tensorflow/lite/kernels/internal/common.h"
+
+#if defined(TFLITE_X86_PLATFORM) && defined(__x86_64__) && \
+    (defined(__GNUC__) || defined(__clang__))
+#define TFLITE_AVX512_VNNI_GEMM
+#include <immintrin.h>
+#endif
+
+namespace tflite {
+namespace cpu_backend_gemm {
+namespace detail {
+namespace {
+
+#ifdef TFLITE_AVX512_VNNI_GEMM
+
+#define TFLITE_AVX512_VNNI_TARGET \
+  __attribute__((target("avx512f,avx512bw,avx512vnni")))
+
+// The kernel keeps a block of kBlockRows x kBlockCols dst entries in
+// registers, and consumes kDepthStep bytes of each lhs row and rhs column at
+// a time.
+constexpr int kBlockRows = 4;
+constexpr int kBlockCols = 4;
+constexpr int kDepthStep = 64;
+// Each task multiplies about this many bytes of rhs columns with all of its
+// lhs rows before it moves on to the next ones, so that they stay in the L2
+// cache.
+constexpr int kRhsChunkBytes = 256 * 1024;
+
+struct Problem {
+  int rows;
+  int depth;
+  int cols;
+  const std::int8_t* lhs_data;
+  std::int32_t lhs_zero_point;
+  const std::int8_t* rhs_data;
+  std::int32_t rhs_zero_point;
+  // The sums of the rhs columns, only if lhs_zero_point is not 0.
+  const std::int32_t* rhs_sums;
+  const Avx512VnniOutputStage* output_stage;
+};
+
+// Computes the dot products of kBlockRows lhs rows with kBlockCols rhs
+// columns, and the sums of the lhs rows if `lhs_sums` is not null.
+//
+// VPDPBUSD multiplies unsigned with signed bytes, so the rhs is flipped to
+// uint8(rhs + 128). That adds 128 * sum(lhs) to the dot products, which the
+// caller subtracts. The bytes past the depth load as zeros, so they don't add
+// anything.
+TFLITE_AVX512_VNNI_TARGET void DotProductBlock(
+    const std::int8_t* const* lhs_rows, const std::int8_t* const* rhs_cols,
+    int depth, std::int32_t sums[kBlockRows][kBlockCols],
+    std::int32_t* lhs_sums) {
+  __m512i acc[kBlockRows][kBlockCols];
+  __m512i lhs_acc[kBlockRows];
+  for (int r = 0; r < kBlockRows; ++r) {
+    for (int c = 0; c < kBlockCols; ++c) acc[r][c] = _mm512_setzero_si512();
+    lhs_acc[r] = _mm512_setzero_si512();
+  }
+  const __m512i flip = _mm512_set1_epi8(static_cast<char>(0x80));
+  const __m512i ones = _mm512_set1_epi8(1);
+  for (int d = 0; d < depth; d += kDepthStep) {
+    const int remaining = depth - d;
+    const __mmask64 mask = remaining >= kDepthStep
+                               ? ~__mmask64{0}
+                               : (__mmask64{1} << remaining) - 1;
+    __m512i rhs[kBlockCols];
+    for (int c = 0; c < kBlockCols; ++c) {
+      rhs[c] = _mm512_xor_si512(_mm512_maskz_loadu_epi8(mask, rhs_cols[c] + d),
+                                flip);
+    }
+    for (int r = 0; r < kBlockRows; ++r) {
+      const __m512i lhs = _mm512_maskz_loadu_epi8(mask, lhs_rows[r] + d);
+      for (int c = 0; c < kBlockCols; ++c) {
+        acc[r][c] = _mm512_dpbusd_epi32(acc[r][c], rhs[c], lhs);
+      }
+      if (lhs_sums != nullptr) {
+        lhs_acc[r] = _mm512_dpbusd_epi32(lhs_acc[r], ones, lhs);
+      }
+    }
+  }
+  for (int r = 0; r < kBlockRows; ++r) {
+    for (int c = 0; c < kBlockCols; ++c) {
+      sums[r][c] = _mm512_reduce_add_epi32(acc[r][c]);
+    }
+    if (lhs_sums != nullptr) lhs_sums[r] = _mm512_reduce_add_epi32(lhs_acc[r]);
+  }
+}
+
+template <typename DstScalar>
+void StoreEntry(const Problem& problem, int row, int col, std::int32_t acc,
+                DstScalar* dst_data) {
+  const Avx512VnniOutputStage& output_stage = *problem.output_stage;
+  if (output_stage.bias != nullptr) acc += output_stage.bias[row];
+  if (output_stage.multiplier_fixedpoint_perchannel != nullptr) {
+    acc = MultiplyByQuantizedMultiplier(
+        acc, output_stage.multiplier_fixedpoint_perchannel[row],
+        output_stage.multiplier_exponent_perchannel[row]);
+  } else {
+    acc = MultiplyByQuantizedMultiplier(acc,
+                                        output_stage.multiplier_fixedpoint,
+                                        output_stage.multiplier_exponent);
+  }
+  acc += output_stage.dst_zero_point;
+  acc = std::min(std::max(acc, output_stage.clamp_min),
+                 output_stage.clamp_max);
+  dst_data[static_cast<std::int64_t>(col) * problem.rows + row] =
+      static_cast<DstScalar>(acc);
+}
+
+// Computes the dst rows in [row_start, row_end).
+template <typename DstScalar>
+void RunRows(const Problem& problem, DstScalar* dst_data, int row_start,
+             int row_end) {
+  if (row_start >= row_end) return;
+  const int cols_per_chunk =
+      std::max(kBlockCols, kRhsChunkBytes / std::max(problem.depth, 1) /
+                               kBlockCols * kBlockCols);
+  std::vector<std::int32_t> lhs_sums(row_end - row_start);
+  for (int col_start = 0; col_start < problem.cols;
+       col_start += cols_per_chunk) {
+    const int col_end = std::min(problem.cols, col_start + cols_per_chunk);
+    for (int row = row_start; row < row_end; row += kBlockRows) {
+      // The rows and columns past the end repeat the last one, and their
+      // results are dropped.
+      const int block_rows = std::min(kBlockRows, row_end - row);
+      const std::int8_t* lhs_rows[kBlockRows];
+      for (int r = 0; r < kBlockRows; ++r) {
+        const std::int64_t lhs_row = std::min(row + r, row_end - 1);
+        lhs_rows[r] = problem.lhs_data + lhs_row * problem.depth;
+      }
+      for (int col = col_start; col < col_end; col += kBlockCols) {
+        const int block_cols = std::min(kBlockCols, col_end - col);
+        const std::int8_t* rhs_cols[kBlockCols];
+        for (int c = 0; c < kBlockCols; ++c) {
+          const std::int64_t rhs_col = std::min(col + c, col_end - 1);
+          rhs_cols[c] = problem.rhs_data + rhs_col * problem.depth;
+        }
+        std::int32_t sums[kBlockRows][kBlockCols];
+        std::int32_t block_lhs_sums[kBlockRows];
+        const bool first_block = col == 0;
+        DotProductBlock(lhs_rows, rhs_cols, problem.depth, sums,
+                        first_block ? block_lhs_sums : nullptr);
+        if (first_block) {
+          std::copy(block_lhs_sums, block_lhs_sums + block_rows,
+                    lhs_sums.begin() + (row - row_start));
+        }
+        // sum((lhs - lhs_zero_point) * (rhs - rhs_zero_point)) is the dot
+        // product minus the terms of the offsets.
+        for (int r = 0; r < block_rows; ++r) {
+          const std::int32_t lhs_sum = lhs_sums[row + r - row_start];
+          for (int c = 0; c < block_cols; ++c) {
+            std::int32_t acc =
+                sums[r][c] - (128 + problem.rhs_zero_point) * lhs_sum;
+            if (problem.lhs_zero_point != 0) {
+              acc += problem.lhs_zero_point *
+                     (problem.depth * problem.rhs_zero_point -
+                      problem.rhs_sums[col + c]);
+            }
+            StoreEntry(problem, row + r, col + c, acc, dst_data);
+          }
+        }
+      }
+    }
+  }
+}
+
+template <typename DstScalar>
+class RowsTask : public cpu_backend_threadpool::Task {
+ public:
+  RowsTask(const Problem& problem, DstScalar* dst_data, int row_start,
+           int row_end)
+      : problem_(problem),
+        dst_data_(dst_data),
+        row_start_(row_start),
+        row_end_(row_end) {}
+
+  void Run() override { RunRows(problem_, dst_data_, row_start_, row_end_); }
+
+ private:
+  const Problem& problem_;
+  DstScalar* dst_data_;
+  int row_start_;
+  int row_end_;
+};
+
+#endif  // TFLITE_AVX512_VNNI_GEMM
+
+template <typename DstScalar>
+bool Int8Gemm(int rows, int depth, int cols, const std::int8_t* lhs_data,
+              std::int32_t lhs_zero_point, const std::int8_t* rhs_data,
+              std::int32_t rhs_zero_point,
+              const Avx512VnniOutputStage& output_stage, DstScalar* dst_data,
+              CpuBackendContext* context) {
+#ifdef TFLITE_AVX512_VNNI_GEMM
+  if (!context->HasAvx512Vnni()) return false;
+  ruy::profiler::ScopeLabel label("cpu_backend_gemm::Gemm: AVX512-VNNI");
+  std::vector<std::int32_t> rhs_sums;
+  if (lhs_zero_point != 0) {
+    rhs_sums.resize(cols);
+    for (int col = 0; col < cols; ++col) {
+      const std::int8_t* rhs_col =
+          rhs_data + static_cast<std::int64_t>(col) * depth;
+      std::int32_t sum = 0;
+      for (int d = 0; d < depth; ++d) sum += rhs_col[d];
+      rhs_sums[col] = sum;
+    }
+  }
+  const Problem problem = {rows,           depth,           cols,
+                           lhs_data,       lhs_zero_point,  rhs_data,
+                           rhs_zero_point, rhs_sums.data(), &output_stage};
+
+  const int thread_count = LegacyHowManyThreads<kBlockRows>(
+      context->max_num_threads(), rows, cols, depth);
+  if (thread_count == 1) {
+    RunRows(problem, dst_data, 0, rows);
+    return true;
+  }
+  std::vector<RowsTask<DstScalar>> tasks;
+  tasks.reserve(thread_count);
+  const int rows_per_thread =
+      RoundUp<kBlockRows>(CeilQuotient(rows, thread_count));
+  int row_start = 0;
+  for (int i = 0; i < thread_count; ++i) {
+    const int row_end = std::min(rows, row_start + rows_per_thread);
+    tasks.emplace_back(problem, dst_data, row_start, row_end);
+    row_start = row_end;
+  }
+  cpu_backend_threadpool::Execute(tasks.size(), tasks.data(), context);
+  return true;
+#else
+  return false;
+#endif  // TFLITE_AVX512_VNNI_GEMM
+}
+
+}  // namespace
+
+bool Int8GemmUsingAvx512Vnni(int rows, int depth, int cols,
+                             const std::int8_t* lhs_data,
+                             std::int32_t lhs_zero_point,
+                             const std::int8_t* rhs_data,
+                             std::int32_t rhs_zero_point,
+                             const Avx512VnniOutputStage& output_stage,
+                             std::int8_t* dst_data,
+                             CpuBackendContext* context) {
+  return Int8Gemm(rows, depth, cols, lhs_data, lhs_zero_point, rhs_data,
+                  rhs_zero_point, output_stage, dst_data, context);
+}
+
+bool Int8GemmUsingAvx512Vnni(int rows, int depth, int cols,
+                             const std::int8_t* lhs_data,
+                             std::int32_t lhs_zero_point,
+                             const std::int8_t* rhs_data,
+                             std::int32_t rhs_zero_point,
+                             const Avx512VnniOutputStage& output_stage,
+                             std::int16_t* dst_data,
+                             CpuBackendContext* context) {
+  return Int8Gemm(rows, depth, cols, lhs_data, lhs_zero_point, rhs_data,
+                  rhs_zero_point, output_stage, dst_data, context);
+}
+
+}  // namespace detail
+}  // namespace cpu_backend_gemm
+}  // namespace tflite
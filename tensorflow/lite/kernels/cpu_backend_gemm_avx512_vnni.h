@@ -0,0 +1,109 @@
+/* Copyright 2022 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_LITE_KERNELS_CPU_BACKEND_GEMM_AVX512_VNNI_H_
+#define TENSORFLOW_LITE_KERNELS_CPU_BACKEND_GEMM_AVX512_VNNI_H_
+
+#include <cstdint>
+
+#include "tensorflow/lite/kernels/cpu_backend_context.h"
+#include "tensorflow/lite/kernels/cpu_backend_gemm_params.h"
+
+namespace tflite {
+namespace cpu_backend_gemm {
+namespace detail {
+
+// The output stage of GemmParams, independent of the destination type.
+struct Avx512VnniOutputStage {
+  const std::int32_t* bias = nullptr;
+  std::int32_t multiplier_fixedpoint = 0;
+  int multiplier_exponent = 0;
+  const std::int32_t* multiplier_fixedpoint_perchannel = nullptr;
+  const int* multiplier_exponent_perchannel = nullptr;
+  std::int32_t dst_zero_point = 0;
+  std::int32_t clamp_min = 0;
+  std::int32_t clamp_max = 0;
+};
+
+// Computes the int8 GEMM of a row-major `rows` x `depth` lhs and a
+// column-major `depth` x `cols` rhs into a column-major dst with the
+// AVX512-VNNI dot product instructions, which ruy doesn't use. Returns false
+// without doing anything if the CPU or the compiler doesn't support them.
+bool Int8GemmUsingAvx512Vnni(int rows, int depth, int cols,
+                             const std::int8_t* lhs_data,
+                             std::int32_t lhs_zero_point,
+                             const std::int8_t* rhs_data,
+                             std::int32_t rhs_zero_point,
+                             const Avx512VnniOutputStage& output_stage,
+                             std::int8_t* dst_data,
+                             CpuBackendContext* context);
+bool Int8GemmUsingAvx512Vnni(int rows, int depth, int cols,
+                             const std::int8_t* lhs_data,
+                             std::int32_t lhs_zero_point,
+                             const std::int8_t* rhs_data,
+                             std::int32_t rhs_zero_point,
+                             const Avx512VnniOutputStage& output_stage,
+                             std::int16_t* dst_data,
+                             CpuBackendContext* context);
+
+// Other destination types are left to the other backends.
+template <typename DstScalar>
+bool Int8GemmUsingAvx512Vnni(int rows, int depth, int cols,
+                             const std::int8_t* lhs_data,
+                             std::int32_t lhs_zero_point,
+                             const std::int8_t* rhs_data,
+                             std::int32_t rhs_zero_point,
+                             const Avx512VnniOutputStage& output_stage,
+                             DstScalar* dst_data, CpuBackendContext* context) {
+  return false;
+}
+
+// Runs the GEMM with Int8GemmUsingAvx512Vnni if it supports it, and returns
+// whether it did.
+template <typename DstScalar, QuantizationFlavor quantization_flavor>
+bool GemmUsingAvx512Vnni(
+    const MatrixParams<std::int8_t>& lhs_params, const std::int8_t* lhs_data,
+    const MatrixParams<std::int8_t>& rhs_params, const std::int8_t* rhs_data,
+    const MatrixParams<DstScalar>& dst_params, DstScalar* dst_data,
+    const GemmParams<std::int32_t, DstScalar, quantization_flavor>& params,
+    CpuBackendContext* context) {
+  if (lhs_params.order != Order::kRowMajor ||
+      rhs_params.order != Order::kColMajor ||
+      dst_params.order != Order::kColMajor) {
+    return false;
+  }
+  Avx512VnniOutputStage output_stage;
+  output_stage.bias = params.bias;
+  output_stage.multiplier_fixedpoint = params.multiplier_fixedpoint;
+  output_stage.multiplier_exponent = params.multiplier_exponent;
+  output_stage.multiplier_fixedpoint_perchannel =
+      params.multiplier_fixedpoint_perchannel;
+  output_stage.multiplier_exponent_perchannel =
+      params.multiplier_exponent_perchannel;
+  output_stage.dst_zero_point = dst_params.zero_point;
+  output_stage.clamp_min = params.clamp_min;
+  output_stage.clamp_max = params.clamp_max;
+  return Int8GemmUsingAvx512Vnni(lhs_params.rows, lhs_params.cols,
+                                 rhs_params.cols, lhs_data,
+                                 lhs_params.zero_point, rhs_data,
+                                 rhs_params.zero_point, output_stage, dst_data,
+                                 context);
+}
+
+}  // namespace detail
+}  // namespace cpu_backend_gemm
+}  // namespace tflite
+
+#endif  // TENSORFLOW_LITE_KERNELS_CPU_BACKEND_GEMM_AVX512_VNNI_H_
@@ -22,6 +22,7 @@ limitations under the License.
 #ifndef TFLITE_WITH_RUY
 
 #include "tensorflow/lite/kernels/cpu_backend_context.h"
+#include "tensorflow/lite/kernels/cpu_backend_gemm_avx512_vnni.h"
 #include "tensorflow/lite/kernels/cpu_backend_gemm_eigen.h"
 #include "tensorflow/lite/kernels/cpu_backend_gemm_gemmlowp.h"
 #include "tensorflow/lite/kernels/cpu_backend_gemm_params.h"
@@ -76,6 +77,28 @@ struct GemmImplX86<float, float, float, float,
   }
 };
 
+// For int8, use the AVX512-VNNI dot product instructions if the CPU has them,
+// since ruy doesn't.
+template <typename DstScalar, QuantizationFlavor quantization_flavor>
+struct GemmImplX86Int8 {
+  static void Run(
+      const MatrixParams<std::int8_t>& lhs_params, const std::int8_t* lhs_data,
+      const MatrixParams<std::int8_t>& rhs_params, const std::int8_t* rhs_data,
+      const MatrixParams<DstScalar>& dst_params, DstScalar* dst_data,
+      const GemmParams<std::int32_t, DstScalar, quantization_flavor>& params,
+      CpuBackendContext* context) {
+    if (GemmUsingAvx512Vnni(lhs_params, lhs_data, rhs_params, rhs_data,
+                            dst_params, dst_data, params, context)) {
+      return;
+    }
+    detail::GemmImplUsingRuy<std::int8_t, std::int8_t, std::int32_t, DstScalar,
+                             quantization_flavor>::Run(lhs_params, lhs_data,
+                                                       rhs_params, rhs_data,
+                                                       dst_params, dst_data,
+                                                       params, context);
+  }
+};
+
 // gemmlowp requires NEON for certain quantization cases. See note in
 // cpu_backend_gemm.h
 #if !defined(GEMMLOWP_NEON)
@@ -88,14 +111,12 @@ struct GemmImplX86<SrcScalar, SrcScalar, std::int32_t, std::int8_t,
 template <typename DstScalar, QuantizationFlavor quantization_flavor>
 struct GemmImplX86<std::int8_t, std::int8_t, std::int32_t, DstScalar,
                    quantization_flavor>
-    : detail::GemmImplUsingRuy<std::int8_t, std::int8_t, std::int32_t,
-                               DstScalar, quantization_flavor> {};
+    : GemmImplX86Int8<DstScalar, quantization_flavor> {};
 
 template <QuantizationFlavor quantization_flavor>
 struct GemmImplX86<std::int8_t, std::int8_t, std::int32_t, std::int8_t,
                    quantization_flavor>
-    : detail::GemmImplUsingRuy<std::int8_t, std::int8_t, std::int32_t,
-                               std::int8_t, quantization_flavor> {};
+    : GemmImplX86Int8<std::int8_t, quantization_flavor> {};
 #endif  // not GEMMLOWP_NEON
 }  // namespace detail
 }  // namespace cpu_backend_gemm
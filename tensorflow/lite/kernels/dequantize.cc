@@ -17,6 +17,7 @@ limitations under the License.
 #include <stddef.h>
 
 #include "tensorflow/lite/c/common.h"
+#include "tensorflow/lite/kernels/cpu_backend_context.h"
 #include "tensorflow/lite/kernels/internal/optimized/neon_check.h"
 #include "tensorflow/lite/kernels/kernel_util.h"
 
@@ -66,8 +67,11 @@ TfLiteStatus Prepare(TfLiteContext* context, TfLiteNode* node) {
 
   op_context.output->type = kTfLiteFloat32;
   // If the input tensor is constant, we can persist the dequantized value in
-  // the output tensor. Otherwise we run dequantize upon each eval.
-  if (IsConstantTensor(op_context.input)) {
+  // the output tensor. Otherwise we run dequantize upon each eval. With a
+  // weights cache, the dequantized weights don't stay in memory, and are
+  // dequantized from the mapped model upon each eval too.
+  if (IsConstantTensor(op_context.input) &&
+      CpuBackendContext::GetFromContext(context)->weights_cache() == nullptr) {
     op_context.output->allocation_type = kTfLiteArenaRwPersistent;
   }
   return context->ResizeTensor(context, op_context.output,
@@ -89,7 +93,7 @@ TfLiteStatus Eval(TfLiteContext* context, TfLiteNode* node) {
     return status;
   }
 
-  if (IsConstantTensor(op_context.input)) {
+  if (op_context.output->allocation_type == kTfLiteArenaRwPersistent) {
     op_data->float_dequantized_weights_initialized = true;
   }
   return kTfLiteOk;
@@ -928,14 +928,23 @@ bool VerifySparsity(const RuntimeShape& weights_shape,
   const int max_batch_index = batches - 1;
   const int max_output = max_batch_index * output_depth + w0_size;
   const int max_batch_depth = accum_depth * max_batch_index;
+  // The indices of block sparse weights are in units of blocks.
+  const int block_size = sparsity->dim_metadata_size == 3
+                             ? sparsity->dim_metadata[2].dense_size
+                             : 1;
 
   // Verify output size is enough.
   if (output_elements < max_output) return false;
 
+  // Verify the blocks cover the rows without a partial block.
+  if (block_size <= 0 || accum_depth % block_size != 0) return false;
+
   // Verify index from sparse in input is valid.
   for (int i = 0; i < sparsity->dim_metadata[1].array_indices->size; ++i) {
-    if (input_elements <=
-        max_batch_depth + sparsity->dim_metadata[1].array_indices->data[i])
+    if (input_elements <
+        max_batch_depth +
+            (sparsity->dim_metadata[1].array_indices->data[i] + 1) *
+                block_size)
       return false;
   }
   return true;
@@ -1029,6 +1038,16 @@ TfLiteStatus EvalQuantized(TfLiteContext* context, TfLiteNode* node,
                 GetTensorData<int32_t>(bias), output_shape,
                 GetTensorData<int8_t>(output),
                 CpuBackendContext::GetFromContext(context));
+          } else if (sparsity.dim_metadata_size ==
+                         kDimMetadataSizeBlockSparse &&
+                     sparsity.dim_metadata[2].dense_size == 4) {
+            // Block sparse with block size of 1x4.
+            optimized_ops::FullyConnectedSparseWeight1x4(
+                sparsity, op_params, input_shape, GetTensorData<int8_t>(input),
+                filter_shape, GetTensorData<int8_t>(filter), bias_shape,
+                GetTensorData<int32_t>(bias), output_shape,
+                GetTensorData<int8_t>(output),
+                CpuBackendContext::GetFromContext(context));
           } else {
             TF_LITE_KERNEL_LOG(
                 context, "Unsupported sparse fully-connected weight format.");
@@ -1220,6 +1239,16 @@ TfLiteStatus EvalFloat(TfLiteContext* context, TfLiteNode* node,
             bias_shape, GetTensorData<float>(bias),      // Disable formatting
             output_shape, GetTensorData<float>(output),
             CpuBackendContext::GetFromContext(context));
+      } else if (sparsity.dim_metadata_size == kDimMetadataSizeBlockSparse &&
+                 sparsity.dim_metadata[2].dense_size == 16) {
+        // Block sparse with block size of 1x16.
+        optimized_ops::FullyConnectedSparseWeight1x16(
+            sparsity, op_params,                         // Disable formatting
+            input_shape, GetTensorData<float>(input),    // Disable formatting
+            filter_shape, GetTensorData<float>(filter),  // Disable formatting
+            bias_shape, GetTensorData<float>(bias),      // Disable formatting
+            output_shape, GetTensorData<float>(output),
+            CpuBackendContext::GetFromContext(context));
       } else {
         TF_LITE_KERNEL_LOG(context,
                            "Unsupported sparse fully-connected weight format.");
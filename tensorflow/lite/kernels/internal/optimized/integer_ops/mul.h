@@ -21,6 +21,7 @@ limitations under the License.
 #include "ruy/profiler/instrumentation.h"  // from @ruy
 #include "tensorflow/lite/kernels/internal/common.h"
 #include "tensorflow/lite/kernels/internal/compatibility.h"
+#include "tensorflow/lite/kernels/internal/optimized/avx2_quantization_utils.h"
 #include "tensorflow/lite/kernels/internal/optimized/cpu_check.h"
 #include "tensorflow/lite/kernels/internal/optimized/neon_check.h"
 #include "tensorflow/lite/kernels/internal/optimized/optimized_ops.h"
@@ -229,6 +230,171 @@ inline void MulSimpleBroadcast(int size, const ArithmeticParams& params,
   }
 }
 
+// Element-wise mul of 16-bit inputs, as used by the int16 activations / int8
+// weights quantization mode. The inputs are symmetrically quantized, so the
+// product of two values always fits in 32 bits without any offsets.
+inline void MulElementwise(int size, const ArithmeticParams& params,
+                           const int16* input1_data, const int16* input2_data,
+                           int16* output_data) {
+  ruy::profiler::ScopeLabel label("MulElementwiseInt16/16bit");
+  int i = 0;
+  TFLITE_DCHECK_EQ(params.input1_offset, 0);
+  TFLITE_DCHECK_EQ(params.input2_offset, 0);
+#ifdef __AVX2__
+  const __m256i output_offset = _mm256_set1_epi32(params.output_offset);
+  const __m256i clamp_max_v =
+      _mm256_set1_epi32(params.quantized_activation_max);
+  const __m256i clamp_min_v =
+      _mm256_set1_epi32(params.quantized_activation_min);
+
+  for (; i <= size - 16; i += 16) {
+    const __m256i input1_val_original =
+        _mm256_loadu_si256(reinterpret_cast<__m256i const*>(input1_data + i));
+    const __m256i input2_val_original =
+        _mm256_loadu_si256(reinterpret_cast<__m256i const*>(input2_data + i));
+
+    const __m256i s11 =
+        _mm256_cvtepi16_epi32(_mm256_castsi256_si128(input1_val_original));
+    const __m256i s12 =
+        _mm256_cvtepi16_epi32(_mm256_extracti128_si256(input1_val_original, 1));
+    const __m256i s21 =
+        _mm256_cvtepi16_epi32(_mm256_castsi256_si128(input2_val_original));
+    const __m256i s22 =
+        _mm256_cvtepi16_epi32(_mm256_extracti128_si256(input2_val_original, 1));
+
+    __m256i p1 = _mm256_mullo_epi32(s11, s21);
+    __m256i p2 = _mm256_mullo_epi32(s12, s22);
+
+    p1 = avx2_utils::MultiplyByQuantizedMultiplier(p1, params.output_multiplier,
+                                                   params.output_shift);
+    p2 = avx2_utils::MultiplyByQuantizedMultiplier(p2, params.output_multiplier,
+                                                   params.output_shift);
+
+    p1 = _mm256_add_epi32(p1, output_offset);
+    p2 = _mm256_add_epi32(p2, output_offset);
+
+    p1 = _mm256_min_epi32(p1, clamp_max_v);
+    p1 = _mm256_max_epi32(p1, clamp_min_v);
+    p2 = _mm256_min_epi32(p2, clamp_max_v);
+    p2 = _mm256_max_epi32(p2, clamp_min_v);
+
+    avx2_utils::CastInt32ToInt16AndStore(output_data + i, p1);
+    avx2_utils::CastInt32ToInt16AndStore(output_data + i + 8, p2);
+  }
+#elif defined(USE_NEON)
+  const int32x4_t output_offset_vector = vdupq_n_s32(params.output_offset);
+  const int16x8_t output_activation_min_vector =
+      vdupq_n_s16(params.quantized_activation_min);
+  const int16x8_t output_activation_max_vector =
+      vdupq_n_s16(params.quantized_activation_max);
+  const int left_shift = std::max(0, params.output_shift);
+  const int right_shift = std::max(0, -params.output_shift);
+  const int32x4_t left_shift_vec = vdupq_n_s32(left_shift);
+  for (; i <= size - 8; i += 8) {
+    // We load / store 8 at a time, multiplying as two sets of 4 int32s.
+    const int16x8_t input1_val = vld1q_s16(input1_data + i);
+    const int16x8_t input2_val = vld1q_s16(input2_data + i);
+
+    int32x4_t p1 =
+        vmull_s16(vget_low_s16(input1_val), vget_low_s16(input2_val));
+    int32x4_t p2 =
+        vmull_s16(vget_high_s16(input1_val), vget_high_s16(input2_val));
+
+    p1 = vshlq_s32(p1, left_shift_vec);
+    p2 = vshlq_s32(p2, left_shift_vec);
+
+    p1 = vqrdmulhq_n_s32(p1, params.output_multiplier);
+    p2 = vqrdmulhq_n_s32(p2, params.output_multiplier);
+    using gemmlowp::RoundingDivideByPOT;
+    p1 = RoundingDivideByPOT(p1, right_shift);
+    p2 = RoundingDivideByPOT(p2, right_shift);
+
+    p1 = vaddq_s32(p1, output_offset_vector);
+    p2 = vaddq_s32(p2, output_offset_vector);
+
+    const int16x8_t p = vcombine_s16(vqmovn_s32(p1), vqmovn_s32(p2));
+    const int16x8_t clamped =
+        vmaxq_s16(output_activation_min_vector,
+                  vminq_s16(output_activation_max_vector, p));
+    vst1q_s16(output_data + i, clamped);
+  }
+#endif  // NEON
+
+  for (; i < size; ++i) {
+    const int32 input1_val = input1_data[i];
+    const int32 input2_val = input2_data[i];
+    const int32 unclamped_result =
+        params.output_offset +
+        MultiplyByQuantizedMultiplier(input1_val * input2_val,
+                                      params.output_multiplier,
+                                      params.output_shift);
+    const int32 clamped_output =
+        std::min(params.quantized_activation_max,
+                 std::max(params.quantized_activation_min, unclamped_result));
+    output_data[i] = static_cast<int16>(clamped_output);
+  }
+}
+
+// Broadcast mul of 16-bit inputs that can be used for inner loop of broadcast
+// Mul.
+inline void MulSimpleBroadcast(int size, const ArithmeticParams& params,
+                               const int16 broadcast_value,
+                               const int16* input2_data, int16* output_data) {
+  ruy::profiler::ScopeLabel label("BroadMulSimpleBroadcastInt16/16bit");
+  const int32 input1_val = broadcast_value;
+
+  int i = 0;
+  TFLITE_DCHECK_EQ(params.input1_offset, 0);
+  TFLITE_DCHECK_EQ(params.input2_offset, 0);
+#ifdef USE_NEON
+  const int32x4_t output_offset_vector = vdupq_n_s32(params.output_offset);
+  const int16x8_t output_activation_min_vector =
+      vdupq_n_s16(params.quantized_activation_min);
+  const int16x8_t output_activation_max_vector =
+      vdupq_n_s16(params.quantized_activation_max);
+  const int left_shift = std::max(0, params.output_shift);
+  const int right_shift = std::max(0, -params.output_shift);
+  const int32x4_t left_shift_vec = vdupq_n_s32(left_shift);
+  for (; i <= size - 8; i += 8) {
+    const int16x8_t input2_val = vld1q_s16(input2_data + i);
+
+    int32x4_t p1 = vmull_n_s16(vget_low_s16(input2_val), broadcast_value);
+    int32x4_t p2 = vmull_n_s16(vget_high_s16(input2_val), broadcast_value);
+
+    p1 = vshlq_s32(p1, left_shift_vec);
+    p2 = vshlq_s32(p2, left_shift_vec);
+
+    p1 = vqrdmulhq_n_s32(p1, params.output_multiplier);
+    p2 = vqrdmulhq_n_s32(p2, params.output_multiplier);
+    using gemmlowp::RoundingDivideByPOT;
+    p1 = RoundingDivideByPOT(p1, right_shift);
+    p2 = RoundingDivideByPOT(p2, right_shift);
+
+    p1 = vaddq_s32(p1, output_offset_vector);
+    p2 = vaddq_s32(p2, output_offset_vector);
+
+    const int16x8_t p = vcombine_s16(vqmovn_s32(p1), vqmovn_s32(p2));
+    const int16x8_t clamped =
+        vmaxq_s16(output_activation_min_vector,
+                  vminq_s16(output_activation_max_vector, p));
+    vst1q_s16(output_data + i, clamped);
+  }
+#endif  // NEON
+
+  for (; i < size; ++i) {
+    const int32 input2_val = input2_data[i];
+    const int32 unclamped_result =
+        params.output_offset +
+        MultiplyByQuantizedMultiplier(input1_val * input2_val,
+                                      params.output_multiplier,
+                                      params.output_shift);
+    const int32 clamped_output =
+        std::min(params.quantized_activation_max,
+                 std::max(params.quantized_activation_min, unclamped_result));
+    output_data[i] = static_cast<int16>(clamped_output);
+  }
+}
+
 inline void Mul(const ArithmeticParams& params,
                 const RuntimeShape& input1_shape, const int8* input1_data,
                 const RuntimeShape& input2_shape, const int8* input2_data,
@@ -242,6 +408,19 @@ inline void Mul(const ArithmeticParams& params,
   MulElementwise(flat_size, params, input1_data, input2_data, output_data);
 }
 
+inline void Mul(const ArithmeticParams& params,
+                const RuntimeShape& input1_shape, const int16* input1_data,
+                const RuntimeShape& input2_shape, const int16* input2_data,
+                const RuntimeShape& output_shape, int16* output_data) {
+  TFLITE_DCHECK_LE(params.quantized_activation_min,
+                   params.quantized_activation_max);
+  ruy::profiler::ScopeLabel label("MulInt16/16bit");
+  const int flat_size =
+      MatchingElementsSize(input1_shape, input2_shape, output_shape);
+
+  MulElementwise(flat_size, params, input1_data, input2_data, output_data);
+}
+
 inline void BroadcastMulDispatch(const ArithmeticParams& params,
                                  const RuntimeShape& input1_shape,
                                  const int8* input1_data,
@@ -257,7 +436,33 @@ inline void BroadcastMulDispatch(const ArithmeticParams& params,
 
   optimized_ops::BinaryBroadcastFiveFold(
       params, input1_shape, input1_data, input2_shape, input2_data,
-      output_shape, output_data, MulElementwise, MulSimpleBroadcast);
+      output_shape, output_data,
+      static_cast<void (*)(int, const ArithmeticParams&, const int8*,
+                           const int8*, int8*)>(MulElementwise),
+      static_cast<void (*)(int, const ArithmeticParams&, int8, const int8*,
+                           int8*)>(MulSimpleBroadcast));
+}
+
+inline void BroadcastMulDispatch(const ArithmeticParams& params,
+                                 const RuntimeShape& input1_shape,
+                                 const int16* input1_data,
+                                 const RuntimeShape& input2_shape,
+                                 const int16* input2_data,
+                                 const RuntimeShape& output_shape,
+                                 int16* output_data) {
+  if (params.broadcast_category == BroadcastableOpCategory::kGenericBroadcast) {
+    return reference_integer_ops::BroadcastMul4DSlow(
+        params, input1_shape, input1_data, input2_shape, input2_data,
+        output_shape, output_data);
+  }
+
+  optimized_ops::BinaryBroadcastFiveFold(
+      params, input1_shape, input1_data, input2_shape, input2_data,
+      output_shape, output_data,
+      static_cast<void (*)(int, const ArithmeticParams&, const int16*,
+                           const int16*, int16*)>(MulElementwise),
+      static_cast<void (*)(int, const ArithmeticParams&, int16, const int16*,
+                           int16*)>(MulSimpleBroadcast));
 }
 
 }  // namespace optimized_integer_ops
@@ -1955,6 +1955,40 @@ void NeonSparseMatrixBatchVectorMultiplyAccumulate1x4(
   }
 }
 
+void NeonSparseMatrixBatchVectorMultiplyAccumulate1x16(
+    const float* __restrict__ matrix, const int32_t* __restrict__ segments,
+    const int32_t* __restrict__ indices, int m_rows, int m_cols,
+    const float* __restrict__ vector, int n_batch, float* __restrict__ result) {
+  constexpr int kNeonVectorsPerBlock = 4;
+  constexpr int kBlockSize = kNeonVectorsPerBlock * kFloatValuesPerNeonVector;
+  TFLITE_DCHECK_EQ(m_cols % kBlockSize, 0);
+
+  for (int batch = 0; batch < n_batch; batch++) {
+    const float* matrix_ptr = matrix;
+    for (int row = 0; row < m_rows; row++) {
+      float32x4_t acc_32x4 = vmovq_n_f32(0.0);
+      const float* vector_in_batch = vector + batch * m_cols;
+
+      for (int i = segments[row]; i < segments[row + 1]; i++) {
+        const int block_start_index = indices[i] * kBlockSize;
+        const float* vector_block_in_batch_ptr =
+            vector_in_batch + block_start_index;
+        for (int c = 0; c < kNeonVectorsPerBlock; c++) {
+          // Load 4 float values from the vector and matrix row.
+          float32x4_t vector_f32x4 = vld1q_f32(vector_block_in_batch_ptr +
+                                               c * kFloatValuesPerNeonVector);
+          float32x4_t matrix_f32x4 =
+              vld1q_f32(matrix_ptr + c * kFloatValuesPerNeonVector);
+          // Multiply the vector and matrix row and add to accumulator.
+          acc_32x4 = vmlaq_f32(acc_32x4, matrix_f32x4, vector_f32x4);
+        }
+        matrix_ptr += kBlockSize;
+      }
+      result[batch * m_rows + row] += AccumulateNeonLane(acc_32x4);
+    }
+  }
+}
+
 void NeonSparseMatrixBatchVectorMultiplyAccumulate1x16(
     const int8_t* __restrict__ matrix, const int32_t* __restrict__ segments,
     const int32_t* __restrict__ indices, int m_rows, int m_cols,
@@ -3752,6 +3752,100 @@ inline void SoftmaxInt8LUT(const SoftmaxParams& params,
   }
 }
 
+// Quantized softmax with int16_t input and int16_t output. This follows
+// reference_ops::SoftmaxInt16 bit-exactly, but vectorizes the max reduction
+// and the final rescaling by the reciprocal of the sum of exps. The exp
+// itself remains a per-element interpolated table lookup.
+inline void SoftmaxInt16(const SoftmaxParams& params,
+                         const RuntimeShape& input_shape,
+                         const int16_t* input_data,
+                         const RuntimeShape& output_shape,
+                         int16_t* output_data) {
+  ruy::profiler::ScopeLabel label("SoftmaxInt16");
+  const int trailing_dim = input_shape.DimensionsCount() - 1;
+  const int outer_size =
+      MatchingFlatSizeSkipDim(input_shape, trailing_dim, output_shape);
+  const int depth =
+      MatchingDim(input_shape, trailing_dim, output_shape, trailing_dim);
+
+  for (int i = 0; i < outer_size; ++i) {
+    const int16_t* input_row = input_data + i * depth;
+    int16_t* output_row = output_data + i * depth;
+
+    // Find the largest element.
+    int c = 0;
+    int16_t max_in_row = std::numeric_limits<int16_t>::min();
+#ifdef USE_NEON
+    if (depth >= 8) {
+      int16x8_t max8 = vld1q_s16(input_row);
+      for (c = 8; c <= depth - 8; c += 8) {
+        max8 = vmaxq_s16(max8, vld1q_s16(input_row + c));
+      }
+      int16x4_t max4 = vmax_s16(vget_low_s16(max8), vget_high_s16(max8));
+      max4 = vpmax_s16(max4, max4);
+      max4 = vpmax_s16(max4, max4);
+      max_in_row = vget_lane_s16(max4, 0);
+    }
+#endif
+    for (; c < depth; ++c) {
+      max_in_row = std::max(max_in_row, input_row[c]);
+    }
+
+    // Compute the exp values and their sum, caching the exp values in the
+    // output buffer.
+    int32_t sum_of_exps = 0;  // Q16.15 fixed point format.
+    for (c = 0; c < depth; ++c) {
+      output_row[c] =
+          reference_ops::SoftMaxCalculateExp(params, input_row, depth,
+                                             max_in_row, 0, c);
+      sum_of_exps += output_row[c];
+    }
+
+    // Compute the reciprocal 1/sum_of_exps, see reference_ops::SoftmaxInt16.
+    const uint8_t headroom_plus_one =
+        CountLeadingZeros(static_cast<uint32_t>(sum_of_exps));
+    const int32_t shifted_sum =
+        ((static_cast<int64_t>(sum_of_exps) << (headroom_plus_one - 1)) +
+         (1 << 13)) >>
+        14;
+    const int32_t sym_shifted_sum = shifted_sum + (-((1 << 15) + (1 << 16)));
+    const int16_t sat_sym_shifted_sum = static_cast<int16_t>(
+        std::min(std::max(sym_shifted_sum, static_cast<int32_t>(-32768)),
+                 static_cast<int32_t>(32767)));
+    const int16_t reciprocal_scale_Q015 =
+        lut_lookup(sat_sym_shifted_sum, params.one_over_one_plus_x_lut);
+
+    // Rescale the exp results with the reciprocal. Both factors are in
+    // [0, 32767], so their product fits in 32 bits.
+    const int right_shift = 31 - headroom_plus_one;
+    c = 0;
+#ifdef USE_NEON
+    const int32x4_t right_shift_dup = vdupq_n_s32(-right_shift);
+    const int16x8_t zero = vdupq_n_s16(0);
+    for (; c <= depth - 8; c += 8) {
+      const int16x8_t exps = vld1q_s16(output_row + c);
+      int32x4_t low = vmull_n_s16(vget_low_s16(exps), reciprocal_scale_Q015);
+      int32x4_t high = vmull_n_s16(vget_high_s16(exps), reciprocal_scale_Q015);
+      low = vrshlq_s32(low, right_shift_dup);
+      high = vrshlq_s32(high, right_shift_dup);
+      const int16x8_t result =
+          vmaxq_s16(vcombine_s16(vqmovn_s32(low), vqmovn_s32(high)), zero);
+      vst1q_s16(output_row + c, result);
+    }
+#endif
+    const int32_t round = 1 << (right_shift - 1);
+    for (; c < depth; ++c) {
+      const int32_t result =
+          (output_row[c] * static_cast<int32_t>(reciprocal_scale_Q015) +
+           round) >>
+          right_shift;
+      output_row[c] = static_cast<int16_t>(
+          std::min(std::max(result, static_cast<int32_t>(0)),
+                   static_cast<int32_t>(32767)));
+    }
+  }
+}
+
 inline void LogSoftmax(const SoftmaxParams& params,
                        const RuntimeShape& input_shape, const float* input_data,
                        const RuntimeShape& output_shape, float* output_data) {
@@ -16,6 +16,8 @@ limitations under the License.
 #define TENSORFLOW_LITE_KERNELS_INTERNAL_OPTIMIZED_SPARSE_OPS_FULLY_CONNECTED_H_
 
 #include <algorithm>
+#include <cstring>
+#include <vector>
 
 #include "ruy/profiler/instrumentation.h"  // from @ruy
 #include "tensorflow/lite/c/common.h"
@@ -76,24 +78,29 @@ inline void FullyConnectedSparseWeight(
   }
 }
 
-inline void FullyConnectedSparseWeight1x16Impl(
+// Computes the rows [row_start, row_end) of the batches [batch_start,
+// batch_end) of a fully connected layer with 1x`block_size` block sparse
+// weights. Slicing the rows of more than one batch is not supported.
+inline void FullyConnectedSparseWeight1xNImpl(
     const TfLiteSparsity& sparsity, const FullyConnectedParams& params,
     const RuntimeShape& input_shape, const int8_t* input_data,
     const RuntimeShape& weights_shape, const int8_t* weights_data,
     const RuntimeShape& bias_shape, const int32_t* bias_data,
-    const RuntimeShape& output_shape, int8_t* output_data, int thread_start,
-    int thread_end, const CpuBackendContext& cpu_backend_context) {
+    const RuntimeShape& output_shape, int8_t* output_data, int block_size,
+    int batch_start, int batch_end, int row_start, int row_end) {
   ruy::profiler::ScopeLabel label("FullyConnected");
-  ruy::profiler::ScopeLabel inner_label("1x16 Block Sparse");
+  ruy::profiler::ScopeLabel inner_label(block_size == 4 ? "1x4 Block Sparse"
+                                                        : "1x16 Block Sparse");
 
   const int input_dims_count = input_shape.DimensionsCount();
   const int output_dims_count = output_shape.DimensionsCount();
   const int weights_dims_count = weights_shape.DimensionsCount();
-  const int batches = thread_end - thread_start;
+  const int batches = batch_end - batch_start;
   const int input_depth = MatchingDim(weights_shape, weights_dims_count - 1,
                                       input_shape, input_dims_count - 1);
   const int output_depth = MatchingDim(weights_shape, weights_dims_count - 2,
                                        output_shape, output_dims_count - 1);
+  TFLITE_DCHECK(batches == 1 || row_end - row_start == output_depth);
   const int32_t input_offset = params.input_offset;
   const int32_t output_offset = params.output_offset;
   const int32_t output_multiplier = params.output_multiplier;
@@ -101,48 +108,74 @@ inline void FullyConnectedSparseWeight1x16Impl(
   const int32_t output_activation_min = params.quantized_activation_min;
   const int32_t output_activation_max = params.quantized_activation_max;
 
-  const int* w1_segments = sparsity.dim_metadata[1].array_segments->data;
+  // The segments hold absolute offsets into the indices, so only the values
+  // need to be moved to the first row of the slice.
+  const int* w1_segments =
+      sparsity.dim_metadata[1].array_segments->data + row_start;
   const int* w1_indices = sparsity.dim_metadata[1].array_indices->data;
+  const int8_t* weights_slice = weights_data + w1_segments[0] * block_size;
+  const int32_t* bias_slice =
+      bias_data != nullptr ? bias_data + row_start : nullptr;
+  const int8_t* input_slice = input_data + batch_start * input_depth;
+  int8_t* output_slice = output_data + batch_start * output_depth + row_start;
 
-  tensor_utils::SparseMatrixBatchVectorMultiplyAccumulate1x16(
-      weights_data, w1_segments, w1_indices, weights_shape.Dims(0),
-      weights_shape.Dims(1), input_data + thread_start * input_depth, bias_data,
-      batches, input_offset, output_multiplier, output_shift, output_offset,
-      output_activation_min, output_activation_max,
-      output_data + thread_start * output_depth);
+  if (block_size == 4) {
+    tensor_utils::SparseMatrixBatchVectorMultiplyAccumulate1x4(
+        weights_slice, w1_segments, w1_indices, row_end - row_start,
+        input_depth, input_slice, bias_slice, batches, input_offset,
+        output_multiplier, output_shift, output_offset, output_activation_min,
+        output_activation_max, output_slice);
+  } else {
+    tensor_utils::SparseMatrixBatchVectorMultiplyAccumulate1x16(
+        weights_slice, w1_segments, w1_indices, row_end - row_start,
+        input_depth, input_slice, bias_slice, batches, input_offset,
+        output_multiplier, output_shift, output_offset, output_activation_min,
+        output_activation_max, output_slice);
+  }
 }
 
-inline void FullyConnectedSparseWeight1x4Impl(
+inline void FullyConnectedSparseWeight1xNImpl(
     const TfLiteSparsity& sparsity, const FullyConnectedParams& params,
     const RuntimeShape& input_shape, const float* input_data,
     const RuntimeShape& weights_shape, const float* weights_data,
     const RuntimeShape& bias_shape, const float* bias_data,
-    const RuntimeShape& output_shape, float* output_data, int thread_start,
-    int thread_end, const CpuBackendContext& cpu_backend_context) {
+    const RuntimeShape& output_shape, float* output_data, int block_size,
+    int batch_start, int batch_end, int row_start, int row_end) {
   ruy::profiler::ScopeLabel label("FullyConnected");
-  ruy::profiler::ScopeLabel inner_label("1x4 Block Sparse");
+  ruy::profiler::ScopeLabel inner_label(block_size == 4 ? "1x4 Block Sparse"
+                                                        : "1x16 Block Sparse");
   const float output_activation_min = params.float_activation_min;
   const float output_activation_max = params.float_activation_max;
 
   const int input_dims_count = input_shape.DimensionsCount();
   const int output_dims_count = output_shape.DimensionsCount();
   const int weights_dims_count = weights_shape.DimensionsCount();
-  const int batches = thread_end - thread_start;
+  const int batches = batch_end - batch_start;
   const int input_depth = MatchingDim(weights_shape, weights_dims_count - 1,
                                       input_shape, input_dims_count - 1);
   const int output_depth = MatchingDim(weights_shape, weights_dims_count - 2,
                                        output_shape, output_dims_count - 1);
-  const int* w1_segments = sparsity.dim_metadata[1].array_segments->data;
+  TFLITE_DCHECK(batches == 1 || row_end - row_start == output_depth);
+  const int* w1_segments =
+      sparsity.dim_metadata[1].array_segments->data + row_start;
   const int* w1_indices = sparsity.dim_metadata[1].array_indices->data;
+  const float* weights_slice = weights_data + w1_segments[0] * block_size;
+  const float* input_slice = input_data + batch_start * input_depth;
+  float* output_slice = output_data + batch_start * output_depth + row_start;
 
-  tensor_utils::SparseMatrixBatchVectorMultiplyAccumulate1x4(
-      weights_data, w1_segments, w1_indices, weights_shape.Dims(0),
-      weights_shape.Dims(1), input_data + thread_start * input_depth, batches,
-      output_data + thread_start * output_depth);
+  if (block_size == 4) {
+    tensor_utils::SparseMatrixBatchVectorMultiplyAccumulate1x4(
+        weights_slice, w1_segments, w1_indices, row_end - row_start,
+        input_depth, input_slice, batches, output_slice);
+  } else {
+    tensor_utils::SparseMatrixBatchVectorMultiplyAccumulate1x16(
+        weights_slice, w1_segments, w1_indices, row_end - row_start,
+        input_depth, input_slice, batches, output_slice);
+  }
 
   ruy::profiler::ScopeLabel activation_label("activation function");
-  for (int b = thread_start; b < thread_end; ++b) {
-    for (int i = 0; i < output_depth; ++i) {
+  for (int b = batch_start; b < batch_end; ++b) {
+    for (int i = row_start; i < row_end; ++i) {
       float total = output_data[b * output_depth + i];
       const float bias_value = bias_data ? bias_data[i] : 0;
       output_data[b * output_depth + i] = ActivationFunctionWithMinMax(
@@ -151,14 +184,15 @@ inline void FullyConnectedSparseWeight1x4Impl(
   }
 }
 
-struct FullyConnectedSparseWeight1x4Task : cpu_backend_threadpool::Task {
-  FullyConnectedSparseWeight1x4Task(
+template <typename T, typename BiasT>
+struct FullyConnectedSparseWeight1xNTask : cpu_backend_threadpool::Task {
+  FullyConnectedSparseWeight1xNTask(
       const TfLiteSparsity& sparsity, const FullyConnectedParams& params,
-      const RuntimeShape& input_shape, const float* input_data,
-      const RuntimeShape& weights_shape, const float* weights_data,
-      const RuntimeShape& bias_shape, const float* bias_data,
-      const RuntimeShape& output_shape, float* output_data, int thread_start,
-      int thread_end, const CpuBackendContext& cpu_backend_context_x)
+      const RuntimeShape& input_shape, const T* input_data,
+      const RuntimeShape& weights_shape, const T* weights_data,
+      const RuntimeShape& bias_shape, const BiasT* bias_data,
+      const RuntimeShape& output_shape, T* output_data, int block_size,
+      int batch_start, int batch_end, int row_start, int row_end)
       : sparsity(sparsity),
         params(params),
         input_shape(input_shape),
@@ -169,97 +203,150 @@ struct FullyConnectedSparseWeight1x4Task : cpu_backend_threadpool::Task {
         bias_data(bias_data),
         output_shape(output_shape),
         output_data(output_data),
-        thread_start(thread_start),
-        thread_end(thread_end),
-        cpu_backend_context(cpu_backend_context_x) {}
+        block_size(block_size),
+        batch_start(batch_start),
+        batch_end(batch_end),
+        row_start(row_start),
+        row_end(row_end) {}
 
   void Run() override {
-    FullyConnectedSparseWeight1x4Impl(
+    FullyConnectedSparseWeight1xNImpl(
         sparsity, params, input_shape, input_data, weights_shape, weights_data,
-        bias_shape, bias_data, output_shape, output_data, thread_start,
-        thread_end, cpu_backend_context);
+        bias_shape, bias_data, output_shape, output_data, block_size,
+        batch_start, batch_end, row_start, row_end);
   }
 
  private:
   const TfLiteSparsity& sparsity;
   const FullyConnectedParams& params;
   const RuntimeShape& input_shape;
-  const float* input_data;
+  const T* input_data;
   const RuntimeShape& weights_shape;
-  const float* weights_data;
+  const T* weights_data;
   const RuntimeShape& bias_shape;
-  const float* bias_data;
+  const BiasT* bias_data;
   const RuntimeShape& output_shape;
-  float* output_data;
-  int thread_start;
-  int thread_end;
-  const CpuBackendContext& cpu_backend_context;
+  T* output_data;
+  int block_size;
+  int batch_start;
+  int batch_end;
+  int row_start;
+  int row_end;
 };
 
-inline void FullyConnectedSparseWeight1x16(
-    const TfLiteSparsity& sparsity, const FullyConnectedParams& params,
-    const RuntimeShape& input_shape, const int8_t* input_data,
-    const RuntimeShape& weights_shape, const int8_t* weights_data,
-    const RuntimeShape& bias_shape, const int32_t* bias_data,
-    const RuntimeShape& output_shape, int8_t* output_data,
-    CpuBackendContext* cpu_backend_context) {
-  const int output_elements = output_shape.FlatSize();
-  memset(output_data, 0, output_elements * sizeof(int8_t));
-
-  const int batches =
-      FlatSizeSkipDim(output_shape, output_shape.DimensionsCount() - 1);
-
-  // TODO(b/220851507): Add multi-thread support for quantized sparse kernel.
-  return FullyConnectedSparseWeight1x16Impl(
-      sparsity, params, input_shape, input_data, weights_shape, weights_data,
-      bias_shape, bias_data, output_shape, output_data, 0, batches,
-      *cpu_backend_context);
-}
+// The minimum number of rows of the weights a thread computes when a single
+// batch is sliced along the rows.
+constexpr int kMinSparseRowsPerThread = 64;
 
 // The multi-threaded kernel slices the workload along the batch dimension. If
-// there's not enough batches of data, the number of threads used is equal to
-// the batch size. We can improve this later with slicing along the row
-// dimension of the weight.
-inline void FullyConnectedSparseWeight1x4(
+// there's a single batch, it slices along the row dimension of the weight
+// instead, so that the common case of a matrix-vector product also uses all
+// threads.
+template <typename T, typename BiasT>
+inline void FullyConnectedSparseWeight1xN(
     const TfLiteSparsity& sparsity, const FullyConnectedParams& params,
-    const RuntimeShape& input_shape, const float* input_data,
-    const RuntimeShape& weights_shape, const float* weights_data,
-    const RuntimeShape& bias_shape, const float* bias_data,
-    const RuntimeShape& output_shape, float* output_data,
+    const RuntimeShape& input_shape, const T* input_data,
+    const RuntimeShape& weights_shape, const T* weights_data,
+    const RuntimeShape& bias_shape, const BiasT* bias_data,
+    const RuntimeShape& output_shape, T* output_data, int block_size,
     CpuBackendContext* cpu_backend_context) {
   const int output_elements = output_shape.FlatSize();
-  memset(output_data, 0, output_elements * sizeof(float));
+  memset(output_data, 0, output_elements * sizeof(T));
 
   const int max_threads = cpu_backend_context->max_num_threads();
-  const int batches =
-      FlatSizeSkipDim(output_shape, output_shape.DimensionsCount() - 1);
-  const int thread_count = std::max(1, std::min(batches, max_threads));
+  const int output_dims_count = output_shape.DimensionsCount();
+  const int batches = FlatSizeSkipDim(output_shape, output_dims_count - 1);
+  const int output_depth = output_shape.Dims(output_dims_count - 1);
+  const bool slice_rows = batches == 1;
+  const int slices = slice_rows ? output_depth / kMinSparseRowsPerThread
+                                : batches;
+  const int thread_count = std::max(1, std::min(slices, max_threads));
   if (thread_count == 1) {
-    return FullyConnectedSparseWeight1x4Impl(
+    return FullyConnectedSparseWeight1xNImpl(
         sparsity, params, input_shape, input_data, weights_shape, weights_data,
-        bias_shape, bias_data, output_shape, output_data, 0, batches,
-        *cpu_backend_context);
+        bias_shape, bias_data, output_shape, output_data, block_size, 0,
+        batches, 0, output_depth);
   }
-  std::vector<FullyConnectedSparseWeight1x4Task> tasks;
+  const int work = slice_rows ? output_depth : batches;
+  std::vector<FullyConnectedSparseWeight1xNTask<T, BiasT>> tasks;
   tasks.reserve(thread_count);
   int thread_start = 0;
   for (int i = 0; i < thread_count; ++i) {
-    // This makes sure the workload is relatively balanced when batches is not a
-    // multiple of thread_count. The first mod(batches, thread_count) tasks need
-    // to process one more batch than the rest.
-    int thread_end = thread_start + batches / thread_count;
-    if (i < batches % thread_count) thread_end++;
+    // This makes sure the workload is relatively balanced when the work is not
+    // a multiple of thread_count. The first mod(work, thread_count) tasks need
+    // to process one more batch or row than the rest.
+    int thread_end = thread_start + work / thread_count;
+    if (i < work % thread_count) thread_end++;
 
-    tasks.emplace_back(sparsity, params, input_shape, input_data, weights_shape,
-                       weights_data, bias_shape, bias_data, output_shape,
-                       output_data, thread_start, thread_end,
-                       *cpu_backend_context);
+    if (slice_rows) {
+      tasks.emplace_back(sparsity, params, input_shape, input_data,
+                         weights_shape, weights_data, bias_shape, bias_data,
+                         output_shape, output_data, block_size, 0, 1,
+                         thread_start, thread_end);
+    } else {
+      tasks.emplace_back(sparsity, params, input_shape, input_data,
+                         weights_shape, weights_data, bias_shape, bias_data,
+                         output_shape, output_data, block_size, thread_start,
+                         thread_end, 0, output_depth);
+    }
     thread_start = thread_end;
   }
   cpu_backend_threadpool::Execute(tasks.size(), tasks.data(),
                                   cpu_backend_context);
 }
 
+inline void FullyConnectedSparseWeight1x16(
+    const TfLiteSparsity& sparsity, const FullyConnectedParams& params,
+    const RuntimeShape& input_shape, const int8_t* input_data,
+    const RuntimeShape& weights_shape, const int8_t* weights_data,
+    const RuntimeShape& bias_shape, const int32_t* bias_data,
+    const RuntimeShape& output_shape, int8_t* output_data,
+    CpuBackendContext* cpu_backend_context) {
+  FullyConnectedSparseWeight1xN(sparsity, params, input_shape, input_data,
+                                weights_shape, weights_data, bias_shape,
+                                bias_data, output_shape, output_data,
+                                /*block_size=*/16, cpu_backend_context);
+}
+
+inline void FullyConnectedSparseWeight1x4(
+    const TfLiteSparsity& sparsity, const FullyConnectedParams& params,
+    const RuntimeShape& input_shape, const int8_t* input_data,
+    const RuntimeShape& weights_shape, const int8_t* weights_data,
+    const RuntimeShape& bias_shape, const int32_t* bias_data,
+    const RuntimeShape& output_shape, int8_t* output_data,
+    CpuBackendContext* cpu_backend_context) {
+  FullyConnectedSparseWeight1xN(sparsity, params, input_shape, input_data,
+                                weights_shape, weights_data, bias_shape,
+                                bias_data, output_shape, output_data,
+                                /*block_size=*/4, cpu_backend_context);
+}
+
+inline void FullyConnectedSparseWeight1x16(
+    const TfLiteSparsity& sparsity, const FullyConnectedParams& params,
+    const RuntimeShape& input_shape, const float* input_data,
+    const RuntimeShape& weights_shape, const float* weights_data,
+    const RuntimeShape& bias_shape, const float* bias_data,
+    const RuntimeShape& output_shape, float* output_data,
+    CpuBackendContext* cpu_backend_context) {
+  FullyConnectedSparseWeight1xN(sparsity, params, input_shape, input_data,
+                                weights_shape, weights_data, bias_shape,
+                                bias_data, output_shape, output_data,
+                                /*block_size=*/16, cpu_backend_context);
+}
+
+inline void FullyConnectedSparseWeight1x4(
+    const TfLiteSparsity& sparsity, const FullyConnectedParams& params,
+    const RuntimeShape& input_shape, const float* input_data,
+    const RuntimeShape& weights_shape, const float* weights_data,
+    const RuntimeShape& bias_shape, const float* bias_data,
+    const RuntimeShape& output_shape, float* output_data,
+    CpuBackendContext* cpu_backend_context) {
+  FullyConnectedSparseWeight1xN(sparsity, params, input_shape, input_data,
+                                weights_shape, weights_data, bias_shape,
+                                bias_data, output_shape, output_data,
+                                /*block_size=*/4, cpu_backend_context);
+}
+
 }  // namespace optimized_ops
 }  // namespace tflite
 #endif  // TENSORFLOW_LITE_KERNELS_INTERNAL_OPTIMIZED_SPARSE_OPS_FULLY_CONNECTED_H_
@@ -31,6 +31,7 @@ limitations under the License.
 #include "tensorflow/lite/kernels/cpu_backend_context.h"
 #include "tensorflow/lite/kernels/cpu_backend_gemm.h"
 #include "tensorflow/lite/kernels/cpu_backend_gemm_params.h"
+#include "tensorflow/lite/kernels/internal/common.h"
 #include "tensorflow/lite/kernels/internal/compatibility.h"
 
 namespace tflite {
@@ -86,7 +87,6 @@ static inline int32_t ReduceInt32x4(__m128i acc) {
   return _mm_cvtsi128_si32(acc);
 }
 
-#ifdef __AVX2__
 // Horizontally add 4 float values stored in a single XMM register to float.
 static inline float ReduceFloat32x4(__m128 acc) {
   __m128 shuffle = _mm_movehdup_ps(acc);
@@ -96,6 +96,8 @@ static inline float ReduceFloat32x4(__m128 acc) {
   return _mm_cvtss_f32(acc);
 }
 
+#ifdef __AVX2__
+
 // Horizontally add 8 float values stored in a single XMM register to float.
 static inline float ReduceFloat32x8(__m256 acc) {
   __m128 low = _mm256_extractf128_ps(acc, 0);
@@ -617,6 +619,178 @@ void SseSparseMatrixBatchVectorMultiplyAccumulate(
   }  // for batch
 }
 
+void SseSparseMatrixBatchVectorMultiplyAccumulate1x4(
+    const float* __restrict__ matrix, const int32_t* __restrict__ segments,
+    const int32_t* __restrict__ indices, int m_rows, int m_cols,
+    const float* __restrict__ vector, int n_batch, float* __restrict__ result) {
+  constexpr int kBlockSize = 4;
+  TFLITE_DCHECK_EQ(m_cols % kBlockSize, 0);
+  for (int batch = 0; batch < n_batch; batch++) {
+    const float* matrix_ptr = matrix;
+    const float* vector_in_batch = vector + batch * m_cols;
+    for (int row = 0; row < m_rows; row++) {
+      __m128 acc_fx4 = _mm_setzero_ps();
+      for (int i = segments[row]; i < segments[row + 1]; i++) {
+        const __m128 vec_fx4 =
+            _mm_loadu_ps(vector_in_batch + indices[i] * kBlockSize);
+        const __m128 row_fx4 = _mm_loadu_ps(matrix_ptr);
+        acc_fx4 = _mm_add_ps(acc_fx4, _mm_mul_ps(row_fx4, vec_fx4));
+        matrix_ptr += kBlockSize;
+      }
+      result[batch * m_rows + row] += ReduceFloat32x4(acc_fx4);
+    }
+  }
+}
+
+void SseSparseMatrixBatchVectorMultiplyAccumulate1x16(
+    const float* __restrict__ matrix, const int32_t* __restrict__ segments,
+    const int32_t* __restrict__ indices, int m_rows, int m_cols,
+    const float* __restrict__ vector, int n_batch, float* __restrict__ result) {
+  constexpr int kBlockSize = 16;
+  TFLITE_DCHECK_EQ(m_cols % kBlockSize, 0);
+  for (int batch = 0; batch < n_batch; batch++) {
+    const float* matrix_ptr = matrix;
+    const float* vector_in_batch = vector + batch * m_cols;
+    for (int row = 0; row < m_rows; row++) {
+      // Keeps 4 independent accumulators to hide the latency of the adds.
+      __m128 acc0_fx4 = _mm_setzero_ps();
+      __m128 acc1_fx4 = _mm_setzero_ps();
+      __m128 acc2_fx4 = _mm_setzero_ps();
+      __m128 acc3_fx4 = _mm_setzero_ps();
+      for (int i = segments[row]; i < segments[row + 1]; i++) {
+        const float* vector_block = vector_in_batch + indices[i] * kBlockSize;
+        acc0_fx4 = _mm_add_ps(acc0_fx4, _mm_mul_ps(_mm_loadu_ps(matrix_ptr),
+                                                   _mm_loadu_ps(vector_block)));
+        acc1_fx4 = _mm_add_ps(
+            acc1_fx4, _mm_mul_ps(_mm_loadu_ps(matrix_ptr + 4),
+                                 _mm_loadu_ps(vector_block + 4)));
+        acc2_fx4 = _mm_add_ps(
+            acc2_fx4, _mm_mul_ps(_mm_loadu_ps(matrix_ptr + 8),
+                                 _mm_loadu_ps(vector_block + 8)));
+        acc3_fx4 = _mm_add_ps(
+            acc3_fx4, _mm_mul_ps(_mm_loadu_ps(matrix_ptr + 12),
+                                 _mm_loadu_ps(vector_block + 12)));
+        matrix_ptr += kBlockSize;
+      }
+      const __m128 acc_fx4 = _mm_add_ps(_mm_add_ps(acc0_fx4, acc1_fx4),
+                                        _mm_add_ps(acc2_fx4, acc3_fx4));
+      result[batch * m_rows + row] += ReduceFloat32x4(acc_fx4);
+    }
+  }
+}
+
+namespace {
+
+// Requantizes the int32 dot product of a row of a sparse int8 matrix and the
+// input to the int8 output.
+inline int8_t SseRequantizeSparseDotProd(
+    int32_t dot_prod, int32_t matrix_row_sum, int32_t bias_value,
+    const int32_t input_offset, const int32_t output_multiplier,
+    const int32_t output_shift, const int32_t output_offset,
+    const int32_t output_activation_min, const int32_t output_activation_max) {
+  int32_t acc = dot_prod + bias_value + input_offset * matrix_row_sum;
+  acc = MultiplyByQuantizedMultiplier(acc, output_multiplier, output_shift);
+  acc += output_offset;
+  return static_cast<int8_t>(ActivationFunctionWithMinMax(
+      acc, output_activation_min, output_activation_max));
+}
+
+}  // namespace
+
+void SseSparseMatrixBatchVectorMultiplyAccumulate1x16(
+    const int8_t* __restrict__ matrix, const int32_t* __restrict__ segments,
+    const int32_t* __restrict__ indices, int m_rows, int m_cols,
+    const int8_t* __restrict__ vector, const int32_t* __restrict__ bias_vector,
+    int n_batch, const int32_t input_offset, const int32_t output_multiplier,
+    const int32_t output_shift, const int32_t output_offset,
+    const int32_t output_activation_min, const int32_t output_activation_max,
+    int8_t* __restrict__ result) {
+  constexpr int kBlockSize = 16;
+  TFLITE_DCHECK_EQ(m_cols % kBlockSize, 0);
+  const __m128i ones_8x16 = _mm_set1_epi8(1);
+  for (int batch = 0; batch < n_batch; ++batch) {
+    const int8_t* matrix_ptr = matrix;
+    const int8_t* vector_in_batch = vector + batch * m_cols;
+    for (int row = 0; row < m_rows; ++row) {
+      __m128i dotprod_32x4 = _mm_setzero_si128();
+      __m128i row_sum_32x4 = _mm_setzero_si128();
+      for (int i = segments[row]; i < segments[row + 1]; ++i) {
+        const __m128i vec_8x16 =
+            _mm_loadu_si128(reinterpret_cast<const __m128i*>(
+                vector_in_batch + indices[i] * kBlockSize));
+        const __m128i row_8x16 =
+            _mm_loadu_si128(reinterpret_cast<const __m128i*>(matrix_ptr));
+        // The weights are symmetric, so only the input can be -128.
+        dotprod_32x4 =
+            _mm_add_epi32(dotprod_32x4, DotProdInt8x4x4(vec_8x16, row_8x16));
+        row_sum_32x4 =
+            _mm_add_epi32(row_sum_32x4, DotProdInt8x4x4(ones_8x16, row_8x16));
+        matrix_ptr += kBlockSize;
+      }
+      const int32_t bias_value = bias_vector != nullptr ? bias_vector[row] : 0;
+      result[batch * m_rows + row] = SseRequantizeSparseDotProd(
+          ReduceInt32x4(dotprod_32x4), ReduceInt32x4(row_sum_32x4), bias_value,
+          input_offset, output_multiplier, output_shift, output_offset,
+          output_activation_min, output_activation_max);
+    }
+  }
+}
+
+void SseSparseMatrixBatchVectorMultiplyAccumulate1x4(
+    const int8_t* __restrict__ matrix, const int32_t* __restrict__ segments,
+    const int32_t* __restrict__ indices, int m_rows, int m_cols,
+    const int8_t* __restrict__ vector, const int32_t* __restrict__ bias_vector,
+    int n_batch, const int32_t input_offset, const int32_t output_multiplier,
+    const int32_t output_shift, const int32_t output_offset,
+    const int32_t output_activation_min, const int32_t output_activation_max,
+    int8_t* __restrict__ result) {
+  constexpr int kBlockSize = 4;
+  TFLITE_DCHECK_EQ(m_cols % kBlockSize, 0);
+  const __m128i ones_8x16 = _mm_set1_epi8(1);
+  for (int batch = 0; batch < n_batch; ++batch) {
+    const int8_t* matrix_ptr = matrix;
+    const int8_t* vector_in_batch = vector + batch * m_cols;
+    for (int row = 0; row < m_rows; ++row) {
+      __m128i dotprod_32x4 = _mm_setzero_si128();
+      __m128i row_sum_32x4 = _mm_setzero_si128();
+      int i = segments[row];
+      // The blocks of a row are contiguous in the matrix, so gather the input
+      // of 4 blocks into a single register.
+      for (; i + 4 <= segments[row + 1]; i += 4) {
+        const __m128i vec01_8x8 = _mm_unpacklo_epi32(
+            _mm_loadu_si32(vector_in_batch + indices[i] * kBlockSize),
+            _mm_loadu_si32(vector_in_batch + indices[i + 1] * kBlockSize));
+        const __m128i vec23_8x8 = _mm_unpacklo_epi32(
+            _mm_loadu_si32(vector_in_batch + indices[i + 2] * kBlockSize),
+            _mm_loadu_si32(vector_in_batch + indices[i + 3] * kBlockSize));
+        const __m128i vec_8x16 = _mm_unpacklo_epi64(vec01_8x8, vec23_8x8);
+        const __m128i row_8x16 =
+            _mm_loadu_si128(reinterpret_cast<const __m128i*>(matrix_ptr));
+        dotprod_32x4 =
+            _mm_add_epi32(dotprod_32x4, DotProdInt8x4x4(vec_8x16, row_8x16));
+        row_sum_32x4 =
+            _mm_add_epi32(row_sum_32x4, DotProdInt8x4x4(ones_8x16, row_8x16));
+        matrix_ptr += 4 * kBlockSize;
+      }
+      for (; i < segments[row + 1]; ++i) {
+        const __m128i vec_8x4 =
+            _mm_loadu_si32(vector_in_batch + indices[i] * kBlockSize);
+        const __m128i row_8x4 = _mm_loadu_si32(matrix_ptr);
+        dotprod_32x4 =
+            _mm_add_epi32(dotprod_32x4, DotProdInt8x4x4(vec_8x4, row_8x4));
+        row_sum_32x4 =
+            _mm_add_epi32(row_sum_32x4, DotProdInt8x4x4(ones_8x16, row_8x4));
+        matrix_ptr += kBlockSize;
+      }
+      const int32_t bias_value = bias_vector != nullptr ? bias_vector[row] : 0;
+      result[batch * m_rows + row] = SseRequantizeSparseDotProd(
+          ReduceInt32x4(dotprod_32x4), ReduceInt32x4(row_sum_32x4), bias_value,
+          input_offset, output_multiplier, output_shift, output_offset,
+          output_activation_min, output_activation_max);
+    }
+  }
+}
+
 void SseReductionSumVector(const int8_t* input_vector, int32_t* output_vector,
                            const int output_size, const int reduction_size) {
   static constexpr std::intptr_t kBlockSize = 16;
@@ -1552,6 +1552,49 @@ TEST(uKernels, SparseMatrixBatchVectorMultiplyAccumulateTest) {
 
   EXPECT_THAT(sparse_output,
               ElementsAreArray(ArrayFloatNear(dense_output, 1e-4)));
+
+  // The same matrix in the 1x16 block format of sparse FullyConnected.
+  const int32_t segments[] = {0, 2, 3, 4, 6};
+  const int32_t indices[] = {0, 2, 1, 1, 0, 2};
+  std::vector<float> sparse_1x16_output(kRow * kBatch, 0.0);
+  SparseMatrixBatchVectorMultiplyAccumulate1x16(
+      matrix_values, segments, indices, kRow, kCol, vector, kBatch,
+      sparse_1x16_output.data());
+
+  EXPECT_THAT(sparse_1x16_output,
+              ElementsAreArray(ArrayFloatNear(dense_output, 1e-4)));
+}
+
+TEST(uKernels, SparseMatrixBatchVectorMultiplyAccumulate1x4Int8Test) {
+  const int kRow = 3;
+  const int kCol = 8;
+  const int kBatch = 2;
+  // 1x4 blocks of the matrix
+  // {{1, 2, 3, 4, 0, 0, 0, 0},
+  //  {0, 0, 0, 0, -1, 1, -2, 2},
+  //  {1, 1, 1, 1, 2, 2, 2, 2}}
+  const int8_t matrix_values[] = {1, 2, 3, 4, -1, 1, -2, 2,
+                                  1, 1, 1, 1, 2,  2, 2,  2};
+  const int32_t segments[] = {0, 1, 2, 4};
+  const int32_t indices[] = {0, 1, 0, 1};
+  const int8_t vector[kBatch * kCol] = {1,  2,  3,  4,  5,  6,  7,  8,
+                                        -1, -1, -1, -1, -1, -1, -1, -1};
+  const int32_t bias[kRow] = {10, -10, 0};
+  const int32_t input_offset = 1;
+  // A multiplier of 0.5 with a left shift of 1 leaves the accumulators
+  // unchanged.
+  const int32_t output_multiplier = 1 << 30;
+  const int32_t output_shift = 1;
+  const int32_t output_offset = -5;
+
+  std::vector<int8_t> output(kRow * kBatch);
+  SparseMatrixBatchVectorMultiplyAccumulate1x4(
+      matrix_values, segments, indices, kRow, kCol, vector, bias, kBatch,
+      input_offset, output_multiplier, output_shift, output_offset,
+      /*output_activation_min=*/-128, /*output_activation_max=*/60,
+      output.data());
+
+  EXPECT_THAT(output, ElementsAreArray({45, -12, 60, 5, -15, -5}));
 }
 
 #ifdef __ANDROID__
@@ -29,6 +29,7 @@ limitations under the License.
 #include "tensorflow/lite/c/builtin_op_data.h"
 #include "tensorflow/lite/c/common.h"
 #include "tensorflow/lite/kernels/cpu_backend_context.h"
+#include "tensorflow/lite/kernels/cpu_backend_threadpool.h"
 #include "tensorflow/lite/kernels/internal/compatibility.h"
 #include "tensorflow/lite/kernels/internal/kernel_utils.h"
 #include "tensorflow/lite/kernels/internal/optimized/optimized_ops.h"
@@ -962,6 +963,261 @@ inline void LstmStepFloat(
 // LINT.ThenChange(../tools/optimize/calibration/builtin_logging_ops/lstm.cc,\
 //                 ../experimental/kernels/fp16/lstm_eval.cc)
 
+// The pointers and sizes of a fused LSTM step that the gate math of each
+// batch needs. See LstmStepFloatFused.
+struct FusedLstmGateArgs {
+  bool use_cifg;
+  const float* cell_to_input_weights_ptr;
+  const float* cell_to_forget_weights_ptr;
+  const float* cell_to_output_weights_ptr;
+  const float* input_layer_norm_coefficients_ptr;
+  const float* forget_layer_norm_coefficients_ptr;
+  const float* cell_layer_norm_coefficients_ptr;
+  const float* output_layer_norm_coefficients_ptr;
+  const float* input_gate_bias_ptr;
+  const float* forget_gate_bias_ptr;
+  const float* cell_gate_bias_ptr;
+  const float* output_gate_bias_ptr;
+  const TfLiteLSTMParams* params;
+  int n_cell;
+  // The gate pre-activations, 'n_gates * n_cell' per batch.
+  float* gates;
+  // Input/output vector, size n_batch * n_cell.
+  float* cell_state;
+  // Output vector for output_gate .* activate(cell_state), size
+  // n_batch * n_cell.
+  float* hidden;
+};
+
+// Normalizes a single gate of a layer norm LSTM and adds its bias, as in
+// CalculateLstmGateFloat.
+inline void NormalizeLstmGateFloat(const float* layer_norm_coefficients,
+                                   const float* gate_bias, int n_cell,
+                                   float* gate) {
+  tensor_utils::MeanStddevNormalization(gate, gate, n_cell, /*n_batch=*/1);
+  tensor_utils::VectorBatchVectorCwiseProduct(layer_norm_coefficients, n_cell,
+                                              gate, /*n_batch=*/1, gate);
+  tensor_utils::VectorBatchVectorAdd(gate_bias, n_cell, /*n_batch=*/1, gate);
+}
+
+// Applies the peephole connections, layer norm and activations to the gates of
+// the batches [batch_start, batch_end), updates their cell state and computes
+// their output before projection. The batches are independent, so that the
+// ranges can run on different threads.
+void UpdateFusedLstmGatesFloat(const FusedLstmGateArgs& args, int batch_start,
+                               int batch_end) {
+  const int n_cell = args.n_cell;
+  const int n_gates = args.use_cifg ? 3 : 4;
+  const bool use_layer_norm =
+      (args.forget_layer_norm_coefficients_ptr != nullptr);
+  for (int b = batch_start; b < batch_end; ++b) {
+    float* gates = args.gates + b * n_gates * n_cell;
+    float* input_gate = args.use_cifg ? nullptr : gates;
+    float* forget_gate = args.use_cifg ? gates : gates + n_cell;
+    float* output_gate = forget_gate + n_cell;
+    float* cell_gate = output_gate + n_cell;
+    float* cell_state = args.cell_state + b * n_cell;
+    float* hidden = args.hidden + b * n_cell;
+
+    // The input and forget gates are contiguous, so that both are activated at
+    // once.
+    if (!args.use_cifg) {
+      if (args.cell_to_input_weights_ptr != nullptr) {
+        tensor_utils::VectorVectorCwiseProductAccumulate(
+            args.cell_to_input_weights_ptr, cell_state, n_cell, input_gate);
+      }
+      if (use_layer_norm) {
+        NormalizeLstmGateFloat(args.input_layer_norm_coefficients_ptr,
+                               args.input_gate_bias_ptr, n_cell, input_gate);
+      }
+    }
+    if (args.cell_to_forget_weights_ptr != nullptr) {
+      tensor_utils::VectorVectorCwiseProductAccumulate(
+          args.cell_to_forget_weights_ptr, cell_state, n_cell, forget_gate);
+    }
+    if (use_layer_norm) {
+      NormalizeLstmGateFloat(args.forget_layer_norm_coefficients_ptr,
+                             args.forget_gate_bias_ptr, n_cell, forget_gate);
+      NormalizeLstmGateFloat(args.cell_layer_norm_coefficients_ptr,
+                             args.cell_gate_bias_ptr, n_cell, cell_gate);
+    }
+    float* sigmoid_gates = args.use_cifg ? forget_gate : input_gate;
+    const int n_sigmoid = args.use_cifg ? n_cell : 2 * n_cell;
+    tensor_utils::ApplySigmoidToVector(sigmoid_gates, n_sigmoid,
+                                       sigmoid_gates);
+    tensor_utils::ApplyActivationToVector(cell_gate, n_cell,
+                                          args.params->activation, cell_gate);
+
+    UpdateLstmCellFloat(/*n_batch=*/1, n_cell, cell_state, input_gate,
+                        forget_gate, cell_gate, args.use_cifg,
+                        args.params->cell_clip);
+
+    // The output gate peeks at the new cell state.
+    if (args.cell_to_output_weights_ptr != nullptr) {
+      tensor_utils::VectorVectorCwiseProductAccumulate(
+          args.cell_to_output_weights_ptr, cell_state, n_cell, output_gate);
+    }
+    if (use_layer_norm) {
+      NormalizeLstmGateFloat(args.output_layer_norm_coefficients_ptr,
+                             args.output_gate_bias_ptr, n_cell, output_gate);
+    }
+    tensor_utils::ApplySigmoidToVector(output_gate, n_cell, output_gate);
+
+    tensor_utils::ApplyActivationToVector(cell_state, n_cell,
+                                          args.params->activation, hidden);
+    tensor_utils::VectorVectorCwiseProduct(output_gate, hidden, n_cell, hidden);
+  }
+}
+
+class FusedLstmGatesTask : public cpu_backend_threadpool::Task {
+ public:
+  FusedLstmGatesTask(const FusedLstmGateArgs& args, int batch_start,
+                     int batch_end)
+      : args_(args), batch_start_(batch_start), batch_end_(batch_end) {}
+
+  void Run() override {
+    UpdateFusedLstmGatesFloat(args_, batch_start_, batch_end_);
+  }
+
+ private:
+  const FusedLstmGateArgs& args_;
+  const int batch_start_;
+  const int batch_end_;
+};
+
+// The minimum number of cells per thread worth splitting the gate math of a
+// step over threads for.
+constexpr int kMinFusedLstmCellsPerThread = 4096;
+
+// Same as LstmStepFloat, with the gate weights and biases of `fused_weights`.
+// All gates are computed with one matrix multiplication per input, and the
+// element-wise gate math is split by batch over the threads of `context`.
+//
+// scratch0 and scratch1 both hold
+// 'n_batch * FusedLstmScratchSizeFloat(n_cell, n_output, use_cifg) / 2'
+// floats.
+inline void LstmStepFloatFused(
+    const float* input_ptr, const float* aux_input_ptr,
+    const FusedLstmWeightsFloat& fused_weights,
+    const float* cell_to_input_weights_ptr,
+    const float* cell_to_forget_weights_ptr,
+    const float* cell_to_output_weights_ptr,
+    const float* input_layer_norm_coefficients_ptr,
+    const float* forget_layer_norm_coefficients_ptr,
+    const float* cell_layer_norm_coefficients_ptr,
+    const float* output_layer_norm_coefficients_ptr,
+    const float* input_gate_bias_ptr, const float* forget_gate_bias_ptr,
+    const float* cell_gate_bias_ptr, const float* output_gate_bias_ptr,
+    const float* projection_weights_ptr, const float* projection_bias_ptr,
+    const TfLiteLSTMParams* params, int n_batch, int n_cell, int n_input,
+    int n_aux_input, int n_output, int output_batch_leading_dim,
+    float* output_state_ptr, float* cell_state_ptr, float* scratch0,
+    float* scratch1, float* output_ptr, CpuBackendContext* context) {
+  ruy::profiler::ScopeLabel label("LstmStepFloatFused");
+  const bool use_cifg = (fused_weights.n_gates == 3);
+  const bool use_layer_norm = (forget_layer_norm_coefficients_ptr != nullptr);
+  const bool use_projection = (projection_weights_ptr != nullptr);
+  const int n_rows = fused_weights.n_gates * n_cell;
+
+  // Check if inputs are all zeros so we can skip some computations.
+  const bool is_input_all_zeros =
+      tensor_utils::IsZeroVector(input_ptr, n_batch * n_input);
+  const bool is_aux_input_all_zeros =
+      (aux_input_ptr == nullptr || fused_weights.aux_input_weights.empty() ||
+       tensor_utils::IsZeroVector(aux_input_ptr, n_batch * n_aux_input));
+
+  // Initialize the gates with bias for regular lstm or with zero for layer
+  // norm lstm, which adds the bias after normalization.
+  float* gates = scratch0;
+  float* accumulation_buffer = scratch1;
+  if (use_layer_norm) {
+    std::fill_n(gates, n_rows * n_batch, 0.0f);
+  } else {
+    tensor_utils::VectorBatchVectorAssign(fused_weights.bias.data(), n_rows,
+                                          n_batch, gates);
+  }
+  if (!is_input_all_zeros) {
+    MatrixBatchVectorMultiplyAccumulate(fused_weights.input_weights.data(),
+                                        input_ptr, gates, accumulation_buffer,
+                                        n_rows, n_input, n_batch, context);
+    std::swap(gates, accumulation_buffer);
+  }
+  if (!is_aux_input_all_zeros) {
+    MatrixBatchVectorMultiplyAccumulate(
+        fused_weights.aux_input_weights.data(), aux_input_ptr, gates,
+        accumulation_buffer, n_rows, n_aux_input, n_batch, context);
+    std::swap(gates, accumulation_buffer);
+  }
+  MatrixBatchVectorMultiplyAccumulate(fused_weights.recurrent_weights.data(),
+                                      output_state_ptr, gates,
+                                      accumulation_buffer, n_rows, n_output,
+                                      n_batch, context);
+  std::swap(gates, accumulation_buffer);
+
+  FusedLstmGateArgs args;
+  args.use_cifg = use_cifg;
+  args.cell_to_input_weights_ptr = cell_to_input_weights_ptr;
+  args.cell_to_forget_weights_ptr = cell_to_forget_weights_ptr;
+  args.cell_to_output_weights_ptr = cell_to_output_weights_ptr;
+  args.input_layer_norm_coefficients_ptr = input_layer_norm_coefficients_ptr;
+  args.forget_layer_norm_coefficients_ptr = forget_layer_norm_coefficients_ptr;
+  args.cell_layer_norm_coefficients_ptr = cell_layer_norm_coefficients_ptr;
+  args.output_layer_norm_coefficients_ptr = output_layer_norm_coefficients_ptr;
+  args.input_gate_bias_ptr = input_gate_bias_ptr;
+  args.forget_gate_bias_ptr = forget_gate_bias_ptr;
+  args.cell_gate_bias_ptr = cell_gate_bias_ptr;
+  args.output_gate_bias_ptr = output_gate_bias_ptr;
+  args.params = params;
+  args.n_cell = n_cell;
+  args.gates = gates;
+  args.cell_state = cell_state_ptr;
+  // Without projection the output before projection is the output state,
+  // which the matrix multiplications above are done reading.
+  args.hidden = use_projection ? accumulation_buffer : output_state_ptr;
+
+  const int thread_count = std::min(
+      {context->max_num_threads(), n_batch,
+       n_batch * n_cell / kMinFusedLstmCellsPerThread});
+  if (thread_count <= 1) {
+    UpdateFusedLstmGatesFloat(args, 0, n_batch);
+  } else {
+    std::vector<FusedLstmGatesTask> tasks;
+    tasks.reserve(thread_count);
+    int batch_start = 0;
+    for (int i = 0; i < thread_count; ++i) {
+      const int batch_end = batch_start + (n_batch - batch_start) /
+                                              (thread_count - i);
+      tasks.emplace_back(args, batch_start, batch_end);
+      batch_start = batch_end;
+    }
+    cpu_backend_threadpool::Execute(tasks.size(), tasks.data(), context);
+  }
+
+  if (use_projection) {
+    // The gates are done with, so they hold the projection bias.
+    float* projection_bias_scratch = gates;
+    if (projection_bias_ptr != nullptr) {
+      tensor_utils::VectorBatchVectorAssign(projection_bias_ptr, n_output,
+                                            n_batch, projection_bias_scratch);
+    } else {
+      std::fill_n(projection_bias_scratch, n_batch * n_output, 0.0f);
+    }
+    MatrixBatchVectorMultiplyAccumulate(
+        projection_weights_ptr, args.hidden, projection_bias_scratch,
+        output_state_ptr, n_output, n_cell, n_batch, context);
+    if (params->proj_clip > 0.0f) {
+      tensor_utils::CwiseClipping(output_state_ptr, n_batch * n_output,
+                                  params->proj_clip);
+    }
+  }
+  // Copy output state to the output. Note that the output's rows may not be
+  // contiguous (output_batch_leading_dim != n_output).
+  for (int b = 0; b < n_batch; b++) {
+    std::copy_n(output_state_ptr + b * n_output, n_output,
+                output_ptr + b * output_batch_leading_dim);
+  }
+}
+
 // Same as above but with quantized weight matrices. In detail:
 // Input of size 'n_batch * n_input':
 //   input_ptr
@@ -1739,8 +1995,65 @@ inline void LstmStepInteger8x8_8(
   std::copy_n(output_state_ptr, n_batch * n_output, output_ptr);
 }
 
+// Appends the data of the float `tensor`, if any, to `fused`.
+void AppendTensorData(const TfLiteTensor* tensor, std::vector<float>* fused) {
+  if (tensor == nullptr) return;
+  const float* data = GetTensorData<float>(tensor);
+  fused->insert(fused->end(), data, data + tensor->bytes / sizeof(float));
+}
+
 }  // namespace
 
+void FuseLstmWeightsFloat(
+    const TfLiteTensor* input_to_input_weights,
+    const TfLiteTensor* input_to_forget_weights,
+    const TfLiteTensor* input_to_cell_weights,
+    const TfLiteTensor* input_to_output_weights,
+    const TfLiteTensor* aux_input_to_input_weights,
+    const TfLiteTensor* aux_input_to_forget_weights,
+    const TfLiteTensor* aux_input_to_cell_weights,
+    const TfLiteTensor* aux_input_to_output_weights,
+    const TfLiteTensor* recurrent_to_input_weights,
+    const TfLiteTensor* recurrent_to_forget_weights,
+    const TfLiteTensor* recurrent_to_cell_weights,
+    const TfLiteTensor* recurrent_to_output_weights,
+    const TfLiteTensor* input_gate_bias, const TfLiteTensor* forget_gate_bias,
+    const TfLiteTensor* cell_gate_bias, const TfLiteTensor* output_gate_bias,
+    FusedLstmWeightsFloat* fused_weights) {
+  const bool use_cifg = (input_to_input_weights == nullptr);
+  fused_weights->n_gates = use_cifg ? 3 : 4;
+  // The weights of each gate are 'n_cell' rows, so that fusing them
+  // concatenates the tensors.
+  const auto fuse = [use_cifg](const TfLiteTensor* input_gate,
+                               const TfLiteTensor* forget_gate,
+                               const TfLiteTensor* cell_gate,
+                               const TfLiteTensor* output_gate,
+                               std::vector<float>* fused) {
+    fused->clear();
+    if (!use_cifg) AppendTensorData(input_gate, fused);
+    AppendTensorData(forget_gate, fused);
+    AppendTensorData(output_gate, fused);
+    AppendTensorData(cell_gate, fused);
+  };
+  fuse(input_to_input_weights, input_to_forget_weights, input_to_cell_weights,
+       input_to_output_weights, &fused_weights->input_weights);
+  fuse(aux_input_to_input_weights, aux_input_to_forget_weights,
+       aux_input_to_cell_weights, aux_input_to_output_weights,
+       &fused_weights->aux_input_weights);
+  fuse(recurrent_to_input_weights, recurrent_to_forget_weights,
+       recurrent_to_cell_weights, recurrent_to_output_weights,
+       &fused_weights->recurrent_weights);
+  fuse(input_gate_bias, forget_gate_bias, cell_gate_bias, output_gate_bias,
+       &fused_weights->bias);
+}
+
+int FusedLstmScratchSizeFloat(int n_cell, int n_output, bool use_cifg) {
+  // Two buffers for the gates, which also hold the output before projection
+  // and the projection bias.
+  const int n_gates = use_cifg ? 3 : 4;
+  return 2 * std::max(n_gates * n_cell, n_output);
+}
+
 // LINT.IfChange
 TfLiteStatus EvalFloat(
     const TfLiteTensor* input, const TfLiteTensor* input_to_input_weights,
@@ -1768,8 +2081,8 @@ TfLiteStatus EvalFloat(
     const TfLiteTensor* projection_weights, const TfLiteTensor* projection_bias,
     const TfLiteLSTMParams* params, bool forward_sequence, bool time_major,
     int output_offset, TfLiteTensor* scratch_buffer, TfLiteTensor* output_state,
-    TfLiteTensor* cell_state, TfLiteTensor* output,
-    CpuBackendContext* context) {
+    TfLiteTensor* cell_state, TfLiteTensor* output, CpuBackendContext* context,
+    const FusedLstmWeightsFloat* fused_weights) {
   TF_LITE_ASSERT(input->dims->size >= 2 && input->dims->size <= 3);
   int max_time, n_batch;
   if (input->dims->size == 3) {
@@ -1813,6 +2126,11 @@ TfLiteStatus EvalFloat(
 
   const int output_batch_leading_dim =
       output->dims->data[output->dims->size - 1];
+  // The fused step uses the scratch buffer as two halves.
+  float* fused_scratch0 = scratch_buffer_ptr;
+  float* fused_scratch1 =
+      scratch_buffer_ptr +
+      n_batch * FusedLstmScratchSizeFloat(n_cell, n_output, use_cifg) / 2;
   if (time_major) {
     // Loop through the sequence.
     const int input_step = n_batch * n_input;
@@ -1829,6 +2147,28 @@ TfLiteStatus EvalFloat(
       float* output_ptr =
           GetTensorData<float>(output) + t_rel * output_step + output_offset;
 
+      if (fused_weights != nullptr) {
+        LstmStepFloatFused(
+            input_ptr, aux_input_ptr, *fused_weights,
+            GetTensorData<float>(cell_to_input_weights),
+            GetTensorData<float>(cell_to_forget_weights),
+            GetTensorData<float>(cell_to_output_weights),
+            GetTensorData<float>(input_layer_norm_coefficients),
+            GetTensorData<float>(forget_layer_norm_coefficients),
+            GetTensorData<float>(cell_layer_norm_coefficients),
+            GetTensorData<float>(output_layer_norm_coefficients),
+            GetTensorData<float>(input_gate_bias),
+            GetTensorData<float>(forget_gate_bias),
+            GetTensorData<float>(cell_gate_bias),
+            GetTensorData<float>(output_gate_bias),
+            GetTensorData<float>(projection_weights),
+            GetTensorData<float>(projection_bias), params, n_batch, n_cell,
+            n_input, aux_input_size, n_output, output_batch_leading_dim,
+            GetTensorData<float>(output_state),
+            GetTensorData<float>(cell_state), fused_scratch0, fused_scratch1,
+            output_ptr, context);
+        continue;
+      }
       LstmStepFloat(
           input_ptr, GetTensorData<float>(input_to_input_weights),
           GetTensorData<float>(input_to_forget_weights),
@@ -1891,6 +2231,27 @@ TfLiteStatus EvalFloat(
         float* cell_gate_scratch_ptr = cell_gate_scratch + b * n_cell;
         float* output_gate_scratch_ptr = output_gate_scratch + b * n_cell;
 
+        if (fused_weights != nullptr) {
+          LstmStepFloatFused(
+              input_ptr, aux_input_ptr, *fused_weights,
+              GetTensorData<float>(cell_to_input_weights),
+              GetTensorData<float>(cell_to_forget_weights),
+              GetTensorData<float>(cell_to_output_weights),
+              GetTensorData<float>(input_layer_norm_coefficients),
+              GetTensorData<float>(forget_layer_norm_coefficients),
+              GetTensorData<float>(cell_layer_norm_coefficients),
+              GetTensorData<float>(output_layer_norm_coefficients),
+              GetTensorData<float>(input_gate_bias),
+              GetTensorData<float>(forget_gate_bias),
+              GetTensorData<float>(cell_gate_bias),
+              GetTensorData<float>(output_gate_bias),
+              GetTensorData<float>(projection_weights),
+              GetTensorData<float>(projection_bias), params, /*n_batch=*/1,
+              n_cell, n_input, aux_input_size, n_output,
+              output_batch_leading_dim, output_state_ptr, cell_state_ptr,
+              fused_scratch0, fused_scratch1, output_ptr, context);
+          continue;
+        }
         LstmStepFloat(
             input_ptr, GetTensorData<float>(input_to_input_weights),
             GetTensorData<float>(input_to_forget_weights),
@@ -17,6 +17,7 @@ limitations under the License.
 
 #include <cstdint>
 #include <memory>
+#include <vector>
 
 #include "tensorflow/lite/c/builtin_op_data.h"
 #include "tensorflow/lite/c/common.h"
@@ -95,6 +96,47 @@ struct IntegerLstmParameter {
   int32_t intermediate_zp[12];
 };
 
+// The gate weights and biases of a float LSTM, concatenated along the cell
+// dimension in the order input (unless CIFG), forget, output, cell gate. With
+// these, each step computes all gates with one matrix multiplication per
+// input instead of one per gate and input.
+struct FusedLstmWeightsFloat {
+  // The number of gates, 3 with CIFG and 4 otherwise.
+  int n_gates = 0;
+  // Size 'n_gates * n_cell * n_input'.
+  std::vector<float> input_weights;
+  // Size 'n_gates * n_cell * n_aux_input', empty without auxiliary input.
+  std::vector<float> aux_input_weights;
+  // Size 'n_gates * n_cell * n_output'.
+  std::vector<float> recurrent_weights;
+  // Size 'n_gates * n_cell'.
+  std::vector<float> bias;
+};
+
+// Fills `fused_weights` from the weight and bias tensors of a float LSTM. The
+// input gate tensors are nullptr with CIFG, and the auxiliary input weights
+// are nullptr without auxiliary input.
+void FuseLstmWeightsFloat(
+    const TfLiteTensor* input_to_input_weights,
+    const TfLiteTensor* input_to_forget_weights,
+    const TfLiteTensor* input_to_cell_weights,
+    const TfLiteTensor* input_to_output_weights,
+    const TfLiteTensor* aux_input_to_input_weights,
+    const TfLiteTensor* aux_input_to_forget_weights,
+    const TfLiteTensor* aux_input_to_cell_weights,
+    const TfLiteTensor* aux_input_to_output_weights,
+    const TfLiteTensor* recurrent_to_input_weights,
+    const TfLiteTensor* recurrent_to_forget_weights,
+    const TfLiteTensor* recurrent_to_cell_weights,
+    const TfLiteTensor* recurrent_to_output_weights,
+    const TfLiteTensor* input_gate_bias, const TfLiteTensor* forget_gate_bias,
+    const TfLiteTensor* cell_gate_bias, const TfLiteTensor* output_gate_bias,
+    FusedLstmWeightsFloat* fused_weights);
+
+// Returns the number of floats per batch that EvalFloat needs in the scratch
+// buffer when it is given fused weights.
+int FusedLstmScratchSizeFloat(int n_cell, int n_output, bool use_cifg);
+
 TfLiteStatus EvalFloat(
     const TfLiteTensor* input, const TfLiteTensor* input_to_input_weights,
     const TfLiteTensor* input_to_forget_weights,
@@ -121,7 +163,8 @@ TfLiteStatus EvalFloat(
     const TfLiteTensor* projection_weights, const TfLiteTensor* projection_bias,
     const TfLiteLSTMParams* params, bool forward_sequence, bool time_major,
     int output_offset, TfLiteTensor* scratch_buffer, TfLiteTensor* output_state,
-    TfLiteTensor* cell_state, TfLiteTensor* output, CpuBackendContext* context);
+    TfLiteTensor* cell_state, TfLiteTensor* output, CpuBackendContext* context,
+    const FusedLstmWeightsFloat* fused_weights = nullptr);
 
 TfLiteStatus EvalHybrid(
     const TfLiteTensor* input, const TfLiteTensor* input_to_input_weights,
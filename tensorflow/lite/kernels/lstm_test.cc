@@ -2734,6 +2734,134 @@ TEST_F(NoCifgPeepholeProjectionNoClippingSparseLstmTest,
                 sparse_layer_norm_lstm_golden_output, &sparse_layer_norm_lstm);
 }
 
+// A float LSTM with constant weights and biases, which the kernel fuses in
+// Prepare.
+class ConstantWeightsLSTMOpModel : public SingleOpModel {
+ public:
+  ConstantWeightsLSTMOpModel(
+      int n_batch, int n_input, int n_cell, int n_output,
+      const std::vector<float>& input_to_input_weights,
+      const std::vector<float>& input_to_forget_weights,
+      const std::vector<float>& input_to_cell_weights,
+      const std::vector<float>& input_to_output_weights,
+      const std::vector<float>& recurrent_to_input_weights,
+      const std::vector<float>& recurrent_to_forget_weights,
+      const std::vector<float>& recurrent_to_cell_weights,
+      const std::vector<float>& recurrent_to_output_weights,
+      const std::vector<float>& input_gate_bias,
+      const std::vector<float>& forget_gate_bias,
+      const std::vector<float>& cell_gate_bias,
+      const std::vector<float>& output_gate_bias) {
+    input_ = AddInput({TensorType_FLOAT32, {n_batch, n_input}});
+    AddConstInput(TensorType_FLOAT32, input_to_input_weights,
+                  {n_cell, n_input});
+    AddConstInput(TensorType_FLOAT32, input_to_forget_weights,
+                  {n_cell, n_input});
+    AddConstInput(TensorType_FLOAT32, input_to_cell_weights, {n_cell, n_input});
+    AddConstInput(TensorType_FLOAT32, input_to_output_weights,
+                  {n_cell, n_input});
+    AddConstInput(TensorType_FLOAT32, recurrent_to_input_weights,
+                  {n_cell, n_output});
+    AddConstInput(TensorType_FLOAT32, recurrent_to_forget_weights,
+                  {n_cell, n_output});
+    AddConstInput(TensorType_FLOAT32, recurrent_to_cell_weights,
+                  {n_cell, n_output});
+    AddConstInput(TensorType_FLOAT32, recurrent_to_output_weights,
+                  {n_cell, n_output});
+    // No peephole.
+    AddNullInput();
+    AddNullInput();
+    AddNullInput();
+    AddConstInput(TensorType_FLOAT32, input_gate_bias, {n_cell});
+    AddConstInput(TensorType_FLOAT32, forget_gate_bias, {n_cell});
+    AddConstInput(TensorType_FLOAT32, cell_gate_bias, {n_cell});
+    AddConstInput(TensorType_FLOAT32, output_gate_bias, {n_cell});
+    // No projection.
+    AddNullInput();
+    AddNullInput();
+    AddVariableInput({TensorType_FLOAT32, {n_batch, n_output}});
+    AddVariableInput({TensorType_FLOAT32, {n_batch, n_cell}});
+    // No layer norm.
+    for (int i = 0; i < 4; ++i) {
+      AddNullInput();
+    }
+    output_ = AddOutput({TensorType_FLOAT32, {n_batch, n_output}});
+
+    SetBuiltinOp(
+        BuiltinOperator_LSTM, BuiltinOptions_LSTMOptions,
+        CreateLSTMOptions(builder_, ActivationFunctionType_TANH,
+                          /*cell_clip=*/0.0f, /*proj_clip=*/0.0f,
+                          LSTMKernelType_FULL)
+            .Union());
+    BuildInterpreter(/*input_shapes=*/{});
+  }
+
+  void SetInput(const std::vector<float>& data) {
+    PopulateTensor(input_, data);
+  }
+
+  std::vector<float> GetOutput() { return ExtractVector<float>(output_); }
+
+ private:
+  int input_;
+  int output_;
+};
+
+TEST(ConstantWeightsLstmOpTest, NoCifg_NoPeephole_NoProjection_NoLayerNorm) {
+  // The weights of LstmOpTest.NoCifg_NoPeephole_NoProjection_NoLayerNorm, with
+  // two copies of each input.
+  ConstantWeightsLSTMOpModel lstm(
+      /*n_batch=*/2, /*n_input=*/2, /*n_cell=*/4, /*n_output=*/4,
+      /*input_to_input_weights=*/
+      {-0.45018822, -0.02338299, -0.0870589, -0.34550029, 0.04266912,
+       -0.15680569, -0.34856534, 0.43890524},
+      /*input_to_forget_weights=*/
+      {0.09701663, 0.20334584, -0.50592935, -0.31343272, -0.40032279,
+       0.44781327, 0.01387155, -0.35593212},
+      /*input_to_cell_weights=*/
+      {-0.50013041, 0.1370284, 0.11810488, 0.2013163, -0.20583314, 0.44344562,
+       0.22077113, -0.29909778},
+      /*input_to_output_weights=*/
+      {-0.25065863, -0.28290087, 0.04613829, 0.40525138, 0.44272184,
+       0.03897077, -0.1556896, 0.19487578},
+      /*recurrent_to_input_weights=*/
+      {-0.0063535, -0.2042388, 0.31454784, -0.35746509, 0.28902304, 0.08183324,
+       -0.16555229, 0.02286911, -0.13566875, 0.03034258, 0.48091322,
+       -0.12528998, 0.24077177, -0.51332325, -0.33502164, 0.10629296},
+      /*recurrent_to_forget_weights=*/
+      {-0.48684245, -0.06655136, 0.42224967, 0.2112639, 0.27654213, 0.20864892,
+       -0.07646349, 0.45877004, 0.00141793, -0.14609534, 0.36447752,
+       0.09196436, 0.28053468, 0.01560611, -0.20127171, -0.01140004},
+      /*recurrent_to_cell_weights=*/
+      {-0.3407414, 0.24443203, -0.2078532, 0.26320225, 0.05695659, -0.00123841,
+       -0.4744786, -0.35869038, -0.06418842, -0.13502428, -0.501764,
+       0.22830659, -0.46367589, 0.26016325, -0.03894562, -0.16368064},
+      /*recurrent_to_output_weights=*/
+      {0.43385774, -0.17194885, 0.2718237, 0.09215671, 0.24107647, -0.39835793,
+       0.18212086, 0.01301402, 0.48572797, -0.50656658, 0.20047462,
+       -0.20607421, -0.51818722, -0.15390486, 0.0468148, 0.39922136},
+      /*input_gate_bias=*/{0., 0., 0., 0.},
+      /*forget_gate_bias=*/{1., 1., 1., 1.},
+      /*cell_gate_bias=*/{0., 0., 0., 0.},
+      /*output_gate_bias=*/{0., 0., 0., 0.});
+
+  const std::vector<std::vector<float>> inputs = {
+      {2., 3., 2., 3.}, {3., 4., 3., 4.}, {1., 1., 1., 1.}};
+  const std::vector<std::vector<float>> golden_outputs = {
+      {-0.02973187, 0.1229473, 0.20885126, -0.15358765},
+      {-0.03716109, 0.12507336, 0.41193449, -0.20860538},
+      {-0.15053082, 0.09120187, 0.24278517, -0.12222792}};
+  for (size_t i = 0; i < inputs.size(); ++i) {
+    lstm.SetInput(inputs[i]);
+    ASSERT_EQ(lstm.Invoke(), kTfLiteOk);
+    std::vector<float> expected = golden_outputs[i];
+    expected.insert(expected.end(), golden_outputs[i].begin(),
+                    golden_outputs[i].end());
+    EXPECT_THAT(lstm.GetOutput(),
+                ElementsAreArray(ArrayFloatNear(expected, 0.00001f)));
+  }
+}
+
 // Test parameter controls asymmetric_quantize_inputs in LSTMOpModel.
 INSTANTIATE_TEST_SUITE_P(
     Parameterized, LstmOpTest,
@@ -366,6 +366,48 @@ TEST(QuantizedMulOpTest, NoActivationInt16Scaled) {
                                       kQuantizedToleranceInt16Scaled)));
 }
 
+TEST(QuantizedMulOpTest, NoActivationInt16LargeTensor) {
+  // Large enough to exercise the vectorized loops as well as the leftovers.
+  const float kMin = -1.f;
+  const float kMax = 32767.f / 32768.f;
+  QuantizedMulOpModel m({TensorType_INT16, {1, 2, 2, 5}, kMin, kMax},
+                        {TensorType_INT16, {1, 2, 2, 5}, kMin, kMax},
+                        {TensorType_INT16, {}, kMin, kMax},
+                        ActivationFunctionType_NONE);
+  m.QuantizeAndPopulate<int16_t>(
+      m.input1(), {-0.8, 0.2, 0.9, 0.7, -0.1, 0.5, -0.95, 0.3, 0.6, -0.4, 0.05,
+                   -0.7, 0.85, -0.25, 0.45, -0.6, 0.15, 0.75, -0.35, 0.95});
+  m.QuantizeAndPopulate<int16_t>(
+      m.input2(), {0.6, 0.4, 0.9, 0.8, -0.5, -0.3, 0.7, 0.2, -0.9, 0.1, 0.65,
+                   -0.45, 0.35, 0.55, -0.75, 0.25, -0.15, 0.5, 0.95, -0.85});
+  ASSERT_EQ(m.Invoke(), kTfLiteOk);
+  EXPECT_THAT(m.GetDequantizedOutputInt16(),
+              ElementsAreArray(ArrayFloatNear(
+                  {-0.48, 0.08, 0.81, 0.56, 0.05, -0.15, -0.665, 0.06, -0.54,
+                   -0.04, 0.0325, 0.315, 0.2975, -0.1375, -0.3375, -0.15,
+                   -0.0225, 0.375, -0.3325, -0.8075},
+                  kQuantizedToleranceInt16)));
+}
+
+TEST(QuantizedMulOpTest, WithBroadcastInt16) {
+  const float kMin = -1.f;
+  const float kMax = 32767.f / 32768.f;
+  QuantizedMulOpModel m({TensorType_INT16, {1, 3, 2, 2}, kMin, kMax},
+                        {TensorType_INT16, {2}, kMin, kMax},
+                        {TensorType_INT16, {}, kMin, kMax},
+                        ActivationFunctionType_NONE);
+  m.QuantizeAndPopulate<int16_t>(
+      m.input1(), {-0.8, 0.2, 0.9, 0.7, -0.1, 0.5, -0.95, 0.3, 0.6, -0.4, 0.05,
+                   -0.7});
+  m.QuantizeAndPopulate<int16_t>(m.input2(), {0.5, -0.25});
+  ASSERT_EQ(m.Invoke(), kTfLiteOk);
+  EXPECT_THAT(m.GetDequantizedOutputInt16(),
+              ElementsAreArray(ArrayFloatNear(
+                  {-0.4, -0.05, 0.45, -0.175, -0.05, -0.125, -0.475, -0.075,
+                   0.3, 0.1, 0.025, 0.175},
+                  kQuantizedToleranceInt16)));
+}
+
 template <TensorType tensor_type, typename integer_dtype>
 void NoActivationInt16With8BitOutput() {
   const float kMinInt16 = -1.f;
@@ -29,6 +29,7 @@ TfLiteRegistration* Register_NUMERIC_VERIFY_REF();
 TfLiteRegistration* Register_AUDIO_SPECTROGRAM();
 TfLiteRegistration* Register_MFCC();
 TfLiteRegistration* Register_DETECTION_POSTPROCESS();
+TfLiteRegistration* Register_SCALED_DOT_PRODUCT_ATTENTION_REF();
 
 }  // namespace custom
 
@@ -511,6 +512,8 @@ BuiltinRefOpResolver::BuiltinRefOpResolver() {
             tflite::ops::custom::Register_AUDIO_SPECTROGRAM());
   AddCustom("TFLite_Detection_PostProcess",
             tflite::ops::custom::Register_DETECTION_POSTPROCESS());
+  AddCustom("ScaledDotProductAttention",
+            tflite::ops::custom::Register_SCALED_DOT_PRODUCT_ATTENTION_REF());
 }
 
 }  // namespace builtin
@@ -0,0 +1,612 @@
+/* Copyright 2022 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+// Fused attention: computes softmax(scale * query * key^T + mask) * value for
+// every batch of the leading dimensions. The scores are computed and consumed
+// one block of query rows at a time, so they never round-trip through the
+// arena as they do with separate BATCH_MATMUL, MUL, ADD and SOFTMAX ops.
+//
+// Inputs:
+//   0: query [..., query_len, depth], float32 or int8.
+//   1: key [..., kv_len, depth], same type as query.
+//   2: value [..., kv_len, value_depth], same type as query.
+//   3: optional additive mask, broadcastable to [..., query_len, kv_len],
+//      float32 or the type of query.
+// Outputs:
+//   0: [..., query_len, value_depth], same type as query.
+// Options (flexbuffer map):
+//   scale: float, the factor of the scores, 1 if not set.
+//
+// The batch dimensions of query, key and value must be equal.
+
+#include <math.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include <algorithm>
+#include <limits>
+#include <vector>
+
+#include "flatbuffers/flexbuffers.h"  // from @flatbuffers
+#include "tensorflow/lite/c/common.h"
+#include "tensorflow/lite/kernels/internal/tensor_ctypes.h"
+#include "tensorflow/lite/kernels/internal/tensor_utils.h"
+#include "tensorflow/lite/kernels/kernel_util.h"
+
+namespace tflite {
+namespace ops {
+namespace custom {
+namespace scaled_dot_product_attention {
+
+enum KernelType {
+  kReference,
+  kGenericOptimized,
+};
+
+constexpr int kQueryTensor = 0;
+constexpr int kKeyTensor = 1;
+constexpr int kValueTensor = 2;
+constexpr int kMaskTensor = 3;
+constexpr int kOutputTensor = 0;
+
+// The number of query rows whose scores are computed at once.
+constexpr int kRowBlockSize = 32;
+// The scale of the int8 probabilities multiplied with an int8 value.
+constexpr float kProbabilityScale = 1.0f / 127.0f;
+
+enum TemporaryTensor {
+  // float [rows, kv_len], the scores and then the probabilities.
+  kScores,
+  // [value_depth, kv_len] of the type of value.
+  kTransposedValue,
+  // int8 [rows, kv_len].
+  kQuantizedProbabilities,
+  // float [rows, value_depth], the int8 output before requantization.
+  kOutputRows,
+  // int32 [kv_len + 2 * rows], the sums of the key, query and probability
+  // rows, which correct the products of int8 values for their zero points.
+  kRowSums,
+  // float [rows].
+  kScalingFactors,
+  // float, the int8 mask dequantized.
+  kDequantizedMask,
+  kNumTemporaries,
+};
+
+struct OpData {
+  float scale = 1.0f;
+  int scratch_tensor_index;
+  // The offset of the mask of each batch, and the strides of the mask over
+  // the query and key rows. Broadcast dimensions have a stride of 0.
+  std::vector<int> mask_batch_offsets;
+  int mask_row_stride = 0;
+  int mask_col_stride = 0;
+};
+
+struct Dims {
+  int num_batches;
+  int query_len;
+  int kv_len;
+  int depth;
+  int value_depth;
+};
+
+Dims GetDims(const TfLiteTensor* query, const TfLiteTensor* value) {
+  const int rank = NumDimensions(query);
+  Dims dims;
+  dims.num_batches = 1;
+  for (int i = 0; i < rank - 2; ++i) {
+    dims.num_batches *= SizeOfDimension(query, i);
+  }
+  dims.query_len = SizeOfDimension(query, rank - 2);
+  dims.depth = SizeOfDimension(query, rank - 1);
+  dims.kv_len = SizeOfDimension(value, rank - 2);
+  dims.value_depth = SizeOfDimension(value, rank - 1);
+  return dims;
+}
+
+void* Init(TfLiteContext* context, const char* buffer, size_t length) {
+  auto* op_data = new OpData();
+  if (buffer != nullptr && length > 0) {
+    const uint8_t* buffer_t = reinterpret_cast<const uint8_t*>(buffer);
+    const flexbuffers::Map& m = flexbuffers::GetRoot(buffer_t, length).AsMap();
+    const flexbuffers::Reference scale = m["scale"];
+    if (!scale.IsNull()) op_data->scale = scale.AsFloat();
+  }
+  context->AddTensors(context, kNumTemporaries, &op_data->scratch_tensor_index);
+  return op_data;
+}
+
+void Free(TfLiteContext* context, void* buffer) {
+  delete reinterpret_cast<OpData*>(buffer);
+}
+
+TfLiteStatus ResizeTemporary(TfLiteContext* context, TfLiteNode* node,
+                             int index, TfLiteType type,
+                             std::initializer_list<int> shape) {
+  TfLiteTensor* temporary;
+  TF_LITE_ENSURE_OK(context,
+                    GetTemporarySafe(context, node, index, &temporary));
+  temporary->type = type;
+  temporary->allocation_type = kTfLiteArenaRw;
+  TfLiteIntArray* size = TfLiteIntArrayCreate(shape.size());
+  std::copy(shape.begin(), shape.end(), size->data);
+  return context->ResizeTensor(context, temporary, size);
+}
+
+// Computes the offsets and strides of the mask, which is broadcast to the
+// shape of the scores.
+TfLiteStatus PrepareMask(TfLiteContext* context, const TfLiteTensor* query,
+                         const TfLiteTensor* mask, const Dims& dims,
+                         OpData* op_data) {
+  const int rank = NumDimensions(query);
+  const int mask_rank = NumDimensions(mask);
+  TF_LITE_ENSURE(context, mask_rank <= rank);
+  std::vector<int> scores_shape(query->dims->data,
+                                query->dims->data + rank);
+  scores_shape[rank - 1] = dims.kv_len;
+  // The strides of the mask over the dimensions of the scores.
+  std::vector<int> strides(rank, 0);
+  int stride = 1;
+  for (int i = rank - 1; i >= rank - mask_rank; --i) {
+    const int mask_dim = SizeOfDimension(mask, i - (rank - mask_rank));
+    TF_LITE_ENSURE(context, mask_dim == 1 || mask_dim == scores_shape[i]);
+    if (mask_dim != 1) strides[i] = stride;
+    stride *= mask_dim;
+  }
+  op_data->mask_row_stride = strides[rank - 2];
+  op_data->mask_col_stride = strides[rank - 1];
+  op_data->mask_batch_offsets.assign(dims.num_batches, 0);
+  for (int b = 0; b < dims.num_batches; ++b) {
+    int remaining = b;
+    int offset = 0;
+    for (int i = rank - 3; i >= 0; --i) {
+      offset += (remaining % scores_shape[i]) * strides[i];
+      remaining /= scores_shape[i];
+    }
+    op_data->mask_batch_offsets[b] = offset;
+  }
+  return kTfLiteOk;
+}
+
+TfLiteStatus Prepare(TfLiteContext* context, TfLiteNode* node) {
+  TF_LITE_ENSURE(context, NumInputs(node) == 3 || NumInputs(node) == 4);
+  TF_LITE_ENSURE_EQ(context, NumOutputs(node), 1);
+  OpData* op_data = reinterpret_cast<OpData*>(node->user_data);
+
+  const TfLiteTensor* query;
+  TF_LITE_ENSURE_OK(context, GetInputSafe(context, node, kQueryTensor, &query));
+  const TfLiteTensor* key;
+  TF_LITE_ENSURE_OK(context, GetInputSafe(context, node, kKeyTensor, &key));
+  const TfLiteTensor* value;
+  TF_LITE_ENSURE_OK(context, GetInputSafe(context, node, kValueTensor, &value));
+  const TfLiteTensor* mask = GetOptionalInputTensor(context, node, kMaskTensor);
+  TfLiteTensor* output;
+  TF_LITE_ENSURE_OK(context,
+                    GetOutputSafe(context, node, kOutputTensor, &output));
+
+  TF_LITE_ENSURE(context,
+                 query->type == kTfLiteFloat32 || query->type == kTfLiteInt8);
+  TF_LITE_ENSURE_TYPES_EQ(context, key->type, query->type);
+  TF_LITE_ENSURE_TYPES_EQ(context, value->type, query->type);
+  TF_LITE_ENSURE_TYPES_EQ(context, output->type, query->type);
+
+  const int rank = NumDimensions(query);
+  TF_LITE_ENSURE(context, rank >= 2);
+  TF_LITE_ENSURE_EQ(context, NumDimensions(key), rank);
+  TF_LITE_ENSURE_EQ(context, NumDimensions(value), rank);
+  for (int i = 0; i < rank - 2; ++i) {
+    TF_LITE_ENSURE_EQ(context, SizeOfDimension(key, i),
+                      SizeOfDimension(query, i));
+    TF_LITE_ENSURE_EQ(context, SizeOfDimension(value, i),
+                      SizeOfDimension(query, i));
+  }
+  TF_LITE_ENSURE_EQ(context, SizeOfDimension(key, rank - 1),
+                    SizeOfDimension(query, rank - 1));
+  TF_LITE_ENSURE_EQ(context, SizeOfDimension(key, rank - 2),
+                    SizeOfDimension(value, rank - 2));
+  const Dims dims = GetDims(query, value);
+  TF_LITE_ENSURE(context, dims.kv_len > 0);
+
+  if (mask != nullptr) {
+    TF_LITE_ENSURE(context,
+                   mask->type == kTfLiteFloat32 || mask->type == query->type);
+    TF_LITE_ENSURE_OK(context,
+                      PrepareMask(context, query, mask, dims, op_data));
+  }
+
+  const bool is_int8 = query->type == kTfLiteInt8;
+  const int rows = std::min(dims.query_len, kRowBlockSize);
+  TfLiteIntArrayFree(node->temporaries);
+  node->temporaries = TfLiteIntArrayCreate(kNumTemporaries);
+  for (int i = 0; i < kNumTemporaries; ++i) {
+    node->temporaries->data[i] = op_data->scratch_tensor_index + i;
+  }
+  TF_LITE_ENSURE_OK(context, ResizeTemporary(context, node, kScores,
+                                             kTfLiteFloat32,
+                                             {rows, dims.kv_len}));
+  TF_LITE_ENSURE_OK(context, ResizeTemporary(context, node, kTransposedValue,
+                                             value->type,
+                                             {dims.value_depth, dims.kv_len}));
+  TF_LITE_ENSURE_OK(
+      context, ResizeTemporary(context, node, kQuantizedProbabilities,
+                               kTfLiteInt8, {is_int8 ? rows : 0, dims.kv_len}));
+  TF_LITE_ENSURE_OK(context,
+                    ResizeTemporary(context, node, kOutputRows, kTfLiteFloat32,
+                                    {is_int8 ? rows : 0, dims.value_depth}));
+  TF_LITE_ENSURE_OK(context,
+                    ResizeTemporary(context, node, kRowSums, kTfLiteInt32,
+                                    {is_int8 ? dims.kv_len + 2 * rows : 0}));
+  TF_LITE_ENSURE_OK(context,
+                    ResizeTemporary(context, node, kScalingFactors,
+                                    kTfLiteFloat32, {is_int8 ? rows : 0}));
+  const int dequantized_mask_size =
+      mask != nullptr && mask->type == kTfLiteInt8 ? NumElements(mask) : 0;
+  TF_LITE_ENSURE_OK(context,
+                    ResizeTemporary(context, node, kDequantizedMask,
+                                    kTfLiteFloat32, {dequantized_mask_size}));
+
+  TfLiteIntArray* output_size = TfLiteIntArrayCopy(query->dims);
+  output_size->data[rank - 1] = dims.value_depth;
+  return context->ResizeTensor(context, output, output_size);
+}
+
+// The mask of the rows of one batch.
+struct Mask {
+  const float* data = nullptr;
+  int row_stride = 0;
+  int col_stride = 0;
+};
+
+// Replaces the `rows` rows of scores, starting at row `first_row`, with
+// softmax(scale * scores + mask).
+void ScaledMaskedSoftmax(float scale, const Mask& mask, int first_row,
+                         int rows, int kv_len, float* scores) {
+  for (int i = 0; i < rows; ++i) {
+    float* row = scores + i * kv_len;
+    float max = -std::numeric_limits<float>::infinity();
+    if (mask.data != nullptr) {
+      const float* mask_row = mask.data + (first_row + i) * mask.row_stride;
+      for (int j = 0; j < kv_len; ++j) {
+        row[j] = row[j] * scale + mask_row[j * mask.col_stride];
+        max = std::max(max, row[j]);
+      }
+    } else {
+      for (int j = 0; j < kv_len; ++j) {
+        row[j] *= scale;
+        max = std::max(max, row[j]);
+      }
+    }
+    float sum = 0;
+    for (int j = 0; j < kv_len; ++j) {
+      row[j] = expf(row[j] - max);
+      sum += row[j];
+    }
+    const float inverse_sum = 1.0f / sum;
+    for (int j = 0; j < kv_len; ++j) row[j] *= inverse_sum;
+  }
+}
+
+template <typename T>
+void Transpose(const T* matrix, int rows, int cols, T* transposed) {
+  for (int i = 0; i < rows; ++i) {
+    for (int j = 0; j < cols; ++j) {
+      transposed[j * rows + i] = matrix[i * cols + j];
+    }
+  }
+}
+
+template <KernelType kernel_type>
+void EvalFloat(const OpData& op_data, const Dims& dims, const float* query,
+               const float* key, const float* value, const float* mask_data,
+               float* scores, float* transposed_value, float* output) {
+  for (int b = 0; b < dims.num_batches; ++b) {
+    const float* q = query + b * dims.query_len * dims.depth;
+    const float* k = key + b * dims.kv_len * dims.depth;
+    const float* v = value + b * dims.kv_len * dims.value_depth;
+    float* out = output + b * dims.query_len * dims.value_depth;
+    Mask mask;
+    if (mask_data != nullptr) {
+      mask.data = mask_data + op_data.mask_batch_offsets[b];
+      mask.row_stride = op_data.mask_row_stride;
+      mask.col_stride = op_data.mask_col_stride;
+    }
+    if (kernel_type == kGenericOptimized) {
+      // The rows of the transposed value are contiguous for the product with
+      // the probabilities.
+      Transpose(v, dims.kv_len, dims.value_depth, transposed_value);
+    }
+    for (int r = 0; r < dims.query_len; r += kRowBlockSize) {
+      const int rows = std::min(kRowBlockSize, dims.query_len - r);
+      const float* q_rows = q + r * dims.depth;
+      float* out_rows = out + r * dims.value_depth;
+      if (kernel_type == kGenericOptimized) {
+        std::fill_n(scores, rows * dims.kv_len, 0.0f);
+        tensor_utils::MatrixBatchVectorMultiplyAccumulate(
+            k, dims.kv_len, dims.depth, q_rows, rows, scores);
+      } else {
+        for (int i = 0; i < rows; ++i) {
+          for (int j = 0; j < dims.kv_len; ++j) {
+            float dot = 0;
+            for (int d = 0; d < dims.depth; ++d) {
+              dot += q_rows[i * dims.depth + d] * k[j * dims.depth + d];
+            }
+            scores[i * dims.kv_len + j] = dot;
+          }
+        }
+      }
+      ScaledMaskedSoftmax(op_data.scale, mask, r, rows, dims.kv_len, scores);
+      std::fill_n(out_rows, rows * dims.value_depth, 0.0f);
+      if (kernel_type == kGenericOptimized) {
+        tensor_utils::MatrixBatchVectorMultiplyAccumulate(
+            transposed_value, dims.value_depth, dims.kv_len, scores, rows,
+            out_rows);
+      } else {
+        for (int i = 0; i < rows; ++i) {
+          for (int j = 0; j < dims.kv_len; ++j) {
+            const float p = scores[i * dims.kv_len + j];
+            for (int d = 0; d < dims.value_depth; ++d) {
+              out_rows[i * dims.value_depth + d] +=
+                  p * v[j * dims.value_depth + d];
+            }
+          }
+        }
+      }
+    }
+  }
+}
+
+struct QuantizedInputs {
+  const int8_t* data;
+  float scale;
+  int32_t zero_point;
+};
+
+QuantizedInputs GetQuantizedInputs(const TfLiteTensor* tensor) {
+  return {GetTensorData<int8_t>(tensor), tensor->params.scale,
+          tensor->params.zero_point};
+}
+
+int8_t Quantize(float value, float inverse_scale, int32_t zero_point) {
+  const int32_t quantized =
+      static_cast<int32_t>(roundf(value * inverse_scale)) + zero_point;
+  return static_cast<int8_t>(std::min<int32_t>(
+      std::max<int32_t>(quantized, std::numeric_limits<int8_t>::min()),
+      std::numeric_limits<int8_t>::max()));
+}
+
+// The reference computes in float from the dequantized inputs.
+void EvalInt8Reference(const OpData& op_data, const Dims& dims,
+                       const QuantizedInputs& query,
+                       const QuantizedInputs& key,
+                       const QuantizedInputs& value, const float* mask_data,
+                       float* scores, TfLiteTensor* output) {
+  int8_t* output_data = GetTensorData<int8_t>(output);
+  const float inverse_output_scale = 1.0f / output->params.scale;
+  std::vector<float> out_row(dims.value_depth);
+  for (int b = 0; b < dims.num_batches; ++b) {
+    const int8_t* q = query.data + b * dims.query_len * dims.depth;
+    const int8_t* k = key.data + b * dims.kv_len * dims.depth;
+    const int8_t* v = value.data + b * dims.kv_len * dims.value_depth;
+    int8_t* out = output_data + b * dims.query_len * dims.value_depth;
+    Mask mask;
+    if (mask_data != nullptr) {
+      mask.data = mask_data + op_data.mask_batch_offsets[b];
+      mask.row_stride = op_data.mask_row_stride;
+      mask.col_stride = op_data.mask_col_stride;
+    }
+    for (int i = 0; i < dims.query_len; ++i) {
+      for (int j = 0; j < dims.kv_len; ++j) {
+        float dot = 0;
+        for (int d = 0; d < dims.depth; ++d) {
+          dot += (query.scale * (q[i * dims.depth + d] - query.zero_point)) *
+                 (key.scale * (k[j * dims.depth + d] - key.zero_point));
+        }
+        scores[j] = dot;
+      }
+      ScaledMaskedSoftmax(op_data.scale, mask, i, 1, dims.kv_len, scores);
+      std::fill(out_row.begin(), out_row.end(), 0.0f);
+      for (int j = 0; j < dims.kv_len; ++j) {
+        for (int d = 0; d < dims.value_depth; ++d) {
+          out_row[d] += scores[j] * value.scale *
+                        (v[j * dims.value_depth + d] - value.zero_point);
+        }
+      }
+      for (int d = 0; d < dims.value_depth; ++d) {
+        out[i * dims.value_depth + d] = Quantize(
+            out_row[d], inverse_output_scale, output->params.zero_point);
+      }
+    }
+  }
+}
+
+// Multiplies the int8 values with the hybrid kernels of tensor_utils, which
+// assume symmetric quantization, and corrects the products for the zero
+// points with the sums of the rows. The probabilities are quantized to int8
+// with a fixed scale for their product with the value.
+void EvalInt8Optimized(TfLiteContext* context, TfLiteNode* node,
+                       const OpData& op_data, const Dims& dims,
+                       const QuantizedInputs& query,
+                       const QuantizedInputs& key,
+                       const QuantizedInputs& value, const float* mask_data,
+                       TfLiteTensor* output) {
+  float* scores = GetTensorData<float>(GetTemporary(context, node, kScores));
+  int8_t* transposed_value =
+      GetTensorData<int8_t>(GetTemporary(context, node, kTransposedValue));
+  int8_t* probabilities = GetTensorData<int8_t>(
+      GetTemporary(context, node, kQuantizedProbabilities));
+  float* out_rows =
+      GetTensorData<float>(GetTemporary(context, node, kOutputRows));
+  int32_t* key_sums =
+      GetTensorData<int32_t>(GetTemporary(context, node, kRowSums));
+  int32_t* query_sums = key_sums + dims.kv_len;
+  int32_t* probability_sums = query_sums + kRowBlockSize;
+  float* scaling_factors =
+      GetTensorData<float>(GetTemporary(context, node, kScalingFactors));
+  int8_t* output_data = GetTensorData<int8_t>(output);
+  const float inverse_output_scale = 1.0f / output->params.scale;
+  const float qk_scale = query.scale * key.scale;
+  const float pv_scale = kProbabilityScale * value.scale;
+
+  for (int b = 0; b < dims.num_batches; ++b) {
+    const int8_t* q = query.data + b * dims.query_len * dims.depth;
+    const int8_t* k = key.data + b * dims.kv_len * dims.depth;
+    const int8_t* v = value.data + b * dims.kv_len * dims.value_depth;
+    int8_t* out = output_data + b * dims.query_len * dims.value_depth;
+    Mask mask;
+    if (mask_data != nullptr) {
+      mask.data = mask_data + op_data.mask_batch_offsets[b];
+      mask.row_stride = op_data.mask_row_stride;
+      mask.col_stride = op_data.mask_col_stride;
+    }
+    tensor_utils::ReductionSumVector(k, key_sums, dims.kv_len, dims.depth);
+    Transpose(v, dims.kv_len, dims.value_depth, transposed_value);
+    for (int r = 0; r < dims.query_len; r += kRowBlockSize) {
+      const int rows = std::min(kRowBlockSize, dims.query_len - r);
+      const int8_t* q_rows = q + r * dims.depth;
+
+      // (q - zq) * (k - zk) = q * k - zk * sum(q) - zq * sum(k) + depth * zq *
+      // zk.
+      std::fill_n(scores, rows * dims.kv_len, 0.0f);
+      std::fill_n(scaling_factors, rows, qk_scale);
+      tensor_utils::MatrixBatchVectorMultiplyAccumulate(
+          k, dims.kv_len, dims.depth, q_rows, scaling_factors, rows, scores);
+      tensor_utils::ReductionSumVector(q_rows, query_sums, rows, dims.depth);
+      const int32_t zero_points_product =
+          dims.depth * query.zero_point * key.zero_point;
+      for (int i = 0; i < rows; ++i) {
+        const int32_t query_correction = key.zero_point * query_sums[i];
+        for (int j = 0; j < dims.kv_len; ++j) {
+          scores[i * dims.kv_len + j] -=
+              qk_scale * (query_correction + query.zero_point * key_sums[j] -
+                          zero_points_product);
+        }
+      }
+      ScaledMaskedSoftmax(op_data.scale, mask, r, rows, dims.kv_len, scores);
+
+      for (int i = 0; i < rows * dims.kv_len; ++i) {
+        probabilities[i] =
+            static_cast<int8_t>(roundf(scores[i] / kProbabilityScale));
+      }
+      tensor_utils::ReductionSumVector(probabilities, probability_sums, rows,
+                                       dims.kv_len);
+      std::fill_n(out_rows, rows * dims.value_depth, 0.0f);
+      std::fill_n(scaling_factors, rows, pv_scale);
+      tensor_utils::MatrixBatchVectorMultiplyAccumulate(
+          transposed_value, dims.value_depth, dims.kv_len, probabilities,
+          scaling_factors, rows, out_rows);
+      for (int i = 0; i < rows; ++i) {
+        const float correction =
+            pv_scale * value.zero_point * probability_sums[i];
+        for (int d = 0; d < dims.value_depth; ++d) {
+          out[(r + i) * dims.value_depth + d] =
+              Quantize(out_rows[i * dims.value_depth + d] - correction,
+                       inverse_output_scale, output->params.zero_point);
+        }
+      }
+    }
+  }
+}
+
+template <KernelType kernel_type>
+TfLiteStatus Eval(TfLiteContext* context, TfLiteNode* node) {
+  const OpData& op_data = *reinterpret_cast<OpData*>(node->user_data);
+  const TfLiteTensor* query;
+  TF_LITE_ENSURE_OK(context, GetInputSafe(context, node, kQueryTensor, &query));
+  const TfLiteTensor* key;
+  TF_LITE_ENSURE_OK(context, GetInputSafe(context, node, kKeyTensor, &key));
+  const TfLiteTensor* value;
+  TF_LITE_ENSURE_OK(context, GetInputSafe(context, node, kValueTensor, &value));
+  const TfLiteTensor* mask = GetOptionalInputTensor(context, node, kMaskTensor);
+  TfLiteTensor* output;
+  TF_LITE_ENSURE_OK(context,
+                    GetOutputSafe(context, node, kOutputTensor, &output));
+  const Dims dims = GetDims(query, value);
+
+  TfLiteTensor* scores;
+  TF_LITE_ENSURE_OK(context, GetTemporarySafe(context, node, kScores, &scores));
+  const float* mask_data = nullptr;
+  if (mask != nullptr && mask->type == kTfLiteInt8) {
+    TfLiteTensor* dequantized_mask;
+    TF_LITE_ENSURE_OK(context, GetTemporarySafe(context, node, kDequantizedMask,
+                                                &dequantized_mask));
+    const int8_t* quantized = GetTensorData<int8_t>(mask);
+    float* dequantized = GetTensorData<float>(dequantized_mask);
+    for (int i = 0; i < NumElements(mask); ++i) {
+      dequantized[i] =
+          mask->params.scale * (quantized[i] - mask->params.zero_point);
+    }
+    mask_data = dequantized;
+  } else if (mask != nullptr) {
+    mask_data = GetTensorData<float>(mask);
+  }
+
+  switch (query->type) {
+    case kTfLiteFloat32: {
+      TfLiteTensor* transposed_value;
+      TF_LITE_ENSURE_OK(context, GetTemporarySafe(context, node,
+                                                  kTransposedValue,
+                                                  &transposed_value));
+      EvalFloat<kernel_type>(
+          op_data, dims, GetTensorData<float>(query),
+          GetTensorData<float>(key), GetTensorData<float>(value), mask_data,
+          GetTensorData<float>(scores), GetTensorData<float>(transposed_value),
+          GetTensorData<float>(output));
+      return kTfLiteOk;
+    }
+    case kTfLiteInt8:
+      if (kernel_type == kGenericOptimized) {
+        EvalInt8Optimized(context, node, op_data, dims,
+                          GetQuantizedInputs(query), GetQuantizedInputs(key),
+                          GetQuantizedInputs(value), mask_data, output);
+      } else {
+        EvalInt8Reference(op_data, dims, GetQuantizedInputs(query),
+                          GetQuantizedInputs(key), GetQuantizedInputs(value),
+                          mask_data, GetTensorData<float>(scores), output);
+      }
+      return kTfLiteOk;
+    default:
+      TF_LITE_KERNEL_LOG(context, "Type %s is not supported.",
+                         TfLiteTypeGetName(query->type));
+      return kTfLiteError;
+  }
+}
+
+}  // namespace scaled_dot_product_attention
+
+TfLiteRegistration* Register_SCALED_DOT_PRODUCT_ATTENTION_REF() {
+  static TfLiteRegistration r = {
+      scaled_dot_product_attention::Init, scaled_dot_product_attention::Free,
+      scaled_dot_product_attention::Prepare,
+      scaled_dot_product_attention::Eval<
+          scaled_dot_product_attention::kReference>};
+  return &r;
+}
+
+TfLiteRegistration* Register_SCALED_DOT_PRODUCT_ATTENTION_GENERIC_OPT() {
+  static TfLiteRegistration r = {
+      scaled_dot_product_attention::Init, scaled_dot_product_attention::Free,
+      scaled_dot_product_attention::Prepare,
+      scaled_dot_product_attention::Eval<
+          scaled_dot_product_attention::kGenericOptimized>};
+  return &r;
+}
+
+TfLiteRegistration* Register_SCALED_DOT_PRODUCT_ATTENTION() {
+  return Register_SCALED_DOT_PRODUCT_ATTENTION_GENERIC_OPT();
+}
+
+}  // namespace custom
+}  // namespace ops
+}  // namespace tflite
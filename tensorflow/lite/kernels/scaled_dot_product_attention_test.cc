@@ -0,0 +1,235 @@
+/* Copyright 2022 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include <math.h>
+#include <stdint.h>
+
+#include <algorithm>
+#include <map>
+#include <vector>
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+#include "flatbuffers/flexbuffers.h"  // from @flatbuffers
+#include "tensorflow/lite/kernels/test_util.h"
+#include "tensorflow/lite/schema/schema_generated.h"
+
+namespace tflite {
+namespace ops {
+namespace custom {
+
+TfLiteRegistration* Register_SCALED_DOT_PRODUCT_ATTENTION_REF();
+TfLiteRegistration* Register_SCALED_DOT_PRODUCT_ATTENTION_GENERIC_OPT();
+
+namespace {
+
+using ::testing::ElementsAreArray;
+
+class ScaledDotProductAttentionOpModel : public SingleOpModel {
+ public:
+  ScaledDotProductAttentionOpModel(TfLiteRegistration* registration,
+                                   const TensorData& query,
+                                   const TensorData& key,
+                                   const TensorData& value,
+                                   const TensorData& output, float scale,
+                                   const TensorData* mask = nullptr) {
+    query_ = AddInput(query);
+    key_ = AddInput(key);
+    value_ = AddInput(value);
+    std::vector<std::vector<int>> input_shapes = {
+        GetShape(query_), GetShape(key_), GetShape(value_)};
+    if (mask != nullptr) {
+      mask_ = AddInput(*mask);
+      input_shapes.push_back(GetShape(mask_));
+    }
+    output_ = AddOutput(output);
+
+    flexbuffers::Builder fbb;
+    fbb.Map([&]() { fbb.Float("scale", scale); });
+    fbb.Finish();
+    SetCustomOp("ScaledDotProductAttention", fbb.GetBuffer(),
+                [registration]() { return registration; });
+    BuildInterpreter(input_shapes);
+  }
+
+  int query() const { return query_; }
+  int key() const { return key_; }
+  int value() const { return value_; }
+  int mask() const { return mask_; }
+  int output() const { return output_; }
+
+  std::vector<int> GetOutputShape() { return GetTensorShape(output_); }
+  std::vector<float> GetDequantizedOutput() {
+    return Dequantize<int8_t>(ExtractVector<int8_t>(output_),
+                              GetScale(output_), GetZeroPoint(output_));
+  }
+
+ private:
+  int query_;
+  int key_;
+  int value_;
+  int mask_ = -1;
+  int output_;
+};
+
+// Deterministic inputs in [-1, 1].
+std::vector<float> MakeData(int size, int seed) {
+  std::vector<float> data(size);
+  for (int i = 0; i < size; ++i) data[i] = sinf(0.37f * i + seed);
+  return data;
+}
+
+// softmax(scale * q * k^T + mask) * v for `num_batches` batches, with a mask
+// of [num_batches, query_len, kv_len] or none.
+std::vector<float> ReferenceAttention(const std::vector<float>& query,
+                                      const std::vector<float>& key,
+                                      const std::vector<float>& value,
+                                      const std::vector<float>& mask,
+                                      int num_batches, int query_len,
+                                      int kv_len, int depth, int value_depth,
+                                      float scale) {
+  std::vector<float> output(num_batches * query_len * value_depth, 0.0f);
+  std::vector<float> scores(kv_len);
+  for (int b = 0; b < num_batches; ++b) {
+    for (int i = 0; i < query_len; ++i) {
+      float max = -INFINITY;
+      for (int j = 0; j < kv_len; ++j) {
+        float dot = 0;
+        for (int d = 0; d < depth; ++d) {
+          dot += query[(b * query_len + i) * depth + d] *
+                 key[(b * kv_len + j) * depth + d];
+        }
+        scores[j] = scale * dot;
+        if (!mask.empty()) scores[j] += mask[(b * query_len + i) * kv_len + j];
+        max = std::max(max, scores[j]);
+      }
+      float sum = 0;
+      for (float& score : scores) {
+        score = expf(score - max);
+        sum += score;
+      }
+      for (int j = 0; j < kv_len; ++j) {
+        for (int d = 0; d < value_depth; ++d) {
+          output[(b * query_len + i) * value_depth + d] +=
+              scores[j] / sum * value[(b * kv_len + j) * value_depth + d];
+        }
+      }
+    }
+  }
+  return output;
+}
+
+const auto kKernelMap = new std::map<string, TfLiteRegistration*>({
+    {"Reference", Register_SCALED_DOT_PRODUCT_ATTENTION_REF()},
+    {"GenericOptimized", Register_SCALED_DOT_PRODUCT_ATTENTION_GENERIC_OPT()},
+});
+
+class ScaledDotProductAttentionOpTest : public SingleOpTest {
+ protected:
+  const std::map<string, TfLiteRegistration*>& GetKernelMap() override {
+    return *kKernelMap;
+  }
+};
+
+TEST_P(ScaledDotProductAttentionOpTest, Float) {
+  ScaledDotProductAttentionOpModel model(
+      GetRegistration(), {TensorType_FLOAT32, {2, 3, 4}},
+      {TensorType_FLOAT32, {2, 5, 4}}, {TensorType_FLOAT32, {2, 5, 2}},
+      {TensorType_FLOAT32, {}}, 0.5f);
+  const std::vector<float> query = MakeData(24, 0);
+  const std::vector<float> key = MakeData(40, 1);
+  const std::vector<float> value = MakeData(20, 2);
+  model.PopulateTensor<float>(model.query(), query);
+  model.PopulateTensor<float>(model.key(), key);
+  model.PopulateTensor<float>(model.value(), value);
+  ASSERT_EQ(model.Invoke(), kTfLiteOk);
+  EXPECT_THAT(model.GetOutputShape(), ElementsAreArray({2, 3, 2}));
+  EXPECT_THAT(model.ExtractVector<float>(model.output()),
+              ElementsAreArray(ArrayFloatNear(ReferenceAttention(
+                  query, key, value, {}, 2, 3, 5, 4, 2, 0.5f))));
+}
+
+TEST_P(ScaledDotProductAttentionOpTest, FloatMoreRowsThanBlock) {
+  ScaledDotProductAttentionOpModel model(
+      GetRegistration(), {TensorType_FLOAT32, {1, 70, 8}},
+      {TensorType_FLOAT32, {1, 9, 8}}, {TensorType_FLOAT32, {1, 9, 3}},
+      {TensorType_FLOAT32, {}}, 0.25f);
+  const std::vector<float> query = MakeData(560, 3);
+  const std::vector<float> key = MakeData(72, 4);
+  const std::vector<float> value = MakeData(27, 5);
+  model.PopulateTensor<float>(model.query(), query);
+  model.PopulateTensor<float>(model.key(), key);
+  model.PopulateTensor<float>(model.value(), value);
+  ASSERT_EQ(model.Invoke(), kTfLiteOk);
+  EXPECT_THAT(model.ExtractVector<float>(model.output()),
+              ElementsAreArray(ArrayFloatNear(ReferenceAttention(
+                  query, key, value, {}, 1, 70, 9, 8, 3, 0.25f))));
+}
+
+TEST_P(ScaledDotProductAttentionOpTest, FloatBroadcastMask) {
+  // A causal mask of [query_len, kv_len] shared by both batches.
+  const TensorData mask_data = {TensorType_FLOAT32, {3, 3}};
+  ScaledDotProductAttentionOpModel model(
+      GetRegistration(), {TensorType_FLOAT32, {2, 3, 4}},
+      {TensorType_FLOAT32, {2, 3, 4}}, {TensorType_FLOAT32, {2, 3, 2}},
+      {TensorType_FLOAT32, {}}, 1.0f, &mask_data);
+  const std::vector<float> query = MakeData(24, 6);
+  const std::vector<float> key = MakeData(24, 7);
+  const std::vector<float> value = MakeData(12, 8);
+  const std::vector<float> mask = {0, -1e9, -1e9, 0, 0, -1e9, 0, 0, 0};
+  model.PopulateTensor<float>(model.query(), query);
+  model.PopulateTensor<float>(model.key(), key);
+  model.PopulateTensor<float>(model.value(), value);
+  model.PopulateTensor<float>(model.mask(), mask);
+  ASSERT_EQ(model.Invoke(), kTfLiteOk);
+  std::vector<float> batch_mask = mask;
+  batch_mask.insert(batch_mask.end(), mask.begin(), mask.end());
+  const std::vector<float> expected =
+      ReferenceAttention(query, key, value, batch_mask, 2, 3, 3, 4, 2, 1.0f);
+  const std::vector<float> output = model.ExtractVector<float>(model.output());
+  EXPECT_THAT(output, ElementsAreArray(ArrayFloatNear(expected)));
+  // The first query of each batch only attends to the first key.
+  EXPECT_NEAR(output[0], value[0], 1e-5);
+  EXPECT_NEAR(output[6], value[6], 1e-5);
+}
+
+TEST_P(ScaledDotProductAttentionOpTest, Int8) {
+  ScaledDotProductAttentionOpModel model(
+      GetRegistration(), {TensorType_INT8, {2, 40, 8}, -1.0f, 1.0f},
+      {TensorType_INT8, {2, 17, 8}, -1.5f, 0.8f},
+      {TensorType_INT8, {2, 17, 5}, -1.0f, 1.2f},
+      {TensorType_INT8, {}, -1.0f, 1.0f}, 0.7f);
+  const std::vector<float> query = MakeData(640, 9);
+  const std::vector<float> key = MakeData(272, 10);
+  const std::vector<float> value = MakeData(170, 11);
+  model.QuantizeAndPopulate<int8_t>(model.query(), query);
+  model.QuantizeAndPopulate<int8_t>(model.key(), key);
+  model.QuantizeAndPopulate<int8_t>(model.value(), value);
+  ASSERT_EQ(model.Invoke(), kTfLiteOk);
+  EXPECT_THAT(model.GetOutputShape(), ElementsAreArray({2, 40, 5}));
+  EXPECT_THAT(model.GetDequantizedOutput(),
+              ElementsAreArray(ArrayFloatNear(
+                  ReferenceAttention(query, key, value, {}, 2, 40, 17, 8, 5,
+                                     0.7f),
+                  0.04f)));
+}
+
+INSTANTIATE_TEST_SUITE_P(
+    ScaledDotProductAttentionOpTest, ScaledDotProductAttentionOpTest,
+    ::testing::ValuesIn(SingleOpTest::GetKernelTags(*kKernelMap)));
+
+}  // namespace
+}  // namespace custom
+}  // namespace ops
+}  // namespace tflite
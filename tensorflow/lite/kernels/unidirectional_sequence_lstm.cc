@@ -44,6 +44,9 @@ struct OpData {
   bool compute_row_sums = false;
 
   lstm_eval::IntegerLstmParameter integer_lstm_param;
+  // The concatenated gate weights of a float LSTM with constant weights. Empty
+  // (n_gates == 0) otherwise.
+  lstm_eval::FusedLstmWeightsFloat fused_weights;
 };
 
 TfLiteStatus PopulateQuantizedLstmParams8x8_16(
@@ -383,6 +386,84 @@ TfLiteStatus PopulateQuantizedLstmParams8x8_16(
   return kTfLiteOk;
 }
 
+// Concatenates the gate weights and biases of a float LSTM, if they are all
+// constant, so that each step computes all gates with one matrix
+// multiplication per input.
+TfLiteStatus PrepareFusedWeightsFloat(TfLiteContext* context,
+                                      TfLiteNode* node, OpData* op_data) {
+  if (op_data->fused_weights.n_gates > 0) {
+    return kTfLiteOk;
+  }
+  const TfLiteTensor* input_to_input_weights = GetOptionalInputTensor(
+      context, node, lstm::full::kInputToInputWeightsTensor);
+  const TfLiteTensor* input_to_forget_weights;
+  TF_LITE_ENSURE_OK(
+      context,
+      GetInputSafe(context, node, lstm::full::kInputToForgetWeightsTensor,
+                   &input_to_forget_weights));
+  const TfLiteTensor* input_to_cell_weights;
+  TF_LITE_ENSURE_OK(context, GetInputSafe(context, node,
+                                          lstm::full::kInputToCellWeightsTensor,
+                                          &input_to_cell_weights));
+  const TfLiteTensor* input_to_output_weights;
+  TF_LITE_ENSURE_OK(
+      context,
+      GetInputSafe(context, node, lstm::full::kInputToOutputWeightsTensor,
+                   &input_to_output_weights));
+  const TfLiteTensor* recurrent_to_input_weights = GetOptionalInputTensor(
+      context, node, lstm::full::kRecurrentToInputWeightsTensor);
+  const TfLiteTensor* recurrent_to_forget_weights;
+  TF_LITE_ENSURE_OK(
+      context,
+      GetInputSafe(context, node, lstm::full::kRecurrentToForgetWeightsTensor,
+                   &recurrent_to_forget_weights));
+  const TfLiteTensor* recurrent_to_cell_weights;
+  TF_LITE_ENSURE_OK(
+      context,
+      GetInputSafe(context, node, lstm::full::kRecurrentToCellWeightsTensor,
+                   &recurrent_to_cell_weights));
+  const TfLiteTensor* recurrent_to_output_weights;
+  TF_LITE_ENSURE_OK(
+      context,
+      GetInputSafe(context, node, lstm::full::kRecurrentToOutputWeightsTensor,
+                   &recurrent_to_output_weights));
+  const TfLiteTensor* input_gate_bias = GetOptionalInputTensor(
+      context, node, lstm::full::kInputGateBiasTensor);
+  const TfLiteTensor* forget_gate_bias;
+  TF_LITE_ENSURE_OK(
+      context, GetInputSafe(context, node, lstm::full::kForgetGateBiasTensor,
+                            &forget_gate_bias));
+  const TfLiteTensor* cell_gate_bias;
+  TF_LITE_ENSURE_OK(
+      context, GetInputSafe(context, node, lstm::full::kCellGateBiasTensor,
+                            &cell_gate_bias));
+  const TfLiteTensor* output_gate_bias;
+  TF_LITE_ENSURE_OK(
+      context, GetInputSafe(context, node, lstm::full::kOutputGateBiasTensor,
+                            &output_gate_bias));
+
+  for (const TfLiteTensor* tensor :
+       {input_to_input_weights, input_to_forget_weights, input_to_cell_weights,
+        input_to_output_weights, recurrent_to_input_weights,
+        recurrent_to_forget_weights, recurrent_to_cell_weights,
+        recurrent_to_output_weights, input_gate_bias, forget_gate_bias,
+        cell_gate_bias, output_gate_bias}) {
+    if (tensor != nullptr && !IsConstantTensor(tensor)) {
+      return kTfLiteOk;
+    }
+  }
+  lstm_eval::FuseLstmWeightsFloat(
+      input_to_input_weights, input_to_forget_weights, input_to_cell_weights,
+      input_to_output_weights, /*aux_input_to_input_weights=*/nullptr,
+      /*aux_input_to_forget_weights=*/nullptr,
+      /*aux_input_to_cell_weights=*/nullptr,
+      /*aux_input_to_output_weights=*/nullptr, recurrent_to_input_weights,
+      recurrent_to_forget_weights, recurrent_to_cell_weights,
+      recurrent_to_output_weights, input_gate_bias, forget_gate_bias,
+      cell_gate_bias, output_gate_bias, &op_data->fused_weights);
+  return kTfLiteOk;
+}
+
 }  // namespace
 
 // Temporary tensors
@@ -966,12 +1047,22 @@ TfLiteStatus Prepare(TfLiteContext* context, TfLiteNode* node) {
   scratch_buffer->type = input->type;
   scratch_buffer->allocation_type = kTfLiteArenaRw;
 
+  if (!is_integer && !IsHybridOp(input, input_to_output_weights)) {
+    TF_LITE_ENSURE_OK(context,
+                      PrepareFusedWeightsFloat(context, node, op_data));
+  }
+
   const TfLiteTensor* input_to_input_weights = GetOptionalInputTensor(
       context, node, lstm::full::kInputToInputWeightsTensor);
   const bool use_cifg = (input_to_input_weights == nullptr);
   TfLiteIntArray* scratch_buffer_size = TfLiteIntArrayCreate(2);
   scratch_buffer_size->data[0] = n_batch;
-  if (use_cifg) {
+  if (op_data->fused_weights.n_gates > 0) {
+    // Reserving space for the fused gates and an extra 16 bytes to avoid
+    // internal ruy copies.
+    scratch_buffer_size->data[1] =
+        lstm_eval::FusedLstmScratchSizeFloat(n_cell, n_output, use_cifg) + 16;
+  } else if (use_cifg) {
     // Reserving space for Cell, Forget, Output gates and scratch accumulation
     // buffer and an extra 16 bytes to avoid internal ruy copies.
     scratch_buffer_size->data[1] = n_cell * 4 + 16;
@@ -1346,7 +1437,9 @@ TfLiteStatus Eval(TfLiteContext* context, TfLiteNode* node) {
           projection_weights, projection_bias, &lstm_params,
           /*forward_sequence=*/true, time_major,
           /*output_offset=*/0, scratch_buffer, output_state, cell_state, output,
-          CpuBackendContext::GetFromContext(context));
+          CpuBackendContext::GetFromContext(context),
+          op_data->fused_weights.n_gates > 0 ? &op_data->fused_weights
+                                             : nullptr);
     }
     case kTfLiteUInt8:
     case kTfLiteInt8: {
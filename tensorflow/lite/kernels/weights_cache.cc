@@ -0,0 +1,55 @@
+/* Copyright 2022 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/lite/kernels/weights_cache.h"
+
+#include <stddef.h>
+
+namespace tflite {
+
+void* WeightsCache::Find(const void* weights, int kind, size_t size) {
+  auto it = index_.find(Key(weights, kind));
+  if (it == index_.end() || it->second->size != size) return nullptr;
+  entries_.splice(entries_.begin(), entries_, it->second);
+  return it->second->data.get();
+}
+
+void* WeightsCache::Insert(const void* weights, int kind, size_t size) {
+  const Key key(weights, kind);
+  auto it = index_.find(key);
+  if (it != index_.end()) {
+    size_bytes_ -= it->second->size;
+    entries_.erase(it->second);
+    index_.erase(it);
+  }
+  if (size > max_size_bytes_) return nullptr;
+  while (size_bytes_ + size > max_size_bytes_) {
+    size_bytes_ -= entries_.back().size;
+    index_.erase(entries_.back().key);
+    entries_.pop_back();
+  }
+  entries_.push_front(
+      Entry{key, size, std::unique_ptr<char[]>(new char[size])});
+  index_[key] = entries_.begin();
+  size_bytes_ += size;
+  return entries_.front().data.get();
+}
+
+void WeightsCache::Clear() {
+  entries_.clear();
+  index_.clear();
+  size_bytes_ = 0;
+}
+
+}  // namespace tflite
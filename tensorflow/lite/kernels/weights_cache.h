@@ -0,0 +1,86 @@
+/* Copyright 2022 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_LITE_KERNELS_WEIGHTS_CACHE_H_
+#define TENSORFLOW_LITE_KERNELS_WEIGHTS_CACHE_H_
+
+#include <stddef.h>
+
+#include <list>
+#include <map>
+#include <memory>
+#include <utility>
+
+namespace tflite {
+
+// The kinds of data that kernels derive from weights and cache.
+enum WeightsCacheKind {
+  // The filter of CONV_2D transposed to HWCN.
+  kWeightsCacheConvHwcnFilter = 0,
+  // The constant RHS of BATCH_MATMUL with its last two dimensions transposed.
+  kWeightsCacheBatchMatMulTransposedRhs = 1,
+};
+
+// A cache of the data that kernels derive from constant weights, e.g. the
+// transposed weights of CONV_2D, of at most `max_size_bytes` bytes. When it is
+// used, the kernels no longer keep the derived data in persistent arena memory
+// for the lifetime of the interpreter, but look it up when they run, and
+// derive it again from the weights after it was evicted.
+//
+// An entry is keyed by the data of the weights it is derived from and by a
+// kind, to tell apart different data derived from the same weights. A buffer
+// returned by `Find()` or `Insert()` is valid until the next call to
+// `Insert()` or `Clear()`.
+//
+// The cache is not thread-safe, like the CPU backend context that owns it.
+class WeightsCache {
+ public:
+  explicit WeightsCache(size_t max_size_bytes)
+      : max_size_bytes_(max_size_bytes) {}
+
+  // Returns the buffer of `size` bytes cached for the data derived from
+  // `weights` of `kind`, and marks it as the most recently used, or returns
+  // nullptr if there is none.
+  void* Find(const void* weights, int kind, size_t size);
+
+  // Returns a new buffer of `size` bytes for the data derived from `weights`
+  // of `kind`, into which the caller derives it, after evicting the least
+  // recently used entries that don't fit anymore. Returns nullptr if `size` is
+  // larger than the maximum size of the cache.
+  void* Insert(const void* weights, int kind, size_t size);
+
+  // Removes all the entries.
+  void Clear();
+
+  size_t size_bytes() const { return size_bytes_; }
+  size_t max_size_bytes() const { return max_size_bytes_; }
+
+ private:
+  using Key = std::pair<const void*, int>;
+  struct Entry {
+    Key key;
+    size_t size;
+    std::unique_ptr<char[]> data;
+  };
+
+  const size_t max_size_bytes_;
+  size_t size_bytes_ = 0;
+  // The entries from the most to the least recently used.
+  std::list<Entry> entries_;
+  std::map<Key, std::list<Entry>::iterator> index_;
+};
+
+}  // namespace tflite
+
+#endif  // TENSORFLOW_LITE_KERNELS_WEIGHTS_CACHE_H_
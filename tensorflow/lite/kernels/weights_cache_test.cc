@@ -0,0 +1,84 @@
+/* Copyright 2022 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/lite/kernels/weights_cache.h"
+
+#include <string.h>
+
+#include <gtest/gtest.h>
+
+namespace tflite {
+namespace {
+
+TEST(WeightsCacheTest, FindInserted) {
+  WeightsCache cache(100);
+  const float weights[4] = {1, 2, 3, 4};
+  EXPECT_EQ(cache.Find(weights, 0, 16), nullptr);
+  void* buffer = cache.Insert(weights, 0, 16);
+  ASSERT_NE(buffer, nullptr);
+  memcpy(buffer, weights, 16);
+  EXPECT_EQ(cache.Find(weights, 0, 16), buffer);
+  EXPECT_EQ(memcmp(cache.Find(weights, 0, 16), weights, 16), 0);
+  EXPECT_EQ(cache.size_bytes(), 16);
+  // Another kind or size of data derived from the same weights is a miss.
+  EXPECT_EQ(cache.Find(weights, 1, 16), nullptr);
+  EXPECT_EQ(cache.Find(weights, 0, 8), nullptr);
+}
+
+TEST(WeightsCacheTest, EvictsLeastRecentlyUsed) {
+  WeightsCache cache(100);
+  const char weights[3] = {};
+  ASSERT_NE(cache.Insert(&weights[0], 0, 40), nullptr);
+  ASSERT_NE(cache.Insert(&weights[1], 0, 40), nullptr);
+  // Use the first entry, so that the second one is evicted.
+  ASSERT_NE(cache.Find(&weights[0], 0, 40), nullptr);
+  ASSERT_NE(cache.Insert(&weights[2], 0, 40), nullptr);
+  EXPECT_NE(cache.Find(&weights[0], 0, 40), nullptr);
+  EXPECT_EQ(cache.Find(&weights[1], 0, 40), nullptr);
+  EXPECT_NE(cache.Find(&weights[2], 0, 40), nullptr);
+  EXPECT_EQ(cache.size_bytes(), 80);
+}
+
+TEST(WeightsCacheTest, ReinsertReplaces) {
+  WeightsCache cache(100);
+  const char weights = 0;
+  ASSERT_NE(cache.Insert(&weights, 0, 40), nullptr);
+  ASSERT_NE(cache.Insert(&weights, 0, 60), nullptr);
+  EXPECT_EQ(cache.size_bytes(), 60);
+  EXPECT_NE(cache.Find(&weights, 0, 60), nullptr);
+}
+
+TEST(WeightsCacheTest, TooLarge) {
+  WeightsCache cache(100);
+  const char weights[2] = {};
+  ASSERT_NE(cache.Insert(&weights[0], 0, 40), nullptr);
+  EXPECT_EQ(cache.Insert(&weights[1], 0, 101), nullptr);
+  // The cached entries are kept.
+  EXPECT_NE(cache.Find(&weights[0], 0, 40), nullptr);
+
+  WeightsCache empty_cache(0);
+  EXPECT_EQ(empty_cache.Insert(&weights[0], 0, 1), nullptr);
+}
+
+TEST(WeightsCacheTest, Clear) {
+  WeightsCache cache(100);
+  const char weights = 0;
+  ASSERT_NE(cache.Insert(&weights, 0, 40), nullptr);
+  cache.Clear();
+  EXPECT_EQ(cache.size_bytes(), 0);
+  EXPECT_EQ(cache.Find(&weights, 0, 40), nullptr);
+}
+
+}  // namespace
+}  // namespace tflite
@@ -0,0 +1,132 @@
+/* Copyright 2022 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/lite/node_dependencies.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+
+#include "tensorflow/lite/c/common.h"
+
+namespace tflite {
+namespace {
+
+constexpr int kNoNode = -1;
+
+// Returns whether nodes that take `tensor` as an input may modify it.
+bool IsModifiedByReaders(const TfLiteTensor& tensor) {
+  return tensor.is_variable || tensor.type == kTfLiteResource ||
+         tensor.type == kTfLiteVariant;
+}
+
+}  // namespace
+
+NodeDependencies::NodeDependencies(GraphInfo* graph_info,
+                                   const std::vector<bool>& exclusive_nodes) {
+  const int num_nodes = graph_info->num_execution_nodes();
+  successors_.resize(num_nodes);
+  num_predecessors_.assign(num_nodes, 0);
+
+  // The last node that wrote each tensor and the nodes that read it since.
+  std::vector<int> last_writer(graph_info->num_tensors(), kNoNode);
+  std::vector<std::vector<int>> readers(graph_info->num_tensors());
+  int last_exclusive_node = kNoNode;
+  std::vector<int> nodes_since_exclusive_node;
+
+  auto add_edge = [this](int from, int to) {
+    if (from != kNoNode && from != to) successors_[from].push_back(to);
+  };
+  auto write = [&](int node, int tensor) {
+    add_edge(last_writer[tensor], node);
+    for (int reader : readers[tensor]) add_edge(reader, node);
+    last_writer[tensor] = node;
+    readers[tensor].clear();
+  };
+
+  for (int i = 0; i < num_nodes; ++i) {
+    const TfLiteNode& node = graph_info->node(i);
+    for (int j = 0; j < node.inputs->size; ++j) {
+      const int tensor = node.inputs->data[j];
+      if (tensor == kTfLiteOptionalTensor) continue;
+      if (IsModifiedByReaders(*graph_info->tensor(tensor))) {
+        write(i, tensor);
+      } else {
+        add_edge(last_writer[tensor], i);
+        readers[tensor].push_back(i);
+      }
+    }
+    for (int j = 0; j < node.outputs->size; ++j) {
+      const int tensor = node.outputs->data[j];
+      if (tensor == kTfLiteOptionalTensor) continue;
+      write(i, tensor);
+    }
+
+    if (!exclusive_nodes.empty() && exclusive_nodes[i]) {
+      for (int earlier : nodes_since_exclusive_node) add_edge(earlier, i);
+      nodes_since_exclusive_node.clear();
+      add_edge(last_exclusive_node, i);
+      last_exclusive_node = i;
+    } else {
+      add_edge(last_exclusive_node, i);
+      nodes_since_exclusive_node.push_back(i);
+    }
+  }
+
+  for (std::vector<int>& successors : successors_) {
+    std::sort(successors.begin(), successors.end());
+    successors.erase(std::unique(successors.begin(), successors.end()),
+                     successors.end());
+    for (int successor : successors) ++num_predecessors_[successor];
+  }
+}
+
+std::vector<int32_t> NodeDependencies::LastConcurrentNodes() const {
+  const int num_nodes = successors_.size();
+  const int num_words = (num_nodes + 63) / 64;
+  // The nodes that depend on each node, directly or indirectly. Successors
+  // come later in the execution plan, so a reverse scan sees them first.
+  std::vector<std::vector<uint64_t>> descendants(
+      num_nodes, std::vector<uint64_t>(num_words, 0));
+  std::vector<int32_t> last_concurrent_nodes(num_nodes);
+  for (int i = num_nodes - 1; i >= 0; --i) {
+    std::vector<uint64_t>& node_descendants = descendants[i];
+    for (int successor : successors_[i]) {
+      node_descendants[successor / 64] |= uint64_t{1} << (successor % 64);
+      for (int w = successor / 64; w < num_words; ++w) {
+        node_descendants[w] |= descendants[successor][w];
+      }
+    }
+    last_concurrent_nodes[i] = i;
+    for (int w = num_words - 1; w >= i / 64; --w) {
+      uint64_t others = ~node_descendants[w];
+      if (w == num_words - 1 && num_nodes % 64 != 0) {
+        others &= (uint64_t{1} << (num_nodes % 64)) - 1;
+      }
+      if (w == i / 64) {
+        // Only the nodes after `i`.
+        others &= ~((uint64_t{2} << (i % 64)) - 1);
+      }
+      if (others != 0) {
+        int bit = 63;
+        while ((others >> bit) == 0) --bit;
+        last_concurrent_nodes[i] = w * 64 + bit;
+        break;
+      }
+    }
+  }
+  return last_concurrent_nodes;
+}
+
+}  // namespace tflite
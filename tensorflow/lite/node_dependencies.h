@@ -0,0 +1,72 @@
+/* Copyright 2022 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_LITE_NODE_DEPENDENCIES_H_
+#define TENSORFLOW_LITE_NODE_DEPENDENCIES_H_
+
+#include <cstdint>
+#include <vector>
+
+#include "tensorflow/lite/graph_info.h"
+
+namespace tflite {
+
+// The order in which the nodes of an execution plan have to run so that they
+// can run at the same time as the nodes they don't depend on, with the same
+// results as running the whole plan in order. Nodes are identified by their
+// index in the execution plan, and a node only depends on earlier nodes.
+//
+// A node depends on:
+// - the last earlier node that writes one of its inputs;
+// - for each of its outputs, the last earlier node that writes it and the
+//   nodes that read it since, so that it isn't overwritten while read;
+// - for inputs that it modifies, i.e. variable, resource and variant tensors,
+//   the same nodes as for its outputs.
+// Nodes can also be marked exclusive, e.g. control flow ops that invoke other
+// subgraphs. They depend on all the earlier nodes, and all the later nodes
+// depend on them.
+//
+// The dependencies don't take the memory that tensors share into account, see
+// ArenaPlanner::SetPlanForConcurrentNodes().
+class NodeDependencies {
+ public:
+  // `exclusive_nodes` is either empty or has an entry for each node of the
+  // execution plan of `graph_info`.
+  explicit NodeDependencies(GraphInfo* graph_info,
+                            const std::vector<bool>& exclusive_nodes = {});
+
+  size_t num_nodes() const { return successors_.size(); }
+
+  // Returns the nodes that depend directly on `node`, in increasing order.
+  const std::vector<int>& successors(int node) const {
+    return successors_[node];
+  }
+
+  // Returns the number of nodes that `node` depends directly on.
+  int num_predecessors(int node) const { return num_predecessors_[node]; }
+
+  // Returns, for each node, the last node of the execution plan that doesn't
+  // depend on it, directly or indirectly, i.e. that may run at the same time
+  // or before it, or the node itself if there is none. Takes O(n^2 / 8) bytes
+  // of memory for n nodes.
+  std::vector<int32_t> LastConcurrentNodes() const;
+
+ private:
+  std::vector<std::vector<int>> successors_;
+  std::vector<int> num_predecessors_;
+};
+
+}  // namespace tflite
+
+#endif  // TENSORFLOW_LITE_NODE_DEPENDENCIES_H_
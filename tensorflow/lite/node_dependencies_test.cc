@@ -0,0 +1,147 @@
+/* Copyright 2022 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/lite/node_dependencies.h"
+
+#include <cstdint>
+#include <vector>
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+#include "tensorflow/lite/c/common.h"
+#include "tensorflow/lite/graph_info.h"
+
+namespace tflite {
+namespace {
+
+using ::testing::ElementsAre;
+using ::testing::IsEmpty;
+
+// A graph of nodes with the given inputs and outputs.
+class TestGraphInfo : public GraphInfo {
+ public:
+  TestGraphInfo(int num_tensors,
+                const std::vector<std::vector<std::vector<int>>>& nodes)
+      : tensors_(num_tensors) {
+    for (const auto& node : nodes) {
+      nodes_.emplace_back();
+      nodes_.back().inputs = CreateArray(node[0]);
+      nodes_.back().outputs = CreateArray(node[1]);
+    }
+  }
+  ~TestGraphInfo() override {
+    for (TfLiteNode& node : nodes_) {
+      TfLiteIntArrayFree(node.inputs);
+      TfLiteIntArrayFree(node.outputs);
+    }
+  }
+
+  size_t num_tensors() const override { return tensors_.size(); }
+  TfLiteTensor* tensor(size_t index) override { return &tensors_[index]; }
+  size_t num_execution_nodes() const override { return nodes_.size(); }
+  size_t num_total_nodes() const override { return nodes_.size(); }
+  const TfLiteNode& node(size_t index) const override { return nodes_[index]; }
+  size_t node_index(size_t index) const override { return index; }
+  const std::vector<int>& inputs() const override { return empty_; }
+  const std::vector<int>& outputs() const override { return empty_; }
+  const std::vector<int>& variables() const override { return empty_; }
+
+ private:
+  static TfLiteIntArray* CreateArray(const std::vector<int>& values) {
+    TfLiteIntArray* array = TfLiteIntArrayCreate(values.size());
+    for (size_t i = 0; i < values.size(); ++i) array->data[i] = values[i];
+    return array;
+  }
+
+  std::vector<TfLiteTensor> tensors_;
+  std::vector<TfLiteNode> nodes_;
+  std::vector<int> empty_;
+};
+
+TEST(NodeDependenciesTest, Branches) {
+  TestGraphInfo graph(5, {
+                             {{0}, {1}},     // First branch
+                             {{1}, {2}},     // First branch
+                             {{0}, {3}},     // Second branch
+                             {{2, 3}, {4}},  // Join
+                         });
+  NodeDependencies dependencies(&graph);
+  ASSERT_EQ(dependencies.num_nodes(), 4);
+  EXPECT_THAT(dependencies.successors(0), ElementsAre(1));
+  EXPECT_THAT(dependencies.successors(1), ElementsAre(3));
+  EXPECT_THAT(dependencies.successors(2), ElementsAre(3));
+  EXPECT_THAT(dependencies.successors(3), IsEmpty());
+  EXPECT_EQ(dependencies.num_predecessors(0), 0);
+  EXPECT_EQ(dependencies.num_predecessors(1), 1);
+  EXPECT_EQ(dependencies.num_predecessors(2), 0);
+  EXPECT_EQ(dependencies.num_predecessors(3), 2);
+  EXPECT_THAT(dependencies.LastConcurrentNodes(), ElementsAre(2, 2, 2, 3));
+}
+
+TEST(NodeDependenciesTest, WritesAfterReads) {
+  TestGraphInfo graph(4, {
+                             {{0}, {1}},
+                             {{1}, {2}},
+                             // Overwrites the input of the second node.
+                             {{3}, {1}},
+                         });
+  NodeDependencies dependencies(&graph);
+  EXPECT_THAT(dependencies.successors(0), ElementsAre(1, 2));
+  EXPECT_THAT(dependencies.successors(1), ElementsAre(2));
+  EXPECT_THAT(dependencies.LastConcurrentNodes(), ElementsAre(0, 1, 2));
+}
+
+TEST(NodeDependenciesTest, VariableInputs) {
+  TestGraphInfo graph(3, {
+                             {{0}, {1}},
+                             {{0}, {2}},
+                         });
+  graph.tensor(0)->is_variable = true;
+  NodeDependencies dependencies(&graph);
+  EXPECT_THAT(dependencies.successors(0), ElementsAre(1));
+}
+
+TEST(NodeDependenciesTest, ExclusiveNodes) {
+  TestGraphInfo graph(6, {
+                             {{0}, {1}},
+                             {{0}, {2}},
+                             {{0}, {3}},
+                             {{0}, {4}},
+                         });
+  NodeDependencies dependencies(&graph, {false, false, true, false});
+  EXPECT_THAT(dependencies.successors(0), ElementsAre(2));
+  EXPECT_THAT(dependencies.successors(1), ElementsAre(2));
+  EXPECT_THAT(dependencies.successors(2), ElementsAre(3));
+  EXPECT_THAT(dependencies.LastConcurrentNodes(), ElementsAre(1, 1, 2, 3));
+}
+
+TEST(NodeDependenciesTest, LastConcurrentNodesOfLargeGraph) {
+  // 100 independent chains of two nodes, one after the other in the plan.
+  std::vector<std::vector<std::vector<int>>> nodes;
+  for (int i = 0; i < 100; ++i) {
+    nodes.push_back({{0}, {1 + 2 * i}});
+    nodes.push_back({{1 + 2 * i}, {2 + 2 * i}});
+  }
+  TestGraphInfo graph(201, nodes);
+  const std::vector<int32_t> last_concurrent_nodes =
+      NodeDependencies(&graph).LastConcurrentNodes();
+  ASSERT_EQ(last_concurrent_nodes.size(), 200);
+  for (int i = 0; i < 200; ++i) {
+    // Only the last node depends on the first node of the last chain.
+    EXPECT_EQ(last_concurrent_nodes[i], i == 198 ? 198 : 199) << i;
+  }
+}
+
+}  // namespace
+}  // namespace tflite
@@ -0,0 +1,230 @@
+/* Copyright 2022 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/lite/offline_memory_planner.h"
+
+#include <stddef.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <limits>
+#include <numeric>
+#include <random>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace tflite {
+namespace {
+
+constexpr size_t kNotPlaced = std::numeric_limits<size_t>::max();
+
+size_t AlignTo(size_t alignment, size_t offset) {
+  return offset % alignment == 0 ? offset
+                                 : offset + (alignment - offset % alignment);
+}
+
+bool Intersect(const OfflinePlannedBuffer& a, const OfflinePlannedBuffer& b) {
+  return a.first_node <= b.last_node && b.first_node <= a.last_node;
+}
+
+}  // namespace
+
+size_t PeakLiveBytes(const std::vector<OfflinePlannedBuffer>& buffers) {
+  // Pairs of a node and the change of the live bytes at it. The frees sort
+  // before the allocations of the same node.
+  std::vector<std::pair<int64_t, int64_t>> events;
+  events.reserve(2 * buffers.size());
+  for (const OfflinePlannedBuffer& buffer : buffers) {
+    const int64_t size = static_cast<int64_t>(buffer.size);
+    events.emplace_back(buffer.first_node, size);
+    events.emplace_back(static_cast<int64_t>(buffer.last_node) + 1, -size);
+  }
+  std::sort(events.begin(), events.end());
+  int64_t live_bytes = 0;
+  int64_t peak = 0;
+  for (const auto& event : events) {
+    live_bytes += event.second;
+    peak = std::max(peak, live_bytes);
+  }
+  return static_cast<size_t>(peak);
+}
+
+namespace {
+
+// Places the buffers one at a time in `order`, each in the smallest gap
+// between the buffers placed before it that it fits in, and returns the arena
+// size.
+size_t PlaceInOrder(const std::vector<OfflinePlannedBuffer>& buffers,
+                    const std::vector<int>& order, size_t alignment,
+                    std::vector<size_t>* offsets) {
+  // The placed buffers, ordered by offset.
+  std::vector<int> placed;
+  placed.reserve(order.size());
+  size_t arena_size = 0;
+  for (int i : order) {
+    const OfflinePlannedBuffer& buffer = buffers[i];
+    if (buffer.size == 0) {
+      (*offsets)[i] = 0;
+      continue;
+    }
+    size_t best_offset = kNotPlaced;
+    size_t best_gap = kNotPlaced;
+    size_t current_offset = 0;
+    for (int j : placed) {
+      if (!Intersect(buffer, buffers[j])) continue;
+      const size_t aligned_offset = AlignTo(alignment, current_offset);
+      const size_t offset = (*offsets)[j];
+      if (aligned_offset + buffer.size <= offset &&
+          offset - aligned_offset < best_gap) {
+        best_offset = aligned_offset;
+        best_gap = offset - aligned_offset;
+      }
+      current_offset = std::max(current_offset, offset + buffers[j].size);
+    }
+    if (best_offset == kNotPlaced) {
+      best_offset = AlignTo(alignment, current_offset);
+    }
+    (*offsets)[i] = best_offset;
+    arena_size = std::max(arena_size, best_offset + buffer.size);
+    auto insertion_it = std::upper_bound(
+        placed.begin(), placed.end(), best_offset,
+        [offsets](size_t offset, int j) { return offset < (*offsets)[j]; });
+    placed.insert(insertion_it, i);
+  }
+  return arena_size;
+}
+
+}  // namespace
+
+std::vector<size_t> PlanOfflineMemoryAllocation(
+    const std::vector<OfflinePlannedBuffer>& buffers,
+    const OfflineMemoryPlannerOptions& options, size_t* arena_size) {
+  auto lifetime = [&buffers](int i) {
+    return static_cast<double>(buffers[i].last_node) -
+           static_cast<double>(buffers[i].first_node) + 1;
+  };
+  const std::vector<std::function<bool(int, int)>> greedy_orders = {
+      // By size, like ArenaPlanner.
+      [&buffers](int a, int b) {
+        if (buffers[a].size != buffers[b].size) {
+          return buffers[a].size > buffers[b].size;
+        }
+        return buffers[a].first_node < buffers[b].first_node;
+      },
+      // By size times lifetime.
+      [&buffers, &lifetime](int a, int b) {
+        return static_cast<double>(buffers[a].size) * lifetime(a) >
+               static_cast<double>(buffers[b].size) * lifetime(b);
+      },
+      // By first use, with the larger buffers first.
+      [&buffers](int a, int b) {
+        if (buffers[a].first_node != buffers[b].first_node) {
+          return buffers[a].first_node < buffers[b].first_node;
+        }
+        return buffers[a].size > buffers[b].size;
+      },
+  };
+
+  std::vector<int> identity(buffers.size());
+  std::iota(identity.begin(), identity.end(), 0);
+  std::vector<size_t> offsets(buffers.size());
+  std::vector<int> best_order;
+  std::vector<size_t> best_offsets;
+  size_t best_size = kNotPlaced;
+  for (const auto& compare : greedy_orders) {
+    std::vector<int> order = identity;
+    std::stable_sort(order.begin(), order.end(), compare);
+    const size_t size =
+        PlaceInOrder(buffers, order, options.alignment, &offsets);
+    if (size < best_size) {
+      best_size = size;
+      best_order = std::move(order);
+      best_offsets = offsets;
+    }
+  }
+
+  const size_t lower_bound = PeakLiveBytes(buffers);
+  // A fixed seed, and not using the distributions of the standard library,
+  // keeps the plans of a model reproducible across platforms.
+  std::mt19937 rng(0);
+  auto position = [&]() { return rng() % buffers.size(); };
+  for (int iteration = 0; iteration < options.local_search_iterations &&
+                          buffers.size() > 1 && best_size > lower_bound;
+       ++iteration) {
+    std::vector<int> order = best_order;
+    std::swap(order[position()], order[position()]);
+    const size_t size =
+        PlaceInOrder(buffers, order, options.alignment, &offsets);
+    // Also accepts swaps that keep the size, to move across plateaus.
+    if (size <= best_size) {
+      best_size = size;
+      best_order = std::move(order);
+      best_offsets = offsets;
+    }
+  }
+  *arena_size = best_size;
+  return best_offsets;
+}
+
+std::string SerializeOfflineMemoryAllocation(
+    const std::vector<std::pair<int, std::vector<int32_t>>>&
+        subgraph_offsets) {
+  std::vector<int32_t> values = {kOfflineMemoryAllocationVersion};
+  for (const auto& subgraph : subgraph_offsets) {
+    values.push_back(subgraph.first);
+    values.push_back(static_cast<int32_t>(subgraph.second.size()));
+    values.insert(values.end(), subgraph.second.begin(),
+                  subgraph.second.end());
+  }
+  return std::string(reinterpret_cast<const char*>(values.data()),
+                     values.size() * sizeof(int32_t));
+}
+
+bool ParseOfflineMemoryAllocation(const char* data, size_t bytes,
+                                  int subgraph_index,
+                                  std::vector<int32_t>* offsets) {
+  if (bytes % sizeof(int32_t) != 0) return false;
+  const size_t num_values = bytes / sizeof(int32_t);
+  auto value = [data](size_t i) {
+    int32_t value;
+    memcpy(&value, data + i * sizeof(int32_t), sizeof(int32_t));
+    return value;
+  };
+  if (num_values == 0 || value(0) != kOfflineMemoryAllocationVersion) {
+    return false;
+  }
+  size_t i = 1;
+  while (i + 2 <= num_values) {
+    const int32_t index = value(i);
+    const int32_t num_tensors = value(i + 1);
+    i += 2;
+    if (num_tensors < 0 || static_cast<size_t>(num_tensors) > num_values - i) {
+      return false;
+    }
+    if (index == subgraph_index) {
+      offsets->resize(num_tensors);
+      for (int32_t j = 0; j < num_tensors; ++j) {
+        (*offsets)[j] = value(i + j);
+      }
+      return true;
+    }
+    i += num_tensors;
+  }
+  return false;
+}
+
+}  // namespace tflite
@@ -0,0 +1,86 @@
+/* Copyright 2022 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_LITE_OFFLINE_MEMORY_PLANNER_H_
+#define TENSORFLOW_LITE_OFFLINE_MEMORY_PLANNER_H_
+
+#include <stddef.h>
+
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace tflite {
+
+// The name of the model metadata that holds the kTfLiteArenaRw offsets of
+// tensors that were planned ahead of time, e.g. by the converter.
+//
+// The metadata is a buffer of int32 values: a version followed by a record per
+// planned subgraph,
+//
+//   version, [subgraph index, number of tensors, offset of each tensor]...
+//
+// where kOnlinePlannedOffset marks the tensors that are planned at runtime.
+constexpr char kOfflineMemoryAllocationMetadata[] = "OfflineMemoryAllocation";
+constexpr int32_t kOfflineMemoryAllocationVersion = 1;
+constexpr int32_t kOnlinePlannedOffset = -1;
+
+// A buffer to plan: `size` bytes that are used from the execution of
+// `first_node` through the execution of `last_node`.
+struct OfflinePlannedBuffer {
+  size_t size;
+  int32_t first_node;
+  int32_t last_node;
+};
+
+struct OfflineMemoryPlannerOptions {
+  // The alignment of the offsets.
+  size_t alignment = 64;
+  // The number of orders the local search tries after the greedy orders.
+  int local_search_iterations = 100;
+};
+
+// Returns offsets of `buffers` such that buffers with intersecting usage
+// intervals don't overlap, and sets `arena_size` to the size of the arena they
+// need.
+//
+// The buffers are placed one at a time in the smallest gap they fit in, in
+// the best of a few greedy orders (by size, by size times lifetime and by
+// first use). A local search then swaps pairs of buffers in the order, and
+// keeps the swaps that don't grow the arena. The search stops early if the
+// arena reaches the peak of the live bytes, which is a lower bound.
+std::vector<size_t> PlanOfflineMemoryAllocation(
+    const std::vector<OfflinePlannedBuffer>& buffers,
+    const OfflineMemoryPlannerOptions& options, size_t* arena_size);
+
+// Returns the largest sum of the sizes of the buffers that are used at the
+// same node, which is a lower bound of the size of any arena that holds them.
+size_t PeakLiveBytes(const std::vector<OfflinePlannedBuffer>& buffers);
+
+// Returns the contents of the kOfflineMemoryAllocationMetadata metadata with
+// the offsets of each (subgraph index, offsets) pair.
+std::string SerializeOfflineMemoryAllocation(
+    const std::vector<std::pair<int, std::vector<int32_t>>>& subgraph_offsets);
+
+// Reads the offsets of subgraph `subgraph_index` from the contents of the
+// kOfflineMemoryAllocationMetadata metadata. Returns false if the metadata
+// doesn't plan the subgraph or is malformed.
+bool ParseOfflineMemoryAllocation(const char* data, size_t bytes,
+                                  int subgraph_index,
+                                  std::vector<int32_t>* offsets);
+
+}  // namespace tflite
+
+#endif  // TENSORFLOW_LITE_OFFLINE_MEMORY_PLANNER_H_
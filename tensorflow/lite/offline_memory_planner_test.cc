@@ -0,0 +1,120 @@
+/* Copyright 2022 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/lite/offline_memory_planner.h"
+
+#include <stddef.h>
+
+#include <cstdint>
+#include <random>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+namespace tflite {
+namespace {
+
+// Expects that the buffers with intersecting usage intervals don't overlap,
+// and that they fit in the arena.
+void ExpectValidPlan(const std::vector<OfflinePlannedBuffer>& buffers,
+                     const std::vector<size_t>& offsets, size_t arena_size,
+                     size_t alignment) {
+  ASSERT_EQ(buffers.size(), offsets.size());
+  for (size_t i = 0; i < buffers.size(); ++i) {
+    EXPECT_EQ(offsets[i] % alignment, 0);
+    EXPECT_LE(offsets[i] + buffers[i].size, arena_size);
+    for (size_t j = 0; j < i; ++j) {
+      if (buffers[i].size == 0 || buffers[j].size == 0 ||
+          buffers[i].last_node < buffers[j].first_node ||
+          buffers[j].last_node < buffers[i].first_node) {
+        continue;
+      }
+      EXPECT_TRUE(offsets[i] + buffers[i].size <= offsets[j] ||
+                  offsets[j] + buffers[j].size <= offsets[i])
+          << "buffers " << i << " and " << j << " overlap";
+    }
+  }
+}
+
+TEST(OfflineMemoryPlannerTest, Chain) {
+  const std::vector<OfflinePlannedBuffer> buffers = {
+      {100, 0, 1}, {200, 1, 2}, {100, 2, 3}, {0, 0, 3}};
+  OfflineMemoryPlannerOptions options;
+  options.alignment = 4;
+  size_t arena_size;
+  const std::vector<size_t> offsets =
+      PlanOfflineMemoryAllocation(buffers, options, &arena_size);
+  ExpectValidPlan(buffers, offsets, arena_size, options.alignment);
+  EXPECT_EQ(arena_size, 300);
+}
+
+TEST(OfflineMemoryPlannerTest, BetterThanSizeOrder) {
+  // In the order by size, #4 reuses the memory of #0, and #1 doesn't
+  // fit next to #4 and #2, so the arena grows to 100 bytes.
+  const std::vector<OfflinePlannedBuffer> buffers = {
+      {40, 0, 0}, {20, 1, 3}, {40, 0, 1}, {30, 4, 6}, {40, 2, 3}};
+  OfflineMemoryPlannerOptions options;
+  options.alignment = 1;
+  size_t arena_size;
+  const std::vector<size_t> offsets =
+      PlanOfflineMemoryAllocation(buffers, options, &arena_size);
+  ExpectValidPlan(buffers, offsets, arena_size, options.alignment);
+  EXPECT_EQ(arena_size, 80);
+}
+
+TEST(OfflineMemoryPlannerTest, RandomBuffers) {
+  std::mt19937 rng(42);
+  for (int test = 0; test < 20; ++test) {
+    std::vector<OfflinePlannedBuffer> buffers;
+    for (int i = 0; i < 50; ++i) {
+      const int32_t first_node = rng() % 40;
+      buffers.push_back({1 + rng() % 1000, first_node,
+                         first_node + static_cast<int32_t>(rng() % 10)});
+    }
+    OfflineMemoryPlannerOptions options;
+    options.local_search_iterations = 0;
+    size_t greedy_arena_size;
+    PlanOfflineMemoryAllocation(buffers, options, &greedy_arena_size);
+
+    options.local_search_iterations = 100;
+    size_t arena_size;
+    const std::vector<size_t> offsets =
+        PlanOfflineMemoryAllocation(buffers, options, &arena_size);
+    ExpectValidPlan(buffers, offsets, arena_size, options.alignment);
+    EXPECT_LE(arena_size, greedy_arena_size);
+  }
+}
+
+TEST(OfflineMemoryPlannerTest, SerializeAndParse) {
+  const std::string metadata = SerializeOfflineMemoryAllocation(
+      {{0, {0, 64, kOnlinePlannedOffset}}, {2, {128}}});
+  std::vector<int32_t> offsets;
+  ASSERT_TRUE(ParseOfflineMemoryAllocation(metadata.data(), metadata.size(),
+                                           0, &offsets));
+  EXPECT_EQ(offsets, std::vector<int32_t>({0, 64, kOnlinePlannedOffset}));
+  ASSERT_TRUE(ParseOfflineMemoryAllocation(metadata.data(), metadata.size(),
+                                           2, &offsets));
+  EXPECT_EQ(offsets, std::vector<int32_t>({128}));
+  EXPECT_FALSE(ParseOfflineMemoryAllocation(metadata.data(), metadata.size(),
+                                            1, &offsets));
+  // Truncated metadata.
+  EXPECT_FALSE(ParseOfflineMemoryAllocation(
+      metadata.data(), metadata.size() - sizeof(int32_t), 2, &offsets));
+  EXPECT_FALSE(ParseOfflineMemoryAllocation(metadata.data(), 3, 0, &offsets));
+}
+
+}  // namespace
+}  // namespace tflite
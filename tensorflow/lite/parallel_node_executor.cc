@@ -0,0 +1,119 @@
+/* Copyright 2022 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/lite/parallel_node_executor.h"
+
+#include <functional>
+#include <memory>
+#include <mutex>  // NOLINT(build/c++11)
+#include <thread>  // NOLINT(build/c++11)
+#include <vector>
+
+#include "tensorflow/lite/c/common.h"
+#include "tensorflow/lite/external_cpu_backend_context.h"
+#include "tensorflow/lite/node_dependencies.h"
+
+namespace tflite {
+namespace {
+
+thread_local ExternalCpuBackendContext* worker_cpu_backend_context = nullptr;
+
+}  // namespace
+
+ParallelNodeExecutor::ParallelNodeExecutor(int num_threads) {
+  for (int i = 1; i < num_threads; ++i) {
+    worker_cpu_backend_contexts_.push_back(
+        std::make_unique<ExternalCpuBackendContext>());
+    workers_.emplace_back(&ParallelNodeExecutor::WorkerLoop, this,
+                          worker_cpu_backend_contexts_.back().get());
+  }
+}
+
+ParallelNodeExecutor::~ParallelNodeExecutor() {
+  {
+    std::lock_guard<std::mutex> lock(mu_);
+    exiting_ = true;
+  }
+  ready_cv_.notify_all();
+  for (std::thread& worker : workers_) worker.join();
+}
+
+TfLiteExternalContext* ParallelNodeExecutor::WorkerCpuBackendContext() {
+  return worker_cpu_backend_context;
+}
+
+TfLiteStatus ParallelNodeExecutor::Run(
+    const NodeDependencies& dependencies,
+    const std::function<TfLiteStatus(int node)>& run_node, int* failed_node) {
+  std::unique_lock<std::mutex> lock(mu_);
+  dependencies_ = &dependencies;
+  run_node_ = &run_node;
+  status_ = kTfLiteOk;
+  failed_node_ = -1;
+  num_remaining_nodes_ = dependencies.num_nodes();
+  num_pending_predecessors_.resize(dependencies.num_nodes());
+  for (int i = 0; i < dependencies.num_nodes(); ++i) {
+    num_pending_predecessors_[i] = dependencies.num_predecessors(i);
+    if (num_pending_predecessors_[i] == 0) ready_nodes_.push(i);
+  }
+  ready_cv_.notify_all();
+
+  while (num_remaining_nodes_ > 0 &&
+         (status_ == kTfLiteOk || num_running_nodes_ > 0)) {
+    if (!RunReadyNode(&lock)) done_cv_.wait(lock);
+  }
+  dependencies_ = nullptr;
+  run_node_ = nullptr;
+  if (failed_node != nullptr) *failed_node = failed_node_;
+  return status_;
+}
+
+bool ParallelNodeExecutor::RunReadyNode(std::unique_lock<std::mutex>* lock) {
+  if (ready_nodes_.empty() || status_ != kTfLiteOk) return false;
+  const int node = ready_nodes_.top();
+  ready_nodes_.pop();
+  ++num_running_nodes_;
+  lock->unlock();
+  const TfLiteStatus status = (*run_node_)(node);
+  lock->lock();
+  --num_running_nodes_;
+  --num_remaining_nodes_;
+  if (status != kTfLiteOk) {
+    if (status_ == kTfLiteOk) {
+      status_ = status;
+      failed_node_ = node;
+    }
+    while (!ready_nodes_.empty()) ready_nodes_.pop();
+  } else if (status_ == kTfLiteOk) {
+    for (int successor : dependencies_->successors(node)) {
+      if (--num_pending_predecessors_[successor] == 0) {
+        ready_nodes_.push(successor);
+        ready_cv_.notify_one();
+      }
+    }
+  }
+  done_cv_.notify_one();
+  return true;
+}
+
+void ParallelNodeExecutor::WorkerLoop(
+    ExternalCpuBackendContext* cpu_backend_context) {
+  worker_cpu_backend_context = cpu_backend_context;
+  std::unique_lock<std::mutex> lock(mu_);
+  while (!exiting_) {
+    if (!RunReadyNode(&lock)) ready_cv_.wait(lock);
+  }
+}
+
+}  // namespace tflite
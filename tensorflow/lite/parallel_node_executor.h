@@ -0,0 +1,92 @@
+/* Copyright 2022 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_LITE_PARALLEL_NODE_EXECUTOR_H_
+#define TENSORFLOW_LITE_PARALLEL_NODE_EXECUTOR_H_
+
+#include <condition_variable>  // NOLINT(build/c++11)
+#include <functional>
+#include <memory>
+#include <mutex>  // NOLINT(build/c++11)
+#include <queue>
+#include <thread>  // NOLINT(build/c++11)
+#include <vector>
+
+#include "tensorflow/lite/c/common.h"
+#include "tensorflow/lite/external_cpu_backend_context.h"
+#include "tensorflow/lite/node_dependencies.h"
+
+namespace tflite {
+
+// Runs the nodes of an execution plan on a pool of threads, each node once the
+// nodes it depends on are done. The thread that calls Run() runs nodes too, and
+// ready nodes run in the order of the execution plan.
+//
+// Kernels from different nodes can run at the same time, so they must not
+// share mutable state. Each worker thread has its own kTfLiteCpuBackendContext,
+// which WorkerCpuBackendContext() returns, since the CPU backend context isn't
+// thread safe.
+class ParallelNodeExecutor {
+ public:
+  // Starts `num_threads - 1` worker threads.
+  explicit ParallelNodeExecutor(int num_threads);
+  ~ParallelNodeExecutor();
+  ParallelNodeExecutor(const ParallelNodeExecutor&) = delete;
+  ParallelNodeExecutor& operator=(const ParallelNodeExecutor&) = delete;
+
+  int num_threads() const { return workers_.size() + 1; }
+
+  // Calls `run_node` for each node of `dependencies`. Once a node fails, no
+  // other nodes are started, and the error of the first failed node is
+  // returned after the running nodes are done, with the node in
+  // `failed_node`. Not reentrant.
+  TfLiteStatus Run(const NodeDependencies& dependencies,
+                   const std::function<TfLiteStatus(int node)>& run_node,
+                   int* failed_node);
+
+  // Returns the kTfLiteCpuBackendContext of the calling thread if it is a
+  // worker thread of an executor, or nullptr.
+  static TfLiteExternalContext* WorkerCpuBackendContext();
+
+ private:
+  // Runs the next ready node of the current Run(), if there is one and no
+  // node failed, with mu_ released while the node runs. Returns whether a
+  // node ran.
+  bool RunReadyNode(std::unique_lock<std::mutex>* lock);
+  void WorkerLoop(ExternalCpuBackendContext* cpu_backend_context);
+
+  std::vector<std::unique_ptr<ExternalCpuBackendContext>>
+      worker_cpu_backend_contexts_;
+  std::vector<std::thread> workers_;
+
+  std::mutex mu_;
+  // Signals the workers that a node is ready or that they have to exit.
+  std::condition_variable ready_cv_;
+  // Signals the caller of Run() that a node is done.
+  std::condition_variable done_cv_;
+  bool exiting_ = false;
+  // The state of the current Run().
+  const NodeDependencies* dependencies_ = nullptr;
+  const std::function<TfLiteStatus(int)>* run_node_ = nullptr;
+  std::vector<int> num_pending_predecessors_;
+  std::priority_queue<int, std::vector<int>, std::greater<int>> ready_nodes_;
+  int num_running_nodes_ = 0;
+  int num_remaining_nodes_ = 0;
+  TfLiteStatus status_ = kTfLiteOk;
+  int failed_node_ = -1;
+};
+
+}  // namespace tflite
+
+#endif  // TENSORFLOW_LITE_PARALLEL_NODE_EXECUTOR_H_
@@ -0,0 +1,189 @@
+/* Copyright 2022 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/lite/parallel_node_executor.h"
+
+#include <atomic>
+#include <chrono>  // NOLINT(build/c++11)
+#include <mutex>  // NOLINT(build/c++11)
+#include <set>
+#include <thread>  // NOLINT(build/c++11)
+#include <vector>
+
+#include <gtest/gtest.h>
+#include "tensorflow/lite/c/common.h"
+#include "tensorflow/lite/graph_info.h"
+#include "tensorflow/lite/node_dependencies.h"
+
+namespace tflite {
+namespace {
+
+// A graph of nodes with the given inputs and outputs.
+class TestGraphInfo : public GraphInfo {
+ public:
+  TestGraphInfo(int num_tensors,
+                const std::vector<std::vector<std::vector<int>>>& nodes)
+      : tensors_(num_tensors) {
+    for (const auto& node : nodes) {
+      nodes_.emplace_back();
+      nodes_.back().inputs = CreateArray(node[0]);
+      nodes_.back().outputs = CreateArray(node[1]);
+    }
+  }
+  ~TestGraphInfo() override {
+    for (TfLiteNode& node : nodes_) {
+      TfLiteIntArrayFree(node.inputs);
+      TfLiteIntArrayFree(node.outputs);
+    }
+  }
+
+  size_t num_tensors() const override { return tensors_.size(); }
+  TfLiteTensor* tensor(size_t index) override { return &tensors_[index]; }
+  size_t num_execution_nodes() const override { return nodes_.size(); }
+  size_t num_total_nodes() const override { return nodes_.size(); }
+  const TfLiteNode& node(size_t index) const override { return nodes_[index]; }
+  size_t node_index(size_t index) const override { return index; }
+  const std::vector<int>& inputs() const override { return empty_; }
+  const std::vector<int>& outputs() const override { return empty_; }
+  const std::vector<int>& variables() const override { return empty_; }
+
+ private:
+  static TfLiteIntArray* CreateArray(const std::vector<int>& values) {
+    TfLiteIntArray* array = TfLiteIntArrayCreate(values.size());
+    for (size_t i = 0; i < values.size(); ++i) array->data[i] = values[i];
+    return array;
+  }
+
+  std::vector<TfLiteTensor> tensors_;
+  std::vector<TfLiteNode> nodes_;
+  std::vector<int> empty_;
+};
+
+// Two branches of three nodes that join.
+TestGraphInfo CreateBranches() {
+  return TestGraphInfo(8, {
+                              {{0}, {1}},
+                              {{0}, {2}},
+                              {{1}, {3}},
+                              {{2}, {4}},
+                              {{3}, {5}},
+                              {{4}, {6}},
+                              {{5, 6}, {7}},
+                          });
+}
+
+TEST(ParallelNodeExecutorTest, RunsNodesAfterTheirDependencies) {
+  TestGraphInfo graph = CreateBranches();
+  NodeDependencies dependencies(&graph);
+  ParallelNodeExecutor executor(4);
+  EXPECT_EQ(executor.num_threads(), 4);
+  for (int run = 0; run < 100; ++run) {
+    std::mutex mutex;
+    std::vector<int> done_nodes;
+    std::vector<bool> ran_after_predecessors(dependencies.num_nodes(), true);
+    auto run_node = [&](int node) {
+      std::lock_guard<std::mutex> lock(mutex);
+      const std::set<int> done(done_nodes.begin(), done_nodes.end());
+      for (int i = 0; i < dependencies.num_nodes(); ++i) {
+        for (int successor : dependencies.successors(i)) {
+          if (successor == node && !done.count(i)) {
+            ran_after_predecessors[node] = false;
+          }
+        }
+      }
+      done_nodes.push_back(node);
+      return kTfLiteOk;
+    };
+    int failed_node = 0;
+    ASSERT_EQ(executor.Run(dependencies, run_node, &failed_node), kTfLiteOk);
+    EXPECT_EQ(failed_node, -1);
+    EXPECT_EQ(done_nodes.size(), dependencies.num_nodes());
+    EXPECT_EQ(std::set<int>(done_nodes.begin(), done_nodes.end()).size(),
+              dependencies.num_nodes());
+    for (bool ran_after : ran_after_predecessors) EXPECT_TRUE(ran_after);
+  }
+}
+
+TEST(ParallelNodeExecutorTest, RunsIndependentNodesAtTheSameTime) {
+  TestGraphInfo graph(3, {{{0}, {1}}, {{0}, {2}}});
+  NodeDependencies dependencies(&graph);
+  ParallelNodeExecutor executor(2);
+  // Each node waits for the other one to start.
+  std::atomic<int> num_started(0);
+  auto run_node = [&](int node) {
+    ++num_started;
+    const auto deadline =
+        std::chrono::steady_clock::now() + std::chrono::seconds(10);
+    while (num_started < 2) {
+      if (std::chrono::steady_clock::now() > deadline) return kTfLiteError;
+      std::this_thread::yield();
+    }
+    return kTfLiteOk;
+  };
+  EXPECT_EQ(executor.Run(dependencies, run_node, nullptr), kTfLiteOk);
+}
+
+TEST(ParallelNodeExecutorTest, StopsAfterFailure) {
+  TestGraphInfo graph = CreateBranches();
+  NodeDependencies dependencies(&graph);
+  ParallelNodeExecutor executor(3);
+  std::atomic<bool> ran_successor(false);
+  auto run_node = [&](int node) {
+    if (node == 4 || node == 6) ran_successor = true;
+    return node == 2 ? kTfLiteError : kTfLiteOk;
+  };
+  int failed_node = -1;
+  EXPECT_EQ(executor.Run(dependencies, run_node, &failed_node), kTfLiteError);
+  EXPECT_EQ(failed_node, 2);
+  EXPECT_FALSE(ran_successor);
+
+  // The executor can run the nodes again.
+  auto succeed = [](int node) { return kTfLiteOk; };
+  EXPECT_EQ(executor.Run(dependencies, succeed, &failed_node), kTfLiteOk);
+}
+
+TEST(ParallelNodeExecutorTest, WorkerCpuBackendContexts) {
+  TestGraphInfo graph(5, {
+                             {{0}, {1}},
+                             {{0}, {2}},
+                             {{0}, {3}},
+                             {{0}, {4}},
+                         });
+  NodeDependencies dependencies(&graph);
+  ParallelNodeExecutor executor(4);
+  EXPECT_EQ(ParallelNodeExecutor::WorkerCpuBackendContext(), nullptr);
+  const std::thread::id main_thread = std::this_thread::get_id();
+  std::mutex mutex;
+  std::set<TfLiteExternalContext*> contexts;
+  auto run_node = [&](int node) {
+    std::lock_guard<std::mutex> lock(mutex);
+    TfLiteExternalContext* context =
+        ParallelNodeExecutor::WorkerCpuBackendContext();
+    if (std::this_thread::get_id() == main_thread) {
+      return context == nullptr ? kTfLiteOk : kTfLiteError;
+    }
+    if (context == nullptr || context->type != kTfLiteCpuBackendContext) {
+      return kTfLiteError;
+    }
+    contexts.insert(context);
+    return kTfLiteOk;
+  };
+  for (int run = 0; run < 10; ++run) {
+    EXPECT_EQ(executor.Run(dependencies, run_node, nullptr), kTfLiteOk);
+  }
+  EXPECT_LE(contexts.size(), 3);
+}
+
+}  // namespace
+}  // namespace tflite
@@ -0,0 +1,138 @@
+/* Copyright 2022 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/lite/pipeline_executor.h"
+
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>  // NOLINT(build/c++11)
+#include <utility>
+#include <vector>
+
+#include "tensorflow/lite/c/common.h"
+#include "tensorflow/lite/external_cpu_backend_context.h"
+
+namespace tflite {
+namespace {
+
+thread_local ExternalCpuBackendContext* stage_cpu_backend_context = nullptr;
+
+}  // namespace
+
+PipelineExecutor::PipelineExecutor(int num_stages, int depth,
+                                   int last_input_stage,
+                                   const std::vector<bool>& output_stages,
+                                   RunStageFn run_stage)
+    : depth_(depth),
+      last_input_stage_(last_input_stage),
+      run_stage_(std::move(run_stage)),
+      stages_(num_stages),
+      statuses_(depth, kTfLiteOk),
+      failed_stages_(depth, -1) {
+  for (int i = 0; i < num_stages; ++i) {
+    stages_[i].cpu_backend_context =
+        std::make_unique<ExternalCpuBackendContext>();
+    stages_[i].waits_for_caller = i < output_stages.size() && output_stages[i];
+  }
+  for (int i = 0; i < num_stages; ++i) {
+    stages_[i].thread = std::thread(&PipelineExecutor::StageLoop, this, i);
+  }
+}
+
+PipelineExecutor::~PipelineExecutor() {
+  {
+    std::lock_guard<std::mutex> lock(mu_);
+    exiting_ = true;
+    num_released_ = num_started_;
+  }
+  cv_.notify_all();
+  for (Stage& stage : stages_) stage.thread.join();
+}
+
+TfLiteExternalContext* PipelineExecutor::StageCpuBackendContext() {
+  return stage_cpu_backend_context;
+}
+
+TfLiteStatus PipelineExecutor::Start(const std::function<void(int slot)>& start,
+                                     int64_t* handle) {
+  if (num_in_flight() >= depth_) return kTfLiteError;
+  const int64_t invocation = num_started_;
+  const int slot = invocation % depth_;
+  start(slot);
+  std::unique_lock<std::mutex> lock(mu_);
+  statuses_[slot] = kTfLiteOk;
+  failed_stages_[slot] = -1;
+  ++num_started_;
+  cv_.notify_all();
+  if (last_input_stage_ >= 0) {
+    cv_.wait(lock, [&]() {
+      return stages_[last_input_stage_].num_done > invocation;
+    });
+  }
+  *handle = invocation;
+  return kTfLiteOk;
+}
+
+TfLiteStatus PipelineExecutor::Wait(int64_t handle,
+                                    const std::function<void(int slot)>& done,
+                                    int* failed_stage) {
+  if (handle != num_waited_ || handle >= num_started_) return kTfLiteError;
+  const int slot = handle % depth_;
+  TfLiteStatus status;
+  {
+    std::unique_lock<std::mutex> lock(mu_);
+    num_released_ = handle + 1;
+    cv_.notify_all();
+    cv_.wait(lock, [&]() { return stages_.back().num_done > handle; });
+    status = statuses_[slot];
+    if (failed_stage != nullptr) *failed_stage = failed_stages_[slot];
+  }
+  done(slot);
+  std::lock_guard<std::mutex> lock(mu_);
+  ++num_waited_;
+  return status;
+}
+
+void PipelineExecutor::StageLoop(int stage_index) {
+  Stage& stage = stages_[stage_index];
+  stage_cpu_backend_context = stage.cpu_backend_context.get();
+  std::unique_lock<std::mutex> lock(mu_);
+  while (true) {
+    const int64_t invocation = stage.num_done;
+    cv_.wait(lock, [&]() {
+      return (exiting_ && invocation >= num_started_) ||
+             (invocation < num_started_ &&
+              (stage_index == 0 ||
+               stages_[stage_index - 1].num_done > invocation) &&
+              (!stage.waits_for_caller || invocation < num_released_));
+    });
+    if (invocation >= num_started_) return;
+    const int slot = invocation % depth_;
+    if (statuses_[slot] == kTfLiteOk) {
+      lock.unlock();
+      const TfLiteStatus status = run_stage_(stage_index, slot);
+      lock.lock();
+      if (status != kTfLiteOk) {
+        statuses_[slot] = status;
+        failed_stages_[slot] = stage_index;
+      }
+    }
+    ++stage.num_done;
+    cv_.notify_all();
+  }
+}
+
+}  // namespace tflite
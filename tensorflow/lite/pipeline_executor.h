@@ -0,0 +1,113 @@
+/* Copyright 2022 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_LITE_PIPELINE_EXECUTOR_H_
+#define TENSORFLOW_LITE_PIPELINE_EXECUTOR_H_
+
+#include <condition_variable>  // NOLINT(build/c++11)
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>  // NOLINT(build/c++11)
+#include <thread>  // NOLINT(build/c++11)
+#include <vector>
+
+#include "tensorflow/lite/c/common.h"
+#include "tensorflow/lite/external_cpu_backend_context.h"
+
+namespace tflite {
+
+// Runs invocations through a pipeline of stages, each on its own thread, so
+// that a stage works on an invocation while the next stages work on earlier
+// ones. Every stage runs the invocations in order, and an invocation runs a
+// stage once it ran the previous one. Up to `depth` invocations are in flight
+// between Start() and Wait(), each with a slot in [0, depth) that it keeps
+// until it is waited for.
+//
+// Start() returns once stage `last_input_stage` ran the invocation, so that
+// the caller can reuse what the stages up to it read. The stages in
+// `output_stages` only run an invocation once the caller waits for it, so
+// that they don't overwrite what the caller reads after waiting for the
+// previous invocation.
+//
+// Each stage thread has its own kTfLiteCpuBackendContext, which
+// StageCpuBackendContext() returns, since the CPU backend context isn't thread
+// safe. Start() and Wait() must be called from one thread at a time.
+class PipelineExecutor {
+ public:
+  // Runs `stage` for the invocation in `slot`.
+  typedef std::function<TfLiteStatus(int stage, int slot)> RunStageFn;
+
+  PipelineExecutor(int num_stages, int depth, int last_input_stage,
+                   const std::vector<bool>& output_stages,
+                   RunStageFn run_stage);
+  // Finishes the invocations in flight.
+  ~PipelineExecutor();
+  PipelineExecutor(const PipelineExecutor&) = delete;
+  PipelineExecutor& operator=(const PipelineExecutor&) = delete;
+
+  int num_stages() const { return stages_.size(); }
+  int depth() const { return depth_; }
+
+  // Returns the number of invocations that weren't waited for.
+  int num_in_flight() const { return num_started_ - num_waited_; }
+
+  // Calls `start(slot)` and starts an invocation in the slot, whose handle is
+  // stored in `handle`. Fails if `depth` invocations are in flight.
+  TfLiteStatus Start(const std::function<void(int slot)>& start,
+                     int64_t* handle);
+
+  // Waits for the invocation of `handle`, which must be the first one in
+  // flight, and calls `done(slot)` before the slot is reused. Returns the error
+  // of the first stage that failed, after which the invocation skipped the
+  // later stages, in `failed_stage` if it isn't null.
+  TfLiteStatus Wait(int64_t handle, const std::function<void(int slot)>& done,
+                    int* failed_stage);
+
+  // Returns the kTfLiteCpuBackendContext of the calling thread if it is a
+  // stage thread of an executor, or nullptr.
+  static TfLiteExternalContext* StageCpuBackendContext();
+
+ private:
+  struct Stage {
+    std::unique_ptr<ExternalCpuBackendContext> cpu_backend_context;
+    bool waits_for_caller = false;
+    // The number of invocations the stage ran.
+    int64_t num_done = 0;
+    std::thread thread;
+  };
+
+  void StageLoop(int stage);
+
+  const int depth_;
+  const int last_input_stage_;
+  const RunStageFn run_stage_;
+  std::vector<Stage> stages_;
+
+  std::mutex mu_;
+  std::condition_variable cv_;
+  bool exiting_ = false;
+  int64_t num_started_ = 0;
+  int64_t num_waited_ = 0;
+  // The number of invocations that the stages in `output_stages` may run.
+  int64_t num_released_ = 0;
+  // The status and the failed stage of the invocation in each slot.
+  std::vector<TfLiteStatus> statuses_;
+  std::vector<int> failed_stages_;
+};
+
+}  // namespace tflite
+
+#endif  // TENSORFLOW_LITE_PIPELINE_EXECUTOR_H_
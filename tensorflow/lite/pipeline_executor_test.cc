@@ -0,0 +1,177 @@
+/* Copyright 2022 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/lite/pipeline_executor.h"
+
+#include <atomic>
+#include <cstdint>
+#include <mutex>  // NOLINT(build/c++11)
+#include <set>
+#include <thread>  // NOLINT(build/c++11)
+#include <utility>
+#include <vector>
+
+#include <gtest/gtest.h>
+#include "tensorflow/lite/c/common.h"
+
+namespace tflite {
+namespace {
+
+// Records the stages that ran, in order.
+class StageLog {
+ public:
+  PipelineExecutor::RunStageFn RunStage() {
+    return [this](int stage, int slot) {
+      std::lock_guard<std::mutex> lock(mu_);
+      log_.emplace_back(stage, slot);
+      return kTfLiteOk;
+    };
+  }
+
+  std::vector<std::pair<int, int>> log() {
+    std::lock_guard<std::mutex> lock(mu_);
+    return log_;
+  }
+
+ private:
+  std::mutex mu_;
+  std::vector<std::pair<int, int>> log_;
+};
+
+TEST(PipelineExecutorTest, RunsStagesInOrder) {
+  StageLog log;
+  PipelineExecutor executor(3, 2, -1, {}, log.RunStage());
+  std::vector<int> started_slots;
+  int64_t handle;
+  ASSERT_EQ(executor.Start([&](int slot) { started_slots.push_back(slot); },
+                           &handle),
+            kTfLiteOk);
+  EXPECT_EQ(handle, 0);
+  std::vector<int> done_slots;
+  EXPECT_EQ(executor.Wait(
+                handle, [&](int slot) { done_slots.push_back(slot); }, nullptr),
+            kTfLiteOk);
+  EXPECT_EQ(log.log(),
+            (std::vector<std::pair<int, int>>{{0, 0}, {1, 0}, {2, 0}}));
+  EXPECT_EQ(started_slots, std::vector<int>{0});
+  EXPECT_EQ(done_slots, std::vector<int>{0});
+  EXPECT_EQ(executor.num_in_flight(), 0);
+}
+
+TEST(PipelineExecutorTest, OverlapsInvocations) {
+  // The second stage of the first invocation only finishes once the first
+  // stage ran the second invocation.
+  std::atomic<bool> second_started(false);
+  PipelineExecutor executor(2, 2, -1, {}, [&](int stage, int slot) {
+    if (stage == 0 && slot == 1) second_started = true;
+    if (stage == 1 && slot == 0) {
+      while (!second_started) std::this_thread::yield();
+    }
+    return kTfLiteOk;
+  });
+  int64_t first, second;
+  ASSERT_EQ(executor.Start([](int) {}, &first), kTfLiteOk);
+  ASSERT_EQ(executor.Start([](int) {}, &second), kTfLiteOk);
+  EXPECT_EQ(executor.num_in_flight(), 2);
+  // The slots are in use.
+  int64_t third;
+  EXPECT_EQ(executor.Start([](int) {}, &third), kTfLiteError);
+  // The invocations are waited for in order.
+  EXPECT_EQ(executor.Wait(second, [](int) {}, nullptr), kTfLiteError);
+  EXPECT_EQ(executor.Wait(first, [](int) {}, nullptr), kTfLiteOk);
+  EXPECT_EQ(executor.Wait(second, [](int) {}, nullptr), kTfLiteOk);
+}
+
+TEST(PipelineExecutorTest, StartWaitsForInputStage) {
+  std::atomic<int> num_input_stage_runs(0);
+  PipelineExecutor executor(3, 2, 1, {}, [&](int stage, int slot) {
+    if (stage == 1) ++num_input_stage_runs;
+    return kTfLiteOk;
+  });
+  int64_t handle;
+  ASSERT_EQ(executor.Start([](int) {}, &handle), kTfLiteOk);
+  EXPECT_EQ(num_input_stage_runs, 1);
+  EXPECT_EQ(executor.Wait(handle, [](int) {}, nullptr), kTfLiteOk);
+}
+
+TEST(PipelineExecutorTest, OutputStageWaitsForCaller) {
+  std::atomic<int> num_output_stage_runs(0);
+  PipelineExecutor executor(2, 2, 0, {false, true}, [&](int stage, int slot) {
+    if (stage == 1) ++num_output_stage_runs;
+    return kTfLiteOk;
+  });
+  int64_t first, second;
+  ASSERT_EQ(executor.Start([](int) {}, &first), kTfLiteOk);
+  ASSERT_EQ(executor.Start([](int) {}, &second), kTfLiteOk);
+  EXPECT_EQ(num_output_stage_runs, 0);
+  EXPECT_EQ(executor.Wait(first, [](int) {}, nullptr), kTfLiteOk);
+  // The caller may still read what the first invocation wrote.
+  EXPECT_EQ(num_output_stage_runs, 1);
+  EXPECT_EQ(executor.Wait(second, [](int) {}, nullptr), kTfLiteOk);
+  EXPECT_EQ(num_output_stage_runs, 2);
+}
+
+TEST(PipelineExecutorTest, FailedStageSkipsLaterStages) {
+  StageLog log;
+  auto run_stage = log.RunStage();
+  PipelineExecutor executor(3, 2, -1, {}, [&](int stage, int slot) {
+    run_stage(stage, slot);
+    return stage == 1 && slot == 0 ? kTfLiteError : kTfLiteOk;
+  });
+  int64_t first, second;
+  ASSERT_EQ(executor.Start([](int) {}, &first), kTfLiteOk);
+  int failed_stage = -1;
+  EXPECT_EQ(executor.Wait(first, [](int) {}, &failed_stage), kTfLiteError);
+  EXPECT_EQ(failed_stage, 1);
+  EXPECT_EQ(log.log(), (std::vector<std::pair<int, int>>{{0, 0}, {1, 0}}));
+  // The next invocation runs all the stages.
+  ASSERT_EQ(executor.Start([](int) {}, &second), kTfLiteOk);
+  EXPECT_EQ(executor.Wait(second, [](int) {}, &failed_stage), kTfLiteOk);
+  EXPECT_EQ(failed_stage, -1);
+  EXPECT_EQ(log.log().size(), 5);
+}
+
+TEST(PipelineExecutorTest, StagesHaveTheirOwnCpuBackendContexts) {
+  std::mutex mu;
+  std::set<TfLiteExternalContext*> contexts;
+  PipelineExecutor executor(3, 1, -1, {}, [&](int stage, int slot) {
+    std::lock_guard<std::mutex> lock(mu);
+    contexts.insert(PipelineExecutor::StageCpuBackendContext());
+    return kTfLiteOk;
+  });
+  int64_t handle;
+  ASSERT_EQ(executor.Start([](int) {}, &handle), kTfLiteOk);
+  EXPECT_EQ(executor.Wait(handle, [](int) {}, nullptr), kTfLiteOk);
+  EXPECT_EQ(contexts.size(), 3);
+  EXPECT_EQ(contexts.count(nullptr), 0);
+  EXPECT_EQ(PipelineExecutor::StageCpuBackendContext(), nullptr);
+}
+
+TEST(PipelineExecutorTest, DestructorFinishesInvocations) {
+  std::atomic<int> num_runs(0);
+  {
+    PipelineExecutor executor(2, 2, -1, {false, true}, [&](int, int) {
+      ++num_runs;
+      return kTfLiteOk;
+    });
+    int64_t handle;
+    ASSERT_EQ(executor.Start([](int) {}, &handle), kTfLiteOk);
+    ASSERT_EQ(executor.Start([](int) {}, &handle), kTfLiteOk);
+  }
+  EXPECT_EQ(num_runs, 4);
+}
+
+}  // namespace
+}  // namespace tflite
@@ -0,0 +1,197 @@
+/* Copyright 2022 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/lite/pipeline_plan.h"
+
+#include <algorithm>
+#include <map>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "tensorflow/lite/c/common.h"
+
+namespace tflite {
+namespace {
+
+constexpr int kNoNode = -1;
+
+// The node that uses a private tensor, and whether it writes it.
+struct PrivateUse {
+  int node = kNoNode;
+  bool is_output = false;
+};
+
+}  // namespace
+
+PipelinePlan::PipelinePlan(
+    GraphInfo* graph_info,
+    const std::unordered_map<int, int>& private_tensors)
+    : num_nodes_(graph_info->num_execution_nodes()) {
+  const int num_tensors = graph_info->num_tensors();
+  fetches_.resize(num_nodes_);
+  publishes_.resize(num_nodes_);
+  ordered_copies_before_.resize(num_nodes_);
+  ordered_copies_after_.resize(num_nodes_);
+
+  // Whether nodes of different stages could overwrite each other's values of
+  // `tensor` if they shared it.
+  auto is_shared = [&](int tensor) {
+    if (tensor == kTfLiteOptionalTensor || private_tensors.count(tensor)) {
+      return false;
+    }
+    const TfLiteAllocationType allocation_type =
+        graph_info->tensor(tensor)->allocation_type;
+    return allocation_type != kTfLiteMmapRo &&
+           allocation_type != kTfLitePersistentRo;
+  };
+
+  // The first and last nodes that use each tensor in place, its writer, and
+  // the uses of the private tensors.
+  std::vector<int> first_use(num_tensors, kNoNode);
+  std::vector<int> last_use(num_tensors, kNoNode);
+  std::vector<int> writer(num_tensors, kNoNode);
+  std::unordered_map<int, PrivateUse> private_uses;
+  for (int i = 0; i < num_nodes_; ++i) {
+    const TfLiteNode& node = graph_info->node(i);
+    for (const TfLiteIntArray* tensors : {node.inputs, node.outputs}) {
+      const bool is_output = tensors == node.outputs;
+      for (int j = 0; j < tensors->size; ++j) {
+        const int tensor = tensors->data[j];
+        if (private_tensors.count(tensor)) {
+          private_uses[tensor] = {i, is_output};
+        }
+        if (!is_shared(tensor)) continue;
+        if (first_use[tensor] == kNoNode) first_use[tensor] = i;
+        last_use[tensor] = i;
+        if (is_output) writer[tensor] = i;
+      }
+    }
+  }
+
+  // Number of tensors used in place on both sides of the start of each node.
+  std::vector<int> num_spanning_tensors(num_nodes_ + 1, 0);
+  for (int tensor = 0; tensor < num_tensors; ++tensor) {
+    if (first_use[tensor] == kNoNode) continue;
+    ++num_spanning_tensors[first_use[tensor] + 1];
+    --num_spanning_tensors[last_use[tensor] + 1];
+  }
+  stage_begins_.push_back(0);
+  int spanning = num_spanning_tensors[0];
+  for (int i = 1; i < num_nodes_; ++i) {
+    spanning += num_spanning_tensors[i];
+    if (spanning == 0 &&
+        graph_info->node(i).delegate != graph_info->node(i - 1).delegate) {
+      stage_begins_.push_back(i);
+    }
+  }
+  std::vector<int> node_stages(num_nodes_);
+  auto assign_stages = [&]() {
+    for (int stage = 0; stage < num_stages(); ++stage) {
+      for (int i = stage_begin(stage); i < stage_end(stage); ++i) {
+        node_stages[i] = stage;
+      }
+    }
+  };
+  assign_stages();
+
+  std::vector<bool> is_input(num_tensors, false);
+  std::vector<bool> is_output(num_tensors, false);
+  for (int tensor : graph_info->inputs()) {
+    if (tensor != kTfLiteOptionalTensor) is_input[tensor] = true;
+  }
+  for (int tensor : graph_info->outputs()) {
+    if (tensor != kTfLiteOptionalTensor) is_output[tensor] = true;
+  }
+  auto assign_io_stages = [&]() {
+    last_input_stage_ = -1;
+    writes_outputs_.assign(num_stages(), false);
+    for (int tensor = 0; tensor < num_tensors; ++tensor) {
+      if (first_use[tensor] == kNoNode) continue;
+      // All the uses in place are in the same stage.
+      const int stage = node_stages[first_use[tensor]];
+      if (is_input[tensor]) {
+        last_input_stage_ = std::max(last_input_stage_, stage);
+      }
+      if (is_output[tensor]) writes_outputs_[stage] = true;
+    }
+  };
+  assign_io_stages();
+  for (int stage = 0; stage <= last_input_stage_; ++stage) {
+    if (writes_outputs_[stage]) {
+      // The stage would wait for the caller to be done with the outputs of the
+      // previous invocation, while the caller waits for the stage to be done
+      // with the inputs.
+      stage_begins_.resize(1);
+      assign_stages();
+      assign_io_stages();
+      break;
+    }
+  }
+
+  // The private tensors of each tensor, in order.
+  std::map<int, std::vector<int>> privates_of;
+  for (const auto& private_and_original : private_tensors) {
+    if (private_uses[private_and_original.first].node == kNoNode) continue;
+    privates_of[private_and_original.second].push_back(
+        private_and_original.first);
+  }
+  for (auto& original_and_privates : privates_of) {
+    const int tensor = original_and_privates.first;
+    std::vector<int>& privates = original_and_privates.second;
+    std::sort(privates.begin(), privates.end());
+    int private_writer = -1;
+    for (int private_tensor : privates) {
+      if (private_uses[private_tensor].is_output) {
+        private_writer = private_tensor;
+      }
+    }
+    if (!is_input[tensor] && private_writer < 0 && writer[tensor] == kNoNode) {
+      // Nothing writes the tensor.
+      continue;
+    }
+
+    const int buffer = buffer_tensors_.size();
+    buffer_tensors_.push_back(tensor);
+    if (is_input[tensor]) {
+      input_publishes_.push_back({buffer, tensor});
+    } else if (private_writer >= 0) {
+      publishes_[private_uses[private_writer].node].push_back(
+          {buffer, private_writer});
+    } else {
+      publishes_[writer[tensor]].push_back({buffer, tensor});
+    }
+    const int source = private_writer >= 0 ? private_writer : tensor;
+    for (int private_tensor : privates) {
+      if (private_tensor == private_writer) continue;
+      const int node = private_uses[private_tensor].node;
+      fetches_[node].push_back({buffer, private_tensor});
+      ordered_copies_before_[node].push_back({source, private_tensor});
+    }
+    if (private_writer >= 0) {
+      if (first_use[tensor] != kNoNode) {
+        fetches_[first_use[tensor]].push_back({buffer, tensor});
+      } else if (is_output[tensor]) {
+        output_fetches_.push_back({buffer, tensor});
+      }
+      if (first_use[tensor] != kNoNode || is_output[tensor]) {
+        ordered_copies_after_[private_uses[private_writer].node].push_back(
+            {private_writer, tensor});
+      }
+    }
+  }
+}
+
+}  // namespace tflite
@@ -0,0 +1,113 @@
+/* Copyright 2022 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_LITE_PIPELINE_PLAN_H_
+#define TENSORFLOW_LITE_PIPELINE_PLAN_H_
+
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "tensorflow/lite/graph_info.h"
+
+namespace tflite {
+
+// How the nodes of an execution plan run as a pipeline, in which consecutive
+// runs of nodes, the stages, work on different invocations at the same time.
+// Nodes are identified by their index in the execution plan.
+//
+// Delegate kernels don't share tensors with other nodes or with the caller:
+// they use private copies of the tensors at the boundary of their partition,
+// in `private_tensors`, which maps each private tensor to the tensor it stands
+// for. The values of these tensors move between stages through buffers that
+// have a slot for each invocation in flight: a node publishes the value into
+// the slot of its invocation after it runs, and the nodes that use the value
+// fetch it before they run.
+//
+// Stages start where the execution plan switches between the nodes of a
+// delegate and other nodes, except where a tensor that isn't private and isn't
+// read-only is used in place on both sides, like a tensor that several CPU
+// partitions use. Graph inputs that a stage reads in place can only be
+// overwritten once the stage is done with them, and graph outputs that a stage
+// writes in place only once the outputs of the previous invocation are no
+// longer needed. If a stage that writes outputs in place comes before the last
+// stage that reads inputs in place, the plan has a single stage.
+class PipelinePlan {
+ public:
+  // A copy between `tensor` and a slot of `buffer`.
+  struct Copy {
+    int buffer;
+    int tensor;
+  };
+
+  PipelinePlan(GraphInfo* graph_info,
+               const std::unordered_map<int, int>& private_tensors);
+
+  int num_stages() const { return stage_begins_.size(); }
+
+  // The nodes of `stage` are those from stage_begin(stage) up to
+  // stage_begin(stage + 1), or the end of the execution plan.
+  int stage_begin(int stage) const { return stage_begins_[stage]; }
+  int stage_end(int stage) const {
+    return stage + 1 < num_stages() ? stage_begins_[stage + 1] : num_nodes_;
+  }
+
+  // Returns the tensor whose values each buffer holds.
+  const std::vector<int>& buffer_tensors() const { return buffer_tensors_; }
+
+  // Returns the copies into tensors before `node` runs.
+  const std::vector<Copy>& fetches(int node) const { return fetches_[node]; }
+  // Returns the copies out of tensors after `node` runs.
+  const std::vector<Copy>& publishes(int node) const {
+    return publishes_[node];
+  }
+  // Returns the copies out of graph inputs when an invocation starts.
+  const std::vector<Copy>& input_publishes() const { return input_publishes_; }
+  // Returns the copies into graph outputs once an invocation is done.
+  const std::vector<Copy>& output_fetches() const { return output_fetches_; }
+
+  // Returns the last stage that reads graph inputs in place, or -1.
+  int last_input_stage() const { return last_input_stage_; }
+  // Returns whether `stage` writes graph outputs in place.
+  bool writes_outputs(int stage) const { return writes_outputs_[stage]; }
+
+  // Returns the copies from the first to the second tensor before and after
+  // `node` runs, when the nodes run in order and one invocation at a time.
+  const std::vector<std::pair<int, int>>& ordered_copies_before(
+      int node) const {
+    return ordered_copies_before_[node];
+  }
+  const std::vector<std::pair<int, int>>& ordered_copies_after(
+      int node) const {
+    return ordered_copies_after_[node];
+  }
+
+ private:
+  int num_nodes_;
+  std::vector<int> stage_begins_;
+  std::vector<int> buffer_tensors_;
+  std::vector<std::vector<Copy>> fetches_;
+  std::vector<std::vector<Copy>> publishes_;
+  std::vector<Copy> input_publishes_;
+  std::vector<Copy> output_fetches_;
+  int last_input_stage_ = -1;
+  std::vector<bool> writes_outputs_;
+  std::vector<std::vector<std::pair<int, int>>> ordered_copies_before_;
+  std::vector<std::vector<std::pair<int, int>>> ordered_copies_after_;
+};
+
+}  // namespace tflite
+
+#endif  // TENSORFLOW_LITE_PIPELINE_PLAN_H_
@@ -0,0 +1,191 @@
+/* Copyright 2022 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/lite/pipeline_plan.h"
+
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+#include "tensorflow/lite/c/common.h"
+#include "tensorflow/lite/graph_info.h"
+
+namespace tflite {
+namespace {
+
+using ::testing::ElementsAre;
+using ::testing::IsEmpty;
+using ::testing::Pair;
+
+// A graph of nodes with the given inputs and outputs, which run on `delegate`
+// if the third list of the node isn't empty.
+class TestGraphInfo : public GraphInfo {
+ public:
+  TestGraphInfo(int num_tensors,
+                const std::vector<std::vector<std::vector<int>>>& nodes,
+                const std::vector<int>& inputs, const std::vector<int>& outputs)
+      : tensors_(num_tensors), inputs_(inputs), outputs_(outputs) {
+    for (TfLiteTensor& tensor : tensors_) {
+      tensor.allocation_type = kTfLiteArenaRw;
+    }
+    for (const auto& node : nodes) {
+      nodes_.emplace_back();
+      nodes_.back().inputs = CreateArray(node[0]);
+      nodes_.back().outputs = CreateArray(node[1]);
+      if (node.size() > 2) nodes_.back().delegate = &delegate_;
+    }
+  }
+  ~TestGraphInfo() override {
+    for (TfLiteNode& node : nodes_) {
+      TfLiteIntArrayFree(node.inputs);
+      TfLiteIntArrayFree(node.outputs);
+    }
+  }
+
+  size_t num_tensors() const override { return tensors_.size(); }
+  TfLiteTensor* tensor(size_t index) override { return &tensors_[index]; }
+  size_t num_execution_nodes() const override { return nodes_.size(); }
+  size_t num_total_nodes() const override { return nodes_.size(); }
+  const TfLiteNode& node(size_t index) const override { return nodes_[index]; }
+  size_t node_index(size_t index) const override { return index; }
+  const std::vector<int>& inputs() const override { return inputs_; }
+  const std::vector<int>& outputs() const override { return outputs_; }
+  const std::vector<int>& variables() const override { return empty_; }
+
+ private:
+  static TfLiteIntArray* CreateArray(const std::vector<int>& values) {
+    TfLiteIntArray* array = TfLiteIntArrayCreate(values.size());
+    for (size_t i = 0; i < values.size(); ++i) array->data[i] = values[i];
+    return array;
+  }
+
+  TfLiteDelegate delegate_;
+  std::vector<TfLiteTensor> tensors_;
+  std::vector<TfLiteNode> nodes_;
+  std::vector<int> inputs_;
+  std::vector<int> outputs_;
+  std::vector<int> empty_;
+};
+
+MATCHER_P2(IsCopy, buffer, tensor, "") {
+  return arg.buffer == buffer && arg.tensor == tensor;
+}
+
+TEST(PipelinePlanTest, CpuDelegateCpu) {
+  // The delegate kernel uses 5 and 6 in place of 1 and 2.
+  TestGraphInfo graph(7,
+                      {
+                          {{0}, {1}},
+                          {{5}, {6}, {true}},
+                          {{2}, {3}},
+                      },
+                      /*inputs=*/{0}, /*outputs=*/{3});
+  PipelinePlan plan(&graph, {{5, 1}, {6, 2}});
+  ASSERT_EQ(plan.num_stages(), 3);
+  EXPECT_EQ(plan.stage_begin(1), 1);
+  EXPECT_EQ(plan.stage_end(1), 2);
+  EXPECT_EQ(plan.stage_end(2), 3);
+  EXPECT_THAT(plan.buffer_tensors(), ElementsAre(1, 2));
+  EXPECT_THAT(plan.fetches(0), IsEmpty());
+  EXPECT_THAT(plan.publishes(0), ElementsAre(IsCopy(0, 1)));
+  EXPECT_THAT(plan.fetches(1), ElementsAre(IsCopy(0, 5)));
+  EXPECT_THAT(plan.publishes(1), ElementsAre(IsCopy(1, 6)));
+  EXPECT_THAT(plan.fetches(2), ElementsAre(IsCopy(1, 2)));
+  EXPECT_THAT(plan.publishes(2), IsEmpty());
+  EXPECT_THAT(plan.input_publishes(), IsEmpty());
+  EXPECT_THAT(plan.output_fetches(), IsEmpty());
+  EXPECT_EQ(plan.last_input_stage(), 0);
+  EXPECT_FALSE(plan.writes_outputs(0));
+  EXPECT_FALSE(plan.writes_outputs(1));
+  EXPECT_TRUE(plan.writes_outputs(2));
+  EXPECT_THAT(plan.ordered_copies_before(1), ElementsAre(Pair(1, 5)));
+  EXPECT_THAT(plan.ordered_copies_after(1), ElementsAre(Pair(6, 2)));
+  EXPECT_THAT(plan.ordered_copies_before(2), IsEmpty());
+}
+
+TEST(PipelinePlanTest, DelegateInputsAndOutputs) {
+  // The delegate kernels use 3, 4, 5 and 6 in place of 0, 1, 1 and 2.
+  TestGraphInfo graph(7,
+                      {
+                          {{3}, {4}, {true}},
+                          {{1}, {1}},
+                          {{5}, {6}, {true}},
+                      },
+                      /*inputs=*/{0}, /*outputs=*/{2});
+  PipelinePlan plan(&graph, {{3, 0}, {4, 1}, {5, 1}, {6, 2}});
+  ASSERT_EQ(plan.num_stages(), 3);
+  EXPECT_THAT(plan.buffer_tensors(), ElementsAre(0, 1, 2));
+  EXPECT_THAT(plan.input_publishes(), ElementsAre(IsCopy(0, 0)));
+  EXPECT_THAT(plan.fetches(0), ElementsAre(IsCopy(0, 3)));
+  EXPECT_THAT(plan.publishes(0), ElementsAre(IsCopy(1, 4)));
+  // The CPU node uses the value of the first delegate kernel in place.
+  EXPECT_THAT(plan.fetches(1), ElementsAre(IsCopy(1, 1)));
+  EXPECT_THAT(plan.fetches(2), ElementsAre(IsCopy(1, 5)));
+  EXPECT_THAT(plan.publishes(2), ElementsAre(IsCopy(2, 6)));
+  EXPECT_THAT(plan.output_fetches(), ElementsAre(IsCopy(2, 2)));
+  EXPECT_EQ(plan.last_input_stage(), -1);
+  EXPECT_FALSE(plan.writes_outputs(2));
+  EXPECT_THAT(plan.ordered_copies_before(2), ElementsAre(Pair(4, 5)));
+  EXPECT_THAT(plan.ordered_copies_after(0), ElementsAre(Pair(4, 1)));
+  EXPECT_THAT(plan.ordered_copies_after(2), ElementsAre(Pair(6, 2)));
+}
+
+TEST(PipelinePlanTest, TensorsUsedByTwoStagesMergeThem) {
+  TestGraphInfo graph(7,
+                      {
+                          {{0}, {1}},
+                          {{5}, {6}, {true}},
+                          {{2}, {3}},
+                          // Uses the output of the first node.
+                          {{1, 3}, {4}},
+                      },
+                      /*inputs=*/{0}, /*outputs=*/{4});
+  PipelinePlan plan(&graph, {{5, 1}, {6, 2}});
+  EXPECT_EQ(plan.num_stages(), 1);
+  EXPECT_EQ(plan.stage_end(0), 4);
+}
+
+TEST(PipelinePlanTest, ReadOnlyTensorsDontMergeStages) {
+  TestGraphInfo graph(6,
+                      {
+                          {{0, 5}, {1}},
+                          {{3}, {4}, {true}},
+                          {{2, 5}, {2}},
+                      },
+                      /*inputs=*/{0}, /*outputs=*/{2});
+  graph.tensor(5)->allocation_type = kTfLiteMmapRo;
+  PipelinePlan plan(&graph, {{3, 1}, {4, 2}});
+  EXPECT_EQ(plan.num_stages(), 3);
+}
+
+TEST(PipelinePlanTest, OutputsWrittenBeforeInputsAreRead) {
+  TestGraphInfo graph(8,
+                      {
+                          {{0}, {1, 7}},
+                          {{5}, {6}, {true}},
+                          // Reads an input after the output is written.
+                          {{2, 3}, {4}},
+                      },
+                      /*inputs=*/{0, 3}, /*outputs=*/{4, 7});
+  PipelinePlan plan(&graph, {{5, 1}, {6, 2}});
+  EXPECT_EQ(plan.num_stages(), 1);
+  EXPECT_EQ(plan.last_input_stage(), 0);
+  EXPECT_TRUE(plan.writes_outputs(0));
+}
+
+}  // namespace
+}  // namespace tflite
@@ -16,9 +16,11 @@ limitations under the License.
 #define TENSORFLOW_LITE_PROFILING_BUFFERED_PROFILER_H_
 
 #include <cstdint>
+#include <memory>
 #include <vector>
 
 #include "tensorflow/lite/core/api/profiler.h"
+#include "tensorflow/lite/profiling/perf_counters.h"
 #include "tensorflow/lite/profiling/profile_buffer.h"
 
 namespace tflite {
@@ -110,6 +112,21 @@ class BufferedProfiler : public tflite::Profiler {
                      event_metadata2);
   }
 
+  // Also records the hardware event counts of each op invocation, see
+  // PerfCounters. Only the calling thread is counted, so this should be called
+  // on the thread that invokes the interpreter. Returns false if the counters
+  // are not supported.
+  bool EnablePerfCounters() {
+    if (!perf_counters_) perf_counters_ = std::make_unique<PerfCounters>();
+    if (!perf_counters_->IsSupported()) {
+      buffer_.SetPerfCounters(nullptr);
+      perf_counters_.reset();
+      return false;
+    }
+    buffer_.SetPerfCounters(perf_counters_.get());
+    return true;
+  }
+
   void StartProfiling() { buffer_.SetEnabled(true); }
   void StopProfiling() { buffer_.SetEnabled(false); }
   void Reset() { buffer_.Reset(); }
@@ -129,6 +146,8 @@ class BufferedProfiler : public tflite::Profiler {
 
  private:
   ProfileBuffer* GetProfileBuffer() { return &buffer_; }
+  // Declared before buffer_, which refers to them.
+  std::unique_ptr<PerfCounters> perf_counters_;
   ProfileBuffer buffer_;
   const uint64_t supported_event_types_;
 };
@@ -0,0 +1,106 @@
+/* Copyright 2022 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/lite/profiling/perf_counters.h"
+
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include <cstring>
+#endif
+
+namespace tflite {
+namespace profiling {
+
+#ifdef __linux__
+namespace {
+
+int OpenCounter(uint64_t config, int group_fd) {
+  perf_event_attr attr;
+  memset(&attr, 0, sizeof(attr));
+  attr.type = PERF_TYPE_HARDWARE;
+  attr.size = sizeof(attr);
+  attr.config = config;
+  attr.exclude_kernel = 1;
+  attr.exclude_hv = 1;
+  attr.read_format = PERF_FORMAT_GROUP;
+  // The group starts disabled and is enabled once all counters are open.
+  attr.disabled = group_fd < 0 ? 1 : 0;
+  return syscall(__NR_perf_event_open, &attr, /*pid=*/0, /*cpu=*/-1, group_fd,
+                 /*flags=*/0);
+}
+
+void CloseCounter(int* fd) {
+  if (*fd >= 0) close(*fd);
+  *fd = -1;
+}
+
+}  // namespace
+
+PerfCounters::PerfCounters() {
+  group_fd_ = OpenCounter(PERF_COUNT_HW_CPU_CYCLES, -1);
+  if (group_fd_ < 0) return;
+  instructions_fd_ = OpenCounter(PERF_COUNT_HW_INSTRUCTIONS, group_fd_);
+  cache_references_fd_ =
+      OpenCounter(PERF_COUNT_HW_CACHE_REFERENCES, group_fd_);
+  cache_misses_fd_ = OpenCounter(PERF_COUNT_HW_CACHE_MISSES, group_fd_);
+  if (instructions_fd_ < 0 || cache_references_fd_ < 0 ||
+      cache_misses_fd_ < 0 ||
+      ioctl(group_fd_, PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP) != 0 ||
+      ioctl(group_fd_, PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP) != 0) {
+    CloseCounter(&cache_misses_fd_);
+    CloseCounter(&cache_references_fd_);
+    CloseCounter(&instructions_fd_);
+    CloseCounter(&group_fd_);
+  }
+}
+
+PerfCounters::~PerfCounters() {
+  CloseCounter(&cache_misses_fd_);
+  CloseCounter(&cache_references_fd_);
+  CloseCounter(&instructions_fd_);
+  CloseCounter(&group_fd_);
+}
+
+bool PerfCounters::Read(PerfCounterValues* values) const {
+  if (group_fd_ < 0) return false;
+  // With PERF_FORMAT_GROUP, the number of counters followed by their values
+  // in the order they were opened.
+  uint64_t buffer[5];
+  if (read(group_fd_, buffer, sizeof(buffer)) != sizeof(buffer) ||
+      buffer[0] != 4) {
+    return false;
+  }
+  values->cycles = buffer[1];
+  values->instructions = buffer[2];
+  values->cache_references = buffer[3];
+  values->cache_misses = buffer[4];
+  return true;
+}
+
+#else
+
+PerfCounters::PerfCounters() {}
+
+PerfCounters::~PerfCounters() {}
+
+bool PerfCounters::Read(PerfCounterValues* values) const { return false; }
+
+#endif
+
+}  // namespace profiling
+}  // namespace tflite
@@ -0,0 +1,85 @@
+/* Copyright 2022 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_LITE_PROFILING_PERF_COUNTERS_H_
+#define TENSORFLOW_LITE_PROFILING_PERF_COUNTERS_H_
+
+#include <cstdint>
+
+namespace tflite {
+namespace profiling {
+
+// Hardware event counts, see PerfCounters.
+struct PerfCounterValues {
+  uint64_t cycles = 0;
+  uint64_t instructions = 0;
+  // Last level cache accesses and misses.
+  uint64_t cache_references = 0;
+  uint64_t cache_misses = 0;
+
+  PerfCounterValues operator+(const PerfCounterValues& other) const {
+    PerfCounterValues res;
+    res.cycles = cycles + other.cycles;
+    res.instructions = instructions + other.instructions;
+    res.cache_references = cache_references + other.cache_references;
+    res.cache_misses = cache_misses + other.cache_misses;
+    return res;
+  }
+
+  PerfCounterValues operator-(const PerfCounterValues& other) const {
+    PerfCounterValues res;
+    res.cycles = cycles - other.cycles;
+    res.instructions = instructions - other.instructions;
+    res.cache_references = cache_references - other.cache_references;
+    res.cache_misses = cache_misses - other.cache_misses;
+    return res;
+  }
+};
+
+// Counts the hardware events of the thread that created it with the
+// perf_event interface of Linux and Android. Only that thread is counted, so
+// the work that kernels delegate to other threads (e.g. the CPU backend
+// threadpool) is missed unless the interpreter runs with a single thread.
+//
+// Opening the counters fails on other platforms, when the kernel doesn't
+// expose them (e.g. in some virtual machines), or when
+// /proc/sys/kernel/perf_event_paranoid forbids them; IsSupported() returns
+// false then.
+class PerfCounters {
+ public:
+  PerfCounters();
+  ~PerfCounters();
+
+  PerfCounters(const PerfCounters&) = delete;
+  PerfCounters& operator=(const PerfCounters&) = delete;
+
+  bool IsSupported() const { return group_fd_ >= 0; }
+
+  // Reads the counts since the counters were opened. Returns false if the
+  // counters are not supported or can't be read.
+  bool Read(PerfCounterValues* values) const;
+
+ private:
+  // The cycle counter, which leads the group of all counters so that they
+  // are read together.
+  int group_fd_ = -1;
+  int instructions_fd_ = -1;
+  int cache_references_fd_ = -1;
+  int cache_misses_fd_ = -1;
+};
+
+}  // namespace profiling
+}  // namespace tflite
+
+#endif  // TENSORFLOW_LITE_PROFILING_PERF_COUNTERS_H_
@@ -0,0 +1,61 @@
+/* Copyright 2022 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/lite/profiling/perf_counters.h"
+
+#include <gtest/gtest.h>
+
+namespace tflite {
+namespace profiling {
+namespace {
+
+TEST(PerfCountersTest, CountsWork) {
+  PerfCounters counters;
+  PerfCounterValues begin;
+  if (!counters.IsSupported()) {
+    EXPECT_FALSE(counters.Read(&begin));
+    GTEST_SKIP() << "Hardware performance counters are not available.";
+  }
+  ASSERT_TRUE(counters.Read(&begin));
+  volatile uint64_t sum = 0;
+  for (int i = 0; i < 1000000; ++i) sum += i;
+  PerfCounterValues end;
+  ASSERT_TRUE(counters.Read(&end));
+  const PerfCounterValues delta = end - begin;
+  EXPECT_GT(delta.cycles, 0);
+  EXPECT_GT(delta.instructions, 1000000);
+  EXPECT_GE(delta.cache_references, delta.cache_misses);
+}
+
+TEST(PerfCounterValuesTest, Arithmetic) {
+  PerfCounterValues a;
+  a.cycles = 10;
+  a.instructions = 20;
+  a.cache_references = 4;
+  a.cache_misses = 1;
+  const PerfCounterValues sum = a + a;
+  EXPECT_EQ(20, sum.cycles);
+  EXPECT_EQ(40, sum.instructions);
+  EXPECT_EQ(8, sum.cache_references);
+  EXPECT_EQ(2, sum.cache_misses);
+  const PerfCounterValues diff = sum - a;
+  EXPECT_EQ(10, diff.cycles);
+  EXPECT_EQ(20, diff.instructions);
+  EXPECT_EQ(4, diff.cache_references);
+  EXPECT_EQ(1, diff.cache_misses);
+}
+
+}  // namespace
+}  // namespace profiling
+}  // namespace tflite
@@ -24,6 +24,7 @@ limitations under the License.
 
 #include "tensorflow/lite/core/api/profiler.h"
 #include "tensorflow/lite/profiling/memory_info.h"
+#include "tensorflow/lite/profiling/perf_counters.h"
 #include "tensorflow/lite/profiling/time.h"
 
 namespace tflite {
@@ -50,6 +51,12 @@ struct ProfileEvent {
   // The memory usage when the event ends.
   memory::MemoryUsage end_mem_usage;
 
+  // The hardware event counts when an OPERATOR_INVOKE_EVENT begins and ends.
+  // Both are zero unless the buffer has perf counters, see
+  // ProfileBuffer::SetPerfCounters.
+  PerfCounterValues begin_counters;
+  PerfCounterValues end_counters;
+
   // The field containing the type of event. This must be one of the event types
   // in EventType.
   EventType event_type;
@@ -73,6 +80,13 @@ class ProfileBuffer {
         event_buffer_(max_num_entries),
         allow_dynamic_expansion_(allow_dynamic_expansion) {}
 
+  // Reads `perf_counters` when OPERATOR_INVOKE_EVENTs begin and end, if not
+  // null. The counters must outlive the buffer or be unset before they are
+  // destroyed.
+  void SetPerfCounters(const PerfCounters* perf_counters) {
+    perf_counters_ = perf_counters;
+  }
+
   // Adds an event to the buffer with begin timestamp set to the current
   // timestamp. Returns a handle to event that can be used to call EndEvent. If
   // buffer is disabled this has no affect.
@@ -82,6 +96,13 @@ class ProfileBuffer {
     if (!enabled_) {
       return kInvalidEventHandle;
     }
+    // The counters are read before the timestamp, so that reading them isn't
+    // part of the elapsed time.
+    PerfCounterValues counters;
+    if (perf_counters_ &&
+        event_type == Profiler::EventType::OPERATOR_INVOKE_EVENT) {
+      perf_counters_->Read(&counters);
+    }
     uint64_t timestamp = time::NowMicros();
     const auto next_index = GetNextEntryIndex();
     if (next_index.second) {
@@ -94,6 +115,8 @@ class ProfileBuffer {
     event_buffer_[index].extra_event_metadata = event_metadata2;
     event_buffer_[index].begin_timestamp_us = timestamp;
     event_buffer_[index].elapsed_time = 0;
+    event_buffer_[index].begin_counters = counters;
+    event_buffer_[index].end_counters = counters;
     if (event_type != Profiler::EventType::OPERATOR_INVOKE_EVENT) {
       event_buffer_[index].begin_mem_usage = memory::GetMemoryUsage();
     }
@@ -126,6 +149,8 @@ class ProfileBuffer {
     if (event_buffer_[event_index].event_type !=
         Profiler::EventType::OPERATOR_INVOKE_EVENT) {
       event_buffer_[event_index].end_mem_usage = memory::GetMemoryUsage();
+    } else if (perf_counters_) {
+      perf_counters_->Read(&event_buffer_[event_index].end_counters);
     }
     if (event_metadata1) {
       event_buffer_[event_index].event_metadata = *event_metadata1;
@@ -152,6 +177,8 @@ class ProfileBuffer {
     event_buffer_[index].extra_event_metadata = event_metadata2;
     event_buffer_[index].begin_timestamp_us = 0;
     event_buffer_[index].elapsed_time = elapsed_time;
+    event_buffer_[index].begin_counters = PerfCounterValues();
+    event_buffer_[index].end_counters = PerfCounterValues();
     current_index_++;
   }
 
@@ -206,6 +233,7 @@ class ProfileBuffer {
   uint32_t current_index_;
   std::vector<ProfileEvent> event_buffer_;
   const bool allow_dynamic_expansion_;
+  const PerfCounters* perf_counters_ = nullptr;
 };
 
 }  // namespace profiling
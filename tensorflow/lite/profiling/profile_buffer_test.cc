@@ -21,6 +21,7 @@ limitations under the License.
 
 #include <gmock/gmock.h>
 #include <gtest/gtest.h>
+#include "tensorflow/lite/profiling/perf_counters.h"
 
 namespace tflite {
 namespace profiling {
@@ -138,6 +139,33 @@ TEST(ProfileBufferTest, Enable) {
   EXPECT_EQ(1, buffer.Size());
 }
 
+TEST(ProfileBufferTest, PerfCounters) {
+  PerfCounters counters;
+  if (!counters.IsSupported()) {
+    GTEST_SKIP() << "Hardware performance counters are not available.";
+  }
+  ProfileBuffer buffer(/*max_size*/ 10, /*enabled*/ true);
+  buffer.SetPerfCounters(&counters);
+  auto op_handle = buffer.BeginEvent(
+      "op", ProfileEvent::EventType::OPERATOR_INVOKE_EVENT,
+      /*event_metadata1*/ 0, /*event_metadata2*/ 0);
+  volatile int sum = 0;
+  for (int i = 0; i < 10000; ++i) sum += i;
+  buffer.EndEvent(op_handle);
+  auto other_handle =
+      buffer.BeginEvent("other", ProfileEvent::EventType::DEFAULT,
+                        /*event_metadata1*/ 0, /*event_metadata2*/ 0);
+  buffer.EndEvent(other_handle);
+
+  auto events = GetProfileEvents(buffer);
+  ASSERT_EQ(2, events.size());
+  EXPECT_GT(events[0]->end_counters.instructions,
+            events[0]->begin_counters.instructions);
+  // Only operator invocations are counted.
+  EXPECT_EQ(0, events[1]->begin_counters.instructions);
+  EXPECT_EQ(0, events[1]->end_counters.instructions);
+}
+
 }  // namespace
 }  // namespace profiling
 }  // namespace tflite
@@ -15,9 +15,13 @@ limitations under the License.
 
 #include "tensorflow/lite/profiling/profile_summarizer.h"
 
+#include <algorithm>
+#include <iomanip>
 #include <memory>
 #include <sstream>
 #include <string>
+#include <utility>
+#include <vector>
 
 #include "tensorflow/lite/profiling/memory_info.h"
 #include "tensorflow/lite/schema/schema_generated.h"
@@ -139,6 +143,16 @@ void ProfileSummarizer::ProcessProfiles(
 
       stats_calculator->AddNodeStats(node_name_in_stats, type_in_stats,
                                      node_num, node_exec_time, 0 /*memory */);
+
+      const PerfCounterValues counters =
+          event->end_counters - event->begin_counters;
+      if (counters.cycles > 0 || counters.instructions > 0) {
+        auto& op_counters =
+            perf_counters_map_[subgraph_index][node_name_in_stats];
+        op_counters.type = type_in_stats;
+        ++op_counters.num_invocations;
+        op_counters.total = op_counters.total + counters;
+      }
     } else if (event->event_type ==
                Profiler::EventType::DELEGATE_OPERATOR_INVOKE_EVENT) {
       const std::string node_name(event->tag);
@@ -188,6 +202,54 @@ void ProfileSummarizer::ProcessProfiles(
   }
 }
 
+std::string ProfileSummarizer::GetPerfCountersString() const {
+  std::stringstream stream;
+  for (const auto& subgraph_counters : perf_counters_map_) {
+    // Sorts the operators by their total cycles.
+    std::vector<std::pair<std::string, const OperatorPerfCounters*>> ops;
+    for (const auto& op_counters : subgraph_counters.second) {
+      ops.emplace_back(op_counters.first, &op_counters.second);
+    }
+    std::stable_sort(ops.begin(), ops.end(),
+                     [](const auto& a, const auto& b) {
+                       return a.second->total.cycles > b.second->total.cycles;
+                     });
+
+    stream << "Subgraph (index: " << subgraph_counters.first
+           << ") hardware counters per invocation of the invoking thread:\n";
+    stream << std::setw(24) << "[node type]" << std::setw(14) << "[cycles]"
+           << std::setw(14) << "[instructions]" << std::setw(8) << "[IPC]"
+           << std::setw(14) << "[LLC refs]" << std::setw(14) << "[LLC misses]"
+           << std::setw(10) << "[miss %]"
+           << "\t[Name]\n";
+    stream << std::fixed;
+    for (const auto& op : ops) {
+      const OperatorPerfCounters& counters = *op.second;
+      const double num_invocations = counters.num_invocations;
+      const PerfCounterValues& total = counters.total;
+      const double ipc =
+          total.cycles > 0
+              ? static_cast<double>(total.instructions) / total.cycles
+              : 0.0;
+      const double miss_rate =
+          total.cache_references > 0
+              ? 100.0 * total.cache_misses / total.cache_references
+              : 0.0;
+      stream << std::setw(24) << counters.type << std::setprecision(0)
+             << std::setw(14) << total.cycles / num_invocations
+             << std::setw(14) << total.instructions / num_invocations
+             << std::setprecision(2) << std::setw(8) << ipc
+             << std::setprecision(0) << std::setw(14)
+             << total.cache_references / num_invocations << std::setw(14)
+             << total.cache_misses / num_invocations << std::setprecision(2)
+             << std::setw(9) << miss_rate << "%"
+             << "\t" << op.first << "\n";
+    }
+    stream << "\n";
+  }
+  return stream.str();
+}
+
 tensorflow::StatsCalculator* ProfileSummarizer::GetStatsCalculator(
     uint32_t subgraph_index) {
   if (stats_calculator_map_.count(subgraph_index) == 0) {
@@ -17,12 +17,14 @@ limitations under the License.
 #define TENSORFLOW_LITE_PROFILING_PROFILE_SUMMARIZER_H_
 
 #include <functional>
+#include <map>
 #include <memory>
 #include <string>
 #include <vector>
 
 #include "tensorflow/core/util/stats_calculator.h"
 #include "tensorflow/lite/interpreter.h"
+#include "tensorflow/lite/profiling/perf_counters.h"
 #include "tensorflow/lite/profiling/profile_buffer.h"
 #include "tensorflow/lite/profiling/profile_summary_formatter.h"
 
@@ -53,6 +55,11 @@ class ProfileSummarizer {
                                                *delegate_stats_calculator_);
   }
 
+  // Returns a table of the average hardware event counts of each operator, or
+  // an empty string if the profiles had no counts, see
+  // BufferedProfiler::EnablePerfCounters.
+  std::string GetPerfCountersString() const;
+
   tensorflow::StatsCalculator* GetStatsCalculator(uint32_t subgraph_index);
 
   bool HasProfiles() {
@@ -70,6 +77,15 @@ class ProfileSummarizer {
 
   std::unique_ptr<tensorflow::StatsCalculator> delegate_stats_calculator_;
 
+  struct OperatorPerfCounters {
+    std::string type;
+    int64_t num_invocations = 0;
+    PerfCounterValues total;
+  };
+  // The hardware event counts per subgraph and node name.
+  std::map<uint32_t, std::map<std::string, OperatorPerfCounters>>
+      perf_counters_map_;
+
   // Summary formatter for customized output formats.
   std::shared_ptr<ProfileSummaryFormatter> summary_formatter_;
 };
@@ -149,6 +149,43 @@ TEST(ProfileSummarizerTest, InterpreterPlusProfilingDetails) {
       << output;
 }
 
+TEST(ProfileSummarizerTest, InterpreterPerfCounters) {
+  BufferedProfiler profiler(1024);
+  const bool counters_supported = profiler.EnablePerfCounters();
+  SimpleOpModel m;
+  m.Init(RegisterSimpleOp);
+  auto interpreter = m.GetInterpreter();
+  interpreter->SetProfiler(&profiler);
+  profiler.StartProfiling();
+  m.SetInputs(1, 2);
+  ASSERT_EQ(m.Invoke(), kTfLiteOk);
+  profiler.StopProfiling();
+  ProfileSummarizer summarizer;
+  summarizer.ProcessProfiles(profiler.GetProfileEvents(), *interpreter);
+  auto output = summarizer.GetPerfCountersString();
+  if (counters_supported) {
+    EXPECT_TRUE(output.find("SimpleOpEval") != std::string::npos) << output;
+    EXPECT_TRUE(output.find("[IPC]") != std::string::npos) << output;
+  } else {
+    EXPECT_TRUE(output.empty()) << output;
+  }
+}
+
+TEST(ProfileSummarizerTest, NoPerfCountersByDefault) {
+  BufferedProfiler profiler(1024);
+  SimpleOpModel m;
+  m.Init(RegisterSimpleOp);
+  auto interpreter = m.GetInterpreter();
+  interpreter->SetProfiler(&profiler);
+  profiler.StartProfiling();
+  m.SetInputs(1, 2);
+  ASSERT_EQ(m.Invoke(), kTfLiteOk);
+  profiler.StopProfiling();
+  ProfileSummarizer summarizer;
+  summarizer.ProcessProfiles(profiler.GetProfileEvents(), *interpreter);
+  EXPECT_TRUE(summarizer.GetPerfCountersString().empty());
+}
+
 // A simple test that performs `ADD` if condition is true, and `MUL` otherwise.
 // The computation is: `cond ? a + b : a * b`.
 class ProfileSummarizerIfOpTest : public subgraph_test_util::ControlFlowOpTest {
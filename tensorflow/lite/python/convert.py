@@ -502,6 +502,7 @@ def build_conversion_flags(inference_type=dtypes.float32,
                            enable_dynamic_update_slice=False,
                            preserve_assert_op=False,
                            guarantee_all_funcs_one_use=False,
+                           enable_offline_memory_planning=False,
                            **_):
   """Builds protocol buffer describing a conversion of a model.
 
@@ -586,6 +587,9 @@ def build_conversion_flags(inference_type=dtypes.float32,
       function only has a single use. This option will be helpful if the
       conversion fails when the `PartitionedCall` or `StatefulPartitionedCall`
       can't be properly inlined (default: False).
+    enable_offline_memory_planning: Whether to plan the arena offsets of the
+      tensors during conversion and embed them in the model metadata, so that
+      the interpreter doesn't plan them at runtime (default: False).
 
   Returns:
     conversion_flags: protocol buffer describing the conversion process.
@@ -644,6 +648,8 @@ def build_conversion_flags(inference_type=dtypes.float32,
   conversion_flags.enable_dynamic_update_slice = enable_dynamic_update_slice
   conversion_flags.preserve_assert_op = preserve_assert_op
   conversion_flags.guarantee_all_funcs_one_use = guarantee_all_funcs_one_use
+  conversion_flags.enable_offline_memory_planning = (
+      enable_offline_memory_planning)
   if tf_quantization_mode:
     conversion_flags.tf_quantization_mode = tf_quantization_mode
   conversion_flags.disable_infer_tensor_range = disable_infer_tensor_range
@@ -554,6 +554,7 @@ class TFLiteConverterBase(object):
     self._experimental_enable_dynamic_update_slice = False
     self._experimental_preserve_assert_op = False
     self._experimental_guarantee_all_funcs_one_use = False
+    self._experimental_offline_memory_planning = False
 
     # When the value is true, the MLIR quantantizer triggers dynamic range
     # quantization in MLIR instead of the old quantizer. Used only if
@@ -676,6 +677,8 @@ class TFLiteConverterBase(object):
             self._experimental_preserve_assert_op,
         "guarantee_all_funcs_one_use":
             self._experimental_guarantee_all_funcs_one_use,
+        "enable_offline_memory_planning":
+            self._experimental_offline_memory_planning,
     }
 
     if self.saved_model_dir:
@@ -91,6 +91,98 @@ TfLiteStatus SimpleMemoryArena::Allocate(
   return kTfLiteOk;
 }
 
+TfLiteStatus SimpleMemoryArena::AllocateBestFit(
+    TfLiteContext* context, size_t alignment, size_t size, int32_t tensor,
+    int32_t first_node, int32_t last_node,
+    ArenaAllocWithUsageInterval* new_alloc) {
+  TF_LITE_ENSURE(context, alignment <= arena_alignment_);
+  new_alloc->tensor = tensor;
+  new_alloc->first_node = first_node;
+  new_alloc->last_node = last_node;
+  new_alloc->size = size;
+  if (size == 0) {
+    new_alloc->offset = 0;
+    return kTfLiteOk;
+  }
+
+  const size_t kOffsetNotAssigned = std::numeric_limits<size_t>::max();
+  size_t best_offset = kOffsetNotAssigned;
+  size_t best_hole_size = kOffsetNotAssigned;
+  size_t current_offset = 0;
+  // Takes the hole between `current_offset` and `hole_end` if the tensor fits
+  // in it and it is smaller than the best hole so far.
+  auto consider_hole = [&](size_t hole_end) {
+    const size_t aligned_current_offset = AlignTo(alignment, current_offset);
+    if (aligned_current_offset + size <= hole_end &&
+        hole_end - current_offset < best_hole_size) {
+      best_offset = aligned_current_offset;
+      best_hole_size = hole_end - current_offset;
+    }
+  };
+  for (const auto& alloc : ordered_allocs_) {
+    if (alloc.last_node < first_node || alloc.first_node > last_node) {
+      continue;
+    }
+    consider_hole(alloc.offset);
+    current_offset = std::max(current_offset, alloc.offset + alloc.size);
+  }
+  consider_hole(high_water_mark_);
+  if (best_offset == kOffsetNotAssigned) {
+    best_offset = AlignTo(alignment, current_offset);
+  }
+
+  high_water_mark_ = std::max(high_water_mark_, best_offset + size);
+  new_alloc->offset = best_offset;
+
+  auto insertion_it = std::upper_bound(ordered_allocs_.begin(),
+                                       ordered_allocs_.end(), *new_alloc);
+  ordered_allocs_.insert(insertion_it, *new_alloc);
+  return kTfLiteOk;
+}
+
+bool SimpleMemoryArena::TryAllocateAt(size_t alignment, size_t offset,
+                                      size_t size, int32_t tensor,
+                                      int32_t first_node, int32_t last_node,
+                                      ArenaAllocWithUsageInterval* new_alloc) {
+  if (alignment > arena_alignment_ || offset % alignment != 0) {
+    return false;
+  }
+  new_alloc->tensor = tensor;
+  new_alloc->first_node = first_node;
+  new_alloc->last_node = last_node;
+  new_alloc->size = size;
+  if (size == 0) {
+    new_alloc->offset = 0;
+    return true;
+  }
+  for (const auto& alloc : ordered_allocs_) {
+    if (alloc.offset >= offset + size) break;
+    if (alloc.offset + alloc.size > offset && alloc.last_node >= first_node &&
+        alloc.first_node <= last_node) {
+      return false;
+    }
+  }
+  new_alloc->offset = offset;
+  high_water_mark_ = std::max(high_water_mark_, offset + size);
+  auto insertion_it = std::upper_bound(ordered_allocs_.begin(),
+                                       ordered_allocs_.end(), *new_alloc);
+  ordered_allocs_.insert(insertion_it, *new_alloc);
+  return true;
+}
+
+SimpleMemoryArena SimpleMemoryArena::CopyPlan() const {
+  SimpleMemoryArena copy(arena_alignment_);
+  copy.high_water_mark_ = high_water_mark_;
+  copy.ordered_allocs_ = ordered_allocs_;
+  return copy;
+}
+
+void SimpleMemoryArena::SetPlan(const SimpleMemoryArena& plan) {
+  committed_ = false;
+  high_water_mark_ = plan.high_water_mark_;
+  ordered_allocs_ = plan.ordered_allocs_;
+}
+
 TfLiteStatus SimpleMemoryArena::Deallocate(
     TfLiteContext* context, const ArenaAllocWithUsageInterval& alloc) {
   if (alloc.size == 0) {
@@ -114,6 +206,9 @@ TfLiteStatus SimpleMemoryArena::Deallocate(
 TfLiteStatus SimpleMemoryArena::Commit(TfLiteContext* context) {
   size_t required_size = RequiredBufferSize();
   if (required_size > underlying_buffer_size_) {
+    if (grow_geometrically_) {
+      required_size = std::max(required_size, 2 * underlying_buffer_size_);
+    }
     char* new_alloc = new char[required_size];
     char* new_underlying_buffer_aligned_ptr = reinterpret_cast<char*>(
         AlignTo(arena_alignment_, reinterpret_cast<intptr_t>(new_alloc)));
@@ -76,6 +76,25 @@ class SimpleMemoryArena {
                         int32_t tensor, int32_t first_node, int32_t last_node,
                         ArenaAllocWithUsageInterval* new_alloc);
 
+  // Schedules memory allocation for a tensor like Allocate(), in the smallest
+  // hole it fits in. The holes are the gaps between the allocations whose
+  // usage intervals intersect the one of the tensor, and the gap between the
+  // last of them and the high water mark. Unlike Allocate(), this doesn't
+  // put tensors at the end of the buffer while a hole below the high water
+  // mark fits them.
+  TfLiteStatus AllocateBestFit(TfLiteContext* context, size_t alignment,
+                               size_t size, int32_t tensor, int32_t first_node,
+                               int32_t last_node,
+                               ArenaAllocWithUsageInterval* new_alloc);
+
+  // Schedules memory allocation for a tensor at `offset`, like Allocate().
+  // Returns false without scheduling it if the memory at `offset` is used by
+  // an allocation whose usage interval intersects the one of the tensor, or if
+  // `offset` isn't aligned to `alignment`.
+  bool TryAllocateAt(size_t alignment, size_t offset, size_t size,
+                     int32_t tensor, int32_t first_node, int32_t last_node,
+                     ArenaAllocWithUsageInterval* new_alloc);
+
   TfLiteStatus Deallocate(TfLiteContext* context,
                           const ArenaAllocWithUsageInterval& alloc);
 
@@ -104,6 +123,24 @@ class SimpleMemoryArena {
 
   size_t GetBufferSize() { return underlying_buffer_size_; }
 
+  // Returns the end of the allocation that ends last in the current plan.
+  size_t GetHighWaterMark() const { return high_water_mark_; }
+
+  // Returns an arena with the allocations of this one and no underlying
+  // buffer, e.g. to find out how large alternative plans are.
+  SimpleMemoryArena CopyPlan() const;
+
+  // Replaces the allocations of this arena with the ones of `plan`, e.g. one
+  // returned by CopyPlan(), keeping the underlying buffer. Like after
+  // ClearPlan(), the arena has to be committed and the allocations resolved
+  // before the arena is used again.
+  void SetPlan(const SimpleMemoryArena& plan);
+
+  // If true, Commit() grows the underlying buffer to at least twice its size
+  // when it's too small, so that a plan that grows a little at a time
+  // reallocates the buffer rarely. The buffer never shrinks either way.
+  void SetGrowGeometrically(bool value) { grow_geometrically_ = value; }
+
   std::intptr_t BasePointer() const {
     return reinterpret_cast<std::intptr_t>(underlying_buffer_aligned_ptr_);
   }
@@ -133,6 +170,7 @@ class SimpleMemoryArena {
   size_t underlying_buffer_size_;
   char* underlying_buffer_aligned_ptr_;
   std::vector<ArenaAllocWithUsageInterval> ordered_allocs_;
+  bool grow_geometrically_ = false;
 };
 
 }  // namespace tflite
@@ -43,6 +43,89 @@ TEST(SimpleMemoryArenaTest, BasicArenaOperations) {
   EXPECT_EQ(allocs[5].offset, 2048);
 }
 
+TEST(SimpleMemoryArenaTest, TryAllocateAt) {
+  TfLiteContext context;
+  SimpleMemoryArena arena(64);
+  ArenaAllocWithUsageInterval allocs[4];
+
+  ASSERT_TRUE(arena.TryAllocateAt(32, 2048, 2047, 0, 1, 3, &allocs[0]));
+  EXPECT_EQ(allocs[0].offset, 2048);
+  // The memory of #0 is free after node 3.
+  ASSERT_TRUE(arena.TryAllocateAt(32, 2048, 1023, 1, 4, 6, &allocs[1]));
+  EXPECT_EQ(allocs[1].offset, 2048);
+  // #0 uses the memory at node 2.
+  EXPECT_FALSE(arena.TryAllocateAt(32, 3072, 1023, 2, 2, 5, &allocs[2]));
+  // The offset isn't aligned.
+  EXPECT_FALSE(arena.TryAllocateAt(32, 16, 1023, 2, 2, 5, &allocs[2]));
+
+  // Online allocations are planned around the offline ones.
+  ASSERT_EQ(arena.Allocate(&context, 32, 2047, 2, 2, 5, &allocs[2]),
+            kTfLiteOk);
+  EXPECT_EQ(allocs[2].offset, 0);
+  ASSERT_EQ(arena.Allocate(&context, 32, 1023, 3, 2, 5, &allocs[3]),
+            kTfLiteOk);
+  EXPECT_EQ(allocs[3].offset, 4096);
+}
+
+TEST(SimpleMemoryArenaTest, AllocateBestFit) {
+  TfLiteContext context;
+  SimpleMemoryArena arena(64);
+  ArenaAllocWithUsageInterval allocs[5];
+  ASSERT_TRUE(arena.TryAllocateAt(32, 0, 2048, 0, 0, 0, &allocs[0]));
+  ASSERT_TRUE(arena.TryAllocateAt(32, 2048, 1024, 1, 0, 2, &allocs[1]));
+  ASSERT_TRUE(arena.TryAllocateAt(32, 3072, 1024, 2, 0, 0, &allocs[2]));
+  SimpleMemoryArena first_fit_arena = arena.CopyPlan();
+  EXPECT_EQ(first_fit_arena.GetHighWaterMark(), 4096);
+
+  // #3 goes to the hole between #1 and the high water mark at node 1, which
+  // leaves room for #4 below #1.
+  ASSERT_EQ(arena.AllocateBestFit(&context, 32, 512, 3, 1, 1, &allocs[3]),
+            kTfLiteOk);
+  EXPECT_EQ(allocs[3].offset, 3072);
+  ASSERT_EQ(arena.AllocateBestFit(&context, 32, 2048, 4, 1, 1, &allocs[4]),
+            kTfLiteOk);
+  EXPECT_EQ(allocs[4].offset, 0);
+  EXPECT_EQ(arena.GetHighWaterMark(), 4096);
+
+  // Allocate() puts #3 in the gap below #1 instead, and #4 at the end.
+  ASSERT_EQ(
+      first_fit_arena.Allocate(&context, 32, 512, 3, 1, 1, &allocs[3]),
+      kTfLiteOk);
+  EXPECT_EQ(allocs[3].offset, 0);
+  ASSERT_EQ(
+      first_fit_arena.Allocate(&context, 32, 2048, 4, 1, 1, &allocs[4]),
+      kTfLiteOk);
+  EXPECT_EQ(allocs[4].offset, 3072);
+  EXPECT_EQ(first_fit_arena.GetHighWaterMark(), 5120);
+}
+
+TEST(SimpleMemoryArenaTest, SetPlanAndGrowGeometrically) {
+  TfLiteContext context;
+  SimpleMemoryArena arena(64);
+  arena.SetGrowGeometrically(true);
+  ArenaAllocWithUsageInterval allocs[3];
+  ASSERT_EQ(arena.Allocate(&context, 32, 1024, 0, 0, 2, &allocs[0]),
+            kTfLiteOk);
+  ASSERT_EQ(arena.Commit(&context), kTfLiteOk);
+  const size_t first_size = arena.GetBufferSize();
+  SimpleMemoryArena plan = arena.CopyPlan();
+
+  ASSERT_EQ(arena.Allocate(&context, 32, 64, 1, 1, 2, &allocs[1]), kTfLiteOk);
+  ASSERT_EQ(arena.Commit(&context), kTfLiteOk);
+  EXPECT_EQ(arena.GetBufferSize(), 2 * first_size);
+
+  // The buffer doesn't shrink when the smaller plan comes back.
+  arena.SetPlan(plan);
+  EXPECT_EQ(arena.GetHighWaterMark(), 1024);
+  ASSERT_EQ(arena.Allocate(&context, 32, 64, 2, 0, 2, &allocs[2]), kTfLiteOk);
+  EXPECT_EQ(allocs[2].offset, 1024);
+  ASSERT_EQ(arena.Commit(&context), kTfLiteOk);
+  EXPECT_EQ(arena.GetBufferSize(), 2 * first_size);
+  char* resolved = nullptr;
+  ASSERT_EQ(arena.ResolveAlloc(&context, allocs[2], &resolved), kTfLiteOk);
+  EXPECT_NE(resolved, nullptr);
+}
+
 TEST(SimpleMemoryArenaTest, BasicZeroAlloc) {
   TfLiteContext context;
   SimpleMemoryArena arena(64);
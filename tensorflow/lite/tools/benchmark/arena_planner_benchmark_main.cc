@@ -0,0 +1,179 @@
+/* Copyright 2022 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+// Reports the size of the kTfLiteArenaRw arena that ArenaPlanner plans for
+// each model of a list, with the default and the best fit planning, against
+// the peak of the bytes of the tensors that are used at the same time, which
+// is a lower bound of it, e.g.
+//
+//   arena_planner_benchmark --graphs=/models/a.tflite,/models/b.tflite
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "absl/strings/str_split.h"
+#include "tensorflow/lite/arena_planner.h"
+#include "tensorflow/lite/c/common.h"
+#include "tensorflow/lite/core/subgraph.h"
+#include "tensorflow/lite/graph_info.h"
+#include "tensorflow/lite/interpreter.h"
+#include "tensorflow/lite/kernels/register.h"
+#include "tensorflow/lite/model.h"
+#include "tensorflow/lite/profiling/time.h"
+#include "tensorflow/lite/tools/command_line_flags.h"
+#include "tensorflow/lite/tools/logging.h"
+#include "tensorflow/lite/util.h"
+
+namespace tflite {
+namespace benchmark {
+namespace {
+
+// The GraphInfo of a prepared subgraph with copies of its tensors, so that
+// planning them doesn't change the allocations of the subgraph.
+class SubgraphCopyInfo : public GraphInfo {
+ public:
+  explicit SubgraphCopyInfo(const Subgraph& subgraph) : subgraph_(subgraph) {
+    for (int i = 0; i < static_cast<int>(subgraph.tensors_size()); ++i) {
+      tensors_.push_back(*subgraph.tensor(i));
+    }
+  }
+
+  size_t num_tensors() const override { return tensors_.size(); }
+  TfLiteTensor* tensor(size_t index) override { return &tensors_[index]; }
+  size_t num_execution_nodes() const override {
+    return subgraph_.execution_plan().size();
+  }
+  size_t num_total_nodes() const override { return subgraph_.nodes_size(); }
+  const TfLiteNode& node(size_t index) const override {
+    return subgraph_.nodes_and_registration()[node_index(index)].first;
+  }
+  size_t node_index(size_t index) const override {
+    return subgraph_.execution_plan()[index];
+  }
+  const std::vector<int>& inputs() const override { return subgraph_.inputs(); }
+  const std::vector<int>& outputs() const override {
+    return subgraph_.outputs();
+  }
+  const std::vector<int>& variables() const override {
+    return subgraph_.variables();
+  }
+
+ private:
+  const Subgraph& subgraph_;
+  std::vector<TfLiteTensor> tensors_;
+};
+
+struct PlanStats {
+  size_t arena_size = 0;
+  size_t lower_bound = 0;
+  uint64_t planning_us = 0;
+};
+
+// Plans the arena of all subgraphs of `interpreter`, which must have allocated
+// its tensors, and adds up their sizes.
+bool PlanArenas(Interpreter* interpreter, bool best_fit, PlanStats* stats) {
+  for (int i = 0; i < static_cast<int>(interpreter->subgraphs_size()); ++i) {
+    Subgraph& subgraph = *interpreter->subgraph(i);
+    ArenaPlanner planner(subgraph.context(),
+                         std::make_unique<SubgraphCopyInfo>(subgraph),
+                         /*preserve_all_tensors=*/false,
+                         kDefaultTensorAlignment);
+    planner.SetUseBestFitPlanning(best_fit);
+    const uint64_t start_us = profiling::time::NowMicros();
+    if (planner.PlanAllocations() != kTfLiteOk ||
+        planner.ExecuteAllocations(
+            0, static_cast<int>(subgraph.execution_plan().size()) - 1) !=
+            kTfLiteOk) {
+      return false;
+    }
+    stats->planning_us += profiling::time::NowMicros() - start_us;
+    stats->arena_size += planner.GetArenaSize();
+    stats->lower_bound += planner.GetPeakLiveArenaBytes();
+  }
+  return true;
+}
+
+double Ratio(size_t size, size_t lower_bound) {
+  return lower_bound == 0 ? 1.0 : static_cast<double>(size) / lower_bound;
+}
+
+int Main(int argc, char** argv) {
+  std::string graphs;
+  std::vector<Flag> flag_list = {
+      Flag::CreateFlag("graphs", &graphs,
+                       "Comma separated paths of the TFLite models to plan."),
+  };
+  if (!Flags::Parse(&argc, const_cast<const char**>(argv), flag_list) ||
+      graphs.empty()) {
+    TFLITE_LOG(ERROR) << Flags::Usage(argv[0], flag_list);
+    return 1;
+  }
+
+  double default_ratio_sum = 0;
+  double best_fit_ratio_sum = 0;
+  int num_models = 0;
+  ops::builtin::BuiltinOpResolver resolver;
+  const std::vector<std::string> paths = absl::StrSplit(graphs, ',');
+  for (const std::string& graph : paths) {
+    std::unique_ptr<FlatBufferModel> model =
+        FlatBufferModel::BuildFromFile(graph.c_str());
+    if (!model) {
+      TFLITE_LOG(ERROR) << "Failed to load " << graph;
+      continue;
+    }
+    std::unique_ptr<Interpreter> interpreter;
+    if (InterpreterBuilder(*model, resolver)(&interpreter) != kTfLiteOk ||
+        interpreter->AllocateTensors() != kTfLiteOk) {
+      TFLITE_LOG(ERROR) << "Failed to prepare " << graph;
+      continue;
+    }
+    PlanStats default_stats;
+    PlanStats best_fit_stats;
+    if (!PlanArenas(interpreter.get(), /*best_fit=*/false, &default_stats) ||
+        !PlanArenas(interpreter.get(), /*best_fit=*/true, &best_fit_stats)) {
+      TFLITE_LOG(ERROR) << "Failed to plan " << graph;
+      continue;
+    }
+    const double default_ratio =
+        Ratio(default_stats.arena_size, default_stats.lower_bound);
+    const double best_fit_ratio =
+        Ratio(best_fit_stats.arena_size, best_fit_stats.lower_bound);
+    TFLITE_LOG(INFO) << graph << ": lower bound "
+                     << default_stats.lower_bound << " bytes, default "
+                     << default_stats.arena_size << " bytes ("
+                     << default_ratio << "x, "
+                     << default_stats.planning_us << " us), best fit "
+                     << best_fit_stats.arena_size << " bytes ("
+                     << best_fit_ratio << "x, "
+                     << best_fit_stats.planning_us << " us)";
+    default_ratio_sum += default_ratio;
+    best_fit_ratio_sum += best_fit_ratio;
+    ++num_models;
+  }
+  if (num_models == 0) {
+    return 1;
+  }
+  TFLITE_LOG(INFO) << "Mean arena size over the lower bound of " << num_models
+                   << " models: default " << default_ratio_sum / num_models
+                   << "x, best fit " << best_fit_ratio_sum / num_models << "x";
+  return 0;
+}
+
+}  // namespace
+}  // namespace benchmark
+}  // namespace tflite
+
+int main(int argc, char** argv) { return tflite::benchmark::Main(argc, argv); }
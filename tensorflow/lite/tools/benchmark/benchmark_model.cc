@@ -19,10 +19,12 @@ limitations under the License.
 #include <memory>
 #include <sstream>
 #include <string>
+#include <thread>  // NOLINT(build/c++11)
 
 #include "tensorflow/lite/profiling/memory_info.h"
 #include "tensorflow/lite/profiling/time.h"
 #include "tensorflow/lite/tools/benchmark/benchmark_utils.h"
+#include "tensorflow/lite/tools/benchmark/concurrent_runner.h"
 #include "tensorflow/lite/tools/logging.h"
 
 namespace tflite {
@@ -50,6 +52,8 @@ BenchmarkParams BenchmarkModel::DefaultParams() {
                   BenchmarkParam::Create<bool>(false));
   params.AddParam("memory_footprint_check_interval_ms",
                   BenchmarkParam::Create<int32_t>(kMemoryCheckIntervalMs));
+  params.AddParam("concurrency", BenchmarkParam::Create<int32_t>(0));
+  params.AddParam("target_qps", BenchmarkParam::Create<float>(-1.0f));
   return params;
 }
 
@@ -141,7 +145,19 @@ std::vector<Flag> BenchmarkModel::GetFlags() {
       CreateFlag<int32_t>("memory_footprint_check_interval_ms", &params_,
                           "The interval in millisecond between two consecutive "
                           "memory footprint checks. This is only used when "
-                          "--report_peak_memory_footprint is set to true.")};
+                          "--report_peak_memory_footprint is set to true."),
+      CreateFlag<int32_t>(
+          "concurrency", &params_,
+          "If positive, after the regular runs, also run that many copies of "
+          "the model at the same time, each on its own thread, for the same "
+          "number of runs and duration, and report the latency distribution, "
+          "throughput, CPU utilization and memory footprint."),
+      CreateFlag<float>(
+          "target_qps", &params_,
+          "The rate at which the concurrent runs start, see --concurrency. "
+          "Their latencies count from when they are due, including the time "
+          "they wait for a free copy. If not set, each copy runs back to "
+          "back.")};
 }
 
 void BenchmarkModel::LogParams() {
@@ -168,10 +184,76 @@ void BenchmarkModel::LogParams() {
                       "Report the peak memory footprint", verbose);
   LOG_BENCHMARK_PARAM(int32_t, "memory_footprint_check_interval_ms",
                       "Memory footprint check interval (ms)", verbose);
+  LOG_BENCHMARK_PARAM(int32_t, "concurrency", "Concurrent copies", verbose);
+  LOG_BENCHMARK_PARAM(float, "target_qps", "Target concurrent runs per second",
+                      verbose);
 }
 
 TfLiteStatus BenchmarkModel::PrepareInputData() { return kTfLiteOk; }
 
+TfLiteStatus BenchmarkModel::InitConcurrentRuns(int num_workers) {
+  TFLITE_LOG(ERROR) << "--concurrency isn't supported by this benchmark.";
+  return kTfLiteError;
+}
+
+TfLiteStatus BenchmarkModel::RunConcurrentImpl(int worker) {
+  return kTfLiteError;
+}
+
+TfLiteStatus BenchmarkModel::RunConcurrentBenchmark() {
+  const int32_t concurrency = params_.Get<int32_t>("concurrency");
+  const auto start_mem_usage = profiling::memory::GetMemoryUsage();
+  profiling::memory::MemoryUsageMonitor memory_monitor(
+      params_.Get<int32_t>("memory_footprint_check_interval_ms"));
+  memory_monitor.Start();
+  TF_LITE_ENSURE_STATUS(InitConcurrentRuns(concurrency));
+  const auto init_mem_usage =
+      profiling::memory::GetMemoryUsage() - start_mem_usage;
+
+  ConcurrentRunOptions options;
+  options.num_workers = concurrency;
+  options.target_qps = params_.Get<float>("target_qps");
+  options.min_num_runs = params_.Get<int32_t>("num_runs");
+  options.min_secs = params_.Get<float>("min_secs");
+  options.max_secs = params_.Get<float>("max_secs");
+  TFLITE_LOG(INFO) << "Running " << concurrency
+                   << " copies of the model concurrently.";
+  TFLITE_MAY_LOG(INFO, options.target_qps > 0)
+      << "Target runs per second: " << options.target_qps;
+  const ConcurrentRunResults results = RunConcurrently(
+      options, [this](int worker) { return RunConcurrentImpl(worker); });
+  memory_monitor.Stop();
+  const auto overall_mem_usage =
+      profiling::memory::GetMemoryUsage() - start_mem_usage;
+
+  TFLITE_LOG(INFO) << "Concurrent runs: " << results.num_runs << " in "
+                   << results.duration_us / 1e6 << "s, "
+                   << results.num_failed_runs << " failed, throughput "
+                   << results.QueriesPerSecond() << " runs/s.";
+  TFLITE_LOG(INFO) << "Concurrent latency in us: "
+                   << "p50=" << results.PercentileUs(50)
+                   << " p90=" << results.PercentileUs(90)
+                   << " p99=" << results.PercentileUs(99)
+                   << " p999=" << results.PercentileUs(99.9)
+                   << " max=" << results.PercentileUs(100);
+  if (results.CpuUtilization() >= 0) {
+    TFLITE_LOG(INFO) << "Concurrent CPU utilization: "
+                     << results.CpuUtilization() * 100 << "% of "
+                     << std::thread::hardware_concurrency() << " cores.";
+  }
+  if (init_mem_usage.IsSupported()) {
+    TFLITE_LOG(INFO) << "Concurrent memory footprint delta (MB): "
+                     << "init=" << init_mem_usage.max_rss_kb / 1024.0
+                     << " overall=" << overall_mem_usage.max_rss_kb / 1024.0;
+  }
+  const float peak_mem_mb = memory_monitor.GetPeakMemUsageInMB();
+  if (peak_mem_mb > 0) {
+    TFLITE_LOG(INFO) << "Concurrent peak memory footprint (MB): "
+                     << peak_mem_mb;
+  }
+  return results.num_failed_runs == 0 ? kTfLiteOk : kTfLiteError;
+}
+
 TfLiteStatus BenchmarkModel::ResetInputsAndOutputs() { return kTfLiteOk; }
 
 Stat<int64_t> BenchmarkModel::Run(int min_num_times, float min_secs,
@@ -305,6 +387,9 @@ TfLiteStatus BenchmarkModel::Run() {
   listeners_.OnBenchmarkEnd({model_size_mb, startup_latency_us, input_bytes,
                              warmup_time_us, inference_time_us, init_mem_usage,
                              overall_mem_usage, peak_mem_mb});
+  if (status == kTfLiteOk && params_.Get<int32_t>("concurrency") > 0) {
+    status = RunConcurrentBenchmark();
+  }
   return status;
 }
 
@@ -226,6 +226,14 @@ class BenchmarkModel {
   virtual TfLiteStatus ResetInputsAndOutputs();
   virtual TfLiteStatus RunImpl() = 0;
 
+  // Prepares `num_workers` copies of the model, with their inputs, for
+  // --concurrency. The default doesn't support it.
+  virtual TfLiteStatus InitConcurrentRuns(int num_workers);
+  // Runs the copy of `worker`. Each worker calls it from its own thread.
+  virtual TfLiteStatus RunConcurrentImpl(int worker);
+  // Runs the copies at the same time and logs the latency distribution.
+  TfLiteStatus RunConcurrentBenchmark();
+
   // Create a MemoryUsageMonitor to report peak memory footprint if specified.
   virtual std::unique_ptr<profiling::memory::MemoryUsageMonitor>
   MayCreateMemoryUsageMonitor() const;
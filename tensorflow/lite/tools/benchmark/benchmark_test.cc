@@ -409,6 +409,21 @@ class MaxDurationWorksTestListener : public BenchmarkListener {
   }
 };
 
+TEST(BenchmarkTest, RunConcurrently) {
+  ASSERT_THAT(g_fp32_model_path, testing::NotNull());
+  TestBenchmark benchmark(CreateParams(10, 0.0f, 150.0f));
+  ScopedCommandlineArgs scoped_argv({"--concurrency=3", "--target_qps=100"});
+  EXPECT_EQ(kTfLiteOk, benchmark.Run(scoped_argv.argc(), scoped_argv.argv()));
+}
+
+TEST(BenchmarkTest, RunStringModelConcurrently) {
+  ASSERT_THAT(g_string_model_path, testing::NotNull());
+  TestBenchmark benchmark(
+      CreateParams(10, 0.0f, 150.0f, ModelGraphType::STRING));
+  ScopedCommandlineArgs scoped_argv({"--concurrency=2"});
+  EXPECT_EQ(kTfLiteOk, benchmark.Run(scoped_argv.argc(), scoped_argv.argv()));
+}
+
 TEST(BenchmarkTest, MaxDurationWorks) {
   ASSERT_THAT(g_fp32_model_path, testing::NotNull());
   TestBenchmark benchmark(CreateParams(100000000 /* num_runs */,
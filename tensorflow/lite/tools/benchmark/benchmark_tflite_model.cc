@@ -327,6 +327,8 @@ BenchmarkParams BenchmarkTfLiteModel::DefaultParams() {
                           BenchmarkParam::Create<bool>(false));
   default_params.AddParam("profiling_output_csv_file",
                           BenchmarkParam::Create<std::string>(""));
+  default_params.AddParam("enable_op_perf_counters",
+                          BenchmarkParam::Create<bool>(false));
 
   default_params.AddParam("print_preinvoke_state",
                           BenchmarkParam::Create<bool>(false));
@@ -360,6 +362,7 @@ BenchmarkTfLiteModel::~BenchmarkTfLiteModel() {
   // Destory the owned interpreter earlier than other objects (specially
   // 'owned_delegates_').
   interpreter_.reset();
+  concurrent_workers_.clear();
 }
 
 std::vector<Flag> BenchmarkTfLiteModel::GetFlags() {
@@ -398,6 +401,9 @@ std::vector<Flag> BenchmarkTfLiteModel::GetFlags() {
           "profiling_output_csv_file", &params_,
           "File path to export profile data as CSV, if not set "
           "prints to stdout."),
+      CreateFlag<bool>("enable_op_perf_counters", &params_,
+                       "record hardware performance counters of each op, "
+                       "requires enable_op_profiling"),
       CreateFlag<bool>(
           "print_preinvoke_state", &params_,
           "print out the interpreter internals just before calling Invoke. The "
@@ -447,6 +453,8 @@ void BenchmarkTfLiteModel::LogParams() {
                       verbose);
   LOG_BENCHMARK_PARAM(std::string, "profiling_output_csv_file",
                       "CSV File to export profiling data to", verbose);
+  LOG_BENCHMARK_PARAM(bool, "enable_op_perf_counters",
+                      "Enable op hardware performance counters", verbose);
   LOG_BENCHMARK_PARAM(bool, "print_preinvoke_state",
                       "Print pre-invoke interpreter state", verbose);
   LOG_BENCHMARK_PARAM(bool, "print_postinvoke_state",
@@ -664,11 +672,7 @@ TfLiteStatus BenchmarkTfLiteModel::Init() {
 
   interpreter_->SetAllowFp16PrecisionForFp32(params_.Get<bool>("allow_fp16"));
 
-  InterpreterOptions options;
-  options.SetEnsureDynamicTensorsAreReleased(
-      params_.Get<bool>("release_dynamic_tensors"));
-  options.OptimizeMemoryForLargeTensors(
-      params_.Get<int32_t>("optimize_memory_for_large_tensors"));
+  InterpreterOptions options = GetInterpreterOptions();
   interpreter_->ApplyOptions(&options);
 
   owned_delegates_.clear();
@@ -790,6 +794,79 @@ TfLiteStatus BenchmarkTfLiteModel::Init() {
   return kTfLiteOk;
 }
 
+InterpreterOptions BenchmarkTfLiteModel::GetInterpreterOptions() const {
+  InterpreterOptions options;
+  options.SetEnsureDynamicTensorsAreReleased(
+      params_.Get<bool>("release_dynamic_tensors"));
+  options.OptimizeMemoryForLargeTensors(
+      params_.Get<int32_t>("optimize_memory_for_large_tensors"));
+  return options;
+}
+
+TfLiteStatus BenchmarkTfLiteModel::InitConcurrentRuns(int num_workers) {
+  TFLITE_TOOLS_CHECK(interpreter_);
+  concurrent_workers_.clear();
+  concurrent_workers_.resize(num_workers);
+  InterpreterOptions options = GetInterpreterOptions();
+  tools::ProvidedDelegateList delegate_providers(&params_);
+  for (ConcurrentWorker& worker : concurrent_workers_) {
+    auto resolver = GetOpResolver();
+    tflite::InterpreterBuilder builder(*model_, *resolver);
+    if (builder.SetNumThreads(params_.Get<int32_t>("num_threads")) !=
+        kTfLiteOk) {
+      TFLITE_LOG(ERROR) << "Failed to set thread number";
+      return kTfLiteError;
+    }
+    builder(&worker.interpreter);
+    if (!worker.interpreter) {
+      TFLITE_LOG(ERROR) << "Failed to initialize a concurrent interpreter";
+      return kTfLiteError;
+    }
+    Interpreter* interpreter = worker.interpreter.get();
+    interpreter->SetAllowFp16PrecisionForFp32(params_.Get<bool>("allow_fp16"));
+    interpreter->ApplyOptions(&options);
+    auto created_delegates = delegate_providers.CreateAllRankedDelegates();
+    for (auto& created_delegate : created_delegates) {
+      worker.delegates.emplace_back(std::move(created_delegate.delegate));
+      if (interpreter->ModifyGraphWithDelegate(worker.delegates.back().get()) !=
+          kTfLiteOk) {
+        TFLITE_LOG(ERROR) << "Failed to apply "
+                          << created_delegate.provider->GetName()
+                          << " delegate to a concurrent interpreter.";
+        return kTfLiteError;
+      }
+    }
+
+    // The copies run with the shapes and the data of the inputs of the
+    // regular runs.
+    for (int input : interpreter_->inputs()) {
+      const TfLiteTensor* t = interpreter_->tensor(input);
+      if (t->type != kTfLiteString) {
+        interpreter->ResizeInputTensor(
+            input,
+            std::vector<int>(t->dims->data, t->dims->data + t->dims->size));
+      }
+    }
+    if (interpreter->AllocateTensors() != kTfLiteOk) {
+      TFLITE_LOG(ERROR) << "Failed to allocate tensors!";
+      return kTfLiteError;
+    }
+    for (int input : interpreter_->inputs()) {
+      const TfLiteTensor* t = interpreter_->tensor(input);
+      TfLiteTensor* copy = interpreter->tensor(input);
+      if (t->type == kTfLiteString) TfLiteTensorRealloc(t->bytes, copy);
+      TFLITE_TOOLS_CHECK_EQ(t->bytes, copy->bytes)
+          << "Input tensor #" << input << " has a different size in a copy.";
+      if (t->bytes > 0) std::memcpy(copy->data.raw, t->data.raw, t->bytes);
+    }
+  }
+  return kTfLiteOk;
+}
+
+TfLiteStatus BenchmarkTfLiteModel::RunConcurrentImpl(int worker) {
+  return concurrent_workers_[worker].interpreter->Invoke();
+}
+
 TfLiteStatus BenchmarkTfLiteModel::LoadModel() {
   std::string graph = params_.Get<std::string>("graph");
   model_ = tflite::FlatBufferModel::BuildFromFile(graph.c_str());
@@ -823,12 +900,19 @@ std::unique_ptr<BenchmarkListener>
 BenchmarkTfLiteModel::MayCreateProfilingListener() const {
   if (!params_.Get<bool>("enable_op_profiling")) return nullptr;
 
-  return std::unique_ptr<BenchmarkListener>(new ProfilingListener(
+  auto listener = std::make_unique<ProfilingListener>(
       interpreter_.get(), params_.Get<int32_t>("max_profiling_buffer_entries"),
       params_.Get<bool>("allow_dynamic_profiling_buffer_increase"),
       params_.Get<std::string>("profiling_output_csv_file"),
       CreateProfileSummaryFormatter(
-          !params_.Get<std::string>("profiling_output_csv_file").empty())));
+          !params_.Get<std::string>("profiling_output_csv_file").empty()));
+  if (params_.Get<bool>("enable_op_perf_counters") &&
+      !listener->EnablePerfCounters()) {
+    TFLITE_LOG(WARN) << "Hardware performance counters are not available on "
+                        "this platform, e.g. because of "
+                        "/proc/sys/kernel/perf_event_paranoid.";
+  }
+  return listener;
 }
 
 TfLiteStatus BenchmarkTfLiteModel::RunImpl() { return interpreter_->Invoke(); }
@@ -87,6 +87,8 @@ class BenchmarkTfLiteModel : public BenchmarkModel {
  protected:
   TfLiteStatus PrepareInputData() override;
   TfLiteStatus ResetInputsAndOutputs() override;
+  TfLiteStatus InitConcurrentRuns(int num_workers) override;
+  TfLiteStatus RunConcurrentImpl(int worker) override;
 
   int64_t MayGetModelFileSize() override;
 
@@ -117,6 +119,8 @@ class BenchmarkTfLiteModel : public BenchmarkModel {
   utils::InputTensorData CreateRandomTensorData(
       const TfLiteTensor& t, const InputLayerInfo* layer_info);
 
+  InterpreterOptions GetInterpreterOptions() const;
+
   void AddOwnedListener(std::unique_ptr<BenchmarkListener> listener) {
     if (listener == nullptr) return;
     owned_listeners_.emplace_back(std::move(listener));
@@ -126,6 +130,14 @@ class BenchmarkTfLiteModel : public BenchmarkModel {
   std::vector<std::unique_ptr<BenchmarkListener>> owned_listeners_;
   std::mt19937 random_engine_;
   std::vector<Interpreter::TfLiteDelegatePtr> owned_delegates_;
+
+  // A copy of the model for --concurrency. The interpreter is destroyed
+  // before its delegates.
+  struct ConcurrentWorker {
+    std::vector<Interpreter::TfLiteDelegatePtr> delegates;
+    std::unique_ptr<Interpreter> interpreter;
+  };
+  std::vector<ConcurrentWorker> concurrent_workers_;
   // Always TFLITE_LOG the benchmark result.
   BenchmarkLoggingListener log_output_;
 };
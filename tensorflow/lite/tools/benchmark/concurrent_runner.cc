@@ -0,0 +1,127 @@
+/* Copyright 2022 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/lite/tools/benchmark/concurrent_runner.h"
+
+#if defined(__linux__) || defined(__APPLE__)
+#include <sys/resource.h>
+#endif
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <thread>  // NOLINT(build/c++11)
+
+#include "tensorflow/lite/profiling/time.h"
+
+namespace tflite {
+namespace benchmark {
+namespace {
+
+int64_t ProcessCpuTimeMicros() {
+#if defined(__linux__) || defined(__APPLE__)
+  struct rusage usage;
+  if (getrusage(RUSAGE_SELF, &usage) == 0) {
+    return (usage.ru_utime.tv_sec + usage.ru_stime.tv_sec) * 1000000LL +
+           usage.ru_utime.tv_usec + usage.ru_stime.tv_usec;
+  }
+#endif
+  return -1;
+}
+
+}  // namespace
+
+int64_t ConcurrentRunResults::PercentileUs(double percentile) const {
+  if (latencies_us.empty()) return 0;
+  // The nearest-rank percentile, with some slack for the rounding errors of
+  // e.g. 99.9 / 100.
+  const int64_t rank = static_cast<int64_t>(
+      std::ceil(percentile * latencies_us.size() / 100.0 - 1e-6));
+  return latencies_us[std::min<int64_t>(std::max<int64_t>(rank, 1),
+                                        latencies_us.size()) -
+                      1];
+}
+
+double ConcurrentRunResults::QueriesPerSecond() const {
+  return duration_us > 0 ? num_runs * 1e6 / duration_us : 0.0;
+}
+
+double ConcurrentRunResults::CpuUtilization() const {
+  const unsigned int num_cores = std::thread::hardware_concurrency();
+  if (cpu_time_us < 0 || duration_us <= 0 || num_cores == 0) return -1.0;
+  return static_cast<double>(cpu_time_us) / duration_us / num_cores;
+}
+
+ConcurrentRunResults RunConcurrently(
+    const ConcurrentRunOptions& options,
+    const std::function<TfLiteStatus(int worker)>& run) {
+  const int num_workers = std::max(options.num_workers, 1);
+  std::vector<std::vector<int64_t>> latencies_us(num_workers);
+  std::vector<int64_t> num_failed_runs(num_workers, 0);
+  std::atomic<int64_t> next_run(0);
+
+  const int64_t start_cpu_time_us = ProcessCpuTimeMicros();
+  const int64_t start_us = profiling::time::NowMicros();
+  const int64_t min_finish_us =
+      start_us + static_cast<int64_t>(options.min_secs * 1e6);
+  const int64_t max_finish_us =
+      start_us + static_cast<int64_t>(options.max_secs * 1e6);
+  auto worker_loop = [&](int worker) {
+    while (true) {
+      const int64_t run_index = next_run++;
+      int64_t due_us;
+      if (options.target_qps > 0) {
+        due_us = start_us +
+                 static_cast<int64_t>(run_index * 1e6 / options.target_qps);
+        const int64_t now_us = profiling::time::NowMicros();
+        if (due_us > max_finish_us) break;
+        if (due_us > now_us) profiling::time::SleepForMicros(due_us - now_us);
+      } else {
+        due_us = profiling::time::NowMicros();
+      }
+      if ((run_index >= options.min_num_runs && due_us >= min_finish_us) ||
+          due_us > max_finish_us) {
+        break;
+      }
+      if (run(worker) != kTfLiteOk) ++num_failed_runs[worker];
+      latencies_us[worker].push_back(profiling::time::NowMicros() - due_us);
+    }
+  };
+  std::vector<std::thread> threads;
+  for (int worker = 1; worker < num_workers; ++worker) {
+    threads.emplace_back(worker_loop, worker);
+  }
+  worker_loop(0);
+  for (std::thread& thread : threads) thread.join();
+
+  ConcurrentRunResults results;
+  results.duration_us = profiling::time::NowMicros() - start_us;
+  const int64_t end_cpu_time_us = ProcessCpuTimeMicros();
+  if (start_cpu_time_us >= 0 && end_cpu_time_us >= 0) {
+    results.cpu_time_us = end_cpu_time_us - start_cpu_time_us;
+  }
+  for (int worker = 0; worker < num_workers; ++worker) {
+    results.latencies_us.insert(results.latencies_us.end(),
+                                latencies_us[worker].begin(),
+                                latencies_us[worker].end());
+    results.num_failed_runs += num_failed_runs[worker];
+  }
+  std::sort(results.latencies_us.begin(), results.latencies_us.end());
+  results.num_runs = results.latencies_us.size();
+  return results;
+}
+
+}  // namespace benchmark
+}  // namespace tflite
@@ -0,0 +1,72 @@
+/* Copyright 2022 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_LITE_TOOLS_BENCHMARK_CONCURRENT_RUNNER_H_
+#define TENSORFLOW_LITE_TOOLS_BENCHMARK_CONCURRENT_RUNNER_H_
+
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+#include "tensorflow/lite/c/common.h"
+
+namespace tflite {
+namespace benchmark {
+
+struct ConcurrentRunOptions {
+  // The number of threads that run at the same time.
+  int num_workers = 1;
+  // The rate at which the runs are due to start. The latency of a run counts
+  // from the time it is due, so that it includes the time the run waited for
+  // a free worker. If not positive, every worker starts a run as soon as its
+  // previous run is done.
+  float target_qps = -1.0f;
+  // The runs go on until both `min_num_runs` runs were started and
+  // `min_secs` seconds passed, but stop after `max_secs` seconds.
+  int min_num_runs = 0;
+  float min_secs = 0.0f;
+  float max_secs = 0.0f;
+};
+
+struct ConcurrentRunResults {
+  int64_t num_runs = 0;
+  int64_t num_failed_runs = 0;
+  int64_t duration_us = 0;
+  // The latencies of all the runs, in increasing order.
+  std::vector<int64_t> latencies_us;
+  // The CPU time that the process used during the runs, or a negative value
+  // if it isn't available on the platform.
+  int64_t cpu_time_us = -1;
+
+  // Returns the latency that `percentile` percent of the runs don't exceed,
+  // or 0 if there were no runs.
+  int64_t PercentileUs(double percentile) const;
+  // Returns the number of runs per second.
+  double QueriesPerSecond() const;
+  // Returns the share of the CPU time of all cores that the process used, or
+  // a negative value if it isn't available.
+  double CpuUtilization() const;
+};
+
+// Calls `run(worker)` from `options.num_workers` threads, for workers in
+// [0, num_workers), and measures the latency of each call.
+ConcurrentRunResults RunConcurrently(
+    const ConcurrentRunOptions& options,
+    const std::function<TfLiteStatus(int worker)>& run);
+
+}  // namespace benchmark
+}  // namespace tflite
+
+#endif  // TENSORFLOW_LITE_TOOLS_BENCHMARK_CONCURRENT_RUNNER_H_
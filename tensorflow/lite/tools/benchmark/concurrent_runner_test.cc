@@ -0,0 +1,107 @@
+/* Copyright 2022 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/lite/tools/benchmark/concurrent_runner.h"
+
+#include <atomic>
+#include <mutex>  // NOLINT(build/c++11)
+#include <set>
+
+#include <gtest/gtest.h>
+#include "tensorflow/lite/profiling/time.h"
+
+namespace tflite {
+namespace benchmark {
+namespace {
+
+TEST(ConcurrentRunnerTest, RunsOnAllWorkers) {
+  ConcurrentRunOptions options;
+  options.num_workers = 4;
+  options.min_num_runs = 100;
+  options.max_secs = 60.0f;
+  std::mutex mu;
+  std::set<int> workers;
+  ConcurrentRunResults results = RunConcurrently(options, [&](int worker) {
+    // Each run keeps its worker busy, so that the others take runs too.
+    profiling::time::SleepForMicros(1000);
+    std::lock_guard<std::mutex> lock(mu);
+    workers.insert(worker);
+    return kTfLiteOk;
+  });
+  EXPECT_GE(results.num_runs, 100);
+  EXPECT_EQ(results.num_failed_runs, 0);
+  EXPECT_EQ(workers, (std::set<int>{0, 1, 2, 3}));
+  EXPECT_GE(results.PercentileUs(0), 1000);
+  EXPECT_LE(results.PercentileUs(50), results.PercentileUs(99.9));
+  EXPECT_GT(results.QueriesPerSecond(), 0.0);
+}
+
+TEST(ConcurrentRunnerTest, TargetQps) {
+  ConcurrentRunOptions options;
+  options.num_workers = 2;
+  options.target_qps = 200.0f;
+  options.min_secs = 0.25f;
+  options.max_secs = 60.0f;
+  ConcurrentRunResults results =
+      RunConcurrently(options, [](int worker) { return kTfLiteOk; });
+  // The runs start at the target rate rather than back to back.
+  EXPECT_GE(results.num_runs, 40);
+  EXPECT_LE(results.num_runs, 60);
+  EXPECT_LT(results.QueriesPerSecond(), 400.0);
+}
+
+TEST(ConcurrentRunnerTest, LatencyIncludesWaitingForAWorker) {
+  ConcurrentRunOptions options;
+  options.num_workers = 1;
+  options.target_qps = 1000.0f;
+  options.min_num_runs = 10;
+  options.max_secs = 60.0f;
+  // The runs are due every 1ms but take 5ms, so they queue up.
+  ConcurrentRunResults results = RunConcurrently(options, [](int worker) {
+    profiling::time::SleepForMicros(5000);
+    return kTfLiteOk;
+  });
+  ASSERT_EQ(results.num_runs, 10);
+  EXPECT_GE(results.PercentileUs(100), 10 * 4000);
+}
+
+TEST(ConcurrentRunnerTest, CountsFailedRuns) {
+  ConcurrentRunOptions options;
+  options.num_workers = 2;
+  options.min_num_runs = 10;
+  options.max_secs = 60.0f;
+  std::atomic<int> num_runs(0);
+  ConcurrentRunResults results = RunConcurrently(options, [&](int worker) {
+    return num_runs++ % 2 == 0 ? kTfLiteOk : kTfLiteError;
+  });
+  EXPECT_EQ(results.num_runs, num_runs);
+  EXPECT_EQ(results.num_failed_runs, num_runs / 2);
+}
+
+TEST(ConcurrentRunnerTest, Percentiles) {
+  ConcurrentRunResults results;
+  for (int i = 1; i <= 1000; ++i) results.latencies_us.push_back(i);
+  EXPECT_EQ(results.PercentileUs(50), 500);
+  EXPECT_EQ(results.PercentileUs(90), 900);
+  EXPECT_EQ(results.PercentileUs(99), 990);
+  EXPECT_EQ(results.PercentileUs(99.9), 999);
+  EXPECT_EQ(results.PercentileUs(100), 1000);
+  EXPECT_EQ(results.PercentileUs(0), 1);
+  EXPECT_EQ(ConcurrentRunResults().PercentileUs(50), 0);
+}
+
+}  // namespace
+}  // namespace benchmark
+}  // namespace tflite
@@ -80,6 +80,12 @@ void ProfilingListener::OnBenchmarkEnd(const BenchmarkResults& results) {
     WriteOutput("Operator-wise Profiling Info for Regular Benchmark Runs:",
                 run_summarizer_.GetOutputString(),
                 output_stream == nullptr ? &TFLITE_LOG(INFO) : output_stream);
+    const std::string perf_counters = run_summarizer_.GetPerfCountersString();
+    if (!perf_counters.empty()) {
+      // Not part of the CSV output.
+      WriteOutput("Operator-wise Hardware Counters for Regular Benchmark Runs:",
+                  perf_counters, &TFLITE_LOG(INFO));
+    }
   }
 }
 
@@ -36,6 +36,11 @@ class ProfilingListener : public BenchmarkListener {
       std::shared_ptr<profiling::ProfileSummaryFormatter> summarizer_formatter =
           std::make_shared<profiling::ProfileSummaryDefaultFormatter>());
 
+  // Also records the hardware performance counters of each op on the calling
+  // thread, which should be the one that invokes the interpreter. Returns false
+  // if they are not supported.
+  bool EnablePerfCounters() { return profiler_.EnablePerfCounters(); }
+
   void OnBenchmarkStart(const BenchmarkParams& params) override;
 
   void OnSingleRunStart(RunType run_type) override;
@@ -51,5 +51,7 @@ include_directories(
    "${PTHREADPOOL_SOURCE_DIR}/include"
    "${FP16_SOURCE_DIR}/include"
    "${XNNPACK_SOURCE_DIR}/include"
+   # For the weights cache layout that the weights cache files store.
+   "${XNNPACK_SOURCE_DIR}/src"
    "${CPUINFO_SOURCE_DIR}/"
 )
@@ -0,0 +1,339 @@
+/* Copyright 2022 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/lite/tools/optimize/mixed_precision_search.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "flatbuffers/flatbuffers.h"  // from @flatbuffers
+#include "tensorflow/lite/interpreter.h"
+#include "tensorflow/lite/kernels/register.h"
+#include "tensorflow/lite/model.h"
+#include "tensorflow/lite/profiling/time.h"
+#include "tensorflow/lite/tools/optimize/operator_property.h"
+#include "tensorflow/lite/tools/optimize/quantize_model.h"
+
+namespace tflite {
+namespace optimize {
+
+namespace {
+
+using Samples = std::vector<std::vector<std::vector<float>>>;
+
+// A set of layers to quantize and what the resulting model costs.
+struct Candidate {
+  std::unordered_set<string> layers;
+  ModelMetrics metrics;
+};
+
+void PackModel(const ModelT& model, flatbuffers::FlatBufferBuilder* builder) {
+  FinishModelBuffer(*builder, Model::Pack(*builder, &model));
+}
+
+std::unique_ptr<ModelT> CopyModel(const ModelT& model) {
+  flatbuffers::FlatBufferBuilder builder;
+  PackModel(model, &builder);
+  return std::unique_ptr<ModelT>(
+      GetModel(builder.GetBufferPointer())->UnPack());
+}
+
+// Returns the output tensor names of the layers quantizable to
+// `activations_type`, in execution order.
+std::vector<string> GetQuantizableLayers(const ModelT& model,
+                                         TensorType activations_type) {
+  std::vector<string> layers;
+  std::unordered_set<string> seen;
+  for (int subgraph_idx = 0; subgraph_idx < model.subgraphs.size();
+       ++subgraph_idx) {
+    const SubGraphT* subgraph = model.subgraphs[subgraph_idx].get();
+    for (int op_idx = 0; op_idx < subgraph->operators.size(); ++op_idx) {
+      const OperatorT* op = subgraph->operators[op_idx].get();
+      if (op->outputs.empty()) continue;
+      const operator_property::OperatorProperty property =
+          operator_property::GetOperatorProperty(&model, subgraph_idx, op_idx);
+      if (!property.quantizable ||
+          (activations_type == TensorType_INT16 &&
+           !property.quantizable_int16)) {
+        continue;
+      }
+      const string& name = subgraph->tensors[op->outputs[0]]->name;
+      if (seen.insert(name).second) layers.push_back(name);
+    }
+  }
+  return layers;
+}
+
+// Quantizes `layers` of `model` to `activations_type`, leaving the other
+// layers and the model inputs and outputs in float.
+TfLiteStatus QuantizeLayers(const ModelT& model,
+                            const std::unordered_set<string>& layers,
+                            TensorType activations_type,
+                            bool disable_per_channel,
+                            flatbuffers::FlatBufferBuilder* builder,
+                            ErrorReporter* error_reporter) {
+  std::unique_ptr<ModelT> quantized_model = CopyModel(model);
+  const TensorType bias_type = activations_type == TensorType_INT16
+                                   ? TensorType_INT64
+                                   : TensorType_INT32;
+  return QuantizeModel(builder, quantized_model.get(), TensorType_FLOAT32,
+                       TensorType_FLOAT32, /*allow_float=*/true, layers,
+                       activations_type, bias_type, disable_per_channel,
+                       error_reporter);
+}
+
+TfLiteStatus EvaluateLayers(const ModelT& model,
+                            const std::unordered_set<string>& layers,
+                            TensorType activations_type,
+                            const MixedPrecisionOptions& options,
+                            const ModelEvaluator& evaluator,
+                            MixedPrecisionResult* result, ModelMetrics* metrics,
+                            ErrorReporter* error_reporter) {
+  if (layers.empty()) {
+    *metrics = result->float_metrics;
+    return kTfLiteOk;
+  }
+  flatbuffers::FlatBufferBuilder builder;
+  TF_LITE_ENSURE_STATUS(QuantizeLayers(model, layers, activations_type,
+                                       options.disable_per_channel, &builder,
+                                       error_reporter));
+  ++result->num_evaluations;
+  return evaluator(GetModel(builder.GetBufferPointer()), metrics);
+}
+
+// Finds the layers to quantize to `activations_type` as described in
+// QuantizeModelMixedPrecision(). Returns the best candidate found, which
+// may exceed the error budget.
+TfLiteStatus SearchLayers(const ModelT& model, TensorType activations_type,
+                          const MixedPrecisionOptions& options,
+                          const ModelEvaluator& evaluator,
+                          MixedPrecisionResult* result, Candidate* candidate,
+                          ErrorReporter* error_reporter) {
+  const std::vector<string> layers =
+      GetQuantizableLayers(model, activations_type);
+  candidate->layers = std::unordered_set<string>(layers.begin(), layers.end());
+  TF_LITE_ENSURE_STATUS(EvaluateLayers(model, candidate->layers,
+                                       activations_type, options, evaluator,
+                                       result, &candidate->metrics,
+                                       error_reporter));
+  if (candidate->metrics.error <= options.max_error) return kTfLiteOk;
+
+  // Measure what each layer costs in error and saves in latency by leaving
+  // it alone in float.
+  const ModelMetrics all_quantized = candidate->metrics;
+  std::vector<std::pair<double, string>> layers_by_benefit;
+  for (const string& layer : layers) {
+    std::unordered_set<string> without_layer = candidate->layers;
+    without_layer.erase(layer);
+    ModelMetrics metrics;
+    TF_LITE_ENSURE_STATUS(EvaluateLayers(model, without_layer,
+                                         activations_type, options, evaluator,
+                                         result, &metrics, error_reporter));
+    const double error_removed = all_quantized.error - metrics.error;
+    if (error_removed <= 0) continue;
+    const double latency_lost = metrics.latency_us - all_quantized.latency_us;
+    const double benefit = latency_lost > 0
+                               ? error_removed / latency_lost
+                               : std::numeric_limits<double>::infinity();
+    layers_by_benefit.emplace_back(benefit, layer);
+  }
+  std::stable_sort(
+      layers_by_benefit.begin(), layers_by_benefit.end(),
+      [](const std::pair<double, string>& a,
+         const std::pair<double, string>& b) { return a.first > b.first; });
+
+  // The errors of the layers interact, so re-measure after each change.
+  for (const auto& benefit_and_layer : layers_by_benefit) {
+    if (candidate->metrics.error <= options.max_error) break;
+    candidate->layers.erase(benefit_and_layer.second);
+    TF_LITE_ENSURE_STATUS(EvaluateLayers(model, candidate->layers,
+                                         activations_type, options, evaluator,
+                                         result, &candidate->metrics,
+                                         error_reporter));
+  }
+  return kTfLiteOk;
+}
+
+// Runs `inputs` through `model` `num_runs` times. Stores the outputs of the
+// first run in `outputs` and the mean Invoke() latency in `latency_us`.
+TfLiteStatus RunModel(const Model* model, const Samples& inputs, int num_runs,
+                      int num_threads, ErrorReporter* error_reporter,
+                      Samples* outputs, double* latency_us) {
+  ops::builtin::BuiltinOpResolver resolver;
+  std::unique_ptr<Interpreter> interpreter;
+  if (InterpreterBuilder(model, resolver, error_reporter)(
+          &interpreter, num_threads) != kTfLiteOk ||
+      interpreter == nullptr) {
+    TF_LITE_REPORT_ERROR(error_reporter, "Failed to build the interpreter.");
+    return kTfLiteError;
+  }
+  TF_LITE_ENSURE_STATUS(interpreter->AllocateTensors());
+
+  outputs->clear();
+  uint64_t total_us = 0;
+  for (int run = 0; run < num_runs; ++run) {
+    for (const std::vector<std::vector<float>>& sample : inputs) {
+      if (sample.size() != interpreter->inputs().size()) {
+        TF_LITE_REPORT_ERROR(error_reporter,
+                             "Expected %d inputs per sample, got %d.",
+                             static_cast<int>(interpreter->inputs().size()),
+                             static_cast<int>(sample.size()));
+        return kTfLiteError;
+      }
+      for (int i = 0; i < sample.size(); ++i) {
+        TfLiteTensor* tensor = interpreter->input_tensor(i);
+        if (tensor->type != kTfLiteFloat32 ||
+            tensor->bytes != sample[i].size() * sizeof(float)) {
+          TF_LITE_REPORT_ERROR(error_reporter,
+                               "Sample does not match model input %d.", i);
+          return kTfLiteError;
+        }
+        std::memcpy(tensor->data.f, sample[i].data(), tensor->bytes);
+      }
+      const uint64_t start_us = profiling::time::NowMicros();
+      TF_LITE_ENSURE_STATUS(interpreter->Invoke());
+      total_us += profiling::time::NowMicros() - start_us;
+      if (run > 0) continue;
+      outputs->emplace_back();
+      for (int i = 0; i < interpreter->outputs().size(); ++i) {
+        const TfLiteTensor* tensor = interpreter->output_tensor(i);
+        if (tensor->type != kTfLiteFloat32) {
+          TF_LITE_REPORT_ERROR(error_reporter, "Model output %d is not float.",
+                               i);
+          return kTfLiteError;
+        }
+        outputs->back().emplace_back(
+            tensor->data.f, tensor->data.f + tensor->bytes / sizeof(float));
+      }
+    }
+  }
+  const int64_t num_invocations =
+      static_cast<int64_t>(num_runs) * inputs.size();
+  *latency_us =
+      num_invocations > 0 ? static_cast<double>(total_us) / num_invocations : 0;
+  return kTfLiteOk;
+}
+
+}  // namespace
+
+TfLiteStatus QuantizeModelMixedPrecision(
+    flatbuffers::FlatBufferBuilder* builder, const ModelT& model,
+    const MixedPrecisionOptions& options, const ModelEvaluator& evaluator,
+    MixedPrecisionResult* result, ErrorReporter* error_reporter) {
+  *result = MixedPrecisionResult();
+  {
+    flatbuffers::FlatBufferBuilder float_builder;
+    PackModel(model, &float_builder);
+    ++result->num_evaluations;
+    TF_LITE_ENSURE_STATUS(evaluator(GetModel(float_builder.GetBufferPointer()),
+                                    &result->float_metrics));
+  }
+
+  Candidate best;
+  best.metrics = result->float_metrics;
+  TensorType best_type = TensorType_FLOAT32;
+  for (const TensorType activations_type : options.activations_types) {
+    if (activations_type != TensorType_INT8 &&
+        activations_type != TensorType_INT16) {
+      TF_LITE_REPORT_ERROR(error_reporter,
+                           "Activations type %s is not supported.",
+                           EnumNameTensorType(activations_type));
+      return kTfLiteError;
+    }
+    Candidate candidate;
+    TF_LITE_ENSURE_STATUS(SearchLayers(model, activations_type, options,
+                                       evaluator, result, &candidate,
+                                       error_reporter));
+    if (!candidate.layers.empty() &&
+        candidate.metrics.error <= options.max_error &&
+        candidate.metrics.latency_us < best.metrics.latency_us) {
+      best = std::move(candidate);
+      best_type = activations_type;
+    }
+  }
+
+  result->activations_type = best_type;
+  result->quantized_layers = best.layers;
+  result->metrics = best.metrics;
+  if (best_type == TensorType_FLOAT32) {
+    PackModel(model, builder);
+    return kTfLiteOk;
+  }
+  return QuantizeLayers(model, best.layers, best_type,
+                        options.disable_per_channel, builder, error_reporter);
+}
+
+ModelEvaluator CreateInterpreterEvaluator(const ModelT& float_model,
+                                          Samples inputs, int num_runs,
+                                          int num_threads,
+                                          ErrorReporter* error_reporter) {
+  struct State {
+    Samples inputs;
+    Samples reference_outputs;
+    TfLiteStatus reference_status;
+  };
+  auto state = std::make_shared<State>();
+  state->inputs = std::move(inputs);
+  flatbuffers::FlatBufferBuilder builder;
+  PackModel(float_model, &builder);
+  double latency_us;
+  state->reference_status =
+      RunModel(GetModel(builder.GetBufferPointer()), state->inputs,
+               /*num_runs=*/1, num_threads, error_reporter,
+               &state->reference_outputs, &latency_us);
+
+  return [state, num_runs, num_threads, error_reporter](
+             const Model* model, ModelMetrics* metrics) -> TfLiteStatus {
+    TF_LITE_ENSURE_STATUS(state->reference_status);
+    Samples outputs;
+    TF_LITE_ENSURE_STATUS(RunModel(model, state->inputs, num_runs,
+                                   num_threads, error_reporter, &outputs,
+                                   &metrics->latency_us));
+    if (outputs.size() != state->reference_outputs.size()) {
+      TF_LITE_REPORT_ERROR(error_reporter, "Mismatched number of outputs.");
+      return kTfLiteError;
+    }
+    double total_error = 0;
+    int64_t num_values = 0;
+    for (int i = 0; i < outputs.size(); ++i) {
+      if (outputs[i].size() != state->reference_outputs[i].size()) {
+        TF_LITE_REPORT_ERROR(error_reporter, "Mismatched number of outputs.");
+        return kTfLiteError;
+      }
+      for (int j = 0; j < outputs[i].size(); ++j) {
+        const std::vector<float>& output = outputs[i][j];
+        const std::vector<float>& reference = state->reference_outputs[i][j];
+        if (output.size() != reference.size()) {
+          TF_LITE_REPORT_ERROR(error_reporter, "Mismatched output shapes.");
+          return kTfLiteError;
+        }
+        for (int k = 0; k < output.size(); ++k) {
+          total_error += std::abs(output[k] - reference[k]);
+        }
+        num_values += output.size();
+      }
+    }
+    metrics->error = num_values > 0 ? total_error / num_values : 0;
+    return kTfLiteOk;
+  };
+}
+
+}  // namespace optimize
+}  // namespace tflite
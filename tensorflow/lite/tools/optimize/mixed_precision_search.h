@@ -0,0 +1,102 @@
+/* Copyright 2022 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_LITE_TOOLS_OPTIMIZE_MIXED_PRECISION_SEARCH_H_
+#define TENSORFLOW_LITE_TOOLS_OPTIMIZE_MIXED_PRECISION_SEARCH_H_
+
+#include <functional>
+#include <unordered_set>
+#include <vector>
+
+#include "tensorflow/lite/context.h"
+#include "tensorflow/lite/core/api/error_reporter.h"
+#include "tensorflow/lite/schema/schema_generated.h"
+#include "tensorflow/lite/util.h"
+
+namespace tflite {
+namespace optimize {
+
+// What a candidate model costs on the target, as measured by a
+// ModelEvaluator.
+struct ModelMetrics {
+  // Mean latency of one inference, in microseconds.
+  double latency_us = 0;
+  // Deviation of the candidate's outputs from the float model's outputs.
+  // Only compared with `MixedPrecisionOptions::max_error`, so any metric where
+  // larger is worse works.
+  double error = 0;
+};
+
+// Measures `model`, a fully built TFLite model, on the target.
+using ModelEvaluator =
+    std::function<TfLiteStatus(const Model* model, ModelMetrics* metrics)>;
+
+struct MixedPrecisionOptions {
+  // The activation types to consider for the quantized layers, each of which
+  // is TensorType_INT8 or TensorType_INT16 (16x8 quantization). A model uses a
+  // single activation type; its layers are each either quantized to it or left
+  // in float.
+  std::vector<TensorType> activations_types = {TensorType_INT8,
+                                               TensorType_INT16};
+  // The largest `ModelMetrics::error` the chosen model may have.
+  double max_error = 0;
+  bool disable_per_channel = false;
+};
+
+struct MixedPrecisionResult {
+  // TensorType_FLOAT32 if no quantized model met the error budget, in which
+  // case the float model is returned.
+  TensorType activations_type = TensorType_FLOAT32;
+  // The output tensor names of the quantized layers.
+  std::unordered_set<string> quantized_layers;
+  ModelMetrics metrics;
+  ModelMetrics float_metrics;
+  // How many candidate models were evaluated.
+  int num_evaluations = 0;
+};
+
+// Quantizes the calibrated `model` with per-layer precision chosen from
+// measurements: picks the activation type and the set of layers to quantize
+// that give the lowest latency within `options.max_error`.
+//
+// For each activation type, all quantizable layers are quantized first. If
+// that exceeds the error budget, each layer is then measured once in float to
+// find the error it contributes and the latency it saves, and layers are
+// returned to float in order of most error removed per microsecond lost until
+// the model fits the budget. This takes O(#layers) evaluations per activation
+// type rather than searching all combinations.
+//
+// Model inputs and outputs stay float. `model` is not modified. The chosen
+// model is written to `builder`.
+//
+// Note: This is a private API, subject to change.
+TfLiteStatus QuantizeModelMixedPrecision(
+    flatbuffers::FlatBufferBuilder* builder, const ModelT& model,
+    const MixedPrecisionOptions& options, const ModelEvaluator& evaluator,
+    MixedPrecisionResult* result, ErrorReporter* error_reporter);
+
+// Returns an evaluator that runs `inputs` through candidate models with the
+// builtin kernels on this machine. `inputs[i][j]` is the value of the model's
+// j-th input for the i-th sample. Latency is the mean Invoke() time over
+// `num_runs` passes through the samples; error is the mean absolute
+// difference from the outputs of `float_model`.
+ModelEvaluator CreateInterpreterEvaluator(
+    const ModelT& float_model,
+    std::vector<std::vector<std::vector<float>>> inputs, int num_runs,
+    int num_threads, ErrorReporter* error_reporter);
+
+}  // namespace optimize
+}  // namespace tflite
+
+#endif  // TENSORFLOW_LITE_TOOLS_OPTIMIZE_MIXED_PRECISION_SEARCH_H_
@@ -0,0 +1,235 @@
+/* Copyright 2022 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/lite/tools/optimize/mixed_precision_search.h"
+
+#include <algorithm>
+#include <map>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+#include "flatbuffers/flatbuffers.h"  // from @flatbuffers
+#include "tensorflow/core/lib/io/path.h"
+#include "tensorflow/core/platform/init_main.h"
+#include "tensorflow/core/util/command_line_flags.h"
+#include "tensorflow/lite/model.h"
+#include "tensorflow/lite/schema/schema_generated.h"
+#include "tensorflow/lite/schema/schema_utils.h"
+#include "tensorflow/lite/tools/optimize/test_util.h"
+
+namespace {
+tensorflow::string* g_test_model_dir = nullptr;
+}  // namespace
+
+namespace tflite {
+namespace optimize {
+namespace {
+
+using ::testing::UnorderedElementsAre;
+
+std::unique_ptr<FlatBufferModel> ReadModel(const string& model_name) {
+  auto model_path = tensorflow::io::JoinPath(*g_test_model_dir, model_name);
+  return FlatBufferModel::BuildFromFile(model_path.c_str());
+}
+
+// Prices a model from the types its operators compute in, as if measured on a
+// target where CONV_2D is 10us in float, 6us in int16x8 and 4us in int8, and
+// LOG_SOFTMAX is 2us in float and 1us in int8. Each quantized layer adds its
+// entry in `errors`.
+TfLiteStatus FakeEvaluate(const Model* model, ModelMetrics* metrics) {
+  const std::map<std::pair<BuiltinOperator, TensorType>, double> latencies = {
+      {{BuiltinOperator_CONV_2D, TensorType_FLOAT32}, 10},
+      {{BuiltinOperator_CONV_2D, TensorType_INT16}, 6},
+      {{BuiltinOperator_CONV_2D, TensorType_INT8}, 4},
+      {{BuiltinOperator_LOG_SOFTMAX, TensorType_FLOAT32}, 2},
+      {{BuiltinOperator_LOG_SOFTMAX, TensorType_INT8}, 1},
+  };
+  const std::map<std::pair<BuiltinOperator, TensorType>, double> errors = {
+      {{BuiltinOperator_CONV_2D, TensorType_INT16}, 0.05},
+      {{BuiltinOperator_CONV_2D, TensorType_INT8}, 0.5},
+      {{BuiltinOperator_LOG_SOFTMAX, TensorType_INT8}, 0.5},
+  };
+  *metrics = ModelMetrics();
+  const SubGraph* subgraph = model->subgraphs()->Get(0);
+  for (const Operator* op : *subgraph->operators()) {
+    const BuiltinOperator op_code =
+        GetBuiltinCode(model->operator_codes()->Get(op->opcode_index()));
+    const TensorType type =
+        subgraph->tensors()->Get(op->outputs()->Get(0))->type();
+    auto latency = latencies.find({op_code, type});
+    if (latency != latencies.end()) metrics->latency_us += latency->second;
+    auto error = errors.find({op_code, type});
+    if (error != errors.end()) metrics->error += error->second;
+  }
+  return kTfLiteOk;
+}
+
+class MixedPrecisionSearchTest : public testing::Test {
+ protected:
+  MixedPrecisionSearchTest() {
+    // conv_2d->log_softmax, where only conv_2d supports 16x8 quantization.
+    input_model_ = ReadModel(internal::kModelMixed16x8);
+    input_model_->GetModel()->UnPackTo(&model_);
+  }
+
+  // Returns the types of the operators in the chosen model.
+  std::vector<std::pair<BuiltinOperator, TensorType>> OperatorTypes() {
+    const Model* model = GetModel(builder_.GetBufferPointer());
+    const SubGraph* subgraph = model->subgraphs()->Get(0);
+    std::vector<std::pair<BuiltinOperator, TensorType>> types;
+    for (const Operator* op : *subgraph->operators()) {
+      types.emplace_back(
+          GetBuiltinCode(model->operator_codes()->Get(op->opcode_index())),
+          subgraph->tensors()->Get(op->outputs()->Get(0))->type());
+    }
+    return types;
+  }
+
+  string OutputName(int op_index) {
+    const SubGraphT* subgraph = model_.subgraphs[0].get();
+    return subgraph->tensors[subgraph->operators[op_index]->outputs[0]]->name;
+  }
+
+  std::unique_ptr<FlatBufferModel> input_model_;
+  ModelT model_;
+  flatbuffers::FlatBufferBuilder builder_;
+  internal::FailOnErrorReporter error_reporter_;
+};
+
+TEST_F(MixedPrecisionSearchTest, QuantizesEverythingWithinBudget) {
+  MixedPrecisionOptions options;
+  options.max_error = 1.0;
+  MixedPrecisionResult result;
+  ASSERT_EQ(kTfLiteOk,
+            QuantizeModelMixedPrecision(&builder_, model_, options,
+                                        FakeEvaluate, &result,
+                                        &error_reporter_));
+  EXPECT_EQ(result.activations_type, TensorType_INT8);
+  EXPECT_THAT(result.quantized_layers,
+              UnorderedElementsAre(OutputName(0), OutputName(1)));
+  EXPECT_EQ(result.metrics.latency_us, 5);
+  EXPECT_EQ(result.float_metrics.latency_us, 12);
+}
+
+TEST_F(MixedPrecisionSearchTest, LeavesLeastBeneficialLayerInFloat) {
+  MixedPrecisionOptions options;
+  options.max_error = 0.6;
+  MixedPrecisionResult result;
+  ASSERT_EQ(kTfLiteOk,
+            QuantizeModelMixedPrecision(&builder_, model_, options,
+                                        FakeEvaluate, &result,
+                                        &error_reporter_));
+  // Quantizing log_softmax saves 1us for 0.5 error and quantizing conv_2d
+  // saves 6us for the same error, so log_softmax goes back to float.
+  EXPECT_EQ(result.activations_type, TensorType_INT8);
+  EXPECT_THAT(result.quantized_layers, UnorderedElementsAre(OutputName(0)));
+  EXPECT_EQ(result.metrics.latency_us, 6);
+  EXPECT_EQ(result.metrics.error, 0.5);
+
+  std::vector<std::pair<BuiltinOperator, TensorType>> types = OperatorTypes();
+  EXPECT_NE(std::find(types.begin(), types.end(),
+                      std::make_pair(BuiltinOperator_CONV_2D, TensorType_INT8)),
+            types.end());
+  EXPECT_NE(std::find(types.begin(), types.end(),
+                      std::make_pair(BuiltinOperator_LOG_SOFTMAX,
+                                     TensorType_FLOAT32)),
+            types.end());
+}
+
+TEST_F(MixedPrecisionSearchTest, PrefersInt16WhenInt8IsTooLossy) {
+  MixedPrecisionOptions options;
+  options.max_error = 0.1;
+  MixedPrecisionResult result;
+  ASSERT_EQ(kTfLiteOk,
+            QuantizeModelMixedPrecision(&builder_, model_, options,
+                                        FakeEvaluate, &result,
+                                        &error_reporter_));
+  EXPECT_EQ(result.activations_type, TensorType_INT16);
+  EXPECT_THAT(result.quantized_layers, UnorderedElementsAre(OutputName(0)));
+  EXPECT_EQ(result.metrics.latency_us, 8);
+}
+
+TEST_F(MixedPrecisionSearchTest, FallsBackToFloat) {
+  MixedPrecisionOptions options;
+  options.max_error = 0;
+  MixedPrecisionResult result;
+  ASSERT_EQ(kTfLiteOk,
+            QuantizeModelMixedPrecision(&builder_, model_, options,
+                                        FakeEvaluate, &result,
+                                        &error_reporter_));
+  EXPECT_EQ(result.activations_type, TensorType_FLOAT32);
+  EXPECT_TRUE(result.quantized_layers.empty());
+  for (const auto& type : OperatorTypes()) {
+    EXPECT_EQ(type.second, TensorType_FLOAT32);
+  }
+}
+
+TEST(InterpreterEvaluatorTest, FloatModelHasNoError) {
+  std::unique_ptr<FlatBufferModel> input_model =
+      ReadModel(internal::kConvModelWith0Plus10Weights);
+  ModelT model;
+  input_model->GetModel()->UnPackTo(&model);
+  const TensorT* input =
+      model.subgraphs[0]->tensors[model.subgraphs[0]->inputs[0]].get();
+  int num_elements = 1;
+  for (int dim : input->shape) num_elements *= dim;
+  std::vector<std::vector<std::vector<float>>> inputs = {
+      {std::vector<float>(num_elements, 1.0f)},
+      {std::vector<float>(num_elements, 5.0f)}};
+  internal::FailOnErrorReporter error_reporter;
+  ModelEvaluator evaluator = CreateInterpreterEvaluator(
+      model, inputs, /*num_runs=*/2, /*num_threads=*/1, &error_reporter);
+
+  ModelMetrics metrics;
+  ASSERT_EQ(kTfLiteOk, evaluator(input_model->GetModel(), &metrics));
+  EXPECT_EQ(metrics.error, 0);
+  EXPECT_GE(metrics.latency_us, 0);
+
+  MixedPrecisionOptions options;
+  options.activations_types = {TensorType_INT8};
+  options.max_error = 1e9;
+  flatbuffers::FlatBufferBuilder builder;
+  MixedPrecisionResult result;
+  ASSERT_EQ(kTfLiteOk, QuantizeModelMixedPrecision(&builder, model, options,
+                                                   evaluator, &result,
+                                                   &error_reporter));
+  EXPECT_LE(result.metrics.error, options.max_error);
+  EXPECT_GE(result.num_evaluations, 2);
+}
+
+}  // namespace
+}  // namespace optimize
+}  // namespace tflite
+
+int main(int argc, char** argv) {
+  tensorflow::string model_file;
+  const std::vector<tensorflow::Flag> flag_list = {
+      tensorflow::Flag("test_model_file", &model_file,
+                       "Path to test tflite model file."),
+  };
+
+  const bool parse_result = tensorflow::Flags::Parse(&argc, argv, flag_list);
+  if (!parse_result) {
+    std::cerr << "Required test_model_file\n";
+    std::abort();
+  }
+  g_test_model_dir =
+      new tensorflow::string(tensorflow::io::Dirname(model_file));
+  ::tensorflow::port::InitMain(argv[0], &argc, &argv);
+  return RUN_ALL_TESTS();
+}
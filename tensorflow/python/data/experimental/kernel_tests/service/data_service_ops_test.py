@@ -227,6 +227,23 @@ class DataServiceOpsTest(data_service_test_base.TestBase,
     self.assertDatasetProduces(
         ds, num_workers * list(range(num_elements)), assert_items_equal=True)
 
+  @combinations.generate(
+      combinations.times(
+          test_base.default_test_combinations(),
+          combinations.combine(max_bytes_per_request=[1, 64, 1 << 20])))
+  def testMaxBytesPerRequest(self, max_bytes_per_request):
+    num_workers = 2
+    cluster = data_service_test_base.TestCluster(num_workers=num_workers)
+    num_elements = 100
+    ds = dataset_ops.Dataset.range(num_elements)
+    ds = ds.apply(
+        data_service_ops._distribute(
+            processing_mode="parallel_epochs",
+            service=cluster.dispatcher_address(),
+            max_bytes_per_request=max_bytes_per_request))
+    self.assertDatasetProduces(
+        ds, num_workers * list(range(num_elements)), assert_items_equal=True)
+
   @combinations.generate(test_base.eager_only_combinations())
   def testInsideFunction(self):
     num_workers = 3
@@ -203,10 +203,16 @@ def _get_compression_proto(compression):
                    f"Must be one of {[COMPRESSION_AUTO, COMPRESSION_NONE]}.")
 
 
-def _decide_compression(compression, data_transfer_protocol):
+def _decide_compression(compression,
+                        data_transfer_protocol,
+                        max_bytes_per_request=None):
   if (compression == COMPRESSION_AUTO and data_transfer_protocol != "grpc" and
       data_transfer_protocol is not None):
     return COMPRESSION_NONE
+  # Batched responses are compressed as a whole, so elements don't need to be
+  # compressed individually.
+  if compression == COMPRESSION_AUTO and max_bytes_per_request:
+    return COMPRESSION_NONE
   return compression
 
 
@@ -226,7 +232,8 @@ class _DataServiceDatasetV2(dataset_ops.DatasetSource):
                max_outstanding_requests=None,
                task_refresh_interval_hint_ms=None,
                cross_trainer_cache=None,
-               target_workers="AUTO"):
+               target_workers="AUTO",
+               max_bytes_per_request=None):
     """Constructs a _DataServiceDatasetV2.
 
     Args:
@@ -278,6 +285,11 @@ class _DataServiceDatasetV2(dataset_ops.DatasetSource):
         avoid RPCs and data copy if every TF worker colocates with a tf.data
         service worker. Consumers of a shared job must use the same
         `target_workers`. Defaults to `"AUTO"`.
+      max_bytes_per_request: (Optional.) If set, each request asks a worker
+        for up to this many bytes of elements, which are returned in one
+        response. This amortizes the per-request overhead when elements are
+        small. Only applies to first-come-first-served reads which don't use a
+        `cross_trainer_cache`.
     """
     if consumer_index is None != num_consumers is None:
       raise ValueError(
@@ -334,6 +346,8 @@ class _DataServiceDatasetV2(dataset_ops.DatasetSource):
     compat_kwargs = {}
     if data_transfer_protocol is not None:
       compat_kwargs["data_transfer_protocol"] = data_transfer_protocol
+    if max_bytes_per_request is not None:
+      compat_kwargs["max_bytes_per_request"] = max_bytes_per_request
 
     # If `uncompress` is `True`, the dataset will query the servers to find
     # out the actual compression used. It is always set to `True` the first
@@ -373,7 +387,7 @@ class _DataServiceDatasetV1(dataset_ops.DatasetV1Adapter):
                protocol, data_transfer_protocol, job_name, consumer_index,
                num_consumers, max_outstanding_requests,
                task_refresh_interval_hint_ms, cross_trainer_cache,
-               target_workers):
+               target_workers, max_bytes_per_request):
 
     self._wrapped = _DataServiceDatasetV2(
         dataset_id=dataset_id,
@@ -388,7 +402,8 @@ class _DataServiceDatasetV1(dataset_ops.DatasetV1Adapter):
         max_outstanding_requests=max_outstanding_requests,
         task_refresh_interval_hint_ms=task_refresh_interval_hint_ms,
         cross_trainer_cache=cross_trainer_cache,
-        target_workers=target_workers)
+        target_workers=target_workers,
+        max_bytes_per_request=max_bytes_per_request)
     super(_DataServiceDatasetV1, self).__init__(self._wrapped)
 
 
@@ -436,7 +451,8 @@ def _distribute(processing_mode,
                 data_transfer_protocol=None,
                 compression="AUTO",
                 cross_trainer_cache=None,
-                target_workers="AUTO"):
+                target_workers="AUTO",
+                max_bytes_per_request=None):
   """A transformation that moves dataset processing to the tf.data service.
 
   This transformation is similar to `distribute`, but supports additional
@@ -493,13 +509,18 @@ def _distribute(processing_mode,
       data copy if every TF worker colocates with a tf.data service worker.
       Consumers of a shared job must use the same `target_workers`. Defaults to
       `"AUTO"`.
+    max_bytes_per_request: (Optional.) If set, each request asks a worker for up
+      to this many bytes of elements, which are returned in one response. This
+      amortizes the per-request overhead when elements are small. Only applies
+      to first-come-first-served reads which don't use a `cross_trainer_cache`.
 
   Returns:
     Dataset: A `Dataset` of the elements produced by the data service.
   """
   processing_mode = _get_validated_sharding_policy(processing_mode)
   _validate_compression(compression)
-  compression = _decide_compression(compression, data_transfer_protocol)
+  compression = _decide_compression(compression, data_transfer_protocol,
+                                    max_bytes_per_request)
 
   def _apply_fn(dataset):  # pylint: disable=missing-docstring
     dataset_id = _register_dataset(service, dataset, compression=compression)
@@ -516,7 +537,8 @@ def _distribute(processing_mode,
         data_transfer_protocol=data_transfer_protocol,
         compression=compression,
         cross_trainer_cache=cross_trainer_cache,
-        target_workers=target_workers)
+        target_workers=target_workers,
+        max_bytes_per_request=max_bytes_per_request)
 
   return _apply_fn
 
@@ -884,7 +906,8 @@ def _from_dataset_id(processing_mode,
                      data_transfer_protocol=None,
                      compression="AUTO",
                      cross_trainer_cache=False,
-                     target_workers="AUTO"):
+                     target_workers="AUTO",
+                     max_bytes_per_request=None):
   """Creates a dataset which reads data from the tf.data service.
 
   This transformation is similar to `from_dataset_id`, but supports additional
@@ -947,6 +970,10 @@ def _from_dataset_id(processing_mode,
       data copy if every TF worker colocates with a tf.data service worker.
       Consumers of a shared job must use the same `target_workers`. Defaults to
       `"AUTO"`.
+    max_bytes_per_request: (Optional.) If set, each request asks a worker for up
+      to this many bytes of elements, which are returned in one response. Only
+      applies to first-come-first-served reads which don't use a
+      `cross_trainer_cache`.
 
   Returns:
     A `tf.data.Dataset` which reads from the tf.data service.
@@ -1013,7 +1040,8 @@ def _from_dataset_id(processing_mode,
       max_outstanding_requests=max_outstanding_requests,
       task_refresh_interval_hint_ms=task_refresh_interval_hint_ms,
       cross_trainer_cache=cross_trainer_cache,
-      target_workers=target_workers)
+      target_workers=target_workers,
+      max_bytes_per_request=max_bytes_per_request)
 
   # Disable autosharding for shared jobs.
   if job_name is not None:
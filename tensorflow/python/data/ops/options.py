@@ -227,6 +227,15 @@ class AutotuneOptions(options_lib.OptionsBase):
       docstring="When autotuning is enabled (through `autotune`), determines "
       "the algorithm to use.")
 
+  warm_start_dir = options_lib.create_option(
+      name="warm_start_dir",
+      ty=str,
+      docstring="When autotuning is enabled (through `autotune`), determines "
+      "the directory where the tuned parameter values are saved. Later runs of "
+      "the same input pipeline with the same directory start tuning from the "
+      "saved values instead of the defaults. If None, the tuned values are not "
+      "saved.")
+
   def _to_proto(self):
     pb = dataset_options_pb2.AutotuneOptions()
     if self.enabled is not None:
@@ -238,6 +247,8 @@ class AutotuneOptions(options_lib.OptionsBase):
     if self.autotune_algorithm is not None:
       pb.autotune_algorithm = AutotuneAlgorithm._to_proto(  # pylint: disable=protected-access
           self.autotune_algorithm)
+    if self.warm_start_dir is not None:
+      pb.warm_start_dir = self.warm_start_dir
     return pb
 
   def _from_proto(self, pb):
@@ -250,6 +261,8 @@ class AutotuneOptions(options_lib.OptionsBase):
     if pb.WhichOneof("optional_autotune_algorithm") is not None:
       self.autotune_algorithm = AutotuneAlgorithm._from_proto(  # pylint: disable=protected-access
           pb.autotune_algorithm)
+    if pb.WhichOneof("optional_warm_start_dir") is not None:
+      self.warm_start_dir = pb.warm_start_dir
 
   def _set_mutable(self, mutable):
     """Change the mutability value to `mutable` on this options and children."""
@@ -473,12 +486,24 @@ class ThreadingOptions(options_lib.OptionsBase):
       "The value 0 can be used to indicate that the threadpool size should be "
       "determined at runtime based on the number of available CPU cores.")
 
+  numa_affinity = options_lib.create_option(
+      name="numa_affinity",
+      ty=bool,
+      docstring=
+      "If set, the dataset threads are pinned to the NUMA node of the device "
+      "consuming the dataset, and elements are allocated from memory local to "
+      "that node. The dataset uses a private threadpool, sized by "
+      "`private_threadpool_size` if set, or otherwise by the number of CPU "
+      "cores of the NUMA node.")
+
   def _to_proto(self):
     pb = dataset_options_pb2.ThreadingOptions()
     if self.max_intra_op_parallelism is not None:
       pb.max_intra_op_parallelism = self.max_intra_op_parallelism
     if self.private_threadpool_size is not None:
       pb.private_threadpool_size = self.private_threadpool_size
+    if self.numa_affinity is not None:
+      pb.numa_affinity = self.numa_affinity
     return pb
 
   def _from_proto(self, pb):
@@ -486,6 +511,8 @@ class ThreadingOptions(options_lib.OptionsBase):
       self.max_intra_op_parallelism = pb.max_intra_op_parallelism
     if pb.WhichOneof("optional_private_threadpool_size") is not None:
       self.private_threadpool_size = pb.private_threadpool_size
+    if pb.WhichOneof("optional_numa_affinity") is not None:
+      self.numa_affinity = pb.numa_affinity
 
 
 @tf_export("data.Options")
@@ -558,6 +558,35 @@ class TensorArrayTest(test.TestCase):
           "it has already been written to."):
         self.evaluate(ta.write(2, 3.0).write(2, 3.0).flow)
 
+  @test_util.run_in_graph_and_eager_modes
+  def testSkipEagerTensorArrayWriteInParallelIterationsStack(self):
+    with self.session():
+      # Elements of 64 bytes with a fully defined shape are kept in one
+      # contiguous buffer.
+      ta = tensor_array_ops.TensorArray(
+          dtype=dtypes.float32,
+          size=100,
+          element_shape=[4, 4],
+          clear_after_read=False)
+
+      def body(i, ta):
+        value = array_ops.fill([4, 4], math_ops.cast(i, dtypes.float32))
+        return i + 1, ta.write(i, value)
+
+      _, ta = control_flow_ops.while_loop(
+          lambda i, _: i < 100, body, [0, ta], parallel_iterations=32)
+      stacked = ta.stack()
+      with ops.control_dependencies([stacked]):
+        read = ta.read(7)
+        gathered = ta.gather([3, 1])
+
+      expected = np.tile(
+          np.arange(100, dtype=np.float32)[:, None, None], [1, 4, 4])
+      stacked, read, gathered = self.evaluate([stacked, read, gathered])
+      self.assertAllEqual(expected, stacked)
+      self.assertAllEqual(expected[7], read)
+      self.assertAllEqual(expected[[3, 1]], gathered)
+
   def testTensorArrayConcatIncompatibleShapesFails(self):
     with self.session():
       ta = tensor_array_ops.TensorArray(
@@ -21,6 +21,7 @@ from tensorflow.python.framework import constant_op
 from tensorflow.python.framework import dtypes
 from tensorflow.python.framework import ops
 from tensorflow.python.framework import test_util
+from tensorflow.python.ops import array_ops
 from tensorflow.python.ops import gen_io_ops
 from tensorflow.python.ops import io_ops
 from tensorflow.python.platform import test
@@ -37,6 +38,51 @@ class SaveTest(test.TestCase):
                         self.evaluate(io_ops.restore_v2(
                             "ckpt", ["x"], [""], [dtypes.float32])))
 
+  def testAsyncSave(self):
+    prefix = os.path.join(self.get_temp_dir(), "async")
+    shards = [prefix + "_temp/part-00000-of-00002",
+              prefix + "_temp/part-00001-of-00002"]
+    with test.mock.patch.dict(os.environ, {"TF_ASYNC_CHECKPOINT_SAVE": "1"}):
+      with ops.Graph().as_default(), session.Session() as sess:
+        saves = [
+            io_ops.save_v2(shards[0], ["x", "y"], ["", ""], [
+                constant_op.constant(100.),
+                constant_op.constant([b"a", b"bc"])
+            ]),
+            io_ops.save_v2(shards[1], ["z"], [""],
+                           [array_ops.ones([1 << 20], dtypes.int32)]),
+        ]
+        sess.run(saves)
+        # Waits for the writes of the shards.
+        sess.run(gen_io_ops.merge_v2_checkpoints(shards, prefix))
+        x, y, z = sess.run(
+            io_ops.restore_v2(prefix, ["x", "y", "z"], ["", "", ""],
+                              [dtypes.float32, dtypes.string, dtypes.int32]))
+    self.assertAllEqual(100., x)
+    self.assertAllEqual([b"a", b"bc"], y)
+    self.assertAllEqual([1] * (1 << 20), z)
+
+
+  def testMmapRestore(self):
+    prefix = os.path.join(self.get_temp_dir(), "mmap")
+    with test.mock.patch.dict(os.environ, {
+        "TF_CHECKPOINT_DATA_ALIGNMENT": "64",
+        "TF_CHECKPOINT_RESTORE_USE_MMAP": "1"
+    }):
+      with ops.Graph().as_default(), session.Session() as sess:
+        sess.run(
+            io_ops.save_v2(prefix, ["x", "y", "z"], ["", "", ""], [
+                constant_op.constant([1., 2.]),
+                constant_op.constant([b"a", b"bc"]),
+                array_ops.ones([3, 5], dtypes.int64)
+            ]))
+        x, y, z = sess.run(
+            io_ops.restore_v2(prefix, ["x", "y", "z"], ["", "", ""],
+                              [dtypes.float32, dtypes.string, dtypes.int64]))
+    self.assertAllEqual([1., 2.], x)
+    self.assertAllEqual([b"a", b"bc"], y)
+    self.assertAllEqual([[1] * 5] * 3, z)
+
 
 class ShardedFileOpsTest(test.TestCase):
 
@@ -151,6 +151,34 @@ class TopKTest(test.TestCase):
     self._testMediumTopK(np.float32)
     self._testMediumTopK(np.float16)
 
+  def _testVeryLargeTopK(self, dtype):
+    # Long rows with large k, which use radix select on GPU.
+    b = 3
+    n = 100000
+    k = 2000
+    inputs = np.random.permutation(
+        np.linspace(0, 100, b * n, dtype=dtype)).reshape(b, n)
+    indices = np.argsort(-inputs, axis=1)[:, :k]
+    values = -np.sort(-inputs, axis=1)[:, :k]
+    self._validateTopK(inputs, k, values, indices)
+
+  def testVeryLargeTopK(self):
+    self._testVeryLargeTopK(np.float32)
+    self._testVeryLargeTopK(np.float64)
+    self._testVeryLargeTopK(np.float16)
+
+  def testVeryLargeTopKNegativeInts(self):
+    b = 2
+    n = 65536
+    k = 1000
+    for dtype in [np.int32, np.int64]:
+      # Lots of repeated integers, half of them negative.
+      inputs = np.random.permutation(
+          np.linspace(-50, 50, b * n).astype(dtype)).reshape(b, n)
+      indices = np.argsort(-inputs, axis=1, kind="mergesort")[:, :k]
+      values = -np.sort(-inputs, axis=1)[:, :k]
+      self._validateTopK(inputs, k, values, indices)
+
   def testStableSort(self):
     b = 5
     n = 500
@@ -521,3 +521,39 @@ def all_to_all_v3(communicator, t, group_assignment=None, timeout_seconds=None):
       input=t,
       group_assignment=group_assignment,
       timeout_seconds=timeout_seconds)
+
+
+def all_to_all_v_v3(communicator,
+                    t,
+                    send_counts,
+                    group_assignment=None,
+                    timeout_seconds=None):
+  """Exchanges tensors mutually with variable split sizes.
+
+  Args:
+    communicator: the resource `tf.Tensor` returned from
+      `initialize_communicator`.
+    t: a `tf.Tensor` with at least one dimension.
+    send_counts: an int64 `tf.Tensor` with the length of the size of the group.
+      The first `send_counts[0]` rows of `t` are sent to `rank 0`, the next
+      `send_counts[1]` rows to `rank 1`, and so on.
+    group_assignment: Optional int32 `tf.Tensor` with shape [num_groups,
+      num_ranks_per_group]. `group_assignment[i]` represents the ranks in the
+      `ith` subgroup.
+    timeout_seconds: If set to a non zero, set a completion timeout to detect
+      staleness. If the timer goes off, a DeadlineExceededError is raised. The
+      timeout value in seconds. This feature is experimental.
+
+  Returns:
+    A tuple of a `tf.Tensor` with the rows received from all ranks, in rank
+    order, and an int64 `tf.Tensor` with the number of rows received from each
+    rank.
+  """
+  if group_assignment is None:
+    group_assignment = []
+  return gen_collective_ops.collective_all_to_all_vv3(
+      communicator=communicator,
+      input=t,
+      send_counts=send_counts,
+      group_assignment=group_assignment,
+      timeout_seconds=timeout_seconds)
@@ -23,7 +23,7 @@ from tensorflow.python.framework import dtypes
 from tensorflow.python.framework import test_util
 from tensorflow.python.framework.test_util import TensorFlowTestCase
 # Import resource_variable_ops for the variables-to-tensor implicit conversion.
-from tensorflow.python.ops import resource_variable_ops  # pylint: disable=unused-import
+from tensorflow.python.ops import resource_variable_ops
 from tensorflow.python.ops import variables
 from tensorflow.python.platform import googletest
 from tensorflow.python.training import training_ops
@@ -442,6 +442,63 @@ class TrainingOpsTest(TensorFlowTestCase):
       self.assertShapeEqual(out, apply_adam)
       self.assertAllCloseAccordingToType(new_var, out)
 
+  @test_util.run_in_graph_and_eager_modes
+  def testResourceSparseApplyAdam(self):
+    for dtype in [np.float32, np.float64]:
+      var = np.arange(12).reshape(4, 3).astype(dtype)
+      m = np.ones([4, 3], dtype=dtype)
+      v = np.ones([4, 3], dtype=dtype)
+      grad = np.arange(9).reshape(3, 3).astype(dtype)
+      indices = np.array([2, 0, 2], dtype=np.int64)
+      var_t = resource_variable_ops.ResourceVariable(var)
+      m_t = resource_variable_ops.ResourceVariable(m)
+      v_t = resource_variable_ops.ResourceVariable(v)
+      self.evaluate(variables.global_variables_initializer())
+
+      beta1 = np.array(0.9, dtype=dtype)
+      beta2 = np.array(0.999, dtype=dtype)
+      lr = np.array(0.001, dtype=dtype)
+      epsilon = np.array(1e-8, dtype=dtype)
+      self.evaluate(
+          training_ops.resource_sparse_apply_adam(
+              var_t.handle, m_t.handle, v_t.handle, beta1, beta2, lr, beta1,
+              beta2, epsilon, grad, indices))
+
+      # Duplicate rows are added up, and rows without a gradient are
+      # unchanged.
+      expected_var, expected_m, expected_v = var.copy(), m.copy(), v.copy()
+      for row, g in [(0, grad[1]), (2, grad[0] + grad[2])]:
+        expected_var[row], expected_m[row], expected_v[row] = (
+            self._adamUpdateNumpy(var[row], g, 1, m[row], v[row], lr, beta1,
+                                  beta2, epsilon))
+      self.assertAllCloseAccordingToType(expected_var, self.evaluate(var_t))
+      self.assertAllCloseAccordingToType(expected_m, self.evaluate(m_t))
+      self.assertAllCloseAccordingToType(expected_v, self.evaluate(v_t))
+
+  @test_util.run_in_graph_and_eager_modes
+  def testResourceSparseApplyAdagradV2DeduplicateIndices(self):
+    for use_locking in [False, True]:
+      var = np.arange(8).reshape(4, 2).astype(np.float32)
+      accum = np.full([4, 2], 0.1, dtype=np.float32)
+      grad = np.array([[1, 2], [3, 4], [5, 6]], dtype=np.float32)
+      indices = np.array([3, 1, 3], dtype=np.int32)
+      var_t = resource_variable_ops.ResourceVariable(var)
+      accum_t = resource_variable_ops.ResourceVariable(accum)
+      self.evaluate(variables.global_variables_initializer())
+      lr = np.float32(0.5)
+      epsilon = np.float32(1e-7)
+      self.evaluate(
+          training_ops.resource_sparse_apply_adagrad_v2(
+              var_t.handle, accum_t.handle, lr, epsilon, grad, indices,
+              use_locking=use_locking, deduplicate_indices=True))
+
+      expected_var, expected_accum = var.copy(), accum.copy()
+      for row, g in [(3, grad[0] + grad[2]), (1, grad[1])]:
+        expected_accum[row] += g * g
+        expected_var[row] -= lr * g / (np.sqrt(expected_accum[row]) + epsilon)
+      self.assertAllClose(expected_var, self.evaluate(var_t))
+      self.assertAllClose(expected_accum, self.evaluate(accum_t))
+
   def _adamUpdateNumpy(self, param, g_t, t, m, v, alpha, beta1, beta2, epsilon):
     alpha_t = alpha * np.sqrt(1 - beta2**t) / (1 - beta1**t)
 
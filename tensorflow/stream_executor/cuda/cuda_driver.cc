@@ -1070,6 +1070,80 @@ GpuDriver::CreateMemoryHandle(GpuContext* context, uint64_t bytes) {
   return false;
 }
 
+/* static */ port::Status GpuDriver::StreamBeginCapture(GpuContext* context,
+                                                        CUstream stream) {
+  ScopedActivateContext activated{context};
+  CHECK(stream != nullptr);
+  // Only captures the operations of the calling thread, so that other threads
+  // that use the context aren't affected by the capture.
+  RETURN_IF_CUDA_RES_ERROR(
+      cuStreamBeginCapture(stream, CU_STREAM_CAPTURE_MODE_THREAD_LOCAL),
+      "Failed to begin the capture of CUDA stream");
+  return ::tensorflow::OkStatus();
+}
+
+/* static */ port::Status GpuDriver::StreamEndCapture(GpuContext* context,
+                                                      CUstream stream,
+                                                      CUgraph* graph) {
+  ScopedActivateContext activated{context};
+  CHECK(stream != nullptr);
+  RETURN_IF_CUDA_RES_ERROR(cuStreamEndCapture(stream, graph),
+                           "Failed to end the capture of CUDA stream");
+  return ::tensorflow::OkStatus();
+}
+
+/* static */ port::Status GpuDriver::GraphInstantiate(GpuContext* context,
+                                                      CUgraph graph,
+                                                      CUgraphExec* graph_exec) {
+  ScopedActivateContext activated{context};
+  RETURN_IF_CUDA_RES_ERROR(
+      cuGraphInstantiate(graph_exec, graph, /*phErrorNode=*/nullptr,
+                         /*logBuffer=*/nullptr, /*bufferSize=*/0),
+      "Failed to instantiate CUDA graph");
+  return ::tensorflow::OkStatus();
+}
+
+/* static */ port::StatusOr<bool> GpuDriver::GraphExecUpdate(
+    GpuContext* context, CUgraphExec graph_exec, CUgraph graph) {
+  ScopedActivateContext activated{context};
+  CUgraphNode error_node;
+  CUgraphExecUpdateResult update_result;
+  CUresult res =
+      cuGraphExecUpdate(graph_exec, graph, &error_node, &update_result);
+  if (res == CUDA_ERROR_GRAPH_EXEC_UPDATE_FAILURE) {
+    VLOG(2) << "CUDA graph can't be updated: " << update_result;
+    return false;
+  }
+  RETURN_IF_CUDA_RES_ERROR(res, "Failed to update CUDA graph");
+  return true;
+}
+
+/* static */ port::Status GpuDriver::GraphLaunch(GpuContext* context,
+                                                 CUgraphExec graph_exec,
+                                                 CUstream stream) {
+  ScopedActivateContext activated{context};
+  RETURN_IF_CUDA_RES_ERROR(cuGraphLaunch(graph_exec, stream),
+                           "Failed to launch CUDA graph");
+  return ::tensorflow::OkStatus();
+}
+
+/* static */ void GpuDriver::DestroyGraph(GpuContext* context, CUgraph graph) {
+  ScopedActivateContext activated{context};
+  CUresult res = cuGraphDestroy(graph);
+  if (res != CUDA_SUCCESS) {
+    LOG(ERROR) << "failed to destroy CUDA graph: " << ToString(res);
+  }
+}
+
+/* static */ void GpuDriver::DestroyGraphExec(GpuContext* context,
+                                              CUgraphExec graph_exec) {
+  ScopedActivateContext activated{context};
+  CUresult res = cuGraphExecDestroy(graph_exec);
+  if (res != CUDA_SUCCESS) {
+    LOG(ERROR) << "failed to destroy CUDA graph exec: " << ToString(res);
+  }
+}
+
 /* static */ port::Status GpuDriver::SynchronousMemcpyD2H(GpuContext* context,
                                                           void* host_dst,
                                                           CUdeviceptr gpu_src,
@@ -409,6 +409,49 @@ class GpuDriver {
   // the stream immediately after this returns).
   static bool IsStreamIdle(GpuContext* context, GpuStreamHandle stream);
 
+  // Starts capturing the operations that the calling thread enqueues onto
+  // stream into a graph, via cuStreamBeginCapture.  The captured operations
+  // are not executed.
+  // https://docs.nvidia.com/cuda/cuda-driver-api/group__CUDA__STREAM.html
+  static port::Status StreamBeginCapture(GpuContext* context,
+                                         GpuStreamHandle stream);
+
+  // Ends the capture of stream and returns the captured graph, via
+  // cuStreamEndCapture.  Fails if an operation that can't be captured was
+  // enqueued during the capture.
+  // https://docs.nvidia.com/cuda/cuda-driver-api/group__CUDA__STREAM.html
+  static port::Status StreamEndCapture(GpuContext* context,
+                                       GpuStreamHandle stream,
+                                       GpuGraphHandle* graph);
+
+  // Creates an executable graph from graph, via cuGraphInstantiate.
+  // https://docs.nvidia.com/cuda/cuda-driver-api/group__CUDA__GRAPH.html
+  static port::Status GraphInstantiate(GpuContext* context,
+                                       GpuGraphHandle graph,
+                                       GpuGraphExecHandle* graph_exec);
+
+  // Updates the node parameters of graph_exec, e.g. the arguments of its
+  // kernels, to the ones of graph, via cuGraphExecUpdate.  Returns false if
+  // graph_exec can't be updated, e.g. because graph has a different topology.
+  // https://docs.nvidia.com/cuda/cuda-driver-api/group__CUDA__GRAPH.html
+  static port::StatusOr<bool> GraphExecUpdate(GpuContext* context,
+                                              GpuGraphExecHandle graph_exec,
+                                              GpuGraphHandle graph);
+
+  // Enqueues the execution of graph_exec onto stream, via cuGraphLaunch.
+  // https://docs.nvidia.com/cuda/cuda-driver-api/group__CUDA__GRAPH.html
+  static port::Status GraphLaunch(GpuContext* context,
+                                  GpuGraphExecHandle graph_exec,
+                                  GpuStreamHandle stream);
+
+  // Destroys graph, via cuGraphDestroy.
+  static void DestroyGraph(GpuContext* context, GpuGraphHandle graph);
+
+  // Destroys graph_exec, via cuGraphExecDestroy.  Executions of graph_exec
+  // that are in flight complete normally.
+  static void DestroyGraphExec(GpuContext* context,
+                               GpuGraphExecHandle graph_exec);
+
   // Returns whether code in the from context can access memory in the to
   // context via cuDeviceCanAccessPeer.
   // http://docs.nvidia.com/cuda/cuda-driver-api/group__CUDA__PEER__ACCESS.html#group__CUDA__PEER__ACCESS_1g496bdaae1f632ebfb695b99d2c40f19e
@@ -840,6 +840,45 @@ GpuDriver::ContextGetSharedMemConfig(GpuContext* context) {
   return false;
 }
 
+// TODO(ROCm): Capture graphs with the hipGraph API.
+/* static */ port::Status GpuDriver::StreamBeginCapture(
+    GpuContext* context, GpuStreamHandle stream) {
+  return port::Status{port::error::UNIMPLEMENTED,
+                      "Graph capture is not implemented on ROCm"};
+}
+
+/* static */ port::Status GpuDriver::StreamEndCapture(GpuContext* context,
+                                                      GpuStreamHandle stream,
+                                                      GpuGraphHandle* graph) {
+  return port::Status{port::error::UNIMPLEMENTED,
+                      "Graph capture is not implemented on ROCm"};
+}
+
+/* static */ port::Status GpuDriver::GraphInstantiate(
+    GpuContext* context, GpuGraphHandle graph, GpuGraphExecHandle* graph_exec) {
+  return port::Status{port::error::UNIMPLEMENTED,
+                      "Graph capture is not implemented on ROCm"};
+}
+
+/* static */ port::StatusOr<bool> GpuDriver::GraphExecUpdate(
+    GpuContext* context, GpuGraphExecHandle graph_exec, GpuGraphHandle graph) {
+  return port::Status{port::error::UNIMPLEMENTED,
+                      "Graph capture is not implemented on ROCm"};
+}
+
+/* static */ port::Status GpuDriver::GraphLaunch(GpuContext* context,
+                                                 GpuGraphExecHandle graph_exec,
+                                                 GpuStreamHandle stream) {
+  return port::Status{port::error::UNIMPLEMENTED,
+                      "Graph capture is not implemented on ROCm"};
+}
+
+/* static */ void GpuDriver::DestroyGraph(GpuContext* context,
+                                          GpuGraphHandle graph) {}
+
+/* static */ void GpuDriver::DestroyGraphExec(GpuContext* context,
+                                              GpuGraphExecHandle graph_exec) {}
+
 /* static */ port::Status GpuDriver::SynchronousMemcpyD2H(
     GpuContext* context, void* host_dst, hipDeviceptr_t gpu_src,
     uint64_t size) {